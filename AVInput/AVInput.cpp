@@ -205,14 +205,7 @@ namespace WPEFramework {
         // Thunder plugins communication
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > AVInput::getThunderControllerClient()
         {
-            string token;
-            Utils::SecurityToken::getSecurityToken(token);
-            string query = "token=" + token;
-
-            // making function local static to be thread safe
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(SERVER_DETAILS)));
-            static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > thunderClient = make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> >("", "", false, query);
-            return thunderClient;
+            return Utils::getThunderControllerClient();
         }
 
         void AVInput::activatePlugin(const char* callSign)
@@ -226,7 +219,9 @@ namespace WPEFramework {
                 LOGINFO("Activating %s", callSign);
                 // deactivatePlugin() would have "deactivate" as a command (plus, m_activatedPlugins should have an entry erased from it, see isPluginActivated())
                 // setting wait Time to 2 seconds
-                uint32_t status = getThunderControllerClient()->Invoke<JsonObject, JsonObject>(2000, "activate", joParams, joResult);
+                auto thunderController = getThunderControllerClient();
+                uint32_t status = thunderController->Invoke<JsonObject, JsonObject>(2000, "activate", joParams, joResult);
+                Utils::releaseThunderControllerClient(thunderController, status);
                 string strParams;
                 string strResult;
                 joParams.ToString(strParams);
@@ -250,7 +245,8 @@ namespace WPEFramework {
         {
             string method = "status@" + string(callSign);
             Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-            getThunderControllerClient()->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(2000, method.c_str(),joResult);
+            auto thunderController = getThunderControllerClient();
+            Utils::releaseThunderControllerClient(thunderController, thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(2000, method.c_str(),joResult));
             LOGINFO("Getting status for callSign %s, result: %s", callSign, joResult[0].JSONState.Data().c_str());
             bool pluginActivated = joResult[0].JSONState == PluginHost::IShell::ACTIVATED;
             auto p = m_activatedPlugins.find(string(callSign));
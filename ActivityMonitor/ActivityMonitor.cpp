@@ -18,6 +18,10 @@
 **/
 
 #include <memory>
+#include <atomic>
+#include <algorithm>
+#include <fcntl.h>
+#include <dirent.h>
 
 #include "ActivityMonitor.h"
 
@@ -28,9 +32,14 @@
 #define ACTIVITY_MONITOR_METHOD_GET_ALL_MEMORY_USAGE "getAllMemoryUsage"
 #define ACTIVITY_MONITOR_METHOD_ENABLE_MONITORING "enableMonitoring"
 #define ACTIVITY_MONITOR_METHOD_DISABLE_MONITORING "disableMonitoring"
+#define ACTIVITY_MONITOR_METHOD_GET_HISTORY "getHistory"
+#define ACTIVITY_MONITOR_METHOD_ENABLE_PRESSURE_MONITORING "enablePressureMonitoring"
+#define ACTIVITY_MONITOR_METHOD_DISABLE_PRESSURE_MONITORING "disablePressureMonitoring"
+#define ACTIVITY_MONITOR_METHOD_GET_PRESSURE "getPressure"
 
 #define ACTIVITY_MONITOR_EVT_ON_MEMORY_THRESHOLD "onMemoryThreshold"
 #define ACTIVITY_MONITOR_EVT_ON_CPU_THRESHOLD "onCPUThreshold"
+#define ACTIVITY_MONITOR_EVT_ON_PRESSURE "onPressure"
 
 #define VERSION_TXT_FILE "/version.txt"
 
@@ -40,6 +49,8 @@
 
 #define CALLSIGN_PARAMETER "-C"
 
+#define HISTORY_SIZE 600
+
 namespace WPEFramework
 {
     namespace Plugin
@@ -49,6 +60,80 @@ namespace WPEFramework
         ActivityMonitor* ActivityMonitor::_instance = nullptr;
 
 
+        // Fixed-size sample history of one monitored application. There is a
+        // single writer (the monitoring thread); readers never block it. Each
+        // slot carries the index of the sample it holds, published after the
+        // data, so a reader can tell a complete slot from one being overwritten.
+        struct MonitorHistory
+        {
+            struct Sample
+            {
+                long long int timestamp;
+                unsigned int memoryMB;
+                unsigned int cpuPercent;
+            };
+
+            MonitorHistory() : head(0)
+            {
+                for (unsigned int n = 0; n < HISTORY_SIZE; n++)
+                    slots[n].index.store(0, std::memory_order_relaxed);
+            }
+
+            void add(long long int timestamp, unsigned int memoryMB, unsigned int cpuPercent)
+            {
+                long long unsigned int n = head.load(std::memory_order_relaxed);
+                Slot &slot = slots[n % HISTORY_SIZE];
+
+                slot.index.store(0, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.timestamp.store(timestamp, std::memory_order_relaxed);
+                slot.memoryMB.store(memoryMB, std::memory_order_relaxed);
+                slot.cpuPercent.store(cpuPercent, std::memory_order_relaxed);
+                slot.index.store(n + 1, std::memory_order_release);
+
+                head.store(n + 1, std::memory_order_release);
+            }
+
+            // Copies the samples not older than since (ms since epoch), oldest first
+            void read(long long int since, std::vector<Sample> &samplesOut) const
+            {
+                long long unsigned int end = head.load(std::memory_order_acquire);
+                long long unsigned int begin = end > HISTORY_SIZE ? end - HISTORY_SIZE : 0;
+
+                for (long long unsigned int n = begin; n < end; n++)
+                {
+                    const Slot &slot = slots[n % HISTORY_SIZE];
+
+                    if (slot.index.load(std::memory_order_acquire) != n + 1)
+                        continue;
+
+                    Sample sample;
+                    sample.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+                    sample.memoryMB = slot.memoryMB.load(std::memory_order_relaxed);
+                    sample.cpuPercent = slot.cpuPercent.load(std::memory_order_relaxed);
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (slot.index.load(std::memory_order_relaxed) != n + 1)
+                        continue; // overwritten while copying
+
+                    if (sample.timestamp >= since)
+                        samplesOut.push_back(sample);
+                }
+            }
+
+        private:
+            struct Slot
+            {
+                std::atomic<long long unsigned int> index;
+                std::atomic<long long int> timestamp;
+                std::atomic<unsigned int> memoryMB;
+                std::atomic<unsigned int> cpuPercent;
+            };
+
+            Slot slots[HISTORY_SIZE];
+            std::atomic<long long unsigned int> head;
+        };
+
         struct AppConfig
         {
             AppConfig()
@@ -58,6 +143,7 @@ namespace WPEFramework
                 cpuUsage = 0;
                 memExceeded = cpuExceededPercent = 0;
                 eventSent = false;
+                memoryMB = cpuPercent = 0;
             }
 
             enum {
@@ -77,6 +163,10 @@ namespace WPEFramework
             unsigned int memExceeded;
             unsigned int cpuExceededPercent;
             bool eventSent;
+
+            unsigned int memoryMB;
+            unsigned int cpuPercent;
+            std::shared_ptr<MonitorHistory> history;
         };
 
         struct MonitorParams
@@ -89,6 +179,33 @@ namespace WPEFramework
             std::chrono::system_clock::time_point lastCpuCheck;
         };
 
+        // State kept between two /proc scans for one process. The stat file
+        // stays open and is re-read with pread(); memory and call sign are only
+        // recomputed when the process changed or the pid was reused.
+        struct ProcEntry
+        {
+            ProcEntry()
+            {
+                statFd = -1;
+                ppid = pvt = shared = 0;
+                startTime = cpuTicks = rss = 0;
+                memValid = callSignResolved = seen = false;
+            }
+
+            int statFd;
+            std::string cmdName;
+            unsigned int ppid;
+            long long unsigned int startTime;
+            long long unsigned int cpuTicks;
+            long long unsigned int rss;
+            unsigned int pvt;
+            unsigned int shared;
+            bool memValid;
+            std::string callSign;
+            bool callSignResolved;
+            bool seen;
+        };
+
         class MemoryInfo
         {
         public:
@@ -102,18 +219,28 @@ namespace WPEFramework
             static unsigned int getFreeMemory();
             static void readSmaps(const char *pid, unsigned int &pvtOut, unsigned int &sharedOut);
 
-            static void getProcStat(const char *dirName, std::string &cmdName, unsigned int &ppid, bool calcCpu, long long unsigned int &cpuTicks);
+            static bool getProcStat(int procFd, const char *dirName, ProcEntry &entry);
             static std::string getCallSign(int pid);
             static void getProcInfo(bool calcMem, bool calcCpu, std::vector<unsigned int> &pidsOut, std::vector <std::string> &cmdsOut, std::vector <unsigned int> &memUsageOut, std::vector <long long unsigned int> &cpuUsageOut);
 
         private:
             static std::map <std::string, std::string> registry;
             static bool isRegistryLoaded;
+
+            static std::mutex procCacheMutex;
+            static std::map <unsigned int, ProcEntry> procCache;
+            static int smapsRollup;
+            static std::vector <char> buffer;
         };
 
         std::map <std::string, std::string> MemoryInfo::registry;
         bool MemoryInfo::isRegistryLoaded = false;
 
+        std::mutex MemoryInfo::procCacheMutex;
+        std::map <unsigned int, ProcEntry> MemoryInfo::procCache;
+        int MemoryInfo::smapsRollup = -1;
+        std::vector <char> MemoryInfo::buffer(4096);
+
 
         ActivityMonitor::ActivityMonitor()
         : AbstractPlugin()
@@ -126,6 +253,10 @@ namespace WPEFramework
             registerMethod(ACTIVITY_MONITOR_METHOD_GET_ALL_MEMORY_USAGE, &ActivityMonitor::getAllMemoryUsage, this);
             registerMethod(ACTIVITY_MONITOR_METHOD_ENABLE_MONITORING, &ActivityMonitor::enableMonitoring, this);
             registerMethod(ACTIVITY_MONITOR_METHOD_DISABLE_MONITORING, &ActivityMonitor::disableMonitoring, this);
+            registerMethod(ACTIVITY_MONITOR_METHOD_GET_HISTORY, &ActivityMonitor::getHistory, this);
+            registerMethod(ACTIVITY_MONITOR_METHOD_ENABLE_PRESSURE_MONITORING, &ActivityMonitor::enablePressureMonitoring, this);
+            registerMethod(ACTIVITY_MONITOR_METHOD_DISABLE_PRESSURE_MONITORING, &ActivityMonitor::disablePressureMonitoring, this);
+            registerMethod(ACTIVITY_MONITOR_METHOD_GET_PRESSURE, &ActivityMonitor::getPressure, this);
         }
 
         ActivityMonitor::~ActivityMonitor()
@@ -136,6 +267,8 @@ namespace WPEFramework
         {
             ActivityMonitor::_instance = nullptr;
 
+            m_pressureMonitor.stop();
+
             if (m_monitor.joinable())
                 m_monitor.join();
 
@@ -250,6 +383,8 @@ namespace WPEFramework
             m_monitorParams->memoryIntervalSeconds = memoryIntervalSeconds;
             m_monitorParams->cpuIntervalSeconds = cpuIntervalSeconds;
 
+            std::map <unsigned int, std::shared_ptr<MonitorHistory>> history;
+
             JsonArray::Iterator index(configArray.Elements());
 
             while (index.Next() == true)
@@ -265,6 +400,10 @@ namespace WPEFramework
                     getNumberParameterObject(m, "cpuThresholdPercent", conf.cpuThresholdPercent);
                     getNumberParameterObject(m, "cpuThresholdSeconds", conf.cpuThresholdSeconds);
 
+                    std::shared_ptr<MonitorHistory> &h = history[conf.pid];
+                    if (!h)
+                        h = std::make_shared<MonitorHistory>();
+                    conf.history = h;
 
                     m_monitorParams->config.push_back(conf);
                 }
@@ -280,6 +419,11 @@ namespace WPEFramework
                 m_stopMonitoring = false;
             }
 
+            {
+                std::lock_guard<std::mutex> lock(m_historyMutex);
+                m_history.swap(history);
+            }
+
             m_monitor = std::thread(threadRun, this);
 
             returnResponse(true);
@@ -298,6 +442,193 @@ namespace WPEFramework
             returnResponse(true);
         }
 
+        static unsigned int percentile(const std::vector<unsigned int> &sorted, unsigned int percent)
+        {
+            size_t rank = (sorted.size() * percent + 99) / 100; // nearest rank
+            return sorted[rank > 0 ? rank - 1 : 0];
+        }
+
+        static JsonObject historyStats(std::vector<unsigned int> &values)
+        {
+            std::sort(values.begin(), values.end());
+
+            JsonObject stats;
+            stats["min"] = values.front();
+            stats["max"] = values.back();
+            stats["p50"] = percentile(values, 50);
+            stats["p95"] = percentile(values, 95);
+            return stats;
+        }
+
+        uint32_t ActivityMonitor::getHistory(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            returnIfParamNotFound(parameters, "appPid");
+
+            unsigned int pid = 0;
+            unsigned int seconds = 0;
+            getNumberParameter("appPid", pid);
+            if (parameters.HasLabel("seconds"))
+                getNumberParameter("seconds", seconds);
+
+            std::shared_ptr<MonitorHistory> history;
+            {
+                std::lock_guard<std::mutex> lock(m_historyMutex);
+                std::map <unsigned int, std::shared_ptr<MonitorHistory>>::iterator it = m_history.find(pid);
+                if (it != m_history.end())
+                    history = it->second;
+            }
+
+            if (!history)
+            {
+                LOGWARN("No history for pid %u, it is not monitored", pid);
+                returnResponse(false);
+            }
+
+            long long int since = 0;
+            if (seconds > 0)
+                since = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - (long long int)seconds * 1000;
+
+            std::vector<MonitorHistory::Sample> samples;
+            history->read(since, samples);
+
+            response["appPid"] = pid;
+            response["samples"] = (unsigned int)samples.size();
+
+            if (samples.size() > 0)
+            {
+                std::vector<unsigned int> memoryMB, cpuPercent;
+                memoryMB.reserve(samples.size());
+                cpuPercent.reserve(samples.size());
+
+                for (unsigned int n = 0; n < samples.size(); n++)
+                {
+                    memoryMB.push_back(samples[n].memoryMB);
+                    cpuPercent.push_back(samples[n].cpuPercent);
+                }
+
+                response["from"] = (int64_t)samples.front().timestamp;
+                response["to"] = (int64_t)samples.back().timestamp;
+                response["memoryMB"] = historyStats(memoryMB);
+                response["cpuPercent"] = historyStats(cpuPercent);
+            }
+
+            returnResponse(true);
+        }
+
+        uint32_t ActivityMonitor::enablePressureMonitoring(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            if (!PressureMonitor::isSupported())
+            {
+                LOGERR("The kernel does not report pressure stall information");
+                response["error"] = "not supported";
+                returnResponse(false);
+            }
+
+            std::vector<PressureMonitor::Trigger> triggers;
+            JsonArray triggerArray = parameters["triggers"].Array();
+            JsonArray::Iterator index(triggerArray.Elements());
+
+            while (index.Next() == true)
+            {
+                if (Core::JSON::Variant::type::OBJECT == index.Current().Content())
+                {
+                    JsonObject m = index.Current().Object();
+                    PressureMonitor::Trigger trigger;
+
+                    trigger.resource = m["resource"].String();
+                    trigger.type = m.HasLabel("type") ? m["type"].String() : "some";
+                    trigger.stallMs = 0;
+                    trigger.windowMs = 1000;
+                    trigger.cgroup = m.HasLabel("cgroup") ? m["cgroup"].String() : "";
+                    trigger.pid = 0;
+                    getNumberParameterObject(m, "stallMs", trigger.stallMs);
+                    if (m.HasLabel("windowMs"))
+                        getNumberParameterObject(m, "windowMs", trigger.windowMs);
+                    if (m.HasLabel("appPid"))
+                        getNumberParameterObject(m, "appPid", trigger.pid);
+
+                    if (trigger.resource != "memory" && trigger.resource != "cpu" && trigger.resource != "io")
+                    {
+                        LOGWARN("Unknown pressure resource '%s'", trigger.resource.c_str());
+                        response["error"] = "resource is memory, cpu or io";
+                        returnResponse(false);
+                    }
+
+                    triggers.push_back(trigger);
+                }
+                else
+                    LOGWARN("Unexpected variant type");
+            }
+
+            std::string error;
+            bool result = m_pressureMonitor.start(triggers, std::bind(&ActivityMonitor::onPressure, this, std::placeholders::_1, std::placeholders::_2), error);
+            if (!result)
+                response["error"] = error;
+
+            returnResponse(result);
+        }
+
+        uint32_t ActivityMonitor::disablePressureMonitoring(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            m_pressureMonitor.stop();
+
+            returnResponse(true);
+        }
+
+        static JsonObject pressureAverages(const PressureMonitor::Averages &averages)
+        {
+            JsonObject a;
+            a["avg10"] = averages.avg10;
+            a["avg60"] = averages.avg60;
+            a["avg300"] = averages.avg300;
+            a["total"] = (uint64_t)averages.total;
+            return a;
+        }
+
+        static void pressureResponse(const PressureMonitor::Reading &reading, JsonObject &response)
+        {
+            response["some"] = pressureAverages(reading.some);
+            // CPU has no full line before 5.13, nothing is ever stalled on it at the system level
+            if (reading.full.valid)
+                response["full"] = pressureAverages(reading.full);
+        }
+
+        uint32_t ActivityMonitor::getPressure(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            std::string cgroup;
+            unsigned int pid = 0;
+            getDefaultStringParameter("cgroup", cgroup, "");
+            if (parameters.HasLabel("appPid"))
+                getNumberParameter("appPid", pid);
+
+            bool result = false;
+            const char *resources[] = { "memory", "cpu", "io" };
+            for (const char *resource : resources)
+            {
+                PressureMonitor::Reading reading;
+                if (PressureMonitor::read(PressureMonitor::path(resource, cgroup, pid), reading))
+                {
+                    JsonObject r;
+                    pressureResponse(reading, r);
+                    response[resource] = r;
+                    result = true;
+                }
+            }
+
+            if (!result)
+                LOGWARN("No pressure stall information%s%s", cgroup.empty() && 0 == pid ? "" : " for ", pid > 0 ? std::to_string(pid).c_str() : cgroup.c_str());
+
+            returnResponse(result);
+        }
+
         bool MemoryInfo::isDevOrVBNImage()
         {
             std::vector <char> buf;
@@ -416,23 +747,11 @@ namespace WPEFramework
 
         unsigned int MemoryInfo::parseLine(const char *line)
         {
-            std::string s(line);
-
-            unsigned int val;
+            const char *begin = strpbrk(line, "0123456789");
+            if (NULL != begin)
+                return strtoul(begin, NULL, 10);
 
-            size_t begin = s.find_first_of("0123456789");
-            size_t end = std::string::npos;
-            if (std::string::npos != begin)
-                end = s.find_first_not_of("0123456789", begin);
-
-            if (std::string::npos != begin && std::string::npos != end)
-            {
-                s = s.substr(begin, end);
-                val = strtoul(s.c_str(), NULL, 10);
-                return val;
-            }
-            else
-                LOGERR("Failed to parse value from %s", line);
+            LOGERR("Failed to parse value from %s", line);
 
             return 0;
         }
@@ -462,41 +781,45 @@ namespace WPEFramework
             return total / 1024; // From KB to MB
         }
 
+        // Called with procCacheMutex held, uses the shared buffer.
         void MemoryInfo::readSmaps(const char *pid, unsigned int &pvtOut, unsigned int &sharedOut)
         {
-            std::string smapsName = "/proc/";
-            smapsName += pid;
-            smapsName += "/smaps";
+            if (-1 == smapsRollup)
+                smapsRollup = (0 == access("/proc/self/smaps_rollup", R_OK)) ? 1 : 0;
+
+            // smaps_rollup has the same fields already summed up over all mappings
+            char smapsName[64];
+            snprintf(smapsName, sizeof(smapsName), "/proc/%s/%s", pid, smapsRollup ? "smaps_rollup" : "smaps");
 
-            FILE *f = fopen(smapsName.c_str(), "r");
+            FILE *f = fopen(smapsName, "r");
             if (NULL == f)
             {
                 pvtOut = sharedOut = 0;
                 return;
             }
 
-            std::vector <char> buf;
-            buf.resize(1024);
+            char *buf = buffer.data();
+            int bufSize = buffer.size();
 
             size_t shared = 0;
             size_t pvt = 0;
             size_t pss = 0;
             bool withPss = false;
 
-            while (fgets(buf.data(), buf.size(), f))
+            while (fgets(buf, bufSize, f))
             {
-                if (strstr(buf.data(), "Shared") == buf.data())
+                if (0 == strncmp(buf, "Shared", 6))
                 {
-                    shared += parseLine(buf.data());
+                    shared += parseLine(buf);
                 }
-                else if (strstr(buf.data(), "Private") == buf.data())
+                else if (0 == strncmp(buf, "Private", 7))
                 {
-                    pvt += parseLine(buf.data());
+                    pvt += parseLine(buf);
                 }
-                else if (strstr(buf.data(), "Pss") == buf.data())
+                else if (0 == strncmp(buf, "Pss:", 4)) // not Pss_Anon/Pss_File/... of newer kernels
                 {
                     withPss = true;
-                    pss += parseLine(buf.data());
+                    pss += parseLine(buf);
                 }
             }
 
@@ -509,77 +832,84 @@ namespace WPEFramework
             sharedOut = shared;
         }
 
-        void MemoryInfo::getProcStat(const char *dirName, std::string &cmdName, unsigned int &ppid, bool calcCpu, long long unsigned int &cpuTicks)
+        // Called with procCacheMutex held. Opens the stat file relative to
+        // procFd on first use and keeps it open in the entry.
+        bool MemoryInfo::getProcStat(int procFd, const char *dirName, ProcEntry &entry)
         {
-            std::string statName = "/proc/";
-            statName += dirName;
-            statName += "/stat";
+            char statName[64];
+            snprintf(statName, sizeof(statName), "%s/stat", dirName);
 
-            std::vector <char> buf;
-            buf.resize(1024);
+            if (entry.statFd < 0)
+                entry.statFd = openat(procFd, statName, O_RDONLY | O_CLOEXEC);
 
-            size_t r = 0;
-            FILE *f = fopen(statName.c_str(), "r");
-            if (f)
+            if (entry.statFd < 0)
+                return false;
+
+            ssize_t r = pread(entry.statFd, buffer.data(), buffer.size() - 1, 0);
+            if (r <= 0)
             {
-                r = fread(buf.data(), 1, buf.size(), f);
-                if (buf.size() == r)
-                {
-                    LOGERR("Failed to read stat, buffer is too small");
-                }
-                fclose(f);
+                // The process is gone (or its pid was just reused), start over
+                close(entry.statFd);
+                entry.statFd = openat(procFd, statName, O_RDONLY | O_CLOEXEC);
+                if (entry.statFd < 0)
+                    return false;
+                r = pread(entry.statFd, buffer.data(), buffer.size() - 1, 0);
+                if (r <= 0)
+                    return false;
             }
-
-            std::string stat(buf.data(), r);
-
-            std::size_t p1 = stat.find_first_of("(");
-            std::size_t p2 = stat.find_first_of(")");
-            if (std::string::npos == p1 || std::string::npos == p2)
+            if ((size_t)r == buffer.size() - 1)
             {
-                //LOGINFO("Failed to parse command name from stat file '%s', '%s'", statName.c_str(), stat.c_str());
-                return;
+                LOGERR("Failed to read stat, buffer is too small");
             }
 
-            cmdName = stat.substr(p1 + 1, p2 - p1 - 1);
-
-            size_t pos = p2, cnt = 0;
+            char *stat = buffer.data();
+            stat[r] = 0;
 
-            while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
+            char *p1 = strchr(stat, '(');
+            char *p2 = strrchr(stat, ')');
+            if (NULL == p1 || NULL == p2 || p2 < p1)
             {
-                cnt++;
-                if (2 == cnt)
-                    break;
+                //LOGINFO("Failed to parse command name from stat file '%s', '%s'", statName, stat);
+                return false;
             }
 
-            ppid = 0;
-
-            int vc = sscanf(buf.data() + pos, "%u", &ppid);
-            if (1 != vc)
-                LOGERR("Failed to parse parent pid from '%s'", stat.c_str());
-
-            if (calcCpu)
+            unsigned int ppid = 0;
+            long long unsigned int utime = 0, stime = 0, cutime = 0, cstime = 0, startTime = 0, rss = 0;
+
+            int vc = sscanf(p2 + 1,
+                            " %*c %u" // state, ppid
+                            " %*d %*d %*d %*d %*u" // pgrp, session, tty_nr, tpgid, flags
+                            " %*u %*u %*u %*u" // minflt, cminflt, majflt, cmajflt
+                            " %llu %llu %llu %llu" // utime, stime, cutime, cstime
+                            " %*d %*d %*d %*d" // priority, nice, num_threads, itrealvalue
+                            " %llu %*u %llu", // starttime, vsize, rss
+                            &ppid, &utime, &stime, &cutime, &cstime, &startTime, &rss);
+            if (7 != vc)
             {
-                while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
-                {
-                    cnt++;
-                    if (12 == cnt)
-                        break;
-                }
+                LOGERR("Failed to parse '%s', number of items matched: %d", stat, vc);
+                if (vc < 1)
+                    return false;
+            }
 
-                long long unsigned int utime = 0, stime = 0, cutime = 0, cstime = 0;
+            if (startTime != entry.startTime)
+            {
+                // New process, or a different one behind a reused pid
+                entry.cmdName.assign(p1 + 1, p2 - p1 - 1);
+                entry.startTime = startTime;
+                entry.callSign.clear();
+                entry.callSignResolved = false;
+                entry.memValid = false;
+            }
 
-                vc = sscanf(buf.data() + pos,
-                                "%llu %llu " //utime, stime
-                                "%llu %llu ", //cutime, cstime
-                                &utime, &stime, &cutime, &cstime);
-                if (4 != vc)
-                {
-                    LOGERR("Failed to parse parent cpu ticks from '%s', number of items matched: %d", stat.c_str(), vc);
-                }
+            long long unsigned int cpuTicks = utime + stime + cutime + cstime;
+            if (cpuTicks != entry.cpuTicks || rss != entry.rss)
+                entry.memValid = false;
 
-                cpuTicks = utime + stime + cutime + cstime;
-            }
+            entry.ppid = ppid;
+            entry.cpuTicks = cpuTicks;
+            entry.rss = rss;
 
+            return true;
         }
 
         std::string MemoryInfo::getCallSign(int pid)
@@ -642,12 +972,23 @@ namespace WPEFramework
                 return;
             }
 
+            std::lock_guard<std::mutex> lock(procCacheMutex);
+
             std::vector<std::string> cmds;
             std::vector<unsigned int> pids;
             std::vector<unsigned int> ppids;
             std::vector<long long unsigned int> cpuUsage;
+            std::vector<ProcEntry *> entries;
 
             DIR *d = opendir("/proc");
+            if (NULL == d)
+            {
+                LOGERR("Failed to open /proc: %s", strerror(errno));
+                return;
+            }
+
+            for (std::map <unsigned int, ProcEntry>::iterator it = procCache.begin(); it != procCache.end(); it++)
+                it->second.seen = false;
 
             struct dirent *de;
 
@@ -661,16 +1002,37 @@ namespace WPEFramework
                 if (0 != *end)
                     continue;
 
-                std::string cmdName;
-                unsigned int ppid = 0;
-                long long unsigned int cpuTicks = 0;
+                ProcEntry &entry = procCache[pid];
+                entry.seen = true;
 
-                MemoryInfo::getProcStat(de->d_name, cmdName, ppid, calcCpu, cpuTicks);
+                if (!MemoryInfo::getProcStat(dirfd(d), de->d_name, entry))
+                {
+                    entry.cmdName.clear();
+                    entry.startTime = 0;
+                    entry.ppid = 0;
+                    entry.cpuTicks = 0;
+                    entry.memValid = false;
+                }
 
-                cmds.push_back(cmdName);
+                cmds.push_back(entry.cmdName);
                 pids.push_back(pid);
-                ppids.push_back(ppid);
-                cpuUsage.push_back(cpuTicks);
+                ppids.push_back(entry.ppid);
+                cpuUsage.push_back(calcCpu ? entry.cpuTicks : 0);
+                entries.push_back(&entry);
+            }
+
+            closedir(d);
+
+            for (std::map <unsigned int, ProcEntry>::iterator it = procCache.begin(); it != procCache.end();)
+            {
+                if (!it->second.seen)
+                {
+                    if (it->second.statFd >= 0)
+                        close(it->second.statFd);
+                    it = procCache.erase(it);
+                }
+                else
+                    it++;
             }
 
             std::map <unsigned int, unsigned int> pidMap;
@@ -701,11 +1063,16 @@ namespace WPEFramework
                     {
                         if (pid2callSign.find(pids[idx]) == pid2callSign.end())
                         {
-                            std::string callSign = getCallSign(pids[idx]);
+                            ProcEntry *entry = entries[idx];
+                            if (!entry->callSignResolved)
+                            {
+                                entry->callSign = getCallSign(pids[idx]);
+                                entry->callSignResolved = true;
+                            }
 
-                            if (callSign.size() > 0)
+                            if (entry->callSign.size() > 0)
                             {    
-                                pid2callSign[pids[idx]] = callSign;
+                                pid2callSign[pids[idx]] = entry->callSign;
                                 lastIdx = idx;
                             }
 
@@ -742,12 +1109,17 @@ namespace WPEFramework
                 {
                     for (unsigned int n = 0; n < it->second.size(); n++)
                     {
-                        char s[256];
-                        snprintf(s, sizeof(s), "%u", pids[it->second[n]]);
+                        ProcEntry *entry = entries[it->second[n]];
+                        if (!entry->memValid)
+                        {
+                            char s[256];
+                            snprintf(s, sizeof(s), "%u", pids[it->second[n]]);
 
-                        unsigned int pvt, shared;
+                            readSmaps(s, entry->pvt, entry->shared);
+                            entry->memValid = true;
+                        }
 
-                        readSmaps(s, pvt, shared);
+                        unsigned int pvt = entry->pvt, shared = entry->shared;
                         unsigned int cnt = cmdCount[cmds[it->second[n]]];
                         if (0 == cnt)
                         {
@@ -856,6 +1228,8 @@ namespace WPEFramework
                     totalCpuUsage = MemoryInfo::getTotalCpuUsage();
                 }
 
+                long long int now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
                 for (std::list <AppConfig>::iterator it = m_monitorParams->config.begin(); it != m_monitorParams->config.end(); it++)
                 {
                     unsigned int pid = it->pid;
@@ -877,6 +1251,8 @@ namespace WPEFramework
                             LOGERR("Failed to determine memory usage for %u", pid);
                         }
 
+                        it->memoryMB = memoryUsed;
+
                         if (memoryUsed >= it->memoryThresholdsMB)
                         {
                             if (0 == it->memExceeded)
@@ -942,6 +1318,8 @@ namespace WPEFramework
                                     percents = 100 * ( usage - it->cpuUsage) / (totalCpuUsage - m_monitorParams->totalCpuUsage);
                                 }
 
+                                it->cpuPercent = percents;
+
                                 if (percents >= it->cpuThresholdPercent)
                                 {
                                     if (AppConfig::STATE_NORMAL == it->state)
@@ -1022,6 +1400,9 @@ namespace WPEFramework
 
                         it->cpuUsage = usage;
                     }
+
+                    if ((memCheck || cpuCheck) && it->history)
+                        it->history->add(now, it->memoryMB, it->cpuPercent);
                 }
 
                 if (memCheck)
@@ -1063,6 +1444,20 @@ namespace WPEFramework
             sendNotify(ACTIVITY_MONITOR_EVT_ON_CPU_THRESHOLD, result);
         }
 
+        void ActivityMonitor::onPressure(const PressureMonitor::Trigger& trigger, const PressureMonitor::Reading& reading)
+        {
+            JsonObject result;
+            result["resource"] = trigger.resource;
+            result["type"] = trigger.type;
+            if (!trigger.cgroup.empty())
+                result["cgroup"] = trigger.cgroup;
+            if (trigger.pid > 0)
+                result["appPid"] = trigger.pid;
+            pressureResponse(reading, result);
+
+            sendNotify(ACTIVITY_MONITOR_EVT_ON_PRESSURE, result);
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
 
@@ -22,17 +22,22 @@
 #include <condition_variable>
 #include <thread>
 #include <mutex>
+#include <map>
+#include <memory>
 
 #include "Module.h"
 #include "utils.h"
 
 #include "AbstractPlugin.h"
 
+#include "PressureMonitor.h"
+
 namespace WPEFramework {
 
     namespace Plugin {
 
         struct MonitorParams;
+        struct MonitorHistory;
 
 		// This is a server for a JSONRPC communication channel.
 		// For a plugin to be capable to handle JSONRPC, inherit from PluginHost::JSONRPC.
@@ -58,11 +63,16 @@ namespace WPEFramework {
             uint32_t getAllMemoryUsage(const JsonObject& parameters, JsonObject& response);
             uint32_t enableMonitoring(const JsonObject& parameters, JsonObject& response);
             uint32_t disableMonitoring(const JsonObject& parameters, JsonObject& response);
+            uint32_t getHistory(const JsonObject& parameters, JsonObject& response);
+            uint32_t enablePressureMonitoring(const JsonObject& parameters, JsonObject& response);
+            uint32_t disablePressureMonitoring(const JsonObject& parameters, JsonObject& response);
+            uint32_t getPressure(const JsonObject& parameters, JsonObject& response);
             //End methods
 
             //Begin events
             void onMemoryThresholdOccurred(const JsonObject& result);
             void onCPUThresholdOccurred(const JsonObject& result);
+            void onPressure(const PressureMonitor::Trigger& trigger, const PressureMonitor::Reading& reading);
             //End events
 
         public:
@@ -84,6 +94,11 @@ namespace WPEFramework {
 
             MonitorParams *m_monitorParams;
             bool m_stopMonitoring;
+
+            std::mutex m_historyMutex;
+            std::map <unsigned int, std::shared_ptr<MonitorHistory>> m_history;
+
+            PressureMonitor m_pressureMonitor;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
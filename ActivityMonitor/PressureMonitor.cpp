@@ -0,0 +1,265 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "PressureMonitor.h"
+
+#include "utils.h"
+
+#define PRESSURE_SYSTEM_PATH "/proc/pressure/"
+#define PRESSURE_CGROUP_ROOT "/sys/fs/cgroup"
+
+// Limits of the kernel for a trigger window
+#define PRESSURE_MIN_WINDOW_MS 500
+#define PRESSURE_MAX_WINDOW_MS 10000
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        PressureMonitor::PressureMonitor()
+        : m_fdStop(-1)
+        {
+        }
+
+        PressureMonitor::~PressureMonitor()
+        {
+            stop();
+        }
+
+        bool PressureMonitor::isSupported()
+        {
+            return 0 == access(PRESSURE_SYSTEM_PATH "memory", R_OK);
+        }
+
+        std::string PressureMonitor::path(const std::string &resource, const std::string &cgroup, unsigned int pid)
+        {
+            std::string group = cgroup;
+
+            if (pid > 0)
+            {
+                // cgroup v2: "0::/path"
+                std::ifstream file("/proc/" + std::to_string(pid) + "/cgroup");
+                std::string line;
+                group.clear();
+                while (std::getline(file, line))
+                {
+                    if (0 == line.compare(0, 3, "0::"))
+                    {
+                        group = line.substr(3);
+                        break;
+                    }
+                }
+                if (group.empty())
+                    return std::string();
+            }
+
+            // The root cgroup has no pressure files, it is the whole system
+            if (group.empty() || group == "/" || group == PRESSURE_CGROUP_ROOT || group == PRESSURE_CGROUP_ROOT "/")
+                return PRESSURE_SYSTEM_PATH + resource;
+
+            if (0 != group.compare(0, strlen(PRESSURE_CGROUP_ROOT), PRESSURE_CGROUP_ROOT))
+                group = PRESSURE_CGROUP_ROOT + std::string(group[0] == '/' ? "" : "/") + group;
+            if (group[group.size() - 1] != '/')
+                group += "/";
+
+            return group + resource + ".pressure";
+        }
+
+        // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        // full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        bool PressureMonitor::read(const std::string &path, Reading &reading)
+        {
+            memset(&reading, 0, sizeof(reading));
+
+            FILE *file = fopen(path.c_str(), "r");
+            if (!file)
+                return false;
+
+            char type[8];
+            Averages averages;
+            while (5 == fscanf(file, "%7s avg10=%lf avg60=%lf avg300=%lf total=%llu", type, &averages.avg10, &averages.avg60, &averages.avg300, &averages.total))
+            {
+                averages.valid = true;
+                if (0 == strcmp(type, "some"))
+                    reading.some = averages;
+                else if (0 == strcmp(type, "full"))
+                    reading.full = averages;
+            }
+            fclose(file);
+
+            return reading.some.valid;
+        }
+
+        bool PressureMonitor::start(const std::vector<Trigger> &triggers, const Callback &callback, std::string &error)
+        {
+            stop();
+
+            std::vector<std::string> paths;
+            std::vector<int> fds;
+            for (const Trigger &trigger : triggers)
+            {
+                std::string name = trigger.resource + " " + trigger.type + (trigger.cgroup.empty() ? "" : " in " + trigger.cgroup) +
+                    (trigger.pid > 0 ? " of " + std::to_string(trigger.pid) : "");
+
+                if ((trigger.type != "some" && trigger.type != "full") ||
+                    trigger.windowMs < PRESSURE_MIN_WINDOW_MS || trigger.windowMs > PRESSURE_MAX_WINDOW_MS ||
+                    0 == trigger.stallMs || trigger.stallMs >= trigger.windowMs)
+                {
+                    error = name + ": type is some or full, windowMs 500 to 10000, stallMs below windowMs";
+                    break;
+                }
+
+                std::string file = path(trigger.resource, trigger.cgroup, trigger.pid);
+                int fd = file.empty() ? -1 : open(file.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+                if (fd < 0)
+                {
+                    error = name + ": " + (file.empty() ? std::string("no cgroup") : file + ": " + strerror(errno));
+                    break;
+                }
+
+                // The trigger lives as long as the file stays open
+                std::string spec = trigger.type + " " + std::to_string(trigger.stallMs * 1000) + " " + std::to_string(trigger.windowMs * 1000);
+                if (write(fd, spec.c_str(), spec.size() + 1) < 0)
+                {
+                    // Without CAP_SYS_RESOURCE the kernel only takes windows that are a multiple of 2 s
+                    error = name + ": " + strerror(errno) + (errno == EINVAL && trigger.windowMs % 2000 ? ", windowMs a multiple of 2000 for an unprivileged process" : "");
+                    close(fd);
+                    break;
+                }
+
+                paths.push_back(file);
+                fds.push_back(fd);
+            }
+
+            if (fds.size() != triggers.size() || triggers.empty())
+            {
+                for (int fd : fds)
+                    close(fd);
+                if (triggers.empty())
+                    error = "no triggers";
+                LOGERR("Pressure triggers not set: %s", error.c_str());
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_fdStop = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_fdStop < 0)
+            {
+                error = strerror(errno);
+                for (int fd : fds)
+                    close(fd);
+                return false;
+            }
+
+            m_triggers = triggers;
+            m_paths = paths;
+            m_fds = fds;
+            m_callback = callback;
+            m_thread = std::thread(&PressureMonitor::run, this);
+
+            LOGINFO("%zu pressure triggers set", triggers.size());
+            return true;
+        }
+
+        void PressureMonitor::stop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_thread.joinable())
+            {
+                uint64_t value = 1;
+                if (write(m_fdStop, &value, sizeof(value)) != sizeof(value))
+                    LOGWARN("Failed to signal the pressure monitor: %s", strerror(errno));
+                lock.unlock();
+                m_thread.join();
+                lock.lock();
+            }
+            closeAll();
+        }
+
+        // Caller holds m_mutex
+        void PressureMonitor::closeAll()
+        {
+            for (int fd : m_fds)
+                close(fd);
+            m_fds.clear();
+            m_paths.clear();
+            m_triggers.clear();
+
+            if (m_fdStop >= 0)
+            {
+                close(m_fdStop);
+                m_fdStop = -1;
+            }
+        }
+
+        void PressureMonitor::run()
+        {
+            // Set before the thread started, not changed until it is joined
+            std::vector<struct pollfd> fds(m_fds.size() + 1);
+            for (size_t n = 0; n < m_fds.size(); n++)
+            {
+                fds[n].fd = m_fds[n];
+                fds[n].events = POLLPRI;
+            }
+            fds.back().fd = m_fdStop;
+            fds.back().events = POLLIN;
+
+            while (true)
+            {
+                if (poll(fds.data(), fds.size(), -1) < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    LOGERR("Pressure monitor poll failed: %s", strerror(errno));
+                    break;
+                }
+
+                if (fds.back().revents)
+                    break;
+
+                for (size_t n = 0; n < m_fds.size(); n++)
+                {
+                    if (fds[n].revents & POLLERR)
+                    {
+                        // The cgroup is gone, its trigger with it
+                        LOGWARN("Pressure trigger on %s removed", m_paths[n].c_str());
+                        fds[n].fd = -1;
+                    }
+                    else if (fds[n].revents & POLLPRI)
+                    {
+                        Reading reading;
+                        read(m_paths[n], reading);
+                        if (m_callback)
+                            m_callback(m_triggers[n], reading);
+                    }
+                }
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
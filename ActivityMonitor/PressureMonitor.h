@@ -0,0 +1,95 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Pressure stall information (PSI) triggers: the kernel wakes the monitor when tasks stalled on
+        // memory, CPU or IO for more than stallMs within windowMs, system wide (/proc/pressure/<resource>)
+        // or in a cgroup (<cgroup>/<resource>.pressure). Nothing is sampled, the thread sleeps in poll
+        // until a trigger fires, and the kernel fires a trigger at most once per window.
+        class PressureMonitor
+        {
+        public:
+            struct Trigger
+            {
+                std::string resource;       // memory, cpu or io
+                std::string type;           // some (at least one task stalled) or full (all of them)
+                unsigned int stallMs;
+                unsigned int windowMs;
+                std::string cgroup;         // cgroup v2 path, empty for the whole system
+                unsigned int pid;           // the cgroup is the one of this process, if set
+            };
+
+            struct Averages
+            {
+                double avg10;               // % of the time stalled over 10 s, 60 s and 300 s
+                double avg60;
+                double avg300;
+                unsigned long long total;   // us stalled since boot
+                bool valid;
+            };
+
+            struct Reading
+            {
+                Averages some;
+                Averages full;
+            };
+
+            // On the monitor thread
+            typedef std::function<void(const Trigger &trigger, const Reading &reading)> Callback;
+
+            PressureMonitor();
+            ~PressureMonitor();
+            PressureMonitor(const PressureMonitor&) = delete;
+            PressureMonitor& operator=(const PressureMonitor&) = delete;
+
+            // Replaces the triggers of a previous start, error says which trigger the kernel refused
+            bool start(const std::vector<Trigger> &triggers, const Callback &callback, std::string &error);
+            void stop();
+
+            static bool isSupported();
+            // Path of the pressure file, resolves the cgroup of the pid
+            static std::string path(const std::string &resource, const std::string &cgroup, unsigned int pid);
+            static bool read(const std::string &path, Reading &reading);
+
+        private:
+            void run();
+            void closeAll();
+
+            std::mutex m_mutex;
+            std::thread m_thread;
+            std::vector<Trigger> m_triggers;
+            std::vector<std::string> m_paths;
+            std::vector<int> m_fds;
+            int m_fdStop;
+            Callback m_callback;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
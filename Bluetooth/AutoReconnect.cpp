@@ -0,0 +1,226 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "AutoReconnect.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include "Module.h"
+#include "utils.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        AutoReconnect::AutoReconnect(const Connect& connect)
+            : m_connect(connect)
+            , m_loaded(false)
+            , m_stopping(false)
+            , m_runStartMs(0)
+            , m_next(0)
+        {
+        }
+
+        AutoReconnect::~AutoReconnect()
+        {
+            stop();
+        }
+
+        void AutoReconnect::start(const std::string& reason, const std::vector<Device>& disconnected)
+        {
+            std::lock_guard<std::mutex> run(m_runLock);
+            stop();
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_loaded)
+                load();
+
+            m_stopping = false;
+            m_reason = reason;
+            m_runStartMs = nowMs();
+            m_attempts.clear();
+            m_next = 0;
+
+            for (const Device& device : disconnected)
+            {
+                if (m_lastUsed.find(device.deviceID) == m_lastUsed.end())
+                    continue;
+
+                Attempt attempt;
+                attempt.device = device;
+                attempt.result = "pending";
+                attempt.startMs = 0;
+                attempt.requestMs = 0;
+                attempt.connectedMs = 0;
+                m_attempts.push_back(attempt);
+            }
+            std::stable_sort(m_attempts.begin(), m_attempts.end(), [this](const Attempt& a, const Attempt& b) {
+                return m_lastUsed[a.device.deviceID] > m_lastUsed[b.device.deviceID];
+            });
+
+            LOGINFO("auto reconnect on %s: %zu of %zu disconnected paired devices", reason.c_str(), m_attempts.size(), disconnected.size());
+
+            size_t workers = std::min(m_attempts.size(), (size_t) BLUETOOTH_AUTO_RECONNECT_PARALLEL);
+            for (size_t i = 0; i < workers; i++)
+                m_workers.push_back(std::thread(&AutoReconnect::work, this));
+        }
+
+        void AutoReconnect::stop()
+        {
+            std::vector<std::thread> workers;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stopping = true;
+                workers.swap(m_workers);
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+        }
+
+        void AutoReconnect::connected(long long int deviceID)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_loaded)
+                load();
+
+            m_lastUsed[deviceID] = time(nullptr);
+            save();
+
+            for (Attempt& attempt : m_attempts)
+            {
+                if (attempt.device.deviceID != deviceID || attempt.result != "requested")
+                    continue;
+
+                attempt.result = "connected";
+                attempt.connectedMs = nowMs() - m_runStartMs;
+                LOGINFO("auto reconnect: %s connected %lld ms after the start, %lld ms after its request",
+                    attempt.device.name.c_str(), (long long) attempt.connectedMs, (long long) (attempt.connectedMs - attempt.startMs));
+            }
+        }
+
+        void AutoReconnect::forget(long long int deviceID)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_loaded)
+                load();
+
+            if (m_lastUsed.erase(deviceID) > 0)
+                save();
+        }
+
+        std::string AutoReconnect::status() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            JsonObject status;
+            JsonArray devices;
+            int64_t totalMs = 0;
+            for (const Attempt& attempt : m_attempts)
+            {
+                JsonObject device;
+                device["deviceID"] = std::to_string(attempt.device.deviceID);
+                device["name"] = attempt.device.name;
+                device["result"] = attempt.result;
+                device["startMs"] = attempt.startMs;
+                device["requestMs"] = attempt.requestMs;
+                if (attempt.result == "connected")
+                {
+                    device["connectedMs"] = attempt.connectedMs;
+                    totalMs = std::max(totalMs, attempt.connectedMs);
+                }
+                devices.Add(device);
+            }
+            status["reason"] = m_reason;
+            status["totalMs"] = totalMs;
+            status["devices"] = devices;
+
+            std::string json;
+            status.ToString(json);
+            return json;
+        }
+
+        void AutoReconnect::work()
+        {
+            for (;;)
+            {
+                size_t index;
+                Device device;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (m_stopping || m_next >= m_attempts.size())
+                        return;
+
+                    index = m_next++;
+                    m_attempts[index].result = "requested";
+                    m_attempts[index].startMs = nowMs() - m_runStartMs;
+                    device = m_attempts[index].device;
+                }
+
+                bool success = m_connect(device);
+
+                std::lock_guard<std::mutex> lock(m_lock);
+                Attempt& attempt = m_attempts[index];
+                attempt.requestMs = nowMs() - m_runStartMs - attempt.startMs;
+                if (!success && attempt.result != "connected")
+                {
+                    attempt.result = "failed";
+                    LOGWARN("auto reconnect: %s failed after %lld ms", device.name.c_str(), (long long) attempt.requestMs);
+                }
+            }
+        }
+
+        // Caller holds m_lock
+        void AutoReconnect::load()
+        {
+            std::ifstream file(BLUETOOTH_AUTO_RECONNECT_FILE);
+            long long int deviceID;
+            long long int lastUsed;
+            while (file >> deviceID >> lastUsed)
+                m_lastUsed[deviceID] = lastUsed;
+            m_loaded = true;
+        }
+
+        // Caller holds m_lock
+        void AutoReconnect::save() const
+        {
+            const std::string temporary = std::string(BLUETOOTH_AUTO_RECONNECT_FILE) + ".tmp";
+            std::ofstream file(temporary, std::ios::trunc);
+            for (const std::pair<const long long int, int64_t>& device : m_lastUsed)
+                file << device.first << ' ' << device.second << '\n';
+            file.close();
+
+            if (file.fail() || rename(temporary.c_str(), BLUETOOTH_AUTO_RECONNECT_FILE) != 0)
+            {
+                LOGWARN("could not store the devices to reconnect in %s", BLUETOOTH_AUTO_RECONNECT_FILE);
+                remove(temporary.c_str());
+            }
+        }
+
+        int64_t AutoReconnect::nowMs()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,108 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BLUETOOTH_AUTO_RECONNECT_FILE "/opt/persistent/bluetoothAutoReconnect"
+
+/* Connects in flight at once. The controller pages one device at a time, the profile set-up that follows overlaps */
+#define BLUETOOTH_AUTO_RECONNECT_PARALLEL 3
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        /*
+         * Reconnects the paired devices that were connected when the box was left, at boot and on resume.
+         *
+         * A device is remembered, with the time it was last connected, when it connects and forgotten when
+         * it is disconnected on request or unpaired, so a device that dropped off because of standby or range
+         * comes back and one the user disconnected does not. start() connects the remembered devices among
+         * the paired ones, last used first, BLUETOOTH_AUTO_RECONNECT_PARALLEL at a time instead of one after
+         * the other, and keeps the timing of every device for status().
+         */
+        class AutoReconnect
+        {
+        public:
+            struct Device
+            {
+                long long int deviceID;
+                std::string name;
+                std::string deviceType;
+            };
+
+            // Same as setDeviceConnection CONNECT, true if the request succeeded
+            typedef std::function<bool(const Device& device)> Connect;
+
+            explicit AutoReconnect(const Connect& connect);
+            ~AutoReconnect();
+            AutoReconnect(const AutoReconnect&) = delete;
+            AutoReconnect& operator=(const AutoReconnect&) = delete;
+
+            // Reconnects the remembered ones of the paired devices that are not connected, ends the previous run first
+            void start(const std::string& reason, const std::vector<Device>& disconnected);
+            // Drops what is not started yet and waits for the connects in flight
+            void stop();
+
+            void connected(long long int deviceID);
+            void forget(long long int deviceID);
+
+            // JSON of the last run: reason, time to the last connection and the timing per device
+            std::string status() const;
+
+        private:
+            struct Attempt
+            {
+                Device device;
+                std::string result;                 // pending, requested, connected or failed
+                int64_t startMs;                    // from the start of the run
+                int64_t requestMs;
+                int64_t connectedMs;
+            };
+
+            void work();
+            void load();
+            void save() const;
+            static int64_t nowMs();
+
+            Connect m_connect;
+            std::mutex m_runLock;               // one start at a time
+            mutable std::mutex m_lock;
+            std::map<long long int, int64_t> m_lastUsed;    // device, seconds since the epoch
+            bool m_loaded;
+            bool m_stopping;
+
+            std::string m_reason;
+            int64_t m_runStartMs;
+            std::vector<Attempt> m_attempts;    // last used first
+            size_t m_next;                      // next attempt to start
+            std::vector<std::thread> m_workers;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -20,8 +20,10 @@
 #include <fstream>
 
 #include "Bluetooth.h"
+#include "pwrMgr.h"
 
 #include <stdlib.h>
+#include <cmath>
 
 // IMPLEMENTATION NOTE
 //
@@ -31,6 +33,19 @@
 // with RDK naming schema  which, in turn, call to actual Bluetooth Manager functions. These "internal" methods are similar to what we had in Service Manager as public APIs.
 // For example, the exposed "startScan" method is mapped to "startScanWrapper()" and that one calls to "startDeviceDiscovery()" internally,
 // which finally calls to "BTRMGR_StartDeviceDiscovery()" in Bluetooth Manager.
+//
+// Bluetooth Manager reports a discovered device for every advertisement it sees. The plugin keeps the devices it has been told
+// about in m_devices, forwards onDiscoveredDevice only when something the client shows has changed (or once every
+// DISCOVERY_EVENT_INTERVAL_MS to keep the signal strength fresh), and answers getDiscoveredDevices / getPairedDevices from
+// there. Each list is read from Bluetooth Manager once after it may have changed without an event (discovery started or
+// completed, pairing changed) and events keep it current afterwards.
+//
+// At boot and when the box comes out of standby the devices that were connected before are reconnected by
+// m_autoReconnect, several at a time instead of one setDeviceConnection after another.
+
+static const int DISCOVERY_EVENT_INTERVAL_MS = 5000;
+static const double SIGNAL_STRENGTH_SMOOTHING = 0.25;   // weight of a new sample
+static const unsigned int LOW_LATENCY_DEVICE_DELAY_MS = 0;  // no buffering in the audio-out path beyond what the codec needs
 
 const short WPEFramework::Plugin::Bluetooth::API_VERSION_NUMBER_MAJOR = 1;  // corresponds to org.rdk.Bluetooth_5
 const short WPEFramework::Plugin::Bluetooth::API_VERSION_NUMBER_MINOR = 0;
@@ -135,6 +150,12 @@ namespace WPEFramework
         , m_apiVersionNumber(API_VERSION_NUMBER_MAJOR)
         , m_discoveryRunning(false)
         , m_discoveryTimer(this)
+        , m_discoveredValid(false)
+        , m_pairedValid(false)
+        , m_lowLatency(false)
+        , m_lowLatencyDevice(0)
+        , m_normalDelay(0)
+        , m_autoReconnect([this](const AutoReconnect::Device& device) { return setDeviceConnection(device.deviceID, ENABLE_CONNECT, device.deviceType); })
         {
             Bluetooth::_instance = this;
             registerMethod(METHOD_GET_API_VERSION_NUMBER, &Bluetooth::getApiVersionNumber, this);
@@ -177,8 +198,17 @@ namespace WPEFramework
         {
         }
 
+        const string Bluetooth::Initialize(PluginHost::IShell* /* service */)
+        {
+            InitializeIARM();
+            reconnectPairedDevices("boot");
+            return (string());
+        }
+
         void Bluetooth::Deinitialize(PluginHost::IShell* /* service */)
         {
+            DeinitializeIARM();
+            m_autoReconnect.stop();
             Bluetooth::_instance = nullptr;
 
             BTRMGR_Result_t rc = BTRMGR_UnRegisterFromCallbacks(Utils::IARM::NAME);
@@ -190,7 +220,62 @@ namespace WPEFramework
 
         string Bluetooth::Information() const
         {
-            return(string("{\"service\": \"") + SERVICE_NAME + string("\"}"));
+            return(string("{\"service\": \"") + SERVICE_NAME + string("\", \"autoReconnect\": ") + m_autoReconnect.status() + string("}"));
+        }
+
+        void Bluetooth::InitializeIARM()
+        {
+            if (Utils::IARM::isConnected())
+            {
+                IARM_Result_t res;
+                m_iarmEvents.start();
+                IARM_CHECK( m_iarmEvents.subscribe(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, powerModeChange) );
+            }
+        }
+
+        void Bluetooth::DeinitializeIARM()
+        {
+            /* Unsubscribes, then handles what is still queued */
+            m_iarmEvents.stop();
+        }
+
+        void Bluetooth::powerModeChange(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            if (strcmp(owner, IARM_BUS_PWRMGR_NAME) == 0 && eventId == IARM_BUS_PWRMGR_EVENT_MODECHANGED)
+            {
+                IARM_Bus_PWRMgr_EventData_t *param = (IARM_Bus_PWRMgr_EventData_t *)data;
+                LOGINFO("Event IARM_BUS_PWRMGR_EVENT_MODECHANGED: State Changed %d -- > %d",
+                        param->data.state.curState, param->data.state.newState);
+                if (Bluetooth::_instance && param->data.state.curState != IARM_BUS_PWRMGR_POWERSTATE_ON &&
+                    param->data.state.newState == IARM_BUS_PWRMGR_POWERSTATE_ON)
+                    Bluetooth::_instance->reconnectPairedDevices("resume");
+            }
+        }
+
+        void Bluetooth::reconnectPairedDevices(const string &reason)
+        {
+            string status;
+            getStatusSupport(status);
+            if (status != STATUS_AVAILABLE)
+            {
+                LOGINFO("no auto reconnect on %s, Bluetooth is %s", C_STR(reason), C_STR(status));
+                return;
+            }
+
+            // Connections may have dropped in standby without an event
+            invalidateDevices(false, true);
+            getPairedDevices();
+
+            std::vector<AutoReconnect::Device> disconnected;
+            {
+                std::lock_guard<std::mutex> lock(m_devicesMutex);
+                for (const auto& device : m_devices)
+                {
+                    if (device.second.paired && !device.second.connected)
+                        disconnected.push_back({ device.first, device.second.name, device.second.deviceType });
+                }
+            }
+            m_autoReconnect.start(reason, disconnected);
         }
 
         /// Internal methods begin
@@ -352,28 +437,51 @@ namespace WPEFramework
         JsonArray Bluetooth::getDiscoveredDevices()
         {
             JsonArray deviceArray;
-            BTRMGR_DiscoveredDevicesList_t discoveredDevices;
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
 
-            memset (&discoveredDevices, 0, sizeof(discoveredDevices));
-            BTRMGR_Result_t rc = BTRMGR_GetDiscoveredDevices(0, &discoveredDevices);
-            if (BTRMGR_RESULT_SUCCESS != rc)
+            if (!m_discoveredValid)
             {
-                LOGERR("Failed to get the discovered devices");
-            }
-            else
-            {
-                int i = 0;
-                JsonObject deviceDetails;
+                BTRMGR_DiscoveredDevicesList_t discoveredDevices;
+
+                memset (&discoveredDevices, 0, sizeof(discoveredDevices));
+                BTRMGR_Result_t rc = BTRMGR_GetDiscoveredDevices(0, &discoveredDevices);
+                if (BTRMGR_RESULT_SUCCESS != rc)
+                {
+                    LOGERR("Failed to get the discovered devices");
+                    return deviceArray;
+                }
+
                 LOGINFO ("Success....   Discovered %d Devices", discoveredDevices.m_numOfDevices);
-                for (; i < discoveredDevices.m_numOfDevices; i++)
+                for (auto& device : m_devices)
+                    device.second.discovered = false;
+                for (int i = 0; i < discoveredDevices.m_numOfDevices; i++)
                 {
-                    deviceDetails["deviceID"] = std::to_string(discoveredDevices.m_deviceProperty[i].m_deviceHandle);
-                    deviceDetails["name"] = string(discoveredDevices.m_deviceProperty[i].m_name);
-                    deviceDetails["deviceType"] = string(BTRMGR_GetDeviceTypeAsString(discoveredDevices.m_deviceProperty[i].m_deviceType));
-                    deviceDetails["connected"] = discoveredDevices.m_deviceProperty[i].m_isConnected?true:false;
-                    deviceDetails["paired"] = discoveredDevices.m_deviceProperty[i].m_isPairedDevice?true:false;
-                    deviceArray.Add(deviceDetails);
+                    DeviceEntry& entry = m_devices[discoveredDevices.m_deviceProperty[i].m_deviceHandle];
+                    entry.name = string(discoveredDevices.m_deviceProperty[i].m_name);
+                    entry.deviceType = string(BTRMGR_GetDeviceTypeAsString(discoveredDevices.m_deviceProperty[i].m_deviceType));
+                    entry.connected = discoveredDevices.m_deviceProperty[i].m_isConnected?true:false;
+                    entry.paired = discoveredDevices.m_deviceProperty[i].m_isPairedDevice?true:false;
+                    entry.discovered = true;
                 }
+                m_discoveredValid = true;
+            }
+
+            JsonObject deviceDetails;
+            for (const auto& device : m_devices)
+            {
+                if (!device.second.discovered)
+                    continue;
+
+                deviceDetails["deviceID"] = std::to_string(device.first);
+                deviceDetails["name"] = device.second.name;
+                deviceDetails["deviceType"] = device.second.deviceType;
+                deviceDetails["connected"] = device.second.connected;
+                deviceDetails["paired"] = device.second.paired;
+                if (device.second.signalSamples > 0)
+                    deviceDetails["signalStrength"] = std::to_string(std::lround(device.second.signalStrength));
+                else
+                    deviceDetails.Remove("signalStrength");
+                deviceArray.Add(deviceDetails);
             }
             return deviceArray;
         }
@@ -381,31 +489,108 @@ namespace WPEFramework
         JsonArray Bluetooth::getPairedDevices()
         {
             JsonArray deviceArray;
-            BTRMGR_PairedDevicesList_t pairedDevices;
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
 
-            memset (&pairedDevices, 0, sizeof(pairedDevices));
-            BTRMGR_Result_t rc = BTRMGR_GetPairedDevices(0, &pairedDevices);
-            if (BTRMGR_RESULT_SUCCESS != rc)
-            {
-                LOGERR("Failed to get the paired devices");
-            }
-            else
+            if (!m_pairedValid)
             {
-                int i = 0;
-                JsonObject deviceDetails;
+                BTRMGR_PairedDevicesList_t pairedDevices;
+
+                memset (&pairedDevices, 0, sizeof(pairedDevices));
+                BTRMGR_Result_t rc = BTRMGR_GetPairedDevices(0, &pairedDevices);
+                if (BTRMGR_RESULT_SUCCESS != rc)
+                {
+                    LOGERR("Failed to get the paired devices");
+                    return deviceArray;
+                }
+
                 LOGINFO ("Success....   Paired %d Devices", pairedDevices.m_numOfDevices);
-                for (; i < pairedDevices.m_numOfDevices; i++)
+                for (auto& device : m_devices)
+                    device.second.paired = false;
+                for (int i = 0; i < pairedDevices.m_numOfDevices; i++)
                 {
-                    deviceDetails["deviceID"] = std::to_string(pairedDevices.m_deviceProperty[i].m_deviceHandle);
-                    deviceDetails["name"] = string(pairedDevices.m_deviceProperty[i].m_name);
-                    deviceDetails["deviceType"] = string(BTRMGR_GetDeviceTypeAsString(pairedDevices.m_deviceProperty[i].m_deviceType));
-                    deviceDetails["connected"] = pairedDevices.m_deviceProperty[i].m_isConnected?true:false;
-                    deviceArray.Add(deviceDetails);
+                    DeviceEntry& entry = m_devices[pairedDevices.m_deviceProperty[i].m_deviceHandle];
+                    entry.name = string(pairedDevices.m_deviceProperty[i].m_name);
+                    entry.deviceType = string(BTRMGR_GetDeviceTypeAsString(pairedDevices.m_deviceProperty[i].m_deviceType));
+                    entry.connected = pairedDevices.m_deviceProperty[i].m_isConnected?true:false;
+                    entry.paired = true;
                 }
+                m_pairedValid = true;
+            }
+
+            JsonObject deviceDetails;
+            for (const auto& device : m_devices)
+            {
+                if (!device.second.paired)
+                    continue;
+
+                deviceDetails["deviceID"] = std::to_string(device.first);
+                deviceDetails["name"] = device.second.name;
+                deviceDetails["deviceType"] = device.second.deviceType;
+                deviceDetails["connected"] = device.second.connected;
+                deviceArray.Add(deviceDetails);
             }
             return deviceArray;
         }
 
+        // Records a discovery update, returns false when it is not worth an onDiscoveredDevice event.
+        bool Bluetooth::updateDiscoveredDevice(const BTRMGR_DiscoveredDevices_t &device, int &signalStrength)
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            auto now = std::chrono::steady_clock::now();
+            DeviceEntry& entry = m_devices[device.m_deviceHandle];
+
+            string name = string(device.m_name);
+            bool discovered = device.m_isDiscovered ? true : false;
+            bool paired = device.m_isPairedDevice ? true : false;
+            bool changed = !entry.notifiedSeen ||
+                entry.notifiedDiscovered != discovered || entry.notifiedPaired != paired || entry.name != name;
+
+            entry.name = name;
+            entry.deviceType = string(BTRMGR_GetDeviceTypeAsString(device.m_deviceType));
+            entry.connected = device.m_isConnected ? true : false;
+            entry.paired = paired;
+            entry.discovered = discovered;
+            entry.lastSeen = now;
+            if (discovered)
+            {
+                if (entry.signalSamples == 0)
+                    entry.signalStrength = device.m_signalLevel;
+                else
+                    entry.signalStrength += SIGNAL_STRENGTH_SMOOTHING * (device.m_signalLevel - entry.signalStrength);
+                entry.signalSamples++;
+            }
+            signalStrength = (int) std::lround(entry.signalStrength);
+
+            if (!changed && now - entry.lastNotified < std::chrono::milliseconds(DISCOVERY_EVENT_INTERVAL_MS))
+                return false;
+
+            entry.lastNotified = now;
+            entry.notifiedSeen = true;
+            entry.notifiedDiscovered = discovered;
+            entry.notifiedPaired = paired;
+            return true;
+        }
+
+        // Makes the next list getter read its list from Bluetooth Manager again.
+        void Bluetooth::invalidateDevices(bool discovered, bool paired)
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            if (discovered)
+            {
+                // A new discovery cycle reports the devices around again, only the paired ones are worth keeping
+                for (auto device = m_devices.begin(); device != m_devices.end(); )
+                {
+                    if (device->second.paired)
+                        ++device;
+                    else
+                        device = m_devices.erase(device);
+                }
+                m_discoveredValid = false;
+            }
+            if (paired)
+                m_pairedValid = false;
+        }
+
         JsonArray Bluetooth::getConnectedDevices()
         {
             JsonArray deviceArray;
@@ -478,11 +663,13 @@ namespace WPEFramework
 
             if (BTRMGR_RESULT_SUCCESS != rc)
                 LOGERR("Failed to do setDeviceConnection");
+            else if (Utils::String::equal(enable, "DISCONNECT"))
+                m_autoReconnect.forget(deviceID);   // left on purpose, not to be reconnected
 
             return BTRMGR_RESULT_SUCCESS == rc;
         }
 
-        bool Bluetooth::setAudioStream(long long int deviceID, const string &audioStreamName)
+        bool Bluetooth::setAudioStream(long long int deviceID, const string &audioStreamName, const string &latencyMode)
         {
             BTRMGR_Result_t rc = BTRMGR_RESULT_SUCCESS;
             BTRMGR_StreamOut_Type_t streamOutPref = BTRMGR_STREAM_PRIMARY;
@@ -496,8 +683,66 @@ namespace WPEFramework
             if (BTRMGR_RESULT_SUCCESS != rc)
             {
                 LOGERR("Failed to do setAudioStream");
+                return false;
             }
-            return BTRMGR_RESULT_SUCCESS == rc;
+
+            if (Utils::String::equal(latencyMode, "LOW_LATENCY"))
+                return setAudioLatency(deviceID, true);
+            else if (Utils::String::equal(latencyMode, "NORMAL"))
+                return setAudioLatency(deviceID, false);
+            return true;
+        }
+
+        // Low latency drops the buffering Bluetooth Manager keeps in front of the audio-out device to
+        // LOW_LATENCY_DEVICE_DELAY_MS, normal restores the delay the device had before.
+        bool Bluetooth::setAudioLatency(long long int deviceID, bool lowLatency)
+        {
+            std::lock_guard<std::mutex> lock(m_latencyMutex);
+#ifdef BTMGR_DEVICE_DELAY
+            BTRMGR_Result_t rc = BTRMGR_RESULT_SUCCESS;
+            BTRMgrDeviceHandle deviceHandle = (BTRMgrDeviceHandle) deviceID;
+
+            if (lowLatency)
+            {
+                unsigned int delay = 0;
+                unsigned int msInBuffer = 0;
+
+                if (m_lowLatency && m_lowLatencyDevice != deviceID)
+                    BTRMGR_SetDeviceDelay(0, (BTRMgrDeviceHandle) m_lowLatencyDevice, BTRMGR_DEVICE_OP_TYPE_AUDIO_OUTPUT, m_normalDelay);
+
+                rc = BTRMGR_GetDeviceDelay(0, deviceHandle, BTRMGR_DEVICE_OP_TYPE_AUDIO_OUTPUT, &delay, &msInBuffer);
+                if (BTRMGR_RESULT_SUCCESS == rc)
+                {
+                    if (!m_lowLatency || m_lowLatencyDevice != deviceID || delay != LOW_LATENCY_DEVICE_DELAY_MS)
+                        m_normalDelay = delay;
+                    rc = BTRMGR_SetDeviceDelay(0, deviceHandle, BTRMGR_DEVICE_OP_TYPE_AUDIO_OUTPUT, LOW_LATENCY_DEVICE_DELAY_MS);
+                }
+            }
+            else if (m_lowLatency && m_lowLatencyDevice == deviceID)
+            {
+                rc = BTRMGR_SetDeviceDelay(0, deviceHandle, BTRMGR_DEVICE_OP_TYPE_AUDIO_OUTPUT, m_normalDelay);
+            }
+
+            if (BTRMGR_RESULT_SUCCESS != rc)
+            {
+                LOGERR("Failed to set the %s latency mode", lowLatency ? "low" : "normal");
+                return false;
+            }
+
+            if (lowLatency || m_lowLatencyDevice == deviceID)
+            {
+                m_lowLatency = lowLatency;
+                m_lowLatencyDevice = deviceID;
+            }
+            return true;
+#else
+            if (lowLatency)
+            {
+                LOGERR("Bluetooth Manager does not support setting the device delay, low latency mode unavailable");
+                return false;
+            }
+            return true;
+#endif
         }
 
         bool Bluetooth::setDevicePairing(long long int deviceID, bool pair)
@@ -516,6 +761,8 @@ namespace WPEFramework
                 LOGERR("Failed to do %s ", (pair ? "Pair" : "Unpair"));
             } else {
                 LOGINFO("Successfully done %s ", (pair ? "Pair" : "Unpair"));
+                if (!pair)
+                    m_autoReconnect.forget(deviceID);
             }
             return BTRMGR_RESULT_SUCCESS == rc;
         }
@@ -821,6 +1068,17 @@ namespace WPEFramework
                 mediaTrackInfo["ui32TrackNumber"] = std::to_string(m_mediaTrackInfo.ui32TrackNumber);
                 mediaTrackInfo["ui32NumberOfTracks"] = std::to_string(m_mediaTrackInfo.ui32NumberOfTracks);
             }
+
+            {
+                std::lock_guard<std::mutex> lock(m_latencyMutex);
+                mediaTrackInfo["latencyMode"] = (m_lowLatency && m_lowLatencyDevice == deviceID) ? "LOW_LATENCY" : "NORMAL";
+            }
+#ifdef BTMGR_DEVICE_DELAY
+            unsigned int delay = 0;
+            unsigned int msInBuffer = 0;
+            if (BTRMGR_RESULT_SUCCESS == BTRMGR_GetDeviceDelay(0, deviceHandle, BTRMGR_DEVICE_OP_TYPE_AUDIO_OUTPUT, &delay, &msInBuffer))
+                mediaTrackInfo["audioDelay"] = std::to_string(delay + msInBuffer);
+#endif
             return mediaTrackInfo;
         }
 
@@ -835,6 +1093,7 @@ namespace WPEFramework
                     LOGINFO ("Received %s Event from BTRMgr", C_STR(STATUS_DISCOVERY_COMPLETED));
                     params["newStatus"] = STATUS_DISCOVERY_COMPLETED;
                     eventId = EVT_STATUS_CHANGED;
+                    invalidateDevices(true, false);
 
                     // TODO: Stopping the discovery timer and resetting the flag should not be needed on Discovery completed.
                     //       But is it logical to expect DISCOVERY_COMPLETED, when Bluetooth Service has not asked BTRMgr to
@@ -856,6 +1115,7 @@ namespace WPEFramework
                     params["connected"] = eventMsg.m_discoveredDevice.m_isConnected ? true : false;
 
                     eventId = EVT_STATUS_CHANGED;
+                    invalidateDevices(false, true);
                     break;
 
                 case BTRMGR_EVENT_DEVICE_UNPAIRING_COMPLETE:
@@ -870,10 +1130,19 @@ namespace WPEFramework
                     params["connected"] = eventMsg.m_pairedDevice.m_isConnected ? true : false;
 
                     eventId = EVT_STATUS_CHANGED;
+                    invalidateDevices(false, true);
                     break;
 
                 case BTRMGR_EVENT_DEVICE_CONNECTION_COMPLETE:
                 case BTRMGR_EVENT_DEVICE_DISCONNECT_COMPLETE: /* Allow only AudioIn/Out & HID Connection Event propogation to XRE for now */
+                    {
+                        std::lock_guard<std::mutex> lock(m_devicesMutex);
+                        auto device = m_devices.find(eventMsg.m_pairedDevice.m_deviceHandle);
+                        if (device != m_devices.end())
+                            device->second.connected = eventMsg.m_pairedDevice.m_isConnected ? true : false;
+                    }
+                    if (eventMsg.m_eventType == BTRMGR_EVENT_DEVICE_CONNECTION_COMPLETE && eventMsg.m_pairedDevice.m_isConnected)
+                        m_autoReconnect.connected(eventMsg.m_pairedDevice.m_deviceHandle);
                     if ((eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_WEARABLE_HEADSET)   ||
                         (eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_HANDSFREE)          ||
                         (eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_LOUDSPEAKER)        ||
@@ -886,6 +1155,17 @@ namespace WPEFramework
                         (eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_HID)                ){
 
                         LOGINFO ("Received %s Event from BTRMgr", C_STR(STATUS_CONNECTION_CHANGE));
+                        if (eventMsg.m_eventType == BTRMGR_EVENT_DEVICE_CONNECTION_COMPLETE && eventMsg.m_pairedDevice.m_isConnected)
+                        {
+                            bool lowLatency;
+                            {
+                                std::lock_guard<std::mutex> lock(m_latencyMutex);
+                                lowLatency = m_lowLatency && m_lowLatencyDevice == (long long int) eventMsg.m_pairedDevice.m_deviceHandle;
+                            }
+                            // Bluetooth Manager starts a reconnected device with its default delay
+                            if (lowLatency)
+                                setAudioLatency(eventMsg.m_pairedDevice.m_deviceHandle, true);
+                        }
                         params["newStatus"] = STATUS_CONNECTION_CHANGE;
                         params["deviceID"] = std::to_string(eventMsg.m_pairedDevice.m_deviceHandle);
                         params["name"] = string(eventMsg.m_pairedDevice.m_name);
@@ -903,6 +1183,7 @@ namespace WPEFramework
                     LOGINFO ("Received %s Event from BTRMgr", C_STR(STATUS_DISCOVERY_STARTED));
                     params["newStatus"] = STATUS_DISCOVERY_STARTED;
                     eventId = EVT_STATUS_CHANGED;
+                    invalidateDevices(true, false);
                     break;
 
                 case BTRMGR_EVENT_RECEIVED_EXTERNAL_PAIR_REQUEST:
@@ -1105,6 +1386,11 @@ namespace WPEFramework
                     break;
 
                 case BTRMGR_EVENT_DEVICE_DISCOVERY_UPDATE:
+                {
+                    int signalStrength = 0;
+                    if (!updateDiscoveredDevice(eventMsg.m_discoveredDevice, signalStrength))
+                        break;
+
                     params["deviceID"] = std::to_string(eventMsg.m_discoveredDevice.m_deviceHandle);
                     params["discoveryType"] = eventMsg.m_discoveredDevice.m_isDiscovered ? "DISCOVERED":"LOST";
                     params["name"] = string(eventMsg.m_discoveredDevice.m_name);
@@ -1112,9 +1398,11 @@ namespace WPEFramework
                     params["rawDeviceType"] = std::to_string(eventMsg.m_discoveredDevice.m_ui32DevClassBtSpec);
                     params["lastConnectedState"] = eventMsg.m_discoveredDevice.m_isLastConnectedDevice? true:false;
                     params["paired"] = eventMsg.m_discoveredDevice.m_isPairedDevice ? true:false;
+                    params["signalStrength"] = std::to_string(signalStrength);
 
                     eventId = EVT_DEVICE_DISCOVERY_UPDATE;
                     break;
+                }
 
                     // TODO: implement or delete these values from enum
                 case BTRMGR_EVENT_MAX:
@@ -1367,6 +1655,7 @@ namespace WPEFramework
             bool deviceIDDefined = false;
             string audioStreamName; //"PRIMARY" or "AUXILIARY"
             bool audioStreamNameDefined = false;
+            string latencyMode; //"NORMAL" or "LOW_LATENCY", unchanged if empty
             bool successFlag;
 
             if (parameters.HasLabel("deviceID"))
@@ -1381,10 +1670,14 @@ namespace WPEFramework
                 getStringParameter("audioStreamName", audioStreamName);
                 audioStreamNameDefined = true;
             }
+            if (parameters.HasLabel("latencyMode"))
+            {
+                getStringParameter("latencyMode", latencyMode);
+            }
             if (deviceIDDefined && audioStreamNameDefined)
             {
-                LOGINFO("Making a call with deviceID=%llu audioStreamName=%s", deviceID, audioStreamName.c_str());
-                successFlag = setAudioStream(deviceID, audioStreamName);
+                LOGINFO("Making a call with deviceID=%llu audioStreamName=%s latencyMode=%s", deviceID, audioStreamName.c_str(), latencyMode.c_str());
+                successFlag = setAudioStream(deviceID, audioStreamName, latencyMode);
             } else {
                 LOGERR("Please specify parameters. Example: \"params\": {\"deviceID\": \"271731989589742\", \"audioStreamName\": \"PRIMARY\"}");
                 successFlag = false;
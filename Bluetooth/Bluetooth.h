@@ -19,11 +19,16 @@
 
 #pragma once
 
+#include <chrono>
+#include <map>
+#include <mutex>
 #include <thread>
 
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "IarmEventQueue.h"
+#include "AutoReconnect.h"
 
 #include "btmgr.h" //TODO: can we move it to the module? Required by notifyEventWrapper()
 
@@ -112,7 +117,8 @@ namespace WPEFramework {
             JsonArray getPairedDevices();
             JsonArray getConnectedDevices();
             bool setDeviceConnection(long long int deviceID, const string &enable, const string &deviceType = "UNKNOWN DEVICE");
-            bool setAudioStream(long long int deviceID, const string &audioStreamName);
+            bool setAudioStream(long long int deviceID, const string &audioStreamName, const string &latencyMode);
+            bool setAudioLatency(long long int deviceID, bool lowLatency);
             bool setDevicePairing(long long int deviceID, bool pair);
             bool setBluetoothEnabled(const string &enabled);
             bool setBluetoothDiscoverable(bool enabled, int timeout);
@@ -125,6 +131,12 @@ namespace WPEFramework {
             bool setDeviceVolumeMuteProperties(long long int  deviceID, const string &deviceProfile, unsigned char ui8volume, unsigned char mute);
             JsonObject getDeviceVolumeMuteProperties(long long int  deviceID, const string &deviceProfile);
             BTRMGR_DeviceOperationType_t btmgrDeviceOperationTypeFromString(const string &deviceProfile);
+            bool updateDiscoveredDevice(const BTRMGR_DiscoveredDevices_t &device, int &signalStrength);
+            void invalidateDevices(bool discovered, bool paired);
+            void reconnectPairedDevices(const string &reason);
+            void InitializeIARM();
+            void DeinitializeIARM();
+            static void powerModeChange(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
 
 
         public:
@@ -174,6 +186,7 @@ namespace WPEFramework {
 
             Bluetooth();
             virtual ~Bluetooth();
+            virtual const string Initialize(PluginHost::IShell* service) override;
             virtual void Deinitialize(PluginHost::IShell* service) override;
             virtual string Information() const override;
 
@@ -222,6 +235,37 @@ namespace WPEFramework {
             Utils::ThreadRAII m_executionThread;
             bool m_discoveryRunning;
             DiscoveryTimer m_discoveryTimer;
+
+            // Devices as last reported by Bluetooth Manager, kept current from its events so that
+            // the list getters do not go through IARM and repeated discovery events can be dropped
+            struct DeviceEntry {
+                string name;
+                string deviceType;
+                bool connected = false;
+                bool paired = false;
+                bool discovered = false;
+                double signalStrength = 0;          // smoothed, valid when signalSamples > 0
+                int signalSamples = 0;
+                std::chrono::steady_clock::time_point lastSeen;
+                std::chrono::steady_clock::time_point lastNotified;
+                bool notifiedSeen = false;          // onDiscoveredDevice sent, the fields below are valid
+                bool notifiedDiscovered = false;    // discoveryType of the last onDiscoveredDevice
+                bool notifiedPaired = false;
+            };
+            std::map<long long int, DeviceEntry> m_devices;
+            std::mutex m_devicesMutex;
+            bool m_discoveredValid;                 // m_devices holds the discovered list of Bluetooth Manager
+            bool m_pairedValid;                     // m_devices holds the paired list
+
+            // Low-latency audio out: the device it was selected for and the delay to restore when it is left
+            std::mutex m_latencyMutex;
+            bool m_lowLatency;
+            long long int m_lowLatencyDevice;
+            unsigned int m_normalDelay;
+
+            // Reconnects the devices that were connected when the box was left, at boot and on resume
+            AutoReconnect m_autoReconnect;
+            IarmEventQueue m_iarmEvents;
             friend class DiscoveryTimer;
         };
 	} // Plugin
@@ -33,6 +33,7 @@
 #define COMPOSITEINPUT_METHOD_START_COMPOSITE_INPUT "startCompositeInput"
 #define COMPOSITEINPUT_METHOD_STOP_COMPOSITE_INPUT "stopCompositeInput"
 #define COMPOSITEINPUT_METHOD_SCALE_COMPOSITE_INPUT "setVideoRectangle"
+#define COMPOSITEINPUT_METHOD_GET_INPUT_SWITCH_STATISTICS "getInputSwitchStatistics"
 
 #define COMPOSITEINPUT_EVENT_ON_DEVICES_CHANGED "onDevicesChanged"
 #define COMPOSITEINPUT_EVENT_ON_SIGNAL_CHANGED "onSignalChanged"
@@ -48,6 +49,8 @@ namespace WPEFramework
 
         CompositeInput::CompositeInput()
         : AbstractPlugin()
+        , m_inputSource(std::bind(&CompositeInput::selectPort, this, std::placeholders::_1),
+                        [this](const InputSourceManager::Plane& plane) { return setVideoRectangle(plane.x, plane.y, plane.width, plane.height); })
         {
             CompositeInput::_instance = this;
 
@@ -57,6 +60,7 @@ namespace WPEFramework
             registerMethod(COMPOSITEINPUT_METHOD_START_COMPOSITE_INPUT, &CompositeInput::startCompositeInput, this);
             registerMethod(COMPOSITEINPUT_METHOD_STOP_COMPOSITE_INPUT, &CompositeInput::stopCompositeInput, this);
             registerMethod(COMPOSITEINPUT_METHOD_SCALE_COMPOSITE_INPUT, &CompositeInput::setVideoRectangleWrapper, this);
+            registerMethod(COMPOSITEINPUT_METHOD_GET_INPUT_SWITCH_STATISTICS, &CompositeInput::getInputSwitchStatisticsWrapper, this);
         }
 
         CompositeInput::~CompositeInput()
@@ -106,16 +110,8 @@ namespace WPEFramework
                 returnResponse(false);
             }
 
-            bool success = true;
-            try
-            {
-                device::CompositeInput::getInstance().selectPort(portId);
-            }
-            catch (const device::Exception& err)
-            {
-                LOG_DEVICE_EXCEPTION1(sPortId);
-                success = false;
-            }
+            // Switches in place when another port is presented, no stop needed in between
+            bool success = m_inputSource.start(portId);
             returnResponse(success);
 
         }
@@ -124,16 +120,9 @@ namespace WPEFramework
         {
             LOGINFOMETHOD();
 
-            bool success = true;
-            try
-            {
-                device::CompositeInput::getInstance().selectPort(-1);
-            }
-            catch (const device::Exception& err)
-            {
+            bool success = m_inputSource.stop();
+            if (!success)
                 LOGWARN("CompositeInputService::stopCompositeInput Failed");
-                success = false;
-            }
             returnResponse(success);
 
         }
@@ -187,7 +176,12 @@ namespace WPEFramework
 		    returnResponse(false);
                 }
 
-                result = setVideoRectangle(x, y, w, h);
+                InputSourceManager::Plane plane;
+                plane.x = x;
+                plane.y = y;
+                plane.width = w;
+                plane.height = h;
+                result = m_inputSource.scale(plane);
                 if (false == result) {
                   LOGWARN("CompositeInputService::setVideoRectangle Failed");
                   response["message"] = "failed to set scale";
@@ -214,6 +208,41 @@ namespace WPEFramework
             return ret;
         }
 
+        bool CompositeInput::selectPort(int iPort)
+        {
+            try
+            {
+                device::CompositeInput::getInstance().selectPort(iPort);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(std::to_string(iPort));
+                return false;
+            }
+            return true;
+        }
+
+        uint32_t CompositeInput::getInputSwitchStatisticsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            InputSourceManager::Switch last = m_inputSource.lastSwitch();
+            Utils::Metrics::Histogram::Summary summary;
+            m_inputSource.statistics(summary);
+
+            JsonObject lastSwitch;
+            lastSwitch["from"] = last.from;
+            lastSwitch["to"] = last.to;
+            lastSwitch["selectMs"] = last.selectMs;
+            lastSwitch["presentMs"] = last.presentMs;
+            response["lastSwitch"] = lastSwitch;
+            response["switches"] = summary.count;
+            response["p50Ms"] = summary.p50;
+            response["p90Ms"] = summary.p90;
+            response["maxMs"] = summary.max;
+            returnResponse(true);
+        }
+
         uint32_t CompositeInput::getCompositeInputDevicesWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
@@ -335,6 +364,8 @@ namespace WPEFramework
             }
 
             sendNotify(COMPOSITEINPUT_EVENT_ON_STATUS_CHANGED, params);
+
+            m_inputSource.presented(port, isPresented);
         }
 
         void CompositeInput::dsCompositeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
@@ -24,6 +24,7 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "InputSourceManager.h"
 
 namespace WPEFramework {
 
@@ -57,11 +58,13 @@ namespace WPEFramework {
             uint32_t stopCompositeInput(const JsonObject& parameters, JsonObject& response);
 
             uint32_t setVideoRectangleWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getInputSwitchStatisticsWrapper(const JsonObject& parameters, JsonObject& response);
             //End methods
 
             JsonArray getCompositeInputDevices();
 
             bool setVideoRectangle(int x, int y, int width, int height);
+            bool selectPort(int iPort);
 
             void compositeInputHotplug( int input , int connect);
             static void dsCompositeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
@@ -81,6 +84,9 @@ namespace WPEFramework {
 
         public:
             static CompositeInput* _instance;
+
+        private:
+            InputSourceManager m_inputSource;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
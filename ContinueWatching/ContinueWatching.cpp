@@ -33,6 +33,7 @@
   * This service will be enabled/disabled using an TR181 parameter.
   */
 #include <iomanip>
+#include <unistd.h>
 
 #include "ContinueWatching.h"
 
@@ -84,6 +85,7 @@ namespace WPEFramework {
 
 		void ContinueWatching::Deinitialize(PluginHost::IShell* /* service */)
 		{
+			ContinueWatchingStore::getInstance().flush();
 			ContinueWatching::_instance = nullptr;
 		}
 
@@ -193,6 +195,12 @@ namespace WPEFramework {
 		{
 			try
 			{
+				std::string tokenData;
+				if (ContinueWatchingStore::getInstance().getToken(strApplicationName, tokenData))
+				{
+					return tokenData;
+				}
+
 				ContinueWatchingImplFactory continueWatchingImplFactory;
 				ContinueWatchingImpl *continueWatchingImpl = NULL;
 				continueWatchingImpl = continueWatchingImplFactory.createContinueWatchingImpl(strApplicationName);
@@ -202,9 +210,13 @@ namespace WPEFramework {
 					return "";
 				}
 
-				std::string tokenData = continueWatchingImpl->getApplicationToken();
+				tokenData = continueWatchingImpl->getApplicationToken();
 				delete continueWatchingImpl;
 				continueWatchingImpl = NULL;
+				if (!tokenData.empty())
+				{
+					ContinueWatchingStore::getInstance().setToken(strApplicationName, tokenData);
+				}
 				LOGINFO(" tokenData %s \n",tokenData.c_str());
 				return tokenData;
 			}
@@ -273,6 +285,263 @@ namespace WPEFramework {
 			}
 		}
 
+		/**
+		 * @brief Returns the token store, the writer thread is started with the first change.
+		 *
+		 * @return ContinueWatchingStore&.
+		 */
+		ContinueWatchingStore& ContinueWatchingStore::getInstance()
+		{
+			static ContinueWatchingStore instance;
+			return instance;
+		}
+
+		ContinueWatchingStore::ContinueWatchingStore()
+		: m_loaded(false)
+		, m_dirty(false)
+		, m_stop(false)
+		{
+		}
+
+		ContinueWatchingStore::~ContinueWatchingStore()
+		{
+			flush();
+		}
+
+		/**
+		 * @brief This function is used to get the encrypted data of an application.
+		 *
+		 * @param[in] strApplicationName Application Name String.
+		 *
+		 * @return encrypted data, empty if the application has no token.
+		 */
+		std::string ContinueWatchingStore::getEncryptedData(const std::string& strApplicationName)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			loadNoLock();
+
+			std::unordered_map<std::string, Entry>::const_iterator entry = m_entries.find(strApplicationName);
+			return (entry != m_entries.end() ? entry->second.encryptedData : std::string());
+		}
+
+		/**
+		 * @brief This function is used to set the encrypted data of an application. The decrypted
+		 * token is dropped, the next getToken misses and the data is decrypted once again.
+		 *
+		 * @param[in] strApplicationName Application Name String.
+		 * @param[in] encryptedData Base64 encoded encrypted data.
+		 */
+		void ContinueWatchingStore::setEncryptedData(const std::string& strApplicationName, const std::string& encryptedData)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			loadNoLock();
+
+			Entry& entry = m_entries[strApplicationName];
+			entry.encryptedData = encryptedData;
+			entry.token.clear();
+			entry.hasToken = false;
+			scheduleWriteNoLock();
+		}
+
+		/**
+		 * @brief This function is used to delete the token of an application.
+		 *
+		 * @param[in] strApplicationName Application Name String.
+		 *
+		 * @return false if the application had no token.
+		 */
+		bool ContinueWatchingStore::deleteEntry(const std::string& strApplicationName)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			loadNoLock();
+
+			if (m_entries.erase(strApplicationName) == 0)
+			{
+				return false;
+			}
+			scheduleWriteNoLock();
+			return true;
+		}
+
+		/**
+		 * @brief This function is used to get the decrypted token of an application.
+		 *
+		 * @param[in] strApplicationName Application Name String.
+		 * @param[out] token Decrypted token.
+		 *
+		 * @return false if the token was not decrypted since it was loaded or set.
+		 */
+		bool ContinueWatchingStore::getToken(const std::string& strApplicationName, std::string& token)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			std::unordered_map<std::string, Entry>::const_iterator entry = m_entries.find(strApplicationName);
+			if (entry == m_entries.end() || !entry->second.hasToken)
+			{
+				return false;
+			}
+			token = entry->second.token;
+			return true;
+		}
+
+		/**
+		 * @brief This function is used to keep the decrypted token of an application.
+		 *
+		 * @param[in] strApplicationName Application Name String.
+		 * @param[in] token Decrypted token.
+		 */
+		void ContinueWatchingStore::setToken(const std::string& strApplicationName, const std::string& token)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			std::unordered_map<std::string, Entry>::iterator entry = m_entries.find(strApplicationName);
+			if (entry != m_entries.end())
+			{
+				entry->second.token = token;
+				entry->second.hasToken = true;
+			}
+		}
+
+		/**
+		 * @brief This function is used to write pending changes right away and stop the writer thread.
+		 */
+		void ContinueWatchingStore::flush()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_condition.notify_all();
+
+			if (m_writer.joinable())
+			{
+				m_writer.join();
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = false;
+		}
+
+		void ContinueWatchingStore::loadNoLock()
+		{
+			if (m_loaded)
+			{
+				return;
+			}
+			m_loaded = true;
+
+			FILE *file = fopen(CW_LOCAL_FILE, "r");
+			if (!file)
+				return;
+
+			fseek(file, 0, SEEK_END);
+			long numbytes = ftell(file);
+			char *jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
+			if(jsonDoc == NULL) {
+				fclose(file);
+				return;
+			}
+
+			fseek(file, 0, SEEK_SET);
+			fread(jsonDoc, 1, numbytes, file);
+			fclose(file);
+			jsonDoc[numbytes] = '\0';
+
+			cJSON *root = cJSON_Parse(jsonDoc);
+			cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
+			int tokensCount = cJSON_GetArraySize(tokens);
+
+			for (int i = 0; i < tokensCount; i++) {
+				cJSON *token = cJSON_GetArrayItem(tokens, i);
+				cJSON *item = cJSON_GetObjectItem(token, "applicationName");
+				cJSON *encrypteDataItem = cJSON_GetObjectItem(token, "encryptedData");
+				if (item && item->valuestring && encrypteDataItem && encrypteDataItem->valuestring) {
+					Entry& entry = m_entries[item->valuestring];
+					entry.encryptedData = encrypteDataItem->valuestring;
+					entry.hasToken = false;
+				}
+			}
+			cJSON_Delete(root);
+			free(jsonDoc);
+		}
+
+		void ContinueWatchingStore::scheduleWriteNoLock()
+		{
+			m_dirty = true;
+			if (!m_writer.joinable())
+			{
+				m_writer = std::thread(&ContinueWatchingStore::writerThread, this);
+			}
+			m_condition.notify_all();
+		}
+
+		void ContinueWatchingStore::writerThread()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			while (true)
+			{
+				m_condition.wait(lock, [this] { return m_dirty || m_stop; });
+				if (!m_dirty)
+				{
+					break;
+				}
+
+				// Debounce, a burst of changes ends up in one write
+				m_condition.wait_for(lock, std::chrono::milliseconds(CW_WRITE_DELAY_MS), [this] { return m_stop; });
+
+				std::unordered_map<std::string, std::string> encryptedData;
+				for (const std::pair<const std::string, Entry>& entry : m_entries)
+				{
+					encryptedData[entry.first] = entry.second.encryptedData;
+				}
+				m_dirty = false;
+
+				lock.unlock();
+				bool result = saveToFile(encryptedData);
+				lock.lock();
+
+				if (!result)
+				{
+					LOGERR("Failed to write %s\n", CW_LOCAL_FILE);
+				}
+			}
+		}
+
+		bool ContinueWatchingStore::saveToFile(const std::unordered_map<std::string, std::string>& encryptedData)
+		{
+			cJSON *root = cJSON_CreateObject();
+			cJSON *tokenArray = cJSON_CreateArray();
+			cJSON_AddItemToObject(root, "tokens", tokenArray);
+			for (const std::pair<const std::string, std::string>& entry : encryptedData) {
+				cJSON *jsonItem = cJSON_CreateObject();
+				cJSON_AddItemToObject(jsonItem, "applicationName", cJSON_CreateString(entry.first.c_str()));
+				cJSON_AddItemToObject(jsonItem, "encryptedData", cJSON_CreateString(entry.second.c_str()));
+				cJSON_AddItemToArray(tokenArray, jsonItem);
+			}
+
+			char *jsonOut = cJSON_Print(root);
+			cJSON_Delete(root);
+			if (jsonOut == NULL)
+				return false;
+
+			FILE *file = fopen(CW_LOCAL_FILE_TMP, "w");
+			if (!file) {
+				free(jsonOut);
+				return false;
+			}
+
+			bool result = (fputs(jsonOut, file) >= 0) && (fflush(file) == 0) && (fsync(fileno(file)) == 0);
+			result = (fclose(file) == 0) && result;
+			free(jsonOut);
+
+			if (!result || rename(CW_LOCAL_FILE_TMP, CW_LOCAL_FILE) != 0) {
+				remove(CW_LOCAL_FILE_TMP);
+				return false;
+			}
+			return true;
+		}
+
 		/**
 		 * @brief Class ContinueWatchingImpl Constructor.
 		 *
@@ -475,231 +744,41 @@ namespace WPEFramework {
 		}
 
 		/**
-		 * @brief This function is used to write the protectedData into file.
+		 * @brief This function is used to store the protectedData, the store writes it to file later.
 		 *
 		 * @param[in] protectedData Variable of string.
 		 *
-		 * @return True if it able to write data into file.
+		 * @return True.
 		 */
 		bool ContinueWatchingImpl::writeToJson(std::string protectedData)
 		{
-			char *jsonDoc = NULL;
-			char *jsonOut = NULL;
-			cJSON *root = NULL;
-			bool createNewJsonDoc = true;
-
-			FILE *file = fopen(CW_LOCAL_FILE, "r");
-			if (file) {
-				fseek(file, 0, SEEK_END);
-				long numbytes = ftell(file);
-				jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
-				if(jsonDoc == NULL) {
-					fclose(file);
-					return false;
-				}
-
-				fseek(file, 0, SEEK_SET);
-				fread(jsonDoc, numbytes, 1, file);
-				fclose(file);
-				file = NULL;
-				jsonDoc[numbytes] = 0;
-
-				root = cJSON_Parse(jsonDoc);
-				cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
-				if (tokens) {
-					int i;
-					bool tokenUpdated = false;
-					int tokensCount = cJSON_GetArraySize(tokens);
-					createNewJsonDoc = false;
-					for (i = 0; i < tokensCount; i++) {
-						cJSON *token = cJSON_GetArrayItem(tokens, i);
-						cJSON *item = cJSON_GetObjectItem(token, "applicationName");
-						if (item) {
-							//updating token data
-							if (strcmp(item->valuestring, mStrApplicationName.c_str()) == 0) {
-								tokenUpdated = true;
-								cJSON_ReplaceItemInObject(token, "encryptedData", cJSON_CreateString(protectedData.c_str()));
-				 				break;
-							}
-						}
-					}
-
-					//Adding new entry to list
-					if(!tokenUpdated) {
-						cJSON *jsonItem = cJSON_CreateObject();
-
-						cJSON_AddItemToObject(jsonItem, "applicationName", cJSON_CreateString(mStrApplicationName.c_str()));
-						cJSON_AddItemToObject(jsonItem, "encryptedData", cJSON_CreateString(protectedData.c_str()));
-						cJSON_AddItemToArray(tokens, jsonItem);
-					}
-				}
-				free(jsonDoc);
-				jsonDoc = NULL;
-			}
-
-			if (createNewJsonDoc) {
-				cJSON *tokenArray;
-				cJSON *jsonItem;
-
-				cJSON_Delete(root);
-				root  = cJSON_CreateObject();
-				tokenArray=  cJSON_CreateArray();
-				cJSON_AddItemToObject(root, "tokens", tokenArray);
-				jsonItem = cJSON_CreateObject();
-				cJSON_AddItemToObject(jsonItem, "applicationName", cJSON_CreateString(mStrApplicationName.c_str()));
-				cJSON_AddItemToObject(jsonItem, "encryptedData", cJSON_CreateString(protectedData.c_str()));
-				cJSON_AddItemToArray(tokenArray, jsonItem);
-			}
-
-			jsonOut = cJSON_Print(root);
-			cJSON_Delete(root);
-
-			file = fopen(CW_LOCAL_FILE, "w");
-			if (!file) {
-				free(jsonOut);
-				jsonOut = NULL;
-				return false;
-			}
-
-			fprintf(file, "%s", jsonOut);
-
-			fclose (file);
-			file = NULL;
-			free(jsonOut);
-			jsonOut = NULL;
-
+			ContinueWatchingStore::getInstance().setEncryptedData(mStrApplicationName, protectedData);
 			return true;
 		}
 
 		/**
-		 * @brief This function is used to read the protectedData from file.
+		 * @brief This function is used to read the protectedData from the store.
 		 *
 		 * @return protectedData.
 		 */
 		std::string ContinueWatchingImpl::readFromJson()
 		{
-			char *jsonDoc = NULL;
-			std::string retVal = "";
-			FILE *file = fopen(CW_LOCAL_FILE, "r");
-
-			if (!file)
-				return retVal;
-
-			fseek(file, 0, SEEK_END);
-			long numbytes = ftell(file);
-			jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
-			if(jsonDoc == NULL) {
-				fclose(file);
-				return retVal;
-			}
-
-			fseek(file, 0, SEEK_SET);
-			fread(jsonDoc, 1, numbytes, file);
-			fclose(file);
-			jsonDoc[numbytes] = '\0';
-
-			cJSON *root = cJSON_Parse(jsonDoc);
-			cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
-			int tokensCount = cJSON_GetArraySize(tokens);
-			int i;
-
-			for (i = 0; i < tokensCount; i++) {
-				cJSON *token = cJSON_GetArrayItem(tokens, i);
-				cJSON *item = cJSON_GetObjectItem(token, "applicationName");
-				if (item) {
-					if (strcmp(item->valuestring, mStrApplicationName.c_str()) == 0) {
-						cJSON *encrypteDataItem = cJSON_GetObjectItem(token, "encryptedData");
-						if (encrypteDataItem){
-							retVal = encrypteDataItem->valuestring;
-						}
-						break;
-					}
-				}
-			}
-			cJSON_Delete(root);
-			root = NULL;
-			free(jsonDoc);
-			root = NULL;
-
-			return retVal;
+			return ContinueWatchingStore::getInstance().getEncryptedData(mStrApplicationName);
 		}
 
 		/**
-		 * @brief This function is used to delete the token from file.
+		 * @brief This function is used to delete the token from the store.
 		 *
-		 * @return True.
+		 * @return True if the application had a token.
 		 */
 		bool ContinueWatchingImpl::deleteToken()
 		{
-			char *jsonDoc = NULL;
-			char *jsonOut = NULL;
-			cJSON *root = NULL;
-			bool retVal = false;
-
 			if(!tr181FeatureEnabled()) {
 				LOGWARN("Feature DISABLED...\n");
 				return false;
 			}
 
-			FILE *file = fopen(CW_LOCAL_FILE, "r");
-			if (!file)
-				return retVal;
-
-			fseek(file, 0, SEEK_END);
-			long numbytes = ftell(file);
-			jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
-			if(jsonDoc==NULL) {
-				fclose(file);
-				return false;
-			}
-			fseek(file, 0, SEEK_SET);
-			fread(jsonDoc, numbytes, 1, file);
-			fclose(file);
-			file = NULL;
-			jsonDoc[numbytes] = 0;
-
-			root = cJSON_Parse(jsonDoc);
-			cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
-			if (tokens) {
-				int i;
-				int tokensCount = cJSON_GetArraySize(tokens);
-				for (i = 0; i < tokensCount; i++) {
-					cJSON *token = cJSON_GetArrayItem(tokens, i);
-					cJSON *item = cJSON_GetObjectItem(token, "applicationName");
-					if (item) {
-						if (strcmp(item->valuestring, mStrApplicationName.c_str()) == 0) {
-							retVal = true;
-							cJSON_DeleteItemFromArray(tokens, i);
-							break;
-						}
-					}
-				}
-			}
-			free(jsonDoc);
-			jsonDoc = NULL;
-
-			if (!retVal) {
-				cJSON_Delete(root);
-				return retVal;
-			}
-
-			jsonOut = cJSON_Print(root);
-			cJSON_Delete(root);
-
-			file = fopen(CW_LOCAL_FILE, "w");
-			if (!file) {
-				free(jsonOut);
-				jsonOut = NULL;
-				retVal = false;
-				return retVal;
-			}
-
-			fprintf(file, "%s", jsonOut);
-			fclose (file);
-			file = NULL;
-			free(jsonOut);
-			jsonOut = NULL;
-			return true;
+			return ContinueWatchingStore::getInstance().deleteEntry(mStrApplicationName);
 		}
 
 		/**
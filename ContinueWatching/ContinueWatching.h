@@ -39,7 +39,10 @@
 #define CONTINUEWATCHING_H
 
 #include <string.h>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "Module.h"
 #include "utils.h"
 #if !defined(DISABLE_SECAPI)
@@ -50,6 +53,8 @@
 #include "AbstractPlugin.h"
 
 #define CW_LOCAL_FILE  "/opt/continuewatching.json"
+#define CW_LOCAL_FILE_TMP  "/opt/continuewatching.json.tmp"
+#define CW_WRITE_DELAY_MS  1000
 #define NETFLIX_CONTINUEWATCHING_APP_NAME  "netflix"
 
 namespace WPEFramework {
@@ -98,6 +103,52 @@ namespace WPEFramework {
 			uint32_t m_apiVersionNumber;
 	        };
 
+		/**
+		* @brief Class declaration for the token store of ContinueWatching
+		*
+		* CW_LOCAL_FILE is read once, after that the encrypted data and the decrypted tokens of
+		* the applications are served from memory. Changes are written back by a single writer
+		* thread CW_WRITE_DELAY_MS after the last change, replacing the file atomically.
+		**/
+		class ContinueWatchingStore
+		{
+		public:
+			static ContinueWatchingStore& getInstance();
+
+			std::string getEncryptedData(const std::string& strApplicationName);
+			void setEncryptedData(const std::string& strApplicationName, const std::string& encryptedData);
+			bool deleteEntry(const std::string& strApplicationName);
+			bool getToken(const std::string& strApplicationName, std::string& token);
+			void setToken(const std::string& strApplicationName, const std::string& token);
+			void flush();
+
+		private:
+			struct Entry
+			{
+				std::string encryptedData;
+				std::string token;
+				bool hasToken;
+			};
+
+			ContinueWatchingStore();
+			~ContinueWatchingStore();
+			ContinueWatchingStore(const ContinueWatchingStore&) = delete;
+			ContinueWatchingStore& operator=(const ContinueWatchingStore&) = delete;
+
+			void loadNoLock();
+			void scheduleWriteNoLock();
+			void writerThread();
+			bool saveToFile(const std::unordered_map<std::string, std::string>& encryptedData);
+
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			std::thread m_writer;
+			std::unordered_map<std::string, Entry> m_entries;
+			bool m_loaded;
+			bool m_dirty;
+			bool m_stop;
+		};
+
 		/**
 		* @brief Class declaration for ContinueWatching Implementation
 		**/
@@ -52,6 +52,10 @@ typedef enum
 
 #define IEEE_MAC_ADDRESS_STR_MAX    30
 
+// ControlMgr updates some of the remote statistics (voice counters, last key time) without an event,
+// so cached remote data is refreshed at least this often.
+#define CACHE_MAX_AGE_MS            5000
+
 
 using namespace std;
 
@@ -67,6 +71,9 @@ namespace WPEFramework {
         ControlService::ControlService()
             : AbstractPlugin()
             , m_apiVersionNumber((uint32_t)-1)   /* default max uint32_t so everything gets enabled */    //TODO(MROLLINS) Can't we access this from jsonrpc interface?
+            , m_remoteGeneration(0)
+            , m_keyGeneration(0)
+            , m_valuesGeneration(0)
         {
             LOGINFO("ctor");
             ControlService::_instance = this;
@@ -178,12 +185,24 @@ namespace WPEFramework {
             if (!strcmp(owner, IARM_BUS_IRMGR_NAME))
             {
                 if (eventId == IARM_BUS_IRMGR_EVENT_IRKEY)
+                {
+                    m_keyGeneration++;
                     irmgrHandler(owner, eventId, data, len);
+                }
                 else
                     LOGWARN("Ignoring unexpected irMgr event - eventId: %d!!", eventId);
             }
             else if (!strcmp(owner, CTRLM_MAIN_IARM_BUS_NAME))
             {
+                // Keep the cached state current, the getters fetch it again on their next call
+                if ((eventId == CTRLM_RCU_IARM_EVENT_KEY_GHOST) || (eventId == CTRLM_RCU_IARM_EVENT_CONTROL))
+                    m_keyGeneration++;
+                else if ((eventId == CTRLM_RCU_IARM_EVENT_BATTERY_MILESTONE) ||
+                         (eventId == CTRLM_RCU_IARM_EVENT_REMOTE_REBOOT) ||
+                         (eventId == CTRLM_RCU_IARM_EVENT_VALIDATION_END) ||
+                         (eventId == CTRLM_RCU_IARM_EVENT_CONFIGURATION_COMPLETE))
+                    m_remoteGeneration++;
+
                 if ((eventId == CTRLM_RCU_IARM_EVENT_KEY_GHOST) ||
                     (eventId == CTRLM_RCU_IARM_EVENT_BATTERY_MILESTONE) ||
                     (eventId == CTRLM_RCU_IARM_EVENT_REMOTE_REBOOT) ||
@@ -735,10 +754,22 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             StatusCode status_code = STATUS_OK;
+            bool refresh = false;
+            getDefaultBoolParameter("refresh", refresh, false);
 
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            status_code = getAllRemoteData(response);
+            uint32_t generation = m_remoteGeneration;
+            if (isCached(m_allRemoteDataCache, generation, refresh))
+            {
+                response = m_allRemoteDataCache.data;
+            }
+            else
+            {
+                status_code = getAllRemoteData(response);
+                if (status_code == STATUS_OK)
+                    storeCache(m_allRemoteDataCache, response, generation);
+            }
 
             response["status_code"] = (int)status_code;
             returnResponse(status_code == STATUS_OK);
@@ -777,9 +808,23 @@ namespace WPEFramework {
                 LOGINFO("remoteId passed in is %d.", remoteId);
             }
 
+            bool refresh = false;
+            getDefaultBoolParameter("refresh", refresh, false);
+
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            status_code = getSingleRemoteData(remoteInfo, remoteId);
+            uint32_t generation = m_remoteGeneration;
+            CachedObject& cache = m_singleRemoteDataCache[remoteId];
+            if (isCached(cache, generation, refresh))
+            {
+                remoteInfo = cache.data;
+            }
+            else
+            {
+                status_code = getSingleRemoteData(remoteInfo, remoteId);
+                if (status_code == STATUS_OK)
+                    storeCache(cache, remoteInfo, generation);
+            }
 
             if (status_code == STATUS_OK)
             {
@@ -795,10 +840,22 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             StatusCode status_code = STATUS_OK;
+            bool refresh = false;
+            getDefaultBoolParameter("refresh", refresh, false);
 
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            status_code = getLastKeypressSource(response);
+            uint32_t generation = m_keyGeneration;
+            if (isCached(m_lastKeypressSourceCache, generation, refresh))
+            {
+                response = m_lastKeypressSourceCache.data;
+            }
+            else
+            {
+                status_code = getLastKeypressSource(response);
+                if (status_code == STATUS_OK)
+                    storeCache(m_lastKeypressSourceCache, response, generation);
+            }
 
             response["status_code"] = (int)status_code;
             returnResponse(status_code == STATUS_OK);
@@ -810,9 +867,22 @@ namespace WPEFramework {
             JsonObject remoteInfo;
             StatusCode status_code = STATUS_OK;
 
+            bool refresh = false;
+            getDefaultBoolParameter("refresh", refresh, false);
+
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            status_code = getLastPairedRemoteData(remoteInfo);
+            uint32_t generation = m_remoteGeneration;
+            if (isCached(m_lastPairedRemoteDataCache, generation, refresh))
+            {
+                remoteInfo = m_lastPairedRemoteDataCache.data;
+            }
+            else
+            {
+                status_code = getLastPairedRemoteData(remoteInfo);
+                if (status_code == STATUS_OK)
+                    storeCache(m_lastPairedRemoteDataCache, remoteInfo, generation);
+            }
 
             if (status_code == STATUS_OK)
             {
@@ -840,6 +910,7 @@ namespace WPEFramework {
             std::lock_guard<std::mutex> guard(m_callMutex);
 
             status_code = setValues(parameters);
+            m_valuesGeneration++;
 
             response["status_code"] = (int)status_code;
             returnResponse(status_code == STATUS_OK);
@@ -849,10 +920,22 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             StatusCode status_code = STATUS_OK;
+            bool refresh = false;
+            getDefaultBoolParameter("refresh", refresh, false);
 
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            status_code = getValues(response);
+            uint32_t generation = m_valuesGeneration;
+            if (isCached(m_valuesCache, generation, refresh))
+            {
+                response = m_valuesCache.data;
+            }
+            else
+            {
+                status_code = getValues(response);
+                if (status_code == STATUS_OK)
+                    storeCache(m_valuesCache, response, generation);
+            }
 
             response["status_code"] = (int)status_code;
             returnResponse(status_code == STATUS_OK);
@@ -925,6 +1008,7 @@ namespace WPEFramework {
             std::lock_guard<std::mutex> guard(m_callMutex);
 
             status_code = endPairingMode(bindStatus);
+            m_remoteGeneration++;
             if (status_code == STATUS_OK)
             {
                 response["bindStatus"] = bindStatus;
@@ -941,7 +1025,18 @@ namespace WPEFramework {
 
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            result = canFindMyRemote();
+            uint32_t generation = m_remoteGeneration;
+            if (isCached(m_canFindMyRemoteCache, generation, false))
+            {
+                result = m_canFindMyRemoteCache.data["result"].Boolean();
+            }
+            else
+            {
+                JsonObject data;
+                result = canFindMyRemote();
+                data["result"] = result;
+                storeCache(m_canFindMyRemoteCache, data, generation);
+            }
 
             response["result"] = result;
             returnResponse(true);
@@ -1107,6 +1202,20 @@ namespace WPEFramework {
         // End events
 
         // Begin private method implementations
+        bool ControlService::isCached(const CachedObject& cache, uint32_t generation, bool refresh)
+        {
+            return (!refresh && cache.valid && (cache.generation == generation) &&
+                    (std::chrono::steady_clock::now() - cache.filled < std::chrono::milliseconds(CACHE_MAX_AGE_MS)));
+        }
+
+        void ControlService::storeCache(CachedObject& cache, const JsonObject& data, uint32_t generation)
+        {
+            cache.data = data;
+            cache.valid = true;
+            cache.generation = generation;
+            cache.filled = std::chrono::steady_clock::now();
+        }
+
         StatusCode ControlService::getAllRemoteData(JsonObject& response)
         {
             JsonArray    infoArray;
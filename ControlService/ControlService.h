@@ -28,6 +28,9 @@
 #include "ctrlm_ipc_rcu.h"
 #include "ctrlm_ipc_key_codes.h"
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <mutex>
 
 #define IARM_CONTROLSERVICE_PLUGIN_NAME    "Control_Service"
@@ -88,6 +91,17 @@ namespace WPEFramework {
         // Note that most of the above is now inherited from the AbstractPlugin class.
         class ControlService : public AbstractPlugin {
         private:
+            // Result of a getter, good while no event changed its generation and it is not too old
+            struct CachedObject
+            {
+                CachedObject() : valid(false), generation(0) {}
+
+                JsonObject data;
+                bool valid;
+                uint32_t generation;
+                std::chrono::steady_clock::time_point filled;
+            };
+
             typedef Core::JSON::String JString;
             typedef Core::JSON::ArrayType<JString> JStringArray;
             typedef Core::JSON::ArrayType<JsonObject> JObjectArray;
@@ -169,6 +183,9 @@ namespace WPEFramework {
             bool getAllRf4ceBindRemotes(void);
             bool getLastPairedRf4ceBindRemote(JsonObject& remoteInfo);
 
+            static bool isCached(const CachedObject& cache, uint32_t generation, bool refresh);
+            static void storeCache(CachedObject& cache, const JsonObject& data, uint32_t generation);
+
         public:
             static ControlService* _instance;
         private:
@@ -179,6 +196,18 @@ namespace WPEFramework {
 
             std::mutex  m_callMutex;
 
+            // Bumped from the IARM event thread, the caches themselves are only used under m_callMutex
+            std::atomic<uint32_t> m_remoteGeneration;   // pairing, battery and reboot events
+            std::atomic<uint32_t> m_keyGeneration;      // key events
+            std::atomic<uint32_t> m_valuesGeneration;   // setValues
+
+            CachedObject m_allRemoteDataCache;
+            std::map<int, CachedObject> m_singleRemoteDataCache;
+            CachedObject m_lastPairedRemoteDataCache;
+            CachedObject m_lastKeypressSourceCache;
+            CachedObject m_valuesCache;
+            CachedObject m_canFindMyRemoteCache;
+
             // Used to remember the "golden" and "entered" digits, during 3-digit manual pairing validation
             threeDigits m_goldenValDigits;
             threeDigits m_enteredValDigits;
@@ -179,6 +179,9 @@ namespace WPEFramework
 
          config.FromString(_service->ConfigLine());
 
+         _epgWindow = config.EpgUpdateWindow.Value();
+         _pretune = config.Pretune.Value();
+
          _service->Register(&_notification);
 
          _dtv = service->Root<Core::IUnknown>(_connectionId, 2000, _T("DTV"));
@@ -245,6 +248,12 @@ namespace WPEFramework
          // start cleaning up..
          _service->Unregister(&_notification);
 
+         _epgJob.Revoke();
+
+         _playLock.Lock();
+         ReleasePretune();
+         _playLock.Unlock();
+
          _dtv->Release();
          _dtv = nullptr;
 
@@ -556,24 +565,29 @@ namespace WPEFramework
             case UI_EVENT_UPDATE:
             {
                //STB_SPDebugWrite("DTV::DvbEventHandler: event=0x%08x\n", event);
+               // A search can add, move or remove any number of services
+               DTV::instance()->InvalidateIndex();
                DTV::instance()->NotifySearchStatus();
                break;
             }
 
             case APP_EVENT_SERVICE_UPDATED:
             {
+               DTV::instance()->UpdateIndex(*(void **)event_data);
                DTV::instance()->NotifyService(EventtypeType::SERVICEUPDATED, _T("serviceupdated"), *(void **)event_data);
                break;
             }
 
             case APP_EVENT_SERVICE_ADDED:
             {
+               DTV::instance()->InvalidateIndex(*(void **)event_data);
                DTV::instance()->NotifyService(EventtypeType::SERVICEADDED, _T("serviceadded"), *(void **)event_data);
                break;
             }
 
             case APP_EVENT_SERVICE_DELETED:
             {
+               DTV::instance()->InvalidateIndex(*(void **)event_data);
                DTV::instance()->NotifyService(EventtypeType::SERVICEDELETED, _T("servicedeleted"), *(void **)event_data);
                break;
             }
@@ -581,6 +595,8 @@ namespace WPEFramework
             case APP_EVENT_SERVICE_VIDEO_CODEC_CHANGED:
             case APP_EVENT_SERVICE_VIDEO_PID_UPDATE:
             {
+               // PIDs are updated once the PMT of the tuned service has been processed
+               DTV::instance()->RecordPmt(*(void **)event_data);
                DTV::instance()->NotifyService(EventtypeType::VIDEOCHANGED, _T("videochanged"), *(void **)event_data);
                break;
             }
@@ -588,6 +604,7 @@ namespace WPEFramework
             case APP_EVENT_SERVICE_AUDIO_CODEC_CHANGED:
             case APP_EVENT_SERVICE_AUDIO_PID_UPDATE:
             {
+               DTV::instance()->RecordPmt(*(void **)event_data);
                DTV::instance()->NotifyService(EventtypeType::AUDIOCHANGED, _T("audiochanged"), *(void **)event_data);
                break;
             }
@@ -603,11 +620,47 @@ namespace WPEFramework
                /* Service, and hence event info, can only be provided if the service is available */
                if (event_data != NULL)
                {
+                  DTV::instance()->InvalidateSchedule(*(void **)event_data);
                   DTV::instance()->NotifyEventChanged(*(void **)event_data);
                }
                break;
             }
 
+#ifdef STB_EVENT_TUNE_LOCKED
+            case STB_EVENT_TUNE_LOCKED:
+            {
+               if ((event_data != NULL) && (data_size >= sizeof(U8BIT)))
+               {
+                  DTV::instance()->RecordTuneLocked(*(U8BIT *)event_data);
+               }
+               break;
+            }
+#endif
+
+#ifdef STB_EVENT_VIDEO_DECODE_STARTED
+            case STB_EVENT_VIDEO_DECODE_STARTED:
+            {
+               if ((event_data != NULL) && (data_size >= sizeof(U8BIT)))
+               {
+                  DTV::instance()->RecordFirstFrame(*(U8BIT *)event_data);
+               }
+               break;
+            }
+#endif
+
+#ifdef APP_EVENT_SERVICE_EIT_SCHED_UPDATE
+            case APP_EVENT_SERVICE_EIT_SCHED_UPDATE:
+            {
+               if (event_data != NULL)
+               {
+                  // The stack doesn't say which part of the schedule changed
+                  DTV::instance()->InvalidateSchedule(*(void **)event_data);
+                  DTV::instance()->RecordEpgChange(*(void **)event_data, 0, 0xffffffff);
+               }
+               break;
+            }
+#endif
+
             default:
             {
                //STB_SPDebugWrite("DTV::DvbEventHandler: Unhandled event=0x%08x\n", event);
@@ -668,8 +721,9 @@ namespace WPEFramework
          if (service != NULL)
          {
             void *now;
+            void *next;
 
-            ADB_GetNowNextEvents(service, &now, NULL);
+            ADB_GetNowNextEvents(service, &now, &next);
 
             if (now != NULL)
             {
@@ -681,6 +735,19 @@ namespace WPEFramework
 
                ADB_ReleaseEventData(now);
 
+               // The change covers the new 'now' event and the 'next' event that follows it
+               U32BIT end_time = params.Event.Starttime.Value() + params.Event.Duration.Value();
+
+               if (next != NULL)
+               {
+                  EiteventInfo next_event;
+
+                  ExtractDvbEventInfo(next_event, next);
+                  end_time = next_event.Starttime.Value() + next_event.Duration.Value();
+               }
+
+               RecordEpgChange(service, params.Event.Starttime.Value(), end_time);
+
                string message(_T("{\"eventtype\":\"EventChanged\""));
                message += _T(", \"service\":");
                message += CreateJsonForService(params.Service);
@@ -692,7 +759,361 @@ namespace WPEFramework
 
                EventEventChanged(params);
             }
+
+            if (next != NULL)
+            {
+               ADB_ReleaseEventData(next);
+            }
+         }
+      }
+
+      // Changes are collected per service and sent together once the update window has passed,
+      // so a burst of EIT sections results in a single event
+      void DTV::RecordEpgChange(void *service, U32BIT start_time, U32BIT end_time)
+      {
+         const string dvburi(GetDvbUri(service));
+
+         _indexLock.Lock();
+
+         _serviceVersions[dvburi]++;
+
+         std::map<string, EpgRange>::iterator entry(_epgChanges.find(dvburi));
+
+         if (entry == _epgChanges.end())
+         {
+            if (_epgChanges.empty())
+            {
+               _epgJob.Schedule(Core::Time::Now().Add(_epgWindow));
+            }
+
+            _epgChanges.insert(std::make_pair(dvburi, EpgRange(start_time, end_time)));
+         }
+         else
+         {
+            entry->second.first = std::min(entry->second.first, start_time);
+            entry->second.second = std::max(entry->second.second, end_time);
+         }
+
+         _indexLock.Unlock();
+      }
+
+      // The service predicted to be zapped to next, the adjacent LCN in the direction of the
+      // last zap, is tuned on a spare path for SI monitoring only. This keeps a tuner locked to its
+      // transport and the PAT/PMT acquired, so a zap to it doesn't have to wait for them.
+      // Must be called with _playLock held.
+      void DTV::Pretune(void *live_service, U8BIT live_path)
+      {
+         const U16BIT lcn = ADB_GetServiceLcn(live_service);
+
+         ReleasePretune();
+
+         if (_liveLcn != 0)
+         {
+            _zapUp = (lcn >= _liveLcn);
+         }
+
+         _livePath = live_path;
+         _liveLcn = lcn;
+
+         U16BIT predicted = 0;
+
+         _indexLock.Lock();
+
+         BuildServiceIndex();
+
+         for (const IndexedService& entry : _serviceIndex)
+         {
+            const U16BIT entry_lcn = entry.Info.Lcn.Value();
+
+            if (!entry.Info.Hidden.Value() && entry.Info.Selectable.Value() && (entry_lcn != lcn) &&
+               ((_zapUp && (entry_lcn > lcn) && ((predicted == 0) || (entry_lcn < predicted))) ||
+                (!_zapUp && (entry_lcn < lcn) && (entry_lcn > predicted))))
+            {
+               predicted = entry_lcn;
+            }
+         }
+
+         _indexLock.Unlock();
+
+         if (predicted != 0)
+         {
+            void *service = ADB_FindServiceByLcn(ADB_SERVICE_LIST_ALL, predicted, FALSE);
+
+            if (service != NULL)
+            {
+               U8BIT path = ACTL_TuneToService(INVALID_RES_ID, NULL, service, FALSE, ACTL_PATH_PURPOSE_MONITOR_SI);
+
+               if (path != INVALID_RES_ID)
+               {
+                  SYSLOG(Logging::Notification, (_T("DTV::Pretune: lcn=%u on path %u"), predicted, path));
+
+                  _pretunePath = path;
+                  _pretuneService = service;
+               }
+            }
+         }
+      }
+
+      // Must be called with _playLock held
+      void DTV::ReleasePretune()
+      {
+         if (_pretunePath != INVALID_RES_ID)
+         {
+            ACTL_TuneOff(_pretunePath);
+            ACTL_ReleasePath(_pretunePath);
+
+            _pretunePath = INVALID_RES_ID;
+            _pretuneService = nullptr;
+         }
+      }
+
+      void DTV::RecordTuneLocked(U8BIT tuner)
+      {
+         const uint64_t now = Core::Time::Now().Ticks();
+
+         _zapLock.Lock();
+
+         for (std::map<U8BIT, ZapTiming>::iterator entry(_zapTimings.begin()); entry != _zapTimings.end(); entry++)
+         {
+            if ((entry->second.TuneLock == 0) && (STB_DPGetPathTuner(entry->first) == tuner))
+            {
+               entry->second.TuneLock = std::max(static_cast<uint32_t>((now - entry->second.Started) / Core::Time::TicksPerMillisecond), 1U);
+            }
+         }
+
+         _zapLock.Unlock();
+      }
+
+      void DTV::RecordPmt(void *service)
+      {
+         const uint64_t now = Core::Time::Now().Ticks();
+
+         _zapLock.Lock();
+
+         for (std::map<U8BIT, ZapTiming>::iterator entry(_zapTimings.begin()); entry != _zapTimings.end(); entry++)
+         {
+            if ((entry->second.Pmt == 0) && (ADB_GetTunedService(entry->first) == service))
+            {
+               entry->second.Pmt = std::max(static_cast<uint32_t>((now - entry->second.Started) / Core::Time::TicksPerMillisecond), 1U);
+            }
+         }
+
+         _zapLock.Unlock();
+      }
+
+      void DTV::RecordFirstFrame(U8BIT decoder)
+      {
+         const uint64_t now = Core::Time::Now().Ticks();
+
+         _zapLock.Lock();
+
+         for (std::map<U8BIT, ZapTiming>::iterator entry(_zapTimings.begin()); entry != _zapTimings.end(); entry++)
+         {
+            if ((entry->second.FirstFrame == 0) && (STB_DPGetPathVideoDecoder(entry->first) == decoder))
+            {
+               entry->second.FirstFrame = std::max(static_cast<uint32_t>((now - entry->second.Started) / Core::Time::TicksPerMillisecond), 1U);
+            }
+         }
+
+         _zapLock.Unlock();
+      }
+
+      void DTV::Dispatch()
+      {
+         EpgchangedParamsData params;
+
+         params.Eventtype = _T("EpgChanged");
+
+         _indexLock.Lock();
+
+         for (std::map<string, EpgRange>::const_iterator entry(_epgChanges.begin()); entry != _epgChanges.end(); entry++)
+         {
+            EpgchangeData& change(params.Changes.Add());
+
+            change.Dvburi = entry->first;
+            change.Starttime = entry->second.first;
+            change.Endtime = entry->second.second;
+            change.Version = _serviceVersions[entry->first];
+         }
+
+         _epgChanges.clear();
+
+         _indexLock.Unlock();
+
+         if (params.Changes.Length() != 0)
+         {
+            string message;
+
+            params.ToString(message);
+            _service->Notify(message);
+
+            EventEpgChanged(params);
+         }
+      }
+
+      void DTV::InvalidateIndex(void *service)
+      {
+         _indexLock.Lock();
+
+         _indexValid = false;
+
+         if (service == nullptr)
+         {
+            _scheduleIndex.clear();
+         }
+         else
+         {
+            _scheduleIndex.erase(GetDvbUri(service));
+         }
+
+         _indexLock.Unlock();
+      }
+
+      void DTV::UpdateIndex(void *service)
+      {
+         const string dvburi(GetDvbUri(service));
+
+         _indexLock.Lock();
+
+         if (_indexValid)
+         {
+            std::vector<IndexedService>::iterator entry(_serviceIndex.begin());
+
+            while ((entry != _serviceIndex.end()) && (entry->Info.Dvburi.Value() != dvburi))
+            {
+               entry++;
+            }
+
+            if (entry == _serviceIndex.end())
+            {
+               _indexValid = false;
+            }
+            else
+            {
+               const uint16_t lcn = entry->Info.Lcn.Value();
+
+               ExtractDvbServiceInfo(entry->Info, service);
+
+               // The index is kept in database order, which follows the LCN
+               if (entry->Info.Lcn.Value() != lcn)
+               {
+                  _indexValid = false;
+               }
+            }
          }
+
+         _indexLock.Unlock();
+      }
+
+      void DTV::InvalidateSchedule(void *service)
+      {
+         const string dvburi(GetDvbUri(service));
+
+         _indexLock.Lock();
+         _scheduleIndex.erase(dvburi);
+         _indexLock.Unlock();
+      }
+
+      // Must be called with _indexLock held
+      void DTV::BuildServiceIndex() const
+      {
+         if (_indexValid == false)
+         {
+            U16BIT num_services = 0;
+            void **slist = NULL;
+
+            _serviceIndex.clear();
+
+            ADB_GetServiceList(ADB_SERVICE_LIST_DIGITAL, &slist, &num_services);
+
+            if ((slist != NULL) && (num_services != 0))
+            {
+               BOOLEAN is_sig2;
+               U16BIT serv_id;
+
+               _serviceIndex.reserve(num_services);
+
+               for (U16BIT index = 0; index < num_services; index++)
+               {
+                  _serviceIndex.emplace_back();
+
+                  IndexedService& entry(_serviceIndex.back());
+
+                  ExtractDvbServiceInfo(entry.Info, slist[index]);
+                  entry.Signal = ADB_GetServiceSignalType(slist[index], &is_sig2);
+                  ADB_GetServiceIds(slist[index], &entry.OnetId, &entry.TransId, &serv_id);
+               }
+
+               ADB_ReleaseServiceList(slist, num_services);
+            }
+
+            _indexValid = true;
+         }
+      }
+
+      // Must be called with _indexLock held. The returned schedule stays valid until the lock is released.
+      const DTV::IndexedSchedule* DTV::BuildSchedule(void *service) const
+      {
+         const string dvburi(GetDvbUri(service));
+         const uint64_t now = Core::Time::Now().Ticks();
+         const uint64_t lifetime = static_cast<uint64_t>(DTV_SCHEDULE_INDEX_LIFETIME) * Core::Time::MicroSecondsPerSecond;
+
+         std::map<string, IndexedSchedule>::iterator entry(_scheduleIndex.find(dvburi));
+
+         if ((entry != _scheduleIndex.end()) && ((now - entry->second.Built) >= lifetime))
+         {
+            _scheduleIndex.erase(entry);
+            entry = _scheduleIndex.end();
+         }
+
+         if (entry == _scheduleIndex.end())
+         {
+            if (_scheduleIndex.size() >= DTV_SCHEDULE_INDEX_SIZE)
+            {
+               std::map<string, IndexedSchedule>::iterator oldest(_scheduleIndex.begin());
+
+               for (std::map<string, IndexedSchedule>::iterator index(_scheduleIndex.begin()); index != _scheduleIndex.end(); index++)
+               {
+                  if (index->second.Built < oldest->second.Built)
+                  {
+                     oldest = index;
+                  }
+               }
+
+               _scheduleIndex.erase(oldest);
+            }
+
+            entry = _scheduleIndex.insert(std::make_pair(dvburi, IndexedSchedule())).first;
+            entry->second.Built = now;
+
+            void **event_list = NULL;
+            U16BIT num_events = 0;
+
+            ADB_GetEventSchedule(FALSE, service, &event_list, &num_events);
+            if (event_list != NULL)
+            {
+               entry->second.Events.reserve(num_events);
+
+               for (U16BIT i = 0; i < num_events; i++)
+               {
+                  entry->second.Events.emplace_back();
+                  ExtractDvbEventInfo(entry->second.Events.back(), event_list[i]);
+               }
+
+               ADB_ReleaseEventList(event_list, num_events);
+            }
+         }
+
+         return (&entry->second);
+      }
+
+      string DTV::GetDvbUri(void *service) const
+      {
+         U16BIT onet_id, trans_id, serv_id;
+
+         ADB_GetServiceIds(service, &onet_id, &trans_id, &serv_id);
+
+         return (std::to_string(onet_id) + "." + std::to_string(trans_id) + "." + std::to_string(serv_id));
       }
 
       string DTV::CreateJsonForService(ServiceInfo& service) const
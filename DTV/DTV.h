@@ -22,6 +22,10 @@
 #include "Module.h"
 #include <interfaces/json/JsonData_DTV.h>
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 extern "C"
 {
    // DVB include files
@@ -32,6 +36,15 @@ extern "C"
    #include <ap_dbacc.h>
 };
 
+// Number of services whose EIT schedule is kept in the event index
+#define DTV_SCHEDULE_INDEX_SIZE 16
+
+// Seconds a cached EIT schedule is used for before being read from the DVB stack again
+#define DTV_SCHEDULE_INDEX_LIFETIME 60
+
+// Default time in ms over which EIT changes are collected into a single epgchanged event
+#define DTV_EPG_UPDATE_WINDOW 1000
+
 
 namespace WPEFramework
 {
@@ -90,10 +103,14 @@ namespace WPEFramework
             public:
                Config() : Core::JSON::Container(),
                   SubtitleProcessing(false),
-                  TeletextProcessing(false)
+                  TeletextProcessing(false),
+                  EpgUpdateWindow(DTV_EPG_UPDATE_WINDOW),
+                  Pretune(false)
                {
                    Add(_T("subtitleprocessing"), &SubtitleProcessing);
                    Add(_T("teletextprocessing"), &TeletextProcessing);
+                   Add(_T("epgupdatewindow"), &EpgUpdateWindow);
+                   Add(_T("pretune"), &Pretune);
                }
 
                ~Config()
@@ -103,6 +120,8 @@ namespace WPEFramework
             public:
                Core::JSON::Boolean SubtitleProcessing;
                Core::JSON::Boolean TeletextProcessing;
+               Core::JSON::DecUInt16 EpgUpdateWindow;
+               Core::JSON::Boolean Pretune;
          };
 
          public:
@@ -134,8 +153,278 @@ namespace WPEFramework
                   Core::JSON::ArrayType<ServiceInfo> ServiceList;
             };
 
+            class QueryServicesParamsData: public Core::JSON::Container
+            {
+               private:
+                  QueryServicesParamsData(const QueryServicesParamsData&) = delete;
+                  QueryServicesParamsData& operator=(const QueryServicesParamsData&) = delete;
+
+               public:
+                  QueryServicesParamsData() : Core::JSON::Container(), Offset(0), Limit(0), Lcnfrom(0), Lcnto(0xffff)
+                  {
+                     Add(_T("offset"), &Offset);
+                     Add(_T("limit"), &Limit);
+                     Add(_T("tunertype"), &Tunertype);
+                     Add(_T("transport"), &Transport);
+                     Add(_T("lcnfrom"), &Lcnfrom);
+                     Add(_T("lcnto"), &Lcnto);
+                  }
+
+                  ~QueryServicesParamsData()
+                  {
+                  }
+
+               public:
+                  Core::JSON::DecUInt16 Offset;
+                  Core::JSON::DecUInt16 Limit;
+                  Core::JSON::EnumType<TunertypeType> Tunertype;
+                  Core::JSON::String Transport;
+                  Core::JSON::DecUInt16 Lcnfrom;
+                  Core::JSON::DecUInt16 Lcnto;
+            };
+
+            class QueryServicesResultData: public Core::JSON::Container
+            {
+               private:
+                  QueryServicesResultData(const QueryServicesResultData&) = delete;
+                  QueryServicesResultData& operator=(const QueryServicesResultData&) = delete;
+
+               public:
+                  QueryServicesResultData() : Core::JSON::Container(), Total(0)
+                  {
+                     Add(_T("total"), &Total);
+                     Add(_T("services"), &Services);
+                  }
+
+                  ~QueryServicesResultData()
+                  {
+                  }
+
+               public:
+                  Core::JSON::DecUInt16 Total;
+                  Core::JSON::ArrayType<ServiceInfo> Services;
+            };
+
+            class QueryEventsParamsData: public Core::JSON::Container
+            {
+               private:
+                  QueryEventsParamsData(const QueryEventsParamsData&) = delete;
+                  QueryEventsParamsData& operator=(const QueryEventsParamsData&) = delete;
+
+               public:
+                  QueryEventsParamsData() : Core::JSON::Container(), Starttime(0), Endtime(0xffffffff), Offset(0), Limit(0)
+                  {
+                     Add(_T("dvburi"), &Dvburi);
+                     Add(_T("starttime"), &Starttime);
+                     Add(_T("endtime"), &Endtime);
+                     Add(_T("offset"), &Offset);
+                     Add(_T("limit"), &Limit);
+                  }
+
+                  ~QueryEventsParamsData()
+                  {
+                  }
+
+               public:
+                  Core::JSON::String Dvburi;
+                  Core::JSON::DecUInt32 Starttime;
+                  Core::JSON::DecUInt32 Endtime;
+                  Core::JSON::DecUInt16 Offset;
+                  Core::JSON::DecUInt16 Limit;
+            };
+
+            class QueryEventsResultData: public Core::JSON::Container
+            {
+               private:
+                  QueryEventsResultData(const QueryEventsResultData&) = delete;
+                  QueryEventsResultData& operator=(const QueryEventsResultData&) = delete;
+
+               public:
+                  QueryEventsResultData() : Core::JSON::Container(), Total(0)
+                  {
+                     Add(_T("total"), &Total);
+                     Add(_T("events"), &Events);
+                  }
+
+                  ~QueryEventsResultData()
+                  {
+                  }
+
+               public:
+                  Core::JSON::DecUInt16 Total;
+                  Core::JSON::ArrayType<EiteventInfo> Events;
+            };
+
+            // Service info extended with a counter that is incremented each time the
+            // EIT data of the service changes
+            class VersionedServiceInfo: public ServiceInfo
+            {
+               private:
+                  VersionedServiceInfo(const VersionedServiceInfo&) = delete;
+                  VersionedServiceInfo& operator=(const VersionedServiceInfo&) = delete;
+
+               public:
+                  VersionedServiceInfo() : ServiceInfo(), Version(0)
+                  {
+                     Add(_T("version"), &Version);
+                  }
+
+                  ~VersionedServiceInfo()
+                  {
+                  }
+
+               public:
+                  Core::JSON::DecUInt32 Version;
+            };
+
+            // Time in ms from startPlaying to each phase of the zap, 0 if the phase wasn't reached (yet)
+            class ZapData: public Core::JSON::Container
+            {
+               private:
+                  ZapData(const ZapData&) = delete;
+                  ZapData& operator=(const ZapData&) = delete;
+
+               public:
+                  ZapData() : Core::JSON::Container(), Tunelock(0), Pmt(0), Firstframe(0), Pretuned(false)
+                  {
+                     Add(_T("tunelock"), &Tunelock);
+                     Add(_T("pmt"), &Pmt);
+                     Add(_T("firstframe"), &Firstframe);
+                     Add(_T("pretuned"), &Pretuned);
+                  }
+
+                  ~ZapData()
+                  {
+                  }
+
+               public:
+                  Core::JSON::DecUInt32 Tunelock;
+                  Core::JSON::DecUInt32 Pmt;
+                  Core::JSON::DecUInt32 Firstframe;
+                  Core::JSON::Boolean Pretuned;
+            };
+
+            class ZapStatusData: public StatusData
+            {
+               private:
+                  ZapStatusData(const ZapStatusData&) = delete;
+                  ZapStatusData& operator=(const ZapStatusData&) = delete;
+
+               public:
+                  ZapStatusData() : StatusData()
+                  {
+                     Add(_T("zap"), &Zap);
+                  }
+
+                  ~ZapStatusData()
+                  {
+                  }
+
+               public:
+                  ZapData Zap;
+            };
+
+            class EpgchangeData: public Core::JSON::Container
+            {
+               public:
+                  EpgchangeData() : Core::JSON::Container(), Starttime(0), Endtime(0), Version(0)
+                  {
+                     Init();
+                  }
+
+                  EpgchangeData(const EpgchangeData& other) : Core::JSON::Container(),
+                     Dvburi(other.Dvburi), Starttime(other.Starttime), Endtime(other.Endtime), Version(other.Version)
+                  {
+                     Init();
+                  }
+
+                  EpgchangeData& operator=(const EpgchangeData& rhs)
+                  {
+                     Dvburi = rhs.Dvburi;
+                     Starttime = rhs.Starttime;
+                     Endtime = rhs.Endtime;
+                     Version = rhs.Version;
+                     return (*this);
+                  }
+
+                  ~EpgchangeData()
+                  {
+                  }
+
+               private:
+                  void Init()
+                  {
+                     Add(_T("dvburi"), &Dvburi);
+                     Add(_T("starttime"), &Starttime);
+                     Add(_T("endtime"), &Endtime);
+                     Add(_T("version"), &Version);
+                  }
+
+               public:
+                  Core::JSON::String Dvburi;
+                  Core::JSON::DecUInt32 Starttime;
+                  Core::JSON::DecUInt32 Endtime;
+                  Core::JSON::DecUInt32 Version;
+            };
+
+            class EpgchangedParamsData: public Core::JSON::Container
+            {
+               private:
+                  EpgchangedParamsData(const EpgchangedParamsData&) = delete;
+                  EpgchangedParamsData& operator=(const EpgchangedParamsData&) = delete;
+
+               public:
+                  EpgchangedParamsData() : Core::JSON::Container()
+                  {
+                     Add(_T("eventtype"), &Eventtype);
+                     Add(_T("changes"), &Changes);
+                  }
+
+                  ~EpgchangedParamsData()
+                  {
+                  }
+
+               public:
+                  Core::JSON::String Eventtype;
+                  Core::JSON::ArrayType<EpgchangeData> Changes;
+            };
+
+         private:
+            // Services and EIT schedules as last read from the DVB database. Both are rebuilt
+            // on demand after the DVB stack signals a change, so property and query calls don't
+            // walk the whole database each time.
+            struct IndexedService
+            {
+               ServiceInfo Info;
+               E_STB_DP_SIGNAL_TYPE Signal;
+               U16BIT OnetId;
+               U16BIT TransId;
+            };
+
+            struct IndexedSchedule
+            {
+               uint64_t Built;
+               std::vector<EiteventInfo> Events;
+            };
+
+            // Start and end time in UTC seconds of the EIT data that changed for a service
+            typedef std::pair<U32BIT, U32BIT> EpgRange;
+
+            struct ZapTiming
+            {
+               uint64_t Started;
+               uint32_t TuneLock;
+               uint32_t Pmt;
+               uint32_t FirstFrame;
+               bool Pretuned;
+            };
+
          public:
-            DTV() : _skipURL(0), _service(nullptr), _connectionId(0), _dtv(nullptr), _notification(this)
+            DTV() : _skipURL(0), _service(nullptr), _connectionId(0), _dtv(nullptr), _notification(this),
+               _indexLock(), _indexValid(false), _serviceIndex(), _scheduleIndex(),
+               _serviceVersions(), _epgChanges(), _epgWindow(DTV_EPG_UPDATE_WINDOW), _epgJob(*this),
+               _playLock(), _pretune(false), _livePath(INVALID_RES_ID), _liveLcn(0), _zapUp(true),
+               _pretunePath(INVALID_RES_ID), _pretuneService(nullptr), _zapLock(), _zapTimings()
             {
                DTV::instance(this);
                RegisterAll();
@@ -183,6 +472,22 @@ namespace WPEFramework
             void NotifyService(EventtypeType event_type, const string& event_name, void *service);
             void NotifyEventChanged(void *service);
 
+            void InvalidateIndex(void *service = nullptr);
+            void UpdateIndex(void *service);
+            void InvalidateSchedule(void *service);
+            void BuildServiceIndex() const;
+            const IndexedSchedule* BuildSchedule(void *service) const;
+            void RecordEpgChange(void *service, U32BIT start_time, U32BIT end_time);
+
+            void Pretune(void *live_service, U8BIT live_path);
+            void ReleasePretune();
+            void RecordTuneLocked(U8BIT tuner);
+            void RecordPmt(void *service);
+            void RecordFirstFrame(U8BIT decoder);
+
+            friend Core::ThreadPool::JobType<DTV&>;
+            void Dispatch();
+
             // JsonRpc
             void RegisterAll();
             void UnregisterAll();
@@ -196,8 +501,8 @@ namespace WPEFramework
             uint32_t GetServiceList(const string& index, Core::JSON::ArrayType<ServiceInfo>& response) const;
             uint32_t GetNowNextEvents(const string& service_uri, NowNextEventsData& response) const;
             uint32_t GetScheduleEvents(const string& index, Core::JSON::ArrayType<EiteventInfo>& response) const;
-            uint32_t GetStatus(const string& index, StatusData& response) const;
-            uint32_t GetServiceInfo(const string& index, ServiceInfo& response) const;
+            uint32_t GetStatus(const string& index, ZapStatusData& response) const;
+            uint32_t GetServiceInfo(const string& index, VersionedServiceInfo& response) const;
             uint32_t GetServiceComponents(const string& index, Core::JSON::ArrayType<ComponentData>& response) const;
             uint32_t GetTransportInfo(const string& index, TransportInfo& response) const;
             uint32_t GetExtendedEventInfo(const string& index, ExtendedeventinfoData& response) const;
@@ -210,10 +515,13 @@ namespace WPEFramework
             uint32_t FinishServiceSearch(const FinishServiceSearchParamsData& search_params, Core::JSON::Boolean& response);
             uint32_t StartPlaying(const StartPlayingParamsData& play_params, Core::JSON::DecSInt32& play_handle);
             uint32_t StopPlaying(Core::JSON::DecSInt32 play_handle);
+            uint32_t QueryServices(const QueryServicesParamsData& query_params, QueryServicesResultData& response);
+            uint32_t QueryEvents(const QueryEventsParamsData& query_params, QueryEventsResultData& response);
 
             void EventSearchStatus(SearchstatusParamsData& params);
             void EventService(const string& event_name, ServiceupdatedParamsInfo& params);
             void EventEventChanged(EventchangedParamsData& params);
+            void EventEpgChanged(EpgchangedParamsData& params);
 
             string CreateJsonForService(ServiceInfo& service) const;
             string CreateJsonForEITEvent(EiteventInfo& event) const;
@@ -234,6 +542,28 @@ namespace WPEFramework
             PluginHost::IShell *_service;
             Core::Sink<Notification> _notification;
 
+            mutable Core::CriticalSection _indexLock;
+            mutable bool _indexValid;
+            mutable std::vector<IndexedService> _serviceIndex;
+            mutable std::map<string, IndexedSchedule> _scheduleIndex;
+            std::map<string, uint32_t> _serviceVersions;
+            std::map<string, EpgRange> _epgChanges;
+            uint16_t _epgWindow;
+            Core::WorkerPool::JobType<DTV&> _epgJob;
+
+            // Serialises startPlaying/stopPlaying, which own the live and pretune paths
+            Core::CriticalSection _playLock;
+            bool _pretune;
+            U8BIT _livePath;
+            U16BIT _liveLcn;
+            bool _zapUp;
+            U8BIT _pretunePath;
+            void *_pretuneService;
+
+            // Never held across ACTL calls, the DVB event task takes it
+            mutable Core::CriticalSection _zapLock;
+            std::map<U8BIT, ZapTiming> _zapTimings;
+
          private:
             static void DvbEventHandler(U32BIT event, void *event_data, U32BIT data_size);
 
@@ -276,6 +606,7 @@ namespace WPEFramework
 
             void* FindSatellite(const char *satellite_name) const;
 
+            string GetDvbUri(void *service) const;
             void ExtractDvbServiceInfo(ServiceInfo& service, void *serv_ptr) const;
             void ExtractDvbStreamInfo(ComponentData& component, void *stream) const;
             void ExtractDvbTransportInfo(TransportInfo& transport, void *trans_ptr) const;
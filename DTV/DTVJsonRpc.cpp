@@ -54,10 +54,10 @@ namespace WPEFramework
          JSONRPC::Property<Core::JSON::ArrayType<ServiceInfo>>(_T("serviceList"), &DTV::GetServiceList, nullptr, this);
          JSONRPC::Property<NowNextEventsData>(_T("nowNextEvents"), &DTV::GetNowNextEvents, nullptr, this);
          JSONRPC::Property<Core::JSON::ArrayType<EiteventInfo>>(_T("scheduleEvents"), &DTV::GetScheduleEvents, nullptr, this);
-         JSONRPC::Property<StatusData>(_T("status"), &DTV::GetStatus, nullptr, this);
+         JSONRPC::Property<ZapStatusData>(_T("status"), &DTV::GetStatus, nullptr, this);
 
          // Version 2 properties
-         JSONRPC::Property<ServiceInfo>(_T("serviceInfo"), &DTV::GetServiceInfo, nullptr, this);
+         JSONRPC::Property<VersionedServiceInfo>(_T("serviceInfo"), &DTV::GetServiceInfo, nullptr, this);
          JSONRPC::Property<Core::JSON::ArrayType<ComponentData>>(_T("serviceComponents"), &DTV::GetServiceComponents, nullptr, this);
          JSONRPC::Property<TransportInfo>(_T("transportInfo"), &DTV::GetTransportInfo, nullptr, this);
          JSONRPC::Property<ExtendedeventinfoData>(_T("extendedEventInfo"), &DTV::GetExtendedEventInfo, nullptr, this);
@@ -72,6 +72,8 @@ namespace WPEFramework
          JSONRPC::Register<Core::JSON::DecSInt32, void>(_T("stopPlaying"), &DTV::StopPlaying, this);
 
          // Version 2 methods
+         JSONRPC::Register<QueryServicesParamsData, QueryServicesResultData>(_T("queryServices"), &DTV::QueryServices, this);
+         JSONRPC::Register<QueryEventsParamsData, QueryEventsResultData>(_T("queryEvents"), &DTV::QueryEvents, this);
       }
 
       void DTV::UnregisterAll()
@@ -100,6 +102,8 @@ namespace WPEFramework
          JSONRPC::Unregister(_T("finishServiceSearch"));
          JSONRPC::Unregister(_T("startPlaying"));
          JSONRPC::Unregister(_T("stopPlaying"));
+         JSONRPC::Unregister(_T("queryServices"));
+         JSONRPC::Unregister(_T("queryEvents"));
       }
 
       // API implementation
@@ -277,63 +281,39 @@ namespace WPEFramework
       uint32_t DTV::GetServiceList(const string& index, Core::JSON::ArrayType<ServiceInfo>& response) const
       {
          U16BIT onet_id, trans_id;
-         void *transport;
          E_STB_DP_SIGNAL_TYPE signal = SIGNAL_NONE;
-         U16BIT num_services = 0;
-         void **slist = NULL;
 
          SYSLOG(Logging::Notification, (_T("DTV::GetServiceList: %s"), index.c_str()));
 
          // The index may be a doublet specifying a transport, or a tuner type
          int num_args = std::sscanf(index.c_str(), "%hu.%hu", &onet_id, &trans_id);
-         if (num_args == 2)
-         {
-            transport = ADB_GetTransportFromIds(ADB_INVALID_DVB_ID, onet_id, trans_id);
-            if (transport != NULL)
-            {
-               ADB_GetTransportServiceList(transport, &slist, &num_services);
-            }
-         }
-         else
+         if (num_args != 2)
          {
             // Check for a tuner type, otherwise all services will be returned
-            switch(Core::EnumerateType<TunertypeType>(index.c_str()).Value())
-            {
-               case TunertypeType::DVBS:
-                  signal = SIGNAL_QPSK;
-                  break;
-               case TunertypeType::DVBT:
-                  signal = SIGNAL_COFDM;
-                  break;
-               case TunertypeType::DVBC:
-                  signal = SIGNAL_QAM;
-                  break;
-               default:
-                  signal = SIGNAL_NONE;
-                  break;
-            }
-
-            ADB_GetServiceList(ADB_SERVICE_LIST_DIGITAL, &slist, &num_services);
+            signal = GetDvbSignalType(Core::EnumerateType<TunertypeType>(index.c_str()).Value());
          }
 
-         if ((slist != NULL) && (num_services != 0))
-         {
-            BOOLEAN is_sig2;
+         _indexLock.Lock();
+
+         BuildServiceIndex();
 
-            for (U16BIT index = 0; index < num_services; index++)
+         for (const IndexedService& entry : _serviceIndex)
+         {
+            if (num_args == 2)
             {
-               if ((signal == SIGNAL_NONE) || (ADB_GetServiceSignalType(slist[index], &is_sig2) == signal))
+               if ((entry.OnetId == onet_id) && (entry.TransId == trans_id))
                {
-                  ServiceInfo service;
-
-                  ExtractDvbServiceInfo(service, slist[index]);
-                  response.Add(service);
+                  response.Add(entry.Info);
                }
             }
-
-            ADB_ReleaseServiceList(slist, num_services);
+            else if ((signal == SIGNAL_NONE) || (entry.Signal == signal))
+            {
+               response.Add(entry.Info);
+            }
          }
 
+         _indexLock.Unlock();
+
          return (Core::ERROR_NONE);
       }
 
@@ -418,35 +398,28 @@ namespace WPEFramework
                void *service = ADB_FindServiceByIds(onet_id, trans_id, serv_id);
                if (service != NULL)
                {
-                  void **event_list;
-                  U16BIT num_events;
+                  _indexLock.Lock();
 
-                  ADB_GetEventSchedule(FALSE, service, &event_list, &num_events);
-                  if (event_list != NULL)
+                  const IndexedSchedule* schedule = BuildSchedule(service);
+
+                  for (const EiteventInfo& event : schedule->Events)
                   {
-                     U32BIT start_time;
+                     U32BIT start_time = event.Starttime.Value();
 
-                     for (U16BIT i = 0; i < num_events; i++)
+                     if (start_time > end_utc)
+                     {
+                        /* Events are provided in increasing date/time order so all events after
+                         * this will be outside of the requested window and don't need to be checked */
+                        break;
+                     }
+                     else if (start_time >= start_utc)
                      {
-                        start_time = STB_GCConvertToTimestamp(ADB_GetEventStartDateTime(event_list[i]));
-                        if ((start_time >= start_utc) && (start_time <= end_utc))
-                        {
-                           EiteventInfo event;
-
-                           ExtractDvbEventInfo(event, event_list[i]);
-                           response.Add(event);
-                        }
-                        else if (start_time > end_utc)
-                        {
-                           /* Events are provided in increasing date/time order so all events after
-                            * this will be outside of the requested window and don't need to be checked */
-                           break;
-                        }
+                        response.Add(event);
                      }
-
-                     ADB_ReleaseEventList(event_list, num_events);
                   }
 
+                  _indexLock.Unlock();
+
                   result = Core::ERROR_NONE;
                }
             }
@@ -459,7 +432,7 @@ namespace WPEFramework
       // Return codes:
       //  - ERROR_NONE: Success
       //  - ERROR_BAD_REQUEST: invalid play handle
-      uint32_t DTV::GetStatus(const string& index, StatusData& response) const
+      uint32_t DTV::GetStatus(const string& index, ZapStatusData& response) const
       {
          uint32_t result = Core::ERROR_BAD_REQUEST;
 
@@ -491,6 +464,19 @@ namespace WPEFramework
                   response.Dvburi = _T("");
                }
 
+               _zapLock.Lock();
+
+               std::map<U8BIT, ZapTiming>::const_iterator timing(_zapTimings.find(path));
+               if (timing != _zapTimings.end())
+               {
+                  response.Zap.Tunelock = timing->second.TuneLock;
+                  response.Zap.Pmt = timing->second.Pmt;
+                  response.Zap.Firstframe = timing->second.FirstFrame;
+                  response.Zap.Pretuned = timing->second.Pretuned;
+               }
+
+               _zapLock.Unlock();
+
                result = Core::ERROR_NONE;
             }
          }
@@ -506,7 +492,7 @@ namespace WPEFramework
       // Return codes:
       //  - ERROR_NONE: Success
       //  - ERROR_BAD_REQUEST: invalid service URI or service can't be found
-      uint32_t DTV::GetServiceInfo(const string& index, ServiceInfo& response) const
+      uint32_t DTV::GetServiceInfo(const string& index, VersionedServiceInfo& response) const
       {
          uint32_t result = Core::ERROR_BAD_REQUEST;
          U16BIT onet_id, trans_id, serv_id;
@@ -521,6 +507,14 @@ namespace WPEFramework
             if (service != NULL)
             {
                ExtractDvbServiceInfo(response, service);
+
+               _indexLock.Lock();
+
+               std::map<string, uint32_t>::const_iterator version(_serviceVersions.find(response.Dvburi.Value()));
+               response.Version = (version != _serviceVersions.end() ? version->second : 0);
+
+               _indexLock.Unlock();
+
                result = Core::ERROR_NONE;
             }
          }
@@ -876,6 +870,7 @@ namespace WPEFramework
          if (signal != SIGNAL_NONE)
          {
             ADB_FinaliseDatabaseAfterSearch(finish_search.Savechanges, signal, NULL, TRUE, TRUE, FALSE);
+            InvalidateIndex();
             result = Core::ERROR_NONE;
             response = true;
          }
@@ -920,10 +915,33 @@ namespace WPEFramework
          if (service != NULL)
          {
             E_ACTL_PATH_PURPOSE purpose = (monitor_only ? ACTL_PATH_PURPOSE_MONITOR_SI : ACTL_PATH_PURPOSE_STREAM_LIVE);
+            const uint64_t started = Core::Time::Now().Ticks();
+
+            _playLock.Lock();
+
+            const bool pretuned = ((_pretuneService != nullptr) && (service == _pretuneService));
 
             U8BIT decode_path = ACTL_TuneToService(INVALID_RES_ID, NULL, service, FALSE, purpose);
+            if ((decode_path == INVALID_RES_ID) && (_pretunePath != INVALID_RES_ID))
+            {
+               // The pretune path may be holding the only tuner that is left
+               ReleasePretune();
+               decode_path = ACTL_TuneToService(INVALID_RES_ID, NULL, service, FALSE, purpose);
+            }
+
             if (decode_path != INVALID_RES_ID)
             {
+               ZapTiming timing = { started, 0, 0, 0, pretuned };
+
+               _zapLock.Lock();
+               _zapTimings[decode_path] = timing;
+               _zapLock.Unlock();
+
+               if (_pretune && !monitor_only)
+               {
+                  Pretune(service, decode_path);
+               }
+
                play_handle = decode_path;
                result = Core::ERROR_NONE;
             }
@@ -932,6 +950,8 @@ namespace WPEFramework
                play_handle = -1;
             }
 
+            _playLock.Unlock();
+
             SYSLOG(Logging::Notification, (_T("DTV::StartPlaying: %d"), play_handle.Value()));
          }
 
@@ -945,13 +965,150 @@ namespace WPEFramework
          if (play_handle.Value() >= 0)
          {
             U8BIT decode_path = (U8BIT)play_handle.Value();
+
+            _playLock.Lock();
+
             ACTL_TuneOff(decode_path);
             ACTL_ReleasePath(decode_path);
+
+            if (decode_path == _livePath)
+            {
+               ReleasePretune();
+               _livePath = INVALID_RES_ID;
+            }
+
+            _playLock.Unlock();
+
+            _zapLock.Lock();
+            _zapTimings.erase(decode_path);
+            _zapLock.Unlock();
          }
 
          return(Core::ERROR_NONE);
       }
 
+      // Method: queryServices - get a page of the services matching the given filter
+      // Return codes:
+      //  - ERROR_NONE: Success
+      //  - ERROR_BAD_REQUEST: invalid tuner type or transport
+      uint32_t DTV::QueryServices(const QueryServicesParamsData& query_params, QueryServicesResultData& response)
+      {
+         uint32_t result = Core::ERROR_NONE;
+         U16BIT onet_id = 0;
+         U16BIT trans_id = 0;
+         bool by_transport = false;
+         E_STB_DP_SIGNAL_TYPE signal = SIGNAL_NONE;
+
+         if (query_params.Transport.IsSet())
+         {
+            by_transport = (std::sscanf(query_params.Transport.Value().c_str(), "%hu.%hu", &onet_id, &trans_id) == 2);
+            if (!by_transport)
+            {
+               result = Core::ERROR_BAD_REQUEST;
+            }
+         }
+
+         if (query_params.Tunertype.IsSet())
+         {
+            signal = GetDvbSignalType(query_params.Tunertype);
+            if (signal == SIGNAL_NONE)
+            {
+               result = Core::ERROR_BAD_REQUEST;
+            }
+         }
+
+         if (result == Core::ERROR_NONE)
+         {
+            const uint32_t first = query_params.Offset.Value();
+            const uint32_t last = (query_params.Limit.Value() != 0 ? first + query_params.Limit.Value() : ~0U);
+            const uint16_t lcn_from = query_params.Lcnfrom.Value();
+            const uint16_t lcn_to = query_params.Lcnto.Value();
+            uint16_t total = 0;
+
+            _indexLock.Lock();
+
+            BuildServiceIndex();
+
+            for (const IndexedService& entry : _serviceIndex)
+            {
+               const uint16_t lcn = entry.Info.Lcn.Value();
+
+               if (((signal == SIGNAL_NONE) || (entry.Signal == signal)) &&
+                  (!by_transport || ((entry.OnetId == onet_id) && (entry.TransId == trans_id))) &&
+                  (lcn >= lcn_from) && (lcn <= lcn_to))
+               {
+                  if ((total >= first) && (total < last))
+                  {
+                     response.Services.Add(entry.Info);
+                  }
+
+                  total++;
+               }
+            }
+
+            _indexLock.Unlock();
+
+            response.Total = total;
+         }
+
+         return (result);
+      }
+
+      // Method: queryEvents - get a page of the scheduled EIT events of a service that start in the given window
+      // Return codes:
+      //  - ERROR_NONE: Success
+      //  - ERROR_BAD_REQUEST: invalid service URI or service can't be found
+      uint32_t DTV::QueryEvents(const QueryEventsParamsData& query_params, QueryEventsResultData& response)
+      {
+         uint32_t result = Core::ERROR_BAD_REQUEST;
+         U16BIT onet_id, trans_id, serv_id;
+
+         if (query_params.Dvburi.IsSet() &&
+            (std::sscanf(query_params.Dvburi.Value().c_str(), "%hu.%hu.%hu", &onet_id, &trans_id, &serv_id) == 3))
+         {
+            void *service = ADB_FindServiceByIds(onet_id, trans_id, serv_id);
+            if (service != NULL)
+            {
+               const U32BIT start_utc = query_params.Starttime.Value();
+               const U32BIT end_utc = query_params.Endtime.Value();
+               const uint32_t first = query_params.Offset.Value();
+               const uint32_t last = (query_params.Limit.Value() != 0 ? first + query_params.Limit.Value() : ~0U);
+               uint16_t total = 0;
+
+               _indexLock.Lock();
+
+               const IndexedSchedule* schedule = BuildSchedule(service);
+
+               for (const EiteventInfo& event : schedule->Events)
+               {
+                  U32BIT start_time = event.Starttime.Value();
+
+                  if (start_time > end_utc)
+                  {
+                     // Events are in increasing date/time order
+                     break;
+                  }
+                  else if (start_time >= start_utc)
+                  {
+                     if ((total >= first) && (total < last))
+                     {
+                        response.Events.Add(event);
+                     }
+
+                     total++;
+                  }
+               }
+
+               _indexLock.Unlock();
+
+               response.Total = total;
+               result = Core::ERROR_NONE;
+            }
+         }
+
+         return (result);
+      }
+
       void DTV::EventSearchStatus(SearchstatusParamsData& params)
       {
          Notify(_T("searchstatus"), params);
@@ -967,6 +1124,11 @@ namespace WPEFramework
          Notify(_T("eventchanged"), params);
       }
 
+      void DTV::EventEpgChanged(EpgchangedParamsData& params)
+      {
+         Notify(_T("epgchanged"), params);
+      }
+
       void DTV::ExtractDvbServiceInfo(ServiceInfo& service, void *serv_ptr) const
       {
          U8BIT *name;
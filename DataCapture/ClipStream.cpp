@@ -0,0 +1,277 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ClipStream.h"
+
+#include "socket_adaptor.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef USE_FLAC
+#include <FLAC/stream_encoder.h>
+#endif
+
+#define CLIP_STREAM_CHUNK (16 * 1024)
+#define CLIP_STREAM_FLAC_LEVEL 5
+
+namespace WPEFramework {
+    namespace Plugin {
+
+#ifdef USE_FLAC
+        struct ClipStream::Encoder {
+            FLAC__StreamEncoder* encoder = nullptr;
+            std::vector<FLAC__int32> samples;
+        };
+
+        static FLAC__StreamEncoderWriteStatus FlacWriteCallback(const FLAC__StreamEncoder*, const FLAC__byte buffer[], size_t bytes, unsigned, unsigned, void* client_data)
+        {
+            static_cast<ClipStream*>(client_data)->append(buffer, bytes);
+            return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+        }
+#else
+        struct ClipStream::Encoder {
+        };
+#endif
+
+        ClipStream::ClipStream(socket_adaptor& source, Compression compression, const Format& format)
+            : _source(source)
+            , _compression(compression)
+            , _format(format)
+            , _failed(false)
+            , _done(false)
+            , _consumed(0)
+            , _produced(0)
+            , _inputOffset(0)
+            , _pendingOffset(0)
+            , _encoder(nullptr)
+        {
+        }
+
+        ClipStream::~ClipStream()
+        {
+            release();
+            _source.close_socket();
+        }
+
+        bool ClipStream::supported(Compression compression, const Format& format)
+        {
+            bool result = (NONE == compression);
+#ifdef USE_FLAC
+            result = result || ((FLAC == compression) && (16 == format.bitsPerSample) && (0 < format.channels) && (8 >= format.channels) && (0 < format.sampleRate));
+#else
+            (void)format;
+#endif
+            return result;
+        }
+
+        const char* ClipStream::contentType() const
+        {
+            return (FLAC == _compression) ? "audio/flac" : "audio/x-wav";
+        }
+
+        void ClipStream::append(const unsigned char* data, size_t length)
+        {
+            _pending.insert(_pending.end(), data, data + length);
+            _produced += length;
+        }
+
+        bool ClipStream::start()
+        {
+            release();
+            _failed = false;
+            _done = false;
+            _consumed = 0;
+            _produced = 0;
+            _input.clear();
+            _inputOffset = 0;
+            _pending.clear();
+            _pendingOffset = 0;
+
+            if (!supported(_compression, _format))
+            {
+                LOGERR("Unsupported compression %d for %u channels of %u bits", (int)_compression, _format.channels, _format.bitsPerSample);
+                _failed = true;
+                return false;
+            }
+
+            if (!fill() || _input.empty())
+                return false;
+
+#ifdef USE_FLAC
+            if (FLAC == _compression)
+            {
+                _encoder = new Encoder();
+                _encoder->encoder = FLAC__stream_encoder_new();
+
+                if ((nullptr == _encoder->encoder)
+                    || !FLAC__stream_encoder_set_channels(_encoder->encoder, _format.channels)
+                    || !FLAC__stream_encoder_set_bits_per_sample(_encoder->encoder, _format.bitsPerSample)
+                    || !FLAC__stream_encoder_set_sample_rate(_encoder->encoder, _format.sampleRate)
+                    || !FLAC__stream_encoder_set_compression_level(_encoder->encoder, CLIP_STREAM_FLAC_LEVEL)
+                    || (FLAC__STREAM_ENCODER_INIT_STATUS_OK != FLAC__stream_encoder_init_stream(_encoder->encoder, FlacWriteCallback, nullptr, nullptr, nullptr, this)))
+                {
+                    LOGERR("Failed to set up the FLAC encoder");
+                    _failed = true;
+                    release();
+                }
+            }
+#endif
+            return !_failed;
+        }
+
+        // Reads the next part of the clip behind what is left of the previous one.
+        bool ClipStream::fill()
+        {
+            size_t left = _input.size() - _inputOffset;
+
+            if (0 < _inputOffset)
+            {
+                memmove(_input.data(), _input.data() + _inputOffset, left);
+                _inputOffset = 0;
+            }
+            _input.resize(left + CLIP_STREAM_CHUNK);
+
+            int length = _source.read_data(reinterpret_cast<char*>(_input.data() + left), CLIP_STREAM_CHUNK);
+
+            _input.resize(left + std::max(length, 0));
+            if (0 < length)
+                _consumed += length;
+            else
+                _done = true;
+
+            if (0 > length)
+                _failed = true;
+
+            return (0 < length);
+        }
+
+        size_t ClipStream::read(unsigned char* buffer, size_t size)
+        {
+            size_t copied = 0;
+
+            if (NONE == _compression)
+            {
+                // Bytes read ahead by start() first, then straight from the socket into the caller's buffer.
+                if (_inputOffset < _input.size())
+                {
+                    copied = std::min(size, _input.size() - _inputOffset);
+                    memcpy(buffer, _input.data() + _inputOffset, copied);
+                    _inputOffset += copied;
+                }
+                else if (!_done && !_failed)
+                {
+                    int length = _source.read_data(reinterpret_cast<char*>(buffer), size);
+                    if (0 < length)
+                    {
+                        copied = length;
+                        _consumed += length;
+                    }
+                    else
+                    {
+                        _done = true;
+                        _failed = (0 > length);
+                    }
+                }
+            }
+            else
+            {
+                while ((copied < size) && !_failed)
+                {
+                    if (_pendingOffset < _pending.size())
+                    {
+                        size_t length = std::min(size - copied, _pending.size() - _pendingOffset);
+                        memcpy(buffer + copied, &_pending[_pendingOffset], length);
+                        _pendingOffset += length;
+                        copied += length;
+                    }
+                    else if (nullptr == _encoder)
+                    {
+                        break;
+                    }
+                    else
+                    {
+                        // Keeps the capacity, the encoder refills it with about the same amount.
+                        _pending.clear();
+                        _pendingOffset = 0;
+
+                        if (!_done)
+                            fill();
+                        encode(_done);
+                    }
+                }
+            }
+
+            return _failed ? 0 : copied;
+        }
+
+        void ClipStream::encode(bool last)
+        {
+#ifdef USE_FLAC
+            const size_t frameBytes = _format.channels * 2;
+            const size_t frames = (_input.size() - _inputOffset) / frameBytes;
+            const unsigned char* pcm = _input.data() + _inputOffset;
+
+            _encoder->samples.resize(frames * _format.channels);
+            for (size_t i = 0; i < _encoder->samples.size(); i++, pcm += 2)
+                _encoder->samples[i] = static_cast<int16_t>(pcm[0] | (pcm[1] << 8));
+
+            _inputOffset += frames * frameBytes;
+
+            if ((0 < frames) && !FLAC__stream_encoder_process_interleaved(_encoder->encoder, _encoder->samples.data(), frames))
+            {
+                LOGERR("FLAC encoding failed: %s", FLAC__stream_encoder_get_resolved_state_string(_encoder->encoder));
+                _failed = true;
+            }
+
+            if (last && !_failed)
+            {
+                if (_inputOffset < _input.size())
+                    LOGWARN("Dropping %u bytes of an incomplete sample", (unsigned)(_input.size() - _inputOffset));
+                if (!FLAC__stream_encoder_finish(_encoder->encoder))
+                {
+                    LOGERR("Failed to finish the FLAC stream");
+                    _failed = true;
+                }
+            }
+
+            if (last || _failed)
+                release();
+#else
+            (void)last;
+            _failed = true;
+#endif
+        }
+
+        void ClipStream::release()
+        {
+#ifdef USE_FLAC
+            if (nullptr != _encoder)
+            {
+                if (nullptr != _encoder->encoder)
+                    FLAC__stream_encoder_delete(_encoder->encoder);
+                delete _encoder;
+                _encoder = nullptr;
+            }
+#endif
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,89 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class socket_adaptor;
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Passes an audio clip on from the audiocapturemgr socket while it is being
+        // read, optionally FLAC encoded. Only one socket read worth of samples and the
+        // encoded bytes not read yet are held, never the clip.
+        class ClipStream {
+        public:
+            enum Compression { NONE, FLAC };
+
+            // Interleaved little endian PCM as delivered by audiocapturemgr
+            struct Format {
+                unsigned int channels;
+                unsigned int bitsPerSample;
+                unsigned int sampleRate;
+            };
+
+            ClipStream(socket_adaptor& source, Compression compression, const Format& format);
+            ~ClipStream();
+
+            static bool supported(Compression compression, const Format& format);
+
+            // Reads the first part of the clip from the connected socket, false if there is none.
+            bool start();
+
+            // Next bytes of the upload, 0 once the clip is complete (or failed()).
+            size_t read(unsigned char* buffer, size_t size);
+
+            bool failed() const { return _failed; }
+            size_t consumed() const { return _consumed; }
+            size_t produced() const { return _produced; }
+            const char* contentType() const;
+
+            // Output of the encoder, and its state (ClipStream.cpp).
+            void append(const unsigned char* data, size_t length);
+            struct Encoder;
+
+        private:
+            ClipStream(const ClipStream&) = delete;
+            ClipStream& operator=(const ClipStream&) = delete;
+
+            bool fill();
+            void encode(bool last);
+            void release();
+
+        private:
+            socket_adaptor& _source;
+            Compression _compression;
+            Format _format;
+            bool _failed;
+            bool _done;
+            size_t _consumed;
+            size_t _produced;
+            std::vector<unsigned char> _input;
+            size_t _inputOffset;
+            std::vector<unsigned char> _pending;
+            size_t _pendingOffset;
+            Encoder* _encoder;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
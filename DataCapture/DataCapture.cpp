@@ -73,6 +73,7 @@ namespace WPEFramework {
             , _max_supported_duration(0)
             , _is_precapture(false)
             , _duration(0)
+            , _compression(ClipStream::NONE)
         {
             LOGINFO("ctor");
 
@@ -301,9 +302,10 @@ namespace WPEFramework {
             _duration = (unsigned int)clipRequest["duration"].Number();
             const string& captureMode = clipRequest["captureMode"].String();
             _is_precapture = (captureMode == "preCapture");
+            const string compression = clipRequest.HasLabel("compression") ? clipRequest["compression"].String() : string("none");
 
-            LOGINFO("DataCaptureService calling getAudioClip: stream = %s, url = %s, duration = %d, captureMode = %s, session id = %d",
-                         stream.c_str(), _destination_url.c_str(), _duration, captureMode.c_str(), _session_id);
+            LOGINFO("DataCaptureService calling getAudioClip: stream = %s, url = %s, duration = %d, captureMode = %s, compression = %s, session id = %d",
+                         stream.c_str(), _destination_url.c_str(), _duration, captureMode.c_str(), compression.c_str(), _session_id);
 
             if(0 > _session_id)
             {
@@ -311,6 +313,22 @@ namespace WPEFramework {
                 return ACM_RESULT_GENERAL_FAILURE;
             }
 
+            if(compression == "flac")
+                _compression = ClipStream::FLAC;
+            else if(compression == "none")
+                _compression = ClipStream::NONE;
+            else
+            {
+                LOGERR("Unknown compression '%s'.", compression.c_str());
+                return ACM_RESULT_GENERAL_FAILURE;
+            }
+
+            if(!ClipStream::supported(_compression, clipFormat()))
+            {
+                LOGERR("Compression '%s' is not available for this audio format.", compression.c_str());
+                return ACM_RESULT_GENERAL_FAILURE;
+            }
+
             if(stream != "primary")
             {
                 LOGERR("Error! Audiocapture supports only primary audio.");
@@ -374,6 +392,39 @@ namespace WPEFramework {
             LOGINFO("New format string is %s", _audio_format_string.c_str());
         }
 
+        ClipStream::Format DataCapture::clipFormat() const
+        {
+            ClipStream::Format format = { 0, 0, 0 };
+
+            switch(_audio_properties.format)
+            {
+                case acmFormate16BitStereo:
+                    format.channels = 2; format.bitsPerSample = 16; break;
+                case acmFormate16BitMonoLeft: //fall-through
+                case acmFormate16BitMonoRight: //fall-through
+                case acmFormate16BitMono:
+                    format.channels = 1; format.bitsPerSample = 16; break;
+                case acmFormate24BitStereo:
+                    format.channels = 2; format.bitsPerSample = 24; break;
+                case acmFormate24Bit5_1:
+                    format.channels = 6; format.bitsPerSample = 24; break;
+                default:
+                    break;
+            }
+
+            switch(_audio_properties.sampling_frequency)
+            {
+                case acmFreqe48000: format.sampleRate = 48000; break;
+                case acmFreqe44100: format.sampleRate = 44100; break;
+                case acmFreqe32000: format.sampleRate = 32000; break;
+                case acmFreqe24000: format.sampleRate = 24000; break;
+                case acmFreqe16000: format.sampleRate = 16000; break;
+                default: break;
+            }
+
+            return format;
+        }
+
         void DataCapture::iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
             pthread_mutex_lock(&_mutex);
@@ -402,33 +453,36 @@ namespace WPEFramework {
                 pos = dataLocator.rfind(delimiter);
                 fileName = dataLocator.substr(pos + delimiter.length(), dataLocator.length());
                 int attemptsLeft = 2;
-                vector<unsigned char> data;
                 int time_wait_sec = 1;
+                bool gotData = false;
+                ClipStream clip(*_sock_adaptor, _compression, clipFormat());
 
                 JsonObject params;
                 params["fileName"] = fileName;
 
+                // The clip is passed on to the upload while it is read, it is never held here as a whole
                 while (attemptsLeft) {
-                    if(0 == _sock_adaptor->connect_socket(payload->dataLocator))
+                    if(0 == _sock_adaptor->connect_socket(payload->dataLocator) && clip.start())
                     {
-                        _sock_adaptor->get_data(data); // closes the socket
-                        if (data.size() > 0) {
-                            LOGINFO("Got a clip: %u bytes", data.size());
-                            break;
-                        } else {
-                            LOGWARN("No data in the socket. One more attempt in %d sec", time_wait_sec);
-                            usleep(1000 * 1000 * time_wait_sec);
-                            --attemptsLeft;
-                            continue;
-                        }
+                        gotData = true;
+                        break;
+                    }
+                    if(clip.failed())
+                        break;
+
+                    --attemptsLeft;
+                    if(attemptsLeft) {
+                        LOGWARN("No data in the socket. One more attempt in %d sec", time_wait_sec);
+                        usleep(1000 * 1000 * time_wait_sec);
                     }
                 }
 
-                if(data.size() > 0)
+                if(gotData)
                 {
                     std::string error_str;
-                    if (uploadDataToUrl(data, _destination_url.c_str(), error_str))
+                    if (uploadDataToUrl(clip, _destination_url.c_str(), error_str))
                     {
+                        LOGINFO("Uploaded a clip: %u bytes read, %u bytes sent", (unsigned)clip.consumed(), (unsigned)clip.produced());
                         params["status"] = true;
                         params["message"] = "Success";
 
@@ -437,18 +491,6 @@ namespace WPEFramework {
                         params["status"] = false;
                         params["message"] = std::string("Upload Failed: ") + error_str;
                     }
-
-                    // Optionally, we can save a file
-//                    FILE * pFile;
-//                    const char* path = strcat(payload->dataLocator, ".received.pcm");
-//                    pFile = fopen (path, "wb");
-//                    fwrite (&data[0] , sizeof(unsigned char), data.size(), pFile);
-//                    fclose (pFile);
-                    // now, upload it, then remove:
-//                    if (remove(path) != 0)
-//                    {
-//                        LOGERR("Unable to delete %s", path);
-//                    }
                 } else {
                     LOGERR("Unable to read data from %s (connection error)", payload->dataLocator);
                     params["status"] = false;
@@ -462,7 +504,15 @@ namespace WPEFramework {
             }
         }
 
-        bool DataCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        static size_t ClipStreamReadCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+        {
+            ClipStream *stream = static_cast<ClipStream*>(userdata);
+            size_t length = stream->read((unsigned char*)buffer, size * nitems);
+
+            return stream->failed() ? CURL_READFUNC_ABORT : length;
+        }
+
+        bool DataCapture::uploadDataToUrl(ClipStream &stream, const char *url, std::string &error_str)
         {
             CURL *curl;
             CURLcode res;
@@ -474,7 +524,7 @@ namespace WPEFramework {
                 return false;
             }
 
-            LOGWARN("uploading pcm data of size %u to '%s'", data.size(), url);
+            LOGWARN("uploading %s data to '%s'", stream.contentType(), url);
 
             //init curl
             curl_global_init(CURL_GLOBAL_ALL);
@@ -486,21 +536,29 @@ namespace WPEFramework {
                 return false;
             }
 
-            //create header
+            //create header, the size is not known up front
             struct curl_slist *chunk = NULL;
-            chunk = curl_slist_append(chunk, "Content-Type: audio/x-wav");
+            chunk = curl_slist_append(chunk, (std::string("Content-Type: ") + stream.contentType()).c_str());
+            chunk = curl_slist_append(chunk, "Transfer-Encoding: chunked");
 
-            //set url and data
+            //set url and data, read from the socket while curl sends it
             curl_easy_setopt(curl, CURLOPT_URL, url);
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, ClipStreamReadCallback);
+            curl_easy_setopt(curl, CURLOPT_READDATA, &stream);
 
             //perform blocking upload call
             res = curl_easy_perform(curl);
 
             //output success / failure log
-            if(CURLE_OK == res)
+            if(stream.failed())
+            {
+                LOGERR("reading or encoding the clip failed during upload");
+                error_str = "Failed to read the clip";
+                call_succeeded = false;
+            }
+            else if(CURLE_OK == res)
             {
                 long response_code;
 
@@ -22,6 +22,7 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "ClipStream.h"
 #include "libIBus.h"
 //#include "irMgr.h"
 
@@ -63,7 +64,8 @@ namespace WPEFramework {
             int enableAudioCapture(unsigned int bufferMaxDuration);
             int getAudioClip(const JsonObject& clipRequest);
             void constructFormatString();
-            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str);
+            ClipStream::Format clipFormat() const;
+            bool uploadDataToUrl(ClipStream &stream, const char *url, std::string &error_str);
         private/*members*/:
             audiocapturemgr::session_id_t _session_id;
             unsigned int _max_supported_duration;
@@ -73,6 +75,7 @@ namespace WPEFramework {
             string _destination_url;
             bool _is_precapture;
             unsigned int _duration;
+            ClipStream::Compression _compression;
             static pthread_mutex_t _mutex;
         };
     } // namespace Plugin
@@ -81,6 +81,7 @@ int socket_adaptor::connect_socket(const std::string &path)
         } else {
             SA_ERR("connect() failed\n");
             close(m_read_fd);
+            m_read_fd = -1;
             ret = -1;
             return ret;
 
@@ -157,6 +158,41 @@ unsigned int socket_adaptor::fetch_data()
     return total_size;
 }
 
+int socket_adaptor::read_data(char * buffer, const unsigned int size)
+{
+    if(m_read_fd < 0) {
+        SA_ERR("Unable to read data. Did you connect?");
+        return -1;
+    }
+
+    int ret;
+    do
+    {
+        ret = read(m_read_fd, buffer, size);
+    } while((0 > ret) && (EINTR == errno));
+
+    if(0 > ret)
+    {
+        SA_ERR("read() failed. errno: 0x%x\n", errno);
+    }
+    if(0 >= ret)
+    {
+        close_socket();
+    }
+    return ret;
+}
+
+void socket_adaptor::close_socket()
+{
+    lock();
+    if(0 <= m_read_fd)
+    {
+        close(m_read_fd);
+        m_read_fd = -1;
+    }
+    unlock();
+}
+
 void socket_adaptor::get_data(std::vector<unsigned char>& data)
 {
     if (m_fetch_buffer.empty())
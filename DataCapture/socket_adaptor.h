@@ -125,6 +125,23 @@ class socket_adaptor
      */
     void get_data(std::vector<unsigned char>& data);
 
+    /**
+     *  @brief This api invokes unix read() once to read the next part of the data from the connected socket
+     *
+     *  The socket is closed once all data was read or on error, like fetch_data() does.
+     *
+     *  @param[in] buffer Buffer to read into.
+     *  @param[in] size   Size of the buffer
+     *
+     *  @return Returns length of the data read, 0 at the end of the data or -1 in case of an error
+     */
+    int read_data(char * buffer, const unsigned int size);
+
+    /**
+     *  @brief This api closes the socket connected with connect_socket(), e.g. to abandon a transfer.
+     */
+    void close_socket();
+
     /**
     *  @brief This api provides the previously fetched data
      *
@@ -22,13 +22,27 @@
 #include <curl/curl.h>
 #include <time.h>
 
+#include <chrono>
+
 #include "utils.h"
 
 #define DEVICE_DIAGNOSTICS_METHOD_NAME_GET_CONFIGURATION  "getConfiguration"
 #define DEVICE_DIAGNOSTICS_METHOD_GET_AV_DECODER_STATUS "getAVDecoderStatus"
+#define DEVICE_DIAGNOSTICS_METHOD_GET_AV_DECODER_STATISTICS "getAVDecoderStatistics"
 
 #define DEVICE_DIAGNOSTICS_EVT_ON_AV_DECODER_STATUS_CHANGED "onAVDecoderStatusChanged"
 
+#define DEVICE_DIAGNOSTICS_AGENT_URL "http://127.0.0.1:10999"
+/* How long a parameter value is served from the cache */
+#define DEVICE_DIAGNOSTICS_CACHE_TTL_MS 3000
+/* After a failed request the agent is not asked again for this long, the callers get the cached values or fail right away */
+#define DEVICE_DIAGNOSTICS_AGENT_BACKOFF_MS 10000
+
+/* Decoder status poll interval by the last status: fast while playing, so that stalls are seen, slow when idle */
+#define DEVICE_DIAGNOSTICS_POLL_ACTIVE_MS 1000
+#define DEVICE_DIAGNOSTICS_POLL_PAUSED_MS 5000
+#define DEVICE_DIAGNOSTICS_POLL_IDLE_MS 30000
+
 namespace WPEFramework
 {
     namespace Plugin
@@ -37,29 +51,48 @@ namespace WPEFramework
 
         DeviceDiagnostics* DeviceDiagnostics::_instance = nullptr;
 
-        const int curlTimeoutInSeconds = 30;
+        // The agent is local, if it doesn't answer within this it is hung
+        const int curlTimeoutInSeconds = 5;
+        const int curlConnectTimeoutInSeconds = 1;
         static const char *decoderStatusStr[] = {
             "IDLE",
             "PAUSED",
             "ACTIVE",
             NULL
         };
+        // Indices of decoderStatusStr, the values of the ERM states
+        static const int decoderStatusPaused = 1;
+        static const int decoderStatusActive = 2;
 
-        static size_t writeCurlResponse(void *ptr, size_t size, size_t nmemb, std::string stream)
+        static size_t writeCurlResponse(void *ptr, size_t size, size_t nmemb, void *stream)
         {
           size_t realsize = size * nmemb;
-          std::string temp(static_cast<const char*>(ptr), realsize);
-          stream.append(temp);
+          static_cast<std::string*>(stream)->append(static_cast<const char*>(ptr), realsize);
           return realsize;
         }
 
+        static uint64_t monotonicMs()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
         DeviceDiagnostics::DeviceDiagnostics()
         : AbstractPlugin()
+        , m_curl(nullptr)
+        , m_agentBackoffUntilMs(0)
         {
             DeviceDiagnostics::_instance = this;
 
             registerMethod(DEVICE_DIAGNOSTICS_METHOD_NAME_GET_CONFIGURATION, &DeviceDiagnostics::getConfigurationWrapper, this);
             registerMethod(DEVICE_DIAGNOSTICS_METHOD_GET_AV_DECODER_STATUS, &DeviceDiagnostics::getAVDecoderStatus, this);
+            registerMethod(DEVICE_DIAGNOSTICS_METHOD_GET_AV_DECODER_STATISTICS, &DeviceDiagnostics::getAVDecoderStatistics, this);
+
+            m_decoderStats.status = 0;
+            m_decoderStats.changes = 0;
+            m_decoderStats.stalls = 0;
+            m_decoderStats.stallTotalMs = 0;
+            m_decoderStats.stallLongestMs = 0;
+            m_decoderStats.stallStartMs = 0;
         }
 
         DeviceDiagnostics::~DeviceDiagnostics()
@@ -93,9 +126,22 @@ namespace WPEFramework
             m_AVDecoderStatusLock.lock();
             m_pollThreadRun = 0;
             m_AVDecoderStatusLock.unlock();
+            m_AVPollCondition.notify_all();
             m_AVPollThread.join();
             EssRMgrDestroy(m_EssRMgr);
 #endif
+            {
+                std::lock_guard<std::timed_mutex> lock(m_curlLock);
+                if (m_curl != nullptr)
+                {
+                    curl_easy_cleanup(m_curl);
+                    m_curl = nullptr;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_cacheLock);
+                m_cache.clear();
+            }
             DeviceDiagnostics::_instance = nullptr;
         }
 
@@ -104,31 +150,19 @@ namespace WPEFramework
             LOGINFOMETHOD();
 
             JsonArray names = parameters["names"].Array();
-
-            JsonObject requestParams;
-            JsonArray namePairs;
+            std::vector<std::string> nameList;
 
             JsonArray::Iterator index(names.Elements());
 
             while (index.Next() == true)
             {
                 if (Core::JSON::Variant::type::STRING == index.Current().Content())
-                {
-                    //JSON::String s = index.Current().String();
-                    JsonObject o;
-                    o["name"] = index.Current().String();
-                    namePairs.Add(o);
-                }
+                    nameList.push_back(index.Current().String());
                 else
                     LOGWARN("Unexpected variant type");
             }
 
-            requestParams["paramList"] = namePairs;
-
-            string json;
-            requestParams.ToString(json);
-
-            if (0 == getConfiguration(json, response))
+            if (0 == getConfiguration(nameList, response))
                 returnResponse(true);
 
             returnResponse(false);
@@ -147,40 +181,71 @@ namespace WPEFramework
             return status;
         }
 
-        /* periodically polls ERM library for changes in most
-         * active decoder and send thunder event when decoder
-         * status changes. Needs to be done via poll and separate
-         * thread because ERM doesn't support events. */
+        /* polls ERM library for changes in most active decoder and
+         * sends thunder event when decoder status changes. Needs to be
+         * done via poll and separate thread because ERM doesn't support
+         * events. The interval follows the status, and getAVDecoderStatus
+         * reports a change it sees right away. */
 #ifdef ENABLE_ERM
         void *DeviceDiagnostics::AVPollThread(void *arg)
         {
-            struct timespec poll_wait = { .tv_sec = 30, .tv_nsec = 0  };
-            int lastStatus = EssRMgrRes_idle;
-            int status;
             DeviceDiagnostics* t = DeviceDiagnostics::_instance;
 
             LOGINFO("AVPollThread started");
+            std::unique_lock<std::mutex> lock(t->m_AVDecoderStatusLock);
             for (;;)
             {
-                nanosleep(&poll_wait, NULL);
-                std::unique_lock<std::mutex> lock(t->m_AVDecoderStatusLock);
+                int interval = DEVICE_DIAGNOSTICS_POLL_IDLE_MS;
+                if (t->m_decoderStats.status == decoderStatusActive)
+                    interval = DEVICE_DIAGNOSTICS_POLL_ACTIVE_MS;
+                else if (t->m_decoderStats.status == decoderStatusPaused)
+                    interval = DEVICE_DIAGNOSTICS_POLL_PAUSED_MS;
+
+                t->m_AVPollCondition.wait_for(lock, std::chrono::milliseconds(interval));
                 if (t->m_pollThreadRun == 0)
                     break;
 
-                status = t->getMostActiveDecoderStatus();
+                int status = t->getMostActiveDecoderStatus();
+                bool changed = t->updateDecoderStatus(status);
                 lock.unlock();
 
-                if (status == lastStatus)
-                    continue;
+                if (changed)
+                    t->onDecoderStatusChange(status);
 
-                lastStatus = status;
-                t->onDecoderStatusChange(status);
+                lock.lock();
             }
 
             return NULL;
         }
 #endif
 
+        /* Caller holds m_AVDecoderStatusLock. A stall is the decoder dropping from
+         * ACTIVE to PAUSED, it lasts until the decoder is ACTIVE again or goes IDLE. */
+        bool DeviceDiagnostics::updateDecoderStatus(int status)
+        {
+            DecoderStatistics& stats = m_decoderStats;
+            if (status == stats.status)
+                return false;
+
+            uint64_t now = monotonicMs();
+            if (stats.stallStartMs != 0)
+            {
+                uint64_t duration = now - stats.stallStartMs;
+                stats.stallTotalMs += duration;
+                stats.stallLongestMs = std::max(stats.stallLongestMs, duration);
+                stats.stallStartMs = 0;
+            }
+            if (stats.status == decoderStatusActive && status == decoderStatusPaused)
+            {
+                stats.stalls++;
+                stats.stallStartMs = now;
+            }
+
+            stats.status = status;
+            stats.changes++;
+            return true;
+        }
+
         void DeviceDiagnostics::onDecoderStatusChange(int status)
         {
             JsonObject params;
@@ -194,7 +259,14 @@ namespace WPEFramework
 #ifdef ENABLE_ERM
             m_AVDecoderStatusLock.lock();
             int status = getMostActiveDecoderStatus();
+            bool changed = updateDecoderStatus(status);
             m_AVDecoderStatusLock.unlock();
+            if (changed)
+            {
+                // the poll interval depends on the status
+                m_AVPollCondition.notify_all();
+                onDecoderStatusChange(status);
+            }
             response["avDecoderStatus"] = decoderStatusStr[status];
 #else
             response["avDecoderStatus"] = decoderStatusStr[0];
@@ -202,36 +274,181 @@ namespace WPEFramework
             returnResponse(true);
         }
 
-        int DeviceDiagnostics::getConfiguration(const std::string& postData, JsonObject& out)
+        uint32_t DeviceDiagnostics::getAVDecoderStatistics(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool reset = false;
+            getDefaultBoolParameter("reset", reset, false);
+
+#ifdef ENABLE_ERM
+            std::lock_guard<std::mutex> lock(m_AVDecoderStatusLock);
+#endif
+            DecoderStatistics& stats = m_decoderStats;
+            uint64_t stallTotalMs = stats.stallTotalMs;
+            uint64_t stallLongestMs = stats.stallLongestMs;
+            if (stats.stallStartMs != 0)
+            {
+                uint64_t current = monotonicMs() - stats.stallStartMs;
+                stallTotalMs += current;
+                stallLongestMs = std::max(stallLongestMs, current);
+            }
+
+            response["avDecoderStatus"] = decoderStatusStr[stats.status];
+            response["statusChanges"] = stats.changes;
+            response["stallCount"] = stats.stalls;
+            response["stallTotalMs"] = stallTotalMs;
+            response["stallLongestMs"] = stallLongestMs;
+            response["stalled"] = (stats.stallStartMs != 0);
+
+            if (reset)
+            {
+                stats.changes = 0;
+                stats.stalls = (stats.stallStartMs != 0) ? 1 : 0;
+                stats.stallTotalMs = 0;
+                stats.stallLongestMs = 0;
+                if (stats.stallStartMs != 0)
+                    stats.stallStartMs = monotonicMs();
+            }
+
+            returnResponse(true);
+        }
+
+        int DeviceDiagnostics::getConfiguration(const std::vector<std::string>& names, JsonObject& out)
         {
             LOGINFO("%s",__FUNCTION__);
 
-            JsonObject DeviceDiagnosticsResult;
+            std::map<std::string, JsonObject> values;
+            std::vector<std::string> missing;
+            uint64_t now = monotonicMs();
+
+            {
+                std::lock_guard<std::mutex> lock(m_cacheLock);
+                for (const std::string& name : names)
+                {
+                    auto it = m_cache.find(name);
+                    if (it != m_cache.end() && it->second.expiresMs > now)
+                        values[name] = it->second.entry;
+                    else if (std::find(missing.begin(), missing.end(), name) == missing.end())
+                        missing.push_back(name);
+                }
+            }
+
+            int result = 0;
+            if (!missing.empty())
+            {
+                JsonArray fetched;
+                result = queryAgent(missing, fetched);
+
+                std::lock_guard<std::mutex> lock(m_cacheLock);
+                if (result == 0)
+                {
+                    now = monotonicMs();
+                    for (uint16_t i = 0; i < fetched.Length(); i++)
+                    {
+                        JsonObject entry = fetched[i].Object();
+                        std::string name = entry["name"].String();
+                        values[name] = entry;
+                        CachedParam& cached = m_cache[name];
+                        cached.entry = entry;
+                        cached.expiresMs = now + DEVICE_DIAGNOSTICS_CACHE_TTL_MS;
+                    }
+                }
+                else
+                {
+                    // The agent failed, stale values are better than none if every name has one
+                    bool complete = true;
+                    for (const std::string& name : missing)
+                    {
+                        auto it = m_cache.find(name);
+                        if (it == m_cache.end())
+                            complete = false;
+                        else
+                            values[name] = it->second.entry;
+                    }
+                    if (complete)
+                    {
+                        LOGWARN("agent failed, answering from the cache");
+                        result = 0;
+                    }
+                }
+            }
+
+            if (result == 0)
+            {
+                JsonArray paramList;
+                for (const std::string& name : names)
+                {
+                    auto it = values.find(name);
+                    if (it != values.end())
+                    {
+                        paramList.Add(it->second);
+                        values.erase(it); // once per name
+                    }
+                }
+                out["paramList"] = paramList;
+            }
+            return result;
+        }
+
+        /* One POST to the TR-181 agent on the kept connection. Callers wait at most one request
+         * timeout for the connection, and after a failure the agent is left alone for a while. */
+        int DeviceDiagnostics::queryAgent(const std::vector<std::string>& names, JsonArray& paramList)
+        {
+            if (monotonicMs() < m_agentBackoffUntilMs)
+            {
+                LOGWARN("agent failed recently, not asking it");
+                return -1;
+            }
+
+            std::unique_lock<std::timed_mutex> lock(m_curlLock, std::defer_lock);
+            if (!lock.try_lock_for(std::chrono::seconds(curlTimeoutInSeconds)))
+            {
+                LOGWARN("agent busy, giving up");
+                return -1;
+            }
+
+            JsonObject requestParams;
+            JsonArray namePairs;
+            for (const std::string& name : names)
+            {
+                JsonObject o;
+                o["name"] = name;
+                namePairs.Add(o);
+            }
+            requestParams["paramList"] = namePairs;
+
+            std::string postData;
+            requestParams.ToString(postData);
+
             int result = -1;
 
             long http_code = 0;
             std::string response;
-            CURL *curl_handle = NULL;
             CURLcode res = CURLE_OK;
-            curl_handle = curl_easy_init();
+
+            if (m_curl == nullptr)
+                m_curl = curl_easy_init();
 
             LOGINFO("data: %s", postData.c_str());
 
-            if (curl_handle) {
+            if (m_curl) {
 
-                curl_easy_setopt(curl_handle, CURLOPT_URL, "http://127.0.0.1:10999");
-                curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, postData.c_str());
-                curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, postData.size());
-                curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1); //when redirected, follow the redirections
-                curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, writeCurlResponse);
-                curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, &response);
-                curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, curlTimeoutInSeconds);
+                curl_easy_setopt(m_curl, CURLOPT_URL, DEVICE_DIAGNOSTICS_AGENT_URL);
+                curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, postData.c_str());
+                curl_easy_setopt(m_curl, CURLOPT_POSTFIELDSIZE, postData.size());
+                curl_easy_setopt(m_curl, CURLOPT_FOLLOWLOCATION, 1); //when redirected, follow the redirections
+                curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, writeCurlResponse);
+                curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &response);
+                curl_easy_setopt(m_curl, CURLOPT_TIMEOUT, curlTimeoutInSeconds);
+                curl_easy_setopt(m_curl, CURLOPT_CONNECTTIMEOUT, curlConnectTimeoutInSeconds);
+                curl_easy_setopt(m_curl, CURLOPT_TCP_KEEPALIVE, 1L);
+                curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, 1L);
 
-                res = curl_easy_perform(curl_handle);
-                curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_code);
+                res = curl_easy_perform(m_curl);
+                curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &http_code);
 
                 LOGWARN("Perfomed curl call : %d http response code: %ld", res, http_code);
-                curl_easy_cleanup(curl_handle);
             }
             else {
                 LOGWARN("Could not perform curl ");
@@ -247,14 +464,17 @@ namespace WPEFramework
                  if (jsonHash.HasLabel("paramList"))
                  {
                     LOGWARN("key paramList present");
-                    out["paramList"] = jsonHash["paramList"];
+                    paramList = jsonHash["paramList"].Array();
                     result = 0;
                  }
              }
+
+            if (result != 0 && (m_curl == nullptr || res != CURLE_OK))
+                m_agentBackoffUntilMs = monotonicMs() + DEVICE_DIAGNOSTICS_AGENT_BACKOFF_MS;
+
             return result;
         }
 
-
     } // namespace Plugin
 } // namespace WPEFramework
 
@@ -19,8 +19,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
 #include <thread>
 #include <mutex>
+#include <vector>
+#include <curl/curl.h>
 #ifdef ENABLE_ERM
 #include <essos-resmgr.h>
 #endif
@@ -57,18 +62,45 @@ namespace WPEFramework {
             uint32_t getConfigurationWrapper(const JsonObject& parameters, JsonObject& response);
             //End methods
 
-            int getConfiguration(const std::string& postData, JsonObject& response);
+            int getConfiguration(const std::vector<std::string>& names, JsonObject& response);
+            int queryAgent(const std::vector<std::string>& names, JsonArray& paramList);
             uint32_t getAVDecoderStatus(const JsonObject& parameters, JsonObject& response);
+            uint32_t getAVDecoderStatistics(const JsonObject& parameters, JsonObject& response);
             int getMostActiveDecoderStatus();
+            bool updateDecoderStatus(int status);
             void onDecoderStatusChange(int status);
 #ifdef ENABLE_ERM
             static void *AVPollThread(void *arg);
 #endif
 
         private:
+            struct CachedParam
+            {
+                JsonObject entry;           // as the agent returned it, {"name", "value"}
+                uint64_t expiresMs;
+            };
+
+            std::timed_mutex m_curlLock;
+            CURL* m_curl;                   // kept, so that the connection to the agent is reused
+            std::atomic<uint64_t> m_agentBackoffUntilMs;
+            std::mutex m_cacheLock;
+            std::map<std::string, CachedParam> m_cache;
+
+            struct DecoderStatistics
+            {
+                int status;                 // last status seen, index of decoderStatusStr
+                uint32_t changes;
+                uint32_t stalls;            // ACTIVE to PAUSED
+                uint64_t stallTotalMs;
+                uint64_t stallLongestMs;
+                uint64_t stallStartMs;      // 0 if not in a stall
+            };
+            DecoderStatistics m_decoderStats;
+
 #ifdef ENABLE_ERM
             std::thread m_AVPollThread;
             std::mutex m_AVDecoderStatusLock;
+            std::condition_variable m_AVPollCondition;
             EssRMgr* m_EssRMgr;
             int m_pollThreadRun;
 #endif
@@ -20,11 +20,50 @@
 #include "DeviceIdentification.h"
 #include "IdentityProvider.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
 namespace WPEFramework {
 namespace Plugin {
 
     SERVICE_REGISTRATION(DeviceIdentification, 1, 0);
 
+    namespace {
+
+        const TCHAR* const kCacheFile = _T("identity.json");
+
+        string ToHex(const string& data)
+        {
+            static const TCHAR digits[] = _T("0123456789abcdef");
+            string result;
+
+            for (const char byte : data) {
+                result += digits[(static_cast<uint8_t>(byte) >> 4) & 0x0F];
+                result += digits[static_cast<uint8_t>(byte) & 0x0F];
+            }
+            return (result);
+        }
+
+        bool FromHex(const string& hex, string& data)
+        {
+            data.clear();
+            if ((hex.length() % 2) != 0) {
+                return (false);
+            }
+            for (size_t index = 0; index < hex.length(); index += 2) {
+                char* end = nullptr;
+                const string digits(hex.substr(index, 2));
+                const long value = ::strtol(digits.c_str(), &end, 16);
+                if (*end != '\0') {
+                    return (false);
+                }
+                data += static_cast<char>(value);
+            }
+            return (true);
+        }
+    }
+
     /* virtual */ const string DeviceIdentification::Initialize(PluginHost::IShell* service)
     {
         ASSERT(service != nullptr);
@@ -32,23 +71,19 @@ namespace Plugin {
 
         string message;
 
-        _device = service->Root<Exchange::IDeviceProperties>(_connectionId, 2000, _T("DeviceImplementation"));
-        if (_device != nullptr) {
-
-            _identifier = _device->QueryInterface<PluginHost::ISubSystem::IIdentifier>();
-            if (_identifier == nullptr) {
+        _service = service;
 
-                _device->Release();
-                _device = nullptr;
-            } else {
-                _deviceId = GetDeviceId();
-                if (_deviceId.empty() != true) {
-                    service->SubSystems()->Set(PluginHost::ISubSystem::IDENTIFIER, _device);
-                }
+        if (LoadCache() == true) {
+            // Serve the identity of the previous activation right away, the platform is queried in the background
+            _cachedIdentifier = Core::Service<CachedIdentifier>::Create<CachedIdentifier>(_identity);
+            SetIdentifier(_cachedIdentifier);
+            _verifyJob.Submit();
+        } else if (Instantiate() == true) {
+            if (_deviceId.empty() != true) {
+                SetIdentifier(_device);
             }
-        }
-
-        if (_device == nullptr) {
+            SaveCache();
+        } else {
             message = _T("DeviceIdentification plugin could not be instantiated.");
         }
 
@@ -58,25 +93,32 @@ namespace Plugin {
     /* virtual */ void DeviceIdentification::Deinitialize(PluginHost::IShell* service)
     {
         ASSERT(service != nullptr);
-        ASSERT(_device != nullptr);
+        ASSERT(service == _service);
+
+        _verifyJob.Revoke();
+
+        if ((_deviceId.empty() != true) || (_cachedIdentifier != nullptr)) {
+            SetIdentifier(nullptr);
+            _deviceId.clear();
+        }
+
+        if (_cachedIdentifier != nullptr) {
+            _cachedIdentifier->Release();
+            _cachedIdentifier = nullptr;
+        }
 
-        ASSERT(_identifier != nullptr);
         if (_identifier != nullptr) {
-            if (_deviceId.empty() != true) {
-                service->SubSystems()->Set(PluginHost::ISubSystem::IDENTIFIER, nullptr);
-                _deviceId.clear();
-            }
             _identifier->Release();
             _identifier = nullptr;
         }
 
-        ASSERT(_device != nullptr);
         if (_device != nullptr) {
             _device->Release();
             _device = nullptr;
         }
 
         _connectionId = 0;
+        _service = nullptr;
     }
 
     /* virtual */ string DeviceIdentification::Information() const
@@ -85,19 +127,149 @@ namespace Plugin {
         return (string());
     }
 
+    // Starts the platform implementation and reads the identity from it
+    bool DeviceIdentification::Instantiate()
+    {
+        uint32_t connectionId = 0;
+        Exchange::IDeviceProperties* device = _service->Root<Exchange::IDeviceProperties>(connectionId, 2000, _T("DeviceImplementation"));
+        if (device == nullptr) {
+            return (false);
+        }
+
+        const PluginHost::ISubSystem::IIdentifier* identifier = device->QueryInterface<PluginHost::ISubSystem::IIdentifier>();
+        if (identifier == nullptr) {
+            device->Release();
+            return (false);
+        }
+
+        uint8_t myBuffer[64];
+        const uint8_t length = identifier->Identifier(sizeof(myBuffer) - 1, &(myBuffer[1]));
+        const string firmwareVersion = device->FirmwareVersion();
+        const string chipset = device->Chipset();
+
+        _adminLock.Lock();
+        _device = device;
+        _identifier = identifier;
+        _connectionId = connectionId;
+        _identity = string(reinterpret_cast<const char*>(&(myBuffer[1])), length);
+        _deviceId = GetDeviceId();
+        _firmwareVersion = firmwareVersion;
+        _chipset = chipset;
+        _adminLock.Unlock();
+
+        return (true);
+    }
+
+    void DeviceIdentification::SetIdentifier(Core::IUnknown* identifier) const
+    {
+        PluginHost::ISubSystem* subSystem = _service->SubSystems();
+        if (subSystem != nullptr) {
+            subSystem->Set(PluginHost::ISubSystem::IDENTIFIER, identifier);
+            subSystem->Release();
+        }
+    }
+
+    // The cached identity is only used on the same hardware (network MAC) and the same build
+    string DeviceIdentification::Fingerprint() const
+    {
+        string result = Core::SystemInfo::Instance().Id(Core::SystemInfo::Instance().RawDeviceId(), ~0);
+
+        PluginHost::ISubSystem* subSystem = _service->SubSystems();
+        if (subSystem != nullptr) {
+            result += _T("#") + subSystem->BuildTreeHash();
+            subSystem->Release();
+        }
+        return (result);
+    }
+
+    bool DeviceIdentification::LoadCache()
+    {
+        std::ifstream file(_service->PersistentPath() + kCacheFile);
+        if (file.is_open() == false) {
+            return (false);
+        }
+
+        const string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        Cache cache;
+        string identity;
+        if ((cache.FromString(content) == false) || (cache.Fingerprint.Value() != Fingerprint())
+            || (FromHex(cache.Identity.Value(), identity) == false) || (identity.empty() == true)) {
+            TRACE(Trace::Information, (_T("No valid cached device identity")));
+            return (false);
+        }
+
+        _identity = identity;
+        _deviceId = GetDeviceId();
+        _firmwareVersion = cache.Firmwareversion.Value();
+        _chipset = cache.Chipset.Value();
+
+        // The id derivation may differ between builds, the fingerprint already covers that
+        return (_deviceId == cache.Deviceid.Value());
+    }
+
+    void DeviceIdentification::SaveCache() const
+    {
+        Cache cache;
+        string content;
+
+        _adminLock.Lock();
+        cache.Fingerprint = Fingerprint();
+        cache.Identity = ToHex(_identity);
+        cache.Deviceid = _deviceId;
+        cache.Firmwareversion = _firmwareVersion;
+        cache.Chipset = _chipset;
+        _adminLock.Unlock();
+
+        cache.ToString(content);
+
+        const string path = _service->PersistentPath();
+        Core::Directory(path.c_str()).CreatePath();
+
+        const string name = path + kCacheFile;
+        const string temporary = name + _T(".tmp");
+        std::ofstream file(temporary, std::ios::trunc);
+        file << content;
+        file.close();
+
+        if ((file.fail() == true) || (::rename(temporary.c_str(), name.c_str()) != 0)) {
+            TRACE(Trace::Error, (_T("Could not store the device identity in %s"), name.c_str()));
+            ::remove(temporary.c_str());
+        }
+    }
+
+    // Verifies the cached identity against the platform, off the activation path
+    void DeviceIdentification::Dispatch()
+    {
+        const string identity = _identity;
+        const string firmwareVersion = _firmwareVersion;
+        const string chipset = _chipset;
+
+        if (Instantiate() == false) {
+            SYSLOG(Logging::Notification, (_T("Could not verify the cached device identity")));
+            return;
+        }
+
+        if (_identity != identity) {
+            SYSLOG(Logging::Notification, (_T("Device identity changed, replacing the cached one")));
+            SetIdentifier(_deviceId.empty() != true ? static_cast<Core::IUnknown*>(_device) : nullptr);
+        }
+
+        if ((_identity != identity) || (_firmwareVersion != firmwareVersion) || (_chipset != chipset)) {
+            SaveCache();
+        }
+    }
+
     string DeviceIdentification::GetDeviceId() const
     {
         string result;
-        ASSERT(_identifier != nullptr);
 
-        if (_identifier != nullptr) {
+        if (_identity.empty() != true) {
             uint8_t myBuffer[64];
 
-            myBuffer[0] = _identifier->Identifier(sizeof(myBuffer) - 1, &(myBuffer[1]));
+            myBuffer[0] = static_cast<uint8_t>(std::min(_identity.length(), sizeof(myBuffer) - 1));
+            ::memcpy(&(myBuffer[1]), _identity.c_str(), myBuffer[0]);
 
-            if (myBuffer[0] != 0) {
-                result = Core::SystemInfo::Instance().Id(myBuffer, ~0);
-            }
+            result = Core::SystemInfo::Instance().Id(myBuffer, ~0);
         }
 
         return result;
@@ -105,12 +277,16 @@ namespace Plugin {
 
     void DeviceIdentification::Info(JsonData::DeviceIdentification::DeviceidentificationData& deviceInfo) const
     {
-        deviceInfo.Firmwareversion = _device->FirmwareVersion();
-        deviceInfo.Chipset = _device->Chipset();
+        _adminLock.Lock();
+
+        deviceInfo.Firmwareversion = _firmwareVersion;
+        deviceInfo.Chipset = _chipset;
 
         if (_deviceId.empty() != true) {
             deviceInfo.Deviceid = _deviceId;
         }
+
+        _adminLock.Unlock();
     }
 
 } // namespace Plugin
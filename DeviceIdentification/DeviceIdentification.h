@@ -27,15 +27,81 @@ namespace WPEFramework {
 namespace Plugin {
 
     class DeviceIdentification : public PluginHost::IPlugin, public PluginHost::JSONRPC {
+    private:
+        // Identity of the last activation, kept in the persistent path of the plugin
+        class Cache : public Core::JSON::Container {
+        public:
+            Cache(const Cache&) = delete;
+            Cache& operator=(const Cache&) = delete;
+
+            Cache()
+                : Core::JSON::Container()
+                , Fingerprint()
+                , Identity()
+                , Deviceid()
+                , Firmwareversion()
+                , Chipset()
+            {
+                Add(_T("fingerprint"), &Fingerprint);
+                Add(_T("identity"), &Identity);
+                Add(_T("deviceid"), &Deviceid);
+                Add(_T("firmwareversion"), &Firmwareversion);
+                Add(_T("chipset"), &Chipset);
+            }
+            ~Cache() override = default;
+
+        public:
+            Core::JSON::String Fingerprint;
+            Core::JSON::String Identity; // hex
+            Core::JSON::String Deviceid;
+            Core::JSON::String Firmwareversion;
+            Core::JSON::String Chipset;
+        };
+
+        // Serves the cached identity to the subsystem until the implementation has verified it
+        class CachedIdentifier : public PluginHost::ISubSystem::IIdentifier {
+        public:
+            CachedIdentifier() = delete;
+            CachedIdentifier(const CachedIdentifier&) = delete;
+            CachedIdentifier& operator=(const CachedIdentifier&) = delete;
+
+            CachedIdentifier(const string& identity)
+                : _identity(identity)
+            {
+            }
+            ~CachedIdentifier() override = default;
+
+            uint8_t Identifier(const uint8_t length, uint8_t buffer[]) const override
+            {
+                uint8_t result = static_cast<uint8_t>(_identity.length() > length ? length : _identity.length());
+                ::memcpy(buffer, _identity.c_str(), result);
+                return (result);
+            }
+
+            BEGIN_INTERFACE_MAP(CachedIdentifier)
+                INTERFACE_ENTRY(PluginHost::ISubSystem::IIdentifier)
+            END_INTERFACE_MAP
+
+        private:
+            const string _identity;
+        };
+
     public:
         DeviceIdentification(const DeviceIdentification&) = delete;
         DeviceIdentification& operator=(const DeviceIdentification&) = delete;
 
         DeviceIdentification()
-            : _deviceId()
+            : _adminLock()
+            , _deviceId()
+            , _identity()
+            , _firmwareVersion()
+            , _chipset()
+            , _service(nullptr)
             , _device(nullptr)
             , _identifier(nullptr)
+            , _cachedIdentifier(nullptr)
             , _connectionId(0)
+            , _verifyJob(*this)
         {
             RegisterAll();
         }
@@ -65,12 +131,28 @@ namespace Plugin {
         string GetDeviceId() const;
         void Info(JsonData::DeviceIdentification::DeviceidentificationData&) const;
 
+        bool Instantiate();
+        void SetIdentifier(Core::IUnknown* identifier) const;
+        string Fingerprint() const;
+        bool LoadCache();
+        void SaveCache() const;
+
+        friend Core::ThreadPool::JobType<DeviceIdentification&>;
+        void Dispatch();
+
     private:
+        mutable Core::CriticalSection _adminLock;
         string _deviceId;
+        string _identity;
+        string _firmwareVersion;
+        string _chipset;
+        PluginHost::IShell* _service;
         Exchange::IDeviceProperties* _device;
         const PluginHost::ISubSystem::IIdentifier* _identifier;
+        CachedIdentifier* _cachedIdentifier;
 
         uint32_t _connectionId;
+        Core::WorkerPool::JobType<DeviceIdentification&> _verifyJob;
     };
 
 } // namespace Plugin
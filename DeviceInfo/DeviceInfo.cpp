@@ -39,9 +39,18 @@ namespace Plugin {
         _subSystem = service->SubSystems();
         _service = service;
         _systemId = Core::SystemInfo::Instance().Id(Core::SystemInfo::Instance().RawDeviceId(), ~0);
+        _totalRam = Core::SystemInfo::Instance().GetTotalRam();
+        _loadRefresh = static_cast<uint64_t>(config.LoadRefresh.Value()) * Core::Time::TicksPerMillisecond;
+        _addressRefresh = static_cast<uint64_t>(config.AddressRefresh.Value()) * Core::Time::TicksPerMillisecond;
+        _loadUpdated = 0;
+        _addressesUpdated = 0;
 
         ASSERT(_subSystem != nullptr);
 
+        if (_subSystem != nullptr) {
+            _version = _service->Version() + _T("#") + _subSystem->BuildTreeHash();
+        }
+
         // On success return empty, to indicate there is no error text.
 
         return (_subSystem != nullptr) ? EMPTY_STRING : _T("Could not retrieve System Information.");
@@ -96,7 +105,17 @@ namespace Plugin {
             } else if (index.Current() == "Adresses") {
                 AddressInfo(response->Addresses);
             } else if (index.Current() == "System") {
-                SysInfo(response->SystemInfo);
+                // GET .../System?fields=cpuload,freeram only returns the listed fields
+                uint16_t fields = FIELD_ALL;
+                if (request.Query.IsSet() == true) {
+                    const string& query = request.Query.Value();
+                    size_t start = query.find(_T("fields="));
+                    if ((start != string::npos) && ((start == 0) || (query[start - 1] == '&'))) {
+                        start += 7;
+                        fields = Fields(query.substr(start, query.find('&', start) - start));
+                    }
+                }
+                SysInfo(response->SystemInfo, fields);
             } else if (index.Current() == "Sockets") {
                 SocketPortInfo(response->Sockets);
             }
@@ -112,31 +131,82 @@ namespace Plugin {
         return result;
     }
 
-    void DeviceInfo::SysInfo(JsonData::DeviceInfo::SysteminfoData& systemInfo) const
+    void DeviceInfo::SysInfo(JsonData::DeviceInfo::SysteminfoData& systemInfo, const uint16_t fields) const
     {
         Core::SystemInfo& singleton(Core::SystemInfo::Instance());
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+
+        if (((fields & (FIELD_UPTIME | FIELD_FREERAM | FIELD_CPULOAD)) != 0) && ((_loadUpdated == 0) || ((now - _loadUpdated) >= _loadRefresh))) {
+            _upTime = singleton.GetUpTime();
+            _freeRam = singleton.GetFreeRam();
+            _cpuLoad = Core::NumberType<uint32_t>(static_cast<uint32_t>(singleton.GetCpuLoad())).Text();
+            _loadUpdated = now;
+        }
+        if (((fields & FIELD_DEVICENAME) != 0) && ((_addressesUpdated == 0) || ((now - _addressesUpdated) >= _addressRefresh))) {
+            RefreshAddresses(now);
+        }
+
+        if ((fields & FIELD_TIME) != 0) {
+            systemInfo.Time = Core::Time::Now().ToRFC1123(true);
+        }
+        if ((fields & FIELD_VERSION) != 0) {
+            systemInfo.Version = _version;
+        }
+        if ((fields & FIELD_UPTIME) != 0) {
+            systemInfo.Uptime = _upTime;
+        }
+        if ((fields & FIELD_FREERAM) != 0) {
+            systemInfo.Freeram = _freeRam;
+        }
+        if ((fields & FIELD_TOTALRAM) != 0) {
+            systemInfo.Totalram = _totalRam;
+        }
+        if ((fields & FIELD_DEVICENAME) != 0) {
+            systemInfo.Devicename = _deviceName;
+        }
+        if ((fields & FIELD_CPULOAD) != 0) {
+            systemInfo.Cpuload = _cpuLoad;
+        }
+        if ((fields & FIELD_SERIALNUMBER) != 0) {
+            systemInfo.Serialnumber = _systemId;
+        }
 
-        systemInfo.Time = Core::Time::Now().ToRFC1123(true);
-        systemInfo.Version = _service->Version() + _T("#") + _subSystem->BuildTreeHash();
-        systemInfo.Uptime = singleton.GetUpTime();
-        systemInfo.Freeram = singleton.GetFreeRam();
-        systemInfo.Totalram = singleton.GetTotalRam();
-        systemInfo.Devicename = singleton.GetHostName();
-        systemInfo.Cpuload = Core::NumberType<uint32_t>(static_cast<uint32_t>(singleton.GetCpuLoad())).Text();
-        systemInfo.Serialnumber = _systemId;
+        _adminLock.Unlock();
     }
 
     void DeviceInfo::AddressInfo(Core::JSON::ArrayType<JsonData::DeviceInfo::AddressesData>& addressInfo) const
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+
+        if ((_addressesUpdated == 0) || ((now - _addressesUpdated) >= _addressRefresh)) {
+            RefreshAddresses(now);
+        }
+
+        Core::JSON::ArrayType<JsonData::DeviceInfo::AddressesData>::Iterator element(_addresses.Elements());
+        while (element.Next() == true) {
+            addressInfo.Add(element.Current());
+        }
+
+        _adminLock.Unlock();
+    }
+
+    // Called with _adminLock taken
+    void DeviceInfo::RefreshAddresses(const uint64_t now) const
     {
         // Get the point of entry on WPEFramework..
         Core::AdapterIterator interfaces;
 
+        _addresses.Clear();
         while (interfaces.Next() == true) {
 
             JsonData::DeviceInfo::AddressesData newElement;
             newElement.Name = interfaces.Name();
             newElement.Mac = interfaces.MACAddress(':');
-            JsonData::DeviceInfo::AddressesData& element(addressInfo.Add(newElement));
+            JsonData::DeviceInfo::AddressesData& element(_addresses.Add(newElement));
 
             // get an interface with a public IP address, then we will have a proper MAC address..
             Core::IPV4AddressIterator selectedNode(interfaces.IPV4Addresses());
@@ -148,6 +218,39 @@ namespace Plugin {
                 element.Ip.Add(nodeName);
             }
         }
+
+        _deviceName = Core::SystemInfo::Instance().GetHostName();
+        _addressesUpdated = now;
+    }
+
+    /* static */ uint16_t DeviceInfo::Fields(const string& list)
+    {
+        static const std::pair<const TCHAR*, uint16_t> names[] = {
+            { _T("time"), FIELD_TIME },
+            { _T("version"), FIELD_VERSION },
+            { _T("uptime"), FIELD_UPTIME },
+            { _T("freeram"), FIELD_FREERAM },
+            { _T("totalram"), FIELD_TOTALRAM },
+            { _T("devicename"), FIELD_DEVICENAME },
+            { _T("cpuload"), FIELD_CPULOAD },
+            { _T("serialnumber"), FIELD_SERIALNUMBER }
+        };
+
+        if (list.empty() == true) {
+            return (FIELD_ALL);
+        }
+
+        uint16_t fields = 0;
+        Core::TextSegmentIterator index(Core::TextFragment(list), false, ',');
+        while (index.Next() == true) {
+            for (const auto& name : names) {
+                if (index.Current() == name.first) {
+                    fields |= name.second;
+                    break;
+                }
+            }
+        }
+        return (fields);
     }
 
     void DeviceInfo::SocketPortInfo(JsonData::DeviceInfo::SocketinfoData& socketPortInfo) const
@@ -28,6 +28,31 @@ namespace Plugin {
 
     class DeviceInfo : public PluginHost::IPlugin, public PluginHost::IWeb, public PluginHost::JSONRPC {
     public:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&);
+            Config& operator=(const Config&);
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , LoadRefresh(1000)
+                , AddressRefresh(10000)
+            {
+                Add(_T("loadrefresh"), &LoadRefresh);
+                Add(_T("addressrefresh"), &AddressRefresh);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            // Minimum age in ms before uptime, freeram and cpuload are read again
+            Core::JSON::DecUInt32 LoadRefresh;
+            // Minimum age in ms before the hostname and the network addresses are read again
+            Core::JSON::DecUInt32 AddressRefresh;
+        };
+
         class Data : public Core::JSON::Container {
         public:
             Data()
@@ -51,6 +76,18 @@ namespace Plugin {
         };
 
     private:
+        enum field : uint16_t {
+            FIELD_TIME = 0x0001,
+            FIELD_VERSION = 0x0002,
+            FIELD_UPTIME = 0x0004,
+            FIELD_FREERAM = 0x0008,
+            FIELD_TOTALRAM = 0x0010,
+            FIELD_DEVICENAME = 0x0020,
+            FIELD_CPULOAD = 0x0040,
+            FIELD_SERIALNUMBER = 0x0080,
+            FIELD_ALL = 0x00FF
+        };
+
         DeviceInfo(const DeviceInfo&) = delete;
         DeviceInfo& operator=(const DeviceInfo&) = delete;
 
@@ -77,6 +114,18 @@ namespace Plugin {
             , _subSystem(nullptr)
             , _systemId()
             , _deviceId()
+            , _adminLock()
+            , _version()
+            , _totalRam(0)
+            , _loadRefresh(0)
+            , _addressRefresh(0)
+            , _upTime(0)
+            , _freeRam(0)
+            , _cpuLoad()
+            , _loadUpdated(0)
+            , _deviceName()
+            , _addresses()
+            , _addressesUpdated(0)
         {
             RegisterAll();
         }
@@ -108,14 +157,16 @@ namespace Plugin {
         // JsonRpc
         void RegisterAll();
         void UnregisterAll();
-        uint32_t get_systeminfo(JsonData::DeviceInfo::SysteminfoData& response) const;
+        uint32_t get_systeminfo(const string& index, JsonData::DeviceInfo::SysteminfoData& response) const;
         uint32_t get_addresses(Core::JSON::ArrayType<JsonData::DeviceInfo::AddressesData>& response) const;
         uint32_t get_socketinfo(JsonData::DeviceInfo::SocketinfoData& response) const;
 
-        void SysInfo(JsonData::DeviceInfo::SysteminfoData& systemInfo) const;
+        void SysInfo(JsonData::DeviceInfo::SysteminfoData& systemInfo, const uint16_t fields = FIELD_ALL) const;
         void AddressInfo(Core::JSON::ArrayType<JsonData::DeviceInfo::AddressesData>& addressInfo) const;
+        void RefreshAddresses(const uint64_t now) const;
         void SocketPortInfo(JsonData::DeviceInfo::SocketinfoData& socketPortInfo) const;
         string GetDeviceId() const;
+        static uint16_t Fields(const string& list);
 
     private:
         uint8_t _skipURL;
@@ -123,6 +174,20 @@ namespace Plugin {
         PluginHost::ISubSystem* _subSystem;
         string _systemId;
         mutable string _deviceId;
+
+        // Snapshot of the system information, the static values are read once in Initialize
+        mutable Core::CriticalSection _adminLock;
+        string _version;
+        uint64_t _totalRam;
+        uint64_t _loadRefresh;
+        uint64_t _addressRefresh;
+        mutable uint64_t _upTime;
+        mutable uint64_t _freeRam;
+        mutable string _cpuLoad;
+        mutable uint64_t _loadUpdated;
+        mutable string _deviceName;
+        mutable Core::JSON::ArrayType<JsonData::DeviceInfo::AddressesData> _addresses;
+        mutable uint64_t _addressesUpdated;
     };
 
 } // namespace Plugin
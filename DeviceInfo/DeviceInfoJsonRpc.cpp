@@ -46,11 +46,12 @@ namespace Plugin {
     //
 
     // Property: systeminfo - System general information
+    // Index: optional comma separated list of the fields to return, e.g. "cpuload,freeram"
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t DeviceInfo::get_systeminfo(SysteminfoData& response) const
+    uint32_t DeviceInfo::get_systeminfo(const string& index, SysteminfoData& response) const
     {
-        SysInfo(response);
+        SysInfo(response, Fields(index));
         return Core::ERROR_NONE;
     }
 
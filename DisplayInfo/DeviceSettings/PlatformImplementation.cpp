@@ -55,6 +55,7 @@ private:
     using ColorimetryIteratorImplementation = RPC::IteratorType<Exchange::IDisplayProperties::IColorimetryIterator>;
 public:
     DisplayInfoImplementation()
+        : _edidStale(true)
     {
         DisplayInfoImplementation::_instance = this;
         try
@@ -63,6 +64,7 @@ public:
             IARM_Result_t res;
             IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_RES_PRECHANGE,ResolutionChange) );
             IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_RES_POSTCHANGE, ResolutionChange) );
+            IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG, HdmiHotPlug) );
 
             //TODO: this is probably per process so we either need to be running in our own process or be carefull no other plugin is calling it
             device::Manager::Initialize();
@@ -82,6 +84,7 @@ public:
         IARM_Result_t res;
         IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_RES_PRECHANGE) );
         IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_RES_POSTCHANGE) );
+        IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG) );
         DisplayInfoImplementation::_instance = nullptr;
     }
 
@@ -152,8 +155,18 @@ public:
         }
     }
 
+    static void HdmiHotPlug(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+    {
+        if(DisplayInfoImplementation::_instance)
+        {
+           DisplayInfoImplementation::_instance->InvalidateEdid();
+        }
+    }
+
     void ResolutionChangeImpl(IConnectionProperties::INotification::Source eventtype)
     {
+        InvalidateEdid();
+
         _adminLock.Lock();
 
         std::list<IConnectionProperties::INotification*>::const_iterator index = _observers.begin();
@@ -211,18 +224,13 @@ public:
     }
     uint32_t VerticalFreq(uint32_t& value) const override
     {
-        vector<uint8_t> edidVec;
-        uint32_t ret = GetEdidBytes(edidVec);
+        EdidCapabilities edid;
+        uint32_t ret = GetEdidCapabilities(edid);
         if (ret == Core::ERROR_NONE)
         {
-            uint32_t edidLen = edidVec.size();
-            unsigned char* edidbytes = new unsigned char [edidLen];
-            std::copy(edidVec.begin(), edidVec.end(), edidbytes);
-            if (edid_parser::EDID_Verify(edidbytes, edidLen) == edid_parser::EDID_STATUS_OK)
+            if (edid.verified)
             {
-                edid_parser::edid_data_t data_ptr;
-                edid_parser::EDID_Parse(edidbytes, edidLen, &data_ptr);
-                value = data_ptr.res.refresh;
+                value = edid.refresh;
                 TRACE(Trace::Information, (_T("Vertical frequency = %d"), value));
             }
             else
@@ -230,7 +238,6 @@ public:
                 TRACE(Trace::Information, (_T("EDID Verification failed")));
                 ret = Core::ERROR_GENERAL;
             }
-            delete edidbytes;
         }
         else
         {
@@ -305,15 +312,13 @@ public:
 
     uint32_t WidthInCentimeters(uint8_t& width /* @out */) const override
     {
-        int ret = Core::ERROR_NONE;
-        vector<uint8_t> edidVec;
-        ret = GetEdidBytes(edidVec);
+        EdidCapabilities edid;
+        uint32_t ret = GetEdidCapabilities(edid);
         if (Core::ERROR_NONE == ret)
         {
-            std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
-            if(edidVec.size() > EDID_MAX_VERTICAL_SIZE)
+            if(edid.bytes.size() > EDID_MAX_VERTICAL_SIZE)
             {
-                width = edidVec[EDID_MAX_HORIZONTAL_SIZE];
+                width = edid.bytes[EDID_MAX_HORIZONTAL_SIZE];
                 TRACE(Trace::Information, (_T("Width in cm = %d"), width));
             }
             else
@@ -327,30 +332,18 @@ public:
 
     uint32_t HeightInCentimeters(uint8_t& height /* @out */) const override
     {
-        try
+        EdidCapabilities edid;
+        if (GetEdidCapabilities(edid) == Core::ERROR_NONE)
         {
-            std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
-            ::device::VideoOutputPort vPort = ::device::Host::getInstance().getVideoOutputPort(strVideoPort.c_str());
-            if (vPort.isDisplayConnected())
+            if(edid.bytes.size() > EDID_MAX_VERTICAL_SIZE)
             {
-                std::vector<uint8_t> edidVec;
-
-                vPort.getDisplay().getEDIDBytes(edidVec);
-
-                if(edidVec.size() > EDID_MAX_VERTICAL_SIZE)
-                {
-                    height = edidVec[EDID_MAX_VERTICAL_SIZE];
-                    TRACE(Trace::Information, (_T("Height in cm = %d"), height));
-                }
-                else
-                {
-                    TRACE(Trace::Information, (_T("Failed to get Display Size!")));
-                }
+                height = edid.bytes[EDID_MAX_VERTICAL_SIZE];
+                TRACE(Trace::Information, (_T("Height in cm = %d"), height));
+            }
+            else
+            {
+                TRACE(Trace::Information, (_T("Failed to get Display Size!")));
             }
-        }
-        catch (const device::Exception& err)
-        {
-            TRACE(Trace::Error, (_T("Exception during DeviceSetting library call. code = %d message = %s"), err.getCode(), err.what()));
         }
         return (Core::ERROR_NONE);
     }
@@ -358,27 +351,15 @@ public:
     uint32_t EDID (uint16_t& length /* @inout */, uint8_t data[] /* @out @length:length */) const override
     {
         vector<uint8_t> edidVec({'u','n','k','n','o','w','n' });
-        int ret = Core::ERROR_NONE;
-        try
+        EdidCapabilities edid;
+        uint32_t ret = GetEdidCapabilities(edid);
+        if (ret == Core::ERROR_NONE)
         {
-            vector<uint8_t> edidVec2;
-            std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
-            device::VideoOutputPort vPort = device::Host::getInstance().getVideoOutputPort(strVideoPort.c_str());
-            if (vPort.isDisplayConnected())
-            {
-                vPort.getDisplay().getEDIDBytes(edidVec2);
-                edidVec = edidVec2;//edidVec must be "unknown" unless we successfully get to this line
-            }
-            else
-            {
-                TRACE(Trace::Information, (_T("failure: HDMI not connected!")));
-                ret = Core::ERROR_GENERAL;
-            }
+            edidVec = edid.bytes;//edidVec must be "unknown" unless the EDID was read
         }
-        catch (const device::Exception& err)
+        else
         {
-            LOG_DEVICE_EXCEPTION0();
-            ret = Core::ERROR_GENERAL;
+            TRACE(Trace::Information, (_T("failure: HDMI not connected!")));
         }
         //convert to base64
         uint16_t size = min(edidVec.size(), (size_t)numeric_limits<uint16_t>::max());
@@ -576,18 +557,13 @@ public:
     uint32_t Colorimetry(IColorimetryIterator*& colorimetry /* @out */) const override
     {
         std::list<Exchange::IDisplayProperties::ColorimetryType> colorimetryCaps;
-        vector<uint8_t> edidVec;
-        uint32_t ret = GetEdidBytes(edidVec);
+        EdidCapabilities edid;
+        uint32_t ret = GetEdidCapabilities(edid);
         if (ret == Core::ERROR_NONE)
         {
-            uint32_t edidLen = edidVec.size();
-            unsigned char* edidbytes = new unsigned char [edidLen];
-            std::copy(edidVec.begin(), edidVec.end(), edidbytes);
-            if (edid_parser::EDID_Verify(edidbytes, edidLen) == edid_parser::EDID_STATUS_OK)
+            if (edid.verified)
             {
-                edid_parser::edid_data_t data_ptr;
-                edid_parser::EDID_Parse(edidbytes, edidLen, &data_ptr);
-                uint32_t colorimetry_info = data_ptr.colorimetry_info;
+                uint32_t colorimetry_info = edid.colorimetry;
                 TRACE(Trace::Information, (_T("colorimetry = %d"),colorimetry_info));
                 if (!colorimetry_info) colorimetryCaps.push_back(COLORIMETRY_UNKNOWN);
                 if (colorimetry_info & edid_parser::COLORIMETRY_INFO_XVYCC601) colorimetryCaps.push_back(COLORIMETRY_XVYCC601);
@@ -604,7 +580,6 @@ public:
                 TRACE(Trace::Error, (_T("EDID Verification failed")));
                 ret = Core::ERROR_GENERAL;
             }
-            delete edidbytes;
         }
         else
         {
@@ -751,10 +726,90 @@ public:
     END_INTERFACE_MAP
 
 private:
+    // EDID of the connected display and the capabilities parsed from it
+    struct EdidCapabilities
+    {
+        EdidCapabilities()
+            : bytes()
+            , hash(0)
+            , verified(false)
+            , refresh(0)
+            , colorimetry(0)
+        {
+        }
+
+        vector<uint8_t> bytes;
+        uint32_t hash;
+        bool verified;          // EDID_Verify passed, refresh and colorimetry are set
+        uint32_t refresh;
+        uint32_t colorimetry;
+    };
+
     std::list<IConnectionProperties::INotification*> _observers;
     mutable Core::CriticalSection _adminLock;
 
+    mutable Core::CriticalSection _edidLock;
+    mutable EdidCapabilities _edid;
+    mutable bool _edidStale;
+
 private:
+    void InvalidateEdid()
+    {
+        _edidLock.Lock();
+        _edidStale = true;
+        _edidLock.Unlock();
+    }
+
+    // The EDID is read again after a hotplug or resolution change, it is only parsed again if
+    // its hash changed. Without a display nothing is cached, the next call reads again.
+    uint32_t GetEdidCapabilities(EdidCapabilities& edid) const
+    {
+        uint32_t ret = Core::ERROR_NONE;
+
+        _edidLock.Lock();
+
+        if (_edidStale)
+        {
+            vector<uint8_t> edidVec;
+            ret = GetEdidBytes(edidVec);
+            if (ret == Core::ERROR_NONE)
+            {
+                uint32_t hash = 2166136261u;
+                for (uint8_t byte : edidVec)
+                {
+                    hash = (hash ^ byte) * 16777619u;
+                }
+
+                if (edidVec.empty() || hash != _edid.hash)
+                {
+                    EdidCapabilities parsed;
+                    parsed.bytes = edidVec;
+                    parsed.hash = hash;
+                    if (!edidVec.empty() && edid_parser::EDID_Verify(edidVec.data(), edidVec.size()) == edid_parser::EDID_STATUS_OK)
+                    {
+                        edid_parser::edid_data_t data_ptr;
+                        edid_parser::EDID_Parse(edidVec.data(), edidVec.size(), &data_ptr);
+                        parsed.verified = true;
+                        parsed.refresh = data_ptr.res.refresh;
+                        parsed.colorimetry = data_ptr.colorimetry_info;
+                    }
+                    _edid = parsed;
+                    TRACE(Trace::Information, (_T("EDID parsed, hash = %u"), hash));
+                }
+                _edidStale = false;
+            }
+        }
+
+        if (ret == Core::ERROR_NONE)
+        {
+            edid = _edid;
+        }
+
+        _edidLock.Unlock();
+
+        return ret;
+    }
+
     uint32_t GetEdidBytes(vector<uint8_t> &edid) const
     {
         uint32_t ret = Core::ERROR_NONE;
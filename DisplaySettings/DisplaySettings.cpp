@@ -70,10 +70,20 @@ using namespace std;
 #define HDMICECSINK_PLUGIN_ACTIVATION_TIME 2
 #define RECONNECTION_TIME_IN_MILLISECONDS 5500
 #define AUDIO_DEVICE_CONNECTION_CHECK_TIME_IN_MILLISECONDS 3000
+#define FRAMERATE_SWITCH_SETTLE_TIME_IN_MILLISECONDS 3000
+#define FRAMERATE_SWITCH_MAX_TIME_IN_MILLISECONDS 10000
 
 #define ZOOM_SETTINGS_FILE      "/opt/persistent/rdkservices/zoomSettings.json"
 #define ZOOM_SETTINGS_DIRECTORY "/opt/persistent/rdkservices"
 
+// returnResponse for the methods with a JsonData result
+#define returnTypedResponse(success) \
+    { \
+        response.Success = success; \
+        LOGTRACEMETHODFIN(); \
+        return (Core::ERROR_NONE); \
+    }
+
 static bool isCecArcRoutingThreadEnabled = false;
 static bool isCecEnabled = false;
 
@@ -213,6 +223,7 @@ namespace WPEFramework {
             registerMethod("setAssociatedAudioMixing", &DisplaySettings::setAssociatedAudioMixing, this);
             registerMethod("getAssociatedAudioMixing", &DisplaySettings::getAssociatedAudioMixing, this);
             registerMethod("setFaderControl", &DisplaySettings::setFaderControl, this);
+            registerMethod("setAudioProfile", &DisplaySettings::setAudioProfile, this);
             registerMethod("getFaderControl", &DisplaySettings::getFaderControl, this);
             registerMethod("setPrimaryLanguage", &DisplaySettings::setPrimaryLanguage, this);
             registerMethod("getPrimaryLanguage", &DisplaySettings::getPrimaryLanguage, this);
@@ -245,9 +256,12 @@ namespace WPEFramework {
         m_arcAudioEnabled = false;
 	    m_hdmiCecAudioDeviceDetected = false;
 	    m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
-	    m_cecArcRoutingThreadRun = false;
+	    m_arcBringUpPending = false;
+	    m_frameRateSwitchUntilMs = 0;
+	    m_dsCacheGeneration = 0;
 	    isCecArcRoutingThreadEnabled = true;
 	    m_arcRoutingThread = std::thread(cecArcRoutingThread);
+	    m_videoEventThread = std::thread(videoEventThread);
 	    m_timer.connect(std::bind(&DisplaySettings::onTimer, this));
             m_AudioDeviceDetectTimer.connect(std::bind(&DisplaySettings::checkAudioDeviceDetectionTimer, this));
         }
@@ -379,9 +393,7 @@ namespace WPEFramework {
                                         std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
                                         if((m_currentArcRoutingState == ARC_STATE_ARC_TERMINATED) && (isCecEnabled == true)) {
                                             LOGINFO("%s: Send dummy ARC initiation request... \n", __FUNCTION__);
-                                            m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-                                            m_cecArcRoutingThreadRun = true;
-                                            arcRoutingCV.notify_one();
+                                            requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
                                         }
                                        }
                                     }
@@ -448,6 +460,7 @@ namespace WPEFramework {
             {
                 LOGWARN("Current power state %d", m_powerState);
             }
+            warmDsCache();
             LOGWARN ("DisplaySettings::Initialize completes line:%d", __LINE__);
             // On success return empty, to indicate there is no error text.
             return (string());
@@ -461,14 +474,16 @@ namespace WPEFramework {
             std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
             LOGINFO("DisplaySettings::Deinitialize %d", __LINE__);
             m_currentArcRoutingState = ARC_STATE_ARC_EXIT;
-	    m_cecArcRoutingThreadRun = true;
-            arcRoutingCV.notify_one();
 	   }
+	   queueAudioRoutingEvent(AUDIO_ROUTING_EXIT);
+	   queueVideoEvent(VIDEO_EVENT_EXIT);
 
             try
             {
                 if (m_arcRoutingThread.joinable())
                         m_arcRoutingThread.join();
+                if (m_videoEventThread.joinable())
+                        m_videoEventThread.join();
             }
             catch(const std::system_error& e)
             {
@@ -503,6 +518,8 @@ namespace WPEFramework {
 		IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_VIDEO_FORMAT_UPDATE, formatUpdateEventHandler) );
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, powerEventHandler) );
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_PORT_STATE, audioPortStateEventHandler) );
+                IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_PRECHANGE, frameRateChangeEventHandler) );
+                IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_POSTCHANGE, frameRateChangeEventHandler) );
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_ASSOCIATED_AUDIO_MIXING_CHANGED, dsSettingsChangeEventHandler) );
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_FADER_CONTROL_CHANGED, dsSettingsChangeEventHandler) );
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_PRIMARY_LANGUAGE_CHANGED, dsSettingsChangeEventHandler) );
@@ -544,6 +561,8 @@ namespace WPEFramework {
 		IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_AUDIO_FORMAT_UPDATE) );
                 IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED) );
                 IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_AUDIO_PORT_STATE) );
+                IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_PRECHANGE) );
+                IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_POSTCHANGE) );
             }
 
             try
@@ -564,7 +583,8 @@ namespace WPEFramework {
         {
             if(DisplaySettings::_instance)
             {
-                DisplaySettings::_instance->resolutionPreChange();
+                DisplaySettings::_instance->invalidateDsCache("currentResolution:");
+                DisplaySettings::_instance->queueVideoEvent(VIDEO_EVENT_RESOLUTION_PRE_CHANGE);
             }
         }
 
@@ -587,7 +607,8 @@ namespace WPEFramework {
 
             if(DisplaySettings::_instance)
             {
-                DisplaySettings::_instance->resolutionChanged(dw, dh);
+                DisplaySettings::_instance->invalidateDsCache("currentResolution:");
+                DisplaySettings::_instance->queueVideoEvent(VIDEO_EVENT_RESOLUTION_CHANGED, dw, dh);
             }
         }
 
@@ -608,7 +629,10 @@ namespace WPEFramework {
                         dw = eventData->data.resn.width ;
                         dh = eventData->data.resn.height ;
                         if(DisplaySettings::_instance)
-                            DisplaySettings::_instance->resolutionChanged(dw,dh);
+                        {
+                            DisplaySettings::_instance->invalidateDsCache("currentResolution:");
+                            DisplaySettings::_instance->queueVideoEvent(VIDEO_EVENT_RESOLUTION_CHANGED, dw, dh);
+                        }
                     }
                     break;
                 case IARM_BUS_DSMGR_EVENT_ZOOM_SETTINGS:
@@ -654,6 +678,14 @@ namespace WPEFramework {
 
         void DisplaySettings::dsHdmiEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
+            // A hotplug changes the EDID, so TV resolutions and audio modes, and the connected ports
+            if(DisplaySettings::_instance)
+            {
+                DisplaySettings::_instance->invalidateDsCache();
+                // and the audio ports are initialised again for real, whatever the frame rate does
+                DisplaySettings::_instance->m_frameRateSwitchUntilMs = 0;
+            }
+
             switch (eventId)
             {
             case IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG :
@@ -665,7 +697,7 @@ namespace WPEFramework {
                     int hdmi_hotplug_event = eventData->data.hdmi_hpd.event;
                     LOGINFO("Received IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG  event data:%d ", hdmi_hotplug_event);
                     if(DisplaySettings::_instance)
-                        DisplaySettings::_instance->connectedVideoDisplaysUpdated(hdmi_hotplug_event);
+                        DisplaySettings::_instance->queueVideoEvent(VIDEO_EVENT_DISPLAYS_UPDATED, hdmi_hotplug_event);
                 }
                 break;
                 //TODO(MROLLINS) localinput.cpp was also sending these and they were getting handled by services other then DisplaySettings.  Should DisplaySettings own these as well ?
@@ -715,156 +747,8 @@ namespace WPEFramework {
             }
 
 		    if(hdmiin_hotplug_port == HDMI_IN_ARC_PORT_ID) { //HDMI ARC/eARC Port Handling
-			bool arc_port_enabled =  false;
-
-                        JsonObject audioOutputPortConfig = DisplaySettings::_instance->getAudioOutputPortConfig();
-			if (audioOutputPortConfig.HasLabel("HDMI_ARC")) {
-                            try {
-                                    arc_port_enabled = audioOutputPortConfig["HDMI_ARC"].Boolean();
-                            }catch (const device::Exception& err) {
-                                    LOGERR("HDMI_ARC not in config object \n");
-                                    arc_port_enabled = false;
-                            }
-			}
-
-                        if(arc_port_enabled) {
-                            try
-                            {
-                                int types = dsAUDIOARCSUPPORT_NONE;
-                                device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI_ARC0");
-
-                                if(hdmiin_hotplug_conn) {
-                                    aPort.getSupportedARCTypes(&types);
-                                    LOGINFO("dsHdmiEventHandler: Configuring User set Audio mode before starting ARC/eARC Playback...\n");
-                                    if(aPort.getStereoAuto() == true) {
-					if(types & dsAUDIOARCSUPPORT_eARC) {
-					    aPort.setStereoAuto(true,true);
-					}
-					else if (types & dsAUDIOARCSUPPORT_ARC) {
-                                            if (!DisplaySettings::_instance->requestShortAudioDescriptor()) {
-                                                LOGERR("dsHdmiEventHandler (ARC Auto mode): requestShortAudioDescriptor failed !!!\n");;
-                                            }
-                                            else {
-                                                LOGINFO("dsHdmiEventHandler (ARC Auto Mode): requestShortAudioDescriptor successful\n");
-                                            }
-					    aPort.setStereoAuto(true,true);
-					}
-                                    }
-                                    else{
-                                        device::AudioStereoMode mode = device::AudioStereoMode::kStereo;  //default to stereo
-                                        mode = aPort.getStereoMode(); //get Last User set stereo mode and set
-					if((types & dsAUDIOARCSUPPORT_ARC) && (mode == device::AudioStereoMode::kPassThru)){
-                                            if (!DisplaySettings::_instance->requestShortAudioDescriptor()) {
-                                                LOGERR("dsHdmiEventHandler (ARC Passthru mode): requestShortAudioDescriptor failed !!!\n");;
-                                            }
-                                            else {
-                                                LOGINFO("dsHdmiEventHandler (ARC Passthru mode): requestShortAudioDescriptor successful\n");
-                                            }
-					    aPort.setStereoMode(mode.toString(), true);
-                                        }
-					else if(types & dsAUDIOARCSUPPORT_eARC) {
-                                            aPort.setStereoMode(mode.toString(), true);
-                                        }
-                                    }
-
-                                    if(types & dsAUDIOARCSUPPORT_eARC) {
-                                        DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = true;
-                                        DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
-                                        LOGINFO("dsHdmiEventHandler: Enable eARC\n");
-                                        aPort.enableARC(dsAUDIOARCSUPPORT_eARC, true);
-                                        DisplaySettings::_instance->m_arcAudioEnabled = true;
-                                    }
-                                    else if(types & dsAUDIOARCSUPPORT_ARC)  {
-                                      {
-                                         if (isCecEnabled == true)
-                                         {
-                                            //No need to check the ARC routing state. Request ARC initiation irrespective of state
-                                            LOGINFO("%s: Send ARC initiation request... \n", __FUNCTION__);
-                                            std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
-                                            DisplaySettings::_instance->m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-                                            DisplaySettings::_instance->m_cecArcRoutingThreadRun = true;
-                                            DisplaySettings::_instance->arcRoutingCV.notify_one();
-                                         }else {
-					    LOGINFO("%s: cec is disabled, ARC initiation not possible \n", __FUNCTION__);
-				         }
-                                      }
-                                    }
-                                    else {
-				        LOGINFO("dsHdmiEventHandler: Skip HDMI ARC/eARC handling. Connected device does not support ARC/eARC \n");
-                                    }
-                                }
-                                else { //HDMI ARC/eARC disconnected
-                                        LOGINFO("dsHdmiEventHandler: Disable ARC\n");
-                                        DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = false;
-                                        DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
-					if(DisplaySettings::_instance->m_arcAudioEnabled == true) {
-                                            aPort.enableARC(dsAUDIOARCSUPPORT_ARC, false);
-                                            DisplaySettings::_instance->m_arcAudioEnabled = false;
-					}
-
-                                       {
-                                        std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
-                                        DisplaySettings::_instance->m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
-                                       }
-                                }
-                            }
-                            catch (const device::Exception& err)
-                            {
-                                LOG_DEVICE_EXCEPTION1(string("HDMI_ARC0"));
-                            }
-                        }
-                        else { //HDMI ARC/eARC UI settings not enabled
-                            LOGINFO("dsHdmiEventHandler: Skip HDMI_ARC Hotplug handling !!! HDMI_ARC port not enabled. \n");
-                            int types = dsAUDIOARCSUPPORT_NONE;
-                           try {
-                                device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI_ARC0");
-                               aPort.getSupportedARCTypes(&types);
-
-                               if(hdmiin_hotplug_conn) {
-                                   if(types & dsAUDIOARCSUPPORT_eARC) {
-                                       DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = true;
-                                       DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
-                                   }
-                                   else if (types & dsAUDIOARCSUPPORT_ARC) {
-                                       //Dummy ARC intiation request
-                                      {
-					 if (isCecEnabled == true)
-					 {
-                                        //No need to check the ARC routing state. Request ARC initiation irrespective of state
-                                            LOGINFO("%s: cecEnabled is true, Send dummy ARC initiation request... \n", __FUNCTION__);
-                                            std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
-                                            DisplaySettings::_instance->m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-                                            DisplaySettings::_instance->m_cecArcRoutingThreadRun = true;
-                                            DisplaySettings::_instance->arcRoutingCV.notify_one();
-					 }else {
-					    LOGINFO("%s: cec is disabled, ARC initiation not possible \n", __FUNCTION__);
-					 }
-                                      }
-                                   }
-                                   else {
-                                       LOGINFO("%s: Connected Device doesn't have ARC/eARC capability... \n", __FUNCTION__);
-                                   }
-                               }
-                               else {
-                                   DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = false;
-                                   DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
-				   if(DisplaySettings::_instance->m_arcAudioEnabled == true) {
-                                       aPort.enableARC(dsAUDIOARCSUPPORT_ARC, false);
-                                       DisplaySettings::_instance->m_arcAudioEnabled = false;
-				   }
-
-                                   {
-                                     std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
-                                     DisplaySettings::_instance->m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
-                                   }
-                               }
-                           }
-                           catch (const device::Exception& err){
-                                   LOG_DEVICE_EXCEPTION1(string("HDMI_ARC0"));
-                           }
-	                }
-
-	            }// HDMI_IN_ARC_PORT_ID
+		        DisplaySettings::_instance->queueAudioRoutingEvent(AUDIO_ROUTING_HDMI_IN_HOTPLUG, JsonObject(), hdmiin_hotplug_conn);
+		    }
 
 		}
 	        break;
@@ -897,7 +781,7 @@ namespace WPEFramework {
                     videoFormat = eventData->data.VideoFormatInfo.videoFormat;
                     LOGINFO("Received IARM_BUS_DSMGR_EVENT_VIDEO_FORMAT_UPDATE. Video format: %d \n", videoFormat);
                     if(DisplaySettings::_instance) {
-                        DisplaySettings::_instance->notifyVideoFormatChange(videoFormat);
+                        DisplaySettings::_instance->queueVideoEvent(VIDEO_EVENT_VIDEO_FORMAT, videoFormat);
                     }
 		  }
                   break;
@@ -920,8 +804,11 @@ namespace WPEFramework {
                    try
                    {   if( audioPortState == dsAUDIOPORT_STATE_INITIALIZED)
                        {
-                           DisplaySettings::_instance->AudioPortsReInitialize();
-                           DisplaySettings::_instance->InitAudioPorts();
+                           DisplaySettings::_instance->invalidateDsCache();
+                           if (DisplaySettings::_instance->inFrameRateSwitch())
+                               LOGINFO("audio ports initialised during a frame rate switch, not initialised again");
+                           else
+                               DisplaySettings::_instance->queueAudioRoutingEvent(AUDIO_ROUTING_REINIT_AUDIO_PORTS);
                        }
                   }
                   catch(const device::Exception& err)
@@ -936,6 +823,33 @@ namespace WPEFramework {
            }  
         }  
 
+        // Only the rate of the HDMI mode changes, the audio of the sink stays what it was: the audio
+        // port state dsMgr reports on the way does not need the ports and ARC set up again, which
+        // would be seconds of no audio on top of the blank of the switch.
+        void DisplaySettings::frameRateChangeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            if(!DisplaySettings::_instance)
+                return;
+
+            int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            switch (eventId) {
+                case IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_PRECHANGE:
+                    DisplaySettings::_instance->m_frameRateSwitchUntilMs = now + FRAMERATE_SWITCH_MAX_TIME_IN_MILLISECONDS;
+                    break;
+                case IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_POSTCHANGE:
+                    DisplaySettings::_instance->m_frameRateSwitchUntilMs = now + FRAMERATE_SWITCH_SETTLE_TIME_IN_MILLISECONDS;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        bool DisplaySettings::inFrameRateSwitch() const
+        {
+            int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            return now < m_frameRateSwitchUntilMs;
+        }
+
         void DisplaySettings::dsSettingsChangeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
 
@@ -944,6 +858,8 @@ namespace WPEFramework {
                 LOGERR("data is NULL, return !!!\n");
                 return;
             }
+            if(DisplaySettings::_instance)
+                DisplaySettings::_instance->invalidateDsCache("supportedAudioModes:");
             switch (eventId) {
                 case IARM_BUS_DSMGR_EVENT_AUDIO_ASSOCIATED_AUDIO_MIXING_CHANGED:
                   {
@@ -999,9 +915,11 @@ namespace WPEFramework {
             for(auto& i : items) arr.Add(JsonValue(i));
 
             response[key] = arr;
+        }
 
-            string json;
-            response.ToString(json);
+        void setResponseArray(Core::JSON::ArrayType<Core::JSON::String>& response, const vector<string>& items)
+        {
+            for(auto& i : items) response.Add() = i;
         }
 
         //Begin methods
@@ -1019,6 +937,13 @@ namespace WPEFramework {
         uint32_t DisplaySettings::getConnectedAudioPorts(const JsonObject& parameters, JsonObject& response)
         {   //sample servicemanager response: {"success":true,"connectedAudioPorts":["HDMI0"]}
             LOGINFOMETHOD();
+            // HDMI_ARC0 only counts with an audio device behind it
+            const string cacheKey = string("connectedAudioPorts:") + (m_hdmiInAudioDeviceConnected ? "arc" : "");
+            uint32_t generation;
+            if (getCachedResponse(cacheKey, response, generation))
+                returnResponse(true);
+
+            bool cacheable = true;
             vector<string> connectedAudioPorts;
             try
             {
@@ -1039,8 +964,11 @@ namespace WPEFramework {
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION0();
+                cacheable = false;
             }
             setResponseArray(response, "connectedAudioPorts", connectedAudioPorts);
+            if (cacheable)
+                setCachedResponse(cacheKey, response, generation);
             returnResponse(true);
         }
 
@@ -1090,11 +1018,16 @@ namespace WPEFramework {
             returnResponse(true);
         }
 
-        uint32_t DisplaySettings::getSupportedTvResolutions(const JsonObject& parameters, JsonObject& response)
+        uint32_t DisplaySettings::getSupportedTvResolutions(const JsonData::DisplaySettings::GetsupportedtvresolutionsParamsData& parameters, JsonData::DisplaySettings::GetsupportedtvresolutionsResultData& response)
         {   //sample servicemanager response:{"success":true,"supportedTvResolutions":["480i","480p","576i","720p","1080i","1080p"]}
             LOGINFOMETHOD();
-            std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
-            string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : strVideoPort;
+            string videoDisplay = parameters.Videodisplay.IsSet() ? parameters.Videodisplay.Value() : device::Host::getInstance().getDefaultVideoPortName();
+            const string cacheKey = "supportedTvResolutions:" + videoDisplay;
+            uint32_t generation;
+            if (getCachedResponse(cacheKey, response.Supportedtvresolutions, generation))
+                returnTypedResponse(true);
+
+            bool cacheable = true;
             vector<string> supportedTvResolutions;
             try
             {
@@ -1115,9 +1048,12 @@ namespace WPEFramework {
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION1(videoDisplay);
+                cacheable = false;
             }
-            setResponseArray(response, "supportedTvResolutions", supportedTvResolutions);
-            returnResponse(true);
+            setResponseArray(response.Supportedtvresolutions, supportedTvResolutions);
+            if (cacheable)
+                setCachedResponse(cacheKey, supportedTvResolutions, generation);
+            returnTypedResponse(true);
         }
 
         uint32_t DisplaySettings::getSupportedSettopResolutions(const JsonObject& parameters, JsonObject& response)
@@ -1171,10 +1107,16 @@ namespace WPEFramework {
             returnResponse(true);
         }
 
-        uint32_t DisplaySettings::getSupportedAudioModes(const JsonObject& parameters, JsonObject& response)
+        uint32_t DisplaySettings::getSupportedAudioModes(const JsonData::DisplaySettings::GetsupportedaudiomodesParamsData& parameters, JsonData::DisplaySettings::GetsupportedaudiomodesResultData& response)
         {   //sample response: {"success":true,"supportedAudioModes":["STEREO","PASSTHRU","AUTO (Dolby Digital 5.1)"]}
             LOGINFOMETHOD();
-            string audioPort = parameters.HasLabel("audioPort") ? parameters["audioPort"].String() : "";
+            string audioPort = parameters.Audioport.Value();
+            const string cacheKey = "supportedAudioModes:" + audioPort;
+            uint32_t generation;
+            if (getCachedResponse(cacheKey, response.Supportedaudiomodes, generation))
+                returnTypedResponse(true);
+
+            bool cacheable = true;
             vector<string> supportedAudioModes;
             try
             {
@@ -1211,6 +1153,7 @@ namespace WPEFramework {
                     catch(const device::Exception& err)
                     {
                         surroundMode = false;
+                        cacheable = false;
                         LOG_DEVICE_EXCEPTION1(audioPort);
                     }
                     if (vPort.isDisplayConnected() && surroundMode)
@@ -1241,9 +1184,12 @@ namespace WPEFramework {
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION1(audioPort);
+                cacheable = false;
             }
-            setResponseArray(response, "supportedAudioModes", supportedAudioModes);
-            returnResponse(true);
+            setResponseArray(response.Supportedaudiomodes, supportedAudioModes);
+            if (cacheable)
+                setCachedResponse(cacheKey, supportedAudioModes, generation);
+            returnTypedResponse(true);
         }
 
         uint32_t DisplaySettings::getZoomSetting(const JsonObject& parameters, JsonObject& response)
@@ -1312,6 +1258,11 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
             string videoDisplay = parameters.HasLabel("videoDisplay") ? parameters["videoDisplay"].String() : strVideoPort;
+            const string cacheKey = "currentResolution:" + videoDisplay;
+            uint32_t generation;
+            if (getCachedResponse(cacheKey, response, generation))
+                returnResponse(true);
+
             bool success = true;
             try
             {
@@ -1323,6 +1274,8 @@ namespace WPEFramework {
                 LOG_DEVICE_EXCEPTION1(videoDisplay);
                 success = false;
             }
+            if (success)
+                setCachedResponse(cacheKey, response, generation);
             returnResponse(success);
         }
 
@@ -1344,6 +1297,7 @@ namespace WPEFramework {
             if (!isIgnoreEdidArg) LOGINFO("isIgnoreEdid: false"); else LOGINFO("isIgnoreEdid: %d", isIgnoreEdid);
 
             bool success = true;
+            invalidateDsCache("currentResolution:");
             try
             {
                 device::VideoOutputPort &vPort = device::Host::getInstance().getVideoOutputPort(videoDisplay);
@@ -1876,6 +1830,12 @@ namespace WPEFramework {
             int capabilities = dsAUDIOSUPPORT_NONE;
 
             string audioPort = parameters.HasLabel("audioPort") ? parameters["audioPort"].String() : "HDMI0";
+            const string cacheKey = "settopAudioCapabilities:" + audioPort;
+            uint32_t generation;
+            if (getCachedResponse(cacheKey, response, generation))
+                returnResponse(true);
+
+            bool cacheable = true;
             try
             {
                 device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort(audioPort);
@@ -1884,6 +1844,7 @@ namespace WPEFramework {
             catch(const device::Exception& err)
             {
                 LOG_DEVICE_EXCEPTION0();
+                cacheable = false;
             }
 
             if(!capabilities)audioCapabilities.Add("none");
@@ -1899,6 +1860,8 @@ namespace WPEFramework {
             {
                LOGINFO("capabilities: %s", audioCapabilities[i].String().c_str());
             }
+            if (cacheable)
+                setCachedResponse(cacheKey, response, generation);
             returnResponse(true);
         }
 
@@ -2082,64 +2045,39 @@ namespace WPEFramework {
                 returnResponse(success);
         }
 
-        void DisplaySettings::audioFormatToString(dsAudioFormat_t audioFormat, JsonObject & response)
+        const char *DisplaySettings::audioFormatToString(dsAudioFormat_t audioFormat)
         {
-            std::vector<string> supportedAudioFormat = {"NONE", "PCM", "AAC","VORBIS","WMA", "DOLBY AC3", "DOLBY EAC3",
-                                                         "DOLBY AC4", "DOLBY MAT", "DOLBY TRUEHD",
-                                                         "DOLBY EAC3 ATMOS","DOLBY TRUEHD ATMOS",
-                                                         "DOLBY MAT ATMOS","DOLBY AC4 ATMOS","UNKNOWN"};
             switch (audioFormat)
             {
-                   case dsAUDIO_FORMAT_NONE:
-                       response["currentAudioFormat"] = "NONE";
-                       break;
-                   case dsAUDIO_FORMAT_PCM:
-                       response["currentAudioFormat"] = "PCM";
-                       break;
-                   case dsAUDIO_FORMAT_AAC:
-                       response["currentAudioFormat"] = "AAC";
-                       break;
-                   case dsAUDIO_FORMAT_VORBIS:
-                       response["currentAudioFormat"] = "VORBIS";
-                       break;
-                   case dsAUDIO_FORMAT_WMA:
-                       response["currentAudioFormat"] = "WMA";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_AC3:
-                       response["currentAudioFormat"] = "DOLBY AC3";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_EAC3:
-                       response["currentAudioFormat"] = "DOLBY EAC3";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_AC4:
-                       response["currentAudioFormat"] = "DOLBY AC4";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_MAT:
-                       response["currentAudioFormat"] = "DOLBY MAT";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_TRUEHD:
-                       response["currentAudioFormat"] = "DOLBY TRUEHD";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_EAC3_ATMOS:
-                       response["currentAudioFormat"] = "DOLBY EAC3 ATMOS";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_TRUEHD_ATMOS:
-                       response["currentAudioFormat"] = "DOLBY TRUEHD ATMOS";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_MAT_ATMOS:
-                       response["currentAudioFormat"] = "DOLBY MAT ATMOS";
-                       break;
-                   case dsAUDIO_FORMAT_DOLBY_AC4_ATMOS:
-                       response["currentAudioFormat"] = "DOLBY AC4 ATMOS";
-                       break;
-                   default:
-                       response["currentAudioFormat"] = "UNKNOWN";
-                       break;
-            }
-            setResponseArray(response, "supportedAudioFormat", supportedAudioFormat);
+                   case dsAUDIO_FORMAT_NONE:               return "NONE";
+                   case dsAUDIO_FORMAT_PCM:                return "PCM";
+                   case dsAUDIO_FORMAT_AAC:                return "AAC";
+                   case dsAUDIO_FORMAT_VORBIS:             return "VORBIS";
+                   case dsAUDIO_FORMAT_WMA:                return "WMA";
+                   case dsAUDIO_FORMAT_DOLBY_AC3:          return "DOLBY AC3";
+                   case dsAUDIO_FORMAT_DOLBY_EAC3:         return "DOLBY EAC3";
+                   case dsAUDIO_FORMAT_DOLBY_AC4:          return "DOLBY AC4";
+                   case dsAUDIO_FORMAT_DOLBY_MAT:          return "DOLBY MAT";
+                   case dsAUDIO_FORMAT_DOLBY_TRUEHD:       return "DOLBY TRUEHD";
+                   case dsAUDIO_FORMAT_DOLBY_EAC3_ATMOS:   return "DOLBY EAC3 ATMOS";
+                   case dsAUDIO_FORMAT_DOLBY_TRUEHD_ATMOS: return "DOLBY TRUEHD ATMOS";
+                   case dsAUDIO_FORMAT_DOLBY_MAT_ATMOS:    return "DOLBY MAT ATMOS";
+                   case dsAUDIO_FORMAT_DOLBY_AC4_ATMOS:    return "DOLBY AC4 ATMOS";
+                   default:                                return "UNKNOWN";
+            }
 	}
 
-        uint32_t DisplaySettings::getAudioFormat(const JsonObject& parameters, JsonObject& response)
+        void DisplaySettings::getSupportedAudioFormats(Core::JSON::ArrayType<Core::JSON::String>& formats)
+        {
+            static const char * const supportedAudioFormat[] = {"NONE", "PCM", "AAC","VORBIS","WMA", "DOLBY AC3", "DOLBY EAC3",
+                                                         "DOLBY AC4", "DOLBY MAT", "DOLBY TRUEHD",
+                                                         "DOLBY EAC3 ATMOS","DOLBY TRUEHD ATMOS",
+                                                         "DOLBY MAT ATMOS","DOLBY AC4 ATMOS","UNKNOWN"};
+            for (const char *format : supportedAudioFormat)
+                formats.Add() = format;
+        }
+
+        uint32_t DisplaySettings::getAudioFormat(const JsonObject& parameters, JsonData::DisplaySettings::GetaudioformatResultData& response)
         {
              LOGINFOMETHOD();
 	     bool success = true;
@@ -2148,22 +2086,24 @@ namespace WPEFramework {
              {
                  device::Host::getInstance().getCurrentAudioFormat(audioFormat);
                  LOGINFO("current audio format: %d \n", audioFormat);
-                 audioFormatToString(audioFormat, response);
                  success = true;
              }
              catch (const device::Exception& err)
              {
                  LOG_DEVICE_EXCEPTION0();
 		 success = false;
-		 audioFormatToString(dsAUDIO_FORMAT_NONE, response);
+		 audioFormat = dsAUDIO_FORMAT_NONE;
              }
-	     returnResponse(success);
+             response.Currentaudioformat = audioFormatToString(audioFormat);
+             getSupportedAudioFormats(response.Supportedaudioformat);
+	     returnTypedResponse(success);
         }
 
 	void DisplaySettings::notifyAudioFormatChange(dsAudioFormat_t audioFormat)
 	{
-	     JsonObject params;
-	     audioFormatToString(audioFormat, params);
+	     JsonData::DisplaySettings::AudioformatchangedParamsData params;
+	     params.Currentaudioformat = audioFormatToString(audioFormat);
+	     getSupportedAudioFormats(params.Supportedaudioformat);
              sendNotify("audioFormatChanged", params);
 	}
 
@@ -3296,6 +3236,131 @@ namespace WPEFramework {
         }
 
 
+        // Applies a set of audio settings to one port. All values are checked before the first one is
+        // applied and a setting the port already has is not set again, as each set can re-initialise the
+        // audio path. The sound mode, which always does, goes last.
+        uint32_t DisplaySettings::setAudioProfile(const JsonObject& parameters, JsonObject& response)
+        {
+                LOGINFOMETHOD();
+                string audioPort = parameters.HasLabel("audioPort") ? parameters["audioPort"].String() : "HDMI0";
+
+                int DRCMode = 0, bassBoost = 0, mixerBalance = 0, enhancerLevel = 0;
+                bool MISteering = false, surroundDecoder = false;
+                bool hasDRCMode = parameters.HasLabel("DRCMode");
+                bool hasBassBoost = parameters.HasLabel("bassBoost");
+                bool hasMixerBalance = parameters.HasLabel("mixerBalance");
+                bool hasEnhancerLevel = parameters.HasLabel("enhancerlevel");
+                bool hasMISteering = parameters.HasLabel("MISteeringEnable");
+                bool hasSurroundDecoder = parameters.HasLabel("surroundDecoderEnable");
+                bool hasSoundMode = parameters.HasLabel("soundMode");
+
+                if (!hasDRCMode && !hasBassBoost && !hasMixerBalance && !hasEnhancerLevel && !hasMISteering && !hasSurroundDecoder && !hasSoundMode) {
+                    LOGWARN("No audio settings given");
+                    returnResponse(false);
+                }
+
+                try {
+                    if (hasDRCMode) {
+                        string sDRCMode = parameters["DRCMode"].String();
+                        if (!Utils::isValidUnsignedInt((char*)sDRCMode.c_str())) {
+                            LOGWARN("DRCMode should be an unsigned integer");
+                            returnResponse(false);
+                        }
+                        DRCMode = stoi(sDRCMode);
+                    }
+                    if (hasBassBoost) {
+                        string sBassBoost = parameters["bassBoost"].String();
+                        if (!Utils::isValidUnsignedInt((char*)sBassBoost.c_str())) {
+                            LOGWARN("bassBoost should be an unsigned integer");
+                            returnResponse(false);
+                        }
+                        bassBoost = stoi(sBassBoost);
+                    }
+                    if (hasMixerBalance) {
+                        string sMixerBalance = parameters["mixerBalance"].String();
+                        if (!Utils::isValidInt((char*)sMixerBalance.c_str())) {
+                            LOGWARN("mixerBalance should be an integer");
+                            returnResponse(false);
+                        }
+                        mixerBalance = stoi(sMixerBalance);
+                    }
+                    if (hasEnhancerLevel)
+                        enhancerLevel = stoi(parameters["enhancerlevel"].String());
+                    if (hasMISteering)
+                        MISteering = parameters["MISteeringEnable"].Boolean();
+                    if (hasSurroundDecoder)
+                        surroundDecoder = parameters["surroundDecoderEnable"].Boolean();
+                }
+                catch (const std::exception& err) {
+                    LOGERR("Failed to parse the audio settings: %s", err.what());
+                    returnResponse(false);
+                }
+
+                bool success = true;
+                JsonArray applied;
+                try
+                {
+                        device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort(audioPort);
+
+                        if (hasDRCMode && aPort.getDRCMode() != DRCMode) {
+                            aPort.setDRCMode(DRCMode);
+                            applied.Add("DRCMode");
+                        }
+                        if (hasMISteering && aPort.getMISteering() != MISteering) {
+                            aPort.setMISteering(MISteering);
+                            applied.Add("MISteeringEnable");
+                        }
+                        if (hasBassBoost && aPort.getBassEnhancer() != bassBoost) {
+                            aPort.setBassEnhancer(bassBoost);
+                            applied.Add("bassBoost");
+                        }
+                        if (hasSurroundDecoder && aPort.isSurroundDecoderEnabled() != surroundDecoder) {
+                            aPort.enableSurroundDecoder(surroundDecoder);
+                            applied.Add("surroundDecoderEnable");
+                        }
+                        if (hasEnhancerLevel && aPort.getDialogEnhancement() != enhancerLevel) {
+                            aPort.setDialogEnhancement(enhancerLevel);
+                            applied.Add("enhancerlevel");
+                        }
+                        if (hasMixerBalance) {
+                            int current = 0;
+                            if (device::Host::getInstance().isHDMIOutPortPresent()) {
+                                aPort.getFaderControl(&current);
+                                if (current != mixerBalance)
+                                    aPort.setFaderControl(mixerBalance);
+                            }
+                            else {
+                                device::Host::getInstance().getFaderControl(&current);
+                                if (current != mixerBalance)
+                                    device::Host::getInstance().setFaderControl(mixerBalance);
+                            }
+                            if (current != mixerBalance)
+                                applied.Add("mixerBalance");
+                        }
+                }
+                catch (const device::Exception& err)
+                {
+                        LOG_DEVICE_EXCEPTION1(audioPort);
+                        success = false;
+                }
+
+                if (success && hasSoundMode) {
+                    JsonObject soundModeParams;
+                    JsonObject soundModeResponse;
+                    soundModeParams["audioPort"] = audioPort;
+                    soundModeParams["soundMode"] = parameters["soundMode"].String();
+                    if (parameters.HasLabel("persist"))
+                        soundModeParams["persist"] = parameters["persist"].Boolean();
+                    setSoundMode(soundModeParams, soundModeResponse);
+                    success = soundModeResponse["success"].Boolean();
+                    if (success)
+                        applied.Add("soundMode");
+                }
+
+                response["applied"] = applied;
+                returnResponse(success);
+        }
+
         uint32_t DisplaySettings::getFaderControl(const JsonObject& parameters, JsonObject& response)
         {
                 LOGINFOMETHOD();
@@ -3804,7 +3869,7 @@ namespace WPEFramework {
                     LOGINFO("ARC Routing - %d \n", arcEnable);
                     {
                         UnlockApiGuard unlockApi;
-                        hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "setupARCRouting", param, hdmiCecSinkResult);
+                        Utils::releaseThunderControllerClient(hdmiCecSinkPlugin, hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "setupARCRouting", param, hdmiCecSinkResult));
                     }
                     if (!hdmiCecSinkResult["success"].Boolean()) {
 			success = false;
@@ -3836,7 +3901,7 @@ namespace WPEFramework {
 
                     {
                         UnlockApiGuard unlockApi;
-                        hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "getEnabled", param, hdmiCecSinkResult);
+                        Utils::releaseThunderControllerClient(hdmiCecSinkPlugin, hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "getEnabled", param, hdmiCecSinkResult));
                     }
 
 		    cecEnable = hdmiCecSinkResult["enabled"].Boolean();
@@ -3871,7 +3936,7 @@ namespace WPEFramework {
 
                     {
                         UnlockApiGuard unlockApi;
-                        hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "getAudioDeviceConnectedStatus", param, hdmiCecSinkResult);
+                        Utils::releaseThunderControllerClient(hdmiCecSinkPlugin, hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "getAudioDeviceConnectedStatus", param, hdmiCecSinkResult));
                     }
 
                     hdmiAudioDeviceDetected = hdmiCecSinkResult["connected"].Boolean();
@@ -3906,7 +3971,7 @@ namespace WPEFramework {
                     LOGINFO("%s: Send Audio Device Power On !!!\n");
                     {
                         UnlockApiGuard unlockApi;
-                        hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "sendAudioDevicePowerOnMessage", param, hdmiCecSinkResult);
+                        Utils::releaseThunderControllerClient(hdmiCecSinkPlugin, hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "sendAudioDevicePowerOnMessage", param, hdmiCecSinkResult));
                     }
                     if (!hdmiCecSinkResult["success"].Boolean()) {
                         success = false;
@@ -3938,7 +4003,7 @@ namespace WPEFramework {
                     LOGINFO("Requesting Short Audio Descriptor \n");
                     {
                         UnlockApiGuard unlockApi;
-                        hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "requestShortAudioDescriptor", param, hdmiCecSinkResult);
+                        Utils::releaseThunderControllerClient(hdmiCecSinkPlugin, hdmiCecSinkPlugin->Invoke<JsonObject, JsonObject>(2000, "requestShortAudioDescriptor", param, hdmiCecSinkResult));
                     }
                     if (!hdmiCecSinkResult["success"].Boolean()) {
                         success = false;
@@ -3961,6 +4026,7 @@ namespace WPEFramework {
 
             bool success = true;
             string audioPort = parameters["audioPort"].String();
+            invalidateDsCache("connectedAudioPorts:");
 
             returnIfParamNotFound(parameters, "enable");
             string spEnable = parameters["enable"].String();
@@ -4066,9 +4132,7 @@ namespace WPEFramework {
                                 {
                                     std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
                                     if((m_currentArcRoutingState == ARC_STATE_ARC_TERMINATED) && (isCecEnabled == true)) {
-                                        m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-                                        m_cecArcRoutingThreadRun = true;
-                                        arcRoutingCV.notify_one();
+                                        requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
                                     }
                                     else {
                                         LOGINFO("%s: ARC State is already either initiating/intitiated... \n", __FUNCTION__);
@@ -4132,14 +4196,12 @@ namespace WPEFramework {
         // Thunder plugins communication
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> DisplaySettings::getHdmiCecSinkPlugin()
         {
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T("127.0.0.1:9998")));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("org.rdk.HdmiCecSink.1", "");
+            return Utils::getThunderControllerClient("org.rdk.HdmiCecSink.1");
         }
 
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> DisplaySettings::getSystemPlugin()
         {
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T("127.0.0.1:9998")));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("org.rdk.System.1", "");
+            return Utils::getThunderControllerClient("org.rdk.System.1");
         }
 
         IARM_Bus_PWRMgr_PowerState_t DisplaySettings::getSystemPowerState()
@@ -4161,44 +4223,161 @@ namespace WPEFramework {
             return m_powerState;
         }
 
-        void DisplaySettings::initAudioPortsWorker(void)
+        // HDMI_IN hotplug of the ARC/eARC port, on the ARC routing thread
+        void DisplaySettings::handleHdmiInHotplug(bool hdmiin_hotplug_conn)
         {
-            DisplaySettings::_instance->InitAudioPorts();
-        }
+		    { //HDMI ARC/eARC Port Handling
+			bool arc_port_enabled =  false;
 
-        void DisplaySettings::powerEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
-        {
-            if(!DisplaySettings::_instance)
-                 return;
-            if (strcmp(owner, IARM_BUS_PWRMGR_NAME) != 0)
-                 return;
+                        JsonObject audioOutputPortConfig = DisplaySettings::_instance->getAudioOutputPortConfig();
+			if (audioOutputPortConfig.HasLabel("HDMI_ARC")) {
+                            try {
+                                    arc_port_enabled = audioOutputPortConfig["HDMI_ARC"].Boolean();
+                            }catch (const device::Exception& err) {
+                                    LOGERR("HDMI_ARC not in config object \n");
+                                    arc_port_enabled = false;
+                            }
+			}
 
-            switch (eventId) {
-            case  IARM_BUS_PWRMGR_EVENT_MODECHANGED:
-            {
-                IARM_Bus_PWRMgr_EventData_t *eventData = (IARM_Bus_PWRMgr_EventData_t *)data;
-                LOGWARN("Event IARM_BUS_PWRMGR_EVENT_MODECHANGED: State Changed %d --> %d\r",
-                             eventData->data.state.curState, eventData->data.state.newState);
-                m_powerState = eventData->data.state.newState;
-                if (eventData->data.state.newState == IARM_BUS_PWRMGR_POWERSTATE_ON) {
-	            try
-                    {
-		        LOGWARN("creating worker thread for initAudioPortsWorker ");
-		        std::thread audioPortInitThread = std::thread(initAudioPortsWorker);
-			audioPortInitThread.detach();
-                    }
-                    catch(const std::system_error& e)
-                    {
-                        LOGERR("system_error exception in thread creation: %s", e.what());
-                    }
-                    catch(const std::exception& e)
-                    {
-                        LOGERR("exception in thread creation : %s", e.what());
-                    }
-                }
+                        if(arc_port_enabled) {
+                            try
+                            {
+                                int types = dsAUDIOARCSUPPORT_NONE;
+                                device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI_ARC0");
 
-		else {
-		    LOGINFO("%s: Current Power state: %d\n",__FUNCTION__,eventData->data.state.newState);
+                                if(hdmiin_hotplug_conn) {
+                                    aPort.getSupportedARCTypes(&types);
+                                    LOGINFO("dsHdmiEventHandler: Configuring User set Audio mode before starting ARC/eARC Playback...\n");
+                                    if(aPort.getStereoAuto() == true) {
+					if(types & dsAUDIOARCSUPPORT_eARC) {
+					    aPort.setStereoAuto(true,true);
+					}
+					else if (types & dsAUDIOARCSUPPORT_ARC) {
+                                            if (!DisplaySettings::_instance->requestShortAudioDescriptor()) {
+                                                LOGERR("dsHdmiEventHandler (ARC Auto mode): requestShortAudioDescriptor failed !!!\n");;
+                                            }
+                                            else {
+                                                LOGINFO("dsHdmiEventHandler (ARC Auto Mode): requestShortAudioDescriptor successful\n");
+                                            }
+					    aPort.setStereoAuto(true,true);
+					}
+                                    }
+                                    else{
+                                        device::AudioStereoMode mode = device::AudioStereoMode::kStereo;  //default to stereo
+                                        mode = aPort.getStereoMode(); //get Last User set stereo mode and set
+					if((types & dsAUDIOARCSUPPORT_ARC) && (mode == device::AudioStereoMode::kPassThru)){
+                                            if (!DisplaySettings::_instance->requestShortAudioDescriptor()) {
+                                                LOGERR("dsHdmiEventHandler (ARC Passthru mode): requestShortAudioDescriptor failed !!!\n");;
+                                            }
+                                            else {
+                                                LOGINFO("dsHdmiEventHandler (ARC Passthru mode): requestShortAudioDescriptor successful\n");
+                                            }
+					    aPort.setStereoMode(mode.toString(), true);
+                                        }
+					else if(types & dsAUDIOARCSUPPORT_eARC) {
+                                            aPort.setStereoMode(mode.toString(), true);
+                                        }
+                                    }
+
+                                    if(types & dsAUDIOARCSUPPORT_eARC) {
+                                        DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = true;
+                                        DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
+                                        LOGINFO("dsHdmiEventHandler: Enable eARC\n");
+                                        aPort.enableARC(dsAUDIOARCSUPPORT_eARC, true);
+                                        DisplaySettings::_instance->m_arcAudioEnabled = true;
+                                    }
+                                    else if(types & dsAUDIOARCSUPPORT_ARC)  {
+                                      {
+                                         if (isCecEnabled == true)
+                                         {
+                                            //No need to check the ARC routing state. Request ARC initiation irrespective of state
+                                            LOGINFO("%s: Send ARC initiation request... \n", __FUNCTION__);
+                                            std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
+                                            DisplaySettings::_instance->requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
+                                         }else {
+					    LOGINFO("%s: cec is disabled, ARC initiation not possible \n", __FUNCTION__);
+				         }
+                                      }
+                                    }
+                                    else {
+				        LOGINFO("dsHdmiEventHandler: Skip HDMI ARC/eARC handling. Connected device does not support ARC/eARC \n");
+                                    }
+                                }
+                                else { //HDMI ARC/eARC disconnected
+                                        LOGINFO("dsHdmiEventHandler: Disable ARC\n");
+                                        DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = false;
+                                        DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
+					if(DisplaySettings::_instance->m_arcAudioEnabled == true) {
+                                            aPort.enableARC(dsAUDIOARCSUPPORT_ARC, false);
+                                            DisplaySettings::_instance->m_arcAudioEnabled = false;
+					}
+
+                                       {
+                                        std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
+                                        DisplaySettings::_instance->m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
+                                       }
+                                }
+                            }
+                            catch (const device::Exception& err)
+                            {
+                                LOG_DEVICE_EXCEPTION1(string("HDMI_ARC0"));
+                            }
+                        }
+                        else { //HDMI ARC/eARC UI settings not enabled
+                            LOGINFO("dsHdmiEventHandler: Skip HDMI_ARC Hotplug handling !!! HDMI_ARC port not enabled. \n");
+                            int types = dsAUDIOARCSUPPORT_NONE;
+                           try {
+                                device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI_ARC0");
+                               aPort.getSupportedARCTypes(&types);
+
+                               if(hdmiin_hotplug_conn) {
+                                   if(types & dsAUDIOARCSUPPORT_eARC) {
+                                       DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = true;
+                                       DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
+                                   }
+                                   else if (types & dsAUDIOARCSUPPORT_ARC) {
+                                       //Dummy ARC intiation request
+                                      {
+					 if (isCecEnabled == true)
+					 {
+                                        //No need to check the ARC routing state. Request ARC initiation irrespective of state
+                                            LOGINFO("%s: cecEnabled is true, Send dummy ARC initiation request... \n", __FUNCTION__);
+                                            std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
+                                            DisplaySettings::_instance->requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
+					 }else {
+					    LOGINFO("%s: cec is disabled, ARC initiation not possible \n", __FUNCTION__);
+					 }
+                                      }
+                                   }
+                                   else {
+                                       LOGINFO("%s: Connected Device doesn't have ARC/eARC capability... \n", __FUNCTION__);
+                                   }
+                               }
+                               else {
+                                   DisplaySettings::_instance->m_hdmiInAudioDeviceConnected = false;
+                                   DisplaySettings::_instance->connectedAudioPortUpdated(dsAUDIOPORT_TYPE_HDMI_ARC, hdmiin_hotplug_conn);
+				   if(DisplaySettings::_instance->m_arcAudioEnabled == true) {
+                                       aPort.enableARC(dsAUDIOARCSUPPORT_ARC, false);
+                                       DisplaySettings::_instance->m_arcAudioEnabled = false;
+				   }
+
+                                   {
+                                     std::lock_guard<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
+                                     DisplaySettings::_instance->m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
+                                   }
+                               }
+                           }
+                           catch (const device::Exception& err){
+                                   LOG_DEVICE_EXCEPTION1(string("HDMI_ARC0"));
+                           }
+	                }
+
+	            }// HDMI_IN_ARC_PORT_ID
+        }
+
+        // Power state left ON: ARC/eARC goes down, on the ARC routing thread
+        void DisplaySettings::handleStandby()
+        {
             try
             {
                 device::List<device::AudioOutputPort> aPorts = device::Host::getInstance().getAudioOutputPorts();
@@ -4247,6 +4426,31 @@ namespace WPEFramework {
             {
                 LOG_DEVICE_EXCEPTION0();
             }
+        }
+
+        void DisplaySettings::powerEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            if(!DisplaySettings::_instance)
+                 return;
+            if (strcmp(owner, IARM_BUS_PWRMGR_NAME) != 0)
+                 return;
+
+            switch (eventId) {
+            case  IARM_BUS_PWRMGR_EVENT_MODECHANGED:
+            {
+                IARM_Bus_PWRMgr_EventData_t *eventData = (IARM_Bus_PWRMgr_EventData_t *)data;
+                LOGWARN("Event IARM_BUS_PWRMGR_EVENT_MODECHANGED: State Changed %d --> %d\r",
+                             eventData->data.state.curState, eventData->data.state.newState);
+                m_powerState = eventData->data.state.newState;
+                DisplaySettings::_instance->invalidateDsCache();
+                if (eventData->data.state.newState == IARM_BUS_PWRMGR_POWERSTATE_ON) {
+		    LOGWARN("queueing audio ports initialisation");
+		    DisplaySettings::_instance->queueAudioRoutingEvent(AUDIO_ROUTING_INIT_AUDIO_PORTS);
+                }
+
+		else {
+		    LOGINFO("%s: Current Power state: %d\n",__FUNCTION__,eventData->data.state.newState);
+		    DisplaySettings::_instance->queueAudioRoutingEvent(AUDIO_ROUTING_STANDBY);
 		}
             }
             break;
@@ -4256,58 +4460,187 @@ namespace WPEFramework {
         }
 
 
-	//Displaysettings ARC Routing thread
+	//Displaysettings ARC Routing thread: runs the audio routing events one after the other, so that the
+	//IARM and HdmiCecSink event dispatch never waits for devicesettings or HdmiCecSink calls
 	void DisplaySettings::cecArcRoutingThread() {
             LOGINFO("%s: ARC Routing Thread Start\n",__FUNCTION__);
-	    bool threadExit = false;
-	    int arcState = ARC_STATE_ARC_TERMINATED;
 
             if(!DisplaySettings::_instance)
                  return;
-	    
-	    while(isCecArcRoutingThreadEnabled) {
 
-		LOGINFO("%s: Debug:  ARC Routing Thread wait \n",__FUNCTION__);
+	    while(isCecArcRoutingThreadEnabled) {
+		AudioRoutingEvent event;
 		{
-	    	std::unique_lock<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
-		DisplaySettings::_instance->arcRoutingCV.wait(lock, []{return (DisplaySettings::_instance->m_cecArcRoutingThreadRun == true);});
-		arcState = DisplaySettings::_instance->m_currentArcRoutingState;
-		}
-                if(threadExit == true) {
-                    break;
+		    std::unique_lock<std::mutex> lock(DisplaySettings::_instance->m_audioRoutingMutex);
+		    DisplaySettings::_instance->m_audioRoutingCV.wait(lock, []{return !DisplaySettings::_instance->m_audioRoutingQueue.empty();});
+		    event = DisplaySettings::_instance->m_audioRoutingQueue.front();
+		    DisplaySettings::_instance->m_audioRoutingQueue.pop_front();
 		}
 
-		
+		if(event.type == AUDIO_ROUTING_EXIT)
+		    break;
 
-		switch(arcState) {
+		std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+		DisplaySettings::_instance->handleAudioRoutingEvent(event);
+		LOGINFO("%s: audio routing event %d waited %lld ms, handled in %lld ms\n", __FUNCTION__, event.type,
+		    (long long) std::chrono::duration_cast<std::chrono::milliseconds>(started - event.queued).count(),
+		    (long long) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count());
+	    }
 
-                    case ARC_STATE_REQUEST_ARC_INITIATION:
+	    LOGINFO("%s: ARC Routing Thread Stop\n",__FUNCTION__);
+	}
+
+        void DisplaySettings::handleAudioRoutingEvent(const AudioRoutingEvent& event)
+        {
+            switch(event.type) {
+                case AUDIO_ROUTING_REINIT_AUDIO_PORTS:
+                    AudioPortsReInitialize();
+                    InitAudioPorts();
+                    break;
+                case AUDIO_ROUTING_INIT_AUDIO_PORTS:
+                    InitAudioPorts();
+                    break;
+                case AUDIO_ROUTING_STANDBY:
+                    handleStandby();
+                    break;
+                case AUDIO_ROUTING_HDMI_IN_HOTPLUG:
+                    handleHdmiInHotplug(event.connected);
+                    break;
+                case AUDIO_ROUTING_ARC_INITIATION:
+                    handleARCInitiationEvent(event.parameters);
+                    break;
+                case AUDIO_ROUTING_ARC_TERMINATION:
+                    handleARCTerminationEvent(event.parameters);
+                    break;
+                case AUDIO_ROUTING_SHORT_AUDIO_DESCRIPTOR:
+                    handleShortAudioDescriptorEvent(event.parameters);
+                    break;
+                case AUDIO_ROUTING_SYSTEM_AUDIO_MODE:
+                    handleSystemAudioModeEvent(event.parameters);
+                    break;
+                case AUDIO_ROUTING_AUDIO_DEVICE_CONNECTED_STATUS:
+                    handleAudioDeviceConnectedStatusEvent(event.parameters);
+                    break;
+                case AUDIO_ROUTING_ARC_REQUEST:
+                {
+                    int arcState;
+                    {
+                        std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
+                        arcState = m_currentArcRoutingState;
+                    }
+                    if(arcState == ARC_STATE_REQUEST_ARC_INITIATION) {
                         LOGINFO("%s: Send ARC Initiation request \n",__FUNCTION__);
-                        DisplaySettings::_instance->setUpHdmiCecSinkArcRouting(true);
-                        break;
+                        setUpHdmiCecSinkArcRouting(true);
+                    }
+                    else if(arcState == ARC_STATE_REQUEST_ARC_TERMINATION) {
+                        LOGINFO("%s: Send ARC Termination request \n",__FUNCTION__);
+                        setUpHdmiCecSinkArcRouting(false);
+                    }
+                    else {
+                        LOGINFO("%s: ARC request superseded - arcState : %d \n",__FUNCTION__, arcState);
+                    }
+                }
+                break;
+                default:
+                    break;
+            }
+        }
 
-                    case ARC_STATE_REQUEST_ARC_TERMINATION:
-			LOGINFO("%s: Send ARC Termination request \n",__FUNCTION__);
-			DisplaySettings::_instance->setUpHdmiCecSinkArcRouting(false);
-			break;
+        // A hotplug, ARC request or port initialisation still in the queue is not queued again, only the
+        // last hotplug state counts and m_currentArcRoutingState says what the ARC request is.
+        void DisplaySettings::queueAudioRoutingEvent(int type, const JsonObject& parameters, bool connected)
+        {
+            std::lock_guard<std::mutex> lock(m_audioRoutingMutex);
+
+            if(type == AUDIO_ROUTING_HDMI_IN_HOTPLUG || type == AUDIO_ROUTING_ARC_REQUEST ||
+               type == AUDIO_ROUTING_INIT_AUDIO_PORTS || type == AUDIO_ROUTING_REINIT_AUDIO_PORTS) {
+                for(auto& queued : m_audioRoutingQueue) {
+                    if(queued.type == type) {
+                        queued.connected = connected;
+                        LOGINFO("%s: audio routing event %d coalesced\n", __FUNCTION__, type);
+                        return;
+                    }
+                }
+            }
 
-                    case ARC_STATE_ARC_EXIT:
-			threadExit = true;
-			break;
+            AudioRoutingEvent event;
+            event.type = type;
+            event.parameters = parameters;
+            event.connected = connected;
+            event.queued = std::chrono::steady_clock::now();
+            m_audioRoutingQueue.push_back(event);
+            m_audioRoutingCV.notify_one();
+        }
 
-                    //TODO: DD Handle Arc routing logic completely in this separate thread
-                    default:
-			LOGINFO("%s: Default case - arcState : %d \n",__FUNCTION__, arcState);
-			break;
+        // Called with m_arcRoutingStateMutex held.
+        void DisplaySettings::requestArcRouting(int arcState)
+        {
+            m_currentArcRoutingState = arcState;
+            if(arcState == ARC_STATE_REQUEST_ARC_INITIATION && !m_arcBringUpPending) {
+                m_arcBringUpPending = true;
+                m_arcRequestedAt = std::chrono::steady_clock::now();
+            }
+            queueAudioRoutingEvent(AUDIO_ROUTING_ARC_REQUEST);
+        }
+
+	//Displaysettings video event thread: resolution, display hotplug and HDR format notifications, which
+	//query devicesettings for the connected displays and formats. Neither the IARM dispatch nor the audio
+	//routing work on the ARC routing thread holds them up.
+	void DisplaySettings::videoEventThread() {
+            LOGINFO("%s: Video Event Thread Start\n",__FUNCTION__);
+
+            if(!DisplaySettings::_instance)
+                 return;
+
+	    while(true) {
+		VideoEvent event;
+		{
+		    std::unique_lock<std::mutex> lock(DisplaySettings::_instance->m_videoEventMutex);
+		    DisplaySettings::_instance->m_videoEventCV.wait(lock, []{return !DisplaySettings::_instance->m_videoEventQueue.empty();});
+		    event = DisplaySettings::_instance->m_videoEventQueue.front();
+		    DisplaySettings::_instance->m_videoEventQueue.pop_front();
 		}
 
-	    std::unique_lock<std::mutex> lock(DisplaySettings::_instance->m_arcRoutingStateMutex);
-		DisplaySettings::_instance->m_cecArcRoutingThreadRun = false;
+		switch(event.type) {
+		    case VIDEO_EVENT_RESOLUTION_PRE_CHANGE:
+			DisplaySettings::_instance->resolutionPreChange();
+			break;
+		    case VIDEO_EVENT_RESOLUTION_CHANGED:
+			DisplaySettings::_instance->resolutionChanged(event.first, event.second);
+			break;
+		    case VIDEO_EVENT_DISPLAYS_UPDATED:
+			DisplaySettings::_instance->connectedVideoDisplaysUpdated(event.first);
+			break;
+		    case VIDEO_EVENT_VIDEO_FORMAT:
+			DisplaySettings::_instance->notifyVideoFormatChange((dsHDRStandard_t) event.first);
+			break;
+		    case VIDEO_EVENT_EXIT:
+		    default:
+			LOGINFO("%s: Video Event Thread Stop\n",__FUNCTION__);
+			return;
+		}
 	    }
-
-	    LOGINFO("%s: ARC Routing Thread Stop\n",__FUNCTION__);
 	}
 
+        // Back to back resolution changes are reported once, with the last resolution.
+        void DisplaySettings::queueVideoEvent(int type, int first, int second)
+        {
+            std::lock_guard<std::mutex> lock(m_videoEventMutex);
+
+            if(type == VIDEO_EVENT_RESOLUTION_CHANGED && !m_videoEventQueue.empty() && m_videoEventQueue.back().type == type) {
+                m_videoEventQueue.back().first = first;
+                m_videoEventQueue.back().second = second;
+                return;
+            }
+
+            VideoEvent event;
+            event.type = type;
+            event.first = first;
+            event.second = second;
+            m_videoEventQueue.push_back(event);
+            m_videoEventCV.notify_one();
+        }
+
         // Event management
         // 1.
         uint32_t DisplaySettings::subscribeForHdmiCecSinkEvent(const char* eventName)
@@ -4356,8 +4689,29 @@ namespace WPEFramework {
             return err;
         }
 
-        // 2.
+        // HdmiCecSink events are handled on the ARC routing thread
         void DisplaySettings::onARCInitiationEventHandler(const JsonObject& parameters) {
+            queueAudioRoutingEvent(AUDIO_ROUTING_ARC_INITIATION, parameters);
+        }
+
+        void DisplaySettings::onARCTerminationEventHandler(const JsonObject& parameters) {
+            queueAudioRoutingEvent(AUDIO_ROUTING_ARC_TERMINATION, parameters);
+        }
+
+        void DisplaySettings::onShortAudioDescriptorEventHandler(const JsonObject& parameters) {
+            queueAudioRoutingEvent(AUDIO_ROUTING_SHORT_AUDIO_DESCRIPTOR, parameters);
+        }
+
+        void DisplaySettings::onSystemAudioModeEventHandler(const JsonObject& parameters) {
+            queueAudioRoutingEvent(AUDIO_ROUTING_SYSTEM_AUDIO_MODE, parameters);
+        }
+
+        void DisplaySettings::onAudioDeviceConnectedStatusEventHandler(const JsonObject& parameters) {
+            queueAudioRoutingEvent(AUDIO_ROUTING_AUDIO_DEVICE_CONNECTED_STATUS, parameters);
+        }
+
+        // 2.
+        void DisplaySettings::handleARCInitiationEvent(const JsonObject& parameters) {
             string message;
 	    string value;
 
@@ -4388,6 +4742,12 @@ namespace WPEFramework {
                             LOGINFO("onARCInitiationEventHandler: Enable ARC\n");
                             aPort.enableARC(dsAUDIOARCSUPPORT_ARC, true);
                             m_arcAudioEnabled = true;
+                            std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
+                            if (m_arcBringUpPending) {
+                                m_arcBringUpPending = false;
+                                LOGINFO("onARCInitiationEventHandler: ARC bring-up took %lld ms\n",
+                                    (long long) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_arcRequestedAt).count());
+                            }
                         }
                         else {
                            LOGINFO("onARCInitiationEventHandler: HDMI_ARC0 Port not enabled. Skip Audio Routing !!!\n");
@@ -4403,6 +4763,7 @@ namespace WPEFramework {
                     {
                       std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
                       m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
+                      m_arcBringUpPending = false;
                     }
 		}
             } else {
@@ -4413,7 +4774,7 @@ namespace WPEFramework {
         }
 
         // 3.
-        void DisplaySettings::onARCTerminationEventHandler(const JsonObject& parameters) {
+        void DisplaySettings::handleARCTerminationEvent(const JsonObject& parameters) {
             string message;
 	    string value;
 
@@ -4456,7 +4817,7 @@ namespace WPEFramework {
         }
 
         // 4.
-        void DisplaySettings::onShortAudioDescriptorEventHandler(const JsonObject& parameters) {
+        void DisplaySettings::handleShortAudioDescriptorEvent(const JsonObject& parameters) {
             string message;
 
             parameters.ToString(message);
@@ -4500,7 +4861,7 @@ namespace WPEFramework {
         }
 
         // 5.
-        void DisplaySettings::onSystemAudioModeEventHandler(const JsonObject& parameters) {
+        void DisplaySettings::handleSystemAudioModeEvent(const JsonObject& parameters) {
             string message;
             string value;
 
@@ -4527,9 +4888,7 @@ namespace WPEFramework {
                             std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
                             if((m_currentArcRoutingState == ARC_STATE_ARC_TERMINATED) && (m_hdmiInAudioDeviceConnected == false) && (isCecEnabled == true)) {
                                 LOGINFO("%s :  m_hdmiInAudioDeviceConnected = false. ARC state is terminated.  Trigger ARC Initiation request !!!\n", __FUNCTION__); 
-                                m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-			        m_cecArcRoutingThreadRun = true;
-		                arcRoutingCV.notify_one();
+                                requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
 		            }
                         }
                     }
@@ -4571,7 +4930,7 @@ namespace WPEFramework {
         }
 
 	/* Event handler when Audio Device is Added/Removed     */
-	void DisplaySettings::onAudioDeviceConnectedStatusEventHandler(const JsonObject& parameters)
+	void DisplaySettings::handleAudioDeviceConnectedStatusEvent(const JsonObject& parameters)
 	{
             int types = dsAUDIOARCSUPPORT_NONE;
 	    string value;
@@ -4593,7 +4952,7 @@ namespace WPEFramework {
 		    	device::AudioOutputPort aPort = device::Host::getInstance().getAudioOutputPort("HDMI_ARC0");
 		    	aPort.getSupportedARCTypes(&types);
 	        
-		    		LOGINFO("[ Audio Device Added ], AudioSupport_type [%d], m_hdmiInAudioDeviceConnected [%d], m_currentArcRoutingState [%d], m_cecArcRoutingThreadRun [%d] \n", types, m_hdmiInAudioDeviceConnected, m_currentArcRoutingState, m_cecArcRoutingThreadRun);
+		    		LOGINFO("[ Audio Device Added ], AudioSupport_type [%d], m_hdmiInAudioDeviceConnected [%d], m_currentArcRoutingState [%d] \n", types, m_hdmiInAudioDeviceConnected, m_currentArcRoutingState);
 		    	if(types & dsAUDIOARCSUPPORT_eARC) {
 		    	if(m_hdmiInAudioDeviceConnected == false)
 		    	{
@@ -4608,10 +4967,8 @@ namespace WPEFramework {
 	        
 		    		if((m_currentArcRoutingState == ARC_STATE_ARC_TERMINATED) && (isCecEnabled == true)) {
 		    		LOGINFO("ARC_mode: Send dummy ARC initiation request... \n");
-		    		m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-		    					m_cecArcRoutingThreadRun = true;
-		    		LOGINFO("ARC_mode: Notify Arc routing with m_currentArcRoutingStat [%d] \n", DisplaySettings::_instance->m_currentArcRoutingState );
-		    					arcRoutingCV.notify_one();
+		    		requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
+		    		LOGINFO("ARC_mode: Queued Arc routing with m_currentArcRoutingStat [%d] \n", DisplaySettings::_instance->m_currentArcRoutingState );
 		    	}
 		    	}else {
 		    					LOGINFO("Connected Device doesn't have ARC/eARC capability... \n");
@@ -4730,9 +5087,7 @@ namespace WPEFramework {
                         std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
                         if((m_currentArcRoutingState == ARC_STATE_ARC_TERMINATED) && (isCecEnabled == true)) {
                             LOGINFO("%s: Send dummy ARC initiation request... \n", __FUNCTION__);
-                            m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-                            m_cecArcRoutingThreadRun = true;
-                            arcRoutingCV.notify_one();
+                            requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
                         }
                       }
                     }
@@ -4769,9 +5124,7 @@ namespace WPEFramework {
                        std::lock_guard<std::mutex> lock(m_arcRoutingStateMutex);
                        if((m_currentArcRoutingState == ARC_STATE_ARC_TERMINATED) && (isCecEnabled == true)) {
                            LOGINFO("%s: Send dummy ARC initiation request... \n", __FUNCTION__);
-                           m_currentArcRoutingState = ARC_STATE_REQUEST_ARC_INITIATION;
-                           m_cecArcRoutingThreadRun = true;
-                           arcRoutingCV.notify_one();
+                           requestArcRouting(ARC_STATE_REQUEST_ARC_INITIATION);
                        }
                       }
                    }
@@ -5061,6 +5414,84 @@ namespace WPEFramework {
             }
         }
 
+        // False with the generation to hand to setCachedResponse() when key is not cached.
+        bool DisplaySettings::getCachedResponse(const string& key, JsonObject& response, uint32_t& generation)
+        {
+            lock_guard<mutex> lock(m_dsCacheMutex);
+            auto it = m_dsCache.find(key);
+            if (it == m_dsCache.end())
+            {
+                generation = m_dsCacheGeneration;
+                return false;
+            }
+            response = it->second;
+            return true;
+        }
+
+        // Dropped if the cache was invalidated since the response was looked up, it may be stale.
+        void DisplaySettings::setCachedResponse(const string& key, const JsonObject& response, uint32_t generation)
+        {
+            lock_guard<mutex> lock(m_dsCacheMutex);
+            if (generation == m_dsCacheGeneration)
+                m_dsCache[key] = response;
+        }
+
+        bool DisplaySettings::getCachedResponse(const string& key, Core::JSON::ArrayType<Core::JSON::String>& response, uint32_t& generation)
+        {
+            lock_guard<mutex> lock(m_dsCacheMutex);
+            auto it = m_dsListCache.find(key);
+            if (it == m_dsListCache.end())
+            {
+                generation = m_dsCacheGeneration;
+                return false;
+            }
+            setResponseArray(response, it->second);
+            return true;
+        }
+
+        void DisplaySettings::setCachedResponse(const string& key, const std::vector<string>& response, uint32_t generation)
+        {
+            lock_guard<mutex> lock(m_dsCacheMutex);
+            if (generation == m_dsCacheGeneration)
+                m_dsListCache[key] = response;
+        }
+
+        void DisplaySettings::invalidateDsCache(const string& prefix)
+        {
+            lock_guard<mutex> lock(m_dsCacheMutex);
+            m_dsCacheGeneration++;
+            for (auto it = m_dsCache.begin(); it != m_dsCache.end(); )
+            {
+                if (it->first.compare(0, prefix.size(), prefix) == 0)
+                    it = m_dsCache.erase(it);
+                else
+                    ++it;
+            }
+            for (auto it = m_dsListCache.begin(); it != m_dsListCache.end(); )
+            {
+                if (it->first.compare(0, prefix.size(), prefix) == 0)
+                    it = m_dsListCache.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        // Fills the cache for the default ports so the first settings screen does not wait for devicesettings.
+        void DisplaySettings::warmDsCache()
+        {
+            const JsonObject parameters;
+            JsonObject resolution, audioPorts, audioCapabilities;
+            const JsonData::DisplaySettings::GetsupportedtvresolutionsParamsData tvResolutionsParameters;
+            JsonData::DisplaySettings::GetsupportedtvresolutionsResultData tvResolutions;
+            const JsonData::DisplaySettings::GetsupportedaudiomodesParamsData audioModesParameters;
+            JsonData::DisplaySettings::GetsupportedaudiomodesResultData audioModes;
+            getSupportedTvResolutions(tvResolutionsParameters, tvResolutions);
+            getCurrentResolution(parameters, resolution);
+            getConnectedAudioPorts(parameters, audioPorts);
+            getSupportedAudioModes(audioModesParameters, audioModes);
+            getSettopAudioCapabilities(parameters, audioCapabilities);
+        }
+
         bool DisplaySettings::checkPortName(std::string& name) const
         {
             if (Utils::String::stringContains(name,"HDMI")) {
@@ -19,10 +19,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <condition_variable>
 #include "Module.h"
 #include "utils.h"
+#include "JsonData_DisplaySettings.h"
 #include "dsTypes.h"
 #include "tptimer.h"
 #include "AbstractPluginWithApiAndIARMLock.h"
@@ -63,10 +68,10 @@ namespace WPEFramework {
 	    uint32_t setEnableAudioPort (const JsonObject& parameters, JsonObject& response);
             uint32_t getSupportedResolutions(const JsonObject& parameters, JsonObject& response);
             uint32_t getSupportedVideoDisplays(const JsonObject& parameters, JsonObject& response);
-            uint32_t getSupportedTvResolutions(const JsonObject& parameters, JsonObject& response);
+            uint32_t getSupportedTvResolutions(const JsonData::DisplaySettings::GetsupportedtvresolutionsParamsData& parameters, JsonData::DisplaySettings::GetsupportedtvresolutionsResultData& response);
             uint32_t getSupportedSettopResolutions(const JsonObject& parameters, JsonObject& response);
             uint32_t getSupportedAudioPorts(const JsonObject& parameters, JsonObject& response);
-            uint32_t getSupportedAudioModes(const JsonObject& parameters, JsonObject& response);
+            uint32_t getSupportedAudioModes(const JsonData::DisplaySettings::GetsupportedaudiomodesParamsData& parameters, JsonData::DisplaySettings::GetsupportedaudiomodesResultData& response);
             uint32_t getZoomSetting(const JsonObject& parameters, JsonObject& response);
             uint32_t setZoomSetting(const JsonObject& parameters, JsonObject& response);
             uint32_t getCurrentResolution(const JsonObject& parameters, JsonObject& response);
@@ -131,13 +136,14 @@ namespace WPEFramework {
 	    uint32_t setAssociatedAudioMixing(const JsonObject& parameters, JsonObject& response);
             uint32_t getAssociatedAudioMixing(const JsonObject& parameters, JsonObject& response);
             uint32_t setFaderControl(const JsonObject& parameters, JsonObject& response);
+            uint32_t setAudioProfile(const JsonObject& parameters, JsonObject& response);
             uint32_t getFaderControl(const JsonObject& parameters, JsonObject& response);
             uint32_t setPrimaryLanguage(const JsonObject& parameters, JsonObject& response);
             uint32_t getPrimaryLanguage(const JsonObject& parameters, JsonObject& response);
             uint32_t setSecondaryLanguage(const JsonObject& parameters, JsonObject& response);
             uint32_t getSecondaryLanguage(const JsonObject& parameters, JsonObject& response);
 
-	    uint32_t getAudioFormat(const JsonObject& parameters, JsonObject& response);
+	    uint32_t getAudioFormat(const JsonObject& parameters, JsonData::DisplaySettings::GetaudioformatResultData& response);
 	    uint32_t getVolumeLeveller2(const JsonObject& parameters, JsonObject& response);
 	    uint32_t setVolumeLeveller2(const JsonObject& parameters, JsonObject& response);
 	    uint32_t getSurroundVirtualizer2(const JsonObject& parameters, JsonObject& response);
@@ -150,7 +156,6 @@ namespace WPEFramework {
             uint32_t setMS12ProfileSettingsOverride(const JsonObject& parameters, JsonObject& response);
             void InitAudioPorts();
             void AudioPortsReInitialize();
-            static void initAudioPortsWorker(void);
             //End methods
 
             //Begin events
@@ -172,6 +177,13 @@ namespace WPEFramework {
 	    void onSystemAudioModeEventHandler(const JsonObject& parameters);
 	    void onAudioDeviceConnectedStatusEventHandler(const JsonObject& parameters);
 	    void onCecEnabledEventHandler(const JsonObject& parameters);
+            void handleARCInitiationEvent(const JsonObject& parameters);
+            void handleARCTerminationEvent(const JsonObject& parameters);
+            void handleShortAudioDescriptorEvent(const JsonObject& parameters);
+            void handleSystemAudioModeEvent(const JsonObject& parameters);
+            void handleAudioDeviceConnectedStatusEvent(const JsonObject& parameters);
+            void handleHdmiInHotplug(bool hdmiin_hotplug_conn);
+            void handleStandby();
             //End events
         public:
             DisplaySettings();
@@ -189,13 +201,21 @@ namespace WPEFramework {
 	    static void formatUpdateEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             static void powerEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             static void audioPortStateEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+            static void frameRateChangeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             static void dsSettingsChangeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             void getConnectedVideoDisplaysHelper(std::vector<string>& connectedDisplays);
-	    void audioFormatToString(dsAudioFormat_t audioFormat, JsonObject &response);
+	    const char *audioFormatToString(dsAudioFormat_t audioFormat);
+	    static void getSupportedAudioFormats(Core::JSON::ArrayType<Core::JSON::String>& formats);
             const char *getVideoFormatTypeToString(dsHDRStandard_t format);
             dsHDRStandard_t getVideoFormatTypeFromString(const char *mode);
             JsonArray getSupportedVideoFormats();
             bool checkPortName(std::string& name) const;
+            bool getCachedResponse(const string& key, JsonObject& response, uint32_t& generation);
+            void setCachedResponse(const string& key, const JsonObject& response, uint32_t generation);
+            bool getCachedResponse(const string& key, Core::JSON::ArrayType<Core::JSON::String>& response, uint32_t& generation);
+            void setCachedResponse(const string& key, const std::vector<string>& response, uint32_t generation);
+            void invalidateDsCache(const string& prefix = string());
+            void warmDsCache();
             IARM_Bus_PWRMgr_PowerState_t getSystemPowerState();
 
 	    std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> getHdmiCecSinkPlugin();
@@ -217,8 +237,6 @@ namespace WPEFramework {
             std::mutex m_callMutex;
 	    std::thread m_arcRoutingThread;
 	    std::mutex m_arcRoutingStateMutex;
-	    bool m_cecArcRoutingThreadRun; 
-	    std::condition_variable arcRoutingCV;
 	    bool m_hdmiInAudioDeviceConnected;
         bool m_arcAudioEnabled;
 	    bool m_hdmiCecAudioDeviceDetected;
@@ -235,6 +253,74 @@ namespace WPEFramework {
             };
 
             int m_currentArcRoutingState; 
+            bool m_arcBringUpPending;               // initiation requested, ARC audio not enabled yet
+            std::chrono::steady_clock::time_point m_arcRequestedAt;
+
+            // A display frame rate switch, FrameRate setContentFrameRate / setDisplayFrameRate, keeps the
+            // audio ports and ARC as they were: their re-initialisation is skipped until this time, ms
+            // of the steady clock
+            std::atomic<int64_t> m_frameRateSwitchUntilMs;
+            bool inFrameRateSwitch() const;
+
+            // Devicesettings and HdmiCecSink work for IARM and HdmiCecSink events, done by m_arcRoutingThread
+            enum {
+                AUDIO_ROUTING_INIT_AUDIO_PORTS,
+                AUDIO_ROUTING_REINIT_AUDIO_PORTS,
+                AUDIO_ROUTING_STANDBY,
+                AUDIO_ROUTING_HDMI_IN_HOTPLUG,
+                AUDIO_ROUTING_ARC_INITIATION,
+                AUDIO_ROUTING_ARC_TERMINATION,
+                AUDIO_ROUTING_SHORT_AUDIO_DESCRIPTOR,
+                AUDIO_ROUTING_SYSTEM_AUDIO_MODE,
+                AUDIO_ROUTING_AUDIO_DEVICE_CONNECTED_STATUS,
+                AUDIO_ROUTING_ARC_REQUEST,
+                AUDIO_ROUTING_EXIT
+            };
+
+            struct AudioRoutingEvent {
+                int type = AUDIO_ROUTING_EXIT;
+                JsonObject parameters;              // HdmiCecSink event payload
+                bool connected = false;             // HDMI_IN hotplug
+                std::chrono::steady_clock::time_point queued;
+            };
+
+            void queueAudioRoutingEvent(int type, const JsonObject& parameters = JsonObject(), bool connected = false);
+            void handleAudioRoutingEvent(const AudioRoutingEvent& event);
+            void requestArcRouting(int arcState);
+
+            std::deque<AudioRoutingEvent> m_audioRoutingQueue;
+            std::mutex m_audioRoutingMutex;
+            std::condition_variable m_audioRoutingCV;
+
+            // Video listener notifications, sent by m_videoEventThread
+            enum {
+                VIDEO_EVENT_RESOLUTION_PRE_CHANGE,
+                VIDEO_EVENT_RESOLUTION_CHANGED,     // width, height
+                VIDEO_EVENT_DISPLAYS_UPDATED,       // HDMI hotplug event
+                VIDEO_EVENT_VIDEO_FORMAT,           // dsHDRStandard_t
+                VIDEO_EVENT_EXIT
+            };
+
+            struct VideoEvent {
+                int type = VIDEO_EVENT_EXIT;
+                int first = 0;
+                int second = 0;
+            };
+
+            static void videoEventThread();
+            void queueVideoEvent(int type, int first = 0, int second = 0);
+
+            std::thread m_videoEventThread;
+            std::deque<VideoEvent> m_videoEventQueue;
+            std::mutex m_videoEventMutex;
+            std::condition_variable m_videoEventCV;
+
+            // Responses of the devicesettings getters that only change with a DS event, by method and
+            // arguments. Events drop the affected entries and the next call fills them again.
+            std::map<string, JsonObject> m_dsCache;
+            std::map<string, std::vector<string>> m_dsListCache;   // the same for the typed getters, the list they return
+            std::mutex m_dsCacheMutex;
+            uint32_t m_dsCacheGeneration;
 
         public:
             static DisplaySettings* _instance;
@@ -0,0 +1,142 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+// C++ classes for the DisplaySettings JSON-RPC API, as in DisplaySettings.json. Laid out and
+// named the way JsonGenerator writes them for the interfaces (JsonData_DisplayInfo.h, ...), so
+// they can be replaced by the generated ones. Only for the methods that do not go through
+// JsonObject: serialising these is a fixed member list, not a map of variants.
+
+#pragma once
+
+#include <core/JSON.h>
+
+namespace WPEFramework {
+
+namespace JsonData {
+
+    namespace DisplaySettings {
+
+        // Method params/result classes
+        //
+
+        class GetsupportedtvresolutionsParamsData : public Core::JSON::Container {
+        public:
+            GetsupportedtvresolutionsParamsData()
+                : Core::JSON::Container()
+            {
+                Add(_T("videoDisplay"), &Videodisplay);
+            }
+
+            GetsupportedtvresolutionsParamsData(const GetsupportedtvresolutionsParamsData&) = delete;
+            GetsupportedtvresolutionsParamsData& operator=(const GetsupportedtvresolutionsParamsData&) = delete;
+
+        public:
+            Core::JSON::String Videodisplay; // Video display port name. The default port is `HDMI0` if no port is specified
+        }; // class GetsupportedtvresolutionsParamsData
+
+        class GetsupportedtvresolutionsResultData : public Core::JSON::Container {
+        public:
+            GetsupportedtvresolutionsResultData()
+                : Core::JSON::Container()
+            {
+                Add(_T("supportedTvResolutions"), &Supportedtvresolutions);
+                Add(_T("success"), &Success);
+            }
+
+            GetsupportedtvresolutionsResultData(const GetsupportedtvresolutionsResultData&) = delete;
+            GetsupportedtvresolutionsResultData& operator=(const GetsupportedtvresolutionsResultData&) = delete;
+
+        public:
+            Core::JSON::ArrayType<Core::JSON::String> Supportedtvresolutions; // A string [] of supported TV resolutions
+            Core::JSON::Boolean Success; // Whether the request succeeded
+        }; // class GetsupportedtvresolutionsResultData
+
+        class GetsupportedaudiomodesParamsData : public Core::JSON::Container {
+        public:
+            GetsupportedaudiomodesParamsData()
+                : Core::JSON::Container()
+            {
+                Add(_T("audioPort"), &Audioport);
+            }
+
+            GetsupportedaudiomodesParamsData(const GetsupportedaudiomodesParamsData&) = delete;
+            GetsupportedaudiomodesParamsData& operator=(const GetsupportedaudiomodesParamsData&) = delete;
+
+        public:
+            Core::JSON::String Audioport; // Audio port name
+        }; // class GetsupportedaudiomodesParamsData
+
+        class GetsupportedaudiomodesResultData : public Core::JSON::Container {
+        public:
+            GetsupportedaudiomodesResultData()
+                : Core::JSON::Container()
+            {
+                Add(_T("supportedAudioModes"), &Supportedaudiomodes);
+                Add(_T("success"), &Success);
+            }
+
+            GetsupportedaudiomodesResultData(const GetsupportedaudiomodesResultData&) = delete;
+            GetsupportedaudiomodesResultData& operator=(const GetsupportedaudiomodesResultData&) = delete;
+
+        public:
+            Core::JSON::ArrayType<Core::JSON::String> Supportedaudiomodes; // A string [] of supported audio modes
+            Core::JSON::Boolean Success; // Whether the request succeeded
+        }; // class GetsupportedaudiomodesResultData
+
+        class GetaudioformatResultData : public Core::JSON::Container {
+        public:
+            GetaudioformatResultData()
+                : Core::JSON::Container()
+            {
+                Add(_T("supportedAudioFormat"), &Supportedaudioformat);
+                Add(_T("currentAudioFormat"), &Currentaudioformat);
+                Add(_T("success"), &Success);
+            }
+
+            GetaudioformatResultData(const GetaudioformatResultData&) = delete;
+            GetaudioformatResultData& operator=(const GetaudioformatResultData&) = delete;
+
+        public:
+            Core::JSON::ArrayType<Core::JSON::String> Supportedaudioformat; // A list of supported audio formats
+            Core::JSON::String Currentaudioformat; // The currently set audio format
+            Core::JSON::Boolean Success; // Whether the request succeeded
+        }; // class GetaudioformatResultData
+
+        class AudioformatchangedParamsData : public Core::JSON::Container {
+        public:
+            AudioformatchangedParamsData()
+                : Core::JSON::Container()
+            {
+                Add(_T("supportedAudioFormat"), &Supportedaudioformat);
+                Add(_T("currentAudioFormat"), &Currentaudioformat);
+            }
+
+            AudioformatchangedParamsData(const AudioformatchangedParamsData&) = delete;
+            AudioformatchangedParamsData& operator=(const AudioformatchangedParamsData&) = delete;
+
+        public:
+            Core::JSON::ArrayType<Core::JSON::String> Supportedaudioformat; // A list of supported audio formats
+            Core::JSON::String Currentaudioformat; // The currently set audio format
+        }; // class AudioformatchangedParamsData
+
+    } // namespace DisplaySettings
+
+} // namespace JsonData
+
+}
@@ -107,6 +107,7 @@ namespace WPEFramework {
             _mediaStreams.clear();
 
             service->Unregister(&_notification);
+            _fastEvents.close();
 
             RPC::IRemoteConnection* connection(_service->RemoteConnection(_aampMediaPlayerConnectionId));
             auto const result = _aampMediaPlayer->Release();
@@ -149,6 +150,8 @@ namespace WPEFramework {
             Register(_T("stop"), &FireboltMediaPlayer::stop, this);
             Register(_T("initConfig"), &FireboltMediaPlayer::initConfig, this);
             Register(_T("setDRMConfig"), &FireboltMediaPlayer::setDRMConfig, this);
+            Register(_T("preload"), &FireboltMediaPlayer::preload, this);
+            Register(_T("subscribeFast"), &FireboltMediaPlayer::subscribeFast, this);
         }
 
         void FireboltMediaPlayer::UnregisterAll()
@@ -162,6 +165,8 @@ namespace WPEFramework {
             Unregister(_T("stop"));
             Unregister(_T("initConfig"));
             Unregister(_T("setDRMConfig"));
+            Unregister(_T("preload"));
+            Unregister(_T("subscribeFast"));
         }
 
         uint32_t FireboltMediaPlayer::create(const JsonObject& parameters, JsonObject& response)
@@ -360,10 +365,77 @@ namespace WPEFramework {
             returnResponse((*it).second->Stream()->InitDRMConfig(parametersWithoutIdStr) == Core::ERROR_NONE);
         }
 
+        /**
+         * @brief Prepare the next stream while the current one plays, a load of the same url switches
+         * to it. Readiness is notified with 'preloadReady' or 'preloadFailed'. Without a url the
+         * preloaded stream is dropped.
+         *
+         * The stream interface has no call of its own for it, it is passed on as the 'preload' setting.
+         *
+         */
+        uint32_t FireboltMediaPlayer::preload(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            const char *keyId = "id";
+            const char *keyUrl = "url";
+            returnIfStringParamNotFound(parameters, keyId);
+            string id = parameters[keyId].String();
+            MediaStreams::const_iterator it = _mediaStreams.find(id);
+            if (it == _mediaStreams.end())
+            {
+                LOGERR("Instance '%s' does not exist", id.c_str());
+                returnResponse(false);
+            }
+
+            JsonObject configuration;
+            configuration["preload"] = parameters.HasLabel(keyUrl) ? parameters[keyUrl].String() : string();
+            string configurationStr;
+            if (!configuration.ToString(configurationStr))
+            {
+                LOGERR("Failed to serialize parameters into a string");
+                returnResponse(false);
+            }
+            returnResponse((*it).second->Stream()->InitConfig(configurationStr) == Core::ERROR_NONE);
+        }
+
+        /**
+         * @brief Open the shared memory channel for the playback progress of all streams, the
+         * 'playbackProgressUpdate' events are still notified. The record carries the id of the
+         * stream as its text, see FastEventChannel.h for the layout.
+         *
+         */
+        uint32_t FireboltMediaPlayer::subscribeFast(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            string name = FAST_EVENT_CHANNEL_PREFIX "FireboltMediaPlayer";
+            if (!_fastEvents.open(name))
+            {
+                returnResponse(false);
+            }
+
+            response["channel"] = name;
+            response["version"] = FAST_EVENT_CHANNEL_VERSION;
+            response["recordSize"] = (int)sizeof(Utils::FastEventRecord);
+            response["capacity"] = FAST_EVENT_CHANNEL_CAPACITY;
+            returnResponse(true);
+        }
+
         void FireboltMediaPlayer::onMediaStreamEvent(const string& id, const string &eventName, const string &parametersJson)
         {
+            JsonObject parametersJsonObj(parametersJson);
+            if (eventName == "playbackProgressUpdate" && _fastEvents.isOpen())
+            {
+                const int64_t values[] = {
+                    (int64_t)parametersJsonObj["positionMiliseconds"].Number(),
+                    (int64_t)parametersJsonObj["durationMiliseconds"].Number(),
+                    (int64_t)parametersJsonObj["startMiliseconds"].Number(),
+                    (int64_t)parametersJsonObj["endMiliseconds"].Number(),
+                    (int64_t)parametersJsonObj["playbackSpeed"].Number() };
+                _fastEvents.publish(Utils::FAST_EVENT_PLAYBACK_PROGRESS, values, sizeof(values) / sizeof(values[0]), id);
+            }
+
             JsonObject parametersJsonObjWithId;
-            parametersJsonObjWithId[id.c_str()] = JsonObject(parametersJson);
+            parametersJsonObjWithId[id.c_str()] = parametersJsonObj;
 
             // Notify to all with:
             // params : { "<id>" : { <parametersJson> } }
@@ -21,6 +21,7 @@
 
 #include "Module.h"
 #include <interfaces/IMediaPlayer.h>
+#include "FastEventChannel.h"
 
 namespace WPEFramework {
     namespace Plugin {
@@ -161,6 +162,8 @@ namespace WPEFramework {
             uint32_t stop(const JsonObject& parameters, JsonObject& response);
             uint32_t initConfig(const JsonObject& parameters, JsonObject& response);
             uint32_t setDRMConfig(const JsonObject& parameters, JsonObject& response);
+            uint32_t preload(const JsonObject& parameters, JsonObject& response);
+            uint32_t subscribeFast(const JsonObject& parameters, JsonObject& response);
 
             void onMediaStreamEvent(const string& id, const string &eventName, const string &parameters);
 
@@ -193,6 +196,8 @@ namespace WPEFramework {
             Exchange::IMediaPlayer* _aampMediaPlayer;
             //* The current MediaStreamProxy instances by name. When their reference count reaches zero they are removed from this map.
             MediaStreams _mediaStreams;
+            //* playbackProgressUpdate of all streams as FAST_EVENT_PLAYBACK_PROGRESS records, once a local client asked for it with subscribeFast
+            Utils::FastEventChannelWriter _fastEvents;
         };
 
     } //namespace Plugin
@@ -28,6 +28,13 @@ namespace WPEFramework {
 
         AampEventListener::AampEventListener(AampMediaStream& parent)
         : _parent(parent)
+        , _lock()
+        , _progressInterval(0)
+        , _coalescing(false)
+        , _lastProgress(0)
+        , _lastProgressSpeed(0)
+        , _pendingProgress()
+        , _lastSent()
         {
         }
 
@@ -63,9 +70,70 @@ namespace WPEFramework {
             }
         }
 
+        void AampEventListener::SetProgressInterval(uint32_t intervalMs)
+        {
+            _lock.Lock();
+            _progressInterval = intervalMs;
+            _lock.Unlock();
+        }
+
+        void AampEventListener::SetCoalescing(bool enabled)
+        {
+            _lock.Lock();
+            _coalescing = enabled;
+            _lastSent.clear();
+            _lock.Unlock();
+        }
+
+        void AampEventListener::Switched()
+        {
+            HandlePlaybackStartedEvent();
+        }
+
+        // A new stream starts from scratch, nothing of the previous one is held back or repeated.
+        void AampEventListener::Reset()
+        {
+            _lock.Lock();
+            _lastProgress = 0;
+            _lastProgressSpeed = 0;
+            _pendingProgress.clear();
+            _lastSent.clear();
+            _lock.Unlock();
+        }
+
+        void AampEventListener::Send(const string& eventName, const string& parameters, bool coalescable)
+        {
+            string pending;
+            bool forward = true;
+
+            _lock.Lock();
+            pending.swap(_pendingProgress);
+            if (_coalescing && coalescable) {
+                std::map<string, string>::iterator it = _lastSent.find(eventName);
+                if (it == _lastSent.end()) {
+                    _lastSent.emplace(eventName, parameters);
+                } else if (it->second == parameters) {
+                    forward = false;
+                } else {
+                    it->second = parameters;
+                }
+            }
+            _lock.Unlock();
+
+            // The client sees the position the player had when the state changed.
+            if (!pending.empty())
+                _parent.SendEvent(_T("playbackProgressUpdate"), pending);
+
+            if (forward)
+                _parent.SendEvent(eventName, parameters);
+            else
+                LOGINFO("Send: %s repeats the last one, dropped", eventName.c_str());
+        }
+
         void AampEventListener::HandlePlaybackStartedEvent()
         {
-            _parent.SendEvent(_T("playbackStarted"), string());
+            Reset();
+            Send(_T("playbackStarted"), string(), false);
         }
 
         void AampEventListener::HandlePlaybackStateChangedEvent(const AAMPEvent& event)
@@ -75,7 +143,7 @@ namespace WPEFramework {
 
             string s;
             parameters.ToString(s);
-            _parent.SendEvent(_T("playbackStateChanged"), s);
+            Send(_T("playbackStateChanged"), s, true);
         }
 
         void AampEventListener::HandlePlaybackProgressUpdateEvent(const AAMPEvent& event)
@@ -89,7 +157,26 @@ namespace WPEFramework {
 
             string s;
             parameters.ToString(s);
-            _parent.SendEvent(_T("playbackProgressUpdate"), s);
+
+            // A speed change is a transition, it is never held back.
+            int const speed = static_cast<int>(event.data.progress.playbackSpeed);
+            uint64_t const now = Core::Time::Now().Ticks();
+            bool forward = true;
+
+            _lock.Lock();
+            if ((_progressInterval != 0) && (speed == _lastProgressSpeed)
+                    && ((now - _lastProgress) < (static_cast<uint64_t>(_progressInterval) * Core::Time::TicksPerMillisecond))) {
+                _pendingProgress = s;
+                forward = false;
+            } else {
+                _lastProgress = now;
+                _lastProgressSpeed = speed;
+                _pendingProgress.clear();
+            }
+            _lock.Unlock();
+
+            if (forward)
+                _parent.SendEvent(_T("playbackProgressUpdate"), s);
         }
 
         void AampEventListener::HandleBufferingChangedEvent(const AAMPEvent& event)
@@ -99,7 +186,7 @@ namespace WPEFramework {
 
             string s;
             parameters.ToString(s);
-            _parent.SendEvent(_T("bufferingChanged"), s);
+            Send(_T("bufferingChanged"), s, true);
         }
 
         void AampEventListener::HandlePlaybackSpeedChanged(const AAMPEvent& event)
@@ -109,7 +196,7 @@ namespace WPEFramework {
 
             string s;
             parameters.ToString(s);
-            _parent.SendEvent(_T("playbackSpeedChanged"), s);
+            Send(_T("playbackSpeedChanged"), s, true);
         }
 
         void AampEventListener::HandlePlaybackFailed(const AAMPEvent& event)
@@ -121,7 +208,50 @@ namespace WPEFramework {
 
             string s;
             parameters.ToString(s);
-            _parent.SendEvent(_T("playbackFailed"), s);
+            Send(_T("playbackFailed"), s, false);
+        }
+
+            AampPreloadListener::AampPreloadListener(AampMediaStream& parent, const string& url)
+        : _parent(parent)
+        , _url(url)
+        , _ready(false)
+        , _reported(false)
+        {
+        }
+
+        AampPreloadListener::~AampPreloadListener()
+        {
+        }
+
+        void AampPreloadListener::Event(const AAMPEvent& event)
+        {
+            // Tuned without autoplay the stream stops in PREPARED, or PAUSED once the pipeline prerolled
+            if (event.type == AAMP_EVENT_STATE_CHANGED) {
+                PrivAAMPState const state = event.data.stateChanged.state;
+                if ((state == eSTATE_PREPARED) || (state == eSTATE_PAUSED)) {
+                    _ready = true;
+                    if (!_reported.exchange(true)) {
+                        JsonObject parameters;
+                        parameters[_T("url")] = _url;
+
+                        string s;
+                        parameters.ToString(s);
+                        _parent.SendEvent(_T("preloadReady"), s);
+                    }
+                }
+            } else if (event.type == AAMP_EVENT_TUNE_FAILED) {
+                _ready = false;
+                _reported = true;
+
+                JsonObject parameters;
+                parameters[_T("url")] = _url;
+                parameters[_T("code")] = event.data.mediaError.code;
+                parameters[_T("description")] = string(event.data.mediaError.description);
+
+                string s;
+                parameters.ToString(s);
+                _parent.SendEvent(_T("preloadFailed"), s);
+            }
         }
 
     }
@@ -22,6 +22,8 @@
 #include "Module.h"
 
 #include <main_aamp.h>
+#include <atomic>
+#include <map>
 
 namespace WPEFramework {
     namespace Plugin {
@@ -39,7 +41,18 @@ namespace WPEFramework {
 
             void Event(const AAMPEvent& event) override;
 
+            // Progress events closer together than this are held back, only the latest one is kept
+            // and it goes out ahead of the next event. 0 forwards all of them.
+            void SetProgressInterval(uint32_t intervalMs);
+            // Drops state, buffering and speed events that repeat the last one sent.
+            void SetCoalescing(bool enabled);
+            // A preloaded stream took over, it was tuned already: the client hears of it as if it was tuned now.
+            void Switched();
+
         private:
+            void Send(const string& eventName, const string& parameters, bool coalescable);
+            void Reset();
+
             void HandlePlaybackStartedEvent();
             void HandlePlaybackStateChangedEvent(const AAMPEvent& event);
             void HandlePlaybackProgressUpdateEvent(const AAMPEvent& event);
@@ -48,6 +61,36 @@ namespace WPEFramework {
             void HandlePlaybackFailed(const AAMPEvent& event);
 
             AampMediaStream& _parent;
+
+            Core::CriticalSection _lock;
+            uint32_t _progressInterval;
+            bool _coalescing;
+            uint64_t _lastProgress;
+            int _lastProgressSpeed;
+            string _pendingProgress;
+            std::map<string, string> _lastSent;
+        };
+
+        // Listens to the instance of AAMP that preloads the next stream, it plays nothing the client
+        // should hear of until it takes over. Only tells when the stream is prerolled, or failed to.
+        class AampPreloadListener : public AAMPEventListener {
+        public:
+            AampPreloadListener(AampMediaStream& parent, const string& url);
+            ~AampPreloadListener() override;
+
+            AampPreloadListener() = delete;
+            AampPreloadListener(const AampPreloadListener&) = delete;
+            AampPreloadListener& operator=(const AampPreloadListener&) = delete;
+
+            void Event(const AAMPEvent& event) override;
+
+            bool Ready() const { return _ready; }
+
+        private:
+            AampMediaStream& _parent;
+            const string _url;
+            std::atomic<bool> _ready;
+            std::atomic<bool> _reported;
         };
 
     }
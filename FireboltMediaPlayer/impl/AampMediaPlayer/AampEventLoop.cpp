@@ -0,0 +1,186 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AampEventLoop.h"
+#include "AampMediaStream.h"
+#include "utils.h"
+
+// ms, an event that waited longer than this to be delivered is logged
+#define AAMP_EVENT_LATENCY_WARNING 100
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        AampEventLoop* AampEventLoop::_instance = nullptr;
+        Core::CriticalSection AampEventLoop::_instanceLock;
+
+        AampEventLoop* AampEventLoop::Attach(AampMediaStream& stream)
+        {
+            _instanceLock.Lock();
+            if (_instance == nullptr)
+                _instance = new AampEventLoop();
+
+            _instance->_lock.Lock();
+            _instance->_streams[&stream] = Latency();
+            LOGINFO("Attach: %zu streams share the event loop", _instance->_streams.size());
+            _instance->_lock.Unlock();
+
+            AampEventLoop* result = _instance;
+            _instanceLock.Unlock();
+            return result;
+        }
+
+        void AampEventLoop::Detach(AampMediaStream& stream)
+        {
+            _instanceLock.Lock();
+            AampEventLoop* loop = _instance;
+            if (loop == nullptr) {
+                _instanceLock.Unlock();
+                return;
+            }
+
+            loop->_dispatchLock.Lock();
+            loop->_lock.Lock();
+            uint32_t dropped = 0;
+            std::list<Pending>::iterator it = loop->_pending.begin();
+            while (it != loop->_pending.end()) {
+                if (it->stream == &stream) {
+                    it = loop->_pending.erase(it);
+                    ++dropped;
+                } else {
+                    ++it;
+                }
+            }
+
+            std::map<AampMediaStream*, Latency>::iterator entry = loop->_streams.find(&stream);
+            if (entry != loop->_streams.end()) {
+                Latency const& latency = entry->second;
+                double const average = (latency.events != 0) ? (static_cast<double>(latency.total) / latency.events) : 0.0;
+                LOGINFO("Detach: %u events delivered, %u dropped, waited %.1f ms on average, %.1f ms at most",
+                        latency.events, dropped, average / Core::Time::TicksPerMillisecond,
+                        static_cast<double>(latency.longest) / Core::Time::TicksPerMillisecond);
+                loop->_streams.erase(entry);
+            }
+            bool const last = loop->_streams.empty();
+            loop->_lock.Unlock();
+            loop->_dispatchLock.Unlock();
+
+            if (last) {
+                _instance = nullptr;
+                delete loop;
+            }
+            _instanceLock.Unlock();
+        }
+
+        AampEventLoop::AampEventLoop()
+        : _lock()
+        , _dispatchLock()
+        , _queued(false, true)
+        , _pending()
+        , _streams()
+        , _loop(g_main_loop_new(nullptr, false))
+        , _loopThread(_loop)
+        , _dispatcher(*this)
+        {
+            _loopThread.Run();
+            _dispatcher.Run();
+        }
+
+        AampEventLoop::~AampEventLoop()
+        {
+            _dispatcher.Block();
+            _queued.SetEvent();
+            _dispatcher.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+            // Quit from the loop itself, it may not be running yet
+            _loopThread.Block();
+            g_idle_add(Quit, _loop);
+            _loopThread.Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+            g_main_loop_unref(_loop);
+            _loop = nullptr;
+        }
+
+        void AampEventLoop::Post(AampMediaStream& stream, const string& eventName, const string& parameters)
+        {
+            _lock.Lock();
+            if (_streams.find(&stream) == _streams.end()) {
+                _lock.Unlock();
+                LOGWARN("Post: %s of a detached stream, dropped", eventName.c_str());
+                return;
+            }
+            _pending.push_back({ &stream, eventName, parameters, Core::Time::Now().Ticks() });
+            _queued.SetEvent();
+            _lock.Unlock();
+        }
+
+        void AampEventLoop::Dispatch()
+        {
+            _dispatchLock.Lock();
+            _lock.Lock();
+            if (_pending.empty()) {
+                _queued.ResetEvent();
+                _lock.Unlock();
+                _dispatchLock.Unlock();
+                return;
+            }
+
+            Pending event(std::move(_pending.front()));
+            _pending.pop_front();
+            size_t const backlog = _pending.size();
+
+            uint64_t const waited = Core::Time::Now().Ticks() - event.queued;
+            Latency& latency = _streams[event.stream];
+            ++latency.events;
+            latency.total += waited;
+            if (waited > latency.longest)
+                latency.longest = waited;
+            _lock.Unlock();
+
+            if (waited > (static_cast<uint64_t>(AAMP_EVENT_LATENCY_WARNING) * Core::Time::TicksPerMillisecond))
+                LOGWARN("Dispatch: %s waited %.1f ms, %zu pending", event.eventName.c_str(),
+                        static_cast<double>(waited) / Core::Time::TicksPerMillisecond, backlog);
+
+            event.stream->DeliverEvent(event.eventName, event.parameters);
+            _dispatchLock.Unlock();
+        }
+
+        gboolean AampEventLoop::Quit(gpointer data)
+        {
+            g_main_loop_quit(static_cast<GMainLoop*>(data));
+            return G_SOURCE_REMOVE;
+        }
+
+        uint32_t AampEventLoop::LoopThread::Worker()
+        {
+            g_main_loop_run(_loop); // blocks
+            Block();
+            return Core::infinite;
+        }
+
+        uint32_t AampEventLoop::Dispatcher::Worker()
+        {
+            _parent._queued.Lock(Core::infinite);
+            if (IsRunning())
+                _parent.Dispatch();
+            return 0;
+        }
+
+    }
+}
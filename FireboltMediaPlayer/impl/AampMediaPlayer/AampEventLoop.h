@@ -0,0 +1,121 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <glib.h>
+#include <list>
+#include <map>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        class AampMediaStream;
+
+        // The threads all the streams of the process share, whether main, picture-in-picture or preloading:
+        // one runs the GLib main loop AAMP and GStreamer call back on, the other delivers the events of
+        // the streams to their clients. The events of a stream are delivered in the order they came in,
+        // one at a time, so that a slow client holds up neither AAMP nor the GLib main loop.
+        // Created with the first stream, destroyed with the last one.
+        class AampEventLoop {
+        public:
+            static AampEventLoop* Attach(AampMediaStream& stream);
+            // No event is delivered to the stream once this returns, the pending ones are dropped.
+            static void Detach(AampMediaStream& stream);
+
+            void Post(AampMediaStream& stream, const string& eventName, const string& parameters);
+
+        private:
+            class LoopThread : public Core::Thread {
+            public:
+                LoopThread() = delete;
+                LoopThread(const LoopThread&) = delete;
+                LoopThread& operator=(const LoopThread&) = delete;
+
+                LoopThread(GMainLoop* loop)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("AampMainLoop"))
+                , _loop(loop)
+                {
+                }
+                ~LoopThread() override = default;
+
+            private:
+                uint32_t Worker() override;
+
+                GMainLoop* _loop;
+            };
+
+            class Dispatcher : public Core::Thread {
+            public:
+                Dispatcher() = delete;
+                Dispatcher(const Dispatcher&) = delete;
+                Dispatcher& operator=(const Dispatcher&) = delete;
+
+                Dispatcher(AampEventLoop& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("AampEvents"))
+                , _parent(parent)
+                {
+                }
+                ~Dispatcher() override = default;
+
+            private:
+                uint32_t Worker() override;
+
+                AampEventLoop& _parent;
+            };
+
+            struct Pending {
+                AampMediaStream* stream;
+                string eventName;
+                string parameters;
+                uint64_t queued;
+            };
+
+            // Time the events of a stream waited to be delivered, in ticks
+            struct Latency {
+                uint32_t events = 0;
+                uint64_t total = 0;
+                uint64_t longest = 0;
+            };
+
+            AampEventLoop();
+            ~AampEventLoop();
+            AampEventLoop(const AampEventLoop&) = delete;
+            AampEventLoop& operator=(const AampEventLoop&) = delete;
+
+            void Dispatch();
+            static gboolean Quit(gpointer data);
+
+            static AampEventLoop* _instance;
+            static Core::CriticalSection _instanceLock;
+
+            Core::CriticalSection _lock;
+            Core::CriticalSection _dispatchLock;    // held while an event is delivered, Detach waits for it
+            Core::Event _queued;
+            std::list<Pending> _pending;
+            std::map<AampMediaStream*, Latency> _streams;
+            GMainLoop* _loop;
+            LoopThread _loopThread;
+            Dispatcher _dispatcher;
+        };
+
+    }
+}
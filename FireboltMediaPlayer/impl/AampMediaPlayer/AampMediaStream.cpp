@@ -23,7 +23,7 @@
 
 // Use macros to avoid unnecessary repetition of code. 
 #define ADD_SETTER_INT(name, fn)                                                                                       \
-    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {                      \
+    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) { \
         int setting;                                                                                                   \
         if (!extractSetting(label, value, setting))                                                                    \
             return false;                                                                                              \
@@ -32,7 +32,7 @@
         return true;                                                                                                   \
     };
 #define ADD_SETTER_FLOAT(name, fn)                                                                                     \
-    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {                      \
+    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) { \
         double setting;                                                                                                \
         if (!extractSetting(label, value, setting))                                                                    \
             return false;                                                                                              \
@@ -41,7 +41,7 @@
         return true;                                                                                                   \
     };
 #define ADD_SETTER_BOOLEAN(name, fn)                                                                                   \
-    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {                      \
+    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) { \
         bool setting;                                                                                                  \
         if (!extractSetting(label, value, setting))                                                                    \
             return false;                                                                                              \
@@ -50,7 +50,7 @@
         return true;                                                                                                   \
     };
 #define ADD_SETTER_STRING(name, fn)                                                                                    \
-    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {                      \
+    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) { \
         string setting;                                                                                                \
         if (!extractSetting(label, value, setting))                                                                    \
             return false;                                                                                              \
@@ -67,7 +67,7 @@
  *
  */
 #define ADD_SETTER_STRINGNULL(name, fn)                                                                                \
-    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {                      \
+    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) { \
         char const* rawSetting = NULL;                                                                                 \
         string stdSetting;                                                                                             \
         if (value.Content() != Variant::type::EMPTY) {                                                                 \
@@ -84,7 +84,7 @@
         return true;                                                                                                   \
     };
 #define ADD_SETTER_LICENSESERVERURL(name, licenseType)                                                                 \
-    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {                      \
+    m_setters[#name] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) { \
         string setting;                                                                                                \
         if (!extractSetting(label, value, setting))                                                                    \
             return false;                                                                                              \
@@ -93,7 +93,7 @@
         return true;                                                                                                   \
     };
 #define ADD_SETTER_UNSUPPORTED(name)                                                                                   \
-    m_setters[#name] = [] (PlayerInstanceAAMP*, string const& label, Variant const&) {                                 \
+    m_setters[#name] = [] (PlayerInstanceAAMP*, Plugin::AampEventListener*, string const& label, Variant const&) {     \
         LOGWARN("The configuration setting '%s' is currently unsupported", label.c_str());                             \
         return false;                                                                                                  \
     };
@@ -114,13 +114,14 @@ namespace {
         /**
          * @brief Apply a configuration setting to AAMP.
          * 
-         * @param aamp  The instance of AAMP to apply to.
-         * @param name  The name of the setting.
-         * @param value The value to apply as a JSON Variant.
-         * @return      Whether the setting was successfully applied.
+         * @param aamp     The instance of AAMP to apply to.
+         * @param listener The event listener of the stream, for the settings of the events it forwards.
+         * @param name     The name of the setting.
+         * @param value    The value to apply as a JSON Variant.
+         * @return         Whether the setting was successfully applied.
          * 
          */
-        bool apply(PlayerInstanceAAMP* aamp, string const& name, Variant const& value)
+        bool apply(PlayerInstanceAAMP* aamp, Plugin::AampEventListener* listener, string const& name, Variant const& value)
         {
             // Do we have a setting with this name?
             SetterMap::const_iterator it = m_setters.find(name);
@@ -131,7 +132,7 @@ namespace {
             }
 
             // Use associated lambda to set the value
-            return (*it).second(aamp, name, value);
+            return (*it).second(aamp, listener, name, value);
         }
 
         /**
@@ -268,7 +269,7 @@ namespace {
          */
         virtual void populate() = 0;
 
-        using SetterFunction = std::function<bool(PlayerInstanceAAMP* aamp, string const& name, Variant const& value)>;
+        using SetterFunction = std::function<bool(PlayerInstanceAAMP* aamp, Plugin::AampEventListener* listener, string const& name, Variant const& value)>;
         using SetterMap = std::map<string, SetterFunction>; 
 
         SetterMap m_setters;
@@ -301,12 +302,13 @@ namespace {
          *
          * Only used for DRM settings as main configuration settings are more complicated.
          *
-         * @param aamp   The instance of aamp to apply to.
-         * @param config A JSON object containing labels and values which are the settings.
-         * @return       True if any setting could be applied.
+         * @param aamp     The instance of aamp to apply to.
+         * @param listener The event listener of the stream.
+         * @param config   A JSON object containing labels and values which are the settings.
+         * @return         True if any setting could be applied.
          *
          */
-        bool apply(PlayerInstanceAAMP* aamp, JsonObject const& config)
+        bool apply(PlayerInstanceAAMP* aamp, Plugin::AampEventListener* listener, JsonObject const& config)
         {
             string const idLabel("id");
             JsonObject::Iterator it = config.Variants();
@@ -319,7 +321,7 @@ namespace {
                 if (label == idLabel)
                     continue;
 
-                if (apply(aamp, label, it.Current()))
+                if (apply(aamp, listener, label, it.Current()))
                     success = true;
             }
 
@@ -336,7 +338,7 @@ namespace {
             ADD_SETTER_LICENSESERVERURL(com.microsoft.playready, eDRM_PlayReady)
             ADD_SETTER_LICENSESERVERURL(com.widevine.alpha, eDRM_WideVine)
             ADD_SETTER_LICENSESERVERURL(org.w3.clearkey, eDRM_ClearKey)
-            m_setters["customHeaderLicense"] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {
+            m_setters["customHeaderLicense"] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) {
                 string setting;
                 bool result = false;
                 if (!extractSetting(label, value, setting))
@@ -377,7 +379,7 @@ namespace {
                 }
                 return result;
             };
-            m_setters["preferredKeysystem"] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {
+            m_setters["preferredKeysystem"] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) {
                 string setting;
                 if (!extractSetting(label, value, setting))
                     return false;
@@ -431,7 +433,7 @@ namespace {
         {
             ADD_SETTER_INT(initialBitrate, SetInitialBitrate)
             ADD_SETTER_INT(initialBitrate4K, SetInitialBitrate4K)
-            m_setters["offset"] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {
+            m_setters["offset"] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) {
                 int setting;
                 if (!extractSetting(label, value, setting))
                     return false;
@@ -461,7 +463,7 @@ namespace {
             ADD_SETTER_BOOLEAN(parallelPlaylistRefresh, SetParallelPlaylistRefresh)
             ADD_SETTER_BOOLEAN(useAverageBandwidth, SetAvgBWForABR)
             ADD_SETTER_INT(preCachePlaylistTime, SetPreCacheTimeWindow)
-            m_setters["progressReportingInterval"] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {
+            m_setters["progressReportingInterval"] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener*, string const& label, Variant const& value) {
                 int setting;
                 if (!extractSetting(label, value, setting))
                     return false;
@@ -472,6 +474,25 @@ namespace {
                 aamp->SetReportInterval(setting);
                 return true;
             };
+            // These two shape what the stream forwards to its client, AAMP itself is not involved
+            m_setters["progressEventInterval"] = [] (PlayerInstanceAAMP*, Plugin::AampEventListener* listener, string const& label, Variant const& value) {
+                int setting;
+                if (!extractSetting(label, value, setting) || (setting < 0))
+                    return false;
+
+                LOGINFO("Forwarding progress events at most every %d ms", setting);
+                listener->SetProgressInterval(setting);
+                return true;
+            };
+            m_setters["coalesceStateEvents"] = [] (PlayerInstanceAAMP*, Plugin::AampEventListener* listener, string const& label, Variant const& value) {
+                bool setting;
+                if (!extractSetting(label, value, setting))
+                    return false;
+
+                LOGINFO("Coalescing repeated state events: %s", setting ? "true" : "false");
+                listener->SetCoalescing(setting);
+                return true;
+            };
             ADD_SETTER_BOOLEAN(useRetuneForUnpairedDiscontinuity, SetRetuneForUnpairedDiscontinuity)
             ADD_SETTER_INT(drmDecryptFailThreshold, SetSegmentDecryptFailCount)
             ADD_SETTER_INT(initialBuffer, SetInitialBufferDuration)
@@ -495,14 +516,14 @@ namespace {
             ADD_SETTER_UNSUPPORTED(playbackBuffer)
             ADD_SETTER_STRINGNULL(preferredAudioRendition, SetPreferredRenditions)
             ADD_SETTER_STRINGNULL(preferredAudioCodec, SetPreferredCodec)
-            m_setters["drmConfig"] = [] (PlayerInstanceAAMP* aamp, string const& label, Variant const& value) {
+            m_setters["drmConfig"] = [] (PlayerInstanceAAMP* aamp, Plugin::AampEventListener* listener, string const& label, Variant const& value) {
                 if (value.Content() != Variant::type::OBJECT) {
                     LOGERR("Settings::populate - '%s' setting is not a JSON object", label.c_str());
                     return false;
                 }
 
                 // Apply all these DRM settings
-                return DRMSettings::getInstance().apply(aamp, value.Object());
+                return DRMSettings::getInstance().apply(aamp, listener, value.Object());
             };
             ADD_SETTER_BOOLEAN(asyncTune, SetAsyncTuneConfig)
             ADD_SETTER_BOOLEAN(useWesterosSink, SetWesterosSinkConfig)
@@ -533,7 +554,11 @@ namespace WPEFramework {
         , _notification(nullptr)
         , _aampPlayer(nullptr)
         , _aampEventListener(nullptr)
-        , _aampGstPlayerMainLoop(nullptr)
+        , _eventLoop(nullptr)
+        , _preloadPlayer(nullptr)
+        , _preloadListener(nullptr)
+        , _preloadUrl()
+        , _configurations()
         {
             gst_init(0, nullptr);
             _aampPlayer = new PlayerInstanceAAMP();
@@ -547,13 +572,9 @@ namespace WPEFramework {
             {
                 return;
             }
+            _eventLoop = AampEventLoop::Attach(*this);
             _aampPlayer->RegisterEvents(_aampEventListener);
             _aampPlayer->SetReportInterval(1000 /* ms */);
-
-            _aampGstPlayerMainLoop = g_main_loop_new(nullptr, false);
-
-            // Run thread with _aampGstPlayerMainLoop
-            Run();
         }
 
         AampMediaStream::~AampMediaStream()
@@ -570,22 +591,19 @@ namespace WPEFramework {
                 _notification = nullptr;
             }
 	    _notificationRelease.Unlock();
+            DropPreload();
             _adminLock.Unlock();
             _aampPlayer->Stop();
-            Block();
-            _adminLock.Lock();
-
-            if(_aampGstPlayerMainLoop)
-            {
-                g_main_loop_quit(_aampGstPlayerMainLoop);
-            }
 
+            _adminLock.Lock();
+            _aampPlayer->RegisterEvents(nullptr);
             _adminLock.Unlock();
-            Wait(Thread::BLOCKED | Thread::STOPPED, Core::infinite);
+
+            // Nothing is delivered to this stream past here, the loop goes with the last stream
+            AampEventLoop::Detach(*this);
+            _eventLoop = nullptr;
 
             _adminLock.Lock();
-            _aampPlayer->Stop();
-            _aampPlayer->RegisterEvents(nullptr);
             delete _aampEventListener;
             _aampEventListener = nullptr;
             delete _aampPlayer;
@@ -600,6 +618,33 @@ namespace WPEFramework {
             _adminLock.Lock();
 
             ASSERT(_aampPlayer != nullptr);
+            if ((_preloadPlayer != nullptr) && (url == _preloadUrl))
+            {
+                bool const ready = _preloadListener->Ready();
+                LOGINFO("Load: switching to the preloaded stream%s", ready ? "" : ", still prerolling");
+
+                PlayerInstanceAAMP* previous = _aampPlayer;
+                previous->RegisterEvents(nullptr);
+                previous->Stop();
+
+                _aampPlayer = _preloadPlayer;
+                _preloadPlayer = nullptr;
+                _aampPlayer->RegisterEvents(_aampEventListener);
+                delete _preloadListener;
+                _preloadListener = nullptr;
+                _preloadUrl.clear();
+
+                _aampPlayer->SetVideoMute(false);
+                // Not prerolled yet, its own events tell the client when it is
+                if (ready)
+                    _aampEventListener->Switched();
+                if (autoPlay)
+                    _aampPlayer->SetRate(1);
+
+                _adminLock.Unlock();
+                delete previous;
+                return Core::ERROR_NONE;
+            }
             _aampPlayer->Tune(url.c_str(), autoPlay);
 
             _adminLock.Unlock();
@@ -644,6 +689,48 @@ namespace WPEFramework {
             LOGINFO("InitConfig with config=%s", configurationJson.c_str());
             _adminLock.Lock();
 
+            Configure(_aampPlayer, configurationJson, false);
+            _configurations.emplace_back(false, configurationJson);
+
+            // 'preload' is an action on the next stream, it gets the configuration above too
+            string const preloadLabel("preload");
+            JsonObject const config(configurationJson);
+            if (config.HasLabel(preloadLabel.c_str()))
+            {
+                string url;
+                Variant const value = config.Get(preloadLabel.c_str());
+                if ((value.Content() == Variant::type::EMPTY) || Settings::extractSetting(preloadLabel, value, url))
+                    Preload(url);
+            }
+
+            _adminLock.Unlock();
+            return Core::ERROR_NONE;
+        }
+
+        uint32_t AampMediaStream::InitDRMConfig(const string& configurationJson)
+        {
+            LOGINFO("InitDRMConfig with config=%s", configurationJson.c_str());
+            _adminLock.Lock();
+
+            JsonObject const config(configurationJson);
+            DRMSettings::getInstance().apply(_aampPlayer, _aampEventListener, config);
+            _configurations.emplace_back(true, configurationJson);
+
+            _adminLock.Unlock();
+            return Core::ERROR_NONE;
+        }
+
+        /**
+         * @brief Apply the configuration settings to an instance of AAMP. Caller holds _adminLock.
+         *
+         * @param aamp              The instance of AAMP to apply to.
+         * @param configurationJson The settings as given to InitConfig.
+         * @param replay            The settings were applied to the current stream already and are
+         *                          replayed for the preloaded one, its own 'offset' is not known.
+         *
+         */
+        void AampMediaStream::Configure(PlayerInstanceAAMP* aamp, const string& configurationJson, bool replay)
+        {
             int langCodePreferenceValue = -1;
             bool descriptiveTrackNameValue = false;
             bool enableVideoRectangleValue = false;
@@ -651,6 +738,8 @@ namespace WPEFramework {
 
             // Iterate through the configuration settings
             string const idLabel("id");
+            string const preloadLabel("preload");
+            string const offsetLabel("offset");
             string const langCodePreferenceLabel("langCodePreference");
             string const descriptiveTrackNameLabel("descriptiveTrackName");
             string const enableVideoRectangleLabel("enableVideoRectangle");
@@ -660,8 +749,10 @@ namespace WPEFramework {
             {
                 string const label = it.Label();
 
-                // Ignore 'id' as it's not a configuration setting
-                if (label == idLabel)
+                // Ignore 'id' as it's not a configuration setting, 'preload' is handled by InitConfig
+                if ((label == idLabel) || (label == preloadLabel))
+                    continue;
+                if (replay && (label == offsetLabel))
                     continue;
 
                 // The settings 'langCodePreference' and 'descriptiveTrackName' are used together so don't apply immediately
@@ -672,34 +763,69 @@ namespace WPEFramework {
                 else if (label == enableVideoRectangleLabel)
                     enableVideoRectangleSet = Settings::extractSetting(descriptiveTrackNameLabel, it.Current(), enableVideoRectangleValue);
                 else
-                    ConfigurationSettings::getInstance().apply(_aampPlayer, label, it.Current());
+                    ConfigurationSettings::getInstance().apply(aamp, _aampEventListener, label, it.Current());
             }
 
             if (langCodePreferenceValue != -1) {
                 LOGINFO("Invoking PlayerInstanceAAMP::SetLanguagueFormat(%d, %s)", langCodePreferenceValue, descriptiveTrackNameValue ? "true" : "false");
-                _aampPlayer->SetLanguageFormat(LangCodePreference(langCodePreferenceValue), descriptiveTrackNameValue);
+                aamp->SetLanguageFormat(LangCodePreference(langCodePreferenceValue), descriptiveTrackNameValue);
             }
 
             // UVE-JS delays this to the end so do the same
             if (enableVideoRectangleSet) {
                 LOGINFO("Invoking PlayerInstanceAAMP::EnableVideoRectangle(%s)", enableVideoRectangleValue ? "true" : "false");
-                _aampPlayer->EnableVideoRectangle(enableVideoRectangleValue);
+                aamp->EnableVideoRectangle(enableVideoRectangleValue);
             }
-
-            _adminLock.Unlock();
-            return Core::ERROR_NONE;
         }
 
-        uint32_t AampMediaStream::InitDRMConfig(const string& configurationJson)
+        /**
+         * @brief Tune a second instance of AAMP to the next stream, without autoplay so that it fetches
+         * the manifest and the first segments and prerolls while the current stream plays. It replaces
+         * the one preloaded before, an empty url only drops that. Caller holds _adminLock.
+         *
+         * @param url The stream a Load switches to without tuning.
+         *
+         */
+        void AampMediaStream::Preload(const string& url)
         {
-            LOGINFO("InitDRMConfig with config=%s", configurationJson.c_str());
-            _adminLock.Lock();
+            DropPreload();
+            if (url.empty())
+                return;
 
-            JsonObject const config(configurationJson);
-            DRMSettings::getInstance().apply(_aampPlayer, config);
+            LOGINFO("Preload with url=%s", url.c_str());
+            _preloadPlayer = new PlayerInstanceAAMP();
+            _preloadListener = new AampPreloadListener(*this, url);
+            _preloadPlayer->RegisterEvents(_preloadListener);
+            _preloadPlayer->SetReportInterval(1000 /* ms */);
 
-            _adminLock.Unlock();
-            return Core::ERROR_NONE;
+            for (auto const& configuration : _configurations)
+            {
+                if (configuration.first)
+                    DRMSettings::getInstance().apply(_preloadPlayer, _aampEventListener, JsonObject(configuration.second));
+                else
+                    Configure(_preloadPlayer, configuration.second, true);
+            }
+
+            // Its first frame must not show over the current stream
+            _preloadPlayer->SetVideoMute(true);
+            _preloadPlayer->Tune(url.c_str(), false);
+            _preloadUrl = url;
+        }
+
+        // Caller holds _adminLock
+        void AampMediaStream::DropPreload()
+        {
+            if (_preloadPlayer != nullptr)
+            {
+                LOGINFO("Dropping the preloaded stream %s", _preloadUrl.c_str());
+                _preloadPlayer->RegisterEvents(nullptr);
+                _preloadPlayer->Stop();
+                delete _preloadPlayer;
+                _preloadPlayer = nullptr;
+            }
+            delete _preloadListener;
+            _preloadListener = nullptr;
+            _preloadUrl.clear();
         }
 
         uint32_t AampMediaStream::Register(Exchange::IMediaPlayer::IMediaStream::INotification* notification)
@@ -738,12 +864,18 @@ namespace WPEFramework {
         }
 
         void AampMediaStream::SendEvent(const string& eventName, const string& parameters)
+        {
+            ASSERT(_eventLoop != nullptr);
+            _eventLoop->Post(*this, eventName, parameters);
+        }
+
+        void AampMediaStream::DeliverEvent(const string& eventName, const string& parameters)
         {
             LOGINFO("eventName=%s, parameters=%s", eventName.c_str(), parameters.c_str());
             _adminLock.Lock();
             if(!_notification)
             {
-                LOGERR("SendEvent: notification callback is null");
+                LOGERR("DeliverEvent: notification callback is null");
                 _adminLock.Unlock();
                 return;
             }
@@ -757,16 +889,5 @@ namespace WPEFramework {
 	    _notificationRelease.Unlock();
         }
 
-        // Thread overrides
-        uint32_t AampMediaStream::Worker()
-        {
-            if (_aampGstPlayerMainLoop) {
-                g_main_loop_run(_aampGstPlayerMainLoop); // blocks
-                g_main_loop_unref(_aampGstPlayerMainLoop);
-                _aampGstPlayerMainLoop = nullptr;
-            }
-            return WPEFramework::Core::infinite;
-        }
-
     }
 }
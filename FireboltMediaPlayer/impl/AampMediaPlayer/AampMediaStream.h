@@ -21,15 +21,18 @@
 
 #include "Module.h"
 #include "AampEventListener.h"
+#include "AampEventLoop.h"
 
 #include <interfaces/IMediaPlayer.h>
 #include <gst/gst.h>
 #include <main_aamp.h>
+#include <utility>
+#include <vector>
 
 namespace WPEFramework {
     namespace Plugin {
 
-        class AampMediaStream : public Exchange::IMediaPlayer::IMediaStream, Core::Thread {
+        class AampMediaStream : public Exchange::IMediaPlayer::IMediaStream {
         public:
             AampMediaStream();
             ~AampMediaStream() override;
@@ -51,19 +54,28 @@ namespace WPEFramework {
             INTERFACE_ENTRY(Exchange::IMediaPlayer::IMediaStream)
             END_INTERFACE_MAP
 
+            // Queued for the event loop, which delivers it to the client with DeliverEvent
             void SendEvent(const string& eventName, const string& parameters);
+            void DeliverEvent(const string& eventName, const string& parameters);
 
         private:
-            typedef struct _GMainLoop GMainLoop;
-
-            // Thread Interface
-            uint32_t Worker() override;
+            void Configure(PlayerInstanceAAMP* aamp, const string& configurationJson, bool replay);
+            void Preload(const string& url);
+            void DropPreload();
 
             mutable Core::CriticalSection _adminLock, _notificationRelease;
             Exchange::IMediaPlayer::IMediaStream::INotification *_notification;
             PlayerInstanceAAMP *_aampPlayer;
             AampEventListener *_aampEventListener;
-            GMainLoop *_aampGstPlayerMainLoop;
+            AampEventLoop *_eventLoop;
+
+            // The next stream, tuned without autoplay and muted while the current one plays. A Load of
+            // its url switches to it instead of tuning again. It gets the configuration of the stream
+            // replayed, 'true' marks the DRM configurations.
+            PlayerInstanceAAMP *_preloadPlayer;
+            AampPreloadListener *_preloadListener;
+            string _preloadUrl;
+            std::vector<std::pair<bool, string>> _configurations;
         };
 
     }
@@ -0,0 +1,286 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "AutoFrameRate.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define EDID_BLOCK_SIZE 128
+#define CTA_EXTENSION_TAG 0x02
+
+#define CTA_VIDEO_DATA_BLOCK 2
+#define CTA_VENDOR_DATA_BLOCK 3
+#define CTA_EXTENDED_DATA_BLOCK 7
+#define CTA_EXTENDED_YCBCR420_VIDEO 0x0E
+#define CTA_EXTENDED_HF_SCDB 0x79
+
+#define OUI_HDMI_LLC 0x000C03
+#define OUI_HDMI_FORUM 0xC45DD8
+
+namespace {
+
+    struct Vic {
+        uint8_t vic;
+        int width;
+        int height;
+        int rate;
+        bool interlaced;
+    };
+
+    // The CTA-861 VICs a set-top box outputs, aspect ratio variants included. 720x480 and 720x576
+    // are left out, nothing is played at frame rate there.
+    const Vic vics[] = {
+        {  4, 1280,  720,  60, false }, {  5, 1920, 1080,  60, true  }, { 16, 1920, 1080,  60, false },
+        { 19, 1280,  720,  50, false }, { 20, 1920, 1080,  50, true  }, { 31, 1920, 1080,  50, false },
+        { 32, 1920, 1080,  24, false }, { 33, 1920, 1080,  25, false }, { 34, 1920, 1080,  30, false },
+        { 39, 1920, 1080,  50, true  }, { 40, 1920, 1080, 100, true  }, { 41, 1280,  720, 100, false },
+        { 46, 1920, 1080, 120, true  }, { 47, 1280,  720, 120, false },
+        { 60, 1280,  720,  24, false }, { 61, 1280,  720,  25, false }, { 62, 1280,  720,  30, false },
+        { 63, 1920, 1080, 120, false }, { 64, 1920, 1080, 100, false },
+        { 65, 1280,  720,  24, false }, { 66, 1280,  720,  25, false }, { 67, 1280,  720,  30, false },
+        { 68, 1280,  720,  50, false }, { 69, 1280,  720,  60, false }, { 70, 1280,  720, 100, false },
+        { 71, 1280,  720, 120, false },
+        { 72, 1920, 1080,  24, false }, { 73, 1920, 1080,  25, false }, { 74, 1920, 1080,  30, false },
+        { 75, 1920, 1080,  50, false }, { 76, 1920, 1080,  60, false }, { 77, 1920, 1080, 100, false },
+        { 78, 1920, 1080, 120, false },
+        { 93, 3840, 2160,  24, false }, { 94, 3840, 2160,  25, false }, { 95, 3840, 2160,  30, false },
+        { 96, 3840, 2160,  50, false }, { 97, 3840, 2160,  60, false },
+        { 98, 4096, 2160,  24, false }, { 99, 4096, 2160,  25, false }, {100, 4096, 2160,  30, false },
+        {101, 4096, 2160,  50, false }, {102, 4096, 2160,  60, false },
+        {103, 3840, 2160,  24, false }, {104, 3840, 2160,  25, false }, {105, 3840, 2160,  30, false },
+        {106, 3840, 2160,  50, false }, {107, 3840, 2160,  60, false },
+        {108, 1280,  720,  48, false }, {109, 1280,  720,  48, false },
+        {111, 1920, 1080,  48, false }, {112, 1920, 1080,  48, false },
+        {114, 3840, 2160,  48, false }, {115, 4096, 2160,  48, false }, {116, 3840, 2160,  48, false },
+        {117, 3840, 2160, 100, false }, {118, 3840, 2160, 120, false },
+        {119, 3840, 2160, 100, false }, {120, 3840, 2160, 120, false },
+    };
+
+    // HDMI_VIC of the HDMI 1.4 VSDB, the 4k modes from before they had a CTA VIC
+    const Vic hdmiVics[] = {
+        { 1, 3840, 2160, 30, false }, { 2, 3840, 2160, 25, false },
+        { 3, 3840, 2160, 24, false }, { 4, 4096, 2160, 24, false },
+    };
+
+    void addMode(const Vic* table, size_t count, uint8_t vic, std::vector<WPEFramework::Plugin::AutoFrameRate::Mode>& modes)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (table[i].vic != vic)
+                continue;
+
+            for (auto it = modes.begin(); it != modes.end(); ++it)
+                if (it->width == table[i].width && it->height == table[i].height && it->rate == table[i].rate && it->interlaced == table[i].interlaced)
+                    return;
+
+            WPEFramework::Plugin::AutoFrameRate::Mode mode = { table[i].width, table[i].height, table[i].rate, table[i].interlaced };
+            modes.push_back(mode);
+            return;
+        }
+    }
+
+    // Short video descriptor: VICs 1-64 have the native flag in bit 7, from 193 on it is all VIC
+    uint8_t svdVic(uint8_t svd)
+    {
+        return (svd >= 129 && svd <= 192) ? (svd & 0x7F) : svd;
+    }
+
+    // byte 8 of the HF-VSDB and of the HF-SCDB, relative to the data block header
+    bool qmsFlag(const uint8_t* block, int length)
+    {
+        return (length >= 8 && (block[8] & 0x40) != 0);
+    }
+
+    void parseHdmiVsdb(const uint8_t* block, int length, std::vector<WPEFramework::Plugin::AutoFrameRate::Mode>& modes)
+    {
+        if (length < 8 || (block[8] & 0x20) == 0)
+            return;
+
+        int index = 9;
+        if (block[8] & 0x80)
+            index += 2;             // video and audio latency
+        if (block[8] & 0x40)
+            index += 2;             // interlaced latencies
+        if (index + 1 > length)
+            return;
+
+        int count = block[index + 1] >> 5;
+        for (int i = 0; i < count && index + 2 + i <= length; i++)
+            addMode(hdmiVics, sizeof(hdmiVics) / sizeof(hdmiVics[0]), block[index + 2 + i], modes);
+    }
+
+    bool rateMatches(double rate, double content, int& multiple)
+    {
+        multiple = (int) lround(rate / content);
+        return (multiple >= 1 && fabs(rate - multiple * content) <= multiple * content * AUTO_FRAME_RATE_TOLERANCE);
+    }
+}
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        AutoFrameRate::AutoFrameRate()
+            : m_hash(0)
+            , m_modes()
+            , m_qms(false)
+        {
+        }
+
+        void AutoFrameRate::update(const std::vector<uint8_t>& edid)
+        {
+            // FNV-1a
+            uint32_t hash = 2166136261u;
+            for (auto it = edid.begin(); it != edid.end(); ++it)
+                hash = (hash ^ *it) * 16777619u;
+
+            if (hash == m_hash && !m_modes.empty())
+                return;
+
+            m_hash = hash;
+            if (!parseEdid(edid, m_modes, m_qms))
+                LOGWARN("EDID of %u bytes does not parse, no auto frame rate", (unsigned) edid.size());
+            LOGINFO("%u video modes, QMS %s", (unsigned) m_modes.size(), m_qms ? "supported" : "not supported");
+        }
+
+        bool AutoFrameRate::parseEdid(const std::vector<uint8_t>& edid, std::vector<Mode>& modes, bool& qms)
+        {
+            static const uint8_t header[] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+            modes.clear();
+            qms = false;
+
+            if (edid.size() < EDID_BLOCK_SIZE || memcmp(&edid[0], header, sizeof(header)) != 0)
+                return false;
+
+            size_t extensions = edid[126];
+            for (size_t n = 1; n <= extensions && (n + 1) * EDID_BLOCK_SIZE <= edid.size(); n++)
+            {
+                const uint8_t* extension = &edid[n * EDID_BLOCK_SIZE];
+                if (extension[0] != CTA_EXTENSION_TAG)
+                    continue;
+
+                // the data block collection runs up to the first detailed timing descriptor
+                int end = extension[2];
+                if (end > EDID_BLOCK_SIZE - 1)
+                    end = EDID_BLOCK_SIZE - 1;
+
+                for (int index = 4; index < end; )
+                {
+                    const uint8_t* block = extension + index;
+                    int tag = block[0] >> 5;
+                    int length = block[0] & 0x1F;
+                    if (index + length >= end)
+                        break;
+
+                    if (tag == CTA_VIDEO_DATA_BLOCK)
+                    {
+                        for (int i = 1; i <= length; i++)
+                            addMode(vics, sizeof(vics) / sizeof(vics[0]), svdVic(block[i]), modes);
+                    }
+                    else if (tag == CTA_VENDOR_DATA_BLOCK && length >= 3)
+                    {
+                        uint32_t oui = block[1] | (block[2] << 8) | (block[3] << 16);
+                        if (oui == OUI_HDMI_LLC)
+                            parseHdmiVsdb(block, length, modes);
+                        else if (oui == OUI_HDMI_FORUM)
+                            qms = qms || qmsFlag(block, length);
+                    }
+                    else if (tag == CTA_EXTENDED_DATA_BLOCK && length >= 1)
+                    {
+                        // 4:2:0 only modes, 4k60 on a sink without the TMDS rate for 4:4:4
+                        if (block[1] == CTA_EXTENDED_YCBCR420_VIDEO)
+                        {
+                            for (int i = 2; i <= length; i++)
+                                addMode(vics, sizeof(vics) / sizeof(vics[0]), svdVic(block[i]), modes);
+                        }
+                        else if (block[1] == CTA_EXTENDED_HF_SCDB)
+                            qms = qms || qmsFlag(block, length);
+                    }
+
+                    index += length + 1;
+                }
+            }
+
+            return !modes.empty();
+        }
+
+        bool AutoFrameRate::select(int width, int height, double currentRate, double contentRate, double& rate) const
+        {
+            if (contentRate <= 0)
+                return false;
+
+            // the whole multiple of the content closest to it, 24 before 48 before 120
+            bool found = false;
+            int best = 0;
+            for (auto it = m_modes.begin(); it != m_modes.end(); ++it)
+            {
+                if (it->width != width || it->height != height || it->interlaced)
+                    continue;
+
+                double rates[2] = { (double) it->rate, it->rate * 1000.0 / 1001.0 };
+                int count = (it->rate % 6 == 0) ? 2 : 1;   // 24, 30, 48, 60, 120 also come as /1.001
+                for (int i = 0; i < count; i++)
+                {
+                    int multiple = 0;
+                    if (rateMatches(rates[i], contentRate, multiple) && (!found || multiple < best))
+                    {
+                        found = true;
+                        best = multiple;
+                        rate = rates[i];
+                    }
+                }
+            }
+
+            // without QMS a switch blanks the picture, a rate that is still a multiple of the content is kept
+            int multiple = 0;
+            if (found && !m_qms && rateMatches(currentRate, contentRate, multiple))
+                rate = currentRate;
+
+            return found;
+        }
+
+        std::string AutoFrameRate::format(int width, int height, double rate)
+        {
+            char framerate[32];
+            if (fabs(rate - lround(rate)) < 0.005)
+                snprintf(framerate, sizeof(framerate), "%dx%dpx%ld", width, height, lround(rate));
+            else
+                snprintf(framerate, sizeof(framerate), "%dx%dpx%.2f", width, height, rate);
+            return framerate;
+        }
+
+        bool AutoFrameRate::parseFramerate(const char* framerate, int& width, int& height, double& rate)
+        {
+            if (sscanf(framerate, "%dx%d", &width, &height) != 2)
+                return false;
+
+            const char* p = strchr(framerate, 'p');
+            if (p == nullptr)
+                return false;
+            if (*(++p) == 'x')
+                p++;
+
+            return (sscanf(p, "%lf", &rate) == 1 && rate > 0);
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
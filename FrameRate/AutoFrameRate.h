@@ -0,0 +1,72 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* A display rate matches the content if it is a whole multiple of it within this fraction */
+#define AUTO_FRAME_RATE_TOLERANCE 0.0005
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Auto frame rate matching: the video modes of the sink, from the CTA-861 extension of its
+        // EDID, and the display rate that plays content of a given frame rate without judder at the
+        // current resolution. The EDID is only parsed again when its hash changes. A sink that can do
+        // Quick Media Switching (HF-VSDB/HF-SCDB, HDMI 2.1a) changes rate without blanking the
+        // picture, otherwise a rate that already is a multiple of the content is kept: every switch
+        // costs a blank of a few seconds.
+        class AutoFrameRate {
+        public:
+            struct Mode {
+                int width;
+                int height;
+                int rate;           // Hz as in the VIC, 24, 30, 60, ... also stand for 24/1.001, ...
+                bool interlaced;
+            };
+
+            AutoFrameRate();
+
+            // Parses edid unless it is the one the modes are from. An EDID that does not parse
+            // leaves no modes, select() then keeps the current rate.
+            void update(const std::vector<uint8_t>& edid);
+
+            bool seamless() const { return m_qms; }
+            const std::vector<Mode>& modes() const { return m_modes; }
+
+            // The display rate for content of contentRate at width x height, currently shown at
+            // currentRate. False without a mode that matches the content.
+            bool select(int width, int height, double currentRate, double contentRate, double& rate) const;
+
+            static bool parseEdid(const std::vector<uint8_t>& edid, std::vector<Mode>& modes, bool& qms);
+
+            // "3840x2160px48" / "1920x1080px23.98", as setDisplayframerate and getCurrentDisframerate have it
+            static std::string format(int width, int height, double rate);
+            static bool parseFramerate(const char* framerate, int& width, int& height, double& rate);
+
+        private:
+            uint32_t m_hash;
+            std::vector<Mode> m_modes;
+            bool m_qms;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -17,6 +17,8 @@
 * limitations under the License.
 **/
 
+#include <math.h>
+
 #include "FrameRate.h"
 #include "host.hpp"
 #include "exception.hpp"
@@ -31,10 +33,13 @@
 #define METHOD_START_FPS_COLLECTION "startFpsCollection"
 #define METHOD_STOP_FPS_COLLECTION "stopFpsCollection"
 #define METHOD_UPDATE_FPS_COLLECTION "updateFps"
+#define METHOD_UPDATE_FRAME_TIMES "updateFrameTimes"
 #define METHOD_SET_FRAME_MODE "setFrmMode"
 #define METHOD_GET_FRAME_MODE "getFrmMode"
 #define METHOD_GET_DISPLAY_FRAME_RATE "getDisplayFrameRate"
 #define METHOD_SET_DISPLAY_FRAME_RATE "setDisplayFrameRate"
+#define METHOD_SUBSCRIBE_FAST "subscribeFast"
+#define METHOD_SET_CONTENT_FRAME_RATE "setContentFrameRate"
 
 // Events
 #define EVENT_FPS_UPDATE "onFpsEvent"
@@ -46,6 +51,10 @@
 #define MINIMUM_FPS_COLLECTION_TIME_IN_MILLISECONDS 100
 #define DEFAULT_MIN_FPS_VALUE 60
 #define DEFAULT_MAX_FPS_VALUE -1
+#define DEFAULT_FRAME_INTERVAL_IN_MICROSECONDS 16667
+#define IDLE_FRAME_GAP_IN_MICROSECONDS 500000
+#define MINIMUM_FRAMES_FOR_INTERVAL_ESTIMATE 10
+#define JANK_SLOW_FRAME_COUNT 3
 
 namespace WPEFramework
 {
@@ -60,6 +69,9 @@ namespace WPEFramework
           , m_fpsCollectionFrequencyInMs(DEFAULT_FPS_COLLECTION_TIME_IN_MILLISECONDS)
           , m_minFpsValue(DEFAULT_MIN_FPS_VALUE), m_maxFpsValue(DEFAULT_MAX_FPS_VALUE)
           , m_totalFpsValues(0), m_numberOfFpsUpdates(0), m_fpsCollectionInProgress(false), m_lastFpsValue(-1)
+          , m_lastFrameTime(0), m_frameIntervalUs(DEFAULT_FRAME_INTERVAL_IN_MICROSECONDS)
+          , m_droppedFrames(0), m_jankEvents(0), m_slowFrames(0)
+          , m_edidStale(true)
         {
             FrameRate::_instance = this;
 
@@ -67,10 +79,13 @@ namespace WPEFramework
             Register(METHOD_START_FPS_COLLECTION, &FrameRate::startFpsCollectionWrapper, this);
             Register(METHOD_STOP_FPS_COLLECTION, &FrameRate::stopFpsCollectionWrapper, this);
             Register(METHOD_UPDATE_FPS_COLLECTION, &FrameRate::updateFpsWrapper, this);
+            Register(METHOD_UPDATE_FRAME_TIMES, &FrameRate::updateFrameTimesWrapper, this);
+            Register(METHOD_SUBSCRIBE_FAST, &FrameRate::subscribeFastWrapper, this);
 	    registerMethod(METHOD_SET_FRAME_MODE, &FrameRate::setFrmMode, this, {2});
             registerMethod(METHOD_GET_FRAME_MODE, &FrameRate::getFrmMode, this, {2});
             registerMethod(METHOD_GET_DISPLAY_FRAME_RATE, &FrameRate::getDisplayFrameRate, this, {2});
-            registerMethod(METHOD_SET_DISPLAY_FRAME_RATE, &FrameRate::setDisplayFrameRate, this, {2});		
+            registerMethod(METHOD_SET_DISPLAY_FRAME_RATE, &FrameRate::setDisplayFrameRate, this, {2});
+            registerMethod(METHOD_SET_CONTENT_FRAME_RATE, &FrameRate::setContentFrameRate, this, {2});		
 
             m_reportFpsTimer.connect( std::bind( &FrameRate::onReportFpsTimer, this ) );
         }
@@ -94,6 +109,7 @@ namespace WPEFramework
 		    IARM_Result_t res;
 		    IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_PRECHANGE, FrameRatePreChange) );
 		    IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_POSTCHANGE, FrameRatePostChange) );
+		    IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG, HdmiHotplug) );
 	    }
 	}
 
@@ -104,12 +120,14 @@ namespace WPEFramework
                 IARM_Result_t res;
                 IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME,IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_PRECHANGE) );
                 IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_DISPLAY_FRAMRATE_POSTCHANGE) );
+                IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_DSMGR_NAME, IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG) );
             }
         }
 
         void FrameRate::Deinitialize(PluginHost::IShell* /* service */)
         {
 		DeinitializeIARM();
+		m_fastEvents.close();
     		FrameRate::_instance = nullptr;
         }
 
@@ -179,7 +197,46 @@ namespace WPEFramework
 
             returnResponse(true);
         }
+
+        uint32_t FrameRate::updateFrameTimesWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_callMutex);
+
+            // Called for every batch of frames, so no LOGINFOMETHOD here
+            returnIfArrayParamNotFound(parameters, "timestamps");
+
+            const JsonArray& timestamps = parameters["timestamps"].Array();
+            for (int i = 0; i < timestamps.Length(); i++)
+            {
+                if (timestamps[i].Content() != JsonValue::type::NUMBER || timestamps[i].Number() < 0)
+                {
+                    LOGWARN("Ignoring invalid frame timestamp at index %d", i);
+                    continue;
+                }
+                updateFrameTime(timestamps[i].Number());
+            }
+
+            returnResponse(true);
+        }
         
+        uint32_t FrameRate::subscribeFastWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            // The ring is only created for the first local client, onFpsEvent keeps going out as before
+            string name = FAST_EVENT_CHANNEL_PREFIX "FrameRate";
+            if (!m_fastEvents.open(name))
+            {
+                returnResponse(false);
+            }
+
+            response["channel"] = name;
+            response["version"] = FAST_EVENT_CHANNEL_VERSION;
+            response["recordSize"] = (int)sizeof(Utils::FastEventRecord);
+            response["capacity"] = FAST_EVENT_CHANNEL_CAPACITY;
+            returnResponse(true);
+        }
+
 	uint32_t FrameRate::setFrmMode(const JsonObject& parameters, JsonObject& response)
         {
             std::lock_guard<std::mutex> guard(m_callMutex);
@@ -278,6 +335,95 @@ namespace WPEFramework
             returnResponse(success);
         }
 
+        // The display rate for the content the player is about to start, from the modes of the sink at
+        // the current resolution. contentFrameRate 0 when the content ended: the rate from before the
+        // first switch is set again.
+        uint32_t FrameRate::setContentFrameRate(const JsonObject& parameters, JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_callMutex);
+
+            LOGINFOMETHOD();
+            returnIfParamNotFound(parameters, "contentFrameRate");
+
+            double contentRate = parameters["contentFrameRate"].Float();
+
+            char sFramerate[20] = {0};
+            bool success = true;
+            try
+            {
+                device::VideoDevice &device = device::Host::getInstance().getVideoDevices().at(0);
+                device.getCurrentDisframerate(sFramerate);
+
+                int width = 0;
+                int height = 0;
+                double currentRate = 0;
+                if (!AutoFrameRate::parseFramerate(sFramerate, width, height, currentRate))
+                {
+                    LOGERR("unexpected display framerate '%s'", sFramerate);
+                    returnResponse(false);
+                }
+
+                string target = sFramerate;
+                if (contentRate <= 0)
+                {
+                    if (!m_afrRestoreFramerate.empty())
+                        target = m_afrRestoreFramerate;
+                    m_afrRestoreFramerate.clear();
+                }
+                else
+                {
+                    updateEdidModes();
+
+                    double rate = currentRate;
+                    if (!m_autoFrameRate.select(width, height, currentRate, contentRate, rate))
+                        LOGWARN("no mode at %dx%d for %.3f fps, display stays at %s", width, height, contentRate, sFramerate);
+                    else if (fabs(rate - currentRate) > 0.005)
+                        target = AutoFrameRate::format(width, height, rate);
+                }
+
+                bool switched = (target != sFramerate);
+                if (switched)
+                {
+                    if (contentRate > 0 && m_afrRestoreFramerate.empty())
+                        m_afrRestoreFramerate = sFramerate;
+                    LOGINFO("content at %.3f fps, display %s -> %s%s", contentRate, sFramerate, target.c_str(), m_autoFrameRate.seamless() ? " (QMS)" : "");
+                    device.setDisplayframerate(target.c_str());
+                }
+
+                response["framerate"] = target;
+                response["switched"] = switched;
+                response["seamless"] = switched && m_autoFrameRate.seamless();
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(std::string(sFramerate));
+                success = false;
+            }
+            returnResponse(success);
+        }
+
+        // Reads the EDID after a hotplug only, the modes are only parsed again for another sink
+        void FrameRate::updateEdidModes()
+        {
+            if (!m_edidStale.exchange(false))
+                return;
+
+            std::vector<uint8_t> edid;
+            try
+            {
+                std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
+                device::VideoOutputPort vPort = device::Host::getInstance().getVideoOutputPort(strVideoPort.c_str());
+                if (vPort.isDisplayConnected())
+                    vPort.getDisplay().getEDIDBytes(edid);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION0();
+                m_edidStale = true;
+            }
+            m_autoFrameRate.update(edid);
+        }
+
         /**
         * @brief This function is used to get the amount of collection interval per milliseconds.
         *
@@ -322,6 +468,7 @@ namespace WPEFramework
             m_maxFpsValue = DEFAULT_MAX_FPS_VALUE;
             m_totalFpsValues = 0;
             m_numberOfFpsUpdates = 0;
+            resetFrameTimes();
             m_fpsCollectionInProgress = true;
             int fpsCollectionFrequency = m_fpsCollectionFrequencyInMs;
             if (fpsCollectionFrequency < MINIMUM_FPS_COLLECTION_TIME_IN_MILLISECONDS)
@@ -385,6 +532,59 @@ namespace WPEFramework
             m_numberOfFpsUpdates++;
             m_lastFpsValue = newFpsValue;
         }
+
+        /**
+        * @brief This function is used to add the presentation time of a frame. The interval to the
+        * previous frame goes into the frame time histogram. A frame that took more than one and a half
+        * times the nominal interval is slow and the frames it covered are dropped, JANK_SLOW_FRAME_COUNT
+        * slow frames in a row are one jank event. Gaps above IDLE_FRAME_GAP_IN_MICROSECONDS are taken
+        * as the compositor being idle and are not counted.
+        *
+        * @param[in] timestampUs Monotonic presentation time of the frame in microseconds.
+        * @ingroup SERVMGR_ABSFRAMERATE_API
+        */
+        void FrameRate::updateFrameTime(uint64_t timestampUs)
+        {
+            uint64_t lastFrameTime = m_lastFrameTime;
+            m_lastFrameTime = timestampUs;
+
+            if (lastFrameTime == 0 || timestampUs <= lastFrameTime)
+            {
+                return;
+            }
+
+            uint64_t interval = timestampUs - lastFrameTime;
+            if (interval > IDLE_FRAME_GAP_IN_MICROSECONDS)
+            {
+                m_slowFrames = 0;
+                return;
+            }
+
+            m_frameIntervals.record(interval);
+
+            if (interval * 2 > m_frameIntervalUs * 3)
+            {
+                m_droppedFrames += (interval + m_frameIntervalUs / 2) / m_frameIntervalUs - 1;
+                if (++m_slowFrames == JANK_SLOW_FRAME_COUNT)
+                {
+                    m_jankEvents++;
+                }
+            }
+            else
+            {
+                m_slowFrames = 0;
+            }
+        }
+
+        void FrameRate::resetFrameTimes()
+        {
+            Utils::Metrics::Histogram::Summary summary;
+            m_frameIntervals.read(summary, true);
+            m_lastFrameTime = 0;
+            m_droppedFrames = 0;
+            m_jankEvents = 0;
+            m_slowFrames = 0;
+        }
         
         void FrameRate::fpsCollectionUpdate( int averageFps, int minFps, int maxFps )
         {
@@ -392,8 +592,29 @@ namespace WPEFramework
             params["average"] = averageFps;
             params["min"] = minFps;
             params["max"] = maxFps;
-            
+
+            // The frame time statistics restart with every interval, a jank run in progress carries over
+            Utils::Metrics::Histogram::Summary summary;
+            m_frameIntervals.read(summary, true);
+            params["frames"] = summary.count;
+            params["p99FrameTime"] = summary.p99;
+            params["maxFrameTime"] = summary.max;
+            params["droppedFrames"] = m_droppedFrames;
+            params["jankEvents"] = m_jankEvents;
+            m_droppedFrames = 0;
+            m_jankEvents = 0;
+
+            // Follow the display rate, the median interval of a busy window is the nominal frame time
+            if (summary.count >= MINIMUM_FRAMES_FOR_INTERVAL_ESTIMATE && summary.p50 > 0)
+            {
+                m_frameIntervalUs = summary.p50;
+            }
+
             sendNotify(EVENT_FPS_UPDATE, params);
+
+            const int64_t values[] = { averageFps, minFps, maxFps, (int64_t)summary.count, (int64_t)summary.p99, (int64_t)summary.max,
+                (int64_t)params["droppedFrames"].Number(), (int64_t)params["jankEvents"].Number() };
+            m_fastEvents.publish(Utils::FAST_EVENT_FPS, values, sizeof(values) / sizeof(values[0]));
         }
         
         void FrameRate::onReportFpsTimer()
@@ -453,6 +674,15 @@ namespace WPEFramework
             sendNotify(EVENT_FRAMERATE_POSTCHANGE, JsonObject());
         }
 
+        void FrameRate::HdmiHotplug(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            // another sink, or the same one with other modes after it was switched over
+            if(FrameRate::_instance)
+            {
+                FrameRate::_instance->m_edidStale = true;
+            }
+        }
+
         
     } // namespace Plugin
 } // namespace WPEFramework
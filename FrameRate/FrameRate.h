@@ -19,10 +19,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 
 #include "Module.h"
 #include "tptimer.h"
+#include "Metrics.h"
+#include "FastEventChannel.h"
+#include "AutoFrameRate.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
 
@@ -54,10 +58,13 @@ namespace WPEFramework {
             uint32_t startFpsCollectionWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t stopFpsCollectionWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t updateFpsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t updateFrameTimesWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t setFrmMode(const JsonObject& parameters, JsonObject& response);
 	    uint32_t getFrmMode(const JsonObject& parameters, JsonObject& response);
 	    uint32_t getDisplayFrameRate(const JsonObject& parameters, JsonObject& response);
 	    uint32_t setDisplayFrameRate(const JsonObject& parameters, JsonObject& response);
+            uint32_t subscribeFastWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setContentFrameRate(const JsonObject& parameters, JsonObject& response);
 	    //End methods
             
             int getCollectionFrequency();
@@ -65,6 +72,8 @@ namespace WPEFramework {
             bool startFpsCollection();
             bool stopFpsCollection();
             void updateFps(int newFpsValue);
+            void updateFrameTime(uint64_t timestampUs);
+            void resetFrameTimes();
 
             void fpsCollectionUpdate( int averageFps, int minFps, int maxFps );
             
@@ -83,6 +92,9 @@ namespace WPEFramework {
             void frameRatePostChange();
             static void FrameRatePostChange(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
 
+            static void HdmiHotplug(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+            void updateEdidModes();
+
 
         public:
             FrameRate();
@@ -102,6 +114,23 @@ namespace WPEFramework {
             //QTimer m_reportFpsTimer;
             TpTimer m_reportFpsTimer;
             int m_lastFpsValue;
+
+            // Per frame statistics of the current interval, fed by updateFrameTimes
+            Utils::Metrics::Histogram m_frameIntervals;
+            uint64_t m_lastFrameTime;
+            uint64_t m_frameIntervalUs;
+            int m_droppedFrames;
+            int m_jankEvents;
+            int m_slowFrames;
+
+            // onFpsEvent as FAST_EVENT_FPS records, once a local client asked for it with subscribeFast
+            Utils::FastEventChannelWriter m_fastEvents;
+
+            // setContentFrameRate: the modes of the sink, re-read after a hotplug, and the display
+            // framerate from before the first switch, set again when the content ended
+            AutoFrameRate m_autoFrameRate;
+            std::atomic<bool> m_edidStale;
+            std::string m_afrRestoreFramerate;
             
             std::mutex m_callMutex;
         };
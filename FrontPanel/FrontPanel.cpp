@@ -42,6 +42,8 @@
 #define METHOD_FP_SET_PREFERENCES "setPreferences"
 #define METHOD_FP_SET_LED "setLED"
 #define METHOD_FP_SET_BLINK "setBlink"
+#define METHOD_FP_ANIMATE "animate"
+#define METHOD_FP_STOP_ANIMATION "stopAnimation"
 #define METHOD_FP_SET_24_HOUR_CLOCK "set24HourClock"
 #define METHOD_FP_IS_24_HOUR_CLOCK "is24HourClock"
 #define METHOD_FP_SET_CLOCKTESTPATTERN "setClockTestPattern"
@@ -173,6 +175,8 @@ namespace WPEFramework
             registerMethod(METHOD_FP_SET_PREFERENCES, &FrontPanel::setPreferencesWrapper, this);
             registerMethod(METHOD_FP_SET_LED, &FrontPanel::setLEDWrapper, this);
             registerMethod(METHOD_FP_SET_BLINK, &FrontPanel::setBlinkWrapper, this);
+            registerMethod(METHOD_FP_ANIMATE, &FrontPanel::animateWrapper, this);
+            registerMethod(METHOD_FP_STOP_ANIMATION, &FrontPanel::stopAnimationWrapper, this);
             registerMethod(METHOD_FP_SET_24_HOUR_CLOCK, &FrontPanel::set24HourClockWrapper, this);
             registerMethod(METHOD_FP_IS_24_HOUR_CLOCK, &FrontPanel::is24HourClockWrapper, this);
             registerMethod(METHOD_FP_SET_CLOCKTESTPATTERN, &FrontPanel::setClockTestPatternWrapper, this);
@@ -728,6 +732,30 @@ namespace WPEFramework
             CFrontPanel::instance()->setBlink(blinkInfo);
         }
 
+        /**
+         * @brief Runs a keyframe animation on an LED in the given priority layer. Only the highest
+         * layer of an LED is shown, e.g. a notification overrides a boot animation, which resumes
+         * after it. Frames are sent from the blink timer thread, only when the LED state changes.
+         *
+         * @param[in] animation Object containing Indicator name, priority, iterations and keyframes.
+         *
+         * @return Returns false if the indicator or keyframes are missing.
+         */
+        bool FrontPanel::animate(const JsonObject& animation)
+        {
+            return CFrontPanel::instance()->animate(animation);
+        }
+
+        /**
+         * @brief Stops an animation layer of an LED, or all of its layers if no priority is given.
+         *
+         * @param[in] animation Object containing Indicator name and optional priority.
+         */
+        void FrontPanel::stopAnimation(const JsonObject& animation)
+        {
+            CFrontPanel::instance()->stopAnimation(animation);
+        }
+
         /**
          * @brief Specifies the 24 hour clock format.
          *
@@ -862,6 +890,22 @@ namespace WPEFramework
             returnResponse(success);
         }
 
+        uint32_t FrontPanel::animateWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            returnIfStringParamNotFound(parameters, "ledIndicator");
+            returnIfArrayParamNotFound(parameters, "keyframes");
+
+            returnResponse(animate(parameters));
+        }
+
+        uint32_t FrontPanel::stopAnimationWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            returnIfStringParamNotFound(parameters, "ledIndicator");
+
+            stopAnimation(parameters);
+            returnResponse(true);
+        }
+
         uint32_t FrontPanel::set24HourClockWrapper(const JsonObject& parameters, JsonObject& response)
         {
             bool success = false;
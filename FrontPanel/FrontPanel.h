@@ -99,6 +99,8 @@ namespace WPEFramework {
             void setPreferences(const JsonObject& preferences);
             bool setLED(const JsonObject& properties);
             void setBlink(const JsonObject& blinkInfo);
+            bool animate(const JsonObject& animation);
+            void stopAnimation(const JsonObject& animation);
             void set24HourClock(bool is24Hour);
             bool is24HourClock();
             void setClockTestPattern(bool show);
@@ -117,6 +119,8 @@ namespace WPEFramework {
             uint32_t setPreferencesWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t setLEDWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t setBlinkWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t animateWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t stopAnimationWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t set24HourClockWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t is24HourClockWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t setClockTestPatternWrapper(const JsonObject& parameters, JsonObject& response);
@@ -49,14 +49,21 @@ namespace WPEFramework
 
         HdcpProfile::HdcpProfile()
         : AbstractPluginWithApiAndIARMLock()
+        , m_hdcpStatusValid(false)
         {
             HdcpProfile::_instance = this;
 
-            InitializeIARM();
-            device::Manager::Initialize();
+            {
+                BootPhase phase(*this, "iarmConnect");
+                InitializeIARM();
+            }
+            // devicesettings is only needed for the first status query, which players make at playback start
+            setDeferredInitialization([]() { device::Manager::Initialize(); });
 
             registerMethod(HDCP_PROFILE_METHOD_GET_HDCP_STATUS, &HdcpProfile::getHDCPStatusWrapper, this);
             registerMethod(HDCP_PROFILE_METHOD_GET_SETTOP_HDCP_SUPPORT, &HdcpProfile::getSettopHDCPSupportWrapper, this);
+
+            bootReady();
         }
 
         HdcpProfile::~HdcpProfile()
@@ -69,6 +76,7 @@ namespace WPEFramework
             //No need to run device::Manager::DeInitialize for individual plugin. As it is a singleton instance
             //and shared among all wpeframework plugins
             DeinitializeIARM();
+            m_hdcpStatusValid = false;
         }
 
         void HdcpProfile::InitializeIARM()
@@ -102,38 +110,35 @@ namespace WPEFramework
         {
             LOGINFOMETHOD();
 
-            dsHdcpProtocolVersion_t hdcpProtocol = dsHDCP_VERSION_MAX;
-
-            try
-            {
-                std::string strVideoPort = device::Host::getInstance().getDefaultVideoPortName();
-                device::VideoOutputPort vPort = device::VideoOutputPortConfig::getInstance().getPort(strVideoPort.c_str());
-                hdcpProtocol = (dsHdcpProtocolVersion_t)vPort.getHDCPProtocol();
-            }
-            catch (const std::exception e)
-            {
-                LOGWARN("DS exception caught from %s\r\n", __FUNCTION__);
-            }
-
-            if(hdcpProtocol == dsHDCP_VERSION_2X)
-            {
-                response["supportedHDCPVersion"] = "2.2";
-                LOGWARN("supportedHDCPVersion :2.2");
-            }
-            else
-            {
-                response["supportedHDCPVersion"] = "1.4";
-                LOGWARN("supportedHDCPVersion :1.4");
-            }
+            // The settop protocol is part of the status, take it from there
+            string supportedHDCPVersion = getHDCPStatus()["supportedHDCPVersion"].String();
+            response["supportedHDCPVersion"] = supportedHDCPVersion;
+            LOGWARN("supportedHDCPVersion :%s", supportedHDCPVersion.c_str());
 
             response["isHDCPSupported"] = true;
 
             returnResponse(true);
         }
 
+        // Players ask before every playback start, this must not cost a devicesettings round trip
         JsonObject HdcpProfile::getHDCPStatus()
         {
-            JsonObject hdcpStatus;
+            if (!m_hdcpStatusValid)
+            {
+                ensureInitialized();
+
+                JsonObject hdcpStatus;
+                m_hdcpStatusValid = queryHDCPStatus(hdcpStatus);
+                m_hdcpStatus = hdcpStatus;
+                logHdcpStatus("Request", hdcpStatus);
+            }
+            return m_hdcpStatus;
+        }
+
+        // Returns false if devicesettings could not be read, the defaults are filled in then
+        bool HdcpProfile::queryHDCPStatus(JsonObject& hdcpStatus)
+        {
+            bool success = true;
 
             bool isConnected     = false;
             bool isHDCPCompliant = false;
@@ -166,6 +171,7 @@ namespace WPEFramework
             catch (const std::exception e)
             {
                 LOGWARN("DS exception caught from %s\r\n", __FUNCTION__);
+                success = false;
             }
 
             hdcpStatus["isConnected"] = isConnected;
@@ -200,8 +206,7 @@ namespace WPEFramework
                 hdcpStatus["currentHDCPVersion"] = "1.4";
             }
 
-            logHdcpStatus("Request", hdcpStatus);
-            return hdcpStatus;
+            return success;
         }
 
         void HdcpProfile::onHdmiOutputHotPlug(int connectStatus)
@@ -209,7 +214,11 @@ namespace WPEFramework
             if (HDMI_HOT_PLUG_EVENT_CONNECTED == connectStatus)
                 LOGWARN(" %s   Status : %d \n",__FUNCTION__, connectStatus);
 
-            JsonObject status = getHDCPStatus();
+            ensureInitialized();
+
+            JsonObject status;
+            m_hdcpStatusValid = queryHDCPStatus(status);
+            m_hdcpStatus = status;
             JsonObject params;
             params["HDCPStatus"] = status;
             sendNotify(HDCP_PROFILE_EVT_ON_DISPLAY_CONNECTION_CHANGED, params);
@@ -231,7 +240,11 @@ namespace WPEFramework
 
         void HdcpProfile::onHdmiOutputHDCPStatusEvent(int hdcpStatus)
         {
-            JsonObject status = getHDCPStatus();
+            ensureInitialized();
+
+            JsonObject status;
+            m_hdcpStatusValid = queryHDCPStatus(status);
+            m_hdcpStatus = status;
             JsonObject params;
             params["HDCPStatus"] = status;
             sendNotify(HDCP_PROFILE_EVT_ON_DISPLAY_CONNECTION_CHANGED, params);
@@ -58,6 +58,7 @@ namespace WPEFramework {
             //End methods
 
             JsonObject getHDCPStatus();
+            bool queryHDCPStatus(JsonObject& hdcpStatus);
             void onHdmiOutputHotPlug(int connectStatus);
             void onHdmiOutputHDCPStatusEvent(int);
             void logHdcpStatus (const char *trigger, const JsonObject& status);
@@ -71,6 +72,12 @@ namespace WPEFramework {
             void terminate();
 
             static HdcpProfile* _instance;
+
+        private:
+            // Refreshed from the hotplug and HDCP status events. API calls and IARM events
+            // are serialized by the API lock, so no lock of its own.
+            JsonObject m_hdcpStatus;
+            bool m_hdcpStatusValid;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
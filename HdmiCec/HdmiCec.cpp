@@ -82,7 +82,6 @@ namespace WPEFramework
 
         HdmiCec* HdmiCec::_instance = nullptr;
 
-        static int libcecInitStatus = 0;
 
 //=========================================== HdmiCec cec msg Processor =========================================
        void HdmiCec::process (const ActiveSource &msg, const Header &header)
@@ -428,22 +427,7 @@ namespace WPEFramework
                 LOGINFO("CECMGR is available");
             }
 
-            if(0 == libcecInitStatus)
-            {
-                try
-                {
-                    LibCCEC::getInstance().init();
-                }
-                catch (const std::exception e)
-                {
-                    LOGWARN("CEC exception caught from CECEnable");
-                }
-            }
-            libcecInitStatus++;
-
-            smConnection = new Connection(LogicalAddress::UNREGISTERED,false,"ServiceManager::Connection::");
-            smConnection->open();
-            smConnection->addFrameListener(this);
+            smConnection = CecCore::getInstance().acquire(this);
 
             //Acquire CEC Addresses
             getPhysicalAddress();
@@ -519,23 +503,11 @@ namespace WPEFramework
                 //Clear cec device cache.
                 removeAllCecDevices();
 
-
-                smConnection->close();
-                delete smConnection;
+                CecCore::getInstance().release(this);
                 smConnection = NULL;
             }
             cecEnableStatus = false;
 
-            if(1 == libcecInitStatus)
-            {
-                LibCCEC::getInstance().term();
-            }
-
-            if(libcecInitStatus > 0)
-            {
-                libcecInitStatus--;
-            }
-
             return;
         }
 
@@ -710,7 +682,7 @@ namespace WPEFramework
                 CECFrame frame = CECFrame((const uint8_t *)buf.data(), decodedLen);
         //      SVCLOG_WARN("Frame to be sent from servicemanager in %s \n",__FUNCTION__);
         //      frame.hexDump();
-                smConnection->sendAsync(frame);
+                CecCore::getInstance().sendAsync(frame);
             }
             else
                 LOGWARN("cecEnableStatus=false");
@@ -827,7 +799,7 @@ namespace WPEFramework
 
 		LOGWARN("PING for  0x%x \r\n",idev);
 		try {
-			_instance->smConnection->ping(LogicalAddress(_instance->logicalAddress), LogicalAddress(idev), Throw_e());
+			CecCore::getInstance().ping(LogicalAddress(_instance->logicalAddress), LogicalAddress(idev));
 		}
 		catch(CECNoAckException &e)
 		{
@@ -931,7 +903,7 @@ namespace WPEFramework
 			CECFrame frame = CECFrame((const uint8_t *)buf.data(), size);
 			//      SVCLOG_WARN("Frame to be sent from servicemanager in %s \n",__FUNCTION__);
 			//      frame.hexDump();
-			smConnection->sendAsync(frame);
+			CecCore::getInstance().sendAsync(frame);
 		}
 		else
 			LOGWARN("cecEnableStatus=false");
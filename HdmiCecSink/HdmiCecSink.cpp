@@ -35,6 +35,8 @@
 #include "manager.hpp"
 #include "websocket/URL.h"
 
+#include <algorithm>
+
 #include "utils.h"
 
 #define HDMICECSINK_METHOD_SET_ENABLED 			"setEnabled"
@@ -61,11 +63,19 @@
 #define HDMICECSINK_METHOD_SEND_KEY_PRESS                          "sendKeyPressEvent"
 #define HDMICECSINK_METHOD_SEND_GIVE_AUDIO_STATUS          "sendGetAudioStatusMessage"
 #define HDMICECSINK_METHOD_GET_AUDIO_DEVICE_CONNECTED_STATUS   "getAudioDeviceConnectedStatus"
+#define HDMICECSINK_METHOD_GET_BUS_STATISTICS      "getBusStatistics"
 
 #define TEST_ADD 0
 #define HDMICECSINK_REQUEST_MAX_RETRY 				3
 #define HDMICECSINK_REQUEST_MAX_WAIT_TIME_MS 		2000
 #define HDMICECSINK_PING_INTERVAL_MS 				10000
+#define HDMICECSINK_PING_INTERVAL_MAX_MS 			80000
+#define HDMICECSINK_PING_GAP_MS 					50
+/* Longest a ping waits for queued key presses and routing messages */
+#define HDMICECSINK_TX_DEFER_MAX_MS					1000
+#define HDMICECSINK_DISCOVERY_ROUNDS 				2
+/* Start bit 4.5ms, then 10 bits of 2.4ms for each byte */
+#define HDMICECSINK_FRAME_TIME_MS(bytes)			((45 + (bytes) * 240) / 10)
 #define HDMICECSINK_WAIT_FOR_HDMI_IN_MS 			1000
 #define HDMICECSINK_REQUEST_INTERVAL_TIME_MS 		200
 #define HDMICECSINK_NUMBER_TV_ADDR 					2
@@ -129,6 +139,10 @@ static char *eventString[] = {
 #define CEC_SETTING_OSD_NAME "cecOSDName"
 #define CEC_SETTING_VENDOR_ID "cecVendorId"
 
+/* Device info learnt from earlier sessions, restored while the devices are being verified */
+#define HDMICECSINK_DEVICE_CACHE_FILE "/opt/persistent/ds/cecSinkDevices.json"
+#define HDMICECSINK_DEVICE_CACHE_MAX 16
+
 static vector<uint8_t> defaultVendorId = {0x00,0x19,0xFB};
 static VendorID appVendorId = {defaultVendorId.at(0),defaultVendorId.at(1),defaultVendorId.at(2)};
 static VendorID lgVendorId = {0x00,0xE0,0x91};
@@ -148,7 +162,6 @@ namespace WPEFramework
         SERVICE_REGISTRATION(HdmiCecSink, 1, 0);
 
         HdmiCecSink* HdmiCecSink::_instance = nullptr;
-        static int libcecInitStatus = 0;
 
 //=========================================== HdmiCecSinkFrameListener =========================================
         void HdmiCecSinkFrameListener::notify(const CECFrame &in) const {
@@ -162,6 +175,9 @@ namespace WPEFramework
                 }
                 LOGINFO("   >>>>>    Received CEC Frame: :%s \n",strBuffer);
 
+                if (HdmiCecSink::_instance)
+                    HdmiCecSink::_instance->countFrame(len);
+
                 MessageDecoder(processor).decode(in);
        }
 
@@ -305,11 +321,13 @@ namespace WPEFramework
        {
              printHeader(header);
              LOGINFO("Command: RoutingChange From : %s To: %s \n",msg.from.toString().c_str(),msg.to.toString().c_str());
+             HdmiCecSink::_instance->requestDiscovery();
        }
        void HdmiCecSinkProcessor::process (const RoutingInformation &msg, const Header &header)
        {
              printHeader(header);
              LOGINFO("Command: RoutingInformation Routing Information to Sink : %s\n",msg.toSink.toString().c_str());
+             HdmiCecSink::_instance->requestDiscovery();
        }
        void HdmiCecSinkProcessor::process (const SetStreamPath &msg, const Header &header)
        {
@@ -332,6 +350,7 @@ namespace WPEFramework
 	     if(!HdmiCecSink::_instance)
 	        return;
              HdmiCecSink::_instance->addDevice(header.from.toInt());
+	     HdmiCecSink::_instance->confirmDevice(header.from.toInt(), msg.physicalAddress);
 	     updateDeviceTypeStatus = HdmiCecSink::_instance->deviceList[header.from.toInt()].m_isDeviceTypeUpdated;
              updatePAStatus   = HdmiCecSink::_instance->deviceList[header.from.toInt()].m_isPAUpdated;
 	     LOGINFO("updateDeviceTypeStatus %d updatePAStatus %d \n",updateDeviceTypeStatus,updatePAStatus);
@@ -348,6 +367,7 @@ namespace WPEFramework
              LOGINFO("Command: DeviceVendorID VendorID : %s\n",msg.vendorId.toString().c_str());
 
 	     HdmiCecSink::_instance->addDevice(header.from.toInt());
+	     HdmiCecSink::_instance->checkVendorID(header.from.toInt(), msg.vendorId);
 	     updateStatus = HdmiCecSink::_instance->deviceList[header.from.toInt()].m_isVendorIDUpdated;
              LOGINFO("updateStatus %d\n",updateStatus);
 	     HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.vendorId);
@@ -501,6 +521,17 @@ namespace WPEFramework
 		   hdmiCecAudioDeviceConnected = false;
 		   m_pollNextState = POLL_THREAD_STATE_NONE;
 		   m_pollThreadState = POLL_THREAD_STATE_NONE;
+		   m_discoveryPending = 0;
+		   m_pingInterval = HDMICECSINK_PING_INTERVAL_MS;
+		   m_pingsSent = 0;
+		   m_pingsAcked = 0;
+		   m_requestsSent = 0;
+		   m_framesReceived = 0;
+		   m_discoveries = 0;
+		   m_livenessChecks = 0;
+		   m_busTimeMs = 0;
+		   m_txCoalesced = 0;
+		   m_deviceCacheSeen = 0;
 		   dsHdmiInGetNumberOfInputsParam_t hdmiInput;
 
            InitializeIARM();
@@ -527,10 +558,11 @@ namespace WPEFramework
 		   registerMethod(HDMICECSINK_METHOD_SEND_KEY_PRESS,&HdmiCecSink::sendRemoteKeyPressWrapper,this);
 		   registerMethod(HDMICECSINK_METHOD_SEND_GIVE_AUDIO_STATUS,&HdmiCecSink::sendGiveAudioStatusWrapper,this);
 		   registerMethod(HDMICECSINK_METHOD_GET_AUDIO_DEVICE_CONNECTED_STATUS,&HdmiCecSink::getAudioDeviceConnectedStatusWrapper,this);
+		   registerMethod(HDMICECSINK_METHOD_GET_BUS_STATISTICS,&HdmiCecSink::getBusStatisticsWrapper,this);
            logicalAddressDeviceType = "None";
            logicalAddress = 0xFF;
-           m_sendKeyEventThreadExit = false;
-           m_sendKeyEventThread = std::thread(threadSendKeyEvent);
+           m_txThreadExit = false;
+           m_txThread = std::thread(threadTransmit);
            
            m_currentArcRoutingState = ARC_STATE_ARC_TERMINATED;
            m_semSignaltoArcRoutingThread.acquire();
@@ -541,6 +573,7 @@ namespace WPEFramework
            m_arcStartStopTimer.setSingleShot(true);
            // load persistence setting
            loadSettings();
+           loadDeviceCache();
 
             // get power state:
             IARM_Bus_PWRMgr_GetPowerState_Param_t param;
@@ -633,14 +666,16 @@ namespace WPEFramework
 		LOGERR("exception in thread join %s", e.what());
 	    }
 
-	    m_sendKeyEventThreadExit = true;
-            std::unique_lock<std::mutex> lk(m_sendKeyEventMutex);
-            m_sendKeyCV.notify_one();
+	    {
+                std::unique_lock<std::mutex> lk(m_txMutex);
+                m_txThreadExit = true;
+                m_txCV.notify_one();
+	    }
 
 	    try
 	    {
-            if (m_sendKeyEventThread.joinable())
-                m_sendKeyEventThread.join();
+            if (m_txThread.joinable())
+                m_txThread.join();
 	    }
 	    catch(const std::system_error& e)
 	    {
@@ -764,6 +799,7 @@ namespace WPEFramework
                                                    HdmiCecSink::_instance->m_currentActiveSource = _instance->m_logicalAddressAllocated;
 						}
                                                 /* Initiate a ping straight away */
+                                                HdmiCecSink::_instance->m_pingInterval = HDMICECSINK_PING_INTERVAL_MS;
                                                 HdmiCecSink::_instance->m_pollNextState = POLL_THREAD_STATE_PING;
                                                 HdmiCecSink::_instance->m_ThreadExitCV.notify_one();
 					}
@@ -851,6 +887,12 @@ namespace WPEFramework
                         }
 			CheckHdmiInState();
 
+			/* The topology changed, look for devices on the unknown addresses */
+			if ( cecEnableStatus )
+			{
+				requestDiscovery();
+			}
+
 			if ( previousHdmiState != m_isHdmiInConnected )
 			{
 				if ( m_isHdmiInConnected == false )
@@ -1068,7 +1110,7 @@ namespace WPEFramework
             if(!(_instance->smConnection))
                 return;
              LOGINFO(" Send systemAudioModeRequest ");
-           _instance->smConnection->sendTo(LogicalAddress::AUDIO_SYSTEM,MessageEncoder().encode(SystemAudioModeRequest(physical_addr)), 1000);
+           _instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, LogicalAddress::AUDIO_SYSTEM, MessageEncoder().encode(SystemAudioModeRequest(physical_addr)), 1000, true);
 
         }
          void HdmiCecSink::sendGiveAudioStatusMsg()
@@ -1078,7 +1120,7 @@ namespace WPEFramework
             if(!(_instance->smConnection))
                 return;
              LOGINFO(" Send GiveAudioStatus ");
-	      _instance->smConnection->sendTo(LogicalAddress::AUDIO_SYSTEM,MessageEncoder().encode(GiveAudioStatus()), 100);
+	      _instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, LogicalAddress::AUDIO_SYSTEM, MessageEncoder().encode(GiveAudioStatus()), 100, true);
 
         }
         void HdmiCecSink::SendStandbyMsgEvent(const int logicalAddress)
@@ -1120,6 +1162,20 @@ namespace WPEFramework
             returnResponse(true);
        }
 
+       uint32_t HdmiCecSink::getBusStatisticsWrapper(const JsonObject& parameters, JsonObject& response)
+       {
+            response["pingsSent"] = (uint32_t)m_pingsSent;
+            response["pingsAcked"] = (uint32_t)m_pingsAcked;
+            response["requestsSent"] = (uint32_t)m_requestsSent;
+            response["framesReceived"] = (uint32_t)m_framesReceived;
+            response["discoveries"] = (uint32_t)m_discoveries;
+            response["livenessChecks"] = (uint32_t)m_livenessChecks;
+            response["busTimeMs"] = (uint32_t)m_busTimeMs;
+            response["requestsCoalesced"] = (uint32_t)m_txCoalesced;
+            response["pingInterval"] = (uint32_t)m_pingInterval;
+            returnResponse(true);
+       }
+
 	  uint32_t HdmiCecSink::getActiveSourceWrapper(const JsonObject& parameters, JsonObject& response)
        {
        		char routeString[1024] = {'\0'};
@@ -1459,13 +1515,7 @@ namespace WPEFramework
 			returnIfParamNotFound(parameters, "keyCode");
 			string logicalAddress = parameters["logicalAddress"].String();
 			string keyCode = parameters["keyCode"].String();
-			SendKeyInfo keyInfo;
-			keyInfo.logicalAddr = stoi(logicalAddress);
-			keyInfo.keyCode     = stoi(keyCode);
-			std::unique_lock<std::mutex> lk(m_sendKeyEventMutex);
-			m_SendKeyQueue.push(keyInfo);
-			m_sendKeyCV.notify_one();
-			LOGINFO("Post send key press event to queue size:%d \n",m_SendKeyQueue.size());
+			queueKeyPress(stoi(logicalAddress), stoi(keyCode));
 			returnResponse(true);
 		}
 	   uint32_t HdmiCecSink::sendGiveAudioStatusWrapper(const JsonObject& parameters, JsonObject& response)
@@ -1889,7 +1939,7 @@ namespace WPEFramework
 		       LOGINFO(" Sending FeatureAbort to %s for opcode %s with reason %s ",logicalAddress.toString().c_str(),feature.toString().c_str(),reason.toString().c_str());
                        _instance->smConnection->sendTo(logicalAddress, MessageEncoder().encode(FeatureAbort(feature,reason)), 100);
                  }
-	void HdmiCecSink::pingDevices(std::vector<int> &connected , std::vector<int> &disconnected)
+	void HdmiCecSink::pingDevices(std::vector<int> &connected , std::vector<int> &disconnected, bool discover)
         {
         	int i;
 
@@ -1903,12 +1953,28 @@ namespace WPEFramework
 				return;
 			}
 			
+			if ( discover ) {
+				_instance->m_discoveries++;
+			} else {
+				_instance->m_livenessChecks++;
+			}
+
             for(i=0; i< LogicalAddress::UNREGISTERED; i++ ) {
-				if ( i != _instance->m_logicalAddressAllocated )
+				/* Without a topology change only see if the known devices are still there */
+				if ( i != _instance->m_logicalAddressAllocated &&
+					( discover || _instance->deviceList[i].m_isDevicePresent ) )
 				{
 					//LOGWARN("PING for  0x%x \r\n",i);
+					/* Let pending key presses and routing go out first */
+					for (int wait = 0; wait < HDMICECSINK_TX_DEFER_MAX_MS &&
+							_instance->txPending(HDMICECSINK_TX_PRIORITY_ROUTING); wait += HDMICECSINK_PING_GAP_MS)
+					{
+						usleep(HDMICECSINK_PING_GAP_MS * 1000);
+					}
+					_instance->m_pingsSent++;
+					_instance->m_busTimeMs += HDMICECSINK_FRAME_TIME_MS(1);
 					try {
-						_instance->smConnection->ping(LogicalAddress(_instance->m_logicalAddressAllocated), LogicalAddress(i), Throw_e());
+						CecCore::getInstance().ping(LogicalAddress(_instance->m_logicalAddressAllocated), LogicalAddress(i));
 					}
 					catch(CECNoAckException &e)
 					{
@@ -1916,23 +1982,24 @@ namespace WPEFramework
 							disconnected.push_back(i);
 						}
                                                 //LOGWARN("Ping device: 0x%x caught %s \r\n", i, e.what());
-						usleep(50000);
+						usleep(HDMICECSINK_PING_GAP_MS * 1000);
 						continue;
 					}
 					  catch(Exception &e)
 					  {
 						LOGWARN("Ping device: 0x%x caught %s \r\n", i, e.what());
-                                                usleep(50000);
+                                                usleep(HDMICECSINK_PING_GAP_MS * 1000);
                                                 continue;
 					  }
 					  
+					  _instance->m_pingsAcked++;
 					  /* If we get ACK, then the device is present in the network*/
 					  if ( !_instance->deviceList[i].m_isDevicePresent )
 					  {
 					  	connected.push_back(i);
                                                 //LOGWARN("Ping success, added device: 0x%x \r\n", i);
 					  }
-					  usleep(50000);      
+					  usleep(HDMICECSINK_PING_GAP_MS * 1000);
 				}
            	}
         }
@@ -1955,6 +2022,199 @@ namespace WPEFramework
 			return requestType;
 		}
 
+		/* Pings the unknown logical addresses too, in the next rounds of the poll thread */
+		void HdmiCecSink::requestDiscovery() {
+			if(!HdmiCecSink::_instance)
+				return;
+
+			_instance->m_discoveryPending = HDMICECSINK_DISCOVERY_ROUNDS;
+			_instance->m_pingInterval = HDMICECSINK_PING_INTERVAL_MS;
+			_instance->m_ThreadExitCV.notify_one();
+		}
+
+		void HdmiCecSink::countFrame(size_t length) {
+			m_framesReceived++;
+			m_busTimeMs += HDMICECSINK_FRAME_TIME_MS(length);
+		}
+
+		static std::string deviceCacheKey(const PhysicalAddress &physical_addr, const VendorID &vendorId) {
+			char key[16];
+			snprintf(key, sizeof(key), "%x.%x.%x.%x-%02X%02X%02X",
+					physical_addr.getByteValue(0), physical_addr.getByteValue(1), physical_addr.getByteValue(2), physical_addr.getByteValue(3),
+					vendorId.at(0), vendorId.at(1), vendorId.at(2));
+			return std::string(key);
+		}
+
+		void HdmiCecSink::loadDeviceCache() {
+			Core::File file;
+			file = HDMICECSINK_DEVICE_CACHE_FILE;
+
+			std::lock_guard<std::mutex> lk(m_deviceCacheMutex);
+			m_deviceCache = JsonObject();
+			m_deviceCacheSeen = 0;
+
+			if ( file.Open() )
+			{
+				m_deviceCache.IElement::FromFile(file);
+				file.Close();
+
+				int entries = 0;
+				JsonObject::Iterator it = m_deviceCache.Variants();
+				while (it.Next())
+				{
+					JsonObject entry = it.Current().Object();
+					m_deviceCacheSeen = std::max<uint32_t>(m_deviceCacheSeen, entry["seen"].Number());
+					entries++;
+				}
+				LOGINFO("Device cache: %d entries", entries);
+			}
+		}
+
+		/* Fills in what the device at this address reported last time. The physical address
+		   request is still sent, its reply confirms the rest or drops it (confirmDevice). */
+		void HdmiCecSink::restoreDevice(const int logicalAddress) {
+			JsonObject found;
+			uint32_t seen = 0;
+
+			{
+				std::lock_guard<std::mutex> lk(m_deviceCacheMutex);
+				JsonObject::Iterator it = m_deviceCache.Variants();
+				while (it.Next())
+				{
+					JsonObject entry = it.Current().Object();
+					if ( entry["logicalAddress"].Number() == logicalAddress && entry["seen"].Number() >= seen )
+					{
+						found = entry;
+						seen = entry["seen"].Number();
+					}
+				}
+			}
+
+			if ( !found.HasLabel("physicalAddress") )
+				return;
+
+			uint32_t pa = found["physicalAddress"].Number();
+			uint32_t vendorId = found["vendorId"].Number();
+			CECDeviceParams &device = deviceList[logicalAddress];
+
+			device.m_physicalAddr = PhysicalAddress((pa >> 12) & 0xF, (pa >> 8) & 0xF, (pa >> 4) & 0xF, pa & 0xF);
+			device.m_deviceType = DeviceType(found["deviceType"].Number());
+			device.m_vendorID = VendorID((vendorId >> 16) & 0xFF, (vendorId >> 8) & 0xFF, vendorId & 0xFF);
+			device.m_cecVersion = Version(found["cecVersion"].Number());
+			device.m_osdName = OSDName(found["osdName"].String().c_str());
+			device.m_isProvisional = true;
+			LOGINFO("Restored provisional info for 0x%x: %s %s", logicalAddress,
+					device.m_physicalAddr.toString().c_str(), device.m_osdName.toString().c_str());
+		}
+
+		void HdmiCecSink::confirmDevice(const int logicalAddress, const PhysicalAddress &physical_addr) {
+			if ( logicalAddress >= LogicalAddress::UNREGISTERED )
+				return;
+
+			CECDeviceParams &device = deviceList[logicalAddress];
+			if ( !device.m_isProvisional )
+				return;
+
+			device.m_isProvisional = false;
+			if ( device.m_physicalAddr.toString() == physical_addr.toString() )
+			{
+				/* Same device as last time, no need to ask for the rest */
+				LOGINFO("Confirmed cached info for 0x%x", logicalAddress);
+				device.m_isOSDNameUpdated = true;
+				device.m_isVersionUpdated = true;
+				device.m_isVendorIDUpdated = true;
+			}
+			else
+			{
+				LOGINFO("Cached info for 0x%x is stale, requesting it", logicalAddress);
+				device.m_cecVersion = 0;
+				device.m_vendorID = VendorID(0,0,0);
+				device.m_osdName = "NA";
+			}
+		}
+
+		/* A different vendor ID at a known address is a different device */
+		void HdmiCecSink::checkVendorID(const int logicalAddress, const VendorID &vendorId) {
+			if ( logicalAddress >= LogicalAddress::UNREGISTERED )
+				return;
+
+			CECDeviceParams &device = deviceList[logicalAddress];
+			if ( (device.m_isProvisional || device.m_isVendorIDUpdated) &&
+					device.m_vendorID.toString() != vendorId.toString() )
+			{
+				LOGINFO("Vendor ID of 0x%x changed, requesting its info again", logicalAddress);
+				device.m_isProvisional = false;
+				device.m_isOSDNameUpdated = false;
+				device.m_isVersionUpdated = false;
+				device.m_osdName = "NA";
+				device.m_cecVersion = 0;
+				m_pollNextState = POLL_THREAD_STATE_INFO;
+			}
+		}
+
+		/* Writes the file only when something changed */
+		void HdmiCecSink::persistDevice(const int logicalAddress) {
+			CECDeviceParams &device = deviceList[logicalAddress];
+
+			if ( device.m_isProvisional || !device.isAllUpdated() )
+				return;
+
+			const PhysicalAddress &pa = device.m_physicalAddr;
+			std::string key = deviceCacheKey(pa, device.m_vendorID);
+			JsonObject entry;
+			entry["logicalAddress"] = logicalAddress;
+			entry["physicalAddress"] = (pa.getByteValue(0) << 12) | (pa.getByteValue(1) << 8) | (pa.getByteValue(2) << 4) | pa.getByteValue(3);
+			entry["deviceType"] = device.m_deviceType.toInt();
+			entry["vendorId"] = (device.m_vendorID.at(0) << 16) | (device.m_vendorID.at(1) << 8) | device.m_vendorID.at(2);
+			entry["cecVersion"] = device.m_cecVersion.toInt();
+			entry["osdName"] = device.m_osdName.toString();
+
+			std::lock_guard<std::mutex> lk(m_deviceCacheMutex);
+			if ( m_deviceCache.HasLabel(key.c_str()) )
+			{
+				JsonObject cached = m_deviceCache[key.c_str()].Object();
+				entry["seen"] = cached["seen"];
+				string current, previous;
+				entry.ToString(current);
+				cached.ToString(previous);
+				if ( current == previous )
+					return;
+			}
+
+			entry["seen"] = ++m_deviceCacheSeen;
+			m_deviceCache[key.c_str()] = entry;
+
+			/* Drop the least recently seen device beyond the limit */
+			int entries = 0;
+			string oldest;
+			uint32_t oldestSeen = UINT32_MAX;
+			JsonObject::Iterator it = m_deviceCache.Variants();
+			while (it.Next())
+			{
+				JsonObject cached = it.Current().Object();
+				if ( cached["seen"].Number() < oldestSeen )
+				{
+					oldestSeen = cached["seen"].Number();
+					oldest = it.Label();
+				}
+				entries++;
+			}
+			if ( entries > HDMICECSINK_DEVICE_CACHE_MAX )
+			{
+				m_deviceCache.Remove(oldest.c_str());
+			}
+
+			Core::File file;
+			file = HDMICECSINK_DEVICE_CACHE_FILE;
+			file.Destroy();
+			if ( file.Create() )
+			{
+				m_deviceCache.IElement::ToFile(file);
+				file.Close();
+				LOGINFO("Device cache updated for 0x%x (%s)", logicalAddress, key.c_str());
+			}
+		}
+
 		void HdmiCecSink::printDeviceList() {
 			int i;
 
@@ -2021,9 +2281,9 @@ namespace WPEFramework
 				{
 					LOGINFO("Sending Power OFF ");
 					/* send Power OFF Function to turn OFF */
-					_instance->smConnection->sendTo(LogicalAddress(_instance->m_currentActiveSource), MessageEncoder().encode(UserControlPressed(UICommand::UI_COMMAND_POWER_OFF_FUNCTION)), 100);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, _instance->m_currentActiveSource, MessageEncoder().encode(UserControlPressed(UICommand::UI_COMMAND_POWER_OFF_FUNCTION)), 100, false);
 
-					_instance->smConnection->sendTo(LogicalAddress(_instance->m_currentActiveSource), MessageEncoder().encode(UserControlReleased()), 100);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, _instance->m_currentActiveSource, MessageEncoder().encode(UserControlReleased()), 100, false);
 				}
 			}
 		}
@@ -2057,8 +2317,8 @@ namespace WPEFramework
 				{
 					LOGINFO("Sending Power ON");
 					/* send Power ON Function to turn ON */
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddr), MessageEncoder().encode(UserControlPressed(UICommand::UI_COMMAND_POWER_ON_FUNCTION)), 100);
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddr), MessageEncoder().encode(UserControlReleased()), 100);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, logicalAddr, MessageEncoder().encode(UserControlPressed(UICommand::UI_COMMAND_POWER_ON_FUNCTION)), 100, false);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, logicalAddr, MessageEncoder().encode(UserControlReleased()), 100, false);
 				}
 			}
 		}
@@ -2075,7 +2335,7 @@ namespace WPEFramework
 				return;
 			}
 
-			_instance->smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST), MessageEncoder().encode(SetStreamPath(physical_addr)), 500);
+			_instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, LogicalAddress::BROADCAST, MessageEncoder().encode(SetStreamPath(physical_addr)), 500, true);
 		}
 
 		void HdmiCecSink::setRoutingChange(const std::string &from, const std::string &to) {
@@ -2134,7 +2394,7 @@ namespace WPEFramework
 			
                         if(!(_instance->smConnection))
                             return;
-			_instance->smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST), MessageEncoder().encode(RoutingChange(oldPhyAddr, newPhyAddr)), 500);
+			_instance->queueTx(HDMICECSINK_TX_PRIORITY_ROUTING, LogicalAddress::BROADCAST, MessageEncoder().encode(RoutingChange(oldPhyAddr, newPhyAddr)), 500, false);
 		}
 
 		void HdmiCecSink::addDevice(const int logicalAddress) {
@@ -2154,6 +2414,14 @@ namespace WPEFramework
 				HdmiCecSink::_instance->deviceList[logicalAddress].m_logicalAddress = LogicalAddress(logicalAddress);
 				HdmiCecSink::_instance->m_numberOfDevices++;
 				HdmiCecSink::_instance->m_pollNextState = POLL_THREAD_STATE_INFO;
+				HdmiCecSink::_instance->m_pingInterval = HDMICECSINK_PING_INTERVAL_MS;
+				_instance->restoreDevice(logicalAddress);
+
+				/* An unsolicited frame from a device not known yet, others may have joined with it */
+				if ( std::this_thread::get_id() != _instance->m_pollThread.get_id() )
+				{
+					_instance->requestDiscovery();
+				}
 
 				if(logicalAddress == 0x5)
 				{
@@ -2182,6 +2450,7 @@ namespace WPEFramework
 			if (_instance->deviceList[logicalAddress].m_isDevicePresent)
 			{
 				_instance->m_numberOfDevices--;
+				_instance->m_pingInterval = HDMICECSINK_PING_INTERVAL_MS;
 
 				for (int i=0; i < m_numofHdmiInput; i++) 
 				{
@@ -2217,7 +2486,7 @@ namespace WPEFramework
 				LOGERR("Logical Address NOT Allocated Or its not valid");
 				return;
 			}
-			_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveDevicePowerStatus()), 100);
+			_instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, logicalAddress, MessageEncoder().encode(GiveDevicePowerStatus()), 100, true);
 		}
 
 		void HdmiCecSink::request(const int logicalAddress) {
@@ -2240,31 +2509,31 @@ namespace WPEFramework
 			{
 				case CECDeviceParams::REQUEST_PHISICAL_ADDRESS :
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GivePhysicalAddress()), 200);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, logicalAddress, MessageEncoder().encode(GivePhysicalAddress()), 200, true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_CEC_VERSION :
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GetCECVersion()), 100);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, logicalAddress, MessageEncoder().encode(GetCECVersion()), 100, true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_DEVICE_VENDOR_ID :
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveDeviceVendorID()), 100);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, logicalAddress, MessageEncoder().encode(GiveDeviceVendorID()), 100, true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_OSD_NAME :	
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveOSDName()), 200);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, logicalAddress, MessageEncoder().encode(GiveOSDName()), 200, true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_POWER_STATUS :	
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveDevicePowerStatus()), 100);
+					_instance->queueTx(HDMICECSINK_TX_PRIORITY_INFO, logicalAddress, MessageEncoder().encode(GiveDevicePowerStatus()), 100, true);
 				}
 					break;
 				default:
@@ -2469,6 +2738,8 @@ namespace WPEFramework
 								MessageEncoder().encode(ReportPhysicalAddress(physical_addr, _instance->deviceList[_instance->m_logicalAddressAllocated].m_deviceType)), 100);
 
 						_instance->m_sleepTime = 0;
+						_instance->m_pingInterval = HDMICECSINK_PING_INTERVAL_MS;
+						_instance->m_discoveryPending = HDMICECSINK_DISCOVERY_ROUNDS;
 						_instance->m_pollThreadState = POLL_THREAD_STATE_PING;
 					}
 					else
@@ -2485,7 +2756,12 @@ namespace WPEFramework
 					_instance->m_pollThreadState = POLL_THREAD_STATE_INFO;
 					connected.clear();
 					disconnected.clear();
-					_instance->pingDevices(connected, disconnected);
+					{
+						/* A discovery round uses up one of the pending ones */
+						uint32_t pending = _instance->m_discoveryPending;
+						while ( pending && !_instance->m_discoveryPending.compare_exchange_weak(pending, pending - 1) );
+						_instance->pingDevices(connected, disconnected, pending != 0);
+					}
 
 					if ( disconnected.size() ){
 						for( i=0; i< disconnected.size(); i++ )
@@ -2536,6 +2812,13 @@ namespace WPEFramework
 
 						if ( i ==  LogicalAddress::UNREGISTERED)
 						{
+							for(i=0;i<LogicalAddress::UNREGISTERED;i++)
+							{
+								if ( i != _instance->m_logicalAddressAllocated && _instance->deviceList[i].m_isDevicePresent )
+									_instance->persistDevice(i);
+							}
+							i = LogicalAddress::UNREGISTERED;
+
 							/*So there is no update required, try to ping after some seconds*/
 							_instance->m_pollThreadState = POLL_THREAD_STATE_IDLE;		
 							_instance->m_sleepTime = 0;
@@ -2587,7 +2870,17 @@ namespace WPEFramework
 				case POLL_THREAD_STATE_IDLE :
 				{
 					//LOGINFO("POLL_THREAD_STATE_IDLE");
-					_instance->m_sleepTime = HDMICECSINK_PING_INTERVAL_MS;
+					if ( _instance->m_discoveryPending )
+					{
+						/* Topology changed, discover again (the next round after the interval to catch the late ones) */
+						_instance->m_sleepTime = (_instance->m_discoveryPending < HDMICECSINK_DISCOVERY_ROUNDS) ? HDMICECSINK_PING_INTERVAL_MS : 0;
+					}
+					else
+					{
+						/* Nothing changed, back off until something does */
+						_instance->m_sleepTime = _instance->m_pingInterval;
+						_instance->m_pingInterval = std::min<uint32_t>(_instance->m_pingInterval * 2, HDMICECSINK_PING_INTERVAL_MAX_MS);
+					}
 					_instance->m_pollThreadState = POLL_THREAD_STATE_PING;
 				}
 				break;
@@ -2688,24 +2981,11 @@ namespace WPEFramework
                 return;
             }
 
-            if(0 == libcecInitStatus)
-            {
-                try
-                {
-                    LibCCEC::getInstance().init();
-                }
-                catch (const std::exception e)
-                {
-                    LOGWARN("CEC exception caught from LibCCEC::getInstance().init()");
-                }
-            }
-            libcecInitStatus++;
-          
+            smConnection = CecCore::getInstance().acquire(NULL);
+
             //Acquire CEC Addresses
             getPhysicalAddress();
 
-			smConnection = new Connection(LogicalAddress::UNREGISTERED,false,"ServiceManager::Connection::");
-            smConnection->open();
             allocateLogicalAddress(DeviceType::TV);
             LOGINFO("logical address allocalted: %x  \n",m_logicalAddressAllocated);
             if ( m_logicalAddressAllocated != LogicalAddress::UNREGISTERED && smConnection)
@@ -2779,9 +3059,12 @@ namespace WPEFramework
 
 		LOGWARN("Deleted Thread %p", smConnection );
 
-                smConnection->close();
-                delete smConnection;
+                CecCore::getInstance().release(msgFrameListener);
                 smConnection = NULL;
+                delete msgFrameListener;
+                msgFrameListener = NULL;
+                delete msgProcessor;
+                msgProcessor = NULL;
             }
             
 	    m_logicalAddressAllocated = LogicalAddress::UNREGISTERED;
@@ -2795,20 +3078,7 @@ namespace WPEFramework
 	         }
             }
 
-            if(1 == libcecInitStatus)
-            {
-                try
-                {
-                   LibCCEC::getInstance().term();
-                }
-                catch (const std::exception e)
-                {
-                    LOGWARN("CEC exception caught from LibCCEC::getInstance().term() ");
-                }
-            }
-
-            libcecInitStatus--;
-            LOGWARN("CEC Disabled %d",libcecInitStatus); 
+            LOGWARN("CEC Disabled"); 
 
 	   params["cecEnable"] = string("false");
            sendNotify(eventString[HDMICECSINK_EVENT_CEC_ENABLED], params);
@@ -2981,43 +3251,108 @@ namespace WPEFramework
                 sendNotify(eventString[HDMICECSINK_EVENT_ARC_TERMINATION_EVENT], params);
         }
 
-        void HdmiCecSink::threadSendKeyEvent()
+        void HdmiCecSink::queueTx(int priority, const int logicalAddress, const CECFrame &frame, int timeout, bool coalesce)
+        {
+            CecTxRequest request = { logicalAddress, -1, frame, timeout, coalesce };
+            std::unique_lock<std::mutex> lk(m_txMutex);
+            std::deque<CecTxRequest> &queue = m_txQueue[priority];
+
+            if ( coalesce && frame.length() > 0 )
+            {
+                for (auto it = queue.begin(); it != queue.end(); it++)
+                {
+                    /* Same opcode to the same device: the queued one is sent with the latest operands */
+                    if ( it->coalesce && it->logicalAddr == logicalAddress &&
+                            it->frame.length() > 0 && it->frame.at(0) == frame.at(0) )
+                    {
+                        it->frame = frame;
+                        it->timeout = timeout;
+                        m_txCoalesced++;
+                        return;
+                    }
+                }
+            }
+
+            queue.push_back(request);
+            m_txCV.notify_one();
+        }
+
+        void HdmiCecSink::queueKeyPress(const int logicalAddress, int keyCode)
         {
-            int i;
+            CecTxRequest request = { logicalAddress, keyCode, CECFrame(), 100, false };
+            std::unique_lock<std::mutex> lk(m_txMutex);
+            m_txQueue[HDMICECSINK_TX_PRIORITY_KEY].push_back(request);
+            m_txCV.notify_one();
+            LOGINFO("Post send key press event to queue size:%d \n",m_txQueue[HDMICECSINK_TX_PRIORITY_KEY].size());
+        }
 
+        /* Anything queued at this priority or above */
+        bool HdmiCecSink::txPending(int priority)
+        {
+            std::unique_lock<std::mutex> lk(m_txMutex);
+            for (int i = 0; i <= priority; i++)
+            {
+                if ( !m_txQueue[i].empty() )
+                    return true;
+            }
+            return false;
+        }
+
+        void HdmiCecSink::threadTransmit()
+        {
             if(!HdmiCecSink::_instance)
                 return;
 
             while(1)
             {
-                SendKeyInfo keyInfo = {-1,-1};
+                CecTxRequest request;
+                int priority = 0;
                 {
-                    // Wait for a message to be added to the queue
-                    std::unique_lock<std::mutex> lk(_instance->m_sendKeyEventMutex);
-                    while (_instance->m_SendKeyQueue.empty())
-                        _instance->m_sendKeyCV.wait(lk);
-
-                    if (_instance->m_SendKeyQueue.empty())
-                        continue;
-                    keyInfo = _instance->m_SendKeyQueue.front();
-                    _instance->m_SendKeyQueue.pop();
+                    // Wait for a message to be added to any of the queues
+                    std::unique_lock<std::mutex> lk(_instance->m_txMutex);
+                    auto pending = [] () {
+                        for (int i = 0; i < HDMICECSINK_TX_PRIORITIES; i++)
+                            if ( !_instance->m_txQueue[i].empty() )
+                                return true;
+                        return false;
+                    };
+                    _instance->m_txCV.wait(lk, [&] () { return _instance->m_txThreadExit || pending(); });
+
+                    if (_instance->m_txThreadExit == true)
+                    {
+                        LOGINFO(" threadTransmit Exiting");
+                        break;
+                    }
+
+                    while ( _instance->m_txQueue[priority].empty() )
+                        priority++;
+                    request = _instance->m_txQueue[priority].front();
+                    _instance->m_txQueue[priority].pop_front();
                 }
 
-                LOGINFO("sendRemoteKeyThread : logical addr:0x%x keyCode: 0x%x  queue size :%d \n",keyInfo.logicalAddr,keyInfo.keyCode,_instance->m_SendKeyQueue.size());
-			    _instance->sendKeyPressEvent(keyInfo.logicalAddr,keyInfo.keyCode);
-			    _instance->sendKeyReleaseEvent(keyInfo.logicalAddr);
-			    if((_instance->m_SendKeyQueue.size()<=1 || (_instance->m_SendKeyQueue.size() % 2 == 0)) && ((keyInfo.keyCode == VOLUME_UP) || (keyInfo.keyCode == VOLUME_DOWN) || (keyInfo.keyCode == MUTE)) )
-			    {
-			        _instance->sendGiveAudioStatusMsg();
-			    }
+                if(!(_instance->smConnection))
+                    continue;
 
-                if (_instance->m_sendKeyEventThreadExit == true)
+                if ( request.keyCode >= 0 )
                 {
-                    LOGINFO(" threadSendKeyEvent Exiting");
-                    break;
+                    LOGINFO("sendRemoteKeyThread : logical addr:0x%x keyCode: 0x%x\n",request.logicalAddr,request.keyCode);
+                    _instance->sendKeyPressEvent(request.logicalAddr,request.keyCode);
+                    _instance->sendKeyReleaseEvent(request.logicalAddr);
+                    _instance->m_busTimeMs += HDMICECSINK_FRAME_TIME_MS(3) + HDMICECSINK_FRAME_TIME_MS(2);
+                    if ((request.keyCode == VOLUME_UP) || (request.keyCode == VOLUME_DOWN) || (request.keyCode == MUTE))
+                    {
+                        /* Coalesced, so a burst of volume keys is followed by one status request */
+                        _instance->sendGiveAudioStatusMsg();
+                    }
+                    continue;
                 }
+
+                CecCore::getInstance().sendTo(LogicalAddress(request.logicalAddr), request.frame, request.timeout);
+                _instance->m_busTimeMs += HDMICECSINK_FRAME_TIME_MS(request.frame.length() + 1);
+                if ( priority == HDMICECSINK_TX_PRIORITY_INFO )
+                    _instance->m_requestsSent++;
             }//while(1)
-        }//threadSendKeyEvent
+        }//threadTransmit
 
 
         void HdmiCecSink::threadArcRouting()
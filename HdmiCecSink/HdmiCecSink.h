@@ -22,6 +22,8 @@
 #include <stdint.h>
 #include "ccec/FrameListener.hpp"
 #include "ccec/Connection.hpp"
+#include "ccec/CECFrame.hpp"
+#include "CecCore.h"
 
 #include "libIBus.h"
 #include "ccec/Assert.hpp"
@@ -35,10 +37,12 @@
 #include "utils.h"
 #include "AbstractPlugin.h"
 #include "tptimer.h"
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <deque>
 
 namespace WPEFramework {
 
@@ -132,6 +136,7 @@ namespace WPEFramework {
 			bool m_isOSDNameUpdated;
 			bool m_isVendorIDUpdated;
 			bool m_isPowerStatusUpdated;
+			bool m_isProvisional;		/* restored from the device cache, not confirmed by the device yet */
 			int  m_isRequested;
 			int  m_isRequestRetry;
 			std::chrono::system_clock::time_point m_requestTime;
@@ -150,6 +155,7 @@ namespace WPEFramework {
 				m_isPowerStatusUpdated = false;
 				m_isDeviceDisconnected = false;
 				m_isDeviceTypeUpdated = false;
+				m_isProvisional = false;
 				m_isRequestRetry = 0;
 			}
 
@@ -172,6 +178,7 @@ namespace WPEFramework {
 				m_isPowerStatusUpdated = false;
 				m_isDeviceDisconnected = false;
 				m_isDeviceTypeUpdated = false;
+				m_isProvisional = false;
 			}
 
 			void printVariable()
@@ -250,11 +257,22 @@ namespace WPEFramework {
 			}
 			
 		} ;
-	        typedef struct sendKeyInfo
-                {
-                   int logicalAddr;
-                   int keyCode;
-                }SendKeyInfo;
+		/* Lower value goes out first */
+		enum {
+			HDMICECSINK_TX_PRIORITY_KEY = 0,
+			HDMICECSINK_TX_PRIORITY_ROUTING,
+			HDMICECSINK_TX_PRIORITY_INFO,
+			HDMICECSINK_TX_PRIORITIES
+		};
+
+		typedef struct cecTxRequest
+		{
+			int logicalAddr;
+			int keyCode;		/* >= 0 for a remote key press, sent as pressed + released */
+			CECFrame frame;
+			int timeout;
+			bool coalesce;		/* replaces a queued frame with the same opcode to the same device */
+		}CecTxRequest;
 
 		class HdmiPortMap {
 			public:
@@ -556,6 +574,10 @@ private:
             void sendKeyPressEvent(const int logicalAddress, int keyCode);
             void sendKeyReleaseEvent(const int logicalAddress);
 			void sendGiveAudioStatusMsg();
+			void requestDiscovery();
+			void countFrame(size_t length);
+			void confirmDevice(const int logicalAddress, const PhysicalAddress &physical_addr);
+			void checkVendorID(const int logicalAddress, const VendorID &vendorId);
 			int m_numberOfDevices; /* Number of connected devices othethan own device */
         private:
             // We do not allow this plugin to be copied !!
@@ -585,6 +607,7 @@ private:
                         uint32_t sendRemoteKeyPressWrapper(const JsonObject& parameters, JsonObject& response);
 	                uint32_t sendGiveAudioStatusWrapper(const JsonObject& parameters, JsonObject& response);
 			uint32_t getAudioDeviceConnectedStatusWrapper(const JsonObject& parameters, JsonObject& response);
+			uint32_t getBusStatisticsWrapper(const JsonObject& parameters, JsonObject& response);
                         //End methods
             std::string logicalAddressDeviceType;
             bool cecSettingEnabled;
@@ -600,14 +623,30 @@ private:
 			uint32_t m_pollNextState;
 			bool m_pollThreadExit;
 			uint32_t m_sleepTime;
+			/* Discovery: unknown addresses are only pinged when this is set, known ones every m_pingInterval */
+			std::atomic<uint32_t> m_discoveryPending;
+			std::atomic<uint32_t> m_pingInterval;
+			/* Bus utilization */
+			std::atomic<uint32_t> m_pingsSent;
+			std::atomic<uint32_t> m_pingsAcked;
+			std::atomic<uint32_t> m_requestsSent;
+			std::atomic<uint32_t> m_framesReceived;
+			std::atomic<uint32_t> m_discoveries;
+			std::atomic<uint32_t> m_livenessChecks;
+			std::atomic<uint32_t> m_busTimeMs;
             std::mutex m_pollExitMutex;
             std::mutex m_enableMutex;
-            /* Send Key event related */
-            bool m_sendKeyEventThreadExit;
-            std::thread m_sendKeyEventThread;
-            std::mutex m_sendKeyEventMutex;
-            std::queue<SendKeyInfo> m_SendKeyQueue;
-            std::condition_variable m_sendKeyCV;
+            /* Transmit queue: key presses, then routing, then info requests */
+            bool m_txThreadExit;
+            std::thread m_txThread;
+            std::mutex m_txMutex;
+            std::deque<CecTxRequest> m_txQueue[HDMICECSINK_TX_PRIORITIES];
+            std::condition_variable m_txCV;
+            std::atomic<uint32_t> m_txCoalesced;
+            /* Device info cache, persisted and keyed by physical address and vendor ID */
+            JsonObject m_deviceCache;
+            std::mutex m_deviceCacheMutex;
+            uint32_t m_deviceCacheSeen;
 	    std::condition_variable m_ThreadExitCV;
 
             /* ARC related */
@@ -626,12 +665,15 @@ private:
             void DeinitializeIARM();
 			void allocateLogicalAddress(int deviceType);
 			void allocateLAforTV();
-			void pingDevices(std::vector<int> &connected , std::vector<int> &disconnected);
+			void pingDevices(std::vector<int> &connected , std::vector<int> &disconnected, bool discover);
 			void CheckHdmiInState();
 			void request(const int logicalAddress);
 			int requestType(const int logicalAddress);
 			int requestStatus(const int logicalAddress);
 			void requestPowerStatus(const int logicalAddress);
+			void queueTx(int priority, const int logicalAddress, const CECFrame &frame, int timeout, bool coalesce);
+			void queueKeyPress(const int logicalAddress, int keyCode);
+			bool txPending(int priority);
 			static void threadRun();
 			void cecMonitoringThread();
             static void cecMgrEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
@@ -642,6 +684,9 @@ private:
             void onHdmiHotPlug(int portId, int connectStatus);
 	    void wakeupFromStandby();
             bool loadSettings();
+            void loadDeviceCache();
+            void restoreDevice(const int logicalAddress);
+            void persistDevice(const int logicalAddress);
             void persistSettings(bool enableStatus);
             void persistOTPSettings(bool enableStatus);
             void persistOSDName(const char *name);
@@ -657,7 +702,7 @@ private:
             
             // Arc functions
     
-            static void  threadSendKeyEvent();
+            static void  threadTransmit();
             static void  threadArcRouting();
             void requestArcInitiation();
             void requestArcTermination();
@@ -48,12 +48,17 @@
 #define HDMICEC2_METHOD_GET_VENDOR_ID "getVendorId"
 #define HDMICEC2_METHOD_PERFORM_OTP_ACTION "performOTPAction"
 #define HDMICEC2_METHOD_SEND_STANDBY_MESSAGE "sendStandbyMessage"
+#define HDMICEC2_METHOD_GET_HOTPLUG_STATS "getHotplugStats"
 
 #define HDMICEC_EVENT_ON_DEVICES_CHANGED "onDevicesChanged"
 #define HDMICEC_EVENT_ON_HDMI_HOT_PLUG "onHdmiHotPlug"
 #define HDMICEC_EVENT_ON_STANDBY_MSG_RECEIVED "standbyMessageReceived"
 #define DEV_TYPE_TUNER 1
 #define HDMI_HOT_PLUG_EVENT_CONNECTED 0
+//ms, the addresses are announced once no hotplug came in for this long
+#define HDMICEC2_HOTPLUG_DEBOUNCE_MS 300
+//ms, nor later than this after the first hotplug of a burst, for a link that keeps bouncing
+#define HDMICEC2_HOTPLUG_DEBOUNCE_MAX_MS 2000
 #define ABORT_REASON_ID 4
 
 enum {
@@ -92,7 +97,6 @@ namespace WPEFramework
         SERVICE_REGISTRATION(HdmiCec_2, 1, 0);
 
         HdmiCec_2* HdmiCec_2::_instance = nullptr;
-        static int libcecInitStatus = 0;
 
 //=========================================== HdmiCec_2FrameListener =========================================
         void HdmiCec_2FrameListener::notify(const CECFrame &in) const {
@@ -362,6 +366,14 @@ namespace WPEFramework
        {
            LOGWARN("ctor");
            IsCecMgrActivated = false;
+           m_hotplugThreadExit = true;
+           m_hotplugPending = false;
+           m_hotplugStatus = 0;
+           m_hotplugEvents = 0;
+           m_hotplugCollapsed = 0;
+           m_hotplugAnnounces = 0;
+           m_announceLatencyMs = 0;
+           m_announceLatencyMaxMs = 0;
            registerMethod(HDMICEC2_METHOD_SET_ENABLED, &HdmiCec_2::setEnabledWrapper, this);
            registerMethod(HDMICEC2_METHOD_GET_ENABLED, &HdmiCec_2::getEnabledWrapper, this);
            registerMethod(HDMICEC2_METHOD_OTP_SET_ENABLED, &HdmiCec_2::setOTPEnabledWrapper, this);
@@ -373,6 +385,7 @@ namespace WPEFramework
            registerMethod(HDMICEC2_METHOD_PERFORM_OTP_ACTION, &HdmiCec_2::performOTPActionWrapper, this);
            registerMethod(HDMICEC2_METHOD_SEND_STANDBY_MESSAGE, &HdmiCec_2::sendStandbyMessageWrapper, this);
            registerMethod("getDeviceList", &HdmiCec_2::getDeviceList, this);
+           registerMethod(HDMICEC2_METHOD_GET_HOTPLUG_STATS, &HdmiCec_2::getHotplugStatsWrapper, this);
 
        }
 
@@ -596,9 +609,22 @@ namespace WPEFramework
                 IARM_Bus_DSMgr_EventData_t *eventData = (IARM_Bus_DSMgr_EventData_t *)data;
                 int hdmi_hotplug_event = eventData->data.hdmi_hpd.event;
                 LOGINFO("Received IARM_BUS_DSMGR_EVENT_HDMI_HOTPLUG  event data:%d \r\n", hdmi_hotplug_event);
-                HdmiCec_2::_instance->onHdmiHotPlug(hdmi_hotplug_event);
-                //Trigger CEC device poll here
-                pthread_cond_signal(&(_instance->m_condSig));
+                //Handled on the hotplug thread, the IARM thread does not wait for the bus
+                {
+                    std::lock_guard<std::mutex> lock(_instance->m_hotplugLock);
+                    if (_instance->m_hotplugThreadExit)
+                        return;
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    _instance->m_hotplugEvents++;
+                    if (_instance->m_hotplugPending)
+                        _instance->m_hotplugCollapsed++;
+                    else
+                        _instance->m_hotplugFirst = now;
+                    _instance->m_hotplugLast = now;
+                    _instance->m_hotplugStatus = hdmi_hotplug_event;
+                    _instance->m_hotplugPending = true;
+                }
+                _instance->m_hotplugCond.notify_one();
             }
        }
 
@@ -670,11 +696,12 @@ namespace WPEFramework
            return;
        }
 
-       void HdmiCec_2::onHdmiHotPlug(int connectStatus)
+       bool HdmiCec_2::onHdmiHotPlug(int connectStatus)
        {
+            bool announced = false;
             if (!IsCecMgrActivated) {
                 LOGWARN("CEC Mgr not activated CEC communication is not possible");
-                return;
+                return announced;
             }
             if (HDMI_HOT_PLUG_EVENT_CONNECTED == connectStatus)
             {
@@ -714,6 +741,7 @@ namespace WPEFramework
                              smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST), MessageEncoder().encode(DeviceVendorID(lgVendorId)), 5000);
                          else 
                              smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST), MessageEncoder().encode(DeviceVendorID(appVendorId)),5000);
+                         announced = true;
                      } 
                      catch(...)
                      {
@@ -721,7 +749,7 @@ namespace WPEFramework
                      }
                  }
             }
-            return;
+            return announced;
        }
 
        uint32_t HdmiCec_2::setEnabledWrapper(const JsonObject& parameters, JsonObject& response)
@@ -748,6 +776,17 @@ namespace WPEFramework
             response["enabled"] = getEnabled();
             returnResponse(true);
        }
+
+       uint32_t HdmiCec_2::getHotplugStatsWrapper(const JsonObject& parameters, JsonObject& response)
+       {
+            std::lock_guard<std::mutex> lock(m_hotplugLock);
+            response["hotplugs"] = m_hotplugEvents;
+            response["collapsed"] = m_hotplugCollapsed;
+            response["announcements"] = m_hotplugAnnounces;
+            response["announceLatency"] = m_announceLatencyMs;
+            response["maxAnnounceLatency"] = m_announceLatencyMaxMs;
+            returnResponse(true);
+       }
        uint32_t HdmiCec_2::setOTPEnabledWrapper(const JsonObject& parameters, JsonObject& response)
        {
            LOGINFOMETHOD();
@@ -1005,26 +1044,13 @@ namespace WPEFramework
                 return;
             }
 
-            if(0 == libcecInitStatus)
-            {
-                try
-                {
-                    LibCCEC::getInstance().init();
-                }
-                catch (const std::exception e)
-                {
-                    LOGWARN("CEC exception caught from LibCCEC::getInstance().init()");
-                }
-            }
-            libcecInitStatus++;
-          
+            smConnection = CecCore::getInstance().acquire(NULL);
 
             //Acquire CEC Addresses
             getPhysicalAddress();
             getLogicalAddress();
 
-            smConnection = new Connection(logicalAddress.toInt(),false,"ServiceManager::Connection::");
-            smConnection->open();
+            smConnection->setSource(logicalAddress);
             msgProcessor = new HdmiCec_2Processor(*smConnection);
             msgFrameListener = new HdmiCec_2FrameListener(*msgProcessor);
             smConnection->addFrameListener(msgFrameListener);
@@ -1058,6 +1084,14 @@ namespace WPEFramework
                 _instance->m_condSig = PTHREAD_COND_INITIALIZER;
                 m_pollThread = std::thread(threadRun);
 
+                LOGWARN("Start hotplug Thread %p", smConnection );
+                {
+                    std::lock_guard<std::mutex> lock(m_hotplugLock);
+                    m_hotplugThreadExit = false;
+                    m_hotplugPending = false;
+                }
+                m_hotplugThread = std::thread(threadHotplug);
+
             }
             return;
         }
@@ -1082,6 +1116,25 @@ namespace WPEFramework
             {
                 LOGWARN("Stop Thread %p", smConnection );
 
+                {
+                    std::lock_guard<std::mutex> lock(m_hotplugLock);
+                    m_hotplugThreadExit = true;
+                }
+                m_hotplugCond.notify_one();
+                try {
+                    if (m_hotplugThread.joinable()) {
+                       LOGWARN("Join hotplug Thread %p", smConnection );
+                       m_hotplugThread.join();
+                    }
+                }
+                catch(const std::system_error& e) {
+                    LOGERR("system_error exception in thread join %s", e.what());
+                }
+                catch(const std::exception& e) {
+                    LOGERR("exception in thread join %s", e.what());
+                }
+                LOGWARN("Deleted hotplug Thread %p", smConnection );
+
                 m_updateThreadExit = true;
                 //Trigger codition to exit poll loop
                 pthread_cond_signal(&(_instance->m_condSigUpdate));
@@ -1118,26 +1171,15 @@ namespace WPEFramework
                 //Clear cec device cache.
                 removeAllCecDevices();
 
-                smConnection->close();
-                delete smConnection;
+                CecCore::getInstance().release(msgFrameListener);
                 smConnection = NULL;
+                delete msgFrameListener;
+                msgFrameListener = NULL;
+                delete msgProcessor;
+                msgProcessor = NULL;
             }
             cecEnableStatus = false;
 
-            if(1 == libcecInitStatus)
-            {
-                try
-                {
-                   LibCCEC::getInstance().term();
-                }
-                catch (const std::exception e)
-                {
-                    LOGWARN("CEC exception caught from LibCCEC::getInstance().term() ");
-                }
-            }
-
-            libcecInitStatus--;
-
             return;
         }
 
@@ -1294,7 +1336,7 @@ namespace WPEFramework
 
 		LOGWARN("PING for  0x%x \r\n",idev);
 		try {
-			_instance->smConnection->ping(logicalAddress, LogicalAddress(idev), Throw_e());
+			CecCore::getInstance().ping(logicalAddress, LogicalAddress(idev));
 		}
 		catch(CECNoAckException &e)
 		{
@@ -1398,7 +1440,7 @@ namespace WPEFramework
 			CECFrame frame = CECFrame((const uint8_t *)buf.data(), size);
 			//      SVCLOG_WARN("Frame to be sent from servicemanager in %s \n",__FUNCTION__);
 			//      frame.hexDump();
-			smConnection->sendAsync(frame);
+			CecCore::getInstance().sendAsync(frame);
 		}
 		else
 			LOGWARN("cecEnableStatus=false");
@@ -1538,5 +1580,51 @@ namespace WPEFramework
 		pthread_mutex_unlock(&(_instance->m_lockUpdate));
 	}
 
+	void HdmiCec_2::threadHotplug()
+	{
+		if(!HdmiCec_2::_instance)
+			return;
+		LOGINFO("Entering ThreadHotplug: _instance->m_hotplugThreadExit %d",_instance->m_hotplugThreadExit);
+		std::unique_lock<std::mutex> lock(_instance->m_hotplugLock);
+		while (!_instance->m_hotplugThreadExit) {
+			if (!_instance->m_hotplugPending) {
+				_instance->m_hotplugCond.wait(lock);
+				continue;
+			}
+
+			//Every hotplug of the burst moves the announcement back, up to the maximum
+			std::chrono::steady_clock::time_point deadline = std::min(
+				_instance->m_hotplugLast + std::chrono::milliseconds(HDMICEC2_HOTPLUG_DEBOUNCE_MS),
+				_instance->m_hotplugFirst + std::chrono::milliseconds(HDMICEC2_HOTPLUG_DEBOUNCE_MAX_MS));
+			if (std::chrono::steady_clock::now() < deadline) {
+				_instance->m_hotplugCond.wait_until(lock, deadline);
+				continue;
+			}
+
+			int status = _instance->m_hotplugStatus;
+			std::chrono::steady_clock::time_point first = _instance->m_hotplugFirst;
+			_instance->m_hotplugPending = false;
+			lock.unlock();
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			bool announced = _instance->onHdmiHotPlug(status);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			//Trigger CEC device poll here
+			pthread_cond_signal(&(_instance->m_condSig));
+
+			lock.lock();
+			if (announced) {
+				uint32_t latency = std::chrono::duration_cast<std::chrono::milliseconds>(end - first).count();
+				_instance->m_hotplugAnnounces++;
+				_instance->m_announceLatencyMs = latency;
+				if (latency > _instance->m_announceLatencyMaxMs)
+					_instance->m_announceLatencyMaxMs = latency;
+				LOGINFO("hotplug announced %u ms after the first event, %lld ms on the bus, %u of %u events collapsed",
+					latency, (long long)std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(),
+					_instance->m_hotplugCollapsed, _instance->m_hotplugEvents);
+			}
+		}
+	}
+
     } // namespace Plugin
 } // namespace WPEFramework
@@ -20,8 +20,13 @@
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include "ccec/FrameListener.hpp"
 #include "ccec/Connection.hpp"
+#include "CecCore.h"
 
 #include "libIBus.h"
 #include "ccec/Assert.hpp"
@@ -191,6 +196,7 @@ namespace WPEFramework {
             uint32_t performOTPActionWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t sendStandbyMessageWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getDeviceList (const JsonObject& parameters, JsonObject& response);
+            uint32_t getHotplugStatsWrapper(const JsonObject& parameters, JsonObject& response);
 
             //End methods
             std::string logicalAddressDeviceType;
@@ -205,6 +211,23 @@ namespace WPEFramework {
             bool m_updateThreadExit;
             std::thread m_UpdateThread;
 
+            // The IARM thread only records a hotplug. The re-announcement runs on m_hotplugThread
+            // after the link stayed quiet for HDMICEC2_HOTPLUG_DEBOUNCE_MS: a burst of re-plugs
+            // or TV input switches is one announcement, with the state of the last event.
+            std::mutex m_hotplugLock;
+            std::condition_variable m_hotplugCond;
+            std::thread m_hotplugThread;
+            bool m_hotplugThreadExit;
+            bool m_hotplugPending;
+            int m_hotplugStatus;
+            std::chrono::steady_clock::time_point m_hotplugFirst;   // first event of the burst
+            std::chrono::steady_clock::time_point m_hotplugLast;
+            uint32_t m_hotplugEvents;
+            uint32_t m_hotplugCollapsed;
+            uint32_t m_hotplugAnnounces;
+            uint32_t m_announceLatencyMs;       // first event of the burst to the last frame sent
+            uint32_t m_announceLatencyMaxMs;
+
             HdmiCec_2Processor *msgProcessor;
             HdmiCec_2FrameListener *msgFrameListener;
             const void InitializeIARM();
@@ -214,7 +237,7 @@ namespace WPEFramework {
             static void pwrMgrModeChangeEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             void onCECDaemonInit();
             void cecStatusUpdated(void *evtStatus);
-            void onHdmiHotPlug(int connectStatus);
+            bool onHdmiHotPlug(int connectStatus);
             bool loadSettings();
             void persistSettings(bool enableStatus);
             void persistOTPSettings(bool enableStatus);
@@ -238,6 +261,7 @@ namespace WPEFramework {
             void requestCecDevDetails(const int logicalAddress);
             static void threadRun();
             static void threadUpdateCheck();
+            static void threadHotplug();
         };
 	} // namespace Plugin
 } // namespace WPEFramework
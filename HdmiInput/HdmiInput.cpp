@@ -42,11 +42,22 @@
 #define HDMIINPUT_METHOD_START_HDMI_INPUT "startHdmiInput"
 #define HDMIINPUT_METHOD_STOP_HDMI_INPUT "stopHdmiInput"
 #define HDMIINPUT_METHOD_SCALE_HDMI_INPUT "setVideoRectangle"
+#define HDMIINPUT_METHOD_SET_GAME_MODE "setGameMode"
+#define HDMIINPUT_METHOD_GET_GAME_MODE "getGameMode"
+#define HDMIINPUT_METHOD_GET_INPUT_SWITCH_STATISTICS "getInputSwitchStatistics"
 
 #define HDMIINPUT_EVENT_ON_DEVICES_CHANGED "onDevicesChanged"
 #define HDMIINPUT_EVENT_ON_SIGNAL_CHANGED "onSignalChanged"
 #define HDMIINPUT_EVENT_ON_STATUS_CHANGED "onInputStatusChanged"
 #define HDMIINPUT_EVENT_ON_VIDEO_MODE_UPDATED "videoStreamInfoUpdate"
+#define HDMIINPUT_EVENT_ON_GAME_MODE_CHANGED "onGameModeChanged"
+#define HDMIINPUT_EVENT_ON_SOURCE_INFO_CHANGED "onSourceInfoChanged"
+
+// SPD InfoFrame source information values (CTA-861), indexed by the source_info byte
+static const char* const kSourceTypes[] = {
+    "unknown", "stb", "dvd", "dvhs", "hddVideo", "dvc", "dsc", "videoCd",
+    "game", "pc", "bluray", "superAudioCd", "hdDvd", "pmp"
+};
 
 using namespace std;
 
@@ -60,6 +71,14 @@ namespace WPEFramework
 
         HdmiInput::HdmiInput()
         : AbstractPlugin(2)
+        , m_gameModeEnabled(false)
+        , m_gameModeFollowSource(true)
+        , m_gameModeActive(false)
+        , m_gameModePort(-1)
+        , m_presentedPort(-1)
+        , m_numberOfInputs(-1)
+        , m_inputSource(std::bind(&HdmiInput::selectPort, this, std::placeholders::_1),
+                        [this](const InputSourceManager::Plane& plane) { return setVideoRectangle(plane.x, plane.y, plane.width, plane.height); })
         {
             HdmiInput::_instance = this;
 
@@ -77,6 +96,9 @@ namespace WPEFramework
             registerMethod(HDMIINPUT_METHOD_START_HDMI_INPUT, &HdmiInput::startHdmiInput, this);
             registerMethod(HDMIINPUT_METHOD_STOP_HDMI_INPUT, &HdmiInput::stopHdmiInput, this);
             registerMethod(HDMIINPUT_METHOD_SCALE_HDMI_INPUT, &HdmiInput::setVideoRectangleWrapper, this);
+            registerMethod(HDMIINPUT_METHOD_SET_GAME_MODE, &HdmiInput::setGameModeWrapper, this, {2});
+            registerMethod(HDMIINPUT_METHOD_GET_GAME_MODE, &HdmiInput::getGameModeWrapper, this, {2});
+            registerMethod(HDMIINPUT_METHOD_GET_INPUT_SWITCH_STATISTICS, &HdmiInput::getInputSwitchStatisticsWrapper, this, {2});
         }
 
         HdmiInput::~HdmiInput()
@@ -128,16 +150,8 @@ namespace WPEFramework
                 returnResponse(false);
             }
 
-            bool success = true;
-            try
-            {
-                device::HdmiInput::getInstance().selectPort(portId);
-            }
-            catch (const device::Exception& err)
-            {
-                LOG_DEVICE_EXCEPTION1(sPortId);
-                success = false;
-            }
+            // Switches in place when another port is presented, no stop needed in between
+            bool success = m_inputSource.start(portId);
             returnResponse(success);
 
         }
@@ -146,16 +160,9 @@ namespace WPEFramework
         {
             LOGINFOMETHOD();
 
-            bool success = true;
-            try
-            {
-                device::HdmiInput::getInstance().selectPort(-1);
-            }
-            catch (const device::Exception& err)
-            {
+            bool success = m_inputSource.stop();
+            if (!success)
                 LOGWARN("HdmiInputService::stopHdmiInput Failed");
-                success = false;
-            }
             returnResponse(success);
 
         }
@@ -209,7 +216,12 @@ namespace WPEFramework
 		    returnResponse(false);
                 }
 
-                result = setVideoRectangle(x, y, w, h);
+                InputSourceManager::Plane plane;
+                plane.x = x;
+                plane.y = y;
+                plane.width = w;
+                plane.height = h;
+                result = m_inputSource.scale(plane);
                 if (false == result) {
                   LOGWARN("HdmiInputService::setVideoRectangle Failed");
                   response["message"] = "failed to set scale";
@@ -236,6 +248,20 @@ namespace WPEFramework
             return ret;
         }
 
+        bool HdmiInput::selectPort(int iPort)
+        {
+            try
+            {
+                device::HdmiInput::getInstance().selectPort(iPort);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(std::to_string(iPort));
+                return false;
+            }
+            return true;
+        }
+
         uint32_t HdmiInput::getHDMIInputDevicesWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
@@ -297,7 +323,7 @@ namespace WPEFramework
             JsonArray list;
             try
             {
-                int num = device::HdmiInput::getInstance().getNumberOfInputs();
+                int num = getNumberOfInputs();
                 if (num > 0) {
                     int i = 0;
                     for (i = 0; i < num; i++) {
@@ -307,7 +333,7 @@ namespace WPEFramework
                         std::stringstream locator;
                         locator << "hdmiin://localhost/deviceid/" << i;
                         hash["locator"] = locator.str();
-                        hash["connected"] = device::HdmiInput::getInstance().isPortConnected(i) ? "true" : "false";
+                        hash["connected"] = isPortConnected(i) ? "true" : "false";
                         LOGWARN("HdmiInputService::getHDMIInputDevices id %d, locator=[%s], connected=[%s]", i, hash["locator"].String().c_str(), hash["connected"].String().c_str());
                         list.Add(hash);
                     }
@@ -332,7 +358,7 @@ namespace WPEFramework
             try
             {
                 vector<uint8_t> edidVec2;
-                device::HdmiInput::getInstance().getEDIDBytesInfo (iPort, edidVec2);
+                getCachedEDID (iPort, edidVec2);
                 edidVec = edidVec2;//edidVec must be "unknown" unless we successfully get to this line
 
                 //convert to base64
@@ -366,6 +392,14 @@ namespace WPEFramework
         {
             LOGWARN("hdmiInputHotplug [%d, %d]", input, connect);
 
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                PortInfo& info = m_portInfo[input];
+                info.connectedValid = true;
+                info.connected = (connect == HDMI_HOT_PLUG_EVENT_CONNECTED);
+            }
+            refreshSourceInfo(input);
+
             JsonObject params;
             params["devices"] = getHDMIInputDevices();
             sendNotify(HDMIINPUT_EVENT_ON_DEVICES_CHANGED, params);
@@ -382,6 +416,12 @@ namespace WPEFramework
         {
             LOGWARN("hdmiInputSignalStatus [%d, %d]", port, signalStatus);
 
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                m_portInfo[port].signalStatus = signalStatus;
+            }
+            refreshSourceInfo(port);
+
             JsonObject params;
             params["id"] = port;
             std::stringstream locator;
@@ -424,6 +464,8 @@ namespace WPEFramework
         {
             LOGWARN("hdmiInputStatus [%d, %d]", port, isPresented);
 
+            refreshSourceInfo(port);
+
             JsonObject params;
             params["id"] = port;
             std::stringstream locator;
@@ -438,6 +480,16 @@ namespace WPEFramework
             }
 
             sendNotify(HDMIINPUT_EVENT_ON_STATUS_CHANGED, params);
+
+            m_inputSource.presented(port, isPresented);
+
+            std::string sourceType = isPresented ? getSourceType(port) : "";
+            {
+                std::lock_guard<std::mutex> lock(m_gameModeMutex);
+                m_presentedPort = isPresented ? port : -1;
+                m_sourceType = sourceType;
+            }
+            updateGameMode();
         }
 
         /**
@@ -451,6 +503,8 @@ namespace WPEFramework
         {
             LOGWARN("hdmiInputVideoModeUpdate [%d]", port);
 
+            refreshSourceInfo(port);
+
             JsonObject params;
             params["id"] = port;
             std::stringstream locator;
@@ -544,6 +598,23 @@ namespace WPEFramework
             }
 
             sendNotify(HDMIINPUT_EVENT_ON_VIDEO_MODE_UPDATED, params);
+
+            // Consoles update their SPD InfoFrame when they switch between menus and games,
+            // which usually comes with a new video mode
+            bool presented = false;
+            {
+                std::lock_guard<std::mutex> lock(m_gameModeMutex);
+                presented = (m_presentedPort == port);
+            }
+            if (presented) {
+                std::string sourceType = getSourceType(port);
+                {
+                    std::lock_guard<std::mutex> lock(m_gameModeMutex);
+                    if (m_presentedPort == port)
+                        m_sourceType = sourceType;
+                }
+                updateGameMode();
+            }
         }
 
         void HdmiInput::dsHdmiEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
@@ -673,7 +744,7 @@ namespace WPEFramework
             {
                 LOGWARN("HdmiInput::getHDMISPDInfo");
                 vector<uint8_t> spdVect2;
-                device::HdmiInput::getInstance().getHDMISPDInfo(iPort, spdVect2);
+                getCachedSPD(iPort, spdVect2);
                 spdVect = spdVect2;//edidVec must be "unknown" unless we successfully get to this line
 
                 //convert to base64
@@ -709,7 +780,7 @@ namespace WPEFramework
             {
                 LOGWARN("HdmiInput::getHDMISPDInfo");
                 vector<uint8_t> spdVect2;
-                device::HdmiInput::getInstance().getHDMISPDInfo(iPort, spdVect2);
+                getCachedSPD(iPort, spdVect2);
                 spdVect = spdVect2;//edidVec must be "unknown" unless we successfully get to this line
 
                 //convert to base64
@@ -785,6 +856,10 @@ namespace WPEFramework
             try
             {
                 device::HdmiInput::getInstance().setEdidVersion (iPort, iEdidVer);
+                {
+                    std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                    m_portInfo[iPort].edidValid = false;
+                }
                 LOGWARN("HdmiInput::setEdidVersion EDID Version:%d", iEdidVer);
             }
             catch (const device::Exception& err)
@@ -844,5 +919,243 @@ namespace WPEFramework
             return edidVersion;
         }
 
+        uint32_t HdmiInput::setGameModeWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            returnIfBooleanParamNotFound(parameters, "enabled");
+
+            bool enabled = parameters["enabled"].Boolean();
+            bool followSource = true;
+            getDefaultBoolParameter("followSource", followSource, true);
+
+            {
+                std::lock_guard<std::mutex> lock(m_gameModeMutex);
+                m_gameModeEnabled = enabled;
+                m_gameModeFollowSource = followSource;
+            }
+            updateGameMode();
+
+            returnResponse(true);
+        }
+
+        uint32_t HdmiInput::getGameModeWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            std::lock_guard<std::mutex> lock(m_gameModeMutex);
+            response["enabled"] = m_gameModeEnabled;
+            response["followSource"] = m_gameModeFollowSource;
+            response["active"] = m_gameModeActive;
+            response["id"] = m_presentedPort;
+            response["sourceType"] = m_sourceType;
+            response["startLatencyMs"] = m_inputSource.lastSwitch().presentMs;
+            returnResponse(true);
+        }
+
+        uint32_t HdmiInput::getInputSwitchStatisticsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            InputSourceManager::Switch last = m_inputSource.lastSwitch();
+            Utils::Metrics::Histogram::Summary summary;
+            m_inputSource.statistics(summary);
+
+            JsonObject lastSwitch;
+            lastSwitch["from"] = last.from;
+            lastSwitch["to"] = last.to;
+            lastSwitch["selectMs"] = last.selectMs;
+            lastSwitch["presentMs"] = last.presentMs;
+            response["lastSwitch"] = lastSwitch;
+            response["switches"] = summary.count;
+            response["p50Ms"] = summary.p50;
+            response["p90Ms"] = summary.p90;
+            response["maxMs"] = summary.max;
+            returnResponse(true);
+        }
+
+        /**
+         * @brief Source type of the device on an HDMI Input port, from the source information of its SPD InfoFrame.
+         *
+         * @param[in] iPort HDMI In port id.
+         * @return One of kSourceTypes, "unknown" if the source sends no SPD InfoFrame.
+         */
+        std::string HdmiInput::getSourceType(int iPort)
+        {
+            std::string sourceType = kSourceTypes[0];
+            try
+            {
+                vector<uint8_t> spdVect;
+                getCachedSPD(iPort, spdVect);
+                if (spdVect.size() >= sizeof(struct dsSpd_infoframe_st)) {
+                    struct dsSpd_infoframe_st spd;
+                    memcpy(&spd, spdVect.data(), sizeof(struct dsSpd_infoframe_st));
+                    if (spd.source_info < sizeof(kSourceTypes) / sizeof(kSourceTypes[0]))
+                        sourceType = kSourceTypes[spd.source_info];
+                }
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(std::to_string(iPort));
+            }
+            return sourceType;
+        }
+
+        /**
+         * @brief Re-evaluates game mode and sends onGameModeChanged if it changed. Game mode is active
+         * while it is enabled and an input is presented whose source reports game content, or any
+         * presented input if followSource is false. The picture quality owner switches to its low
+         * latency processing on the event.
+         */
+        void HdmiInput::updateGameMode()
+        {
+            JsonObject params;
+            {
+                std::lock_guard<std::mutex> lock(m_gameModeMutex);
+                bool active = m_gameModeEnabled && (m_presentedPort >= 0) &&
+                              (!m_gameModeFollowSource || (m_sourceType == "game"));
+                if (active == m_gameModeActive)
+                    return;
+
+                m_gameModeActive = active;
+                if (active)
+                    m_gameModePort = m_presentedPort;
+                params["id"] = m_gameModePort;
+                std::stringstream locator;
+                locator << "hdmiin://localhost/deviceid/" << m_gameModePort;
+                params["locator"] = locator.str();
+                params["active"] = active;
+                params["sourceType"] = m_sourceType;
+            }
+
+            LOGWARN("HDMI Input game mode %s", params["active"].Boolean() ? "active" : "inactive");
+            sendNotify(HDMIINPUT_EVENT_ON_GAME_MODE_CHANGED, params);
+        }
+
+        int HdmiInput::getNumberOfInputs()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                if (m_numberOfInputs >= 0)
+                    return m_numberOfInputs;
+            }
+
+            int num = device::HdmiInput::getInstance().getNumberOfInputs();
+            std::lock_guard<std::mutex> lock(m_portInfoMutex);
+            m_numberOfInputs = num;
+            return num;
+        }
+
+        bool HdmiInput::isPortConnected(int iPort)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                PortInfo& info = m_portInfo[iPort];
+                if (info.connectedValid)
+                    return info.connected;
+            }
+
+            bool connected = device::HdmiInput::getInstance().isPortConnected(iPort);
+            std::lock_guard<std::mutex> lock(m_portInfoMutex);
+            PortInfo& info = m_portInfo[iPort];
+            if (!info.connectedValid) {
+                info.connectedValid = true;
+                info.connected = connected;
+            }
+            return connected;
+        }
+
+        // Throws device::Exception like getEDIDBytesInfo, failures are not cached
+        void HdmiInput::getCachedEDID(int iPort, std::vector<uint8_t>& edid)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                PortInfo& info = m_portInfo[iPort];
+                if (info.edidValid) {
+                    edid = info.edid;
+                    return;
+                }
+            }
+
+            device::HdmiInput::getInstance().getEDIDBytesInfo (iPort, edid);
+            std::lock_guard<std::mutex> lock(m_portInfoMutex);
+            PortInfo& info = m_portInfo[iPort];
+            info.edidValid = true;
+            info.edid = edid;
+        }
+
+        // Throws device::Exception like getHDMISPDInfo, failures are not cached
+        void HdmiInput::getCachedSPD(int iPort, std::vector<uint8_t>& spd)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                PortInfo& info = m_portInfo[iPort];
+                if (info.spdValid) {
+                    spd = info.spd;
+                    return;
+                }
+            }
+
+            device::HdmiInput::getInstance().getHDMISPDInfo(iPort, spd);
+            std::lock_guard<std::mutex> lock(m_portInfoMutex);
+            PortInfo& info = m_portInfo[iPort];
+            info.spdValid = true;
+            info.spd = spd;
+        }
+
+        /**
+         * @brief Re-reads the SPD InfoFrame of a port after a dsMgr event and sends onSourceInfoChanged
+         * if the connection, signal or SPD state of the port changed. Clients can wait for the event
+         * instead of polling getHDMISPD.
+         *
+         * @param[in] iPort HDMI In port id.
+         */
+        void HdmiInput::refreshSourceInfo(int iPort)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                m_portInfo[iPort].spdValid = false;
+            }
+
+            std::vector<uint8_t> spd;
+            bool connected = false;
+            try
+            {
+                connected = isPortConnected(iPort);
+                getCachedSPD(iPort, spd);
+            }
+            catch (const device::Exception& err)
+            {
+                LOG_DEVICE_EXCEPTION1(std::to_string(iPort));
+            }
+
+            JsonObject params;
+            {
+                std::lock_guard<std::mutex> lock(m_portInfoMutex);
+                PortInfo& info = m_portInfo[iPort];
+
+                // FNV-1a over the state clients care about
+                uint32_t value = 2166136261u;
+                auto mix = [&value](uint8_t byte) { value = (value ^ byte) * 16777619u; };
+                mix(connected ? 1 : 0);
+                mix((uint8_t)(info.signalStatus + 1));
+                for (uint8_t byte : spd)
+                    mix(byte);
+
+                char hash[9];
+                snprintf(hash, sizeof(hash), "%08x", value);
+                if (info.hash == hash)
+                    return;
+                info.hash = hash;
+
+                params["id"] = iPort;
+                std::stringstream locator;
+                locator << "hdmiin://localhost/deviceid/" << iPort;
+                params["locator"] = locator.str();
+                params["hash"] = info.hash;
+            }
+
+            sendNotify(HDMIINPUT_EVENT_ON_SOURCE_INFO_CHANGED, params);
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
@@ -24,8 +24,14 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "InputSourceManager.h"
 #include "dsTypes.h"
 
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
 namespace WPEFramework {
 
     namespace Plugin {
@@ -64,6 +70,9 @@ namespace WPEFramework {
             uint32_t stopHdmiInput(const JsonObject& parameters, JsonObject& response);
 
             uint32_t setVideoRectangleWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setGameModeWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getGameModeWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getInputSwitchStatisticsWrapper(const JsonObject& parameters, JsonObject& response);
             //End methods
 
             JsonArray getHDMIInputDevices();
@@ -76,6 +85,16 @@ namespace WPEFramework {
 
 
             bool setVideoRectangle(int x, int y, int width, int height);
+            bool selectPort(int iPort);
+
+            std::string getSourceType(int iPort);
+            void updateGameMode();
+
+            int getNumberOfInputs();
+            bool isPortConnected(int iPort);
+            void getCachedEDID(int iPort, std::vector<uint8_t>& edid);
+            void getCachedSPD(int iPort, std::vector<uint8_t>& spd);
+            void refreshSourceInfo(int iPort);
 
             void hdmiInputHotplug( int input , int connect);
             static void dsHdmiEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
@@ -96,6 +115,34 @@ namespace WPEFramework {
 
             void terminate();
 
+        private:
+            // Per port state from devicesettings, kept until the dsMgr events report a change
+            struct PortInfo
+            {
+                bool connectedValid = false;
+                bool connected = false;
+                int signalStatus = -1;
+                bool edidValid = false;
+                std::vector<uint8_t> edid;
+                bool spdValid = false;
+                std::vector<uint8_t> spd;
+                std::string hash;
+            };
+            std::mutex m_portInfoMutex;
+            std::map<int, PortInfo> m_portInfo;
+            int m_numberOfInputs;
+
+            // Game mode follows the presented port and the source type from its SPD InfoFrame
+            std::mutex m_gameModeMutex;
+            bool m_gameModeEnabled;
+            bool m_gameModeFollowSource;
+            bool m_gameModeActive;
+            int m_gameModePort;
+            int m_presentedPort;
+            std::string m_sourceType;
+
+            InputSourceManager m_inputSource;
+
         public:
             static HdmiInput* _instance;
         };
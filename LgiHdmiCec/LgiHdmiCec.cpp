@@ -119,7 +119,6 @@ namespace WPEFramework
 
         LgiHdmiCec* LgiHdmiCec::_instance = nullptr;
 
-        static std::atomic<int> libcecInitStatus{0};
 
         LgiHdmiCec::LgiHdmiCec()
         : AbstractPluginWithApiAndIARMLock(),
@@ -648,22 +647,7 @@ namespace WPEFramework
                 return;
             }
 
-            if(0 == libcecInitStatus)
-            {
-                try
-                {
-                    LibCCEC::getInstance().init();
-                }
-                catch (const std::exception e)
-                {
-                    LOGWARN("CEC exception caught from CECEnable");
-                }
-            }
-            libcecInitStatus++;
-
-            smConnection = new Connection(LogicalAddress::UNREGISTERED,false,"ServiceManager::Connection::");
-            smConnection->open();
-            smConnection->addFrameListener(this);
+            smConnection = CecCore::getInstance().acquire(this);
 
             //Acquire CEC Addresses
             getPhysicalAddress();
@@ -694,22 +678,11 @@ namespace WPEFramework
 
             if (smConnection != NULL)
             {
-                smConnection->close();
-                delete smConnection;
+                CecCore::getInstance().release(this);
                 smConnection = NULL;
             }
             cecEnableStatus = false;
 
-            if(1 == libcecInitStatus)
-            {
-                LibCCEC::getInstance().term();
-            }
-
-            if(libcecInitStatus > 0)
-            {
-                libcecInitStatus--;
-            }
-
             return;
         }
 
@@ -903,7 +876,7 @@ namespace WPEFramework
                 CECFrame frame = CECFrame((const uint8_t *)buf.data(), decodedLen);
         //      SVCLOG_WARN("Frame to be sent from servicemanager in %s \n",__FUNCTION__);
         //      frame.hexDump();
-                smConnection->sendAsync(frame);
+                CecCore::getInstance().sendAsync(frame);
             }
             else
                 LOGWARN("cecEnableStatus=false");
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include "ccec/FrameListener.hpp"
 #include "ccec/Connection.hpp"
+#include "CecCore.h"
 
 #include "libIBus.h"
 
@@ -406,6 +406,21 @@ namespace Plugin {
         return (result);
     }
 
+    void LocationService::Restore(const string& ip, const string& timeZone, const string& country, const string& region, const string& city)
+    {
+        _adminLock.Lock();
+
+        if (_state == IDLE) {
+            _publicIPAddress = ip;
+            _timeZone = timeZone;
+            _country = country;
+            _region = region;
+            _city = city;
+        }
+
+        _adminLock.Unlock();
+    }
+
     void LocationService::Stop()
     {
         _adminLock.Lock();
@@ -68,6 +68,19 @@ namespace Plugin {
         uint32_t Probe(const string& remoteNode, const uint32_t retries, const uint32_t retryTimeSpan);
         void Stop();
 
+        // The last probe found the location
+        bool Loaded() const
+        {
+            _adminLock.Lock();
+            bool result = (_state == LOADED);
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        // Location known from an earlier run, served until a probe replaces it.
+        void Restore(const string& ip, const string& timeZone, const string& country, const string& region, const string& city);
+
         /*
         * ------------------------------------------------------------------------------------------------------------
         * ISubSystem::INetwork methods
@@ -116,7 +129,7 @@ namespace Plugin {
         void Dispatch();
 
     private:
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         state _state;
         string _remoteId;
         Core::NodeId _sourceNode;
@@ -19,6 +19,8 @@
  
 #include "LocationSync.h"
 
+#include <algorithm>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -32,7 +34,10 @@ namespace Plugin {
 #endif
     LocationSync::LocationSync()
         : _skipURL(0)
-        , _source()
+        , _sources()
+        , _cacheFile()
+        , _published()
+        , _provisional(false)
         , _sink(this)
         , _service(nullptr)
     {
@@ -54,12 +59,44 @@ namespace Plugin {
         config.FromString(service->ConfigLine());
         string version = service->Version();
 
-        if (LocationService::IsSupported(config.Source.Value()) == Core::ERROR_NONE) {
+        Core::JSON::ArrayType<Core::JSON::String>::Iterator index(config.Sources.Elements());
+        std::list<string> sources;
+
+        while (index.Next() == true) {
+            sources.push_back(index.Current().Value());
+        }
+        if ((config.Source.IsSet() == true) && (std::find(sources.begin(), sources.end(), config.Source.Value()) == sources.end())) {
+            sources.push_back(config.Source.Value());
+        }
+        for (const string& source : sources) {
+            if (LocationService::IsSupported(source) == Core::ERROR_NONE) {
+                _sources.push_back(source);
+            } else {
+                TRACE(Trace::Warning, (_T("Ignoring the unsupported location source %s"), source.c_str()));
+            }
+        }
+
+        if (_sources.empty() == false) {
             _skipURL = static_cast<uint16_t>(service->WebPrefix().length());
-            _source = config.Source.Value();
             _service = service;
 
-            _sink.Initialize(config.Source.Value(), config.Interval.Value(), config.Retries.Value());
+            if (config.Cache.Value() == true) {
+                Core::Directory(service->PersistentPath().c_str()).CreatePath();
+                _cacheFile = service->PersistentPath() + _T("location.json");
+            }
+
+            _sink.Initialize(_sources, config.Interval.Value(), config.Retries.Value(), (_cacheFile.empty() == true ? string() : service->PersistentPath() + _T("providers.json")));
+
+            // Publish what was found last time right away, the probe only revalidates it.
+            if (LoadLocation() == true) {
+                TRACE(Trace::Information, (_T("Provisional location: %s, %s"), _published.PublicIp.Value().c_str(), _published.TimeZone.Value().c_str()));
+
+                _sink.Restore(_published);
+                Publish();
+                _provisional = true;
+            }
+
+            _sink.Probe(config.Retries.Value(), config.Interval.Value());
         } else {
             result = _T("URL for retrieving location is incorrect !!!");
         }
@@ -77,8 +114,7 @@ namespace Plugin {
 
     string LocationSync::Information() const /* override */
     {
-        // No additional info to report.
-        return (string());
+        return (_sink.Information());
     }
 
     void LocationSync::Inbound(Web::Request& /* request */) /* override */
@@ -124,8 +160,8 @@ namespace Plugin {
         } else if (request.Verb == Web::Request::HTTP_POST) {
             index.Next();
             if (index.Next()) {
-                if ((index.Current() == "Sync") && (_source.empty() == false)) {
-                    uint32_t error = _sink.Probe(_source, 1, 1);
+                if ((index.Current() == "Sync") && (_sources.empty() == false)) {
+                    uint32_t error = _sink.Probe(1, 1);
 
                     if (error != Core::ERROR_NONE) {
                         result->ErrorCode = Web::STATUS_INTERNAL_SERVER_ERROR;
@@ -142,6 +178,39 @@ namespace Plugin {
     }
 
     void LocationSync::SyncedLocation()
+    {
+        PluginHost::ISubSystem::IInternet* internet(_sink.Network());
+        PluginHost::ISubSystem::ILocation* location(_sink.Location());
+
+        ASSERT((internet != nullptr) && (location != nullptr));
+
+        if ((_provisional == true)
+            && (internet->PublicIPAddress() == _published.PublicIp.Value())
+            && (location->TimeZone() == _published.TimeZone.Value())
+            && (location->Country() == _published.Country.Value())
+            && (location->Region() == _published.Region.Value())
+            && (location->City() == _published.City.Value())) {
+
+            // Nothing changed since the provisional location was published, nobody needs to know.
+            TRACE(Trace::Information, (_T("Location unchanged since the provisional one was published")));
+        } else {
+            Publish();
+
+            if (location->TimeZone().empty() == false) {
+                _published.PublicIp = internet->PublicIPAddress();
+                _published.TimeZone = location->TimeZone();
+                _published.Country = location->Country();
+                _published.Region = location->Region();
+                _published.City = location->City();
+
+                SaveLocation();
+            }
+        }
+
+        _provisional = false;
+    }
+
+    void LocationSync::Publish()
     {
         PluginHost::ISubSystem* subSystem = _service->SubSystems();
 
@@ -160,5 +229,281 @@ namespace Plugin {
         }
     }
 
+    void LocationSync::Provider::Dispatch() /* override */
+    {
+        _parent.Finished(*this);
+    }
+
+    void LocationSync::Notification::Initialize(const std::list<string>& sources, const uint16_t interval, const uint8_t retries, const string& statisticsFile)
+    {
+        _interval = interval;
+        _retries = retries;
+        _statisticsFile = statisticsFile;
+
+        for (const string& source : sources) {
+            _providers.emplace_back(*this, source);
+        }
+
+        LoadStatistics();
+
+        _adminLock.Lock();
+        Rank();
+        _adminLock.Unlock();
+    }
+
+    void LocationSync::Notification::Deinitialize()
+    {
+        for (Provider& provider : _providers) {
+            provider.Locator()->Stop();
+        }
+    }
+
+    uint32_t LocationSync::Notification::Probe(const uint32_t retries, const uint32_t retryTimeSpan)
+    {
+        _interval = retryTimeSpan;
+        _retries = retries;
+
+        return (Probe());
+    }
+
+    uint32_t LocationSync::Notification::Probe()
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        _adminLock.Lock();
+
+        _winner = nullptr;
+        Rank();
+
+        // The preferred source goes out first
+        std::list<Provider*> order;
+        for (Provider& provider : _providers) {
+            if (&provider == _preferred) {
+                order.push_front(&provider);
+            } else {
+                order.push_back(&provider);
+            }
+        }
+
+        for (Provider* provider : order) {
+            uint32_t status = provider->Locator()->Probe(provider->Source, _retries, _interval);
+
+            if (status == Core::ERROR_NONE) {
+                provider->Active = true;
+                provider->Started = Core::Time::Now().Ticks();
+                result = Core::ERROR_NONE;
+            } else {
+                TRACE(Trace::Warning, (_T("Probe of %s not started, error code: %d"), provider->Source.c_str(), status));
+                if (result != Core::ERROR_NONE) {
+                    result = status;
+                }
+            }
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    void LocationSync::Notification::Finished(Provider& provider)
+    {
+        std::list<Provider*> cancelled;
+        bool report = false;
+
+        _adminLock.Lock();
+
+        if (provider.Active == true) {
+            provider.Active = false;
+
+            if (provider.Locator()->Loaded() == true) {
+                uint32_t latency = static_cast<uint32_t>((Core::Time::Now().Ticks() - provider.Started) / Core::Time::TicksPerMillisecond);
+
+                provider.Latency = (provider.Successes == 0 ? latency : ((3 * provider.Latency) + latency) / 4);
+                provider.Successes++;
+
+                if (_winner == nullptr) {
+                    TRACE(Trace::Information, (_T("Location from %s after %d mS"), provider.Source.c_str(), latency));
+
+                    _winner = &provider;
+                    report = true;
+
+                    for (Provider& other : _providers) {
+                        if (other.Active == true) {
+                            other.Active = false;
+                            cancelled.push_back(&other);
+                        }
+                    }
+                }
+            } else {
+                provider.Failures++;
+
+                bool pending = false;
+                for (const Provider& other : _providers) {
+                    pending = pending || other.Active;
+                }
+                // None of the sources found the location
+                report = (pending == false) && (_winner == nullptr);
+            }
+
+            SaveStatistics();
+        }
+
+        _adminLock.Unlock();
+
+        // Not holding the lock, a locator calls its Finished holding its own.
+        for (Provider* other : cancelled) {
+            other->Locator()->Stop();
+        }
+
+        if (report == true) {
+            _parent.SyncedLocation();
+        }
+    }
+
+    // Caller holds _adminLock
+    void LocationSync::Notification::Rank()
+    {
+        _preferred = nullptr;
+
+        for (Provider& provider : _providers) {
+            if ((_preferred == nullptr) || (provider.Before(*_preferred) == true)) {
+                _preferred = &provider;
+            }
+        }
+    }
+
+    LocationService* LocationSync::Notification::Current() const
+    {
+        LocationService* result = nullptr;
+
+        _adminLock.Lock();
+
+        if (_winner != nullptr) {
+            result = _winner->Locator();
+        } else if (_preferred != nullptr) {
+            result = _preferred->Locator();
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    string LocationSync::Notification::Information() const
+    {
+        Statistics statistics;
+        string result;
+
+        _adminLock.Lock();
+
+        Fill(statistics);
+
+        _adminLock.Unlock();
+
+        statistics.ToString(result);
+
+        return (result);
+    }
+
+    // Caller holds _adminLock
+    void LocationSync::Notification::Fill(Statistics& statistics) const
+    {
+        for (const Provider& provider : _providers) {
+            ProviderStatistics& entry(statistics.Providers.Add());
+            entry.Source = provider.Source;
+            entry.Successes = provider.Successes;
+            entry.Failures = provider.Failures;
+            entry.Latency = provider.Latency;
+        }
+    }
+
+    void LocationSync::Notification::LoadStatistics()
+    {
+        if (_statisticsFile.empty() == false) {
+            Core::File file(_statisticsFile);
+
+            if (file.Open(true) == true) {
+                Statistics statistics;
+                Core::OptionalType<Core::JSON::Error> error;
+                statistics.IElement::FromFile(file, error);
+                file.Close();
+
+                if (error.IsSet() == true) {
+                    TRACE(Trace::Warning, (_T("Ignoring the source statistics in %s: %s"), _statisticsFile.c_str(), ErrorDisplayMessage(error.Value()).c_str()));
+                } else {
+                    Core::JSON::ArrayType<ProviderStatistics>::Iterator index(statistics.Providers.Elements());
+
+                    while (index.Next() == true) {
+                        for (Provider& provider : _providers) {
+                            if (provider.Source == index.Current().Source.Value()) {
+                                provider.Successes = index.Current().Successes.Value();
+                                provider.Failures = index.Current().Failures.Value();
+                                provider.Latency = index.Current().Latency.Value();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Caller holds _adminLock
+    void LocationSync::Notification::SaveStatistics() const
+    {
+        if (_statisticsFile.empty() == false) {
+            Statistics statistics;
+
+            Fill(statistics);
+
+            Core::File file(_statisticsFile);
+
+            if (file.Create() == true) {
+                statistics.IElement::ToFile(file);
+                file.Close();
+            } else {
+                TRACE(Trace::Warning, (_T("Could not store the source statistics in %s"), _statisticsFile.c_str()));
+            }
+        }
+    }
+
+    bool LocationSync::LoadLocation()
+    {
+        bool result = false;
+
+        if (_cacheFile.empty() == false) {
+            Core::File file(_cacheFile);
+
+            if (file.Open(true) == true) {
+                Core::OptionalType<Core::JSON::Error> error;
+                _published.IElement::FromFile(file, error);
+
+                if (error.IsSet() == true) {
+                    TRACE(Trace::Warning, (_T("Ignoring the stored location in %s: %s"), _cacheFile.c_str(), ErrorDisplayMessage(error.Value()).c_str()));
+                    _published.Clear();
+                } else {
+                    result = (_published.PublicIp.Value().empty() == false) && (_published.TimeZone.Value().empty() == false);
+                }
+
+                file.Close();
+            }
+        }
+
+        return (result);
+    }
+
+    void LocationSync::SaveLocation() const
+    {
+        if (_cacheFile.empty() == false) {
+            Core::File file(_cacheFile);
+
+            if (file.Create() == true) {
+                _published.IElement::ToFile(file);
+                file.Close();
+            } else {
+                TRACE(Trace::Warning, (_T("Could not store the location in %s"), _cacheFile.c_str()));
+            }
+        }
+    }
+
 } // namespace Plugin
 } // namespace WPEFramework
@@ -45,8 +45,8 @@ namespace Plugin {
                 Add(_T("ip"), &PublicIp);
                 Add(_T("timezone"), &TimeZone);
                 Add(_T("region"), &Region);
-                Add(_T("country"), &Region);
-                Add(_T("city"), &Region);
+                Add(_T("country"), &Country);
+                Add(_T("city"), &City);
             }
 
             ~Data() override
@@ -61,84 +61,202 @@ namespace Plugin {
             Core::JSON::String City;
         };
 
+        // Per source: answers, failures and the smoothed time to an answer, kept across restarts
+        class ProviderStatistics : public Core::JSON::Container {
+        public:
+            ProviderStatistics()
+                : Core::JSON::Container()
+                , Source()
+                , Successes()
+                , Failures()
+                , Latency()
+            {
+                Init();
+            }
+            ProviderStatistics(const ProviderStatistics& copy)
+                : Core::JSON::Container()
+                , Source(copy.Source)
+                , Successes(copy.Successes)
+                , Failures(copy.Failures)
+                , Latency(copy.Latency)
+            {
+                Init();
+            }
+            ProviderStatistics& operator=(const ProviderStatistics& rhs)
+            {
+                Source = rhs.Source;
+                Successes = rhs.Successes;
+                Failures = rhs.Failures;
+                Latency = rhs.Latency;
+                return (*this);
+            }
+            ~ProviderStatistics() override
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("source"), &Source);
+                Add(_T("successes"), &Successes);
+                Add(_T("failures"), &Failures);
+                Add(_T("latency"), &Latency);
+            }
+
+        public:
+            Core::JSON::String Source;
+            Core::JSON::DecUInt32 Successes;
+            Core::JSON::DecUInt32 Failures;
+            Core::JSON::DecUInt32 Latency; // mS
+        };
+
+        class Statistics : public Core::JSON::Container {
+        public:
+            Statistics(const Statistics&) = delete;
+            Statistics& operator=(const Statistics&) = delete;
+
+            Statistics()
+                : Core::JSON::Container()
+                , Providers()
+            {
+                Add(_T("providers"), &Providers);
+            }
+            ~Statistics() override
+            {
+            }
+
+        public:
+            Core::JSON::ArrayType<ProviderStatistics> Providers;
+        };
+
     private:
-        class Notification : public Core::IDispatch {
+        class Notification;
+
+        // One configured source with its own locator, so that the sources can be probed at the same time.
+        class Provider : public Core::IDispatch {
         private:
-            Notification() = delete;
-            Notification(const Notification&) = delete;
-            Notification& operator=(const Notification&) = delete;
+            Provider() = delete;
+            Provider(const Provider&) = delete;
+            Provider& operator=(const Provider&) = delete;
 
         public:
 #ifdef __WINDOWS__
 #pragma warning(disable : 4355)
 #endif
-            explicit Notification(LocationSync* parent)
-                : _parent(*parent)
-                , _source()
-                , _interval()
-                , _retries()
+            Provider(Notification& parent, const string& source)
+                : _parent(parent)
                 , _locator(Core::Service<LocationService>::Create<LocationService>(this))
+                , Source(source)
+                , Active(false)
+                , Started(0)
+                , Successes(0)
+                , Failures(0)
+                , Latency(0)
             {
-                ASSERT(parent != nullptr);
             }
 #ifdef __WINDOWS__
 #pragma warning(default : 4355)
 #endif
-            ~Notification()
+            ~Provider() override
             {
                 _locator->Release();
             }
 
         public:
-            inline void Initialize(const string& source, const uint16_t interval, const uint8_t retries)
+            inline LocationService* Locator() const
+            {
+                return (_locator);
+            }
+            // Ranking of the sources, the ones answering most reliably and then fastest first
+            inline bool Before(const Provider& other) const
             {
-                _source = source;
-                _interval = interval;
-                _retries = retries;
+                uint64_t mine = static_cast<uint64_t>(Successes + 1) * (other.Successes + other.Failures + 1);
+                uint64_t theirs = static_cast<uint64_t>(other.Successes + 1) * (Successes + Failures + 1);
 
-                Probe();
+                return ((mine > theirs) || ((mine == theirs) && (Latency < other.Latency)));
             }
-            inline void Deinitialize()
+
+            void Dispatch() override;
+
+        private:
+            Notification& _parent;
+            LocationService* _locator;
+
+        public:
+            const string Source;
+            bool Active; // probe running, guarded by the lock of the Notification
+            uint64_t Started;
+            uint32_t Successes;
+            uint32_t Failures;
+            uint32_t Latency; // mS, smoothed
+        };
+
+        // Probes all sources at the same time. The first location found is published, the probes of the
+        // other sources are stopped. The preferred source, the best ranked one, serves the location until then.
+        class Notification {
+        private:
+            Notification() = delete;
+            Notification(const Notification&) = delete;
+            Notification& operator=(const Notification&) = delete;
+
+        public:
+            explicit Notification(LocationSync* parent)
+                : _parent(*parent)
+                , _adminLock()
+                , _providers()
+                , _interval()
+                , _retries()
+                , _preferred(nullptr)
+                , _winner(nullptr)
+                , _statisticsFile()
             {
+                ASSERT(parent != nullptr);
             }
-            uint32_t Probe(const string& remoteNode, const uint32_t retries, const uint32_t retryTimeSpan)
+            ~Notification()
             {
-                _source = remoteNode;
-                _interval = retryTimeSpan;
-                _retries = retries;
-
-                return (Probe());
             }
 
+        public:
+            void Initialize(const std::list<string>& sources, const uint16_t interval, const uint8_t retries, const string& statisticsFile);
+            void Deinitialize();
+            uint32_t Probe(const uint32_t retries, const uint32_t retryTimeSpan);
+            void Finished(Provider& provider);
+            string Information() const;
+
             inline PluginHost::ISubSystem::ILocation* Location()
             {
-                return (_locator);
+                return (Current());
             }
             inline PluginHost::ISubSystem::IInternet* Network()
             {
-                return (_locator);
+                return (Current());
             }
-
-        private:
-            inline uint32_t Probe()
+            inline void Restore(const Data& data)
             {
+                LocationService* locator(Current());
 
-                ASSERT(_locator != nullptr);
+                ASSERT(locator != nullptr);
 
-                return (_locator != nullptr ? _locator->Probe(_source, _retries, _interval) : static_cast<uint32_t>(Core::ERROR_UNAVAILABLE));
+                locator->Restore(data.PublicIp.Value(), data.TimeZone.Value(), data.Country.Value(), data.Region.Value(), data.City.Value());
             }
 
-            void Dispatch() override
-            {
-                _parent.SyncedLocation();
-            }
+        private:
+            uint32_t Probe();
+            void Rank();
+            LocationService* Current() const;
+            void Fill(Statistics& statistics) const;
+            void LoadStatistics();
+            void SaveStatistics() const;
 
         private:
             LocationSync& _parent;
-            string _source;
+            mutable Core::CriticalSection _adminLock;
+            std::list<Core::Sink<Provider>> _providers;
             uint16_t _interval;
             uint8_t _retries;
-            LocationService* _locator;
+            Provider* _preferred;
+            Provider* _winner; // of the last probe
+            string _statisticsFile;
         };
 
         class Config : public Core::JSON::Container {
@@ -151,10 +269,14 @@ namespace Plugin {
                 : Interval(30)
                 , Retries(8)
                 , Source()
+                , Sources()
+                , Cache(true)
             {
                 Add(_T("interval"), &Interval);
                 Add(_T("retries"), &Retries);
                 Add(_T("source"), &Source);
+                Add(_T("sources"), &Sources);
+                Add(_T("cache"), &Cache);
             }
             ~Config()
             {
@@ -164,6 +286,8 @@ namespace Plugin {
             Core::JSON::DecUInt16 Interval;
             Core::JSON::DecUInt8 Retries;
             Core::JSON::String Source;
+            Core::JSON::ArrayType<Core::JSON::String> Sources; // probed at the same time, source is added to them
+            Core::JSON::Boolean Cache; // publish the last location found at startup, until it is probed again
         };
 
     private:
@@ -201,11 +325,17 @@ namespace Plugin {
         void event_locationchange();
 
         void SyncedLocation();
+        void Publish();
+        bool LoadLocation();
+        void SaveLocation() const;
 
     private:
         uint16_t _skipURL;
-        string _source;
-        Core::Sink<Notification> _sink;
+        std::list<string> _sources;
+        string _cacheFile;
+        Data _published;
+        bool _provisional;
+        Notification _sink;
         PluginHost::IShell* _service;
     };
 
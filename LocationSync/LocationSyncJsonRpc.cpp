@@ -56,8 +56,8 @@ namespace Plugin {
     {
         uint32_t result = Core::ERROR_NONE;
 
-        if (_source.empty() == false) {
-            result = _sink.Probe(_source, 1, 1);
+        if (_sources.empty() == false) {
+            result = _sink.Probe(1, 1);
         } else {
             result = Core::ERROR_GENERAL;
         }
@@ -20,6 +20,8 @@
 #include "LoggingPreferences.h"
 #include <sysMgr.h>
 
+#define SETTING_KEYSTROKE_MASK_ENABLED "keystrokeMaskEnabled"
+
 using namespace std;
 
 namespace WPEFramework {
@@ -47,11 +49,13 @@ namespace WPEFramework {
         const string LoggingPreferences::Initialize(PluginHost::IShell* /* service */)
         {
             InitializeIARM();
+            m_settings.reset(new SettingsStore("LoggingPreferences"));
             return "";
         }
 
         void LoggingPreferences::Deinitialize(PluginHost::IShell* /* service */)
         {
+            m_settings.reset();
             DeinitializeIARM();
             LoggingPreferences::_instance = nullptr;
         }
@@ -70,6 +74,13 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
 
+            bool enabled = false;
+            if (m_settings->getBool(SETTING_KEYSTROKE_MASK_ENABLED, enabled))
+            {
+                response["keystrokeMaskEnabled"] = enabled;
+                returnResponse(true);
+            }
+
             IARM_BUS_SYSMGR_KEYCodeLoggingInfo_Param_t param;
             IARM_Result_t res = IARM_Bus_Call(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_API_GetKeyCodeLoggingPref, (void *)&param, sizeof(param));
             if(res != IARM_RESULT_SUCCESS)
@@ -78,6 +89,7 @@ namespace WPEFramework {
                 returnResponse(false);
             }
 
+            m_settings->setBool(SETTING_KEYSTROKE_MASK_ENABLED, !param.logStatus);
             response["keystrokeMaskEnabled"] = !param.logStatus;
             returnResponse(true);
         }
@@ -86,6 +98,15 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             returnIfBooleanParamNotFound(parameters, "keystrokeMaskEnabled");
 
+            bool enabled = parameters["keystrokeMaskEnabled"].Boolean();
+
+            bool current = false;
+            if (m_settings->getBool(SETTING_KEYSTROKE_MASK_ENABLED, current) && current == enabled)
+            {
+                LOGWARN("Keystroke mask already %s", enabled ? "enabled" : "disabled");
+                returnResponse(true);
+            }
+
             IARM_BUS_SYSMGR_KEYCodeLoggingInfo_Param_t params;
             IARM_Result_t res = IARM_Bus_Call(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_API_GetKeyCodeLoggingPref, (void *)&params, sizeof(params));
             if (res != IARM_RESULT_SUCCESS)
@@ -94,8 +115,6 @@ namespace WPEFramework {
                 returnResponse(false);
             }
 
-            bool enabled = parameters["keystrokeMaskEnabled"].Boolean();
-
             if (enabled == params.logStatus)
             {
                 params = { enabled ? 0 : 1 };
@@ -106,10 +125,12 @@ namespace WPEFramework {
                     returnResponse(false);
                 }
 
+                m_settings->setBool(SETTING_KEYSTROKE_MASK_ENABLED, enabled);
                 onKeystrokeMaskEnabledChange(enabled);
             }
             else
             {
+                m_settings->setBool(SETTING_KEYSTROKE_MASK_ENABLED, enabled);
                 LOGWARN("Keystroke mask already %s", enabled ? "enabled" : "disabled");
             }
 
@@ -25,6 +25,9 @@
 
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "SettingsStore.h"
+
+#include <memory>
 
 namespace WPEFramework {
 
@@ -57,6 +60,9 @@ namespace WPEFramework {
             void InitializeIARM();
             void DeinitializeIARM();
 
+            // Mirror of the SysMgr key code logging preference, SysMgr is only asked while it holds no value
+            std::unique_ptr<SettingsStore> m_settings;
+
         public:
             static LoggingPreferences* _instance;
 
@@ -36,6 +36,7 @@
 #include <iomanip>
 #include <bits/stdc++.h>
 #include <algorithm>
+#include <sys/stat.h>
 
 #include "MaintenanceManager.h"
 #include "utils.h"
@@ -70,6 +71,43 @@ using namespace std;
 #define TR181_AUTOREBOOT_ENABLE "Device.DeviceInfo.X_RDKCENTRAL-COM_RFC.Feature.AutoReboot.Enable"
 #define TR181_STOP_MAINTENANCE  "Device.DeviceInfo.X_RDKCENTRAL-COM_RFC.Feature.StopMaintenance.Enable"
 
+string throttleLevelToString(Maint_throttle_level_t level)
+{
+    switch(level){
+        case THROTTLE_NONE:
+            return "NONE";
+        case THROTTLE_LIGHT:
+            return "LIGHT";
+        case THROTTLE_HEAVY:
+            return "HEAVY";
+    }
+    return "NONE";
+}
+
+/* cgroup v2 cpu.weight and io.weight, v1 cpu.shares and blkio.weight per throttle level */
+static const struct {
+    int cpuWeight;
+    int ioWeight;
+    int cpuShares;
+    int blkioWeight;
+} throttleWeights[] = {
+    { 100, 100, 1024, 500 },    /* THROTTLE_NONE: as any other process */
+    { 50, 50, 512, 250 },       /* THROTTLE_LIGHT */
+    { 10, 10, 102, 50 }         /* THROTTLE_HEAVY */
+};
+
+static bool writeCgroupFile(const string& path, const string& value)
+{
+    std::ofstream file(path);
+    file << value;
+    file.close();
+    if (!file){
+        LOGERR("Failed to write '%s' to %s", value.c_str(), path.c_str());
+        return false;
+    }
+    return true;
+}
+
 string notifyStatusToString(Maint_notify_status_t &status)
 {
     string ret_status="";
@@ -177,8 +215,6 @@ namespace WPEFramework {
             "/lib/rdk/Start_uploadSTBLogs.sh"
         };
 
-        vector<string> tasks;
-
         string script_names[]={
             "DCMscript_maintaince.sh",
             "RFCbase.sh",
@@ -191,6 +227,20 @@ namespace WPEFramework {
          */
         MaintenanceManager::MaintenanceManager()
             :AbstractPlugin()
+            , m_taskBudget(MAINTENANCE_TASK_BUDGET)
+            , m_userIdleTime(MAINTENANCE_USER_IDLE_SEC)
+            , m_maxDeferTime(MAINTENANCE_MAX_DEFER_SEC)
+            , m_lastUserActivity(0)
+            , m_throttleEnabled(false)
+            , m_activeBandwidth(MAINTENANCE_ACTIVE_BANDWIDTH)
+            , m_playbackBandwidth(MAINTENANCE_PLAYBACK_BANDWIDTH)
+            , m_throttleLevel(THROTTLE_NONE)
+            , m_userInactive(false)
+            , m_playing(false)
+            , m_poweredOn(true)
+            , m_cgroupV2(false)
+            , m_rdkShellSubscribed(false)
+            , m_mediaPlayerSubscribed(false)
         {
             MaintenanceManager::_instance = this;
 
@@ -217,14 +267,8 @@ namespace WPEFramework {
          }
 
         void MaintenanceManager::task_execution_thread(){
-            uint8_t i=0;
-            string cmd="";
             bool internetConnectStatus=false;
-
-            /* cleanup if not empty */
-            if(!tasks.empty()){
-                tasks.erase (tasks.begin(),tasks.end());
-            }
+            bool addTasks=false;
 
             /* Controlled by CFLAGS */
 #if defined(SUPPRESS_MAINTENANCE)
@@ -246,6 +290,10 @@ namespace WPEFramework {
 #endif
             LOGINFO("Reboot_Pending :%s",g_is_reboot_pending.c_str());
 
+            /* RDKShell and the media player may have come up since the last maintenance */
+            subscribeActivityEvents();
+            updateThrottle();
+
             MaintenanceManager::_instance->onMaintenanceStatusChange(MAINTENANCE_STARTED);
 #if defined(SUPPRESS_MAINTENANCE)
             /* decide which all tasks are needed based on the activation status */
@@ -254,63 +302,31 @@ namespace WPEFramework {
                     /* set the task status of swupdate */
                     SET_STATUS(g_task_status,DIFD_SUCCESS);
                     SET_STATUS(g_task_status,DIFD_COMPLETE);
-
-                    /* Add tasks */
-                    tasks.push_back("/lib/rdk/RFCbase.sh");
-                    tasks.push_back("/lib/rdk/Start_uploadSTBLogs.sh");
-                }else{
-                    tasks.push_back("/lib/rdk/RFCbase.sh");
-                    tasks.push_back("/lib/rdk/swupdate_utility.sh >> /opt/logs/swupdate.log");
-                    tasks.push_back("/lib/rdk/Start_uploadSTBLogs.sh");
                 }
+                addTasks=true;
             }
 #else
-            tasks.push_back("/lib/rdk/RFCbase.sh");
-            tasks.push_back("/lib/rdk/swupdate_utility.sh >> /opt/logs/swupdate.log");
-            tasks.push_back("/lib/rdk/Start_uploadSTBLogs.sh");
+            addTasks=true;
 #endif
+            /* DCM is started on boot up (and is complete already in a solicited maintenance).
+             * RFC may change what the firmware update does, so that waits for it. The log
+             * upload only needs the DCM settings and overlaps with both */
+            std::vector<MaintenanceTask> tasks;
+            if (addTasks){
+                tasks.push_back({ "/lib/rdk/StartDCM_maintaince.sh", DCM_COMPLETE, {}, 0, true, false });
+                tasks.push_back({ task_names_foreground[0], RFC_COMPLETE, { 0 }, 1, false, false });
+                tasks.push_back({ task_names_foreground[1], DIFD_COMPLETE, { 1 }, 2, false, false });
+                tasks.push_back({ task_names_foreground[2], LOGUPLOAD_COMPLETE, { 0 }, 1, false, false });
+            }
+
             std::unique_lock<std::mutex> lck(m_callMutex);
 
-            // Unsolicited part comes here
-            if (UNSOLICITED_MAINTENANCE == g_maintenance_type && internetConnectStatus){
-                LOGINFO("---------------UNSOLICITED_MAINTENANCE--------------");
-                for( i = 0; i < tasks.size(); i++) {
-                    LOGINFO("waiting to unlock.. [%d/%d]",i,tasks.size());
-                    task_thread.wait(lck);
-                    cmd = tasks[i];
-                    cmd += " &";
-                    cmd += "\0";
-                    m_task_map[tasks[i]] = true;
-
-                    if ( !m_abort_flag ){
-                        LOGINFO("Starting Script (USM) :  %s \n", cmd.c_str());
-                        system(cmd.c_str());
-                    }
-                }
-            }
-            /* Here in Solicited, we start with RFC so no
-             * need to wait for any DCM events */
-            else if( SOLICITED_MAINTENANCE == g_maintenance_type && internetConnectStatus){
-                LOGINFO("=============SOLICITED_MAINTENANCE===============");
-                cmd = tasks[0];
-                cmd += " &";
-                cmd += "\0";
-                m_task_map[tasks[0]] = true;
-                LOGINFO("Starting Script (SM) :  %s \n", cmd.c_str());
-                system(cmd.c_str());
-                cmd="";
-                for( i = 1; i < tasks.size(); i++){
-                    LOGINFO("Waiting to unlock.. [%d/%d]",i,tasks.size());
-                    task_thread.wait(lck);
-                    cmd = tasks[i];
-                    cmd += " &";
-                    cmd += "\0";
-                    m_task_map[tasks[i]]=true;
-                    if ( !m_abort_flag ){
-                        LOGINFO("Starting Script (SM) :  %s \n",cmd.c_str());
-                        system(cmd.c_str());
-                    }
-                }
+            if (internetConnectStatus && !tasks.empty()){
+                if (UNSOLICITED_MAINTENANCE == g_maintenance_type)
+                    LOGINFO("---------------UNSOLICITED_MAINTENANCE--------------");
+                else
+                    LOGINFO("=============SOLICITED_MAINTENANCE===============");
+                scheduleTasks(tasks, lck);
             }
             m_abort_flag=false;
             LOGINFO("Worker Thread Completed");
@@ -320,6 +336,248 @@ namespace WPEFramework {
             }
         }
 
+        /* Starts every task whose predecessors are complete, as long as the weights of the
+         * running ones stay within m_taskBudget (one always runs, whatever its weight).
+         * An unsolicited maintenance starts nothing while the user is active, up to
+         * m_maxDeferTime. Returns once all tasks are complete, or after an abort once the
+         * running ones are. Called and returns with lck held, waits for the events with it released */
+        void MaintenanceManager::scheduleTasks(std::vector<MaintenanceTask>& tasks, std::unique_lock<std::mutex>& lck)
+        {
+            typedef std::chrono::steady_clock Clock;
+            const Clock::time_point begin = Clock::now();
+            const bool deferrable = (UNSOLICITED_MAINTENANCE == g_maintenance_type) && (m_userIdleTime > 0);
+            const Clock::time_point deferLimit = begin + std::chrono::seconds(m_maxDeferTime);
+            bool deferLogged = false;
+
+            while (true) {
+                const int64_t elapsed = std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - begin).count();
+                int load = 0;
+                bool running = false;
+                bool pending = false;
+
+                for (auto& task : tasks) {
+                    bool complete = CHECK_STATUS(g_task_status, task.completeBit);
+                    if (task.started && !complete) {
+                        running = true;
+                        load += task.weight;
+                    } else if (!task.started && !complete) {
+                        pending = true;
+                    } else if (task.started && !task.finished) {
+                        task.finished = true;
+                        LOGINFO("Task %s complete after %lld s", task.script.c_str(), (long long)elapsed);
+                    }
+                }
+
+                if (m_abort_flag)
+                    pending = false;
+                if (!running && !pending)
+                    break;
+
+                /* Wait for the user to go idle, but not beyond the limit */
+                Clock::time_point now = Clock::now();
+                Clock::time_point wakeup = now;
+                int64_t lastActivity = m_lastUserActivity;
+                if (pending && deferrable && lastActivity != 0 && !m_userInactive && now < deferLimit) {
+                    Clock::time_point idleAt = Clock::time_point(std::chrono::milliseconds(lastActivity)) + std::chrono::seconds(m_userIdleTime);
+                    if (idleAt > now)
+                        wakeup = std::min(idleAt, deferLimit);
+                }
+
+                if (pending && wakeup > now) {
+                    if (!deferLogged)
+                        LOGINFO("User is active, deferring the pending tasks for up to %lld s",
+                                (long long)std::chrono::duration_cast<std::chrono::seconds>(wakeup - now).count());
+                    deferLogged = true;
+                } else if (pending) {
+                    deferLogged = false;
+                    for (auto& task : tasks) {
+                        if (task.started || CHECK_STATUS(g_task_status, task.completeBit))
+                            continue;
+
+                        bool ready = true;
+                        for (int index : task.after)
+                            ready = ready && CHECK_STATUS(g_task_status, tasks[index].completeBit);
+                        if (!ready || (running && load + task.weight > (int)m_taskBudget))
+                            continue;
+
+                        startTask(task, load, elapsed);
+                        load += task.weight;
+                        running = true;
+                    }
+                }
+
+                if (wakeup > now)
+                    task_thread.wait_until(lck, wakeup);
+                else
+                    task_thread.wait(lck);
+            }
+        }
+
+        void MaintenanceManager::startTask(MaintenanceTask& task, int load, int64_t elapsed)
+        {
+            string cmd = taskCommand(task.script);
+            cmd += " &";
+            task.started = true;
+            m_task_map[task.script] = true;
+
+            LOGINFO("Starting Script (%s) :  %s after %lld s, load %d/%u \n",
+                    (UNSOLICITED_MAINTENANCE == g_maintenance_type) ? "USM" : "SM",
+                    cmd.c_str(), (long long)elapsed, load + task.weight, m_taskBudget);
+            system(cmd.c_str());
+        }
+
+        /* The script starts in the throttle cgroups, so everything it runs is weighted
+         * from the start, and learns the bandwidth it may use from the environment */
+        string MaintenanceManager::taskCommand(const string& script)
+        {
+            uint32_t bandwidth = 0;
+            {
+                std::lock_guard<std::mutex> guard(m_throttleMutex);
+                bandwidth = bandwidthLimit(m_throttleLevel);
+            }
+            if (m_throttleGroups.empty() && 0 == bandwidth)
+                return script;
+
+            string cmd = "sh -c '";
+            for (const auto& group : m_throttleGroups)
+                cmd += "echo $$ > " + group + "/cgroup.procs; ";
+            if (bandwidth > 0)
+                cmd += "export MAINTENANCE_BANDWIDTH_LIMIT=" + to_string(bandwidth) + "; ";
+            cmd += "exec " + script + "'";
+            return cmd;
+        }
+
+        uint32_t MaintenanceManager::bandwidthLimit(Maint_throttle_level_t level) const
+        {
+            switch (level){
+                case THROTTLE_LIGHT:
+                    return m_activeBandwidth;
+                case THROTTLE_HEAVY:
+                    return m_playbackBandwidth;
+                default:
+                    return 0;
+            }
+        }
+
+        void MaintenanceManager::setupThrottleGroups()
+        {
+            const string root = MAINTENANCE_CGROUP_ROOT;
+            m_cgroupV2 = Utils::fileExists((root + "/cgroup.controllers").c_str());
+
+            if (m_cgroupV2){
+                /* the controllers have to be enabled for the children of the root */
+                writeCgroupFile(root + "/cgroup.subtree_control", "+cpu +io");
+                string group = root + "/" + MAINTENANCE_CGROUP_NAME;
+                if (0 == mkdir(group.c_str(), 0755) || EEXIST == errno)
+                    m_throttleGroups.push_back(group);
+            }
+            else {
+                for (const char* controller : { "cpu", "blkio" }){
+                    string group = root + "/" + controller + "/" + MAINTENANCE_CGROUP_NAME;
+                    if (0 == mkdir(group.c_str(), 0755) || EEXIST == errno)
+                        m_throttleGroups.push_back(group);
+                }
+            }
+
+            if (m_throttleGroups.empty())
+                LOGERR("No cgroup for the maintenance tasks, CPU and I/O are not throttled");
+            else
+                LOGINFO("Maintenance tasks run in %zu cgroup(s) (%s)", m_throttleGroups.size(), m_cgroupV2 ? "v2" : "v1");
+        }
+
+        void MaintenanceManager::subscribeActivityEvents()
+        {
+            if (!m_throttleEnabled)
+                return;
+
+            if (!m_rdkShellSubscribed && Utils::isPluginActivated("org.rdk.RDKShell")){
+                m_rdkShellClient = Utils::getThunderControllerClient(RDKSHELL_CALLSIGN_VER, "MaintenanceManager");
+                if (m_rdkShellClient){
+                    uint32_t status = m_rdkShellClient->Subscribe<JsonObject>(1000, _T("onUserInactivity"),
+                            &MaintenanceManager::onUserInactivity, this);
+                    m_rdkShellSubscribed = (Core::ERROR_NONE == status);
+                    LOGINFO("Subscribing for RDKShell onUserInactivity: %d", status);
+                }
+            }
+
+            if (!m_mediaPlayerSubscribed && Utils::isPluginActivated("org.rdk.FireboltMediaPlayer")){
+                m_mediaPlayerClient = Utils::getThunderControllerClient(MEDIAPLAYER_CALLSIGN_VER, "MaintenanceManager");
+                if (m_mediaPlayerClient){
+                    uint32_t status = m_mediaPlayerClient->Subscribe<JsonObject>(1000, _T("playbackStateChanged"),
+                            &MaintenanceManager::onPlaybackStateChanged, this);
+                    m_mediaPlayerSubscribed = (Core::ERROR_NONE == status);
+                    LOGINFO("Subscribing for FireboltMediaPlayer playbackStateChanged: %d", status);
+                }
+            }
+        }
+
+        void MaintenanceManager::onUserInactivity(const JsonObject& parameters)
+        {
+            LOGINFO("User inactive for %s minutes", parameters["minutes"].String().c_str());
+            if (!m_userInactive.exchange(true)){
+                updateThrottle();
+                /* deferred tasks may start now */
+                std::lock_guard<std::mutex> guard(m_callMutex);
+                task_thread.notify_one();
+            }
+        }
+
+        void MaintenanceManager::onPlaybackStateChanged(const JsonObject& parameters)
+        {
+            int state = parameters["state"].Number();
+            bool playing = (MEDIAPLAYER_STATE_PLAYING == state || MEDIAPLAYER_STATE_BUFFERING == state
+                    || MEDIAPLAYER_STATE_SEEKING == state);
+            if (m_playing.exchange(playing) != playing)
+                updateThrottle();
+        }
+
+        void MaintenanceManager::onUserActivity()
+        {
+            m_lastUserActivity = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            if (m_userInactive.exchange(false))
+                updateThrottle();
+        }
+
+        void MaintenanceManager::onPowerStateChange(bool poweredOn)
+        {
+            if (m_poweredOn.exchange(poweredOn) != poweredOn)
+                updateThrottle();
+        }
+
+        /* Nothing is throttled in standby; during playback the most, while the user is active some */
+        void MaintenanceManager::updateThrottle(bool force)
+        {
+            if (!m_throttleEnabled)
+                return;
+
+            Maint_throttle_level_t level = THROTTLE_NONE;
+            if (m_poweredOn && m_playing)
+                level = THROTTLE_HEAVY;
+            else if (m_poweredOn && !m_userInactive)
+                level = THROTTLE_LIGHT;
+
+            std::lock_guard<std::mutex> guard(m_throttleMutex);
+            if (level == m_throttleLevel && !force)
+                return;
+
+            LOGINFO("Maintenance throttle %s -> %s", throttleLevelToString(m_throttleLevel).c_str(), throttleLevelToString(level).c_str());
+            m_throttleLevel = level;
+
+            for (const auto& group : m_throttleGroups){
+                if (m_cgroupV2){
+                    writeCgroupFile(group + "/cpu.weight", to_string(throttleWeights[level].cpuWeight));
+                    writeCgroupFile(group + "/io.weight", "default " + to_string(throttleWeights[level].ioWeight));
+                }
+                else if (group.find("/cpu/") != string::npos){
+                    writeCgroupFile(group + "/cpu.shares", to_string(throttleWeights[level].cpuShares));
+                }
+                else {
+                    writeCgroupFile(group + "/blkio.weight", to_string(throttleWeights[level].blkioWeight));
+                }
+            }
+        }
+
         const string MaintenanceManager::checkActivatedStatus()
         {
             JsonObject joGetParams;
@@ -497,11 +755,28 @@ namespace WPEFramework {
             MaintenanceManager::_instance = nullptr;
         }
 
-        const string MaintenanceManager::Initialize(PluginHost::IShell*)
+        const string MaintenanceManager::Initialize(PluginHost::IShell* service)
         {
+            Config config;
+            if (service)
+                config.FromString(service->ConfigLine());
+
+            m_taskBudget = config.TaskBudget.Value() > 0 ? config.TaskBudget.Value() : 1;
+            m_userIdleTime = config.UserIdleTime.Value();
+            m_maxDeferTime = config.MaxDeferTime.Value();
+            LOGINFO("task budget %u, user idle after %u s, deferring up to %u s", m_taskBudget, m_userIdleTime, m_maxDeferTime);
+
+            m_throttleEnabled = config.Throttle.Value();
+            m_activeBandwidth = config.ActiveBandwidth.Value();
+            m_playbackBandwidth = config.PlaybackBandwidth.Value();
+            if (m_throttleEnabled)
+                setupThrottleGroups();
+
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             InitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            /* the groups may keep the weights of an earlier run */
+            updateThrottle(true);
             /* On Success; return empty to indicate no error text. */
             return (string());
         }
@@ -511,6 +786,11 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            if (m_rdkShellSubscribed)
+                m_rdkShellClient->Unsubscribe(1000, _T("onUserInactivity"));
+            if (m_mediaPlayerSubscribed)
+                m_mediaPlayerClient->Unsubscribe(1000, _T("playbackStateChanged"));
+            m_rdkShellSubscribed = m_mediaPlayerSubscribed = false;
         }
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
@@ -522,6 +802,14 @@ namespace WPEFramework {
                 IARM_CHECK(IARM_Bus_RegisterEventHandler(IARM_BUS_MAINTENANCE_MGR_NAME, IARM_BUS_MAINTENANCEMGR_EVENT_UPDATE, _MaintenanceMgrEventHandler));
                 //Register for setMaintenanceStartTime
                 IARM_CHECK(IARM_Bus_RegisterEventHandler(IARM_BUS_MAINTENANCE_MGR_NAME, IARM_BUS_DCM_NEW_START_TIME_EVENT,_MaintenanceMgrEventHandler));
+                //Key presses tell the user is active
+                IARM_CHECK(IARM_Bus_RegisterEventHandler(IARM_BUS_IRMGR_NAME, IARM_BUS_IRMGR_EVENT_IRKEY, _UserActivityEventHandler));
+                //Nothing is throttled in standby
+                IARM_CHECK(IARM_Bus_RegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED, _PowerEventHandler));
+
+                IARM_Bus_PWRMgr_GetPowerState_Param_t param;
+                if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetPowerState, (void *)&param, sizeof(param)))
+                    m_poweredOn = (IARM_BUS_PWRMGR_POWERSTATE_ON == param.curState);
 
                 maintenanceManagerOnBootup();
             }
@@ -597,6 +885,21 @@ namespace WPEFramework {
                 LOGWARN("WARNING - cannot handle IARM events without MaintenanceManager plugin instance!");
         }
 
+        void MaintenanceManager::_UserActivityEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            if (MaintenanceManager::_instance && IARM_BUS_IRMGR_EVENT_IRKEY == eventId){
+                MaintenanceManager::_instance->onUserActivity();
+            }
+        }
+
+        void MaintenanceManager::_PowerEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
+        {
+            if (MaintenanceManager::_instance && IARM_BUS_PWRMGR_EVENT_MODECHANGED == eventId){
+                IARM_Bus_PWRMgr_EventData_t *eventData = (IARM_Bus_PWRMgr_EventData_t *)data;
+                MaintenanceManager::_instance->onPowerStateChange(IARM_BUS_PWRMGR_POWERSTATE_ON == eventData->data.state.newState);
+            }
+        }
+
         void MaintenanceManager::iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
             Maint_notify_status_t notify_status=MAINTENANCE_STARTED;
@@ -626,6 +929,8 @@ namespace WPEFramework {
                     LOGINFO("MaintMGR Status %d \n",module_status);
                     string status_string=moduleStatusToString(module_status);
                     LOGINFO("MaintMGR Status %s \n", status_string.c_str());
+                    /* the scheduler starts the next tasks from g_task_status */
+                    std::lock_guard<std::mutex> guard(m_callMutex);
                     switch (module_status) {
                         case MAINT_RFC_COMPLETE :
                             if(task_status_RFC->second != true) {
@@ -671,6 +976,7 @@ namespace WPEFramework {
                             else {
                                 SET_STATUS(g_task_status,LOGUPLOAD_SUCCESS);
                                 SET_STATUS(g_task_status,LOGUPLOAD_COMPLETE);
+                                task_thread.notify_one();
                                 m_task_map[task_names_foreground[2].c_str()]=false;
                             }
 
@@ -721,6 +1027,7 @@ namespace WPEFramework {
                             }
                             else {
                                 SET_STATUS(g_task_status,LOGUPLOAD_COMPLETE);
+                                task_thread.notify_one();
                                 LOGINFO("Error encountered in LOGUPLOAD script task \n");
                                 m_task_map[task_names_foreground[2].c_str()]=false;
                             }
@@ -818,6 +1125,8 @@ namespace WPEFramework {
                 IARM_Result_t res;
                 IARM_CHECK(IARM_Bus_UnRegisterEventHandler(IARM_BUS_MAINTENANCE_MGR_NAME, IARM_BUS_MAINTENANCEMGR_EVENT_UPDATE));
                 IARM_CHECK(IARM_Bus_UnRegisterEventHandler(IARM_BUS_MAINTENANCE_MGR_NAME, IARM_BUS_DCM_NEW_START_TIME_EVENT));
+                IARM_CHECK(IARM_Bus_UnRegisterEventHandler(IARM_BUS_IRMGR_NAME, IARM_BUS_IRMGR_EVENT_IRKEY));
+                IARM_CHECK(IARM_Bus_UnRegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED));
                 MaintenanceManager::_instance = nullptr;
             }
 
@@ -904,6 +1213,19 @@ namespace WPEFramework {
                     }
                     response["isCriticalMaintenance"] = b_criticalMaintenace;
                     response["isRebootPending"] = b_rebootPending;
+
+                    if (m_throttleEnabled){
+                        JsonObject throttle;
+                        std::lock_guard<std::mutex> throttleGuard(m_throttleMutex);
+                        throttle["level"] = throttleLevelToString(m_throttleLevel);
+                        throttle["userActive"] = !m_userInactive;
+                        throttle["playing"] = (bool)m_playing;
+                        throttle["standby"] = !m_poweredOn;
+                        throttle["cpuWeight"] = m_cgroupV2 ? throttleWeights[m_throttleLevel].cpuWeight : throttleWeights[m_throttleLevel].cpuShares;
+                        throttle["ioWeight"] = m_cgroupV2 ? throttleWeights[m_throttleLevel].ioWeight : throttleWeights[m_throttleLevel].blkioWeight;
+                        throttle["bandwidthLimit"] = bandwidthLimit(m_throttleLevel);
+                        response["throttleState"] = throttle;
+                    }
                     result = true;
 
                     returnResponse(result);
@@ -921,7 +1243,7 @@ namespace WPEFramework {
             string starttime="";
             unsigned long int start_time=0;
 
-            starttime = Utils::cRunScript("/lib/rdk/getMaintenanceStartTime.sh &");
+            Utils::runCommand({ "/lib/rdk/getMaintenanceStartTime.sh" }, &starttime);
             if (!starttime.empty()){
                   response["maintenanceStartTime"]=stoi(starttime.c_str());
                   result=true;
@@ -1210,6 +1532,12 @@ namespace WPEFramework {
                     LOGERR("Failed to stopMaintenance without starting maintenance \n");
                 }
                 m_statusMutex.unlock();
+
+                if (result){
+                    /* the scheduler starts nothing more */
+                    std::lock_guard<std::mutex> guard(m_callMutex);
+                    task_thread.notify_one();
+                }
             }
             else {
                 LOGERR("Failed to initiate stopMaintenance, RFC is set as False \n");
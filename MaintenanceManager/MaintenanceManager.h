@@ -21,8 +21,14 @@
 #define MAINTENANCEMANAGER_H
 
 #include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include "Module.h"
 #include "tracing/Logging.h"
@@ -71,6 +77,12 @@ typedef enum{
     UNSOLICITED_MAINTENANCE
 }Maintenance_Type_t;
 
+typedef enum{
+    THROTTLE_NONE,      /* standby, or nobody watching */
+    THROTTLE_LIGHT,     /* the user is active */
+    THROTTLE_HEAVY      /* audio/video is playing */
+}Maint_throttle_level_t;
+
 #define FOREGROUND_MODE "FOREGROUND"
 #define BACKGROUND_MODE "BACKGROUND"
 
@@ -81,6 +93,24 @@ typedef enum{
 #define MAX_NETWORK_RETRIES             4
 #define MAX_ACTIVATION_RETRIES          4
 
+/* Defaults of the configuration */
+#define MAINTENANCE_TASK_BUDGET         2       /* sum of the weights of the tasks running at once */
+#define MAINTENANCE_USER_IDLE_SEC       300     /* no key for this long and the user is not active */
+#define MAINTENANCE_MAX_DEFER_SEC       1800    /* unsolicited tasks wait for the user at most this long */
+#define MAINTENANCE_ACTIVE_BANDWIDTH    0       /* kbit/s the tasks get while the user is active, 0 unlimited */
+#define MAINTENANCE_PLAYBACK_BANDWIDTH  2000    /* kbit/s the tasks get during playback, 0 unlimited */
+
+/* The tasks run in this cgroup, weighted by the throttle level */
+#define MAINTENANCE_CGROUP_ROOT         "/sys/fs/cgroup"
+#define MAINTENANCE_CGROUP_NAME         "maintenance"
+
+#define RDKSHELL_CALLSIGN_VER           "org.rdk.RDKShell.1"
+#define MEDIAPLAYER_CALLSIGN_VER        "org.rdk.FireboltMediaPlayer.1"
+/* playbackStateChanged states (AAMP PrivAAMPState) in which media is flowing */
+#define MEDIAPLAYER_STATE_BUFFERING     5
+#define MEDIAPLAYER_STATE_SEEKING       7
+#define MEDIAPLAYER_STATE_PLAYING       8
+
 #define DCM_SUCCESS                     0
 #define DCM_COMPLETE                    1
 #define RFC_SUCCESS                     2
@@ -114,6 +144,41 @@ namespace WPEFramework {
         // will receive a JSONRPC message as a notification, in case this method is called.
 
         class MaintenanceManager : public AbstractPlugin {
+            public:
+                class Config : public Core::JSON::Container {
+                private:
+                    Config(const Config&) = delete;
+                    Config& operator=(const Config&) = delete;
+
+                public:
+                    Config()
+                        : TaskBudget(MAINTENANCE_TASK_BUDGET)
+                        , UserIdleTime(MAINTENANCE_USER_IDLE_SEC)
+                        , MaxDeferTime(MAINTENANCE_MAX_DEFER_SEC)
+                        , Throttle(true)
+                        , ActiveBandwidth(MAINTENANCE_ACTIVE_BANDWIDTH)
+                        , PlaybackBandwidth(MAINTENANCE_PLAYBACK_BANDWIDTH)
+                    {
+                        Add(_T("taskbudget"), &TaskBudget);
+                        Add(_T("useridletime"), &UserIdleTime);
+                        Add(_T("maxdefertime"), &MaxDeferTime);
+                        Add(_T("throttle"), &Throttle);
+                        Add(_T("activebandwidth"), &ActiveBandwidth);
+                        Add(_T("playbackbandwidth"), &PlaybackBandwidth);
+                    }
+                    ~Config()
+                    {
+                    }
+
+                public:
+                    Core::JSON::DecUInt32 TaskBudget;       // weight of the tasks that may run at once
+                    Core::JSON::DecUInt32 UserIdleTime;     // s without a key press before unsolicited tasks start, 0 not to wait
+                    Core::JSON::DecUInt32 MaxDeferTime;     // s unsolicited tasks wait for the user at most
+                    Core::JSON::Boolean Throttle;           // weight the tasks' CPU and I/O by user activity and playback
+                    Core::JSON::DecUInt32 ActiveBandwidth;  // kbit/s for tasks started while the user is active, 0 unlimited
+                    Core::JSON::DecUInt32 PlaybackBandwidth;    // kbit/s for tasks started during playback, 0 unlimited
+                };
+
             private:
                 typedef Core::JSON::String JString;
                 typedef Core::JSON::ArrayType<JString> JStringArray;
@@ -144,8 +209,52 @@ namespace WPEFramework {
 
                 std::map<string, bool> m_task_map;
 
+                /* A maintenance task. It is complete when its bit of g_task_status is set,
+                 * by the IARM event telling it succeeded or failed or before it started */
+                struct MaintenanceTask {
+                    std::string script;             // also the m_task_map key
+                    int completeBit;
+                    std::vector<int> after;         // indexes of the tasks to complete first
+                    int weight;                     // share of m_taskBudget taken while running
+                    bool started;
+                    bool finished;                  // completion logged
+                };
+
+                uint32_t m_taskBudget;
+                uint32_t m_userIdleTime;
+                uint32_t m_maxDeferTime;
+                std::atomic<int64_t> m_lastUserActivity;    // steady clock ms, 0 without a key press yet
+
+                /* Throttling of the tasks by what the user does */
+                bool m_throttleEnabled;
+                uint32_t m_activeBandwidth;
+                uint32_t m_playbackBandwidth;
+                std::mutex m_throttleMutex;
+                Maint_throttle_level_t m_throttleLevel;
+                std::atomic<bool> m_userInactive;           // RDKShell reported inactivity after the last key press
+                std::atomic<bool> m_playing;
+                std::atomic<bool> m_poweredOn;
+                bool m_cgroupV2;
+                std::vector<std::string> m_throttleGroups;  // cgroup directories the tasks start in
+                std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> m_rdkShellClient;
+                std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> m_mediaPlayerClient;
+                bool m_rdkShellSubscribed;
+                bool m_mediaPlayerSubscribed;
+
                 bool isDeviceOnline();
                 void task_execution_thread();
+                void scheduleTasks(std::vector<MaintenanceTask>& tasks, std::unique_lock<std::mutex>& lck);
+                void startTask(MaintenanceTask& task, int load, int64_t elapsed);
+                string taskCommand(const string& script);
+
+                void setupThrottleGroups();
+                void subscribeActivityEvents();
+                void onUserInactivity(const JsonObject& parameters);
+                void onPlaybackStateChanged(const JsonObject& parameters);
+                void onUserActivity();
+                void onPowerStateChange(bool poweredOn);
+                void updateThrottle(bool force = false);
+                uint32_t bandwidthLimit(Maint_throttle_level_t level) const;
                 void requestSystemReboot();
                 void maintenanceManagerOnBootup();
                 bool checkAutoRebootFlag();
@@ -158,18 +267,12 @@ namespace WPEFramework {
                 string getLastRebootReason();
                 void iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
                 static void _MaintenanceMgrEventHandler(const char *owner,IARM_EventId_t eventId, void *data, size_t len);
+                static void _UserActivityEventHandler(const char *owner,IARM_EventId_t eventId, void *data, size_t len);
+                static void _PowerEventHandler(const char *owner,IARM_EventId_t eventId, void *data, size_t len);
                 // We do not allow this plugin to be copied !!
                 MaintenanceManager(const MaintenanceManager&) = delete;
                 MaintenanceManager& operator=(const MaintenanceManager&) = delete;
 
-            private:
-                class MaintenanceTask{
-                    private:
-                        std::string taskName;
-                        std::string taskScript;
-                    public:
-                        void startTask();
-                };
             public:
                 MaintenanceManager();
                 virtual ~MaintenanceManager();
@@ -41,11 +41,17 @@ namespace Plugin {
         _service = service;
         _service->AddRef();
 
+        Config config;
+        config.FromString(_service->ConfigLine());
+        _batchWindow = config.BatchWindow.Value();
+
         _roomAdmin = service->Root<Exchange::IRoomAdministrator>(_connectionId, 2000, _T("RoomMaintainer"));
         ASSERT(_roomAdmin != nullptr);
 
         _roomAdmin->Register(this);
 
+        _service->Register(&_securityObserver);
+
         return { };
     }
 
@@ -53,6 +59,9 @@ namespace Plugin {
     {
         ASSERT(service == _service);
 
+        _service->Unregister(&_securityObserver);
+        ReleaseSecurity();
+
         // Exit all the rooms (if any) that were joined by this client
         for (auto& room : _roomIds) {
             room.second->Release();
@@ -60,6 +69,14 @@ namespace Plugin {
 
         _roomIds.clear();
 
+        _batchJob.Revoke();
+
+        _batchLock.Lock();
+        _batches.clear();
+        _batchedRooms.clear();
+        _batchPending = false;
+        _batchLock.Unlock();
+
         _roomAdmin->Unregister(this);
         _rooms.clear();
 
@@ -149,6 +166,10 @@ namespace Plugin {
 
         _adminLock.Unlock();
 
+        if (result) {
+            DropBatch(roomId);
+        }
+
         return result;
     }
 
@@ -171,6 +192,73 @@ namespace Plugin {
         return result;
     }
 
+    // Message batching
+
+    void Messenger::SubscribeBatch(const string& roomId, bool subscribe)
+    {
+        _batchLock.Lock();
+
+        if (subscribe) {
+            _batchedRooms.insert(roomId);
+        }
+        else {
+            _batchedRooms.erase(roomId);
+            _batches.erase(roomId);
+        }
+
+        _batchLock.Unlock();
+    }
+
+    bool Messenger::Batch(const string& roomId, const string& senderName, const string& message)
+    {
+        bool batched = false;
+
+        _batchLock.Lock();
+
+        if (_batchedRooms.find(roomId) != _batchedRooms.end()) {
+            _batches[roomId].push_back({ senderName, message });
+            batched = true;
+
+            // The window starts with the first message, later ones must not push it out.
+            if (_batchPending == false) {
+                _batchPending = true;
+
+                if (_batchWindow == 0) {
+                    _batchJob.Submit();
+                }
+                else {
+                    _batchJob.Schedule(Core::Time::Now().Add(_batchWindow));
+                }
+            }
+        }
+
+        _batchLock.Unlock();
+
+        return (batched);
+    }
+
+    void Messenger::DropBatch(const string& roomId)
+    {
+        _batchLock.Lock();
+        _batchedRooms.erase(roomId);
+        _batches.erase(roomId);
+        _batchLock.Unlock();
+    }
+
+    void Messenger::Dispatch()
+    {
+        std::map<string, std::list<BatchedMessage>> batches;
+
+        _batchLock.Lock();
+        batches.swap(_batches);
+        _batchPending = false;
+        _batchLock.Unlock();
+
+        for (auto const& batch : batches) {
+            event_messages(batch.first, batch.second);
+        }
+    }
+
     // Helpers
 
     string Messenger::GenerateRoomId(const string& roomName, const string& userName)
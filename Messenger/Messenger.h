@@ -24,8 +24,12 @@
 #include <interfaces/json/JsonData_Messenger.h>
 #include <map>
 #include <set>
+#include <list>
 #include <functional>
 
+// Officers of distinct tokens kept, the cache starts over when it is full
+#define MESSENGER_OFFICER_CACHE_SIZE 64
+
 namespace WPEFramework {
 
 namespace Plugin {
@@ -33,10 +37,120 @@ namespace Plugin {
     class Messenger : public PluginHost::IPlugin
                     , public Exchange::IRoomAdministrator::INotification
                     , public PluginHost::JSONRPCSupportsEventStatus {
+    private:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : BatchWindow(50)
+            {
+                Add(_T("batchwindow"), &BatchWindow);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt16 BatchWindow; // ms the messages of a batched room are collected for
+        };
+
+        // Parameters of the "messages" event: all messages collected within one batch window.
+        class BatchParamsData : public Core::JSON::Container {
+        public:
+            class MessageData : public Core::JSON::Container {
+            public:
+                MessageData()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+
+                MessageData(const MessageData& other)
+                    : Core::JSON::Container()
+                    , User(other.User)
+                    , Message(other.Message)
+                {
+                    Init();
+                }
+
+                MessageData& operator=(const MessageData& rhs)
+                {
+                    User = rhs.User;
+                    Message = rhs.Message;
+                    return (*this);
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("user"), &User);
+                    Add(_T("message"), &Message);
+                }
+
+            public:
+                Core::JSON::String User;
+                Core::JSON::String Message;
+            };
+
+        public:
+            BatchParamsData(const BatchParamsData&) = delete;
+            BatchParamsData& operator=(const BatchParamsData&) = delete;
+
+            BatchParamsData()
+                : Core::JSON::Container()
+            {
+                Add(_T("messages"), &Messages);
+            }
+
+        public:
+            Core::JSON::ArrayType<MessageData> Messages;
+        };
+
+        struct BatchedMessage {
+            string user;
+            string message;
+        };
+
+        // Drops the SecurityAgent interfaces when SecurityAgent is deactivated
+        class SecurityObserver : public PluginHost::IPlugin::INotification {
+        public:
+            SecurityObserver() = delete;
+            SecurityObserver(const SecurityObserver&) = delete;
+            SecurityObserver& operator=(const SecurityObserver&) = delete;
+
+            SecurityObserver(Messenger* parent)
+                : _parent(*parent)
+            {
+            }
+            ~SecurityObserver() override
+            {
+            }
+
+            void StateChange(PluginHost::IShell* plugin) override
+            {
+                if ((plugin->Callsign() == _T("SecurityAgent")) && (plugin->State() != PluginHost::IShell::ACTIVATED)) {
+                    _parent.ReleaseSecurity();
+                }
+            }
+
+            BEGIN_INTERFACE_MAP(SecurityObserver)
+                INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
+            END_INTERFACE_MAP
+
+        private:
+            Messenger& _parent;
+        };
+
     public:
         Messenger(const Messenger&) = delete;
         Messenger& operator=(const Messenger&) = delete;
 
+        #ifdef __WINDOWS__
+        #pragma warning(disable: 4355)
+        #endif
         Messenger()
             : PluginHost::JSONRPCSupportsEventStatus(std::bind(&Messenger::CheckToken, this,
                     std::placeholders::_1, std::placeholders::_2, std::placeholders::_3))
@@ -45,9 +159,22 @@ namespace Plugin {
             , _roomAdmin(nullptr)
             , _roomIds()
             , _adminLock()
+            , _batchWindow(0)
+            , _batchedRooms()
+            , _batches()
+            , _batchPending(false)
+            , _batchLock()
+            , _batchJob(*this)
+            , _securityLock()
+            , _auth(nullptr)
+            , _officers()
+            , _securityObserver(this)
         {
             RegisterAll();
         }
+        #ifdef __WINDOWS__
+        #pragma warning(default: 4355)
+        #endif
 
         ~Messenger()
         {
@@ -145,7 +272,9 @@ namespace Plugin {
 
         void MessageHandler(const string& roomId, const string& senderName, const string& message)
         {
-            event_message(roomId, senderName, message);
+            if (Batch(roomId, senderName, message) == false) {
+                event_message(roomId, senderName, message);
+            }
         }
 
         // IMessenger::INotification methods
@@ -174,6 +303,14 @@ namespace Plugin {
         string GenerateRoomId(const string& roomName, const string& userName);
         bool SubscribeUserUpdate(const string& roomId, bool subscribe);
 
+        // Batched rooms: those with a listener to "messages" rather than "message".
+        void SubscribeBatch(const string& roomId, bool subscribe);
+        bool Batch(const string& roomId, const string& senderName, const string& message);
+        void DropBatch(const string& roomId);
+
+        friend Core::ThreadPool::JobType<Messenger&>;
+        void Dispatch();
+
         // JSON-RPC
         void RegisterAll();
         void UnregisterAll();
@@ -183,8 +320,13 @@ namespace Plugin {
         void event_roomupdate(const string& room, const JsonData::Messenger::RoomupdateParamsData::ActionType& action);
         void event_userupdate(const string& id, const string& user, const JsonData::Messenger::UserupdateParamsData::ActionType& action);
         void event_message(const string& id, const string& user, const string& message);
+        void event_messages(const string& id, const std::list<BatchedMessage>& messages);
         bool CheckToken(const string& token, const string& method, const string& parameters);
 
+        // SecurityAgent officer of the token, resolved once per token
+        bool IsAllowed(const string& token, const string& designator);
+        void ReleaseSecurity();
+
         uint32_t _connectionId;
         PluginHost::IShell* _service;
         Exchange::IRoomAdministrator* _roomAdmin;
@@ -192,6 +334,16 @@ namespace Plugin {
         std::set<string> _rooms;
         std::map<string, std::list<string>> _roomACL;
         mutable Core::CriticalSection _adminLock;
+        uint16_t _batchWindow;
+        std::set<string> _batchedRooms;
+        std::map<string, std::list<BatchedMessage>> _batches;
+        bool _batchPending;
+        Core::CriticalSection _batchLock;
+        Core::WorkerPool::JobType<Messenger&> _batchJob;
+        Core::CriticalSection _securityLock;
+        PluginHost::IAuthenticate* _auth;
+        std::map<string, PluginHost::ISecurity*> _officers;
+        Core::Sink<SecurityObserver> _securityObserver;
     }; // class Messenger
 
 } // namespace Plugin
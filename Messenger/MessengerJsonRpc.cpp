@@ -46,6 +46,12 @@ namespace Plugin {
             SubscribeUserUpdate(roomId, status == Status::registered);
         });
 
+        RegisterEventStatusListener(_T("messages"), [this](const string& client, Status status) {
+            // Listening to this event rather than "message" opts the room ID in to batching.
+            const string roomId = client.substr(0, client.find('.'));
+            SubscribeBatch(roomId, status == Status::registered);
+        });
+
         Register<JoinParamsData,JoinResultInfo>(_T("join"), &Messenger::endpoint_join, this);
         Register<JoinResultInfo,void>(_T("leave"), &Messenger::endpoint_leave, this);
         Register<SendParamsData,void>(_T("send"), &Messenger::endpoint_send, this);
@@ -56,6 +62,7 @@ namespace Plugin {
         Unregister(_T("send"));
         Unregister(_T("leave"));
         Unregister(_T("join"));
+        UnregisterEventStatusListener(_T("messages"));
         UnregisterEventStatusListener(_T("userupdate"));
         UnregisterEventStatusListener(_T("roomupdate"));
     }
@@ -152,7 +159,23 @@ namespace Plugin {
         });
     }
 
+    // Notifies about the messages sent to a batched room within one batch window.
+    void Messenger::event_messages(const string& id, const std::list<BatchedMessage>& messages)
+    {
+        BatchParamsData params;
+
+        for (auto const& entry : messages) {
+            BatchParamsData::MessageData& message(params.Messages.Add());
+            message.User = entry.user;
+            message.Message = entry.message;
+        }
+
+        Notify(_T("messages"), params, [&](const string& designator) -> bool {
+            const string designator_id = designator.substr(0, designator.find('.'));
+            return (id == designator_id);
+        });
+    }
+
 } // namespace Plugin
 
 }
-
@@ -19,6 +19,7 @@
 
 #include "Module.h"
 #include "Messenger.h"
+#include "cryptalgo/Hash.h"
 
 #include <interfaces/json/JsonData_Messenger.h>
 
@@ -28,30 +29,6 @@
 // helper functions
 namespace {
 
-    bool IsAllowed(WPEFramework::PluginHost::IShell* service, const string& token, const string& designator)
-    {
-        bool result = false;
-
-        auto auth = service->QueryInterfaceByCallsign<WPEFramework::PluginHost::IAuthenticate>("SecurityAgent");
-        if (auth != nullptr) {
-            string encoded;
-            if (auth->CreateToken(
-                    static_cast<uint16_t>(token.length()),
-                    reinterpret_cast<const uint8_t *>(token.c_str()),
-                    encoded) == WPEFramework::Core::ERROR_NONE) {
-                WPEFramework::PluginHost::ISecurity *officer = auth->Officer(encoded);
-                if (officer != nullptr) {
-                    WPEFramework::Core::JSONRPC::Message message;
-                    message.Designator = designator;
-
-                    result = officer->Allowed(message);
-                }
-            }
-        }
-
-        return result;
-    }
-
     string CreateUrlRegex(const string& input)
     {
         string regex = input;
@@ -86,6 +63,74 @@ namespace Plugin {
 
     using namespace JsonData::Messenger;
 
+    bool Messenger::IsAllowed(const string& token, const string& designator)
+    {
+        bool result = false;
+
+        // The officers are kept by the digest of the token, not by the token itself
+        Crypto::SHA256 hash;
+        hash.Input(reinterpret_cast<const uint8_t*>(token.c_str()), static_cast<uint16_t>(token.length()));
+        const string digest(reinterpret_cast<const char*>(hash.Result()), Crypto::SHA256::Length);
+
+        _securityLock.Lock();
+
+        PluginHost::ISecurity* officer = nullptr;
+        auto cached = _officers.find(digest);
+
+        if (cached != _officers.end()) {
+            officer = cached->second;
+        } else {
+            if (_auth == nullptr) {
+                _auth = _service->QueryInterfaceByCallsign<PluginHost::IAuthenticate>(_T("SecurityAgent"));
+            }
+
+            string encoded;
+            if ((_auth != nullptr) && (_auth->CreateToken(
+                    static_cast<uint16_t>(token.length()),
+                    reinterpret_cast<const uint8_t *>(token.c_str()),
+                    encoded) == Core::ERROR_NONE)) {
+                officer = _auth->Officer(encoded);
+                if (officer != nullptr) {
+                    if (_officers.size() >= MESSENGER_OFFICER_CACHE_SIZE) {
+                        for (auto& entry : _officers) {
+                            entry.second->Release();
+                        }
+                        _officers.clear();
+                    }
+                    _officers.emplace(digest, officer);
+                }
+            }
+        }
+
+        if (officer != nullptr) {
+            Core::JSONRPC::Message message;
+            message.Designator = designator;
+
+            result = officer->Allowed(message);
+        }
+
+        _securityLock.Unlock();
+
+        return result;
+    }
+
+    void Messenger::ReleaseSecurity()
+    {
+        _securityLock.Lock();
+
+        for (auto& entry : _officers) {
+            entry.second->Release();
+        }
+        _officers.clear();
+
+        if (_auth != nullptr) {
+            _auth->Release();
+            _auth = nullptr;
+        }
+
+        _securityLock.Unlock();
+    }
+
     // TokenCheckFunction
 
     // Note, token is assumed to be a URL
@@ -127,7 +172,7 @@ namespace Plugin {
                         TRACE(Trace::Error, (_T("ACL is empty")));
                     } else if (roomExists) {
                         TRACE(Trace::Error, (_T("Can't set ACL of an active room '%s'"), room.c_str()));
-                    } else if (!IsAllowed(_service, token, _service->Callsign() + ".acl")) {
+                    } else if (!IsAllowed(token, _service->Callsign() + ".acl")) {
                         TRACE(Trace::Error, (_T("Not permitted to set ACL")));
                     } else {
                         auto retval = _roomACL.emplace(std::piecewise_construct,
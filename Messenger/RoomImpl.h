@@ -28,11 +28,24 @@ namespace WPEFramework {
 namespace Plugin {
 
     class RoomImpl : public Exchange::IRoomAdministrator::IRoom {
+    private:
+        // Messages not yet handed to a user's sink. A sink that does not keep up
+        // loses the oldest ones rather than holding up the sender.
+        static constexpr uint16_t OutboxLimit = 64;
+
+        struct Message {
+            string sender;
+            string text;
+        };
+
     public:
         RoomImpl() = delete;
         RoomImpl(const RoomImpl&) = delete;
         RoomImpl& operator=(const RoomImpl&) = delete;
 
+        #ifdef __WINDOWS__
+        #pragma warning(disable: 4355)
+        #endif
         RoomImpl(RoomMaintainer* admin, const string& roomId, const string& userId, IMsgNotification* messageSink)
             : _roomId(roomId)
             , _userId(userId)
@@ -40,6 +53,10 @@ namespace Plugin {
             , _callback(nullptr)
             , _messageSink(messageSink)
             , _adminLock()
+            , _outbox()
+            , _dropped(0)
+            , _outboxLock()
+            , _delivery(*this)
         {
             ASSERT(admin != nullptr);
 
@@ -53,6 +70,9 @@ namespace Plugin {
                 TRACE(Trace::Warning, (_T("Created a user with empty userId")));
             }
         }
+        #ifdef __WINDOWS__
+        #pragma warning(default: 4355)
+        #endif
 
         virtual ~RoomImpl()
         {
@@ -60,6 +80,9 @@ namespace Plugin {
 
             _roomAdmin->Exit(this);
 
+            // Out of the room, nothing gets posted anymore; what was not delivered yet is dropped.
+            _delivery.Revoke();
+
             // Release the callback if necessary.
             SetCallback(nullptr);
 
@@ -135,10 +158,22 @@ namespace Plugin {
             _adminLock.Unlock();
         }
 
+        // Queues the message, it is delivered on a worker pool thread.
         void MessageReceived(const string& userId, const string& message)
         {
             if (_messageSink != nullptr) {
-                _messageSink->Message(userId, message);
+                _outboxLock.Lock();
+
+                if (_outbox.size() >= OutboxLimit) {
+                    _outbox.pop_front();
+                    _dropped++;
+                }
+
+                _outbox.push_back({ userId, message });
+
+                _outboxLock.Unlock();
+
+                _delivery.Submit();
             }
         }
 
@@ -150,6 +185,41 @@ namespace Plugin {
             INTERFACE_ENTRY(Exchange::IRoomAdministrator::IRoom)
         END_INTERFACE_MAP
 
+    private:
+        friend Core::ThreadPool::JobType<RoomImpl&>;
+
+        // Deliveries to one user never run concurrently, so the order is kept.
+        void Dispatch()
+        {
+            ASSERT(_messageSink != nullptr);
+
+            Message message;
+            uint32_t dropped;
+
+            _outboxLock.Lock();
+
+            dropped = _dropped;
+            _dropped = 0;
+
+            while (_outbox.empty() == false) {
+                message = std::move(_outbox.front());
+                _outbox.pop_front();
+
+                _outboxLock.Unlock();
+
+                _messageSink->Message(message.sender, message.text);
+
+                _outboxLock.Lock();
+            }
+
+            _outboxLock.Unlock();
+
+            if (dropped != 0) {
+                TRACE(Trace::Warning, (_T("User '%s': Dropped %u message(s) in room '%s', the receiver is too slow"),
+                        UserId().c_str(), dropped, RoomId().c_str()));
+            }
+        }
+
     private:
         string _roomId;
         string _userId;
@@ -157,6 +227,10 @@ namespace Plugin {
         Exchange::IRoomAdministrator::IRoom::ICallback* _callback;
         Exchange::IRoomAdministrator::IRoom::IMsgNotification* _messageSink;
         mutable Core::CriticalSection _adminLock;
+        std::list<Message> _outbox;
+        uint32_t _dropped;
+        Core::CriticalSection _outboxLock;
+        Core::WorkerPool::JobType<RoomImpl&> _delivery;
     };
 
 } // namespace Plugin
@@ -33,15 +33,16 @@ namespace Plugin {
         // Note: Nullptr message sink is allowed (e.g. for broadcast-only users).
 
         RoomImpl* newRoomUser = nullptr;
+        Shard& shard(ShardOf(roomId));
 
-        _adminLock.Lock();
+        shard.lock.Lock();
 
-        auto  it(_roomMap.find(roomId));
+        auto  it(shard.rooms.find(roomId));
 
-        if (it == _roomMap.end()) {
+        if (it == shard.rooms.end()) {
             // Room not found, so create one, already emplacing the first user.
             newRoomUser = Core::Service<RoomImpl>::Create<RoomImpl>(this, roomId, userId, messageSink);
-            it = _roomMap.emplace(roomId, std::list<RoomImpl*>({newRoomUser})).first;
+            it = shard.rooms.emplace(roomId, std::list<RoomImpl*>({newRoomUser})).first;
 
             TRACE(Trace::Information, (_T("Room Maintainer: Room '%s' created"), roomId.c_str()));
             if (roomId.size() == 0) {
@@ -49,9 +50,7 @@ namespace Plugin {
             }
 
             // Notify the observers about a new room.
-            for (auto& observer : _observers) {
-                observer->Created(roomId);
-            }
+            NotifyCreated(roomId);
         }
         else {
             // Room already created; try to add another user.
@@ -79,7 +78,7 @@ namespace Plugin {
                     userId.c_str(), roomId.c_str()));
         }
 
-        _adminLock.Unlock();
+        shard.lock.Unlock();
 
         // May be nullptr if the user has already joined the room earlier.
         return newRoomUser;
@@ -89,12 +88,14 @@ namespace Plugin {
     {
         ASSERT(roomUser != nullptr);
 
-        _adminLock.Lock();
+        Shard& shard(ShardOf(roomUser->RoomId()));
+
+        shard.lock.Lock();
 
-        auto it(_roomMap.find(roomUser->RoomId()));
-        ASSERT(it != _roomMap.end());
+        auto it(shard.rooms.find(roomUser->RoomId()));
+        ASSERT(it != shard.rooms.end());
 
-        if (it != _roomMap.end()) {
+        if (it != shard.rooms.end()) {
             std::list<RoomImpl*>& users = (*it).second;
 
             auto uit(std::find(users.begin(), users.end(), roomUser));
@@ -113,61 +114,69 @@ namespace Plugin {
 
                 // Was it the last user?
                 if (users.size() == 0) {
-                    _roomMap.erase(it);
+                    shard.rooms.erase(it);
 
                     TRACE(Trace::Information, (_T("Room Maintainer: Room '%s' has been destroyed"), roomUser->RoomId().c_str()));
 
                     // Notify the observers about the destruction of this room.
-                    for (auto& observer : _observers) {
-                        observer->Destroyed(roomUser->RoomId());
-                    }
+                    NotifyDestroyed(roomUser->RoomId());
                 }
             }
         }
 
-        _adminLock.Unlock();
+        shard.lock.Unlock();
     }
 
     void RoomMaintainer::Notify(RoomImpl* roomUser)
     {
         ASSERT(roomUser != nullptr);
 
-        _adminLock.Lock();
+        Shard& shard(ShardOf(roomUser->RoomId()));
 
-        auto it = _roomMap.find(roomUser->RoomId());
-        ASSERT(it != _roomMap.end());
+        shard.lock.Lock();
 
-        if (it != _roomMap.end()) {
+        auto it = shard.rooms.find(roomUser->RoomId());
+        ASSERT(it != shard.rooms.end());
+
+        if (it != shard.rooms.end()) {
             for (auto& user : (*it).second) {
                 roomUser->UserJoined(user->UserId());
             }
         }
 
-        _adminLock.Unlock();
+        shard.lock.Unlock();
     }
 
     void RoomMaintainer::Send(const string& message, RoomImpl* roomUser)
     {
         ASSERT(roomUser != nullptr);
 
-        _adminLock.Lock();
+        Shard& shard(ShardOf(roomUser->RoomId()));
+
+        shard.lock.Lock();
 
-        auto it(_roomMap.find(roomUser->RoomId()));
-        ASSERT(it != _roomMap.end());
+        auto it(shard.rooms.find(roomUser->RoomId()));
+        ASSERT(it != shard.rooms.end());
 
-        if (it != _roomMap.end()) {
+        if (it != shard.rooms.end()) {
+            // Only queues the message with every user, the delivery is asynchronous.
             for (RoomImpl* user : (*it).second) {
                 user->MessageReceived(roomUser->UserId(), message);
             }
         }
 
-        _adminLock.Unlock();
+        shard.lock.Unlock();
     }
 
     /* virtual */ void RoomMaintainer::Register(INotification* sink)
     {
         ASSERT(sink != nullptr);
 
+        // Holds all shards, so no room comes or goes while the existing ones are reported.
+        for (Shard& shard : _shards) {
+            shard.lock.Lock();
+        }
+
         _adminLock.Lock();
 
         // Make sure it's not registered multiple times.
@@ -177,12 +186,18 @@ namespace Plugin {
         sink->AddRef();
 
         // Notify the caller about all rooms created to date.
-        for (auto const& room : _roomMap) {
-            sink->Created(room.first);
+        for (Shard& shard : _shards) {
+            for (auto const& room : shard.rooms) {
+                sink->Created(room.first);
+            }
         }
 
         _adminLock.Unlock();
 
+        for (Shard& shard : _shards) {
+            shard.lock.Unlock();
+        }
+
         TRACE(Trace::Information, (_T("Room Maintainer: Registered a notification sink")));
     }
 
@@ -207,6 +222,28 @@ namespace Plugin {
         TRACE(Trace::Information, (_T("Room Maintainer: Unregistered a notification sink")));
     }
 
+    void RoomMaintainer::NotifyCreated(const string& roomId)
+    {
+        _adminLock.Lock();
+
+        for (auto& observer : _observers) {
+            observer->Created(roomId);
+        }
+
+        _adminLock.Unlock();
+    }
+
+    void RoomMaintainer::NotifyDestroyed(const string& roomId)
+    {
+        _adminLock.Lock();
+
+        for (auto& observer : _observers) {
+            observer->Destroyed(roomId);
+        }
+
+        _adminLock.Unlock();
+    }
+
 } // namespace Plugin
 
 } // namespace WPEFramework
@@ -29,13 +29,23 @@ namespace Plugin {
     class RoomImpl;
 
     class RoomMaintainer : public Exchange::IRoomAdministrator {
+    private:
+        // Rooms are spread over shards by the hash of their id, each with its own lock,
+        // so a busy room holds up only the rooms sharing its shard.
+        static constexpr uint8_t ShardCount = 16;
+
+        struct Shard {
+            std::map<string, std::list<RoomImpl*>> rooms;
+            Core::CriticalSection lock;
+        };
+
     public:
         RoomMaintainer(const RoomMaintainer&) = delete;
         RoomMaintainer& operator=(const RoomMaintainer&) = delete;
 
         RoomMaintainer()
             : _observers()
-            , _roomMap()
+            , _shards()
             , _adminLock()
         { /* empty */}
 
@@ -55,8 +65,18 @@ namespace Plugin {
         END_INTERFACE_MAP
 
     private:
+        Shard& ShardOf(const string& roomId)
+        {
+            return (_shards[std::hash<string>()(roomId) % ShardCount]);
+        }
+
+        void NotifyCreated(const string& roomId);
+        void NotifyDestroyed(const string& roomId);
+
+    private:
+        // Lock order: a shard's lock (ascending when several), then the admin lock.
         std::list<INotification*> _observers;
-        std::map<string, std::list<RoomImpl*>> _roomMap;
+        Shard _shards[ShardCount];
         mutable Core::CriticalSection _adminLock;
     };
 
@@ -0,0 +1,133 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LEAKESTIMATOR_H
+#define __LEAKESTIMATOR_H
+
+#include "Module.h"
+
+#include <math.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Online least squares fit of a memory series against time, with the samples weighted
+    // down by half every "halfLife" seconds, so the slope follows the recent trend of the
+    // service but is not thrown by a single allocation burst. The time axis is moved along
+    // with every sample, the newest one always sits at t = 0, so the sums stay small and
+    // the intercept is the fitted value of now. O(1) in time and memory per sample.
+    class LeakEstimator {
+    public:
+        LeakEstimator()
+            : _halfLife(0)
+            , _samples(0)
+            , _last(0)
+            , _s0(0)
+            , _st(0)
+            , _stt(0)
+            , _sy(0)
+            , _sty(0)
+        {
+        }
+        LeakEstimator(const LeakEstimator& copy) = default;
+        ~LeakEstimator()
+        {
+        }
+
+        LeakEstimator& operator=(const LeakEstimator&) = delete;
+
+    public:
+        inline void HalfLife(const uint32_t seconds)
+        {
+            _halfLife = seconds;
+        }
+        inline void Reset()
+        {
+            _samples = 0;
+            _last = 0;
+            _s0 = _st = _stt = _sy = _sty = 0;
+        }
+        // time in microseconds (Core::Time ticks), value in bytes
+        void Add(const uint64_t time, const uint64_t value)
+        {
+            if (_samples > 0) {
+                double dt = (time > _last ? static_cast<double>(time - _last) : 0) / (1000 * 1000);
+                double decay = (_halfLife != 0 ? pow(0.5, dt / _halfLife) : 1.0);
+
+                // Shift the samples dt back in time, then age them.
+                _stt = (_stt - (2 * dt * _st) + (dt * dt * _s0)) * decay;
+                _sty = (_sty - (dt * _sy)) * decay;
+                _st = (_st - (dt * _s0)) * decay;
+                _sy = _sy * decay;
+                _s0 = _s0 * decay;
+            }
+
+            double y = static_cast<double>(value);
+            _s0 += 1;
+            _sy += y;
+            _last = time;
+            _samples++;
+        }
+
+    public:
+        inline uint32_t Samples() const
+        {
+            return (_samples);
+        }
+        // bytes per second, 0 until the samples span some time
+        inline double Slope() const
+        {
+            double denominator = (_s0 * _stt) - (_st * _st);
+            return ((_samples > 1) && (denominator > 0) ? ((_s0 * _sty) - (_st * _sy)) / denominator : 0);
+        }
+        // bytes, fitted value at the newest sample
+        inline double Value() const
+        {
+            return (_s0 > 0 ? (_sy - (Slope() * _st)) / _s0 : 0);
+        }
+        // seconds until the fitted line reaches limit, 0 if it never does
+        inline uint32_t TimeTo(const uint64_t limit) const
+        {
+            double slope = Slope();
+            double value = Value();
+            uint32_t result = 0;
+
+            if ((slope > 0) && (limit != 0)) {
+                double seconds = (static_cast<double>(limit) - value) / slope;
+                result = (seconds <= 1 ? 1 : (seconds >= static_cast<double>(~static_cast<uint32_t>(0)) ? ~static_cast<uint32_t>(0) : static_cast<uint32_t>(seconds)));
+            }
+            return (result);
+        }
+
+    private:
+        uint32_t _halfLife; // s, 0 weighs all samples the same
+        uint32_t _samples;
+        uint64_t _last;
+        // Weighted sums of 1, t, t^2, y and t*y, t in seconds relative to the newest sample (<= 0)
+        double _s0;
+        double _st;
+        double _stt;
+        double _sy;
+        double _sty;
+    };
+
+}
+}
+
+#endif // __LEAKESTIMATOR_H
@@ -27,6 +27,7 @@ namespace Plugin {
     static Core::ProxyPoolType<Web::JSONBodyType<Core::JSON::ArrayType<Monitor::Data>>> jsonBodyDataFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data>> jsonBodyParamFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data::MetaData>> jsonMemoryBodyDataFactory(2);
+    static Core::ProxyPoolType<Web::TextBody> compactBodyFactory(2);
 
     /* virtual */ const string Monitor::Initialize(PluginHost::IShell* service)
     {
@@ -38,7 +39,7 @@ namespace Plugin {
         Core::JSON::ArrayType<Config::Entry>::Iterator index(_config.Observables.Elements());
 
         // Create a list of plugins to monitor..
-        _monitor->Open(service, index);
+        _monitor->Open(service, index, _config.DeltaInterval.Value());
 
         // During the registartion, all Plugins, currently active are reported to the sink.
         service->Register(_monitor);
@@ -68,6 +69,7 @@ namespace Plugin {
     }
 
     // <GET> ../				Get all Memory Measurments
+    // <GET> ../Compact?since=<sequence>	Get the Measurements changed after sequence, in the compact binary format
     // <GET> ../<Callsign>		Get the Memory Measurements for Callsign
     // <PUT> ../<Callsign>		Reset the Memory measurements for Callsign
     /* virtual */ Core::ProxyType<Web::Response> Monitor::Process(const Web::Request& request)
@@ -94,6 +96,21 @@ namespace Plugin {
 
                     result->Body(Core::proxy_cast<Web::IBody>(response));
                 }
+                result->ContentType = Web::MIME_JSON;
+            } else if (index.Current() == _T("Compact")) {
+                uint32_t since = 0;
+
+                if (request.Query.IsSet() == true) {
+                    Core::URL::KeyValue options(request.Query.Value());
+                    since = options.Number<uint32_t>(_T("since"), 0);
+                }
+
+                Core::ProxyType<Web::TextBody> response(compactBodyFactory.Element());
+
+                _monitor->Snapshot(since, static_cast<string&>(*response));
+
+                result->Body(Core::proxy_cast<Web::IBody>(response));
+                result->ContentType = Web::MIME_BINARY;
             } else {
                 MetaData memoryInfo;
 
@@ -105,9 +122,8 @@ namespace Plugin {
 
                     result->Body(Core::proxy_cast<Web::IBody>(response));
                 }
+                result->ContentType = Web::MIME_JSON;
             }
-
-            result->ContentType = Web::MIME_JSON;
         } else if ((request.Verb == Web::Request::HTTP_PUT) && (index.Next() == true)) {
             MetaData memoryInfo;
 
@@ -21,8 +21,12 @@
 #define __MONITOR_H
 
 #include "Module.h"
+#include "LeakEstimator.h"
+#include "ProcessStatistics.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_Monitor.h>
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <string>
 
@@ -62,6 +66,44 @@ namespace Plugin {
             Core::JSON::DecUInt8 Limit;
         };
 
+        class LeakInfo : public Core::JSON::Container {
+        public:
+            LeakInfo& operator=(const LeakInfo&) = delete;
+
+            LeakInfo()
+                : Core::JSON::Container()
+                , Slope(0)
+                , HalfLife(3600)
+                , Horizon(0)
+                , IdleCPU(5)
+            {
+                Add(_T("slope"), &Slope);
+                Add(_T("halflife"), &HalfLife);
+                Add(_T("horizon"), &Horizon);
+                Add(_T("idlecpu"), &IdleCPU);
+            }
+            LeakInfo(const LeakInfo& copy)
+                : Core::JSON::Container()
+                , Slope(copy.Slope)
+                , HalfLife(copy.HalfLife)
+                , Horizon(copy.Horizon)
+                , IdleCPU(copy.IdleCPU)
+            {
+                Add(_T("slope"), &Slope);
+                Add(_T("halflife"), &HalfLife);
+                Add(_T("horizon"), &Horizon);
+                Add(_T("idlecpu"), &IdleCPU);
+            }
+            virtual ~LeakInfo()
+            {
+            }
+
+            Core::JSON::DecUInt32 Slope; // KB per hour of resident memory growth above which a leak is suspected
+            Core::JSON::DecUInt32 HalfLife; // s, age at which a memory measurement weighs half in the trend
+            Core::JSON::DecUInt32 Horizon; // s, restart when idle if the memorylimit is this close, 0 never does
+            Core::JSON::DecUInt8 IdleCPU; // % of one core, below it the service is idle
+        };
+
     public:
         class MetaData {
         public:
@@ -70,6 +112,11 @@ namespace Plugin {
                 , _allocated()
                 , _shared()
                 , _process()
+                , _cpu()
+                , _voluntarySwitches()
+                , _involuntarySwitches()
+                , _readBytes()
+                , _writeBytes()
                 , _operational(false)
             {
             }
@@ -78,6 +125,11 @@ namespace Plugin {
                 , _allocated(copy._allocated)
                 , _shared(copy._shared)
                 , _process(copy._process)
+                , _cpu(copy._cpu)
+                , _voluntarySwitches(copy._voluntarySwitches)
+                , _involuntarySwitches(copy._involuntarySwitches)
+                , _readBytes(copy._readBytes)
+                , _writeBytes(copy._writeBytes)
                 , _operational(copy._operational)
             {
             }
@@ -91,6 +143,11 @@ namespace Plugin {
                 _allocated = rhs._allocated;
                 _shared = rhs._shared;
                 _process = rhs._process;
+                _cpu = rhs._cpu;
+                _voluntarySwitches = rhs._voluntarySwitches;
+                _involuntarySwitches = rhs._involuntarySwitches;
+                _readBytes = rhs._readBytes;
+                _writeBytes = rhs._writeBytes;
                 _operational = rhs._operational;
 
                 return (*this);
@@ -104,6 +161,14 @@ namespace Plugin {
                 _shared.Set(memInterface->Shared());
                 _process.Set(memInterface->Processes());
             }
+            void Measure(const ProcessStatistics::Counters& delta, const uint32_t cpuPercent)
+            {
+                _cpu.Set(cpuPercent);
+                _voluntarySwitches.Set(delta.VoluntarySwitches);
+                _involuntarySwitches.Set(delta.InvoluntarySwitches);
+                _readBytes.Set(delta.ReadBytes);
+                _writeBytes.Set(delta.WriteBytes);
+            }
             void Operational(const bool operational)
             {
                 _operational = operational;
@@ -114,6 +179,11 @@ namespace Plugin {
                 _allocated.Reset();
                 _shared.Reset();
                 _process.Reset();
+                _cpu.Reset();
+                _voluntarySwitches.Reset();
+                _involuntarySwitches.Reset();
+                _readBytes.Reset();
+                _writeBytes.Reset();
             }
 
         public:
@@ -133,6 +203,30 @@ namespace Plugin {
             {
                 return (_process);
             }
+            inline const Core::MeasurementType<uint64_t>& CPU() const
+            {
+                return (_cpu);
+            }
+            inline const Core::MeasurementType<uint64_t>& VoluntarySwitches() const
+            {
+                return (_voluntarySwitches);
+            }
+            inline const Core::MeasurementType<uint64_t>& InvoluntarySwitches() const
+            {
+                return (_involuntarySwitches);
+            }
+            inline const Core::MeasurementType<uint64_t>& ReadBytes() const
+            {
+                return (_readBytes);
+            }
+            inline const Core::MeasurementType<uint64_t>& WriteBytes() const
+            {
+                return (_writeBytes);
+            }
+            inline bool HasStatistics() const
+            {
+                return (_cpu.Measurements() > 0);
+            }
             inline bool Operational() const
             {
                 return (_operational);
@@ -143,6 +237,11 @@ namespace Plugin {
             Core::MeasurementType<uint64_t> _allocated;
             Core::MeasurementType<uint64_t> _shared;
             Core::MeasurementType<uint8_t> _process;
+            Core::MeasurementType<uint64_t> _cpu; // % of one core, per measurement interval
+            Core::MeasurementType<uint64_t> _voluntarySwitches; // per measurement interval
+            Core::MeasurementType<uint64_t> _involuntarySwitches;
+            Core::MeasurementType<uint64_t> _readBytes;
+            Core::MeasurementType<uint64_t> _writeBytes;
             bool _operational;
         };
 
@@ -249,6 +348,11 @@ namespace Plugin {
                     , Resident()
                     , Shared()
                     , Process()
+                    , CPU()
+                    , VoluntarySwitches()
+                    , InvoluntarySwitches()
+                    , ReadBytes()
+                    , WriteBytes()
                     , Operational()
                     , Count()
                 {
@@ -256,6 +360,11 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("voluntaryswitches"), &VoluntarySwitches);
+                    Add(_T("involuntaryswitches"), &InvoluntarySwitches);
+                    Add(_T("readbytes"), &ReadBytes);
+                    Add(_T("writebytes"), &WriteBytes);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
                 }
@@ -266,6 +375,11 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("voluntaryswitches"), &VoluntarySwitches);
+                    Add(_T("involuntaryswitches"), &InvoluntarySwitches);
+                    Add(_T("readbytes"), &ReadBytes);
+                    Add(_T("writebytes"), &WriteBytes);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
 
@@ -273,6 +387,13 @@ namespace Plugin {
                     Resident = input.Resident();
                     Shared = input.Shared();
                     Process = input.Process();
+                    if (input.HasStatistics() == true) {
+                        CPU = input.CPU();
+                        VoluntarySwitches = input.VoluntarySwitches();
+                        InvoluntarySwitches = input.InvoluntarySwitches();
+                        ReadBytes = input.ReadBytes();
+                        WriteBytes = input.WriteBytes();
+                    }
                     Operational = input.Operational();
                     Count = input.Allocated().Measurements();
                 }
@@ -282,6 +403,11 @@ namespace Plugin {
                     , Resident(copy.Resident)
                     , Shared(copy.Shared)
                     , Process(copy.Process)
+                    , CPU(copy.CPU)
+                    , VoluntarySwitches(copy.VoluntarySwitches)
+                    , InvoluntarySwitches(copy.InvoluntarySwitches)
+                    , ReadBytes(copy.ReadBytes)
+                    , WriteBytes(copy.WriteBytes)
                     , Operational(copy.Operational)
                     , Count(copy.Count)
                 {
@@ -289,6 +415,11 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("voluntaryswitches"), &VoluntarySwitches);
+                    Add(_T("involuntaryswitches"), &InvoluntarySwitches);
+                    Add(_T("readbytes"), &ReadBytes);
+                    Add(_T("writebytes"), &WriteBytes);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
                 }
@@ -302,6 +433,11 @@ namespace Plugin {
                     Resident = RHS.Resident;
                     Shared = RHS.Shared;
                     Process = RHS.Process;
+                    CPU = RHS.CPU;
+                    VoluntarySwitches = RHS.VoluntarySwitches;
+                    InvoluntarySwitches = RHS.InvoluntarySwitches;
+                    ReadBytes = RHS.ReadBytes;
+                    WriteBytes = RHS.WriteBytes;
                     Operational = RHS.Operational;
                     Count = RHS.Count;
 
@@ -313,6 +449,13 @@ namespace Plugin {
                     Resident = RHS.Resident();
                     Shared = RHS.Shared();
                     Process = RHS.Process();
+                    if (RHS.HasStatistics() == true) {
+                        CPU = RHS.CPU();
+                        VoluntarySwitches = RHS.VoluntarySwitches();
+                        InvoluntarySwitches = RHS.InvoluntarySwitches();
+                        ReadBytes = RHS.ReadBytes();
+                        WriteBytes = RHS.WriteBytes();
+                    }
                     Operational = RHS.Operational();
                     Count = RHS.Allocated().Measurements();
 
@@ -324,6 +467,11 @@ namespace Plugin {
                 Measurement Resident;
                 Measurement Shared;
                 Measurement Process;
+                Measurement CPU;
+                Measurement VoluntarySwitches;
+                Measurement InvoluntarySwitches;
+                Measurement ReadBytes;
+                Measurement WriteBytes;
                 Core::JSON::Boolean Operational;
                 Core::JSON::DecUInt32 Count;
             };
@@ -382,6 +530,70 @@ namespace Plugin {
             RestartInfo Restart;
         };
 
+        class CompactData : public Core::JSON::Container {
+        public:
+            CompactData(const CompactData&) = delete;
+            CompactData& operator=(const CompactData&) = delete;
+
+            CompactData()
+                : Core::JSON::Container()
+            {
+                Add(_T("sequence"), &Sequence);
+                Add(_T("data"), &Payload);
+            }
+            ~CompactData()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Sequence;
+            Core::JSON::String Payload; // Base64 encoded compact snapshot
+        };
+
+        class LeakData : public Core::JSON::Container {
+        public:
+            LeakData(const LeakData&) = delete;
+            LeakData& operator=(const LeakData&) = delete;
+
+            LeakData()
+                : Core::JSON::Container()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("resident"), &Resident);
+                Add(_T("allocated"), &Allocated);
+                Add(_T("timetolimit"), &TimeToLimit);
+                Add(_T("restart"), &Restart);
+            }
+            ~LeakData()
+            {
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecSInt64 Resident; // KB per hour
+            Core::JSON::DecSInt64 Allocated; // KB per hour
+            Core::JSON::DecUInt32 TimeToLimit; // s until the memorylimit is reached, 0 without one
+            Core::JSON::Boolean Restart; // restarted before the limit, once idle
+        };
+
+        class SnapshotParams : public Core::JSON::Container {
+        public:
+            SnapshotParams(const SnapshotParams&) = delete;
+            SnapshotParams& operator=(const SnapshotParams&) = delete;
+
+            SnapshotParams()
+                : Core::JSON::Container()
+            {
+                Add(_T("since"), &Since);
+            }
+            ~SnapshotParams()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Since;
+        };
+
     private:
         Monitor(const Monitor&);
         Monitor& operator=(const Monitor&);
@@ -405,6 +617,9 @@ namespace Plugin {
                     Add(_T("memorylimit"), &MetaDataLimit);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("cpulimit"), &CPULimit);
+                    Add(_T("cpusamples"), &CPUSamples);
+                    Add(_T("leak"), &Leak);
                 }
                 Entry(const Entry& copy)
                     : Core::JSON::Container()
@@ -413,12 +628,18 @@ namespace Plugin {
                     , MetaDataLimit(copy.MetaDataLimit)
                     , Operational(copy.Operational)
                     , Restart(copy.Restart)
+                    , CPULimit(copy.CPULimit)
+                    , CPUSamples(copy.CPUSamples)
+                    , Leak(copy.Leak)
                 {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("cpulimit"), &CPULimit);
+                    Add(_T("cpusamples"), &CPUSamples);
+                    Add(_T("leak"), &Leak);
                 }
                 ~Entry()
                 {
@@ -430,13 +651,18 @@ namespace Plugin {
                 Core::JSON::DecUInt32 MetaDataLimit;
                 Core::JSON::DecSInt32 Operational;
                 RestartInfo Restart;
+                Core::JSON::DecUInt32 CPULimit; // % of one core, 0 disables the check
+                Core::JSON::DecUInt8 CPUSamples; // consecutive memory measurements above the limit
+                LeakInfo Leak; // trend of the resident memory, off without a slope
             };
 
         public:
             Config()
                 : Core::JSON::Container()
+                , DeltaInterval(0)
             {
                 Add(_T("observables"), &Observables);
+                Add(_T("deltainterval"), &DeltaInterval);
             }
             ~Config()
             {
@@ -444,6 +670,7 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Entry> Observables;
+            Core::JSON::DecUInt32 DeltaInterval; // Seconds between "measurements" events, 0 disables them
         };
 
         class MonitorObjects : public PluginHost::IPlugin::INotification {
@@ -451,6 +678,9 @@ namespace Plugin {
             using Job = Core::ThreadPool::JobType<MonitorObjects>;
 
             class MonitorObject {
+            private:
+                static constexpr uint32_t LeakMinSamples = 12;
+
             public:
                 MonitorObject() = delete;
                 MonitorObject& operator=(const MonitorObject&) = delete;
@@ -458,7 +688,11 @@ namespace Plugin {
                 enum evaluation {
                     SUCCESFULL = 0x00,
                     NOT_OPERATIONAL = 0x01,
-                    EXCEEDED_MEMORY = 0x02
+                    EXCEEDED_MEMORY = 0x02,
+                    MEASURED = 0x04,
+                    EXCEEDED_CPU = 0x08,
+                    LEAK_SUSPECTED = 0x10,
+                    LEAK_RESTART = 0x20
                 };
 
                 typedef struct {
@@ -474,7 +708,13 @@ namespace Plugin {
                     const uint64_t memoryThreshold,
                     const uint64_t absTime,
                     const uint16_t restartWindow,
-                    const uint8_t restartLimit)
+                    const uint8_t restartLimit,
+                    const uint32_t cpuThreshold,
+                    const uint8_t cpuSamples,
+                    const uint32_t leakSlope,
+                    const uint32_t leakHalfLife,
+                    const uint32_t leakHorizon,
+                    const uint8_t idleCPU)
                     : _operationalInterval(operationalInterval)
                     , _memoryInterval(memoryInterval)
                     , _memoryThreshold(memoryThreshold * 1024)
@@ -489,8 +729,21 @@ namespace Plugin {
                     , _operationalEvaluate(actOnOperational)
                     , _source(nullptr)
                     , _active{ false }
+                    , _sequence(0)
+                    , _cpuThreshold(cpuThreshold)
+                    , _cpuSamples(cpuSamples == 0 ? 1 : cpuSamples)
+                    , _cpuExceeded(0)
+                    , _statistics()
+                    , _leakSlope(static_cast<double>(leakSlope) * 1024 / 3600)
+                    , _leakHorizon(leakHorizon)
+                    , _idleCPU(idleCPU)
+                    , _leakSuspected(false)
+                    , _resident()
+                    , _allocated()
                 {
                     ASSERT((_operationalInterval != 0) || (_memoryInterval != 0));
+                    _resident.HalfLife(leakHalfLife);
+                    _allocated.HalfLife(leakHalfLife);
                     _interval = gcd(_operationalInterval, _memoryInterval);
                 }
                 MonitorObject(const MonitorObject& copy)
@@ -509,6 +762,17 @@ namespace Plugin {
                     , _source(copy._source)
                     , _interval(copy._interval)
                     , _active{ copy._active }
+                    , _sequence(copy._sequence)
+                    , _cpuThreshold(copy._cpuThreshold)
+                    , _cpuSamples(copy._cpuSamples)
+                    , _cpuExceeded(copy._cpuExceeded)
+                    , _statistics(copy._statistics)
+                    , _leakSlope(copy._leakSlope)
+                    , _leakHorizon(copy._leakHorizon)
+                    , _idleCPU(copy._idleCPU)
+                    , _leakSuspected(copy._leakSuspected)
+                    , _resident(copy._resident)
+                    , _allocated(copy._allocated)
                 {
                     if (_source != nullptr) {
                         _source->AddRef();
@@ -582,6 +846,7 @@ namespace Plugin {
                 inline void Reset()
                 {
                     _measurement.Reset();
+                    ResetLeak();
                 }
                 inline void Retrigger(uint64_t currentSlot)
                 {
@@ -601,9 +866,14 @@ namespace Plugin {
                         _source->AddRef();
                     }
 
+                    // (De)activated, the hosting process (if any) changes.
+                    _statistics.Reset();
+                    _cpuExceeded = 0;
+                    ResetLeak();
+
                     _measurement.Operational(_source != nullptr);
                 }
-                inline uint32_t Evaluate()
+                inline uint32_t Evaluate(const string& callsign)
                 {
                     uint32_t status(SUCCESFULL);
                     if (_source != nullptr) {
@@ -611,6 +881,7 @@ namespace Plugin {
                         _memorySlots -= _interval;
 
                         if ((_operationalInterval != 0) && (_operationalSlots == 0)) {
+                            status |= MEASURED;
                             bool operational = _source->IsOperational();
                             _measurement.Operational(operational);
                             if (operational == false) {
@@ -620,21 +891,91 @@ namespace Plugin {
                             _operationalSlots = _operationalInterval;
                         }
                         if ((_memoryInterval != 0) && (_memorySlots == 0)) {
+                            status |= MEASURED;
                             _measurement.Measure(_source);
 
                             if ((_memoryThreshold != 0) && (_measurement.Resident().Last() > _memoryThreshold)) {
                                 status |= EXCEEDED_MEMORY;
                                 TRACE(Trace::Error, (_T("Status MetaData Exceeded. %d"), __LINE__));
                             }
+
+                            ProcessStatistics::Counters delta;
+                            uint32_t cpuPercent = 0;
+                            bool idle = false;
+                            if (_statistics.Measure(callsign, delta, cpuPercent) == true) {
+                                _measurement.Measure(delta, cpuPercent);
+                                idle = (cpuPercent <= _idleCPU);
+
+                                if ((_cpuThreshold != 0) && (cpuPercent > _cpuThreshold)) {
+                                    if (++_cpuExceeded >= _cpuSamples) {
+                                        status |= EXCEEDED_CPU;
+                                        _cpuExceeded = 0;
+                                        TRACE(Trace::Error, (_T("Status CPU Exceeded. %d"), __LINE__));
+                                    }
+                                } else {
+                                    _cpuExceeded = 0;
+                                }
+                            }
+
+                            if (_leakSlope != 0) {
+                                status |= EvaluateLeak(idle);
+                            }
                             _memorySlots = _memoryInterval;
                         }
                     }
                     return (status);
                 }
 
+                // KB per hour
+                int64_t ResidentSlope() const { return static_cast<int64_t>(_resident.Slope() * 3600 / 1024); }
+                int64_t AllocatedSlope() const { return static_cast<int64_t>(_allocated.Slope() * 3600 / 1024); }
+                uint32_t TimeToLimit() const { return _resident.TimeTo(_memoryThreshold); }
+                bool HasLeakRestart() const { return ((_leakHorizon != 0) && (_memoryThreshold != 0) && (_operationalEvaluate == true)); }
+
                 bool IsActive() const { return _active; }
                 void Active(bool active) { _active = active; }
 
+                // Sequence number of the last change, used for delta snapshots
+                uint32_t Sequence() const { return _sequence; }
+                void Sequence(const uint32_t sequence) { _sequence = sequence; }
+
+            private:
+                // The trend of the resident memory says a leak when it grows faster than _leakSlope,
+                // and no longer when it falls below half of that. A suspected leak that will reach
+                // the memory limit within _leakHorizon restarts the service the first time it is idle,
+                // rather than waiting for the limit to hit, maybe in the middle of playback.
+                uint32_t EvaluateLeak(const bool idle)
+                {
+                    uint32_t status(SUCCESFULL);
+                    uint64_t now(Core::Time::Now().Ticks());
+
+                    _resident.Add(now, _measurement.Resident().Last());
+                    _allocated.Add(now, _measurement.Allocated().Last());
+
+                    if (_resident.Samples() >= LeakMinSamples) {
+                        double slope(_resident.Slope());
+
+                        if ((_leakSuspected == false) && (slope > _leakSlope)) {
+                            _leakSuspected = true;
+                            status |= LEAK_SUSPECTED;
+                            TRACE(Trace::Error, (_T("Status leak suspected. %d"), __LINE__));
+                        } else if ((_leakSuspected == true) && (slope < (_leakSlope / 2))) {
+                            _leakSuspected = false;
+                        }
+
+                        if ((_leakSuspected == true) && (idle == true) && (HasLeakRestart() == true) && (TimeToLimit() <= _leakHorizon)) {
+                            status |= LEAK_RESTART;
+                        }
+                    }
+                    return (status);
+                }
+                inline void ResetLeak()
+                {
+                    _resident.Reset();
+                    _allocated.Reset();
+                    _leakSuspected = false;
+                }
+
             private:
                 const uint32_t _operationalInterval; //!< Interval (s) to check the monitored processes
                 const uint32_t _memoryInterval; //!<  Interval (s) for a memory measurement.
@@ -651,6 +992,17 @@ namespace Plugin {
                 Exchange::IMemory* _source;
                 uint32_t _interval; //!< The greatest possible interval to check both memory and processes.
                 bool _active;
+                uint32_t _sequence;
+                const uint32_t _cpuThreshold; //!< CPU usage (% of one core) above which the service misbehaves.
+                const uint8_t _cpuSamples; //!< Consecutive measurements above _cpuThreshold before acting.
+                uint8_t _cpuExceeded;
+                ProcessStatistics _statistics;
+                const double _leakSlope; //!< Resident memory growth (bytes/s) above which a leak is suspected, 0 disables.
+                const uint32_t _leakHorizon; //!< Time to the memory limit (s) below which a leaking service is restarted when idle.
+                const uint8_t _idleCPU; //!< CPU usage (% of one core) up to which the service is idle.
+                bool _leakSuspected;
+                LeakEstimator _resident;
+                LeakEstimator _allocated;
             };
 
         public:
@@ -666,6 +1018,10 @@ namespace Plugin {
                 , _job(*this)
                 , _service(nullptr)
                 , _parent(*parent)
+                , _sequence(0)
+                , _published(0)
+                , _deltaInterval(0)
+                , _nextDelta(0)
             {
             }
 #ifdef __WINDOWS__
@@ -697,12 +1053,15 @@ namespace Plugin {
 
                 _adminLock.Unlock();
             }
-            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
+            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index, const uint32_t deltaInterval)
             {
                 ASSERT((service != nullptr) && (_service == nullptr));
 
                 uint64_t baseTime = Core::Time::Now().Ticks();
 
+                _deltaInterval = static_cast<uint64_t>(deltaInterval) * 1000 * 1000; // Move from Seconds to MicroSeconds
+                _nextDelta = baseTime;
+
                 _service = service;
                 _service->AddRef();
 
@@ -717,6 +1076,9 @@ namespace Plugin {
                     uint32_t memory(element.MetaData.Value() * 1000 * 1000); // Move from Seconds to MicroSeconds
                     uint16_t restartWindow = 0;
                     uint8_t restartLimit = 0;
+                    uint32_t cpuThreshold(element.CPULimit.Value());
+                    uint8_t cpuSamples(element.CPUSamples.IsSet() ? element.CPUSamples.Value() : 3);
+                    uint32_t leakSlope(element.Leak.IsSet() ? element.Leak.Slope.Value() : 0);
 
                     if (element.Restart.IsSet()) {
                         restartWindow = element.Restart.Window;
@@ -732,7 +1094,13 @@ namespace Plugin {
                                 memoryThreshold, 
                                 baseTime, 
                                 restartWindow, 
-                                restartLimit)));
+                                restartLimit,
+                                cpuThreshold,
+                                cpuSamples,
+                                leakSlope,
+                                element.Leak.HalfLife.Value(),
+                                element.Leak.Horizon.Value(),
+                                element.Leak.IdleCPU.Value())));
                     }
                 }
 
@@ -784,10 +1152,12 @@ namespace Plugin {
 
                         if (memory != nullptr) {
                             index->second.Set(memory);
+                            index->second.Sequence(++_sequence);
                             memory->Release();
                         }
                     } else if (currentState == PluginHost::IShell::DEACTIVATION) {
                         index->second.Set(nullptr);
+                        index->second.Sequence(++_sequence);
                     } else if ((currentState == PluginHost::IShell::DEACTIVATED)) {
                         index->second.Active(false);
                         if ((index->second.HasRestartAllowed() == true) && ((service->Reason() == PluginHost::IShell::MEMORY_EXCEEDED) || (service->Reason() == PluginHost::IShell::FAILURE))) {
@@ -825,6 +1195,64 @@ namespace Plugin {
 
                 _adminLock.Unlock();
             }
+            // Packs the observables that changed after sequence "since" (0 for all of them) into
+            // a compact binary record and returns the current sequence. Layout, little endian:
+            //   u8 version, u32 sequence, u16 count, then per observable:
+            //   u8 name length, name, u32 sequence, u8 flags (0x01 operational, 0x02 measured,
+            //   0x04 process statistics), u32 count, if measured, min/max/average/last of allocated,
+            //   resident, shared (u64) and process (u8) and, with process statistics, min/max/average/last
+            //   of cpu, voluntary and involuntary switches, read and written bytes (u64).
+            uint32_t Snapshot(const uint32_t since, string& buffer)
+            {
+                _adminLock.Lock();
+
+                uint32_t sequence = _sequence;
+                uint16_t count = 0;
+
+                buffer.clear();
+                Append<uint8_t>(buffer, 1);
+                Append<uint32_t>(buffer, sequence);
+                Append<uint16_t>(buffer, 0);
+
+                for (auto& element : _monitor) {
+                    const MonitorObject& object(element.second);
+
+                    if ((object.Sequence() > since) && (count < std::numeric_limits<uint16_t>::max())) {
+                        const MetaData& metaData(object.Measurement());
+                        uint8_t length = static_cast<uint8_t>(std::min(element.first.length(), static_cast<size_t>(std::numeric_limits<uint8_t>::max())));
+                        bool measured = object.HasMeasurement();
+                        bool statistics = metaData.HasStatistics();
+
+                        Append<uint8_t>(buffer, length);
+                        buffer.append(element.first, 0, length);
+                        Append<uint32_t>(buffer, object.Sequence());
+                        Append<uint8_t>(buffer, (metaData.Operational() ? 0x01 : 0x00) | (measured ? 0x02 : 0x00) | (statistics ? 0x04 : 0x00));
+                        Append<uint32_t>(buffer, metaData.Allocated().Measurements());
+
+                        if (measured == true) {
+                            Append(buffer, metaData.Allocated());
+                            Append(buffer, metaData.Resident());
+                            Append(buffer, metaData.Shared());
+                            Append(buffer, metaData.Process());
+                        }
+                        if (statistics == true) {
+                            Append(buffer, metaData.CPU());
+                            Append(buffer, metaData.VoluntarySwitches());
+                            Append(buffer, metaData.InvoluntarySwitches());
+                            Append(buffer, metaData.ReadBytes());
+                            Append(buffer, metaData.WriteBytes());
+                        }
+                        count++;
+                    }
+                }
+
+                buffer[5] = static_cast<char>(count & 0xFF);
+                buffer[6] = static_cast<char>(count >> 8);
+
+                _adminLock.Unlock();
+
+                return (sequence);
+            }
             bool Snapshot(const string& name, Monitor::MetaData& result)
             {
                 bool found = false;
@@ -896,6 +1324,7 @@ namespace Plugin {
                 if (index != _monitor.end()) {
                     result = index->second.Measurement();
                     index->second.Reset();
+                    index->second.Sequence(++_sequence);
                     found = true;
                 }
 
@@ -914,6 +1343,7 @@ namespace Plugin {
 
                 if (index != _monitor.end()) {
                     index->second.Reset();
+                    index->second.Sequence(++_sequence);
                     found = true;
                 }
 
@@ -947,20 +1377,34 @@ namespace Plugin {
                     }
 
                     if (info.TimeSlot() <= scheduledTime) {
-                        uint32_t value(info.Evaluate());
+                        uint32_t value(info.Evaluate(index->first));
 
-                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY)) != 0) {
+                        if ((value & MonitorObject::MEASURED) != 0) {
+                            info.Sequence(++_sequence);
+                        }
+
+                        if ((value & MonitorObject::LEAK_SUSPECTED) != 0) {
+                            SYSLOG(Logging::Notification, (_T("Leak suspected: %s grows %lld KB/h."), index->first.c_str(), static_cast<long long>(info.ResidentSlope())));
+                            _parent.event_leak(index->first, info.ResidentSlope(), info.AllocatedSlope(), info.TimeToLimit(), info.HasLeakRestart());
+                        }
+
+                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_CPU | MonitorObject::LEAK_RESTART)) != 0) {
                             PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(index->first));
 
                             if (plugin != nullptr) {
-                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & MonitorObject::EXCEEDED_MEMORY) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                                // A leak restart is handled as MEMORY_EXCEEDED, it is the limit it reaches otherwise.
+                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::LEAK_RESTART)) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+
+                                // A CPU spin is handled as a FAILURE, so the restart limits apply to it as well.
+                                const TCHAR* reason(((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_CPU)) == 0) ? _T("LEAK_SUSPECTED") :
+                                    ((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_CPU)) == MonitorObject::EXCEEDED_CPU) ? _T("EXCEEDED_CPU") : why.Data());
 
-                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + why.Data() + "\" }");
-                                SYSLOG(Trace::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), why.Data()));
+                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + reason + "\" }");
+                                SYSLOG(Trace::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), reason));
 
                                 _service->Notify(message);
 
-                                _parent.event_action(plugin->Callsign(), "Deactivate", why.Data());
+                                _parent.event_action(plugin->Callsign(), "Deactivate", reason);
 
                                 Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
 
@@ -977,6 +1421,16 @@ namespace Plugin {
                     index++;
                 }
 
+                if ((_deltaInterval != 0) && (_sequence != _published) && (scheduledTime >= _nextDelta)) {
+                    // Batch all changes since the last event into one compact delta
+                    string delta;
+                    uint32_t published = _published;
+                    _published = Snapshot(published, delta);
+                    _nextDelta = scheduledTime + _deltaInterval;
+
+                    _parent.event_measurements(_published, delta);
+                }
+
                 if (nextSlot != static_cast<uint64_t>(~0)) {
                     if (nextSlot < Core::Time::Now().Ticks()) {
                         _job.Submit();
@@ -990,6 +1444,22 @@ namespace Plugin {
             }
 
         private:
+            template <typename T>
+            static void Append(string& buffer, T value)
+            {
+                for (uint8_t index = 0; index < sizeof(T); index++) {
+                    buffer.push_back(static_cast<char>(value & 0xFF));
+                    value = static_cast<T>(value >> 8);
+                }
+            }
+            template <typename T>
+            static void Append(string& buffer, const Core::MeasurementType<T>& measurement)
+            {
+                Append<T>(buffer, measurement.Min());
+                Append<T>(buffer, measurement.Max());
+                Append<T>(buffer, measurement.Average());
+                Append<T>(buffer, measurement.Last());
+            }
             template <typename T>
             void translate(const Core::MeasurementType<T>& from, JsonData::Monitor::MeasurementInfo* to)
             {
@@ -1004,6 +1474,10 @@ namespace Plugin {
             Core::WorkerPool::JobType<MonitorObjects&> _job;
             PluginHost::IShell* _service;
             Monitor& _parent;
+            std::atomic<uint32_t> _sequence;
+            uint32_t _published;
+            uint64_t _deltaInterval;
+            uint64_t _nextDelta;
         };
 
     public:
@@ -1080,7 +1554,10 @@ namespace Plugin {
         uint32_t endpoint_restartlimits(const JsonData::Monitor::RestartlimitsParamsData& params);
         uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, JsonData::Monitor::InfoInfo& response);
         uint32_t get_status(const string& index, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response) const;
+        uint32_t endpoint_snapshot(const SnapshotParams& params, CompactData& response);
         void event_action(const string& callsign, const string& action, const string& reason);
+        void event_measurements(const uint32_t sequence, const string& data);
+        void event_leak(const string& callsign, const int64_t resident, const int64_t allocated, const uint32_t timeToLimit, const bool restart);
     };
 }
 }
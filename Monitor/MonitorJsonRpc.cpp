@@ -34,6 +34,7 @@ namespace Plugin {
     {
         Register<RestartlimitsParamsData,void>(_T("restartlimits"), &Monitor::endpoint_restartlimits, this);
         Register<ResetstatsParamsData,InfoInfo>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
+        Register<SnapshotParams,CompactData>(_T("snapshot"), &Monitor::endpoint_snapshot, this);
         Property<Core::JSON::ArrayType<InfoInfo>>(_T("status"), &Monitor::get_status, nullptr, this);
     }
 
@@ -41,6 +42,7 @@ namespace Plugin {
     {
         Unregister(_T("resetstats"));
         Unregister(_T("restartlimits"));
+        Unregister(_T("snapshot"));
         Unregister(_T("status"));
     }
 
@@ -75,6 +77,21 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Method: snapshot - Returns the measurements changed after a sequence number in the compact format
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t Monitor::endpoint_snapshot(const SnapshotParams& params, CompactData& response)
+    {
+        string buffer;
+        response.Sequence = _monitor->Snapshot(params.Since.Value(), buffer);
+
+        string encoded;
+        Core::ToString(reinterpret_cast<const uint8_t*>(buffer.c_str()), static_cast<uint16_t>(buffer.length()), true, encoded);
+        response.Payload = encoded;
+
+        return Core::ERROR_NONE;
+    }
+
     // Property: status - The memory and process statistics either for a single plugin or all plugins watched by the Monitor
     // Return codes:
     //  - ERROR_NONE: Success
@@ -95,6 +112,32 @@ namespace Plugin {
 
         Notify(_T("action"), params);
     }
+
+    // Event: measurements - Signals the measurements changed since the previous event, in the compact format
+    void Monitor::event_measurements(const uint32_t sequence, const string& data)
+    {
+        CompactData params;
+        params.Sequence = sequence;
+
+        string encoded;
+        Core::ToString(reinterpret_cast<const uint8_t*>(data.c_str()), static_cast<uint16_t>(data.length()), true, encoded);
+        params.Payload = encoded;
+
+        Notify(_T("measurements"), params);
+    }
+
+    // Event: leak - Signals the resident memory of a service grows faster than its leak slope
+    void Monitor::event_leak(const string& callsign, const int64_t resident, const int64_t allocated, const uint32_t timeToLimit, const bool restart)
+    {
+        LeakData params;
+        params.Callsign = callsign;
+        params.Resident = resident;
+        params.Allocated = allocated;
+        params.TimeToLimit = timeToLimit;
+        params.Restart = restart;
+
+        Notify(_T("leak"), params);
+    }
 } // namespace Plugin
 }
 
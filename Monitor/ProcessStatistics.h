@@ -0,0 +1,291 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PROCESSSTATISTICS_H
+#define __PROCESSSTATISTICS_H
+
+#include "Module.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // CPU, context switch and I/O counters of the process hosting an out-of-process
+    // service, found by the "-C <callsign>" argument WPEProcess is started with, and
+    // of its direct children. Services running inside the framework process have no
+    // process of their own and are not accounted.
+    class ProcessStatistics {
+    private:
+        static constexpr uint8_t MaxAttempts = 3;
+        static constexpr uint32_t BufferSize = 2048;
+
+    public:
+        struct Counters {
+            uint64_t CPUTime; // ns, user + system
+            uint64_t VoluntarySwitches;
+            uint64_t InvoluntarySwitches;
+            uint64_t ReadBytes;
+            uint64_t WriteBytes;
+        };
+
+    public:
+        ProcessStatistics()
+            : _pid(0)
+            , _attempts(0)
+            , _valid(false)
+            , _last()
+            , _lastTime(0)
+        {
+        }
+        ProcessStatistics(const ProcessStatistics& copy)
+            : _pid(copy._pid)
+            , _attempts(copy._attempts)
+            , _valid(copy._valid)
+            , _last(copy._last)
+            , _lastTime(copy._lastTime)
+        {
+        }
+        ~ProcessStatistics()
+        {
+        }
+
+        ProcessStatistics& operator=(const ProcessStatistics&) = delete;
+
+    public:
+        // Forget the process, it is looked up again on the next Measure().
+        inline void Reset()
+        {
+            _pid = 0;
+            _attempts = 0;
+            _valid = false;
+        }
+
+        // Reads the counters and returns true if a previous sample exists to
+        // compute the delta (and the CPU usage in percent of one core) against.
+        bool Measure(const string& callsign, Counters& delta, uint32_t& cpuPercent)
+        {
+            if (_pid == 0) {
+                if (_attempts >= MaxAttempts) {
+                    return (false);
+                }
+                _attempts++;
+                _pid = Find(callsign);
+                if (_pid == 0) {
+                    return (false);
+                }
+                _valid = false;
+            }
+
+            Counters now;
+            memset(&now, 0, sizeof(now));
+
+            if (Read(_pid, now) == false) {
+                // The process is gone, look it up again next time.
+                _pid = 0;
+                _attempts = 0;
+                _valid = false;
+                return (false);
+            }
+
+            char path[64];
+            char buffer[BufferSize];
+            snprintf(path, sizeof(path), "/proc/%d/task/%d/children", _pid, _pid);
+            if (ReadFile(path, buffer) == true) {
+                char* next = buffer;
+                char* end;
+                pid_t child;
+                while ((child = static_cast<pid_t>(strtol(next, &end, 10))) > 0) {
+                    Read(child, now);
+                    next = end;
+                }
+            }
+
+            uint64_t time = Core::Time::Now().Ticks();
+            bool result = false;
+
+            if (_valid == true) {
+                // Counters of exited threads and children are lost, never report negative deltas.
+                delta.CPUTime = Difference(now.CPUTime, _last.CPUTime);
+                delta.VoluntarySwitches = Difference(now.VoluntarySwitches, _last.VoluntarySwitches);
+                delta.InvoluntarySwitches = Difference(now.InvoluntarySwitches, _last.InvoluntarySwitches);
+                delta.ReadBytes = Difference(now.ReadBytes, _last.ReadBytes);
+                delta.WriteBytes = Difference(now.WriteBytes, _last.WriteBytes);
+
+                uint64_t interval = time - _lastTime; // us
+                cpuPercent = (interval == 0) ? 0 : static_cast<uint32_t>(delta.CPUTime / (interval * 10));
+                result = true;
+            }
+
+            _last = now;
+            _lastTime = time;
+            _valid = true;
+
+            return (result);
+        }
+
+    private:
+        static inline uint64_t Difference(const uint64_t now, const uint64_t last)
+        {
+            return (now > last ? now - last : 0);
+        }
+
+        static bool ReadFile(const char path[], char buffer[])
+        {
+            bool result = false;
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                ssize_t length = read(fd, buffer, BufferSize - 1);
+                if (length >= 0) {
+                    buffer[length] = '\0';
+                    result = true;
+                }
+                close(fd);
+            }
+            return (result);
+        }
+
+        static uint64_t Field(const char buffer[], const char label[])
+        {
+            const char* position = strstr(buffer, label);
+            return (position == nullptr ? 0 : strtoull(position + strlen(label), nullptr, 10));
+        }
+
+        // Adds the counters of one process to "counters".
+        static bool Read(const pid_t pid, Counters& counters)
+        {
+            char path[64];
+            char buffer[BufferSize];
+
+            snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+            if (ReadFile(path, buffer) == false) {
+                return (false);
+            }
+
+            // utime and stime are fields 14 and 15, the command name (field 2) may contain spaces.
+            const char* fields = strrchr(buffer, ')');
+            unsigned long long utime = 0, stime = 0;
+            if ((fields == nullptr) || (sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) != 2)) {
+                return (false);
+            }
+            static const uint64_t ticks = sysconf(_SC_CLK_TCK);
+            counters.CPUTime += (utime + stime) * (1000000000 / ticks);
+
+            // Context switches are only reported per thread.
+            snprintf(path, sizeof(path), "/proc/%d/task", pid);
+            DIR* dir = opendir(path);
+            if (dir != nullptr) {
+                struct dirent* entry;
+                while ((entry = readdir(dir)) != nullptr) {
+                    if (entry->d_name[0] == '.') {
+                        continue;
+                    }
+                    snprintf(path, sizeof(path), "/proc/%d/task/%s/status", pid, entry->d_name);
+                    if (ReadFile(path, buffer) == true) {
+                        counters.VoluntarySwitches += Field(buffer, "\nvoluntary_ctxt_switches:");
+                        counters.InvoluntarySwitches += Field(buffer, "\nnonvoluntary_ctxt_switches:");
+                    }
+                }
+                closedir(dir);
+            }
+
+            // Storage I/O, accumulated over all threads by the kernel.
+            snprintf(path, sizeof(path), "/proc/%d/io", pid);
+            if (ReadFile(path, buffer) == true) {
+                counters.ReadBytes += Field(buffer, "\nread_bytes:");
+                counters.WriteBytes += Field(buffer, "\nwrite_bytes:");
+            }
+
+            return (true);
+        }
+
+        static pid_t Find(const string& callsign)
+        {
+            pid_t result = 0;
+            pid_t parent = getpid();
+            DIR* dir = opendir("/proc");
+
+            if (dir != nullptr) {
+                char path[64];
+                char buffer[BufferSize];
+                struct dirent* entry;
+
+                while ((result == 0) && ((entry = readdir(dir)) != nullptr)) {
+                    char* end;
+                    pid_t pid = static_cast<pid_t>(strtol(entry->d_name, &end, 10));
+                    if ((pid <= 0) || (*end != '\0')) {
+                        continue;
+                    }
+
+                    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+                    if (ReadFile(path, buffer) == false) {
+                        continue;
+                    }
+                    const char* fields = strrchr(buffer, ')');
+                    int ppid = 0;
+                    if ((fields == nullptr) || (sscanf(fields + 1, " %*c %d", &ppid) != 1) || (ppid != parent)) {
+                        continue;
+                    }
+
+                    snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+                    int fd = open(path, O_RDONLY | O_CLOEXEC);
+                    if (fd < 0) {
+                        continue;
+                    }
+                    ssize_t length = read(fd, buffer, BufferSize - 1);
+                    close(fd);
+                    if (length <= 0) {
+                        continue;
+                    }
+                    buffer[length] = '\0';
+
+                    // Arguments are '\0' separated
+                    const char* argument = buffer;
+                    const char* last = buffer + length;
+                    while (argument < last) {
+                        const char* next = argument + strlen(argument) + 1;
+                        if ((strcmp(argument, "-C") == 0) && (next < last) && (callsign == next)) {
+                            result = pid;
+                            break;
+                        }
+                        argument = next;
+                    }
+                }
+                closedir(dir);
+            }
+
+            return (result);
+        }
+
+    private:
+        pid_t _pid;
+        uint8_t _attempts;
+        bool _valid;
+        Counters _last;
+        uint64_t _lastTime;
+    };
+}
+}
+
+#endif // __PROCESSSTATISTICS_H
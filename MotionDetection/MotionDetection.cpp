@@ -68,7 +68,9 @@ namespace WPEFramework {
             Register("getLastMotionEventElapsedTime", &MotionDetection::getLastMotionEventElapsedTime, this);
             Register("setMotionEventsActivePeriod", &MotionDetection::setMotionEventsActivePeriod, this);
             Register("getMotionEventsActivePeriod", &MotionDetection::getMotionEventsActivePeriod, this);
+            Register("subscribeFast", &MotionDetection::subscribeFast, this);
 
+            m_filterTimer.connect(std::bind(&MotionDetection::onFilterTimer, this));
         }
 
         MotionDetection::~MotionDetection()
@@ -104,6 +106,11 @@ namespace WPEFramework {
             LOGINFO("MotionDetection Deinitialize");
 	    MOTION_DETECTION_Platform_Term();
             MotionDetection::_instance = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_filterLock);
+                m_filterTimer.stop();
+                m_filters.clear();
+            }
             Unregister("getMotionDetectors");
             Unregister("arm");
             Unregister("disarm");
@@ -115,6 +122,8 @@ namespace WPEFramework {
             Unregister("getLastMotionEventElapsedTime");
             Unregister("setMotionEventsActivePeriod");
             Unregister("getMotionEventsActivePeriod");
+            Unregister("subscribeFast");
+            m_fastEvents.close();
         }
 
         //Begin methods
@@ -215,15 +224,42 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             string index = parameters["index"].String();
-            string sPeriod = parameters["period"].String();
-            int period = stoi(sPeriod);
-            MOTION_DETECTION_Result_t rc = MOTION_DETECTION_RESULT_SUCCESS;
-            rc = MOTION_DETECTION_SetNoMotionPeriod(index.c_str(), period);
 
-            if (rc != MOTION_DETECTION_RESULT_SUCCESS) {
-                LOGERR("Failed to set no motion period..!");
+            if (!parameters.HasLabel("period") && !parameters.HasLabel("debounce") &&
+                !parameters.HasLabel("batchPeriod") && !parameters.HasLabel("activityWindow")) {
+                LOGERR("No argument 'period'");
                 returnResponse(false);
             }
+
+            if (parameters.HasLabel("period")) {
+                string sPeriod = parameters["period"].String();
+                int period = stoi(sPeriod);
+                MOTION_DETECTION_Result_t rc = MOTION_DETECTION_RESULT_SUCCESS;
+                rc = MOTION_DETECTION_SetNoMotionPeriod(index.c_str(), period);
+
+                if (rc != MOTION_DETECTION_RESULT_SUCCESS) {
+                    LOGERR("Failed to set no motion period..!");
+                    returnResponse(false);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_filterLock);
+            EventFilter& filter = m_filters[index];
+            int debounce = filter.debounceMs;
+            int batchPeriod = filter.batchPeriodMs;
+            int activityWindow = filter.activityWindowS;
+            getDefaultNumberParameter("debounce", debounce, filter.debounceMs);
+            getDefaultNumberParameter("batchPeriod", batchPeriod, filter.batchPeriodMs);
+            getDefaultNumberParameter("activityWindow", activityWindow, filter.activityWindowS);
+
+            if ((debounce < 0) || (batchPeriod < 0) || (activityWindow <= 0)) {
+                LOGERR("Invalid debounce %d, batchPeriod %d or activityWindow %d..!", debounce, batchPeriod, activityWindow);
+                returnResponse(false);
+            }
+
+            filter.debounceMs = debounce;
+            filter.batchPeriodMs = batchPeriod;
+            filter.activityWindowS = activityWindow;
             returnResponse(true);
         }
 
@@ -240,6 +276,13 @@ namespace WPEFramework {
                 returnResponse(false);
             }
             response["period"] = std::to_string(period);
+
+            std::lock_guard<std::mutex> lock(m_filterLock);
+            EventFilter& filter = m_filters[index];
+            response["debounce"] = filter.debounceMs;
+            response["batchPeriod"] = filter.batchPeriodMs;
+            response["activityWindow"] = filter.activityWindowS;
+            response["activityLevel"] = activityLevel(filter, Clock::now());
             returnResponse(true);
         }
 
@@ -408,19 +451,159 @@ namespace WPEFramework {
              }
              returnResponse(true);
         }
+
+        uint32_t MotionDetection::subscribeFast(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            // The ring is only created for the first local client, the JSON-RPC events keep going out as before
+            string name = FAST_EVENT_CHANNEL_PREFIX "MotionDetection";
+            if (!m_fastEvents.open(name))
+            {
+                returnResponse(false);
+            }
+
+            response["channel"] = name;
+            response["version"] = FAST_EVENT_CHANNEL_VERSION;
+            response["recordSize"] = (int)sizeof(Utils::FastEventRecord);
+            response["capacity"] = FAST_EVENT_CHANNEL_CAPACITY;
+            returnResponse(true);
+        }
         //End methods
 
         //Begin events
         void MotionDetection::onMotionEvent(const string& index, const string& eventType)
         {
-            JsonObject params;
-            params["index"] = index;
-            params["mode"] = eventType;
-            sendNotify("onMotionEvent", params);
+            Notifications notifications;
+            Clock::time_point now = Clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(m_filterLock);
+                EventFilter& filter = m_filters[index];
+
+                // Every raw transition counts for the activity level, also the ones debouncing drops
+                activityLevel(filter, now);
+                filter.transitions.push_back(std::make_pair(now, eventType == "1"));
+                if (filter.transitions.size() > MOTION_MAX_RAW_TRANSITIONS) {
+                    filter.motionAtWindowStart = filter.transitions.front().second;
+                    filter.transitions.pop_front();
+                }
+
+                if (filter.debounceMs == 0) {
+                    commitEvent(index, filter, eventType, now, notifications);
+                } else if (eventType == filter.reported) {
+                    // Back to the reported mode within the window: the transition was noise
+                    filter.hasPending = false;
+                } else if (!filter.hasPending || (filter.pending != eventType)) {
+                    filter.pending = eventType;
+                    filter.pendingSince = now;
+                    filter.hasPending = true;
+                }
+
+                if ((filter.hasPending || (filter.batch.Length() > 0)) && !m_filterTimer.isActive())
+                    m_filterTimer.start(MOTION_FILTER_TICK_MS);
+            }
+
+            sendNotifications(notifications);
 
             m_lastEventTime = std::chrono::system_clock::now();
         }
         //End events
 
+        void MotionDetection::onFilterTimer()
+        {
+            Notifications notifications;
+            Clock::time_point now = Clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(m_filterLock);
+                bool busy = false;
+
+                for (auto& entry : m_filters) {
+                    EventFilter& filter = entry.second;
+
+                    if (filter.hasPending && (now - filter.pendingSince >= std::chrono::milliseconds(filter.debounceMs)))
+                        commitEvent(entry.first, filter, filter.pending, now, notifications);
+                    if ((filter.batch.Length() > 0) && (now - filter.batchStart >= std::chrono::milliseconds(filter.batchPeriodMs)))
+                        flushBatch(filter, notifications);
+
+                    busy = busy || filter.hasPending || (filter.batch.Length() > 0);
+                }
+
+                if (!busy)
+                    m_filterTimer.stop();
+            }
+
+            sendNotifications(notifications);
+        }
+
+        // Called with m_filterLock held
+        void MotionDetection::commitEvent(const string& index, EventFilter& filter, const string& mode, Clock::time_point now, Notifications& notifications)
+        {
+            filter.hasPending = false;
+            if ((filter.debounceMs != 0) && (mode == filter.reported))
+                return;
+            filter.reported = mode;
+
+            JsonObject params;
+            params["index"] = index;
+            params["mode"] = mode;
+            params["activityLevel"] = activityLevel(filter, now);
+
+            const int64_t values[] = { (mode == "1") ? 1 : 0, (int64_t)params["activityLevel"].Number() };
+            m_fastEvents.publish(Utils::FAST_EVENT_MOTION, values, sizeof(values) / sizeof(values[0]), index);
+
+            if (filter.batchPeriodMs == 0) {
+                notifications.push_back(std::make_pair(string("onMotionEvent"), params));
+                return;
+            }
+
+            if (filter.batch.Length() == 0)
+                filter.batchStart = now;
+            params["time"] = (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            filter.batch.Add(params);
+        }
+
+        // Called with m_filterLock held
+        void MotionDetection::flushBatch(EventFilter& filter, Notifications& notifications)
+        {
+            JsonObject params;
+            params["events"] = filter.batch;
+            notifications.push_back(std::make_pair(string("onMotionEvents"), params));
+            filter.batch = JsonArray();
+        }
+
+        // Percentage of the activity window the sensor reported motion. Called with m_filterLock held
+        uint32_t MotionDetection::activityLevel(EventFilter& filter, Clock::time_point now)
+        {
+            const Clock::duration window = std::chrono::seconds(filter.activityWindowS);
+            const Clock::time_point windowStart = now - window;
+
+            while (!filter.transitions.empty() && (filter.transitions.front().first <= windowStart)) {
+                filter.motionAtWindowStart = filter.transitions.front().second;
+                filter.transitions.pop_front();
+            }
+
+            Clock::duration motion = Clock::duration::zero();
+            Clock::time_point since = windowStart;
+            bool inMotion = filter.motionAtWindowStart;
+            for (const auto& transition : filter.transitions) {
+                if (inMotion)
+                    motion += transition.first - since;
+                since = transition.first;
+                inMotion = transition.second;
+            }
+            if (inMotion)
+                motion += now - since;
+
+            return (uint32_t)(motion.count() * 100 / window.count());
+        }
+
+        void MotionDetection::sendNotifications(const Notifications& notifications)
+        {
+            for (const auto& notification : notifications)
+                sendNotify(notification.first.c_str(), notification.second);
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
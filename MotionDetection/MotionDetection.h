@@ -20,10 +20,23 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "tptimer.h"
 #include "motionDetector.h"
+#include "FastEventChannel.h"
+
+// Defaults keep forwarding every transition of the sensor right away
+#define MOTION_DEFAULT_DEBOUNCE_MS          0
+#define MOTION_DEFAULT_BATCH_PERIOD_MS      0
+#define MOTION_DEFAULT_ACTIVITY_WINDOW_S    60
+#define MOTION_FILTER_TICK_MS               100
+#define MOTION_MAX_RAW_TRANSITIONS          256
 
 namespace WPEFramework {
 
@@ -63,6 +76,7 @@ namespace WPEFramework {
             uint32_t getLastMotionEventElapsedTime(const JsonObject& parameters, JsonObject& response);
             uint32_t setMotionEventsActivePeriod(const JsonObject& parameters, JsonObject& response);
             uint32_t getMotionEventsActivePeriod(const JsonObject& parameters, JsonObject& response);
+            uint32_t subscribeFast(const JsonObject& parameters, JsonObject& response);
             //End methods
 
         public:
@@ -86,7 +100,41 @@ namespace WPEFramework {
             static MotionDetection* _instance;
 
         private:
+            typedef std::chrono::steady_clock Clock;
+            typedef std::vector<std::pair<string, JsonObject>> Notifications;
+
+            // Debouncing, activity level and batching of the events of one detector
+            struct EventFilter {
+                uint32_t debounceMs = MOTION_DEFAULT_DEBOUNCE_MS;
+                uint32_t batchPeriodMs = MOTION_DEFAULT_BATCH_PERIOD_MS;
+                uint32_t activityWindowS = MOTION_DEFAULT_ACTIVITY_WINDOW_S;
+
+                string reported;                // last mode sent to the subscribers
+                string pending;                 // mode waiting for the debounce window
+                bool hasPending = false;
+                Clock::time_point pendingSince;
+
+                std::deque<std::pair<Clock::time_point, bool>> transitions;     // raw, within the activity window
+                bool motionAtWindowStart = false;
+
+                JsonArray batch;
+                Clock::time_point batchStart;
+            };
+
+            void onFilterTimer();
+            void commitEvent(const string& index, EventFilter& filter, const string& mode, Clock::time_point now, Notifications& notifications);
+            void flushBatch(EventFilter& filter, Notifications& notifications);
+            uint32_t activityLevel(EventFilter& filter, Clock::time_point now);
+            void sendNotifications(const Notifications& notifications);
+
             std::chrono::system_clock::time_point m_lastEventTime;
+
+            std::mutex m_filterLock;
+            std::map<string, EventFilter> m_filters;
+            TpTimer m_filterTimer;
+
+            // Every committed event as a FAST_EVENT_MOTION record, not batched, once a local client asked for it with subscribeFast
+            Utils::FastEventChannelWriter m_fastEvents;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
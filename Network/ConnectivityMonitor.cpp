@@ -0,0 +1,417 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ConnectivityMonitor.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "DnsCache.h"
+#include "NetUtils.h"
+#include "utils.h"
+
+#define CONNECTIVITY_PROBE_TIMEOUT      5000    // ms, for all the endpoints together
+#define CONNECTIVITY_TRIGGER_DELAY      1000    // ms, connectivity events come in bursts
+#define CONNECTIVITY_CONNECTED_PERIOD   600     // s, probed again while connected
+#define CONNECTIVITY_OFFLINE_PERIOD     60      // s, probed again while not, a portal login goes unnoticed
+#define CONNECTIVITY_RESPONSE_MAX       512     // bytes, the status line is all that is read
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        namespace {
+            const char* const defaultEndpoints[] = {
+                "http://clients3.google.com/generate_204",
+                "http://connectivitycheck.gstatic.com/generate_204"
+            };
+
+            struct Probe {
+                int fd = -1;
+                bool connected = false;
+                std::string request;
+                size_t sent = 0;
+                std::string response;
+            };
+
+            bool endsWith(const std::string& value, const std::string& suffix)
+            {
+                return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+            }
+
+            // -1 until the status line is complete, 0 if it is not an HTTP one
+            int statusCode(const std::string& response)
+            {
+                size_t end = response.find("\r\n");
+                if (end == std::string::npos)
+                    return response.size() < CONNECTIVITY_RESPONSE_MAX ? -1 : 0;
+
+                int major = 0, minor = 0, code = 0;
+                if (sscanf(response.substr(0, end).c_str(), "HTTP/%d.%d %d", &major, &minor, &code) != 3)
+                    return 0;
+                return code;
+            }
+        }
+
+        ConnectivityMonitor::ConnectivityMonitor()
+            : m_state(UNKNOWN)
+            , m_trigger(false)
+            , m_running(false)
+            , m_dnsCache(nullptr)
+        {
+            for (const char* url : defaultEndpoints)
+            {
+                Endpoint endpoint;
+                if (parse(url, endpoint))
+                    m_endpoints.push_back(endpoint);
+            }
+        }
+
+        ConnectivityMonitor::~ConnectivityMonitor()
+        {
+            stop();
+        }
+
+        bool ConnectivityMonitor::start(DnsCache& dnsCache, const Callback& callback, const RouteCheck& hasRoute)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_running)
+                return true;
+
+            m_dnsCache = &dnsCache;
+            m_callback = callback;
+            m_hasRoute = hasRoute;
+            m_trigger = true;
+            m_running = true;
+            m_thread = std::thread(&ConnectivityMonitor::run, this);
+            return true;
+        }
+
+        void ConnectivityMonitor::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running = false;
+            }
+            m_condition.notify_all();
+
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+
+        void ConnectivityMonitor::setEndpoints(const std::vector<std::string>& endpoints)
+        {
+            std::vector<Endpoint> parsed;
+            for (const std::string& url : endpoints)
+            {
+                Endpoint endpoint;
+                if (parse(url, endpoint))
+                    parsed.push_back(endpoint);
+                else
+                    LOGWARN("connectivity test endpoint '%s' ignored", url.c_str());
+            }
+
+            if (parsed.empty())
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_endpoints = parsed;
+                m_trigger = true;
+            }
+            m_condition.notify_all();
+        }
+
+        void ConnectivityMonitor::trigger()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_trigger = true;
+            }
+            m_condition.notify_all();
+        }
+
+        ConnectivityMonitor::State ConnectivityMonitor::state()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_state;
+        }
+
+        const char* ConnectivityMonitor::name(State state)
+        {
+            switch (state)
+            {
+                case NO_INTERNET:       return "NO_INTERNET";
+                case LIMITED_INTERNET:  return "LIMITED_INTERNET";
+                case CAPTIVE_PORTAL:    return "CAPTIVE_PORTAL";
+                case FULLY_CONNECTED:   return "FULLY_CONNECTED";
+                default:                return "UNKNOWN";
+            }
+        }
+
+        bool ConnectivityMonitor::parse(const std::string& url, Endpoint& endpoint)
+        {
+            std::string rest = url;
+            endpoint.http = true;
+
+            size_t scheme = rest.find("://");
+            if (scheme != std::string::npos)
+            {
+                std::string name = rest.substr(0, scheme);
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                if (name == "https")
+                    endpoint.http = false;
+                else if (name != "http")
+                    return false;
+                rest = rest.substr(scheme + 3);
+            }
+
+            size_t slash = rest.find('/');
+            endpoint.path = (slash == std::string::npos) ? "/" : rest.substr(slash);
+            rest = rest.substr(0, slash);
+
+            endpoint.port = endpoint.http ? "80" : "443";
+            size_t colon = rest.rfind(':');
+            if (!rest.empty() && rest[0] == '[')
+            {
+                size_t bracket = rest.find(']');
+                if (bracket == std::string::npos)
+                    return false;
+                if (bracket + 1 < rest.size() && rest[bracket + 1] == ':')
+                    endpoint.port = rest.substr(bracket + 2);
+                rest = rest.substr(1, bracket - 1);
+            }
+            else if (colon != std::string::npos && rest.find(':') == colon)
+            {
+                endpoint.port = rest.substr(colon + 1);
+                rest = rest.substr(0, colon);
+            }
+
+            int port = atoi(endpoint.port.c_str());
+            if (rest.empty() || port <= 0 || port > 65535)
+                return false;
+
+            endpoint.host = rest;
+            endpoint.generate204 = endsWith(endpoint.path, "generate_204");
+            return true;
+        }
+
+        ConnectivityMonitor::State ConnectivityMonitor::probe(const std::vector<Endpoint>& endpoints)
+        {
+            std::vector<Probe> probes(endpoints.size());
+            bool captive = false;
+
+            for (size_t i = 0; i < endpoints.size(); i++)
+            {
+                const Endpoint& endpoint = endpoints[i];
+                std::string address;
+                DnsCache::Lookup lookup;
+                if (!m_dnsCache->resolve(endpoint.host, address, lookup))
+                {
+                    LOGINFO("%s not resolved", endpoint.host.c_str());
+                    continue;
+                }
+
+                struct sockaddr_storage storage;
+                memset(&storage, 0, sizeof(storage));
+                socklen_t length = 0;
+                uint16_t port = htons((uint16_t) atoi(endpoint.port.c_str()));
+                if (NetUtils::isIPV6(address))
+                {
+                    struct sockaddr_in6* in6 = (struct sockaddr_in6*) &storage;
+                    in6->sin6_family = AF_INET6;
+                    in6->sin6_port = port;
+                    inet_pton(AF_INET6, address.c_str(), &in6->sin6_addr);
+                    length = sizeof(*in6);
+                }
+                else
+                {
+                    struct sockaddr_in* in4 = (struct sockaddr_in*) &storage;
+                    in4->sin_family = AF_INET;
+                    in4->sin_port = port;
+                    inet_pton(AF_INET, address.c_str(), &in4->sin_addr);
+                    length = sizeof(*in4);
+                }
+
+                int fd = socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd < 0)
+                    continue;
+                if (connect(fd, (struct sockaddr*) &storage, length) < 0 && errno != EINPROGRESS)
+                {
+                    close(fd);
+                    continue;
+                }
+
+                probes[i].fd = fd;
+                if (endpoint.http)
+                {
+                    probes[i].request = "GET " + endpoint.path + " HTTP/1.1\r\nHost: " + endpoint.host +
+                        "\r\nUser-Agent: rdk-connectivity-check\r\nConnection: close\r\n\r\n";
+                }
+            }
+
+            // All the probes at once, the first to make it through decides
+            Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(CONNECTIVITY_PROBE_TIMEOUT);
+            State result = UNKNOWN;
+            while (result != FULLY_CONNECTED)
+            {
+                std::vector<struct pollfd> fds;
+                std::vector<size_t> index;
+                for (size_t i = 0; i < probes.size(); i++)
+                {
+                    if (probes[i].fd < 0)
+                        continue;
+                    struct pollfd fd;
+                    fd.fd = probes[i].fd;
+                    fd.events = (!probes[i].connected || probes[i].sent < probes[i].request.size()) ? POLLOUT : POLLIN;
+                    fd.revents = 0;
+                    fds.push_back(fd);
+                    index.push_back(i);
+                }
+
+                int remaining = (int) std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                if (fds.empty() || remaining <= 0)
+                    break;
+                if (poll(fds.data(), fds.size(), remaining) < 0 && errno != EINTR)
+                    break;
+
+                for (size_t j = 0; j < fds.size(); j++)
+                {
+                    if (!fds[j].revents)
+                        continue;
+
+                    Probe& probe = probes[index[j]];
+                    const Endpoint& endpoint = endpoints[index[j]];
+                    int code = -1;
+
+                    if (!probe.connected)
+                    {
+                        int error = 0;
+                        socklen_t size = sizeof(error);
+                        if (getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &error, &size) < 0 || error != 0)
+                            code = 0;
+                        else if (!endpoint.http)
+                            code = 204;
+                        else
+                            probe.connected = true;
+                    }
+                    else if (probe.sent < probe.request.size())
+                    {
+                        ssize_t sent = send(probe.fd, probe.request.data() + probe.sent, probe.request.size() - probe.sent, MSG_NOSIGNAL);
+                        if (sent < 0 && errno != EAGAIN && errno != EINTR)
+                            code = 0;
+                        else if (sent > 0)
+                            probe.sent += sent;
+                    }
+                    else
+                    {
+                        char buffer[CONNECTIVITY_RESPONSE_MAX];
+                        ssize_t received = recv(probe.fd, buffer, sizeof(buffer), 0);
+                        if (received > 0)
+                        {
+                            probe.response.append(buffer, received);
+                            code = statusCode(probe.response);
+                        }
+                        else if (received == 0 || (errno != EAGAIN && errno != EINTR))
+                        {
+                            code = 0;
+                        }
+                    }
+
+                    if (code < 0)
+                        continue;
+
+                    close(probe.fd);
+                    probe.fd = -1;
+
+                    if (code == 204 || (code >= 200 && code < 300 && !endpoint.generate204))
+                        result = FULLY_CONNECTED;
+                    else if ((code >= 200 && code < 400) || code == 511)
+                        captive = true;
+
+                    LOGINFO("probe of %s:%s%s: %d", endpoint.host.c_str(), endpoint.port.c_str(), endpoint.path.c_str(), code);
+                }
+            }
+
+            for (Probe& probe : probes)
+            {
+                if (probe.fd >= 0)
+                    close(probe.fd);
+            }
+
+            if (result == FULLY_CONNECTED)
+                return result;
+            return captive ? CAPTIVE_PORTAL : LIMITED_INTERNET;
+        }
+
+        void ConnectivityMonitor::run()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            while (m_running)
+            {
+                int period = (m_state == FULLY_CONNECTED) ? CONNECTIVITY_CONNECTED_PERIOD : CONNECTIVITY_OFFLINE_PERIOD;
+                m_condition.wait_for(lock, std::chrono::seconds(period), [this]() { return m_trigger || !m_running; });
+                if (!m_running)
+                    break;
+
+                // Let the events of the same change come in, one probe for all of them
+                if (m_trigger)
+                {
+                    m_condition.wait_for(lock, std::chrono::milliseconds(CONNECTIVITY_TRIGGER_DELAY), [this]() { return !m_running; });
+                    if (!m_running)
+                        break;
+                }
+
+                m_trigger = false;
+                std::vector<Endpoint> endpoints = m_endpoints;
+                RouteCheck hasRoute = m_hasRoute;
+                lock.unlock();
+
+                Clock::time_point start = Clock::now();
+                State state = (hasRoute && !hasRoute()) ? NO_INTERNET : probe(endpoints);
+
+                lock.lock();
+                State previous = m_state;
+                m_state = state;
+                Callback callback = m_callback;
+                lock.unlock();
+
+                if (state != previous)
+                {
+                    LOGINFO("internet %s (was %s), probed in %.1f ms", name(state), name(previous),
+                            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                    if (callback)
+                        callback(state);
+                }
+
+                lock.lock();
+            }
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
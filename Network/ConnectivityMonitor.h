@@ -0,0 +1,104 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        class DnsCache;
+
+        // Internet connectivity, found out in process by HTTP probes of the test endpoints, all in
+        // parallel, and kept as a state that is read without asking anybody. The endpoints are probed
+        // again when the connectivity changes (netlink and netsrvmgr events), and otherwise only now and
+        // then: a captive portal login or an outage upstream leaves no trace on the device.
+        //
+        // A probe that gets a 204, or a 2xx from an endpoint that is not a generate_204 one, means the
+        // internet is reached. A redirect, a 511 or a 200 from a generate_204 endpoint is a captive portal
+        // answering in its place. https endpoints are only connected to, they can not be told from a portal.
+        class ConnectivityMonitor {
+        public:
+            enum State {
+                UNKNOWN = -1,           // not probed yet
+                NO_INTERNET = 0,        // no default route
+                LIMITED_INTERNET = 1,   // a default route, no endpoint answers
+                CAPTIVE_PORTAL = 2,
+                FULLY_CONNECTED = 3
+            };
+
+            // On the monitor thread when the state changed
+            typedef std::function<void(State state)> Callback;
+            // Whether the device has a default route, probes are not even tried without one
+            typedef std::function<bool()> RouteCheck;
+
+            ConnectivityMonitor();
+            virtual ~ConnectivityMonitor();
+
+            ConnectivityMonitor(const ConnectivityMonitor&) = delete;
+            ConnectivityMonitor& operator=(const ConnectivityMonitor&) = delete;
+
+            bool start(DnsCache& dnsCache, const Callback& callback, const RouteCheck& hasRoute);
+            void stop();
+
+            // URLs, or host[:port] for http://host[:port]/. Probed again with the next change.
+            void setEndpoints(const std::vector<std::string>& endpoints);
+
+            // Connectivity changed: probes again, once for a burst of events.
+            void trigger();
+
+            State state();
+            static const char* name(State state);
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Endpoint {
+                std::string host;
+                std::string port;
+                std::string path;
+                bool http;
+                bool generate204;
+            };
+
+            static bool parse(const std::string& url, Endpoint& endpoint);
+            State probe(const std::vector<Endpoint>& endpoints);
+            void run();
+
+        private:
+            std::mutex m_lock;
+            std::condition_variable m_condition;
+            std::vector<Endpoint> m_endpoints;
+            State m_state;
+            bool m_trigger;
+            bool m_running;
+            DnsCache* m_dnsCache;
+            Callback m_callback;
+            RouteCheck m_hasRoute;
+            std::thread m_thread;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
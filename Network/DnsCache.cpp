@@ -0,0 +1,247 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "DnsCache.h"
+
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <netinet/in.h>
+#include <resolv.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "NetUtils.h"
+#include "PingEngine.h"
+#include "utils.h"
+
+#define DNS_CACHE_DEFAULT_TTL       30      // s, names found by getaddrinfo only
+#define DNS_CACHE_MIN_TTL           5
+#define DNS_CACHE_MAX_TTL           300     // s, a diagnostic should not go on with a much older address
+#define DNS_CACHE_MAX_NAMES         32
+#define DNS_CACHE_REFRESH_DELAY     1000    // ms, connectivity events come in bursts
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        DnsCache::DnsCache()
+            : m_refresh(false)
+            , m_running(false)
+        {
+        }
+
+        DnsCache::~DnsCache()
+        {
+            stop();
+        }
+
+        bool DnsCache::start()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_running)
+                return true;
+
+            m_running = true;
+            m_thread = std::thread(&DnsCache::run, this);
+            return true;
+        }
+
+        void DnsCache::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running = false;
+            }
+            m_condition.notify_all();
+
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+
+        bool DnsCache::resolve(const std::string& endpoint, std::string& address, Lookup& lookup)
+        {
+            Clock::time_point start = Clock::now();
+
+            lookup.time = 0.0;
+            lookup.cached = false;
+
+            if (NetUtils::isIPV4(endpoint) || NetUtils::isIPV6(endpoint))
+            {
+                address = endpoint;
+                return true;
+            }
+
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+
+                if (m_names.size() < DNS_CACHE_MAX_NAMES)
+                    m_names.insert(endpoint);
+
+                auto entry = m_entries.find(endpoint);
+                if (entry != m_entries.end() && entry->second.expiry > start)
+                {
+                    address = entry->second.address;
+                    lookup.cached = true;
+                    found = true;
+                }
+            }
+
+            if (!found)
+                found = this->lookup(endpoint, address);
+
+            lookup.time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            return found;
+        }
+
+        void DnsCache::addName(const std::string& name)
+        {
+            if (name.empty() || NetUtils::isIPV4(name) || NetUtils::isIPV6(name))
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_names.size() >= DNS_CACHE_MAX_NAMES || !m_names.insert(name).second)
+                    return;
+                m_refresh = true;
+            }
+            m_condition.notify_all();
+        }
+
+        void DnsCache::refresh()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_entries.clear();
+                m_refresh = true;
+            }
+            m_condition.notify_all();
+        }
+
+        // Address and TTL of the DNS answer, the lowest TTL of the answer section (CNAMEs included)
+        bool DnsCache::query(const std::string& name, std::string& address, uint32_t& ttl)
+        {
+            const int types[] = { ns_t_a, ns_t_aaaa };
+            struct __res_state state;
+            bool found = false;
+
+            memset(&state, 0, sizeof(state));
+            if (res_ninit(&state) != 0)
+                return false;
+
+            for (int type : types)
+            {
+                unsigned char answer[NS_PACKETSZ * 4];
+                int length = res_nsearch(&state, name.c_str(), ns_c_in, type, answer, sizeof(answer));
+                if (length <= 0)
+                    continue;
+
+                ns_msg message;
+                if (ns_initparse(answer, length, &message) != 0)
+                    continue;
+
+                uint32_t lowest = DNS_CACHE_MAX_TTL;
+                for (int i = 0; i < ns_msg_count(message, ns_s_an); i++)
+                {
+                    ns_rr record;
+                    if (ns_parserr(&message, ns_s_an, i, &record) != 0)
+                        break;
+
+                    lowest = std::min(lowest, (uint32_t) ns_rr_ttl(record));
+
+                    bool ipv4 = (ns_rr_type(record) == ns_t_a && ns_rr_rdlen(record) == 4);
+                    bool ipv6 = (ns_rr_type(record) == ns_t_aaaa && ns_rr_rdlen(record) == 16);
+                    if (!found && ns_rr_type(record) == type && (ipv4 || ipv6))
+                    {
+                        char host[INET6_ADDRSTRLEN];
+                        if (inet_ntop(ipv4 ? AF_INET : AF_INET6, ns_rr_rdata(record), host, sizeof(host)) != NULL)
+                        {
+                            address = host;
+                            found = true;
+                        }
+                    }
+                }
+
+                if (found)
+                {
+                    ttl = lowest;
+                    break;
+                }
+            }
+
+            res_nclose(&state);
+            return found;
+        }
+
+        bool DnsCache::lookup(const std::string& name, std::string& address)
+        {
+            uint32_t ttl = DNS_CACHE_DEFAULT_TTL;
+
+            if (!query(name, address, ttl) && !PingEngine::resolve(name, address))
+                return false;
+
+            ttl = std::max((uint32_t) DNS_CACHE_MIN_TTL, std::min(ttl, (uint32_t) DNS_CACHE_MAX_TTL));
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            Entry& entry = m_entries[name];
+            entry.address = address;
+            entry.expiry = Clock::now() + std::chrono::seconds(ttl);
+            return true;
+        }
+
+        void DnsCache::run()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            while (m_running)
+            {
+                m_condition.wait(lock, [this]() { return m_refresh || !m_running; });
+                if (!m_running)
+                    break;
+
+                // Let the events of the same change come in, one refresh for all of them
+                m_condition.wait_for(lock, std::chrono::milliseconds(DNS_CACHE_REFRESH_DELAY), [this]() { return !m_running; });
+                if (!m_running)
+                    break;
+
+                m_refresh = false;
+                std::vector<std::string> names;
+                for (const std::string& name : m_names)
+                {
+                    auto entry = m_entries.find(name);
+                    if (entry == m_entries.end() || entry->second.expiry <= Clock::now())
+                        names.push_back(name);
+                }
+                lock.unlock();
+
+                for (const std::string& name : names)
+                {
+                    std::string address;
+                    Clock::time_point start = Clock::now();
+                    bool found = lookup(name, address);
+                    LOGINFO("prefetched %s: %s in %.1f ms", name.c_str(), found ? address.c_str() : "not found",
+                            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                }
+
+                lock.lock();
+            }
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,85 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Addresses of the names the diagnostics resolve, kept for the TTL of their DNS answer.
+        // The names are looked up with res_nsearch to learn the TTL, names the DNS does not know
+        // (hosts file) fall back to getaddrinfo and are kept for DNS_CACHE_DEFAULT_TTL. When the
+        // connectivity changes the cache is dropped and the names in it are resolved again in the
+        // background, so that the next diagnostic finds them.
+        class DnsCache {
+        public:
+            struct Lookup {
+                double time = 0.0;      // ms
+                bool cached = false;
+            };
+
+            DnsCache();
+            virtual ~DnsCache();
+
+            DnsCache(const DnsCache&) = delete;
+            DnsCache& operator=(const DnsCache&) = delete;
+
+            bool start();
+            void stop();
+
+            // Numeric address of the endpoint, IPv4 preferred for names, like PingEngine::resolve.
+            bool resolve(const std::string& endpoint, std::string& address, Lookup& lookup);
+
+            // Resolved again on every refresh, also the first time they are needed.
+            void addName(const std::string& name);
+
+            // Connectivity changed: drops the addresses and resolves the names again in the background.
+            void refresh();
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Entry {
+                std::string address;
+                Clock::time_point expiry;
+            };
+
+            static bool query(const std::string& name, std::string& address, uint32_t& ttl);
+            bool lookup(const std::string& name, std::string& address);
+            void run();
+
+        private:
+            std::mutex m_lock;
+            std::condition_variable m_condition;
+            std::map<std::string, Entry> m_entries;
+            std::set<std::string> m_names;      // resolved again on refresh
+            bool m_refresh;
+            bool m_running;
+            std::thread m_thread;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -21,9 +21,14 @@
 #include <fcntl.h>
 #include <linux/rtnetlink.h>
 #include <net/if.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
 
+#define NETLINK_MONITOR_BUFFER_SIZE     32768
+#define NETLINK_MONITOR_RECEIVE_BUFFER  (256 * 1024)
+
 namespace WPEFramework {
     namespace Plugin {
 
@@ -114,6 +119,54 @@ namespace WPEFramework {
             return false;
         }
 
+        /*
+         * Request a dump of all links, addresses or routes (RTM_GETLINK/RTM_GETADDR/RTM_GETROUTE)
+         * The replies are read as any other message, the last one is NLMSG_DONE
+         */
+        bool Netlink::sendDumpRequest(unsigned short type)
+        {
+            struct messageBuffer {
+                struct nlmsghdr netlinkRequesthdr;
+                union {
+                    struct ifinfomsg link;
+                    struct ifaddrmsg address;
+                    struct rtmsg route;
+                };
+            } requestMessage;
+
+            std::lock_guard<std::mutex> lock(m_netlinkProtect);
+
+            memset(&requestMessage, 0, sizeof(struct messageBuffer));
+
+            switch (type)
+            {
+                case RTM_GETLINK:
+                    requestMessage.netlinkRequesthdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+                    break;
+                case RTM_GETADDR:
+                    requestMessage.netlinkRequesthdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+                    break;
+                case RTM_GETROUTE:
+                    requestMessage.netlinkRequesthdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+                    break;
+                default:
+                    LOGERR("Unsupported dump request %d", type);
+                    return false;
+            }
+
+            requestMessage.netlinkRequesthdr.nlmsg_type = type;
+            requestMessage.netlinkRequesthdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+            requestMessage.netlinkRequesthdr.nlmsg_seq = type;
+
+            if (send(m_fdNetlink, &requestMessage, requestMessage.netlinkRequesthdr.nlmsg_len, 0) < 0)
+            {
+                LOGERR("Failed to send socket message: %s", strerror(errno));
+                return false;
+            }
+
+            return true;
+        }
+
         /*
          * DEBUG function to log netlink messages in buffer
          */
@@ -373,5 +426,588 @@ namespace WPEFramework {
             return index > 0;
         }
 
+
+        NetlinkMonitor::NetlinkMonitor() :
+            m_fdStop(-1),
+            m_generation(0),
+            m_dumping(0),
+            m_resync(false),
+            m_ready(false),
+            m_version(0)
+        {
+        }
+
+        NetlinkMonitor::~NetlinkMonitor()
+        {
+            stop();
+        }
+
+        bool NetlinkMonitor::start(const AddressCallback &callback, const ChangeCallback &changed)
+        {
+            if (m_thread.joinable())
+            {
+                return true;
+            }
+
+            m_fdStop = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_fdStop == -1)
+            {
+                LOGERR("Failed to create netlink monitor event: %s", strerror(errno));
+                return false;
+            }
+
+            m_callback = callback;
+            m_changed = changed;
+            m_thread = std::thread(&NetlinkMonitor::_run, this);
+            return true;
+        }
+
+        void NetlinkMonitor::stop()
+        {
+            if (m_thread.joinable())
+            {
+                uint64_t value = 1;
+                if (write(m_fdStop, &value, sizeof(value)) != sizeof(value))
+                {
+                    LOGWARN("Failed to signal the netlink monitor: %s", strerror(errno));
+                }
+                m_thread.join();
+            }
+
+            if (m_fdStop != -1)
+            {
+                close(m_fdStop);
+                m_fdStop = -1;
+            }
+
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+            m_interfaces.clear();
+            m_routes.clear();
+            m_dumping = 0;
+            m_resync = false;
+            m_ready = false;
+        }
+
+        bool NetlinkMonitor::ready()
+        {
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+            return m_ready;
+        }
+
+        unsigned NetlinkMonitor::version()
+        {
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+            return m_version;
+        }
+
+        bool NetlinkMonitor::getInterfaces(std::vector<Interface> &interfaces)
+        {
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+
+            interfaces.clear();
+            for (const auto &entry : m_interfaces)
+            {
+                interfaces.push_back(entry.second);
+            }
+
+            return m_ready;
+        }
+
+        bool NetlinkMonitor::getInterface(const std::string &name, Interface &interface)
+        {
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+
+            for (const auto &entry : m_interfaces)
+            {
+                if (entry.second.name == name)
+                {
+                    interface = entry.second;
+                    return m_ready;
+                }
+            }
+
+            return false;
+        }
+
+        bool NetlinkMonitor::getDefaultRoute(std::string &interface, std::string &gateway, bool ipv6)
+        {
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+            unsigned index = 0;
+
+            if (!m_ready)
+            {
+                return false;
+            }
+
+            if (!_getDefaultRoute(index, gateway, ipv6) && (ipv6 || !_getDefaultRoute(index, gateway, true)))
+            {
+                return false;
+            }
+
+            auto entry = m_interfaces.find(index);
+            if (entry == m_interfaces.end())
+            {
+                return false;
+            }
+
+            interface = entry->second.name;
+            return true;
+        }
+
+        /*
+         * Internal functions
+         */
+
+        bool NetlinkMonitor::_getDefaultRoute(unsigned &index, std::string &gateway, bool ipv6)
+        {
+            const Route *best = nullptr;
+
+            for (const Route &route : m_routes)
+            {
+                if ((route.ipv6 == ipv6) && ((best == nullptr) || (route.metric < best->metric)))
+                {
+                    best = &route;
+                }
+            }
+
+            if (best == nullptr)
+            {
+                return false;
+            }
+
+            index = best->index;
+            gateway = best->gateway;
+            return true;
+        }
+
+        void NetlinkMonitor::_run()
+        {
+            char buffer[NETLINK_MONITOR_BUFFER_SIZE];
+            struct pollfd fds[2];
+            int size = NETLINK_MONITOR_RECEIVE_BUFFER;
+            std::vector<Event> events;
+
+            if (!m_netlink.connect(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE))
+            {
+                LOGERR("Failed to connect the netlink monitor");
+                return;
+            }
+
+            // The table is only as good as the notifications which made it, so give them room
+            if (setsockopt(m_netlink.sockfd(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+            {
+                LOGWARN("Failed to set the netlink receive buffer: %s", strerror(errno));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_tableProtect);
+                if (!_dump())
+                {
+                    return;
+                }
+            }
+
+            fds[0].fd = m_netlink.sockfd();
+            fds[0].events = POLLIN;
+            fds[1].fd = m_fdStop;
+            fds[1].events = POLLIN;
+
+            while (true)
+            {
+                if (poll(fds, 2, -1) < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+
+                    LOGERR("Netlink monitor poll failed: %s", strerror(errno));
+                    break;
+                }
+
+                if (fds[1].revents)
+                {
+                    break;
+                }
+
+                if (!(fds[0].revents & POLLIN))
+                {
+                    continue;
+                }
+
+                int length = recv(m_netlink.sockfd(), buffer, sizeof(buffer), 0);
+                if (length < 0)
+                {
+                    if (errno == ENOBUFS)
+                    {
+                        // Notifications were lost, the table has to be read again
+                        LOGWARN("Netlink monitor overrun, reading the tables again");
+                        std::lock_guard<std::mutex> lock(m_tableProtect);
+                        m_resync = true;
+                        if (m_dumping == 0)
+                            _dump();
+                    }
+                    else if ((errno != EAGAIN) && (errno != EINTR))
+                    {
+                        LOGERR("Netlink monitor read failed: %s", strerror(errno));
+                        break;
+                    }
+                    continue;
+                }
+
+                events.clear();
+                unsigned before = version();
+                _parse(buffer, length, events);
+
+                for (const Event &event : events)
+                {
+                    if (m_callback)
+                        m_callback(event.interface, event.address.address, event.address.ipv6, event.acquired);
+                }
+
+                if (m_changed && ready() && version() != before)
+                    m_changed();
+            }
+        }
+
+        /*
+         * Start reading all tables again, links first so that the addresses and routes find their interface
+         * Entries not seen again by the end of the dump of their table are gone
+         */
+        bool NetlinkMonitor::_dump()
+        {
+            m_generation++;
+            m_resync = false;
+            m_dumping = RTM_GETLINK;
+
+            if (!m_netlink.sendDumpRequest(m_dumping))
+            {
+                m_dumping = 0;
+                return false;
+            }
+
+            return true;
+        }
+
+        void NetlinkMonitor::_parse(const char *buffer, int length, std::vector<Event> &events)
+        {
+            std::lock_guard<std::mutex> lock(m_tableProtect);
+            struct nlmsghdr *nlhdr;
+
+            for (nlhdr = (struct nlmsghdr *)buffer;
+                 NLMSG_OK(nlhdr, length);
+                 nlhdr = NLMSG_NEXT(nlhdr, length))
+            {
+                switch (nlhdr->nlmsg_type)
+                {
+                    case NLMSG_DONE:
+                    case NLMSG_ERROR:
+                        if ((m_dumping != 0) && (nlhdr->nlmsg_seq == m_dumping))
+                        {
+                            if (nlhdr->nlmsg_type == NLMSG_ERROR)
+                            {
+                                LOGERR("Netlink dump %d failed: %s", m_dumping,
+                                        strerror(-((struct nlmsgerr *)NLMSG_DATA(nlhdr))->error));
+                            }
+                            else
+                            {
+                                _sweep(m_dumping, events);
+                            }
+
+                            m_dumping = (m_dumping == RTM_GETLINK) ? RTM_GETADDR : (m_dumping == RTM_GETADDR) ? RTM_GETROUTE : 0;
+                            if (m_dumping == 0)
+                            {
+                                if (!m_ready)
+                                    LOGINFO("Netlink monitor has %zu interfaces and %zu default routes", m_interfaces.size(), m_routes.size());
+                                m_ready = true;
+                                m_version++;
+                                if (m_resync)
+                                    _dump();
+                            }
+                            else if (!m_netlink.sendDumpRequest(m_dumping))
+                            {
+                                m_dumping = 0;
+                            }
+                        }
+                        break;
+                    case RTM_NEWLINK:
+                    case RTM_DELLINK:
+                        _parseLink(nlhdr, events);
+                        break;
+                    case RTM_NEWADDR:
+                    case RTM_DELADDR:
+                        _parseAddress(nlhdr, events);
+                        break;
+                    case RTM_NEWROUTE:
+                    case RTM_DELROUTE:
+                        _parseRoute(nlhdr);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        void NetlinkMonitor::_parseLink(struct nlmsghdr *nlhdr, std::vector<Event> &events)
+        {
+            struct ifinfomsg *ifinfo = (struct ifinfomsg *)NLMSG_DATA(nlhdr);
+            struct rtattr *attribute;
+            int attrLength = IFLA_PAYLOAD(nlhdr);
+
+            // Bridge port notifications come as links too
+            if (ifinfo->ifi_family == AF_BRIDGE)
+            {
+                return;
+            }
+
+            auto entry = m_interfaces.find(ifinfo->ifi_index);
+
+            if (nlhdr->nlmsg_type == RTM_DELLINK)
+            {
+                if (entry != m_interfaces.end())
+                {
+                    for (const Address &address : entry->second.addresses)
+                    {
+                        if (m_ready)
+                            events.push_back({ entry->second.name, address, false });
+                    }
+                    m_interfaces.erase(entry);
+                    m_version++;
+                }
+                return;
+            }
+
+            if (entry == m_interfaces.end())
+            {
+                entry = m_interfaces.insert({ (unsigned)ifinfo->ifi_index, Interface() }).first;
+                entry->second.index = ifinfo->ifi_index;
+            }
+
+            Interface &interface = entry->second;
+            interface.flags = ifinfo->ifi_flags;
+            interface.generation = m_generation;
+
+            for (attribute = IFLA_RTA(ifinfo);
+                    RTA_OK(attribute, attrLength);
+                    attribute = RTA_NEXT(attribute, attrLength))
+            {
+                if (attribute->rta_type == IFLA_IFNAME)
+                {
+                    interface.name = (const char *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == IFLA_ADDRESS)
+                {
+                    const unsigned char *mac = (const unsigned char *)RTA_DATA(attribute);
+                    char text[4];
+
+                    interface.mac.clear();
+                    for (unsigned i = 0; i < RTA_PAYLOAD(attribute); i++)
+                    {
+                        snprintf(text, sizeof(text), i ? ":%02x" : "%02x", mac[i]);
+                        interface.mac += text;
+                    }
+                }
+            }
+
+            m_version++;
+        }
+
+        void NetlinkMonitor::_parseAddress(struct nlmsghdr *nlhdr, std::vector<Event> &events)
+        {
+            struct ifaddrmsg *ifaddr = (struct ifaddrmsg *)NLMSG_DATA(nlhdr);
+            struct rtattr *attribute;
+            int attrLength = IFA_PAYLOAD(nlhdr);
+            char ipAddress[INET6_ADDRSTRLEN] = { 0 };
+            bool local = false;
+
+            if ((ifaddr->ifa_family != AF_INET) && (ifaddr->ifa_family != AF_INET6))
+            {
+                return;
+            }
+
+            auto entry = m_interfaces.find(ifaddr->ifa_index);
+            if (entry == m_interfaces.end())
+            {
+                return;
+            }
+
+            // IFA_LOCAL is the address of a point to point link, IFA_ADDRESS its peer
+            for (attribute = IFA_RTA(ifaddr);
+                    RTA_OK(attribute, attrLength);
+                    attribute = RTA_NEXT(attribute, attrLength))
+            {
+                if ((attribute->rta_type == IFA_LOCAL) || ((attribute->rta_type == IFA_ADDRESS) && !local))
+                {
+                    inet_ntop(ifaddr->ifa_family, RTA_DATA(attribute), ipAddress, INET6_ADDRSTRLEN);
+                    local = (attribute->rta_type == IFA_LOCAL);
+                }
+            }
+
+            if (ipAddress[0] == '\0')
+            {
+                return;
+            }
+
+            Interface &interface = entry->second;
+            bool ipv6 = (ifaddr->ifa_family == AF_INET6);
+            auto address = interface.addresses.begin();
+            while ((address != interface.addresses.end()) && ((address->ipv6 != ipv6) || (address->address != ipAddress)))
+            {
+                ++address;
+            }
+
+            // An address is not usable before duplicate address detection is done with it
+            if ((nlhdr->nlmsg_type == RTM_DELADDR) || (ifaddr->ifa_flags & IFA_F_TENTATIVE))
+            {
+                if (address != interface.addresses.end())
+                {
+                    if (m_ready)
+                        events.push_back({ interface.name, *address, false });
+                    interface.addresses.erase(address);
+                    m_version++;
+                }
+                return;
+            }
+
+            if (address == interface.addresses.end())
+            {
+                interface.addresses.push_back({ ipAddress, ifaddr->ifa_prefixlen, ifaddr->ifa_scope, ipv6, m_generation });
+                if (m_ready)
+                    events.push_back({ interface.name, interface.addresses.back(), true });
+            }
+            else
+            {
+                address->prefix = ifaddr->ifa_prefixlen;
+                address->scope = ifaddr->ifa_scope;
+                address->generation = m_generation;
+            }
+
+            m_version++;
+        }
+
+        void NetlinkMonitor::_parseRoute(struct nlmsghdr *nlhdr)
+        {
+            struct rtmsg *routeMsg = (struct rtmsg *)NLMSG_DATA(nlhdr);
+            struct rtattr *attribute;
+            int attrLength = RTM_PAYLOAD(nlhdr);
+            char ipAddress[INET6_ADDRSTRLEN];
+            unsigned table = routeMsg->rtm_table;
+            Route route = { 0, "", 0, (routeMsg->rtm_family == AF_INET6), m_generation };
+
+            if (((routeMsg->rtm_family != AF_INET) && (routeMsg->rtm_family != AF_INET6)) ||
+                (routeMsg->rtm_type != RTN_UNICAST) ||
+                (routeMsg->rtm_dst_len != 0))
+            {
+                // only default routes are of interest
+                return;
+            }
+
+            for (attribute = RTM_RTA(routeMsg);
+                    RTA_OK(attribute, attrLength);
+                    attribute = RTA_NEXT(attribute, attrLength))
+            {
+                if (attribute->rta_type == RTA_TABLE)
+                {
+                    table = *(unsigned *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == RTA_OIF)
+                {
+                    route.index = *(unsigned *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == RTA_GATEWAY)
+                {
+                    inet_ntop(routeMsg->rtm_family, RTA_DATA(attribute), ipAddress, INET6_ADDRSTRLEN);
+                    route.gateway = ipAddress;
+                }
+                else if (attribute->rta_type == RTA_PRIORITY)
+                {
+                    route.metric = *(unsigned *)RTA_DATA(attribute);
+                }
+            }
+
+            if ((table != RT_TABLE_MAIN) || (route.index == 0))
+            {
+                return;
+            }
+
+            auto entry = m_routes.begin();
+            while ((entry != m_routes.end()) &&
+                   ((entry->ipv6 != route.ipv6) || (entry->index != route.index) ||
+                    (entry->gateway != route.gateway) || (entry->metric != route.metric)))
+            {
+                ++entry;
+            }
+
+            if (nlhdr->nlmsg_type == RTM_DELROUTE)
+            {
+                if (entry != m_routes.end())
+                    m_routes.erase(entry);
+            }
+            else if (entry == m_routes.end())
+            {
+                m_routes.push_back(route);
+            }
+            else
+            {
+                entry->generation = m_generation;
+            }
+
+            m_version++;
+        }
+
+        /*
+         * Drop what the dump of a table did not report again
+         */
+        void NetlinkMonitor::_sweep(unsigned short type, std::vector<Event> &events)
+        {
+            if (type == RTM_GETLINK)
+            {
+                for (auto entry = m_interfaces.begin(); entry != m_interfaces.end(); )
+                {
+                    if (entry->second.generation != m_generation)
+                    {
+                        for (const Address &address : entry->second.addresses)
+                        {
+                            if (m_ready)
+                                events.push_back({ entry->second.name, address, false });
+                        }
+                        entry = m_interfaces.erase(entry);
+                    }
+                    else
+                    {
+                        ++entry;
+                    }
+                }
+            }
+            else if (type == RTM_GETADDR)
+            {
+                for (auto &entry : m_interfaces)
+                {
+                    auto &addresses = entry.second.addresses;
+                    for (auto address = addresses.begin(); address != addresses.end(); )
+                    {
+                        if (address->generation != m_generation)
+                        {
+                            if (m_ready)
+                                events.push_back({ entry.second.name, *address, false });
+                            address = addresses.erase(address);
+                        }
+                        else
+                        {
+                            ++address;
+                        }
+                    }
+                }
+            }
+            else if (type == RTM_GETROUTE)
+            {
+                for (auto route = m_routes.begin(); route != m_routes.end(); )
+                {
+                    if (route->generation != m_generation)
+                        route = m_routes.erase(route);
+                    else
+                        ++route;
+                }
+            }
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
@@ -19,9 +19,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <map>
 #include <string>
 #include <thread>
 #include <mutex>
+#include <vector>
 #include "utils.h"
 
 namespace WPEFramework {
@@ -45,6 +49,7 @@ namespace WPEFramework {
                 bool connect(int groups = 0);
                 int read(char *buffer, int size);
                 bool getDefaultInterfaces(indexList &interfaceIndex, stringList &gatewayAddress, bool ipv6 = false);
+                bool sendDumpRequest(unsigned short type);
                 int sockfd() { return m_fdNetlink;}
 
                 void displayMessages(const char* msgBuffer, int msgLength);
@@ -60,5 +65,95 @@ namespace WPEFramework {
                 bool _getRoutesInformation(indexList &defaultInterfaceIndex, stringList &gatewayAddress);
                 bool _parseRoute(void *msg, unsigned &index, std::string &destination, std::string &gateway);
         };
+
+        /*
+         * Keeps a table of the interfaces, their addresses and the default routes, filled from
+         * a netlink dump and kept up to date by the RTM_NEWLINK/NEWADDR/NEWROUTE (and DEL)
+         * notifications, so that it can be read at any time without asking anybody.
+         */
+        class NetlinkMonitor
+        {
+            public:
+                struct Address
+                {
+                    std::string address;
+                    unsigned prefix;
+                    unsigned char scope;
+                    bool ipv6;
+                    unsigned generation;
+                };
+
+                struct Interface
+                {
+                    unsigned index;
+                    std::string name;
+                    std::string mac;
+                    unsigned flags;                 // IFF_*
+                    std::vector<Address> addresses; // without tentative ones
+                    unsigned generation;
+                };
+
+                struct Route
+                {
+                    unsigned index;
+                    std::string gateway;
+                    unsigned metric;
+                    bool ipv6;
+                    unsigned generation;
+                };
+
+                // Called on the monitor thread for each address gained or lost once the table is filled
+                typedef std::function<void(const std::string &interface, const std::string &address, bool ipv6, bool acquired)> AddressCallback;
+                // Called on the monitor thread after notifications changed the table (links, addresses, routes)
+                typedef std::function<void()> ChangeCallback;
+
+                NetlinkMonitor();
+                virtual ~NetlinkMonitor();
+
+                bool start(const AddressCallback &callback, const ChangeCallback &changed = ChangeCallback());
+                void stop();
+
+                // False until the first dump is complete
+                bool ready();
+                // Changes with every change to the table
+                unsigned version();
+
+                bool getInterfaces(std::vector<Interface> &interfaces);
+                bool getInterface(const std::string &name, Interface &interface);
+                // Lowest metric default route, IPv4 first unless ipv6 is set
+                bool getDefaultRoute(std::string &interface, std::string &gateway, bool ipv6 = false);
+
+            private:
+                struct Event
+                {
+                    std::string interface;
+                    Address address;
+                    bool acquired;
+                };
+
+                void _run();
+                bool _dump();
+                void _parse(const char *buffer, int length, std::vector<Event> &events);
+                void _parseLink(struct nlmsghdr *nlhdr, std::vector<Event> &events);
+                void _parseAddress(struct nlmsghdr *nlhdr, std::vector<Event> &events);
+                void _parseRoute(struct nlmsghdr *nlhdr);
+                void _sweep(unsigned short type, std::vector<Event> &events);
+                bool _getDefaultRoute(unsigned &index, std::string &gateway, bool ipv6);
+
+                Netlink             m_netlink;
+                std::thread         m_thread;
+                int                 m_fdStop;
+                AddressCallback     m_callback;
+                ChangeCallback      m_changed;
+
+                std::mutex          m_tableProtect;
+                std::map<unsigned, Interface> m_interfaces;
+                std::vector<Route>  m_routes;   // default routes of the main table
+                unsigned            m_generation;   // of the current dump
+                unsigned short      m_dumping;      // RTM_GET* in progress, 0 if none
+                bool                m_resync;       // notifications were lost, dump again
+                bool                m_ready;
+                unsigned            m_version;
+        };
     } // namespace Plugin
 } // namespace WPEFramework
@@ -20,6 +20,7 @@
 #include "Network.h"
 #include <net/if.h>
 #include <arpa/inet.h>
+#include <linux/rtnetlink.h>
 #include "utils.h"
 
 using namespace std;
@@ -205,6 +206,34 @@ namespace WPEFramework
         const string Network::Initialize(PluginHost::IShell* /* service */)
         {
             string msg;
+
+            if (!m_pingEngine.start())
+                LOGERR("Ping engine could not be started, pings will fail");
+            m_dnsCache.start();
+            m_dnsCache.addName(m_stunEndPoint);
+
+#ifdef USE_NETLINK
+            if (!m_netlinkMonitor.start([this](const string& interface, const string& address, bool ipv6, bool acquired) {
+                    onNetlinkAddressChanged(interface, address, ipv6, acquired);
+                }, [this]() {
+                    m_connectivityMonitor.trigger();
+                }))
+                LOGERR("Netlink monitor could not be started, interface information comes from netsrvmgr");
+#endif
+
+            ConnectivityMonitor::RouteCheck hasRoute;
+#ifdef USE_NETLINK
+            hasRoute = [this]() {
+                string interface, gateway;
+                // Not known before the first dump, probed anyway
+                return !m_netlinkMonitor.ready() || m_netlinkMonitor.getDefaultRoute(interface, gateway) ||
+                    m_netlinkMonitor.getDefaultRoute(interface, gateway, true);
+            };
+#endif
+            m_connectivityMonitor.start(m_dnsCache, [this](ConnectivityMonitor::State state) {
+                    onInternetStatusChanged(state);
+                }, hasRoute);
+
             if (Utils::IARM::init())
             {
                 IARM_Result_t res;
@@ -255,6 +284,13 @@ namespace WPEFramework
                 m_registrationThread.join();
             }
 
+            m_pingEngine.stop();
+            m_connectivityMonitor.stop();
+            m_dnsCache.stop();
+#ifdef USE_NETLINK
+            m_netlinkMonitor.stop();
+#endif
+
             if (Utils::IARM::isConnected())
             {
                 IARM_Result_t res;
@@ -395,6 +431,35 @@ namespace WPEFramework
 
             if(m_isPluginInited)
             {
+#ifdef USE_NETLINK
+                std::vector<NetlinkMonitor::Interface> interfaces;
+                if (m_netlinkMonitor.getInterfaces(interfaces))
+                {
+                    JsonArray networkInterfaces;
+
+                    for (const NetlinkMonitor::Interface& entry : interfaces)
+                    {
+                        if (entry.flags & IFF_LOOPBACK)
+                            continue;
+
+                        JsonObject interface;
+                        string iface = m_netUtils.getInterfaceDescription(entry.name);
+#ifdef NET_DEFINED_INTERFACES_ONLY
+                        if (iface == "")
+                            continue;					// Skip unrecognised interfaces...
+#endif
+                        interface["interface"] = iface;
+                        interface["macAddress"] = entry.mac;
+                        interface["enabled"] = ((entry.flags & IFF_UP) != 0);
+                        interface["connected"] = ((entry.flags & IFF_RUNNING) != 0);
+
+                        networkInterfaces.Add(interface);
+                    }
+
+                    response["interfaces"] = networkInterfaces;
+                    returnResponse(true)
+                }
+#endif
                 if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getInterfaceList, (void*)&list, sizeof(list)))
                 {
                     JsonArray networkInterfaces;
@@ -501,6 +566,18 @@ namespace WPEFramework
 
             if(m_isPluginInited)
             {
+#ifdef USE_NETLINK
+                // The address of the default interface, IPv6 when it has an IPv6 default route
+                string interface;
+                string gateway;
+                string address;
+                if ((m_netlinkMonitor.getDefaultRoute(interface, gateway, true) && _getNetlinkAddress(interface, true, address)) ||
+                    (m_netlinkMonitor.getDefaultRoute(interface, gateway) && _getNetlinkAddress(interface, false, address)))
+                {
+                    response["ip"] = address;
+                    returnResponse(true)
+                }
+#endif
                 if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getSTBip, (void*)&param, sizeof(param)))
                 {
                     response["ip"] = string(param.activeIfaceIpaddr, MAX_IP_ADDRESS_LEN - 1);
@@ -660,11 +737,16 @@ namespace WPEFramework
                     string endpoint = "";
                     int packets = 0;
 
+                    string guid;
+                    bool async;
+
                     getStringParameter("endpoint", endpoint);
                     if (parameters.HasLabel("packets")) // packets is optional?
                         getNumberParameter("packets", packets);
+                    getDefaultStringParameter("guid", guid, "");
+                    getDefaultBoolParameter("async", async, false);
 
-                    if (_doTrace(endpoint, packets, response))
+                    if (_doTrace(endpoint, packets, response, guid, async))
                         result = true;
                     else
                         LOGERR("Failed to perform network trace");
@@ -691,11 +773,16 @@ namespace WPEFramework
                     string endpointName = "";
                     int packets = 0;
 
+                    string guid;
+                    bool async;
+
                     getStringParameter("endpointName", endpointName);
                     if (parameters.HasLabel("packets")) // packets is optional?
                         getNumberParameter("packets", packets);
+                    getDefaultStringParameter("guid", guid, "");
+                    getDefaultBoolParameter("async", async, false);
 
-                    if (_doTraceNamedEndpoint(endpointName, packets, response))
+                    if (_doTraceNamedEndpoint(endpointName, packets, response, guid, async))
                         result = true;
                     else
                         LOGERR("Failed to perform network trace names endpoint");
@@ -717,6 +804,9 @@ namespace WPEFramework
                 uint32_t packets;
             getDefaultNumberParameter("packets", packets, DEFAULT_PING_PACKETS);
 
+            bool async;
+            getDefaultBoolParameter("async", async, false);
+
             bool result = false;
 
             if(m_isPluginInited)
@@ -725,7 +815,7 @@ namespace WPEFramework
                 {
                     string endpoint;
                     getStringParameter("endpoint", endpoint);
-                    response = _doPing(guid, endpoint, packets);
+                    response = _doPing(guid, endpoint, packets, async);
                     result = response["success"].Boolean();
                 }
                 else
@@ -748,6 +838,9 @@ namespace WPEFramework
             uint32_t packets;
             getDefaultNumberParameter("packets", packets, DEFAULT_PING_PACKETS);
 
+            bool async;
+            getDefaultBoolParameter("async", async, false);
+
             bool result = false;
 
             if(m_isPluginInited)
@@ -757,7 +850,7 @@ namespace WPEFramework
                     string endpointName;
                     getDefaultStringParameter("endpointName", endpointName, "")
 
-                        response = _doPingNamedEndpoint(guid, endpointName, packets);
+                        response = _doPingNamedEndpoint(guid, endpointName, packets, async);
                     result = response["success"].Boolean();
                 }
                 else
@@ -878,6 +971,12 @@ namespace WPEFramework
                             }
                         }
                     }
+#ifdef USE_NETLINK
+                    {
+                        std::lock_guard<std::mutex> lock(m_ipSettingsProtect);
+                        m_ipSettings.clear();
+                    }
+#endif
                     if (IARM_RESULT_SUCCESS ==
                             IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setIPSettings, (void *) &iarmData,
                                 sizeof(iarmData)))
@@ -909,6 +1008,22 @@ namespace WPEFramework
                     getStringParameter("interface", interface);
                     getStringParameter("ipversion", ipversion);
                 }
+#ifdef USE_NETLINK
+                // DNS and autoconfig are not known to netlink, so netsrvmgr still has to be asked,
+                // but only again once the interfaces, addresses or routes have changed
+                string key = interface + "/" + ipversion;
+                unsigned version = m_netlinkMonitor.version();
+                if (m_netlinkMonitor.ready())
+                {
+                    std::lock_guard<std::mutex> lock(m_ipSettingsProtect);
+                    auto entry = m_ipSettings.find(key);
+                    if ((entry != m_ipSettings.end()) && (entry->second.first == version))
+                    {
+                        response = entry->second.second;
+                        returnResponse(true)
+                    }
+                }
+#endif
                 IARM_BUS_NetSrvMgr_Iface_Settings_t iarmData = { 0 };
                 strncpy(iarmData.interface, interface.c_str(), 16);
                 strncpy(iarmData.ipversion, ipversion.c_str(), 16);
@@ -925,6 +1040,13 @@ namespace WPEFramework
                     response["primarydns"] = string(iarmData.primarydns,MAX_IP_ADDRESS_LEN - 1);
                     response["secondarydns"] = string(iarmData.secondarydns,MAX_IP_ADDRESS_LEN - 1);
                     result = true;
+#ifdef USE_NETLINK
+                    if (m_netlinkMonitor.ready())
+                    {
+                        std::lock_guard<std::mutex> lock(m_ipSettingsProtect);
+                        m_ipSettings[key] = std::make_pair(version, response);
+                    }
+#endif
                 }
             }
             else
@@ -940,7 +1062,16 @@ namespace WPEFramework
             bool result = false;
             bool isconnected = false;
 
-            if(m_isPluginInited)
+            // Probed in process, netsrvmgr is only asked until the first probe is done
+            ConnectivityMonitor::State state = m_connectivityMonitor.state();
+            if (state != ConnectivityMonitor::UNKNOWN)
+            {
+                response["connectedToInternet"] = (state == ConnectivityMonitor::FULLY_CONNECTED);
+                response["state"] = (int) state;
+                response["status"] = string(ConnectivityMonitor::name(state));
+                result = true;
+            }
+            else if(m_isPluginInited)
             {
                 if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_isConnectedToInternet, (void*) &isconnected, sizeof(isconnected)))
                 {
@@ -972,6 +1103,7 @@ namespace WPEFramework
                     returnResponse(result);
                 }
                 IARM_BUS_NetSrvMgr_Iface_TestEndpoints_t iarmData;
+                std::vector<string> urls;
                 JsonArray::Iterator index(endpoints.Elements());
                 iarmData.size = 0;
                 while (index.Next() == true)
@@ -979,6 +1111,7 @@ namespace WPEFramework
                     if (Core::JSON::Variant::type::STRING == index.Current().Content())
                     {
                         strncpy(iarmData.endpoints[iarmData.size], index.Current().String().c_str(), MAX_ENDPOINT_SIZE);
+                        urls.push_back(index.Current().String());
                         iarmData.size++;
                     }
                     else
@@ -987,6 +1120,7 @@ namespace WPEFramework
                         returnResponse(result);
                     }
                 }
+                m_connectivityMonitor.setEndpoints(urls);
                 if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setConnectivityTestEndpoints, (void*) &iarmData, sizeof(iarmData)))
                 {
                     result = true;
@@ -1029,6 +1163,7 @@ namespace WPEFramework
             getDefaultBoolParameter("sync", m_stunSync, true);
             getDefaultNumberParameter("timeout", m_stunBindTimeout, 30);
             getDefaultNumberParameter("cache_timeout", m_stunCacheTimeout, 0);
+            m_dnsCache.addName(m_stunEndPoint);
 
             returnResponse(true);
 	}
@@ -1071,6 +1206,15 @@ namespace WPEFramework
                 }
             
                 getBoolParameter("ipv6", iarmData.ipv6);
+
+                // The binding goes to the address the cache already has, netsrvmgr does not resolve it again
+                string address;
+                DnsCache::Lookup lookup;
+                if (!server.empty() && !iarmData.ipv6 && m_dnsCache.resolve(server, address, lookup) && NetUtils::isIPV4(address))
+                {
+                    LOGINFO("STUN server %s is %s, resolved in %.3f ms%s", server.c_str(), address.c_str(), lookup.time, lookup.cached ? " from the cache" : "");
+                    server = address;
+                }
                 getBoolParameter("sync", iarmData.sync);
                 getNumberParameter("timeout", iarmData.bind_timeout);
                 getNumberParameter("cache_timeout", iarmData.cache_timeout);
@@ -1116,6 +1260,10 @@ namespace WPEFramework
             params["interface"] = m_netUtils.getInterfaceDescription(interface);
             params["status"] = string (connected ? "CONNECTED" : "DISCONNECTED");
             sendNotify("onConnectionStatusChanged", params);
+
+            if (connected)
+                m_dnsCache.refresh();
+            m_connectivityMonitor.trigger();
         }
 
         void Network::onInterfaceIPAddressChanged(string interface, string ipv6Addr, string ipv4Addr, bool acquired)
@@ -1132,7 +1280,36 @@ namespace WPEFramework
             }
             params["status"] = string (acquired ? "ACQUIRED" : "LOST");
             sendNotify("onIPAddressStatusChanged", params);
+
+            // Another address can mean another resolver, or a path to it that was not there
+            if (acquired)
+                m_dnsCache.refresh();
+            m_connectivityMonitor.trigger();
+        }
+
+#ifdef USE_NETLINK
+        void Network::onNetlinkAddressChanged(const string& interface, const string& address, bool ipv6, bool acquired)
+        {
+#ifdef NET_DEFINED_INTERFACES_ONLY
+            if (m_netUtils.getInterfaceDescription(interface) == "")
+                return;
+#endif
+            if (ipv6)
+            {
+#ifdef NET_NO_LINK_LOCAL_ANNOUNCE
+                if (!m_netUtils.isIPV6LinkLocal(address))
+#endif
+                    onInterfaceIPAddressChanged(interface, address, "", acquired);
+            }
+            else
+            {
+#ifdef NET_NO_LINK_LOCAL_ANNOUNCE
+                if (!m_netUtils.isIPV4LinkLocal(address))
+#endif
+                    onInterfaceIPAddressChanged(interface, "", address, acquired);
+            }
         }
+#endif
 
         void Network::onDefaultInterfaceChanged(string oldInterface, string newInterface)
         {
@@ -1140,6 +1317,17 @@ namespace WPEFramework
             params["oldInterfaceName"] = m_netUtils.getInterfaceDescription(oldInterface);
             params["newInterfaceName"] = m_netUtils.getInterfaceDescription(newInterface);
             sendNotify("onDefaultInterfaceChanged", params);
+
+            m_dnsCache.refresh();
+            m_connectivityMonitor.trigger();
+        }
+
+        void Network::onInternetStatusChanged(ConnectivityMonitor::State state)
+        {
+            JsonObject params;
+            params["state"] = (int) state;
+            params["status"] = string(ConnectivityMonitor::name(state));
+            sendNotify("onInternetStatusChange", params);
         }
 
         void Network::eventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
@@ -1188,6 +1376,10 @@ namespace WPEFramework
             case IARM_BUS_NETWORK_MANAGER_EVENT_INTERFACE_IPADDRESS:
             {
                 IARM_BUS_NetSrvMgr_Iface_EventInterfaceIPAddress_t *e = (IARM_BUS_NetSrvMgr_Iface_EventInterfaceIPAddress_t*) data;
+#ifdef USE_NETLINK
+                if (m_netlinkMonitor.ready())
+                    break;                      // announced from netlink already
+#endif
 #ifdef NET_DEFINED_INTERFACES_ONLY
                 if (m_netUtils.getInterfaceDescription(e->interface) == "")
                     break;
@@ -1288,18 +1480,28 @@ namespace WPEFramework
                 {
                     LOGINFO("Identified as mediaclient device type");
 
-                    IARM_BUS_NetSrvMgr_DefaultRoute_t defaultRoute = {0};
-                    if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface
-                                , (void*)&defaultRoute, sizeof(defaultRoute)))
+#ifdef USE_NETLINK
+                    if (m_netlinkMonitor.getDefaultRoute(interface, gateway))
                     {
-                        LOGWARN ("Call to %s for %s returned interface = %s, gateway = %s", IARM_BUS_NM_SRV_MGR_NAME
-                                , IARM_BUS_NETSRVMGR_API_getDefaultInterface, defaultRoute.interface, defaultRoute.gateway);
-                        interface = defaultRoute.interface;
-                        gateway = defaultRoute.gateway;
+                        LOGINFO("Netlink default route: interface = %s, gateway = %s", interface.c_str(), gateway.c_str());
                         result = true;
                     }
                     else
-                        LOGWARN ("Call to %s for %s failed", IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface);
+#endif
+                    {
+                        IARM_BUS_NetSrvMgr_DefaultRoute_t defaultRoute = {0};
+                        if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface
+                                    , (void*)&defaultRoute, sizeof(defaultRoute)))
+                        {
+                            LOGWARN ("Call to %s for %s returned interface = %s, gateway = %s", IARM_BUS_NM_SRV_MGR_NAME
+                                    , IARM_BUS_NETSRVMGR_API_getDefaultInterface, defaultRoute.interface, defaultRoute.gateway);
+                            interface = defaultRoute.interface;
+                            gateway = defaultRoute.gateway;
+                            result = true;
+                        }
+                        else
+                            LOGWARN ("Call to %s for %s failed", IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface);
+                    }
                 }
 
                 if (interface.length() == 0)
@@ -1319,5 +1521,36 @@ namespace WPEFramework
             return result;
         }
 
+#ifdef USE_NETLINK
+        /*
+         * A global address of the interface from the netlink table, falling back to any other
+         */
+        bool Network::_getNetlinkAddress(const string& interface, bool ipv6, string& address)
+        {
+            NetlinkMonitor::Interface entry;
+
+            if (!m_netlinkMonitor.getInterface(interface, entry))
+                return false;
+
+            address = "";
+            for (const NetlinkMonitor::Address& candidate : entry.addresses)
+            {
+                if (candidate.ipv6 != ipv6)
+                    continue;
+
+                if (candidate.scope == RT_SCOPE_UNIVERSE)
+                {
+                    address = candidate.address;
+                    break;
+                }
+
+                if (address.empty())
+                    address = candidate.address;
+            }
+
+            return !address.empty();
+        }
+#endif
+
     } // namespace Plugin
 } // namespace WPEFramework
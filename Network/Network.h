@@ -23,14 +23,17 @@
 #include <string>
 
 #include "Module.h"
+#include "ConnectivityMonitor.h"
+#include "DnsCache.h"
 #include "NetUtils.h"
+#include "PingEngine.h"
 #include "utils.h"
 #include "upnpdiscoverymanager.h"
 
 
 // Define this to use netlink calls (where there may be an alternative method but netlink could provide
 // the information or perform the action required)
-//#define USE_NETLINK
+#define USE_NETLINK
 
 namespace WPEFramework {
     namespace Plugin {
@@ -85,6 +88,10 @@ namespace WPEFramework {
             void onInterfaceConnectionStatusChanged(std::string interface, bool connected);
             void onInterfaceIPAddressChanged(std::string interface, std::string ipv6Addr, std::string ipv4Addr, bool acquired);
             void onDefaultInterfaceChanged(std::string oldInterface, std::string newInterface);
+            void onInternetStatusChanged(ConnectivityMonitor::State state);
+#ifdef USE_NETLINK
+            void onNetlinkAddressChanged(const std::string& interface, const std::string& address, bool ipv6, bool acquired);
+#endif
 
             static void eventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             void iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
@@ -93,15 +100,18 @@ namespace WPEFramework {
             bool isValidCIDRv4(std::string interface);
             // Internal methods
             bool _getDefaultInterface(std::string& interface, std::string& gateway);
+#ifdef USE_NETLINK
+            bool _getNetlinkAddress(const std::string& interface, bool ipv6, std::string& address);
+#endif
 
             void retryIarmEventRegistration();
             void threadEventRegistration();
 
-            bool _doTrace(std::string &endpoint, int packets, JsonObject& response);
-            bool _doTraceNamedEndpoint(std::string &endpointName, int packets, JsonObject& response);
+            bool _doTrace(std::string &endpoint, int packets, JsonObject& response, const std::string& guid = "", bool async = false);
+            bool _doTraceNamedEndpoint(std::string &endpointName, int packets, JsonObject& response, const std::string& guid = "", bool async = false);
 
-            JsonObject _doPing(const std::string& guid, const std::string& endPoint, int packets);
-            JsonObject _doPingNamedEndpoint(const std::string& guid, const std::string& endpointName, int packets);
+            JsonObject _doPing(const std::string& guid, const std::string& endPoint, int packets, bool async = false);
+            JsonObject _doPingNamedEndpoint(const std::string& guid, const std::string& endpointName, int packets, bool async = false);
 
         public:
             Network();
@@ -125,6 +135,14 @@ namespace WPEFramework {
 
         private:
             NetUtils m_netUtils;
+            PingEngine m_pingEngine;
+            DnsCache m_dnsCache;
+            ConnectivityMonitor m_connectivityMonitor;
+#ifdef USE_NETLINK
+            NetlinkMonitor m_netlinkMonitor;
+            std::mutex m_ipSettingsProtect;
+            std::map<std::string, std::pair<unsigned, JsonObject>> m_ipSettings;   // netsrvmgr replies by request, with the netlink table version
+#endif
             string m_stunEndPoint;
             string m_isHybridDevice;
             string m_defaultInterface;
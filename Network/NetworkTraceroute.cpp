@@ -21,12 +21,6 @@
 #include <fcntl.h>
 #include <string.h>
 
-//e.g. traceroute -w 3 -m 6 -q 3 192.168.1.100 52
-#define CMD_TRACEROUTE "traceroute -w %d -m %d -q %d %s %d 2>&1"
-//e.g. traceroute6 -i eth0 -w 3 -m 6 -q 3 fe80::5a19:f8ff:fe37:7a3d 52
-#define CMD_TRACEROUTE6 "traceroute6 -i %s -w %d -m %d -q %d %s %d 2>&1"
-
-#define DEFAULT_PACKET_LENGTH   52
 #define DEFAULT_WAIT            3
 #define DEFAULT_MAX_HOPS        6
 #define DEFAULT_QUERIES         3
@@ -35,7 +29,58 @@
 namespace WPEFramework {
     namespace Plugin {
 
-        bool Network::_doTraceNamedEndpoint(std::string &endpointName, int packets, JsonObject &response)
+        // As traceroute prints it, e.g. " 2  10.0.0.1  1.204 ms  1.187 ms  *"
+        static std::string formatHop(const PingEngine::Hop& hop)
+        {
+            char text[64];
+            snprintf(text, sizeof(text), "%2d  %s", hop.ttl, hop.address.empty() ? "*" : hop.address.c_str());
+
+            std::string line(text);
+            for (size_t i = 0; i < hop.rtt.size(); i++)
+            {
+                if (hop.address.empty())
+                {
+                    if (i > 0)
+                        line += " *";
+                    continue;
+                }
+
+                if (hop.rtt[i] < 0)
+                {
+                    line += "  *";
+                }
+                else
+                {
+                    snprintf(text, sizeof(text), "  %.3f ms", hop.rtt[i]);
+                    line += text;
+                }
+            }
+
+            return line;
+        }
+
+        static JsonArray hopTrips(const PingEngine::Hop& hop)
+        {
+            char text[32];
+            JsonArray trips;
+
+            for (double rtt : hop.rtt)
+            {
+                if (rtt < 0)
+                {
+                    trips.Add(string("*"));
+                }
+                else
+                {
+                    snprintf(text, sizeof(text), "%.3f", rtt);
+                    trips.Add(string(text));
+                }
+            }
+
+            return trips;
+        }
+
+        bool Network::_doTraceNamedEndpoint(std::string &endpointName, int packets, JsonObject &response, const std::string& guid, bool async)
         {
             std::string interface;
             std::string endpoint = "";
@@ -46,7 +91,7 @@ namespace WPEFramework {
             }
             else if (_getDefaultInterface(interface, endpoint) && !endpoint.empty())
             {
-                return _doTrace(endpoint, packets, response);
+                return _doTrace(endpoint, packets, response, guid, async);
             }
             else
             {
@@ -56,17 +101,16 @@ namespace WPEFramework {
             return false;
         }
 
-        bool Network::_doTrace(std::string &endpoint, int packets, JsonObject &response)
+        bool Network::_doTrace(std::string &endpoint, int packets, JsonObject &response, const std::string& guid, bool async)
         {
-            std::string output = "";
             std::string error = "";
             std::string interface = "";
             std::string gateway;
+            std::string address;
+            DnsCache::Lookup lookup;
             int wait = DEFAULT_WAIT;
             int maxHops = DEFAULT_MAX_HOPS;
-            int packetLen = DEFAULT_PACKET_LENGTH;
-            char command[MAX_COMMAND_LENGTH];
-            bool result = false;
+            std::vector<PingEngine::Hop> hops;
 
             if (packets <= 0)
             {
@@ -87,64 +131,73 @@ namespace WPEFramework {
             {
                 error = "Could not get default interface";
             }
+            else if (!m_dnsCache.resolve(endpoint, address, lookup))
+            {
+                error = "Could not resolve endpoint";
+            }
+            else if (async)
+            {
+                // Each hop follows in onTraceHop as soon as it is known, everything in onTraceResult.
+                std::string target(endpoint);
+                std::string header = "traceroute to " + endpoint + " (" + address + "), " + std::to_string(maxHops) + " hops max";
+
+                m_pingEngine.trace(address, interface, maxHops, packets, wait * 1000, [this, guid, target](const PingEngine::Hop& hop) {
+                    JsonObject params;
+                    params["target"] = target;
+                    params["hop"] = hop.ttl;
+                    params["address"] = hop.address;
+                    params["trips"] = hopTrips(hop);
+                    params["result"] = formatHop(hop);
+                    params["guid"] = guid;
+                    sendNotify("onTraceHop", params);
+                }, [this, guid, target, header](const std::vector<PingEngine::Hop>& traceHops, const std::string& traceError) {
+                    JsonArray list;
+                    list.Add(header);
+                    for (const PingEngine::Hop& hop : traceHops)
+                        list.Add(formatHop(hop));
+
+                    JsonObject params;
+                    params["target"] = target;
+                    params["success"] = traceError.empty();
+                    params["results"] = list;
+                    params["error"] = traceError;
+                    params["guid"] = guid;
+                    sendNotify("onTraceResult", params);
+                }, error);
+            }
             else
             {
-                if (NetUtils::isIPV6(endpoint))
-                {
-                    snprintf(command, MAX_COMMAND_LENGTH, CMD_TRACEROUTE6,
-                            interface.c_str(),
-                            wait,
-                            maxHops,
-                            packets,
-                            endpoint.c_str(),
-                            packetLen);
-                }
-                else
-                {
-                    snprintf(command, MAX_COMMAND_LENGTH, CMD_TRACEROUTE,
-                            wait,
-                            maxHops,
-                            packets,
-                            endpoint.c_str(),
-                            packetLen);
-                }
+                m_pingEngine.trace(address, interface, maxHops, packets, wait * 1000, hops, error);
+            }
 
-                if (NetUtils::execCmd(command, output, &result) < 0)
-                {
-                    error = "Failed to execute traceroute command";
-                }
-                else if (!result) // check the command return status
-                {
-                    error = "Failed to execute traceroute";
-                }
+            response["target"] = endpoint;
+            response["guid"] = guid;
+
+            if (!address.empty())
+            {
+                char resolveTime[32];
+                snprintf(resolveTime, sizeof(resolveTime), "%.3f", lookup.time);
+                response["resolveTime"] = string(resolveTime);
+                response["resolveCached"] = lookup.cached;
             }
 
             if (error.empty())
             {
-                // We return the entire output of the trace command but since this contains newlines it is not valid as
-                // a json value so we will parse the output into an array of strings, one element for each line.
+                // One line for each hop, as traceroute prints them.
                 JsonArray list;
-                if (!output.empty())
+                if (!async)
                 {
-                    std::string::size_type last = 0;
-                    std::string::size_type next = output.find('\n');
-                    while (next != std::string::npos)
-                    {
-                        list.Add(output.substr(last, next - last));
-                        last = next + 1;
-                        next = output.find('\n', last);
-                    }
-                    list.Add(output.substr(last));
+                    list.Add("traceroute to " + endpoint + " (" + address + "), " + std::to_string(maxHops) + " hops max");
+                    for (const PingEngine::Hop& hop : hops)
+                        list.Add(formatHop(hop));
                 }
 
-                response["target"] = endpoint;
                 response["results"] = list;
                 response["error"] = "";
                 return true;
             }
             else
             {
-                response["target"] = endpoint;
                 response["results"] = "";
                 response["error"] = error;
                 return false;
@@ -0,0 +1,801 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PingEngine.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <linux/errqueue.h>
+#include <netinet/icmp6.h>
+#include <netinet/in.h>
+#include <netinet/ip6.h>
+#include <netinet/ip_icmp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+
+#include "utils.h"
+
+#define PING_MAX_SESSIONS       32
+#define PING_MAX_PACKETS        1000
+#define PING_INTERVAL_MS        200
+#define PING_REPLY_TIMEOUT_MS   5000    // after the last request, as ping -W 5
+#define PING_PAYLOAD_SIZE       56
+#define PING_PACKET_SIZE        1500
+#define TRACE_MAX_HOPS          30
+#define TRACE_MAX_QUERIES       10
+#define TRACE_ROUND_INTERVAL_MS 50      // between the rounds of probes for all TTLs
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        static uint16_t checksum(const uint8_t* data, size_t length)
+        {
+            uint32_t sum = 0;
+
+            for (; length > 1; data += 2, length -= 2)
+                sum += (data[0] << 8) | data[1];
+            if (length == 1)
+                sum += data[0] << 8;
+
+            while (sum >> 16)
+                sum = (sum & 0xffff) + (sum >> 16);
+
+            return htons(static_cast<uint16_t>(~sum));
+        }
+
+        PingEngine::PingEngine()
+            : m_running(false)
+            , m_epoll(-1)
+            , m_event(-1)
+            , m_sessions(0)
+            , m_sequence(static_cast<uint16_t>(getpid()))
+        {
+        }
+
+        PingEngine::~PingEngine()
+        {
+            stop();
+        }
+
+        bool PingEngine::start()
+        {
+            if (m_running)
+                return true;
+
+            m_epoll = epoll_create1(EPOLL_CLOEXEC);
+            m_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+            struct epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.ptr = NULL;
+
+            if (m_epoll < 0 || m_event < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_event, &event) < 0)
+            {
+                LOGERR("Failed to set up the ping engine: %s", strerror(errno));
+                if (m_epoll >= 0)
+                    close(m_epoll);
+                if (m_event >= 0)
+                    close(m_event);
+                m_epoll = m_event = -1;
+                return false;
+            }
+
+            m_running = true;
+            m_thread = std::thread(&PingEngine::run, this);
+
+            return true;
+        }
+
+        void PingEngine::stop()
+        {
+            if (!m_running)
+                return;
+
+            m_running = false;
+            wake();
+
+            if (m_thread.joinable())
+                m_thread.join();
+
+            close(m_epoll);
+            close(m_event);
+            m_epoll = m_event = -1;
+        }
+
+        bool PingEngine::resolve(const std::string& endpoint, std::string& address)
+        {
+            const int families[] = { AF_INET, AF_INET6 };
+
+            for (int family : families)
+            {
+                struct addrinfo hints = {};
+                struct addrinfo* info = NULL;
+
+                hints.ai_family = family;
+                hints.ai_socktype = SOCK_DGRAM;
+
+                if (getaddrinfo(endpoint.c_str(), NULL, &hints, &info) == 0 && info != NULL)
+                {
+                    char host[NI_MAXHOST];
+                    bool found = (getnameinfo(info->ai_addr, info->ai_addrlen, host, sizeof(host), NULL, 0, NI_NUMERICHOST) == 0);
+                    freeaddrinfo(info);
+
+                    if (found)
+                    {
+                        address = host;
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+
+        bool PingEngine::submit(const std::string& address, const std::string& interface, int packets, const Callback& callback, std::string& error)
+        {
+            Session* session = new Session();
+            session->packets = std::max(1, std::min(packets, PING_MAX_PACKETS));
+            session->callback = callback;
+
+            return add(session, address, interface, error);
+        }
+
+        bool PingEngine::ping(const std::string& address, const std::string& interface, int packets, Result& result)
+        {
+            std::mutex lock;
+            std::condition_variable condition;
+            bool done = false;
+
+            std::string error;
+            bool submitted = submit(address, interface, packets, [&](const Result& pingResult) {
+                std::lock_guard<std::mutex> guard(lock);
+                result = pingResult;
+                done = true;
+                condition.notify_one();
+            }, error);
+
+            if (!submitted)
+            {
+                result = Result();
+                result.error = error;
+                return false;
+            }
+
+            std::unique_lock<std::mutex> guard(lock);
+            condition.wait(guard, [&done] { return done; });
+
+            return result.error.empty();
+        }
+
+        bool PingEngine::trace(const std::string& address, const std::string& interface, int maxHops, int queries, int wait,
+                const HopCallback& hopCallback, const TraceCallback& traceCallback, std::string& error)
+        {
+            Session* session = new Session();
+            session->hops = std::max(1, std::min(maxHops, TRACE_MAX_HOPS));
+            session->packets = session->hops * std::max(1, std::min(queries, TRACE_MAX_QUERIES));
+            session->wait = std::max(1, wait);
+            session->from.resize(session->packets);
+            session->fromTarget.assign(session->packets, false);
+            session->reported.assign(session->hops + 1, false);
+            session->hopCallback = hopCallback;
+            session->traceCallback = traceCallback;
+
+            return add(session, address, interface, error);
+        }
+
+        bool PingEngine::trace(const std::string& address, const std::string& interface, int maxHops, int queries, int wait,
+                std::vector<Hop>& hops, std::string& error)
+        {
+            std::mutex lock;
+            std::condition_variable condition;
+            bool done = false;
+
+            bool submitted = trace(address, interface, maxHops, queries, wait, [](const Hop&) {
+            }, [&](const std::vector<Hop>& traceHops, const std::string& traceError) {
+                std::lock_guard<std::mutex> guard(lock);
+                hops = traceHops;
+                error = traceError;
+                done = true;
+                condition.notify_one();
+            }, error);
+
+            if (!submitted)
+                return false;
+
+            std::unique_lock<std::mutex> guard(lock);
+            condition.wait(guard, [&done] { return done; });
+
+            return error.empty();
+        }
+
+        bool PingEngine::add(Session* session, const std::string& address, const std::string& interface, std::string& error)
+        {
+            if (!m_running)
+            {
+                error = "Ping engine not running";
+                delete session;
+                return false;
+            }
+
+            session->sentAt.resize(session->packets);
+            session->rtt.assign(session->packets, -1.0);
+
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            if (m_sessions >= PING_MAX_SESSIONS)
+            {
+                error = "Too many pings in progress";
+                delete session;
+                return false;
+            }
+
+            session->id = ++m_sequence;
+
+            if (!open(*session, address, interface, error))
+            {
+                delete session;
+                return false;
+            }
+
+            m_sessions++;
+            m_pending.push_back(session);
+            lock.unlock();
+
+            wake();
+
+            return true;
+        }
+
+        // Called with m_lock held, the socket is set up before the thread gets to see the session.
+        bool PingEngine::open(Session& session, const std::string& address, const std::string& interface, std::string& error)
+        {
+            memset(&session.target, 0, sizeof(session.target));
+
+            struct sockaddr_in* target4 = reinterpret_cast<struct sockaddr_in*>(&session.target);
+            struct sockaddr_in6* target6 = reinterpret_cast<struct sockaddr_in6*>(&session.target);
+
+            if (inet_pton(AF_INET, address.c_str(), &target4->sin_addr) == 1)
+            {
+                target4->sin_family = AF_INET;
+                session.targetLength = sizeof(struct sockaddr_in);
+            }
+            else if (inet_pton(AF_INET6, address.c_str(), &target6->sin6_addr) == 1)
+            {
+                target6->sin6_family = AF_INET6;
+                session.targetLength = sizeof(struct sockaddr_in6);
+                session.ipv6 = true;
+
+                if (IN6_IS_ADDR_LINKLOCAL(&target6->sin6_addr) && !interface.empty())
+                    target6->sin6_scope_id = if_nametoindex(interface.c_str());
+            }
+            else
+            {
+                error = "Bad Address";
+                return false;
+            }
+
+            const int family = session.ipv6 ? AF_INET6 : AF_INET;
+            const int protocol = session.ipv6 ? static_cast<int>(IPPROTO_ICMPV6) : static_cast<int>(IPPROTO_ICMP);
+
+            // Unprivileged ping sockets need net.ipv4.ping_group_range, raw ones CAP_NET_RAW.
+            session.fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+            if (session.fd < 0)
+            {
+                session.fd = socket(family, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+                session.raw = true;
+            }
+
+            if (session.fd < 0)
+            {
+                LOGERR("Failed to open an ICMP socket: %s", strerror(errno));
+                error = "Could not open ICMP socket";
+                return false;
+            }
+
+            if (session.ipv6)
+            {
+                // As ping6 -I, the default interface carries IPv6 pings.
+                if (!interface.empty() && setsockopt(session.fd, SOL_SOCKET, SO_BINDTODEVICE, interface.c_str(), interface.size() + 1) < 0)
+                    LOGWARN("Could not bind the ping to %s: %s", interface.c_str(), strerror(errno));
+
+                if (session.raw)
+                {
+                    struct icmp6_filter filter;
+                    ICMP6_FILTER_SETBLOCKALL(&filter);
+                    ICMP6_FILTER_SETPASS(ICMP6_ECHO_REPLY, &filter);
+                    if (session.hops > 0)
+                    {
+                        ICMP6_FILTER_SETPASS(ICMP6_TIME_EXCEEDED, &filter);
+                        ICMP6_FILTER_SETPASS(ICMP6_DST_UNREACH, &filter);
+                    }
+                    setsockopt(session.fd, IPPROTO_ICMPV6, ICMP6_FILTER, &filter, sizeof(filter));
+                }
+            }
+
+            // Datagram sockets hand ICMP errors, the routers' answers to a traceroute, to the error queue.
+            if (session.hops > 0 && !session.raw)
+            {
+                int on = 1;
+                if (session.ipv6)
+                    setsockopt(session.fd, IPPROTO_IPV6, IPV6_RECVERR, &on, sizeof(on));
+                else
+                    setsockopt(session.fd, IPPROTO_IP, IP_RECVERR, &on, sizeof(on));
+            }
+
+            struct epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.ptr = &session;
+
+            if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, session.fd, &event) < 0)
+            {
+                LOGERR("Failed to watch the ICMP socket: %s", strerror(errno));
+                close(session.fd);
+                session.fd = -1;
+                error = "Could not open ICMP socket";
+                return false;
+            }
+
+            return true;
+        }
+
+        void PingEngine::wake()
+        {
+            uint64_t value = 1;
+            if (write(m_event, &value, sizeof(value)) < 0)
+                LOGWARN("Failed to wake the ping engine: %s", strerror(errno));
+        }
+
+        void PingEngine::run()
+        {
+            struct epoll_event events[PING_MAX_SESSIONS + 1];
+
+            while (m_running)
+            {
+                Clock::time_point now = Clock::now();
+                int timeout = -1;
+
+                for (Session* session : m_active)
+                {
+                    Clock::time_point due = (session->sent < session->packets) ? session->nextSend : session->deadline;
+                    int wait = std::max(0, static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count()) + 1);
+                    if (timeout < 0 || wait < timeout)
+                        timeout = wait;
+                }
+
+                int count = epoll_wait(m_epoll, events, PING_MAX_SESSIONS + 1, timeout);
+                if (count < 0 && errno != EINTR)
+                {
+                    LOGERR("Ping engine failed to wait: %s", strerror(errno));
+                    break;
+                }
+
+                now = Clock::now();
+
+                for (int i = 0; i < count; i++)
+                {
+                    if (events[i].data.ptr == NULL)
+                    {
+                        uint64_t value;
+                        if (read(m_event, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                            LOGWARN("Failed to read the ping engine event: %s", strerror(errno));
+                    }
+                    else
+                    {
+                        receive(*static_cast<Session*>(events[i].data.ptr), now);
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    for (Session* session : m_pending)
+                    {
+                        session->nextSend = now;
+                        m_active.push_back(session);
+                    }
+                    m_pending.clear();
+                }
+
+                for (auto it = m_active.begin(); it != m_active.end();)
+                {
+                    Session* session = *it;
+
+                    if (session->sent < session->packets && now >= session->nextSend)
+                        transmit(*session, now);
+
+                    if (progress(*session, now))
+                    {
+                        it = m_active.erase(it);
+                        finish(session);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+
+            // Nobody waits for results any longer than the engine lives.
+            std::list<Session*> sessions;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                sessions.swap(m_pending);
+            }
+            sessions.splice(sessions.end(), m_active);
+
+            for (Session* session : sessions)
+            {
+                session->result.error = "Ping engine stopped";
+                finish(session);
+            }
+        }
+
+        void PingEngine::transmit(Session& session, Clock::time_point now)
+        {
+            if (session.hops > 0)
+            {
+                // A round: one probe for every TTL.
+                for (int ttl = 1; ttl <= session.hops; ttl++)
+                {
+                    if (session.ipv6)
+                        setsockopt(session.fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof(ttl));
+                    else
+                        setsockopt(session.fd, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl));
+
+                    send(session, static_cast<uint16_t>(session.sent), now);
+                }
+
+                session.nextSend = now + std::chrono::milliseconds(TRACE_ROUND_INTERVAL_MS);
+                if (session.sent == session.packets)
+                    session.deadline = now + std::chrono::milliseconds(session.wait);
+            }
+            else
+            {
+                send(session, static_cast<uint16_t>(session.sent), now);
+
+                session.nextSend = now + std::chrono::milliseconds(PING_INTERVAL_MS);
+                if (session.sent == session.packets)
+                    session.deadline = now + std::chrono::milliseconds(PING_REPLY_TIMEOUT_MS);
+            }
+
+            session.result.transmitted = session.sent;
+        }
+
+        void PingEngine::send(Session& session, uint16_t sequence, Clock::time_point now)
+        {
+            uint8_t packet[sizeof(struct icmphdr) + PING_PAYLOAD_SIZE];
+
+            memset(packet, 0, sizeof(packet));
+            for (size_t i = sizeof(struct icmphdr); i < sizeof(packet); i++)
+                packet[i] = static_cast<uint8_t>(i);
+
+            if (session.ipv6)
+            {
+                // The kernel fills in the ICMPv6 checksum.
+                struct icmp6_hdr* header = reinterpret_cast<struct icmp6_hdr*>(packet);
+                header->icmp6_type = ICMP6_ECHO_REQUEST;
+                header->icmp6_id = htons(session.id);
+                header->icmp6_seq = htons(sequence);
+            }
+            else
+            {
+                struct icmphdr* header = reinterpret_cast<struct icmphdr*>(packet);
+                header->type = ICMP_ECHO;
+                header->un.echo.id = htons(session.id);
+                header->un.echo.sequence = htons(sequence);
+                header->checksum = checksum(packet, sizeof(packet));
+            }
+
+            session.sentAt[sequence] = now;
+            session.sent++;
+
+            if (sendto(session.fd, packet, sizeof(packet), 0, reinterpret_cast<struct sockaddr*>(&session.target), session.targetLength) < 0)
+                LOGWARN("Failed to send ping %d: %s", sequence, strerror(errno));
+        }
+
+        void PingEngine::receive(Session& session, Clock::time_point now)
+        {
+            uint8_t packet[PING_PACKET_SIZE];
+            struct sockaddr_storage from;
+            socklen_t fromLength = sizeof(from);
+            ssize_t length;
+
+            while ((length = recvfrom(session.fd, packet, sizeof(packet), 0, reinterpret_cast<struct sockaddr*>(&from), &fromLength)) > 0)
+            {
+                const uint8_t* icmp = packet;
+                fromLength = sizeof(from);
+
+                if (session.ipv6)
+                {
+                    // No IP header on ICMPv6 sockets.
+                    if (static_cast<size_t>(length) < sizeof(struct icmp6_hdr))
+                        continue;
+
+                    const struct icmp6_hdr* header = reinterpret_cast<const struct icmp6_hdr*>(icmp);
+
+                    if (header->icmp6_type == ICMP6_ECHO_REPLY)
+                    {
+                        answer(session, ntohs(header->icmp6_id), ntohs(header->icmp6_seq), from, true, now);
+                    }
+                    else if (session.raw && (header->icmp6_type == ICMP6_TIME_EXCEEDED || header->icmp6_type == ICMP6_DST_UNREACH))
+                    {
+                        // Carries the start of our request: its IPv6 header, then the ICMPv6 one.
+                        const size_t offset = sizeof(struct icmp6_hdr) + sizeof(struct ip6_hdr);
+                        if (static_cast<size_t>(length) < offset + sizeof(struct icmp6_hdr))
+                            continue;
+
+                        const struct icmp6_hdr* request = reinterpret_cast<const struct icmp6_hdr*>(icmp + offset);
+                        if (request->icmp6_type == ICMP6_ECHO_REQUEST)
+                            answer(session, ntohs(request->icmp6_id), ntohs(request->icmp6_seq), from, (header->icmp6_type == ICMP6_DST_UNREACH), now);
+                    }
+                }
+                else
+                {
+                    // Raw IPv4 sockets deliver the IP header too.
+                    if (session.raw)
+                    {
+                        size_t headerLength = (packet[0] & 0x0f) * 4;
+                        if (static_cast<size_t>(length) < headerLength)
+                            continue;
+                        icmp += headerLength;
+                        length -= headerLength;
+                    }
+
+                    if (static_cast<size_t>(length) < sizeof(struct icmphdr))
+                        continue;
+
+                    const struct icmphdr* header = reinterpret_cast<const struct icmphdr*>(icmp);
+
+                    if (header->type == ICMP_ECHOREPLY)
+                    {
+                        answer(session, ntohs(header->un.echo.id), ntohs(header->un.echo.sequence), from, true, now);
+                    }
+                    else if (session.raw && (header->type == ICMP_TIME_EXCEEDED || header->type == ICMP_DEST_UNREACH))
+                    {
+                        // Carries the start of our request: its IP header, then the ICMP one.
+                        const uint8_t* inner = icmp + sizeof(struct icmphdr);
+                        if (static_cast<size_t>(length) < sizeof(struct icmphdr) + 1)
+                            continue;
+
+                        const size_t innerLength = (inner[0] & 0x0f) * 4;
+                        if (static_cast<size_t>(length) < sizeof(struct icmphdr) + innerLength + sizeof(struct icmphdr))
+                            continue;
+
+                        const struct icmphdr* request = reinterpret_cast<const struct icmphdr*>(inner + innerLength);
+                        if (request->type == ICMP_ECHO)
+                            answer(session, ntohs(request->un.echo.id), ntohs(request->un.echo.sequence), from, (header->type == ICMP_DEST_UNREACH), now);
+                    }
+                }
+            }
+
+            if (session.hops > 0 && !session.raw)
+                receiveErrors(session, now);
+        }
+
+        void PingEngine::receiveErrors(Session& session, Clock::time_point now)
+        {
+            uint8_t packet[PING_PACKET_SIZE];
+            uint8_t control[512];
+
+            for (;;)
+            {
+                struct iovec vector = { packet, sizeof(packet) };
+                struct msghdr message = {};
+                message.msg_iov = &vector;
+                message.msg_iovlen = 1;
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+
+                ssize_t length = recvmsg(session.fd, &message, MSG_ERRQUEUE | MSG_DONTWAIT);
+                if (length < 0)
+                    break;
+
+                // The data is our own request, the kernel replaced its id.
+                if (static_cast<size_t>(length) < sizeof(struct icmphdr))
+                    continue;
+
+                const uint16_t sequence = session.ipv6
+                        ? ntohs(reinterpret_cast<const struct icmp6_hdr*>(packet)->icmp6_seq)
+                        : ntohs(reinterpret_cast<const struct icmphdr*>(packet)->un.echo.sequence);
+
+                for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL; cmsg = CMSG_NXTHDR(&message, cmsg))
+                {
+                    if (!((cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR)
+                            || (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+                        continue;
+
+                    const struct sock_extended_err* error = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cmsg));
+                    if (error->ee_origin != SO_EE_ORIGIN_ICMP && error->ee_origin != SO_EE_ORIGIN_ICMP6)
+                        continue;
+
+                    struct sockaddr_storage from = {};
+                    const struct sockaddr* offender = SO_EE_OFFENDER(error);
+                    memcpy(&from, offender, (offender->sa_family == AF_INET6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+
+                    const bool unreachable = session.ipv6 ? (error->ee_type == ICMP6_DST_UNREACH) : (error->ee_type == ICMP_DEST_UNREACH);
+                    answer(session, session.id, sequence, from, unreachable, now);
+                }
+            }
+        }
+
+        void PingEngine::answer(Session& session, uint16_t id, uint16_t sequence, const struct sockaddr_storage& from, bool fromTarget, Clock::time_point now)
+        {
+            // Datagram sockets get only their own replies, with the id replaced by the kernel.
+            if (session.raw && id != session.id)
+                return;
+
+            if (sequence >= session.sent || session.rtt[sequence] >= 0)
+                return;
+
+            session.rtt[sequence] = std::chrono::duration_cast<std::chrono::microseconds>(now - session.sentAt[sequence]).count() / 1000.0;
+            session.result.received++;
+
+            if (session.hops > 0)
+            {
+                char host[NI_MAXHOST] = "";
+                getnameinfo(reinterpret_cast<const struct sockaddr*>(&from), (from.ss_family == AF_INET6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in),
+                        host, sizeof(host), NULL, 0, NI_NUMERICHOST);
+                session.from[sequence] = host;
+                session.fromTarget[sequence] = fromTarget;
+
+                const int ttl = (sequence % session.hops) + 1;
+                if (fromTarget && (session.targetHop == 0 || ttl < session.targetHop))
+                    session.targetHop = ttl;
+            }
+        }
+
+        // Reports the hops that are complete, true once the ping or trace is.
+        bool PingEngine::progress(Session& session, Clock::time_point now)
+        {
+            const bool expired = (session.sent == session.packets && now >= session.deadline);
+
+            if (session.hops == 0)
+                return (session.result.received == session.packets || expired);
+
+            const int last = (session.targetHop > 0) ? session.targetHop : session.hops;
+            const int queries = session.packets / session.hops;
+            bool complete = true;
+
+            for (int ttl = 1; ttl <= last; ttl++)
+            {
+                if (session.reported[ttl])
+                    continue;
+
+                bool answered = true;
+                bool target = false;
+                for (int query = 0; query < queries; query++)
+                {
+                    const int sequence = query * session.hops + ttl - 1;
+                    answered = answered && (session.rtt[sequence] >= 0);
+                    target = target || session.fromTarget[sequence];
+                }
+
+                // The hop reaching the target is the last, it goes out after all others.
+                if ((answered && (!target || complete)) || expired)
+                {
+                    session.reported[ttl] = true;
+                    session.hopCallback(hop(session, ttl));
+                }
+                else
+                {
+                    complete = false;
+                }
+            }
+
+            return complete;
+        }
+
+        PingEngine::Hop PingEngine::hop(const Session& session, int ttl) const
+        {
+            Hop hop;
+            hop.ttl = ttl;
+
+            for (int sequence = ttl - 1; sequence < session.packets; sequence += session.hops)
+            {
+                hop.rtt.push_back(session.rtt[sequence]);
+                if (hop.address.empty())
+                    hop.address = session.from[sequence];
+                hop.target = hop.target || session.fromTarget[sequence];
+            }
+
+            return hop;
+        }
+
+        void PingEngine::finish(Session* session)
+        {
+            Result& result = session->result;
+
+            if (session->fd >= 0)
+            {
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, session->fd, NULL);
+                close(session->fd);
+            }
+
+            if (session->hops > 0)
+            {
+                std::vector<Hop> hops;
+                const int last = (session->targetHop > 0) ? session->targetHop : session->hops;
+
+                for (int ttl = 1; ttl <= last; ttl++)
+                    hops.push_back(hop(*session, ttl));
+
+                session->traceCallback(hops, result.error);
+            }
+            else
+            {
+                if (result.transmitted > 0)
+                    result.loss = 100.0 * (result.transmitted - result.received) / result.transmitted;
+
+                if (result.received > 0)
+                {
+                    double sum = 0.0;
+                    double squares = 0.0;
+                    double differences = 0.0;
+                    double previous = -1.0;
+                    int steps = 0;
+
+                    result.min = -1.0;
+
+                    for (double rtt : session->rtt)
+                    {
+                        if (rtt < 0)
+                            continue;
+
+                        if (result.min < 0 || rtt < result.min)
+                            result.min = rtt;
+                        if (rtt > result.max)
+                            result.max = rtt;
+                        sum += rtt;
+                        squares += rtt * rtt;
+
+                        if (previous >= 0)
+                        {
+                            differences += fabs(rtt - previous);
+                            steps++;
+                        }
+                        previous = rtt;
+                    }
+
+                    result.avg = sum / result.received;
+                    result.stddev = sqrt(std::max(0.0, squares / result.received - result.avg * result.avg));
+                    result.jitter = (steps > 0) ? differences / steps : 0.0;
+                }
+                else if (result.error.empty())
+                {
+                    result.error = "Could not ping endpoint";
+                }
+
+                session->callback(result);
+            }
+
+            delete session;
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_sessions--;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,148 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // ICMP/ICMPv6 echo, in process. One thread serves all pings and traceroutes
+        // in parallel, each on its own socket (datagram when the kernel allows
+        // unprivileged ping, raw otherwise) and all of them in one epoll set.
+        class PingEngine {
+        public:
+            struct Result {
+                int transmitted = 0;
+                int received = 0;
+                double loss = 0.0;      // %
+                double min = 0.0;       // ms, this and below only with replies
+                double avg = 0.0;
+                double max = 0.0;
+                double stddev = 0.0;
+                double jitter = 0.0;    // mean difference of consecutive round trips
+                std::string error;
+            };
+
+            struct Hop {
+                int ttl = 0;
+                std::string address;        // first to answer, empty if nobody did
+                std::vector<double> rtt;    // ms per query, < 0 without an answer
+                bool target = false;        // answered by the target (or it was unreachable)
+            };
+
+            typedef std::function<void(const Result&)> Callback;
+            typedef std::function<void(const Hop&)> HopCallback;
+            typedef std::function<void(const std::vector<Hop>&, const std::string& error)> TraceCallback;
+
+            PingEngine();
+            virtual ~PingEngine();
+
+            PingEngine(const PingEngine&) = delete;
+            PingEngine& operator=(const PingEngine&) = delete;
+
+            bool start();
+            void stop();
+
+            // Numeric address of the endpoint, IPv4 preferred for names.
+            static bool resolve(const std::string& endpoint, std::string& address);
+
+            // The callback runs on the engine thread once all replies are in or timed out.
+            bool submit(const std::string& address, const std::string& interface, int packets, const Callback& callback, std::string& error);
+
+            // Blocks until the result is in.
+            bool ping(const std::string& address, const std::string& interface, int packets, Result& result);
+
+            // Probes all TTLs up to maxHops at once, queries rounds of them. Hops are reported
+            // as soon as all their queries are answered, in any order; the one reaching the
+            // target only after all hops before it. Unanswered probes count as lost after wait ms.
+            bool trace(const std::string& address, const std::string& interface, int maxHops, int queries, int wait,
+                    const HopCallback& hopCallback, const TraceCallback& traceCallback, std::string& error);
+
+            // Blocks until the trace is complete.
+            bool trace(const std::string& address, const std::string& interface, int maxHops, int queries, int wait,
+                    std::vector<Hop>& hops, std::string& error);
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Session {
+                int fd = -1;
+                bool ipv6 = false;
+                bool raw = false;
+                struct sockaddr_storage target;
+                socklen_t targetLength = 0;
+                uint16_t id = 0;
+                int packets = 0;
+                int sent = 0;
+                std::vector<Clock::time_point> sentAt;
+                std::vector<double> rtt;    // per sequence number, < 0 until replied
+                Clock::time_point nextSend;
+                Clock::time_point deadline;
+                Callback callback;
+                Result result;
+
+                // Traceroute: sequence number = round * hops + ttl - 1.
+                int hops = 0;
+                int wait = 0;
+                int targetHop = 0;              // lowest TTL answered by the target
+                std::vector<std::string> from;  // per sequence number
+                std::vector<bool> fromTarget;
+                std::vector<bool> reported;     // per hop
+                HopCallback hopCallback;
+                TraceCallback traceCallback;
+            };
+
+            bool add(Session* session, const std::string& address, const std::string& interface, std::string& error);
+            void run();
+            bool open(Session& session, const std::string& address, const std::string& interface, std::string& error);
+            void transmit(Session& session, Clock::time_point now);
+            void send(Session& session, uint16_t sequence, Clock::time_point now);
+            void receive(Session& session, Clock::time_point now);
+            void receiveErrors(Session& session, Clock::time_point now);
+            void answer(Session& session, uint16_t id, uint16_t sequence, const struct sockaddr_storage& from, bool fromTarget, Clock::time_point now);
+            bool progress(Session& session, Clock::time_point now);
+            Hop hop(const Session& session, int ttl) const;
+            void finish(Session* session);
+            void wake();
+
+        private:
+            std::thread m_thread;
+            std::atomic_bool m_running;
+            int m_epoll;
+            int m_event;
+
+            std::mutex m_lock;
+            std::list<Session*> m_pending;  // submitted, not picked up by the thread yet
+            std::list<Session*> m_active;   // owned by the thread
+            int m_sessions;                 // pending and active
+            uint16_t m_sequence;            // makes the raw socket ids unique
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
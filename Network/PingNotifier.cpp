@@ -25,18 +25,45 @@ namespace WPEFramework
 {
     namespace Plugin
     {
+        static string formatTrip(double milliseconds)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "%.3f", milliseconds);
+            return text;
+        }
+
+        static void setPingResult(JsonObject& pingResult, const PingEngine::Result& result)
+        {
+            char loss[32];
+            snprintf(loss, sizeof(loss), "%g", result.loss);
+
+            pingResult["success"] = result.error.empty();
+            pingResult["error"] = result.error;
+            pingResult["packetsTransmitted"] = result.transmitted;
+            pingResult["packetsReceived"] = result.received;
+            pingResult["packetLoss"] = string(loss);
+
+            if (result.received > 0)
+            {
+                pingResult["tripMin"] = formatTrip(result.min);
+                pingResult["tripAvg"] = formatTrip(result.avg);
+                pingResult["tripMax"] = formatTrip(result.max);
+                pingResult["tripStdDev"] = formatTrip(result.stddev);
+                pingResult["tripJitter"] = formatTrip(result.jitter);
+            }
+        }
+
         /**
          * @ingroup SERVMGR_PING_API
          */
-        JsonObject Network::_doPing(const string& guid, const string& endPoint, int packets)
+        JsonObject Network::_doPing(const string& guid, const string& endPoint, int packets, bool async)
         {
             LOGINFO("PingService calling ping");
             JsonObject pingResult;
             string interface = "";
             string gateway;
-            bool result = false;
-            string outputFile;
-            FILE *fp = NULL;
+            string address;
+            string error;
 
             pingResult["target"] = endPoint;
 
@@ -68,126 +95,40 @@ namespace WPEFramework
                 return pingResult;
             }
 
-            char cmd [1000] = {0x0};
-            if (NetUtils::isIPV6(endPoint))
-            {
-                snprintf(cmd, sizeof(cmd), "ping6 -I %s -c %d -W 5 '%s' 2>&1",
-                        interface.c_str(), packets, endPoint.c_str());
-            }
-            else
+            DnsCache::Lookup lookup;
+            if (!m_dnsCache.resolve(endPoint, address, lookup))
             {
-                snprintf(cmd, sizeof(cmd), "ping -c %d -W 5 '%s' 2>&1",
-                        packets, endPoint.c_str());
+                LOGERR("%s: Could not resolve '%s'", __FUNCTION__, endPoint.c_str());
+                pingResult["success"] = false;
+                pingResult["error"] = "Bad Address";
+                pingResult["guid"] = guid;
+                return pingResult;
             }
 
-            LOGWARN("ping command: %s", cmd);
+            LOGINFO("%s: pinging %s (%s) with %d packets%s", __FUNCTION__, endPoint.c_str(), address.c_str(), packets, async ? ", async" : "");
 
-            // Run the command and dump the output to /tmp/pingoutput
-            if (NetUtils::execCmd(cmd, outputFile, &result, "pingoutput") < 0)
-            {
-                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't open pipe for command '%s' for read mode: %s"
-                        , __FUNCTION__, cmd, strerror(errno));
+            pingResult["resolveTime"] = formatTrip(lookup.time);
+            pingResult["resolveCached"] = lookup.cached;
 
-                pingResult["success"] = false;
-                pingResult["error"] = "Could not run command";
-            }
-            else if (!result) // check the command return status
+            if (async)
             {
-                pingResult["success"] = false;
-                pingResult["error"] = "Could not ping endpoint";
-            }
-            else if ((fp = fopen(outputFile.c_str(), "r")) == NULL)
-            {
-                pingResult["success"] = false;
-                pingResult["error"] = "Could not read ping result";
+                // The result follows in onPingResult, the call only reports whether the ping started.
+                bool started = m_pingEngine.submit(address, interface, packets, [this, guid, endPoint](const PingEngine::Result& result) {
+                    JsonObject params;
+                    params["target"] = endPoint;
+                    setPingResult(params, result);
+                    params["guid"] = guid;
+                    sendNotify("onPingResult", params);
+                }, error);
+
+                pingResult["success"] = started;
+                pingResult["error"] = error;
             }
             else
             {
-                pingResult["success"] = true;
-                pingResult["error"] = "";
-
-                char linearray[1000]={0x0};
-                while(fgets(linearray, sizeof(linearray), fp) != NULL)
-                {
-                    // remove newline from linearray
-                    linearray[strcspn(linearray, "\n")] = '\0';
-                    string line(linearray);
-                    LOGINFO("ping result: %s", line.c_str());
-
-                    if( line.find( "packet" ) != string::npos )
-                    {
-                        //Example: 10 packets transmitted, 10 packets received, 0% packet loss
-
-                        stringstream ss( line );
-                        int transCount;
-                        ss >> transCount;
-                        pingResult["packetsTransmitted"] = transCount;
-
-                        string token;
-                        getline( ss, token, ',' );
-                        getline( ss, token, ',' );
-                        stringstream ss2( token );
-                        int rxCount;
-                        ss2 >> rxCount;
-                        pingResult["packetsReceived"] = rxCount;
-
-                        getline( ss, token, ',' );
-                        string prefix = token.substr(0, token.find("%"));
-                        //double lossFloat = ::atof(prefix.c_str());
-                        //pingResult["packetLoss"] = lossFloat;
-                        pingResult["packetLoss"] = prefix.c_str();
-
-                    }
-                    else if( line.find( "min/avg/max" ) != string::npos )
-                    {
-                        //Example: round-trip min/avg/max = 17.038/18.310/20.197 ms
-
-                        stringstream ss( line );
-                        string fullpath;
-                        getline( ss, fullpath, '=' );
-                        getline( ss, fullpath, '=' );
-
-                        string prefix;
-                        int index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            prefix = fullpath.substr(0, fullpath.find("/"));
-                            pingResult["tripMin"] = prefix.c_str();
-                        }
-
-                        index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            fullpath = fullpath.substr(index + 1, fullpath.length());
-                            prefix = fullpath.substr(0, fullpath.find("/"));
-                            pingResult["tripAvg"] = prefix.c_str();
-                        }
-
-                        index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            fullpath = fullpath.substr(index + 1, fullpath.length());
-                            prefix = fullpath.substr(0, fullpath.find("/"));
-                            pingResult["tripMax"] = prefix.c_str();
-                        }
-
-                        index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            fullpath = fullpath.substr(index + 1, fullpath.length());
-                            pingResult["tripStdDev"] = fullpath.c_str();
-                        }
-                    }
-                    else if( line.find( "bad" ) != string::npos )
-                    {
-                        pingResult["success"] = false;
-                        pingResult["error"] = "Bad Address";
-                    }
-                }
-                fclose(fp);
-
-                // clear up
-                remove(outputFile.c_str());
+                PingEngine::Result result;
+                m_pingEngine.ping(address, interface, packets, result);
+                setPingResult(pingResult, result);
             }
 
             pingResult["guid"] = guid;
@@ -198,7 +139,7 @@ namespace WPEFramework
         /**
          * @ingroup SERVMGR_PING_API
          */
-        JsonObject Network::_doPingNamedEndpoint(const string& guid, const string& endpointName, int packets)
+        JsonObject Network::_doPingNamedEndpoint(const string& guid, const string& endpointName, int packets, bool async)
         {
             LOGINFO("PingService calling pingNamedEndpoint for %s", endpointName.c_str());
             string error = "";
@@ -210,7 +151,7 @@ namespace WPEFramework
                 std::string gateway = "";
                 if (_getDefaultInterface(interface, gateway) && !gateway.empty())
                 {
-                    returnResult = _doPing(guid, gateway, packets);
+                    returnResult = _doPing(guid, gateway, packets, async);
                 }
                 else
                 {
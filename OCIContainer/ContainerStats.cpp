@@ -0,0 +1,231 @@
+#include "ContainerStats.h"
+
+#include "Module.h"
+#include "utils.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace WPEFramework
+{
+
+namespace Plugin
+{
+
+namespace
+{
+
+const char* const kCgroupRoot = "/sys/fs/cgroup";
+
+// Large enough for the blkio/io.stat files of a container on a set-top box
+const size_t kReadBufferSize = 4096;
+
+bool readFile(int fd, char* buffer, size_t size)
+{
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    ssize_t length = pread(fd, buffer, size - 1, 0);
+    if (length < 0)
+    {
+        return false;
+    }
+
+    buffer[length] = '\0';
+    return true;
+}
+
+uint64_t readValue(int fd)
+{
+    char buffer[64];
+
+    return (readFile(fd, buffer, sizeof(buffer)) ? strtoull(buffer, nullptr, 10) : 0);
+}
+
+// Value following 'key' in a "key value" or "key=value" formatted file, summed over all lines
+uint64_t sumValues(const char* buffer, const char* key)
+{
+    const size_t keyLength = strlen(key);
+    uint64_t total = 0;
+
+    for (const char* match = strstr(buffer, key); match != nullptr; match = strstr(match + keyLength, key))
+    {
+        total += strtoull(match + keyLength, nullptr, 10);
+    }
+
+    return total;
+}
+
+} // namespace
+
+ContainerStats::ContainerStats()
+    : mUnified(access("/sys/fs/cgroup/cgroup.controllers", F_OK) == 0)
+{
+}
+
+ContainerStats::~ContainerStats()
+{
+    for (std::pair<const std::string, Files>& entry : mFiles)
+    {
+        close(entry.second);
+    }
+}
+
+/**
+ * @brief Read the current resource usage of a container
+ *
+ * @param id         Container ID
+ * @param pidLookup  Returns a process of the container, called when the files are opened
+ * @param sample     Resource usage, counters that can't be read are 0
+ *
+ * @return false if none of the cgroup files of the container could be opened
+ */
+bool ContainerStats::read(const std::string& id, const std::function<pid_t()>& pidLookup, Sample& sample)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    std::map<std::string, Files>::iterator entry = mFiles.find(id);
+    if (entry == mFiles.end())
+    {
+        Files files;
+
+        if (!open(id, pidLookup(), files))
+        {
+            return false;
+        }
+
+        entry = mFiles.insert(std::make_pair(id, files)).first;
+    }
+
+    const Files& files = entry->second;
+    char buffer[kReadBufferSize];
+
+    memset(&sample, 0, sizeof(sample));
+
+    if (mUnified)
+    {
+        if (readFile(files.cpu, buffer, sizeof(buffer)))
+        {
+            sample.cpuUsage = sumValues(buffer, "usage_usec ") * 1000;
+        }
+        if (readFile(files.blkio, buffer, sizeof(buffer)))
+        {
+            sample.blkioRead = sumValues(buffer, "rbytes=");
+            sample.blkioWrite = sumValues(buffer, "wbytes=");
+        }
+    }
+    else
+    {
+        sample.cpuUsage = readValue(files.cpu);
+
+        if (readFile(files.blkio, buffer, sizeof(buffer)))
+        {
+            sample.blkioRead = sumValues(buffer, " Read ");
+            sample.blkioWrite = sumValues(buffer, " Write ");
+        }
+    }
+
+    sample.memoryCurrent = readValue(files.memoryCurrent);
+    sample.memoryPeak = readValue(files.memoryPeak);
+
+    // Sum over the interfaces of the container's network namespace, skipping loopback
+    if (readFile(files.net, buffer, sizeof(buffer)))
+    {
+        char* line = strchr(buffer, '\n');
+        line = (line != nullptr ? strchr(line + 1, '\n') : nullptr);
+
+        while (line != nullptr)
+        {
+            char name[32];
+            unsigned long long rx, tx;
+
+            line++;
+            if ((sscanf(line, " %31[^:]: %llu %*u %*u %*u %*u %*u %*u %*u %llu", name, &rx, &tx) == 3) &&
+                (strcmp(name, "lo") != 0))
+            {
+                sample.netRx += rx;
+                sample.netTx += tx;
+            }
+
+            line = strchr(line, '\n');
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Close the files of a container, e.g. because it stopped
+ */
+void ContainerStats::forget(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    std::map<std::string, Files>::iterator entry = mFiles.find(id);
+    if (entry != mFiles.end())
+    {
+        close(entry->second);
+        mFiles.erase(entry);
+    }
+}
+
+bool ContainerStats::open(const std::string& id, pid_t pid, Files& files) const
+{
+    const std::string root(kCgroupRoot);
+
+    if (mUnified)
+    {
+        const std::string path = root + "/" + id + "/";
+
+        files.cpu = ::open((path + "cpu.stat").c_str(), O_RDONLY | O_CLOEXEC);
+        files.memoryCurrent = ::open((path + "memory.current").c_str(), O_RDONLY | O_CLOEXEC);
+        files.memoryPeak = ::open((path + "memory.peak").c_str(), O_RDONLY | O_CLOEXEC);
+        files.blkio = ::open((path + "io.stat").c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    else
+    {
+        files.cpu = ::open((root + "/cpuacct/" + id + "/cpuacct.usage").c_str(), O_RDONLY | O_CLOEXEC);
+        files.memoryCurrent = ::open((root + "/memory/" + id + "/memory.usage_in_bytes").c_str(), O_RDONLY | O_CLOEXEC);
+        files.memoryPeak = ::open((root + "/memory/" + id + "/memory.max_usage_in_bytes").c_str(), O_RDONLY | O_CLOEXEC);
+        files.blkio = ::open((root + "/blkio/" + id + "/blkio.throttle.io_service_bytes").c_str(), O_RDONLY | O_CLOEXEC);
+    }
+
+    files.net = -1;
+    if (pid > 0)
+    {
+        files.net = ::open(("/proc/" + std::to_string(pid) + "/net/dev").c_str(), O_RDONLY | O_CLOEXEC);
+    }
+
+    if ((files.cpu < 0) && (files.memoryCurrent < 0) && (files.blkio < 0))
+    {
+        LOGWARN("No cgroup statistics found for container %s", id.c_str());
+        close(files);
+        return false;
+    }
+
+    return true;
+}
+
+void ContainerStats::close(Files& files) const
+{
+    const int fds[] = { files.cpu, files.memoryCurrent, files.memoryPeak, files.blkio, files.net };
+
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+
+    files.cpu = files.memoryCurrent = files.memoryPeak = files.blkio = files.net = -1;
+}
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace WPEFramework
+{
+
+namespace Plugin
+{
+
+/**
+ * @brief Reads the resource usage of Dobby containers from cgroupfs and procfs
+ *
+ * The stats files of a container are opened on its first read and kept open, later
+ * reads re-read them from offset 0. Both cgroup v1 (per controller hierarchies) and
+ * the cgroup v2 unified hierarchy are supported, Dobby names the cgroup after the
+ * container ID in either case.
+ */
+class ContainerStats
+{
+public:
+    struct Sample
+    {
+        uint64_t cpuUsage;      // ns
+        uint64_t memoryCurrent; // bytes
+        uint64_t memoryPeak;    // bytes
+        uint64_t blkioRead;     // bytes
+        uint64_t blkioWrite;    // bytes
+        uint64_t netRx;         // bytes
+        uint64_t netTx;         // bytes
+    };
+
+    ContainerStats();
+    ~ContainerStats();
+    ContainerStats(const ContainerStats &) = delete;
+    ContainerStats &operator=(const ContainerStats &) = delete;
+
+    // pidLookup is only called when the files of the container still have to be opened,
+    // its result is used for the network statistics
+    bool read(const std::string& id, const std::function<pid_t()>& pidLookup, Sample& sample);
+    void forget(const std::string& id);
+
+private:
+    struct Files
+    {
+        int cpu;
+        int memoryCurrent;
+        int memoryPeak;
+        int blkio;
+        int net;
+    };
+
+    bool open(const std::string& id, pid_t pid, Files& files) const;
+    void close(Files& files) const;
+
+    const bool mUnified;
+    std::map<std::string, Files> mFiles;
+    std::mutex mLock;
+};
+
+} // namespace Plugin
+} // namespace WPEFramework
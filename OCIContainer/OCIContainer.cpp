@@ -18,6 +18,9 @@ SERVICE_REGISTRATION(OCIContainer, 1, 0);
 
 OCIContainer::OCIContainer()
     : PluginHost::JSONRPC()
+    , mStartThreadsRunning(false)
+    , mStatsRunning(false)
+    , mStatsInterval(0)
 {
     Register("listContainers", &OCIContainer::listContainers, this);
     Register("getContainerState", &OCIContainer::getContainerState, this);
@@ -29,6 +32,10 @@ OCIContainer::OCIContainer()
     Register("pauseContainer", &OCIContainer::pauseContainer, this);
     Register("resumeContainer", &OCIContainer::resumeContainer, this);
     Register("executeCommand", &OCIContainer::executeCommand, this);
+    Register("createWarmPool", &OCIContainer::createWarmPool, this);
+    Register("claimContainer", &OCIContainer::claimContainer, this);
+    Register("destroyWarmPool", &OCIContainer::destroyWarmPool, this);
+    Register("getContainerStats", &OCIContainer::getContainerStats, this);
 }
 
 OCIContainer::~OCIContainer()
@@ -58,15 +65,77 @@ const string OCIContainer::Initialize(PluginHost::IShell *service)
     // Register a state change event listener
     mEventListenerId = mDobbyProxy->registerListener(stateListener, static_cast<const void*>(this));
 
+    // From here on the listener keeps the table up to date
+    refreshContainers();
+
     mOmiProxy = std::make_shared<omi::OmiProxy>();
 
     mOmiListenerId = mOmiProxy->registerListener(omiErrorListener, static_cast<const void*>(this));
 
+    mStartThreadsRunning = true;
+    for (int i = 0; i < OCI_START_THREADS; i++)
+    {
+        mStartThreads.push_back(std::thread(&OCIContainer::startThread, this));
+    }
+
+    Config config;
+    config.FromString(service->ConfigLine());
+    mStatsInterval = config.StatsInterval.Value();
+
+    if (mStatsInterval != 0)
+    {
+        mStatsRunning = true;
+        mStatsThread = std::thread(&OCIContainer::statsThread, this);
+    }
+
     return string();
 }
 
 void OCIContainer::Deinitialize(PluginHost::IShell *service)
 {
+    if (mStatsThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            mStatsRunning = false;
+        }
+        mStatsCondition.notify_all();
+        mStatsThread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mStartMutex);
+        mStartThreadsRunning = false;
+        mStartQueue.clear();
+    }
+    mStartCondition.notify_all();
+    for (std::thread& thread : mStartThreads)
+    {
+        thread.join();
+    }
+    mStartThreads.clear();
+
+    // Nobody can claim the warm containers any more
+    std::list<int32_t> warmDescriptors;
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+        for (const std::pair<const std::string, WarmPool>& pool : mWarmPools)
+        {
+            for (const WarmContainer& container : pool.second.containers)
+            {
+                if (container.descriptor > 0)
+                {
+                    warmDescriptors.push_back(container.descriptor);
+                }
+            }
+        }
+        mWarmPools.clear();
+    }
+    for (int32_t descriptor : warmDescriptors)
+    {
+        mDobbyProxy->stopContainer(descriptor, true);
+    }
+
     mDobbyProxy->unregisterListener(mEventListenerId);
     mOmiProxy->unregisterListener(mOmiListenerId);
     Unregister("listContainers");
@@ -79,6 +148,10 @@ void OCIContainer::Deinitialize(PluginHost::IShell *service)
     Unregister("pauseContainer");
     Unregister("resumeContainer");
     Unregister("executeCommand");
+    Unregister("createWarmPool");
+    Unregister("claimContainer");
+    Unregister("destroyWarmPool");
+    Unregister("getContainerStats");
 }
 
 string OCIContainer::Information() const
@@ -101,20 +174,17 @@ uint32_t OCIContainer::listContainers(const JsonObject &parameters, JsonObject &
 {
     LOGINFO("List containers");
 
-    // Get the running containers from Dobby
-    std::list<std::pair<int32_t, std::string>> runningContainers;
+    // Get the running containers from the table Dobby events keep up to date
     JsonObject containerJson;
     JsonArray containerArray;
 
-    runningContainers = mDobbyProxy->listContainers();
-
-    // Build the response if containers were found
-    if (!runningContainers.empty())
     {
-        for (const std::pair<int32_t, std::string>& c : runningContainers)
+        std::lock_guard<std::mutex> lock(mContainersMutex);
+
+        for (const std::pair<const int32_t, ContainerEntry>& c : mContainers)
         {
             containerJson["Descriptor"] = c.first;
-            containerJson["Id"] = c.second;
+            containerJson["Id"] = c.second.id;
 
             containerArray.Add(containerJson);
         }
@@ -148,9 +218,27 @@ uint32_t OCIContainer::getContainerState(const JsonObject &parameters, JsonObjec
     }
 
     std::string containerState;
+    IDobbyProxyEvents::ContainerState state;
+    bool known = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mContainersMutex);
+
+        std::map<int32_t, ContainerEntry>::const_iterator entry = mContainers.find(cd);
+        if (entry != mContainers.end())
+        {
+            state = entry->second.state;
+            known = true;
+        }
+    }
+
+    if (!known)
+    {
+        state = static_cast<IDobbyProxyEvents::ContainerState>(mDobbyProxy->getContainerState(cd));
+    }
 
     // We got a state back successfully, work out what that means in English
-    switch (static_cast<IDobbyProxyEvents::ContainerState>(mDobbyProxy->getContainerState(cd)))
+    switch (state)
     {
     case IDobbyProxyEvents::ContainerState::Invalid:
         containerState = "Invalid";
@@ -229,7 +317,10 @@ uint32_t OCIContainer::getContainerInfo(const JsonObject &parameters, JsonObject
 /**
  * @brief Starts a container from an OCI bundle
  *
- * @param[in]  parameters   - Must include 'containerId' and 'bundlePath'.
+ * If 'async' is true the call returns straight away and the result is reported by the
+ * onContainerStarted or onContainerFailed event.
+ *
+ * @param[in]  parameters   - Must include 'containerId' and 'bundlePath', optionally 'async'.
  * @param[out] response     - Dobby descriptor of the started container.
  *
  * @return                  A code indicating success.
@@ -247,30 +338,23 @@ uint32_t OCIContainer::startContainer(const JsonObject &parameters, JsonObject &
     std::string command = parameters["command"].String();
     std::string westerosSocket = parameters["westerosSocket"].String();
 
-    // Can be used to pass file descriptors to container construction.
-    // Currently unsupported, see DobbyProxy::startContainerFromBundle().
-    std::list<int> emptyList;
-
-    int descriptor;
-    // If no additional arguments, start the container
-    if ((command == "null" || command.empty()) && (westerosSocket == "null" || westerosSocket.empty()))
-    {
-        descriptor = mDobbyProxy->startContainerFromBundle(id, bundlePath, emptyList);
-    }
-    else
+    if (parameters["async"].Boolean())
     {
-        // Dobby expects empty strings if values not set
-        if (command == "null" || command.empty())
+        queueStart([this, id, bundlePath, command, westerosSocket]()
         {
-            command = "";
-        }
-        if (westerosSocket == "null" || westerosSocket.empty())
-        {
-            westerosSocket = "";
-        }
-        descriptor = mDobbyProxy->startContainerFromBundle(id, bundlePath, emptyList, command, westerosSocket);
+            if (doStartFromBundle(id, bundlePath, command, westerosSocket) <= 0)
+            {
+                LOGERR("Failed to start container %s - internal Dobby error.", id.c_str());
+                onContainerFailed(-1, id, 2);
+            }
+        });
+
+        response["containerId"] = id;
+        returnResponse(true);
     }
 
+    int descriptor = doStartFromBundle(id, bundlePath, command, westerosSocket);
+
     // startContainer returns -1 on failure
     if (descriptor <= 0)
     {
@@ -278,6 +362,8 @@ uint32_t OCIContainer::startContainer(const JsonObject &parameters, JsonObject &
         returnResponse(false);
     }
 
+    setContainerState(descriptor, id, IDobbyProxyEvents::ContainerState::Starting, false);
+
     response["descriptor"] = descriptor;
     returnResponse(true);
 }
@@ -305,10 +391,6 @@ uint32_t OCIContainer::startContainerFromCryptedBundle(const JsonObject &paramet
     std::string command = parameters["command"].String();
     std::string westerosSocket = parameters["westerosSocket"].String();
 
-    // Can be used to pass file descriptors to container construction.
-    // Currently unsupported, see DobbyProxy::startContainerFromBundle().
-    std::list<int> emptyList;
-
     int descriptor;
 
     std::string containerPath;
@@ -325,24 +407,7 @@ uint32_t OCIContainer::startContainerFromCryptedBundle(const JsonObject &paramet
 
     LOGINFO("Mount request to omi succeeded, contenerPath: %s", containerPath.c_str());
 
-    // If no additional arguments, start the container
-    if ((command == "null" || command.empty()) && (westerosSocket == "null" || westerosSocket.empty()))
-    {
-        descriptor = mDobbyProxy->startContainerFromBundle(id, containerPath, emptyList);
-    }
-    else
-    {
-        // Dobby expects empty strings if values not set
-        if (command == "null" || command.empty())
-        {
-            command = "";
-        }
-        if (westerosSocket == "null" || westerosSocket.empty())
-        {
-            westerosSocket = "";
-        }
-        descriptor = mDobbyProxy->startContainerFromBundle(id, containerPath, emptyList, command, westerosSocket);
-    }
+    descriptor = doStartFromBundle(id, containerPath, command, westerosSocket);
 
     // startContainer returns -1 on failure
     if (descriptor <= 0)
@@ -359,6 +424,8 @@ uint32_t OCIContainer::startContainerFromCryptedBundle(const JsonObject &paramet
         returnResponse(false);
     }
 
+    setContainerState(descriptor, id, IDobbyProxyEvents::ContainerState::Starting, false);
+
     response["descriptor"] = descriptor;
     returnResponse(true);
 }
@@ -367,8 +434,11 @@ uint32_t OCIContainer::startContainerFromCryptedBundle(const JsonObject &paramet
  * @brief Starts a container using a Dobby spec file
  *
  * Provides legacy support for starting containers from a Dobby spec string.
+ * If 'async' is true the call returns straight away and the result is reported by the
+ * onContainerStarted or onContainerFailed event.
  *
- * @param[in]  parameters   Must include 'containerId' and 'dobbySpec' of container to start.
+ * @param[in]  parameters   Must include 'containerId' and 'dobbySpec' of container to start,
+ *                          optionally 'async'.
  * @param[out] response     Dobby descriptor of the started container.
  *
  * @return                  A code indicating success.
@@ -392,30 +462,23 @@ uint32_t OCIContainer::startContainerFromDobbySpec(const JsonObject &parameters,
         returnResponse(false);
     }
 
-    // Can be used to pass file descriptors to container construction.
-    // Currently unsupported, see DobbyProxy::startContainerFromSpec().
-    std::list<int> emptyList;
-
-    int descriptor;
-    // If no additional arguments, start the container
-    if ((command == "null" || command.empty()) && (westerosSocket == "null" || westerosSocket.empty()))
-    {
-        descriptor = mDobbyProxy->startContainerFromSpec(id, specString, emptyList);
-    }
-    else
+    if (parameters["async"].Boolean())
     {
-        // Dobby expects empty strings if values not set
-        if (command == "null" || command.empty())
-        {
-            command = "";
-        }
-        if (westerosSocket == "null" || westerosSocket.empty())
+        queueStart([this, id, specString, command, westerosSocket]()
         {
-            westerosSocket = "";
-        }
-        descriptor = mDobbyProxy->startContainerFromSpec(id, specString, emptyList, command, westerosSocket);
+            if (doStartFromSpec(id, specString, command, westerosSocket) <= 0)
+            {
+                LOGERR("Failed to start container %s - internal Dobby error.", id.c_str());
+                onContainerFailed(-1, id, 2);
+            }
+        });
+
+        response["containerId"] = id;
+        returnResponse(true);
     }
 
+    int descriptor = doStartFromSpec(id, specString, command, westerosSocket);
+
     // startContainer returns -1 on failure
     if (descriptor <= 0)
     {
@@ -423,6 +486,8 @@ uint32_t OCIContainer::startContainerFromDobbySpec(const JsonObject &parameters,
         returnResponse(false);
     }
 
+    setContainerState(descriptor, id, IDobbyProxyEvents::ContainerState::Starting, false);
+
     response["descriptor"] = descriptor;
     returnResponse(true);
 }
@@ -500,6 +565,8 @@ uint32_t OCIContainer::pauseContainer(const JsonObject &parameters, JsonObject &
         returnResponse(false);
     }
 
+    setContainerState(cd, id, IDobbyProxyEvents::ContainerState::Paused);
+
     returnResponse(true);
 }
 
@@ -535,6 +602,8 @@ uint32_t OCIContainer::resumeContainer(const JsonObject &parameters, JsonObject
         returnResponse(false);
     }
 
+    setContainerState(cd, id, IDobbyProxyEvents::ContainerState::Running);
+
     returnResponse(true);
 }
 
@@ -579,6 +648,215 @@ uint32_t OCIContainer::executeCommand(const JsonObject &parameters, JsonObject &
     returnResponse(true);
 }
 
+/**
+ * @brief Create a pool of paused containers from a template Dobby spec
+ *
+ * The containers are started in the background and paused once running, so a later
+ * claimContainer only has to resume one. The pool is topped up again after each claim.
+ *
+ * @param[in]  parameters   Must include 'templateName', 'dobbySpec' and 'size', optionally
+ *                          'command' and 'westerosSocket'.
+ * @param[out] response     Success.
+ *
+ * @return                  A code indicating success.
+ */
+uint32_t OCIContainer::createWarmPool(const JsonObject &parameters, JsonObject &response)
+{
+    LOGINFO("Create warm container pool");
+
+    returnIfStringParamNotFound(parameters, "templateName");
+    returnIfObjectParamNotFound(parameters, "dobbySpec");
+    returnIfNumberParamNotFound(parameters, "size");
+
+    std::string templateName = parameters["templateName"].String();
+    JsonObject dobbySpec = parameters["dobbySpec"].Object();
+    int size = parameters["size"].Number();
+
+    if (size <= 0)
+    {
+        response["error"] = "invalid pool size";
+        returnResponse(false);
+    }
+
+    std::string specString;
+    if (!WPEFramework::Core::JSON::IElement::ToString(dobbySpec, specString))
+    {
+        LOGERR("Failed to convert Dobby spec to string");
+        returnResponse(false);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+
+        if (mWarmPools.find(templateName) != mWarmPools.end())
+        {
+            response["error"] = "pool already exists";
+            returnResponse(false);
+        }
+
+        WarmPool& pool = mWarmPools[templateName];
+        pool.spec = specString;
+        pool.command = parameters["command"].String();
+        pool.westerosSocket = parameters["westerosSocket"].String();
+        pool.size = size;
+        pool.next = 0;
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        queueStart(std::bind(&OCIContainer::fillWarmPool, this, templateName));
+    }
+
+    returnResponse(true);
+}
+
+/**
+ * @brief Claim a paused container from a warm pool and resume it
+ *
+ * @param[in]  parameters   Must include 'templateName' of the pool.
+ * @param[out] response     Dobby descriptor and ID of the claimed container.
+ *
+ * @return                  A code indicating success.
+ */
+uint32_t OCIContainer::claimContainer(const JsonObject &parameters, JsonObject &response)
+{
+    LOGINFO("Claim container from warm pool");
+
+    returnIfStringParamNotFound(parameters, "templateName");
+    std::string templateName = parameters["templateName"].String();
+
+    WarmContainer claimed = { std::string(), -1, false };
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+
+        std::map<std::string, WarmPool>::iterator pool = mWarmPools.find(templateName);
+        if (pool == mWarmPools.end())
+        {
+            response["error"] = "unknown pool";
+            returnResponse(false);
+        }
+
+        for (std::list<WarmContainer>::iterator it = pool->second.containers.begin(); it != pool->second.containers.end(); ++it)
+        {
+            if (it->ready)
+            {
+                claimed = *it;
+                pool->second.containers.erase(it);
+                break;
+            }
+        }
+    }
+
+    if (!claimed.ready)
+    {
+        response["error"] = "no warm container available";
+        returnResponse(false);
+    }
+
+    queueStart(std::bind(&OCIContainer::fillWarmPool, this, templateName));
+
+    if (!mDobbyProxy->resumeContainer(claimed.descriptor))
+    {
+        LOGERR("Failed to resume warm container %s - internal Dobby error.", claimed.id.c_str());
+        mDobbyProxy->stopContainer(claimed.descriptor, true);
+        response["error"] = "internal dobby error";
+        returnResponse(false);
+    }
+
+    setContainerState(claimed.descriptor, claimed.id, IDobbyProxyEvents::ContainerState::Running);
+
+    response["descriptor"] = claimed.descriptor;
+    response["containerId"] = claimed.id;
+    returnResponse(true);
+}
+
+/**
+ * @brief Remove a warm pool and stop its unclaimed containers
+ *
+ * @param[in]  parameters   Must include 'templateName' of the pool.
+ * @param[out] response     Success.
+ *
+ * @return                  A code indicating success.
+ */
+uint32_t OCIContainer::destroyWarmPool(const JsonObject &parameters, JsonObject &response)
+{
+    LOGINFO("Destroy warm container pool");
+
+    returnIfStringParamNotFound(parameters, "templateName");
+    std::string templateName = parameters["templateName"].String();
+
+    std::list<WarmContainer> containers;
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+
+        std::map<std::string, WarmPool>::iterator pool = mWarmPools.find(templateName);
+        if (pool == mWarmPools.end())
+        {
+            response["error"] = "unknown pool";
+            returnResponse(false);
+        }
+
+        // Containers still being started are stopped by fillWarmPool once it finds the pool gone
+        containers.swap(pool->second.containers);
+        mWarmPools.erase(pool);
+    }
+
+    for (const WarmContainer& container : containers)
+    {
+        if (container.descriptor > 0)
+        {
+            mDobbyProxy->stopContainer(container.descriptor, true);
+        }
+    }
+
+    returnResponse(true);
+}
+
+
+/**
+ * @brief Get the resource usage of a container from its cgroups
+ *
+ * @param[in]  parameters   Must include 'containerId' of the container.
+ * @param[out] response     CPU time in ns, and memory, block I/O and network usage in bytes.
+ *
+ * @return                  A code indicating success.
+ */
+uint32_t OCIContainer::getContainerStats(const JsonObject &parameters, JsonObject &response)
+{
+    LOGINFO("Get container stats");
+
+    returnIfStringParamNotFound(parameters, "containerId");
+    std::string id = parameters["containerId"].String();
+
+    int cd = GetContainerDescriptorFromId(id);
+    if (cd < 0)
+    {
+        response["error"] = "container descriptor can not be acquired";
+        returnResponse(false);
+    }
+
+    // The cgroups are named after the container ID, which may not be what was passed in
+    {
+        std::lock_guard<std::mutex> lock(mContainersMutex);
+
+        std::map<int32_t, ContainerEntry>::const_iterator entry = mContainers.find(cd);
+        if (entry != mContainers.end())
+        {
+            id = entry->second.id;
+        }
+    }
+
+    JsonObject stats;
+    if (!getStats(cd, id, stats))
+    {
+        response["error"] = "failed to read container stats";
+        returnResponse(false);
+    }
+
+    response["containerId"] = id;
+    response["stats"] = stats;
+    returnResponse(true);
+}
 
 /**
  * @brief Send an event notifying that a container has started.
@@ -618,6 +896,34 @@ void OCIContainer::onContainerStopped(int32_t descriptor, const std::string& nam
     sendNotify("onContainerStopped", params);
 }
 
+/**
+ * @brief Send an event notifying that a container failed.
+ *
+ * @param descriptor    Container descriptor, -1 if the container was never created.
+ * @param name          Container name.
+ * @param errorCode     1 for a verity failure, 2 if an async start failed.
+ */
+void OCIContainer::onContainerFailed(int32_t descriptor, const std::string& name, int errorCode)
+{
+    JsonObject params;
+    params["descriptor"] = descriptor;
+    params["name"] = name;
+    params["errorCode"] = errorCode;
+    sendNotify("onContainerFailed", params);
+}
+
+/**
+ * @brief Send the periodic resource usage event.
+ *
+ * @param containers    Descriptor, ID and stats of each running or paused container.
+ */
+void OCIContainer::onContainerStats(const JsonArray& containers)
+{
+    JsonObject params;
+    params["containers"] = containers;
+    sendNotify("onContainerStats", params);
+}
+
 // End Thunder methods
 
 
@@ -629,22 +935,32 @@ void OCIContainer::onContainerStopped(int32_t descriptor, const std::string& nam
  * Will only return a value if Dobby knows about the running container
  * (e.g. the container was started by Dobby, not manually using the OCI runtime).
  *
+ * The container table is searched first, Dobby is only asked again if the container isn't in it.
+ *
  * @param containerId The container ID used by the OCI runtime - not the Dobby descriptor
  *
  * @return Descriptor value
  */
 const int OCIContainer::GetContainerDescriptorFromId(const std::string& containerId)
 {
-    const std::list<std::pair<int32_t, std::string>> containers = mDobbyProxy->listContainers();
-
-    for (const std::pair<int32_t, std::string>& container : containers)
+    for (int attempt = 0; attempt < 2; attempt++)
     {
-        char strDescriptor[32];
-        sprintf(strDescriptor, "%d", container.first);
+        if (attempt != 0)
+        {
+            refreshContainers();
+        }
+
+        std::lock_guard<std::mutex> lock(mContainersMutex);
 
-        if ((containerId == strDescriptor) || (containerId == container.second))
+        for (const std::pair<const int32_t, ContainerEntry>& container : mContainers)
         {
-            return container.first;
+            char strDescriptor[32];
+            sprintf(strDescriptor, "%d", container.first);
+
+            if ((containerId == strDescriptor) || (containerId == container.second.id))
+            {
+                return container.first;
+            }
         }
     }
 
@@ -652,6 +968,57 @@ const int OCIContainer::GetContainerDescriptorFromId(const std::string& containe
     return -1;
 }
 
+/**
+ * @brief Rebuild the container table from Dobby
+ */
+void OCIContainer::refreshContainers()
+{
+    const std::list<std::pair<int32_t, std::string>> containers = mDobbyProxy->listContainers();
+    std::map<int32_t, ContainerEntry> table;
+
+    for (const std::pair<int32_t, std::string>& container : containers)
+    {
+        ContainerEntry& entry = table[container.first];
+        entry.id = container.second;
+        entry.state = static_cast<IDobbyProxyEvents::ContainerState>(mDobbyProxy->getContainerState(container.first));
+    }
+
+    std::lock_guard<std::mutex> lock(mContainersMutex);
+    mContainers.swap(table);
+}
+
+/**
+ * @brief Record the state of a container in the container table
+ *
+ * @param descriptor Container descriptor
+ * @param name       Container name
+ * @param state      Container state, Stopped removes the container from the table
+ * @param overwrite  Update the state of a container that is already in the table
+ */
+void OCIContainer::setContainerState(int32_t descriptor, const std::string& name, IDobbyProxyEvents::ContainerState state, bool overwrite)
+{
+    std::lock_guard<std::mutex> lock(mContainersMutex);
+
+    if (state == IDobbyProxyEvents::ContainerState::Stopped)
+    {
+        mContainers.erase(descriptor);
+    }
+    else
+    {
+        std::map<int32_t, ContainerEntry>::iterator entry = mContainers.find(descriptor);
+        if (entry == mContainers.end())
+        {
+            ContainerEntry& added = mContainers[descriptor];
+            added.id = name;
+            added.state = state;
+        }
+        else if (overwrite)
+        {
+            entry->second.state = state;
+        }
+    }
+}
+
 /**
  * @brief Callback listener for state change events.
  *
@@ -669,7 +1036,19 @@ const void OCIContainer::stateListener(int32_t descriptor, const std::string& na
     // Cast const void* back to OCIContainer* type to get 'this'
     OCIContainer* __this = const_cast<OCIContainer*>(reinterpret_cast<const OCIContainer*>(_this));
 
-    if (state == IDobbyProxyEvents::ContainerState::Running)
+    __this->setContainerState(descriptor, name, state);
+
+    if (state == IDobbyProxyEvents::ContainerState::Stopped)
+    {
+        __this->mStats.forget(name);
+    }
+
+    // Unclaimed warm pool containers are internal to the plugin
+    if (__this->isWarmContainer(name, (state == IDobbyProxyEvents::ContainerState::Stopped)))
+    {
+        LOGINFO("Warm pool container '%s' changed state.", name.c_str());
+    }
+    else if (state == IDobbyProxyEvents::ContainerState::Running)
     {
         __this->onContainerStarted(descriptor, name);
     }
@@ -721,12 +1100,8 @@ void OCIContainer::onVerityFailed(const std::string& name)
         return;
     }
 
-    JsonObject params;
-    params["descriptor"] = cd;
-    params["name"] = name;
     // Set error type to Verity Error (1)
-    params["errorCode"] = 1;
-    sendNotify("onContainerFailed", params);
+    onContainerFailed(cd, name, 1);
 
     bool stoppedSuccessfully = mDobbyProxy->stopContainer(cd, true);
 
@@ -737,6 +1112,319 @@ void OCIContainer::onVerityFailed(const std::string& name)
     }
 }
 
+/**
+ * @brief Start a container from an OCI bundle through Dobby
+ *
+ * @return Dobby descriptor, or a value <= 0 on failure
+ */
+int OCIContainer::doStartFromBundle(const std::string& id, const std::string& bundlePath, std::string command, std::string westerosSocket)
+{
+    // Can be used to pass file descriptors to container construction.
+    // Currently unsupported, see DobbyProxy::startContainerFromBundle().
+    std::list<int> emptyList;
+
+    // If no additional arguments, start the container
+    if ((command == "null" || command.empty()) && (westerosSocket == "null" || westerosSocket.empty()))
+    {
+        return mDobbyProxy->startContainerFromBundle(id, bundlePath, emptyList);
+    }
+
+    // Dobby expects empty strings if values not set
+    if (command == "null" || command.empty())
+    {
+        command = "";
+    }
+    if (westerosSocket == "null" || westerosSocket.empty())
+    {
+        westerosSocket = "";
+    }
+    return mDobbyProxy->startContainerFromBundle(id, bundlePath, emptyList, command, westerosSocket);
+}
+
+/**
+ * @brief Start a container from a Dobby spec string through Dobby
+ *
+ * @return Dobby descriptor, or a value <= 0 on failure
+ */
+int OCIContainer::doStartFromSpec(const std::string& id, const std::string& specString, std::string command, std::string westerosSocket)
+{
+    // Can be used to pass file descriptors to container construction.
+    // Currently unsupported, see DobbyProxy::startContainerFromSpec().
+    std::list<int> emptyList;
+
+    // If no additional arguments, start the container
+    if ((command == "null" || command.empty()) && (westerosSocket == "null" || westerosSocket.empty()))
+    {
+        return mDobbyProxy->startContainerFromSpec(id, specString, emptyList);
+    }
+
+    // Dobby expects empty strings if values not set
+    if (command == "null" || command.empty())
+    {
+        command = "";
+    }
+    if (westerosSocket == "null" || westerosSocket.empty())
+    {
+        westerosSocket = "";
+    }
+    return mDobbyProxy->startContainerFromSpec(id, specString, emptyList, command, westerosSocket);
+}
+
+/**
+ * @brief Queue a job for the start threads
+ */
+void OCIContainer::queueStart(const std::function<void()>& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mStartMutex);
+        mStartQueue.push_back(job);
+    }
+    mStartCondition.notify_one();
+}
+
+/**
+ * @brief Start thread main loop, runs queued jobs until Deinitialize
+ */
+void OCIContainer::startThread()
+{
+    std::unique_lock<std::mutex> lock(mStartMutex);
+
+    while (mStartThreadsRunning)
+    {
+        if (mStartQueue.empty())
+        {
+            mStartCondition.wait(lock);
+        }
+        else
+        {
+            std::function<void()> job = mStartQueue.front();
+            mStartQueue.pop_front();
+
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+}
+
+/**
+ * @brief Start one more container for a warm pool, if it isn't full, and pause it once running
+ *
+ * @param templateName  Name of the pool
+ */
+void OCIContainer::fillWarmPool(const std::string& templateName)
+{
+    WarmContainer container = { std::string(), -1, false };
+    std::string spec, command, westerosSocket;
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+
+        std::map<std::string, WarmPool>::iterator pool = mWarmPools.find(templateName);
+        if ((pool == mWarmPools.end()) || (pool->second.containers.size() >= pool->second.size))
+        {
+            return;
+        }
+
+        // Take the slot now so other start threads don't overfill the pool
+        container.id = templateName + "-warm-" + std::to_string(pool->second.next++);
+        pool->second.containers.push_back(container);
+
+        spec = pool->second.spec;
+        command = pool->second.command;
+        westerosSocket = pool->second.westerosSocket;
+    }
+
+    bool paused = false;
+    int descriptor = doStartFromSpec(container.id, spec, command, westerosSocket);
+
+    if (descriptor > 0)
+    {
+        int waited = 0;
+        while ((static_cast<IDobbyProxyEvents::ContainerState>(mDobbyProxy->getContainerState(descriptor)) == IDobbyProxyEvents::ContainerState::Starting) &&
+               (waited < OCI_WARM_START_TIMEOUT_MS))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            waited += 50;
+        }
+
+        paused = mDobbyProxy->pauseContainer(descriptor);
+        if (paused)
+        {
+            setContainerState(descriptor, container.id, IDobbyProxyEvents::ContainerState::Paused);
+        }
+    }
+
+    bool keep = false;
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+
+        std::map<std::string, WarmPool>::iterator pool = mWarmPools.find(templateName);
+        if (pool != mWarmPools.end())
+        {
+            for (std::list<WarmContainer>::iterator it = pool->second.containers.begin(); it != pool->second.containers.end(); ++it)
+            {
+                if (it->id == container.id)
+                {
+                    if (paused)
+                    {
+                        it->descriptor = descriptor;
+                        it->ready = true;
+                        keep = true;
+                    }
+                    else
+                    {
+                        pool->second.containers.erase(it);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!keep)
+    {
+        LOGERR("Failed to add container %s to warm pool %s.", container.id.c_str(), templateName.c_str());
+
+        if (descriptor > 0)
+        {
+            mDobbyProxy->stopContainer(descriptor, true);
+        }
+    }
+    else
+    {
+        LOGINFO("Container %s is ready in warm pool %s.", container.id.c_str(), templateName.c_str());
+    }
+}
+
+/**
+ * @brief Check whether a container belongs to a warm pool and hasn't been claimed
+ *
+ * @param name      Container name
+ * @param remove    Remove the container from its pool, e.g. because it stopped
+ *
+ * @return true if the container is an unclaimed warm pool container
+ */
+bool OCIContainer::isWarmContainer(const std::string& name, bool remove)
+{
+    std::lock_guard<std::mutex> lock(mPoolMutex);
+
+    for (std::pair<const std::string, WarmPool>& pool : mWarmPools)
+    {
+        for (std::list<WarmContainer>::iterator it = pool.second.containers.begin(); it != pool.second.containers.end(); ++it)
+        {
+            if (it->id == name)
+            {
+                if (remove)
+                {
+                    pool.second.containers.erase(it);
+                }
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Read the resource usage of a container
+ *
+ * The first read of a container asks Dobby for its processes, the network statistics are
+ * taken from the network namespace of the first one.
+ *
+ * @param descriptor Container descriptor
+ * @param id         Container ID, which is also the name of its cgroups
+ * @param stats      Resource usage
+ *
+ * @return true if the stats could be read
+ */
+bool OCIContainer::getStats(int32_t descriptor, const std::string& id, JsonObject& stats)
+{
+    ContainerStats::Sample sample;
+
+    std::function<pid_t()> pidLookup = [this, descriptor]() -> pid_t
+    {
+        JsonObject info;
+        WPEC::OptionalType<WPEJ::Error> error;
+
+        if (!WPEJ::IElement::FromString(mDobbyProxy->getContainerInfo(descriptor), info, error))
+        {
+            return -1;
+        }
+
+        JsonArray pids = info["pids"].Array();
+        return (pids.Length() > 0 ? static_cast<pid_t>(pids[0].Number()) : -1);
+    };
+
+    if (!mStats.read(id, pidLookup, sample))
+    {
+        return false;
+    }
+
+    stats["cpuUsage"] = sample.cpuUsage;
+    stats["memoryCurrent"] = sample.memoryCurrent;
+    stats["memoryPeak"] = sample.memoryPeak;
+    stats["blkioRead"] = sample.blkioRead;
+    stats["blkioWrite"] = sample.blkioWrite;
+    stats["netRx"] = sample.netRx;
+    stats["netTx"] = sample.netTx;
+    return true;
+}
+
+/**
+ * @brief Stats thread main loop, sends onContainerStats every mStatsInterval seconds
+ */
+void OCIContainer::statsThread()
+{
+    std::unique_lock<std::mutex> lock(mStatsMutex);
+
+    while (mStatsRunning)
+    {
+        mStatsCondition.wait_for(lock, std::chrono::seconds(mStatsInterval));
+        if (!mStatsRunning)
+        {
+            break;
+        }
+        lock.unlock();
+
+        std::list<std::pair<int32_t, std::string>> containers;
+        {
+            std::lock_guard<std::mutex> containersLock(mContainersMutex);
+
+            for (const std::pair<const int32_t, ContainerEntry>& c : mContainers)
+            {
+                if ((c.second.state == IDobbyProxyEvents::ContainerState::Running) ||
+                    (c.second.state == IDobbyProxyEvents::ContainerState::Paused))
+                {
+                    containers.push_back(std::make_pair(c.first, c.second.id));
+                }
+            }
+        }
+
+        JsonArray containerArray;
+        for (const std::pair<int32_t, std::string>& c : containers)
+        {
+            JsonObject containerJson;
+            JsonObject stats;
+
+            if (getStats(c.first, c.second, stats))
+            {
+                containerJson["descriptor"] = c.first;
+                containerJson["containerId"] = c.second;
+                containerJson["stats"] = stats;
+                containerArray.Add(containerJson);
+            }
+        }
+
+        if (containerArray.Length() > 0)
+        {
+            onContainerStats(containerArray);
+        }
+
+        lock.lock();
+    }
+}
+
 // End Internal methods
 
 } // namespace Plugin
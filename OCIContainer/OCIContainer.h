@@ -2,14 +2,28 @@
 
 #include "Module.h"
 #include "utils.h"
+#include "ContainerStats.h"
 
 #include <Dobby/DobbyProtocol.h>
 #include <Dobby/Public/Dobby/IDobbyProxy.h>
 
 #include <vector>
 #include <map>
+#include <list>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 #include <i_omi_proxy.hpp>
 
+// Number of threads that start containers for async start requests and warm pools
+#define OCI_START_THREADS 3
+
+// How long a warm pool container may take to reach the running state before it is paused
+#define OCI_WARM_START_TIMEOUT_MS 10000
+
 namespace WPEFramework
 {
 
@@ -46,12 +60,18 @@ public:
     uint32_t pauseContainer(const JsonObject &parameters, JsonObject &response);
     uint32_t resumeContainer(const JsonObject &parameters, JsonObject &response);
     uint32_t executeCommand(const JsonObject &parameters, JsonObject &response);
+    uint32_t createWarmPool(const JsonObject &parameters, JsonObject &response);
+    uint32_t claimContainer(const JsonObject &parameters, JsonObject &response);
+    uint32_t destroyWarmPool(const JsonObject &parameters, JsonObject &response);
+    uint32_t getContainerStats(const JsonObject &parameters, JsonObject &response);
     //End methods
 
     //Begin events
     void onContainerStarted(int32_t descriptor, const std::string& name);
     void onContainerStopped(int32_t descriptor, const std::string& name);
     void onVerityFailed(const std::string& name);
+    void onContainerFailed(int32_t descriptor, const std::string& name, int errorCode);
+    void onContainerStats(const JsonArray& containers);
     //End events
 
     //Build QueryInterface implementation, specifying all possible interfaces to be returned.
@@ -68,14 +88,86 @@ public:
     uint32_t getApiVersionNumber() const { return 1; };
 
 private:
+    class Config : public Core::JSON::Container
+    {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Core::JSON::Container()
+            , StatsInterval(0)
+        {
+            Add(_T("statsinterval"), &StatsInterval);
+        }
+
+    public:
+        Core::JSON::DecUInt16 StatsInterval; // seconds between onContainerStats events, 0 disables them
+    };
+
     int mEventListenerId; // Dobby event listener ID
     long unsigned mOmiListenerId;
     std::shared_ptr<IDobbyProxy> mDobbyProxy; // DobbyProxy instance
     std::shared_ptr<AI_IPC::IIpcService> mIpcService; // Ipc Service instance
     const int GetContainerDescriptorFromId(const std::string& containerId);
+
+    // Containers known to Dobby and their last state, seeded at startup and kept up to
+    // date by stateListener so queries don't need a dbus round trip
+    struct ContainerEntry
+    {
+        std::string id;
+        IDobbyProxyEvents::ContainerState state;
+    };
+    void refreshContainers();
+    void setContainerState(int32_t descriptor, const std::string& name, IDobbyProxyEvents::ContainerState state, bool overwrite = true);
+    std::map<int32_t, ContainerEntry> mContainers;
+    std::mutex mContainersMutex;
     static const void stateListener(int32_t descriptor, const std::string& name, IDobbyProxyEvents::ContainerState state, const void* _this);
     static const void omiErrorListener(const std::string& id, omi::IOmiProxy::ErrorType err, const void* _this);
     std::shared_ptr<omi::IOmiProxy> mOmiProxy;
+
+    int doStartFromBundle(const std::string& id, const std::string& bundlePath, std::string command, std::string westerosSocket);
+    int doStartFromSpec(const std::string& id, const std::string& specString, std::string command, std::string westerosSocket);
+
+    // Start requests that must not block the JSON-RPC thread run on a small pool of threads
+    void queueStart(const std::function<void()>& job);
+    void startThread();
+    std::vector<std::thread> mStartThreads;
+    std::deque<std::function<void()>> mStartQueue;
+    std::mutex mStartMutex;
+    std::condition_variable mStartCondition;
+    bool mStartThreadsRunning;
+
+    // Containers started from a template Dobby spec and paused, ready to be claimed
+    struct WarmContainer
+    {
+        std::string id;
+        int32_t descriptor;
+        bool ready;
+    };
+    struct WarmPool
+    {
+        std::string spec;
+        std::string command;
+        std::string westerosSocket;
+        size_t size;
+        unsigned int next;
+        std::list<WarmContainer> containers;
+    };
+    void fillWarmPool(const std::string& templateName);
+    bool isWarmContainer(const std::string& name, bool remove);
+    std::map<std::string, WarmPool> mWarmPools;
+    std::mutex mPoolMutex;
+
+    // Resource usage from cgroupfs, reported on request and periodically by the stats thread
+    bool getStats(int32_t descriptor, const std::string& id, JsonObject& stats);
+    void statsThread();
+    ContainerStats mStats;
+    std::thread mStatsThread;
+    std::mutex mStatsMutex;
+    std::condition_variable mStatsCondition;
+    bool mStatsRunning;
+    uint16_t mStatsInterval;
 };
 } // namespace Plugin
 } // namespace WPEFramework
@@ -29,5 +29,8 @@ namespace Plugin {
     /* static */ const uint8_t CommonEncryptionData::WideVine[] = { 0xed, 0xef, 0x8b, 0xa9, 0x79, 0xd6, 0x4a, 0xce, 0xa3, 0xc8, 0x27, 0xdc, 0xd5, 0x1d, 0x21, 0xed };
     /* static */ const uint8_t CommonEncryptionData::ClearKey[] = { 0x58, 0x14, 0x7e, 0xc8, 0x04, 0x23, 0x46, 0x59, 0x92, 0xe6, 0xf5, 0x2c, 0x5c, 0xe8, 0xc3, 0xcc };
     /* static */ const    char CommonEncryptionData::JSONKeyIds[] = "{\"kids\":";
+
+    /* static */ Core::CriticalSection CommonEncryptionData::_parsedLock;
+    /* static */ std::list<CommonEncryptionData::ParsedEntry> CommonEncryptionData::_parsed;
 }
 } // namespace WPEFramework::Plugin
@@ -22,10 +22,15 @@
 
 #include "Module.h"
 
+// Number of parsed init data blobs remembered, so sessions for the same content skip the parse.
+#define CENC_PARSE_CACHE_SIZE 8
+
 namespace WPEFramework {
 namespace Plugin {
 
-    //This class is not Thread Safe. The user of this class must ensure thread saftey (single thread access) !!!!
+    // Parsing is reentrant: it only touches the instance being constructed. The key ids found for
+    // an init data blob are remembered in a small, locked, most-recently-used cache shared by all
+    // instances. An instance itself is not Thread Safe, its user must ensure single thread access.
     class CommonEncryptionData {
     private:
         CommonEncryptionData() = delete;
@@ -111,11 +116,26 @@ namespace Plugin {
 
         typedef Core::IteratorType<const std::list<KeyId>, const KeyId&, std::list<KeyId>::const_iterator> Iterator;
 
+    private:
+        struct ParsedEntry {
+            uint32_t hash;
+            std::vector<uint8_t> data;
+            std::list<KeyId> keyIds;
+        };
+
+        static Core::CriticalSection _parsedLock;
+        static std::list<ParsedEntry> _parsed; // most recently used first
+
     public:
         CommonEncryptionData(const uint8_t data[], const uint16_t length)
             : _keyIds()
         {
-            Parse(data, length);
+            const uint32_t hash(Hash(data, length));
+
+            if (Recall(hash, data, length) == false) {
+                Parse(data, length);
+                Remember(hash, data, length);
+            }
         }
         CommonEncryptionData(const CommonEncryptionData& copy)
             : _keyIds(copy._keyIds)
@@ -202,8 +222,68 @@ namespace Plugin {
         inline bool IsEmpty() const {
             return _keyIds.empty();
         }
+        // FNV-1a
+        static uint32_t Hash(const uint8_t data[], const uint16_t length)
+        {
+            uint32_t hash = 2166136261u;
+            for (uint16_t index = 0; index < length; index++) {
+                hash = (hash ^ data[index]) * 16777619u;
+            }
+            return (hash);
+        }
     private:
-        uint8_t Base64(const uint8_t value[], const uint8_t sourceLength, uint8_t object[], const uint8_t length)
+        // Call with the _parsedLock taken.
+        static std::list<ParsedEntry>::iterator Find(const uint32_t hash, const uint8_t data[], const uint16_t length)
+        {
+            std::list<ParsedEntry>::iterator index(_parsed.begin());
+            while ((index != _parsed.end()) && ((index->hash != hash) || (index->data.size() != length) || (::memcmp(index->data.data(), data, length) != 0))) {
+                index++;
+            }
+            return (index);
+        }
+        bool Recall(const uint32_t hash, const uint8_t data[], const uint16_t length)
+        {
+            bool found = false;
+
+            _parsedLock.Lock();
+
+            std::list<ParsedEntry>::iterator index(Find(hash, data, length));
+            if (index != _parsed.end()) {
+                _keyIds = index->keyIds;
+                _parsed.splice(_parsed.begin(), _parsed, index);
+                found = true;
+            }
+
+            _parsedLock.Unlock();
+
+            if (found == true) {
+                TRACE(Trace::Information, (_T("Init data recognized, %d keys\n"), static_cast<int>(_keyIds.size())));
+            }
+
+            return (found);
+        }
+        void Remember(const uint32_t hash, const uint8_t data[], const uint16_t length) const
+        {
+            // Only fresh key ids are remembered, before any status update reaches this instance.
+            ParsedEntry entry;
+            entry.hash = hash;
+            entry.data.assign(data, data + length);
+            entry.keyIds = _keyIds;
+
+            _parsedLock.Lock();
+
+            // Another session for the same content may have parsed it meanwhile.
+            if (Find(hash, data, length) == _parsed.end()) {
+                _parsed.push_front(std::move(entry));
+                if (_parsed.size() > CENC_PARSE_CACHE_SIZE) {
+                    _parsed.pop_back();
+                }
+            }
+
+            _parsedLock.Unlock();
+        }
+
+        static uint8_t Base64(const uint8_t value[], const uint8_t sourceLength, uint8_t object[], const uint8_t length)
         {
             uint8_t state = 0;
             uint8_t index = 0;
@@ -340,7 +420,7 @@ namespace Plugin {
             }
         }
 
-        uint16_t FindInXML(const uint8_t data[], const uint16_t length, const char key[], const uint8_t keyLength)
+        static uint16_t FindInXML(const uint8_t data[], const uint16_t length, const char key[], const uint8_t keyLength)
         {
             uint8_t index = 0;
             uint16_t result = 0;
@@ -21,11 +21,16 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 
 #include "Module.h"
 #include "CENCParser.h"
 #include "CapsParser.h"
+#include "LicenseStore.h"
 
 // Get in the definitions required for access to the sepcific
 // DRM engines.
@@ -34,9 +39,16 @@
 
 #define INITIALIZATION_RETRY_SLEEP_MS         100         // delay in [ms] after getting CDMi_BUSY_CANNOT_INITIALIZE and retry
 #define INITIALIZATION_MAX_RETRY_COUNTER      50          // number of repetitions in retrying procedure
+#define DECRYPT_WORKERS_SPARE                 2           // idle decrypt workers kept ready for the next session buffer
+#define DECRYPT_BUFFERS_SPARE                 2           // session buffers mapped at start and kept for the next session
 
 #include "ReportErrors.h"
 
+#ifndef __WINDOWS__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 extern "C" {
 
 typedef ::CDMi::ISystemFactory* (*GetDRMSystemFunction)();
@@ -203,6 +215,40 @@ namespace Plugin {
                 {
 
                     bool released = false;
+                    uint8_t number;
+
+                    if (Index(locator, number) == true) {
+                        _adminLock.Lock();
+
+                        if ((_occupation & (1 << number)) != 0) {
+                            _occupation ^= (1 << number);
+                            released = true;
+                        } else {
+                            // Freeing a buffer that is already free sounds dangerous !!!
+                            ASSERT(false);
+                        }
+
+                        _adminLock.Unlock();
+                    }
+                    return (released);
+                }
+                bool InUse(const string& locator) const
+                {
+                    bool inUse = false;
+                    uint8_t number;
+
+                    if (Index(locator, number) == true) {
+                        _adminLock.Lock();
+                        inUse = ((_occupation & (1 << number)) != 0);
+                        _adminLock.Unlock();
+                    }
+                    return (inUse);
+                }
+
+            private:
+                bool Index(const string& locator, uint8_t& number) const
+                {
+                    bool valid = false;
 
                     if (locator.compare(0, _basePath.length(), _basePath) == 0) {
                         string actualFile(locator.substr(_basePath.length()));
@@ -210,30 +256,233 @@ namespace Plugin {
 
                         if (actualFile.compare(0, baseLength, BufferFileName) == 0) {
                             // Than the last part is the number..
-                            uint8_t number(Core::NumberType<uint8_t>(&(actualFile.c_str()[baseLength]), static_cast<uint32_t>(actualFile.length() - baseLength)).Value());
+                            number = Core::NumberType<uint8_t>(&(actualFile.c_str()[baseLength]), static_cast<uint32_t>(actualFile.length() - baseLength)).Value();
+                            valid = (number < (sizeof(_occupation) * 8));
+                        }
+                    }
+                    return (valid);
+                }
 
-                            if (number <= (sizeof(_occupation) * 8)) {
-                                _adminLock.Lock();
+            private:
+                mutable Core::CriticalSection _adminLock;
+                string _basePath;
+                uint16_t _occupation;
+            };
 
-                                if ((_occupation & (1 << number)) != 0) {
-                                    _occupation ^= (1 << number);
-                                    released = true;
-                                } else {
-                                    // Freeing a buffer that is already free sounds dangerous !!!
-                                    ASSERT(false);
-                                }
+            // The threads serving the session buffers. A buffer keeps its worker for as long as it
+            // exists, as the worker blocks on the buffer's semaphore. A closed buffer hands the worker
+            // back, so the next one (on a zap) starts without creating a thread. Up to "spare" idle
+            // workers are kept, the ones beyond are stopped when the next buffer is released.
+            class DecryptWorkers {
+            public:
+                struct IJob {
+                    virtual ~IJob() = default;
 
-                                _adminLock.Unlock();
-                            }
+                    // Runs on the worker, returns once the job is stopped.
+                    virtual void Serve() = 0;
+                };
+
+                struct Metrics {
+                    uint32_t Busy;
+                    uint32_t Idle;
+                    uint32_t Created;
+                    uint32_t Reused;
+                    uint32_t LastSetup;    // us for a buffer to get its worker
+                    uint32_t MaxSetup;
+                };
+
+            private:
+                DecryptWorkers() = delete;
+                DecryptWorkers(const DecryptWorkers&) = delete;
+                DecryptWorkers& operator=(const DecryptWorkers&) = delete;
+
+                class Runner : public Core::Thread {
+                private:
+                    Runner() = delete;
+                    Runner(const Runner&) = delete;
+                    Runner& operator=(const Runner&) = delete;
+
+                public:
+                    Runner(DecryptWorkers& parent, const uint32_t stackSize)
+                        : Core::Thread(stackSize != 0 ? stackSize : Core::Thread::DefaultStackSize(), _T("DRMSessionThread"))
+                        , _parent(parent)
+                        , _job(nullptr)
+                    {
+                    }
+                    ~Runner() override
+                    {
+                        Core::Thread::Stop();
+                        _parent.Wake();
+                        Core::Thread::Wait(Core::Thread::STOPPED, Core::infinite);
+                    }
+
+                private:
+                    uint32_t Worker() override
+                    {
+                        IJob* job = _parent.Next(*this);
+
+                        if (job != nullptr) {
+                            job->Serve();
+                            _parent.Done(*this);
                         }
+
+                        return (job != nullptr ? 0 : Core::infinite);
+                    }
+
+                private:
+                    friend class DecryptWorkers;
+
+                    DecryptWorkers& _parent;
+                    IJob* _job;
+                };
+
+            public:
+                DecryptWorkers(const uint8_t spare, const uint32_t stackSize)
+                    : _lock()
+                    , _condition()
+                    , _spare(spare)
+                    , _stackSize(stackSize)
+                    , _idle()
+                    , _retired()
+                    , _serving()
+                    , _created(0)
+                    , _reused(0)
+                    , _lastSetup(0)
+                    , _maxSetup(0)
+                {
+                    for (uint8_t index = 0; index < _spare; index++) {
+                        Runner* runner = new Runner(*this, _stackSize);
+                        runner->Run();
+                        _idle.push_back(runner);
+                        _created++;
+                    }
+                }
+                ~DecryptWorkers()
+                {
+                    ASSERT(_serving.empty() == true);
+
+                    std::list<Runner*> runners;
+                    {
+                        std::lock_guard<std::mutex> lock(_lock);
+                        runners.swap(_idle);
+                        runners.splice(runners.end(), _retired);
+                    }
+                    for (Runner* runner : runners) {
+                        delete runner;
+                    }
+                }
+
+            public:
+                void Assign(IJob* job)
+                {
+                    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+                    Runner* runner = nullptr;
+                    bool created = false;
+
+                    std::unique_lock<std::mutex> lock(_lock);
+                    if (_idle.empty() == false) {
+                        runner = _idle.back();
+                        _idle.pop_back();
+                        _reused++;
+                    } else {
+                        runner = new Runner(*this, _stackSize);
+                        created = true;
+                        _created++;
+                    }
+                    runner->_job = job;
+                    _serving.push_back(job);
+                    lock.unlock();
+
+                    if (created == true) {
+                        runner->Run();
+                    } else {
+                        _condition.notify_all();
+                    }
+
+                    const uint32_t setup = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+                    lock.lock();
+                    _lastSetup = setup;
+                    _maxSetup = std::max(_maxSetup, setup);
+                    const uint32_t busy = static_cast<uint32_t>(_serving.size());
+                    const uint32_t idle = static_cast<uint32_t>(_idle.size());
+                    lock.unlock();
+
+                    TRACE(Trace::Information, (_T("Decrypt worker %s in %u us (%u busy, %u idle)"), created ? _T("created") : _T("reused"), setup, busy, idle));
+                }
+
+                // Waits for the (stopped) job to leave its worker.
+                void Release(IJob* job)
+                {
+                    std::list<Runner*> retired;
+                    {
+                        std::unique_lock<std::mutex> lock(_lock);
+                        _condition.wait(lock, [this, job]() {
+                            return (std::find(_serving.begin(), _serving.end(), job) == _serving.end());
+                        });
+                        retired.swap(_retired);
+                    }
+                    for (Runner* runner : retired) {
+                        delete runner;
                     }
-                    return (released);
+                }
+
+                Metrics Statistics() const
+                {
+                    std::lock_guard<std::mutex> lock(_lock);
+                    Metrics result;
+                    result.Busy = static_cast<uint32_t>(_serving.size());
+                    result.Idle = static_cast<uint32_t>(_idle.size());
+                    result.Created = _created;
+                    result.Reused = _reused;
+                    result.LastSetup = _lastSetup;
+                    result.MaxSetup = _maxSetup;
+                    return (result);
                 }
 
             private:
-                Core::CriticalSection _adminLock;
-                string _basePath;
-                uint16_t _occupation;
+                IJob* Next(Runner& runner)
+                {
+                    std::unique_lock<std::mutex> lock(_lock);
+                    _condition.wait(lock, [&runner]() {
+                        return ((runner._job != nullptr) || (runner.IsRunning() == false));
+                    });
+                    return (runner.IsRunning() == true ? runner._job : nullptr);
+                }
+                void Done(Runner& runner)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(_lock);
+                        _serving.erase(std::find(_serving.begin(), _serving.end(), runner._job));
+                        runner._job = nullptr;
+                        if (_idle.size() < _spare) {
+                            _idle.push_back(&runner);
+                        } else {
+                            // can not delete itself, the next Release does
+                            _retired.push_back(&runner);
+                        }
+                    }
+                    _condition.notify_all();
+                }
+                void Wake()
+                {
+                    // in lock, so that a worker can not miss it between its check and its wait
+                    std::lock_guard<std::mutex> lock(_lock);
+                    _condition.notify_all();
+                }
+
+            private:
+                mutable std::mutex _lock;
+                std::condition_variable _condition;
+                const uint8_t _spare;
+                const uint32_t _stackSize;
+                std::list<Runner*> _idle;
+                std::list<Runner*> _retired;
+                std::list<IJob*> _serving;
+                uint32_t _created;
+                uint32_t _reused;
+                uint32_t _lastSetup;
+                uint32_t _maxSetup;
             };
 
             // IMediaKeys defines the MediaKeys interface.
@@ -243,58 +492,130 @@ namespace Plugin {
                 SessionImplementation(const SessionImplementation&) = delete;
                 SessionImplementation& operator=(const SessionImplementation&) = delete;
 
-                class DataExchange : public ::OCDM::DataExchange, public Core::Thread {
+            public:
+                // The shared buffer of a session. Created unattached, mapped and with its pages
+                // touched, so that it can be kept by the accessor and handed to the next session.
+                class DataExchange : public ::OCDM::DataExchange, public DecryptWorkers::IJob {
                 private:
                     DataExchange() = delete;
                     DataExchange(const DataExchange&) = delete;
                     DataExchange& operator=(const DataExchange&) = delete;
 
                 public:
-                    DataExchange(CDMi::IMediaKeySession* mediaKeys, const string& name, const uint32_t defaultSize, CDMi::ICapsParser* parser)
+                    DataExchange(const string& name, const uint32_t defaultSize, DecryptWorkers& workers)
                         : ::OCDM::DataExchange(name, defaultSize)
-                        , Core::Thread(Core::Thread::DefaultStackSize(), _T("DRMSessionThread"))
-                        , _mediaKeys(mediaKeys)
-                        , _mediaKeysExt(dynamic_cast<CDMi::IMediaKeySessionExt*>(mediaKeys))
+                        , _workers(workers)
+                        , _running(false)
+                        , _mediaKeys(nullptr)
+                        , _mediaKeysExt(nullptr)
                         , _sessionKey(nullptr)
                         , _sessionKeyLength(0)
-                        , _parser(parser)
+                        , _parser(nullptr)
+                        , _streamInfo()
+                        , _streamInfoSet(false)
                     {
-                        ASSERT(parser != nullptr);
-                        Core::Thread::Run();
+                        Prefault(defaultSize);
                         TRACE(Trace::Information, (_T("Constructing buffer server side: %p - %s"), this, name.c_str()));
                     }
                     ~DataExchange()
                     {
                         TRACE(Trace::Information, (_T("Destructing buffer server side: %p - %s"), this, ::OCDM::DataExchange::Name().c_str()));
-                        // Make sure the thread reaches a HALT.. We are done.
-                        Core::Thread::Stop();
+                        Detach();
+                    }
 
-                        // If the thread is waiting for a semaphore, fake a signal :-)
-                        Produced();
+                public:
+                    void Attach(CDMi::IMediaKeySession* mediaKeys, CDMi::ICapsParser* parser)
+                    {
+                        ASSERT(parser != nullptr);
+                        ASSERT(_running == false);
+
+                        _mediaKeys = mediaKeys;
+                        _mediaKeysExt = dynamic_cast<CDMi::IMediaKeySessionExt*>(mediaKeys);
+                        _parser = parser;
+                        _streamInfo.clear();
+                        _streamInfoSet = false;
+                        _running = true;
+                        _workers.Assign(this);
+                    }
+                    void Detach()
+                    {
+                        if (_running == true) {
+                            // Make sure the worker leaves Serve().. We are done.
+                            _running = false;
 
-                        Core::Thread::Wait(Core::Thread::STOPPED, Core::infinite);
+                            // If the worker is waiting for a semaphore, fake a signal :-)
+                            Produced();
+
+                            _workers.Release(this);
+
+                            // Back to the state of a new buffer for the next session: nothing to
+                            // consume (our fake signal, or a sample the client left), free to produce.
+                            while (RequestConsume(0) == Core::ERROR_NONE) {
+                            }
+                            while (RequestProduce(0) == Core::ERROR_NONE) {
+                            }
+                            Consumed();
+
+                            // The next session may be another client, it must not find our samples.
+                            ::memset(Buffer(), 0, static_cast<size_t>(Size()));
+
+                            _mediaKeys = nullptr;
+                            _mediaKeysExt = nullptr;
+                            _parser = nullptr;
+                        }
+                    }
+
+                private:
+                    void Prefault(const uint32_t size)
+                    {
+                        uint8_t* buffer = Buffer();
+
+#if !defined(__WINDOWS__) && defined(MADV_HUGEPAGE)
+                        // Huge pages where the share path offers them (tmpfs mounted huge=advise),
+                        // before the pages are touched. Elsewhere this fails, harmless.
+                        const uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+                        const uintptr_t start = (reinterpret_cast<uintptr_t>(buffer) + pageSize - 1) & ~(pageSize - 1);
+                        const uintptr_t end = (reinterpret_cast<uintptr_t>(buffer) + size) & ~(pageSize - 1);
+                        if (end > start) {
+                            ::madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE);
+                        }
+#endif
+                        // Touch every page now, the first sample of the session does not fault them in.
+                        ::memset(buffer, 0, size);
                     }
 
                 private:
-                    virtual uint32_t Worker() override
+                    void Serve() override
                     {
 		      size_t clearContentInfoTraceCount = 0;
 		      size_t clearContentInfoTraceTotalCount = 0;
 
-                        while (IsRunning() == true) {
+                        while (_running == true) {
 
                             uint32_t clearContentSize = 0;
                             uint8_t* clearContent = nullptr;
 
                             RequestConsume(Core::infinite);
 
-                            if (IsRunning() == true) {
+                            if (_running == true) {
                                 uint8_t keyIdLength = 0;
                                 const uint8_t* keyIdData = KeyId(keyIdLength);
 
-                                _parser->Parse(StreamInfo(), StreamInfoLength());
-                                _mediaKeys->SetCapsParser(_parser);
+                                // The caps hardly ever change within a stream, parse them only when they did.
+                                const uint8_t* streamInfo = StreamInfo();
+                                const uint16_t streamInfoLength = StreamInfoLength();
+                                if ((_streamInfoSet == false) || (streamInfoLength != _streamInfo.size()) ||
+                                    ((streamInfoLength > 0) && (::memcmp(streamInfo, _streamInfo.data(), streamInfoLength) != 0))) {
+                                    _streamInfo.assign(streamInfo, streamInfo + streamInfoLength);
+                                    _streamInfoSet = true;
+                                    _parser->Parse(streamInfo, streamInfoLength);
+                                    _mediaKeys->SetCapsParser(_parser);
+                                }
 
+                                // One sample per exchange, without a subsample map: the client gathers the
+                                // encrypted ranges of a sample into the buffer before it signals us. Both the
+                                // buffer layout and the handshake belong to the ::OCDM::DataExchange shared
+                                // with the client library, so batching or passing subsamples has to start there.
                                 int cr = _mediaKeys->Decrypt(
                                     _sessionKey,
                                     _sessionKeyLength,
@@ -334,18 +655,21 @@ namespace Plugin {
                                 Consumed();
                             }
                         }
-
-                        return (Core::infinite);
                     }
 
                 private:
+                    DecryptWorkers& _workers;
+                    std::atomic<bool> _running;
                     CDMi::IMediaKeySession* _mediaKeys;
                     CDMi::IMediaKeySessionExt* _mediaKeysExt;
                     uint8_t* _sessionKey;
                     uint32_t _sessionKeyLength;
                     CDMi::ICapsParser* _parser;
+                    std::vector<uint8_t> _streamInfo;  // as last parsed
+                    bool _streamInfoSet;
                 };
 
+            private:
                 // IMediaKeys defines the MediaKeys interface.
                 class Sink : public CDMi::IMediaKeySessionCallback {
                 private:
@@ -427,6 +751,10 @@ namespace Plugin {
 
                         ASSERT (updated != nullptr);
 
+                        if ((key == ::OCDM::ISession::Usable) && (_parent._persistent == true)) {
+                            _parent.LicenseStored();
+                        }
+
                         if (_callback != nullptr) {
                             _callback->OnKeyStatusUpdate(updated->Id(), updated->Length(), key);
                         }
@@ -471,6 +799,9 @@ namespace Plugin {
                     , _buffer(nullptr)
                     , _cencData(*sessionData)
                     , _parser()
+                    , _persistent(false)
+                    , _initDataHash(0)
+                    , _licenseStored(false)
                 {
                     ASSERT(parent != nullptr);
                     ASSERT(sessionData != nullptr);
@@ -496,6 +827,10 @@ namespace Plugin {
                     , _sink(this, callback)
                     , _buffer(nullptr)
                     , _cencData(*sessionData)
+                    , _parser()
+                    , _persistent(false)
+                    , _initDataHash(0)
+                    , _licenseStored(false)
                 {
                     ASSERT(parent != nullptr);
                     ASSERT(sessionData != nullptr);
@@ -523,7 +858,9 @@ namespace Plugin {
                     // the parent to lock handing out new entries before we clear.
                     _parent.Remove(this, _keySystem, _mediaKeySession);
 
-                    delete _buffer;
+                    if (_buffer != nullptr) {
+                        _parent.ReturnBuffer(_buffer);
+                    }
 
                     TRACE(Trace::Information, ("Server::Session::~Session(%s,%s) => %p", _keySystem.c_str(), _sessionId.c_str(), this));
                     TRACE(Trace::Information, (_T("Destructed the Session Server side: %p"), this));
@@ -566,7 +903,8 @@ namespace Plugin {
 
                         if (_parent._administrator.AquireBuffer(bufferID) == true)
                         {
-                            _buffer = new DataExchange(_mediaKeySession, bufferID, _parent.DefaultSize(), &_parser);
+                            _buffer = _parent.TakeBuffer(bufferID);
+                            _buffer->Attach(_mediaKeySession, &_parser);
                             _adminLock.Unlock();
                             TRACE(Trace::Information, ("Server::Session::CreateSessionBuffer(%s,%s,%s) => %p", _keySystem.c_str(), _sessionId.c_str(), BufferId().c_str(), this));
                         } else {
@@ -619,7 +957,12 @@ namespace Plugin {
                 virtual ::OCDM::OCDM_RESULT Remove() override
                 {
                     TRACE(Trace::Information, ("Remove()"));
-                    return (::OCDM::OCDM_RESULT)(_mediaKeySession->Remove());
+                    const ::OCDM::OCDM_RESULT result = (::OCDM::OCDM_RESULT)(_mediaKeySession->Remove());
+                    if ((result == ::OCDM::OCDM_SUCCESS) && (_persistent == true)) {
+                        _parent._licenses.Remove(_keySystem, _cencData);
+                        _licenseStored = false;
+                    }
+                    return (result);
                 }
 
                 //We are done with the Session, close what we can..
@@ -685,6 +1028,25 @@ namespace Plugin {
                     return _keySystem;
                 }
 
+                // The license of this session is kept by the CDM, remember the content it is for
+                // once it has usable keys.
+                void Persistent(const uint32_t initDataHash)
+                {
+                    _persistent = true;
+                    _initDataHash = initDataHash;
+                }
+
+            private:
+                // Sink, on the first usable key
+                void LicenseStored()
+                {
+                    if (_licenseStored.exchange(true) == false) {
+                        _parent._licenses.Store(_keySystem, _initDataHash, _cencData);
+                    }
+                }
+
+            public:
+
                 BEGIN_INTERFACE_MAP(Session)
                 INTERFACE_ENTRY(::OCDM::ISession)
                 INTERFACE_RELAY(::OCDM::ISessionExt, _mediaKeySessionExt)
@@ -702,20 +1064,51 @@ namespace Plugin {
                 DataExchange* _buffer;
                 CommonEncryptionData _cencData;
                 CapsParser _parser;
+                bool _persistent;
+                uint32_t _initDataHash;
+                std::atomic<bool> _licenseStored;
             };
 
         public:
-            AccessorOCDM(OCDMImplementation* parent, const string& name, const uint32_t defaultSize)
+            AccessorOCDM(OCDMImplementation* parent, const string& name, const uint32_t defaultSize, const uint8_t spareWorkers, const uint32_t workerStackSize, const uint8_t spareBuffers, const string& licenseStore)
                 : _parent(*parent)
                 , _adminLock()
                 , _administrator(name)
+                , _workers(spareWorkers, workerStackSize)
                 , _defaultSize(defaultSize)
                 , _sessionList()
+                , _bufferLock()
+                , _spareBuffers(spareBuffers)
+                , _warmBuffers()
+                , _warmTaken(0)
+                , _coldTaken(0)
+                , _licenses()
             {
                 ASSERT(parent != nullptr);
+
+                _licenses.Open(licenseStore);
+
+                // Mapped and faulted in now, under the names the first sessions will get
+                std::list<string> locators;
+                string locator;
+                while ((locators.size() < _spareBuffers) && (_administrator.AquireBuffer(locator) == true)) {
+                    _warmBuffers[locator] = new SessionImplementation::DataExchange(locator, _defaultSize, _workers);
+                    locators.push_back(locator);
+                }
+                for (const string& entry : locators) {
+                    _administrator.ReleaseBuffer(entry);
+                }
             }
             virtual ~AccessorOCDM()
             {
+                for (auto& entry : _warmBuffers) {
+                    delete entry.second;
+                }
+                _warmBuffers.clear();
+
+                const DecryptWorkers::Metrics metrics(_workers.Statistics());
+                TRACE(Trace::Information, (_T("Decrypt workers: %u created, %u reused, setup at most %u us"), metrics.Created, metrics.Reused, metrics.MaxSetup));
+                TRACE(Trace::Information, (_T("Session buffers: %u warm, %u created"), _warmTaken, _coldTaken));
                 TRACE(Trace::Information, (_T("Released the AccessorOCDM server side [%d]"), __LINE__));
             }
 
@@ -748,6 +1141,52 @@ namespace Plugin {
                 return _defaultSize;
             }
 
+            // The buffer kept under this name, if any, else a new one.
+            SessionImplementation::DataExchange* TakeBuffer(const string& locator)
+            {
+                SessionImplementation::DataExchange* buffer = nullptr;
+
+                _bufferLock.Lock();
+                auto index = _warmBuffers.find(locator);
+                if (index != _warmBuffers.end()) {
+                    buffer = index->second;
+                    _warmBuffers.erase(index);
+                    _warmTaken++;
+                }
+                _bufferLock.Unlock();
+
+                const bool warm = (buffer != nullptr);
+                if (warm == false) {
+                    buffer = new SessionImplementation::DataExchange(locator, _defaultSize, _workers);
+                    _bufferLock.Lock();
+                    _coldTaken++;
+                    _bufferLock.Unlock();
+                }
+                TRACE(Trace::Information, (_T("Session buffer %s: %s"), locator.c_str(), warm ? _T("warm") : _T("created")));
+
+                return (buffer);
+            }
+
+            // Kept for the next session, unless its name was handed out again meanwhile.
+            void ReturnBuffer(SessionImplementation::DataExchange* buffer)
+            {
+                buffer->Detach();
+
+                const string locator(buffer->Name());
+                bool keep = false;
+
+                _bufferLock.Lock();
+                if ((_warmBuffers.size() < _spareBuffers) && (_administrator.InUse(locator) == false) && (_warmBuffers.find(locator) == _warmBuffers.end())) {
+                    _warmBuffers[locator] = buffer;
+                    keep = true;
+                }
+                _bufferLock.Unlock();
+
+                if (keep == false) {
+                    delete buffer;
+                }
+            }
+
             // Create a MediaKeySession using the supplied init data and CDM data.
             virtual OCDM::OCDM_RESULT CreateSession(
                 const std::string& keySystem,
@@ -795,6 +1234,18 @@ namespace Plugin {
                                 session = newEntry;
                                 sessionId = newEntry->SessionId();
 
+                                if (licenseType == PersistentLicense) {
+                                    const uint32_t hash = CommonEncryptionData::Hash(initData, initDataLength);
+                                    newEntry->Persistent(hash);
+
+                                    // Played before: the CDM restores the license it stored, no license round trip
+                                    if (_licenses.Lookup(keySystem, hash, keyIds) == true) {
+                                        const CDMi::CDMi_RESULT loaded = sessionInterface->Load();
+                                        TRACE(Trace::Information, (_T("Persistent license for %s loaded: %08x"), keySystem.c_str(), loaded));
+                                        _licenses.Loaded(loaded == CDMi::CDMi_SUCCESS);
+                                    }
+                                }
+
                                 _adminLock.Lock();
 
                                 _sessionList.push_front(newEntry);
@@ -1083,8 +1534,15 @@ namespace Plugin {
             OCDMImplementation& _parent;
             mutable Core::CriticalSection _adminLock;
             BufferAdministrator _administrator;
+            DecryptWorkers _workers;
             uint32_t _defaultSize;
             std::list<SessionImplementation*> _sessionList;
+            Core::CriticalSection _bufferLock;
+            const uint8_t _spareBuffers;
+            std::map<string, SessionImplementation::DataExchange*> _warmBuffers;
+            uint32_t _warmTaken;
+            uint32_t _coldTaken;
+            LicenseStore _licenses;
         };
 
         class Config : public Core::JSON::Container {
@@ -1138,12 +1596,18 @@ namespace Plugin {
                 , Connector(_T("/tmp/ocdm"))
                 , SharePath(_T("/tmp"))
                 , ShareSize(8 * 1024)
+                , SpareWorkers(DECRYPT_WORKERS_SPARE)
+                , DecryptStackSize(0)
+                , SpareBuffers(DECRYPT_BUFFERS_SPARE)
                 , KeySystems()
             {
                 Add(_T("location"), &Location);
                 Add(_T("connector"), &Connector);
                 Add(_T("sharepath"), &SharePath);
                 Add(_T("sharesize"), &ShareSize);
+                Add(_T("decryptworkers"), &SpareWorkers);
+                Add(_T("decryptstacksize"), &DecryptStackSize);
+                Add(_T("sparebuffers"), &SpareBuffers);
                 Add(_T("systems"), &KeySystems);
             }
             ~Config()
@@ -1155,6 +1619,9 @@ namespace Plugin {
             Core::JSON::String Connector;
             Core::JSON::String SharePath;
             Core::JSON::DecUInt32 ShareSize;
+            Core::JSON::DecUInt8 SpareWorkers;          // idle decrypt workers kept ready
+            Core::JSON::DecUInt32 DecryptStackSize;     // bytes, 0 for the default
+            Core::JSON::DecUInt8 SpareBuffers;          // session buffers kept mapped
             Core::JSON::ArrayType<Systems> KeySystems;
         };
 
@@ -1270,7 +1737,11 @@ namespace Plugin {
                 SYSLOG(Logging::Startup, (_T("No DRM factories specified. OCDM can not service any DRM requests.")));
             }
 
-            _entryPoint = Core::Service<AccessorOCDM>::Create<::OCDM::IAccessorOCDM>(this, config.SharePath.Value(), config.ShareSize.Value());
+            // Content with a persistent license, to load it on replay
+            Core::Directory(service->PersistentPath().c_str()).CreatePath();
+
+            _entryPoint = Core::Service<AccessorOCDM>::Create<::OCDM::IAccessorOCDM>(this, config.SharePath.Value(), config.ShareSize.Value(),
+                config.SpareWorkers.Value(), config.DecryptStackSize.Value(), config.SpareBuffers.Value(), service->PersistentPath() + LICENSE_STORE_FILE);
             Core::ProxyType<RPC::InvokeServer> server = Core::ProxyType<RPC::InvokeServer>::Create(&Core::IWorkerPool::Instance());
             _service = new ExternalAccess(Core::NodeId(config.Connector.Value().c_str()), _entryPoint, server);
 
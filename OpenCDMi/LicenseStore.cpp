@@ -0,0 +1,243 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LicenseStore.h"
+
+#include <algorithm>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    LicenseStore::LicenseStore()
+        : _adminLock()
+        , _fileName()
+        , _licenses()
+        , _hits(0)
+        , _misses(0)
+        , _loaded(0)
+        , _failed(0)
+    {
+    }
+
+    LicenseStore::~LicenseStore()
+    {
+    }
+
+    void LicenseStore::Open(const string& fileName)
+    {
+        Data data;
+        Core::File file(fileName);
+
+        if (file.Open(true) == true) {
+            Core::OptionalType<Core::JSON::Error> error;
+            data.IElement::FromFile(file, error);
+            if (error.IsSet() == true) {
+                TRACE(Trace::Warning, (_T("License store %s unreadable: %s"), fileName.c_str(), Core::JSON::ErrorDisplayMessage(error).c_str()));
+            }
+            file.Close();
+        }
+
+        _adminLock.Lock();
+
+        _fileName = fileName;
+        _licenses.clear();
+        _hits = data.Counters.Hits.Value();
+        _misses = data.Counters.Misses.Value();
+        _loaded = data.Counters.Loaded.Value();
+        _failed = data.Counters.Failed.Value();
+
+        Core::JSON::ArrayType<Entry>::ConstIterator index(static_cast<const Data&>(data).Licenses.Elements());
+        while ((index.Next() == true) && (_licenses.size() < LICENSE_STORE_SIZE)) {
+            License license;
+            license.system = index.Current().System.Value();
+            license.hash = index.Current().Hash.Value();
+
+            Core::JSON::ArrayType<Core::JSON::String>::ConstIterator keyId(index.Current().KeyIds.Elements());
+            while (keyId.Next() == true) {
+                license.keyIds.push_back(keyId.Current().Value());
+            }
+            std::sort(license.keyIds.begin(), license.keyIds.end());
+
+            _licenses.push_back(std::move(license));
+        }
+
+        TRACE(Trace::Information, (_T("License store %s: %u licenses"), fileName.c_str(), static_cast<uint32_t>(_licenses.size())));
+
+        _adminLock.Unlock();
+    }
+
+    bool LicenseStore::Lookup(const string& system, const uint32_t hash, const CommonEncryptionData& keyIds)
+    {
+        const std::vector<string> keys(KeyIds(keyIds));
+
+        _adminLock.Lock();
+
+        std::list<License>::iterator index(Find(system, hash, keys));
+        const bool found = (index != _licenses.end());
+        if (found == true) {
+            _licenses.splice(_licenses.begin(), _licenses, index);
+            _hits++;
+        } else {
+            _misses++;
+        }
+        Save();
+
+        _adminLock.Unlock();
+
+        return (found);
+    }
+
+    void LicenseStore::Loaded(const bool success)
+    {
+        _adminLock.Lock();
+
+        if (success == true) {
+            _loaded++;
+        } else {
+            _failed++;
+        }
+        Save();
+
+        _adminLock.Unlock();
+    }
+
+    void LicenseStore::Store(const string& system, const uint32_t hash, const CommonEncryptionData& keyIds)
+    {
+        License license;
+        license.system = system;
+        license.hash = hash;
+        license.keyIds = KeyIds(keyIds);
+
+        _adminLock.Lock();
+
+        std::list<License>::iterator index(Find(system, hash, license.keyIds));
+        if (index != _licenses.end()) {
+            // Same content, the license may have been renewed for other keys
+            *index = std::move(license);
+            _licenses.splice(_licenses.begin(), _licenses, index);
+        } else {
+            _licenses.push_front(std::move(license));
+            if (_licenses.size() > LICENSE_STORE_SIZE) {
+                _licenses.pop_back();
+            }
+        }
+        Save();
+
+        _adminLock.Unlock();
+    }
+
+    void LicenseStore::Remove(const string& system, const CommonEncryptionData& keyIds)
+    {
+        const std::vector<string> keys(KeyIds(keyIds));
+
+        if (keys.empty() == false) {
+            _adminLock.Lock();
+
+            std::list<License>::iterator index(_licenses.begin());
+            while (index != _licenses.end()) {
+                if ((index->system == system) && (index->keyIds == keys)) {
+                    index = _licenses.erase(index);
+                } else {
+                    index++;
+                }
+            }
+            Save();
+
+            _adminLock.Unlock();
+        }
+    }
+
+    /* static */ bool LicenseStore::Read(const string& fileName, Statistics& statistics)
+    {
+        bool result = false;
+        Data data;
+        Core::File file(fileName);
+
+        if (file.Open(true) == true) {
+            Core::OptionalType<Core::JSON::Error> error;
+            data.IElement::FromFile(file, error);
+            file.Close();
+
+            if (error.IsSet() == false) {
+                statistics.Entries = data.Licenses.Length();
+                statistics.Hits = data.Counters.Hits.Value();
+                statistics.Misses = data.Counters.Misses.Value();
+                statistics.Loaded = data.Counters.Loaded.Value();
+                statistics.Failed = data.Counters.Failed.Value();
+                result = true;
+            }
+        }
+        return (result);
+    }
+
+    /* static */ std::vector<string> LicenseStore::KeyIds(const CommonEncryptionData& keyIds)
+    {
+        std::vector<string> keys;
+
+        CommonEncryptionData::Iterator index(keyIds.Keys());
+        while (index.Next() == true) {
+            keys.push_back(index.Current().ToString());
+        }
+        std::sort(keys.begin(), keys.end());
+
+        return (keys);
+    }
+
+    // The same init data, or other init data for the same keys.
+    std::list<LicenseStore::License>::iterator LicenseStore::Find(const string& system, const uint32_t hash, const std::vector<string>& keyIds)
+    {
+        std::list<License>::iterator index(_licenses.begin());
+        while ((index != _licenses.end()) && ((index->system != system) || ((index->hash != hash) && ((keyIds.empty() == true) || (index->keyIds != keyIds))))) {
+            index++;
+        }
+        return (index);
+    }
+
+    void LicenseStore::Save() const
+    {
+        if (_fileName.empty() == false) {
+            Data data;
+            data.Counters.Entries = static_cast<uint32_t>(_licenses.size());
+            data.Counters.Hits = _hits;
+            data.Counters.Misses = _misses;
+            data.Counters.Loaded = _loaded;
+            data.Counters.Failed = _failed;
+
+            for (const License& license : _licenses) {
+                Entry& entry(data.Licenses.Add());
+                entry.System = license.system;
+                entry.Hash = license.hash;
+                for (const string& keyId : license.keyIds) {
+                    Core::JSON::String& element(entry.KeyIds.Add());
+                    element = keyId;
+                }
+            }
+
+            Core::File file(_fileName);
+            if (file.Create() == true) {
+                data.IElement::ToFile(file);
+                file.Close();
+            } else {
+                TRACE(Trace::Warning, (_T("License store %s can not be written"), _fileName.c_str()));
+            }
+        }
+    }
+}
+} // namespace WPEFramework::Plugin
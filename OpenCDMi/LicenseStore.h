@@ -0,0 +1,164 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "CENCParser.h"
+
+// Persistent licenses remembered, the least recently used are forgotten beyond it.
+#define LICENSE_STORE_SIZE 64
+// In the persistent path of the plugin, shared by the plugin and its implementation.
+#define LICENSE_STORE_FILE _T("licenses.json")
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The content that a persistent license was acquired for, by key system, hash of the init data
+    // and key ids. The license itself stays in the store of the CDM, which has no way to hand it out;
+    // on replay a session for known content is asked to Load() it instead of waiting for the round
+    // trip to the license server. Kept in a file, with the hit counters, so that the plugin can report
+    // them when the implementation runs in a process of its own.
+    class LicenseStore {
+    private:
+        LicenseStore(const LicenseStore&) = delete;
+        LicenseStore& operator=(const LicenseStore&) = delete;
+
+        class Entry : public Core::JSON::Container {
+        public:
+            Entry()
+                : Core::JSON::Container()
+                , System()
+                , Hash(0)
+                , KeyIds()
+            {
+                Add(_T("system"), &System);
+                Add(_T("hash"), &Hash);
+                Add(_T("keyids"), &KeyIds);
+            }
+            Entry(const Entry& copy)
+                : Core::JSON::Container()
+                , System(copy.System)
+                , Hash(copy.Hash)
+                , KeyIds(copy.KeyIds)
+            {
+                Add(_T("system"), &System);
+                Add(_T("hash"), &Hash);
+                Add(_T("keyids"), &KeyIds);
+            }
+            Entry& operator=(const Entry&) = delete;
+
+        public:
+            Core::JSON::String System;
+            Core::JSON::DecUInt32 Hash;
+            Core::JSON::ArrayType<Core::JSON::String> KeyIds;
+        };
+
+    public:
+        class Statistics : public Core::JSON::Container {
+        public:
+            Statistics(const Statistics&) = delete;
+            Statistics& operator=(const Statistics&) = delete;
+
+            Statistics()
+                : Core::JSON::Container()
+                , Entries(0)
+                , Hits(0)
+                , Misses(0)
+                , Loaded(0)
+                , Failed(0)
+            {
+                Add(_T("entries"), &Entries);
+                Add(_T("hits"), &Hits);
+                Add(_T("misses"), &Misses);
+                Add(_T("loaded"), &Loaded);
+                Add(_T("failed"), &Failed);
+            }
+
+        public:
+            Core::JSON::DecUInt32 Entries;
+            Core::JSON::DecUInt32 Hits;     // persistent sessions for content with a stored license
+            Core::JSON::DecUInt32 Misses;   // persistent sessions for content without one
+            Core::JSON::DecUInt32 Loaded;   // hits the CDM loaded the license for
+            Core::JSON::DecUInt32 Failed;   // hits the CDM could not load, the round trip is needed
+        };
+
+    private:
+        class Data : public Core::JSON::Container {
+        public:
+            Data(const Data&) = delete;
+            Data& operator=(const Data&) = delete;
+
+            Data()
+                : Core::JSON::Container()
+                , Counters()
+                , Licenses()
+            {
+                Add(_T("statistics"), &Counters);
+                Add(_T("licenses"), &Licenses);
+            }
+
+        public:
+            Statistics Counters;
+            Core::JSON::ArrayType<Entry> Licenses;
+        };
+
+        struct License {
+            string system;
+            uint32_t hash;
+            std::vector<string> keyIds; // sorted
+        };
+
+    public:
+        LicenseStore();
+        ~LicenseStore();
+
+    public:
+        void Open(const string& fileName);
+
+        // A persistent session is created for this content, true if a license was stored for it.
+        bool Lookup(const string& system, const uint32_t hash, const CommonEncryptionData& keyIds);
+        // What the CDM made of the Load() of a hit.
+        void Loaded(const bool success);
+        // A persistent session has usable keys.
+        void Store(const string& system, const uint32_t hash, const CommonEncryptionData& keyIds);
+        // A persistent session removed its license.
+        void Remove(const string& system, const CommonEncryptionData& keyIds);
+
+        // Of the file, as last saved by the implementation.
+        static bool Read(const string& fileName, Statistics& statistics);
+
+    private:
+        static std::vector<string> KeyIds(const CommonEncryptionData& keyIds);
+        // Call with the _adminLock taken.
+        std::list<License>::iterator Find(const string& system, const uint32_t hash, const std::vector<string>& keyIds);
+        void Save() const;
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        string _fileName;
+        std::list<License> _licenses; // most recently used first
+        uint32_t _hits;
+        uint32_t _misses;
+        uint32_t _loaded;
+        uint32_t _failed;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
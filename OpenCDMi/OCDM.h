@@ -25,6 +25,7 @@
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_OCDM.h>
 #include "utils.h"
+#include "LicenseStore.h"
 
 namespace WPEFramework {
 namespace Plugin {
@@ -230,6 +231,7 @@ namespace Plugin {
         uint32_t get_drms(Core::JSON::ArrayType<JsonData::OCDM::DrmData>& response) const;
         uint32_t get_keysystems(const string& index, Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_sessions(Core::JSON::ArrayType<JsonData::OCDM::SessionInfo>& response) const;
+        uint32_t get_licensecache(LicenseStore::Statistics& response) const;
 
     private:
         uint8_t _skipURL;
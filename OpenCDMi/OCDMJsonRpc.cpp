@@ -19,6 +19,7 @@
 
 #include "Module.h"
 #include "OCDM.h"
+#include "LicenseStore.h"
 #include <interfaces/json/JsonData_OCDM.h>
 
 namespace WPEFramework {
@@ -35,6 +36,7 @@ namespace Plugin {
         Property<Core::JSON::ArrayType<DrmData>>(_T("drms"), &OCDM::get_drms, nullptr, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("keysystems"), &OCDM::get_keysystems, nullptr, this);
         Property<Core::JSON::ArrayType<SessionInfo>>(_T("sessions"), &OCDM::get_sessions, nullptr, this);
+        Property<LicenseStore::Statistics>(_T("licensecache"), &OCDM::get_licensecache, nullptr, this);
     }
 
     void OCDM::UnregisterAll()
@@ -42,6 +44,7 @@ namespace Plugin {
         Unregister(_T("keysystems"));
         Unregister(_T("drms"));
         Unregister(_T("sessions"));
+        Unregister(_T("licensecache"));
     }
 
     bool OCDM::KeySystems(const string& name, Core::JSON::ArrayType<Core::JSON::String>& response) const
@@ -124,6 +127,15 @@ namespace Plugin {
         }
         return Core::ERROR_NONE;
     }
+
+    // Property: licensecache - Persistent licenses remembered for replay, and how often they were used
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: No persistent license was acquired yet
+    uint32_t OCDM::get_licensecache(LicenseStore::Statistics& response) const
+    {
+        return (LicenseStore::Read(_service->PersistentPath() + LICENSE_STORE_FILE, response) == true ? Core::ERROR_NONE : Core::ERROR_UNAVAILABLE);
+    }
 } // namespace Plugin
 
 }
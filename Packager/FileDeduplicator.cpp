@@ -0,0 +1,257 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FileDeduplicator.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace WPEFramework {
+namespace Plugin {
+
+namespace {
+    constexpr size_t kCompareChunk = 64 * 1024;
+
+    // read() until count bytes or the end of the file
+    ssize_t ReadFully(int fd, char* buffer, size_t count)
+    {
+        size_t done = 0;
+        while (done < count) {
+            ssize_t n = read(fd, buffer + done, count - done);
+            if ((n < 0) && (errno == EINTR)) {
+                continue;
+            }
+            if (n < 0) {
+                return -1;
+            }
+            if (n == 0) {
+                break;
+            }
+            done += n;
+        }
+        return done;
+    }
+}
+
+    FileDeduplicator::FileDeduplicator(const string& storePath, const Hash& hash)
+        : _storePath(Core::Directory::Normalize(storePath))
+        , _hash(hash)
+        , _linkable(true)
+    {
+    }
+
+    uint64_t FileDeduplicator::Deduplicate(const std::vector<string>& files)
+    {
+        uint64_t saved = 0;
+
+        for (auto file = files.begin(); (file != files.end()) && (_linkable == true); ++file) {
+            struct stat info;
+
+            // Already in the store, or one of the hardlinks of the package itself
+            if ((lstat(file->c_str(), &info) != 0) || (S_ISREG(info.st_mode) == 0) || (info.st_size == 0) || (info.st_nlink > 1)) {
+                continue;
+            }
+
+            const string hash = _hash(*file);
+            if (hash.size() < 3) {
+                continue;
+            }
+
+            const string object = ObjectPath(hash, info);
+            struct stat objectInfo;
+
+            if (lstat(object.c_str(), &objectInfo) != 0) {
+                Core::Directory(object.substr(0, object.rfind('/')).c_str()).CreatePath();
+                if (link(file->c_str(), object.c_str()) != 0) {
+                    if (errno == EXDEV) {
+                        TRACE_L1("%s is not on the file system of %s, no deduplication", _storePath.c_str(), file->c_str());
+                        _linkable = false;
+                    }
+                }
+            } else if ((objectInfo.st_size == info.st_size) && (Same(*file, object) == true) && (Replace(*file, object) == true)) {
+                saved += info.st_size;
+            }
+        }
+
+        return (saved);
+    }
+
+    void FileDeduplicator::Unshare(const std::vector<string>& files) const
+    {
+        for (auto file = files.begin(); file != files.end(); ++file) {
+            struct stat info;
+
+            if ((lstat(file->c_str(), &info) == 0) && (S_ISREG(info.st_mode) != 0) && (info.st_nlink > 1)) {
+                if (Copy(*file, info) == false) {
+                    TRACE_L1("Could not unshare %s, %s", file->c_str(), strerror(errno));
+                }
+            }
+        }
+    }
+
+    uint32_t FileDeduplicator::Collect() const
+    {
+        uint32_t removed = 0;
+        DIR* store = opendir(_storePath.c_str());
+
+        if (store != nullptr) {
+            struct dirent* bucket;
+            while ((bucket = readdir(store)) != nullptr) {
+                if (bucket->d_name[0] == '.') {
+                    continue;
+                }
+
+                const string bucketPath = _storePath + bucket->d_name + '/';
+                DIR* objects = opendir(bucketPath.c_str());
+                if (objects == nullptr) {
+                    continue;
+                }
+
+                struct dirent* entry;
+                while ((entry = readdir(objects)) != nullptr) {
+                    const string object = bucketPath + entry->d_name;
+                    struct stat info;
+
+                    // Only the store links to it
+                    if ((entry->d_name[0] != '.') && (lstat(object.c_str(), &info) == 0) && (S_ISREG(info.st_mode) != 0) && (info.st_nlink == 1)) {
+                        if (unlink(object.c_str()) == 0) {
+                            removed++;
+                        }
+                    }
+                }
+                closedir(objects);
+
+                rmdir(bucketPath.c_str());
+            }
+            closedir(store);
+        }
+
+        return (removed);
+    }
+
+    // The inode carries mode and owner, files that differ in those are not linked together
+    string FileDeduplicator::ObjectPath(const string& hash, const struct stat& info) const
+    {
+        char suffix[48];
+        snprintf(suffix, sizeof(suffix), ".%04o.%u.%u", static_cast<unsigned>(info.st_mode & 07777),
+            static_cast<unsigned>(info.st_uid), static_cast<unsigned>(info.st_gid));
+
+        return (_storePath + hash.substr(0, 2) + '/' + hash.substr(2) + suffix);
+    }
+
+    // Byte for byte, the content hash alone is not trusted to link two files of different packages
+    /* static */ bool FileDeduplicator::Same(const string& file, const string& other)
+    {
+        int first = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        int second = open(other.c_str(), O_RDONLY | O_CLOEXEC);
+        bool result = (first >= 0) && (second >= 0);
+
+        if (result == true) {
+            std::unique_ptr<char[]> buffers(new char[2 * kCompareChunk]);
+            char* a = buffers.get();
+            char* b = a + kCompareChunk;
+
+            while (result == true) {
+                ssize_t n = ReadFully(first, a, kCompareChunk);
+                ssize_t m = ReadFully(second, b, kCompareChunk);
+                result = (n >= 0) && (n == m) && (memcmp(a, b, n) == 0);
+                if (n <= 0) {
+                    break;
+                }
+            }
+        }
+
+        if (first >= 0) {
+            close(first);
+        }
+        if (second >= 0) {
+            close(second);
+        }
+
+        return (result);
+    }
+
+    // The new link goes next to the file and is renamed over it, the path never goes missing
+    /* static */ bool FileDeduplicator::Replace(const string& file, const string& object)
+    {
+        const string temporary = file + _T(".dedup");
+
+        unlink(temporary.c_str());
+        bool result = (link(object.c_str(), temporary.c_str()) == 0);
+
+        if ((result == true) && (rename(temporary.c_str(), file.c_str()) != 0)) {
+            unlink(temporary.c_str());
+            result = false;
+        }
+
+        return (result);
+    }
+
+    /* static */ bool FileDeduplicator::Copy(const string& file, const struct stat& info)
+    {
+        const string temporary = file + _T(".unshare");
+        int input = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        int output = -1;
+        bool result = false;
+
+        if (input >= 0) {
+            unlink(temporary.c_str());
+            output = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, info.st_mode & 07777);
+        }
+
+        if (output >= 0) {
+            std::unique_ptr<char[]> buffer(new char[kCompareChunk]);
+            ssize_t n;
+
+            result = true;
+            while ((result == true) && ((n = ReadFully(input, buffer.get(), kCompareChunk)) > 0)) {
+                result = (write(output, buffer.get(), n) == n);
+            }
+            result = result && (n == 0);
+
+            if (result == true) {
+                const struct timespec times[2] = { info.st_atim, info.st_mtim };
+                result = (fchown(output, info.st_uid, info.st_gid) == 0) && (fchmod(output, info.st_mode & 07777) == 0);
+                futimens(output, times);
+            }
+
+            result = (close(output) == 0) && result;
+            result = result && (rename(temporary.c_str(), file.c_str()) == 0);
+
+            if (result == false) {
+                unlink(temporary.c_str());
+            }
+        }
+
+        if (input >= 0) {
+            close(input);
+        }
+
+        return (result);
+    }
+
+}  // namespace Plugin
+}  // namespace WPEFramework
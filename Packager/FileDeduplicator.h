@@ -0,0 +1,69 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <sys/stat.h>
+
+#include <functional>
+#include <vector>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Content addressed store of installed files. Every file of an installed package is hardlinked
+    // into the store under the hash of its content, mode and owner; a file that has the same content
+    // as one already there is replaced by a hardlink to it. Apps that ship the same libraries, fonts
+    // or media then share one inode on disk and one copy in the page cache.
+    // The link count is the reference count: a store object no installed file links to any more, as
+    // after an uninstall, is removed by Collect(). Files that are about to be rewritten, by an upgrade
+    // of their package, get a copy of their own first with Unshare(), an in place write to a shared
+    // inode would change the file of every app.
+    // The store has to be on the file system of the installed files, hardlinks do not cross it.
+    class FileDeduplicator {
+    public:
+        typedef std::function<string(const string&)> Hash;
+
+        FileDeduplicator(const FileDeduplicator&) = delete;
+        FileDeduplicator& operator=(const FileDeduplicator&) = delete;
+
+        FileDeduplicator(const string& storePath, const Hash& hash);
+        ~FileDeduplicator() = default;
+
+        // Returns the number of bytes no longer stored twice.
+        uint64_t Deduplicate(const std::vector<string>& files);
+        void Unshare(const std::vector<string>& files) const;
+        // Returns the number of store objects removed.
+        uint32_t Collect() const;
+
+    private:
+        string ObjectPath(const string& hash, const struct stat& info) const;
+        static bool Same(const string& file, const string& other);
+        static bool Replace(const string& file, const string& object);
+        static bool Copy(const string& file, const struct stat& info);
+
+        string _storePath;
+        Hash _hash;
+        bool _linkable;
+    };
+
+}  // namespace Plugin
+}  // namespace WPEFramework
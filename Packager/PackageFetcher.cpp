@@ -0,0 +1,210 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PackageFetcher.h"
+
+#include <curl/curl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <list>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    struct PackageFetcher::Transfer {
+        PackageFetcher::Item* Package;
+        bool Delta;
+        string File;
+        FILE* Output;
+        uint64_t Received;
+    };
+
+    PackageFetcher::PackageFetcher(const uint8_t parallel, const string& deltaTool)
+        : _parallel(parallel == 0 ? 1 : parallel)
+        , _deltaTool(deltaTool)
+    {
+    }
+
+    void PackageFetcher::Fetch(std::vector<Item>& items, const Verifier& verify, const Progress& progress)
+    {
+        CURLM* multi = curl_multi_init();
+        if (multi == nullptr) {
+            TRACE_L1("Failed to set up parallel downloads, leaving them to OPKG");
+            return;
+        }
+
+        std::list<Transfer> pending;
+        std::list<Transfer> active;
+        uint64_t total = 0;
+        uint64_t done = 0;
+        uint8_t reported = 0;
+
+        for (Item& item : items) {
+            bool delta = (item.DeltaUrl.empty() == false) && (Core::File(item.DeltaBase).Exists() == true);
+            pending.push_back({ &item, delta, string(), nullptr, 0 });
+            total += item.Size;
+        }
+
+        while ((pending.empty() == false) || (active.empty() == false)) {
+            while ((pending.empty() == false) && (active.size() < _parallel)) {
+                active.splice(active.end(), pending, pending.begin());
+
+                Transfer& transfer = active.back();
+                if (Start(multi, transfer) == false) {
+                    bool retry = transfer.Delta;
+                    transfer.Delta = false;
+                    if ((retry == false) || (Start(multi, transfer) == false)) {
+                        TRACE_L1("Could not start download of %s", transfer.Package->Url.c_str());
+                        active.pop_back();
+                    }
+                }
+            }
+
+            int running = 0;
+            curl_multi_perform(multi, &running);
+
+            CURLMsg* message;
+            int left;
+            while ((message = curl_multi_info_read(multi, &left)) != nullptr) {
+                if (message->msg != CURLMSG_DONE) {
+                    continue;
+                }
+
+                Transfer* transfer = nullptr;
+                CURL* handle = message->easy_handle;
+                bool success = (message->data.result == CURLE_OK);
+
+                curl_easy_getinfo(handle, CURLINFO_PRIVATE, reinterpret_cast<char**>(&transfer));
+                curl_multi_remove_handle(multi, handle);
+                curl_easy_cleanup(handle);
+                fclose(transfer->Output);
+
+                // Verify right away, the other packages keep downloading in the meantime.
+                Item& item = *(transfer->Package);
+                if (transfer->Delta == true) {
+                    success = success && ApplyDelta(item, transfer->File);
+                    remove(transfer->File.c_str());
+                } else if (success == true) {
+                    success = (rename(transfer->File.c_str(), item.Target.c_str()) == 0);
+                } else {
+                    remove(transfer->File.c_str());
+                }
+                success = success && verify(item);
+
+                if (success == true) {
+                    item.Fetched = true;
+                    done += item.Size;
+                } else {
+                    remove(item.Target.c_str());
+                    if (transfer->Delta == true) {
+                        TRACE_L1("Delta for %s not usable, downloading the full package", item.Url.c_str());
+                        pending.push_front({ &item, false, string(), nullptr, 0 });
+                    } else {
+                        TRACE_L1("Download of %s failed, leaving it to OPKG", item.Url.c_str());
+                    }
+                }
+
+                active.remove_if([transfer](const Transfer& entry) { return (&entry == transfer); });
+            }
+
+            if (total != 0) {
+                uint64_t received = done;
+                for (const Transfer& transfer : active) {
+                    if (transfer.Delta == false) {
+                        received += transfer.Received;
+                    }
+                }
+                uint8_t percentage = static_cast<uint8_t>(std::min(received, total) * 100 / total);
+                if (percentage != reported) {
+                    reported = percentage;
+                    progress(percentage);
+                }
+            }
+
+            if (active.empty() == false) {
+                curl_multi_wait(multi, nullptr, 0, 1000, nullptr);
+            }
+        }
+
+        curl_multi_cleanup(multi);
+    }
+
+    bool PackageFetcher::Start(void* multi, Transfer& transfer) const
+    {
+        const Item& item = *(transfer.Package);
+
+        transfer.File = item.Target + (transfer.Delta == true ? _T(".delta") : _T(".part"));
+        transfer.Received = 0;
+        transfer.Output = fopen(transfer.File.c_str(), "wb");
+        if (transfer.Output == nullptr) {
+            return false;
+        }
+
+        CURL* handle = curl_easy_init();
+        if (handle == nullptr) {
+            fclose(transfer.Output);
+            remove(transfer.File.c_str());
+            return false;
+        }
+
+        curl_easy_setopt(handle, CURLOPT_URL, (transfer.Delta == true ? item.DeltaUrl : item.Url).c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &PackageFetcher::Write);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer);
+        curl_easy_setopt(handle, CURLOPT_PRIVATE, &transfer);
+        curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+
+        if (curl_multi_add_handle(static_cast<CURLM*>(multi), handle) != CURLM_OK) {
+            curl_easy_cleanup(handle);
+            fclose(transfer.Output);
+            remove(transfer.File.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PackageFetcher::ApplyDelta(const Item& item, const string& delta) const
+    {
+        pid_t child = fork();
+
+        if (child == 0) {
+            execlp(_deltaTool.c_str(), _deltaTool.c_str(), "-d", "-f", "-s",
+                item.DeltaBase.c_str(), delta.c_str(), item.Target.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        int status = 0;
+        return ((child > 0) && (waitpid(child, &status, 0) == child) && (WIFEXITED(status)) && (WEXITSTATUS(status) == 0));
+    }
+
+    /* static */ size_t PackageFetcher::Write(char* data, size_t size, size_t count, void* userData)
+    {
+        Transfer* transfer = static_cast<Transfer*>(userData);
+        size_t written = fwrite(data, 1, size * count, transfer->Output);
+        transfer->Received += written;
+        return written;
+    }
+
+}  // namespace Plugin
+}  // namespace WPEFramework
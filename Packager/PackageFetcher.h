@@ -0,0 +1,79 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <functional>
+#include <vector>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Downloads a set of packages over parallel connections ahead of OPKG. Every package is verified
+    // as soon as its transfer completes, while the others are still downloading. A package with a
+    // delta against the installed version is reconstructed from the delta with an xdelta3 compatible
+    // tool and falls back to a full download if the delta is missing or the result does not verify.
+    class PackageFetcher {
+    public:
+        struct Item {
+            Item()
+                : Url()
+                , Target()
+                , DeltaUrl()
+                , DeltaBase()
+                , Size(0)
+                , Fetched(false)
+            {
+            }
+
+            string Url;         // Full package
+            string Target;      // Local file the package ends up in
+            string DeltaUrl;    // Delta against DeltaBase, empty if no delta should be tried
+            string DeltaBase;   // Copy of the installed package
+            uint64_t Size;      // Package size from the feed, only used for progress
+            bool Fetched;       // Set if Target holds the verified package
+        };
+
+        typedef std::function<bool(const Item&)> Verifier;
+        typedef std::function<void(uint8_t)> Progress;
+
+        PackageFetcher(const PackageFetcher&) = delete;
+        PackageFetcher& operator=(const PackageFetcher&) = delete;
+
+        PackageFetcher(const uint8_t parallel, const string& deltaTool);
+        ~PackageFetcher() = default;
+
+        // Items that could not be fetched are left with Fetched false, OPKG downloads them itself.
+        void Fetch(std::vector<Item>& items, const Verifier& verify, const Progress& progress);
+
+    private:
+        struct Transfer;
+
+        bool Start(void* multi, Transfer& transfer) const;
+        bool ApplyDelta(const Item& item, const string& delta) const;
+        static size_t Write(char* data, size_t size, size_t count, void* userData);
+
+        uint8_t _parallel;
+        string _deltaTool;
+    };
+
+}  // namespace Plugin
+}  // namespace WPEFramework
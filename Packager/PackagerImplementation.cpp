@@ -26,10 +26,21 @@
 #endif
 #include <opkg_download.h>
 #include <pkg.h>
+#include <pkg_hash.h>
+#include <file_util.h>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace WPEFramework {
 namespace Plugin {
 
+namespace {
+    // Part of the installation progress taken by the warmers, when there are any
+    constexpr uint8_t kWarmerProgress = 10;
+}
+
     SERVICE_REGISTRATION(PackagerImplementation, 1, 0);
 
     void PackagerImplementation::UpdateConfig() const {
@@ -102,12 +113,52 @@ namespace Plugin {
              _volatileCache = config.MakeCacheVolatile.Value();
          }
 
+        if (config.ParallelDownloads.IsSet() == true) {
+            _parallelDownloads = config.ParallelDownloads.Value();
+        }
+
+        if (config.DeltaUpdates.IsSet() == true) {
+            _deltaUpdates = config.DeltaUpdates.Value();
+        }
+
+        if ((config.DeltaTool.IsSet() == true) && (config.DeltaTool.Value().empty() == false)) {
+            _deltaTool = config.DeltaTool.Value();
+        }
+
+        if (config.Warmers.IsSet() == true) {
+            Core::JSON::ArrayType<Warmer>::Iterator index(config.Warmers.Elements());
+            while (index.Next() == true) {
+                if (index.Current().Command.Value().empty() == false) {
+                    _warmers.emplace_back(index.Current().Name.Value(), index.Current().Command.Value());
+                }
+            }
+        } else {
+            _warmers.emplace_back(_T("ldcache"), _T("ldconfig"));
+            _warmers.emplace_back(_T("fontcache"), _T("fc-cache"));
+        }
+
+        if (config.WarmerTimeout.IsSet() == true) {
+            _warmerTimeout = config.WarmerTimeout.Value();
+        }
+
+        if (config.Deduplicate.IsSet() == true) {
+            _deduplicate = config.Deduplicate.Value();
+        }
+
+        if ((config.DeduplicatePath.IsSet() == true) && (config.DeduplicatePath.Value().empty() == false)) {
+            _deduplicatePath = Core::Directory::Normalize(config.DeduplicatePath.Value());
+        } else {
+            _deduplicatePath = Core::Directory::Normalize(_cachePath) + _T("objects/");
+        }
+
         if (Core::File(_configFile).Exists() == false) {
             result = Core::ERROR_GENERAL;
         } else if (Core::Directory(_tempPath.c_str()).CreatePath() == false) {
             result = Core::ERROR_GENERAL;
         } else if (Core::Directory(_cachePath.c_str()).CreatePath() == false) {
             result = Core::ERROR_GENERAL;
+        } else if ((_deduplicate == true) && (Core::Directory(_deduplicatePath.c_str()).CreatePath() == false)) {
+            result = Core::ERROR_GENERAL;
         } else {
             /* See Install() for explanation why it's not done here.
             if (InitOPKG() == false) {
@@ -197,6 +248,13 @@ namespace Plugin {
     void PackagerImplementation::BlockingInstallUntilCompletionNoLock() {
         ASSERT(_inProgress.Install != nullptr && _inProgress.Package != nullptr);
 
+        std::vector<pkg*> packages;
+        std::vector<PackageFetcher::Item> items;
+        bool installed = false;
+
+        PrefetchNoLock(packages, items);
+        UnshareNoLock();
+
 #if defined (DO_NOT_USE_DEPRECATED_API)
         opkg_cmd_t* command = opkg_cmd_find("install");
         if (command) {
@@ -209,6 +267,9 @@ namespace Plugin {
             const char* argv[1];
             argv[0] = targetCopy.get();
             if (opkg_cmd_exec(command, 1, argv) == 0) {
+                installed = true;
+                DeduplicateNoLock();
+                RunWarmersNoLock();
                 _inProgress.Install->SetProgress(100);
                 _inProgress.Install->SetState(Exchange::IPackager::INSTALLED);
             } else {
@@ -244,8 +305,149 @@ namespace Plugin {
                             this) != 0) {
             _inProgress.Install->SetError(Core::ERROR_GENERAL);
             NotifyStateChange();
+        } else {
+            installed = true;
+            DeduplicateNoLock();
+            if (_warmers.empty() == false) {
+                RunWarmersNoLock();
+                CompleteInstallationNoLock();
+            }
         }
 #endif
+
+        ReleasePrefetchedNoLock(packages, items, installed);
+    }
+
+    // The package and every dependency that is not installed yet at the candidate version. These are
+    // the ones OPKG would download one after the other.
+    void PackagerImplementation::CollectPackagesNoLock(const char name[], std::set<string>& visited, std::vector<pkg*>& packages) const
+    {
+        if (visited.insert(name).second == true) {
+            pkg* candidate = pkg_hash_fetch_best_installation_candidate_by_name(name);
+
+            if (candidate != nullptr) {
+                pkg* installed = pkg_hash_fetch_installed_by_name(name);
+
+                if (((installed == nullptr) || (pkg_compare_versions(installed, candidate) < 0)) &&
+                    (candidate->local_filename == nullptr) && (candidate->src != nullptr) && (candidate->filename != nullptr)) {
+                    packages.push_back(candidate);
+                }
+
+                if (_noDeps == false) {
+                    for (int i = 0; i < (candidate->pre_depends_count + candidate->depends_count); i++) {
+                        const compound_depend_t& depend = candidate->depends[i];
+                        if (((depend.type == PREDEPEND) || (depend.type == DEPEND)) && (depend.possibility_count > 0)) {
+                            CollectPackagesNoLock(depend.possibilities[0]->pkg->name, visited, packages);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Downloads the packages of an installation in parallel before OPKG gets to them. OPKG skips the
+    // download of a package that already has a local file, so whatever could not be fetched here is still
+    // downloaded by OPKG as before.
+    void PackagerImplementation::PrefetchNoLock(std::vector<pkg*>& packages, std::vector<PackageFetcher::Item>& items)
+    {
+        if (_parallelDownloads != 0) {
+            std::set<string> visited;
+            CollectPackagesNoLock(_inProgress.Package->Name().c_str(), visited, packages);
+        }
+
+        if (packages.empty() == false) {
+            const string prefetchPath = Core::Directory::Normalize(_cachePath) + _T("prefetch/");
+            const string basePath = Core::Directory::Normalize(_cachePath) + _T("deltabase/");
+
+            Core::Directory(prefetchPath.c_str()).CreatePath();
+            if (_deltaUpdates == true) {
+                Core::Directory(basePath.c_str()).CreatePath();
+            }
+
+            items.resize(packages.size());
+            for (uint32_t index = 0; index < packages.size(); index++) {
+                const pkg* package = packages[index];
+                PackageFetcher::Item& item = items[index];
+                const char* file = strrchr(package->filename, '/');
+
+                item.Url = string(package->src->value) + '/' + package->filename;
+                item.Target = prefetchPath + (file != nullptr ? file + 1 : package->filename);
+                item.Size = package->size;
+
+                if (_deltaUpdates == true) {
+                    pkg* installed = pkg_hash_fetch_installed_by_name(package->name);
+                    if (installed != nullptr) {
+                        char* version = pkg_version_str_alloc(installed);
+                        item.DeltaUrl = item.Url + '.' + version + _T(".delta");
+                        item.DeltaBase = basePath + package->name + '_' + version + _T(".ipk");
+                        free(version);
+                    }
+                }
+            }
+
+            _inProgress.Install->SetState(Exchange::IPackager::DOWNLOADING);
+            NotifyStateChange();
+
+            PackageFetcher fetcher(_parallelDownloads, _deltaTool);
+            fetcher.Fetch(items,
+                [&packages, &items](const PackageFetcher::Item& item) -> bool {
+                    return VerifyPackage(packages[&item - items.data()], item.Target);
+                },
+                [this](const uint8_t percentage) {
+                    _inProgress.Install->SetProgress(percentage);
+                });
+
+            for (uint32_t index = 0; index < packages.size(); index++) {
+                if (items[index].Fetched == true) {
+                    packages[index]->local_filename = strdup(items[index].Target.c_str());
+                }
+            }
+        }
+    }
+
+    // With delta updates the packages that got installed are kept as the base for the next delta of that
+    // package, replacing the base of the version they updated.
+    void PackagerImplementation::ReleasePrefetchedNoLock(const std::vector<pkg*>& packages, const std::vector<PackageFetcher::Item>& items, const bool installed) const
+    {
+        const string basePath = Core::Directory::Normalize(_cachePath) + _T("deltabase/");
+
+        for (uint32_t index = 0; index < items.size(); index++) {
+            const PackageFetcher::Item& item = items[index];
+
+            if (item.Fetched == true) {
+                if ((installed == true) && (_deltaUpdates == true)) {
+                    char* version = pkg_version_str_alloc(packages[index]);
+                    if (item.DeltaBase.empty() == false) {
+                        remove(item.DeltaBase.c_str());
+                    }
+                    rename(item.Target.c_str(), (basePath + packages[index]->name + '_' + version + _T(".ipk")).c_str());
+                    free(version);
+                } else {
+                    remove(item.Target.c_str());
+                }
+            }
+        }
+    }
+
+    /* static */ bool PackagerImplementation::VerifyPackage(const pkg* package, const string& file)
+    {
+        const char* expected = package->md5sum;
+        char* actual = nullptr;
+
+#if defined(HAVE_SHA256)
+        if (package->sha256sum != nullptr) {
+            expected = package->sha256sum;
+            actual = file_sha256sum_alloc(file.c_str());
+        } else
+#endif
+        if (expected != nullptr) {
+            actual = file_md5sum_alloc(file.c_str());
+        }
+
+        bool result = (expected == nullptr) || ((actual != nullptr) && (strcmp(actual, expected) == 0));
+        free(actual);
+
+        return (result);
     }
 
 #if !defined (DO_NOT_USE_DEPRECATED_API)
@@ -253,7 +455,11 @@ namespace Plugin {
                                                                         void* data)
     {
         PackagerImplementation* self = static_cast<PackagerImplementation*>(data);
-        self->_inProgress.Install->SetProgress(progress->percentage);
+        if (self->_warmers.empty() == true) {
+            self->_inProgress.Install->SetProgress(progress->percentage);
+        } else {
+            self->_inProgress.Install->SetProgress(progress->percentage * (100 - kWarmerProgress) / 100);
+        }
         if (progress->action == OPKG_INSTALL &&
             self->_inProgress.Install->State() == Exchange::IPackager::DOWNLOADING) {
             self->_inProgress.Install->SetState(Exchange::IPackager::DOWNLOADED);
@@ -278,18 +484,162 @@ namespace Plugin {
         if (stateChanged == true)
             self->NotifyStateChange();
         if (progress->percentage == 100) {
-            self->_inProgress.Install->SetState(Exchange::IPackager::INSTALLED);
-            self->NotifyStateChange();
             self->_inProgress.Install->SetAppName(progress->pkg->local_filename);
-            string mfilename = self->GetMetadataFile(self->_inProgress.Install->AppName());
-            string callsign = self->GetCallsign(mfilename);
-            if(!callsign.empty()) {
-                self->DeactivatePlugin(callsign);
+            // With warmers the installation completes once they ran.
+            if (self->_warmers.empty() == true) {
+                self->CompleteInstallationNoLock();
             }
         }
     }
+
+    void PackagerImplementation::CompleteInstallationNoLock()
+    {
+        _inProgress.Install->SetProgress(100);
+        _inProgress.Install->SetState(Exchange::IPackager::INSTALLED);
+        NotifyStateChange();
+        string mfilename = GetMetadataFile(_inProgress.Install->AppName());
+        string callsign = GetCallsign(mfilename);
+        if(!callsign.empty()) {
+            DeactivatePlugin(callsign);
+        }
+    }
 #endif
 
+    // The installed files of the package and its dependencies. With upgradable only those of the packages
+    // the installation is going to upgrade.
+    void PackagerImplementation::InstalledFilesNoLock(const char name[], std::set<string>& visited, std::vector<string>& files, const bool upgradable) const
+    {
+        if (visited.insert(name).second == true) {
+            pkg* installed = pkg_hash_fetch_installed_by_name(name);
+            pkg* candidate = pkg_hash_fetch_best_installation_candidate_by_name(name);
+            pkg* package = (upgradable == true ? candidate : installed);
+
+            if ((installed != nullptr) && ((upgradable == false) || ((candidate != nullptr) && (pkg_compare_versions(installed, candidate) < 0)))) {
+                str_list_t* list = pkg_get_installed_files(installed);
+                if (list != nullptr) {
+                    for (str_list_elt_t* iter = str_list_first(list); iter != nullptr; iter = str_list_next(list, iter)) {
+                        files.emplace_back(static_cast<const char*>(iter->data));
+                    }
+                    pkg_free_installed_files(installed);
+                }
+            }
+
+            if ((package != nullptr) && (_noDeps == false)) {
+                for (int i = 0; i < (package->pre_depends_count + package->depends_count); i++) {
+                    const compound_depend_t& depend = package->depends[i];
+                    if (((depend.type == PREDEPEND) || (depend.type == DEPEND)) && (depend.possibility_count > 0)) {
+                        InstalledFilesNoLock(depend.possibilities[0]->pkg->name, visited, files, upgradable);
+                    }
+                }
+            }
+        }
+    }
+
+    // A shared file of a package that is upgraded gets a copy of its own, whatever OPKG writes to it
+    // then only changes that package.
+    void PackagerImplementation::UnshareNoLock() const
+    {
+        if (_deduplicate == true) {
+            std::set<string> visited;
+            std::vector<string> files;
+            InstalledFilesNoLock(_inProgress.Package->Name().c_str(), visited, files, true);
+
+            FileDeduplicator(_deduplicatePath, nullptr).Unshare(files);
+        }
+    }
+
+    // Links the files of the installed package to the ones in the store with the same content and drops
+    // the store objects no package uses any more, like the ones of the versions just upgraded.
+    void PackagerImplementation::DeduplicateNoLock() const
+    {
+        if (_deduplicate == true) {
+            std::set<string> visited;
+            std::vector<string> files;
+            InstalledFilesNoLock(_inProgress.Package->Name().c_str(), visited, files, false);
+
+            FileDeduplicator deduplicator(_deduplicatePath, [](const string& file) -> string {
+                string result;
+#if defined(HAVE_SHA256)
+                char* hash = file_sha256sum_alloc(file.c_str());
+#else
+                char* hash = file_md5sum_alloc(file.c_str());
+#endif
+                if (hash != nullptr) {
+                    result = hash;
+                    free(hash);
+                }
+                return (result);
+            });
+
+            const uint64_t saved = deduplicator.Deduplicate(files);
+            const uint32_t removed = deduplicator.Collect();
+
+            TRACE(Trace::Information, (_T("[RDM]: Deduplicated %s, %llu bytes shared, %u unused objects removed"),
+                _inProgress.Package->Name().c_str(), static_cast<unsigned long long>(saved), removed));
+        }
+    }
+
+    // Runs the configured warmers on the installed package, each one moving the progress on. They are
+    // best effort, a warmer that fails or times out does not fail the installation.
+    void PackagerImplementation::RunWarmersNoLock()
+    {
+        const string& name = _inProgress.Package->Name();
+        const pkg* installed = pkg_hash_fetch_installed_by_name(name.c_str());
+        const string root = ((installed != nullptr) && (installed->dest != nullptr) ? installed->dest->root_dir : _T("/"));
+        const uint8_t start = 100 - kWarmerProgress;
+
+        for (uint32_t index = 0; index < _warmers.size(); index++) {
+            const uint64_t began = Core::Time::Now().Ticks();
+            bool result = RunWarmer(_warmers[index].second, name, root, _warmerTimeout);
+            const uint32_t elapsed = static_cast<uint32_t>((Core::Time::Now().Ticks() - began) / Core::Time::TicksPerMillisecond);
+
+            if (result == true) {
+                TRACE(Trace::Information, (_T("[RDM]: Warmer %s for %s took %d ms"), _warmers[index].first.c_str(), name.c_str(), elapsed));
+            } else {
+                TRACE(Trace::Error, (_T("[RDM]: Warmer %s for %s failed after %d ms"), _warmers[index].first.c_str(), name.c_str(), elapsed));
+            }
+
+            _inProgress.Install->SetProgress(start + static_cast<uint8_t>((kWarmerProgress * (index + 1)) / _warmers.size()));
+            NotifyStateChange();
+        }
+    }
+
+    /* static */ bool PackagerImplementation::RunWarmer(const string& command, const string& name, const string& root, const uint16_t timeout)
+    {
+        pid_t child = fork();
+
+        if (child == 0) {
+            // Own process group, so a timeout also stops whatever the shell started
+            setpgid(0, 0);
+            setenv("PACKAGE_NAME", name.c_str(), 1);
+            setenv("PACKAGE_ROOT", root.c_str(), 1);
+            execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        bool result = false;
+
+        if (child > 0) {
+            int status = 0;
+            uint32_t waited = 0;
+            pid_t ended;
+
+            while (((ended = waitpid(child, &status, WNOHANG)) == 0) && (waited < (timeout * 1000u))) {
+                SleepMs(20);
+                waited += 20;
+            }
+
+            if (ended == 0) {
+                kill(-child, SIGKILL);
+                waitpid(child, &status, 0);
+            } else {
+                result = (ended == child) && (WIFEXITED(status)) && (WEXITSTATUS(status) == 0);
+            }
+        }
+
+        return (result);
+    }
+
     string PackagerImplementation::GetMetadataFile(const string& appName)
     {
         char *dnld_loc = opkg_config->cache_dir;
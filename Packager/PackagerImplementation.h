@@ -20,14 +20,19 @@
 #pragma once
 
 #include "Module.h"
+#include "FileDeduplicator.h"
+#include "PackageFetcher.h"
 #include <interfaces/IPackager.h>
 
 #include <list>
+#include <set>
 #include <string>
+#include <vector>
 
 // Forward declarations so we do not need to include the OPKG headers here.
 struct opkg_conf;
 struct _opkg_progress_data_t;
+struct pkg;
 
 namespace WPEFramework {
 namespace Plugin {
@@ -37,6 +42,42 @@ namespace Plugin {
         PackagerImplementation(const PackagerImplementation&) = delete;
         PackagerImplementation& operator=(const PackagerImplementation&) = delete;
 
+        class EXTERNAL Warmer : public Core::JSON::Container {
+        public:
+            Warmer()
+                : Core::JSON::Container()
+                , Name()
+                , Command()
+            {
+                Init();
+            }
+
+            Warmer(const Warmer& copy)
+                : Core::JSON::Container()
+                , Name(copy.Name)
+                , Command(copy.Command)
+            {
+                Init();
+            }
+
+            ~Warmer() override
+            {
+            }
+
+            Warmer& operator=(const Warmer&) = delete;
+
+        private:
+            void Init()
+            {
+                Add(_T("name"), &Name);
+                Add(_T("command"), &Command);
+            }
+
+        public:
+            Core::JSON::String Name;
+            Core::JSON::String Command;     // Run with /bin/sh, PACKAGE_NAME and PACKAGE_ROOT are set
+        };
+
         class EXTERNAL Config : public Core::JSON::Container {
         public:
             Config()
@@ -48,6 +89,13 @@ namespace Plugin {
                 , NoDeps()
                 , NoSignatureCheck()
                 , AlwaysUpdateFirst()
+                , ParallelDownloads()           // Packages downloaded at the same time ahead of OPKG, 0 leaves downloading to OPKG
+                , DeltaUpdates()                // Try <package url>.<installed version>.delta before the full package
+                , DeltaTool()                   // xdelta3 compatible tool to apply the deltas with
+                , Warmers()                     // Commands run after an installation, to move first launch costs to install time
+                , WarmerTimeout(60)             // Seconds a warmer may run before it is killed
+                , Deduplicate(false)            // Hardlink installed files with the same content, across packages
+                , DeduplicatePath()             // Store of the shared files, on the file system of the installed files
             {
                 Add(_T("config"), &ConfigFile);
                 Add(_T("temppath"), &TempDir);
@@ -57,6 +105,13 @@ namespace Plugin {
                 Add(_T("nodeps"), &NoDeps);
                 Add(_T("nosignaturecheck"), &NoSignatureCheck);
                 Add(_T("alwaysupdatefirst"), &AlwaysUpdateFirst);
+                Add(_T("paralleldownloads"), &ParallelDownloads);
+                Add(_T("deltaupdates"), &DeltaUpdates);
+                Add(_T("deltatool"), &DeltaTool);
+                Add(_T("warmers"), &Warmers);
+                Add(_T("warmertimeout"), &WarmerTimeout);
+                Add(_T("deduplicate"), &Deduplicate);
+                Add(_T("deduplicatepath"), &DeduplicatePath);
             }
 
             ~Config() override
@@ -74,6 +129,13 @@ namespace Plugin {
             Core::JSON::Boolean NoDeps;
             Core::JSON::Boolean NoSignatureCheck;
             Core::JSON::Boolean AlwaysUpdateFirst;
+            Core::JSON::DecUInt8 ParallelDownloads;
+            Core::JSON::Boolean DeltaUpdates;
+            Core::JSON::String  DeltaTool;
+            Core::JSON::ArrayType<Warmer> Warmers;
+            Core::JSON::DecUInt16 WarmerTimeout;
+            Core::JSON::Boolean Deduplicate;
+            Core::JSON::String  DeduplicatePath;
         };
 
         PackagerImplementation()
@@ -86,6 +148,13 @@ namespace Plugin {
             , _skipSignatureChecking(false)
             , _alwaysUpdateFirst(false)
             , _volatileCache(false)
+            , _parallelDownloads(4)
+            , _deltaUpdates(false)
+            , _deltaTool(_T("xdelta3"))
+            , _warmers()
+            , _warmerTimeout(60)
+            , _deduplicate(false)
+            , _deduplicatePath()
             , _opkgInitialized(false)
             , _worker(this)
             , _isUpgrade(false)
@@ -298,6 +367,16 @@ namespace Plugin {
         void NotifyStateChange();
         void NotifyRepoSynced(uint32_t status);
         void BlockingInstallUntilCompletionNoLock();
+        void CollectPackagesNoLock(const char name[], std::set<string>& visited, std::vector<pkg*>& packages) const;
+        void PrefetchNoLock(std::vector<pkg*>& packages, std::vector<PackageFetcher::Item>& items);
+        void ReleasePrefetchedNoLock(const std::vector<pkg*>& packages, const std::vector<PackageFetcher::Item>& items, const bool installed) const;
+        static bool VerifyPackage(const pkg* package, const string& file);
+        void InstalledFilesNoLock(const char name[], std::set<string>& visited, std::vector<string>& files, const bool upgradable) const;
+        void UnshareNoLock() const;
+        void DeduplicateNoLock() const;
+        void RunWarmersNoLock();
+        void CompleteInstallationNoLock();
+        static bool RunWarmer(const string& command, const string& name, const string& root, const uint16_t timeout);
         void BlockingSetupLocalRepoNoLock(RepoSyncMode mode);
         bool InitOPKG();
         void FreeOPKG();
@@ -311,6 +390,13 @@ namespace Plugin {
         bool _skipSignatureChecking;
         bool _alwaysUpdateFirst;
         bool _volatileCache;
+        uint8_t _parallelDownloads;
+        bool _deltaUpdates;
+        string _deltaTool;
+        std::vector<std::pair<string, string>> _warmers;
+        uint16_t _warmerTimeout;
+        bool _deduplicate;
+        string _deduplicatePath;
         bool _opkgInitialized;
         PluginHost::IShell* _servicePI;
         std::vector<Exchange::IPackager::INotification*> _notifications;
@@ -3,6 +3,8 @@
 #include <sqlite3.h>
 #include <glib.h>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #if defined(USE_PLABELS)
 #include "pbnj_utils.hpp"
@@ -14,6 +16,8 @@
 
 #define SQLITE *(sqlite3**)&mData
 #define SQLITE_IS_ERROR_DBWRITE(rc) (rc == SQLITE_READONLY || rc == SQLITE_CORRUPT)
+// ms between two incremental vacuum steps, so that a large freelist does not hold the lock
+#define MAINTENANCE_STEP_MS 100
 
 /**
  * from utils.h
@@ -50,6 +54,13 @@ const string WPEFramework::Plugin::PersistentStore::METHOD_GET_KEYS = "getKeys";
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_NAMESPACES = "getNamespaces";
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_STORAGE_SIZE = "getStorageSize";
 const string WPEFramework::Plugin::PersistentStore::METHOD_FLUSH_CACHE = "flushCache";
+const string WPEFramework::Plugin::PersistentStore::METHOD_SET_VALUES = "setValues";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_VALUES = "getValues";
+const string WPEFramework::Plugin::PersistentStore::METHOD_DELETE_KEYS = "deleteKeys";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_CACHE_STATS = "getCacheStats";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_DATABASE_STATS = "getDatabaseStats";
+const string WPEFramework::Plugin::PersistentStore::METHOD_SET_NAMESPACE_TTL = "setNamespaceTTL";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_NAMESPACE_TTL = "getNamespaceTTL";
 const string WPEFramework::Plugin::PersistentStore::EVT_ON_STORAGE_EXCEEDED = "onStorageExceeded";
 const char* WPEFramework::Plugin::PersistentStore::STORE_NAME = "rdkservicestore";
 const char* WPEFramework::Plugin::PersistentStore::STORE_KEY = "xyzzy123";
@@ -85,6 +96,22 @@ namespace {
     {
         return g_file_test(f, G_FILE_TEST_EXISTS);
     }
+
+    // namespace and key as the JSON-RPC methods take them, values only have the length limit
+    bool validName(const string& s)
+    {
+        return (!s.empty() && s.size() <= 1000);
+    }
+
+    // same as SQLite length() on TEXT: number of UTF-8 characters
+    int64_t textLength(const string& s)
+    {
+        int64_t result = 0;
+        for (auto it = s.begin(); it != s.end(); ++it)
+            if ((*it & 0xC0) != 0x80)
+                result++;
+        return result;
+    }
 }
 
 namespace WPEFramework {
@@ -94,7 +121,27 @@ namespace WPEFramework {
 
         PersistentStore::PersistentStore()
             : mData(nullptr)
+            , mStatements()
             , mReading(0)
+            , mSize(0)
+            , mWriteBehind(false)
+            , mBatchInterval(0)
+            , mBatchSize(0)
+            , mInTransaction(false)
+            , mPending(0)
+            , mCommitJob(*this)
+            , mWal(false)
+            , mIdleInterval(0)
+            , mVacuumPages(0)
+            , mDirty(false)
+            , mMaintenanceScheduled(false)
+            , mCheckpoints(0)
+            , mVacuumedPages(0)
+            , mMaintenanceJob(*this)
+            , mSweepInterval(0)
+            , mSweepBatch(0)
+            , mSweepScheduled(false)
+            , mSweepJob(*this)
         {
             Register<JsonObject,JsonObject>(METHOD_SET_VALUE, &PersistentStore::setValueWrapper, this);
             Register<JsonObject,JsonObject>(METHOD_GET_VALUE, &PersistentStore::getValueWrapper, this);
@@ -104,6 +151,13 @@ namespace WPEFramework {
             Register<JsonObject,JsonObject>(METHOD_GET_NAMESPACES, &PersistentStore::getNamespacesWrapper, this);
             Register<JsonObject,JsonObject>(METHOD_GET_STORAGE_SIZE, &PersistentStore::getStorageSizeWrapper, this);
             Register<JsonObject,JsonObject>(METHOD_FLUSH_CACHE, &PersistentStore::flushCacheWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_SET_VALUES, &PersistentStore::setValuesWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_GET_VALUES, &PersistentStore::getValuesWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_DELETE_KEYS, &PersistentStore::deleteKeysWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_GET_CACHE_STATS, &PersistentStore::getCacheStatsWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_GET_DATABASE_STATS, &PersistentStore::getDatabaseStatsWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_SET_NAMESPACE_TTL, &PersistentStore::setNamespaceTTLWrapper, this);
+            Register<JsonObject,JsonObject>(METHOD_GET_NAMESPACE_TTL, &PersistentStore::getNamespaceTTLWrapper, this);
         }
 
         PersistentStore::~PersistentStore()
@@ -116,15 +170,48 @@ namespace WPEFramework {
             Unregister(METHOD_GET_NAMESPACES);
             Unregister(METHOD_GET_STORAGE_SIZE);
             Unregister(METHOD_FLUSH_CACHE);
+            Unregister(METHOD_SET_VALUES);
+            Unregister(METHOD_GET_VALUES);
+            Unregister(METHOD_DELETE_KEYS);
+            Unregister(METHOD_GET_CACHE_STATS);
+            Unregister(METHOD_GET_DATABASE_STATS);
+            Unregister(METHOD_SET_NAMESPACE_TTL);
+            Unregister(METHOD_GET_NAMESPACE_TTL);
         }
 
-        const string PersistentStore::Initialize(PluginHost::IShell* /* service */)
+        const string PersistentStore::Initialize(PluginHost::IShell* service)
         {
+            Config config;
+            if (service)
+                config.FromString(service->ConfigLine());
+
+            mWriteBehind = config.WriteBehind.Value();
+            mBatchInterval = config.BatchInterval.Value();
+            mBatchSize = config.BatchSize.Value();
+            mCache.setCapacity(config.CacheSize.Value());
+            mWal = config.Wal.Value();
+            mIdleInterval = config.IdleInterval.Value();
+            mVacuumPages = config.VacuumPages.Value();
+            mSweepInterval = config.SweepInterval.Value();
+            mSweepBatch = config.SweepBatch.Value();
+
+            if (mWriteBehind)
+                LOGINFO("write-behind enabled, interval %u ms, size %u", mBatchInterval, mBatchSize);
+            if (mWal || mVacuumPages > 0)
+                LOGINFO("maintenance enabled, wal %d, idle %u ms, vacuum %u pages", mWal, mIdleInterval, mVacuumPages);
+
             return open() ? "" : "init failed";
         }
 
         void PersistentStore::Deinitialize(PluginHost::IShell* /* service */)
         {
+            mCommitJob.Revoke();
+            mMaintenanceJob.Revoke();
+            mSweepJob.Revoke();
+
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
             term();
         }
 
@@ -133,6 +220,106 @@ namespace WPEFramework {
             return(string("{\"service\": \"") + SERVICE_NAME + string("\"}"));
         }
 
+        // Exchange::IPersistentStore begin
+        uint32_t PersistentStore::SetValue(const string& ns, const string& key, const string& value)
+        {
+            if (!validName(ns) || !validName(key) || value.size() > 1000)
+                return Core::ERROR_BAD_REQUEST;
+
+            return (setValue(ns, key, value) ? Core::ERROR_NONE : Core::ERROR_GENERAL);
+        }
+
+        uint32_t PersistentStore::GetValue(const string& ns, const string& key, string& value)
+        {
+            if (!validName(ns) || !validName(key))
+                return Core::ERROR_BAD_REQUEST;
+
+            return (getValue(ns, key, value) ? Core::ERROR_NONE : Core::ERROR_UNKNOWN_KEY);
+        }
+
+        uint32_t PersistentStore::DeleteKey(const string& ns, const string& key)
+        {
+            if (!validName(ns) || !validName(key))
+                return Core::ERROR_BAD_REQUEST;
+
+            return (deleteKey(ns, key) ? Core::ERROR_NONE : Core::ERROR_GENERAL);
+        }
+
+        uint32_t PersistentStore::DeleteNamespace(const string& ns)
+        {
+            if (!validName(ns))
+                return Core::ERROR_BAD_REQUEST;
+
+            return (deleteNamespace(ns) ? Core::ERROR_NONE : Core::ERROR_GENERAL);
+        }
+
+        uint32_t PersistentStore::SetValues(const string& ns, const std::vector<string>& keys, const std::vector<string>& values)
+        {
+            if (!validName(ns) || keys.empty() || keys.size() != values.size())
+                return Core::ERROR_BAD_REQUEST;
+
+            vector<Item> items(keys.size());
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                if (!validName(keys[i]) || values[i].size() > 1000)
+                    return Core::ERROR_BAD_REQUEST;
+                items[i].ns = ns;
+                items[i].key = keys[i];
+                items[i].value = values[i];
+            }
+
+            return (setValues(items) ? Core::ERROR_NONE : Core::ERROR_GENERAL);
+        }
+
+        uint32_t PersistentStore::GetValues(const string& ns, const std::vector<string>& keys, std::vector<string>& found, std::vector<string>& values)
+        {
+            found.clear();
+            values.clear();
+
+            if (!validName(ns) || keys.empty())
+                return Core::ERROR_BAD_REQUEST;
+
+            vector<Item> items(keys.size());
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                if (!validName(keys[i]))
+                    return Core::ERROR_BAD_REQUEST;
+                items[i].ns = ns;
+                items[i].key = keys[i];
+            }
+
+            vector<Item> result;
+            if (!getValues(items, result))
+                return Core::ERROR_GENERAL;
+
+            found.reserve(result.size());
+            values.reserve(result.size());
+            for (auto it = result.begin(); it != result.end(); ++it)
+            {
+                found.push_back(it->key);
+                values.push_back(it->value);
+            }
+
+            return Core::ERROR_NONE;
+        }
+
+        uint32_t PersistentStore::DeleteKeys(const string& ns, const std::vector<string>& keys)
+        {
+            if (!validName(ns) || keys.empty())
+                return Core::ERROR_BAD_REQUEST;
+
+            vector<Item> items(keys.size());
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                if (!validName(keys[i]))
+                    return Core::ERROR_BAD_REQUEST;
+                items[i].ns = ns;
+                items[i].key = keys[i];
+            }
+
+            return (deleteKeys(items) ? Core::ERROR_NONE : Core::ERROR_GENERAL);
+        }
+
         // Registered methods (wrappers) begin
         uint32_t PersistentStore::setValueWrapper(const JsonObject& parameters, JsonObject& response)
         {
@@ -150,12 +337,15 @@ namespace WPEFramework {
                 string ns = parameters["namespace"].String();
                 string key = parameters["key"].String();
                 string value = parameters["value"].String();
+                int64_t ttl = parameters.HasLabel("ttl") ? parameters["ttl"].Number() : -1;
                 if (ns.empty() || key.empty())
                     response["error"] = "params empty";
                 else if (ns.size() > 1000 || key.size() > 1000 || value.size() > 1000)
                     response["error"] = "params too long";
+                else if (parameters.HasLabel("ttl") && ttl < 0)
+                    response["error"] = "params invalid";
                 else
-                    success = setValue(ns, key, value);
+                    success = setValue(ns, key, value, ttl);
             }
 
             returnResponse(success);
@@ -310,9 +500,86 @@ namespace WPEFramework {
             returnResponse(success);
         }
 
-        bool PersistentStore::setValue(const string& ns, const string& key, const string& value)
+        uint32_t PersistentStore::setValuesWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            vector<Item> items;
+            string error;
+            if (!parseItems(parameters, true, items, error))
+                response["error"] = error;
+            else
+                success = setValues(items);
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::getValuesWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            vector<Item> keys;
+            string error;
+            if (!parseItems(parameters, false, keys, error))
+                response["error"] = error;
+            else
+            {
+                vector<Item> values;
+                success = getValues(keys, values);
+                if (success)
+                {
+                    JsonArray jsonValues;
+                    for (auto it = values.begin(); it != values.end(); ++it)
+                    {
+                        JsonObject jsonValue;
+                        jsonValue["namespace"] = it->ns;
+                        jsonValue["key"] = it->key;
+                        jsonValue["value"] = it->value;
+                        jsonValues.Add(jsonValue);
+                    }
+                    response["values"] = jsonValues;
+                }
+            }
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::deleteKeysWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            vector<Item> keys;
+            string error;
+            if (!parseItems(parameters, false, keys, error))
+                response["error"] = error;
+            else
+                success = deleteKeys(keys);
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::getCacheStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            uint64_t hits, misses;
+            uint32_t size, capacity;
+            mCache.stats(hits, misses, size, capacity);
+
+            response["hits"] = hits;
+            response["misses"] = misses;
+            response["size"] = size;
+            response["capacity"] = capacity;
+
+            returnResponse(true);
+        }
+
+        uint32_t PersistentStore::getDatabaseStatsWrapper(const JsonObject& parameters, JsonObject& response)
         {
-            LOGINFO("%s %s %s", ns.c_str(), key.c_str(), value.c_str());
+            LOGINFOMETHOD();
 
             bool success = false;
 
@@ -321,108 +588,207 @@ namespace WPEFramework {
 
             sqlite3* &db = SQLITE;
 
-            int retry = 0;
-            int rc;
-            do
+            if (db)
             {
-                if (!db)
-                    break;
+                int64_t pageSize = pragma("PRAGMA page_size;");
+                int64_t pageCount = pragma("PRAGMA page_count;");
+                int64_t freePages = pragma("PRAGMA freelist_count;");
 
+                string journalMode;
                 sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT sum(s) FROM ("
-                                       " SELECT sum(length(key)+length(value)) s FROM item"
-                                       " UNION ALL"
-                                       " SELECT sum(length(name)) s FROM namespace"
-                                       ");", -1, &stmt, nullptr);
+                if (sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, nullptr) == SQLITE_OK)
+                {
+                    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0))
+                        journalMode = (const char*)sqlite3_column_text(stmt, 0);
+                    sqlite3_finalize(stmt);
+                }
 
-                rc = sqlite3_step(stmt);
-                if (rc == SQLITE_ROW)
+                int64_t walSize = 0;
+                const char* filename = sqlite3_db_filename(db, "main");
+                if (filename && *filename)
                 {
-                    int64_t size = sqlite3_column_int64(stmt, 0);
-                    if (size > MAX_SIZE_BYTES)
-                        LOGWARN("max size exceeded: %ld", size);
-                    else
-                        success = true;
+                    struct stat st;
+                    if (stat((string(filename) + "-wal").c_str(), &st) == 0)
+                        walSize = st.st_size;
+                }
+
+                if (pageSize >= 0 && pageCount >= 0 && freePages >= 0)
+                {
+                    response["fileSize"] = pageSize * pageCount;
+                    response["walSize"] = walSize;
+                    response["freeBytes"] = pageSize * freePages;
+                    response["liveBytes"] = mSize;
+                    response["journalMode"] = journalMode;
+                    response["checkpoints"] = mCheckpoints;
+                    response["vacuumedPages"] = mVacuumedPages;
+                    success = true;
                 }
+            }
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::setNamespaceTTLWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            if (!parameters.HasLabel("namespace") ||
+                !parameters.HasLabel("ttl"))
+            {
+                response["error"] = "params missing";
+            }
+            else
+            {
+                string ns = parameters["namespace"].String();
+                int64_t ttl = parameters["ttl"].Number();
+                if (ns.empty())
+                    response["error"] = "params empty";
+                else if (ns.size() > 1000)
+                    response["error"] = "params too long";
+                else if (ttl < 0)
+                    response["error"] = "params invalid";
                 else
-                    LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+                    success = setNamespaceTTL(ns, ttl);
+            }
 
-                sqlite3_finalize(stmt);
+            returnResponse(success);
+        }
 
-                if (success)
+        uint32_t PersistentStore::getNamespaceTTLWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            if (!parameters.HasLabel("namespace"))
+            {
+                response["error"] = "params missing";
+            }
+            else
+            {
+                string ns = parameters["namespace"].String();
+                if (ns.empty())
+                    response["error"] = "params empty";
+                else
                 {
-                    success = false;
+                    int64_t ttl = 0;
+                    success = getNamespaceTTL(ns, ttl);
+                    if (success)
+                        response["ttl"] = ttl;
+                }
+            }
 
-                    sqlite3_stmt *stmt;
-                    sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO namespace (name) values (?);", -1, &stmt, nullptr);
+            returnResponse(success);
+        }
 
-                    sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+        bool PersistentStore::parseItems(const JsonObject& parameters, bool withValue, std::vector<Item>& items, string& error)
+        {
+            items.clear();
 
-                    rc = sqlite3_step(stmt);
-                    if (rc != SQLITE_DONE)
-                        LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
-                    else
-                        success = true;
+            if (!parameters.HasLabel("items"))
+            {
+                error = "params missing";
+                return false;
+            }
 
-                    sqlite3_finalize(stmt);
+            JsonArray jsonItems = parameters["items"].Array();
+            if (jsonItems.Length() == 0)
+            {
+                error = "params empty";
+                return false;
+            }
+
+            for (int i = 0; i < jsonItems.Length(); i++)
+            {
+                JsonObject jsonItem = jsonItems[i].Object();
+                if (!jsonItem.HasLabel("namespace") ||
+                    !jsonItem.HasLabel("key") ||
+                    (withValue && !jsonItem.HasLabel("value")))
+                {
+                    error = "params missing";
+                    return false;
                 }
 
-                if (success)
+                Item item;
+                item.ns = jsonItem["namespace"].String();
+                item.key = jsonItem["key"].String();
+                if (withValue)
                 {
-                    success = false;
+                    item.value = jsonItem["value"].String();
+                    if (jsonItem.HasLabel("ttl"))
+                    {
+                        item.ttl = jsonItem["ttl"].Number();
+                        if (item.ttl < 0)
+                        {
+                            error = "params invalid";
+                            return false;
+                        }
+                    }
+                }
+
+                if (item.ns.empty() || item.key.empty())
+                {
+                    error = "params empty";
+                    return false;
+                }
+                if (item.ns.size() > 1000 || item.key.size() > 1000 || item.value.size() > 1000)
+                {
+                    error = "params too long";
+                    return false;
+                }
 
-                    sqlite3_stmt *stmt;
-                    sqlite3_prepare_v2(db, "INSERT INTO item (ns,key,value)"
-                                           " SELECT id, ?, ?"
-                                           " FROM namespace"
-                                           " WHERE name = ?"
-                                           ";", -1, &stmt, nullptr);
+                items.push_back(item);
+            }
 
-                    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
-                    sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
-                    sqlite3_bind_text(stmt, 3, ns.c_str(), -1, SQLITE_TRANSIENT);
+            return true;
+        }
 
-                    rc = sqlite3_step(stmt);
-                    if (rc != SQLITE_DONE)
-                        LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
-                    else
-                        success = true;
+        bool PersistentStore::setValue(const string& ns, const string& key, const string& value, int64_t ttl)
+        {
+            LOGINFO("%s %s %s %lld", ns.c_str(), key.c_str(), value.c_str(), (long long)ttl);
 
-                    sqlite3_finalize(stmt);
+            bool success = false;
+
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            int retry = 0;
+            int rc = SQLITE_OK;
+            do
+            {
+                if (!db)
+                    break;
+
+                beginBatch();
+
+                if (mSize > MAX_SIZE_BYTES)
+                    LOGWARN("max size exceeded: %ld", mSize);
+                else
+                {
+                    rc = insertItem(ns, key, value, ttl);
+                    success = (rc == SQLITE_DONE);
                 }
             } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
 
             if (success)
             {
-                success = false;
-
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT sum(s) FROM ("
-                                       " SELECT sum(length(key)+length(value)) s FROM item"
-                                       " UNION ALL"
-                                       " SELECT sum(length(name)) s FROM namespace"
-                                       ");", -1, &stmt, nullptr);
-
-                rc = sqlite3_step(stmt);
-                if (rc == SQLITE_ROW)
+                if (mSize > MAX_SIZE_BYTES)
                 {
-                    int64_t size = sqlite3_column_int64(stmt, 0);
-                    if (size > MAX_SIZE_BYTES)
-                    {
-                        LOGWARN("max size exceeded: %ld", size);
+                    success = false;
 
-                        JsonObject params;
-                        sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
-                    }
-                    else
-                        success = true;
-                }
-                else
-                    LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+                    LOGWARN("max size exceeded: %ld", mSize);
 
-                sqlite3_finalize(stmt);
+                    JsonObject params;
+                    sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
+                }
             }
 
+            endBatch(false);
+            touch();
+            scheduleSweep();
+
             return success;
         }
 
@@ -439,23 +805,34 @@ namespace WPEFramework {
 
             sqlite3* &db = SQLITE;
 
-            if (db)
+            int64_t now = time(nullptr);
+
+            if (db && mCache.get(ns, key, value, now))
+                success = true;
+            else if (db)
             {
+                // expired items are not found, whether they are swept yet or not
                 sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT value"
+                sqlite3_prepare_v2(db, "SELECT value, expiry"
                                        " FROM item"
                                        " INNER JOIN namespace ON namespace.id = item.ns"
                                        " where name = ? and key = ?"
+                                       " and (expiry is null or expiry > ?)"
                                        ";", -1, &stmt, nullptr);
 
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_int64(stmt, 3, now);
 
                 int rc = sqlite3_step(stmt);
                 if (rc == SQLITE_ROW)
                 {
                     value = (const char*)sqlite3_column_text(stmt, 0);
                     success = true;
+
+                    // must be cached before mReading is released, so a
+                    // writer can't invalidate the entry in between
+                    mCache.put(ns, key, value, sqlite3_column_int64(stmt, 1));
                 }
                 else
                     LOGWARN("not found: %d", rc);
@@ -485,24 +862,15 @@ namespace WPEFramework {
                 if (!db)
                     break;
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "DELETE FROM item"
-                                       " where ns in (select id from namespace where name = ?)"
-                                       " and key = ?"
-                                       ";", -1, &stmt, NULL);
-
-                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
-
-                rc = sqlite3_step(stmt);
-                if (rc != SQLITE_DONE)
-                    LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
-                else
-                    success = true;
+                beginBatch();
 
-                sqlite3_finalize(stmt);
+                rc = removeItem(ns, key);
+                success = (rc == SQLITE_DONE);
             } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
 
+            endBatch(false);
+            touch();
+
             return success;
         }
 
@@ -524,8 +892,11 @@ namespace WPEFramework {
                 if (!db)
                     break;
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "DELETE FROM namespace where name = ?;", -1, &stmt, NULL);
+                beginBatch();
+
+                mCache.removeNamespace(ns);
+
+                sqlite3_stmt *stmt = (sqlite3_stmt *)statement(STMT_DELETE_NAMESPACE);
 
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
 
@@ -533,11 +904,23 @@ namespace WPEFramework {
                 if (rc != SQLITE_DONE)
                     LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
                 else
+                {
                     success = true;
 
-                sqlite3_finalize(stmt);
+                    auto it = mNamespaceSizes.find(ns);
+                    if (it != mNamespaceSizes.end())
+                    {
+                        mSize -= it->second + textLength(ns);
+                        mNamespaceSizes.erase(it);
+                    }
+                }
+
+                sqlite3_reset(stmt);
             } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
 
+            endBatch(false);
+            touch();
+
             return success;
         }
 
@@ -562,9 +945,11 @@ namespace WPEFramework {
                 sqlite3_prepare_v2(db, "SELECT key"
                                        " FROM item"
                                        " where ns in (select id from namespace where name = ?)"
+                                       " and (expiry is null or expiry > ?)"
                                        ";", -1, &stmt, NULL);
 
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_int64(stmt, 2, time(nullptr));
 
                 while (sqlite3_step(stmt) == SQLITE_ROW)
                     keys.push_back((const char*)sqlite3_column_text(stmt, 0));
@@ -623,17 +1008,11 @@ namespace WPEFramework {
 
             if (db)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT name, sum(length(key)+length(value))"
-                                       " FROM item"
-                                       " INNER JOIN namespace ON namespace.id = item.ns"
-                                       " GROUP BY name"
-                                       ";", -1, &stmt, NULL);
+                // namespaces without items are not reported
+                for (auto it = mNamespaceSizes.begin(); it != mNamespaceSizes.end(); ++it)
+                    if (it->second > 0)
+                        namespaceSizes[it->first] = it->second;
 
-                while (sqlite3_step(stmt) == SQLITE_ROW)
-                    namespaceSizes[(const char*)sqlite3_column_text(stmt, 0)] = sqlite3_column_int(stmt, 1);
-
-                sqlite3_finalize(stmt);
                 success = true;
             }
 
@@ -650,6 +1029,8 @@ namespace WPEFramework {
             sqlite3* &db = SQLITE;
             bool success = false;
 
+            endBatch(true);
+
             if (db)
             {
                 int rc = sqlite3_db_cacheflush(db);
@@ -663,12 +1044,415 @@ namespace WPEFramework {
             return success;
         }
 
-        bool PersistentStore::open()
+        bool PersistentStore::setValues(const std::vector<Item>& items)
         {
-            bool result;
+            LOGINFO("%d items", (int)items.size());
 
-            auto path = g_build_filename("opt", "persistent", nullptr);
-            auto file = g_build_filename(path, STORE_NAME, nullptr);
+            bool success = false;
+
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            int retry = 0;
+            int rc = SQLITE_OK;
+            do
+            {
+                if (!db)
+                    break;
+
+                beginBatch();
+
+                if (mSize > MAX_SIZE_BYTES)
+                {
+                    LOGWARN("max size exceeded: %ld", mSize);
+                    break;
+                }
+
+                rc = exec("SAVEPOINT bulk;");
+                if (rc != SQLITE_OK)
+                    break;
+
+                success = true;
+                for (auto it = items.begin(); success && it != items.end(); ++it)
+                {
+                    rc = insertItem(it->ns, it->key, it->value, it->ttl);
+                    success = (rc == SQLITE_DONE);
+                }
+
+                if (success)
+                    exec("RELEASE bulk;");
+                else
+                {
+                    exec("ROLLBACK TO bulk;");
+                    exec("RELEASE bulk;");
+                    loadStorageSize();
+                }
+            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+
+            if (success)
+            {
+                if (mSize > MAX_SIZE_BYTES)
+                {
+                    success = false;
+
+                    LOGWARN("max size exceeded: %ld", mSize);
+
+                    JsonObject params;
+                    sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
+                }
+            }
+
+            endBatch(false);
+            touch();
+            scheduleSweep();
+
+            return success;
+        }
+
+        bool PersistentStore::getValues(const std::vector<Item>& keys, std::vector<Item>& values)
+        {
+            LOGINFO("%d keys", (int)keys.size());
+
+            bool success = false;
+
+            {
+                lock_guard<mutex> lck(mLock);
+                mReading++;
+            }
+
+            sqlite3* &db = SQLITE;
+
+            values.clear();
+
+            if (db)
+            {
+                int64_t now = time(nullptr);
+
+                sqlite3_stmt *stmt;
+                sqlite3_prepare_v2(db, "SELECT value, expiry"
+                                       " FROM item"
+                                       " INNER JOIN namespace ON namespace.id = item.ns"
+                                       " where name = ? and key = ?"
+                                       " and (expiry is null or expiry > ?)"
+                                       ";", -1, &stmt, nullptr);
+
+                for (auto it = keys.begin(); it != keys.end(); ++it)
+                {
+                    Item item = *it;
+                    if (mCache.get(it->ns, it->key, item.value, now))
+                    {
+                        values.push_back(item);
+                        continue;
+                    }
+
+                    sqlite3_bind_text(stmt, 1, it->ns.c_str(), -1, SQLITE_TRANSIENT);
+                    sqlite3_bind_text(stmt, 2, it->key.c_str(), -1, SQLITE_TRANSIENT);
+                    sqlite3_bind_int64(stmt, 3, now);
+
+                    int rc = sqlite3_step(stmt);
+                    if (rc == SQLITE_ROW)
+                    {
+                        item.value = (const char*)sqlite3_column_text(stmt, 0);
+                        values.push_back(item);
+                        mCache.put(item.ns, item.key, item.value, sqlite3_column_int64(stmt, 1));
+                    }
+                    else
+                        LOGWARN("not found: %s %s %d", it->ns.c_str(), it->key.c_str(), rc);
+
+                    sqlite3_reset(stmt);
+                }
+
+                sqlite3_finalize(stmt);
+                success = true;
+            }
+
+            mReading--;
+
+            return success;
+        }
+
+        bool PersistentStore::deleteKeys(const std::vector<Item>& keys)
+        {
+            LOGINFO("%d keys", (int)keys.size());
+
+            bool success = false;
+
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            int retry = 0;
+            int rc = SQLITE_OK;
+            do
+            {
+                if (!db)
+                    break;
+
+                beginBatch();
+
+                rc = exec("SAVEPOINT bulk;");
+                if (rc != SQLITE_OK)
+                    break;
+
+                success = true;
+                for (auto it = keys.begin(); success && it != keys.end(); ++it)
+                {
+                    rc = removeItem(it->ns, it->key);
+                    success = (rc == SQLITE_DONE);
+                }
+
+                if (success)
+                    exec("RELEASE bulk;");
+                else
+                {
+                    exec("ROLLBACK TO bulk;");
+                    exec("RELEASE bulk;");
+                    loadStorageSize();
+                }
+            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+
+            endBatch(false);
+            touch();
+
+            return success;
+        }
+
+        bool PersistentStore::setNamespaceTTL(const string& ns, int64_t ttl)
+        {
+            LOGINFO("%s %lld", ns.c_str(), (long long)ttl);
+
+            bool success = false;
+
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            int retry = 0;
+            int rc = SQLITE_OK;
+            do
+            {
+                if (!db)
+                    break;
+
+                beginBatch();
+
+                sqlite3_stmt *stmt = (sqlite3_stmt *)statement(STMT_INSERT_NAMESPACE);
+
+                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+                rc = sqlite3_step(stmt);
+                if (rc != SQLITE_DONE)
+                    LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
+
+                sqlite3_reset(stmt);
+
+                if (rc != SQLITE_DONE)
+                    continue;
+
+                if (mNamespaceSizes.find(ns) == mNamespaceSizes.end())
+                {
+                    mNamespaceSizes[ns] = 0;
+                    mSize += textLength(ns);
+                }
+
+                // applies to the items written from now on
+                sqlite3_prepare_v2(db, "UPDATE namespace SET ttl = ? WHERE name = ?;", -1, &stmt, nullptr);
+
+                if (ttl > 0)
+                    sqlite3_bind_int64(stmt, 1, ttl);
+                else
+                    sqlite3_bind_null(stmt, 1);
+                sqlite3_bind_text(stmt, 2, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+                rc = sqlite3_step(stmt);
+                if (rc != SQLITE_DONE)
+                    LOGERR("ERROR updating data: %s", sqlite3_errstr(rc));
+                else
+                    success = true;
+
+                sqlite3_finalize(stmt);
+            } while (!success && SQLITE_IS_ERROR_DBWRITE(rc) && (++retry < 2) && open());
+
+            endBatch(false);
+            touch();
+
+            return success;
+        }
+
+        bool PersistentStore::getNamespaceTTL(const string& ns, int64_t& ttl)
+        {
+            LOGINFO("%s", ns.c_str());
+
+            bool success = false;
+
+            {
+                lock_guard<mutex> lck(mLock);
+                mReading++;
+            }
+
+            sqlite3* &db = SQLITE;
+
+            ttl = 0;
+
+            if (db)
+            {
+                sqlite3_stmt *stmt;
+                sqlite3_prepare_v2(db, "SELECT ttl FROM namespace where name = ?;", -1, &stmt, nullptr);
+
+                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+                int rc = sqlite3_step(stmt);
+                if (rc == SQLITE_ROW)
+                    ttl = sqlite3_column_int64(stmt, 0);
+                success = (rc == SQLITE_ROW || rc == SQLITE_DONE);
+
+                sqlite3_finalize(stmt);
+            }
+
+            mReading--;
+
+            return success;
+        }
+
+        int PersistentStore::insertItem(const string& ns, const string& key, const string& value, int64_t ttl)
+        {
+            int64_t oldSize = 0;
+
+            // dropped rather than updated: the write may still be rolled back
+            mCache.remove(ns, key);
+
+            sqlite3_stmt *stmt = (sqlite3_stmt *)statement(STMT_ITEM_SIZE);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            int rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW)
+                oldSize = sqlite3_column_int64(stmt, 0);
+            else if (rc != SQLITE_DONE)
+                LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+
+            sqlite3_reset(stmt);
+
+            if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+                return rc;
+
+            stmt = (sqlite3_stmt *)statement(STMT_INSERT_NAMESPACE);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+                LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
+
+            sqlite3_reset(stmt);
+
+            if (rc != SQLITE_DONE)
+                return rc;
+
+            stmt = (sqlite3_stmt *)statement(STMT_INSERT_ITEM);
+
+            sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, ns.c_str(), -1, SQLITE_TRANSIENT);
+            if (ttl < 0)
+                sqlite3_bind_null(stmt, 4);
+            else
+                sqlite3_bind_int64(stmt, 4, ttl);
+            sqlite3_bind_int64(stmt, 5, time(nullptr));
+
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+                LOGERR("ERROR inserting data: %s", sqlite3_errstr(rc));
+            else
+            {
+                auto it = mNamespaceSizes.find(ns);
+                if (it == mNamespaceSizes.end())
+                {
+                    it = mNamespaceSizes.insert(std::make_pair(ns, (int64_t)0)).first;
+                    mSize += textLength(ns);
+                }
+                int64_t delta = textLength(key) + textLength(value) - oldSize;
+                it->second += delta;
+                mSize += delta;
+            }
+
+            sqlite3_reset(stmt);
+
+            return rc;
+        }
+
+        int PersistentStore::removeItem(const string& ns, const string& key)
+        {
+            sqlite3* &db = SQLITE;
+
+            int64_t oldSize = 0;
+
+            mCache.remove(ns, key);
+
+            sqlite3_stmt *stmt = (sqlite3_stmt *)statement(STMT_ITEM_SIZE);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            if (sqlite3_step(stmt) == SQLITE_ROW)
+                oldSize = sqlite3_column_int64(stmt, 0);
+
+            sqlite3_reset(stmt);
+
+            stmt = (sqlite3_stmt *)statement(STMT_DELETE_KEY);
+
+            sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+            int rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE)
+                LOGERR("ERROR removing data: %s", sqlite3_errstr(rc));
+            else
+            {
+                auto it = mNamespaceSizes.find(ns);
+                if (it != mNamespaceSizes.end() && sqlite3_changes(db) > 0)
+                {
+                    it->second -= oldSize;
+                    mSize -= oldSize;
+                }
+            }
+
+            sqlite3_reset(stmt);
+
+            return rc;
+        }
+
+        int PersistentStore::exec(const char* sql)
+        {
+            sqlite3* &db = SQLITE;
+
+            char *errmsg;
+            int rc = sqlite3_exec(db, sql, 0, 0, &errmsg);
+            if (rc != SQLITE_OK || errmsg)
+            {
+                if (errmsg)
+                {
+                    LOGERR("%d : %s", rc, errmsg);
+                    sqlite3_free(errmsg);
+                }
+                else
+                    LOGERR("%d", rc);
+            }
+
+            return rc;
+        }
+
+        bool PersistentStore::open()
+        {
+            bool result;
+
+            auto path = g_build_filename("opt", "persistent", nullptr);
+            auto file = g_build_filename(path, STORE_NAME, nullptr);
 
             sqlite3* &db = SQLITE;
 
@@ -692,6 +1476,10 @@ namespace WPEFramework {
         {
             sqlite3* &db = SQLITE;
 
+            endBatch(true);
+            finalizeStatements();
+            mCache.clear();
+
             if (db)
             {
                 int rc = sqlite3_db_cacheflush(db);
@@ -705,6 +1493,499 @@ namespace WPEFramework {
             db = nullptr;
         }
 
+        void* PersistentStore::statement(Statement id)
+        {
+            static const char* const sql[STMT_COUNT] = {
+                // STMT_ITEM_SIZE
+                "SELECT length(key)+length(value)"
+                " FROM item"
+                " INNER JOIN namespace ON namespace.id = item.ns"
+                " where name = ? and key = ?"
+                ";",
+                // STMT_INSERT_NAMESPACE
+                "INSERT OR IGNORE INTO namespace (name) values (?);",
+                // STMT_INSERT_ITEM
+                // expiry: now (?5) plus the ttl of the item (?4), or else of the namespace,
+                // none when that is 0
+                "INSERT INTO item (ns,key,value,expiry)"
+                " SELECT id, ?1, ?2, ?5 + nullif(coalesce(?4, ttl, 0), 0)"
+                " FROM namespace"
+                " WHERE name = ?3"
+                ";",
+                // STMT_DELETE_KEY
+                "DELETE FROM item"
+                " where ns in (select id from namespace where name = ?)"
+                " and key = ?"
+                ";",
+                // STMT_DELETE_NAMESPACE
+                "DELETE FROM namespace where name = ?;"
+            };
+
+            sqlite3* &db = SQLITE;
+            sqlite3_stmt* stmt = (sqlite3_stmt*)mStatements[id];
+
+            if (!stmt && db)
+            {
+                int rc = sqlite3_prepare_v2(db, sql[id], -1, &stmt, nullptr);
+                if (rc != SQLITE_OK)
+                {
+                    LOGERR("ERROR preparing statement %d: %s", id, sqlite3_errstr(rc));
+                    stmt = nullptr;
+                }
+                mStatements[id] = stmt;
+            }
+
+            return stmt;
+        }
+
+        void PersistentStore::finalizeStatements()
+        {
+            for (int i = 0; i < STMT_COUNT; i++)
+            {
+                if (mStatements[i])
+                {
+                    sqlite3_finalize((sqlite3_stmt*)mStatements[i]);
+                    mStatements[i] = nullptr;
+                }
+            }
+        }
+
+        bool PersistentStore::loadStorageSize()
+        {
+            sqlite3* &db = SQLITE;
+
+            mNamespaceSizes.clear();
+            mSize = 0;
+
+            if (!db)
+                return false;
+
+            sqlite3_stmt *stmt;
+            sqlite3_prepare_v2(db, "SELECT name, length(name),"
+                                   " (SELECT sum(length(key)+length(value)) FROM item WHERE ns = namespace.id)"
+                                   " FROM namespace"
+                                   ";", -1, &stmt, nullptr);
+
+            int rc;
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+            {
+                int64_t size = sqlite3_column_int64(stmt, 2);
+                mNamespaceSizes[(const char*)sqlite3_column_text(stmt, 0)] = size;
+                mSize += sqlite3_column_int64(stmt, 1) + size;
+            }
+
+            sqlite3_finalize(stmt);
+
+            if (rc != SQLITE_DONE)
+            {
+                LOGERR("ERROR getting size: %s", sqlite3_errstr(rc));
+                return false;
+            }
+
+            return true;
+        }
+
+        void PersistentStore::beginBatch()
+        {
+            sqlite3* &db = SQLITE;
+
+            if (!mWriteBehind || mInTransaction || !db)
+                return;
+
+            if (exec("BEGIN;") == SQLITE_OK)
+            {
+                mInTransaction = true;
+                mPending = 0;
+                mCommitJob.Schedule(Core::Time::Now().Add(mBatchInterval));
+            }
+        }
+
+        void PersistentStore::endBatch(bool force)
+        {
+            sqlite3* &db = SQLITE;
+
+            if (!mInTransaction)
+                return;
+
+            mPending++;
+            if (!force && mPending < mBatchSize)
+                return;
+
+            mInTransaction = false;
+            mPending = 0;
+
+            if (db)
+                exec("COMMIT;");
+        }
+
+        void PersistentStore::Dispatch()
+        {
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            endBatch(true);
+        }
+
+        int64_t PersistentStore::pragma(const char* sql)
+        {
+            sqlite3* &db = SQLITE;
+
+            int64_t result = -1;
+
+            sqlite3_stmt *stmt;
+            int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+            if (rc != SQLITE_OK)
+            {
+                LOGERR("ERROR preparing %s: %s", sql, sqlite3_errstr(rc));
+                return result;
+            }
+
+            rc = sqlite3_step(stmt);
+            if (rc == SQLITE_ROW)
+                result = sqlite3_column_int64(stmt, 0);
+            else
+                LOGERR("ERROR running %s: %s", sql, sqlite3_errstr(rc));
+
+            sqlite3_finalize(stmt);
+
+            return result;
+        }
+
+        void PersistentStore::setupJournal()
+        {
+            sqlite3* &db = SQLITE;
+
+            // auto_vacuum of a file that has tables only changes with a VACUUM,
+            // which is done once, the first time the store is opened with it
+            if (mVacuumPages > 0 && pragma("PRAGMA auto_vacuum;") != 2)
+            {
+                LOGINFO("switching to auto_vacuum=INCREMENTAL");
+                if (exec("PRAGMA auto_vacuum = INCREMENTAL;") == SQLITE_OK)
+                    vacuum();
+            }
+
+            if (mWal)
+            {
+                // readers of other connections no longer wait for a commit, and a commit
+                // is an append to the WAL. The WAL is checkpointed by maintain() when the
+                // store is idle, the default auto-checkpoint still bounds its size.
+                bool wal = false;
+                sqlite3_stmt *stmt;
+                if (sqlite3_prepare_v2(db, "PRAGMA journal_mode = WAL;", -1, &stmt, nullptr) == SQLITE_OK)
+                {
+                    wal = (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)
+                        && strcmp((const char*)sqlite3_column_text(stmt, 0), "wal") == 0);
+                    sqlite3_finalize(stmt);
+                }
+
+                if (!wal)
+                    LOGWARN("WAL journal mode is not available, keeping the rollback journal");
+                else
+                    exec("PRAGMA synchronous = NORMAL;");
+            }
+            else
+                exec("PRAGMA journal_mode = DELETE;"); // in case the WAL was switched off
+        }
+
+        void PersistentStore::touch()
+        {
+            mDirty = true;
+            mLastWrite = Core::Time::Now();
+
+            if ((mWal || mVacuumPages > 0) && !mMaintenanceScheduled)
+            {
+                mMaintenanceScheduled = true;
+                mMaintenanceJob.Schedule(Core::Time::Now().Add(mIdleInterval));
+            }
+        }
+
+        void PersistentStore::maintain()
+        {
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            mMaintenanceScheduled = false;
+
+            if (!db)
+                return;
+
+            // not idle yet, try again IdleInterval after the last write
+            Core::Time idle(mLastWrite);
+            idle.Add(mIdleInterval);
+            if (mInTransaction || idle > Core::Time::Now())
+            {
+                mMaintenanceScheduled = true;
+                mMaintenanceJob.Schedule(mInTransaction ? Core::Time::Now().Add(mIdleInterval) : idle);
+                return;
+            }
+
+            bool more = false;
+
+            if (mVacuumPages > 0)
+            {
+                int64_t before = pragma("PRAGMA freelist_count;");
+                if (before > 0)
+                {
+                    string sql = "PRAGMA incremental_vacuum(" + std::to_string(mVacuumPages) + ");";
+                    if (exec(sql.c_str()) == SQLITE_OK)
+                    {
+                        int64_t after = pragma("PRAGMA freelist_count;");
+                        if (after >= 0)
+                        {
+                            mVacuumedPages += before - after;
+                            more = (after > 0);
+                        }
+                        mDirty = true;
+                    }
+                }
+            }
+
+            if (mWal && mDirty)
+            {
+                // TRUNCATE also gives the space of the WAL file back
+                int log = 0, checkpointed = 0;
+                int rc = sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, &log, &checkpointed);
+                if (rc == SQLITE_OK)
+                {
+                    mCheckpoints++;
+                    mDirty = false;
+                }
+                else
+                {
+                    // SQLITE_BUSY: a reader of another process is on the WAL
+                    LOGWARN("checkpoint: %s, %d of %d frames", sqlite3_errstr(rc), checkpointed, log);
+                    more = true;
+                }
+            }
+            else
+                mDirty = false;
+
+            if (more)
+            {
+                mMaintenanceScheduled = true;
+                mMaintenanceJob.Schedule(Core::Time::Now().Add(MAINTENANCE_STEP_MS));
+            }
+        }
+
+        void PersistentStore::scheduleSweep()
+        {
+            sqlite3* &db = SQLITE;
+
+            if (mSweepScheduled || !db)
+                return;
+
+            sqlite3_stmt *stmt;
+            if (sqlite3_prepare_v2(db, "SELECT min(expiry) FROM item WHERE expiry IS NOT NULL;", -1, &stmt, nullptr) != SQLITE_OK)
+                return;
+
+            if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+            {
+                int64_t wait = (sqlite3_column_int64(stmt, 0) - time(nullptr)) * 1000;
+                if (wait < (int64_t)mSweepInterval)
+                    wait = mSweepInterval;
+
+                mSweepScheduled = true;
+                mSweepJob.Schedule(Core::Time::Now().Add((uint32_t)std::min<int64_t>(wait, UINT32_MAX)));
+            }
+
+            sqlite3_finalize(stmt);
+        }
+
+        void PersistentStore::sweep()
+        {
+            lock_guard<mutex> lck(mLock);
+            while (mReading > 0);
+
+            sqlite3* &db = SQLITE;
+
+            mSweepScheduled = false;
+
+            if (!db)
+                return;
+
+            std::vector<Item> expired;
+
+            sqlite3_stmt *stmt;
+            sqlite3_prepare_v2(db, "SELECT name, key"
+                                   " FROM item"
+                                   " INNER JOIN namespace ON namespace.id = item.ns"
+                                   " where expiry is not null and expiry <= ?"
+                                   " LIMIT ?"
+                                   ";", -1, &stmt, nullptr);
+
+            sqlite3_bind_int64(stmt, 1, time(nullptr));
+            sqlite3_bind_int(stmt, 2, mSweepBatch > 0 ? mSweepBatch : 1);
+
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                Item item;
+                item.ns = (const char*)sqlite3_column_text(stmt, 0);
+                item.key = (const char*)sqlite3_column_text(stmt, 1);
+                expired.push_back(item);
+            }
+
+            sqlite3_finalize(stmt);
+
+            if (!expired.empty())
+            {
+                LOGINFO("%d expired items", (int)expired.size());
+
+                beginBatch();
+
+                // removeItem keeps the size counters and the cache right
+                if (exec("SAVEPOINT sweep;") == SQLITE_OK)
+                {
+                    bool success = true;
+                    for (auto it = expired.begin(); success && it != expired.end(); ++it)
+                        success = (removeItem(it->ns, it->key) == SQLITE_DONE);
+
+                    if (success)
+                        exec("RELEASE sweep;");
+                    else
+                    {
+                        exec("ROLLBACK TO sweep;");
+                        exec("RELEASE sweep;");
+                        loadStorageSize();
+                    }
+                }
+
+                endBatch(false);
+                touch();
+            }
+
+            // a full batch: there are more, come back right away
+            if (expired.size() >= (size_t)(mSweepBatch > 0 ? mSweepBatch : 1))
+            {
+                mSweepScheduled = true;
+                mSweepJob.Schedule(Core::Time::Now().Add(MAINTENANCE_STEP_MS));
+            }
+            else
+                scheduleSweep();
+        }
+
+        PersistentStore::Cache::Cache()
+            : mCapacity(0)
+            , mHits(0)
+            , mMisses(0)
+        {
+        }
+
+        void PersistentStore::Cache::setCapacity(uint32_t capacity)
+        {
+            lock_guard<mutex> lck(mLock);
+
+            mCapacity = capacity;
+            while (mList.size() > mCapacity)
+            {
+                mIndex.erase(mList.back().first);
+                mList.pop_back();
+            }
+        }
+
+        bool PersistentStore::Cache::get(const string& ns, const string& key, string& value, int64_t now)
+        {
+            lock_guard<mutex> lck(mLock);
+
+            if (mCapacity == 0)
+                return false;
+
+            auto it = mIndex.find(Key(ns, key));
+            if (it != mIndex.end() && it->second->second.expiry != 0 && it->second->second.expiry <= now)
+            {
+                mList.erase(it->second);
+                mIndex.erase(it);
+                it = mIndex.end();
+            }
+            if (it == mIndex.end())
+            {
+                mMisses++;
+                return false;
+            }
+
+            mHits++;
+            mList.splice(mList.begin(), mList, it->second);
+            value = it->second->second.data;
+            return true;
+        }
+
+        void PersistentStore::Cache::put(const string& ns, const string& key, const string& value, int64_t expiry)
+        {
+            lock_guard<mutex> lck(mLock);
+
+            if (mCapacity == 0)
+                return;
+
+            Key k(ns, key);
+            auto it = mIndex.find(k);
+            if (it != mIndex.end())
+            {
+                it->second->second.data = value;
+                it->second->second.expiry = expiry;
+                mList.splice(mList.begin(), mList, it->second);
+                return;
+            }
+
+            if (mList.size() >= mCapacity)
+            {
+                mIndex.erase(mList.back().first);
+                mList.pop_back();
+            }
+
+            Value v;
+            v.data = value;
+            v.expiry = expiry;
+            mList.push_front(std::make_pair(k, v));
+            mIndex[k] = mList.begin();
+        }
+
+        void PersistentStore::Cache::remove(const string& ns, const string& key)
+        {
+            lock_guard<mutex> lck(mLock);
+
+            auto it = mIndex.find(Key(ns, key));
+            if (it != mIndex.end())
+            {
+                mList.erase(it->second);
+                mIndex.erase(it);
+            }
+        }
+
+        void PersistentStore::Cache::removeNamespace(const string& ns)
+        {
+            lock_guard<mutex> lck(mLock);
+
+            for (auto it = mList.begin(); it != mList.end();)
+            {
+                if (it->first.first == ns)
+                {
+                    mIndex.erase(it->first);
+                    it = mList.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        void PersistentStore::Cache::clear()
+        {
+            lock_guard<mutex> lck(mLock);
+
+            mList.clear();
+            mIndex.clear();
+        }
+
+        void PersistentStore::Cache::stats(uint64_t& hits, uint64_t& misses, uint32_t& size, uint32_t& capacity)
+        {
+            lock_guard<mutex> lck(mLock);
+
+            hits = mHits;
+            misses = mMisses;
+            size = mList.size();
+            capacity = mCapacity;
+        }
+
         void PersistentStore::vacuum()
         {
             sqlite3* &db = SQLITE;
@@ -726,6 +2007,24 @@ namespace WPEFramework {
             }
         }
 
+        bool PersistentStore::hasColumn(const char* table, const char* column)
+        {
+            sqlite3* &db = SQLITE;
+
+            bool result = false;
+
+            sqlite3_stmt *stmt;
+            string sql = string("PRAGMA table_info(") + table + ");";
+            if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK)
+            {
+                while (!result && sqlite3_step(stmt) == SQLITE_ROW)
+                    result = (strcmp((const char*)sqlite3_column_text(stmt, 1), column) == 0);
+                sqlite3_finalize(stmt);
+            }
+
+            return result;
+        }
+
         bool PersistentStore::init(const char* filename, const char* key)
         {
             sqlite3* &db = SQLITE;
@@ -796,7 +2095,8 @@ namespace WPEFramework {
             char *errmsg;
             rc = sqlite3_exec(db, "CREATE TABLE if not exists namespace ("
                                   "id INTEGER PRIMARY KEY,"
-                                  "name TEXT UNIQUE"
+                                  "name TEXT UNIQUE,"
+                                  "ttl INTEGER"
                                   ");", 0, 0, &errmsg);
             if (rc != SQLITE_OK || errmsg)
             {
@@ -838,6 +2138,7 @@ namespace WPEFramework {
                                   "ns INTEGER,"
                                   "key TEXT,"
                                   "value TEXT,"
+                                  "expiry INTEGER,"
                                   "FOREIGN KEY(ns) REFERENCES namespace(id) ON DELETE CASCADE ON UPDATE NO ACTION,"
                                   "UNIQUE(ns,key) ON CONFLICT REPLACE"
                                   ");", 0, 0, &errmsg);
@@ -864,6 +2165,19 @@ namespace WPEFramework {
                     LOGERR("%d", rc);
             }
 
+            // stores created before the TTL support
+            if (!hasColumn("namespace", "ttl"))
+                exec("ALTER TABLE namespace ADD COLUMN ttl INTEGER;");
+            if (!hasColumn("item", "expiry"))
+                exec("ALTER TABLE item ADD COLUMN expiry INTEGER;");
+            exec("CREATE INDEX if not exists item_expiry ON item (expiry) WHERE expiry IS NOT NULL;");
+
+            setupJournal();
+
+            loadStorageSize();
+
+            scheduleSweep();
+
             return true;
         }
     } // namespace Plugin
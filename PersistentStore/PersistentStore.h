@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Module.h"
+#include "IPersistentStore.h"
 
 #include <vector>
 #include <map>
+#include <list>
 #include <mutex>
 #include <atomic>
 
@@ -11,7 +13,128 @@ namespace WPEFramework {
 
     namespace Plugin {
 
-        class PersistentStore : public PluginHost::IPlugin, public PluginHost::JSONRPC {
+        class PersistentStore : public PluginHost::IPlugin, public PluginHost::JSONRPC, public Exchange::IPersistentStore {
+        public:
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : WriteBehind(false)
+                    , BatchInterval(500)
+                    , BatchSize(64)
+                    , CacheSize(128)
+                    , Wal(false)
+                    , IdleInterval(5000)
+                    , VacuumPages(128)
+                    , SweepInterval(60000)
+                    , SweepBatch(32)
+                {
+                    Add(_T("writebehind"), &WriteBehind);
+                    Add(_T("batchinterval"), &BatchInterval);
+                    Add(_T("batchsize"), &BatchSize);
+                    Add(_T("cachesize"), &CacheSize);
+                    Add(_T("wal"), &Wal);
+                    Add(_T("idleinterval"), &IdleInterval);
+                    Add(_T("vacuumpages"), &VacuumPages);
+                    Add(_T("sweepinterval"), &SweepInterval);
+                    Add(_T("sweepbatch"), &SweepBatch);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::Boolean WriteBehind;
+                Core::JSON::DecUInt32 BatchInterval;
+                Core::JSON::DecUInt16 BatchSize;
+                Core::JSON::DecUInt32 CacheSize;
+                Core::JSON::Boolean Wal;
+                Core::JSON::DecUInt32 IdleInterval;
+                Core::JSON::DecUInt32 VacuumPages;
+                Core::JSON::DecUInt32 SweepInterval;
+                Core::JSON::DecUInt16 SweepBatch;
+            };
+
+            // bounded LRU of (namespace, key) -> value, shared by concurrent readers
+            class Cache {
+            private:
+                Cache(const Cache&) = delete;
+                Cache& operator=(const Cache&) = delete;
+
+            public:
+                Cache();
+
+                void setCapacity(uint32_t capacity);
+                // expiry in seconds since the epoch, 0 if the entry does not expire
+                bool get(const string& ns, const string& key, string& value, int64_t now);
+                void put(const string& ns, const string& key, const string& value, int64_t expiry);
+                void remove(const string& ns, const string& key);
+                void removeNamespace(const string& ns);
+                void clear();
+                void stats(uint64_t& hits, uint64_t& misses, uint32_t& size, uint32_t& capacity);
+
+            private:
+                typedef std::pair<string, string> Key;
+                struct Value {
+                    string data;
+                    int64_t expiry;
+                };
+                typedef std::list<std::pair<Key, Value>> List;
+
+                std::mutex mLock;
+                List mList;
+                std::map<Key, List::iterator> mIndex;
+                uint32_t mCapacity;
+                uint64_t mHits;
+                uint64_t mMisses;
+            };
+
+            // runs the WAL checkpoint and the incremental vacuum once the
+            // store has seen no write for IdleInterval ms
+            class Maintenance {
+            private:
+                Maintenance(const Maintenance&) = delete;
+                Maintenance& operator=(const Maintenance&) = delete;
+
+            public:
+                Maintenance(PersistentStore& parent)
+                    : mParent(parent)
+                {
+                }
+
+                void Dispatch()
+                {
+                    mParent.maintain();
+                }
+
+            private:
+                PersistentStore& mParent;
+            };
+
+            // deletes expired items, SweepBatch at a time
+            class Sweeper {
+            private:
+                Sweeper(const Sweeper&) = delete;
+                Sweeper& operator=(const Sweeper&) = delete;
+
+            public:
+                Sweeper(PersistentStore& parent)
+                    : mParent(parent)
+                {
+                }
+
+                void Dispatch()
+                {
+                    mParent.sweep();
+                }
+
+            private:
+                PersistentStore& mParent;
+            };
+
         private:
             PersistentStore(const PersistentStore&) = delete;
             PersistentStore& operator=(const PersistentStore&) = delete;
@@ -23,6 +146,7 @@ namespace WPEFramework {
             // Build QueryInterface implementation, specifying all possible interfaces to be returned.
             BEGIN_INTERFACE_MAP(PersistentStore)
             INTERFACE_ENTRY(PluginHost::IPlugin)
+            INTERFACE_ENTRY(Exchange::IPersistentStore)
             END_INTERFACE_MAP
 
         public:
@@ -32,6 +156,16 @@ namespace WPEFramework {
             virtual void Deinitialize(PluginHost::IShell* service) override;
             virtual string Information() const override;
 
+            //   Exchange::IPersistentStore methods, the namespace and keys are checked as for JSON-RPC
+            // -------------------------------------------------------------------------------------------------------
+            uint32_t SetValue(const string& ns, const string& key, const string& value) override;
+            uint32_t GetValue(const string& ns, const string& key, string& value) override;
+            uint32_t DeleteKey(const string& ns, const string& key) override;
+            uint32_t DeleteNamespace(const string& ns) override;
+            uint32_t SetValues(const string& ns, const std::vector<string>& keys, const std::vector<string>& values) override;
+            uint32_t GetValues(const string& ns, const std::vector<string>& keys, std::vector<string>& found, std::vector<string>& values) override;
+            uint32_t DeleteKeys(const string& ns, const std::vector<string>& keys) override;
+
         private/*constants*/:
             static const short API_VERSION_NUMBER_MAJOR;
             static const short API_VERSION_NUMBER_MINOR;
@@ -45,6 +179,13 @@ namespace WPEFramework {
             static const string METHOD_GET_NAMESPACES;
             static const string METHOD_GET_STORAGE_SIZE;
             static const string METHOD_FLUSH_CACHE;
+            static const string METHOD_SET_VALUES;
+            static const string METHOD_GET_VALUES;
+            static const string METHOD_DELETE_KEYS;
+            static const string METHOD_GET_CACHE_STATS;
+            static const string METHOD_GET_DATABASE_STATS;
+            static const string METHOD_SET_NAMESPACE_TTL;
+            static const string METHOD_GET_NAMESPACE_TTL;
             //events
             static const string EVT_ON_STORAGE_EXCEEDED;
             //other
@@ -62,9 +203,23 @@ namespace WPEFramework {
             uint32_t getNamespacesWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getStorageSizeWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t flushCacheWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setValuesWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getValuesWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t deleteKeysWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getCacheStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getDatabaseStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setNamespaceTTLWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getNamespaceTTLWrapper(const JsonObject& parameters, JsonObject& response);
 
         private/*internal methods*/:
-            bool setValue(const string& ns, const string& key, const string& value);
+            struct Item {
+                string ns;
+                string key;
+                string value;
+                int64_t ttl = -1; // s, -1 for the default of the namespace, 0 for none
+            };
+
+            bool setValue(const string& ns, const string& key, const string& value, int64_t ttl = -1);
             bool getValue(const string& ns, const string& key, string& value);
             bool deleteKey(const string& ns, const string& key);
             bool deleteNamespace(const string& ns);
@@ -72,16 +227,87 @@ namespace WPEFramework {
             bool getNamespaces(std::vector<string>& namespaces);
             bool getStorageSize(std::map<string, uint64_t>& namespaceSizes);
             bool flushCache();
+            bool setValues(const std::vector<Item>& items);
+            bool getValues(const std::vector<Item>& keys, std::vector<Item>& values);
+            bool deleteKeys(const std::vector<Item>& keys);
+            bool setNamespaceTTL(const string& ns, int64_t ttl);
+            bool getNamespaceTTL(const string& ns, int64_t& ttl);
+
+            bool parseItems(const JsonObject& parameters, bool withValue, std::vector<Item>& items, string& error);
+            int insertItem(const string& ns, const string& key, const string& value, int64_t ttl);
+            int removeItem(const string& ns, const string& key);
+            int exec(const char* sql);
 
             bool open();
             void term();
             void vacuum();
             bool init(const char* filename, const char* key = nullptr);
+            bool hasColumn(const char* table, const char* column);
+
+            // statements used on the write path, prepared once per connection
+            // and only ever stepped with mLock held
+            enum Statement {
+                STMT_ITEM_SIZE = 0,
+                STMT_INSERT_NAMESPACE,
+                STMT_INSERT_ITEM,
+                STMT_DELETE_KEY,
+                STMT_DELETE_NAMESPACE,
+                STMT_COUNT
+            };
+            void* statement(Statement id);
+            void finalizeStatements();
+
+            // running byte counters, loaded once per connection and kept
+            // up to date by the write path
+            bool loadStorageSize();
+
+            // write-behind: writes are grouped into one transaction which is
+            // committed after BatchSize writes, BatchInterval ms or flushCache
+            void beginBatch();
+            void endBatch(bool force);
+
+            friend Core::ThreadPool::JobType<PersistentStore&>;
+            void Dispatch();
+
+            // maintenance: WAL checkpoint and auto_vacuum=INCREMENTAL steps,
+            // run in the background when writes stopped for IdleInterval ms
+            void setupJournal();
+            void touch();
+            void maintain();
+            int64_t pragma(const char* sql);
+
+            // TTL: items past their expiry are hidden from the reads right away
+            // and deleted by sweep(), no earlier than SweepInterval ms apart
+            void scheduleSweep();
+            void sweep();
 
         private:
             void* mData;
+            void* mStatements[STMT_COUNT];
             std::mutex mLock;
             std::atomic<int> mReading;
+            std::map<string, int64_t> mNamespaceSizes;
+            int64_t mSize;
+            Cache mCache;
+            bool mWriteBehind;
+            uint32_t mBatchInterval;
+            uint16_t mBatchSize;
+            bool mInTransaction;
+            uint16_t mPending;
+            Core::WorkerPool::JobType<PersistentStore&> mCommitJob;
+            bool mWal;
+            uint32_t mIdleInterval;
+            uint32_t mVacuumPages;
+            bool mDirty;
+            bool mMaintenanceScheduled;
+            Core::Time mLastWrite;
+            uint64_t mCheckpoints;
+            uint64_t mVacuumedPages;
+            Core::WorkerPool::JobType<Maintenance> mMaintenanceJob;
+            uint32_t mSweepInterval;
+            uint16_t mSweepBatch;
+            bool mSweepScheduled;
+            Core::WorkerPool::JobType<Sweeper> mSweepJob;
         };
     } // namespace Plugin
 } // namespace WPEFramework
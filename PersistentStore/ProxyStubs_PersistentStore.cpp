@@ -0,0 +1,403 @@
+//
+// implements RPC proxy stubs for:
+//   - class IPersistentStore
+//
+// A string list goes as its count, uint16_t, then the strings.
+//
+
+#include "IPersistentStore.h"
+#include "Module.h"
+
+namespace WPEFramework {
+
+namespace ProxyStubs {
+
+    using namespace Exchange;
+
+    namespace {
+
+        void writeList(RPC::Data::Frame::Writer& writer, const std::vector<string>& list)
+        {
+            writer.Number<uint16_t>(static_cast<uint16_t>(list.size()));
+            for (auto it = list.begin(); it != list.end(); ++it)
+                writer.Text(*it);
+        }
+
+        void readList(RPC::Data::Frame::Reader& reader, std::vector<string>& list)
+        {
+            uint16_t count = reader.Number<uint16_t>();
+            list.clear();
+            list.reserve(count);
+            for (uint16_t i = 0; i < count; i++)
+                list.push_back(reader.Text());
+        }
+
+    } // namespace
+
+    // -----------------------------------------------------------------
+    // STUB
+    // -----------------------------------------------------------------
+
+    //
+    // IPersistentStore interface stub definitions
+    //
+    // Methods:
+    //  (0) virtual uint32_t SetValue(const string&, const string&, const string&) = 0
+    //  (1) virtual uint32_t GetValue(const string&, const string&, string& /* @out */) = 0
+    //  (2) virtual uint32_t DeleteKey(const string&, const string&) = 0
+    //  (3) virtual uint32_t DeleteNamespace(const string&) = 0
+    //  (4) virtual uint32_t SetValues(const string&, const std::vector<string>&, const std::vector<string>&) = 0
+    //  (5) virtual uint32_t GetValues(const string&, const std::vector<string>&, std::vector<string>& /* @out */, std::vector<string>& /* @out */) = 0
+    //  (6) virtual uint32_t DeleteKeys(const string&, const std::vector<string>&) = 0
+    //
+
+    ProxyStub::MethodHandler PersistentStoreStubMethods[] = {
+        // virtual uint32_t SetValue(const string&, const string&, const string&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            const string param1 = reader.Text();
+            const string param2 = reader.Text();
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->SetValue(param0, param1, param2);
+
+            // write return value
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+        },
+
+        // virtual uint32_t GetValue(const string&, const string&, string&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            const string param1 = reader.Text();
+            string param2{}; // storage
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->GetValue(param0, param1, param2);
+
+            // write return values
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+            writer.Text(param2);
+        },
+
+        // virtual uint32_t DeleteKey(const string&, const string&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            const string param1 = reader.Text();
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->DeleteKey(param0, param1);
+
+            // write return value
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+        },
+
+        // virtual uint32_t DeleteNamespace(const string&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->DeleteNamespace(param0);
+
+            // write return value
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+        },
+
+        // virtual uint32_t SetValues(const string&, const std::vector<string>&, const std::vector<string>&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            std::vector<string> param1;
+            std::vector<string> param2;
+            readList(reader, param1);
+            readList(reader, param2);
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->SetValues(param0, param1, param2);
+
+            // write return value
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+        },
+
+        // virtual uint32_t GetValues(const string&, const std::vector<string>&, std::vector<string>&, std::vector<string>&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            std::vector<string> param1;
+            readList(reader, param1);
+            std::vector<string> param2; // storage
+            std::vector<string> param3; // storage
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->GetValues(param0, param1, param2, param3);
+
+            // write return values
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+            writeList(writer, param2);
+            writeList(writer, param3);
+        },
+
+        // virtual uint32_t DeleteKeys(const string&, const std::vector<string>&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            std::vector<string> param1;
+            readList(reader, param1);
+
+            // call implementation
+            IPersistentStore* implementation = reinterpret_cast<IPersistentStore*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IPersistentStore implementation pointer");
+            const uint32_t output = implementation->DeleteKeys(param0, param1);
+
+            // write return value
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+        },
+
+        nullptr
+    }; // PersistentStoreStubMethods[]
+
+    // -----------------------------------------------------------------
+    // PROXY
+    // -----------------------------------------------------------------
+
+    //
+    // IPersistentStore interface proxy definitions
+    //
+    // Methods:
+    //  (0) virtual uint32_t SetValue(const string&, const string&, const string&) = 0
+    //  (1) virtual uint32_t GetValue(const string&, const string&, string& /* @out */) = 0
+    //  (2) virtual uint32_t DeleteKey(const string&, const string&) = 0
+    //  (3) virtual uint32_t DeleteNamespace(const string&) = 0
+    //  (4) virtual uint32_t SetValues(const string&, const std::vector<string>&, const std::vector<string>&) = 0
+    //  (5) virtual uint32_t GetValues(const string&, const std::vector<string>&, std::vector<string>& /* @out */, std::vector<string>& /* @out */) = 0
+    //  (6) virtual uint32_t DeleteKeys(const string&, const std::vector<string>&) = 0
+    //
+
+    class PersistentStoreProxy final : public ProxyStub::UnknownProxyType<IPersistentStore> {
+    public:
+        PersistentStoreProxy(const Core::ProxyType<Core::IPCChannel>& channel, RPC::instance_id implementation, const bool otherSideInformed)
+            : BaseClass(channel, implementation, otherSideInformed)
+        {
+        }
+
+        uint32_t SetValue(const string& param0, const string& param1, const string& param2) override
+        {
+            IPCMessage newMessage(BaseClass::Message(0));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+            writer.Text(param1);
+            writer.Text(param2);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return value
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+            }
+
+            return output;
+        }
+
+        uint32_t GetValue(const string& param0, const string& param1, string& /* out */ param2) override
+        {
+            IPCMessage newMessage(BaseClass::Message(1));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+            writer.Text(param1);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return values
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+                param2 = reader.Text();
+            }
+
+            return output;
+        }
+
+        uint32_t DeleteKey(const string& param0, const string& param1) override
+        {
+            IPCMessage newMessage(BaseClass::Message(2));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+            writer.Text(param1);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return value
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+            }
+
+            return output;
+        }
+
+        uint32_t DeleteNamespace(const string& param0) override
+        {
+            IPCMessage newMessage(BaseClass::Message(3));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return value
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+            }
+
+            return output;
+        }
+
+        uint32_t SetValues(const string& param0, const std::vector<string>& param1, const std::vector<string>& param2) override
+        {
+            IPCMessage newMessage(BaseClass::Message(4));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+            writeList(writer, param1);
+            writeList(writer, param2);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return value
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+            }
+
+            return output;
+        }
+
+        uint32_t GetValues(const string& param0, const std::vector<string>& param1, std::vector<string>& /* out */ param2, std::vector<string>& /* out */ param3) override
+        {
+            IPCMessage newMessage(BaseClass::Message(5));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+            writeList(writer, param1);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return values
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+                readList(reader, param2);
+                readList(reader, param3);
+            }
+
+            return output;
+        }
+
+        uint32_t DeleteKeys(const string& param0, const std::vector<string>& param1) override
+        {
+            IPCMessage newMessage(BaseClass::Message(6));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+            writeList(writer, param1);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return value
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+            }
+
+            return output;
+        }
+
+    }; // class PersistentStoreProxy
+
+    // -----------------------------------------------------------------
+    // REGISTRATION
+    // -----------------------------------------------------------------
+
+    namespace {
+
+        typedef ProxyStub::UnknownStubType<IPersistentStore, PersistentStoreStubMethods> PersistentStoreStub;
+
+        static class Instantiation {
+        public:
+            Instantiation()
+            {
+                RPC::Administrator::Instance().Announce<IPersistentStore, PersistentStoreProxy, PersistentStoreStub>();
+            }
+            ~Instantiation()
+            {
+                RPC::Administrator::Instance().Recall<IPersistentStore>();
+            }
+        } ProxyStubRegistration;
+
+    } // namespace
+
+} // namespace ProxyStubs
+
+}
@@ -0,0 +1,166 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <gst/gst.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <sstream>
+
+#define PLAYERINFO_CODEC_CACHE_FILE "/opt/persistent/playerinfo_codecs"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Keeps the codec tables probed from the GStreamer registry across boots. The key covers the
+    // GStreamer version and every registered plugin file (name, path, size and mtime), so the
+    // codecs are only probed again when a plugin is added, removed or updated.
+    class CodecCache {
+    public:
+        CodecCache() = delete;
+        CodecCache(const CodecCache&) = delete;
+        CodecCache& operator= (const CodecCache&) = delete;
+
+        // Needs gst_init to have loaded the registry
+        static string Key()
+        {
+            uint64_t combined = 0;
+            uint32_t count = 0;
+
+            GList* plugins = gst_registry_get_plugin_list(gst_registry_get());
+            for (GList* iterator = plugins; iterator; iterator = iterator->next) {
+                GstPlugin* plugin = static_cast<GstPlugin*>(iterator->data);
+                const gchar* name = gst_plugin_get_name(plugin);
+                const gchar* filename = gst_plugin_get_filename(plugin);
+
+                uint64_t hash = Hash(14695981039346656037ULL, name, (name != nullptr ? strlen(name) : 0));
+                if (filename != nullptr) {
+                    struct stat info;
+                    hash = Hash(hash, filename, strlen(filename));
+                    if (stat(filename, &info) == 0) {
+                        uint64_t size = info.st_size;
+                        uint64_t mtime = info.st_mtime;
+                        hash = Hash(hash, &size, sizeof(size));
+                        hash = Hash(hash, &mtime, sizeof(mtime));
+                    }
+                }
+
+                // The order of the plugin list is not fixed, combine the plugins order independent
+                combined += hash;
+                count++;
+            }
+            gst_plugin_list_free(plugins);
+
+            gchar* version = gst_version_string();
+            std::ostringstream key;
+            key << version << ' ' << count << ' ' << std::hex << combined;
+            g_free(version);
+
+            return (key.str());
+        }
+
+        template <typename AudioCodec, typename VideoCodec>
+        static bool Load(const string& key, std::list<AudioCodec>& audioCodecs, std::list<VideoCodec>& videoCodecs)
+        {
+            std::ifstream file(PLAYERINFO_CODEC_CACHE_FILE);
+            string line;
+
+            if ((std::getline(file, line).good() == false) || (line != key)) {
+                return (false);
+            }
+
+            std::list<AudioCodec> audio;
+            std::list<VideoCodec> video;
+            if ((ReadCodecs(file, _T("audio"), audio) == false) || (ReadCodecs(file, _T("video"), video) == false)) {
+                return (false);
+            }
+
+            audioCodecs = audio;
+            videoCodecs = video;
+            return (true);
+        }
+
+        template <typename AudioCodec, typename VideoCodec>
+        static void Save(const string& key, const std::list<AudioCodec>& audioCodecs, const std::list<VideoCodec>& videoCodecs)
+        {
+            const string temporary = string(PLAYERINFO_CODEC_CACHE_FILE) + _T(".tmp");
+            std::ofstream file(temporary, std::ios::trunc);
+
+            file << key << '\n';
+            WriteCodecs(file, _T("audio"), audioCodecs);
+            WriteCodecs(file, _T("video"), videoCodecs);
+            file.close();
+
+            if ((file.fail() == true) || (rename(temporary.c_str(), PLAYERINFO_CODEC_CACHE_FILE) != 0)) {
+                TRACE_L1(_T("Could not store the codec tables in %s"), PLAYERINFO_CODEC_CACHE_FILE);
+                remove(temporary.c_str());
+            }
+        }
+
+    private:
+        static uint64_t Hash(uint64_t hash, const void* data, size_t length)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t index = 0; index < length; index++) {
+                hash = (hash ^ bytes[index]) * 1099511628211ULL;
+            }
+            return (hash);
+        }
+
+        template <typename Codec>
+        static bool ReadCodecs(std::istream& file, const string& label, std::list<Codec>& codecs)
+        {
+            string line;
+            if (std::getline(file, line).good() == false) {
+                return (false);
+            }
+
+            std::istringstream entries(line);
+            string name;
+            if (((entries >> name).fail() == true) || (name != label)) {
+                return (false);
+            }
+
+            uint32_t value;
+            while ((entries >> value).fail() == false) {
+                codecs.push_back(static_cast<Codec>(value));
+            }
+            return (entries.eof());
+        }
+
+        template <typename Codec>
+        static void WriteCodecs(std::ostream& file, const string& label, const std::list<Codec>& codecs)
+        {
+            file << label;
+            for (const Codec codec : codecs) {
+                file << ' ' << static_cast<uint32_t>(codec);
+            }
+            file << '\n';
+        }
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -20,6 +20,7 @@
 #include "../Module.h"
 #include <interfaces/IPlayerInfo.h>
 #include <interfaces/IDolby.h>
+#include "../CodecCache.h"
 #include "host.hpp"
 #include "exception.hpp"
 #include "audioOutputPortType.hpp"
@@ -117,8 +118,12 @@ public:
     PlayerInfoImplementation()
     {
         gst_init(0, nullptr);
-        UpdateAudioCodecInfo();
-        UpdateVideoCodecInfo();
+        const string codecKey = CodecCache::Key();
+        if (CodecCache::Load(codecKey, _audioCodecs, _videoCodecs) == false) {
+            UpdateAudioCodecInfo();
+            UpdateVideoCodecInfo();
+            CodecCache::Save(codecKey, _audioCodecs, _videoCodecs);
+        }
         Utils::IARM::init();
         device::Manager::Initialize();
         IARM_Result_t res;
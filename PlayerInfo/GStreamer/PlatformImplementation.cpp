@@ -19,6 +19,7 @@
  
 #include "../Module.h"
 #include <interfaces/IPlayerInfo.h>
+#include "../CodecCache.h"
 
 #include <gst/gst.h>
 
@@ -205,8 +206,12 @@ private:
 public:
     PlayerInfoImplementation() {
         gst_init(0, nullptr);
-        UpdateAudioCodecInfo();
-        UpdateVideoCodecInfo();
+        const string codecKey = CodecCache::Key();
+        if (CodecCache::Load(codecKey, _audioCodecs, _videoCodecs) == false) {
+            UpdateAudioCodecInfo();
+            UpdateVideoCodecInfo();
+            CodecCache::Save(codecKey, _audioCodecs, _videoCodecs);
+        }
     }
 
     PlayerInfoImplementation(const PlayerInfoImplementation&) = delete;
@@ -23,9 +23,24 @@
 #include <iostream>
 #include <mutex>
 #include <thread>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <set>
+#include <functional>
 #include <fstream>
 #include <sstream>
 #include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+#include <jpeglib.h>
+#endif
 #include <rdkshell/compositorcontroller.h>
 #include <rdkshell/application.h>
 #include <rdkshell/logger.h>
@@ -118,6 +133,16 @@ const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_SCREENSHOT = "g
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_ENABLE_EASTER_EGGS = "enableEasterEggs";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_ENABLE_LOGS_FLUSHING = "enableLogsFlushing";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_LOGS_FLUSHING_ENABLED = "getLogsFlushingEnabled";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_REQUEST_QUEUE_STATS = "getRequestQueueStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_FRAME_STATS = "getFrameStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_APPLY_TRANSACTION = "applyTransaction";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_LAUNCH_TRACES = "getLaunchTraces";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_MEMORY_POLICY = "setMemoryPolicy";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_MEMORY_POLICY = "getMemoryPolicy";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_ENABLE_KEY_LATENCY_TRACER = "enableKeyLatencyTracer";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_KEY_LATENCY_STATS = "getKeyLatencyStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_CLIENT_GRAPHICS_MEMORY = "getClientGraphicsMemory";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_GRAPHICS_MEMORY_BUDGET = "setGraphicsMemoryBudget";
 
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_USER_INACTIVITY = "onUserInactivity";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_APP_LAUNCHED = "onApplicationLaunched";
@@ -139,6 +164,8 @@ const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_DEVICE_CRITICALLY_LO
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_EASTER_EGG = "onEasterEgg";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_WILL_DESTROY = "onWillDestroy";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE = "onScreenshotComplete";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_MEMORY_POLICY_ACTION = "onMemoryPolicyAction";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_GRAPHICS_MEMORY_BUDGET_EXCEEDED = "onGraphicsMemoryBudgetExceeded";
 
 using namespace std;
 using namespace RdkShell;
@@ -172,6 +199,22 @@ bool needsScreenshot = false;
 #define THUNDER_ACCESS_DEFAULT_VALUE "127.0.0.1:9998"
 #define RDKSHELL_WILLDESTROY_EVENT_WAITTIME 1
 #define RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS 250
+#define RDKSHELL_DEFAULT_REQUEST_WORKERS 2
+#define RDKSHELL_SCREENSHOT_DEFAULT_QUALITY 80
+#define RDKSHELL_LAUNCH_POOL_MAX_FAILURES 3
+#define RDKSHELL_LAUNCH_TRACE_COUNT 32
+#define RDKSHELL_MEMORY_POLICY_DEFAULT_MAX_ACTIONS 3
+#define RDKSHELL_MEMORY_POLICY_ACTION_COUNT 16
+#define RDKSHELL_GRAPHICS_MEMORY_CHECK_INTERVAL_MS 5000
+#define RDKSHELL_SURFACE_BUFFER_COUNT 3
+#define RDKSHELL_SCREENSHOT_DIRECTORY "/tmp/rdkshell_screenshots"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
 
 static std::string gThunderAccessValue = THUNDER_ACCESS_DEFAULT_VALUE;
 static uint32_t gWillDestroyEventWaitTime = RDKSHELL_WILLDESTROY_EVENT_WAITTIME;
@@ -281,179 +324,2108 @@ namespace WPEFramework {
             return Invoke(waitTime, method, empty, respObject);
           }
 
-          template <typename PARAMETERS>
-          uint32_t Set(const uint32_t waitTime, const string& method, const PARAMETERS& sendObject)
-          {
-            JsonObject empty;
-            return Invoke(waitTime, method, sendObject, empty);
-          }
+          template <typename PARAMETERS>
+          uint32_t Set(const uint32_t waitTime, const string& method, const PARAMETERS& sendObject)
+          {
+            JsonObject empty;
+            return Invoke(waitTime, method, sendObject, empty);
+          }
+
+          template <typename PARAMETERS, typename RESPONSE>
+          uint32_t Invoke(const uint32_t waitTime, const string& method, const PARAMETERS& parameters, RESPONSE& response, bool isResponseString=false)
+          {
+            if (dispatcher_ == nullptr) {
+              std::cout << "No JSON RPC dispatcher for " << mCallSign << '\n';
+              return Core::ERROR_GENERAL;
+            }
+
+            auto message = Message();
+
+            message->JSONRPC = Core::JSONRPC::Message::DefaultVersion;
+            message->Id = Core::JSON::DecUInt32(++mId);
+            message->Designator = Core::JSON::String(mCallSign + ".1." + method);
+
+            ToMessage(parameters, message);
+
+            const uint32_t channelId = ~0;
+            auto resp =  dispatcher_->Invoke(sThunderSecurityToken, channelId, *message);
+            if (resp->Error.IsSet()) {
+              std::cout << "Call failed: " << message->Designator.Value() << " error: " <<  resp->Error.Text.Value() << "\n";
+              return resp->Error.Code;
+            }
+
+            if (!FromMessage(response, resp, isResponseString))
+              return Core::ERROR_GENERAL;
+
+            return Core::ERROR_NONE;
+          }
+        };
+
+        class StateControlNotification: public PluginHost::IStateControl::INotification
+        {
+          RDKShell& mRDKShell;
+          std::string mCallSign;
+          bool mLaunchEnabled { false };
+        public:
+          StateControlNotification(std::string callsign, RDKShell& shell)
+            : mRDKShell(shell)
+            , mCallSign(callsign)
+          {
+          }
+
+          void enableLaunch(bool enable)
+          {
+            mLaunchEnabled = enable;
+          }
+
+          void StateChange(const PluginHost::IStateControl::state state) override
+          {
+            bool isSuspended = (state == PluginHost::IStateControl::SUSPENDED);
+            if (mLaunchEnabled)
+            {
+               JsonObject params;
+               params["client"] = mCallSign;
+               params["launchType"] = (isSuspended)?"suspend":"resume";
+               mRDKShell.notify(RDKShell::RDKSHELL_EVENT_ON_LAUNCHED, params);
+               mLaunchEnabled = false;
+            }
+
+            if (isSuspended)
+            {
+                JsonObject params;
+                params["client"] = mCallSign;
+                mRDKShell.notify(RDKShell::RDKSHELL_EVENT_ON_PLUGIN_SUSPENDED, params);
+            }            
+          }
+
+          BEGIN_INTERFACE_MAP(Notification)
+          INTERFACE_ENTRY(PluginHost::IStateControl::INotification)
+          END_INTERFACE_MAP
+        };
+
+        std::map<std::string, StateControlNotification*> gStateNotifications;
+
+        struct RDKShellStartupConfig
+        {
+            std::string name;
+            std::string rfc;
+            std::string thunderApi;
+            JsonObject params;
+            std::vector<std::string> dependsOn;
+            bool ordered; // no dependsOn given, runs after the entry before it
+        };
+
+        std::map<std::string, PluginData> gActivePluginsData;
+        std::map<std::string, PluginStateChangeData*> gPluginsEventListener;
+        std::vector<RDKShellStartupConfig> gStartupConfigs;
+        std::map<std::string, bool> gDestroyApplications;
+        std::map<std::string, bool> gLaunchApplications;
+        
+        uint32_t getKeyFlag(std::string modifier)
+        {
+          uint32_t flag = 0;
+          if (0 == modifier.compare("ctrl"))
+          {
+            flag = RDKSHELL_FLAGS_CONTROL;
+          }
+          else if (0 == modifier.compare("shift"))
+          {
+            flag = RDKSHELL_FLAGS_SHIFT;
+          }
+          else if (0 == modifier.compare("alt"))
+          {
+            flag = RDKSHELL_FLAGS_ALT;
+          }
+          return flag;
+        }
+
+        SERVICE_REGISTRATION(RDKShell, 1, 0);
+
+        RDKShell* RDKShell::_instance = nullptr;
+        // gRdkShellMutex guards the compositor. Whoever takes it may change the compositor, so every
+        // lock() and try_lock() marks the compositor snapshot stale; only the shell loop locks with
+        // lockFrame(), it publishes the snapshot again once the change has been drawn.
+        class RdkShellMutex
+        {
+        public:
+            RdkShellMutex() : mChanged(true) {}
+
+            void lock()
+            {
+                mMutex.lock();
+                mChanged = true;
+            }
+            bool try_lock()
+            {
+                if (!mMutex.try_lock())
+                {
+                    return false;
+                }
+                mChanged = true;
+                return true;
+            }
+            void unlock()
+            {
+                mMutex.unlock();
+            }
+            void lockFrame()
+            {
+                mMutex.lock();
+            }
+            bool changed() const
+            {
+                return mChanged;
+            }
+            // with the lock held, after the new snapshot is published
+            void published()
+            {
+                mChanged = false;
+            }
+
+        private:
+            std::mutex mMutex;
+            std::atomic<bool> mChanged;
+        };
+
+        RdkShellMutex gRdkShellMutex;
+        std::mutex gPluginDataMutex;
+        std::mutex gLaunchDestroyMutex;
+        std::mutex gDestroyMutex;
+
+        std::mutex gLaunchMutex;
+        int32_t gLaunchCount = 0;
+
+        static std::thread shellThread;
+
+        struct CreateDisplayRequest
+        {
+            CreateDisplayRequest(std::string client, std::string displayName, uint32_t displayWidth=0, uint32_t displayHeight=0, bool virtualDisplayEnabled=false, uint32_t virtualWidth=0, uint32_t virtualHeight=0, bool topmost = false, bool focus = false): mClient(client), mDisplayName(displayName), mDisplayWidth(displayWidth), mDisplayHeight(displayHeight), mVirtualDisplayEnabled(virtualDisplayEnabled), mVirtualWidth(virtualWidth),mVirtualHeight(virtualHeight), mTopmost(topmost), mFocus(focus), mResult(false)
+            {
+                sem_init(&mSemaphore, 0, 0);
+            }
+  
+            ~CreateDisplayRequest()
+            {
+                sem_destroy(&mSemaphore);
+            }
+
+            std::string mClient;
+            std::string mDisplayName;
+            uint32_t mDisplayWidth;
+            uint32_t mDisplayHeight;
+            bool mVirtualDisplayEnabled;
+            uint32_t mVirtualWidth;
+            uint32_t mVirtualHeight;
+            bool mTopmost;
+            bool mFocus;
+            sem_t mSemaphore;
+            bool mResult;
+        };
+
+        struct KillClientRequest
+        {
+            KillClientRequest(std::string client): mClient(client), mResult(false)
+            {
+                sem_init(&mSemaphore, 0, 0);
+            }
+  
+            ~KillClientRequest()
+            {
+                sem_destroy(&mSemaphore);
+            }
+
+            std::string mClient;
+            sem_t mSemaphore;
+            bool mResult;
+        };
+
+        std::vector<std::shared_ptr<CreateDisplayRequest>> gCreateDisplayRequests;
+        std::vector<std::shared_ptr<KillClientRequest>> gKillClientRequests;
+
+        // Runs the asynchronous api requests on a fixed set of workers. Requests are served
+        // by priority, then in order. A request identical to one still waiting in the queue
+        // is dropped, the queued one will do the same work.
+        class ApiRequestExecutor
+        {
+        public:
+            enum Priority
+            {
+                PRIORITY_HIGH = 0, // user facing launches
+                PRIORITY_NORMAL,
+                PRIORITY_LOW,      // housekeeping
+                PRIORITY_COUNT
+            };
+
+            ApiRequestExecutor() : mStopping(false)
+            {
+                resetStats();
+            }
+
+            ~ApiRequestExecutor()
+            {
+                stop();
+            }
+
+            void start(size_t workers)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mWorkers.empty())
+                {
+                    return;
+                }
+                mStopping = false;
+                resetStats();
+                for (size_t i = 0; i < workers; i++)
+                {
+                    mWorkers.push_back(std::thread(&ApiRequestExecutor::run, this));
+                }
+            }
+
+            // pending requests are dropped, running ones are waited for
+            void stop()
+            {
+                std::vector<std::thread> workers;
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mStopping = true;
+                    for (int i = 0; i < PRIORITY_COUNT; i++)
+                    {
+                        mQueues[i].clear();
+                    }
+                    workers.swap(mWorkers);
+                }
+                mCondition.notify_all();
+                for (size_t i = 0; i < workers.size(); i++)
+                {
+                    workers[i].join();
+                }
+            }
+
+            bool submit(Priority priority, const std::string& key, const std::function<void()>& job)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mStopping || mWorkers.empty())
+                {
+                    std::cout << "rdkshell request executor not running, dropping request " << key << std::endl;
+                    return false;
+                }
+                mSubmitted++;
+                for (int i = 0; i < PRIORITY_COUNT; i++)
+                {
+                    for (std::deque<Job>::iterator it = mQueues[i].begin(); it != mQueues[i].end(); ++it)
+                    {
+                        if (it->mKey == key)
+                        {
+                            mCoalesced++;
+                            return true;
+                        }
+                    }
+                }
+                Job entry;
+                entry.mKey = key;
+                entry.mJob = job;
+                entry.mQueuedTime = RdkShell::milliseconds();
+                mQueues[priority].push_back(entry);
+
+                size_t depth = queueDepth();
+                if (depth > mMaxDepth)
+                {
+                    mMaxDepth = depth;
+                }
+                mCondition.notify_one();
+                return true;
+            }
+
+            void getStats(JsonObject& stats)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                stats["workers"] = (uint32_t)mWorkers.size();
+                stats["queued"] = (uint32_t)queueDepth();
+                stats["maxQueued"] = (uint32_t)mMaxDepth;
+                stats["submitted"] = mSubmitted;
+                stats["executed"] = mExecuted;
+                stats["coalesced"] = mCoalesced;
+                stats["averageWaitMs"] = mExecuted > 0 ? mTotalWait / mExecuted : 0.0;
+                stats["maxWaitMs"] = mMaxWait;
+                stats["averageRunMs"] = mExecuted > 0 ? mTotalRun / mExecuted : 0.0;
+                stats["maxRunMs"] = mMaxRun;
+            }
+
+        private:
+            struct Job
+            {
+                std::string mKey;
+                std::function<void()> mJob;
+                double mQueuedTime;
+            };
+
+            size_t queueDepth() const
+            {
+                size_t depth = 0;
+                for (int i = 0; i < PRIORITY_COUNT; i++)
+                {
+                    depth += mQueues[i].size();
+                }
+                return depth;
+            }
+
+            void resetStats()
+            {
+                mSubmitted = mExecuted = mCoalesced = 0;
+                mMaxDepth = 0;
+                mTotalWait = mMaxWait = mTotalRun = mMaxRun = 0;
+            }
+
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (true)
+                {
+                    mCondition.wait(lock, [this] { return mStopping || queueDepth() > 0; });
+                    if (mStopping)
+                    {
+                        break;
+                    }
+                    Job job;
+                    for (int i = 0; i < PRIORITY_COUNT; i++)
+                    {
+                        if (!mQueues[i].empty())
+                        {
+                            job = mQueues[i].front();
+                            mQueues[i].pop_front();
+                            break;
+                        }
+                    }
+                    double startTime = RdkShell::milliseconds();
+                    double wait = startTime - job.mQueuedTime;
+                    lock.unlock();
+
+                    job.mJob();
+
+                    double runTime = RdkShell::milliseconds() - startTime;
+                    lock.lock();
+                    mExecuted++;
+                    mTotalWait += wait;
+                    mTotalRun += runTime;
+                    if (wait > mMaxWait)
+                    {
+                        mMaxWait = wait;
+                    }
+                    if (runTime > mMaxRun)
+                    {
+                        mMaxRun = runTime;
+                    }
+                }
+            }
+
+            std::mutex mMutex;
+            std::condition_variable mCondition;
+            std::deque<Job> mQueues[PRIORITY_COUNT];
+            std::vector<std::thread> mWorkers;
+            bool mStopping;
+
+            uint64_t mSubmitted;
+            uint64_t mExecuted;
+            uint64_t mCoalesced;
+            size_t mMaxDepth;
+            double mTotalWait;
+            double mMaxWait;
+            double mTotalRun;
+            double mMaxRun;
+        };
+
+        static ApiRequestExecutor gApiRequestExecutor;
+
+        // Sends the events of the compositor callbacks from a thread of its own, in the order
+        // they were posted. The callbacks run on the shell thread with gRdkShellMutex held, so
+        // building, serializing and sending the parameters there holds up the frame.
+        class EventQueue
+        {
+        public:
+            EventQueue() : mStopping(false), mRunning(false)
+            {
+            }
+
+            ~EventQueue()
+            {
+                stop();
+            }
+
+            void start()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mRunning)
+                {
+                    return;
+                }
+                mStopping = false;
+                mRunning = true;
+                mThread = std::thread(&EventQueue::run, this);
+            }
+
+            // the events posted so far are still sent
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    if (!mRunning)
+                    {
+                        return;
+                    }
+                    mStopping = true;
+                }
+                mCondition.notify_all();
+                mThread.join();
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRunning = false;
+            }
+
+            bool post(const std::function<void()>& event)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mRunning || mStopping)
+                {
+                    return false;
+                }
+                mEvents.push_back(event);
+                mCondition.notify_one();
+                return true;
+            }
+
+        private:
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (true)
+                {
+                    mCondition.wait(lock, [this] { return mStopping || !mEvents.empty(); });
+                    if (mEvents.empty())
+                    {
+                        break;
+                    }
+                    std::function<void()> event = mEvents.front();
+                    mEvents.pop_front();
+                    lock.unlock();
+                    event();
+                    lock.lock();
+                }
+            }
+
+            std::mutex mMutex;
+            std::condition_variable mCondition;
+            std::deque<std::function<void()>> mEvents;
+            std::thread mThread;
+            bool mStopping;
+            bool mRunning;
+        };
+
+        static EventQueue gEventQueue;
+
+        // Frame timing of the shell loop. The work time is the time the loop holds
+        // gRdkShellMutex to draw and update, the interval the time between two frames.
+        class FrameStats
+        {
+        public:
+            FrameStats()
+            {
+                reset();
+            }
+
+            void add(double workMs, double intervalMs, bool missed)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mFrames++;
+                mTotalWork += workMs;
+                if (workMs > mMaxWork)
+                {
+                    mMaxWork = workMs;
+                }
+                if (intervalMs > mMaxInterval)
+                {
+                    mMaxInterval = intervalMs;
+                }
+                if (missed)
+                {
+                    mMissed++;
+                }
+                int bucket = 0;
+                while (bucket < BUCKET_COUNT - 1 && workMs >= sBucketLimits[bucket])
+                {
+                    bucket++;
+                }
+                mBuckets[bucket]++;
+            }
+
+            void idle()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mIdleFrames++;
+            }
+
+            void getStats(JsonObject& stats)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                stats["frames"] = mFrames;
+                stats["idleFrames"] = mIdleFrames;
+                stats["missedFrames"] = mMissed;
+                stats["averageWorkMs"] = mFrames > 0 ? mTotalWork / mFrames : 0.0;
+                stats["maxWorkMs"] = mMaxWork;
+                stats["maxIntervalMs"] = mMaxInterval;
+                JsonArray histogram;
+                for (int i = 0; i < BUCKET_COUNT; i++)
+                {
+                    JsonObject bucket;
+                    if (i < BUCKET_COUNT - 1)
+                    {
+                        bucket["belowMs"] = sBucketLimits[i];
+                    }
+                    bucket["count"] = mBuckets[i];
+                    histogram.Add(bucket);
+                }
+                stats["workHistogram"] = histogram;
+            }
+
+            void reset()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mFrames = mIdleFrames = mMissed = 0;
+                mTotalWork = mMaxWork = mMaxInterval = 0;
+                for (int i = 0; i < BUCKET_COUNT; i++)
+                {
+                    mBuckets[i] = 0;
+                }
+            }
+
+        private:
+            static const int BUCKET_COUNT = 9;
+            static const uint32_t sBucketLimits[BUCKET_COUNT - 1];
+
+            std::mutex mMutex;
+            uint64_t mFrames;
+            uint64_t mIdleFrames;
+            uint64_t mMissed;
+            double mTotalWork;
+            double mMaxWork;
+            double mMaxInterval;
+            uint64_t mBuckets[BUCKET_COUNT];
+        };
+
+        const uint32_t FrameStats::sBucketLimits[FrameStats::BUCKET_COUNT - 1] = { 2, 4, 8, 12, 16, 25, 33, 50 };
+
+        static FrameStats gFrameStats;
+
+#ifdef RFC_ENABLED
+        // The startup thunder apis with their dependencies: an entry runs once the entries
+        // named in its dependsOn are done, entries that don't depend on each other run
+        // concurrently on the request executor. An entry without dependsOn waits for the
+        // entry before it, as when they all ran in order. A name nothing is called is
+        // ignored, as are the dependencies of the entries in a cycle.
+        class StartupGraph
+        {
+        public:
+            explicit StartupGraph(const std::vector<RDKShellStartupConfig>& configs)
+                : mEntries(configs)
+                , mWaiting(configs.size(), 0)
+                , mDependents(configs.size())
+            {
+                std::multimap<std::string, size_t> names;
+                for (size_t i = 0; i < mEntries.size(); i++)
+                {
+                    names.insert(std::make_pair(mEntries[i].name, i));
+                }
+                for (size_t i = 0; i < mEntries.size(); i++)
+                {
+                    if (mEntries[i].ordered && i > 0)
+                    {
+                        mDependents[i - 1].push_back(i);
+                        mWaiting[i]++;
+                    }
+                    for (const std::string& dependency : mEntries[i].dependsOn)
+                    {
+                        auto range = names.equal_range(dependency);
+                        if (range.first == range.second)
+                        {
+                            std::cout << "startup entry " << mEntries[i].name << " depends on unknown entry " << dependency << std::endl;
+                        }
+                        for (auto it = range.first; it != range.second; ++it)
+                        {
+                            if (it->second != i)
+                            {
+                                mDependents[it->second].push_back(i);
+                                mWaiting[i]++;
+                            }
+                        }
+                    }
+                }
+                breakCycles();
+            }
+
+            std::vector<size_t> roots() const
+            {
+                std::vector<size_t> ready;
+                for (size_t i = 0; i < mEntries.size(); i++)
+                {
+                    if (mWaiting[i] == 0)
+                    {
+                        ready.push_back(i);
+                    }
+                }
+                return ready;
+            }
+
+            const RDKShellStartupConfig& entry(size_t index) const
+            {
+                return mEntries[index];
+            }
+
+            // Returns the entries that became ready with this one done
+            std::vector<size_t> done(size_t index)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::vector<size_t> ready;
+                for (size_t dependent : mDependents[index])
+                {
+                    if (--mWaiting[dependent] == 0)
+                    {
+                        ready.push_back(dependent);
+                    }
+                }
+                return ready;
+            }
+
+        private:
+            void breakCycles()
+            {
+                std::vector<uint32_t> waiting(mWaiting);
+                std::vector<size_t> ready = roots();
+                std::vector<bool> reached(mEntries.size(), false);
+                while (!ready.empty())
+                {
+                    size_t index = ready.back();
+                    ready.pop_back();
+                    reached[index] = true;
+                    for (size_t dependent : mDependents[index])
+                    {
+                        if (--waiting[dependent] == 0)
+                        {
+                            ready.push_back(dependent);
+                        }
+                    }
+                }
+                for (size_t i = 0; i < mEntries.size(); i++)
+                {
+                    if (!reached[i])
+                    {
+                        std::cout << "startup entry " << mEntries[i].name << " is in a dependency cycle, ignoring its dependencies" << std::endl;
+                        mWaiting[i] = 0;
+                        for (size_t j = 0; j < mEntries.size(); j++)
+                        {
+                            mDependents[j].erase(std::remove(mDependents[j].begin(), mDependents[j].end(), i), mDependents[j].end());
+                        }
+                    }
+                }
+            }
+
+            std::mutex mMutex;
+            const std::vector<RDKShellStartupConfig> mEntries;
+            std::vector<uint32_t> mWaiting;
+            std::vector<std::vector<size_t>> mDependents;
+        };
+
+        static void runStartupEntry(const RDKShellStartupConfig& config)
+        {
+            RFC_ParamData_t rfcParam;
+            bool ret = Utils::getRFCConfig((char*)config.rfc.c_str(), rfcParam);
+            if (true == ret && (strncasecmp(rfcParam.value,"true",4) == 0))
+            {
+                std::cout << "invoking thunder api " << config.thunderApi << std::endl;
+                uint64_t startUs = Utils::BootTimeline::now();
+                JsonObject apiParams = config.params;
+                JsonObject joResult;
+                auto thunderController = Utils::getThunderControllerClient("", "", gThunderAccessValue);
+                uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, config.thunderApi.c_str(), apiParams, joResult);
+                Utils::releaseThunderControllerClient(thunderController, status);
+                Utils::BootTimeline::record("RDKShell", "startup:" + config.name, startUs, Utils::BootTimeline::now());
+                if (status > 0)
+                {
+                    std::cout << "invoking thunder api " << config.thunderApi << " failed - " << status << std::endl;
+                }
+            }
+            else
+            {
+                std::cout << "rfc " << config.rfc << " not enabled " << std::endl;
+            }
+        }
+
+        static void submitStartupEntry(std::shared_ptr<StartupGraph> graph, size_t index)
+        {
+            std::function<void()> job = [graph, index]() {
+                runStartupEntry(graph->entry(index));
+                std::vector<size_t> ready = graph->done(index);
+                for (size_t i = 0; i < ready.size(); i++)
+                {
+                    submitStartupEntry(graph, ready[i]);
+                }
+            };
+            if (!gApiRequestExecutor.submit(ApiRequestExecutor::PRIORITY_NORMAL, "startup" + std::to_string(index), job))
+            {
+                job();
+            }
+        }
+#endif
+
+        // Latency of the keys injected through the shell, when enabled. A key is stamped when
+        // injectKey is called, when it holds the compositor lock, when the compositor returns
+        // from delivering it and at the end of the next frame the shell draws.
+        class KeyLatencyTracer
+        {
+        public:
+            struct Sample
+            {
+                double received;
+                double dispatched;
+                double delivered;
+            };
+
+            KeyLatencyTracer()
+                : mEnabled(false)
+            {
+                reset();
+            }
+
+            void setEnabled(bool enabled)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mEnabled = enabled;
+                mPending.clear();
+            }
+
+            bool enabled() const
+            {
+                return mEnabled;
+            }
+
+            void delivered(const Sample& sample)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mEnabled && mPending.size() < MAX_PENDING)
+                {
+                    mPending.push_back(sample);
+                }
+            }
+
+            // Called by the shell loop after a frame was drawn
+            void frameDrawn(double now)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (const Sample& sample : mPending)
+                {
+                    const double total = now - sample.received;
+                    mKeys++;
+                    addStage(QUEUE, sample.dispatched - sample.received);
+                    addStage(INJECT, sample.delivered - sample.dispatched);
+                    addStage(COMPOSE, now - sample.delivered);
+                    addStage(TOTAL, total);
+                    int bucket = 0;
+                    while (bucket < BUCKET_COUNT - 1 && total >= sBucketLimits[bucket])
+                    {
+                        bucket++;
+                    }
+                    mBuckets[bucket]++;
+                }
+                mPending.clear();
+            }
+
+            void getStats(JsonObject& stats)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                static const char* const names[STAGE_COUNT] = { "queue", "inject", "compose", "total" };
+                stats["enabled"] = mEnabled;
+                stats["keys"] = mKeys;
+                JsonObject stages;
+                for (int i = 0; i < STAGE_COUNT; i++)
+                {
+                    JsonObject stage;
+                    stage["averageMs"] = mKeys > 0 ? mStageTotal[i] / mKeys : 0.0;
+                    stage["maxMs"] = mStageMax[i];
+                    stages[names[i]] = stage;
+                }
+                stats["stages"] = stages;
+                JsonArray histogram;
+                for (int i = 0; i < BUCKET_COUNT; i++)
+                {
+                    JsonObject bucket;
+                    if (i < BUCKET_COUNT - 1)
+                    {
+                        bucket["belowMs"] = sBucketLimits[i];
+                    }
+                    bucket["count"] = mBuckets[i];
+                    histogram.Add(bucket);
+                }
+                stats["latencyHistogram"] = histogram;
+            }
+
+            void reset()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mKeys = 0;
+                for (int i = 0; i < STAGE_COUNT; i++)
+                {
+                    mStageTotal[i] = mStageMax[i] = 0;
+                }
+                for (int i = 0; i < BUCKET_COUNT; i++)
+                {
+                    mBuckets[i] = 0;
+                }
+            }
+
+        private:
+            enum Stage
+            {
+                QUEUE = 0,
+                INJECT,
+                COMPOSE,
+                TOTAL,
+                STAGE_COUNT
+            };
+
+            void addStage(Stage stage, double ms)
+            {
+                mStageTotal[stage] += ms;
+                if (ms > mStageMax[stage])
+                {
+                    mStageMax[stage] = ms;
+                }
+            }
+
+            static const size_t MAX_PENDING = 64;
+            static const int BUCKET_COUNT = 9;
+            static const uint32_t sBucketLimits[BUCKET_COUNT - 1];
+
+            std::mutex mMutex;
+            std::atomic<bool> mEnabled;
+            std::vector<Sample> mPending;
+            uint64_t mKeys;
+            double mStageTotal[STAGE_COUNT];
+            double mStageMax[STAGE_COUNT];
+            uint64_t mBuckets[BUCKET_COUNT];
+        };
+
+        const uint32_t KeyLatencyTracer::sBucketLimits[KeyLatencyTracer::BUCKET_COUNT - 1] = { 8, 16, 33, 50, 67, 100, 150, 250 };
+
+        static KeyLatencyTracer gKeyLatencyTracer;
+
+        static void addNanoseconds(struct timespec& time, long long nanoseconds)
+        {
+            nanoseconds += time.tv_nsec;
+            time.tv_sec += nanoseconds / 1000000000;
+            time.tv_nsec = nanoseconds % 1000000000;
+        }
+
+        static double elapsedMs(const struct timespec& from, const struct timespec& to)
+        {
+            return (to.tv_sec - from.tv_sec) * 1000.0 + (to.tv_nsec - from.tv_nsec) / 1000000.0;
+        }
+
+        // Compositor state as of the last frame. The shell loop builds a new one, while it holds
+        // gRdkShellMutex, in the frames after the compositor changed and swaps the pointer in; the
+        // getters read it without waiting for the frame to finish. A reader keeps the copy it
+        // loaded alive, so a snapshot is never modified after it is published.
+        struct CompositorSnapshot
+        {
+            struct Client
+            {
+                unsigned int x, y, width, height;
+                bool visible;
+                unsigned int opacity;
+                double scaleX, scaleY;
+            };
+
+            std::vector<std::string> clients;
+            std::vector<std::string> zOrder;
+            std::map<std::string, Client> properties;
+            std::vector<std::pair<std::string, std::string>> planes;    // client and plane, in z order
+
+            bool find(const std::string& client, Client& properties) const
+            {
+                std::string name(client);
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                auto entry = this->properties.find(name);
+                if (entry == this->properties.end())
+                {
+                    return false;
+                }
+                properties = entry->second;
+                return true;
+            }
+        };
+
+        static std::shared_ptr<const CompositorSnapshot> gCompositorSnapshot;
+        // Animations change the compositor on their own, the snapshot is rebuilt each frame until
+        // the last one ends. Only used with gRdkShellMutex held.
+        static double gCompositorAnimatingUntil = 0;
+
+        // Plane of every client, front to back: the first visible client that covers the whole
+        // screen and everything beneath it is the "overlay", the clients beneath it are "occluded"
+        // and left out of the composition until they are exposed again, the others are "gl" and
+        // composed as before. "hidden" clients are not visible. The compositor has no call to
+        // assign hardware planes, it is the covered clients not drawn each frame that saves the
+        // GPU and the memory bandwidth; a platform that scans a single full screen surface out
+        // directly does so for the overlay.
+        // Whether an application covers what is beneath it cannot be told from its surface, the
+        // callsigns that do are configured in RDKSHELL_PLANE_POLICY: opaque UIs, and players whose
+        // video plane shows through their hole punch. Off without it, all visible clients are "gl".
+        // Only used with gRdkShellMutex held.
+        class PlanePolicy
+        {
+        public:
+            void configure(const std::string& config)
+            {
+                mCovering.clear();
+                std::stringstream stream(config);
+                std::string item;
+                while (std::getline(stream, item, ','))
+                {
+                    if (!item.empty())
+                    {
+                        mCovering.insert(toLower(item));
+                        std::cout << "rdkshell plane policy: " << item << " covers the screen" << std::endl;
+                    }
+                }
+            }
+
+            // An application set the visibility of client, the policy does not restore it
+            void visibilityRequested(const std::string& client)
+            {
+                mOccluded.erase(toLower(client));
+            }
+
+            // Visible as far as the applications are concerned, hidden by the policy only
+            bool occluded(const std::string& client) const
+            {
+                return mOccluded.find(toLower(client)) != mOccluded.end();
+            }
+
+            const std::vector<std::pair<std::string, std::string>>& planes() const
+            {
+                return mPlanes;
+            }
+
+            void assign(CompositorSnapshot& snapshot)
+            {
+                unsigned int screenWidth = 0, screenHeight = 0;
+                if (!mCovering.empty())
+                {
+                    CompositorController::getScreenResolution(screenWidth, screenHeight);
+                }
+
+                std::vector<std::pair<std::string, std::string>> planes;
+                std::set<std::string> occluded;
+                bool covered = false;
+                for (const std::string& client : snapshot.zOrder)
+                {
+                    std::string name = toLower(client);
+                    CompositorSnapshot::Client properties;
+                    if (!snapshot.find(name, properties))
+                    {
+                        planes.push_back(std::make_pair(name, std::string("gl")));
+                    }
+                    else if (!properties.visible)
+                    {
+                        planes.push_back(std::make_pair(name, std::string("hidden")));
+                    }
+                    else if (covered)
+                    {
+                        planes.push_back(std::make_pair(name, std::string("occluded")));
+                        occluded.insert(name);
+                    }
+                    else
+                    {
+                        covered = mCovering.find(name) != mCovering.end() &&
+                            properties.opacity >= 100 && properties.scaleX == 1.0 && properties.scaleY == 1.0 &&
+                            properties.x == 0 && properties.y == 0 && properties.width >= screenWidth && properties.height >= screenHeight;
+                        planes.push_back(std::make_pair(name, std::string(covered ? "overlay" : "gl")));
+                    }
+                }
+
+                for (const std::string& name : occluded)
+                {
+                    if (mOccluded.find(name) == mOccluded.end())
+                    {
+                        CompositorController::setVisibility(name, false);
+                    }
+                }
+                for (const std::string& name : mOccluded)
+                {
+                    if (occluded.find(name) == occluded.end() && hasPlane(planes, name))
+                    {
+                        CompositorController::setVisibility(name, true);
+                    }
+                }
+                mOccluded.swap(occluded);
+                mPlanes = planes;
+                snapshot.planes.swap(planes);
+            }
+
+        private:
+            static std::string toLower(const std::string& client)
+            {
+                std::string name(client);
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                return name;
+            }
+
+            static bool hasPlane(const std::vector<std::pair<std::string, std::string>>& planes, const std::string& name)
+            {
+                for (size_t i = 0; i < planes.size(); i++)
+                {
+                    if (planes[i].first == name)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::set<std::string> mCovering;
+            std::set<std::string> mOccluded;
+            std::vector<std::pair<std::string, std::string>> mPlanes;
+        };
+
+        static PlanePolicy gPlanePolicy;
+
+        // must be called with gRdkShellMutex held
+        static void publishCompositorSnapshot()
+        {
+            std::shared_ptr<CompositorSnapshot> snapshot = std::make_shared<CompositorSnapshot>();
+            CompositorController::getClients(snapshot->clients);
+            CompositorController::getZOrder(snapshot->zOrder);
+            for (const std::string& client : snapshot->clients)
+            {
+                CompositorSnapshot::Client properties;
+                properties.scaleX = properties.scaleY = 1.0;
+                if (CompositorController::getBounds(client, properties.x, properties.y, properties.width, properties.height) &&
+                    CompositorController::getVisibility(client, properties.visible) &&
+                    CompositorController::getOpacity(client, properties.opacity) &&
+                    CompositorController::getScale(client, properties.scaleX, properties.scaleY))
+                {
+                    std::string name(client);
+                    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                    properties.visible = properties.visible || gPlanePolicy.occluded(name);
+                    snapshot->properties[name] = properties;
+                }
+            }
+            gPlanePolicy.assign(*snapshot);
+            std::atomic_store(&gCompositorSnapshot, std::shared_ptr<const CompositorSnapshot>(snapshot));
+            gRdkShellMutex.published();
+        }
+
+        // must be called with gRdkShellMutex held. Nothing took the lock since the last snapshot,
+        // it is still current unless clients connected or went away or an animation is running.
+        static void refreshCompositorSnapshot()
+        {
+            std::shared_ptr<const CompositorSnapshot> current = std::atomic_load(&gCompositorSnapshot);
+            bool stale = gRdkShellMutex.changed() || !current || RdkShell::milliseconds() < gCompositorAnimatingUntil;
+            if (!stale)
+            {
+                std::vector<std::string> clients, zOrder;
+                CompositorController::getClients(clients);
+                CompositorController::getZOrder(zOrder);
+                stale = (clients != current->clients) || (zOrder != current->zOrder);
+            }
+            if (stale)
+            {
+                publishCompositorSnapshot();
+            }
+        }
+
+        // Requests that changed the compositor mark the snapshot stale when they lock, the reads
+        // following them take the locked path until the next frame has published their result.
+        static std::shared_ptr<const CompositorSnapshot> loadCompositorSnapshot()
+        {
+            if (gRdkShellMutex.changed())
+            {
+                return std::shared_ptr<const CompositorSnapshot>();
+            }
+            return std::atomic_load(&gCompositorSnapshot);
+        }
+
+        // One entry of an applyTransaction request, validated before anything is applied.
+        struct WindowMutation
+        {
+            std::string mOperation;
+            std::string mCallsign;  // as given, for the plugin lookups
+            std::string mClient;    // lower case, as known to the compositor
+            std::string mTarget;
+            bool mHasX, mHasY, mHasW, mHasH;
+            unsigned int mX, mY, mW, mH;
+            bool mVisible;
+            unsigned int mOpacity;
+            bool mHasScaleX, mHasScaleY;
+            double mScaleX, mScaleY;
+        };
+
+        static bool hasClient(const std::vector<std::string>& clients, const std::string& client)
+        {
+            for (size_t i = 0; i < clients.size(); i++)
+            {
+                if (strcasecmp(clients[i].c_str(), client.c_str()) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static bool parseWindowMutation(const JsonObject& parameters, const std::vector<std::string>& clients, WindowMutation& mutation, std::string& error)
+        {
+            mutation = WindowMutation();
+            mutation.mOperation = parameters["op"].String();
+            mutation.mCallsign = parameters.HasLabel("client") ? parameters["client"].String() : parameters["callsign"].String();
+            mutation.mClient = mutation.mCallsign;
+            std::transform(mutation.mClient.begin(), mutation.mClient.end(), mutation.mClient.begin(), ::tolower);
+            if (mutation.mClient.empty() || !hasClient(clients, mutation.mClient))
+            {
+                error = "unknown client " + mutation.mClient;
+                return false;
+            }
+
+            if (mutation.mOperation == "setBounds")
+            {
+                mutation.mHasX = parameters.HasLabel("x");
+                mutation.mHasY = parameters.HasLabel("y");
+                mutation.mHasW = parameters.HasLabel("w");
+                mutation.mHasH = parameters.HasLabel("h");
+                mutation.mX = mutation.mHasX ? parameters["x"].Number() : 0;
+                mutation.mY = mutation.mHasY ? parameters["y"].Number() : 0;
+                mutation.mW = mutation.mHasW ? parameters["w"].Number() : 0;
+                mutation.mH = mutation.mHasH ? parameters["h"].Number() : 0;
+            }
+            else if (mutation.mOperation == "setVisibility")
+            {
+                if (!parameters.HasLabel("visible"))
+                {
+                    error = "please specify visibility (visible = true/false)";
+                    return false;
+                }
+                mutation.mVisible = parameters["visible"].Boolean();
+            }
+            else if (mutation.mOperation == "setOpacity")
+            {
+                if (!parameters.HasLabel("opacity"))
+                {
+                    error = "please specify opacity";
+                    return false;
+                }
+                mutation.mOpacity = parameters["opacity"].Number();
+            }
+            else if (mutation.mOperation == "setScale")
+            {
+                mutation.mHasScaleX = parameters.HasLabel("sx");
+                mutation.mHasScaleY = parameters.HasLabel("sy");
+                if (!mutation.mHasScaleX && !mutation.mHasScaleY)
+                {
+                    error = "please specify sx and/or sy";
+                    return false;
+                }
+                try
+                {
+                    mutation.mScaleX = mutation.mHasScaleX ? std::stod(parameters["sx"].String()) : 1.0;
+                    mutation.mScaleY = mutation.mHasScaleY ? std::stod(parameters["sy"].String()) : 1.0;
+                }
+                catch(...)
+                {
+                    error = "invalid sx or sy";
+                    return false;
+                }
+            }
+            else if (mutation.mOperation == "moveBehind")
+            {
+                mutation.mTarget = parameters["target"].String();
+                std::transform(mutation.mTarget.begin(), mutation.mTarget.end(), mutation.mTarget.begin(), ::tolower);
+                if (mutation.mTarget.empty() || !hasClient(clients, mutation.mTarget))
+                {
+                    error = "unknown target " + mutation.mTarget;
+                    return false;
+                }
+            }
+            else if (mutation.mOperation != "moveToFront" && mutation.mOperation != "moveToBack")
+            {
+                error = "unsupported op " + mutation.mOperation;
+                return false;
+            }
+            return true;
+        }
+
+        // must be called with gRdkShellMutex held
+        static bool applyWindowMutation(const WindowMutation& mutation)
+        {
+            const std::string& client = mutation.mClient;
+            if (mutation.mOperation == "setBounds")
+            {
+                unsigned int x = 0, y = 0, w = 0, h = 0;
+                CompositorController::getBounds(client, x, y, w, h);
+                x = mutation.mHasX ? mutation.mX : x;
+                y = mutation.mHasY ? mutation.mY : y;
+                w = mutation.mHasW ? mutation.mW : w;
+                h = mutation.mHasH ? mutation.mH : h;
+                CompositorController::setBounds(client, 0, 0, 1, 1); //forcing a compositor resize flush
+                return CompositorController::setBounds(client, x, y, w, h);
+            }
+            else if (mutation.mOperation == "setVisibility")
+            {
+                gPlanePolicy.visibilityRequested(client);
+                return CompositorController::setVisibility(client, mutation.mVisible);
+            }
+            else if (mutation.mOperation == "setOpacity")
+            {
+                return CompositorController::setOpacity(client, mutation.mOpacity);
+            }
+            else if (mutation.mOperation == "setScale")
+            {
+                double scaleX = 1.0, scaleY = 1.0;
+                CompositorController::getScale(client, scaleX, scaleY);
+                scaleX = mutation.mHasScaleX ? mutation.mScaleX : scaleX;
+                scaleY = mutation.mHasScaleY ? mutation.mScaleY : scaleY;
+                return CompositorController::setScale(client, scaleX, scaleY);
+            }
+            else if (mutation.mOperation == "moveToFront")
+            {
+                return CompositorController::moveToFront(client);
+            }
+            else if (mutation.mOperation == "moveToBack")
+            {
+                return CompositorController::moveToBack(client);
+            }
+            else if (mutation.mOperation == "moveBehind")
+            {
+                return CompositorController::moveBehind(client, mutation.mTarget);
+            }
+            return false;
+        }
+
+        // Parameters of the pending getScreenshot request, guarded by gRdkShellMutex like needsScreenshot.
+        // The shell loop only reads the frame back, scaling, encoding and delivery run on the
+        // request workers.
+        struct ScreenshotRequest
+        {
+            ScreenshotRequest() : mDelivery("event"), mFormat("native"), mWidth(0), mHeight(0), mQuality(RDKSHELL_SCREENSHOT_DEFAULT_QUALITY) {}
+
+            std::string mDelivery;  // event, memfd or file
+            std::string mFormat;    // native or jpeg
+            unsigned int mWidth;    // 0 keeps the captured size
+            unsigned int mHeight;
+            int mQuality;
+        };
+
+        static ScreenshotRequest gScreenshotRequest;
+        static std::mutex gScreenshotMutex;
+        static int gScreenshotFd = -1;
+        static std::string gScreenshotFile;
+        static uint32_t gScreenshotCount = 0;
+
+        // Row y of the image counted from the top. The compositor reads the frame back bottom-up
+        // (the ScreenCapture path flips it with a negative stride for the same reason).
+        static inline const uint8_t* screenshotRow(const uint8_t* data, unsigned int width, unsigned int height, unsigned int y, bool bottomUp)
+        {
+            return data + (size_t)(bottomUp ? (height - 1 - y) : y) * width * 4;
+        }
+
+        // Box filter, only for uncompressed RGBA captures. The result is top-down.
+        static std::vector<uint8_t> scaleScreenshot(const uint8_t* data, unsigned int width, unsigned int height, bool bottomUp, unsigned int newWidth, unsigned int newHeight)
+        {
+            std::vector<uint8_t> scaled(newWidth * newHeight * 4);
+            for (unsigned int y = 0; y < newHeight; y++)
+            {
+                unsigned int top = (y * height) / newHeight;
+                unsigned int bottom = std::max(top + 1, ((y + 1) * height) / newHeight);
+                for (unsigned int x = 0; x < newWidth; x++)
+                {
+                    unsigned int left = (x * width) / newWidth;
+                    unsigned int right = std::max(left + 1, ((x + 1) * width) / newWidth);
+                    uint32_t sum[4] = { 0, 0, 0, 0 };
+                    for (unsigned int sy = top; sy < bottom; sy++)
+                    {
+                        const uint8_t* pixel = screenshotRow(data, width, height, sy, bottomUp) + left * 4;
+                        for (unsigned int sx = left; sx < right; sx++, pixel += 4)
+                        {
+                            sum[0] += pixel[0];
+                            sum[1] += pixel[1];
+                            sum[2] += pixel[2];
+                            sum[3] += pixel[3];
+                        }
+                    }
+                    uint32_t count = (bottom - top) * (right - left);
+                    uint8_t* out = &scaled[(y * newWidth + x) * 4];
+                    for (int c = 0; c < 4; c++)
+                    {
+                        out[c] = sum[c] / count;
+                    }
+                }
+            }
+            return scaled;
+        }
+
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+        static bool encodeScreenshotJpeg(const uint8_t* data, unsigned int width, unsigned int height, bool bottomUp, int quality, std::vector<uint8_t>& encoded)
+        {
+            struct jpeg_compress_struct cinfo;
+            struct jpeg_error_mgr jerr;
+            unsigned char* buffer = nullptr;
+            unsigned long size = 0;
+
+            cinfo.err = jpeg_std_error(&jerr);
+            jpeg_create_compress(&cinfo);
+            jpeg_mem_dest(&cinfo, &buffer, &size);
+            cinfo.image_width = width;
+            cinfo.image_height = height;
+            cinfo.input_components = 3;
+            cinfo.in_color_space = JCS_RGB;
+            jpeg_set_defaults(&cinfo);
+            jpeg_set_quality(&cinfo, quality, TRUE);
+            jpeg_start_compress(&cinfo, TRUE);
+
+            std::vector<uint8_t> row(width * 3);
+            while (cinfo.next_scanline < cinfo.image_height)
+            {
+                const uint8_t* pixel = screenshotRow(data, width, height, cinfo.next_scanline, bottomUp);
+                for (unsigned int x = 0; x < width; x++, pixel += 4)
+                {
+                    row[x * 3] = pixel[0];
+                    row[x * 3 + 1] = pixel[1];
+                    row[x * 3 + 2] = pixel[2];
+                }
+                JSAMPROW rowPointer = &row[0];
+                jpeg_write_scanlines(&cinfo, &rowPointer, 1);
+            }
+            jpeg_finish_compress(&cinfo);
+            jpeg_destroy_compress(&cinfo);
+
+            encoded.assign(buffer, buffer + size);
+            free(buffer);
+            return size > 0;
+        }
+#endif
+
+        // The screenshot files only go to RDKSHELL_SCREENSHOT_DIRECTORY, under a name of our own. The
+        // directory has to be ours and not a link, the file is created new and never followed.
+        static int createScreenshotFile(const std::string& format, std::string& path)
+        {
+            static uint32_t sequence = 0;   // under gScreenshotMutex
+            struct stat info;
+            if (mkdir(RDKSHELL_SCREENSHOT_DIRECTORY, 0755) != 0 && errno != EEXIST)
+            {
+                return -1;
+            }
+            if (lstat(RDKSHELL_SCREENSHOT_DIRECTORY, &info) != 0 || !S_ISDIR(info.st_mode) || info.st_uid != geteuid())
+            {
+                errno = EPERM;
+                return -1;
+            }
+            path = std::string(RDKSHELL_SCREENSHOT_DIRECTORY) + "/screenshot-" + std::to_string(getpid()) + "-" + std::to_string(++sequence) + "." + (format == "jpeg" ? "jpg" : format);
+            unlink(path.c_str());
+            return open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+        }
+
+        // Writes the image to a sealed memfd (or a file when memfd is not available) and
+        // keeps the descriptor of the latest capture open until the next one replaces it.
+        // Only the latest screenshot file is kept as well.
+        static bool writeScreenshotHandle(const ScreenshotRequest& request, const std::string& format, const uint8_t* data, size_t size, JsonObject& params)
+        {
+            std::lock_guard<std::mutex> lock(gScreenshotMutex);
+            if (gScreenshotFd >= 0)
+            {
+                close(gScreenshotFd);
+                gScreenshotFd = -1;
+            }
+            if (!gScreenshotFile.empty())
+            {
+                unlink(gScreenshotFile.c_str());
+                gScreenshotFile.clear();
+            }
+
+            std::string path;
+            int fd = -1;
+            bool isMemfd = false;
+#ifdef SYS_memfd_create
+            if (request.mDelivery == "memfd")
+            {
+                fd = syscall(SYS_memfd_create, "rdkshell-screenshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+                isMemfd = (fd >= 0);
+            }
+#endif
+            if (fd < 0)
+            {
+                fd = createScreenshotFile(format, path);
+            }
+            if (fd < 0)
+            {
+                std::cout << "unable to create screenshot handle " << strerror(errno) << std::endl;
+                return false;
+            }
+
+            size_t written = 0;
+            while (written < size)
+            {
+                ssize_t ret = write(fd, data + written, size - written);
+                if (ret < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (ret <= 0)
+                {
+                    std::cout << "unable to write screenshot " << strerror(errno) << std::endl;
+                    close(fd);
+                    if (!isMemfd)
+                    {
+                        unlink(path.c_str());
+                    }
+                    return false;
+                }
+                written += ret;
+            }
+
+            if (isMemfd)
+            {
+#ifdef F_ADD_SEALS
+                fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+                path = "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(fd);
+                params["fd"] = fd;
+                params["pid"] = (uint32_t)getpid();
+                gScreenshotFd = fd;
+            }
+            else
+            {
+                close(fd);
+                gScreenshotFile = path;
+            }
+            params["delivery"] = isMemfd ? "memfd" : "file";
+            params["path"] = path;
+            params["size"] = (uint32_t)size;
+            return true;
+        }
+
+        // Scales and encodes the capture as requested and fills in the onScreenshotComplete parameters.
+        static bool prepareScreenshot(const ScreenshotRequest& request, const std::shared_ptr<uint8_t>& image, size_t size, unsigned int width, unsigned int height, JsonObject& params)
+        {
+            const uint8_t* data = image.get();
+            std::vector<uint8_t> converted;
+            std::string format = "native";
+            // As read back by the compositor, until the scaler turns it around
+            bool bottomUp = true;
+            if (width > 0 && height > 0 && size == (size_t)width * height * 4)
+            {
+                format = "rgba";
+                if (request.mWidth > 0 && request.mHeight > 0 && (request.mWidth < width || request.mHeight < height))
+                {
+                    unsigned int newWidth = std::min(request.mWidth, width);
+                    unsigned int newHeight = std::min(request.mHeight, height);
+                    converted = scaleScreenshot(data, width, height, bottomUp, newWidth, newHeight);
+                    width = newWidth;
+                    height = newHeight;
+                    bottomUp = false;
+                    data = &converted[0];
+                    size = converted.size();
+                }
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+                if (request.mFormat == "jpeg")
+                {
+                    std::vector<uint8_t> encoded;
+                    if (encodeScreenshotJpeg(data, width, height, bottomUp, request.mQuality, encoded))
+                    {
+                        converted.swap(encoded);
+                        data = &converted[0];
+                        size = converted.size();
+                        format = "jpeg";
+                    }
+                    else
+                    {
+                        std::cout << "unable to encode screenshot as jpeg, sending rgba" << std::endl;
+                    }
+                }
+#endif
+            }
+            else if (request.mWidth > 0 || request.mFormat != "native")
+            {
+                std::cout << "screenshot is not raw rgba, sending it unchanged" << std::endl;
+                width = height = 0;
+            }
+
+            if (width > 0)
+            {
+                params["width"] = width;
+                params["height"] = height;
+            }
+            if (format == "rgba")
+            {
+                params["rowOrder"] = bottomUp ? "bottomup" : "topdown";
+            }
+            params["format"] = format;
+
+            if (request.mDelivery == "event")
+            {
+                size_t encodedImageSize = b64_get_encoded_buffer_size(size);
+                uint8_t *encodedImage = (uint8_t*)malloc(encodedImageSize);
+                b64_encode(data, size, encodedImage);
+                params["imageData"] = string(reinterpret_cast<const char*>(encodedImage), encodedImageSize);
+                free(encodedImage);
+                return true;
+            }
+            return writeScreenshotHandle(request, format, data, size, params);
+        }
+
+        // Pre-activated, suspended plugin instances that launch can claim, configured with
+        // RDKSHELL_LAUNCH_POOL="<type>:<count>,...". Instances are clones named <type>Pool<n>;
+        // a claimed instance keeps its name and a new clone is warmed up in its place.
+        class LaunchPool
+        {
+        public:
+            LaunchPool() : mClaims(0), mMisses(0) {}
+
+            void configure(const std::string& config)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mSizes.clear();
+                std::stringstream stream(config);
+                std::string item;
+                while (std::getline(stream, item, ','))
+                {
+                    size_t separator = item.find(':');
+                    std::string type = item.substr(0, separator);
+                    int size = (separator == std::string::npos) ? 1 : atoi(item.c_str() + separator + 1);
+                    if (!type.empty() && size > 0)
+                    {
+                        mSizes[type] = size;
+                        std::cout << "rdkshell launch pool: " << size << " x " << type << std::endl;
+                    }
+                }
+            }
+
+            // instances to warm up now as (type, callsign) pairs
+            std::vector<std::pair<std::string, std::string>> takeFills()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::vector<std::pair<std::string, std::string>> fills;
+                for (std::map<std::string, uint32_t>::iterator size = mSizes.begin(); size != mSizes.end(); ++size)
+                {
+                    const std::string& type = size->first;
+                    if (mFailures[type] >= RDKSHELL_LAUNCH_POOL_MAX_FAILURES)
+                    {
+                        continue;
+                    }
+                    uint32_t available = 0;
+                    for (std::map<std::string, Entry>::iterator entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+                    {
+                        if (entry->second.mType == type && entry->second.mState != CLAIMED)
+                        {
+                            available++;
+                        }
+                    }
+                    for (uint32_t index = 0; available < size->second; index++)
+                    {
+                        std::string callsign = type + "Pool" + std::to_string(index);
+                        if (mEntries.find(callsign) == mEntries.end())
+                        {
+                            mEntries[callsign] = Entry(type, WARMING);
+                            fills.push_back(std::make_pair(type, callsign));
+                            available++;
+                        }
+                    }
+                }
+                return fills;
+            }
+
+            void warmed(const std::string& callsign, bool success)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<std::string, Entry>::iterator entry = mEntries.find(callsign);
+                if (entry == mEntries.end())
+                {
+                    return;
+                }
+                if (success)
+                {
+                    entry->second.mState = READY;
+                    mFailures[entry->second.mType] = 0;
+                }
+                else
+                {
+                    std::cout << "rdkshell launch pool: unable to warm up " << callsign << std::endl;
+                    mFailures[entry->second.mType]++;
+                    mEntries.erase(entry);
+                }
+            }
+
+            bool claim(const std::string& type, std::string& callsign)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mSizes.find(type) == mSizes.end())
+                {
+                    return false;
+                }
+                for (std::map<std::string, Entry>::iterator entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+                {
+                    if (entry->second.mType == type && entry->second.mState == READY)
+                    {
+                        entry->second.mState = CLAIMED;
+                        callsign = entry->first;
+                        mClaims++;
+                        return true;
+                    }
+                }
+                mMisses++;
+                return false;
+            }
+
+            // a warming or ready instance that was not launched yet
+            bool isSpare(const std::string& callsign)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<std::string, Entry>::iterator entry = mEntries.find(callsign);
+                return (entry != mEntries.end()) && (entry->second.mState != CLAIMED);
+            }
+
+            // returns true if the instance belonged to the pool
+            bool release(const std::string& callsign)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<std::string, Entry>::iterator entry = mEntries.find(callsign);
+                if (entry == mEntries.end() || entry->second.mState == WARMING)
+                {
+                    return false;
+                }
+                mEntries.erase(entry);
+                return true;
+            }
+
+            void getStats(JsonObject& stats)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                JsonArray types;
+                for (std::map<std::string, uint32_t>::iterator size = mSizes.begin(); size != mSizes.end(); ++size)
+                {
+                    JsonObject type;
+                    uint32_t count[3] = { 0, 0, 0 };
+                    for (std::map<std::string, Entry>::iterator entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+                    {
+                        if (entry->second.mType == size->first)
+                        {
+                            count[entry->second.mState]++;
+                        }
+                    }
+                    type["type"] = size->first;
+                    type["size"] = size->second;
+                    type["warming"] = count[WARMING];
+                    type["ready"] = count[READY];
+                    type["claimed"] = count[CLAIMED];
+                    types.Add(type);
+                }
+                stats["types"] = types;
+                stats["claims"] = mClaims;
+                stats["misses"] = mMisses;
+            }
+
+        private:
+            enum State { WARMING = 0, READY, CLAIMED };
+            struct Entry
+            {
+                Entry() : mState(WARMING) {}
+                Entry(const std::string& type, State state) : mType(type), mState(state) {}
+                std::string mType;
+                State mState;
+            };
+
+            std::mutex mMutex;
+            std::map<std::string, uint32_t> mSizes;
+            std::map<std::string, Entry> mEntries;
+            std::map<std::string, uint32_t> mFailures;
+            uint64_t mClaims;
+            uint64_t mMisses;
+        };
+
+        static LaunchPool gLaunchPool;
+
+        // Phase timing of the last launches. The first frame arrives after launch has
+        // returned and is filled in when onApplicationFirstFrame is received.
+        class LaunchTraces
+        {
+        public:
+            struct Trace
+            {
+                std::string mCallsign;
+                std::string mType;
+                std::string mLaunchType;
+                bool mPooled;
+                bool mSuccess;
+                double mStart;
+                double mDisplayMs;
+                double mConfigureMs;
+                double mActivateMs;
+                double mSetupMs;
+                double mTotalMs;
+                double mFirstFrameMs;     // < 0 until the first frame
+            };
+
+            LaunchTraces() : mNext(0) {}
+
+            void add(const Trace& trace)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mTraces.size() < RDKSHELL_LAUNCH_TRACE_COUNT)
+                {
+                    mTraces.push_back(trace);
+                }
+                else
+                {
+                    mTraces[mNext] = trace;
+                }
+                mNext = (mNext + 1) % RDKSHELL_LAUNCH_TRACE_COUNT;
+            }
+
+            void firstFrame(const std::string& client, double now)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (size_t i = 1; i <= mTraces.size(); i++)
+                {
+                    Trace& trace = mTraces[(mNext + RDKSHELL_LAUNCH_TRACE_COUNT - i) % RDKSHELL_LAUNCH_TRACE_COUNT];
+                    if (strcasecmp(trace.mCallsign.c_str(), client.c_str()) == 0)
+                    {
+                        if (trace.mFirstFrameMs < 0 && trace.mSuccess)
+                        {
+                            trace.mFirstFrameMs = now - trace.mStart;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            static void toJson(const Trace& trace, JsonObject& timing)
+            {
+                timing["displayMs"] = trace.mDisplayMs;
+                timing["configureMs"] = trace.mConfigureMs;
+                timing["activateMs"] = trace.mActivateMs;
+                timing["setupMs"] = trace.mSetupMs;
+                timing["totalMs"] = trace.mTotalMs;
+                if (trace.mFirstFrameMs >= 0)
+                {
+                    timing["firstFrameMs"] = trace.mFirstFrameMs;
+                }
+            }
 
-          template <typename PARAMETERS, typename RESPONSE>
-          uint32_t Invoke(const uint32_t waitTime, const string& method, const PARAMETERS& parameters, RESPONSE& response, bool isResponseString=false)
-          {
-            if (dispatcher_ == nullptr) {
-              std::cout << "No JSON RPC dispatcher for " << mCallSign << '\n';
-              return Core::ERROR_GENERAL;
+            void getTraces(JsonArray& traces)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (size_t i = mTraces.size(); i > 0; i--)
+                {
+                    const Trace& trace = mTraces[(mNext + RDKSHELL_LAUNCH_TRACE_COUNT - i) % RDKSHELL_LAUNCH_TRACE_COUNT];
+                    JsonObject entry;
+                    entry["callsign"] = trace.mCallsign;
+                    entry["type"] = trace.mType;
+                    entry["launchType"] = trace.mLaunchType;
+                    entry["pooled"] = trace.mPooled;
+                    entry["success"] = trace.mSuccess;
+                    toJson(trace, entry);
+                    traces.Add(entry);
+                }
             }
 
-            auto message = Message();
+        private:
+            std::mutex mMutex;
+            std::vector<Trace> mTraces;
+            size_t mNext;
+        };
 
-            message->JSONRPC = Core::JSONRPC::Message::DefaultVersion;
-            message->Id = Core::JSON::DecUInt32(++mId);
-            message->Designator = Core::JSON::String(mCallSign + ".1." + method);
+        static LaunchTraces gLaunchTraces;
 
-            ToMessage(parameters, message);
+        // Reclaims memory from background applications when the compositor reports low RAM:
+        // the least recently focused ones are suspended on a low RAM warning and destroyed
+        // on a critically low one. Off unless RDKSHELL_MEMORY_POLICY is set or setMemoryPolicy
+        // enables it.
+        class MemoryPolicy
+        {
+        public:
+            struct Config
+            {
+                Config() : mEnabled(false), mLowAction("suspend"), mCriticalAction("destroy"), mTargetFreeKb(0), mMaxActions(RDKSHELL_MEMORY_POLICY_DEFAULT_MAX_ACTIONS)
+                {
+                    mProtected.push_back(RESIDENTAPP_CALLSIGN);
+                }
 
-            const uint32_t channelId = ~0;
-            auto resp =  dispatcher_->Invoke(sThunderSecurityToken, channelId, *message);
-            if (resp->Error.IsSet()) {
-              std::cout << "Call failed: " << message->Designator.Value() << " error: " <<  resp->Error.Text.Value() << "\n";
-              return resp->Error.Code;
+                bool isProtected(const std::string& callsign) const
+                {
+                    for (size_t i = 0; i < mProtected.size(); i++)
+                    {
+                        if (strcasecmp(mProtected[i].c_str(), callsign.c_str()) == 0)
+                        {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                bool mEnabled;
+                std::string mLowAction;         // none, suspend or destroy
+                std::string mCriticalAction;
+                uint32_t mTargetFreeKb;         // 0: one application per warning
+                uint32_t mMaxActions;
+                std::vector<std::string> mProtected;
+            };
+
+            struct Action
+            {
+                std::string mCallsign;
+                std::string mAction;
+                std::string mReason;
+                int32_t mMemoryKb;
+                int32_t mFreeKb;
+                bool mSuccess;
+            };
+
+            MemoryPolicy() : mNext(0) {}
+
+            Config config()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                return mConfig;
             }
 
-            if (!FromMessage(response, resp, isResponseString))
-              return Core::ERROR_GENERAL;
+            void setConfig(const Config& config)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mConfig = config;
+            }
 
-            return Core::ERROR_NONE;
-          }
-        };
+            void focused(const std::string& callsign)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mLastFocused[toLower(callsign)] = RdkShell::milliseconds();
+            }
 
-        class StateControlNotification: public PluginHost::IStateControl::INotification
-        {
-          RDKShell& mRDKShell;
-          std::string mCallSign;
-          bool mLaunchEnabled { false };
-        public:
-          StateControlNotification(std::string callsign, RDKShell& shell)
-            : mRDKShell(shell)
-            , mCallSign(callsign)
-          {
-          }
+            void forget(const std::string& callsign)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mLastFocused.erase(toLower(callsign));
+            }
 
-          void enableLaunch(bool enable)
-          {
-            mLaunchEnabled = enable;
-          }
+            // 0 if never focused
+            double lastFocused(const std::string& callsign)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<std::string, double>::iterator entry = mLastFocused.find(toLower(callsign));
+                return entry == mLastFocused.end() ? 0 : entry->second;
+            }
 
-          void StateChange(const PluginHost::IStateControl::state state) override
-          {
-            bool isSuspended = (state == PluginHost::IStateControl::SUSPENDED);
-            if (mLaunchEnabled)
+            void addAction(const Action& action)
             {
-               JsonObject params;
-               params["client"] = mCallSign;
-               params["launchType"] = (isSuspended)?"suspend":"resume";
-               mRDKShell.notify(RDKShell::RDKSHELL_EVENT_ON_LAUNCHED, params);
-               mLaunchEnabled = false;
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mActions.size() < RDKSHELL_MEMORY_POLICY_ACTION_COUNT)
+                {
+                    mActions.push_back(action);
+                }
+                else
+                {
+                    mActions[mNext] = action;
+                }
+                mNext = (mNext + 1) % RDKSHELL_MEMORY_POLICY_ACTION_COUNT;
             }
 
-            if (isSuspended)
+            static void toJson(const Action& action, JsonObject& entry)
             {
-                JsonObject params;
-                params["client"] = mCallSign;
-                mRDKShell.notify(RDKShell::RDKSHELL_EVENT_ON_PLUGIN_SUSPENDED, params);
-            }            
-          }
+                entry["callsign"] = action.mCallsign;
+                entry["action"] = action.mAction;
+                entry["reason"] = action.mReason;
+                entry["memoryKb"] = action.mMemoryKb;
+                entry["freeKb"] = action.mFreeKb;
+                entry["success"] = action.mSuccess;
+            }
 
-          BEGIN_INTERFACE_MAP(Notification)
-          INTERFACE_ENTRY(PluginHost::IStateControl::INotification)
-          END_INTERFACE_MAP
-        };
+            void getActions(JsonArray& actions)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (size_t i = mActions.size(); i > 0; i--)
+                {
+                    JsonObject entry;
+                    toJson(mActions[(mNext + RDKSHELL_MEMORY_POLICY_ACTION_COUNT - i) % RDKSHELL_MEMORY_POLICY_ACTION_COUNT], entry);
+                    actions.Add(entry);
+                }
+            }
 
-        std::map<std::string, StateControlNotification*> gStateNotifications;
+        private:
+            static std::string toLower(const std::string& callsign)
+            {
+                std::string name(callsign);
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                return name;
+            }
 
-        struct RDKShellStartupConfig
-        {
-            std::string rfc;
-            std::string thunderApi;
-            JsonObject params;
+            std::mutex mMutex;
+            Config mConfig;
+            std::map<std::string, double> mLastFocused;
+            std::vector<Action> mActions;
+            size_t mNext;
         };
 
-        std::map<std::string, PluginData> gActivePluginsData;
-        std::map<std::string, PluginStateChangeData*> gPluginsEventListener;
-        std::vector<RDKShellStartupConfig> gStartupConfigs;
-        std::map<std::string, bool> gDestroyApplications;
-        std::map<std::string, bool> gLaunchApplications;
-        
-        uint32_t getKeyFlag(std::string modifier)
-        {
-          uint32_t flag = 0;
-          if (0 == modifier.compare("ctrl"))
-          {
-            flag = RDKSHELL_FLAGS_CONTROL;
-          }
-          else if (0 == modifier.compare("shift"))
-          {
-            flag = RDKSHELL_FLAGS_SHIFT;
-          }
-          else if (0 == modifier.compare("alt"))
-          {
-            flag = RDKSHELL_FLAGS_ALT;
-          }
-          return flag;
-        }
+        static MemoryPolicy gMemoryPolicy;
 
-        SERVICE_REGISTRATION(RDKShell, 1, 0);
+        // Graphics memory budgets per client, checked every RDKSHELL_GRAPHICS_MEMORY_CHECK_INTERVAL_MS
+        // while there are any. A client over its budget is notified once, and suspended if its budget
+        // says so, until it is back under it.
+        class GraphicsMemoryBudgets
+        {
+        public:
+            struct Budget
+            {
+                Budget() : mBudgetKb(0), mSuspend(false), mExceeded(false) {}
 
-        RDKShell* RDKShell::_instance = nullptr;
-        std::mutex gRdkShellMutex;
-        std::mutex gPluginDataMutex;
-        std::mutex gLaunchDestroyMutex;
-        std::mutex gDestroyMutex;
+                std::string mCallsign;      // as given, for the suspend request
+                uint32_t mBudgetKb;
+                bool mSuspend;
+                bool mExceeded;
+            };
 
-        std::mutex gLaunchMutex;
-        int32_t gLaunchCount = 0;
+            // a budget of 0 removes it, false if there are none left
+            bool set(const std::string& client, const uint32_t budgetKb, const bool suspend)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (budgetKb == 0)
+                {
+                    mBudgets.erase(toLower(client));
+                }
+                else
+                {
+                    Budget& budget = mBudgets[toLower(client)];
+                    budget.mCallsign = client;
+                    budget.mBudgetKb = budgetKb;
+                    budget.mSuspend = suspend;
+                    budget.mExceeded = false;
+                }
+                return !mBudgets.empty();
+            }
 
-        static std::thread shellThread;
+            bool get(const std::string& client, Budget& budget)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<std::string, Budget>::iterator entry = mBudgets.find(toLower(client));
+                if (entry == mBudgets.end())
+                {
+                    return false;
+                }
+                budget = entry->second;
+                return true;
+            }
 
-        struct CreateDisplayRequest
-        {
-            CreateDisplayRequest(std::string client, std::string displayName, uint32_t displayWidth=0, uint32_t displayHeight=0, bool virtualDisplayEnabled=false, uint32_t virtualWidth=0, uint32_t virtualHeight=0, bool topmost = false, bool focus = false): mClient(client), mDisplayName(displayName), mDisplayWidth(displayWidth), mDisplayHeight(displayHeight), mVirtualDisplayEnabled(virtualDisplayEnabled), mVirtualWidth(virtualWidth),mVirtualHeight(virtualHeight), mTopmost(topmost), mFocus(focus), mResult(false)
+            // true only when client goes over its budget, not while it stays over it
+            bool exceeded(const std::string& client, const bool over)
             {
-                sem_init(&mSemaphore, 0, 0);
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<std::string, Budget>::iterator entry = mBudgets.find(toLower(client));
+                if (entry == mBudgets.end())
+                {
+                    return false;
+                }
+                bool crossed = over && !entry->second.mExceeded;
+                entry->second.mExceeded = over;
+                return crossed;
             }
-  
-            ~CreateDisplayRequest()
+
+        private:
+            static std::string toLower(const std::string& client)
             {
-                sem_destroy(&mSemaphore);
+                std::string name(client);
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                return name;
             }
 
-            std::string mClient;
-            std::string mDisplayName;
-            uint32_t mDisplayWidth;
-            uint32_t mDisplayHeight;
-            bool mVirtualDisplayEnabled;
-            uint32_t mVirtualWidth;
-            uint32_t mVirtualHeight;
-            bool mTopmost;
-            bool mFocus;
-            sem_t mSemaphore;
-            bool mResult;
+            std::mutex mMutex;
+            std::map<std::string, Budget> mBudgets;
         };
 
-        struct KillClientRequest
+        static GraphicsMemoryBudgets gGraphicsMemoryBudgets;
+
+        // GPU memory of a process in kB, as the DRM driver accounts it in the fdinfo of the device
+        // files (drm-total-* or the older drm-memory-* keys, Linux 5.19 and later). Each DRM client
+        // is counted once however many fds share it. -1 if the driver does not account it.
+        static int64_t drmMemoryKb(const int pid)
         {
-            KillClientRequest(std::string client): mClient(client), mResult(false)
+            const std::string path = "/proc/" + std::to_string(pid) + "/fdinfo";
+            DIR* directory = opendir(path.c_str());
+            if (directory == nullptr)
             {
-                sem_init(&mSemaphore, 0, 0);
+                return -1;
             }
-  
-            ~KillClientRequest()
+
+            std::set<std::string> drmClients;
+            int64_t totalKb = -1;
+            struct dirent* entry;
+            while ((entry = readdir(directory)) != nullptr)
             {
-                sem_destroy(&mSemaphore);
+                if (entry->d_name[0] == '.')
+                {
+                    continue;
+                }
+                std::ifstream fdinfo(path + "/" + entry->d_name);
+                std::string line, clientId;
+                int64_t fdTotalKb = 0, fdMemoryKb = 0;
+                bool hasTotal = false, hasMemory = false;
+                while (std::getline(fdinfo, line))
+                {
+                    bool total = (line.compare(0, 10, "drm-total-") == 0);
+                    bool memory = (line.compare(0, 11, "drm-memory-") == 0);
+                    if (line.compare(0, 14, "drm-client-id:") == 0)
+                    {
+                        clientId = line.substr(14);
+                    }
+                    else if (total || memory)
+                    {
+                        size_t separator = line.find(':');
+                        if (separator == std::string::npos)
+                        {
+                            continue;
+                        }
+                        // bytes without a unit
+                        int64_t value = strtoll(line.c_str() + separator + 1, nullptr, 10);
+                        if (line.find("MiB") != std::string::npos)
+                        {
+                            value *= 1024;
+                        }
+                        else if (line.find("KiB") == std::string::npos)
+                        {
+                            value /= 1024;
+                        }
+                        (total ? fdTotalKb : fdMemoryKb) += value;
+                        hasTotal = hasTotal || total;
+                        hasMemory = hasMemory || memory;
+                    }
+                }
+                if ((hasTotal || hasMemory) && !clientId.empty() && drmClients.insert(clientId).second)
+                {
+                    totalKb = std::max(totalKb, (int64_t)0) + (hasTotal ? fdTotalKb : fdMemoryKb);
+                }
             }
-
-            std::string mClient;
-            sem_t mSemaphore;
-            bool mResult;
-        };
-
-        std::vector<std::shared_ptr<CreateDisplayRequest>> gCreateDisplayRequests;
-        std::vector<std::shared_ptr<KillClientRequest>> gKillClientRequests;
+            closedir(directory);
+            return totalKb;
+        }
 
         void RDKShell::launchRequestThread(RDKShellApiRequest apiRequest)
         {
-	    std::thread rdkshellRequestsThread = std::thread([=]() {
+            ApiRequestExecutor::Priority priority = ApiRequestExecutor::PRIORITY_NORMAL;
+            if ((apiRequest.mName.compare("launchFactoryApp") == 0) || (apiRequest.mName.compare("launchFactoryAppShortcut") == 0) ||
+                (apiRequest.mName.compare("launchResidentApp") == 0) || (apiRequest.mName.compare("toggleFactoryApp") == 0))
+            {
+                priority = ApiRequestExecutor::PRIORITY_HIGH;
+            }
+            else if ((apiRequest.mName.compare("deactivateresidentapp") == 0) || (apiRequest.mName.compare("exitAgingMode") == 0))
+            {
+                priority = ApiRequestExecutor::PRIORITY_LOW;
+            }
+
+            std::string key = apiRequest.mName;
+            std::string params;
+            apiRequest.mRequest.ToString(params);
+            key.append(params);
+
+            gApiRequestExecutor.submit(priority, key, [=]() {
                 JsonObject result;
                 std::string requestName = apiRequest.mName;
                 if (requestName.compare("launchFactoryApp") == 0)
@@ -492,9 +2464,36 @@ namespace WPEFramework {
                     auto thunderController = getThunderControllerClient();
                     JsonObject joResult;
                     uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, api.c_str(), apiRequest.mRequest, joResult);
+                    Utils::releaseThunderControllerClient(thunderController, status);
                 } 
             });
-            rdkshellRequestsThread.detach();
+        }
+
+        void RDKShell::warmLaunchPool()
+        {
+            std::vector<std::pair<std::string, std::string>> fills = gLaunchPool.takeFills();
+            for (size_t i = 0; i < fills.size(); i++)
+            {
+                const std::string type = fills[i].first;
+                const std::string callsign = fills[i].second;
+                bool submitted = gApiRequestExecutor.submit(ApiRequestExecutor::PRIORITY_LOW, "launchPool" + callsign, [=]() {
+                    JsonObject request, response;
+                    request["callsign"] = callsign;
+                    request["type"] = type;
+                    request["suspend"] = true;
+                    request["visible"] = false;
+                    request["focused"] = false;
+                    std::cout << "rdkshell launch pool: warming up " << callsign << std::endl;
+                    auto rdkShellClient = getThunderControllerClient("org.rdk.RDKShell.1");
+                    uint32_t status = rdkShellClient->Invoke(RDKSHELL_THUNDER_TIMEOUT, "launch", request, response);
+                    Utils::releaseThunderControllerClient(rdkShellClient, status);
+                    gLaunchPool.warmed(callsign, (status == 0) && response["success"].Boolean());
+                });
+                if (!submitted)
+                {
+                    gLaunchPool.warmed(callsign, false);
+                }
+            }
         }
 
         void lockRdkShellMutex()
@@ -593,6 +2592,7 @@ namespace WPEFramework {
                 }
                 else if (currentState == PluginHost::IShell::ACTIVATED && service->Callsign() == WPEFramework::Plugin::RDKShell::SERVICE_NAME)
                 {
+                    mShell.warmLaunchPool();
                    /*PluginHost::ISubSystem* subSystems(service->SubSystems());
                     if (subSystems != nullptr)
                     {
@@ -634,7 +2634,9 @@ namespace WPEFramework {
                                   JsonObject request, response;
                                   std::cout << "about to launch factory app\n";
                                   request["resetagingtime"] = "true";
-                                  uint32_t status = getThunderControllerClient("org.rdk.RDKShell.1")->Invoke(1, "launchFactoryApp", request, response);
+                                  auto rdkShellClient = getThunderControllerClient("org.rdk.RDKShell.1");
+                                  uint32_t status = rdkShellClient->Invoke(1, "launchFactoryApp", request, response);
+                                  Utils::releaseThunderControllerClient(rdkShellClient, status);
                                 }
                             }
                         }
@@ -671,6 +2673,8 @@ namespace WPEFramework {
                 }
                 else if (currentState == PluginHost::IShell::DEACTIVATED)
                 {
+                    Utils::evictThunderControllerClients(service->Callsign());
+
                     std::string configLine = service->ConfigLine();
                     if (configLine.empty())
                     {
@@ -709,6 +2713,12 @@ namespace WPEFramework {
                         gPluginsEventListener.erase(pluginStateChangeEntry);
                     }
                     gPluginDataMutex.unlock();
+
+                    gMemoryPolicy.forget(service->Callsign());
+                    if (gLaunchPool.release(service->Callsign()))
+                    {
+                        mShell.warmLaunchPool();
+                    }
                 }
             }
         }
@@ -793,7 +2803,18 @@ namespace WPEFramework {
 
             registerMethod(RDKSHELL_METHOD_ENABLE_LOGS_FLUSHING, &RDKShell::enableLogsFlushingWrapper, this);
             registerMethod(RDKSHELL_METHOD_GET_LOGS_FLUSHING_ENABLED, &RDKShell::getLogsFlushingEnabledWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_REQUEST_QUEUE_STATS, &RDKShell::getRequestQueueStatsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_FRAME_STATS, &RDKShell::getFrameStatsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_APPLY_TRANSACTION, &RDKShell::applyTransactionWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_LAUNCH_TRACES, &RDKShell::getLaunchTracesWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_MEMORY_POLICY, &RDKShell::setMemoryPolicyWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_MEMORY_POLICY, &RDKShell::getMemoryPolicyWrapper, this);
+            registerMethod(RDKSHELL_METHOD_ENABLE_KEY_LATENCY_TRACER, &RDKShell::enableKeyLatencyTracerWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_KEY_LATENCY_STATS, &RDKShell::getKeyLatencyStatsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_CLIENT_GRAPHICS_MEMORY, &RDKShell::getClientGraphicsMemoryWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_GRAPHICS_MEMORY_BUDGET, &RDKShell::setGraphicsMemoryBudgetWrapper, this);
 	    m_timer.connect(std::bind(&RDKShell::onTimer, this));
+            m_graphicsMemoryTimer.connect(std::bind(&RDKShell::onGraphicsMemoryTimer, this));
         }
 
         RDKShell::~RDKShell()
@@ -899,20 +2920,64 @@ namespace WPEFramework {
             char* waitValue = getenv("RDKSHELL_WAIT_FOR_PERSISTENT_STORE");
             if (NULL != waitValue)
             {
-                std::cout << "waiting for persistent store\n";
-                waitForPersistentStore = true;
+                std::cout << "waiting for persistent store\n";
+                waitForPersistentStore = true;
+            }
+            if (factoryMacMatched)
+            {
+                waitForPersistentStore = false;
+            }
+
+            char* blockResidentApp = getenv("RDKSHELL_BLOCK_RESIDENTAPP_FACTORYMODE");
+            if (NULL != blockResidentApp)
+            {
+                std::cout << "block resident app on factory mode\n";
+                sFactoryModeBlockResidentApp = true;
+            }
+
+            size_t requestWorkers = RDKSHELL_DEFAULT_REQUEST_WORKERS;
+            char* requestWorkersValue = getenv("RDKSHELL_REQUEST_WORKERS");
+            if (NULL != requestWorkersValue && atoi(requestWorkersValue) > 0)
+            {
+                requestWorkers = atoi(requestWorkersValue);
+            }
+            std::cout << "rdkshell request workers: " << requestWorkers << std::endl;
+            gApiRequestExecutor.start(requestWorkers);
+            gEventQueue.start();
+
+            if (NULL != getenv("RDKSHELL_MEMORY_POLICY"))
+            {
+                MemoryPolicy::Config memoryPolicy;
+                memoryPolicy.mEnabled = true;
+                gMemoryPolicy.setConfig(memoryPolicy);
+                std::cout << "rdkshell memory policy enabled" << std::endl;
+            }
+
+            char* planePolicyValue = getenv("RDKSHELL_PLANE_POLICY");
+            if (NULL != planePolicyValue)
+            {
+                gRdkShellMutex.lock();
+                gPlanePolicy.configure(planePolicyValue);
+                gRdkShellMutex.unlock();
             }
-            if (factoryMacMatched)
+
+            char* launchPoolValue = getenv("RDKSHELL_LAUNCH_POOL");
+            if (NULL != launchPoolValue)
             {
-                waitForPersistentStore = false;
+                gLaunchPool.configure(launchPoolValue);
             }
 
-            char* blockResidentApp = getenv("RDKSHELL_BLOCK_RESIDENTAPP_FACTORYMODE");
-            if (NULL != blockResidentApp)
+            // RDKSHELL_VSYNC_PACING: the platform blocks on vsync when presenting a frame, do not sleep in between.
+            // RDKSHELL_IDLE_FRAMERATE: frame rate used while there are no clients and no pending requests.
+            bool vsyncPacing = (NULL != getenv("RDKSHELL_VSYNC_PACING"));
+            int idleFramerate = 0;
+            char* idleFramerateValue = getenv("RDKSHELL_IDLE_FRAMERATE");
+            if (NULL != idleFramerateValue)
             {
-                std::cout << "block resident app on factory mode\n";
-                sFactoryModeBlockResidentApp = true;
+                idleFramerate = atoi(idleFramerateValue);
             }
+            std::cout << "rdkshell vsync pacing: " << vsyncPacing << " idle framerate: " << idleFramerate << std::endl;
+            gFrameStats.reset();
 
             shellThread = std::thread([=]() {
                 bool isRunning = true;
@@ -958,10 +3023,21 @@ namespace WPEFramework {
                 isRunning = sRunning;
                 gRdkShellMutex.unlock();
                 gRdkShellSurfaceModeEnabled = CompositorController::isSurfaceModeEnabled();
+                struct timespec nextFrame, lastFrame;
+                clock_gettime(CLOCK_MONOTONIC, &nextFrame);
+                lastFrame = nextFrame;
                 while(isRunning) {
-                  const double maxSleepTime = (1000 / gCurrentFramerate) * 1000;
-                  double startFrameTime = RdkShell::microseconds();
-                  gRdkShellMutex.lock();
+                  struct timespec frameStart;
+                  clock_gettime(CLOCK_MONOTONIC, &frameStart);
+                  gRdkShellMutex.lockFrame();
+                  bool idle = false;
+                  if (idleFramerate > 0 && idleFramerate < gCurrentFramerate && gCreateDisplayRequests.empty() && gKillClientRequests.empty() &&
+                      !receivedResolutionRequest && !receivedFullScreenImageRequest && !receivedShowWatermarkRequest && !receivedShowSplashScreenRequest && !needsScreenshot)
+                  {
+                      std::vector<std::string> clientList;
+                      CompositorController::getClients(clientList);
+                      idle = clientList.empty();
+                  }
                   while (gCreateDisplayRequests.size() > 0)
                   {
 		      std::shared_ptr<CreateDisplayRequest> request = gCreateDisplayRequests.front();
@@ -1015,6 +3091,7 @@ namespace WPEFramework {
                           Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
                           auto thunderController = getThunderControllerClient();
                           int32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, "status", joResult);
+                          Utils::releaseThunderControllerClient(thunderController, status);
                           JsonArray stateArray;
                           for (uint16_t i = 0; i < joResult.Length(); i++)
                           {
@@ -1071,41 +3148,76 @@ namespace WPEFramework {
                         std::cout << "not launching factory app as conditions not matched\n";
                     }
                   }
+                  // before the frame, a client the plane policy has to expose again is drawn in it
+                  refreshCompositorSnapshot();
                   RdkShell::draw();
+                  if (gKeyLatencyTracer.enabled())
+                  {
+                      gKeyLatencyTracer.frameDrawn(RdkShell::milliseconds());
+                  }
                   if (needsScreenshot)
                   {
                       uint8_t* data = nullptr;
-                      size_t size;
-                      string screenshotBase64;
+                      size_t size = 0;
+                      unsigned int width = 0, height = 0;
                       CompositorController::screenShot(data, size);
-                      size_t encodedImageSize = b64_get_encoded_buffer_size(size);
-                      uint8_t *encodedImage = (uint8_t*)malloc(encodedImageSize);
-                      b64_encode(&data[0], size, encodedImage);
-                      std::stringstream list1;
-                      for (unsigned int i=0; i<encodedImageSize; ++i){
-                         list1 << encodedImage[i];
-                      }
-                      screenshotBase64 = list1.str();
-                      std::cout << "Screenshot success size:" << size << std::endl;
-                      JsonObject params;
-                      params["imageData"] = screenshotBase64;
-
-                      // Calling Notify instead of  RDKShell::notify to avoid logging of entire screen content
-                      LOGINFO("Notify %s", RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE);
-                      Notify(RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE, params);
-
-                      free(encodedImage);
-                      free(data);
+                      CompositorController::getScreenResolution(width, height);
+                      ScreenshotRequest request = gScreenshotRequest;
+                      gScreenshotRequest = ScreenshotRequest();
                       needsScreenshot = false;
+                      if (data != nullptr)
+                      {
+                          std::cout << "Screenshot success size:" << size << std::endl;
+                          std::shared_ptr<uint8_t> image(data, free);
+                          std::function<void()> job = [=]() {
+                              JsonObject params;
+                              if (prepareScreenshot(request, image, size, width, height, params))
+                              {
+                                  // Calling Notify instead of  RDKShell::notify to avoid logging of entire screen content
+                                  LOGINFO("Notify %s", RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE);
+                                  Notify(RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE, params);
+                              }
+                          };
+                          if (!gApiRequestExecutor.submit(ApiRequestExecutor::PRIORITY_LOW, "screenshot" + std::to_string(++gScreenshotCount), job))
+                          {
+                              job();
+                          }
+                      }
+                      else
+                      {
+                          std::cout << "Screenshot failed" << std::endl;
+                      }
                   }
                   RdkShell::update();
                   isRunning = sRunning;
                   gRdkShellMutex.unlock();
-                  double frameTime = (int)RdkShell::microseconds() - (int)startFrameTime;
-                  if (frameTime < maxSleepTime)
+
+                  struct timespec frameEnd;
+                  clock_gettime(CLOCK_MONOTONIC, &frameEnd);
+                  const int framerate = idle ? idleFramerate : gCurrentFramerate;
+                  const long long frameDuration = 1000000000LL / (framerate > 0 ? framerate : 1);
+                  addNanoseconds(nextFrame, frameDuration);
+                  bool missed = elapsedMs(nextFrame, frameEnd) > 0;
+                  gFrameStats.add(elapsedMs(frameStart, frameEnd), elapsedMs(lastFrame, frameStart), missed && !vsyncPacing);
+                  if (idle)
+                  {
+                      gFrameStats.idle();
+                  }
+                  lastFrame = frameStart;
+
+                  if (vsyncPacing && !idle)
+                  {
+                      nextFrame = frameEnd;
+                  }
+                  else if (missed)
+                  {
+                      // too late for this slot, start counting from now instead of catching up
+                      nextFrame = frameEnd;
+                  }
+                  else
                   {
-                      int sleepTime = (int)maxSleepTime-(int)frameTime;
-                      usleep(sleepTime);
+                      // sleep until an absolute deadline so the frame rate does not drift
+                      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrame, NULL) == EINTR);
                   }
                 }
             });
@@ -1216,7 +3328,27 @@ namespace WPEFramework {
                             }
                             params =  paramsValue.Object();
                         }
+                        //populate the names of the entries this one waits for
+                        std::vector<std::string> dependsOn;
+                        if (configEntry.HasLabel("dependsOn"))
+                        {
+                            const JsonValue& dependsOnValue = configEntry["dependsOn"];
+                            if (!(dependsOnValue.Content() == JsonValue::type::ARRAY))
+                            {
+                                std::cout << "one of rdkshell config entry has non-array type dependsOn" << std::endl;
+                                continue;
+                            }
+                            const JsonArray& dependsOnArray = dependsOnValue.Array();
+                            for (int d = 0; d < dependsOnArray.Length(); d++)
+                            {
+                                dependsOn.push_back(dependsOnArray[d].String());
+                            }
+                        }
+
                         RDKShellStartupConfig config; 
+                        config.name = configEntry.HasLabel("name") ? configEntry["name"].String() : thunderApi;
+                        config.dependsOn = dependsOn;
+                        config.ordered = !configEntry.HasLabel("dependsOn");
                         config.rfc = rfc;
                         config.thunderApi = thunderApi;
                         config.params = params;
@@ -1240,29 +3372,28 @@ namespace WPEFramework {
         void RDKShell::invokeStartupThunderApis()
         {
 #ifdef RFC_ENABLED
-            for (std::vector<RDKShellStartupConfig>::iterator iter = gStartupConfigs.begin() ; iter != gStartupConfigs.end(); iter++)
+            bool ordered = true;
+            for (const RDKShellStartupConfig& config : gStartupConfigs)
             {
-                std::string rfc = iter->rfc;
-                std::string thunderApi = iter->thunderApi;
-                JsonObject& apiParams = iter->params;
-
-                RFC_ParamData_t rfcParam;
-                bool ret = Utils::getRFCConfig((char*)rfc.c_str(), rfcParam);
-                if (true == ret && (strncasecmp(rfcParam.value,"true",4) == 0))
-                {
-                    std::cout << "invoking thunder api " << thunderApi << std::endl;
-                    uint32_t status = 0;
-                    JsonObject joResult;
-                    status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, thunderApi.c_str(), apiParams, joResult);
-                    if (status > 0)
-                    {
-                        std::cout << "invoking thunder api " << thunderApi << " failed - " << status << std::endl;
-                    }
-                }
-                else
+                ordered = ordered && config.ordered;
+            }
+            if (ordered)
+            {
+                // Nothing opted in to running concurrently, done before Initialize returns
+                for (const RDKShellStartupConfig& config : gStartupConfigs)
                 {
-                    std::cout << "rfc " << rfc << " not enabled " << std::endl;
+                    runStartupEntry(config);
                 }
+                gStartupConfigs.clear();
+                return;
+            }
+
+            std::shared_ptr<StartupGraph> graph = std::make_shared<StartupGraph>(gStartupConfigs);
+            std::vector<size_t> ready = graph->roots();
+            std::cout << "invoking " << gStartupConfigs.size() << " startup thunder apis, " << ready.size() << " without dependencies" << std::endl;
+            for (size_t i = 0; i < ready.size(); i++)
+            {
+                submitStartupEntry(graph, ready[i]);
             }
 #else
             std::cout << "rfc is not enabled and not invoking thunder apis " << std::endl;
@@ -1273,10 +3404,26 @@ namespace WPEFramework {
         void RDKShell::Deinitialize(PluginHost::IShell* service)
         {
             LOGINFO("Deinitialize");
+            m_graphicsMemoryTimer.stop();
             gRdkShellMutex.lock();
             sRunning = false;
             gRdkShellMutex.unlock();
             shellThread.join();
+            gEventQueue.stop();
+            gApiRequestExecutor.stop();
+            {
+                std::lock_guard<std::mutex> lock(gScreenshotMutex);
+                if (gScreenshotFd >= 0)
+                {
+                    close(gScreenshotFd);
+                    gScreenshotFd = -1;
+                }
+                if (!gScreenshotFile.empty())
+                {
+                    unlink(gScreenshotFile.c_str());
+                    gScreenshotFile.clear();
+                }
+            }
             mCurrentService = nullptr;
             service->Unregister(mClientsMonitor);
             mClientsMonitor->Release();
@@ -1309,24 +3456,17 @@ namespace WPEFramework {
 
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > RDKShell::getThunderControllerClient(std::string callsign, std::string localidentifier)
         {
-            string query = "token=" + sThunderSecurityToken;
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(gThunderAccessValue)));
-            std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > thunderClient = make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> >(callsign.c_str(), localidentifier.c_str(), false, query);
-            return thunderClient;
+            return Utils::getThunderControllerClient(callsign, localidentifier, gThunderAccessValue);
         }
 
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> RDKShell::getPackagerPlugin()
         {
-            string query = "token=" + sThunderSecurityToken;
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(gThunderAccessValue)));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("Packager.1", "", false, query);
+            return Utils::getThunderControllerClient("Packager.1", "", gThunderAccessValue);
         }
 
         std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> RDKShell::getOCIContainerPlugin()
         {
-            string query = "token=" + sThunderSecurityToken;
-            Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(gThunderAccessValue)));
-            return make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>("org.rdk.OCIContainer.1", "", false, query);
+            return Utils::getThunderControllerClient("org.rdk.OCIContainer.1", "", gThunderAccessValue);
         }
 
         void RDKShell::pluginEventHandler(const JsonObject& parameters)
@@ -1341,7 +3481,9 @@ namespace WPEFramework {
                 {
                     std::cout << "Received power state change to sleep " << std::endl;
                     JsonObject request, response;
-                    int32_t status = getThunderControllerClient("org.rdk.RDKShell.1")->Invoke(0, "launchResidentApp", request, response);
+                    auto rdkShellClient = getThunderControllerClient("org.rdk.RDKShell.1");
+                    int32_t status = rdkShellClient->Invoke(0, "launchResidentApp", request, response);
+                    Utils::releaseThunderControllerClient(rdkShellClient, status);
                 }
  
                 if ((prevState == "STANDBY" || prevState == "LIGHT_SLEEP" || prevState == "DEEP_SLEEP" || prevState == "OFF")
@@ -1357,105 +3499,109 @@ namespace WPEFramework {
         void RDKShell::RdkShellListener::onApplicationLaunched(const std::string& client)
         {
           std::cout << "RDKShell onApplicationLaunched event received ..." << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_LAUNCHED, params);
+          postEvent(RDKSHELL_EVENT_ON_APP_LAUNCHED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationConnected(const std::string& client)
         {
           std::cout << "RDKShell onApplicationConnected event received ..." << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_CONNECTED, params);
+          postEvent(RDKSHELL_EVENT_ON_APP_CONNECTED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationDisconnected(const std::string& client)
         {
           std::cout << "RDKShell onApplicationDisconnected event received ..." << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_DISCONNECTED, params);
+          postEvent(RDKSHELL_EVENT_ON_APP_DISCONNECTED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationTerminated(const std::string& client)
         {
           std::cout << "RDKShell onApplicationTerminated event received ..." << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_TERMINATED, params);
+          postEvent(RDKSHELL_EVENT_ON_APP_TERMINATED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationFirstFrame(const std::string& client)
         {
           std::cout << "RDKShell onApplicationFirstFrame event received ..." << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_FIRST_FRAME, params);
+          gLaunchTraces.firstFrame(client, RdkShell::milliseconds());
+          postEvent(RDKSHELL_EVENT_ON_APP_FIRST_FRAME, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationSuspended(const std::string& client)
         {
           std::cout << "RDKShell onApplicationSuspended event received for " << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_SUSPENDED, params);
+          postEvent(RDKSHELL_EVENT_ON_APP_SUSPENDED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationResumed(const std::string& client)
         {
           std::cout << "RDKShell onApplicationResumed event received for " << client << std::endl;
-          JsonObject params;
-          params["client"] = client;
-          mShell.notify(RDKSHELL_EVENT_ON_APP_RESUMED, params);
+          postEvent(RDKSHELL_EVENT_ON_APP_RESUMED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onApplicationActivated(const std::string& client)
         {
             std::cout << "RDKShell onApplicationActivated event received for " << client << std::endl;
-            JsonObject params;
-            params["client"] = client;
-            mShell.notify(RDKSHELL_EVENT_ON_APP_ACTIVATED, params);
+            postEvent(RDKSHELL_EVENT_ON_APP_ACTIVATED, [client](JsonObject& params) { params["client"] = client; });
         }
 
         void RDKShell::RdkShellListener::onUserInactive(const double minutes)
         {
           std::cout << "RDKShell onUserInactive event received ..." << minutes << std::endl;
-          JsonObject params;
-          params["minutes"] = std::to_string(minutes);
-          mShell.notify(RDKSHELL_EVENT_ON_USER_INACTIVITY, params);
+          postEvent(RDKSHELL_EVENT_ON_USER_INACTIVITY, [minutes](JsonObject& params) { params["minutes"] = std::to_string(minutes); });
+        }
+
+        void RDKShell::RdkShellListener::postEvent(const std::string& event, const std::function<void(JsonObject&)>& build)
+        {
+          RDKShell* shell = &mShell;
+          std::function<void()> job = [shell, event, build]() {
+              JsonObject params;
+              build(params);
+              shell->notify(event, params);
+          };
+          if (!gEventQueue.post(job))
+          {
+              job();
+          }
+        }
+
+        // called on the shell thread with gRdkShellMutex held, so the policy runs on a request worker
+        void RDKShell::RdkShellListener::scheduleMemoryReclaim(const bool critical, const int32_t freeKb)
+        {
+          if (!gMemoryPolicy.config().mEnabled)
+          {
+              return;
+          }
+          RDKShell* shell = &mShell;
+          gApiRequestExecutor.submit(ApiRequestExecutor::PRIORITY_HIGH, critical ? "memoryPolicyCritical" : "memoryPolicyLow", [shell, critical, freeKb]() {
+              shell->reclaimMemory(critical, freeKb);
+          });
         }
 
         void RDKShell::RdkShellListener::onDeviceLowRamWarning(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceLowRamWarning event received ..." << freeKb << std::endl;
-          JsonObject params;
-          params["ram"] = freeKb;
-          mShell.notify(RDKSHELL_EVENT_DEVICE_LOW_RAM_WARNING, params);
+          scheduleMemoryReclaim(false, freeKb);
+          postEvent(RDKSHELL_EVENT_DEVICE_LOW_RAM_WARNING, [freeKb](JsonObject& params) { params["ram"] = freeKb; });
         }
 
         void RDKShell::RdkShellListener::onDeviceCriticallyLowRamWarning(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceCriticallyLowRamWarning event received ..." << freeKb << std::endl;
-          JsonObject params;
-          params["ram"] = freeKb;
-          mShell.notify(RDKSHELL_EVENT_DEVICE_CRITICALLY_LOW_RAM_WARNING, params);
+          scheduleMemoryReclaim(true, freeKb);
+          postEvent(RDKSHELL_EVENT_DEVICE_CRITICALLY_LOW_RAM_WARNING, [freeKb](JsonObject& params) { params["ram"] = freeKb; });
         }
 
         void RDKShell::RdkShellListener::onDeviceLowRamWarningCleared(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceLowRamWarningCleared event received ..." << freeKb << std::endl;
-          JsonObject params;
-          params["ram"] = freeKb;
-          mShell.notify(RDKSHELL_EVENT_DEVICE_LOW_RAM_WARNING_CLEARED, params);
+          postEvent(RDKSHELL_EVENT_DEVICE_LOW_RAM_WARNING_CLEARED, [freeKb](JsonObject& params) { params["ram"] = freeKb; });
         }
 
         void RDKShell::RdkShellListener::onDeviceCriticallyLowRamWarningCleared(const int32_t freeKb)
         {
           std::cout << "RDKShell onDeviceCriticallyLowRamWarningCleared event received ..." << freeKb << std::endl;
-          JsonObject params;
-          params["ram"] = freeKb;
-          mShell.notify(RDKSHELL_EVENT_DEVICE_CRITICALLY_LOW_RAM_WARNING_CLEARED, params);
+          postEvent(RDKSHELL_EVENT_DEVICE_CRITICALLY_LOW_RAM_WARNING_CLEARED, [freeKb](JsonObject& params) { params["ram"] = freeKb; });
         }
 
         void RDKShell::RdkShellListener::onEasterEgg(const std::string& name, const std::string& actionJson)
@@ -1469,9 +3615,7 @@ namespace WPEFramework {
           
           if (actionJson.length() == 0)
           {
-            JsonObject params;
-            params["name"] = name;
-            mShell.notify(RDKSHELL_EVENT_ON_EASTER_EGG, params);
+            postEvent(RDKSHELL_EVENT_ON_EASTER_EGG, [name](JsonObject& params) { params["name"] = name; });
           }
           else
           {
@@ -1495,6 +3639,7 @@ namespace WPEFramework {
                         activateParams.Set("callsign",callsign.c_str());
                         JsonObject activateResult;
                         int32_t activateStatus = thunderController->Invoke(3500, "activate", activateParams, activateResult);
+                        Utils::releaseThunderControllerClient(thunderController, activateStatus);
                     }
                     else
                     {
@@ -1519,6 +3664,7 @@ namespace WPEFramework {
                         // setting wait Time to 2 seconds
                         gRdkShellMutex.unlock();
                         status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, invoke.c_str(), actionObject["params"], joResult);
+                        Utils::releaseThunderControllerClient(thunderController, status);
                         gRdkShellMutex.lock();
                     }
                     else
@@ -1528,6 +3674,7 @@ namespace WPEFramework {
                       // setting wait Time to 2 seconds
                       gRdkShellMutex.unlock();
                       status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, invoke.c_str(), joParams, joResult);
+                      Utils::releaseThunderControllerClient(thunderController, status);
                       gRdkShellMutex.lock();
                     }
                     if (status > 0)
@@ -1559,6 +3706,7 @@ namespace WPEFramework {
             std::string getPowerStateInvoke = "org.rdk.System.1.getPowerState";
             auto thunderController = getThunderControllerClient();
             uint32_t status = thunderController->Invoke(5000, getPowerStateInvoke.c_str(), joGetParams, joGetResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
 
             std::cout << "get power state status: " << status << std::endl;
 
@@ -1592,6 +3740,7 @@ namespace WPEFramework {
 
             std::cout << "attempting to set the power state to " << newPowerState << std::endl;
             status = thunderController->Invoke(5000, setPowerStateInvoke.c_str(), joSetParams, joSetResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
             std::cout << "get power state status second: " << status << std::endl;
             if (status > 0)
             {
@@ -1603,9 +3752,7 @@ namespace WPEFramework {
         void RDKShell::RdkShellListener::onSizeChangeComplete(const std::string& client)
         {
             std::cout << "RDKShell onSizeChangeComplete event received ..." << client << std::endl;
-            JsonObject params;
-            params["client"] = client;
-            mShell.notify(RDKSHELL_EVENT_SIZE_CHANGE_COMPLETE, params);
+            postEvent(RDKSHELL_EVENT_SIZE_CHANGE_COMPLETE, [client](JsonObject& params) { params["client"] = client; });
         }
 
         // Registered methods (wrappers) begin
@@ -1777,7 +3924,7 @@ namespace WPEFramework {
                     JsonObject param;
                     param["containerId"] = client;
 
-                    ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "getContainerInfo", param, containerInfoResult);
+                    Utils::releaseThunderControllerClient(ociContainerPlugin, ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "getContainerInfo", param, containerInfoResult));
 
                     // If success is false, the container isn't running so nothing to do
                     if (containerInfoResult["success"].Boolean())
@@ -1787,13 +3934,13 @@ namespace WPEFramework {
                         // Dobby knows about that container - what's it doing?
                         if (containerInfo["state"] == "running" || containerInfo["state"] == "starting")
                         {
-                            ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "stopContainer", param, stopContainerResult);
+                            Utils::releaseThunderControllerClient(ociContainerPlugin, ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "stopContainer", param, stopContainerResult));
                         }
                         else if (containerInfo["state"] == "paused")
                         {
                             // Paused, so force stop
                             param["force"] = true;
-                            ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "stopContainer", param, stopContainerResult);
+                            Utils::releaseThunderControllerClient(ociContainerPlugin, ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "stopContainer", param, stopContainerResult));
                         }
                         else
                         {
@@ -2238,6 +4385,9 @@ namespace WPEFramework {
                 result = false;
             } else {
                 response["clients"] = clients;
+                JsonArray planes;
+                getClientPlanes(planes);
+                response["planes"] = planes;
                 result = true;
             }
             returnResponse(result);
@@ -2910,7 +5060,35 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
 
+            // a pooled instance keeps its own callsign, so callers opt in and use the one returned
+            if (parameters.HasLabel("pool") && parameters["pool"].Boolean() && parameters.HasLabel("type") && !parameters.HasLabel("configuration"))
+            {
+                std::string pooledCallsign;
+                if (gLaunchPool.claim(parameters["type"].String(), pooledCallsign))
+                {
+                    std::cout << "launching " << parameters["callsign"].String() << " as pooled instance " << pooledCallsign << std::endl;
+                    JsonObject pooledParameters(parameters);
+                    pooledParameters["callsign"] = pooledCallsign;
+                    pooledParameters["pool"] = false;
+                    pooledParameters["pooled"] = true;
+                    uint32_t status = launchWrapper(pooledParameters, response);
+                    response["callsign"] = pooledCallsign;
+                    response["pooled"] = true;
+                    warmLaunchPool();
+                    return status;
+                }
+            }
+
             double launchStartTime = RdkShell::seconds();
+            LaunchTraces::Trace trace;
+            trace.mStart = RdkShell::milliseconds();
+            trace.mPooled = parameters.HasLabel("pooled") && parameters["pooled"].Boolean();
+            trace.mSuccess = false;
+            trace.mDisplayMs = trace.mConfigureMs = trace.mActivateMs = trace.mSetupMs = trace.mTotalMs = 0;
+            trace.mFirstFrameMs = -1;
+            trace.mCallsign = parameters["callsign"].String();
+            trace.mType = parameters["type"].String();
+            double phaseStart = trace.mStart;
             bool result = true;
             if (!parameters.HasLabel("callsign"))
             {
@@ -3190,6 +5368,8 @@ namespace WPEFramework {
                         sem_wait(&request->mSemaphore);
                     }
                 }
+                trace.mDisplayMs = RdkShell::milliseconds() - phaseStart;
+                phaseStart += trace.mDisplayMs;
 
                 WPEFramework::Core::JSON::String configString;
 
@@ -3278,6 +5458,9 @@ namespace WPEFramework {
                     std::cout << "set status: " << status << std::endl;
                 }
 
+                trace.mConfigureMs = RdkShell::milliseconds() - phaseStart;
+                phaseStart += trace.mConfigureMs;
+
                 if (launchType == RDKShellLaunchType::UNKNOWN)
                 {
                     status = 0;
@@ -3350,6 +5533,9 @@ namespace WPEFramework {
                     }
                 }
 
+                trace.mActivateMs = RdkShell::milliseconds() - phaseStart;
+                phaseStart += trace.mActivateMs;
+
                 bool deferLaunch = false;
                 if (status > 0)
                 {
@@ -3566,6 +5752,9 @@ namespace WPEFramework {
                             launchTypeString = "unknown";
                             break;
                     }
+                    trace.mSetupMs = RdkShell::milliseconds() - phaseStart;
+                    trace.mLaunchType = launchTypeString;
+                    trace.mSuccess = true;
                     std::cout << "Application:" << callsign << " took " << (RdkShell::seconds() - launchStartTime)*1000 << " milliseconds to launch " << std::endl;
                     gLaunchMutex.lock();
                     gLaunchCount = 0;
@@ -3594,6 +5783,18 @@ namespace WPEFramework {
 	    gLaunchDestroyMutex.unlock();
             std::cout << "new launch count at loc2 is 0\n";
 
+            if (parameters.HasLabel("callsign"))
+            {
+                trace.mTotalMs = RdkShell::milliseconds() - trace.mStart;
+                gLaunchTraces.add(trace);
+                if (result)
+                {
+                    JsonObject timing;
+                    LaunchTraces::toJson(trace, timing);
+                    response["timing"] = timing;
+                }
+            }
+
             returnResponse(result);
         }
 
@@ -3649,7 +5850,9 @@ namespace WPEFramework {
                     WPEFramework::Core::JSON::String stateString;
                     stateString = "suspended";
                     const string callsignWithVersion = callsign + ".1";
-                    status = getThunderControllerClient(callsignWithVersion)->Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                    auto thunderPlugin = getThunderControllerClient(callsignWithVersion);
+                    status = thunderPlugin->Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                    Utils::releaseThunderControllerClient(thunderPlugin, status);
                 }
                 if (status > 0)
                 {
@@ -3705,6 +5908,7 @@ namespace WPEFramework {
                 auto thunderController = getThunderControllerClient();
                 gDestroyMutex.lock();
                 uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, "deactivate", joParams, joResult);
+                Utils::releaseThunderControllerClient(thunderController, status);
                 gDestroyMutex.unlock();
                 if (status > 0)
                 {
@@ -3774,7 +5978,7 @@ namespace WPEFramework {
                     JsonObject installResult;
 
                     installParams.Set("pkgId", uri.c_str());
-                    packagerPlugin->Invoke<JsonObject, JsonObject>(1000, "isInstalled", installParams, installResult);
+                    Utils::releaseThunderControllerClient(packagerPlugin, packagerPlugin->Invoke<JsonObject, JsonObject>(1000, "isInstalled", installParams, installResult));
 
                     if (!installResult.Get("available").Boolean())
                     {
@@ -3787,7 +5991,7 @@ namespace WPEFramework {
                     JsonObject infoResult;
 
                     infoParams.Set("pkgId", uri.c_str());
-                    packagerPlugin->Invoke<JsonObject, JsonObject>(1000, "getPackageInfo", infoParams, infoResult);
+                    Utils::releaseThunderControllerClient(packagerPlugin, packagerPlugin->Invoke<JsonObject, JsonObject>(1000, "getPackageInfo", infoParams, infoResult));
 
                     string bundlePath = infoResult["bundlePath"].String();
 
@@ -3825,7 +6029,7 @@ namespace WPEFramework {
                     param["bundlePath"] = bundlePath;
                     param["westerosSocket"] = display;
 
-                    ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "startContainer", param, ociContainerResult);
+                    Utils::releaseThunderControllerClient(ociContainerPlugin, ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "startContainer", param, ociContainerResult));
 
                     if (!ociContainerResult["success"].Boolean())
                     {
@@ -3910,7 +6114,7 @@ namespace WPEFramework {
                     JsonObject param;
                     param["containerId"] = client;
 
-                    ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "pauseContainer", param, ociContainerResult);
+                    Utils::releaseThunderControllerClient(ociContainerPlugin, ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "pauseContainer", param, ociContainerResult));
 
                     if (!ociContainerResult["success"].Boolean())
                     {
@@ -3976,7 +6180,7 @@ namespace WPEFramework {
                     JsonObject param;
 
                     param["containerId"] = client;
-                    ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "resumeContainer", param, ociContainerResult);
+                    Utils::releaseThunderControllerClient(ociContainerPlugin, ociContainerPlugin->Invoke<JsonObject, JsonObject>(RDKSHELL_THUNDER_TIMEOUT, "resumeContainer", param, ociContainerResult));
 
                     if (!ociContainerResult["success"].Boolean())
                     {
@@ -4010,6 +6214,7 @@ namespace WPEFramework {
             Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
             auto thunderController = getThunderControllerClient();
             uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), joResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
 
             JsonArray availableTypes;
             for (uint16_t i = 0; i < joResult.Length(); i++)
@@ -4149,6 +6354,7 @@ namespace WPEFramework {
             Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
             auto thunderController = getThunderControllerClient();
             uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), joResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
 
 
             JsonArray stateArray;
@@ -4174,11 +6380,13 @@ namespace WPEFramework {
                             const string callsignWithVersion = callsign + ".1";
                             auto thunderPlugin = getThunderControllerClient(callsignWithVersion);
                             uint32_t stateStatus = thunderPlugin->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                            Utils::releaseThunderControllerClient(thunderPlugin, stateStatus);
 
                             if (stateStatus == 0)
                             {
                                 WPEFramework::Core::JSON::String urlString;
                                 uint32_t urlStatus = thunderPlugin->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "url",urlString);
+                                Utils::releaseThunderControllerClient(thunderPlugin, urlStatus);
 
                                 JsonObject typeObject;
                                 typeObject["callsign"] = callsign;
@@ -4231,6 +6439,7 @@ namespace WPEFramework {
             Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
             auto thunderController = getThunderControllerClient();
             uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service>>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), joResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
 
             /*std::cout << "DEACTIVATED: " << PluginHost::MetaData::Service::state::DEACTIVATED << std::endl;
                     std::cout << "DEACTIVATION: " << PluginHost::MetaData::Service::state::DEACTIVATION << std::endl;
@@ -4262,7 +6471,9 @@ namespace WPEFramework {
 
                             WPEFramework::Core::JSON::String stateString;
                             const string callsignWithVersion = callsign + ".1";
-                            uint32_t stateStatus = getThunderControllerClient(callsignWithVersion)->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                            auto thunderPlugin = getThunderControllerClient(callsignWithVersion);
+                            uint32_t stateStatus = thunderPlugin->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                            Utils::releaseThunderControllerClient(thunderPlugin, stateStatus);
 
                             if (stateStatus == 0)
                             {
@@ -4334,7 +6545,9 @@ namespace WPEFramework {
                     std::string agingGetInvoke = "org.rdk.PersistentStore.1.getValue";
 
                     std::cout << "attempting to check aging flag \n";
-                    uint32_t status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+                    auto thunderController = getThunderControllerClient();
+                    uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+                    Utils::releaseThunderControllerClient(thunderController, status);
                     std::cout << "get status: " << status << std::endl;
 
                     if (status > 0)
@@ -4376,7 +6589,9 @@ namespace WPEFramework {
                     std::string agingSetInvoke = "org.rdk.PersistentStore.1.setValue";
 
                     std::cout << "attempting to set aging total time to 0 \n";
-                    uint32_t agingTotalTimeSetStatus = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingSetInvoke.c_str(), joAgingSetValueParams, joAgingSetValueResult);
+                    auto thunderController = getThunderControllerClient();
+                    uint32_t agingTotalTimeSetStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingSetInvoke.c_str(), joAgingSetValueParams, joAgingSetValueResult);
+                    Utils::releaseThunderControllerClient(thunderController, agingTotalTimeSetStatus);
                     std::cout << "aging total time set status: " <<  agingTotalTimeSetStatus << std::endl;
                 }
 
@@ -4415,7 +6630,9 @@ namespace WPEFramework {
                 std::string factoryModeSetInvoke = "org.rdk.PersistentStore.1.setValue";
 
                 std::cout << "attempting to set factory mode flag \n";
-                uint32_t setStatus = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryModeSetInvoke.c_str(), joFactoryModeParams, joFactoryModeResult);
+                auto thunderController = getThunderControllerClient();
+                uint32_t setStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryModeSetInvoke.c_str(), joFactoryModeParams, joFactoryModeResult);
+                Utils::releaseThunderControllerClient(thunderController, setStatus);
                 std::cout << "set status: " << setStatus << std::endl;
 
                 JsonObject joFactoryExitParams;
@@ -4426,7 +6643,8 @@ namespace WPEFramework {
                 std::string factoryExitSetInvoke = "org.rdk.PersistentStore.1.setValue";
 
                 std::cout << "attempting to set factory allow exit flag \n";
-                uint32_t setExitStatus = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryExitSetInvoke.c_str(), joFactoryExitParams, joFactoryExitResult);
+                uint32_t setExitStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryExitSetInvoke.c_str(), joFactoryExitParams, joFactoryExitResult);
+                Utils::releaseThunderControllerClient(thunderController, setExitStatus);
                 std::cout << "set status: " << setExitStatus << std::endl;
 
                 sFactoryAppLaunchStatus = COMPLETED;
@@ -4468,6 +6686,7 @@ namespace WPEFramework {
             std::cout << "attempting to check flag \n";
             auto thunderController = getThunderControllerClient();
             uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, toFacGetInvoke.c_str(), joToFacParams, joToFacResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
             std::cout << "get status: " << status << std::endl;
 
             if (status > 0)
@@ -4520,7 +6739,9 @@ namespace WPEFramework {
                 std::string agingGetInvoke = "org.rdk.PersistentStore.1.getValue";
 
                 std::cout << "attempting to check aging flag \n";
-                uint32_t agingStatus = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+                auto thunderController = getThunderControllerClient();
+                uint32_t agingStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+                Utils::releaseThunderControllerClient(thunderController, agingStatus);
                 std::cout << "aging get status: " << agingStatus << std::endl;
 
                 if (agingStatus == 0 && joAgingResult.HasLabel("value"))
@@ -4546,7 +6767,8 @@ namespace WPEFramework {
                 std::string factoryExitGetInvoke = "org.rdk.PersistentStore.1.getValue";
 
                 std::cout << "attempting to check factory exit flag\n";
-                uint32_t factoryExitStatus = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryExitGetInvoke.c_str(), joExitParams, joExitResult);
+                uint32_t factoryExitStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryExitGetInvoke.c_str(), joExitParams, joExitResult);
+                Utils::releaseThunderControllerClient(thunderController, factoryExitStatus);
                 std::cout << "factory exit get status: " << factoryExitStatus << std::endl;
 
                 if (factoryExitStatus == 0 && joExitResult.HasLabel("value"))
@@ -4590,17 +6812,19 @@ namespace WPEFramework {
             std::string stopHdmiInvoke = "org.rdk.HdmiInput.1.stopHdmiInput";
 
             std::cout << "attempting to stop hdmi input \n";
-            uint32_t stopHdmiStatus = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, stopHdmiInvoke.c_str(), joStopHdmiParams, joStopHdmiResult);
+            auto thunderController = getThunderControllerClient();
+            uint32_t stopHdmiStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, stopHdmiInvoke.c_str(), joStopHdmiParams, joStopHdmiResult);
+            Utils::releaseThunderControllerClient(thunderController, stopHdmiStatus);
             std::cout << "stopHdmiStatus status: " << stopHdmiStatus << std::endl;
 
             sForceResidentAppLaunch = true;
-            auto thunderController = getThunderControllerClient();
             WPEFramework::Core::JSON::String configString;
 
             int32_t status = 0;
             string method = "configuration@ResidentApp";
             Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
             status = thunderController->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), configString);
+            Utils::releaseThunderControllerClient(thunderController, status);
 
             std::cout << "config resident app status: " << status << std::endl;
             std::string updatedUrl;
@@ -4608,6 +6832,7 @@ namespace WPEFramework {
             {
                 std::cout << "trying resident app config status one more time...\n";
                 status = thunderController->Get<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, method.c_str(), configString);
+                Utils::releaseThunderControllerClient(thunderController, status);
                 std::cout << "trying resident app config status: " << status << std::endl;
             }
             else
@@ -4631,12 +6856,14 @@ namespace WPEFramework {
             activateParams.Set("callsign",callsign.c_str());
             JsonObject activateResult;
             status = thunderController->Invoke(3500, "activate", activateParams, activateResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
 
             std::cout << "activate resident app status: " << status << std::endl;
             if (status > 0)
             {
                 std::cout << "trying status one more time...\n";
                 status = thunderController->Invoke(3500, "activate", activateParams, activateResult);
+                Utils::releaseThunderControllerClient(thunderController, status);
                 std::cout << "activate resident app status: " << status << std::endl;
                 if (status > 0)
                 {
@@ -4670,6 +6897,7 @@ namespace WPEFramework {
 
             std::cout << "attempting to set factory mode flag \n";
             uint32_t setStatus = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, factoryModeSetInvoke.c_str(), joFactoryModeParams, joFactoryModeResult);
+            Utils::releaseThunderControllerClient(thunderController, setStatus);
             std::cout << "set status: " << setStatus << std::endl;
             sForceResidentAppLaunch = false;
             returnResponse(ret);
@@ -4744,7 +6972,9 @@ namespace WPEFramework {
             std::string agingGetInvoke = "org.rdk.PersistentStore.1.getValue";
 
             std::cout << "attempting to check aging state flag \n";
-            uint32_t status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+            auto thunderController = getThunderControllerClient();
+            uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
             std::cout << "get status: " << status << std::endl;
 
             if (status > 0)
@@ -4771,7 +7001,8 @@ namespace WPEFramework {
             joAgingParams.Set("value","false");
             std::string agingSetInvoke = "org.rdk.PersistentStore.1.setValue";
             std::cout << "attempting to set check aging state flag to false\n";
-            status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingSetInvoke.c_str(), joAgingParams, joAgingResult);
+            status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingSetInvoke.c_str(), joAgingParams, joAgingResult);
+            Utils::releaseThunderControllerClient(thunderController, status);
             std::cout << "set status: " << status << std::endl;
 
             JsonObject request, res;
@@ -4970,6 +7201,7 @@ namespace WPEFramework {
              auto systemServiceConnection = RDKShell::getThunderControllerClient(serviceCallsign);
              JsonObject request, result;
              uint32_t status = systemServiceConnection->Invoke(RDKSHELL_THUNDER_TIMEOUT, "getWakeupReason", request, result);
+             Utils::releaseThunderControllerClient(systemServiceConnection, status);
              if (Core::ERROR_NONE == status && result.HasLabel("wakeupReason"))
              {
                 std::string wakeupreason = result["wakeupReason"].String();
@@ -4977,6 +7209,7 @@ namespace WPEFramework {
                 {
                      JsonObject req, res;
                      uint32_t status = systemServiceConnection->Invoke(RDKSHELL_THUNDER_TIMEOUT, "getLastWakeupKeyCode", req, res);
+                     Utils::releaseThunderControllerClient(systemServiceConnection, status);
                      if (Core::ERROR_NONE == status && res.HasLabel("wakeupKeyCode"))
                      {
                          unsigned int key = res["wakeupKeyCode"].Number();
@@ -5001,6 +7234,7 @@ namespace WPEFramework {
 				req.Set("netType",1);
 
 				uint32_t status = remoteControlConnection->Invoke(RDKSHELL_THUNDER_TIMEOUT, "getNetStatus", req, res);
+				Utils::releaseThunderControllerClient(remoteControlConnection, status);
 				if (Core::ERROR_NONE == status && res.HasLabel("status"))
 				{
 					stat = res["status"].Object();
@@ -5053,64 +7287,354 @@ namespace WPEFramework {
              returnResponse(false);
         }
 
-	uint32_t RDKShell::hideAllClientsWrapper(const JsonObject& parameters, JsonObject& response)
+	uint32_t RDKShell::hideAllClientsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            if (!parameters.HasLabel("hide"))
+            {
+                response["message"] = "please specify hide parameter";
+                returnResponse(false);
+            }
+            bool hide = parameters["hide"].Boolean();
+            lockRdkShellMutex();
+            std::vector<std::string> clientList;
+            CompositorController::getClients(clientList);
+            bool targetFound = false;
+            for (size_t i=0; i<clientList.size(); i++)
+            {
+                gPlanePolicy.visibilityRequested(clientList[i]);
+                bool ret = CompositorController::setVisibility(clientList[i], !hide);
+            }
+            gRdkShellMutex.unlock();
+            returnResponse(true);
+        }
+
+        uint32_t RDKShell::getScreenshotWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            ScreenshotRequest request;
+            if (parameters.HasLabel("delivery"))
+            {
+                request.mDelivery = parameters["delivery"].String();
+                if (request.mDelivery != "event" && request.mDelivery != "memfd" && request.mDelivery != "file")
+                {
+                    response["message"] = "delivery must be event, memfd or file";
+                    result = false;
+                }
+            }
+            if (parameters.HasLabel("path"))
+            {
+                response["message"] = "path is not supported, files are written to " RDKSHELL_SCREENSHOT_DIRECTORY;
+                result = false;
+            }
+            if (parameters.HasLabel("format"))
+            {
+                request.mFormat = parameters["format"].String();
+#ifdef RDKSHELL_SCREENSHOT_JPEG
+                if (request.mFormat != "native" && request.mFormat != "jpeg")
+#else
+                if (request.mFormat != "native")
+#endif
+                {
+                    response["message"] = "unsupported format";
+                    result = false;
+                }
+            }
+            if (parameters.HasLabel("width") || parameters.HasLabel("height"))
+            {
+                request.mWidth = parameters.HasLabel("width") ? parameters["width"].Number() : 0;
+                request.mHeight = parameters.HasLabel("height") ? parameters["height"].Number() : 0;
+                if (request.mWidth == 0 || request.mHeight == 0)
+                {
+                    response["message"] = "please specify both width and height";
+                    result = false;
+                }
+            }
+            if (parameters.HasLabel("quality"))
+            {
+                request.mQuality = parameters["quality"].Number();
+                if (request.mQuality < 1 || request.mQuality > 100)
+                {
+                    response["message"] = "quality must be between 1 and 100";
+                    result = false;
+                }
+            }
+            if (result)
+            {
+                lockRdkShellMutex();
+                gScreenshotRequest = request;
+                needsScreenshot = true;
+                gRdkShellMutex.unlock();
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::enableLogsFlushingWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+
+            if (!parameters.HasLabel("enable"))
+            {
+                response["message"] = "please specify enable parameter";
+                result = false;
+            }
+            else
+            {
+                bool enable = parameters["enable"].Boolean();
+                enableLogsFlushing(enable);
+                result = true;
+            }
+
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getLogsFlushingEnabledWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+           LOGINFOMETHOD();
+
+            bool enabled = false;
+            getLogsFlushingEnabled(enabled);
+            response["enabled"] = enabled;
+
+            returnResponse(true);
+        }
+
+        uint32_t RDKShell::getRequestQueueStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            gApiRequestExecutor.getStats(response);
+
+            returnResponse(true);
+        }
+
+        uint32_t RDKShell::getFrameStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            gFrameStats.getStats(response);
+            response["framerate"] = gCurrentFramerate;
+            if (parameters.HasLabel("reset") && parameters["reset"].Boolean())
+            {
+                gFrameStats.reset();
+            }
+
+            returnResponse(true);
+        }
+
+        uint32_t RDKShell::applyTransactionWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("operations"))
+            {
+                result = false;
+                response["message"] = "please specify operations";
+            }
+            if (result)
+            {
+                const JsonArray operations = parameters["operations"].Array();
+                std::vector<WindowMutation> mutations(operations.Length());
+                std::vector<std::string> clientList;
+                JsonArray results;
+                bool boundsChanged = false;
+
+                // everything is applied under one lock, so the shell loop renders all changes in the same frame
+                lockRdkShellMutex();
+                CompositorController::getClients(clientList);
+                for (uint16_t i = 0; result && i < operations.Length(); i++)
+                {
+                    std::string error;
+                    if (!parseWindowMutation(operations[i].Object(), clientList, mutations[i], error))
+                    {
+                        response["message"] = "operation " + std::to_string(i) + ": " + error;
+                        result = false;
+                    }
+                }
+                if (result)
+                {
+                    for (size_t i = 0; i < mutations.size(); i++)
+                    {
+                        results.Add(applyWindowMutation(mutations[i]));
+                        boundsChanged = boundsChanged || (mutations[i].mOperation == "setBounds");
+                    }
+                }
+                gRdkShellMutex.unlock();
+
+                if (result)
+                {
+                    for (size_t i = 0; i < mutations.size(); i++)
+                    {
+                        if (mutations[i].mOperation == "setVisibility")
+                        {
+                            setBrowserVisibility(mutations[i].mCallsign, mutations[i].mVisible);
+                        }
+                    }
+                    if (boundsChanged)
+                    {
+                        usleep(68000);
+                    }
+                    response["results"] = results;
+                }
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getLaunchTracesWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            UNUSED(parameters);
+
+            JsonArray launches;
+            gLaunchTraces.getTraces(launches);
+            response["launches"] = launches;
+            JsonObject pool;
+            gLaunchPool.getStats(pool);
+            response["pool"] = pool;
+
+            returnResponse(true);
+        }
+
+        uint32_t RDKShell::enableKeyLatencyTracerWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("enable"))
+            {
+                result = false;
+                response["message"] = "please specify enable";
+            }
+            else
+            {
+                gKeyLatencyTracer.setEnabled(parameters["enable"].Boolean());
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getKeyLatencyStatsWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
-            if (!parameters.HasLabel("hide"))
-            {
-                response["message"] = "please specify hide parameter";
-                returnResponse(false);
-            }
-            bool hide = parameters["hide"].Boolean();
-            lockRdkShellMutex();
-            std::vector<std::string> clientList;
-            CompositorController::getClients(clientList);
-            bool targetFound = false;
-            for (size_t i=0; i<clientList.size(); i++)
+
+            gKeyLatencyTracer.getStats(response);
+            if (parameters.HasLabel("reset") && parameters["reset"].Boolean())
             {
-                bool ret = CompositorController::setVisibility(clientList[i], !hide);
+                gKeyLatencyTracer.reset();
             }
-            gRdkShellMutex.unlock();
+
             returnResponse(true);
         }
 
-        uint32_t RDKShell::getScreenshotWrapper(const JsonObject& parameters, JsonObject& response)
+        uint32_t RDKShell::getClientGraphicsMemoryWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
-            bool result = true;
-            lockRdkShellMutex();
-            needsScreenshot = true;
-            gRdkShellMutex.unlock();
-            returnResponse(result);
+            JsonArray clients;
+            measureGraphicsMemory(parameters.HasLabel("client") ? parameters["client"].String() : string(), clients);
+            response["clients"] = clients;
+            returnResponse(true);
         }
 
-        uint32_t RDKShell::enableLogsFlushingWrapper(const JsonObject& parameters, JsonObject& response)
+        uint32_t RDKShell::setGraphicsMemoryBudgetWrapper(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFOMETHOD();
-            bool result = true;
-
-            if (!parameters.HasLabel("enable"))
+            if (!parameters.HasLabel("client"))
             {
-                response["message"] = "please specify enable parameter";
-                result = false;
+                response["message"] = "please specify client";
+                returnResponse(false);
+            }
+            if (!parameters.HasLabel("budgetKb"))
+            {
+                response["message"] = "please specify budgetKb";
+                returnResponse(false);
+            }
+            const string client = parameters["client"].String();
+            const uint32_t budgetKb = parameters["budgetKb"].Number();
+            const bool suspend = parameters.HasLabel("suspend") && parameters["suspend"].Boolean();
+            if (gGraphicsMemoryBudgets.set(client, budgetKb, suspend))
+            {
+                if (!m_graphicsMemoryTimer.isActive())
+                {
+                    m_graphicsMemoryTimer.start(RDKSHELL_GRAPHICS_MEMORY_CHECK_INTERVAL_MS);
+                }
             }
             else
             {
-                bool enable = parameters["enable"].Boolean();
-                enableLogsFlushing(enable);
-                result = true;
+                m_graphicsMemoryTimer.stop();
             }
+            returnResponse(true);
+        }
 
+        uint32_t RDKShell::setMemoryPolicyWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            MemoryPolicy::Config config = gMemoryPolicy.config();
+            if (parameters.HasLabel("enable"))
+            {
+                config.mEnabled = parameters["enable"].Boolean();
+            }
+            if (parameters.HasLabel("lowRamAction"))
+            {
+                config.mLowAction = parameters["lowRamAction"].String();
+            }
+            if (parameters.HasLabel("criticallyLowRamAction"))
+            {
+                config.mCriticalAction = parameters["criticallyLowRamAction"].String();
+            }
+            if (parameters.HasLabel("targetFreeKb"))
+            {
+                config.mTargetFreeKb = parameters["targetFreeKb"].Number();
+            }
+            if (parameters.HasLabel("maxActions"))
+            {
+                config.mMaxActions = parameters["maxActions"].Number();
+            }
+            if (parameters.HasLabel("protected"))
+            {
+                const JsonArray protectedList = parameters["protected"].Array();
+                config.mProtected.clear();
+                for (uint16_t i = 0; i < protectedList.Length(); i++)
+                {
+                    config.mProtected.push_back(protectedList[i].String());
+                }
+            }
+            const std::string actions[] = { config.mLowAction, config.mCriticalAction };
+            for (int i = 0; i < 2; i++)
+            {
+                if (actions[i] != "none" && actions[i] != "suspend" && actions[i] != "destroy")
+                {
+                    response["message"] = "actions must be none, suspend or destroy";
+                    result = false;
+                }
+            }
+            if (result)
+            {
+                gMemoryPolicy.setConfig(config);
+            }
             returnResponse(result);
         }
 
-        uint32_t RDKShell::getLogsFlushingEnabledWrapper(const JsonObject& parameters, JsonObject& response)
+        uint32_t RDKShell::getMemoryPolicyWrapper(const JsonObject& parameters, JsonObject& response)
         {
-           LOGINFOMETHOD();
+            LOGINFOMETHOD();
+            UNUSED(parameters);
 
-            bool enabled = false;
-            getLogsFlushingEnabled(enabled);
-            response["enabled"] = enabled;
+            MemoryPolicy::Config config = gMemoryPolicy.config();
+            response["enable"] = config.mEnabled;
+            response["lowRamAction"] = config.mLowAction;
+            response["criticallyLowRamAction"] = config.mCriticalAction;
+            response["targetFreeKb"] = config.mTargetFreeKb;
+            response["maxActions"] = config.mMaxActions;
+            JsonArray protectedList;
+            for (size_t i = 0; i < config.mProtected.size(); i++)
+            {
+                protectedList.Add(config.mProtected[i]);
+            }
+            response["protected"] = protectedList;
+            JsonArray actions;
+            gMemoryPolicy.getActions(actions);
+            response["actions"] = actions;
 
             returnResponse(true);
         }
@@ -5180,7 +7704,9 @@ namespace WPEFramework {
                 std::string agingGetInvoke = "org.rdk.PersistentStore.1.getValue";
 
                 std::cout << "attempting to check aging state \n";
-                uint32_t status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+                auto thunderController = getThunderControllerClient();
+                uint32_t status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joAgingParams, joAgingResult);
+                Utils::releaseThunderControllerClient(thunderController, status);
                 std::cout << "get status for aging state: " << status << std::endl;
 
                 if ((status == 0) && (joAgingResult.HasLabel("value")))
@@ -5200,7 +7726,8 @@ namespace WPEFramework {
                 joFactoryModeParams.Set("key","FactoryMode");
 
                 std::cout << "attempting to check factory mode \n";
-                status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joFactoryModeParams, joFactoryModeResult);
+                status = thunderController->Invoke(RDKSHELL_THUNDER_TIMEOUT, agingGetInvoke.c_str(), joFactoryModeParams, joFactoryModeResult);
+                Utils::releaseThunderControllerClient(thunderController, status);
                 std::cout << "get status for factory mode: " << status << std::endl;
 
                 if ((status == 0) && (joFactoryModeResult.HasLabel("value")))
@@ -5308,6 +7835,10 @@ namespace WPEFramework {
             CompositorController::getFocused(previousFocusedClient);
             ret = CompositorController::setFocus(client);
             gRdkShellMutex.unlock();
+            if (ret)
+            {
+                gMemoryPolicy.focused(client);
+            }
             std::string clientLower = toLower(client);
 
             if (previousFocusedClient != clientLower)
@@ -5600,8 +8131,23 @@ namespace WPEFramework {
             for (int i=0; i<modifiers.Length(); i++) {
               flags |= getKeyFlag(modifiers[i].String());
             }
+            const bool traced = gKeyLatencyTracer.enabled();
+            KeyLatencyTracer::Sample sample;
+            if (traced)
+            {
+                sample.received = RdkShell::milliseconds();
+            }
             gRdkShellMutex.lock();
+            if (traced)
+            {
+                sample.dispatched = RdkShell::milliseconds();
+            }
             ret = CompositorController::injectKey(keyCode, flags);
+            if (traced)
+            {
+                sample.delivered = RdkShell::milliseconds();
+                gKeyLatencyTracer.delivered(sample);
+            }
             gRdkShellMutex.unlock();
             return ret;
         }
@@ -5726,21 +8272,59 @@ namespace WPEFramework {
         bool RDKShell::getClients(JsonArray& clients)
         {
             std::vector<std::string> clientList;
-            lockRdkShellMutex();
-            CompositorController::getClients(clientList);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            if (snapshot)
+            {
+                clientList = snapshot->clients;
+            }
+            else
+            {
+                gRdkShellMutex.lock();
+                CompositorController::getClients(clientList);
+                gRdkShellMutex.unlock();
+            }
             for (size_t i=0; i<clientList.size(); i++) {
               clients.Add(clientList[i]);
             }
             return true;
         }
 
+        void RDKShell::getClientPlanes(JsonArray& planes)
+        {
+            std::vector<std::pair<std::string, std::string>> planeList;
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            if (snapshot)
+            {
+                planeList = snapshot->planes;
+            }
+            else
+            {
+                gRdkShellMutex.lock();
+                planeList = gPlanePolicy.planes();
+                gRdkShellMutex.unlock();
+            }
+            for (size_t i=0; i<planeList.size(); i++) {
+              JsonObject plane;
+              plane["client"] = planeList[i].first;
+              plane["plane"] = planeList[i].second;
+              planes.Add(plane);
+            }
+        }
+
         bool RDKShell::getZOrder(JsonArray& clients)
         {
             std::vector<std::string> zOrderList;
-            lockRdkShellMutex();
-            CompositorController::getZOrder(zOrderList);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            if (snapshot)
+            {
+                zOrderList = snapshot->zOrder;
+            }
+            else
+            {
+                gRdkShellMutex.lock();
+                CompositorController::getZOrder(zOrderList);
+                gRdkShellMutex.unlock();
+            }
             for (size_t i=0; i<zOrderList.size(); i++) {
               clients.Add(zOrderList[i]);
             }
@@ -5751,9 +8335,22 @@ namespace WPEFramework {
         {
             unsigned int x=0,y=0,width=0,height=0;
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getBounds(client, x, y, width, height);
-            gRdkShellMutex.unlock();
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            CompositorSnapshot::Client properties;
+            if (snapshot && snapshot->find(client, properties))
+            {
+                x = properties.x;
+                y = properties.y;
+                width = properties.width;
+                height = properties.height;
+                ret = true;
+            }
+            else
+            {
+                gRdkShellMutex.lock();
+                ret = CompositorController::getBounds(client, x, y, width, height);
+                gRdkShellMutex.unlock();
+            }
             if (true == ret) {
               bounds["x"] = x;
               bounds["y"] = y;
@@ -5780,9 +8377,17 @@ namespace WPEFramework {
 
         bool RDKShell::getVisibility(const string& client, bool& visible)
         {
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            CompositorSnapshot::Client properties;
+            if (snapshot && snapshot->find(client, properties))
+            {
+                visible = properties.visible;
+                return true;
+            }
             bool ret = false;
-            lockRdkShellMutex();
+            gRdkShellMutex.lock();
             ret = CompositorController::getVisibility(client, visible);
+            visible = visible || gPlanePolicy.occluded(client);
             gRdkShellMutex.unlock();
             return ret;
         }
@@ -5807,9 +8412,19 @@ namespace WPEFramework {
                     std::cout << "lock was acquired via try for visibility\n";
                 }
             }
+            gPlanePolicy.visibilityRequested(client);
             ret = CompositorController::setVisibility(client, visible);
             gRdkShellMutex.unlock();
-            
+
+            if (!setBrowserVisibility(client, visible))
+            {
+                return false;
+            }
+            return ret;
+        }
+
+        bool RDKShell::setBrowserVisibility(const string& client, const bool visible)
+        {
             bool isApplicationBeingDestroyed = false;
             gLaunchDestroyMutex.lock();
             if (gDestroyApplications.find(client) != gDestroyApplications.end())
@@ -5864,13 +8479,20 @@ namespace WPEFramework {
                 }
             }
 
-            return ret;
+            return true;
         }
 
         bool RDKShell::getOpacity(const string& client, unsigned int& opacity)
         {
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            CompositorSnapshot::Client properties;
+            if (snapshot && snapshot->find(client, properties))
+            {
+                opacity = properties.opacity;
+                return true;
+            }
             bool ret = false;
-            lockRdkShellMutex();
+            gRdkShellMutex.lock();
             ret = CompositorController::getOpacity(client, opacity);
             gRdkShellMutex.unlock();
             return ret;
@@ -5899,8 +8521,16 @@ namespace WPEFramework {
 
         bool RDKShell::getScale(const string& client, double& scaleX, double& scaleY)
         {
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            CompositorSnapshot::Client properties;
+            if (snapshot && snapshot->find(client, properties))
+            {
+                scaleX = properties.scaleX;
+                scaleY = properties.scaleY;
+                return true;
+            }
             bool ret = false;
-            lockRdkShellMutex();
+            gRdkShellMutex.lock();
             ret = CompositorController::getScale(client, scaleX, scaleY);
             gRdkShellMutex.unlock();
             return ret;
@@ -5964,6 +8594,7 @@ namespace WPEFramework {
                     const string client  = animationInfo["client"].String();
                     const double duration = std::stod(animationInfo["duration"].String());
                     std::map<std::string, RdkShellData> animationProperties;
+                    double animationDelay = 0;
                     if (animationInfo.HasLabel("x"))
                     {
                         int32_t x = animationInfo["x"].Number();
@@ -6010,6 +8641,7 @@ namespace WPEFramework {
                         {
                           double duration = std::stod(animationInfo["delay"].String());
                           animationProperties["delay"] = duration;
+                          animationDelay = duration;
                         }
                         catch (...)
                         {
@@ -6017,6 +8649,7 @@ namespace WPEFramework {
                         }
                     }
                     CompositorController::addAnimation(client, duration, animationProperties);
+                    gCompositorAnimatingUntil = std::max(gCompositorAnimatingUntil, RdkShell::milliseconds() + (animationDelay + duration) * 1000);
                 }
             }
             gRdkShellMutex.unlock();
@@ -6088,6 +8721,246 @@ namespace WPEFramework {
             notify(RDKSHELL_EVENT_ON_DESTROYED, params);
         }
 
+        void RDKShell::reclaimMemory(const bool critical, const int32_t freeKb)
+        {
+            MemoryPolicy::Config config = gMemoryPolicy.config();
+            const std::string action = critical ? config.mCriticalAction : config.mLowAction;
+            const std::string reason = critical ? "criticallyLowRam" : "lowRam";
+            if (!config.mEnabled || (action != "suspend" && action != "destroy"))
+            {
+                return;
+            }
+
+            std::string focusedClient;
+            gRdkShellMutex.lock();
+            CompositorController::getFocused(focusedClient);
+            gRdkShellMutex.unlock();
+
+            // resident memory per callsign, accounted over the process tree by ActivityMonitor
+            std::map<std::string, int32_t> memoryKb;
+            JsonObject memoryRequest, memoryResponse;
+            auto activityMonitor = getThunderControllerClient("org.rdk.ActivityMonitor.1");
+            uint32_t status = activityMonitor->Invoke(RDKSHELL_THUNDER_TIMEOUT, "getAllMemoryUsage", memoryRequest, memoryResponse);
+            Utils::releaseThunderControllerClient(activityMonitor, status);
+            if (status == 0 && memoryResponse.HasLabel("applicationMemory"))
+            {
+                const JsonArray applications = memoryResponse["applicationMemory"].Array();
+                for (uint16_t i = 0; i < applications.Length(); i++)
+                {
+                    const JsonObject& application = applications[i].Object();
+                    memoryKb[toLower(application["appName"].String())] = application["memoryMB"].Number() * 1024;
+                }
+            }
+
+            struct Candidate
+            {
+                std::string mCallsign;
+                double mLastFocused;
+                int32_t mMemoryKb;
+            };
+            std::vector<Candidate> candidates;
+
+            JsonObject stateRequest, stateResponse;
+            getState(stateRequest, stateResponse);
+            const JsonArray stateList = stateResponse.HasLabel("state") ? stateResponse["state"].Array() : JsonArray();
+            for (uint16_t i = 0; i < stateList.Length(); i++)
+            {
+                const JsonObject& stateInfo = stateList[i].Object();
+                const std::string callsign = stateInfo["callsign"].String();
+                if (callsign.empty() || toLower(callsign) == toLower(focusedClient) || config.isProtected(callsign) || gLaunchPool.isSpare(callsign))
+                {
+                    continue;
+                }
+                if (action == "suspend" && stateInfo["state"].String() == "suspended")
+                {
+                    continue;
+                }
+                Candidate candidate;
+                candidate.mCallsign = callsign;
+                candidate.mLastFocused = gMemoryPolicy.lastFocused(callsign);
+                candidate.mMemoryKb = -1;
+                std::map<std::string, int32_t>::iterator memory = memoryKb.find(toLower(callsign));
+                if (memory != memoryKb.end())
+                {
+                    candidate.mMemoryKb = memory->second;
+                }
+                else
+                {
+                    JsonArray memoryInfo;
+                    pluginMemoryUsage(callsign, memoryInfo);
+                    candidate.mMemoryKb = memoryInfo[0].Object()["ram"].Number();
+                }
+                candidates.push_back(candidate);
+            }
+
+            // least recently focused first, the larger one of two never focused applications first
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+                if (a.mLastFocused != b.mLastFocused)
+                {
+                    return a.mLastFocused < b.mLastFocused;
+                }
+                return a.mMemoryKb > b.mMemoryKb;
+            });
+
+            const int64_t neededKb = (int64_t)config.mTargetFreeKb - freeKb;
+            int64_t reclaimedKb = 0;
+            uint32_t actions = 0;
+            for (size_t i = 0; i < candidates.size() && actions < config.mMaxActions; i++)
+            {
+                if ((neededKb <= 0 && actions > 0) || (neededKb > 0 && reclaimedKb >= neededKb))
+                {
+                    break;
+                }
+                const Candidate& candidate = candidates[i];
+                std::cout << "memory policy: " << action << " " << candidate.mCallsign << " (" << candidate.mMemoryKb << " kB) on " << reason << std::endl;
+
+                JsonObject params, response;
+                params["callsign"] = candidate.mCallsign;
+                if (action == "suspend")
+                {
+                    suspendWrapper(params, response);
+                }
+                else
+                {
+                    destroyWrapper(params, response);
+                }
+
+                MemoryPolicy::Action record;
+                record.mCallsign = candidate.mCallsign;
+                record.mAction = action;
+                record.mReason = reason;
+                record.mMemoryKb = candidate.mMemoryKb;
+                record.mFreeKb = freeKb;
+                record.mSuccess = response["success"].Boolean();
+                gMemoryPolicy.addAction(record);
+
+                JsonObject event;
+                MemoryPolicy::toJson(record, event);
+                notify(RDKSHELL_EVENT_ON_MEMORY_POLICY_ACTION, event);
+
+                if (record.mSuccess)
+                {
+                    reclaimedKb += std::max(candidate.mMemoryKb, 0);
+                    actions++;
+                }
+            }
+        }
+
+        // Graphics memory of every client, or of the one given: its surface buffers, estimated as
+        // RDKSHELL_SURFACE_BUFFER_COUNT buffers of 32 bits per pixel of the size of the client as the
+        // compositor does not tell how many it attached, and the GPU memory of its process (-1 if
+        // not known), the pid as ActivityMonitor reports it for the callsign.
+        void RDKShell::measureGraphicsMemory(const std::string& only, JsonArray& clients)
+        {
+            std::vector<std::string> clientList;
+            std::map<std::string, uint64_t> pixels;
+            std::shared_ptr<const CompositorSnapshot> snapshot = loadCompositorSnapshot();
+            if (snapshot)
+            {
+                clientList = snapshot->clients;
+                for (const std::string& client : clientList)
+                {
+                    CompositorSnapshot::Client properties;
+                    if (snapshot->find(client, properties))
+                    {
+                        pixels[toLower(client)] = (uint64_t)properties.width * properties.height;
+                    }
+                }
+            }
+            else
+            {
+                gRdkShellMutex.lock();
+                CompositorController::getClients(clientList);
+                for (const std::string& client : clientList)
+                {
+                    unsigned int x = 0, y = 0, width = 0, height = 0;
+                    if (CompositorController::getBounds(client, x, y, width, height))
+                    {
+                        pixels[toLower(client)] = (uint64_t)width * height;
+                    }
+                }
+                gRdkShellMutex.unlock();
+            }
+
+            std::map<std::string, int> pids;
+            JsonObject memoryRequest, memoryResponse;
+            auto activityMonitor = getThunderControllerClient("org.rdk.ActivityMonitor.1");
+            uint32_t status = activityMonitor->Invoke(RDKSHELL_THUNDER_TIMEOUT, "getAllMemoryUsage", memoryRequest, memoryResponse);
+            Utils::releaseThunderControllerClient(activityMonitor, status);
+            if (status == 0 && memoryResponse.HasLabel("applicationMemory"))
+            {
+                const JsonArray applications = memoryResponse["applicationMemory"].Array();
+                for (uint16_t i = 0; i < applications.Length(); i++)
+                {
+                    const JsonObject& application = applications[i].Object();
+                    pids[toLower(application["appName"].String())] = application["appPid"].Number();
+                }
+            }
+
+            for (const std::string& client : clientList)
+            {
+                const std::string name = toLower(client);
+                if (!only.empty() && name != toLower(only))
+                {
+                    continue;
+                }
+                std::map<std::string, uint64_t>::iterator size = pixels.find(name);
+                std::map<std::string, int>::iterator pid = pids.find(name);
+                const int64_t surfaceKb = (size == pixels.end()) ? 0 : size->second * 4 * RDKSHELL_SURFACE_BUFFER_COUNT / 1024;
+                const int64_t gpuKb = (pid == pids.end()) ? -1 : drmMemoryKb(pid->second);
+                GraphicsMemoryBudgets::Budget budget;
+                gGraphicsMemoryBudgets.get(name, budget);
+
+                JsonObject entry;
+                entry["client"] = client;
+                entry["surfaceKb"] = surfaceKb;
+                entry["gpuKb"] = gpuKb;
+                entry["totalKb"] = surfaceKb + std::max(gpuKb, (int64_t)0);
+                entry["budgetKb"] = budget.mBudgetKb;
+                clients.Add(entry);
+            }
+        }
+
+        void RDKShell::checkGraphicsMemory()
+        {
+            JsonArray clients;
+            measureGraphicsMemory(string(), clients);
+            for (uint16_t i = 0; i < clients.Length(); i++)
+            {
+                JsonObject entry = clients[i].Object();
+                GraphicsMemoryBudgets::Budget budget;
+                if (!gGraphicsMemoryBudgets.get(entry["client"].String(), budget))
+                {
+                    continue;
+                }
+                const int64_t totalKb = entry["totalKb"].Number();
+                if (!gGraphicsMemoryBudgets.exceeded(entry["client"].String(), totalKb > budget.mBudgetKb))
+                {
+                    continue;
+                }
+
+                std::cout << "graphics memory: " << budget.mCallsign << " uses " << totalKb << " kB, over its budget of " << budget.mBudgetKb << " kB" << std::endl;
+                entry["action"] = budget.mSuspend ? "suspend" : "none";
+                if (budget.mSuspend)
+                {
+                    JsonObject params, response;
+                    params["callsign"] = budget.mCallsign;
+                    suspendWrapper(params, response);
+                    entry["success"] = response["success"].Boolean();
+                }
+                notify(RDKSHELL_EVENT_ON_GRAPHICS_MEMORY_BUDGET_EXCEEDED, entry);
+            }
+        }
+
+        // on the timer thread, the measurement calls ActivityMonitor so it runs on a request worker
+        void RDKShell::onGraphicsMemoryTimer()
+        {
+            RDKShell* shell = this;
+            gApiRequestExecutor.submit(ApiRequestExecutor::PRIORITY_LOW, "graphicsMemory", [shell]() {
+                shell->checkGraphicsMemory();
+            });
+        }
+
         bool RDKShell::systemMemory(uint32_t &freeKb, uint32_t & totalKb, uint32_t & usedSwapKb)
         {
             lockRdkShellMutex();
@@ -6276,7 +9149,7 @@ namespace WPEFramework {
                 {  
                     std::string serviceCallsign = SYSTEM_SERVICE_CALLSIGN;
                     serviceCallsign.append(".2");
-                    gSystemServiceConnection = RDKShell::getThunderControllerClient(serviceCallsign);
+                    gSystemServiceConnection = RDKShell::getThunderControllerClient(serviceCallsign, "RDKShell");
                 }
             }
 
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <mutex>
+#include <functional>
 #include "Module.h"
 #include "utils.h"
 #include <rdkshell/rdkshellevents.h>
@@ -125,6 +126,16 @@ namespace WPEFramework {
             static const string RDKSHELL_METHOD_ENABLE_EASTER_EGGS;
             static const string RDKSHELL_METHOD_ENABLE_LOGS_FLUSHING;
             static const string RDKSHELL_METHOD_GET_LOGS_FLUSHING_ENABLED;
+            static const string RDKSHELL_METHOD_GET_REQUEST_QUEUE_STATS;
+            static const string RDKSHELL_METHOD_GET_FRAME_STATS;
+            static const string RDKSHELL_METHOD_APPLY_TRANSACTION;
+            static const string RDKSHELL_METHOD_GET_LAUNCH_TRACES;
+            static const string RDKSHELL_METHOD_SET_MEMORY_POLICY;
+            static const string RDKSHELL_METHOD_GET_MEMORY_POLICY;
+            static const string RDKSHELL_METHOD_ENABLE_KEY_LATENCY_TRACER;
+            static const string RDKSHELL_METHOD_GET_KEY_LATENCY_STATS;
+            static const string RDKSHELL_METHOD_GET_CLIENT_GRAPHICS_MEMORY;
+            static const string RDKSHELL_METHOD_SET_GRAPHICS_MEMORY_BUDGET;
 
             // events
             static const string RDKSHELL_EVENT_ON_USER_INACTIVITY;
@@ -147,6 +158,8 @@ namespace WPEFramework {
             static const string RDKSHELL_EVENT_ON_EASTER_EGG;
             static const string RDKSHELL_EVENT_ON_WILL_DESTROY;
             static const string RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE;
+            static const string RDKSHELL_EVENT_ON_MEMORY_POLICY_ACTION;
+            static const string RDKSHELL_EVENT_ON_GRAPHICS_MEMORY_BUDGET_EXCEEDED;
 
             void notify(const std::string& event, const JsonObject& parameters);
             void pluginEventHandler(const JsonObject& parameters);
@@ -227,6 +240,16 @@ namespace WPEFramework {
             uint32_t enableEasterEggsWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t enableLogsFlushingWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getLogsFlushingEnabledWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getRequestQueueStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getFrameStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t applyTransactionWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getLaunchTracesWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setMemoryPolicyWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getMemoryPolicyWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t enableKeyLatencyTracerWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getKeyLatencyStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getClientGraphicsMemoryWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setGraphicsMemoryBudgetWrapper(const JsonObject& parameters, JsonObject& response);
 
         private/*internal methods*/:
             RDKShell(const RDKShell&) = delete;
@@ -253,11 +276,13 @@ namespace WPEFramework {
                 const bool virtualDisplay = false, const uint32_t virtualWidth = 0, const uint32_t virtualHeight = 0,
                 const bool topmost = false, const bool focus = false);
             bool getClients(JsonArray& clients);
+            void getClientPlanes(JsonArray& planes);
             bool getZOrder(JsonArray& clients);
             bool getBounds(const string& client, JsonObject& bounds);
             bool setBounds(const string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h);
             bool getVisibility(const string& client, bool& visibility);
             bool setVisibility(const string& client, const bool visible);
+            bool setBrowserVisibility(const string& client, const bool visible);
             bool getOpacity(const string& client, unsigned int& opacity);
             bool setOpacity(const string& client, const unsigned int opacity);
             bool getScale(const string& client, double& scaleX, double& scaleY);
@@ -278,6 +303,11 @@ namespace WPEFramework {
             bool showFullScreenImage(std::string& path);
             void killAllApps(bool enableDestroyEvent=false);
             bool checkForBootupFactoryAppLaunch();
+            void warmLaunchPool();
+            void reclaimMemory(const bool critical, const int32_t freeKb);
+            void measureGraphicsMemory(const std::string& only, JsonArray& clients);
+            void checkGraphicsMemory();
+            void onGraphicsMemoryTimer();
             bool enableKeyRepeats(const bool enable);
             bool getKeyRepeatsEnabled(bool& enable);
             bool setTopmost(const string& callsign, const bool topmost, const bool focus);
@@ -331,6 +361,11 @@ namespace WPEFramework {
                 virtual void onPowerKey();
                 virtual void onSizeChangeComplete(const std::string& client);
 
+              private:
+                  void scheduleMemoryReclaim(const bool critical, const int32_t freeKb);
+                  // builds the parameters and notifies off the shell thread, in order
+                  void postEvent(const std::string& event, const std::function<void(JsonObject&)>& build);
+
               private:
                   RDKShell& mShell;
             };
@@ -374,6 +409,7 @@ namespace WPEFramework {
             uint32_t mLastWakeupKeyModifiers;
             uint64_t mLastWakeupKeyTimestamp;
             TpTimer m_timer;
+            TpTimer m_graphicsMemoryTimer;
             bool mEnableEasterEggs;
         };
 
@@ -0,0 +1,90 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "benchmark/benchmark.h"
+
+#include "Module.h"
+#include "AbstractPlugin.h"
+
+namespace RdkServicesTest {
+
+namespace {
+
+// The JSON-RPC path every AbstractPlugin method goes through: lookup, parameters in, response out
+class DispatchPlugin : public WPEFramework::Plugin::AbstractPlugin {
+public:
+    DispatchPlugin()
+        : AbstractPlugin()
+    {
+        registerMethod("echo", &DispatchPlugin::echo, this);
+    }
+
+private:
+    uint32_t echo(const JsonObject& parameters, JsonObject& response)
+    {
+        response["value"] = parameters["value"];
+        returnResponse(true);
+    }
+};
+
+} // namespace
+
+static void AbstractPlugin_Invoke(benchmark::State& state)
+{
+    auto plugin = WPEFramework::Core::ProxyType<DispatchPlugin>::Create();
+    WPEFramework::Core::JSONRPC::Handler& handler = *plugin;
+    WPEFramework::Core::JSONRPC::Connection connection(1, 0);
+
+    string response;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.Invoke(connection, _T("echo"), _T("{\"value\":\"benchmark\"}"), response));
+    }
+    plugin->Deinitialize(nullptr);
+}
+BENCHMARK(AbstractPlugin_Invoke);
+
+static void AbstractPlugin_InvokeNoParameters(benchmark::State& state)
+{
+    auto plugin = WPEFramework::Core::ProxyType<DispatchPlugin>::Create();
+    WPEFramework::Core::JSONRPC::Handler& handler = *plugin;
+    WPEFramework::Core::JSONRPC::Connection connection(1, 0);
+
+    string response;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.Invoke(connection, _T("getQuirks"), _T("{}"), response));
+    }
+    plugin->Deinitialize(nullptr);
+}
+BENCHMARK(AbstractPlugin_InvokeNoParameters);
+
+static void AbstractPlugin_InvokeUnknown(benchmark::State& state)
+{
+    auto plugin = WPEFramework::Core::ProxyType<DispatchPlugin>::Create();
+    WPEFramework::Core::JSONRPC::Handler& handler = *plugin;
+    WPEFramework::Core::JSONRPC::Connection connection(1, 0);
+
+    string response;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.Invoke(connection, _T("unknown"), _T("{}"), response));
+    }
+    plugin->Deinitialize(nullptr);
+}
+BENCHMARK(AbstractPlugin_InvokeUnknown);
+
+} // namespace RdkServicesTest
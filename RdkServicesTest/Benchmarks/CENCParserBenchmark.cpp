@@ -0,0 +1,81 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "benchmark/benchmark.h"
+
+#include "CENCParser.h"
+
+#include <vector>
+
+namespace RdkServicesTest {
+
+namespace {
+
+// A version 1 common PSSH box with the key ids in the box header
+std::vector<uint8_t> PSSHBox(const uint8_t keys, const uint8_t seed)
+{
+    static const uint8_t common[] = { 0x10, 0x77, 0xef, 0xec, 0xc0, 0xb2, 0x4d, 0x02, 0xac, 0xe3, 0x3c, 0x1e, 0x52, 0xe2, 0xfb, 0x4b };
+
+    const uint32_t size = 4 + 4 + 4 + sizeof(common) + 4 + (keys * 16) + 4;
+    std::vector<uint8_t> box = {
+        static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size),
+        'p', 's', 's', 'h',
+        0x01, 0x00, 0x00, 0x00
+    };
+    box.insert(box.end(), common, common + sizeof(common));
+    box.insert(box.end(), { 0x00, 0x00, 0x00, keys });
+    for (uint8_t key = 0; key < keys; key++) {
+        for (uint8_t index = 0; index < 16; index++) {
+            box.push_back(static_cast<uint8_t>(seed + key + index));
+        }
+    }
+    box.insert(box.end(), { 0x00, 0x00, 0x00, 0x00 });
+    return (box);
+}
+
+} // namespace
+
+// The same init data for every session, recognized from the parse cache
+static void CENCParser_ParseRepeated(benchmark::State& state)
+{
+    const std::vector<uint8_t> box(PSSHBox(static_cast<uint8_t>(state.range(0)), 0));
+    for (auto _ : state) {
+        WPEFramework::Plugin::CommonEncryptionData data(box.data(), static_cast<uint16_t>(box.size()));
+        benchmark::DoNotOptimize(data.IsEmpty());
+    }
+}
+BENCHMARK(CENCParser_ParseRepeated)->Arg(1)->Arg(8);
+
+// More distinct init data than the parse cache holds, every box is parsed
+static void CENCParser_ParseDistinct(benchmark::State& state)
+{
+    std::vector<std::vector<uint8_t>> boxes;
+    for (uint8_t seed = 0; seed < (2 * CENC_PARSE_CACHE_SIZE); seed++) {
+        boxes.push_back(PSSHBox(static_cast<uint8_t>(state.range(0)), seed));
+    }
+    size_t index = 0;
+    for (auto _ : state) {
+        const std::vector<uint8_t>& box(boxes[index++ % boxes.size()]);
+        WPEFramework::Plugin::CommonEncryptionData data(box.data(), static_cast<uint16_t>(box.size()));
+        benchmark::DoNotOptimize(data.IsEmpty());
+    }
+}
+BENCHMARK(CENCParser_ParseDistinct)->Arg(1)->Arg(8);
+
+} // namespace RdkServicesTest
@@ -0,0 +1,124 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "benchmark/benchmark.h"
+
+#include "PersistentStore.h"
+
+namespace RdkServicesTest {
+
+namespace {
+
+class PersistentStoreFixture {
+public:
+    PersistentStoreFixture()
+        : _plugin(WPEFramework::Core::ProxyType<WPEFramework::Plugin::PersistentStore>::Create())
+        , _handler(*_plugin)
+        , _connection(1, 0)
+    {
+        _plugin->Initialize(nullptr);
+    }
+    ~PersistentStoreFixture()
+    {
+        Invoke(_T("deleteNamespace"), _T("{\"namespace\":\"benchmark\"}"));
+        _plugin->Deinitialize(nullptr);
+    }
+
+    uint32_t Invoke(const string& method, const string& parameters)
+    {
+        return _handler.Invoke(_connection, method, parameters, _response);
+    }
+
+private:
+    WPEFramework::Core::ProxyType<WPEFramework::Plugin::PersistentStore> _plugin;
+    WPEFramework::Core::JSONRPC::Handler& _handler;
+    WPEFramework::Core::JSONRPC::Connection _connection;
+    string _response;
+};
+
+string Items(const int count, const bool values)
+{
+    string items;
+    for (int index = 0; index < count; index++) {
+        items += (index == 0 ? "" : ",");
+        items += "{\"namespace\":\"benchmark\",\"key\":\"k" + std::to_string(index) + "\"";
+        items += (values ? ",\"value\":\"" + std::to_string(index) + "\"}" : "}");
+    }
+    return "{\"items\":[" + items + "]}";
+}
+
+} // namespace
+
+static void PersistentStore_setValue(benchmark::State& state)
+{
+    PersistentStoreFixture store;
+    int index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Invoke(_T("setValue"), "{\"namespace\":\"benchmark\",\"key\":\"k" + std::to_string(index++ % 64) + "\",\"value\":\"v\"}"));
+    }
+}
+BENCHMARK(PersistentStore_setValue);
+
+// Repeated keys, served from the read-through cache
+static void PersistentStore_getValue(benchmark::State& state)
+{
+    PersistentStoreFixture store;
+    store.Invoke(_T("setValue"), _T("{\"namespace\":\"benchmark\",\"key\":\"a\",\"value\":\"1\"}"));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Invoke(_T("getValue"), _T("{\"namespace\":\"benchmark\",\"key\":\"a\"}")));
+    }
+}
+BENCHMARK(PersistentStore_getValue);
+
+// Evicted on every call, the cache holds fewer keys than are read
+static void PersistentStore_getValueUncached(benchmark::State& state)
+{
+    PersistentStoreFixture store;
+    store.Invoke(_T("setValues"), Items(256, true));
+    int index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Invoke(_T("getValue"), "{\"namespace\":\"benchmark\",\"key\":\"k" + std::to_string(index++ % 256) + "\"}"));
+    }
+}
+BENCHMARK(PersistentStore_getValueUncached);
+
+static void PersistentStore_setValues(benchmark::State& state)
+{
+    PersistentStoreFixture store;
+    const string items(Items(state.range(0), true));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Invoke(_T("setValues"), items));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(PersistentStore_setValues)->Arg(8)->Arg(64);
+
+static void PersistentStore_getValues(benchmark::State& state)
+{
+    PersistentStoreFixture store;
+    store.Invoke(_T("setValues"), Items(state.range(0), true));
+    const string items(Items(state.range(0), false));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Invoke(_T("getValues"), items));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(PersistentStore_getValues)->Arg(8)->Arg(64);
+
+} // namespace RdkServicesTest
@@ -0,0 +1,125 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "benchmark/benchmark.h"
+
+#include "SecurityAgent.h"
+
+#include <fstream>
+
+namespace RdkServicesTest {
+
+namespace {
+
+// The ACL of SecurityAgentTest.accessControlList: literal, prefix and regex method patterns
+class AccessControlListFixture {
+public:
+    AccessControlListFixture()
+        : _path(_T("/tmp/securityagent_benchmark_acl.json"))
+    {
+        std::ofstream(_path) << R"({
+            "assign": [
+                { "url": "*://localhost", "role": "local" },
+                { "url": "*://*.example.com", "role": "partner" },
+                { "url": "*", "role": "default" }
+            ],
+            "roles": {
+                "default": { "default": "blocked" },
+                "local": { "default": "allowed" },
+                "partner": {
+                    "default": "blocked",
+                    "DeviceInfo": { "default": "allowed", "methods": [ "register" ] },
+                    "org.rdk.*": { "default": "blocked", "methods": [ "get*", "set*Mode" ] },
+                    "org.rdk.System": { "default": "allowed", "methods": [ "reboot" ] }
+                }
+            }
+        })";
+
+        WPEFramework::Core::File file(_path, false);
+        file.Open(true);
+        _acl.Load(file);
+        file.Close();
+    }
+    ~AccessControlListFixture()
+    {
+        WPEFramework::Core::File(_path, false).Destroy();
+    }
+
+    const WPEFramework::Plugin::AccessControlList::Filter* Filter(const string& url) const
+    {
+        return (_acl.FilterMapFromURL(url));
+    }
+
+private:
+    string _path;
+    WPEFramework::Plugin::AccessControlList _acl;
+};
+
+} // namespace
+
+static void AccessControlList_FilterMapFromURL(benchmark::State& state)
+{
+    AccessControlListFixture acl;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(acl.Filter(_T("https://apps.example.com/app?x=1")));
+    }
+}
+BENCHMARK(AccessControlList_FilterMapFromURL);
+
+static void AccessControlList_AllowedLiteral(benchmark::State& state)
+{
+    AccessControlListFixture acl;
+    const WPEFramework::Plugin::AccessControlList::Filter* partner = acl.Filter(_T("https://apps.example.com/app"));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(partner->Allowed(_T("org.rdk.System"), _T("reboot")));
+    }
+}
+BENCHMARK(AccessControlList_AllowedLiteral);
+
+static void AccessControlList_AllowedPrefix(benchmark::State& state)
+{
+    AccessControlListFixture acl;
+    const WPEFramework::Plugin::AccessControlList::Filter* partner = acl.Filter(_T("https://apps.example.com/app"));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(partner->Allowed(_T("org.rdk.RDKShell"), _T("getClients")));
+    }
+}
+BENCHMARK(AccessControlList_AllowedPrefix);
+
+static void AccessControlList_AllowedRegex(benchmark::State& state)
+{
+    AccessControlListFixture acl;
+    const WPEFramework::Plugin::AccessControlList::Filter* partner = acl.Filter(_T("https://apps.example.com/app"));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(partner->Allowed(_T("org.rdk.DisplaySettings"), _T("setVideoMode")));
+    }
+}
+BENCHMARK(AccessControlList_AllowedRegex);
+
+static void AccessControlList_AllowedDefault(benchmark::State& state)
+{
+    AccessControlListFixture acl;
+    const WPEFramework::Plugin::AccessControlList::Filter* partner = acl.Filter(_T("https://apps.example.com/app"));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(partner->Allowed(_T("Monitor"), _T("status")));
+    }
+}
+BENCHMARK(AccessControlList_AllowedDefault);
+
+} // namespace RdkServicesTest
@@ -0,0 +1,71 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "benchmark/benchmark.h"
+
+#include "cSettings.h"
+
+namespace RdkServicesTest {
+
+namespace {
+
+const char* const SettingsFile = "/tmp/csettings_benchmark.conf";
+
+} // namespace
+
+// A changed value, appended to the settings file
+static void cSettings_setValue(benchmark::State& state)
+{
+    ::remove(SettingsFile);
+    cSettings settings(SettingsFile);
+    int value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.setValue("key" + std::to_string(value % 16), value));
+        value++;
+    }
+    ::remove(SettingsFile);
+}
+BENCHMARK(cSettings_setValue);
+
+// The log of one key, compacted as it grows
+static void cSettings_setValueSameKey(benchmark::State& state)
+{
+    ::remove(SettingsFile);
+    cSettings settings(SettingsFile);
+    settings.setValue("key", 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.setValue("key", 1));
+    }
+    ::remove(SettingsFile);
+}
+BENCHMARK(cSettings_setValueSameKey);
+
+static void cSettings_getValue(benchmark::State& state)
+{
+    ::remove(SettingsFile);
+    cSettings settings(SettingsFile);
+    settings.setValue("key", std::string("value"));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.getValue("key"));
+    }
+    ::remove(SettingsFile);
+}
+BENCHMARK(cSettings_getValue);
+
+} // namespace RdkServicesTest
@@ -0,0 +1,917 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+ * RdkServicesLoad: replays a weighted mix of JSON-RPC calls against a running Thunder over
+ * N WebSocket connections at a target rate, and writes the latency percentiles and error
+ * rates per method and the RSS/CPU of the server over time as JSON.
+ *
+ * Calls are sent on a fixed schedule (open loop): the latency of a call counts from the time
+ * it was due, so a server that stalls is not hidden by the client waiting for it.
+ */
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace RdkServicesTest {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 9998;
+    std::string token;
+    std::string mix;
+    std::string output = "load.json";
+    unsigned connections = 4;
+    double rate = 20.0;             // calls/s for all the connections together
+    unsigned duration = 60;         // s
+    unsigned warmup = 5;            // s, calls made but not counted
+    unsigned timeout = 5000;        // ms
+    unsigned interval = 1;          // s, between server samples
+    int pid = 0;                    // of the server, looked up by name if not set
+    unsigned seed = 1;
+};
+
+struct Call {
+    std::string method;
+    std::string params;
+    unsigned weight;
+};
+
+// Latencies in buckets 1% wide, so a soak of hours takes the same memory as a minute
+class Histogram {
+public:
+    static constexpr double Growth = 1.01;
+    static constexpr unsigned Buckets = 2000;  // 1 us up to about 7 minutes
+
+    Histogram()
+        : _counts(Buckets, 0)
+        , _count(0)
+        , _sum(0)
+        , _max(0)
+    {
+    }
+
+    void Add(uint64_t us)
+    {
+        unsigned bucket = (us <= 1 ? 0 : std::min<unsigned>(Buckets - 1, static_cast<unsigned>(std::log(static_cast<double>(us)) / std::log(Growth))));
+        _counts[bucket]++;
+        _count++;
+        _sum += us;
+        _max = std::max(_max, us);
+    }
+    void Merge(const Histogram& other)
+    {
+        for (unsigned index = 0; index < Buckets; index++) {
+            _counts[index] += other._counts[index];
+        }
+        _count += other._count;
+        _sum += other._sum;
+        _max = std::max(_max, other._max);
+    }
+
+    uint64_t Count() const { return (_count); }
+    uint64_t Max() const { return (_max); }
+    double Mean() const { return (_count == 0 ? 0.0 : static_cast<double>(_sum) / _count); }
+
+    // Upper bound of the bucket of the nearest rank, at most the largest latency seen
+    uint64_t Percentile(double percentile) const
+    {
+        if (_count == 0) {
+            return (0);
+        }
+        uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * _count));
+        uint64_t seen = 0;
+        for (unsigned index = 0; index < Buckets; index++) {
+            seen += _counts[index];
+            if (seen >= std::max<uint64_t>(rank, 1)) {
+                return (std::min(_max, static_cast<uint64_t>(std::ceil(std::pow(Growth, index + 1)))));
+            }
+        }
+        return (_max);
+    }
+
+private:
+    std::vector<uint64_t> _counts;
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _max;
+};
+
+struct Statistics {
+    Histogram latency;
+    uint64_t calls = 0;
+    uint64_t errors = 0;        // error responses
+    uint64_t timeouts = 0;
+    uint64_t failures = 0;      // lost connection, not sent
+
+    void Merge(const Statistics& other)
+    {
+        latency.Merge(other.latency);
+        calls += other.calls;
+        errors += other.errors;
+        timeouts += other.timeouts;
+        failures += other.failures;
+    }
+};
+
+struct Sample {
+    double time;                // s since the start
+    uint64_t rss;               // kB
+    double cpu;                 // % of one core
+    uint64_t calls;             // in the interval
+    uint64_t errors;            // errors, timeouts and failures in the interval
+};
+
+static std::atomic<bool> g_stop(false);
+static std::atomic<uint64_t> g_calls(0);
+static std::atomic<uint64_t> g_errors(0);
+
+static void Interrupt(int)
+{
+    g_stop = true;
+}
+
+static std::string Trim(const std::string& text)
+{
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return (begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1));
+}
+
+// Members of the outer object of a JSON text, with their raw values
+static std::map<std::string, std::string> Members(const std::string& json)
+{
+    std::map<std::string, std::string> members;
+    std::string key;
+    size_t start = std::string::npos;
+    int depth = 0;
+    bool inString = false;
+    bool expectKey = true;
+
+    for (size_t index = 0; index < json.size(); index++) {
+        char c = json[index];
+        if (inString) {
+            if (c == '\\') {
+                index++;
+            } else if (c == '"') {
+                inString = false;
+                if ((depth == 1) && expectKey) {
+                    key = json.substr(start + 1, index - start - 1);
+                }
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+            if ((depth == 1) && expectKey) {
+                start = index;
+            }
+        } else if ((c == '{') || (c == '[')) {
+            depth++;
+        } else if ((c == '}') || (c == ']')) {
+            if ((depth == 1) && !expectKey) {
+                members[key] = Trim(json.substr(start, index - start));
+            }
+            depth--;
+        } else if ((c == ':') && (depth == 1)) {
+            expectKey = false;
+            start = index + 1;
+        } else if ((c == ',') && (depth == 1)) {
+            members[key] = Trim(json.substr(start, index - start));
+            expectKey = true;
+        }
+    }
+    return (members);
+}
+
+static std::string Base64(const uint8_t data[], size_t length)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    for (size_t index = 0; index < length; index += 3) {
+        uint32_t value = (data[index] << 16) | ((index + 1 < length ? data[index + 1] : 0) << 8) | (index + 2 < length ? data[index + 2] : 0);
+        result += table[(value >> 18) & 0x3F];
+        result += table[(value >> 12) & 0x3F];
+        result += (index + 1 < length ? table[(value >> 6) & 0x3F] : '=');
+        result += (index + 2 < length ? table[value & 0x3F] : '=');
+    }
+    return (result);
+}
+
+// A client end of a WebSocket to the JSON-RPC endpoint of Thunder, one call at a time
+class Connection {
+public:
+    Connection(const Options& options, std::mt19937& random)
+        : _options(options)
+        , _random(random)
+        , _fd(-1)
+    {
+    }
+    ~Connection()
+    {
+        Close();
+    }
+
+    bool Open()
+    {
+        Close();
+
+        struct addrinfo hints;
+        struct addrinfo* addresses = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(_options.host.c_str(), std::to_string(_options.port).c_str(), &hints, &addresses) != 0) {
+            return (false);
+        }
+        for (struct addrinfo* address = addresses; (address != nullptr) && (_fd < 0); address = address->ai_next) {
+            _fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+            if ((_fd >= 0) && (connect(_fd, address->ai_addr, address->ai_addrlen) != 0)) {
+                close(_fd);
+                _fd = -1;
+            }
+        }
+        freeaddrinfo(addresses);
+        if (_fd < 0) {
+            return (false);
+        }
+
+        int one = 1;
+        setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        uint8_t nonce[16];
+        for (uint8_t& byte : nonce) {
+            byte = static_cast<uint8_t>(_random());
+        }
+        std::string request = "GET /jsonrpc" + (_options.token.empty() ? std::string() : "?token=" + _options.token) + " HTTP/1.1\r\n"
+            "Host: " + _options.host + ":" + std::to_string(_options.port) + "\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Key: " + Base64(nonce, sizeof(nonce)) + "\r\n"
+            "Sec-WebSocket-Protocol: notification\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n";
+
+        std::string response;
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(_options.timeout);
+        if (!Write(request) || !ReadUntil(response, "\r\n\r\n", deadline) || (response.compare(0, 12, "HTTP/1.1 101") != 0)) {
+            Close();
+            return (false);
+        }
+        // Anything after the handshake is already WebSocket
+        _buffer = response.substr(response.find("\r\n\r\n") + 4);
+        return (true);
+    }
+    void Close()
+    {
+        if (_fd >= 0) {
+            close(_fd);
+            _fd = -1;
+        }
+        _buffer.clear();
+    }
+    bool IsOpen() const
+    {
+        return (_fd >= 0);
+    }
+
+    enum Result { SUCCESS, ERROR, TIMEOUT, FAILURE };
+
+    Result Invoke(uint32_t id, const Call& call, Clock::time_point deadline)
+    {
+        std::string message = "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) + ",\"method\":\"" + call.method + "\"";
+        message += (call.params.empty() ? std::string("}") : ",\"params\":" + call.params + "}");
+
+        if (!SendFrame(0x1, message)) {
+            return (FAILURE);
+        }
+
+        // Notifications and late answers to calls that timed out are skipped
+        const std::string expected = std::to_string(id);
+        while (true) {
+            std::string text;
+            int status = ReceiveMessage(text, deadline);
+            if (status <= 0) {
+                return (status == 0 ? TIMEOUT : FAILURE);
+            }
+            std::map<std::string, std::string> members(Members(text));
+            std::map<std::string, std::string>::const_iterator index(members.find("id"));
+            if ((index != members.end()) && (index->second == expected)) {
+                return (members.count("error") != 0 ? ERROR : SUCCESS);
+            }
+        }
+    }
+
+private:
+    bool Write(const std::string& data)
+    {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t length = send(_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (length < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return (false);
+            }
+            sent += length;
+        }
+        return (true);
+    }
+    // Reads more into the buffer, 0 on timeout, -1 on failure
+    int Fill(Clock::time_point deadline)
+    {
+        int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count());
+        if (remaining <= 0) {
+            return (0);
+        }
+        struct pollfd fd = { _fd, POLLIN, 0 };
+        int result = poll(&fd, 1, remaining);
+        if (result <= 0) {
+            return ((result < 0) && (errno != EINTR) ? -1 : 0);
+        }
+        char data[4096];
+        ssize_t length = recv(_fd, data, sizeof(data), 0);
+        if (length <= 0) {
+            return (-1);
+        }
+        _buffer.append(data, length);
+        return (1);
+    }
+    bool ReadUntil(std::string& data, const char* end, Clock::time_point deadline)
+    {
+        while (_buffer.find(end) == std::string::npos) {
+            if (Fill(deadline) <= 0) {
+                return (false);
+            }
+        }
+        data = _buffer;
+        _buffer.clear();
+        return (true);
+    }
+    bool SendFrame(uint8_t opcode, const std::string& payload)
+    {
+        std::string frame;
+        frame += static_cast<char>(0x80 | opcode);
+        if (payload.size() < 126) {
+            frame += static_cast<char>(0x80 | payload.size());
+        } else if (payload.size() <= 0xFFFF) {
+            frame += static_cast<char>(0x80 | 126);
+            frame += static_cast<char>(payload.size() >> 8);
+            frame += static_cast<char>(payload.size() & 0xFF);
+        } else {
+            frame += static_cast<char>(0x80 | 127);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                frame += static_cast<char>((static_cast<uint64_t>(payload.size()) >> shift) & 0xFF);
+            }
+        }
+        // Client frames are masked
+        uint8_t mask[4];
+        for (uint8_t& byte : mask) {
+            byte = static_cast<uint8_t>(_random());
+            frame += static_cast<char>(byte);
+        }
+        for (size_t index = 0; index < payload.size(); index++) {
+            frame += static_cast<char>(payload[index] ^ mask[index % 4]);
+        }
+        return (Write(frame));
+    }
+    // A whole text message, 0 on timeout, -1 on failure or close
+    int ReceiveMessage(std::string& text, Clock::time_point deadline)
+    {
+        text.clear();
+        while (true) {
+            if (_buffer.size() >= 2) {
+                uint8_t opcode = _buffer[0] & 0x0F;
+                bool final = (_buffer[0] & 0x80) != 0;
+                bool masked = (_buffer[1] & 0x80) != 0;
+                uint64_t length = _buffer[1] & 0x7F;
+                size_t header = 2;
+                if (length == 126) {
+                    header = 4;
+                } else if (length == 127) {
+                    header = 10;
+                }
+                header += (masked ? 4 : 0);
+                if (_buffer.size() >= header) {
+                    if (length == 126) {
+                        length = (static_cast<uint8_t>(_buffer[2]) << 8) | static_cast<uint8_t>(_buffer[3]);
+                    } else if (length == 127) {
+                        length = 0;
+                        for (int index = 2; index < 10; index++) {
+                            length = (length << 8) | static_cast<uint8_t>(_buffer[index]);
+                        }
+                    }
+                    if (_buffer.size() >= header + length) {
+                        std::string payload = _buffer.substr(header, length);
+                        if (masked) {
+                            for (size_t index = 0; index < payload.size(); index++) {
+                                payload[index] ^= _buffer[header - 4 + (index % 4)];
+                            }
+                        }
+                        _buffer.erase(0, header + length);
+
+                        if (opcode == 0x8) {
+                            return (-1);
+                        } else if (opcode == 0x9) {
+                            if (!SendFrame(0xA, payload)) {
+                                return (-1);
+                            }
+                        } else if ((opcode == 0x1) || (opcode == 0x0)) {
+                            text += payload;
+                            if (final) {
+                                return (1);
+                            }
+                        }
+                        continue;
+                    }
+                }
+            }
+            int result = Fill(deadline);
+            if (result <= 0) {
+                return (result);
+            }
+        }
+    }
+
+private:
+    const Options& _options;
+    std::mt19937& _random;
+    int _fd;
+    std::string _buffer;
+};
+
+// One connection, calls due every connections/rate seconds from its own start offset
+class Worker {
+public:
+    Worker(const Options& options, const std::vector<Call>& mix, unsigned index)
+        : _options(options)
+        , _mix(mix)
+        , _random(options.seed * 7919 + index)
+        , _index(index)
+        , _statistics(mix.size())
+    {
+    }
+
+    void Run(Clock::time_point start, Clock::time_point counted, Clock::time_point end)
+    {
+        std::vector<unsigned> weights;
+        for (const Call& call : _mix) {
+            weights.push_back(call.weight);
+        }
+        std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+
+        Connection connection(_options, _random);
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(_options.connections / _options.rate));
+        Clock::time_point due = start + (period * _index) / _options.connections;
+        uint32_t id = 1;
+
+        while (!g_stop && (due < end)) {
+            std::this_thread::sleep_until(due);
+
+            size_t selected = pick(_random);
+            Connection::Result result = Connection::FAILURE;
+            if (connection.IsOpen() || connection.Open()) {
+                result = connection.Invoke(id++, _mix[selected], Clock::now() + std::chrono::milliseconds(_options.timeout));
+            }
+            Clock::time_point done = Clock::now();
+
+            if ((result == Connection::TIMEOUT) || (result == Connection::FAILURE)) {
+                // The answer may still come, a new connection does not get it mixed in
+                connection.Close();
+            }
+
+            if (due >= counted) {
+                Statistics& statistics = _statistics[selected];
+                statistics.calls++;
+                g_calls++;
+                // Error responses are answers too, timeouts and failures have no latency
+                if ((result == Connection::SUCCESS) || (result == Connection::ERROR)) {
+                    statistics.latency.Add(std::chrono::duration_cast<std::chrono::microseconds>(done - due).count());
+                }
+                if (result != Connection::SUCCESS) {
+                    g_errors++;
+                    statistics.errors += (result == Connection::ERROR ? 1 : 0);
+                    statistics.timeouts += (result == Connection::TIMEOUT ? 1 : 0);
+                    statistics.failures += (result == Connection::FAILURE ? 1 : 0);
+                }
+            }
+
+            // Calls that fell behind are sent right away, their latency shows how far behind
+            due += period;
+        }
+    }
+
+    const std::vector<Statistics>& Results() const
+    {
+        return (_statistics);
+    }
+
+private:
+    const Options& _options;
+    const std::vector<Call>& _mix;
+    std::mt19937 _random;
+    unsigned _index;
+    std::vector<Statistics> _statistics;
+};
+
+// RSS and CPU time of the server, from /proc
+class Sampler {
+public:
+    explicit Sampler(int pid)
+        : _pid(pid)
+        , _ticks(sysconf(_SC_CLK_TCK))
+        , _lastCpu(0)
+        , _lastCalls(0)
+        , _lastErrors(0)
+    {
+    }
+
+    static int Find(const char name[])
+    {
+        int found = 0;
+        DIR* proc = opendir("/proc");
+        if (proc != nullptr) {
+            struct dirent* entry;
+            while ((found == 0) && ((entry = readdir(proc)) != nullptr)) {
+                int pid = atoi(entry->d_name);
+                if (pid > 0) {
+                    std::ifstream comm("/proc/" + std::string(entry->d_name) + "/comm");
+                    std::string line;
+                    if (std::getline(comm, line) && (line == name)) {
+                        found = pid;
+                    }
+                }
+            }
+            closedir(proc);
+        }
+        return (found);
+    }
+
+    void Start(Clock::time_point start)
+    {
+        _start = start;
+        _lastTime = start;
+        Cpu(_lastCpu);
+    }
+
+    void Take()
+    {
+        Clock::time_point now = Clock::now();
+        Sample sample;
+        sample.time = std::chrono::duration<double>(now - _start).count();
+        sample.rss = Rss();
+
+        uint64_t cpu = _lastCpu;
+        double elapsed = std::chrono::duration<double>(now - _lastTime).count();
+        sample.cpu = (Cpu(cpu) && (elapsed > 0) ? 100.0 * (cpu - _lastCpu) / _ticks / elapsed : 0.0);
+        _lastCpu = cpu;
+        _lastTime = now;
+
+        uint64_t calls = g_calls;
+        uint64_t errors = g_errors;
+        sample.calls = calls - _lastCalls;
+        sample.errors = errors - _lastErrors;
+        _lastCalls = calls;
+        _lastErrors = errors;
+
+        _samples.push_back(sample);
+    }
+
+    const std::vector<Sample>& Samples() const
+    {
+        return (_samples);
+    }
+
+private:
+    uint64_t Rss() const
+    {
+        std::ifstream status("/proc/" + std::to_string(_pid) + "/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmRSS:") == 0) {
+                return (strtoull(line.c_str() + 6, nullptr, 10));
+            }
+        }
+        return (0);
+    }
+    // utime + stime, fields 14 and 15, counted after the ')' that ends the name
+    bool Cpu(uint64_t& ticks) const
+    {
+        std::ifstream stat("/proc/" + std::to_string(_pid) + "/stat");
+        std::string line;
+        if (!std::getline(stat, line) || (line.rfind(')') == std::string::npos)) {
+            return (false);
+        }
+        std::istringstream fields(line.substr(line.rfind(')') + 2));
+        std::string field;
+        uint64_t utime = 0, stime = 0;
+        for (int index = 3; (index <= 15) && (fields >> field); index++) {
+            if (index == 14) {
+                utime = strtoull(field.c_str(), nullptr, 10);
+            } else if (index == 15) {
+                stime = strtoull(field.c_str(), nullptr, 10);
+            }
+        }
+        ticks = utime + stime;
+        return (true);
+    }
+
+private:
+    int _pid;
+    long _ticks;
+    Clock::time_point _start;
+    Clock::time_point _lastTime;
+    uint64_t _lastCpu;
+    uint64_t _lastCalls;
+    uint64_t _lastErrors;
+    std::vector<Sample> _samples;
+};
+
+// <weight> <method> [<params>], '#' starts a comment
+static bool LoadMix(const std::string& path, std::vector<Call>& mix)
+{
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Can not open the mix %s\n", path.c_str());
+        return (false);
+    }
+    std::string line;
+    unsigned number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        size_t begin = line.find_first_not_of(" \t");
+        if ((begin == std::string::npos) || (line[begin] == '#')) {
+            continue;
+        }
+        std::istringstream fields(line);
+        Call call;
+        if (!(fields >> call.weight >> call.method) || (call.weight == 0)) {
+            fprintf(stderr, "%s:%u: expected <weight> <method> [<params>]\n", path.c_str(), number);
+            return (false);
+        }
+        std::getline(fields, call.params);
+        size_t first = call.params.find_first_not_of(" \t");
+        call.params = (first == std::string::npos ? std::string() : call.params.substr(first));
+        mix.push_back(call);
+    }
+    if (mix.empty()) {
+        fprintf(stderr, "No calls in the mix %s\n", path.c_str());
+    }
+    return (!mix.empty());
+}
+
+static std::string Escape(const std::string& text)
+{
+    std::string result;
+    for (char c : text) {
+        if ((c == '"') || (c == '\\')) {
+            result += '\\';
+        }
+        result += c;
+    }
+    return (result);
+}
+
+static bool WriteResults(const Options& options, const std::vector<Call>& mix, const std::vector<Statistics>& statistics,
+    const Sampler* sampler, double duration)
+{
+    std::ofstream out(options.output);
+    if (!out) {
+        fprintf(stderr, "Can not write %s\n", options.output.c_str());
+        return (false);
+    }
+
+    Statistics total;
+    for (const Statistics& entry : statistics) {
+        total.Merge(entry);
+    }
+
+    auto latency = [](const Histogram& histogram) {
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(3);
+        text << "{\"p50\":" << histogram.Percentile(50) / 1000.0 << ",\"p95\":" << histogram.Percentile(95) / 1000.0
+             << ",\"p99\":" << histogram.Percentile(99) / 1000.0 << ",\"max\":" << histogram.Max() / 1000.0
+             << ",\"mean\":" << histogram.Mean() / 1000.0 << "}";
+        return (text.str());
+    };
+    auto counts = [&latency](const Statistics& entry) {
+        uint64_t failed = entry.errors + entry.timeouts + entry.failures;
+        std::ostringstream text;
+        text << "\"calls\":" << entry.calls << ",\"errors\":" << entry.errors << ",\"timeouts\":" << entry.timeouts
+             << ",\"failures\":" << entry.failures << ",\"errorRate\":" << (entry.calls == 0 ? 0.0 : static_cast<double>(failed) / entry.calls)
+             << ",\"latency\":" << latency(entry.latency);
+        return (text.str());
+    };
+
+    out << "{\n  \"config\":{\"host\":\"" << Escape(options.host) << "\",\"port\":" << options.port
+        << ",\"connections\":" << options.connections << ",\"rate\":" << options.rate << ",\"duration\":" << options.duration
+        << ",\"warmup\":" << options.warmup << ",\"timeout\":" << options.timeout << ",\"seed\":" << options.seed
+        << ",\"mix\":\"" << Escape(options.mix) << "\"},\n";
+    out << "  \"duration\":" << duration << ",\n";
+    out << "  \"rate\":" << (duration > 0 ? total.calls / duration : 0.0) << ",\n";
+    out << "  \"total\":{" << counts(total) << "},\n";
+    out << "  \"methods\":{";
+    for (size_t index = 0; index < mix.size(); index++) {
+        out << (index == 0 ? "\n" : ",\n") << "    \"" << Escape(mix[index].method) << (mix[index].params.empty() ? "" : " " + Escape(mix[index].params))
+            << "\":{\"method\":\"" << Escape(mix[index].method) << "\"," << counts(statistics[index]) << "}";
+    }
+    out << "\n  },\n";
+    out << "  \"server\":{\"pid\":" << options.pid << ",\"samples\":[";
+    if (sampler != nullptr) {
+        const std::vector<Sample>& samples(sampler->Samples());
+        for (size_t index = 0; index < samples.size(); index++) {
+            const Sample& sample(samples[index]);
+            out << (index == 0 ? "\n" : ",\n") << "    {\"time\":" << sample.time << ",\"rss\":" << sample.rss << ",\"cpu\":" << sample.cpu
+                << ",\"calls\":" << sample.calls << ",\"errors\":" << sample.errors << "}";
+        }
+    }
+    out << "\n  ]}\n}\n";
+    return (out.good());
+}
+
+static void Summary(const std::vector<Call>& mix, const std::vector<Statistics>& statistics)
+{
+    printf("%-50s %8s %7s %9s %9s %9s %9s\n", "method", "calls", "errors", "p50 ms", "p95 ms", "p99 ms", "max ms");
+    for (size_t index = 0; index < mix.size(); index++) {
+        const Statistics& entry(statistics[index]);
+        printf("%-50s %8llu %7llu %9.3f %9.3f %9.3f %9.3f\n", mix[index].method.c_str(),
+            static_cast<unsigned long long>(entry.calls), static_cast<unsigned long long>(entry.errors + entry.timeouts + entry.failures),
+            entry.latency.Percentile(50) / 1000.0, entry.latency.Percentile(95) / 1000.0,
+            entry.latency.Percentile(99) / 1000.0, entry.latency.Max() / 1000.0);
+    }
+}
+
+static void Usage(const char name[])
+{
+    printf("Usage: %s --mix <file> [options]\n"
+           "  --host <address>       Thunder address (127.0.0.1)\n"
+           "  --port <port>          Thunder port (9998)\n"
+           "  --token <token>        security token for the WebSocket\n"
+           "  --connections <n>      concurrent WebSocket connections (4)\n"
+           "  --rate <calls/s>       target rate over all connections (20)\n"
+           "  --duration <s>         measured time, after the warm-up (60)\n"
+           "  --warmup <s>           calls made but not counted (5)\n"
+           "  --timeout <ms>         a call without answer by then is a timeout (5000)\n"
+           "  --interval <s>         between samples of the server RSS and CPU (1)\n"
+           "  --pid <pid>            server process (the WPEFramework process)\n"
+           "  --seed <n>             of the method choice, same seed same sequence (1)\n"
+           "  --output <file>        JSON results (load.json)\n", name);
+}
+
+static bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for (int index = 1; index < argc; index++) {
+        std::string option(argv[index]);
+        if ((option == "--help") || (option == "-h") || (index + 1 >= argc)) {
+            return (false);
+        }
+        std::string value(argv[++index]);
+        if (option == "--host") {
+            options.host = value;
+        } else if (option == "--port") {
+            options.port = static_cast<uint16_t>(atoi(value.c_str()));
+        } else if (option == "--token") {
+            options.token = value;
+        } else if (option == "--mix") {
+            options.mix = value;
+        } else if (option == "--output") {
+            options.output = value;
+        } else if (option == "--connections") {
+            options.connections = static_cast<unsigned>(atoi(value.c_str()));
+        } else if (option == "--rate") {
+            options.rate = atof(value.c_str());
+        } else if (option == "--duration") {
+            options.duration = static_cast<unsigned>(atoi(value.c_str()));
+        } else if (option == "--warmup") {
+            options.warmup = static_cast<unsigned>(atoi(value.c_str()));
+        } else if (option == "--timeout") {
+            options.timeout = static_cast<unsigned>(atoi(value.c_str()));
+        } else if (option == "--interval") {
+            options.interval = static_cast<unsigned>(atoi(value.c_str()));
+        } else if (option == "--pid") {
+            options.pid = atoi(value.c_str());
+        } else if (option == "--seed") {
+            options.seed = static_cast<unsigned>(atoi(value.c_str()));
+        } else {
+            return (false);
+        }
+    }
+    return (!options.mix.empty() && (options.connections > 0) && (options.rate > 0) && (options.interval > 0) && (options.timeout > 0));
+}
+
+} // namespace RdkServicesTest
+
+int main(int argc, char* argv[])
+{
+    using namespace RdkServicesTest;
+
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        Usage(argv[0]);
+        return (1);
+    }
+
+    std::vector<Call> mix;
+    if (!LoadMix(options.mix, mix)) {
+        return (1);
+    }
+
+    if (options.pid == 0) {
+        options.pid = Sampler::Find("WPEFramework");
+    }
+    if (options.pid == 0) {
+        fprintf(stderr, "WPEFramework not found, no server samples (--pid)\n");
+    }
+
+    signal(SIGINT, Interrupt);
+    signal(SIGTERM, Interrupt);
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point counted = start + std::chrono::seconds(options.warmup);
+    Clock::time_point end = counted + std::chrono::seconds(options.duration);
+
+    std::vector<Worker*> workers;
+    std::vector<std::thread> threads;
+    for (unsigned index = 0; index < options.connections; index++) {
+        workers.push_back(new Worker(options, mix, index));
+    }
+    for (Worker* worker : workers) {
+        threads.push_back(std::thread(&Worker::Run, worker, start, counted, end));
+    }
+
+    Sampler* sampler = (options.pid != 0 ? new Sampler(options.pid) : nullptr);
+    std::this_thread::sleep_until(counted);
+    if (sampler != nullptr) {
+        sampler->Start(Clock::now());
+    }
+    Clock::time_point next = counted + std::chrono::seconds(options.interval);
+    while (!g_stop && (next <= end)) {
+        std::this_thread::sleep_until(next);
+        if (sampler != nullptr) {
+            sampler->Take();
+        }
+        next += std::chrono::seconds(options.interval);
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double duration = std::max(0.0, std::chrono::duration<double>(std::min(Clock::now(), end) - counted).count());
+
+    std::vector<Statistics> statistics(mix.size());
+    for (Worker* worker : workers) {
+        for (size_t index = 0; index < mix.size(); index++) {
+            statistics[index].Merge(worker->Results()[index]);
+        }
+        delete worker;
+    }
+
+    Summary(mix, statistics);
+    bool written = WriteResults(options, mix, statistics, sampler, duration);
+    delete sampler;
+
+    return (written ? 0 : 1);
+}
@@ -0,0 +1,20 @@
+#!/bin/sh
+
+set -e
+
+THUNDER_ROOT=$(pwd)/thunder
+THUNDER_INSTALL_DIR=${THUNDER_ROOT}/install
+
+# Results of each commit side by side, compare two of them with compare.py of Google Benchmark
+RESULTS_DIR=$(pwd)/benchmarks
+RESULTS=${RESULTS_DIR}/$(git rev-parse --short HEAD).json
+mkdir -p "${RESULTS_DIR}"
+
+PATH=${THUNDER_INSTALL_DIR}/usr/bin:${PATH} \
+LD_LIBRARY_PATH=${THUNDER_INSTALL_DIR}/usr/lib:${THUNDER_INSTALL_DIR}/usr/lib/wpeframework/plugins:${LD_LIBRARY_PATH} \
+RdkServicesBenchmark --benchmark_repetitions=5 --benchmark_report_aggregates_only=true \
+  --benchmark_out="${RESULTS}" --benchmark_out_format=json "$@"
+
+echo "==== DONE ${RESULTS} ===="
+
+exit 0
@@ -39,6 +39,13 @@ TEST(PersistentStoreTest, test) {
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("getNamespaces")));
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("getStorageSize")));
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("flushCache")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("setValues")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("getValues")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("deleteKeys")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("getCacheStats")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("getDatabaseStats")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("setNamespaceTTL")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Exists(_T("getNamespaceTTL")));
 
     // init plugin
 
@@ -53,6 +60,10 @@ TEST(PersistentStoreTest, test) {
     EXPECT_EQ(response, _T("{\"success\":true}"));
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getValue"), _T("{\"namespace\":\"test\",\"key\":\"a\"}"), response));
     EXPECT_EQ(response, _T("{\"value\":\"1\",\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getValue"), _T("{\"namespace\":\"test\",\"key\":\"a\"}"), response));
+    EXPECT_EQ(response, _T("{\"value\":\"1\",\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getCacheStats"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"hits\":1,\"misses\":1,\"size\":1,\"capacity\":128,\"success\":true}"));
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getNamespaces"), _T("{}"), response));
     EXPECT_EQ(response, _T("{\"namespaces\":[\"test\"],\"success\":true}"));
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getStorageSize"), _T("{}"), response));
@@ -65,6 +76,31 @@ TEST(PersistentStoreTest, test) {
     EXPECT_EQ(response, _T("{\"success\":true}"));
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("flushCache"), _T("{}"), response));
     EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("setValues"), _T("{\"items\":[{\"namespace\":\"test\",\"key\":\"a\",\"value\":\"1\"},{\"namespace\":\"test\",\"key\":\"b\",\"value\":\"2\"}]}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getStorageSize"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"namespaceSizes\":{\"test\":4},\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getValues"), _T("{\"items\":[{\"namespace\":\"test\",\"key\":\"a\"},{\"namespace\":\"test\",\"key\":\"c\"}]}"), response));
+    EXPECT_EQ(response, _T("{\"values\":[{\"namespace\":\"test\",\"key\":\"a\",\"value\":\"1\"}],\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("deleteKeys"), _T("{\"items\":[{\"namespace\":\"test\",\"key\":\"a\"},{\"namespace\":\"test\",\"key\":\"b\"}]}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("deleteNamespace"), _T("{\"namespace\":\"test\"}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getDatabaseStats"), _T("{}"), response));
+    EXPECT_NE(string::npos, response.find(_T("\"liveBytes\":0,\"journalMode\":\"delete\"")));
+    EXPECT_NE(string::npos, response.find(_T("\"success\":true")));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("setNamespaceTTL"), _T("{\"namespace\":\"ttl\",\"ttl\":3600}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getNamespaceTTL"), _T("{\"namespace\":\"ttl\"}"), response));
+    EXPECT_EQ(response, _T("{\"ttl\":3600,\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("setValue"), _T("{\"namespace\":\"ttl\",\"key\":\"a\",\"value\":\"1\",\"ttl\":-5}"), response));
+    EXPECT_EQ(response, _T("{\"error\":\"params invalid\",\"success\":false}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("setValue"), _T("{\"namespace\":\"ttl\",\"key\":\"a\",\"value\":\"1\",\"ttl\":60}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("getValue"), _T("{\"namespace\":\"ttl\",\"key\":\"a\"}"), response));
+    EXPECT_EQ(response, _T("{\"value\":\"1\",\"success\":true}"));
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("deleteNamespace"), _T("{\"namespace\":\"ttl\"}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
 
     // clean up
 
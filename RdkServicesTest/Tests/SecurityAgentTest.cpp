@@ -25,6 +25,8 @@
 #include "Source/Config.h"
 #include "Source/Service.h"
 
+#include <fstream>
+
 namespace RdkServicesTest {
 
 TEST(SecurityAgentTest, test) {
@@ -75,6 +77,16 @@ TEST(SecurityAgentTest, test) {
     EXPECT_EQ(WPEFramework::Core::ERROR_NONE, handler.Invoke(connection, _T("validate"), "{\"token\":\"" + token + "\"}", response));
     EXPECT_EQ(response, _T("{\"valid\":true}"));
 
+    // repeated tokens are served from the token cache
+
+    WPEFramework::PluginHost::ISecurity* officer = securityAgent->Officer(token);
+    ASSERT_TRUE(officer != nullptr);
+    WPEFramework::PluginHost::ISecurity* cached = securityAgent->Officer(token);
+    EXPECT_EQ(officer, cached);
+    EXPECT_EQ(officer->Token(), payload);
+    cached->Release();
+    officer->Release();
+
     // invoke rpc-com
 
     string endPoint;
@@ -109,4 +121,68 @@ TEST(SecurityAgentTest, test) {
     _engine.Release();
 }
 
+TEST(SecurityAgentTest, accessControlList) {
+    const string path = _T("/tmp/securityagent_test_acl.json");
+
+    std::ofstream(path) << R"({
+        "assign": [
+            { "url": "*://localhost", "role": "local" },
+            { "url": "*://*.example.com", "role": "partner" },
+            { "url": "*://*.example.org", "role": "wildcard" },
+            { "url": "*", "role": "default" }
+        ],
+        "roles": {
+            "default": { "default": "blocked" },
+            "local": { "default": "allowed" },
+            "partner": {
+                "default": "blocked",
+                "DeviceInfo": { "default": "allowed", "methods": [ "register" ] },
+                "org.rdk.*": { "default": "blocked", "methods": [ "get*", "set*Mode" ] },
+                "org.rdk.System": { "default": "allowed", "methods": [ "reboot" ] }
+            },
+            "wildcard": {
+                "default": "blocked",
+                "*": { "default": "blocked", "methods": [ "*" ] }
+            }
+        }
+    })";
+
+    WPEFramework::Core::File file(path, false);
+    EXPECT_TRUE(file.Open(true));
+
+    WPEFramework::Plugin::AccessControlList acl;
+    EXPECT_EQ(WPEFramework::Core::ERROR_NONE, acl.Load(file));
+
+    const WPEFramework::Plugin::AccessControlList::Filter* local = acl.FilterMapFromURL(_T("http://localhost/index.html"));
+    ASSERT_TRUE(local != nullptr);
+    EXPECT_TRUE(local->Allowed(_T("DeviceInfo"), _T("register")));
+
+    const WPEFramework::Plugin::AccessControlList::Filter* partner = acl.FilterMapFromURL(_T("https://apps.example.com/app?x=1"));
+    ASSERT_TRUE(partner != nullptr);
+    EXPECT_NE(local, partner);
+
+    // literal patterns match every name that contains them, as they always did
+    EXPECT_FALSE(partner->Allowed(_T("DeviceInfo"), _T("register")));
+    EXPECT_FALSE(partner->Allowed(_T("DeviceInfo"), _T("unregister")));
+    EXPECT_TRUE(partner->Allowed(_T("DeviceInfo"), _T("status")));
+    EXPECT_FALSE(partner->Allowed(_T("org.rdk.System"), _T("reboot")));
+    EXPECT_TRUE(partner->Allowed(_T("org.rdk.System"), _T("getMode")));
+    EXPECT_FALSE(partner->Allowed(_T("org.rdk.System.Extra"), _T("reboot")));
+
+    // a '*' after other text never matched, the regex has the '^' in the middle
+    EXPECT_FALSE(partner->Allowed(_T("org.rdk.RDKShell"), _T("getClients")));
+    EXPECT_FALSE(partner->Allowed(_T("org.rdk.DisplaySettings"), _T("setVideoMode")));
+
+    // unlisted plugins take the role default
+    EXPECT_FALSE(partner->Allowed(_T("Monitor"), _T("status")));
+
+    // a lone '*' matches names of letters, digits and dots
+    const WPEFramework::Plugin::AccessControlList::Filter* wildcard = acl.FilterMapFromURL(_T("https://apps.example.org"));
+    ASSERT_TRUE(wildcard != nullptr);
+    EXPECT_TRUE(wildcard->Allowed(_T("org.rdk.RDKShell"), _T("getClients")));
+    EXPECT_FALSE(wildcard->Allowed(_T("org.rdk.RDKShell"), _T("get_clients")));
+
+    file.Destroy();
+}
+
 } // namespace RdkServicesTest
@@ -20,6 +20,9 @@
 #include "RamHelper.h"
 #include "utils.h"
 
+#include <fstream>
+#include <sstream>
+
 // IR-RF Database RF descriptors, needed for all original configurable keys
 // Discrete Power ON/OFF use actual RF keycodes (0x6D, 0x6C), the rest are all XRC ghost codes
 unsigned char const rfDescriptor_DiscretePwrOn[]    = { 0x01, 0x4C, 0x02, 0x01, 0x6D };
@@ -40,6 +43,9 @@ unsigned char const rfDescriptor_Input[]            = { 0x01, 0x4C, 0x02, 0x31,
 #error "ControlMgr RIB request data size is too small for max IR codes!!"
 #endif
 
+// Contents of the RIB IRRFDB entries last written for each controller
+#define RAMS_RIB_CACHE_FILE             "/opt/persistent/rams_rib_cache"
+
 using namespace std;
 
 namespace WPEFramework {
@@ -314,6 +320,8 @@ namespace WPEFramework {
 
                     remoteType = std::string(ctrlStatus.status.type);
 
+                    verifyRibIdentity(deviceID, ctrlStatus.status);
+
                     // Set the booleans concerning 5-digit codes.
                     bFiveDigitCodeSet = (ctrlStatus.status.ir_db_state == CTRLM_RCU_IR_DB_STATE_TV_CODE) ||
                                         (ctrlStatus.status.ir_db_state == CTRLM_RCU_IR_DB_STATE_AVR_CODE) ||
@@ -646,6 +654,12 @@ namespace WPEFramework {
                     (unsigned char)ribRequest.data[12], (unsigned char)ribRequest.data[13], (unsigned char)ribRequest.data[14], (unsigned char)ribRequest.data[15],
                     (unsigned char)ribRequest.data[16], (unsigned char)ribRequest.data[17], (unsigned char)ribRequest.data[18], (unsigned char)ribRequest.data[19]);
 
+            if (isRibEntryCached(ribRequest))
+            {
+                LOGWARN("RIB IRRFDB entry 0x%02X of controller %d is unchanged, not writing it again.", ribRequest.attribute_index, deviceID);
+                return true;
+            }
+
             // Do the direct write to the IR-RF DB RIB entry.
             res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
             if (res == IARM_RESULT_SUCCESS)
@@ -658,16 +672,19 @@ namespace WPEFramework {
                 {
                     LOGWARN("%s: map set for keyName: 0x%02X, rfKeyCode: 0x%02X, %s IrCode size: %d.\n", __FUNCTION__,
                                actionMap.keyName, actionMap.rfKeyCode, ((deviceType == 1) ? "AVR" : "TV"), dataSize);
+                    updateRibEntry(ribRequest, true);
                 }
                 else
                 {
                     LOGERR("FAILURE result in SET ribRequest! result: %d.\n", ribRequest.result);
+                    updateRibEntry(ribRequest, false);
                     return false;
                 }
             }
             else
             {
                 LOGERR("FAILURE in bus call RIB_REQUEST_SET! return value: %d.\n", res);
+                updateRibEntry(ribRequest, false);
                 return false;
             }
 
@@ -860,29 +877,39 @@ namespace WPEFramework {
             ribRequest.length           = 1 + 2 + CONTROLMGR_MAX_IR_DATA_SIZE;
             ribRequest.data[0]          = flags;
 
-            // Direct write to the RIB IRRFDB entry for this RF key.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
-            if (res == IARM_RESULT_SUCCESS)
+            if (isRibEntryCached(ribRequest))
             {
-                LOGWARN("Wrote RIB IR-RF Database: controller_id: %u, network_id: 0x%02X, "
-                        "attribute_id: 0x%02X, attribute_index: 0x%02X, result: %u, length: %u, data[0]: 0x%02X.",
-                        ribRequest.controller_id, ribRequest.network_id, (unsigned char)ribRequest.attribute_id,
-                        ribRequest.attribute_index, ribRequest.result, ribRequest.length, (unsigned char)ribRequest.data[0]);
-                if (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS)
+                LOGWARN("RIB IRRFDB entry 0x%02X of controller %d is already clear, not writing it again.", ribRequest.attribute_index, deviceID);
+            }
+            else
+            {
+                // Direct write to the RIB IRRFDB entry for this RF key.
+                res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+                if (res == IARM_RESULT_SUCCESS)
                 {
-                    LOGWARN("Successfully cleared RIB IRRFDB entry for RF key 0x%02X.\n", (unsigned)rfKey);
+                    LOGWARN("Wrote RIB IR-RF Database: controller_id: %u, network_id: 0x%02X, "
+                            "attribute_id: 0x%02X, attribute_index: 0x%02X, result: %u, length: %u, data[0]: 0x%02X.",
+                            ribRequest.controller_id, ribRequest.network_id, (unsigned char)ribRequest.attribute_id,
+                            ribRequest.attribute_index, ribRequest.result, ribRequest.length, (unsigned char)ribRequest.data[0]);
+                    if (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS)
+                    {
+                        LOGWARN("Successfully cleared RIB IRRFDB entry for RF key 0x%02X.\n", (unsigned)rfKey);
+                        updateRibEntry(ribRequest, true);
+                    }
+                    else
+                    {
+                        LOGERR("FAILURE result in SET ribRequest! status: %d.\n", ribRequest.result);
+                        updateRibEntry(ribRequest, false);
+                        return false;
+                    }
                 }
                 else
                 {
-                    LOGERR("FAILURE result in SET ribRequest! status: %d.\n", ribRequest.result);
+                    LOGERR("FAILURE in bus call RIB_REQUEST_SET! return value: %d.\n", res);
+                    updateRibEntry(ribRequest, false);
                     return false;
                 }
             }
-            else
-            {
-                LOGERR("FAILURE in bus call RIB_REQUEST_SET! return value: %d.\n", res);
-                return false;
-            }
 
             // If we are clearing a power entry, clear the corresponding separate "device" power entry, too.
             if ((rfKey == MSO_RFKEY_PWR_TOGGLE) ||
@@ -1143,6 +1170,12 @@ namespace WPEFramework {
             bytePtr++;
             memcpy(bytePtr, data, dataSize);
 
+            if (isRibEntryCached(ribRequest))
+            {
+                LOGWARN("RIB IRRFDB entry 0x%02X of controller %d is unchanged, not writing it again.", ribRequest.attribute_index, deviceID);
+                return true;
+            }
+
             // Do the direct write to the IR-RF DB RIB entry.
             res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
             if (res == IARM_RESULT_SUCCESS)
@@ -1155,16 +1188,19 @@ namespace WPEFramework {
                 {
                     LOGWARN("separate map set for rfKeyCode: 0x%02X, IrCode size: %d.\n",
                             (unsigned)rfKeyCode, dataSize);
+                    updateRibEntry(ribRequest, true);
                 }
                 else
                 {
                     LOGERR("FAILURE result in SET ribRequest! result: %d.\n", ribRequest.result);
+                    updateRibEntry(ribRequest, false);
                     return false;
                 }
             }
             else
             {
                 LOGERR("FAILURE in bus call RIB_REQUEST_SET! return value: %d.\n", res);
+                updateRibEntry(ribRequest, false);
                 return false;
             }
 
@@ -1212,6 +1248,12 @@ namespace WPEFramework {
             ribRequest.length           = 1 + 2 + CONTROLMGR_MAX_IR_DATA_SIZE;
             ribRequest.data[0]          = flags;
 
+            if (isRibEntryCached(ribRequest))
+            {
+                LOGWARN("RIB IRRFDB entry 0x%02X of controller %d is unchanged, not writing it again.", ribRequest.attribute_index, deviceID);
+                return true;
+            }
+
             // Direct write to the RIB IRRFDB entry for this RF key.
             res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
             if (res == IARM_RESULT_SUCCESS)
@@ -1223,16 +1265,19 @@ namespace WPEFramework {
                 if (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS)
                 {
                     LOGWARN("Successfully cleared separate power slot for rfKeyCode 0x%02X.\n", (unsigned)rfKeyCode);
+                    updateRibEntry(ribRequest, true);
                 }
                 else
                 {
                     LOGERR("FAILURE result in SET ribRequest! status: %d.\n", ribRequest.result);
+                    updateRibEntry(ribRequest, false);
                     return false;
                 }
             }
             else
             {
                 LOGERR("FAILURE in bus call RIB_REQUEST_SET! return value: %d.\n", res);
+                updateRibEntry(ribRequest, false);
                 return false;
             }
 
@@ -1826,6 +1871,184 @@ namespace WPEFramework {
             return keyName;
         }
 
+        //
+        // RIB IRRFDB cache
+        //
+
+        void RemoteActionMappingHelper::verifyRibIdentity(int deviceID, const ctrlm_controller_status_t& status)
+        {
+            std::lock_guard<std::mutex> guard(m_ribCacheMutex);
+            loadRibCacheNoLock();
+
+            ribIdentity& identity = m_ribIdentities[deviceID];
+            if ((identity.ieeeAddress != (unsigned long long)status.ieee_address) ||
+                (identity.timeBinding != (long long)status.time_binding))
+            {
+                // A different remote, or the same remote paired again, holds this controller_id now.
+                // Whatever we wrote before is unknown to its RIB.
+                std::map<std::pair<int, int>, byte_vector_t>::iterator it = m_ribEntries.lower_bound(std::make_pair(deviceID, 0));
+                while ((it != m_ribEntries.end()) && (it->first.first == deviceID))
+                {
+                    it = m_ribEntries.erase(it);
+                }
+                identity.ieeeAddress = (unsigned long long)status.ieee_address;
+                identity.timeBinding = (long long)status.time_binding;
+                m_ribCacheDirty = true;
+            }
+            identity.verified = true;
+        }
+
+        bool RemoteActionMappingHelper::isRibEntryCached(const ctrlm_rcu_iarm_call_rib_request_t& ribRequest)
+        {
+            std::lock_guard<std::mutex> guard(m_ribCacheMutex);
+
+            std::map<int, ribIdentity>::const_iterator identity = m_ribIdentities.find(ribRequest.controller_id);
+            if ((identity == m_ribIdentities.end()) || !identity->second.verified)
+            {
+                return false;
+            }
+
+            std::map<std::pair<int, int>, byte_vector_t>::const_iterator entry =
+                m_ribEntries.find(std::make_pair((int)ribRequest.controller_id, (int)ribRequest.attribute_index));
+            if (entry == m_ribEntries.end())
+            {
+                return false;
+            }
+
+            const byte_vector_t& cached = entry->second;
+            return ((cached.size() == 1 + (size_t)ribRequest.length) &&
+                    (cached[0] == (unsigned char)ribRequest.length) &&
+                    (memcmp(&cached[1], ribRequest.data, ribRequest.length) == 0));
+        }
+
+        // bWritten is false if the write failed, leaving the entry in an unknown state
+        void RemoteActionMappingHelper::updateRibEntry(const ctrlm_rcu_iarm_call_rib_request_t& ribRequest, bool bWritten)
+        {
+            std::lock_guard<std::mutex> guard(m_ribCacheMutex);
+            std::pair<int, int> key((int)ribRequest.controller_id, (int)ribRequest.attribute_index);
+
+            if (bWritten)
+            {
+                byte_vector_t& cached = m_ribEntries[key];
+                cached.assign(1, (unsigned char)ribRequest.length);
+                cached.insert(cached.end(), (const unsigned char*)ribRequest.data, (const unsigned char*)ribRequest.data + ribRequest.length);
+            }
+            else
+            {
+                m_ribEntries.erase(key);
+            }
+            m_ribCacheDirty = true;
+        }
+
+        void RemoteActionMappingHelper::loadRibCacheNoLock()
+        {
+            if (m_ribCacheLoaded)
+            {
+                return;
+            }
+            m_ribCacheLoaded = true;
+
+            // One line per controller ("I <controller_id> <ieee_address> <time_binding>"),
+            // followed by one line per entry ("E <controller_id> <attribute_index> <hex length + data>").
+            std::ifstream file(RAMS_RIB_CACHE_FILE);
+            std::string line;
+            while (std::getline(file, line))
+            {
+                std::istringstream fields(line);
+                std::string tag;
+                int deviceID = 0;
+
+                fields >> tag >> deviceID;
+                if (tag == "I")
+                {
+                    ribIdentity identity = { 0, 0, false };
+                    fields >> std::hex >> identity.ieeeAddress >> std::dec >> identity.timeBinding;
+                    if (!fields.fail())
+                    {
+                        m_ribIdentities[deviceID] = identity;
+                    }
+                }
+                else if (tag == "E")
+                {
+                    int index = 0;
+                    std::string hex;
+                    fields >> index >> hex;
+                    if (fields.fail() || (hex.size() < 2) || (hex.size() % 2) != 0)
+                    {
+                        continue;
+                    }
+                    byte_vector_t data;
+                    for (size_t i = 0; i < hex.size(); i += 2)
+                    {
+                        data.push_back((unsigned char)strtoul(hex.substr(i, 2).c_str(), NULL, 16));
+                    }
+                    if (data.size() == 1 + (size_t)data[0])
+                    {
+                        m_ribEntries[std::make_pair(deviceID, index)] = data;
+                    }
+                }
+            }
+
+            // Entries without a known pairing can never be verified
+            std::map<std::pair<int, int>, byte_vector_t>::iterator it = m_ribEntries.begin();
+            while (it != m_ribEntries.end())
+            {
+                if (m_ribIdentities.find(it->first.first) == m_ribIdentities.end())
+                {
+                    it = m_ribEntries.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            LOGINFO("Loaded %d cached RIB IRRFDB entries.", (int)m_ribEntries.size());
+        }
+
+        void RemoteActionMappingHelper::saveRibCache()
+        {
+            std::lock_guard<std::mutex> guard(m_ribCacheMutex);
+
+            if (!m_ribCacheDirty)
+            {
+                return;
+            }
+
+            std::string tmpFile = std::string(RAMS_RIB_CACHE_FILE) + ".tmp";
+            std::ofstream file(tmpFile.c_str(), std::ios::trunc);
+            if (!file.is_open())
+            {
+                LOGERR("ERROR - can't open %s!", tmpFile.c_str());
+                return;
+            }
+
+            for (std::map<int, ribIdentity>::const_iterator it = m_ribIdentities.begin(); it != m_ribIdentities.end(); ++it)
+            {
+                file << "I " << it->first << " " << std::hex << it->second.ieeeAddress << std::dec << " " << it->second.timeBinding << "\n";
+            }
+            for (std::map<std::pair<int, int>, byte_vector_t>::const_iterator it = m_ribEntries.begin(); it != m_ribEntries.end(); ++it)
+            {
+                char hex[3];
+                file << "E " << it->first.first << " " << it->first.second << " ";
+                for (unsigned char byte : it->second)
+                {
+                    snprintf(hex, sizeof(hex), "%02X", byte);
+                    file << hex;
+                }
+                file << "\n";
+            }
+            file.close();
+
+            if (file.fail() || (rename(tmpFile.c_str(), RAMS_RIB_CACHE_FILE) != 0))
+            {
+                LOGERR("ERROR - failed to write %s!", RAMS_RIB_CACHE_FILE);
+                remove(tmpFile.c_str());
+                return;
+            }
+            m_ribCacheDirty = false;
+        }
+
     } // namespace Plugin
 
 } // namespace WPEFramework
@@ -25,6 +25,8 @@
 #include "ctrlm_ipc.h"
 #include "ctrlm_ipc_rcu.h"
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -298,11 +300,35 @@ namespace WPEFramework {
             bool setDevicePower(int deviceID, int keymapType, keyActionMap& actionMap);
             bool clearDevicePower(int deviceID, int keymapType, int rfKeyCode);
 
+            // Persists the RIB IRRFDB cache, if it changed since the last save
+            void saveRibCache();
+
         private:
             ctrlm_network_id_t getRf4ceNetworkID(void);
             bool getRf4ceBindRemotes(rf4ceBindRemotes_t* bindRemotes);
             bool setRIBDevicePower(int deviceID, int keymapType, int rfKeyCode, byte_vector_t& irData);
             bool clearRIBDevicePower(int deviceID, int keymapType, int rfKeyCode);
+
+            // Cache of the IRRFDB entries written to the RIB of each controller, so that unchanged
+            // entries are not written again. Entries of a controller are only trusted once its
+            // pairing (IEEE address and binding time) has been checked by getControllerByID(),
+            // a new pairing drops them.
+            struct ribIdentity {
+                unsigned long long  ieeeAddress;
+                long long           timeBinding;
+                bool                verified;
+            };
+
+            void verifyRibIdentity(int deviceID, const ctrlm_controller_status_t& status);
+            bool isRibEntryCached(const ctrlm_rcu_iarm_call_rib_request_t& ribRequest);
+            void updateRibEntry(const ctrlm_rcu_iarm_call_rib_request_t& ribRequest, bool bWritten);
+            void loadRibCacheNoLock();
+
+            std::map<int, ribIdentity>                      m_ribIdentities;
+            std::map<std::pair<int, int>, byte_vector_t>    m_ribEntries;   // (controller_id, attribute_index) -> length + data
+            bool                                            m_ribCacheLoaded = false;
+            bool                                            m_ribCacheDirty = false;
+            std::mutex                                      m_ribCacheMutex;
         };
 
     } // namespace Plugin
@@ -1540,6 +1540,8 @@ namespace WPEFramework {
                 // Initialize the controller load progress state.
                 m_readProgress.clear();
             }
+            // Entries that are unchanged next time are not written again
+            m_helper.saveRibCache();
 
             return success;
         }  // end of setKeyActionMapping()
@@ -1595,6 +1597,7 @@ namespace WPEFramework {
                 // Initialize the controller load progress state.
                 m_readProgress.clear();
             }
+            m_helper.saveRibCache();
 
             return result;
         }
@@ -0,0 +1,102 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FrameSignature.h"
+
+#include <algorithm>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        FrameSignature::FrameSignature()
+            : m_valid(false)
+        {
+            memset(m_tiles, 0, sizeof(m_tiles));
+        }
+
+        void FrameSignature::compute(const ImageFrame& frame)
+        {
+            m_valid = false;
+
+            if (NULL == frame.data || frame.width < COLUMNS || frame.height < ROWS)
+                return;
+
+            const int red = frame.bgr ? 2 : 0;
+            const int blue = frame.bgr ? 0 : 2;
+
+            for (int ty = 0; ty < ROWS; ty++)
+            {
+                const int top = ty * frame.height / ROWS;
+                const int height = (ty + 1) * frame.height / ROWS - top;
+                const int rows = std::min<int>(SAMPLES, height);
+
+                for (int tx = 0; tx < COLUMNS; tx++)
+                {
+                    const int left = tx * frame.width / COLUMNS;
+                    const int width = (tx + 1) * frame.width / COLUMNS - left;
+                    const int columns = std::min<int>(SAMPLES, width);
+                    unsigned int sum = 0;
+
+                    for (int y = 0; y < rows; y++)
+                    {
+                        const unsigned char *line = frame.data + static_cast<ptrdiff_t>(top + y * height / rows) * frame.stride;
+                        for (int x = 0; x < columns; x++)
+                        {
+                            const unsigned char *pixel = line + (left + x * width / columns) * 4;
+                            sum += (77 * pixel[red] + 150 * pixel[1] + 29 * pixel[blue]) >> 8;
+                        }
+                    }
+
+                    m_tiles[ty * COLUMNS + tx] = static_cast<uint8_t>(sum / (rows * columns));
+                }
+            }
+
+            m_valid = true;
+        }
+
+        int FrameSignature::difference(const FrameSignature& other) const
+        {
+            if (!m_valid || !other.m_valid)
+                return 100;
+
+            int changed = 0;
+            for (int i = 0; i < TILES; i++)
+            {
+                if (abs(m_tiles[i] - other.m_tiles[i]) > TILE_TOLERANCE)
+                    changed++;
+            }
+
+            return (changed * 100 + TILES - 1) / TILES;
+        }
+
+        int FrameSignature::luminance() const
+        {
+            unsigned int sum = 0;
+            for (int i = 0; i < TILES; i++)
+                sum += m_tiles[i];
+
+            return m_valid ? static_cast<int>(sum / TILES) : 0;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,58 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "ImageStream.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Average luma of a 16x9 grid of tiles, sampled at most 8x8 pixels per tile,
+        // so a 1080p frame costs some 9000 pixel reads instead of an encode.
+        class FrameSignature
+        {
+        public:
+            enum { COLUMNS = 16, ROWS = 9, TILES = COLUMNS * ROWS, SAMPLES = 8 };
+
+            // Luma difference of a tile below which it counts as unchanged (noise, dithering).
+            enum { TILE_TOLERANCE = 8 };
+
+            FrameSignature();
+
+            void compute(const ImageFrame& frame);
+            void reset() { m_valid = false; }
+            bool valid() const { return m_valid; }
+
+            // Percentage (0..100) of tiles that changed, 100 if either has no frame.
+            int difference(const FrameSignature& other) const;
+
+            // Average luma of the frame, 0 (black) .. 255.
+            int luminance() const;
+
+        private:
+            uint8_t m_tiles[TILES];
+            bool m_valid;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
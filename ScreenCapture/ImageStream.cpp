@@ -0,0 +1,397 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ImageStream.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <png.h>
+#include <setjmp.h>
+#include <string.h>
+
+#ifdef USE_JPEG
+#include <stdio.h>
+extern "C" {
+#include <jpeglib.h>
+}
+#endif
+
+#define JPEG_OUTPUT_CHUNK 16384
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        struct ImageStream::Png
+        {
+            png_structp png = NULL;
+            png_infop info = NULL;
+        };
+
+        static void PngWriteCallback(png_structp png_ptr, png_bytep data, png_size_t length)
+        {
+            static_cast<ImageStream*>(png_get_io_ptr(png_ptr))->append(data, length);
+        }
+
+#ifdef USE_JPEG
+        struct ImageStream::Jpeg
+        {
+            struct jpeg_compress_struct cinfo;
+            struct jpeg_error_mgr error;
+            struct jpeg_destination_mgr destination;
+            jmp_buf jump;
+            ImageStream *owner;
+            unsigned char buffer[JPEG_OUTPUT_CHUNK];
+
+            // Hands what the encoder wrote so far to the stream.
+            void flush()
+            {
+                size_t length = sizeof(buffer) - destination.free_in_buffer;
+                if (length > 0)
+                    owner->append(buffer, length);
+                destination.next_output_byte = buffer;
+                destination.free_in_buffer = sizeof(buffer);
+            }
+        };
+
+        static void JpegError(j_common_ptr cinfo)
+        {
+            char message[JMSG_LENGTH_MAX];
+            (*cinfo->err->format_message)(cinfo, message);
+            LOGERR("jpeg encoding failed: %s", message);
+            longjmp(static_cast<ImageStream::Jpeg*>(cinfo->client_data)->jump, 1);
+        }
+
+        static void JpegInitDestination(j_compress_ptr cinfo)
+        {
+            ImageStream::Jpeg *jpeg = static_cast<ImageStream::Jpeg*>(cinfo->client_data);
+            jpeg->destination.next_output_byte = jpeg->buffer;
+            jpeg->destination.free_in_buffer = sizeof(jpeg->buffer);
+        }
+
+        static boolean JpegEmptyOutputBuffer(j_compress_ptr cinfo)
+        {
+            // The buffer is full.
+            static_cast<ImageStream::Jpeg*>(cinfo->client_data)->flush();
+            return TRUE;
+        }
+
+        static void JpegTermDestination(j_compress_ptr cinfo)
+        {
+            static_cast<ImageStream::Jpeg*>(cinfo->client_data)->flush();
+        }
+#else
+        struct ImageStream::Jpeg
+        {
+        };
+#endif
+
+        ImageStream::ImageStream(const ImageFrame& frame, const ImageOptions& options)
+            : m_frame(frame)
+            , m_options(options)
+            , m_width(0)
+            , m_height(0)
+            , m_row(0)
+            , m_failed(false)
+            , m_done(false)
+            , m_produced(0)
+            , m_offset(0)
+            , m_png(NULL)
+            , m_jpeg(NULL)
+        {
+            if (m_options.scale < 1)
+                m_options.scale = 1;
+
+            m_width = (m_frame.width + m_options.scale - 1) / m_options.scale;
+            m_height = (m_frame.height + m_options.scale - 1) / m_options.scale;
+        }
+
+        ImageStream::~ImageStream()
+        {
+            release();
+        }
+
+        bool ImageStream::supported(ImageOptions::Format format)
+        {
+#ifdef USE_JPEG
+            return (ImageOptions::PNG == format || ImageOptions::JPEG == format);
+#else
+            return (ImageOptions::PNG == format);
+#endif
+        }
+
+        const char *ImageStream::contentType() const
+        {
+            return (ImageOptions::JPEG == m_options.format) ? "image/jpeg" : "image/png";
+        }
+
+        void ImageStream::append(const unsigned char *data, size_t length)
+        {
+            m_pending.insert(m_pending.end(), data, data + length);
+            m_produced += length;
+        }
+
+        bool ImageStream::start()
+        {
+            if (NULL == m_frame.data || m_frame.width <= 0 || m_frame.height <= 0 || !supported(m_options.format))
+            {
+                LOGERR("Error: nothing to encode (%dx%d) or unsupported format", m_frame.width, m_frame.height);
+                m_failed = true;
+                return false;
+            }
+
+            if (ImageOptions::PNG == m_options.format)
+            {
+                m_png = new Png();
+                m_png->png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+                if (NULL != m_png->png)
+                    m_png->info = png_create_info_struct(m_png->png);
+
+                if (NULL == m_png->info)
+                {
+                    LOGERR("Error: failed to create the png write structs.");
+                    m_failed = true;
+                }
+                else if (setjmp(png_jmpbuf(m_png->png)))
+                {
+                    LOGERR("Error: failed to write the png header.");
+                    m_failed = true;
+                }
+                else
+                {
+                    png_set_write_fn(m_png->png, this, PngWriteCallback, NULL);
+                    png_set_IHDR(m_png->png, m_png->info, m_width, m_height, 8, PNG_COLOR_TYPE_RGBA,
+                                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+                    png_set_compression_level(m_png->png, m_options.compression);
+                    png_write_info(m_png->png, m_png->info);
+
+                    // Rows are handed over as captured when they need no scaling.
+                    if (1 == m_options.scale && m_frame.bgr)
+                        png_set_bgr(m_png->png);
+                }
+            }
+#ifdef USE_JPEG
+            else
+            {
+                m_jpeg = new Jpeg();
+                m_jpeg->owner = this;
+                m_jpeg->cinfo.err = jpeg_std_error(&m_jpeg->error);
+                m_jpeg->error.error_exit = JpegError;
+                m_jpeg->cinfo.client_data = m_jpeg;
+
+                if (setjmp(m_jpeg->jump))
+                {
+                    m_failed = true;
+                }
+                else
+                {
+                    jpeg_create_compress(&m_jpeg->cinfo);
+                    m_jpeg->cinfo.client_data = m_jpeg;
+                    m_jpeg->destination.init_destination = JpegInitDestination;
+                    m_jpeg->destination.empty_output_buffer = JpegEmptyOutputBuffer;
+                    m_jpeg->destination.term_destination = JpegTermDestination;
+                    m_jpeg->cinfo.dest = &m_jpeg->destination;
+
+                    m_jpeg->cinfo.image_width = m_width;
+                    m_jpeg->cinfo.image_height = m_height;
+                    m_jpeg->cinfo.input_components = 3;
+                    m_jpeg->cinfo.in_color_space = JCS_RGB;
+                    jpeg_set_defaults(&m_jpeg->cinfo);
+                    jpeg_set_quality(&m_jpeg->cinfo, m_options.quality, TRUE);
+                    jpeg_start_compress(&m_jpeg->cinfo, TRUE);
+                    m_jpeg->flush();
+                }
+            }
+#endif
+
+            if (m_failed)
+                release();
+
+            return !m_failed;
+        }
+
+        size_t ImageStream::read(unsigned char *buffer, size_t size)
+        {
+            size_t copied = 0;
+
+            while (copied < size && !m_failed)
+            {
+                if (m_offset < m_pending.size())
+                {
+                    size_t length = std::min(size - copied, m_pending.size() - m_offset);
+                    memcpy(buffer + copied, &m_pending[m_offset], length);
+                    m_offset += length;
+                    copied += length;
+                }
+                else if (m_done)
+                {
+                    break;
+                }
+                else
+                {
+                    // Keeps the capacity, the encoder refills it with about the same amount.
+                    m_pending.clear();
+                    m_offset = 0;
+
+                    if (m_row < m_height)
+                        encodeRow();
+                    else
+                        finish();
+                }
+            }
+
+            return m_failed ? 0 : copied;
+        }
+
+        // Row "row" of the encoded image, either straight from the frame or
+        // averaged over scale x scale pixels into RGB(A) byte order.
+        const unsigned char *ImageStream::sourceRow(int row)
+        {
+            const int scale = m_options.scale;
+            const bool alpha = (ImageOptions::PNG == m_options.format);
+
+            if (1 == scale && alpha)
+                return m_frame.data + static_cast<ptrdiff_t>(row) * m_frame.stride;
+
+            const int channels = alpha ? 4 : 3;
+            const int red = m_frame.bgr ? 2 : 0;
+            const int blue = m_frame.bgr ? 0 : 2;
+            const int top = row * scale;
+            const int rows = std::min(scale, m_frame.height - top);
+
+            m_rowBuffer.resize(static_cast<size_t>(m_width) * channels);
+
+            for (int x = 0; x < m_width; x++)
+            {
+                const int left = x * scale;
+                const int columns = std::min(scale, m_frame.width - left);
+                unsigned int sum[4] = { 0, 0, 0, 0 };
+
+                for (int y = 0; y < rows; y++)
+                {
+                    const unsigned char *pixel = m_frame.data + static_cast<ptrdiff_t>(top + y) * m_frame.stride + left * 4;
+                    for (int i = 0; i < columns; i++, pixel += 4)
+                    {
+                        sum[0] += pixel[red];
+                        sum[1] += pixel[1];
+                        sum[2] += pixel[blue];
+                        sum[3] += pixel[3];
+                    }
+                }
+
+                const unsigned int count = rows * columns;
+                unsigned char *out = &m_rowBuffer[static_cast<size_t>(x) * channels];
+                for (int c = 0; c < channels; c++)
+                    out[c] = static_cast<unsigned char>(sum[c] / count);
+            }
+
+            return &m_rowBuffer[0];
+        }
+
+        void ImageStream::encodeRow()
+        {
+            if (NULL != m_png)
+            {
+                if (setjmp(png_jmpbuf(m_png->png)))
+                {
+                    LOGERR("Error: failed to write png row %d.", m_row);
+                    m_failed = true;
+                }
+                else
+                {
+                    png_write_row(m_png->png, const_cast<png_bytep>(sourceRow(m_row)));
+                    m_row++;
+                }
+            }
+#ifdef USE_JPEG
+            else if (NULL != m_jpeg)
+            {
+                if (setjmp(m_jpeg->jump))
+                {
+                    m_failed = true;
+                }
+                else
+                {
+                    JSAMPROW row = const_cast<JSAMPROW>(sourceRow(m_row));
+                    jpeg_write_scanlines(&m_jpeg->cinfo, &row, 1);
+                    m_jpeg->flush();
+                    m_row++;
+                }
+            }
+#endif
+            else
+            {
+                m_failed = true;
+            }
+
+            if (m_failed)
+                release();
+        }
+
+        void ImageStream::finish()
+        {
+            if (NULL != m_png)
+            {
+                if (setjmp(png_jmpbuf(m_png->png)))
+                {
+                    LOGERR("Error: failed to finish the png.");
+                    m_failed = true;
+                }
+                else
+                {
+                    png_write_end(m_png->png, m_png->info);
+                }
+            }
+#ifdef USE_JPEG
+            else if (NULL != m_jpeg)
+            {
+                if (setjmp(m_jpeg->jump))
+                    m_failed = true;
+                else
+                    jpeg_finish_compress(&m_jpeg->cinfo);
+            }
+#endif
+
+            m_done = true;
+            release();
+        }
+
+        void ImageStream::release()
+        {
+            if (NULL != m_png)
+            {
+                png_destroy_write_struct(&m_png->png, &m_png->info);
+                delete m_png;
+                m_png = NULL;
+            }
+#ifdef USE_JPEG
+            if (NULL != m_jpeg)
+            {
+                jpeg_destroy_compress(&m_jpeg->cinfo);
+                delete m_jpeg;
+                m_jpeg = NULL;
+            }
+#endif
+            m_rowBuffer.clear();
+            m_rowBuffer.shrink_to_fit();
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
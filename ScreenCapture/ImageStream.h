@@ -0,0 +1,104 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // 32 bit pixels as captured, RGBA (or BGRA) byte order. A negative stride
+        // walks the rows bottom up, data then points at the first row to encode.
+        struct ImageFrame
+        {
+            const unsigned char *data;
+            int width;
+            int height;
+            int stride;
+            bool bgr;
+        };
+
+        struct ImageOptions
+        {
+            enum Format { PNG, JPEG };
+
+            Format format = PNG;
+            int compression = 6;    // zlib level of PNG, 0..9
+            int quality = 85;       // JPEG, 1..100
+            int scale = 1;          // output is 1/scale of the frame in both directions
+        };
+
+        // Encodes a frame while it is being read, strictly on demand: read() encodes
+        // just enough rows to fill the caller's buffer. Apart from the encoder state
+        // only one output row and the bytes not read yet are held, never the image.
+        class ImageStream
+        {
+        private:
+            ImageStream(const ImageStream&) = delete;
+            ImageStream& operator=(const ImageStream&) = delete;
+
+        public:
+            ImageStream(const ImageFrame& frame, const ImageOptions& options);
+            ~ImageStream();
+
+            static bool supported(ImageOptions::Format format);
+
+            // Writes the file header, false if the encoder could not be set up.
+            bool start();
+
+            // Next bytes of the image, 0 once it is complete (or failed()).
+            size_t read(unsigned char *buffer, size_t size);
+
+            bool failed() const { return m_failed; }
+            size_t produced() const { return m_produced; }
+            const char *contentType() const;
+
+            // Output of the encoders, and their state (ImageStream.cpp).
+            void append(const unsigned char *data, size_t length);
+            struct Png;
+            struct Jpeg;
+
+        private:
+            const unsigned char *sourceRow(int row);
+            void encodeRow();
+            void finish();
+            void release();
+
+        private:
+            ImageFrame m_frame;
+            ImageOptions m_options;
+            int m_width;
+            int m_height;
+            int m_row;
+            bool m_failed;
+            bool m_done;
+            size_t m_produced;
+            size_t m_offset;
+            std::vector<unsigned char> m_pending;
+            std::vector<unsigned char> m_rowBuffer;
+            Png *m_png;
+            Jpeg *m_jpeg;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -26,7 +26,6 @@
 #include <nxclient.h>
 #endif
 
-#include <png.h>
 #include <curl/curl.h>
 #include <base64.h>
 
@@ -41,9 +40,17 @@ extern "C" {
 
 // Methods
 #define METHOD_UPLOAD "uploadScreenCapture"
+#define METHOD_START_CONTINUOUS "startContinuousCapture"
+#define METHOD_STOP_CONTINUOUS "stopContinuousCapture"
 
 // Events
 #define EVT_UPLOAD_COMPLETE "uploadComplete"
+#define EVT_SCREEN_CHANGED "screenChanged"
+
+#define CONTINUOUS_INTERVAL_DEFAULT 5000
+#define CONTINUOUS_INTERVAL_MIN 500
+#define CONTINUOUS_INTERVAL_MAX 3600000
+#define CONTINUOUS_THRESHOLD_DEFAULT 5
 
 #if defined(PLATFORM_AMLOGIC)
 std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> gRSKShellConnection;
@@ -66,9 +73,12 @@ namespace WPEFramework
 #if defined(PLATFORM_AMLOGIC)
             screenWidth = 1280;
             screenHeight = 720;
+            continuousPending = false;
 #endif   
 
             Register(METHOD_UPLOAD, &ScreenCapture::uploadScreenCapture, this);
+            Register(METHOD_START_CONTINUOUS, &ScreenCapture::startContinuousCapture, this);
+            Register(METHOD_STOP_CONTINUOUS, &ScreenCapture::stopContinuousCapture, this);
         }
 
         ScreenCapture::~ScreenCapture()
@@ -84,6 +94,12 @@ namespace WPEFramework
 
         void ScreenCapture::Deinitialize(PluginHost::IShell* /* service */)
         {
+            {
+                std::lock_guard<std::mutex> lock(m_continuousMutex);
+                continuousCapture.active = false;
+            }
+            screenShotDispatcher->Revoke(ScreenShotJob(this, true));
+
             delete screenShotDispatcher;
         }
 
@@ -93,6 +109,8 @@ namespace WPEFramework
             if (parameters.HasLabel("imageData"))
             {
                 std::string imageData = parameters["imageData"].String();
+                bool isContinuous = continuousPending;
+                continuousPending = false;
 
                 size_t decodedImageSize = b64_get_decoded_buffer_size(imageData.size());
 
@@ -104,30 +122,19 @@ namespace WPEFramework
 
                 uint8_t *decodedImage = (uint8_t*)malloc(decodedImageSize);
                 b64_decode((const uint8_t*) imageData.c_str(), imageData.size(), decodedImage);
+                imageData.clear();
 
-                // flip the image
-                uint32_t *decodedImageRGBA = (uint32_t *)decodedImage;
-                for(size_t row = 0; row < screenHeight / 2; row++)
-                {
-                    for(size_t col = 0; col < screenWidth; col++)
-                    {
-                        uint32_t p = decodedImageRGBA[row * screenWidth + col];
-
-                        decodedImageRGBA[row * screenWidth + col] = decodedImageRGBA[(screenHeight - 1 - row) * screenWidth + col];
-                        decodedImageRGBA[(screenHeight - 1 - row) * screenWidth + col] = p;
-                    }
-                }
+                // the image is upside down, encode it from the last row up
+                ImageFrame frame;
+                frame.width = screenWidth;
+                frame.height = screenHeight;
+                frame.stride = -(int)(screenWidth * 4);
+                frame.data = decodedImage + (screenHeight - 1) * screenWidth * 4;
+                frame.bgr = false;
 
-                std::vector<unsigned char> png_out_data;
-                if(!saveToPng((unsigned char *)decodedImage, screenWidth, screenHeight, png_out_data))
-                {
-                    LOGERR("Failed to convert ScreenShot data to png");
-                    return;
-                }
+                onFrame(&frame, isContinuous);
 
                 free(decodedImage);
-
-                doUploadScreenCapture(png_out_data, true);
             }
 
         }
@@ -139,25 +146,140 @@ namespace WPEFramework
 
             LOGINFOMETHOD();
 
-            if(!parameters.HasLabel("url"))
+            if(!getUploadTarget(parameters, uploadTarget, response))
+                returnResponse(false);
+
+#if defined(PLATFORM_AMLOGIC)
+            requestScreenShot(false);
+#else
+            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this) );
+#endif
+
+            returnResponse(true);
+        }
+
+        uint32_t ScreenCapture::startContinuousCapture(const JsonObject& parameters, JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_callMutex);
+
+            LOGINFOMETHOD();
+
+            UploadTarget target;
+            if(!getUploadTarget(parameters, target, response))
+                returnResponse(false);
+
+            int interval = CONTINUOUS_INTERVAL_DEFAULT;
+            int threshold = CONTINUOUS_THRESHOLD_DEFAULT;
+
+            if(parameters.HasLabel("interval"))
+                getNumberParameter("interval", interval);
+            if(parameters.HasLabel("threshold"))
+                getNumberParameter("threshold", threshold);
+
+            if(interval < CONTINUOUS_INTERVAL_MIN || interval > CONTINUOUS_INTERVAL_MAX)
             {
-                response["message"] = "Upload url is not specified";
+                response["message"] = "Invalid interval";
+                returnResponse(false);
+            }
 
+            if(threshold < 0 || threshold > 100)
+            {
+                response["message"] = "Invalid threshold";
                 returnResponse(false);
             }
 
-            url = parameters["url"].String();
+            // a new configuration starts over, the first capture is always uploaded
+            screenShotDispatcher->Revoke(ScreenShotJob(this, true));
+            {
+                std::lock_guard<std::mutex> lock(m_continuousMutex);
+                continuousCapture.active = true;
+                continuousCapture.interval = interval;
+                continuousCapture.threshold = threshold;
+                continuousCapture.target = target;
+                continuousCapture.signature.reset();
+            }
+            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this, true) );
+
+            returnResponse(true);
+        }
+
+        uint32_t ScreenCapture::stopContinuousCapture(const JsonObject& parameters, JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_callMutex);
+
+            LOGINFOMETHOD();
+
+            bool wasActive = false;
+            {
+                std::lock_guard<std::mutex> lock(m_continuousMutex);
+                wasActive = continuousCapture.active;
+                continuousCapture.active = false;
+            }
+            screenShotDispatcher->Revoke(ScreenShotJob(this, true));
+
+            if(!wasActive)
+                response["message"] = "Continuous capture is not running";
+
+            returnResponse(wasActive);
+        }
+
+        bool ScreenCapture::getUploadTarget(const JsonObject& parameters, UploadTarget& target, JsonObject& response)
+        {
+            if(!parameters.HasLabel("url"))
+            {
+                response["message"] = "Upload url is not specified";
+                return false;
+            }
+
+            target.url = parameters["url"].String();
 
             if(parameters.HasLabel("callGUID"))
-              callGUID = parameters["callGUID"].String();
-              
+              target.callGUID = parameters["callGUID"].String();
+
+            ImageOptions &options = target.options;
+            options = ImageOptions();
+
+            if(parameters.HasLabel("format"))
+            {
+                std::string format = parameters["format"].String();
+                if(format == "jpeg")
+                    options.format = ImageOptions::JPEG;
+                else if(format != "png")
+                    options.format = (ImageOptions::Format)-1;
+
+                if(!ImageStream::supported(options.format))
+                {
+                    response["message"] = "Unsupported image format";
+                    return false;
+                }
+            }
+            if(parameters.HasLabel("compression"))
+                getNumberParameter("compression", options.compression);
+            if(parameters.HasLabel("quality"))
+                getNumberParameter("quality", options.quality);
+            if(parameters.HasLabel("scale"))
+                getNumberParameter("scale", options.scale);
+
+            if(options.compression < 0 || options.compression > 9 ||
+               options.quality < 1 || options.quality > 100 ||
+               options.scale < 1 || options.scale > 8)
+            {
+                response["message"] = "Invalid compression, quality or scale";
+                return false;
+            }
+
+            return true;
+        }
+
+        bool ScreenCapture::requestScreenShot(bool continuous)
+        {
 #if defined(PLATFORM_AMLOGIC)
 
             if (nullptr == gRSKShellConnection)
             {
                 std::string serviceCallsign = "org.rdk.RDKShell";
                 serviceCallsign.append(".1");
-                gRSKShellConnection = Utils::getThunderControllerClient(serviceCallsign);
+                gRSKShellConnection = Utils::getThunderControllerClient(serviceCallsign, "ScreenCapture");
             }
 
             if (nullptr != gRSKShellConnection)
@@ -191,18 +313,26 @@ namespace WPEFramework
                     }
                 }
 
+                // the frame arrives with onScreenshotComplete, which has to know what it was taken for
+                continuousPending = continuous;
+
                 status = gRSKShellConnection->Invoke(SCREENCAPTURE_THUNDER_TIMEOUT, "getScreenshot", req, res);
                 if(Core::ERROR_NONE != status)
+                {
                     LOGERR("Failed to call getScreenshot: %d", status);
+                    continuousPending = false;
+                    return false;
+                }
+
+                return true;
             }
             else
                 LOGERR("Not subscribed to onScreenshotComplete event");
 
+            return false;
 #else
-            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this) );
+            return getScreenShot(continuous);
 #endif
-
-            returnResponse(true);
         }
 
         uint64_t ScreenShotJob::Timed(const uint64_t scheduledTime)
@@ -213,40 +343,101 @@ namespace WPEFramework
                 return 0;
             }
 
-            m_screenCapture->getScreenShot();
+            m_screenCapture->requestScreenShot(m_continuous);
+
+            if(m_continuous)
+            {
+                std::lock_guard<std::mutex> lock(m_screenCapture->m_continuousMutex);
+
+                if(m_screenCapture->continuousCapture.active)
+                    m_screenCapture->screenShotDispatcher->Schedule( Core::Time::Now().Add(m_screenCapture->continuousCapture.interval), ScreenShotJob( m_screenCapture, true) );
+            }
 
             return 0;
         }
 
-        bool ScreenCapture::getScreenShot()
+        bool ScreenCapture::getScreenShot(bool continuous)
         {
-            std::vector<unsigned char> png_data;
             bool got_screenshot = false;
+            FrameConsumer upload = [this, continuous](const ImageFrame& frame) { onFrame(&frame, continuous); };
 
             #ifdef PLATFORM_BROADCOM
-            got_screenshot = getScreenshotNexus(png_data);
+            got_screenshot = got_screenshot || getScreenshotNexus(upload);
             #endif
 
             #ifdef PLATFORM_INTEL
-            got_screenshot = getScreenshotIntel(png_data);
+            got_screenshot = got_screenshot || getScreenshotIntel(upload);
             #endif
 
             #ifdef HAS_FRAMEBUFFER_API_HEADER
-            got_screenshot = getScreenshotRealtek(png_data);
+            got_screenshot = got_screenshot || getScreenshotRealtek(upload);
             #endif
 
-            return doUploadScreenCapture(png_data, got_screenshot);
+            if(!got_screenshot)
+                onFrame(NULL, continuous);
+
+            return got_screenshot;
+        }
+
+        void ScreenCapture::onFrame(const ImageFrame *frame, bool continuous)
+        {
+            if(continuous)
+                onContinuousFrame(frame);
+            else
+                doUploadScreenCapture(frame, uploadTarget);
+        }
+
+        bool ScreenCapture::onContinuousFrame(const ImageFrame *frame)
+        {
+            if(!frame)
+            {
+                // a missed frame is not a change, the next interval tries again
+                LOGERR("Error: could not get the screenshot");
+                return false;
+            }
+
+            FrameSignature signature;
+            signature.compute(*frame);
+
+            UploadTarget target;
+            int score = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_continuousMutex);
+
+                if(!continuousCapture.active)
+                    return false;
+
+                score = signature.difference(continuousCapture.signature);
+                if(continuousCapture.signature.valid() && score <= continuousCapture.threshold)
+                    return false;
+
+                // compared against the last upload, so slow changes add up too
+                continuousCapture.signature = signature;
+                target = continuousCapture.target;
+            }
+
+            JsonObject params;
+            params["score"] = score;
+            params["luminance"] = signature.luminance();
+            params["call_guid"] = target.callGUID;
+
+            sendNotify(EVT_SCREEN_CHANGED, params);
+
+            return doUploadScreenCapture(frame, target);
         }
 
-        bool ScreenCapture::doUploadScreenCapture(const std::vector<unsigned char> &png_data, bool got_screenshot)
+        bool ScreenCapture::doUploadScreenCapture(const ImageFrame *frame, const UploadTarget &target)
         {
-            if(got_screenshot)
+            const std::string &callGUID = target.callGUID;
+
+            if(frame)
             {
                 std::string error_str;
+                ImageStream stream(*frame, target.options);
 
-                LOGWARN("uploading %d of png data to '%s'", png_data.size(), url.c_str() );
+                LOGWARN("uploading %dx%d %s to '%s'", frame->width / target.options.scale, frame->height / target.options.scale, stream.contentType(), target.url.c_str() );
 
-                if(uploadDataToUrl(png_data, url.c_str(), error_str))
+                if(uploadDataToUrl(stream, target.url.c_str(), error_str))
                 {
                     JsonObject params;
                     params["status"] = true;
@@ -285,24 +476,23 @@ namespace WPEFramework
         }
 
 #ifdef PLATFORM_INTEL
-        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotIntel(const FrameConsumer& consumer)
         {
-            int i;
             char *filename = "/proc/gdl/dump/wbp";    //both video and guide graphics, potentially at lower 720x480
 //             char *filename = "/proc/gdl/dump/upp_d"; //graphics only, normally at higher 1280x720
 //             char *filename = "/proc/gdl/dump/upp_a"; //video only, normally at higher 1280x720
 
             FILE* fp = fopen(filename, "rb");
 
-            unsigned char info[56];
-            fread(info, sizeof(unsigned char), 56, fp); // read the 54-byte header
-
             if(!fp)
             {
                 LOGERR("Error: could not open image file '%s'", filename);
                 return false;
             }
 
+            unsigned char info[56];
+            fread(info, sizeof(unsigned char), 56, fp); // read the 54-byte header
+
             // extract image height and width from header
             int w = abs(*(int*)&info[18]);
             int h = abs(*(int*)&info[22]);
@@ -314,29 +504,20 @@ namespace WPEFramework
             if(size < 1)
             {
                 LOGERR("Error: png data size < 1");
+                fclose(fp);
                 return false;
             }
 
             std::vector<unsigned char> data_v(size);
-            std::vector<unsigned char> new_data_v(size);
 
             unsigned char* data = &data_v[0];
-            unsigned char* new_data = &new_data_v[0];
 
             fread(data, sizeof(unsigned char), size, fp); // read the rest of the data at once
             fclose(fp);
 
-            for(i = 0; i < size; i += 4)
-            {
-                //r and b need swapped?
-                new_data[i+0] = data[i+2];
-                new_data[i+1] = data[i+1];
-                new_data[i+2] = data[i+0];
-                new_data[i+3] = data[i+3];
-            }
-
-            //convert to png
-            saveToPng(new_data, w, h, png_out_data);
+            //r and b are swapped, the encoder takes care of it
+            ImageFrame frame = { data, w, h, 4 * w, true };
+            consumer(frame);
 
             return true;
         }
@@ -368,7 +549,7 @@ namespace WPEFramework
             return true;
         }
 
-        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotNexus(const FrameConsumer& consumer)
         {
             if(!joinNexus())
             {
@@ -400,9 +581,6 @@ namespace WPEFramework
             //defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_R8_G8_B8;
             defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_B8_G8_R8;
             int bytesPerPixel = 4;
-            std::vector<unsigned char> data_v(1280 * 720 * 4);
-            unsigned char *bytes = &data_v[0];
-//             unsigned char bytes[1280 * 720 * 4];
 
 
             NEXUS_SurfaceHandle surface = NEXUS_Surface_Create( &defSurfSettings );
@@ -434,7 +612,12 @@ namespace WPEFramework
                         pSurfaceMemory, properties.pixelMemoryOffset, defSurfSettings.width, defSurfSettings.height, bytesPerPixel);
             }
 
-            memcpy(bytes, (const char*) pSurfaceMemory + properties.pixelMemoryOffset, defSurfSettings.width * defSurfSettings.height * bytesPerPixel);
+            {
+                // The surface is ours, it stays locked while being encoded rather than copied
+                ImageFrame frame = { (const unsigned char*) pSurfaceMemory + properties.pixelMemoryOffset,
+                                     defSurfSettings.width, defSurfSettings.height, defSurfSettings.width * bytesPerPixel, false };
+                consumer(frame);
+            }
 
             NEXUS_Surface_Unlock( surface );
 
@@ -449,13 +632,7 @@ namespace WPEFramework
                 return false;
             }
 
-            if(!saveToPng(bytes, defSurfSettings.width, defSurfSettings.height, png_out_data))
-            {
-                LOGERR("could not convert Nexus screenshot to png");
-                return false;
-            }
-            else
-                return true;
+            return true;
         }
 #endif
 
@@ -477,7 +654,7 @@ namespace WPEFramework
             LOGWARN("VNCServerLogMessage called");
         }
 
-        bool ScreenCapture::getScreenshotRealtek(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotRealtek(const FrameConsumer& consumer)
         {
             ErrCode err;
             vnc_bool_t result;
@@ -537,24 +714,9 @@ namespace WPEFramework
             if(buffer) {
                 LOGINFO("fbGetFramebuffer=ok"); 
 
-                for(unsigned int n = 0; n < h; n++)
-                {
-                    for(unsigned int i = 0; i < w; i++)
-                    {
-                        unsigned char *color = buffer + n * s + i * 4;
-
-                        unsigned char blue = color[0];
-                        color[0] =  color[2];
-                        color[2] = blue;
-                    }
-                }
-
-                if(!saveToPng(buffer, w, h, png_out_data))
-                {
-                    LOGERR("could not convert Nexus screenshot to png");
-                    fbDestroy(context);
-                    return false;
-                }
+                // BGRA, encoded straight from the framebuffer instead of swapping it in place
+                ImageFrame frame = { buffer, w, h, s, true };
+                consumer(frame);
                 LOGINFO("[Done]");
 
             } else {
@@ -571,13 +733,15 @@ namespace WPEFramework
         }
 #endif
 
-        static void PngWriteCallback(png_structp  png_ptr, png_bytep data, png_size_t length)
+        static size_t ImageStreamReadCallback(char *buffer, size_t size, size_t nitems, void *userdata)
         {
-            std::vector<unsigned char> *p = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
-            p->insert(p->end(), data, data + length);
+            ImageStream *stream = static_cast<ImageStream*>(userdata);
+            size_t length = stream->read((unsigned char*)buffer, size * nitems);
+
+            return stream->failed() ? CURL_READFUNC_ABORT : length;
         }
 
-        bool ScreenCapture::uploadDataToUrl(const std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        bool ScreenCapture::uploadDataToUrl(ImageStream &stream, const char *url, std::string &error_str)
         {
             CURL *curl;
             CURLcode res;
@@ -589,7 +753,14 @@ namespace WPEFramework
                 return false;
             }
 
-            LOGWARN("uploading png data of size %u to '%s'", data.size(), url);
+            if(!stream.start())
+            {
+                LOGERR("could not start encoding the screenshot");
+                error_str = "Failed to encode screen data";
+                return false;
+            }
+
+            LOGWARN("uploading %s data to '%s'", stream.contentType(), url);
 
             //init curl
             curl_global_init(CURL_GLOBAL_ALL);
@@ -601,21 +772,29 @@ namespace WPEFramework
                 return false;
             }
 
-            //create header
+            //create header, the size is not known up front
             struct curl_slist *chunk = NULL;
-            chunk = curl_slist_append(chunk, "Content-Type: image/png");
+            chunk = curl_slist_append(chunk, (std::string("Content-Type: ") + stream.contentType()).c_str());
+            chunk = curl_slist_append(chunk, "Transfer-Encoding: chunked");
 
-            //set url and data
+            //set url and data, encoded while curl reads it
             curl_easy_setopt(curl, CURLOPT_URL, url);
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, ImageStreamReadCallback);
+            curl_easy_setopt(curl, CURLOPT_READDATA, &stream);
 
             //perform blocking upload call
             res = curl_easy_perform(curl);
 
             //output success / failure log
-            if(CURLE_OK == res)
+            if(stream.failed())
+            {
+                LOGERR("encoding failed during upload");
+                error_str = "Failed to encode screen data";
+                call_succeeded = false;
+            }
+            else if(CURLE_OK == res)
             {
                 long response_code;
 
@@ -628,7 +807,7 @@ namespace WPEFramework
                     call_succeeded = false;
                 }
                 else
-                    LOGWARN("upload done");
+                    LOGWARN("upload of %u bytes done", (unsigned)stream.produced());
             }
             else
             {
@@ -644,91 +823,5 @@ namespace WPEFramework
             return call_succeeded;
         }
 
-        bool ScreenCapture::saveToPng(unsigned char *data, int width, int height, std::vector<unsigned char> &png_out_data)
-        {
-            int bitdepth = 8;
-            int colortype = PNG_COLOR_TYPE_RGBA;
-            int pitch = 4 * width;
-            int transform = PNG_TRANSFORM_IDENTITY;
-
-            int i = 0;
-            int r = 0;
-            png_structp png_ptr = NULL;
-            png_infop info_ptr = NULL;
-            png_bytep* row_pointers = NULL;
-
-            if (NULL == data)
-            {
-                LOGERR("Error: failed to save the png because the given data is NULL.");
-                r = -1;
-                goto error;
-            }
-
-            if (0 == pitch)
-            {
-                LOGERR("Error: failed to save the png because the given pitch is 0.");
-                r = -3;
-                goto error;
-            }
-
-            png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-            if (NULL == png_ptr)
-            {
-                LOGERR("Error: failed to create the png write struct.");
-                r = -5;
-                goto error;
-            }
-
-            info_ptr = png_create_info_struct(png_ptr);
-            if (NULL == info_ptr)
-            {
-                LOGERR("Error: failed to create the png info struct.");
-                r = -6;
-                goto error;
-            }
-
-            png_set_IHDR(png_ptr,
-                            info_ptr,
-                            width,
-                            height,
-                            bitdepth,                 /* e.g. 8 */
-                            colortype,                /* PNG_COLOR_TYPE_{GRAY, PALETTE, RGB, RGB_ALPHA, GRAY_ALPHA, RGBA, GA} */
-                            PNG_INTERLACE_NONE,       /* PNG_INTERLACE_{NONE, ADAM7 } */
-                            PNG_COMPRESSION_TYPE_BASE,
-                            PNG_FILTER_TYPE_BASE);
-
-            row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
-
-            for (i = 0; i < height; ++i)
-                row_pointers[i] = data + i * pitch;
-
-            png_set_write_fn(png_ptr, &png_out_data, PngWriteCallback, NULL);
-            png_set_rows(png_ptr, info_ptr, row_pointers);
-            png_write_png(png_ptr, info_ptr, transform, NULL);
-
-            error:
-
-            if (NULL != png_ptr)
-            {
-
-                if (NULL == info_ptr)
-                {
-                    LOGERR("Error: info ptr is null. not supposed to happen here.\n");
-                }
-
-                png_destroy_write_struct(&png_ptr, &info_ptr);
-                png_ptr = NULL;
-                info_ptr = NULL;
-            }
-
-            if (NULL != row_pointers)
-            {
-                free(row_pointers);
-                row_pointers = NULL;
-            }
-
-            return (r==0);
-        }
-
     } // namespace Plugin
 } // namespace WPEFramework
@@ -19,10 +19,13 @@
 
 #pragma once
 
+#include <functional>
 #include <mutex>
 #include <vector>
 
 #include "Module.h"
+#include "FrameSignature.h"
+#include "ImageStream.h"
 #include "tptimer.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
@@ -40,13 +43,13 @@ namespace WPEFramework {
             ScreenShotJob& operator=(const ScreenShotJob& RHS) = delete;
 
         public:
-            ScreenShotJob(WPEFramework::Plugin::ScreenCapture* tpt) : m_screenCapture(tpt) { }
-            ScreenShotJob(const ScreenShotJob& copy) : m_screenCapture(copy.m_screenCapture) { }
+            ScreenShotJob(WPEFramework::Plugin::ScreenCapture* tpt, bool continuous = false) : m_screenCapture(tpt), m_continuous(continuous) { }
+            ScreenShotJob(const ScreenShotJob& copy) : m_screenCapture(copy.m_screenCapture), m_continuous(copy.m_continuous) { }
             ~ScreenShotJob() {}
 
             inline bool operator==(const ScreenShotJob& RHS) const
             {
-                return(m_screenCapture == RHS.m_screenCapture);
+                return(m_screenCapture == RHS.m_screenCapture && m_continuous == RHS.m_continuous);
             }
 
         public:
@@ -54,6 +57,7 @@ namespace WPEFramework {
 
         private:
             WPEFramework::Plugin::ScreenCapture* m_screenCapture;
+            bool m_continuous;
         };
 
         // This is a server for a JSONRPC communication channel.
@@ -80,25 +84,42 @@ namespace WPEFramework {
 #endif
             //Begin methods
             uint32_t uploadScreenCapture(const JsonObject& parameters, JsonObject& response);
+            uint32_t startContinuousCapture(const JsonObject& parameters, JsonObject& response);
+            uint32_t stopContinuousCapture(const JsonObject& parameters, JsonObject& response);
             //End methods
 
+            // Where and how a capture is uploaded
+            struct UploadTarget
+            {
+                std::string url;
+                std::string callGUID;
+                ImageOptions options;
+            };
+
+            // Platform captures hand the frame to the consumer while it is still valid,
+            // they return false if there was no frame.
+            typedef std::function<void(const ImageFrame&)> FrameConsumer;
+
             #ifdef PLATFORM_BROADCOM
-            bool getScreenshotNexus(std::vector<unsigned char> &png_data);
+            bool getScreenshotNexus(const FrameConsumer& consumer);
             bool joinNexus();
             #endif
 
             #ifdef PLATFORM_INTEL
-            bool getScreenshotIntel(std::vector<unsigned char> &png_data);
+            bool getScreenshotIntel(const FrameConsumer& consumer);
             #endif
 
             #ifdef HAS_FRAMEBUFFER_API_HEADER
-            bool getScreenshotRealtek(std::vector<unsigned char> &png_data);
+            bool getScreenshotRealtek(const FrameConsumer& consumer);
             #endif
 
-            bool saveToPng(unsigned char *bytes, int w, int h, std::vector<unsigned char> &png_out_data);
-            bool uploadDataToUrl(const std::vector<unsigned char> &data, const char *url, std::string &error_str);
-            bool getScreenShot();
-            bool doUploadScreenCapture(const std::vector<unsigned char> &png_data, bool got_screenshot);
+            bool getUploadTarget(const JsonObject& parameters, UploadTarget& target, JsonObject& response);
+            bool requestScreenShot(bool continuous);
+            bool uploadDataToUrl(ImageStream &stream, const char *url, std::string &error_str);
+            bool getScreenShot(bool continuous);
+            void onFrame(const ImageFrame *frame, bool continuous);
+            bool onContinuousFrame(const ImageFrame *frame);
+            bool doUploadScreenCapture(const ImageFrame *frame, const UploadTarget &target);
 
         public:
             ScreenCapture();
@@ -111,8 +132,20 @@ namespace WPEFramework {
 
             WPEFramework::Core::TimerType<ScreenShotJob> *screenShotDispatcher;
 
-            std::string url;
-            std::string callGUID;
+            UploadTarget uploadTarget;
+
+            // Continuous mode: a capture every interval, uploaded when it differs from the last upload
+            struct ContinuousCapture
+            {
+                bool active = false;
+                int interval = 0;
+                int threshold = 0;
+                UploadTarget target;
+                FrameSignature signature;
+            };
+
+            std::mutex m_continuousMutex;
+            ContinuousCapture continuousCapture;
 
             #ifdef PLATFORM_BROADCOM
             bool inNexus;
@@ -121,6 +154,7 @@ namespace WPEFramework {
 #if defined(PLATFORM_AMLOGIC)
             size_t screenWidth;
             size_t screenHeight;
+            bool continuousPending;
 #endif   
 
             friend class ScreenShotJob;
@@ -21,7 +21,10 @@
 
 #include "Module.h"
 
+#include <list>
+#include <map>
 #include <regex>
+#include <unordered_map>
 
 // helper functions
 //namespace {
@@ -83,6 +86,110 @@
 namespace WPEFramework {
 namespace Plugin {
 
+    // Callsign and method patterns of the ACL, compiled once when it is loaded. They
+    // match as they always did, with regex_search() on CreateRegex() of the pattern:
+    // a pattern without wildcards matches every name that contains it ("register"
+    // also matches "unregister"), the others as their regex. Patterns that are
+    // plain text are searched for with find() instead of a regex, and a name that
+    // equals one of them is looked up in a hash map first.
+    // Patterns are tried in the order of their regex, the first match wins.
+    template <typename ELEMENT>
+    class PatternMap {
+    private:
+        struct Entry {
+            Entry(const string& pattern, const ELEMENT& element)
+                : Literal(pattern.find_first_of(_T("\\^$|?+()[]{}*")) == string::npos)
+                , Text(pattern)
+                , Regex()
+                , Element(element)
+            {
+                if (Literal == false) {
+                    Regex.assign(CreateRegex(pattern), std::regex::ECMAScript | std::regex::optimize);
+                }
+            }
+
+            bool Match(const string& subject) const
+            {
+                return (Literal == true ? (subject.find(Text) != string::npos) : std::regex_search(subject, Regex));
+            }
+
+            bool Literal;
+            string Text;
+            std::regex Regex;
+            ELEMENT Element;
+        };
+
+    public:
+        PatternMap(const PatternMap&) = delete;
+        PatternMap& operator=(const PatternMap&) = delete;
+
+        PatternMap()
+            : _entries()
+            , _exact()
+            , _expressions(0)
+        {
+        }
+        ~PatternMap()
+        {
+        }
+
+    public:
+        // Of patterns with the same regex the first is kept. Returns false for a
+        // pattern that is not a valid regex, it is left out.
+        bool Add(const string& pattern, const ELEMENT& element)
+        {
+            bool result = true;
+
+            try {
+                auto entry = _entries.emplace(std::piecewise_construct,
+                    std::forward_as_tuple(CreateRegex(pattern)),
+                    std::forward_as_tuple(pattern, element));
+
+                if ((entry.second == true) && (entry.first->second.Literal == true)) {
+                    _exact.emplace(pattern, &(entry.first->second));
+                } else if (entry.second == true) {
+                    _expressions++;
+                }
+            } catch (const std::regex_error&) {
+                result = false;
+            }
+
+            return (result);
+        }
+        bool Find(const string& subject, ELEMENT& element) const
+        {
+            bool found = false;
+
+            typename std::map<string, Entry>::const_iterator index(_entries.begin());
+
+            while ((index != _entries.end()) && (found == false)) {
+                if (index->second.Match(subject) == true) {
+                    element = index->second.Element;
+                    found = true;
+                } else {
+                    index++;
+                }
+            }
+
+            return (found);
+        }
+        // Any pattern matches, the order does not matter.
+        bool Contains(const string& subject) const
+        {
+            ELEMENT element = ELEMENT();
+            return ((_exact.find(subject) != _exact.end()) || (Find(subject, element) == true));
+        }
+        bool HasExpressions() const
+        {
+            return (_expressions != 0);
+        }
+
+    private:
+        std::map<string, Entry> _entries;
+        std::unordered_map<string, const Entry*> _exact;
+        uint32_t _expressions;
+    };
+
     //Allow -> Check first
     //if Block then check for Block[] and block if present
     //else must be explicitly allowed
@@ -278,8 +385,9 @@ namespace Plugin {
                     , _methods() {
                     Core::JSON::ArrayType<Core::JSON::String>::ConstIterator index(rules.Methods.Elements());
                     while (index.Next() == true) {
-                        string str = index.Current().Value();
-                        _methods.emplace_back(CreateRegex(str));
+                        if (_methods.Add(index.Current().Value(), true) == false) {
+                            SYSLOG(Logging::ParsingError, (_T("Invalid method pattern [%s]"), index.Current().Value().c_str()));
+                        }
                     }
                 }
                 ~Plugin() {
@@ -288,24 +396,16 @@ namespace Plugin {
             public:
                 bool Allowed(const string& method) const
                 {
-                    bool found = false;
-
-                    std::list<string>::const_iterator index(_methods.begin());
-
-                    while ((index != _methods.end()) && (found == false)) { 
-                        std::regex expression(index->c_str());
-                        std::smatch matchList;
-                        found = std::regex_search(method, matchList, expression);
-                        if (found == false) {
-                            index++;
-                        }
-                    }
-                    return !(_defaultBlocked ^ found);
+                    return !(_defaultBlocked ^ _methods.Contains(method));
+                }
+                inline bool HasExpressions() const
+                {
+                    return (_methods.HasExpressions());
                 }
 
             private:
                 bool _defaultBlocked;
-                std::list<string> _methods;
+                PatternMap<bool> _methods;
             };
 
         public:
@@ -315,15 +415,22 @@ namespace Plugin {
 
             Filter(const JSONACL::Plugins& plugins)
                 : _defaultBlocked(plugins.Default.Value() == mode::BLOCKED)
+                , _rules()
                 , _plugins()
+                , _cached(false)
+                , _adminLock()
+                , _decisions()
             {
                 JSONACL::Plugins::Iterator index(plugins.Elements());
           
                 while (index.Next() == true) {
-                    _plugins.emplace(std::piecewise_construct,
-                            std::forward_as_tuple(CreateRegex(index.Key())),
-                            std::forward_as_tuple(index.Current()));
+                    _rules.emplace_back(index.Current());
+                    if (_plugins.Add(index.Key(), &(_rules.back())) == false) {
+                        SYSLOG(Logging::ParsingError, (_T("Invalid callsign pattern [%s]"), index.Key().c_str()));
+                    }
+                    _cached = _cached || _rules.back().HasExpressions();
                 }
+                _cached = _cached || _plugins.HasExpressions();
             }
             ~Filter()
             {
@@ -332,27 +439,58 @@ namespace Plugin {
         public:
             bool Allowed(const string callsign, const string& method) const
             {
-                bool pluginFound = false;
-
-                std::map<string, Plugin>::const_iterator index(_plugins.begin());
-                while ((index != _plugins.end()) && (pluginFound == false)) {
-                    std::regex expression(index->first.c_str());
-                    std::smatch matchList;
-                    pluginFound = std::regex_search(callsign, matchList, expression);
-                    if (pluginFound == false) {
-                        index++;
+                bool result = false;
+
+                if (_cached == false) {
+                    result = Decide(callsign, method);
+                } else {
+                    // Roles using regex patterns remember their decisions, a callsign
+                    // cannot contain a '#' so the key is unambiguous.
+                    const string key(callsign + '#' + method);
+
+                    _adminLock.Lock();
+                    auto index = _decisions.find(key);
+                    bool found = (index != _decisions.end());
+                    if (found == true) {
+                        result = index->second;
+                    }
+                    _adminLock.Unlock();
+
+                    if (found == false) {
+                        result = Decide(callsign, method);
+
+                        _adminLock.Lock();
+                        if (_decisions.size() >= DecisionCacheSize) {
+                            _decisions.clear();
+                        }
+                        _decisions.emplace(key, result);
+                        _adminLock.Unlock();
                     }
                 }
 
-                return (pluginFound == false ? !_defaultBlocked : index->second.Allowed(method));
+                return (result);
+            }
+
+        private:
+            bool Decide(const string& callsign, const string& method) const
+            {
+                const Plugin* plugin = nullptr;
+
+                return (_plugins.Find(callsign, plugin) == false ? !_defaultBlocked : plugin->Allowed(method));
             }
 
         private:
+            static constexpr uint32_t DecisionCacheSize = 256;
+
             bool _defaultBlocked;
-            std::map<string, Plugin> _plugins;
+            std::list<Plugin> _rules;
+            PatternMap<const Plugin*> _plugins;
+            bool _cached;
+            mutable Core::CriticalSection _adminLock;
+            mutable std::unordered_map<string, bool> _decisions;
         };
 
-        using URLList = std::list<std::pair<string, Filter&>>;
+        using URLList = std::list<std::pair<std::regex, Filter&>>;
         using Iterator = Core::IteratorType<const std::list<string>, const string&, std::list<string>::const_iterator>;
 
     public:
@@ -395,12 +533,7 @@ namespace Plugin {
             URLList::const_iterator index = _urlMap.begin();
 
             while ((index != _urlMap.end()) && (result == nullptr)) {
-                // regex_search() for searching the regex pattern
-                // 'r' in the string 's'. 'm' is flag for determining
-                // matching behavior.
-                std::regex expression(index->first.c_str());
-
-                if (std::regex_search(origin, matchList, expression) == true) {
+                if (std::regex_search(origin, matchList, index->first) == true) {
                     result = &(index->second);
                 }
                 else {
@@ -450,11 +583,16 @@ namespace Plugin {
                 } else {
                     Filter& entry(selectedFilter->second);
                     
-                    // create regex for url
+                    // compile the regex for the url once, it is matched for every new security context
                     string url_regex = CreateUrlRegex(index.Current().URL.Value());
-                    
-                    _urlMap.emplace_back(std::pair<string, Filter&>(
-                        url_regex, entry));
+
+                    try {
+                        _urlMap.emplace_back(std::piecewise_construct,
+                            std::forward_as_tuple(url_regex, std::regex::ECMAScript | std::regex::optimize),
+                            std::forward_as_tuple(entry));
+                    } catch (const std::regex_error&) {
+                        SYSLOG(Logging::ParsingError, (_T("Invalid url [%s] for role [%s]"), index.Current().URL.Value().c_str(), role.c_str()));
+                    }
 
                     std::list<string>::iterator found = std::find(_unusedRoles.begin(), _unusedRoles.end(), role);
 
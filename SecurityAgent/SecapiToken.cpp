@@ -57,12 +57,25 @@ void JWTSecApi::SecApi::DeleteKey(SEC_OBJECTID id) {
   CHECK_RESULT(SecKey_Delete(secProcHandle, id));
 }
 
-void JWTSecApi::SecApi::Mac(SEC_OBJECTID id,
+Sec_KeyHandle* JWTSecApi::SecApi::OpenKey(SEC_OBJECTID id) {
+  Sec_KeyHandle* key = nullptr;
+  CHECK_RESULT(SecKey_GetInstance(secProcHandle, id, &key));
+  return key;
+}
+
+void JWTSecApi::SecApi::CloseKey(Sec_KeyHandle* key) {
+  if (key != nullptr) {
+    CHECK_RESULT(SecKey_Release(key));
+  }
+}
+
+// With the key handle open, a MAC doesn't look the key up and load it again
+void JWTSecApi::SecApi::Mac(Sec_KeyHandle* key,
     const uint16_t sourceSize, const uint8_t *source,
     uint16_t &macSize, uint8_t *mac) {
 
-  SEC_SIZE mac_len;
-  CHECK_RESULT(SecMac_SingleInputId(secProcHandle, SEC_MACALGORITHM_HMAC_SHA256, id,
+  SEC_SIZE mac_len = 0;
+  CHECK_RESULT(SecMac_SingleInput(secProcHandle, SEC_MACALGORITHM_HMAC_SHA256, key,
       const_cast<SEC_BYTE *>(reinterpret_cast<const SEC_BYTE *>(source)),
       static_cast<SEC_SIZE>(sourceSize),
       reinterpret_cast<SEC_BYTE *>(mac),
@@ -73,18 +86,24 @@ void JWTSecApi::SecApi::Mac(SEC_OBJECTID id,
 JWTSecApi::MacGenerator::MacGenerator()
   : secApi(make_shared<SecApi>(StorageDir)) {
   hmacKey = secApi->GenerateKey(SEC_KEYTYPE_HMAC_256, SEC_STORAGELOC_RAM);
+  hmacKeyHandle = secApi->OpenKey(hmacKey);
 }
 
 
 JWTSecApi::MacGenerator::~MacGenerator() {
+  secApi->CloseKey(hmacKeyHandle);
   secApi->DeleteKey(hmacKey);
 }
 
 void JWTSecApi::MacGenerator::Mac(const uint16_t sourceSize, const uint8_t *source, uint16_t &macSize, uint8_t *mac) {
-  secApi->Mac(hmacKey, sourceSize, source, macSize, mac);
+  std::lock_guard<std::mutex> guard(lock);
+  secApi->Mac(hmacKeyHandle, sourceSize, source, macSize, mac);
 }
 
-JWTSecApi::MacGenerator JWTSecApi::generator;
+JWTSecApi::MacGenerator& JWTSecApi::MacGenerator::Instance() {
+  static MacGenerator generator;
+  return generator;
+}
 
 JWTSecApi::JWTSecApi()
   : jwt(Web::JSONWebToken::mode(-1), 0, nullptr) {
@@ -95,7 +114,7 @@ uint16_t JWTSecApi::Encode(string &token, const uint16_t length, const uint8_t *
 
   uint16_t macSize;
   uint8_t mac[SEC_MAC_MAX_LEN];
-  generator.Mac(static_cast<uint16_t>(token.length()),
+  MacGenerator::Instance().Mac(static_cast<uint16_t>(token.length()),
       reinterpret_cast<const uint8_t*>(token.c_str()),
       macSize, mac);
   TCHAR signature[((SEC_MAC_MAX_LEN * 8) / 6) + 4];
@@ -138,11 +157,11 @@ bool JWTSecApi::ValidSignature(const string& token) {
 
     uint16_t macSize;
     uint8_t mac[SEC_MAC_MAX_LEN];
-    generator.Mac(static_cast<uint16_t>(pos),
+    MacGenerator::Instance().Mac(static_cast<uint16_t>(pos),
         reinterpret_cast<const uint8_t*>(token.substr(0, pos).c_str()),
         macSize, mac);
 
-    result = (::memcmp(signature, mac, macSize) == 0);
+    result = (macSize > 0) && (::memcmp(signature, mac, macSize) == 0);
   }
 
   return (result);
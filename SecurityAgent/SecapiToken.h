@@ -25,6 +25,7 @@
 #include "sec_security_datatype.h"
 
 #include <memory>
+#include <mutex>
 
 class JWTSecApi {
 private:
@@ -35,7 +36,9 @@ private:
 
     SEC_OBJECTID GenerateKey(Sec_KeyType keyType, Sec_StorageLoc location);
     void DeleteKey(SEC_OBJECTID id);
-    void Mac(SEC_OBJECTID id,
+    Sec_KeyHandle* OpenKey(SEC_OBJECTID id);
+    void CloseKey(Sec_KeyHandle* key);
+    void Mac(Sec_KeyHandle* key,
         const uint16_t sourceSize, const uint8_t source[],
         uint16_t &macSize, uint8_t mac[]);
 
@@ -43,6 +46,8 @@ private:
     Sec_ProcessorHandle* secProcHandle;
   };
 
+  // One key and one open handle of it for the process, created with the first token.
+  // SecAPI calls on the processor are serialized.
   class MacGenerator {
   public:
     MacGenerator();
@@ -50,10 +55,14 @@ private:
     void Mac(const uint16_t sourceSize, const uint8_t source[],
         uint16_t &macSize, uint8_t mac[]);
 
+    static MacGenerator& Instance();
+
   private:
     static const char* StorageDir;
+    std::mutex lock;
     std::shared_ptr<SecApi> secApi;
     SEC_OBJECTID hmacKey;
+    Sec_KeyHandle* hmacKeyHandle;
   };
 
 private:
@@ -71,6 +80,5 @@ private:
   bool ValidSignature(const string& token);
 
 private:
-  static MacGenerator generator;
   WPEFramework::Web::JSONWebToken jwt;
 };
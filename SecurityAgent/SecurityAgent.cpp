@@ -60,6 +60,8 @@ namespace Plugin {
 
     SecurityAgent::SecurityAgent()
         : _acl()
+        , _tokenCache()
+        , _tokenStatistics()
         , _dispatcher(nullptr)
         , _engine()
     {
@@ -105,6 +107,8 @@ namespace Plugin {
             }
         }
 
+        _tokenCache.Configure(config.TokenCacheSize.Value(), config.TokenCacheTTL.Value());
+
         ASSERT(_dispatcher == nullptr);
         ASSERT(subSystem != nullptr);
 
@@ -157,13 +161,15 @@ namespace Plugin {
         _dispatcher.reset();
         _engine.Release();
 
+        // Cached contexts point into the ACL.
+        _tokenCache.Clear();
         _acl.Clear();
     }
 
     /* virtual */ string SecurityAgent::Information() const
     {
-        // No additional info to report.
-        return (string());
+        // Token issuance latency, per token.
+        return (_tokenStatistics.ToString());
     }
 
     /* virtual */ uint32_t SecurityAgent::CreateToken(const uint16_t length, const uint8_t buffer[], string& token)
@@ -172,29 +178,72 @@ namespace Plugin {
         strBuffer.assign(reinterpret_cast<const char*>(buffer),length);
         SYSLOG(Logging::Notification, (_T("Creating Token for %s"), strBuffer.c_str()));
 
+        uint64_t start = Core::Time::Now().Ticks();
+
         // Generate the token from the buffer coming in...
         auto newToken = JWTFactory::Instance().Element();
 
-        return (newToken->Encode(token, length, buffer) > 0 ? Core::ERROR_NONE : Core::ERROR_UNAVAILABLE);
+        bool created = (newToken->Encode(token, length, buffer) > 0);
+
+        _tokenStatistics.Record(1, (created ? 0 : 1), Core::Time::Now().Ticks() - start);
+
+        return (created ? Core::ERROR_NONE : Core::ERROR_UNAVAILABLE);
     }
 
-    /* virtual */ PluginHost::ISecurity* SecurityAgent::Officer(const string& token)
+    uint32_t SecurityAgent::CreateTokens(const std::vector<string>& payloads, std::vector<string>& tokens)
     {
-        PluginHost::ISecurity* result = nullptr;
+        uint32_t result = Core::ERROR_NONE;
+        uint32_t failures = 0;
+
+        SYSLOG(Logging::Notification, (_T("Creating %u Tokens"), static_cast<uint32_t>(payloads.size())));
 
-        auto webToken = JWTFactory::Instance().Element();
-        uint16_t load = webToken->PayloadLength(token);
+        uint64_t start = Core::Time::Now().Ticks();
 
-        // Validate the token
-        if (load != static_cast<uint16_t>(~0)) {
-            // It is potentially a valid token, extract the payload.
-            uint8_t* payload = reinterpret_cast<uint8_t*>(ALLOCA(load));
+        // One encoder for the whole batch, the MAC key stays loaded in between.
+        auto newToken = JWTFactory::Instance().Element();
+
+        tokens.clear();
+        tokens.reserve(payloads.size());
+
+        for (const string& payload : payloads) {
+            tokens.emplace_back();
 
-            load = webToken->Decode(token, load, payload);
+            if ((payload.length() > static_cast<uint16_t>(~0))
+                || (newToken->Encode(tokens.back(), static_cast<uint16_t>(payload.length()), reinterpret_cast<const uint8_t*>(payload.c_str())) == 0)) {
+                tokens.back().clear();
+                failures++;
+                if (result == Core::ERROR_NONE) {
+                    result = Core::ERROR_UNAVAILABLE;
+                }
+            }
+        }
 
+        _tokenStatistics.Record(static_cast<uint32_t>(payloads.size()), failures, Core::Time::Now().Ticks() - start);
+
+        return (result);
+    }
+
+    /* virtual */ PluginHost::ISecurity* SecurityAgent::Officer(const string& token)
+    {
+        // Tokens seen before skip the signature check.
+        PluginHost::ISecurity* result = _tokenCache.Get(token);
+
+        if (result == nullptr) {
+            auto webToken = JWTFactory::Instance().Element();
+            uint16_t load = webToken->PayloadLength(token);
+
+            // Validate the token
             if (load != static_cast<uint16_t>(~0)) {
-                // Seems like we extracted a valid payload, time to create an security context
-                result = Core::Service<SecurityContext>::Create<SecurityContext>(&_acl, load, payload);
+                // It is potentially a valid token, extract the payload.
+                uint8_t* payload = reinterpret_cast<uint8_t*>(ALLOCA(load));
+
+                load = webToken->Decode(token, load, payload);
+
+                if (load != static_cast<uint16_t>(~0)) {
+                    // Seems like we extracted a valid payload, time to create an security context
+                    result = Core::Service<SecurityContext>::Create<SecurityContext>(&_acl, load, payload);
+                    _tokenCache.Put(token, result);
+                }
             }
         }
         return (result);
@@ -24,6 +24,10 @@
 
 #include <interfaces/json/JsonData_SecurityAgent.h>
 
+#include <list>
+#include <unordered_map>
+#include <vector>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -82,6 +86,191 @@ namespace Plugin {
             PluginHost::IAuthenticate* _parentInterface;
         };
 
+        // Bounded LRU of SHA256(token) -> the security context created for it, so
+        // repeated calls with the same token skip decoding and signature checks.
+        // Contexts are immutable and shared, an entry lives at most "ttl" seconds.
+        class TokenCache {
+        private:
+            struct Entry {
+                string Digest;
+                PluginHost::ISecurity* Context;
+                uint64_t Expiry;
+            };
+
+            using EntryList = std::list<Entry>;
+
+        public:
+            TokenCache(const TokenCache&) = delete;
+            TokenCache& operator=(const TokenCache&) = delete;
+
+            TokenCache()
+                : _adminLock()
+                , _entries()
+                , _index()
+                , _capacity(0)
+                , _ttl(0)
+            {
+            }
+            ~TokenCache()
+            {
+                Clear();
+            }
+
+        public:
+            void Configure(const uint16_t capacity, const uint32_t ttl)
+            {
+                Clear();
+
+                _adminLock.Lock();
+                _capacity = capacity;
+                _ttl = static_cast<uint64_t>(ttl) * Core::Time::MicroSecondsPerSecond;
+                _adminLock.Unlock();
+            }
+            void Clear()
+            {
+                _adminLock.Lock();
+                for (Entry& entry : _entries) {
+                    entry.Context->Release();
+                }
+                _entries.clear();
+                _index.clear();
+                _adminLock.Unlock();
+            }
+            // Returns an AddRef'ed context, or nullptr if the token is not cached.
+            PluginHost::ISecurity* Get(const string& token)
+            {
+                PluginHost::ISecurity* result = nullptr;
+
+                string digest;
+
+                if ((_capacity > 0) && (Digest(token, digest) == true)) {
+                    _adminLock.Lock();
+
+                    auto index = _index.find(digest);
+
+                    if (index != _index.end()) {
+                        if (index->second->Expiry <= Core::Time::Now().Ticks()) {
+                            index->second->Context->Release();
+                            _entries.erase(index->second);
+                            _index.erase(index);
+                        } else {
+                            _entries.splice(_entries.begin(), _entries, index->second);
+                            result = index->second->Context;
+                            result->AddRef();
+                        }
+                    }
+
+                    _adminLock.Unlock();
+                }
+
+                return (result);
+            }
+            void Put(const string& token, PluginHost::ISecurity* context)
+            {
+                string digest;
+
+                if ((_capacity > 0) && (Digest(token, digest) == true)) {
+                    _adminLock.Lock();
+
+                    if (_index.find(digest) == _index.end()) {
+                        if (_entries.size() >= _capacity) {
+                            _entries.back().Context->Release();
+                            _index.erase(_entries.back().Digest);
+                            _entries.pop_back();
+                        }
+
+                        context->AddRef();
+                        _entries.push_front({ digest, context, Core::Time::Now().Ticks() + _ttl });
+                        _index.emplace(digest, _entries.begin());
+                    }
+
+                    _adminLock.Unlock();
+                }
+            }
+
+        private:
+            static bool Digest(const string& token, string& digest)
+            {
+                bool result = false;
+
+                if (token.length() <= static_cast<uint16_t>(~0)) {
+                    Crypto::SHA256 hash;
+                    hash.Input(reinterpret_cast<const uint8_t*>(token.c_str()), static_cast<uint16_t>(token.length()));
+                    digest.assign(reinterpret_cast<const char*>(hash.Result()), Crypto::SHA256::Length);
+                    result = true;
+                }
+
+                return (result);
+            }
+
+        private:
+            Core::CriticalSection _adminLock;
+            EntryList _entries;
+            std::unordered_map<string, EntryList::iterator> _index;
+            uint16_t _capacity;
+            uint64_t _ttl;
+        };
+
+        // Issuance latency of CreateToken(s), reported through Information().
+        class TokenStatistics {
+        public:
+            TokenStatistics(const TokenStatistics&) = delete;
+            TokenStatistics& operator=(const TokenStatistics&) = delete;
+
+            TokenStatistics()
+                : _adminLock()
+                , _tokens(0)
+                , _batches(0)
+                , _failures(0)
+                , _totalUs(0)
+                , _maxUs(0)
+                , _lastUs(0)
+            {
+            }
+            ~TokenStatistics()
+            {
+            }
+
+        public:
+            void Record(const uint32_t tokens, const uint32_t failures, const uint64_t elapsedUs)
+            {
+                _adminLock.Lock();
+                _tokens += tokens;
+                _failures += failures;
+                _batches++;
+                _totalUs += elapsedUs;
+                _lastUs = (tokens > 0 ? elapsedUs / tokens : elapsedUs);
+                if (_lastUs > _maxUs) {
+                    _maxUs = _lastUs;
+                }
+                _adminLock.Unlock();
+            }
+            string ToString() const
+            {
+                _adminLock.Lock();
+
+                string result = _T("{\"tokens\":") + Core::NumberType<uint64_t>(_tokens).Text()
+                    + _T(",\"batches\":") + Core::NumberType<uint64_t>(_batches).Text()
+                    + _T(",\"failures\":") + Core::NumberType<uint64_t>(_failures).Text()
+                    + _T(",\"averageus\":") + Core::NumberType<uint64_t>(_tokens > 0 ? _totalUs / _tokens : 0).Text()
+                    + _T(",\"maxus\":") + Core::NumberType<uint64_t>(_maxUs).Text()
+                    + _T(",\"lastus\":") + Core::NumberType<uint64_t>(_lastUs).Text() + _T("}");
+
+                _adminLock.Unlock();
+
+                return (result);
+            }
+
+        private:
+            mutable Core::CriticalSection _adminLock;
+            uint64_t _tokens;
+            uint64_t _batches;
+            uint64_t _failures;
+            uint64_t _totalUs;
+            uint64_t _maxUs;
+            uint64_t _lastUs;
+        };
+
         class Config : public Core::JSON::Container {
         private:
             Config(const Config&) = delete;
@@ -92,9 +281,13 @@ namespace Plugin {
                 : Core::JSON::Container()
                 , ACL(_T("acl.json"))
                 , Connector()
+                , TokenCacheSize(64)
+                , TokenCacheTTL(3600)
             {
                 Add(_T("acl"), &ACL);
                 Add(_T("connector"), &Connector);
+                Add(_T("tokencachesize"), &TokenCacheSize);
+                Add(_T("tokencachettl"), &TokenCacheTTL);
             }
             ~Config()
             {
@@ -103,6 +296,8 @@ namespace Plugin {
         public:
             Core::JSON::String ACL;
             Core::JSON::String Connector;
+            Core::JSON::DecUInt16 TokenCacheSize;
+            Core::JSON::DecUInt32 TokenCacheTTL;
         };
 
     public:
@@ -132,6 +327,10 @@ namespace Plugin {
         virtual uint32_t CreateToken(const uint16_t length, const uint8_t buffer[], string& token);
         virtual PluginHost::ISecurity* Officer(const string& token);
 
+        // Issues a token per payload with one JWT encoder (and so one MAC key handle), for callers
+        // that need several tokens at once. Returns the first error, tokens of failed payloads are empty.
+        uint32_t CreateTokens(const std::vector<string>& payloads, std::vector<string>& tokens);
+
         //   IWeb methods
         // -------------------------------------------------------------------------------------------------------
         //! Whenever a request is received, it might carry some additional data in the body. This method allows
@@ -161,6 +360,8 @@ namespace Plugin {
 
     private:
         AccessControlList _acl;
+        TokenCache _tokenCache;
+        TokenStatistics _tokenStatistics;
         uint8_t _skipURL;
         std::unique_ptr<TokenDispatcher> _dispatcher; 
         Core::ProxyType<RPC::InvokeServer> _engine;
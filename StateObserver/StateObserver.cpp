@@ -99,7 +99,10 @@ namespace WPEFramework {
 		StateObserver::StateObserver()
 		: AbstractPlugin()
 		, m_apiVersionNumber((uint32_t)-1)
+		, m_systemStatesValid(false)
+		, m_batchRunning(false)
 		{
+			memset(&m_systemStates, 0, sizeof(m_systemStates));
 			StateObserver::_instance = this;
 			Register("getValues", &StateObserver::getValues, this);
 			Register("registerListeners", &StateObserver::registerListeners, this);
@@ -117,6 +120,9 @@ namespace WPEFramework {
 
 		const string StateObserver::Initialize(PluginHost::IShell* /* service */)
 		{
+			m_batchRunning = true;
+			m_batchThread = std::thread(&StateObserver::flushBatches, this);
+
 			InitializeIARM();
 
 			// On success return empty, to indicate there is no error text.
@@ -126,6 +132,16 @@ namespace WPEFramework {
 		void StateObserver::Deinitialize(PluginHost::IShell* /* service */)
 		{
 			DeinitializeIARM();
+
+			{
+				std::lock_guard<std::mutex> lock(m_listenersLock);
+				m_batchRunning = false;
+				m_pendingChanges.clear();
+			}
+			m_batchCondition.notify_all();
+			if (m_batchThread.joinable())
+				m_batchThread.join();
+
 			StateObserver::_instance = nullptr;
 			//Unregister all the APIs
 		}
@@ -176,6 +192,7 @@ namespace WPEFramework {
 		uint32_t StateObserver::getRegisteredPropertyNames(const JsonObject &parameters, JsonObject &response)
 		{
 			JsonArray response_arr;
+			std::lock_guard<std::mutex> lock(m_listenersLock);
 			for(const auto &propertyName: registeredPropertyNames)
 			{
         		response_arr.Add(propertyName);
@@ -304,7 +321,7 @@ namespace WPEFramework {
 		 *
 		 */
 
-		void StateObserver::getVal(std::vector<string> pname,JsonObject& response)
+		void StateObserver::getVal(const std::vector<string>& pname,JsonObject& response)
 		{
 			static bool checkForStandalone = true;
 			static bool stbStandAloneMode = false;
@@ -324,9 +341,9 @@ namespace WPEFramework {
 				checkForStandalone = false;
 			}
 			IARM_Bus_SYSMgr_GetSystemStates_Param_t param;
-			IARM_Bus_Call(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_API_GetSystemStates, &param, sizeof(param));
+			getSystemStates(param);
 			JsonArray response_arr;
-			for( std::vector<string>::iterator it = pname.begin(); it!= pname.end(); ++it )
+			for( std::vector<string>::const_iterator it = pname.begin(); it!= pname.end(); ++it )
 			{
 				string err_str="none";
 				JsonObject devProp;
@@ -616,6 +633,37 @@ namespace WPEFramework {
 			#endif
 		}
 
+		/**
+		 * @brief This function copies the property table. The table is read from the system manager
+		 * on first use only, after that the system state events keep it current.
+		 *
+		 * param[out] states The state, error and payload of all properties.
+		 *
+		 */
+		void StateObserver::getSystemStates(IARM_Bus_SYSMgr_GetSystemStates_Param_t& states)
+		{
+			std::lock_guard<std::mutex> lock(m_statesLock);
+			if (!m_systemStatesValid)
+			{
+				IARM_Bus_SYSMgr_GetSystemStates_Param_t param;
+				memset(&param, 0, sizeof(param));
+				IARM_Result_t res = IARM_Bus_Call(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_API_GetSystemStates, &param, sizeof(param));
+				if (res == IARM_RESULT_SUCCESS)
+				{
+					m_systemStates = param;
+					m_systemStatesValid = true;
+				}
+				else
+				{
+					// try again with the next request, events received meanwhile are in the table
+					LOGWARN("IARM_BUS_SYSMGR_API_GetSystemStates failed: %d", res);
+					states = param;
+					return;
+				}
+			}
+			states = m_systemStates;
+		}
+
 
 		 /**
 		 * @brief This function registers Listeners to properties.It adds the properties to a registered properties list.
@@ -649,6 +697,9 @@ namespace WPEFramework {
 				cJSON_Delete(root);
 				returnResponse(ret);
 			}
+			int batchWindow = 0;
+			getDefaultNumberParameter("batchWindow", batchWindow, 0);
+			batchWindow = std::max(0, std::min(batchWindow, STATE_OBSERVER_MAX_BATCH_WINDOW_MS));
 			int arrsize=cJSON_GetArraySize(items);
 			if(arrsize!=0)
 			{
@@ -663,12 +714,22 @@ namespace WPEFramework {
 					pname.push_back(prop_str);
 				}
 
-				for( std::vector<string>::iterator it = pname.begin(); it!= pname.end(); ++it )
 				{
-					if (std::find(registeredPropertyNames.begin(), registeredPropertyNames.end(), *it) == registeredPropertyNames.end())
+					std::lock_guard<std::mutex> lock(m_listenersLock);
+					for( std::vector<string>::iterator it = pname.begin(); it!= pname.end(); ++it )
 					{
-						LOGINFO("prop being added to listeners %s",it->c_str());
-						registeredPropertyNames.push_back(*it);
+						if (std::find(registeredPropertyNames.begin(), registeredPropertyNames.end(), *it) == registeredPropertyNames.end())
+						{
+							LOGINFO("prop being added to listeners %s",it->c_str());
+							registeredPropertyNames.push_back(*it);
+						}
+						if (batchWindow > 0)
+							m_batchWindows[*it] = batchWindow;
+						else
+						{
+							m_batchWindows.erase(*it);
+							m_pendingChanges.erase(*it);
+						}
 					}
 				}
 				getVal(pname,response);
@@ -724,6 +785,7 @@ namespace WPEFramework {
 					string prop_str =elem->valuestring;
 					pname.push_back(prop_str);
 				}
+				std::lock_guard<std::mutex> lock(m_listenersLock);
 				for( std::vector<string>::iterator it = pname.begin(); it!= pname.end(); ++it )
 				{
 					std::vector<string>::iterator itr=std::find(registeredPropertyNames.begin(), registeredPropertyNames.end(), *it);
@@ -733,6 +795,8 @@ namespace WPEFramework {
 						LOGINFO("prop being removed %s",it->c_str());
 						registeredPropertyNames.erase(itr);
 					}
+					m_batchWindows.erase(*it);
+					m_pendingChanges.erase(*it);
 				}
 			}
 			LOGTRACEMETHODFIN();
@@ -746,7 +810,11 @@ namespace WPEFramework {
 		 */
 		void StateObserver::onReportStateObserverEvents(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
 		{
-			IARM_Bus_SYSMgr_GetSystemStates_Param_t systemStates;
+			if (StateObserver::_instance == nullptr)
+				return;
+
+			std::unique_lock<std::mutex> statesLock(StateObserver::_instance->m_statesLock);
+			IARM_Bus_SYSMgr_GetSystemStates_Param_t& systemStates = StateObserver::_instance->m_systemStates;
 			JsonObject params;
 			int state=0;
 			int error=0;
@@ -831,8 +899,8 @@ namespace WPEFramework {
 						{
 						systemStates.dac_init_timestamp.state = state;
 						systemStates.dac_init_timestamp.error = error;
-						strncpy(systemStates.dac_init_timestamp.payload,payload,strlen(payload));
-						systemStates.dac_init_timestamp.payload[strlen(payload)]='\0';
+						strncpy(systemStates.dac_init_timestamp.payload,payload,sizeof(systemStates.dac_init_timestamp.payload) - 1);
+						systemStates.dac_init_timestamp.payload[sizeof(systemStates.dac_init_timestamp.payload) - 1]='\0';
 						if(StateObserver::_instance)
 							StateObserver::_instance->setProp(params,SYSTEM_DAC_INIT_TIMESTAMP,state,error);
 						string payload_str(payload);
@@ -843,8 +911,8 @@ namespace WPEFramework {
 					case IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD_SERIAL_NO:
 						{
 						systemStates.card_serial_no.error =error;
-						strncpy(systemStates.card_serial_no.payload,payload,strlen(payload));
-						systemStates.card_serial_no.payload[strlen(payload)]='\0';
+						strncpy(systemStates.card_serial_no.payload,payload,sizeof(systemStates.card_serial_no.payload) - 1);
+						systemStates.card_serial_no.payload[sizeof(systemStates.card_serial_no.payload) - 1]='\0';
 						params["propertyName"]=SYSTEM_CARD_SERIAL_NO;
 						params["error"]=error;
 						string payload_str(payload);
@@ -855,8 +923,8 @@ namespace WPEFramework {
 					 case IARM_BUS_SYSMGR_SYSSTATE_STB_SERIAL_NO:
 						{
 						systemStates.stb_serial_no.error =error;
-						strncpy(systemStates.stb_serial_no.payload,payload,strlen(payload));
-						systemStates.stb_serial_no.payload[strlen(payload)]='\0';
+						strncpy(systemStates.stb_serial_no.payload,payload,sizeof(systemStates.stb_serial_no.payload) - 1);
+						systemStates.stb_serial_no.payload[sizeof(systemStates.stb_serial_no.payload) - 1]='\0';
 						params["propertyName"]=SYSTEM_STB_SERIAL_NO;
 						params["error"]=error;
 						string payload_str(payload);
@@ -991,8 +1059,8 @@ namespace WPEFramework {
 					case IARM_BUS_SYSMGR_SYSSTATE_ECM_MAC:
 						{
 						systemStates.ecm_mac.error =error;
-						strncpy(systemStates.ecm_mac.payload,payload,strlen(payload));
-						systemStates.ecm_mac.payload[strlen(payload)]='\0';
+						strncpy(systemStates.ecm_mac.payload,payload,sizeof(systemStates.ecm_mac.payload) - 1);
+						systemStates.ecm_mac.payload[sizeof(systemStates.ecm_mac.payload) - 1]='\0';
 						params["propertyName"]=SYSTEM_ECM_MAC;
 						params["error"]=error;
 						string payload_str(payload);
@@ -1004,8 +1072,8 @@ namespace WPEFramework {
 						{
 						systemStates.ip_mode.state=state;
 						systemStates.ip_mode.error =error;
-						strncpy(systemStates.ip_mode.payload,payload,strlen(payload));
-						systemStates.ip_mode.payload[strlen(payload)]='\0';
+						strncpy(systemStates.ip_mode.payload,payload,sizeof(systemStates.ip_mode.payload) - 1);
+						systemStates.ip_mode.payload[sizeof(systemStates.ip_mode.payload) - 1]='\0';
 						if(StateObserver::_instance)
 							StateObserver::_instance->setProp(params,SYSTEM_IP_MODE,state,error);
 						string payload_str(payload);
@@ -1015,6 +1083,7 @@ namespace WPEFramework {
 					default:
 						break;
 				}
+				statesLock.unlock();
 
 				//notify the params
 				if(StateObserver::_instance)
@@ -1041,8 +1110,32 @@ namespace WPEFramework {
 		void StateObserver::notify(string eventname, JsonObject& params)
 		{
 			string property_name=params["propertyName"].String();
+			std::unique_lock<std::mutex> lock(m_listenersLock);
 			if(std::find(registeredPropertyNames.begin(), registeredPropertyNames.end(), property_name) != registeredPropertyNames.end())
 			{
+				auto window = m_batchWindows.find(property_name);
+				if (window != m_batchWindows.end())
+				{
+					// the window opens with the first change, later ones only replace the value
+					auto pending = m_pendingChanges.find(property_name);
+					if (pending == m_pendingChanges.end())
+					{
+						PendingChange change;
+						change.params = params;
+						change.changes = 1;
+						change.due = Clock::now() + std::chrono::milliseconds(window->second);
+						m_pendingChanges.emplace(property_name, change);
+						m_batchCondition.notify_all();
+					}
+					else
+					{
+						pending->second.params = params;
+						pending->second.changes++;
+					}
+					return;
+				}
+				lock.unlock();
+
 				LOGINFO("calling send notify\n");
 				#if(DEBUG_INFO)
 					string json_str;
@@ -1054,6 +1147,52 @@ namespace WPEFramework {
 			}
 		}
 
+		/**
+		 * @brief This function runs on its own thread and sends the batched property changes
+		 * whose window closed, with the number of changes they stand for.
+		 *
+		 */
+		void StateObserver::flushBatches()
+		{
+			std::unique_lock<std::mutex> lock(m_listenersLock);
+			while (m_batchRunning)
+			{
+				if (m_pendingChanges.empty())
+				{
+					m_batchCondition.wait(lock);
+					continue;
+				}
+
+				Clock::time_point now = Clock::now();
+				Clock::time_point next = Clock::time_point::max();
+				std::vector<JsonObject> due;
+				for (auto it = m_pendingChanges.begin(); it != m_pendingChanges.end(); )
+				{
+					if (it->second.due <= now)
+					{
+						it->second.params["changes"] = it->second.changes;
+						due.push_back(it->second.params);
+						it = m_pendingChanges.erase(it);
+					}
+					else
+					{
+						next = std::min(next, it->second.due);
+						++it;
+					}
+				}
+
+				if (!due.empty())
+				{
+					lock.unlock();
+					for (auto& params : due)
+						sendNotify(EVT_STATE_OBSERVER_PROPERTY_CHANGED.c_str(), params);
+					lock.lock();
+				}
+				else
+					m_batchCondition.wait_until(lock, next);
+			}
+		}
+
 		/**
 		 * @brief This function sets the state and error values to the json object.
 		 *
@@ -32,12 +32,22 @@
 #define STATEOBSERVER_H
 #include <cjson/cJSON.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #include "Module.h"
 #include "libIBus.h"
+#include "sysMgr.h"
 #include "utils.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
 
+/* Longest batching window a listener may ask for, in milliseconds */
+#define STATE_OBSERVER_MAX_BATCH_WINDOW_MS 10000
+
 //State Observer Properties
 extern const string SYSTEM_EXIT_OK;
 extern const string SYSTEM_CHANNEL_MAP;
@@ -120,9 +130,11 @@ namespace WPEFramework {
 			uint32_t getApiVersionNumberWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getRegisteredPropertyNames(const JsonObject &parameters, JsonObject &response);
 			uint32_t getNameWrapper(const JsonObject& parameters, JsonObject& response);
-			void getVal(std::vector<string> pname,JsonObject& response);
+			void getVal(const std::vector<string>& pname,JsonObject& response);
+			void getSystemStates(IARM_Bus_SYSMgr_GetSystemStates_Param_t& states);
 			void InitializeIARM();
 			void DeinitializeIARM();
+			void flushBatches();
 			//End methods
 
 
@@ -146,6 +158,27 @@ namespace WPEFramework {
 			static StateObserver* _instance;
 		private:
 			uint32_t m_apiVersionNumber;
+
+			// Property table: seeded with one IARM call, kept current by the system state events
+			std::mutex m_statesLock;
+			IARM_Bus_SYSMgr_GetSystemStates_Param_t m_systemStates;
+			bool m_systemStatesValid;
+
+			// Changes of properties registered with a batch window are held back for the window,
+			// only the last value of the property is sent once it closed.
+			typedef std::chrono::steady_clock Clock;
+			struct PendingChange
+			{
+				JsonObject params;
+				uint32_t changes;
+				Clock::time_point due;
+			};
+			std::mutex m_listenersLock;
+			std::condition_variable m_batchCondition;
+			std::map<string, uint32_t> m_batchWindows;	// ms per registered property
+			std::map<string, PendingChange> m_pendingChanges;
+			std::thread m_batchThread;
+			bool m_batchRunning;
 		};
 
 	} // namespace Plugin
@@ -35,6 +35,8 @@ namespace Exchange {
         virtual uint32_t IsPlaying(const string &input, string &output /* @out */) = 0;
 	virtual uint32_t Config(const string &input, string &output /* @out */) = 0;
         virtual uint32_t GetPlayerSessionId(const string &input, string &output /* @out */) = 0;
+        virtual uint32_t Preload(const string &input, string &output /* @out */) = 0;
+        virtual uint32_t PlayClip(const string &input, string &output /* @out */) = 0;
 
     };
 
@@ -357,6 +357,46 @@ namespace ProxyStubs {
             writer.Text(param1);
         },
 
+        // virtual uint32_t Preload(const string &input, string &output /* @out */)
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            string param1{}; // storage
+
+            // call implementation
+            ISystemAudioPlayer* implementation = reinterpret_cast<ISystemAudioPlayer*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null ISystemAudioPlayer implementation pointer");
+            const uint32_t output = implementation->Preload(param0, param1);
+
+            // write return values
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+            writer.Text(param1);
+        },
+
+        // virtual uint32_t PlayClip(const string &input, string &output /* @out */)
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            string param1{}; // storage
+
+            // call implementation
+            ISystemAudioPlayer* implementation = reinterpret_cast<ISystemAudioPlayer*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null ISystemAudioPlayer implementation pointer");
+            const uint32_t output = implementation->PlayClip(param0, param1);
+
+            // write return values
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+            writer.Text(param1);
+        },
+
         nullptr
     }; // SystemAudioPlayerStubMethods[]
 
@@ -692,6 +732,46 @@ namespace ProxyStubs {
         }
 
 
+        uint32_t Preload(const string& param0, string& /* out */ param1) override
+        {
+            IPCMessage newMessage(BaseClass::Message(14));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return values
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+                param1 = reader.Text();
+            }
+
+            return output;
+        }
+
+        uint32_t PlayClip(const string& param0, string& /* out */ param1) override
+        {
+            IPCMessage newMessage(BaseClass::Message(15));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return values
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+                param1 = reader.Text();
+            }
+
+            return output;
+        }
+
     }; // class SystemAudioPlayerProxy
 
     //
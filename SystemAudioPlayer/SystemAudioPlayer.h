@@ -113,6 +113,8 @@ namespace Plugin {
         uint32_t IsPlaying(const JsonObject& parameters, JsonObject& response);
 	uint32_t Config(const JsonObject& parameters, JsonObject& response);
         uint32_t GetPlayerSessionId(const JsonObject& parameters, JsonObject& response);
+        uint32_t Preload(const JsonObject& parameters, JsonObject& response);
+        uint32_t PlayClip(const JsonObject& parameters, JsonObject& response);
 
         //version number API's
         uint32_t getapiversion(const JsonObject& parameters, JsonObject& response);
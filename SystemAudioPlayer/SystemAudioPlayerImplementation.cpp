@@ -56,7 +56,12 @@ namespace Plugin {
 
     uint32_t SystemAudioPlayerImplementation::Configure(PluginHost::IShell* service)
     {
-     
+        JsonObject config;
+        if (service)
+            config.FromString(service->ConfigLine());
+        // All players feed one mixer pipeline with one sink instead of a pipeline each
+        AudioPlayer::setSharedMixer(config.HasLabel("sharedmixer") && config["sharedmixer"].Boolean());
+        return Core::ERROR_NONE;
     }
 
     void SystemAudioPlayerImplementation::Register(Exchange::ISystemAudioPlayer::INotification* sink)
@@ -178,6 +183,46 @@ namespace Plugin {
         returnResponse(true);
     }
 
+    uint32_t SystemAudioPlayerImplementation::Preload(const string &input, string &output)
+    {
+        SAPLOG_INFO("SystemAudioPlayerImplementation Got Preload request :%s\n",input.c_str());
+        CONVERT_PARAMETERS_TOJSON();
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("url");
+        int durationMs = 0;
+        bool cached = false;
+        bool ret = _clipCache.preload(parameters["url"].String(), durationMs, cached);
+        if(ret)
+        {
+            response["duration"] = durationMs;
+            response["cached"] = cached;
+        }
+        returnResponse(ret);
+    }
+
+    uint32_t SystemAudioPlayerImplementation::PlayClip(const string &input, string &output)
+    {
+        SAPLOG_INFO("SystemAudioPlayerImplementation Got PlayClip request :%s\n",input.c_str());
+        CONVERT_PARAMETERS_TOJSON();
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("url");
+        int volume = DEFAULT_PLAYER_VOL_LEVEL;
+        int durationMs = 0;
+        bool cached = false;
+        if(parameters.HasLabel("volume"))
+            getNumberParameter("volume", volume);
+        if(volume < 0 || volume > 100)
+        {
+            response["message"] = "volume is out of range 0-100";
+            returnResponse(false);
+        }
+        bool ret = _clipCache.play(parameters["url"].String(), volume, durationMs, cached);
+        if(ret)
+        {
+            response["duration"] = durationMs;
+            response["cached"] = cached;
+        }
+        returnResponse(ret);
+    }
+
     uint32_t SystemAudioPlayerImplementation::Play(const string &input, string &output)
     {
         SAPLOG_INFO("SystemAudioPlayerImplementation Got Play request :%s\n",input.c_str());
@@ -238,9 +283,14 @@ namespace Plugin {
             uint8_t *decworkspace = new uint8_t[decworkspace_size];
             size_t decnum_chars = b64_decode(e, dectokenVec.size(),decworkspace);
             LOGINFO("decode size %d\n", decworkspace_size);
-            player->PlayBuffer((const char*)decworkspace,decnum_chars);
+            bool queued = player->PlayBuffer((const char*)decworkspace,decnum_chars);
             delete []decworkspace;
-            
+
+            if(!queued)
+            {
+                response["message"] = "buffer queue is full, send the data again after NEED_DATA";
+                returnResponse(false);
+            }
             returnResponse(true);
         }
         returnResponse(false);
@@ -397,6 +447,17 @@ namespace Plugin {
         params["event"] = message;
         dispatchEvent(ONSAPEVENT, params);
     }
+
+    void SystemAudioPlayerImplementation::onSAPQueueEvent(uint32_t id,std::string message,int depth,unsigned int underruns,unsigned int dropped)
+    {
+        JsonObject params;
+        params["id"]  = JsonValue((int)id);
+        params["event"] = message;
+        params["queueDepth"] = JsonValue(depth);
+        params["underruns"] = JsonValue((int)underruns);
+        params["dropped"] = JsonValue((int)dropped);
+        dispatchEvent(ONSAPEVENT, params);
+    }
     
     void SystemAudioPlayerImplementation::OpenMapping(AudioType audioType,SourceType sourceType,PlayMode mode,int &playerid)
     {
@@ -27,6 +27,7 @@
 
 #include "ISystemAudioPlayer.h"
 #include "impl/AudioPlayer.h"
+#include "impl/ClipCache.h"
 #include "impl/logger.h"
 #include <vector>
 
@@ -116,8 +117,11 @@ namespace Plugin {
         virtual uint32_t IsPlaying(const string &input, string &output /* @out */) override ;
 	virtual uint32_t Config(const string &input, string &output /* @out */) override ;
         virtual uint32_t GetPlayerSessionId(const string &input, string &output /* @out */) override ;
+        virtual uint32_t Preload(const string &input, string &output /* @out */) override ;
+        virtual uint32_t PlayClip(const string &input, string &output /* @out */) override ;
 
         virtual void onSAPEvent(uint32_t id,std::string message) override; 
+        virtual void onSAPQueueEvent(uint32_t id,std::string message,int depth,unsigned int underruns,unsigned int dropped) override;
       
         BEGIN_INTERFACE_MAP(SystemAudioPlayerImplementation)
         INTERFACE_ENTRY(Exchange::ISystemAudioPlayer)
@@ -128,6 +132,7 @@ namespace Plugin {
         AudioPlayer* getObjectFromMap(int key);
         mutable Core::CriticalSection _adminLock;
         std::list<Exchange::ISystemAudioPlayer::INotification*> _notificationClients;
+        ClipCache _clipCache;
 
         void dispatchEvent(Event, JsonObject &params);
         void Dispatch(Event event, string data);
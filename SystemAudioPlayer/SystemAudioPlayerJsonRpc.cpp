@@ -35,6 +35,8 @@ namespace Plugin {
         registerMethod("isspeaking", &SystemAudioPlayer::IsPlaying, this);
 	registerMethod("config", &SystemAudioPlayer::Config, this);
         registerMethod("getPlayerSessionId", &SystemAudioPlayer::GetPlayerSessionId, this);
+        registerMethod("preload", &SystemAudioPlayer::Preload, this);
+        registerMethod("playClip", &SystemAudioPlayer::PlayClip, this);
     }
     
    
@@ -74,6 +76,30 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    uint32_t SystemAudioPlayer::Preload(const JsonObject& parameters, JsonObject& response)
+    {
+        if(_sap) {
+            string params, result;
+            parameters.ToString(params);
+            uint32_t ret= _sap->Preload(params, result);
+            response.FromString(result);
+            return ret;
+        }
+        return Core::ERROR_NONE;
+    }
+
+    uint32_t SystemAudioPlayer::PlayClip(const JsonObject& parameters, JsonObject& response)
+    {
+        if(_sap) {
+            string params, result;
+            parameters.ToString(params);
+            uint32_t ret= _sap->PlayClip(params, result);
+            response.FromString(result);
+            return ret;
+        }
+        return Core::ERROR_NONE;
+    }
+
     uint32_t SystemAudioPlayer::Play(const JsonObject& parameters, JsonObject& response)
     {
         if(_sap) {
@@ -3,6 +3,7 @@
 #include <gst/app/gstappsrc.h>
 
 #include <cmath>
+#include <cstdlib>
 #define AUDIO_GST_FRAGMENT_MAX_SIZE     (128 * 1024)
 #define PLAYBACK_STARTED "PLAYBACK_STARTED"
 #define PLAYBACK_FINISHED "PLAYBACK_FINISHED"
@@ -11,10 +12,18 @@
 #define NETWORK_ERROR "NETWORK_ERROR"
 #define PLAYBACK_ERROR "PLAYBACK_ERROR"
 #define NEED_DATA "NEED_DATA"
+#define ENOUGH_DATA "ENOUGH_DATA"
+#define BUFFER_UNDERRUN "BUFFER_UNDERRUN"
+//bufferQueue depth in packets
+#define BUFFER_QUEUE_SIZE 1000
+#define BUFFER_QUEUE_LOW_WATERMARK 50
+#define BUFFER_QUEUE_HIGH_WATERMARK 800
+#define APPSRC_WAIT_MS 100
 
 GMainLoop* AudioPlayer::m_main_loop=NULL;
 GThread* AudioPlayer::m_main_loop_thread=NULL;
 SAPEventCallback* AudioPlayer::m_callback=NULL;
+bool AudioPlayer::m_useSharedMixer=false;
 audio_hw_device_t* AudioPlayer::m_audio_dev=NULL;
 //TODO Dock primary volume , if both APP & SYSTEM mode are playing
 //static bool app_playing =false;
@@ -27,14 +36,31 @@ AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode play
     this->playMode = playMode;
     this->objectIdentifier = objectIdentifier;
     m_isPaused = false;
+    m_mixerPad = NULL;
+    m_pushedBytes = 0;
+    m_frameBytes = 0;
     state = READY;
     SAPLOG_INFO("SAP: AudioPlayer Constructor\n");    
     if(sourceType == DATA || sourceType == WEBSOCKET)
     {
         m_running = true;
         appsrc_firstpacket = true;
+        m_appsrcEnough = false;
+        m_underruns = 0;
+        m_underrun = false;
         webClient = NULL;
-        bufferQueue = new BufferQueue(1000);
+        bufferQueue = new BufferQueue(BUFFER_QUEUE_SIZE);
+        bufferQueue->setWatermarks(BUFFER_QUEUE_LOW_WATERMARK, BUFFER_QUEUE_HIGH_WATERMARK, [this](bool enough, int depth)
+        {
+            (void)depth;
+            queueEvent(enough ? ENOUGH_DATA : NEED_DATA);
+            //the websocket server is held off while the queue drains
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            if(webClient)
+            {
+                webClient->onQueueLevel(enough);
+            }
+        });
         m_thread= new std::thread(&AudioPlayer::PushDataAppSrc, this);
     }
 
@@ -70,6 +96,7 @@ AudioPlayer::~AudioPlayer()
     if(sourceType == DATA || sourceType == WEBSOCKET)
     {   
         m_running = false;       
+        m_condition.notify_all();
         bufferQueue->preDelete();
 	SAPLOG_INFO("SAP: AudioPlayer Destructor before Pushapp src thread join player id %d\n",getObjectIdentifier());
 	m_thread->join();
@@ -77,8 +104,15 @@ AudioPlayer::~AudioPlayer()
         delete bufferQueue;
         delete m_thread;
     }  
-    gst_element_set_state (m_pipeline, GST_STATE_NULL);
-    gst_object_unref (m_pipeline);  
+    if(m_mixerPad)
+    {
+        destroyPipeline();
+    }
+    else
+    {
+        gst_element_set_state (m_pipeline, GST_STATE_NULL);
+        gst_object_unref (m_pipeline);  
+    }
 }
 
 void AudioPlayer::Init(SAPEventCallback *callback)
@@ -114,6 +148,7 @@ void AudioPlayer::Init(SAPEventCallback *callback)
 void AudioPlayer::DeInit()
 {   
     SAPLOG_INFO("SAP: AudioPlayer DeInit\n");
+    SharedMixer::destroy();
     if(g_main_loop_is_running(m_main_loop))
         g_main_loop_quit(m_main_loop);
     g_thread_join(m_main_loop_thread);
@@ -128,6 +163,13 @@ void AudioPlayer::DeInit()
     SAPLOG_INFO("SAP: AudioPlayer DeInit last\n");
 }
 
+//Players created from now on feed the shared mixer instead of a pipeline of their own
+void AudioPlayer::setSharedMixer(bool shared)
+{
+    SAPLOG_INFO("SAP: shared mixer %s\n", shared ? "enabled" : "disabled");
+    m_useSharedMixer = shared;
+}
+
 void AudioPlayer::event_loop()
 {
     m_main_loop = g_main_loop_new(NULL, false);
@@ -219,6 +261,10 @@ bool AudioPlayer::isPlaying()
 void AudioPlayer::createPipeline()
 {
     GstCaps *audiocaps = NULL;
+    if(m_useSharedMixer && createMixerInput())
+    {
+        return;
+    }
     SAPLOG_INFO("SAP: Creating Pipeline...\n");
     m_pipeline = gst_pipeline_new(NULL);
     if (!m_pipeline) {
@@ -278,8 +324,8 @@ void AudioPlayer::createPipeline()
         {
             gst_app_src_set_caps(GST_APP_SRC(m_source), audiocaps);
 	    gst_caps_unref(audiocaps);
-	    //g_signal_connect (m_source, "need-data", G_CALLBACK (start_feed), this);
-            //g_signal_connect (m_source, "enough-data", G_CALLBACK (stop_feed), this);
+	    g_signal_connect (m_source, "need-data", G_CALLBACK (appsrcNeedData), this);
+            g_signal_connect (m_source, "enough-data", G_CALLBACK (appsrcEnoughData), this);
 	    g_object_set(m_source, "format", GST_FORMAT_TIME, NULL);
 	    #if defined(PLATFORM_AMLOGIC)
             gst_bin_add_many(GST_BIN(m_pipeline), m_source, convert, resample, m_audioSink, NULL);
@@ -374,6 +420,129 @@ void AudioPlayer::createPipeline()
 
 }
 
+//The source chain of the player in a bin, without sink, fed into the shared mixer.
+//The mixer converts to its format, so there is no audioconvert/audioresample per player.
+bool AudioPlayer::createMixerInput()
+{
+    SAPLOG_INFO("SAP: Creating shared mixer input player id:%d\n",getObjectIdentifier());
+    SharedMixer *mixer = SharedMixer::instance();
+    if(!mixer)
+    {
+        SAPLOG_WARNING("SAP: No shared mixer, player id:%d builds its own pipeline\n",getObjectIdentifier());
+        return false;
+    }
+
+    m_pipeline = gst_bin_new(NULL);
+    m_audioSink = NULL;
+    m_audioVolume = NULL;
+    m_capsfilter = NULL;
+    if(sourceType == HTTPSRC)
+    {
+        m_source = gst_element_factory_make("souphttpsrc", NULL);
+    }
+    else if(sourceType == FILESRC)
+    {
+        m_source = gst_element_factory_make("filesrc", NULL);
+    }
+    else
+    {
+        m_source = gst_element_factory_make("appsrc", NULL);
+        gst_app_src_set_max_bytes((GstAppSrc *)m_source,512000);
+    }
+
+    GstElement *elements[2] = { NULL, NULL };
+    int count = 0;
+    if(audioType == PCM)
+    {
+        GstCaps *audiocaps = getPCMAudioCaps( m_PCMFormat, m_Rate , m_Channels ,m_Layout );
+        if(audiocaps == NULL)
+        {
+            if(m_source)
+                gst_object_unref(m_source);
+            gst_object_unref(m_pipeline);
+            m_pipeline = NULL;
+            return false;
+        }
+        if(sourceType == DATA || sourceType == WEBSOCKET)
+        {
+            //Timestamped from the byte count in PushDataAppSrc, the mixer places them by time
+            gst_app_src_set_caps(GST_APP_SRC(m_source), audiocaps);
+            g_signal_connect (m_source, "need-data", G_CALLBACK (appsrcNeedData), this);
+            g_signal_connect (m_source, "enough-data", G_CALLBACK (appsrcEnoughData), this);
+            g_object_set(m_source, "format", GST_FORMAT_TIME, NULL);
+        }
+        else
+        {
+            //The mixer takes TIME segments only, rawaudioparse makes them from the bytes
+            m_capsfilter = gst_element_factory_make ("capsfilter", NULL);
+            if (m_capsfilter)
+                g_object_set (G_OBJECT (m_capsfilter), "caps", audiocaps, NULL);
+            elements[0] = m_capsfilter;
+            elements[1] = gst_element_factory_make("rawaudioparse", NULL);
+            if (elements[1])
+                g_object_set (G_OBJECT (elements[1]), "use-sink-caps", TRUE, NULL);
+            count = 2;
+        }
+        gst_caps_unref(audiocaps);
+    }
+    else if(audioType == WAV)
+    {
+        elements[0] = gst_element_factory_make("wavparse", NULL);
+        count = 1;
+    }
+    else
+    {
+        elements[0] = gst_element_factory_make("mpegaudioparse", NULL);
+        elements[1] = gst_element_factory_make("avdec_mp3", NULL);
+        count = 2;
+    }
+
+    bool result = (m_source != NULL);
+    for(int i = 0; i < count; i++)
+        result = result && (elements[i] != NULL);
+
+    if(result)
+    {
+        GstElement *last = m_source;
+        gst_bin_add(GST_BIN(m_pipeline), m_source);
+        for(int i = 0; i < count; i++)
+            gst_bin_add(GST_BIN(m_pipeline), elements[i]);
+        for(int i = 0; i < count && result; i++)
+        {
+            result = gst_element_link(last, elements[i]);
+            last = elements[i];
+        }
+        if(result)
+        {
+            GstPad *pad = gst_element_get_static_pad(last, "src");
+            gst_element_add_pad(m_pipeline, gst_ghost_pad_new("src", pad));
+            gst_object_unref(pad);
+            result = mixer->attach(m_pipeline, playMode == APP, [this](GstMessage *message) { return handleMessage(message); }, m_mixerPad);
+        }
+    }
+    else
+    {
+        GstElement *created[3] = { m_source, elements[0], elements[1] };
+        for(int i = 0; i < 3; i++)
+        {
+            if(created[i])
+                gst_object_unref(created[i]);
+        }
+    }
+
+    if(!result)
+    {
+        SAPLOG_ERROR("SAP: Failed to create the shared mixer input player id %d\n",getObjectIdentifier());
+        gst_object_unref(m_pipeline);
+        m_pipeline = NULL;
+        m_capsfilter = NULL;
+        m_mixerPad = NULL;
+        return false;
+    }
+    SAPLOG_INFO("SAP: End of create shared mixer input Player id: %d\n",getObjectIdentifier());
+    return true;
+}
+
 int AudioPlayer::GstBusCallback(GstBus *, GstMessage *message, gpointer data) 
 {
     AudioPlayer *player  = (AudioPlayer*) data;
@@ -381,6 +550,41 @@ int AudioPlayer::GstBusCallback(GstBus *, GstMessage *message, gpointer data)
 }
 
 
+//Bits per sample of a raw audio format name, S16LE -> 16, S24_32LE -> 32
+static int pcmSampleBits(const std::string &format)
+{
+    size_t digits = format.find_first_of("0123456789");
+    if(digits == std::string::npos)
+        return 0;
+    if(format.find("_32") != std::string::npos)
+        return 32;
+    return atoi(format.c_str() + digits);
+}
+
+static void releaseWrappedBuffer(gpointer data)
+{
+    static_cast<Buffer*>(data)->unref();
+}
+
+void AudioPlayer::appsrcNeedData(GstElement *, guint, gpointer data)
+{
+    AudioPlayer *player = (AudioPlayer*) data;
+    std::lock_guard<std::mutex> lock(player->m_queueMutex);
+    player->m_appsrcEnough = false;
+    player->m_condition.notify_all();
+}
+
+void AudioPlayer::appsrcEnoughData(GstElement *, gpointer data)
+{
+    AudioPlayer *player = (AudioPlayer*) data;
+    player->m_appsrcEnough = true;
+}
+
+void AudioPlayer::queueEvent(const char *event)
+{
+    m_callback->onSAPQueueEvent(getObjectIdentifier(), event, bufferQueue->count(), m_underruns, bufferQueue->dropped());
+}
+
 gboolean AudioPlayer::PushDataAppSrc()
 {
     while(m_running)
@@ -388,9 +592,12 @@ gboolean AudioPlayer::PushDataAppSrc()
         Buffer *buffer =NULL;
         if(bufferQueue->isEmpty())
         {
-             if(!appsrc_firstpacket)
+             if(!appsrc_firstpacket && !m_underrun)
              {
-	         //event -->Underflow
+	         //event -->Underflow, once until data arrives again
+                 m_underrun = true;
+                 m_underruns++;
+                 queueEvent(BUFFER_UNDERRUN);
                  if(sourceType == DATA)
                  { 
                      m_callback->onSAPEvent(getObjectIdentifier(),NEED_DATA);
@@ -406,9 +613,31 @@ gboolean AudioPlayer::PushDataAppSrc()
 	{
             continue;		
 	}
+        bool resumed = m_underrun;
+        m_underrun = false;
+
+        //appsrc holds max-bytes already, leave the rest in bufferQueue where the watermarks see it
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            while(m_appsrcEnough && m_running)
+            {
+                m_condition.wait_for(lock, std::chrono::milliseconds(APPSRC_WAIT_MS));
+            }
+        }
         int length = buffer->getLength();
         char *ptr = buffer->getBuffer();
 
+        //The mixer plays the stream from now on, after an underrun from where it stopped
+        if(m_mixerPad && (appsrc_firstpacket || resumed))
+        {
+            if(appsrc_firstpacket)
+            {
+                m_pushedBytes = 0;
+                m_frameBytes = (audioType == PCM) ? pcmSampleBits(m_PCMFormat) / 8 * m_Channels : 0;
+            }
+            SharedMixer::instance()->start(m_mixerPad, !appsrc_firstpacket);
+        }
+
         while(length != 0)
         {               
             int lenToSend = length;
@@ -418,13 +647,17 @@ gboolean AudioPlayer::PushDataAppSrc()
                 lenToSend = maxBytes;
             }
      
-            GstBuffer *gbuffer = gst_buffer_new_and_alloc((guint)lenToSend);
-            GstMapInfo map;
-            gst_buffer_map(gbuffer, &map, GST_MAP_WRITE);
-            memcpy(map.data,ptr,lenToSend);
-            gst_buffer_unmap(gbuffer, &map);
+            //wrap the packet, it is released once gstreamer is done with it
+            buffer->ref();
+            GstBuffer *gbuffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, ptr, (gsize)lenToSend, 0, (gsize)lenToSend, buffer, releaseWrappedBuffer);
             //GST_BUFFER_PTS(gbuffer) = pts;
             //GST_BUFFER_DTS(gbuffer) = dts;
+            if(m_mixerPad && m_frameBytes > 0)
+            {
+                GST_BUFFER_PTS(gbuffer) = gst_util_uint64_scale(m_pushedBytes / m_frameBytes, GST_SECOND, m_Rate);
+                m_pushedBytes += lenToSend;
+                GST_BUFFER_DURATION(gbuffer) = gst_util_uint64_scale(m_pushedBytes / m_frameBytes, GST_SECOND, m_Rate) - GST_BUFFER_PTS(gbuffer);
+            }
             //GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(player->m_source), gbuffer);
             GstFlowReturn ret;
             g_signal_emit_by_name (m_source, "push-buffer", gbuffer, &ret);
@@ -445,8 +678,7 @@ gboolean AudioPlayer::PushDataAppSrc()
             ptr = lenToSend + (char *)ptr;
             length -= lenToSend;
         }
-        buffer->deleteBuffer();
-	delete buffer;        
+        buffer->unref();
     }
    
 }
@@ -465,14 +697,28 @@ void AudioPlayer::wsConnectionStatus(WSStatus status)
     } 
 }
 
-void AudioPlayer::push_data(const void *ptr,int length)
+bool AudioPlayer::push_data(const void *ptr,int length)
 {
-    if(!bufferQueue->isFull())
+    //The caller keeps the data and sends it again after NEED_DATA, nothing is lost.
+    //Only this thread adds, the queue can not fill up between the check and the add.
+    if(bufferQueue->isFull())
     {
-	Buffer *buffer = new Buffer();
-        buffer->fillBuffer(ptr,length);
-        bufferQueue->add(buffer);
+        SAPLOG_WARNING("SAP: buffer queue full, data refused Playerid %d\n",getObjectIdentifier());
+        return false;
     }
+    Buffer *buffer = bufferQueue->newBuffer();
+    buffer->fillBuffer(ptr,length);
+    return bufferQueue->add(buffer);
+}
+
+Buffer* AudioPlayer::newBuffer()
+{
+    return bufferQueue->newBuffer();
+}
+
+bool AudioPlayer::push_buffer(Buffer *buffer)
+{
+    return bufferQueue->add(buffer);
 }
 
 bool AudioPlayer::handleMessage(GstMessage *message) 
@@ -516,6 +762,11 @@ bool AudioPlayer::handleMessage(GstMessage *message)
             }
             break;
 
+        case GST_MESSAGE_APPLICATION:
+            if(!m_mixerPad || !gst_message_has_name(message, SAP_MIXER_EOS))
+                break;
+            SharedMixer::instance()->stop(m_mixerPad);
+            // fall through, the end of the stream of a shared mixer input
         case GST_MESSAGE_EOS: {
                 SAPLOG_INFO("Audio EOS message received");
                 if(state != PLAYBACKERROR)
@@ -568,8 +819,12 @@ bool AudioPlayer::handleMessage(GstMessage *message)
                             //Fix audio delay for web socket
                             if(sourceType == WEBSOCKET && !webClient)
                             {                     
-                                webClient = new WebSocketClient(this);
-                                webClient->connect(m_url);
+                                WebSocketClient *client = new WebSocketClient(this);
+                                {
+                                    std::lock_guard<std::mutex> lock(m_wsMutex);
+                                    webClient = client;
+                                }
+                                client->connect(m_url);
                             }
                             if(sourceType != WEBSOCKET && sourceType != DATA)
                             {
@@ -633,6 +888,10 @@ bool AudioPlayer::handleMessage(GstMessage *message)
 void AudioPlayer::resetPipeline()
 {
     SAPLOG_WARNING("Resetting Pipeline...player id %d\n",getObjectIdentifier());
+    if(m_mixerPad)
+    {
+        SharedMixer::instance()->stop(m_mixerPad);
+    }
 
     // Detect pipe line error and destroy the pipeline if any
     if(state == PLAYBACKERROR) 
@@ -683,7 +942,12 @@ void AudioPlayer::destroyPipeline()
 {
     SAPLOG_WARNING("SAP: Destroying Pipeline...Player id %d\n",getObjectIdentifier());
 
-    if(m_pipeline) {
+    if(m_mixerPad) {
+        //The mixer owns the bin
+        SharedMixer::instance()->detach(m_mixerPad);
+        m_mixerPad = NULL;
+    }
+    else if(m_pipeline) {
         gst_element_set_state(m_pipeline, GST_STATE_NULL);
         waitForStatus(GST_STATE_NULL, 200);
         gst_object_unref(m_pipeline);
@@ -706,19 +970,25 @@ void AudioPlayer::Play(std::string url)
         SAPLOG_INFO("SAP: PLAYING GLOBAL primary Volume=%d player Volume=%d",m_primVolume  , m_thisVolume ); 
         //TODO setAppSysPlayingSate(true)
         gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+        if(m_mixerPad)
+        {
+            SharedMixer::instance()->start(m_mixerPad, false);
+        }
     }    
 }
    
-void AudioPlayer::PlayBuffer(const char *data,int length)
+bool AudioPlayer::PlayBuffer(const char *data,int length)
 {  
     std::lock_guard<std::mutex> lock(m_apiMutex);
     SAPLOG_INFO("SAP: AudioPlayer PlayBuffer invoked Playerid %d\n",getObjectIdentifier());
+    bool ret = true;
     if(m_pipeline)
     {
         if(state != PLAYING)
             gst_element_set_state(m_pipeline, GST_STATE_PLAYING);      
-        push_data(data,length);
+        ret = push_data(data,length);
     }
+    return ret;
 }
 
 bool AudioPlayer::Pause()
@@ -736,6 +1006,10 @@ bool AudioPlayer::Pause()
                 m_isPaused = true;
                 SAPLOG_INFO("SAP: AudioPlayer Pause invoked\n");
                 gst_element_set_state(m_pipeline, GST_STATE_PAUSED);
+                if(m_mixerPad)
+                {
+                    SharedMixer::instance()->stop(m_mixerPad);
+                }
                 return true;
             } 
         }
@@ -749,15 +1023,25 @@ void AudioPlayer::Stop()
     std::lock_guard<std::mutex> lock(m_apiMutex);
     if(sourceType == DATA || sourceType == WEBSOCKET )
     {
-        if(webClient != NULL)
+        WebSocketClient *client = NULL;
         {
-            webClient->disconnect();
-            delete webClient;
+            std::lock_guard<std::mutex> wsLock(m_wsMutex);
+            client = webClient;
             webClient = NULL;
         }
+        if(client != NULL)
+        {
+            client->disconnect();
+            delete client;
+        }
 
         appsrc_firstpacket = true;
         bufferQueue->clear();
+        {
+            std::lock_guard<std::mutex> queueLock(m_queueMutex);
+            m_appsrcEnough = false;
+            m_condition.notify_all();
+        }
 	SAPLOG_INFO("size of Buffer queue after clear %d\n",bufferQueue->count());
 	  
     }
@@ -776,6 +1060,10 @@ bool AudioPlayer::Resume()
             if(m_isPaused && state == PAUSED)
             {
                 SAPLOG_INFO("SAP: AudioPlayer Resume invoked\n");
+                if(m_mixerPad)
+                {
+                    SharedMixer::instance()->start(m_mixerPad, true);
+                }
                 gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
                 return true;
             } 
@@ -892,6 +1180,12 @@ void AudioPlayer::setPrimaryVolume( int primVol)
 void AudioPlayer::setVolume( int thisVol)
 {
     SAPLOG_INFO(" Prev Player Volume=%d cur Vol=%d",m_prevThisVolume , thisVol );
+    if(m_mixerPad)
+    {
+        //Volume of the mixer input, the sink is shared
+        SharedMixer::instance()->setVolume(m_mixerPad, thisVol);
+        return;
+    }
 #ifdef PLATFORM_AMLOGIC
     if(audioType == PCM || audioType == WAV)
     {
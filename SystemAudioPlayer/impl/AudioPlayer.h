@@ -5,6 +5,7 @@
 #include <string>
 #include "BufferQueue.h"
 #include "WebSocketClient.h"
+#include "SharedMixer.h"
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -22,6 +23,8 @@ public:
     SAPEventCallback() {}
     virtual ~SAPEventCallback() {}
     virtual void onSAPEvent(uint32_t id,std::string message) { (void)id; }
+    // Events of the appsrc feed, with the current queue depth (packets) and the running counters
+    virtual void onSAPQueueEvent(uint32_t id,std::string message,int depth,unsigned int underruns,unsigned int dropped) { (void)depth; (void)underruns; (void)dropped; onSAPEvent(id,message); }
 };
 
 enum AudioType
@@ -70,6 +73,8 @@ class AudioPlayer
     GstElement  *m_audioSink;
     GstElement  *m_audioVolume;
     GstElement  *m_capsfilter;
+    GstPad      *m_mixerPad; //input of the shared mixer, NULL with a pipeline of its own
+    static bool m_useSharedMixer;
     int m_primVolume;
     int m_prevPrimVolume; 
     int m_thisVolume; //Player Volume
@@ -81,9 +86,15 @@ class AudioPlayer
     std::atomic<bool> m_isPaused;
     bool m_running;
     std::atomic<bool> appsrc_firstpacket;    
+    std::atomic<bool> m_appsrcEnough; //appsrc queue is full, hold packets in bufferQueue
+    std::atomic<unsigned int> m_underruns;
+    bool m_underrun;
+    guint64 m_pushedBytes; //PCM sent to appsrc, timestamps for the shared mixer
+    int m_frameBytes;
     std::mutex m_queueMutex;
     std::mutex m_playMutex;
     std::mutex m_apiMutex;
+    std::mutex m_wsMutex; //webClient, for the queue watermarks
     std::condition_variable m_condition;
     std::string m_url;
     guint       m_busWatch;  
@@ -111,6 +122,7 @@ class AudioPlayer
     int  m_Rate;
     int  m_Channels;    
     void createPipeline();
+    bool createMixerInput();
     void resetPipeline();
     void destroyPipeline();
 #if defined(PLATFORM_AMLOGIC)
@@ -127,7 +139,8 @@ class AudioPlayer
     AudioPlayer(AudioType,SourceType,PlayMode,int objectIdentifier);
     ~AudioPlayer();
     void Play(std::string url);
-    void PlayBuffer(const char*,int);
+    //False if the queue is full, the data was not taken
+    bool PlayBuffer(const char*,int);
     bool Resume();
     bool Pause();
     void Stop();
@@ -135,14 +148,21 @@ class AudioPlayer
     AudioType getAudioType();
     PlayMode  getPlayMode();
     SourceType getSourceType();
-    void push_data(const void *ptr,int length);
+    bool push_data(const void *ptr,int length);
+    //Packets filled in place by the source, push_buffer takes it over, false if it was dropped
+    Buffer* newBuffer();
+    bool push_buffer(Buffer *buffer);
     void wsConnectionStatus(WSStatus status);
     bool handleMessage(GstMessage*);
     gboolean PushDataAppSrc();
     static void Init(SAPEventCallback *callback);
     static void DeInit();
+    static void setSharedMixer(bool shared);
     static int GstBusCallback(GstBus *bus, GstMessage *message, gpointer data); 
     static void event_loop();
+    static void appsrcNeedData(GstElement *appsrc, guint length, gpointer data);
+    static void appsrcEnoughData(GstElement *appsrc, gpointer data);
+    void queueEvent(const char *event);
     int getObjectIdentifier();
     std::string getUrl();
     bool isPlaying();
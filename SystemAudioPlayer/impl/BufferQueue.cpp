@@ -1,11 +1,88 @@
 #include "BufferQueue.h"
 #include <cstring>
+#include <errno.h>
+
+#define BUFFER_POOL_MAX_BLOCKS 64
+
+BufferPool::BufferPool(size_t blockSize, size_t maxBlocks)
+    : m_blockSize(blockSize)
+    , m_maxBlocks(maxBlocks)
+    , m_allocated(0)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+BufferPool::~BufferPool()
+{
+    for(size_t i = 0; i < m_free.size(); i++)
+    {
+        delete[] m_free[i];
+    }
+    pthread_mutex_destroy(&m_mutex);
+}
+
+char* BufferPool::acquire(size_t len)
+{
+    char *block = NULL;
+    if(len > m_blockSize)
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&m_mutex);
+    if(!m_free.empty())
+    {
+        block = m_free.back();
+        m_free.pop_back();
+    }
+    else if(m_allocated < m_maxBlocks)
+    {
+        block = new char[m_blockSize];
+        m_allocated++;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return block;
+}
+
+void BufferPool::release(char *block)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_free.push_back(block);
+    pthread_mutex_unlock(&m_mutex);
+}
 
 void Buffer::fillBuffer(const void *ptr,int len)
 {
-    this->length = len;
-    buff = new char[length];
-    std::memcpy(buff,ptr,length);
+    reserve(len);
+    append(ptr,len);
+}
+
+void Buffer::reserve(int cap)
+{
+    deleteBuffer();
+    length = 0;
+    capacity = cap;
+    buff = pool ? pool->acquire(capacity) : NULL;
+    pooled = (buff != NULL);
+    if(!pooled)
+    {
+        buff = new char[capacity];
+    }
+}
+
+int Buffer::append(const void *ptr,int len)
+{
+    if(len > capacity - length)
+    {
+        len = capacity - length;
+    }
+    std::memcpy(buff + length,ptr,len);
+    length += len;
+    return len;
+}
+
+bool Buffer::isFull()
+{
+    return length == capacity;
 }
 
 int Buffer::getLength()
@@ -23,102 +100,160 @@ void Buffer::deleteBuffer()
     SAPLOG_TRACE("SAP: delete Buffer..."); 
     if(buff != NULL)
     {
-       delete[] buff;
+       if(pooled)
+           pool->release(buff);
+       else
+           delete[] buff;
        buff = NULL;
     }
 }
 
+void Buffer::ref()
+{
+    refs++;
+}
+
+void Buffer::unref()
+{
+    if(--refs == 0)
+    {
+        deleteBuffer();
+        delete this;
+    }
+}
+
 BufferQueue::BufferQueue(int size)
+    : m_ring(size + 1, NULL)
+    , m_head(0)
+    , m_tail(0)
+    , m_dropped(0)
+    , m_lowWatermark(0)
+    , m_highWatermark(size)
+    , m_enough(false)
 {
-    pthread_mutex_init(&m_mutex, NULL);
+    pthread_mutex_init(&m_consumerMutex, NULL);
     sem_init(&m_sem_full,0,0);
-    sem_init(&m_sem_empty,0,size);
+    m_pool = std::make_shared<BufferPool>(BUFFER_POOL_BLOCK_SIZE, BUFFER_POOL_MAX_BLOCKS);
+}
+
+Buffer* BufferQueue::newBuffer()
+{
+    return new Buffer(m_pool);
 }
 
 BufferQueue::~BufferQueue()
 {
-    pthread_mutex_destroy(&m_mutex);
-    sem_destroy(&m_sem_empty);
+    m_watermarkCallback = nullptr;
+    clear();
+    pthread_mutex_destroy(&m_consumerMutex);
     sem_destroy(&m_sem_full);
 }
+
+void BufferQueue::setWatermarks(int low, int high, WatermarkCallback callback)
+{
+    m_lowWatermark = low;
+    m_highWatermark = high;
+    m_watermarkCallback = callback;
+}
+
 void BufferQueue::preDelete()
 {
     clear();
     sem_post(&m_sem_full);           
 }
 
-void BufferQueue::add(Buffer *data)
+bool BufferQueue::add(Buffer *data)
 {
-    sem_wait(&m_sem_empty);
-    pthread_mutex_lock(&m_mutex);
-    m_buffer.push(data);
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % m_ring.size();
+
+    if(data == NULL || next == m_head.load(std::memory_order_acquire))
+    {
+        m_dropped++;
+        if(data != NULL)
+            data->unref();
+        return false;
+    }
+    m_ring[tail] = data;
+    m_tail.store(next, std::memory_order_release);
     sem_post(&m_sem_full);
-    pthread_mutex_unlock(&m_mutex);
+
+    checkWatermarks(count());
+    return true;
 }
 
 int BufferQueue::count()
 {
-    int count;
-    pthread_mutex_lock(&m_mutex);
-    //count = m_buffer.size();
-    sem_getvalue(&m_sem_full,&count); 
-    pthread_mutex_unlock(&m_mutex);
-    return count;
+    size_t head = m_head.load(std::memory_order_acquire);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    return (int)((tail + m_ring.size() - head) % m_ring.size());
+}
+
+unsigned int BufferQueue::dropped()
+{
+    return m_dropped;
 }
 
 void BufferQueue::clear()
 {
-    Buffer *item;
-    int value;
-    pthread_mutex_lock(&m_mutex);
-    while(!m_buffer.empty())
+    pthread_mutex_lock(&m_consumerMutex);
+    size_t head = m_head.load(std::memory_order_relaxed);
+    while(head != m_tail.load(std::memory_order_acquire))
     {
-        item = m_buffer.front();
-        m_buffer.pop();
-        item->deleteBuffer();
-	delete item;
-        sem_getvalue(&m_sem_full,&value);
-        if(value != 0)
-            sem_wait(&m_sem_full);
-        sem_post(&m_sem_empty);
+        m_ring[head]->unref();
+        m_ring[head] = NULL;
+        head = (head + 1) % m_ring.size();
+        m_head.store(head, std::memory_order_release);
+        sem_trywait(&m_sem_full);
     }
-    pthread_mutex_unlock(&m_mutex);
+    pthread_mutex_unlock(&m_consumerMutex);
+    checkWatermarks(count());
 }
 
 bool BufferQueue::isFull()
 {
-    int value;
-    sem_getvalue(&m_sem_empty,&value);
-    if(value == 0)
-    {
-       return true;
-    }
-    return false;
+    size_t next = (m_tail.load(std::memory_order_relaxed) + 1) % m_ring.size();
+    return (next == m_head.load(std::memory_order_acquire));
 }
 
 bool BufferQueue::isEmpty()
 {
-    pthread_mutex_lock(&m_mutex);
-    if(m_buffer.empty())
-    {
-       pthread_mutex_unlock(&m_mutex);
-       return true;
-    }  
-    pthread_mutex_unlock(&m_mutex);
-    return false;
+    return (m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire));
 }
 
 Buffer* BufferQueue::remove()
 {
     Buffer *item = NULL;
-    sem_wait(&m_sem_full);
-    pthread_mutex_lock(&m_mutex);
-    if(!m_buffer.empty())
+    while(sem_wait(&m_sem_full) != 0 && errno == EINTR);
+    pthread_mutex_lock(&m_consumerMutex);
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if(head != m_tail.load(std::memory_order_acquire))
     {
-        item = m_buffer.front();
-        m_buffer.pop();
-        sem_post(&m_sem_empty);
+        item = m_ring[head];
+        m_ring[head] = NULL;
+        m_head.store((head + 1) % m_ring.size(), std::memory_order_release);
+    }
+    pthread_mutex_unlock(&m_consumerMutex);
+    if(item != NULL)
+    {
+        checkWatermarks(count());
     }
-    pthread_mutex_unlock(&m_mutex);
     return item;
 }
+
+void BufferQueue::checkWatermarks(int depth)
+{
+    if(!m_watermarkCallback)
+    {
+        return;
+    }
+    bool enough = m_enough.load();
+    if(!enough && depth >= m_highWatermark && m_enough.compare_exchange_strong(enough, true))
+    {
+        m_watermarkCallback(true, depth);
+    }
+    else if(enough && depth <= m_lowWatermark && m_enough.compare_exchange_strong(enough, false))
+    {
+        m_watermarkCallback(false, depth);
+    }
+}
@@ -5,41 +5,107 @@
 #include <semaphore.h>
 #include <stdlib.h>
 #include <cstring>
+#include <functional>
 #include <queue>
+#include <vector>
+#include <memory>
+#include <atomic>
 #include <stdio.h>
 #include <unistd.h>
 #include "logger.h"
 
+//Size of a pooled block, the longest packet that goes without a heap allocation
+#define BUFFER_POOL_BLOCK_SIZE (32 * 1024)
+
+// Fixed size blocks for the packets of a player, kept for reuse once released
+// instead of a heap allocation per packet. Blocks are allocated on first use,
+// at most maxBlocks of them; bigger packets, or more of them, use the heap.
+class BufferPool
+{
+    public:
+    BufferPool(size_t blockSize, size_t maxBlocks);
+    ~BufferPool();
+    char *acquire(size_t len);
+    void release(char *block);
+
+    private:
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    pthread_mutex_t m_mutex;
+    std::vector<char*> m_free;
+    size_t m_blockSize;
+    size_t m_maxBlocks;
+    size_t m_allocated;
+};
+
+// A packet, reference counted once it is handed on to GStreamer without a copy.
+// The pool stays alive as long as any of its blocks is in use.
 struct Buffer
 {
-    Buffer()
+    Buffer() : buff(NULL), length(0), capacity(0), refs(1), pooled(false)
+    {
+    }
+    Buffer(const std::shared_ptr<BufferPool> &pool) : buff(NULL), length(0), capacity(0), refs(1), pooled(false), pool(pool)
     {
     }
     void fillBuffer(const void *ptr,int len);
+    //Empty packet to be filled in place with append, up to cap bytes
+    void reserve(int cap);
+    //Bytes taken, less than len once the packet is full
+    int append(const void *ptr,int len);
+    bool isFull();
     int getLength();
     char *getBuffer();   
     void deleteBuffer();
+    void ref();
+    void unref();
     char *buff;
     int length;
+    int capacity;
+    std::atomic<int> refs;
+    bool pooled;
+    std::shared_ptr<BufferPool> pool;
 };
 
+// Bounded single producer (the data source) / single consumer (the appsrc feeder)
+// ring. The producer never takes a lock or blocks, a packet that does not fit is
+// dropped and counted. The consumer is woken through a semaphore; the consumer
+// side is serialized with clear(), which may be called from any thread.
 class BufferQueue
 {
     public:
-    void add(Buffer* item);
+    // enough is true once the queue is filled up to the high watermark, false once
+    // it drained down to the low watermark again. Called on the producer/consumer thread.
+    typedef std::function<void(bool enough, int depth)> WatermarkCallback;
+
+    // Takes over the item, false if it was dropped. NULL only counts a dropped packet.
+    bool add(Buffer* item);
     Buffer* remove();
     BufferQueue(int);
+    Buffer* newBuffer();
+    void setWatermarks(int low, int high, WatermarkCallback callback);
     bool isEmpty();
     bool isFull();
     void clear();
     void preDelete();
     int count();
+    unsigned int dropped();
     ~BufferQueue();
 
     private:
-    std::queue<Buffer*> m_buffer;
-    pthread_mutex_t m_mutex;
+    void checkWatermarks(int depth);
+
+    std::vector<Buffer*> m_ring;
+    std::atomic<size_t> m_head; // next to remove, written by the consumer
+    std::atomic<size_t> m_tail; // next to add, written by the producer
+    std::atomic<unsigned int> m_dropped;
+    std::shared_ptr<BufferPool> m_pool;
+    pthread_mutex_t m_consumerMutex;
     sem_t m_sem_full;
-    sem_t m_sem_empty;
+    int m_lowWatermark;
+    int m_highWatermark;
+    std::atomic<bool> m_enough;
+    WatermarkCallback m_watermarkCallback;
 };
 #endif
@@ -0,0 +1,295 @@
+#include "ClipCache.h"
+#include "logger.h"
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+
+//ms, the clip pipeline renders this much after a clip is pushed
+#define SAP_CLIP_LATENCY 10
+#define SAP_CLIP_DECODE_TIMEOUT 3000
+
+ClipCache::ClipCache()
+    : m_bytes(0)
+    , m_pipeline(NULL)
+    , m_source(NULL)
+    , m_volume(NULL)
+    , m_busWatch(0)
+    , m_failed(false)
+{
+}
+
+ClipCache::~ClipCache()
+{
+    destroyPipeline();
+}
+
+bool ClipCache::preload(const std::string &url, int &durationMs, bool &cached)
+{
+    PCM pcm = load(url, cached);
+    if(!pcm)
+        return false;
+    durationMs = pcm->size() / SAP_CLIP_BYTES_PER_MS;
+
+    //Ready for the first clip, the sink is open before a key is pressed
+    std::lock_guard<std::mutex> lock(m_playMutex);
+    if(!m_pipeline)
+        createPipeline();
+    return true;
+}
+
+bool ClipCache::play(const std::string &url, int volume, int &durationMs, bool &cached)
+{
+    PCM pcm = load(url, cached);
+    if(!pcm)
+        return false;
+    durationMs = pcm->size() / SAP_CLIP_BYTES_PER_MS;
+
+    std::lock_guard<std::mutex> lock(m_playMutex);
+    if(m_failed)
+        destroyPipeline();
+    if(!m_pipeline && !createPipeline())
+        return false;
+
+    g_object_set(G_OBJECT(m_volume), "volume", (double)volume / 100, NULL);
+
+    //The PCM stays with the buffer until the sink is done with it, evicted or not
+    PCM *ref = new PCM(pcm);
+    GstBuffer *buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, (gpointer)pcm->data(), pcm->size(), 0, pcm->size(), ref, releasePCM);
+    GST_BUFFER_DURATION(buffer) = durationMs * GST_MSECOND;
+    if(gst_app_src_push_buffer(GST_APP_SRC(m_source), buffer) != GST_FLOW_OK)
+    {
+        SAPLOG_ERROR("SAP: clip pipeline does not accept %s\n", url.c_str());
+        m_failed = true;
+        return false;
+    }
+    return true;
+}
+
+ClipCache::PCM ClipCache::load(const std::string &url, bool &cached)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<std::string, Clip>::iterator it = m_clips.find(url);
+        if(it != m_clips.end())
+        {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+            cached = true;
+            return it->second.pcm;
+        }
+    }
+
+    cached = false;
+    std::shared_ptr<std::vector<char>> pcm(new std::vector<char>());
+    gint64 start = g_get_monotonic_time();
+    if(!decode(url, *pcm))
+        return PCM();
+    SAPLOG_INFO("SAP: clip %s decoded in %lld ms, %zu bytes\n", url.c_str(), (long long)((g_get_monotonic_time() - start) / 1000), pcm->size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, Clip>::iterator it = m_clips.find(url);
+    if(it != m_clips.end())
+        return it->second.pcm; //decoded twice at once, keep the first
+
+    m_lru.push_front(url);
+    Clip &clip = m_clips[url];
+    clip.pcm = pcm;
+    clip.lru = m_lru.begin();
+    m_bytes += pcm->size();
+
+    while(m_bytes > SAP_CLIP_CACHE_MAX_BYTES && m_lru.size() > 1)
+    {
+        std::map<std::string, Clip>::iterator oldest = m_clips.find(m_lru.back());
+        SAPLOG_INFO("SAP: clip %s dropped from the cache\n", oldest->first.c_str());
+        m_bytes -= oldest->second.pcm->size();
+        m_clips.erase(oldest);
+        m_lru.pop_back();
+    }
+    return pcm;
+}
+
+//uridecodebin to the clip format in an appsink, as fast as it decodes
+bool ClipCache::decode(const std::string &url, std::vector<char> &pcm)
+{
+    std::string uri = url;
+    if(!uri.empty() && uri[0] == '/')
+        uri = "file://" + uri;
+
+    GError *error = NULL;
+    GstElement *pipeline = gst_parse_launch("uridecodebin name=source ! audioconvert ! audioresample ! "
+            "capsfilter caps=\"" SAP_CLIP_CAPS "\" ! appsink name=sink sync=false", &error);
+    if(!pipeline)
+    {
+        SAPLOG_ERROR("SAP: Failed to create the clip decoder: %s\n", error ? error->message : "");
+        if(error)
+            g_error_free(error);
+        return false;
+    }
+    if(error)
+        g_error_free(error);
+
+    GstElement *source = gst_bin_get_by_name(GST_BIN(pipeline), "source");
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    g_object_set(G_OBJECT(source), "uri", uri.c_str(), NULL);
+    GstBus *bus = gst_element_get_bus(pipeline);
+
+    bool result = (gst_element_set_state(pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+    gint64 deadline = g_get_monotonic_time() + SAP_CLIP_DECODE_TIMEOUT * 1000;
+    while(result)
+    {
+        GstSample *sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink), 100 * GST_MSECOND);
+        if(sample)
+        {
+            GstMapInfo map;
+            GstBuffer *buffer = gst_sample_get_buffer(sample);
+            if(buffer && gst_buffer_map(buffer, &map, GST_MAP_READ))
+            {
+                pcm.insert(pcm.end(), (const char*)map.data, (const char*)map.data + map.size);
+                gst_buffer_unmap(buffer, &map);
+            }
+            gst_sample_unref(sample);
+            if(pcm.size() > (size_t)SAP_CLIP_MAX_MS * SAP_CLIP_BYTES_PER_MS)
+            {
+                SAPLOG_ERROR("SAP: %s is longer than %d ms, not a clip\n", url.c_str(), SAP_CLIP_MAX_MS);
+                result = false;
+            }
+            continue;
+        }
+        if(gst_app_sink_is_eos(GST_APP_SINK(sink)))
+            break;
+
+        GstMessage *message = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+        if(message)
+        {
+            GError *decodeError = NULL;
+            gchar *debug = NULL;
+            gst_message_parse_error(message, &decodeError, &debug);
+            SAPLOG_ERROR("SAP: Failed to decode %s: %s\n", url.c_str(), decodeError->message);
+            g_error_free(decodeError);
+            g_free(debug);
+            gst_message_unref(message);
+            result = false;
+        }
+        else if(g_get_monotonic_time() > deadline)
+        {
+            SAPLOG_ERROR("SAP: Decoding %s timed out\n", url.c_str());
+            result = false;
+        }
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(bus);
+    gst_object_unref(source);
+    gst_object_unref(sink);
+    gst_object_unref(pipeline);
+    return result && !pcm.empty();
+}
+
+//Caller holds m_playMutex
+bool ClipCache::createPipeline()
+{
+    SAPLOG_INFO("SAP: Creating clip pipeline\n");
+    m_failed = false;
+    m_pipeline = gst_pipeline_new("sap-clips");
+    m_source = gst_element_factory_make("appsrc", NULL);
+    m_volume = gst_element_factory_make("volume", NULL);
+#if defined(PLATFORM_AMLOGIC)
+    GstElement *convert = gst_element_factory_make("audioconvert", NULL);
+    GstElement *resample = gst_element_factory_make("audioresample", NULL);
+    GstElement *sink = gst_element_factory_make("amlhalasink", NULL);
+#else
+    GstElement *sink = gst_element_factory_make("autoaudiosink", NULL);
+#endif
+    bool result = m_pipeline && m_source && m_volume && sink;
+#if defined(PLATFORM_AMLOGIC)
+    result = result && convert && resample;
+#endif
+    if(!result)
+    {
+        SAPLOG_ERROR("SAP: Failed to create the clip pipeline elements\n");
+        GstElement *elements[] = { m_source, m_volume, sink,
+#if defined(PLATFORM_AMLOGIC)
+                convert, resample
+#endif
+        };
+        for(GstElement *element : elements)
+        {
+            if(element)
+                gst_object_unref(element);
+        }
+        m_source = m_volume = NULL;
+        destroyPipeline();
+        return false;
+    }
+
+    //Live, timestamped when pushed: a clip plays SAP_CLIP_LATENCY after it came in
+    GstCaps *caps = gst_caps_from_string(SAP_CLIP_CAPS);
+    gst_app_src_set_caps(GST_APP_SRC(m_source), caps);
+    gst_caps_unref(caps);
+    g_object_set(G_OBJECT(m_source), "format", GST_FORMAT_TIME, "is-live", TRUE, "do-timestamp", TRUE,
+            "min-latency", (gint64)(SAP_CLIP_LATENCY * GST_MSECOND), NULL);
+
+#if defined(PLATFORM_AMLOGIC)
+    g_object_set(G_OBJECT(sink), "direct-mode", FALSE, NULL);
+    gst_bin_add_many(GST_BIN(m_pipeline), m_source, m_volume, convert, resample, sink, NULL);
+    result = gst_element_link_many(m_source, m_volume, convert, resample, sink, NULL);
+#else
+    gst_bin_add_many(GST_BIN(m_pipeline), m_source, m_volume, sink, NULL);
+    result = gst_element_link_many(m_source, m_volume, sink, NULL);
+#endif
+    if(!result)
+    {
+        SAPLOG_ERROR("SAP: Failed to link the clip pipeline\n");
+        destroyPipeline();
+        return false;
+    }
+
+    GstBus *bus = gst_element_get_bus(m_pipeline);
+    m_busWatch = gst_bus_add_watch(bus, busCallback, (gpointer)(this));
+    gst_object_unref(bus);
+
+    if(gst_element_set_state(m_pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        SAPLOG_ERROR("SAP: Failed to start the clip pipeline\n");
+        destroyPipeline();
+        return false;
+    }
+    return true;
+}
+
+//Caller holds m_playMutex, or is the destructor
+void ClipCache::destroyPipeline()
+{
+    if(m_busWatch)
+    {
+        g_source_remove(m_busWatch);
+        m_busWatch = 0;
+    }
+    if(m_pipeline)
+    {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_object_unref(m_pipeline);
+    }
+    m_pipeline = NULL;
+    m_source = NULL;
+    m_volume = NULL;
+}
+
+gboolean ClipCache::busCallback(GstBus *, GstMessage *message, gpointer data)
+{
+    ClipCache *cache = (ClipCache*) data;
+    if(GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR)
+    {
+        GError *error = NULL;
+        gchar *debug = NULL;
+        gst_message_parse_error(message, &error, &debug);
+        SAPLOG_ERROR("SAP: clip pipeline error! code: %d, %s, Debug: %s", error->code, error->message, debug);
+        g_error_free(error);
+        g_free(debug);
+        cache->m_failed = true;
+    }
+    return TRUE;
+}
+
+void ClipCache::releasePCM(gpointer data)
+{
+    delete static_cast<PCM*>(data);
+}
@@ -0,0 +1,66 @@
+#ifndef CLIP_CACHE_H
+#define CLIP_CACHE_H
+
+#include <gst/gst.h>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Format clips are decoded to, and the format of the clip pipeline
+#define SAP_CLIP_CAPS "audio/x-raw,format=S16LE,rate=48000,channels=2,layout=interleaved"
+#define SAP_CLIP_BYTES_PER_MS (48 * 2 * 2)
+//Longer sounds are not clips, they are played by a player
+#define SAP_CLIP_MAX_MS 5000
+//Decoded PCM kept, the least recently played clips are dropped beyond it
+#define SAP_CLIP_CACHE_MAX_BYTES (4 * 1024 * 1024)
+
+// Short UI sounds (key clicks, navigation) decoded once into PCM held in memory, and played by
+// pushing that PCM into a live pipeline that is kept playing. A clip starts within the latency
+// of that pipeline, without the source set-up, decode and preroll a player goes through.
+// A clip that is played while another one is still playing cuts it short.
+class ClipCache
+{
+    public:
+    ClipCache();
+    ~ClipCache();
+    ClipCache(const ClipCache&) = delete;
+    ClipCache& operator=(const ClipCache&) = delete;
+
+    //Decodes the clip unless it is in the cache already
+    bool preload(const std::string &url, int &durationMs, bool &cached);
+    //Preloads the clip if it is not, volume in percentage
+    bool play(const std::string &url, int volume, int &durationMs, bool &cached);
+
+    private:
+    typedef std::shared_ptr<const std::vector<char>> PCM;
+
+    struct Clip
+    {
+        PCM pcm;
+        std::list<std::string>::iterator lru;
+    };
+
+    PCM load(const std::string &url, bool &cached);
+    static bool decode(const std::string &url, std::vector<char> &pcm);
+    bool createPipeline();
+    void destroyPipeline();
+    static gboolean busCallback(GstBus *bus, GstMessage *message, gpointer data);
+    static void releasePCM(gpointer data);
+
+    std::mutex m_mutex;
+    std::map<std::string, Clip> m_clips;
+    std::list<std::string> m_lru;      //most recently played first
+    size_t m_bytes;
+
+    std::mutex m_playMutex;
+    GstElement *m_pipeline;
+    GstElement *m_source;
+    GstElement *m_volume;
+    guint m_busWatch;
+    std::atomic<bool> m_failed;        //rebuilt on the next play
+};
+#endif
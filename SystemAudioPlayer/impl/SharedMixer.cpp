@@ -0,0 +1,325 @@
+#include "SharedMixer.h"
+#include "logger.h"
+
+//ms, time the mixer gives an input to deliver before it mixes without it
+#define SAP_MIXER_LATENCY 40
+//ms, an input that starts is mixed in this much after the current running time
+#define SAP_MIXER_START_DELAY 20
+
+SharedMixer* SharedMixer::m_instance = NULL;
+std::mutex SharedMixer::m_instanceMutex;
+
+SharedMixer::SharedMixer()
+    : m_pipeline(NULL)
+    , m_mixer(NULL)
+    , m_busWatch(0)
+{
+}
+
+SharedMixer::~SharedMixer()
+{
+    if(m_busWatch)
+    {
+        g_source_remove(m_busWatch);
+    }
+    if(m_pipeline)
+    {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_object_unref(m_pipeline);
+    }
+}
+
+SharedMixer* SharedMixer::instance()
+{
+    std::lock_guard<std::mutex> lock(m_instanceMutex);
+    if(!m_instance)
+    {
+        m_instance = new SharedMixer();
+        if(!m_instance->create())
+        {
+            delete m_instance;
+            m_instance = NULL;
+        }
+    }
+    return m_instance;
+}
+
+void SharedMixer::destroy()
+{
+    std::lock_guard<std::mutex> lock(m_instanceMutex);
+    if(m_instance)
+    {
+        if(!m_instance->m_inputs.empty())
+        {
+            SAPLOG_WARNING("SAP: shared mixer still has %zu inputs, kept\n", m_instance->m_inputs.size());
+            return;
+        }
+        delete m_instance;
+        m_instance = NULL;
+    }
+}
+
+bool SharedMixer::create()
+{
+    SAPLOG_INFO("SAP: Creating shared mixer pipeline\n");
+    m_pipeline = gst_pipeline_new("sap-mixer");
+    GstElement *silence = gst_element_factory_make("audiotestsrc", NULL);
+    m_mixer = gst_element_factory_make("audiomixer", NULL);
+    GstElement *capsfilter = gst_element_factory_make("capsfilter", NULL);
+    GstElement *convert = gst_element_factory_make("audioconvert", NULL);
+    GstElement *resample = gst_element_factory_make("audioresample", NULL);
+#if defined(PLATFORM_AMLOGIC)
+    GstElement *sink = gst_element_factory_make("amlhalasink", NULL);
+#else
+    GstElement *sink = gst_element_factory_make("autoaudiosink", NULL);
+#endif
+    if(!m_pipeline || !silence || !m_mixer || !capsfilter || !convert || !resample || !sink)
+    {
+        SAPLOG_ERROR("SAP: Failed to create the shared mixer elements\n");
+        GstElement *elements[] = { silence, m_mixer, capsfilter, convert, resample, sink };
+        for(GstElement *element : elements)
+        {
+            if(element)
+                gst_object_unref(element);
+        }
+        m_mixer = NULL;
+        return false;
+    }
+
+    //Live silence, the mixer produces on the clock whether inputs are playing or not
+    g_object_set(G_OBJECT(silence), "wave", 4, "is-live", TRUE, NULL);
+    g_object_set(G_OBJECT(m_mixer), "latency", (guint64)(SAP_MIXER_LATENCY * GST_MSECOND), NULL);
+    GstCaps *caps = gst_caps_from_string(SAP_MIXER_CAPS);
+    g_object_set(G_OBJECT(capsfilter), "caps", caps, NULL);
+    gst_caps_unref(caps);
+#if defined(PLATFORM_AMLOGIC)
+    g_object_set(G_OBJECT(sink), "direct-mode", FALSE, NULL);
+#endif
+
+    gst_bin_add_many(GST_BIN(m_pipeline), silence, m_mixer, capsfilter, convert, resample, sink, NULL);
+    if(!gst_element_link_many(silence, m_mixer, capsfilter, convert, resample, sink, NULL))
+    {
+        SAPLOG_ERROR("SAP: Failed to link the shared mixer\n");
+        return false;
+    }
+
+    GstBus *bus = gst_element_get_bus(m_pipeline);
+    m_busWatch = gst_bus_add_watch(bus, busCallback, (gpointer)(this));
+    gst_object_unref(bus);
+
+    if(gst_element_set_state(m_pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        SAPLOG_ERROR("SAP: Failed to start the shared mixer\n");
+        return false;
+    }
+    return true;
+}
+
+bool SharedMixer::attach(GstElement *bin, bool ducking, const Handler &handler, GstPad *&pad)
+{
+    GstPad *src = gst_element_get_static_pad(bin, "src");
+    if(!src)
+    {
+        SAPLOG_ERROR("SAP: shared mixer input without src pad\n");
+        return false;
+    }
+    pad = gst_element_get_request_pad(m_mixer, "sink_%u");
+    if(!pad)
+    {
+        SAPLOG_ERROR("SAP: shared mixer has no pad for another input\n");
+        gst_object_unref(src);
+        return false;
+    }
+
+    Input *input = new Input();
+    input->bin = bin;
+    input->src = src;
+    input->ducking = ducking;
+    input->active = false;
+    input->volume = 100;
+    input->handler = handler;
+    input->position = 0;
+    gst_segment_init(&input->segment, GST_FORMAT_TIME);
+
+    gst_object_ref(bin);
+    gst_bin_add(GST_BIN(m_pipeline), bin);
+    if(gst_pad_link(src, pad) != GST_PAD_LINK_OK)
+    {
+        SAPLOG_ERROR("SAP: Failed to link the input to the shared mixer\n");
+        gst_bin_remove(GST_BIN(m_pipeline), bin);
+        gst_element_release_request_pad(m_mixer, pad);
+        gst_object_unref(pad);
+        gst_object_unref(src);
+        delete input;
+        pad = NULL;
+        return false;
+    }
+    gst_object_unref(bin);
+    input->probe = gst_pad_add_probe(src, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM), inputProbe, input, NULL);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_inputs[pad] = input;
+    update();
+    SAPLOG_INFO("SAP: shared mixer input added, %zu inputs\n", m_inputs.size());
+    return true;
+}
+
+void SharedMixer::detach(GstPad *pad)
+{
+    Input *input = NULL;
+    {
+        std::lock_guard<std::recursive_mutex> dispatch(m_dispatchMutex);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<GstPad*, Input*>::iterator it = m_inputs.find(pad);
+        if(it == m_inputs.end())
+            return;
+        input = it->second;
+        m_inputs.erase(it);
+        update();
+    }
+
+    gst_pad_remove_probe(input->src, input->probe);
+    gst_element_set_state(input->bin, GST_STATE_NULL);
+    gst_pad_unlink(input->src, pad);
+    gst_element_release_request_pad(m_mixer, pad);
+    gst_object_unref(pad);
+    gst_object_unref(input->src);
+    gst_bin_remove(GST_BIN(m_pipeline), input->bin);
+    SAPLOG_INFO("SAP: shared mixer input removed\n");
+    delete input;
+}
+
+void SharedMixer::start(GstPad *pad, bool resume)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<GstPad*, Input*>::iterator it = m_inputs.find(pad);
+    if(it == m_inputs.end())
+        return;
+
+    //Buffers come with the running time of their stream, move them to now on the mixer
+    gint64 offset = (gint64)runningTime() + SAP_MIXER_START_DELAY * GST_MSECOND;
+    if(resume)
+        offset -= (gint64)it->second->position.load();
+    gst_pad_set_offset(pad, offset);
+
+    it->second->active = true;
+    update();
+}
+
+void SharedMixer::stop(GstPad *pad)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<GstPad*, Input*>::iterator it = m_inputs.find(pad);
+    if(it != m_inputs.end() && it->second->active)
+    {
+        it->second->active = false;
+        update();
+    }
+}
+
+void SharedMixer::setVolume(GstPad *pad, int volume)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<GstPad*, Input*>::iterator it = m_inputs.find(pad);
+    if(it != m_inputs.end())
+    {
+        it->second->volume = volume;
+        update();
+    }
+}
+
+//Caller holds m_mutex
+void SharedMixer::update()
+{
+    bool ducked = false;
+    for(std::map<GstPad*, Input*>::iterator it = m_inputs.begin(); it != m_inputs.end(); ++it)
+        ducked = ducked || (it->second->ducking && it->second->active);
+
+    for(std::map<GstPad*, Input*>::iterator it = m_inputs.begin(); it != m_inputs.end(); ++it)
+    {
+        double volume = (double)it->second->volume / 100;
+        if(ducked && !it->second->ducking)
+            volume = volume * SAP_MIXER_DUCK_LEVEL / 100;
+        g_object_set(G_OBJECT(it->first), "volume", volume, NULL);
+    }
+}
+
+GstClockTime SharedMixer::runningTime()
+{
+    GstClock *clock = gst_element_get_clock(m_pipeline);
+    if(!clock)
+        return 0;
+    GstClockTime now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+    GstClockTime base = gst_element_get_base_time(m_pipeline);
+    return now > base ? now - base : 0;
+}
+
+GstPadProbeReturn SharedMixer::inputProbe(GstPad *, GstPadProbeInfo *info, gpointer data)
+{
+    Input *input = (Input*) data;
+    if(info->type & GST_PAD_PROBE_TYPE_BUFFER)
+    {
+        GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        if(GST_BUFFER_PTS_IS_VALID(buffer))
+        {
+            GstClockTime end = GST_BUFFER_PTS(buffer);
+            if(GST_BUFFER_DURATION_IS_VALID(buffer))
+                end += GST_BUFFER_DURATION(buffer);
+            guint64 position = gst_segment_to_running_time(&input->segment, GST_FORMAT_TIME, end);
+            if(GST_CLOCK_TIME_IS_VALID(position))
+                input->position = position;
+        }
+    }
+    else if(info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
+    {
+        GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+        if(GST_EVENT_TYPE(event) == GST_EVENT_SEGMENT)
+        {
+            gst_event_copy_segment(event, &input->segment);
+        }
+        else if(GST_EVENT_TYPE(event) == GST_EVENT_EOS)
+        {
+            //An EOS would end the mixer pad for good, the player hears of it instead
+            gst_element_post_message(input->bin, gst_message_new_application(GST_OBJECT(input->bin), gst_structure_new_empty(SAP_MIXER_EOS)));
+            return GST_PAD_PROBE_DROP;
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+gboolean SharedMixer::busCallback(GstBus *, GstMessage *message, gpointer data)
+{
+    SharedMixer *mixer = (SharedMixer*) data;
+    std::lock_guard<std::recursive_mutex> dispatch(mixer->m_dispatchMutex);
+
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(mixer->m_mutex);
+        GstObject *source = GST_MESSAGE_SRC(message);
+        for(std::map<GstPad*, Input*>::iterator it = mixer->m_inputs.begin(); it != mixer->m_inputs.end(); ++it)
+        {
+            GstObject *bin = GST_OBJECT(it->second->bin);
+            if(source == bin || gst_object_has_as_ancestor(source, bin))
+            {
+                handler = it->second->handler;
+                break;
+            }
+        }
+    }
+
+    if(handler)
+    {
+        handler(message);
+    }
+    else if(GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR)
+    {
+        GError *error = NULL;
+        gchar *debug = NULL;
+        gst_message_parse_error(message, &error, &debug);
+        SAPLOG_ERROR("SAP: shared mixer error! code: %d, %s, Debug: %s", error->code, error->message, debug);
+        g_error_free(error);
+        g_free(debug);
+    }
+    return TRUE;
+}
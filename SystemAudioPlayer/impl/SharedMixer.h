@@ -0,0 +1,74 @@
+#ifndef SHARED_MIXER_H
+#define SHARED_MIXER_H
+
+#include <gst/gst.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+//Format everything is mixed in, converted once for the sink
+#define SAP_MIXER_CAPS "audio/x-raw,format=S16LE,rate=48000,channels=2,layout=interleaved"
+//in Percentage of the player volume, the other inputs while a ducking input plays
+#define SAP_MIXER_DUCK_LEVEL 30
+//Posted by an input bin when its stream ended, the mixer itself never sees the EOS
+#define SAP_MIXER_EOS "sap-mixer-eos"
+
+// One long-lived pipeline the players feed instead of each building its own:
+//   audiotestsrc (live silence) -> audiomixer -> capsfilter -> audioconvert -> audioresample -> sink
+// A player adds a bin with its source chain, linked to a request pad of the mixer that carries
+// the volume of the player. The silence keeps the mixer running, so inputs come and go without
+// a state change of the pipeline or a stall of the other inputs. Messages of an input bin go to
+// the handler of its player, on the main loop like those of a pipeline of its own.
+class SharedMixer
+{
+    public:
+    typedef std::function<bool(GstMessage*)> Handler;
+
+    //Created with the first input, NULL if the pipeline can not be built
+    static SharedMixer* instance();
+    static void destroy();
+
+    //Takes the bin, ducking inputs lower the others while they play (TTS over UI sounds)
+    bool attach(GstElement *bin, bool ducking, const Handler &handler, GstPad *&pad);
+    void detach(GstPad *pad);
+    //The input plays from the start of its stream, or on from where it stopped
+    void start(GstPad *pad, bool resume);
+    void stop(GstPad *pad);
+    void setVolume(GstPad *pad, int volume);
+
+    private:
+    struct Input
+    {
+        GstElement *bin;
+        GstPad *src;
+        gulong probe;
+        bool ducking;
+        bool active;
+        int volume;
+        Handler handler;
+        GstSegment segment;                 //streaming thread only
+        std::atomic<guint64> position;      //running time of the end of the last buffer
+    };
+
+    SharedMixer();
+    ~SharedMixer();
+    SharedMixer(const SharedMixer&) = delete;
+    SharedMixer& operator=(const SharedMixer&) = delete;
+
+    bool create();
+    void update();
+    GstClockTime runningTime();
+    static GstPadProbeReturn inputProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+    static gboolean busCallback(GstBus *bus, GstMessage *message, gpointer data);
+
+    static SharedMixer *m_instance;
+    static std::mutex m_instanceMutex;
+    std::mutex m_mutex;
+    std::recursive_mutex m_dispatchMutex;  //held while a handler runs, detach waits for it
+    GstElement *m_pipeline;
+    GstElement *m_mixer;
+    guint m_busWatch;
+    std::map<GstPad*, Input*> m_inputs;
+};
+#endif
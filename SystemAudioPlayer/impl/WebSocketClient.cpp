@@ -4,7 +4,6 @@
 #include <cstring>
 #include <chrono>
 
-#define MAX_RX_BUFFER_BYTES (10*1024*1024)
 
 static WebSocketClient *currentClientWorker = nullptr;
 
@@ -41,6 +40,13 @@ static int WebsocketEventCallback( struct lws *wsi,
         }
         break;
 
+    case LWS_CALLBACK_EVENT_WAIT_CANCELLED:
+        if (currentClientWorker)
+        {
+            currentClientWorker->updateRxFlow();
+        }
+        break;
+
     case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
         SAPLOG_INFO("SAP: Websocket Connection Error");
         if (currentClientWorker)
@@ -52,7 +58,7 @@ static int WebsocketEventCallback( struct lws *wsi,
     case LWS_CALLBACK_CLIENT_RECEIVE:
         if (currentClientWorker)
         {
-            currentClientWorker->onNewData(inData, dataLen);
+            currentClientWorker->onNewData(wsi, inData, dataLen);
         }
         break;
 
@@ -70,7 +76,7 @@ WebSocketClient::WebSocketClient(AudioPlayer *player)
     : m_player(player), m_webSocket(nullptr), m_webSocketProtocols(nullptr),
       m_webSocketContext(nullptr), m_remotePort(40001),
       m_wsThreadID(), m_wsThreadStarted(false), m_wsThreadRun(false),
-      m_isConnected(false)
+      m_isConnected(false), m_rxHold(false), m_rxHeld(false), m_packet(nullptr)
 {    
     SAPLOG_INFO("SAP: Websocket Constructor invoked");
 }
@@ -78,6 +84,10 @@ WebSocketClient::WebSocketClient(AudioPlayer *player)
 WebSocketClient::~WebSocketClient()
 {     
     disconnect();
+    if (m_packet)
+    {
+        m_packet->unref();
+    }
     SAPLOG_INFO("SAP: Websocket Destructor");
 }
 
@@ -114,6 +124,7 @@ bool WebSocketClient::connect(const std::string &uri)
         SAPLOG_ERROR("SAP: Websocket WSI Error");
         return false;
     }
+    m_webSocket = wsi;
 
     assert(!m_wsThreadStarted);
     m_wsThreadRun = true;
@@ -178,12 +189,15 @@ void WebSocketClient::runWebsocketService()
     while(m_wsThreadRun)
     {
         lws_service(m_webSocketContext, 250);
+        updateRxFlow();
     }
 
     if (m_webSocketContext)
     {
         lws_context_destroy(m_webSocketContext);
+        m_webSocketContext = nullptr;
     }
+    m_webSocket = nullptr;
 
     if(m_webSocketProtocols)
     {
@@ -194,9 +208,70 @@ void WebSocketClient::runWebsocketService()
     SAPLOG_INFO("SAP: Websocket thread exited");
 }
 
-void WebSocketClient::onNewData(const void *ptr, size_t len) const
+// Frames are written straight into pooled packets of the player queue, the fragments of a
+// frame one after the other, instead of a packet per fragment. A packet goes to the queue
+// once it is full or the frame is complete.
+void WebSocketClient::onNewData(lws *wsi, const void *ptr, size_t len)
+{
+    const char *data = (const char *)ptr;
+    while (len > 0)
+    {
+        if (!m_packet)
+        {
+            m_packet = m_player->newBuffer();
+            m_packet->reserve(BUFFER_POOL_BLOCK_SIZE);
+        }
+        int taken = m_packet->append(data, len);
+        data += taken;
+        len -= taken;
+        if (m_packet->isFull())
+        {
+            flushPacket();
+        }
+    }
+
+    if (lws_is_final_fragment(wsi) && lws_remaining_packet_payload(wsi) == 0)
+    {
+        flushPacket();
+    }
+}
+
+void WebSocketClient::flushPacket()
 {
-    m_player->push_data(ptr, len);
+    if (m_packet)
+    {
+        if (m_packet->getLength() > 0)
+        {
+            m_player->push_buffer(m_packet);
+        }
+        else
+        {
+            m_packet->unref();
+        }
+        m_packet = nullptr;
+    }
+}
+
+void WebSocketClient::onQueueLevel(bool enough)
+{
+    m_rxHold = enough;
+    if (m_webSocketContext)
+    {
+        //wakes lws_service, the flow control is up to the service thread
+        lws_cancel_service(m_webSocketContext);
+    }
+}
+
+void WebSocketClient::updateRxFlow()
+{
+    bool hold = m_rxHold;
+    if (m_webSocket && hold != m_rxHeld)
+    {
+        //Off, lws stops reading the socket and TCP holds off the server
+        lws_rx_flow_control(m_webSocket, hold ? 0 : 1);
+        m_rxHeld = hold;
+        SAPLOG_INFO("SAP: Websocket receive %s\n", hold ? "held, player queue is full" : "resumed");
+    }
 }
 
 void WebSocketClient::onConnectionError()
@@ -207,6 +282,13 @@ void WebSocketClient::onConnectionError()
 void WebSocketClient::onConnected(bool status)
 {
     m_isConnected = status;
+    if(!m_isConnected)
+    {
+        //what came before the close is still played
+        flushPacket();
+        m_webSocket = nullptr;
+        m_rxHeld = false;
+    }
     if(m_isConnected)
     {
         SAPLOG_INFO("SAP: Websocket Connected");
@@ -229,8 +311,8 @@ void WebSocketClient::createWebsocketContext()
 
     m_webSocketProtocols[0].callback = &WebsocketEventCallback;
     m_webSocketProtocols[0].per_session_data_size = 0;
-    //5MB for audio
-    m_webSocketProtocols[0].rx_buffer_size = 5 * 1024 * 1024;
+    //read in packet sized pieces, one fills a packet of the player queue
+    m_webSocketProtocols[0].rx_buffer_size = BUFFER_POOL_BLOCK_SIZE;
 
     // NULL terminator
     m_webSocketProtocols[1].name = NULL;
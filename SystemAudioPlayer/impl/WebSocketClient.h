@@ -19,13 +19,18 @@ class WebSocketClient
     void disconnect();
     bool isConnected() const;
     void onConnected(bool status);
-    void onNewData(const void *ptr, size_t len) const;
+    void onNewData(lws *wsi, const void *ptr, size_t len);
     void onConnectionError();
     void runWebsocketService();
+    //Any thread, enough once the player queue is at its high watermark
+    void onQueueLevel(bool enough);
+    //Service thread, applies the last queue level to the connection
+    void updateRxFlow();
 
     private:    
     void createWebsocketContext();
     void urlParser(std::string input);
+    void flushPacket();
     lws *m_webSocket;
     lws_protocols *m_webSocketProtocols;
     lws_context *m_webSocketContext;
@@ -35,6 +40,9 @@ class WebSocketClient
     bool m_wsThreadStarted;
     std::atomic<bool> m_wsThreadRun;
     std::atomic<bool> m_isConnected;
+    std::atomic<bool> m_rxHold;  //wanted by the player queue
+    bool m_rxHeld;               //service thread, rx flow of the connection is off
+    Buffer *m_packet;            //service thread, being filled by the received frames
     AudioPlayer *m_player;
 };
 #endif
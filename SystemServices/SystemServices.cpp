@@ -79,7 +79,12 @@ using namespace std;
 
 #define DEVICE_PROPERTIES_FILE "/etc/device.properties"
 
-#define DEVICE_INFO_SCRIPT "sh /lib/rdk/getDeviceDetails.sh read"
+#define DEVICE_INFO_SCRIPT { "sh", "/lib/rdk/getDeviceDetails.sh", "read" }
+
+/* Device details that change at run time (IP addresses) are read again after this */
+#define DEVICE_IDENTITY_VOLATILE_TTL_MS 30000
+/* Downloaded firmware info is read again after this, or on a firmware update state change */
+#define DOWNLOADED_FIRMWARE_INFO_TTL_MS 10000
 
 #define STATUS_CODE_NO_SWUPDATE_CONF 460 
 
@@ -428,6 +433,7 @@ namespace WPEFramework {
             registerMethod("getStoreDemoLink", &SystemServices::getStoreDemoLink, this, {2});
 #endif
             registerMethod("deletePersistentPath", &SystemServices::deletePersistentPath, this, {2});
+            registerMethod("getEventDispatchMetrics", &SystemServices::getEventDispatchMetrics, this, {2});
             GetHandler(2)->Register<JsonObject, PlatformCaps>("getPlatformConfiguration",
                 &SystemServices::getPlatformConfiguration, this);
         }
@@ -440,11 +446,21 @@ namespace WPEFramework {
 
         const string SystemServices::Initialize(PluginHost::IShell* service)
         {
+            m_eventDispatcher.start();
+            if (m_cacheSnapshot.open()) {
+                publishCacheSnapshot();
+            } else {
+                LOGWARN("cache snapshot segment not available\n");
+            }
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             InitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
             m_shellService = service;
             m_shellService->AddRef();
+            m_deviceIdentityThread = Utils::ThreadRAII(std::thread(readDeviceIdentityAsync, this));
+#ifdef ENABLE_THERMAL_PROTECTION
+            CThermalMonitor::instance()->addEventObserver(this);
+#endif /* ENABLE_THERMAL_PROTECTION */
             /* On Success; return empty to indicate no error text. */
             return (string());
         }
@@ -454,6 +470,14 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            /* Handles what the IARM handlers queued before they were unregistered */
+            m_eventDispatcher.stop();
+#ifdef ENABLE_THERMAL_PROTECTION
+            CThermalMonitor::instance()->removeEventObserver(this);
+#endif /* ENABLE_THERMAL_PROTECTION */
+            if (m_deviceIdentityThread.get().joinable())
+                m_deviceIdentityThread.get().join();
+            m_cacheSnapshot.close();
             SystemServices::_instance = nullptr;
             m_shellService->Release();
             m_shellService = nullptr;
@@ -495,6 +519,11 @@ namespace WPEFramework {
         }
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
 
+        void SystemServices::dispatchEvent(const string& type, const std::function<void(SystemServices*)>& handler)
+        {
+            m_eventDispatcher.dispatch(type, [this, handler]() { handler(this); });
+        }
+
 #ifdef DEBUG
         /**
          * @brief : sampleAPI
@@ -517,10 +546,10 @@ namespace WPEFramework {
             string otherReason = "No other reason supplied";
             bool result = false;
 
-            nfxResult = system("pgrep nrdPluginApp");
+            nfxResult = Utils::runCommand({ "pgrep", "nrdPluginApp" });
             if (E_OK == nfxResult) {
                 LOGINFO("SystemService shutting down Netflix...\n");
-                nfxResult = system("pkill nrdPluginApp");
+                nfxResult = Utils::runCommand({ "pkill", "nrdPluginApp" });
                 if (E_OK == nfxResult) {
                     //give Netflix process some time to terminate gracefully.
                     sleep(10);
@@ -583,6 +612,7 @@ namespace WPEFramework {
                             TR181_FW_DELAY_REBOOT, set_rfc_val, WDMP_INT);
                     if ( WDMP_SUCCESS == status ){
                         result=true;
+                        PlatformCaps::Invalidate(PlatformCaps::Change::RFC);
                         LOGINFO("Success Setting setFirmwareRebootDelay value\n");
                     }
                     else {
@@ -629,6 +659,7 @@ namespace WPEFramework {
                        TR181_AUTOREBOOT_ENABLE,set_rfc_val,WDMP_BOOLEAN);
                if ( WDMP_SUCCESS == status ){
                    result=true;
+                   PlatformCaps::Invalidate(PlatformCaps::Change::RFC);
                    LOGINFO("Success Setting the setFirmwareAutoReboot value\n");
                }
                else {
@@ -747,8 +778,7 @@ namespace WPEFramework {
                  mocaFile.open(MOCA_FILE, ios::out);
                      if (mocaFile) {
                          mocaFile.close();
-                         /* TODO: replace system() */
-                         eRetval = system("/etc/init.d/moca_init start");
+                         eRetval = Utils::runCommand({ "/etc/init.d/moca_init", "start" });
                      } else {
                          LOGERR("moca file open failed\n");
                          populateResponseWithError(SysSrv_FileAccessFailed, response);
@@ -756,8 +786,7 @@ namespace WPEFramework {
                  } else {
                      std::remove(MOCA_FILE);
                      if (!Utils::fileExists(MOCA_FILE)) {
-                         /* TODO: replace system() */
-                         eRetval = system("/etc/init.d/moca_init start");
+                         eRetval = Utils::runCommand({ "/etc/init.d/moca_init", "start" });
                      } else {
                          LOGERR("moca file remove failed\n");
                          populateResponseWithError(SysSrv_FileAccessFailed, response);
@@ -799,6 +828,162 @@ namespace WPEFramework {
             returnResponse(result);
         }
 
+        // some tweaks for backward compatibility
+        void SystemServices::addDeviceDetail(const std::string& key, const std::string& value, JsonObject& response)
+        {
+            response[key.c_str()] = value;
+
+            if (key == "imageVersion") {
+                response["version"] = value;
+                response["software_version"] = value;
+            }
+            else if (key == "cableCardVersion") {
+                response["cable_card_firmware_version"] = value;
+            }
+        }
+
+        bool SystemServices::isVolatileDeviceDetail(const std::string& key)
+        {
+            return key.find("IP") != std::string::npos || key.find("_ip") != std::string::npos;
+        }
+
+        int SystemServices::readMake(std::string& make)
+        {
+            if (!Utils::fileExists(DEVICE_PROPERTIES_FILE)) {
+                return SysSrv_FileNotPresent;
+            }
+
+            char buf[1024];
+
+            FILE *f = fopen(DEVICE_PROPERTIES_FILE, "r");
+
+            if(!f) {
+                LOGWARN("failed to open %s:%s", DEVICE_PROPERTIES_FILE, strerror(errno));
+                return SysSrv_FileAccessFailed;
+            }
+
+            std::string line;
+            while(fgets(buf, sizeof(buf), f) != NULL) {
+                line = buf;
+                size_t eq = line.find_first_of("=");
+
+                if (std::string::npos != eq) {
+                    std::string key = line.substr(0, eq);
+
+                    if (key == "MFG_NAME") {
+                        make = line.substr(eq + 1);
+                        Utils::String::trim(make);
+                        break;
+                    }
+                }
+            }
+
+            fclose(f);
+
+            return make.size() > 0 ? SysSrv_OK : SysSrv_MissingKeyValues;
+        }
+
+        void SystemServices::readDeviceIdentityAsync(SystemServices *pSs)
+        {
+            if (pSs) {
+                DeviceIdentity identity;
+                pSs->getDeviceIdentity(identity, false);
+                LOGINFO("device identity read, %d details\n", (int)identity.details.size());
+            }
+        }
+
+        /***
+         * @brief : Reads the device identity, once for all callers asking at the same time.
+         *          Make, serial number and model name don't change at run time and are kept,
+         *          the getDeviceDetails.sh values are read again.
+         */
+        void SystemServices::readDeviceIdentity()
+        {
+            DeviceIdentity identity;
+            {
+                std::unique_lock<std::mutex> lock(m_deviceIdentityMutex);
+                if (m_deviceIdentityReading) {
+                    m_deviceIdentityCV.wait(lock, [this] { return !m_deviceIdentityReading; });
+                    return;
+                }
+                m_deviceIdentityReading = true;
+                identity = m_deviceIdentity;
+            }
+
+            identity.details.clear();
+            identity.detailsValid = false;
+            std::vector<std::string> args = DEVICE_INFO_SCRIPT;
+            std::string res;
+            Utils::runCommand(args, &res);
+
+            std::stringstream ss(res);
+            std::string line;
+            while (std::getline(ss, line)) {
+                size_t eq = line.find_first_of("=");
+                if (std::string::npos != eq) {
+                    identity.details[line.substr(0, eq)] = line.substr(eq + 1);
+                    identity.detailsValid = true;
+                }
+            }
+
+            if (identity.makeError != SysSrv_OK) {
+                identity.make.clear();
+                identity.makeError = readMake(identity.make);
+            }
+
+#ifndef USE_TR_69
+            if (identity.serialNumber.empty()) {
+                JsonObject serial;
+                if (readSerialNumberSnmp(serial))
+                    identity.serialNumber = serial["serialNumber"].String();
+            }
+#endif
+
+#ifdef ENABLE_DEVICE_MANUFACTURER_INFO
+            if (!identity.friendlyIdValid) {
+                JsonObject model;
+                if (getModelName(FRIENDLY_ID, model)) {
+                    identity.friendlyId = model[FRIENDLY_ID.c_str()].String();
+                    identity.friendlyIdValid = true;
+                }
+            }
+#endif
+
+            std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+            identity.read = std::chrono::steady_clock::now();
+            identity.valid = true;
+            m_deviceIdentity = identity;
+            m_deviceIdentityReading = false;
+            m_deviceIdentityCV.notify_all();
+        }
+
+        /***
+         * @brief : The device identity snapshot, read first if there is none yet or the
+         *          volatile details are wanted and older than their TTL.
+         */
+        void SystemServices::getDeviceIdentity(DeviceIdentity& identity, bool fresh)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+                if (m_deviceIdentity.valid && !m_deviceIdentityReading && (!fresh ||
+                        std::chrono::steady_clock::now() - m_deviceIdentity.read < std::chrono::milliseconds(DEVICE_IDENTITY_VOLATILE_TTL_MS))) {
+                    identity = m_deviceIdentity;
+                    return;
+                }
+            }
+
+            readDeviceIdentity();
+
+            std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+            identity = m_deviceIdentity;
+        }
+
+        void SystemServices::invalidateVolatileDeviceDetails()
+        {
+            std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+            m_deviceIdentity.read = std::chrono::steady_clock::time_point();
+        }
+
         /**
          * @brief : API to query DeviceInfo details
          *
@@ -827,49 +1012,19 @@ namespace WPEFramework {
 
            }
 
+            DeviceIdentity identity;
+            getDeviceIdentity(identity, queryParams.empty() || isVolatileDeviceDetail(queryParams));
+
             // there is no /tmp/.make from /lib/rdk/getDeviceDetails.sh, but it can be taken from /etc/device.properties
             if (queryParams.empty() || queryParams == "make") {
 
-                if (!Utils::fileExists(DEVICE_PROPERTIES_FILE)) {
-                    populateResponseWithError(SysSrv_FileNotPresent, response);
+                if (identity.makeError != SysSrv_OK) {
+                    populateResponseWithError(identity.makeError, response);
                     returnResponse(retAPIStatus);
                 }
 
-                char buf[1024];
-
-                FILE *f = fopen(DEVICE_PROPERTIES_FILE, "r");
-
-                if(!f) {
-                    LOGWARN("failed to open %s:%s", DEVICE_PROPERTIES_FILE, strerror(errno));
-                    populateResponseWithError(SysSrv_FileAccessFailed, response);
-                    returnResponse(retAPIStatus);
-                }
-
-                std::string line;
-                std::string make;
-                while(fgets(buf, sizeof(buf), f) != NULL) {
-                    line = buf;
-                    size_t eq = line.find_first_of("=");
-
-                    if (std::string::npos != eq) {
-                        std::string key = line.substr(0, eq);
-
-                        if (key == "MFG_NAME") {
-                            make = line.substr(eq + 1);
-                            Utils::String::trim(make);
-                            break;
-                        }
-                    }
-                }
-
-                fclose(f);
-
-                if (make.size() > 0) {
-                    response["make"] = make;
-                    retAPIStatus = true;
-                } else {
-                    populateResponseWithError(SysSrv_MissingKeyValues, response);
-                }
+                response["make"] = identity.make;
+                retAPIStatus = true;
 
                 if (!queryParams.empty()) {
                     returnResponse(retAPIStatus);
@@ -883,21 +1038,43 @@ namespace WPEFramework {
 
 	    if(!queryParams.compare(FRIENDLY_ID))
 	    {
+		    if (identity.friendlyIdValid) {
+			    response[FRIENDLY_ID.c_str()] = identity.friendlyId;
+			    returnResponse(true);
+		    }
 		    if(getModelName(queryParams, response))
 			    returnResponse(true);
             }
 #endif
 
-            std::string cmd = DEVICE_INFO_SCRIPT;
+            if (identity.detailsValid) {
+                if (queryParams.empty()) {
+                    for (auto it = identity.details.cbegin(); it != identity.details.cend(); ++it)
+                        addDeviceDetail(it->first, it->second, response);
+#ifdef ENABLE_DEVICE_MANUFACTURER_INFO
+                    if (identity.friendlyIdValid)
+                        response[FRIENDLY_ID.c_str()] = identity.friendlyId;
+#endif
+                    returnResponse(true);
+                }
+
+                auto it = identity.details.find(queryParams);
+                if (it != identity.details.end()) {
+                    response[queryParams.c_str()] = it->second;
+                    returnResponse(true);
+                }
+            }
+
+            // Not in the snapshot. The parameter goes to the script as it is, there's no shell to interpret it.
+            std::vector<std::string> args = DEVICE_INFO_SCRIPT;
             if (!queryParams.empty()) {
-                cmd += " ";
-                cmd += queryParams;
+                args.push_back(queryParams);
             }
 
-            std::string res = Utils::cRunScript(cmd.c_str());
+            std::string res;
+            Utils::runCommand(args, &res);
 
             if (res.size() > 0) {
-                std::string model_number;
                 if (queryParams.empty()) {
                     retAPIStatus = true;
 
@@ -912,19 +1089,7 @@ namespace WPEFramework {
                             std::string key = line.substr(0, eq);
                             std::string value = line.substr(eq + 1);
 
-                            response[key.c_str()] = value;
-
-                            // some tweaks for backward compatibility
-                            if (key == "imageVersion") {
-                                response["version"] = value; 
-                                response["software_version"] = value;
-                            }
-                            else if (key == "cableCardVersion") {
-                                response["cable_card_firmware_version"] = value;
-                            }
-                            else if (key == "model_number") {
-                                model_number = value;
-                            }
+                            addDeviceDetail(key, value, response);
                         }
                     }
 #ifdef ENABLE_DEVICE_MANUFACTURER_INFO
@@ -1172,16 +1337,14 @@ namespace WPEFramework {
                             result = false;
                         }
 
-                        string command = "";
+                        int sysStat = 0;
                         if (MODE_WAREHOUSE == m_currentMode) {
-                            command = "touch ";
-                        } else {
-                            command = "rm -f ";
+                            FILE *f = fopen(WAREHOUSE_MODE_FILE, "a");
+                            sysStat = f ? fclose(f) : -1;
+                        } else if (std::remove(WAREHOUSE_MODE_FILE) != 0 && errno != ENOENT) {
+                            sysStat = -1;
                         }
-                        command += WAREHOUSE_MODE_FILE;
-                        /* TODO: replace with system alternate. */
-                        int sysStat = system(command.c_str());
-                        LOGINFO("system returned %d\n", sysStat);
+                        LOGINFO("updating %s returned %d\n", WAREHOUSE_MODE_FILE, sysStat);
                         //set values in temp file so they can be restored in receiver restarts / crashes
                         m_temp_settings.setValue("mode", m_currentMode);
                         m_temp_settings.setValue("mode_duration", m_remainingDuration);
@@ -1357,7 +1520,8 @@ namespace WPEFramework {
             std::system("/lib/rdk/xconfImageCheck.sh  >> /opt/logs/wpeframework.log");
 
             //get xconf http code
-            string httpCodeStr = Utils::cRunScript("cat /tmp/xconf_httpcode_thunder.txt");
+            string httpCodeStr;
+            Utils::readFile("/tmp/xconf_httpcode_thunder.txt", httpCodeStr);
             if(!httpCodeStr.empty())
             {
                 try
@@ -1372,7 +1536,7 @@ namespace WPEFramework {
 
             LOGINFO("xconf http code %d\n", _fwUpdate.httpStatus);
 
-            response = Utils::cRunScript("cat /tmp/xconf_response_thunder.txt");
+            Utils::readFile("/tmp/xconf_response_thunder.txt", response);
             LOGINFO("xconf response '%s'\n", response.c_str());
             
             if(!response.empty()) 
@@ -1837,14 +2001,30 @@ namespace WPEFramework {
          * @brief : Populates Device Serial Number Info using SNMP Request.
          */
         bool SystemServices::getSerialNumberSnmp(JsonObject& response)
+        {
+            DeviceIdentity identity;
+            getDeviceIdentity(identity, false);
+            if (!identity.serialNumber.empty()) {
+                response["serialNumber"] = identity.serialNumber;
+                return true;
+            }
+
+            if (!readSerialNumberSnmp(response))
+                return false;
+
+            std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+            m_deviceIdentity.serialNumber = response["serialNumber"].String();
+            return true;
+        }
+
+        bool SystemServices::readSerialNumberSnmp(JsonObject& response)
         {
             bool retAPIStatus = false;
 	    if (!Utils::fileExists("/lib/rdk/getStateDetails.sh")) {
 		LOGERR("/lib/rdk/getStateDetails.sh not found.");
 		populateResponseWithError(SysSrv_FileNotPresent, response);
 	    } else {
-		/* TODO: remove system() once alternate available. */
-		system("/lib/rdk/getStateDetails.sh STB_SER_NO");
+		Utils::runCommand({ "/lib/rdk/getStateDetails.sh", "STB_SER_NO" });
 		std::vector<string> lines;
 		if (true == Utils::fileExists(TMP_SERIAL_NUMBER_FILE)) {
 		    if (getFileContent(TMP_SERIAL_NUMBER_FILE, lines)) {
@@ -1892,23 +2072,12 @@ namespace WPEFramework {
         {
             bool retStatus = false;
             int m_downloadPercent = -1;
-            if (Utils::fileExists("/opt/curl_progress")) {
-                /* TODO: replace with new implementation. */
-                FILE* fp = popen(CAT_DWNLDPROGRESSFILE_AND_GET_INFO, "r");
-                if (NULL != fp) {
-                    char output[8];
-                    if (NULL != fgets (output, 8, fp)) {
-                        output[strcspn(output, "\n")] = 0;
-                        if (*output) {
-                            m_downloadPercent = strtol(output, NULL, 10);
-                        }
-                        LOGWARN("FirmwareDownloadPercent = [%d]\n", m_downloadPercent);
-                    } else {
-                        LOGERR("Cannot read output from command\n");
-                    }
-                    pclose(fp);
+            if (Utils::fileExists(DWNLD_PROGRESS_FILE)) {
+                std::string progress;
+                if (Utils::readFile(DWNLD_PROGRESS_FILE, progress)) {
+                    m_downloadPercent = getCurlProgressPercent(progress);
                 } else {
-                    LOGERR("Cannot run command\n");
+                    LOGERR("Cannot read %s\n", DWNLD_PROGRESS_FILE);
                 }
 
                 LOGWARN("FirmwareDownloadPercent = [%d]", m_downloadPercent);
@@ -1931,6 +2100,27 @@ namespace WPEFramework {
          */
         uint32_t SystemServices::getDownloadedFirmwareInfo(const JsonObject& parameters,
                 JsonObject& response)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+                if (m_downloadedFirmwareInfoValid && std::chrono::steady_clock::now() - m_downloadedFirmwareInfoRead <
+                        std::chrono::milliseconds(DOWNLOADED_FIRMWARE_INFO_TTL_MS)) {
+                    response = m_downloadedFirmwareInfo;
+                    returnResponse(true);
+                }
+            }
+
+            bool retStat = readDownloadedFirmwareInfo(response);
+            if (retStat) {
+                std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+                m_downloadedFirmwareInfo = response;
+                m_downloadedFirmwareInfoRead = std::chrono::steady_clock::now();
+                m_downloadedFirmwareInfoValid = true;
+            }
+            returnResponse(retStat);
+        }
+
+        bool SystemServices::readDownloadedFirmwareInfo(JsonObject& response)
         {
             bool retStat = false;
             string downloadedFWVersion = "";
@@ -2016,7 +2206,7 @@ namespace WPEFramework {
             } else {
                 populateResponseWithError(SysSrv_FileContentUnsupported, response);
             }
-            returnResponse(retStat);
+            return retStat;
         }
 
         /***
@@ -2048,6 +2238,11 @@ namespace WPEFramework {
 
             const FirmwareUpdateState firmwareUpdateState = (FirmwareUpdateState)newState;
             m_FwUpdateState_LatestEvent=(int)firmwareUpdateState;
+            {
+                std::lock_guard<std::mutex> lock(m_deviceIdentityMutex);
+                m_downloadedFirmwareInfoValid = false;
+            }
+            PlatformCaps::Invalidate(PlatformCaps::Change::FirmwareUpdate);
             params["firmwareUpdateStateChange"] = (int)firmwareUpdateState;
             LOGINFO("New firmwareUpdateState = %d\n", (int)firmwareUpdateState);
             sendNotify(EVT_ONFIRMWAREUPDATESTATECHANGED, params);
@@ -2081,8 +2276,7 @@ namespace WPEFramework {
                 cmdBuffer.clear();
                 cmdBuffer = "/lib/rdk/getDeviceDetails.sh read " + macTypeList[i];
                 LOGWARN("cmd = %s\n", cmdBuffer.c_str());
-                tempBuffer.clear();
-                tempBuffer = Utils::cRunScript(cmdBuffer.c_str());
+                Utils::runCommand({ "/lib/rdk/getDeviceDetails.sh", "read", macTypeList[i] }, &tempBuffer);
                 removeCharsFromString(tempBuffer, "\n\r");
                 LOGWARN("resp = %s\n", tempBuffer.c_str());
                 params[macTypeList[i].c_str()] = (tempBuffer.empty()? "00:00:00:00:00:00" : tempBuffer.c_str());
@@ -2157,6 +2351,31 @@ namespace WPEFramework {
             sendNotify(EVT_ONTEMPERATURETHRESHOLDCHANGED, params);
         }
 
+        /***
+         * @brief : called by the thermal monitor when the temperature is predicted to
+         *          reach a threshold within THERMAL_PREDICTION_HORIZON_S at its current rate
+         * @param1[in]  : string threshold type
+         * @param2[in]  : float temperature
+         * @param3[in]  : float threshold
+         * @param4[in]  : float rate in degrees per second
+         * @param5[in]  : int seconds until the threshold is reached
+         * @param2[out] : {param:{"thresholdType":"<string>","temperature":<string>,"threshold":<string>,
+         *     "rate":<string>,"seconds":<int>}}
+         */
+        void SystemServices::onTemperatureApproachingThreshold(string thresholdType,
+                float temperature, float threshold, float rate, int seconds)
+        {
+            JsonObject params;
+            params["thresholdType"] = thresholdType;
+            params["temperature"] = to_string(temperature);
+            params["threshold"] = to_string(threshold);
+            params["rate"] = to_string(rate * 60);
+            params["seconds"] = seconds;
+            LOGWARN("thresholdType = %s temperature = %f threshold = %f rate = %f/s seconds = %d\n",
+                    thresholdType.c_str(), temperature, threshold, rate, seconds);
+            sendNotify(EVT_ONTEMPERATUREAPPROACHINGTHRESHOLD, params);
+        }
+
 #ifdef ENABLE_SYSTIMEMGR_SUPPORT
         void SystemServices::onTimeStatusChanged(string timequality,string timesource, string utctime)
         {
@@ -2188,8 +2407,7 @@ namespace WPEFramework {
 					LOGERR("Empty timeZone received.");
 				} else {
 					if (!dirExists(dir)) {
-						std::string command = "mkdir -p " + dir + " \0";
-						Utils::cRunScript(command.c_str());
+						Utils::runCommand({ "mkdir", "-p", dir });
 					} else {
 						//Do nothing//
 					}
@@ -2248,13 +2466,17 @@ namespace WPEFramework {
             returnResponse(resp);
         }
 
-        bool SystemServices::processTimeZones(std::string dir, JsonObject& out)
+        bool SystemServices::processTimeZones(const std::string& dir, TimeZoneCatalog& catalog, time_t now)
         {
             bool ret = true;
             std::string cmd = "zdump ";
             cmd += dir;
             cmd += "/*";
 
+            struct stat dirStat;
+            if (0 == stat(dir.c_str(), &dirStat))
+                catalog.directories[dir] = dirStat.st_mtime;
+
             FILE *p = popen(cmd.c_str(), "r");
 
             if(!p)
@@ -2299,19 +2521,28 @@ namespace WPEFramework {
                 }
                 else
                 {
-
-                    std::string name = fullName;
-
-                    size_t pathEnd = fullName.find_last_of("/") + 1;
-                    if (std::string::npos != pathEnd)
-                        name = fullName.substr(pathEnd);
-                    else
-                        LOGWARN("No '/' in %s", fullName.c_str());
+                    std::string name = fullName.substr(strlen(ZONEINFO_DIR "/"));
 
                     line.erase(0, line.find_first_of(" \t"));
                     line.erase(0, line.find_first_not_of(" \n\r\t"));
 
-                    out[name.c_str()] = line;
+                    /* "Thu Nov  5 15:21:17 2020 EST": the local time now gives the offset */
+                    TimeZone& zone = catalog.zones[name];
+                    zone.zdump = line;
+                    struct tm local = {};
+                    const char *abbreviation = strptime(line.c_str(), "%a %b %d %H:%M:%S %Y", &local);
+                    if (abbreviation != NULL)
+                    {
+                        long offset = (long)(timegm(&local) - now);
+                        zone.offset = ((offset >= 0 ? offset + 30 : offset - 30) / 60) * 60;
+                        zone.abbreviation = abbreviation;
+                        zone.abbreviation.erase(0, zone.abbreviation.find_first_not_of(" \t"));
+                        zone.parsed = true;
+                    }
+                    else
+                    {
+                        LOGWARN("No time in '%s' for %s", line.c_str(), name.c_str());
+                    }
                 }
             }
 
@@ -2323,30 +2554,107 @@ namespace WPEFramework {
                 return false;
             }
 
-            for (int n = 0 ; n < dirs.size(); n++) {
-                std::string name = dirs[n];
+            for (size_t n = 0 ; n < dirs.size(); n++) {
+                processTimeZones(dirs[n], catalog, now);
+            }
 
-                size_t pathEnd = name.find_last_of("/") + 1;
+            return ret;
+        }
 
-                if (std::string::npos != pathEnd)
-                    name = name.substr(pathEnd);
-                else
-                    LOGWARN("No '/' in %s", name.c_str());
+        bool SystemServices::isTimeZoneCatalogCurrent(const TimeZoneCatalog& catalog, time_t now)
+        {
+            if (!catalog.valid || (catalog.built / 900) != (now / 900))
+                return false;
 
-                JsonObject dirObject;
-                processTimeZones(dirs[n], dirObject);
-                out[name.c_str()] = dirObject;
+            for (auto const& directory : catalog.directories)
+            {
+                struct stat dirStat;
+                if (stat(directory.first.c_str(), &dirStat) || (dirStat.st_mtime != directory.second))
+                    return false;
             }
+            return true;
+        }
 
-            return ret;
+        /* Adds the zones from it on below prefix, nested like the directories they are in */
+        void SystemServices::addTimeZones(std::map<std::string, TimeZone>::const_iterator& it,
+                std::map<std::string, TimeZone>::const_iterator end, const std::string& prefix,
+                time_t now, JsonObject& out)
+        {
+            while (it != end && 0 == it->first.compare(0, prefix.size(), prefix))
+            {
+                std::string name = it->first.substr(prefix.size());
+                size_t dirEnd = name.find('/');
+                if (std::string::npos != dirEnd)
+                {
+                    name.erase(dirEnd);
+                    JsonObject dirObject;
+                    addTimeZones(it, end, prefix + name + "/", now, dirObject);
+                    out[name.c_str()] = dirObject;
+                    continue;
+                }
+
+                const TimeZone& zone = it->second;
+                if (zone.parsed)
+                {
+                    time_t local = now + zone.offset;
+                    struct tm tm;
+                    char time[64] = { 0 };
+                    gmtime_r(&local, &tm);
+                    strftime(time, sizeof(time), "%a %b %e %H:%M:%S %Y", &tm);
+                    out[name.c_str()] = std::string(time) + " " + zone.abbreviation;
+                }
+                else
+                {
+                    out[name.c_str()] = zone.zdump;
+                }
+                ++it;
+            }
         }
 
+        /***
+         * @brief : To fetch the time zones of the system's time zone database.
+         * @param1[in]  : {"params":{"region":"<string>"}}, region is optional: only the zones below it
+         * @param2[out] : {"result":{"zoneinfo":{...},"success":<bool>}}
+         * @return      : Core::<StatusCode>
+         */
         uint32_t SystemServices::getTimeZones(const JsonObject& parameters, JsonObject& response)
         {
             LOGINFO("called");
 
+            std::lock_guard<std::mutex> lock(m_timeZonesMutex);
+            time_t now = time(NULL);
+            bool resp = true;
+            if (!isTimeZoneCatalogCurrent(m_timeZones, now))
+            {
+                TimeZoneCatalog catalog;
+                catalog.built = now;
+                resp = processTimeZones(ZONEINFO_DIR, catalog, now);
+                catalog.valid = resp;
+                LOGINFO("%zu time zones in %zu directories", catalog.zones.size(), catalog.directories.size());
+                m_timeZones = std::move(catalog);
+            }
+
+            std::map<std::string, TimeZone>::const_iterator it = m_timeZones.zones.begin();
+            std::map<std::string, TimeZone>::const_iterator end = m_timeZones.zones.end();
+            if (parameters.HasLabel("region"))
+            {
+                std::string prefix = parameters["region"].String();
+                prefix.erase(prefix.find_last_not_of("/") + 1);
+                prefix += "/";
+                it = m_timeZones.zones.lower_bound(prefix);
+                end = it;
+                while (end != m_timeZones.zones.end() && 0 == end->first.compare(0, prefix.size(), prefix))
+                    ++end;
+                if (it == end)
+                {
+                    LOGERR("No time zones in region '%s'", prefix.c_str());
+                    populateResponseWithError(SysSrv_KeyNotFound, response);
+                    returnResponse(false);
+                }
+            }
+
             JsonObject dirObject;
-            bool resp = processTimeZones(ZONEINFO_DIR, dirObject);
+            addTimeZones(it, end, "", now, dirObject);
             response["zoneinfo"] = dirObject;
 
             returnResponse(resp);
@@ -2420,6 +2728,7 @@ namespace WPEFramework {
 		    LOGWARN("key: '%s' value: '%s'\n", key.c_str(), value.c_str());
 		    if (key.length() && value.length()) {
 			    if (m_cacheService.setValue(key, value)) {
+				    publishCacheSnapshot();
 				    retStat = true;
 			    } else {
 				    LOGERR("Accessing m_cacheService.setValue failed\n.");
@@ -2476,6 +2785,7 @@ namespace WPEFramework {
 			std::string key = parameters["key"].String();
 			if (key.length()) {
 				if (m_cacheService.remove(key)) {
+					publishCacheSnapshot();
 					retStat = true;
 				} else {
 					LOGERR("Accessing m_cacheService.remove failed\n.");
@@ -2490,6 +2800,19 @@ namespace WPEFramework {
 		returnResponse(retStat);
         }
 
+        /***
+         * @brief : Publish the cache to the shared-memory snapshot, see
+         *          SystemCacheSnapshot.h for the layout and the read protocol.
+         */
+        void SystemServices::publishCacheSnapshot()
+        {
+            std::vector<std::pair<std::string, std::string>> entries;
+            m_cacheService.getAll(entries);
+            if (!m_cacheSnapshot.publish(entries)) {
+                LOGWARN("cache snapshot not published (%d entries)\n", (int)entries.size());
+            }
+        }
+
         /***
          * @brief : To get previous boot info.
          * @param1[in]	: {"params":{}}
@@ -2592,19 +2915,9 @@ namespace WPEFramework {
         {
             bool retAPIStatus = false;
 
-                /* FIXME: popen in use */
-                FILE *pipe = NULL;
-                char cmd[128] = {'\0'};
-
-                snprintf(cmd, 127, "rm -f %s", STANDBY_REASON_FILE);
-                pipe = popen(cmd, "r");
-                if (pipe) {
-                    retAPIStatus = ((pclose(pipe) != -1)? true: false);
-                    if (false == retAPIStatus) {
-                        populateResponseWithError(SysSrv_Unexpected, response);
-                    }
-                } else {
-                    populateResponseWithError(SysSrv_Unexpected, response);
+            retAPIStatus = (std::remove(STANDBY_REASON_FILE) == 0 || errno == ENOENT);
+            if (false == retAPIStatus) {
+                populateResponseWithError(SysSrv_Unexpected, response);
             }
 
             returnResponse(retAPIStatus);
@@ -3546,7 +3859,9 @@ namespace WPEFramework {
                                 Old State %s, New State: %s\n",
                                 curState.c_str() , newState.c_str());
                         if (SystemServices::_instance) {
-                            SystemServices::_instance->onSystemPowerStateChanged(curState, newState);
+                            SystemServices::_instance->dispatchEvent("powerState", [curState, newState](SystemServices* service) {
+                                service->onSystemPowerStateChanged(curState, newState);
+                            });
                         } else {
                             LOGERR("SystemServices::_instance is NULL.\n");
                         }
@@ -3558,7 +3873,11 @@ namespace WPEFramework {
                         IARM_Bus_PWRMgr_RebootParam_t *eventData = (IARM_Bus_PWRMgr_RebootParam_t *)data;
 
                         if (SystemServices::_instance) {
-                            SystemServices::_instance->onPwrMgrReboot(eventData->requestor, eventData->reboot_reason_other);
+                            string requestor = eventData->requestor;
+                            string reason = eventData->reboot_reason_other;
+                            SystemServices::_instance->dispatchEvent("reboot", [requestor, reason](SystemServices* service) {
+                                service->onPwrMgrReboot(requestor, reason);
+                            });
                         } else {
                             LOGERR("SystemServices::_instance is NULL.\n");
                         }
@@ -3571,7 +3890,10 @@ namespace WPEFramework {
                     IARM_Bus_PWRMgr_EventData_t *eventData = (IARM_Bus_PWRMgr_EventData_t *)data;
 
                     if (SystemServices::_instance) {
-                        SystemServices::_instance->onNetorkModeChanged(eventData->data.bNetworkStandbyMode);
+                        bool networkStandbyMode = eventData->data.bNetworkStandbyMode;
+                        SystemServices::_instance->dispatchEvent("networkStandbyMode", [networkStandbyMode](SystemServices* service) {
+                            service->onNetorkModeChanged(networkStandbyMode);
+                        });
                     } else {
                         LOGERR("SystemServices::_instance is NULL.\n");
                     }
@@ -3595,7 +3917,9 @@ namespace WPEFramework {
 
 #ifdef HAS_API_POWERSTATE
             if (SystemServices::_instance) {
-                SystemServices::_instance->onSystemModeChanged(mode);
+                SystemServices::_instance->dispatchEvent("systemMode", [mode](SystemServices* service) {
+                    service->onSystemModeChanged(mode);
+                });
             } else {
                 LOGERR("SystemServices::_instance is NULL.\n");
             }
@@ -3633,22 +3957,37 @@ namespace WPEFramework {
                         {
                             if (IARM_BUS_SYSMGR_FIRMWARE_UPDATE_STATE_CRITICAL_REBOOT == state) {
                                 LOGWARN(" Critical reboot is required. \n ");
-                                SystemServices::_instance->onFirmwarePendingReboot(seconds);
+                                SystemServices::_instance->dispatchEvent("firmwareUpdateState", [seconds](SystemServices* service) {
+                                    service->onFirmwarePendingReboot(seconds);
+                                });
                             } else {
-                                SystemServices::_instance->onFirmwareUpdateStateChange(state);
+                                SystemServices::_instance->dispatchEvent("firmwareUpdateState", [state](SystemServices* service) {
+                                    service->onFirmwareUpdateStateChange(state);
+                                });
                             }
                         } else {
                             LOGERR("SystemServices::_instance is NULL.\n");
                         }
                     } break;
 
+                case IARM_BUS_SYSMGR_SYSSTATE_ESTB_IP:
+                case IARM_BUS_SYSMGR_SYSSTATE_ECM_IP:
+                case IARM_BUS_SYSMGR_SYSSTATE_LAN_IP:
+                case IARM_BUS_SYSMGR_SYSSTATE_IP_MODE:
+                    {
+                        if (SystemServices::_instance)
+                            SystemServices::_instance->invalidateVolatileDeviceDetails();
+                    } break;
+
                 case IARM_BUS_SYSMGR_SYSSTATE_TIME_SOURCE:
                     {
                         if (sysEventData->data.systemStates.state)
                         {
                             LOGWARN("Clock is set.");
                             if (SystemServices::_instance) {
-                                SystemServices::_instance->onClockSet();
+                                SystemServices::_instance->dispatchEvent("clockSet", [](SystemServices* service) {
+                                    service->onClockSet();
+                                });
                             } else {
                                 LOGERR("SystemServices::_instance is NULL.\n");
                             }
@@ -3673,7 +4012,9 @@ namespace WPEFramework {
                     string timerStr = std::string(pMsg->currentTime,cTIMER_STATUS_MESSAGE_LENGTH);
 
                 if (SystemServices::_instance) {
-                    SystemServices::_instance->onTimeStatusChanged(timequality,timersrc,timerStr);
+                    SystemServices::_instance->dispatchEvent("timeStatus", [timequality, timersrc, timerStr](SystemServices* service) {
+                        service->onTimeStatusChanged(timequality, timersrc, timerStr);
+                    });
                 } else {
                     LOGERR("SystemServices::_instance is NULL.\n");
                 }
@@ -3772,11 +4113,14 @@ namespace WPEFramework {
                     validparams = false;
                     LOGERR("Invalid temperature levels \n");
             }
+            CThermalMonitor::instance()->onTemperatureReported(param->data.therm.curTemperature);
             if (validparams) {
                 LOGWARN("Invalid temperature levels \n");
                 if (SystemServices::_instance) {
-                    SystemServices::_instance->onTemperatureThresholdChanged(thermLevel,
-                            crossOver, param->data.therm.curTemperature);
+                    float temperature = param->data.therm.curTemperature;
+                    SystemServices::_instance->dispatchEvent("thermal", [thermLevel, crossOver, temperature](SystemServices* service) {
+                        service->onTemperatureThresholdChanged(thermLevel, crossOver, temperature);
+                    });
                 } else {
                     LOGERR("SystemServices::_instance is NULL.\n");
                 }
@@ -4034,6 +4378,38 @@ namespace WPEFramework {
           returnResponse(result);
         }
 
+        /***
+         * @brief : Metrics of the IARM event handling, per event type.
+         * @param1[in]  : {"params":{}}
+         * @param2[out] : {"result":{"events":[{"type":"<string>","dispatched":<int>,"inlined":<int>,
+         *     "queued":<int>,"maxQueued":<int>,"averageLatencyUs":<int>,"maxLatencyUs":<int>,
+         *     "averageHandlingUs":<int>,"maxHandlingUs":<int>}],"success":<bool>}}
+         * @return      : Core::<StatusCode>
+         */
+        uint32_t SystemServices::getEventDispatchMetrics(const JsonObject& parameters, JsonObject& response)
+        {
+            JsonArray events;
+            for (const auto& entry : m_eventDispatcher.metrics()) {
+                const EventDispatcher::Metrics& metrics = entry.second;
+                uint32_t handled = metrics.dispatched - metrics.queued;
+                uint32_t queuedHandled = handled - metrics.inlined;
+
+                JsonObject event;
+                event["type"] = entry.first;
+                event["dispatched"] = metrics.dispatched;
+                event["inlined"] = metrics.inlined;
+                event["queued"] = metrics.queued;
+                event["maxQueued"] = metrics.maxQueued;
+                event["averageLatencyUs"] = queuedHandled ? (int64_t)(metrics.totalLatencyUs / queuedHandled) : 0;
+                event["maxLatencyUs"] = (int64_t)metrics.maxLatencyUs;
+                event["averageHandlingUs"] = handled ? (int64_t)(metrics.totalHandlingUs / handled) : 0;
+                event["maxHandlingUs"] = (int64_t)metrics.maxHandlingUs;
+                events.Add(event);
+            }
+            response["events"] = events;
+            returnResponse(true);
+        }
+
         uint32_t SystemServices::getPlatformConfiguration(const JsonObject &parameters, PlatformCaps &response)
         {
           LOGINFOMETHOD();
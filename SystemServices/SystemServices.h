@@ -21,6 +21,12 @@
 #define SYSTEMSERVICES_H
 
 #include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <thread>
 #include <regex.h>
 
@@ -29,6 +35,7 @@
 #include "utils.h"
 #include "AbstractPlugin.h"
 #include "SystemServicesHelper.h"
+#include "EventDispatcher.h"
 #include "platformcaps/platformcaps.h"
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
 #include "libIARM.h"
@@ -42,6 +49,7 @@
 
 #include "sysMgr.h"
 #include "cSettings.h"
+#include "SystemCacheSnapshot.h"
 #include "cTimer.h"
 #include "rfcapi.h"
 
@@ -52,6 +60,7 @@
 #define EVT_ONFIRMWAREUPDATEINFORECEIVED  "onFirmwareUpdateInfoReceived"
 #define EVT_ONFIRMWAREUPDATESTATECHANGED  "onFirmwareUpdateStateChange"
 #define EVT_ONTEMPERATURETHRESHOLDCHANGED "onTemperatureThresholdChanged"
+#define EVT_ONTEMPERATUREAPPROACHINGTHRESHOLD "onTemperatureApproachingThreshold"
 #define EVT_ONMACADDRESSRETRIEVED         "onMacAddressesRetreived"
 #define EVT_ONREBOOTREQUEST               "onRebootRequest"
 #define EVT_ON_SYSTEM_CLOCK_SET           "onSystemClockSet"
@@ -95,6 +104,7 @@ namespace WPEFramework {
                 typedef Core::JSON::Boolean JBool;
                 string m_stbVersionString;
                 cSettings m_cacheService;
+                Utils::SystemCacheSnapshotWriter m_cacheSnapshot;
                 static cSettings m_temp_settings;
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
                 static IARM_Bus_SYSMgr_GetSystemStates_Param_t paramGetSysState;
@@ -118,8 +128,63 @@ namespace WPEFramework {
                 static cTimer m_operatingModeTimer;
                 static int m_remainingDuration;
                 Utils::ThreadRAII m_getFirmwareInfoThread;
+
+                /* getDeviceInfo and getSerialNumber values, read at start by m_deviceIdentityThread */
+                struct DeviceIdentity {
+                    std::map<std::string, std::string> details;     /* getDeviceDetails.sh read */
+                    bool detailsValid = false;
+                    std::string make;
+                    int makeError = SysSrv_FileNotPresent;
+                    std::string serialNumber;
+                    std::string friendlyId;
+                    bool friendlyIdValid = false;
+                    std::chrono::steady_clock::time_point read;     /* of details, for the volatile ones */
+                    bool valid = false;
+                };
+                DeviceIdentity m_deviceIdentity;
+                bool m_deviceIdentityReading { false };
+                std::mutex m_deviceIdentityMutex;
+                std::condition_variable m_deviceIdentityCV;
+                Utils::ThreadRAII m_deviceIdentityThread;
+                JsonObject m_downloadedFirmwareInfo;
+                bool m_downloadedFirmwareInfoValid { false };
+                std::chrono::steady_clock::time_point m_downloadedFirmwareInfoRead;
+
+                static void readDeviceIdentityAsync(SystemServices *pSs);
+                void readDeviceIdentity();
+                void getDeviceIdentity(DeviceIdentity& identity, bool fresh);
+                static int readMake(std::string& make);
+                static bool isVolatileDeviceDetail(const std::string& key);
+                static void addDeviceDetail(const std::string& key, const std::string& value, JsonObject& response);
+                bool readSerialNumberSnmp(JsonObject& response);
+                bool readDownloadedFirmwareInfo(JsonObject& response);
+
+                /* getTimeZones catalog of ZONEINFO_DIR, built again when a directory of the tree changed.
+                   The time of a zone is its offset applied to the current time, the offsets hold until
+                   the next quarter hour: a zone changes to or from DST on one. */
+                struct TimeZone {
+                    std::string zdump;          /* as zdump printed it, used if it could not be parsed */
+                    long offset = 0;            /* s east of UTC */
+                    std::string abbreviation;
+                    bool parsed = false;
+                };
+                struct TimeZoneCatalog {
+                    std::map<std::string, TimeZone> zones;          /* by path below ZONEINFO_DIR */
+                    std::map<std::string, time_t> directories;      /* mtime of each when built */
+                    time_t built = 0;
+                    bool valid = false;
+                };
+                TimeZoneCatalog m_timeZones;
+                std::mutex m_timeZonesMutex;
+
+                static bool isTimeZoneCatalogCurrent(const TimeZoneCatalog& catalog, time_t now);
+                static void addTimeZones(std::map<std::string, TimeZone>::const_iterator& it,
+                        std::map<std::string, TimeZone>::const_iterator end, const std::string& prefix,
+                        time_t now, JsonObject& out);
                 PluginHost::IShell* m_shellService { nullptr };
                 regex_t m_regexUnallowedChars;
+                /* Handles the IARM events off the IARM threads */
+                EventDispatcher m_eventDispatcher;
 
                 int m_FwUpdateState_LatestEvent;
 
@@ -132,6 +197,7 @@ namespace WPEFramework {
                 static void startModeTimer(int duration);
                 static void stopModeTimer();
                 static void updateDuration();
+                void publishCacheSnapshot();
 #ifdef ENABLE_DEVICE_MANUFACTURER_INFO
                 bool getManufacturerData(const string& parameter, JsonObject& response);
                 uint32_t getMfgSerialNumber(const JsonObject& parameters, JsonObject& response);
@@ -160,6 +226,8 @@ namespace WPEFramework {
                 void InitializeIARM();
                 void DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+                /* Runs the handler on the event dispatcher, after the ones of the same type dispatched before */
+                void dispatchEvent(const string& type, const std::function<void(SystemServices*)>& handler);
 
                 /* Events : Begin */
                 void onFirmwareUpdateInfoRecieved(string CallGUID);
@@ -168,9 +236,12 @@ namespace WPEFramework {
                 void onNetorkModeChanged(bool betworkStandbyMode);
                 void onSystemModeChanged(string mode);
                 void onFirmwareUpdateStateChange(int state);
+                void invalidateVolatileDeviceDetails();
                 void onClockSet();
                 void onTemperatureThresholdChanged(string thresholdType,
                         bool exceed, float temperature);
+                void onTemperatureApproachingThreshold(string thresholdType, float temperature,
+                        float threshold, float rate, int seconds);
 #ifdef ENABLE_SYSTIMEMGR_SUPPORT
                 void onTimeStatusChanged(string timequality,string timesource, string utctime);
 #endif// ENABLE_SYSTIMEMGR_SUPPORT
@@ -234,7 +305,7 @@ namespace WPEFramework {
                 uint32_t getMacAddresses(const JsonObject& parameters, JsonObject& response);
                 uint32_t setTimeZoneDST(const JsonObject& parameters, JsonObject& response);
                 uint32_t getTimeZoneDST(const JsonObject& parameters, JsonObject& response);
-                bool processTimeZones(std::string dir, JsonObject& out);
+                bool processTimeZones(const std::string& dir, TimeZoneCatalog& catalog, time_t now);
                 uint32_t getTimeZones(const JsonObject& parameters, JsonObject& response);
 
                 uint32_t getCoreTemperature(const JsonObject& parameters, JsonObject& response);
@@ -265,6 +336,7 @@ namespace WPEFramework {
                 uint32_t setFirmwareAutoReboot(const JsonObject& parameters, JsonObject& response);
                 uint32_t getStoreDemoLink(const JsonObject& parameters, JsonObject& response);
                 uint32_t deletePersistentPath(const JsonObject& parameters, JsonObject& response);
+                uint32_t getEventDispatchMetrics(const JsonObject& parameters, JsonObject& response);
 #ifdef ENABLE_SET_WAKEUP_SRC_CONFIG
                 uint32_t setWakeupSrcConfiguration(const JsonObject& parameters, JsonObject& response);
 #endif //ENABLE_SET_WAKEUP_SRC_CONFIG
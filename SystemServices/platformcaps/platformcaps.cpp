@@ -22,37 +22,167 @@
 #include "platformcapsdata.h"
 
 #include <regex>
+#include <map>
+#include <mutex>
+#include <functional>
+
+/**
+ * ms, the account and network fields change without SystemServices
+ * hearing of it, the RFC ones may be set by others than SystemServices
+ */
+#define PLATFORMCAPS_VOLATILE_TTL_MS 30000
+#define PLATFORMCAPS_RFC_TTL_MS 300000
+
+namespace {
+  using namespace WPEFramework;
+
+  enum class Lifetime {
+    Firmware,   /* until a firmware update */
+    RFC,        /* until an RFC change, or PLATFORMCAPS_RFC_TTL_MS */
+    Volatile    /* PLATFORMCAPS_VOLATILE_TTL_MS */
+  };
+
+  enum class Filled {
+    Value,      /* reported and kept */
+    Empty,      /* not reported, kept */
+    Failed      /* reported, asked again next time */
+  };
+
+  struct Entry {
+    string json;
+    bool report;
+    Lifetime lifetime;
+    uint64_t read;
+  };
+
+  std::mutex cacheMutex;
+  std::map<string, Entry> cache;   /* by "AccountInfo.accountId" */
+
+  bool isCurrent(const Entry &entry, uint64_t now) {
+    switch (entry.lifetime) {
+      case Lifetime::RFC:
+        return ((now - entry.read) <
+            (PLATFORMCAPS_RFC_TTL_MS * Core::Time::TicksPerMillisecond));
+      case Lifetime::Volatile:
+        return ((now - entry.read) <
+            (PLATFORMCAPS_VOLATILE_TTL_MS * Core::Time::TicksPerMillisecond));
+      default:
+        return true;
+    }
+  }
+
+  /**
+   * Fills the element from the cache, or with fill and keeps it.
+   * @return whether the element is reported
+   */
+  bool cached(const string &key, Lifetime lifetime,
+      Core::JSON::IElement &element, const std::function<Filled()> &fill) {
+    const uint64_t now = Core::Time::Now().Ticks();
+
+    {
+      std::lock_guard<std::mutex> lock(cacheMutex);
+      auto it = cache.find(key);
+      if ((it != cache.end()) && isCurrent(it->second, now)) {
+        if (it->second.report)
+          element.FromString(it->second.json);
+        return it->second.report;
+      }
+    }
+
+    auto filled = fill();
+    if (filled == Filled::Failed)
+      return true;
+
+    const bool report = (filled == Filled::Value);
+    Entry entry{string(), report, lifetime, now};
+    if (report)
+      element.ToString(entry.json);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache[key] = std::move(entry);
+    return report;
+  }
+
+  /* A reply of another plugin that did not come is not kept */
+  Filled filledString(Core::JSON::String &element, const string &value) {
+    element = value;
+    return (value.empty() ? Filled::Failed : Filled::Value);
+  }
+
+  bool wanted(const std::set<string> &fields, const string &field) {
+    return (fields.empty() || (fields.find(field) != fields.end()));
+  }
+}
 
 namespace WPEFramework {
 namespace Plugin {
 
+void PlatformCaps::Invalidate(Change change) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  if (change == Change::FirmwareUpdate) {
+    TRACE(Trace::Information, (_T("%s Firmware update, %zu fields dropped\n"),
+        __FILE__, cache.size()));
+    cache.clear();
+  } else {
+    for (auto it = cache.begin(); it != cache.end();) {
+      if (it->second.lifetime == Lifetime::RFC)
+        it = cache.erase(it);
+      else
+        ++it;
+    }
+  }
+}
+
 bool PlatformCaps::Load(const string &query) {
   bool result = true;
 
   Reset();
 
-  std::smatch m;
-  std::regex_search(query, m,
-      std::regex("^(AccountInfo|DeviceInfo)(\\.(\\w*)){0,1}"));
+  bool accountAll = query.empty(), deviceAll = query.empty();
+  std::set<string> accountFields, deviceFields;
+
+  /* Several subtrees are separated by ',', a group without a field is all of it */
+  std::sregex_token_iterator part(query.begin(), query.end(), std::regex(","), -1);
+  for (; result && !query.empty() && (part != std::sregex_token_iterator()); ++part) {
+    const string subtree = *part;
+    std::smatch m;
+    std::regex_search(subtree, m,
+        std::regex("^(AccountInfo|DeviceInfo)(\\.(\\w*)){0,1}"));
+
+    if (m.empty()) {
+      TRACE(Trace::Error, (_T("%s Bad query '%s'\n"),
+          __FILE__, query.c_str()));
+      result = false;
+    } else {
+      const bool isAccount = (m[1] == _T("AccountInfo"));
+      const string field = m[3];
+      if (field.empty())
+        (isAccount ? accountAll : deviceAll) = true;
+      else
+        (isAccount ? accountFields : deviceFields).insert(field);
+    }
+  }
+
+  if (accountAll)
+    accountFields.clear();
+  if (deviceAll)
+    deviceFields.clear();
 
-  if (query.empty() || !m.empty()) {
-    if (query.empty() || (m[1] == _T("AccountInfo"))) {
-      if (!accountInfo.Load(m.size() > 3 ? m[3] : string())) {
+  if (result) {
+    if (accountAll || !accountFields.empty()) {
+      if (!accountInfo.Load(accountFields)) {
         result = false;
       }
       Add(_T("AccountInfo"), &accountInfo);
     }
 
-    if (query.empty() || (m[1] == _T("DeviceInfo"))) {
-      if (!deviceInfo.Load(m.size() > 3 ? m[3] : string())) {
+    if (deviceAll || !deviceFields.empty()) {
+      if (!deviceInfo.Load(deviceFields)) {
         result = false;
       }
       Add(_T("DeviceInfo"), &deviceInfo);
     }
-  } else {
-    TRACE(Trace::Error, (_T("%s Bad query '%s'\n"),
-        __FILE__, query.c_str()));
-    result = false;
   }
 
   success = result;
@@ -61,66 +191,83 @@ bool PlatformCaps::Load(const string &query) {
   return result;
 }
 
-bool PlatformCaps::AccountInfo::Load(const string &query) {
+bool PlatformCaps::AccountInfo::Load(const std::set<string> &fields) {
   bool result = true;
 
   Reset();
 
   PlatformCapsData data;
 
-  if (query.empty() || query == _T("accountId")) {
-    accountId = data.GetAccountId();
+  if (wanted(fields, _T("accountId"))) {
+    cached(_T("AccountInfo.accountId"), Lifetime::Volatile, accountId, [&]() {
+      return filledString(accountId, data.GetAccountId());
+    });
     Add(_T("accountId"), &accountId);
   }
 
-  if (query.empty() || query == _T("x1DeviceId")) {
-    x1DeviceId = data.GetX1DeviceId();
+  if (wanted(fields, _T("x1DeviceId"))) {
+    cached(_T("AccountInfo.x1DeviceId"), Lifetime::Volatile, x1DeviceId, [&]() {
+      return filledString(x1DeviceId, data.GetX1DeviceId());
+    });
     Add(_T("x1DeviceId"), &x1DeviceId);
   }
 
-  if (query.empty() || query == _T("XCALSessionTokenAvailable")) {
-    XCALSessionTokenAvailable = data.XCALSessionTokenAvailable();
+  if (wanted(fields, _T("XCALSessionTokenAvailable"))) {
+    cached(_T("AccountInfo.XCALSessionTokenAvailable"), Lifetime::Volatile, XCALSessionTokenAvailable, [&]() {
+      XCALSessionTokenAvailable = data.XCALSessionTokenAvailable();
+      return Filled::Value;
+    });
     Add(_T("XCALSessionTokenAvailable"), &XCALSessionTokenAvailable);
   }
 
-  if (query.empty() || query == _T("experience")) {
-    experience = data.GetExperience();
+  if (wanted(fields, _T("experience"))) {
+    cached(_T("AccountInfo.experience"), Lifetime::Volatile, experience, [&]() {
+      return filledString(experience, data.GetExperience());
+    });
     Add(_T("experience"), &experience);
   }
 
-  if (query.empty() || query == _T("deviceMACAddress")) {
-    deviceMACAddress = data.GetDdeviceMACAddress();
+  if (wanted(fields, _T("deviceMACAddress"))) {
+    cached(_T("AccountInfo.deviceMACAddress"), Lifetime::Firmware, deviceMACAddress, [&]() {
+      return filledString(deviceMACAddress, data.GetDdeviceMACAddress());
+    });
     Add(_T("deviceMACAddress"), &deviceMACAddress);
   }
 
-  if (query.empty() || query == _T("firmwareUpdateDisabled")) {
-    firmwareUpdateDisabled = data.GetFirmwareUpdateDisabled();
+  if (wanted(fields, _T("firmwareUpdateDisabled"))) {
+    cached(_T("AccountInfo.firmwareUpdateDisabled"), Lifetime::Volatile, firmwareUpdateDisabled, [&]() {
+      firmwareUpdateDisabled = data.GetFirmwareUpdateDisabled();
+      return Filled::Value;
+    });
     Add(_T("firmwareUpdateDisabled"), &firmwareUpdateDisabled);
   }
 
   return result;
 }
 
-bool PlatformCaps::DeviceInfo::Load(const string &query) {
+bool PlatformCaps::DeviceInfo::Load(const std::set<string> &fields) {
   bool result = true;
 
   Reset();
 
   PlatformCapsData data;
 
-  if (query.empty() || query == _T("quirks")) {
+  if (wanted(fields, _T("quirks"))) {
     quirks.Clear();
-    auto q = data.GetQuirks();
-    for (const auto &value: q)
-      quirks.Add() = value;
+    cached(_T("DeviceInfo.quirks"), Lifetime::Firmware, quirks, [&]() {
+      auto q = data.GetQuirks();
+      for (const auto &value: q)
+        quirks.Add() = value;
+      return Filled::Value;
+    });
     Add(_T("quirks"), &quirks);
   }
 
-  if (query.empty() || query == _T("mimeTypeExclusions")) {
+  if (wanted(fields, _T("mimeTypeExclusions"))) {
     mimeTypeExclusions.Reset();
-    std::map <string, std::list<string>> hash;
-    data.AddDashExclusionList(hash);
-    if (!hash.empty()) {
+    if (cached(_T("DeviceInfo.mimeTypeExclusions"), Lifetime::RFC, mimeTypeExclusions, [&]() {
+      std::map <string, std::list<string>> hash;
+      data.AddDashExclusionList(hash);
       for (auto &it: hash) {
         JsonArray jsonArray;
         for (auto &jt: it.second) {
@@ -128,64 +275,85 @@ bool PlatformCaps::DeviceInfo::Load(const string &query) {
         }
         mimeTypeExclusions[it.first.c_str()] = jsonArray;
       }
+      return (hash.empty() ? Filled::Empty : Filled::Value);
+    })) {
       Add(_T("mimeTypeExclusions"), &mimeTypeExclusions);
     }
   }
 
-  if (query.empty() || query == _T("features")) {
+  if (wanted(fields, _T("features"))) {
     features.Reset();
-    auto hash = data.DeviceCapsFeatures();
-    if (!hash.empty()) {
+    if (cached(_T("DeviceInfo.features"), Lifetime::Firmware, features, [&]() {
+      auto hash = data.DeviceCapsFeatures();
       for (auto &it: hash) {
         features[it.first.c_str()] = it.second;
       }
+      return (hash.empty() ? Filled::Empty : Filled::Value);
+    })) {
       Add(_T("features"), &features);
     }
   }
 
-  if (query.empty() || query == _T("mimeTypes")) {
+  if (wanted(fields, _T("mimeTypes"))) {
     mimeTypes.Clear();
-    auto q = data.GetMimeTypes();
-    for (const auto &value: q)
-      mimeTypes.Add() = value;
+    cached(_T("DeviceInfo.mimeTypes"), Lifetime::Firmware, mimeTypes, [&]() {
+      auto q = data.GetMimeTypes();
+      for (const auto &value: q)
+        mimeTypes.Add() = value;
+      return Filled::Value;
+    });
     Add(_T("mimeTypes"), &mimeTypes);
   }
 
-  if (query.empty() || query == _T("model")) {
-    model = data.GetModel();
+  if (wanted(fields, _T("model"))) {
+    cached(_T("DeviceInfo.model"), Lifetime::Firmware, model, [&]() {
+      return filledString(model, data.GetModel());
+    });
     Add(_T("model"), &model);
   }
 
-  if (query.empty() || query == _T("deviceType")) {
-    deviceType = data.GetDeviceType();
+  if (wanted(fields, _T("deviceType"))) {
+    cached(_T("DeviceInfo.deviceType"), Lifetime::Firmware, deviceType, [&]() {
+      return filledString(deviceType, data.GetDeviceType());
+    });
     Add(_T("deviceType"), &deviceType);
   }
 
-  if (query.empty() || query == _T("supportsTrueSD")) {
+  if (wanted(fields, _T("supportsTrueSD"))) {
     supportsTrueSD = data.SupportsTrueSD();
     Add(_T("supportsTrueSD"), &supportsTrueSD);
   }
 
-  if (query.empty() || query == _T("webBrowser")) {
-    auto b = data.GetBrowser();
-    webBrowser.browserType = std::get<0>(b);
-    webBrowser.version = std::get<1>(b);
-    webBrowser.userAgent = std::get<2>(b);
+  if (wanted(fields, _T("webBrowser"))) {
+    cached(_T("DeviceInfo.webBrowser"), Lifetime::Firmware, webBrowser, [&]() {
+      auto b = data.GetBrowser();
+      webBrowser.browserType = std::get<0>(b);
+      webBrowser.version = std::get<1>(b);
+      webBrowser.userAgent = std::get<2>(b);
+      return Filled::Value;
+    });
     Add(_T("webBrowser"), &webBrowser);
   }
 
-  if (query.empty() || query == _T("HdrCapability")) {
-    HdrCapability = data.GetHDRCapability();
+  if (wanted(fields, _T("HdrCapability"))) {
+    cached(_T("DeviceInfo.HdrCapability"), Lifetime::Firmware, HdrCapability, [&]() {
+      return filledString(HdrCapability, data.GetHDRCapability());
+    });
     Add(_T("HdrCapability"), &HdrCapability);
   }
 
-  if (query.empty() || query == _T("canMixPCMWithSurround")) {
-    canMixPCMWithSurround = data.CanMixPCMWithSurround();
+  if (wanted(fields, _T("canMixPCMWithSurround"))) {
+    cached(_T("DeviceInfo.canMixPCMWithSurround"), Lifetime::Firmware, canMixPCMWithSurround, [&]() {
+      canMixPCMWithSurround = data.CanMixPCMWithSurround();
+      return Filled::Value;
+    });
     Add(_T("canMixPCMWithSurround"), &canMixPCMWithSurround);
   }
 
-  if (query.empty() || query == _T("publicIP")) {
-    publicIP = data.GetPublicIP();
+  if (wanted(fields, _T("publicIP"))) {
+    cached(_T("DeviceInfo.publicIP"), Lifetime::Volatile, publicIP, [&]() {
+      return filledString(publicIP, data.GetPublicIP());
+    });
     Add(_T("publicIP"), &publicIP);
   }
 
@@ -21,6 +21,8 @@
 
 #include "../Module.h"
 
+#include <set>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -45,10 +47,10 @@ public:
     AccountInfo() = default;
 
     /**
-     * @param query - e.g. "accountId", "" (all)
+     * @param fields - e.g. {"accountId"}, {} (all)
      * @return
      */
-    bool Load(const string &query = string());
+    bool Load(const std::set<string> &fields = std::set<string>());
 
     Core::JSON::String accountId;
     Core::JSON::String x1DeviceId;
@@ -63,10 +65,10 @@ public:
     DeviceInfo() = default;
 
     /**
-     * @param query - e.g. "deviceType", "" (all)
+     * @param fields - e.g. {"deviceType"}, {} (all)
      * @return
      */
-    bool Load(const string &query = string());
+    bool Load(const std::set<string> &fields = std::set<string>());
 
     Core::JSON::ArrayType <Core::JSON::String> quirks;
     JsonObject mimeTypeExclusions;
@@ -81,15 +83,31 @@ public:
     Core::JSON::String publicIP;
   };
 
+public:
+  /**
+   * What the cached fields depend on, see Invalidate
+   */
+  enum class Change {
+    FirmwareUpdate,
+    RFC
+  };
+
 public:
   PlatformCaps() = default;
 
   /**
-   * @param query - e.g. "AccountInfo.accountId", "DeviceInfo", "" (all)
+   * @param query - e.g. "AccountInfo.accountId", "DeviceInfo",
+   *   "DeviceInfo.model,AccountInfo" (several), "" (all)
    * @return
    */
   bool Load(const string &query = string());
 
+  /**
+   * Fields are computed when first asked for and kept, until a change they
+   * depend on. Those of the account and the network are kept for a short time.
+   */
+  static void Invalidate(Change change);
+
   AccountInfo accountInfo;
   DeviceInfo deviceInfo;
   Core::JSON::Boolean success;
@@ -21,9 +21,15 @@
 
 #include "utils.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 // Methods
 #define TELEMETRY_METHOD_SET_REPORT_PROFILE_STATUS"setReportProfileStatus"
 #define TELEMETRY_METHOD_LOG_APPLICATION_EVENT "logApplicationEvent"
+#define TELEMETRY_METHOD_LOG_APPLICATION_EVENTS "logApplicationEvents"
+#define TELEMETRY_METHOD_SET_EVENT_AGGREGATION "setEventAggregation"
+#define TELEMETRY_METHOD_GET_METRICS "getMetrics"
 
 #define RFC_CALLERID "Telemetry"
 #define RFC_REPORT_PROFILES "Device.X_RDKCENTRAL-COM_T2.ReportProfiles"
@@ -46,6 +52,14 @@ namespace WPEFramework
 
             registerMethod(TELEMETRY_METHOD_SET_REPORT_PROFILE_STATUS, &Telemetry::setReportProfileStatus, this);
             registerMethod(TELEMETRY_METHOD_LOG_APPLICATION_EVENT, &Telemetry::logApplicationEvent, this);
+            registerMethod(TELEMETRY_METHOD_LOG_APPLICATION_EVENTS, &Telemetry::logApplicationEvents, this);
+            registerMethod(TELEMETRY_METHOD_SET_EVENT_AGGREGATION, &Telemetry::setEventAggregation, this);
+            registerMethod(TELEMETRY_METHOD_GET_METRICS, &Telemetry::getMetrics, this);
+
+            m_reportTimer.connect([this]() {
+                flushAggregates();
+                flushMetrics();
+            });
         }
 
         Telemetry::~Telemetry()
@@ -55,6 +69,15 @@ namespace WPEFramework
 
         const string Telemetry::Initialize(PluginHost::IShell* service )
         {
+            Config config;
+            if (service)
+                config.FromString(service->ConfigLine());
+
+            if (config.AggregationWindow.Value() > 0)
+            {
+                LOGINFO("Aggregated events are reported every %u s", config.AggregationWindow.Value());
+                m_reportTimer.start(config.AggregationWindow.Value() * 1000);
+            }
 
             bool isEMpty = true;
             DIR *d = opendir(T2_PERSISTENT_FOLDER);
@@ -127,6 +150,18 @@ namespace WPEFramework
 
         void Telemetry::Deinitialize(PluginHost::IShell* /* service */)
         {
+            if (m_reportTimer.isActive())
+            {
+                m_reportTimer.stop();
+            }
+            flushAggregates();
+            flushMetrics();
+
+            {
+                std::lock_guard<std::mutex> lock(m_metricsLock);
+                m_metrics.clear();
+            }
+
             Telemetry::_instance = nullptr;
         }
 
@@ -152,6 +187,10 @@ namespace WPEFramework
                     returnResponse(false);
                 }
 
+                // The report profile is done, don't keep its aggregated events back until the window ends
+                if (status == "COMPLETE")
+                    flushAggregates();
+
                 returnResponse(true);
 
             }
@@ -178,9 +217,7 @@ namespace WPEFramework
                 string eventValue;
                 getStringParameter("eventValue", eventValue);
 
-                LOGINFO("eventName:%s, eventValue:%s", eventName.c_str(), eventValue.c_str());
-
-                LOGT2((char *)eventName.c_str(), (char *)eventValue.c_str());
+                logEvent(eventName, eventValue, true);
             }
             else
             {
@@ -191,6 +228,253 @@ namespace WPEFramework
             returnResponse(true);
         }
 
+        uint32_t Telemetry::logApplicationEvents(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFO();
+
+            if (!parameters.HasLabel("events") || parameters["events"].Content() != Core::JSON::Variant::type::ARRAY)
+            {
+                LOGERR("No 'events' array parameter");
+                returnResponse(false);
+            }
+
+            JsonArray events = parameters["events"].Array();
+            uint32_t logged = 0;
+
+            for (int i = 0; i < events.Length(); i++)
+            {
+                JsonObject event = events[i].Object();
+                if (event.HasLabel("eventName") && event.HasLabel("eventValue"))
+                {
+                    logEvent(event["eventName"].String(), event["eventValue"].String(), false);
+                    logged++;
+                }
+                else
+                {
+                    LOGERR("Skipping event %d without 'eventName' or 'eventValue'", i);
+                }
+            }
+
+            LOGINFO("Logged %u of %d events", logged, events.Length());
+            response["logged"] = logged;
+            returnResponse(logged == (uint32_t)events.Length());
+        }
+
+        uint32_t Telemetry::setEventAggregation(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            returnIfStringParamNotFound(parameters, "eventName");
+            string eventName = parameters["eventName"].String();
+
+            bool enabled = true;
+            if (parameters.HasLabel("enabled"))
+                getBoolParameter("enabled", enabled);
+
+            if (!enabled)
+            {
+                // Report what was collected so far, then go back to forwarding every event
+                flushAggregates(eventName);
+                std::lock_guard<std::mutex> lock(m_aggregatesLock);
+                m_aggregates.erase(eventName);
+                returnResponse(true);
+            }
+
+            std::vector<double> bounds;
+            if (parameters.HasLabel("buckets"))
+            {
+                JsonArray buckets = parameters["buckets"].Array();
+                for (int i = 0; i < buckets.Length(); i++)
+                    bounds.push_back(buckets[i].Float());
+                std::sort(bounds.begin(), bounds.end());
+                bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+            }
+
+            flushAggregates(eventName);
+
+            std::lock_guard<std::mutex> lock(m_aggregatesLock);
+            Aggregate& aggregate = m_aggregates[eventName];
+            aggregate.bounds = bounds;
+            resetAggregate(aggregate);
+
+            returnResponse(true);
+        }
+
+        /**
+         * Forwards an event to T2 or, if its eventName is aggregated, adds it to the current window.
+         * Aggregated values that are not numbers are only counted.
+         */
+        void Telemetry::logEvent(const string& eventName, const string& eventValue, bool verbose)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_aggregatesLock);
+                auto it = m_aggregates.find(eventName);
+                if (it != m_aggregates.end())
+                {
+                    Aggregate& aggregate = it->second;
+                    aggregate.count++;
+
+                    char* end = nullptr;
+                    double value = strtod(eventValue.c_str(), &end);
+                    if (!eventValue.empty() && end != nullptr && *end == '\0')
+                    {
+                        aggregate.min = (aggregate.numeric == 0) ? value : std::min(aggregate.min, value);
+                        aggregate.max = (aggregate.numeric == 0) ? value : std::max(aggregate.max, value);
+                        aggregate.sum += value;
+                        aggregate.numeric++;
+
+                        size_t bucket = std::lower_bound(aggregate.bounds.begin(), aggregate.bounds.end(), value) - aggregate.bounds.begin();
+                        aggregate.histogram[bucket]++;
+                    }
+                    return;
+                }
+            }
+
+            if (verbose)
+                LOGINFO("eventName:%s, eventValue:%s", eventName.c_str(), eventValue.c_str());
+
+            LOGT2((char *)eventName.c_str(), (char *)eventValue.c_str());
+        }
+
+        /**
+         * Sends the aggregates of the window to T2 as "count,sum,min,max[,bucket,...]" and starts a new window.
+         * Only eventName is flushed if it is given.
+         */
+        void Telemetry::flushAggregates(const string& eventName)
+        {
+            std::vector<std::pair<string, string>> reports;
+
+            {
+                std::lock_guard<std::mutex> lock(m_aggregatesLock);
+                for (auto& entry : m_aggregates)
+                {
+                    Aggregate& aggregate = entry.second;
+                    if ((!eventName.empty() && entry.first != eventName) || aggregate.count == 0)
+                        continue;
+
+                    char buffer[128];
+                    snprintf(buffer, sizeof(buffer), "%u,%.15g,%.15g,%.15g", aggregate.count, aggregate.sum, aggregate.min, aggregate.max);
+                    string value = buffer;
+                    if (!aggregate.bounds.empty())
+                    {
+                        for (uint32_t bucket : aggregate.histogram)
+                            value += "," + std::to_string(bucket);
+                    }
+
+                    reports.emplace_back(entry.first, value);
+                    resetAggregate(aggregate);
+                }
+            }
+
+            for (const auto& report : reports)
+            {
+                LOGINFO("eventName:%s, aggregate:%s", report.first.c_str(), report.second.c_str());
+                LOGT2((char *)report.first.c_str(), (char *)report.second.c_str());
+            }
+        }
+
+        uint32_t Telemetry::getMetrics(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFO();
+
+            JsonArray modules;
+
+            std::lock_guard<std::mutex> lock(m_metricsLock);
+            for (const auto& entry : m_metrics)
+            {
+                std::vector<Utils::Metrics::Sample> samples;
+                entry.first->collect(samples, false);
+
+                JsonArray metrics;
+                for (const Utils::Metrics::Sample& sample : samples)
+                {
+                    JsonObject metric;
+                    metric["name"] = sample.name;
+                    metric["type"] = sample.histogram ? "histogram" : "counter";
+                    metric["count"] = sample.summary.count;
+                    if (sample.histogram)
+                    {
+                        metric["sum"] = sample.summary.sum;
+                        metric["min"] = sample.summary.min;
+                        metric["max"] = sample.summary.max;
+                        metric["p50"] = sample.summary.p50;
+                        metric["p90"] = sample.summary.p90;
+                        metric["p99"] = sample.summary.p99;
+                    }
+                    metrics.Add(metric);
+                }
+
+                JsonObject module;
+                module["module"] = entry.second;
+                module["metrics"] = metrics;
+                modules.Add(module);
+            }
+
+            response["modules"] = modules;
+            returnResponse(true);
+        }
+
+        void Telemetry::Attach(const string& module, Utils::Metrics::Registry* registry)
+        {
+            LOGINFO("Collecting the metrics of %s", module.c_str());
+
+            std::lock_guard<std::mutex> lock(m_metricsLock);
+            m_metrics[registry] = module;
+        }
+
+        void Telemetry::Detach(Utils::Metrics::Registry* registry)
+        {
+            std::lock_guard<std::mutex> lock(m_metricsLock);
+            m_metrics.erase(registry);
+        }
+
+        /**
+         * Drains the attached registries and sends one T2 marker per metric that changed in the window,
+         * a counter as its value and a histogram as "count,sum,min,max,p50,p90,p99".
+         */
+        void Telemetry::flushMetrics()
+        {
+            std::vector<std::pair<string, string>> reports;
+
+            {
+                std::lock_guard<std::mutex> lock(m_metricsLock);
+                for (const auto& entry : m_metrics)
+                {
+                    std::vector<Utils::Metrics::Sample> samples;
+                    entry.first->collect(samples, true);
+
+                    for (const Utils::Metrics::Sample& sample : samples)
+                    {
+                        if (sample.summary.count == 0)
+                            continue;
+
+                        string value = std::to_string(sample.summary.count);
+                        if (sample.histogram)
+                        {
+                            const uint64_t fields[] = { sample.summary.sum, sample.summary.min, sample.summary.max,
+                                sample.summary.p50, sample.summary.p90, sample.summary.p99 };
+                            for (uint64_t field : fields)
+                                value += "," + std::to_string(field);
+                        }
+                        reports.emplace_back(sample.name, value);
+                    }
+                }
+            }
+
+            for (const auto& report : reports)
+                LOGT2((char *)report.first.c_str(), (char *)report.second.c_str());
+        }
+
+        void Telemetry::resetAggregate(Aggregate& aggregate)
+        {
+            aggregate.count = 0;
+            aggregate.numeric = 0;
+            aggregate.sum = 0;
+            aggregate.min = 0;
+            aggregate.max = 0;
+            aggregate.histogram.assign(aggregate.bounds.size() + 1, 0);
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
 
@@ -22,6 +22,15 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "tptimer.h"
+#include "Metrics.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Seconds over which aggregated events are collected before they are sent to T2
+#define TELEMETRY_AGGREGATION_WINDOW 900
 
 namespace WPEFramework {
 
@@ -40,27 +49,81 @@ namespace WPEFramework {
         // As the registration/unregistration of notifications is realized by the class PluginHost::JSONRPC,
         // this class exposes a public method called, Notify(), using this methods, all subscribed clients
         // will receive a JSONRPC message as a notification, in case this method is called.
-        class Telemetry : public AbstractPlugin {
+        class Telemetry : public AbstractPlugin, public Exchange::IMetricsCollector {
         private:
 
             // We do not allow this plugin to be copied !!
             Telemetry(const Telemetry&) = delete;
             Telemetry& operator=(const Telemetry&) = delete;
 
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : AggregationWindow(TELEMETRY_AGGREGATION_WINDOW)
+                {
+                    Add(_T("aggregationwindow"), &AggregationWindow);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 AggregationWindow; // s between reports of aggregated events
+            };
+
+            // Events of an aggregated eventName within the current window
+            struct Aggregate
+            {
+                std::vector<double> bounds;         // upper bounds of the histogram buckets, ascending
+                std::vector<uint32_t> histogram;    // one more bucket than bounds, for the values above them
+                uint32_t count;
+                uint32_t numeric;
+                double sum;
+                double min;
+                double max;
+            };
+
             //Begin methods
             uint32_t setReportProfileStatus(const JsonObject& parameters, JsonObject& response);
             uint32_t logApplicationEvent(const JsonObject& parameters, JsonObject& response);
+            uint32_t logApplicationEvents(const JsonObject& parameters, JsonObject& response);
+            uint32_t setEventAggregation(const JsonObject& parameters, JsonObject& response);
+            uint32_t getMetrics(const JsonObject& parameters, JsonObject& response);
             //End methods
 
+            void logEvent(const string& eventName, const string& eventValue, bool verbose);
+            void flushAggregates(const string& eventName = string());
+            static void resetAggregate(Aggregate& aggregate);
+            void flushMetrics();
+
         public:
             Telemetry();
             virtual ~Telemetry();
             virtual const string Initialize(PluginHost::IShell* service) override;
             virtual void Deinitialize(PluginHost::IShell* service) override;
 
+            // Exchange::IMetricsCollector
+            virtual void Attach(const string& module, Utils::Metrics::Registry* registry) override;
+            virtual void Detach(Utils::Metrics::Registry* registry) override;
+
+            BEGIN_INTERFACE_MAP(Telemetry)
+            INTERFACE_ENTRY(PluginHost::IPlugin)
+            INTERFACE_ENTRY(PluginHost::IDispatcher)
+            INTERFACE_ENTRY(Exchange::IMetricsCollector)
+            END_INTERFACE_MAP
+
         public:
             static Telemetry* _instance;
         private:
+            std::map<string, Aggregate> m_aggregates;
+            std::mutex m_aggregatesLock;
+            TpTimer m_reportTimer;
+            std::map<Utils::Metrics::Registry*, string> m_metrics; // registry -> callsign of its plugin
+            std::mutex m_metricsLock;
         };
     } // namespace Plugin
 } // namespace WPEFramework
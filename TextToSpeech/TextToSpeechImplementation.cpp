@@ -22,6 +22,8 @@
 
 #define TTS_MAJOR_VERSION 1
 #define TTS_MINOR_VERSION 0
+#define TTS_CACHE_MEMORY_DEFAULT 1024
+#define TTS_QUEUE_DEPTH_DEFAULT 16
 
 #define GET_STR(map, key, def) ((map.HasLabel(key) && !map[key].String().empty() && map[key].String() != "null") ? map[key].String() : def)
 #define CONVERT_PARAMETERS_TOJSON() JsonObject parameters, response; parameters.FromString(input);
@@ -82,6 +84,30 @@ namespace Plugin {
         } else {
             TTSLOG_WARNING("Doesn't find default voice configuration");
         }
+
+        // Synthesized audio is cached in memory (kB), "path" enables flash (kB) too
+        uint32_t cacheMemory = TTS_CACHE_MEMORY_DEFAULT;
+        uint32_t cacheFlash = 0;
+        string cachePath;
+        if(config.HasLabel("cache")) {
+            JsonObject cache = config["cache"].Object();
+            cacheMemory = std::stoul(GET_STR(cache, "memory", std::to_string(TTS_CACHE_MEMORY_DEFAULT)));
+            cacheFlash = std::stoul(GET_STR(cache, "flash", "0"));
+            cachePath = GET_STR(cache, "path", "");
+        }
+        _ttsManager->configureCache(cacheMemory * 1024, cachePath, cachePath.empty() ? 0 : cacheFlash * 1024);
+
+        // Speech queued at most, 0 for no limit. "coalesce" is "stale" or "latest"
+        uint32_t queueDepth = TTS_QUEUE_DEPTH_DEFAULT;
+        TTS::QueuePolicy queuePolicy = TTS::QUEUE_DROP_STALE;
+        if(config.HasLabel("queue")) {
+            JsonObject queue = config["queue"].Object();
+            queueDepth = std::stoul(GET_STR(queue, "depth", std::to_string(TTS_QUEUE_DEPTH_DEFAULT)));
+            if(GET_STR(queue, "coalesce", "stale") == "latest")
+                queuePolicy = TTS::QUEUE_KEEP_LATEST;
+        }
+        _ttsManager->configureQueue(queueDepth, queuePolicy);
+
         ttsConfig->loadFromConfigStore();
         TTSLOG_INFO("TTSEndPoint : %s", ttsConfig->endPoint().c_str());
         TTSLOG_INFO("SecureTTSEndPoint : %s", ttsConfig->secureEndPoint().c_str());
@@ -255,8 +281,12 @@ namespace Plugin {
 
         _adminLock.Lock();
 
+        TTS::SpeechPriority priority = TTS::SPEECH_PRIORITY_NORMAL;
+        if(GET_STR(parameters, "priority", "normal") == "alert")
+            priority = TTS::SPEECH_PRIORITY_ALERT;
+
         uint32_t speechId = nextSpeechId();
-        auto status = _ttsManager->speak(speechId, parameters["text"].String());
+        auto status = _ttsManager->speak(speechId, parameters["text"].String(), priority);
 
         _adminLock.Unlock();
 
@@ -456,6 +486,22 @@ namespace Plugin {
         dispatchEvent(SPEECH_CANCEL, params);
     }
 
+    void TextToSpeechImplementation::onSpeechDropped(std::vector<uint32_t> speechIds, uint32_t total)
+    {
+        std::stringstream ss;
+        for(auto it = speechIds.begin(); it != speechIds.end(); ++it)
+        {
+            if(it != speechIds.begin())
+                ss << ",";
+            ss << *it;
+        }
+        JsonObject params;
+        params["speechid"]  = ss.str();
+        params["reason"]    = "dropped";
+        params["dropped"]   = JsonValue((int)total);
+        dispatchEvent(SPEECH_CANCEL, params);
+    }
+
     void TextToSpeechImplementation::onSpeechInterrupted(uint32_t speechId)
     {
         JsonObject params;
@@ -112,6 +112,7 @@ namespace Plugin {
         virtual void onSpeechPause(uint32_t speechId) override ;
         virtual void onSpeechResume(uint32_t speechId) override ;
         virtual void onSpeechCancelled(std::vector<uint32_t> speechIds) override ;
+        virtual void onSpeechDropped(std::vector<uint32_t> speechIds, uint32_t total) override ;
         virtual void onSpeechInterrupted(uint32_t speechId) override ;
         virtual void onNetworkError(uint32_t speechId) override ;
         virtual void onPlaybackError(uint32_t speechId) override ;
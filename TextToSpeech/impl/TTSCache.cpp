@@ -0,0 +1,359 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TTSCache.h"
+#include "logger.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+
+#define TTS_CACHE_FILE_MAGIC "TTSC"
+#define TTS_CACHE_FILE_SUFFIX ".tts"
+
+namespace TTS {
+
+TTSCache::TTSCache() :
+    m_memoryLimit(0),
+    m_memorySize(0),
+    m_flashLimit(0),
+    m_flashSize(0),
+    m_hits(0),
+    m_misses(0) { }
+
+TTSCache::~TTSCache() {}
+
+void TTSCache::configure(size_t memoryLimit, const std::string &directory, size_t flashLimit) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_memoryLimit = memoryLimit;
+    evictMemory();
+
+    m_flash.clear();
+    m_flashIndex.clear();
+    m_flashSize = 0;
+    m_flashLimit = flashLimit;
+    m_directory = (flashLimit > 0) ? directory : "";
+
+    if(!m_directory.empty()) {
+        if(m_directory.back() == '/')
+            m_directory.pop_back();
+
+        if(mkdir(m_directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            TTSLOG_ERROR("Can't create cache directory %s (%s), flash cache disabled", m_directory.c_str(), strerror(errno));
+            m_directory.clear();
+        } else {
+            loadFlashIndex();
+            evictFlash();
+        }
+    }
+
+    TTSLOG_INFO("Audio cache: memory=%zu bytes, flash=%zu bytes at \"%s\" (%zu entries)",
+            m_memoryLimit, m_directory.empty() ? 0 : m_flashLimit, m_directory.c_str(), m_flash.size());
+}
+
+bool TTSCache::enabled() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryLimit > 0 || !m_directory.empty();
+}
+
+std::string TTSCache::key(const std::string &format, const std::string &voice, uint8_t rate,
+        const std::string &language, const std::string &sanitizedText) {
+    // The sanitized text is url escaped, it can't contain the separator
+    std::string key(format);
+    key.append("|").append(voice);
+    key.append("|").append(std::to_string(rate));
+    key.append("|").append(language);
+    key.append("|").append(sanitizedText);
+    return key;
+}
+
+bool TTSCache::lookup(const std::string &key, Audio &audio) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_memoryIndex.find(key);
+    if(it != m_memoryIndex.end()) {
+        m_memory.splice(m_memory.begin(), m_memory, it->second);
+        audio = it->second->audio;
+        m_hits++;
+        TTSLOG_INFO("Memory cache hit, %u hits / %u misses", m_hits, m_misses);
+        return true;
+    }
+
+    if(!m_directory.empty() && readFlash(key, audio)) {
+        if(m_memoryLimit > 0)
+            store(key, audio);
+        m_hits++;
+        TTSLOG_INFO("Flash cache hit, %u hits / %u misses", m_hits, m_misses);
+        return true;
+    }
+
+    m_misses++;
+    return false;
+}
+
+bool TTSCache::contains(const std::string &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryIndex.find(key) != m_memoryIndex.end() ||
+        (!m_directory.empty() && m_flashIndex.find(fileName(key)) != m_flashIndex.end());
+}
+
+void TTSCache::insert(const std::string &key, const std::string &caps, std::vector<uint8_t> &&data) {
+    Audio audio;
+    audio.caps = caps;
+    audio.data = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+    insert(key, audio);
+}
+
+void TTSCache::insert(const std::string &key, const Audio &audio) {
+    if(!audio.data || audio.data->empty() || audio.data->size() > TTS_CACHE_MAX_ENTRY)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_memoryLimit > 0)
+        store(key, audio);
+
+    if(!m_directory.empty())
+        writeFlash(key, audio);
+
+    TTSLOG_VERBOSE("Cached %zu bytes, memory holds %zu entries / %zu bytes",
+            audio.data->size(), m_memory.size(), m_memorySize);
+}
+
+void TTSCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_memory.clear();
+    m_memoryIndex.clear();
+    m_memorySize = 0;
+
+    for(auto it = m_flash.begin(); it != m_flash.end(); ++it)
+        unlink(filePath(it->name).c_str());
+    m_flash.clear();
+    m_flashIndex.clear();
+    m_flashSize = 0;
+}
+
+void TTSCache::store(const std::string &key, const Audio &audio) {
+    auto it = m_memoryIndex.find(key);
+    if(it != m_memoryIndex.end()) {
+        m_memorySize -= it->second->audio.data->size();
+        m_memory.erase(it->second);
+        m_memoryIndex.erase(it);
+    }
+
+    MemoryEntry entry;
+    entry.key = key;
+    entry.audio = audio;
+    m_memory.push_front(entry);
+    m_memoryIndex[key] = m_memory.begin();
+    m_memorySize += audio.data->size();
+
+    evictMemory();
+}
+
+void TTSCache::evictMemory() {
+    while(m_memorySize > m_memoryLimit && !m_memory.empty()) {
+        MemoryEntry &oldest = m_memory.back();
+        m_memorySize -= oldest.audio.data->size();
+        m_memoryIndex.erase(oldest.key);
+        m_memory.pop_back();
+    }
+}
+
+// The flash tier keeps one file per entry, named after a hash of the key:
+// magic, key length, key, caps length, caps (lengths 32 bit host order),
+// followed by the audio. The modification time of a file is its last use.
+void TTSCache::loadFlashIndex() {
+    DIR *dir = opendir(m_directory.c_str());
+    if(!dir) {
+        TTSLOG_ERROR("Can't open cache directory %s (%s)", m_directory.c_str(), strerror(errno));
+        return;
+    }
+
+    std::vector<std::pair<time_t, FlashEntry>> files;
+    struct dirent *dirEntry;
+    while((dirEntry = readdir(dir)) != NULL) {
+        std::string name = dirEntry->d_name;
+        const std::string suffix = TTS_CACHE_FILE_SUFFIX;
+        if(name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+
+        struct stat info;
+        if(stat(filePath(name).c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+            continue;
+
+        FlashEntry entry;
+        entry.name = name;
+        entry.size = info.st_size;
+        files.push_back(std::make_pair(info.st_mtime, entry));
+    }
+    closedir(dir);
+
+    std::sort(files.begin(), files.end(),
+            [](const std::pair<time_t, FlashEntry> &a, const std::pair<time_t, FlashEntry> &b) { return a.first > b.first; });
+
+    for(auto it = files.begin(); it != files.end(); ++it) {
+        m_flash.push_back(it->second);
+        m_flashIndex[it->second.name] = --m_flash.end();
+        m_flashSize += it->second.size;
+    }
+}
+
+bool TTSCache::readFlash(const std::string &key, Audio &audio) {
+    std::string name = fileName(key);
+    auto it = m_flashIndex.find(name);
+    if(it == m_flashIndex.end())
+        return false;
+
+    FILE *file = fopen(filePath(name).c_str(), "rb");
+    if(!file) {
+        m_flashSize -= it->second->size;
+        m_flash.erase(it->second);
+        m_flashIndex.erase(it);
+        return false;
+    }
+
+    bool valid = false;
+    char magic[4];
+    uint32_t length = 0;
+    std::string storedKey;
+    std::string caps;
+    if(fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, TTS_CACHE_FILE_MAGIC, sizeof(magic)) == 0 &&
+            fread(&length, sizeof(length), 1, file) == 1 && length == key.size()) {
+        storedKey.resize(length);
+        if(fread(&storedKey[0], 1, length, file) == length && storedKey == key &&
+                fread(&length, sizeof(length), 1, file) == 1 && length < it->second->size) {
+            caps.resize(length);
+            if(length == 0 || fread(&caps[0], 1, length, file) == length) {
+                long start = ftell(file);
+                size_t size = (start > 0 && static_cast<size_t>(start) < it->second->size) ? it->second->size - start : 0;
+                std::vector<uint8_t> *data = new std::vector<uint8_t>(size);
+                valid = (size > 0 && fread(&(*data)[0], 1, size, file) == size);
+                audio.data.reset(data);
+                audio.caps = caps;
+            }
+        }
+    }
+    fclose(file);
+
+    if(!valid) {
+        audio = Audio();
+        // A different key with the same hash stays until it is evicted or overwritten
+        if(storedKey == key) {
+            TTSLOG_WARNING("Dropping corrupt cache file %s", name.c_str());
+            unlink(filePath(name).c_str());
+            m_flashSize -= it->second->size;
+            m_flash.erase(it->second);
+            m_flashIndex.erase(it);
+        }
+        return false;
+    }
+
+    touchFlash(it->second);
+    return true;
+}
+
+void TTSCache::writeFlash(const std::string &key, const Audio &audio) {
+    std::string name = fileName(key);
+    std::string path = filePath(name);
+    std::string temp = path + ".tmp";
+
+    FILE *file = fopen(temp.c_str(), "wb");
+    if(!file) {
+        TTSLOG_ERROR("Can't write cache file %s (%s)", temp.c_str(), strerror(errno));
+        return;
+    }
+
+    uint32_t keyLength = key.size();
+    uint32_t capsLength = audio.caps.size();
+    bool written = fwrite(TTS_CACHE_FILE_MAGIC, 1, 4, file) == 4 &&
+        fwrite(&keyLength, sizeof(keyLength), 1, file) == 1 &&
+        fwrite(key.data(), 1, keyLength, file) == keyLength &&
+        fwrite(&capsLength, sizeof(capsLength), 1, file) == 1 &&
+        fwrite(audio.caps.data(), 1, capsLength, file) == capsLength &&
+        fwrite(audio.data->data(), 1, audio.data->size(), file) == audio.data->size();
+    written = (fclose(file) == 0) && written;
+
+    // Renamed only when complete, a power cut leaves the old file or a .tmp behind
+    if(!written || rename(temp.c_str(), path.c_str()) != 0) {
+        TTSLOG_ERROR("Can't write cache file %s (%s)", path.c_str(), strerror(errno));
+        unlink(temp.c_str());
+        return;
+    }
+
+    size_t size = 4 + sizeof(keyLength) + keyLength + sizeof(capsLength) + capsLength + audio.data->size();
+    auto it = m_flashIndex.find(name);
+    if(it != m_flashIndex.end()) {
+        m_flashSize -= it->second->size;
+        m_flash.erase(it->second);
+        m_flashIndex.erase(it);
+    }
+
+    FlashEntry entry;
+    entry.name = name;
+    entry.size = size;
+    m_flash.push_front(entry);
+    m_flashIndex[name] = m_flash.begin();
+    m_flashSize += size;
+
+    evictFlash();
+}
+
+void TTSCache::touchFlash(std::list<FlashEntry>::iterator entry) {
+    utime(filePath(entry->name).c_str(), NULL);
+    m_flash.splice(m_flash.begin(), m_flash, entry);
+}
+
+void TTSCache::evictFlash() {
+    while(m_flashSize > m_flashLimit && !m_flash.empty()) {
+        FlashEntry &oldest = m_flash.back();
+        unlink(filePath(oldest.name).c_str());
+        m_flashSize -= oldest.size;
+        m_flashIndex.erase(oldest.name);
+        m_flash.pop_back();
+    }
+}
+
+std::string TTSCache::fileName(const std::string &key) {
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < key.size(); i++) {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx" TTS_CACHE_FILE_SUFFIX, static_cast<unsigned long long>(hash));
+    return name;
+}
+
+std::string TTSCache::filePath(const std::string &name) {
+    return m_directory + "/" + name;
+}
+
+} // namespace TTS
@@ -0,0 +1,107 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TTS_CACHE_H_
+#define _TTS_CACHE_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TTS {
+
+// Utterances longer than this (~16s of 128kbps mp3) are not worth keeping
+#define TTS_CACHE_MAX_ENTRY (256 * 1024)
+
+// Synthesized audio of past utterances, as received from the endpoint.
+// Entries live in memory and, with a directory configured, on flash too;
+// both tiers evict the least recently used entries beyond their limit.
+// A flash hit is brought back into memory, flash survives a restart.
+class TTSCache {
+public:
+    typedef std::shared_ptr<const std::vector<uint8_t>> Data;
+
+    struct Audio {
+        std::string caps;   // of the endpoint's stream, may be empty
+        Data data;
+    };
+
+    TTSCache();
+    ~TTSCache();
+
+    // Limits in bytes, 0 disables a tier. An empty directory disables flash.
+    void configure(size_t memoryLimit, const std::string &directory, size_t flashLimit);
+    bool enabled();
+
+    static std::string key(const std::string &format, const std::string &voice, uint8_t rate,
+            const std::string &language, const std::string &sanitizedText);
+
+    bool lookup(const std::string &key, Audio &audio);
+    bool contains(const std::string &key);
+    void insert(const std::string &key, const std::string &caps, std::vector<uint8_t> &&data);
+    void insert(const std::string &key, const Audio &audio);
+    void clear();
+
+private:
+    struct MemoryEntry {
+        std::string key;
+        Audio audio;
+    };
+
+    struct FlashEntry {
+        std::string name;
+        size_t size;
+    };
+
+    void store(const std::string &key, const Audio &audio);
+    void evictMemory();
+
+    void loadFlashIndex();
+    bool readFlash(const std::string &key, Audio &audio);
+    void writeFlash(const std::string &key, const Audio &audio);
+    void touchFlash(std::list<FlashEntry>::iterator entry);
+    void evictFlash();
+    std::string fileName(const std::string &key);
+    std::string filePath(const std::string &name);
+
+    std::mutex m_mutex;
+
+    size_t m_memoryLimit;
+    size_t m_memorySize;
+    std::list<MemoryEntry> m_memory;    // most recently used first
+    std::unordered_map<std::string, std::list<MemoryEntry>::iterator> m_memoryIndex;
+
+    std::string m_directory;
+    size_t m_flashLimit;
+    size_t m_flashSize;
+    std::list<FlashEntry> m_flash;      // most recently used first
+    std::unordered_map<std::string, std::list<FlashEntry>::iterator> m_flashIndex;
+
+    uint32_t m_hits;
+    uint32_t m_misses;
+};
+
+} // namespace TTS
+
+#endif
@@ -32,6 +32,18 @@ namespace TTS {
         SPEECH_NOT_FOUND
     };
 
+    // Alerts are queued ahead of normal speech
+    enum SpeechPriority {
+        SPEECH_PRIORITY_NORMAL = 0,
+        SPEECH_PRIORITY_ALERT
+    };
+
+    // What a client's new speech does to its speech still queued
+    enum QueuePolicy {
+        QUEUE_DROP_STALE = 0,   // the oldest one is dropped when the queue is full
+        QUEUE_KEEP_LATEST       // all of them are dropped, unless the client is preemptive
+    };
+
     enum ExtendedEvents {
         EXT_EVENT_WILL_SPEAK        = 1 << 0,
         EXT_EVENT_PAUSED            = 1 << 1,
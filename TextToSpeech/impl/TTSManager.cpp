@@ -19,6 +19,9 @@
 
 #include "TTSManager.h"
 
+// A callback taking longer holds up the events after it, it is logged
+#define TTS_NOTIFY_SLOW_MS 20
+
 namespace TTS {
 
 TTSManager* TTSManager::create(TTSEventCallback *eventCallback)
@@ -29,16 +32,24 @@ TTSManager* TTSManager::create(TTSEventCallback *eventCallback)
 
 TTSManager::TTSManager(TTSEventCallback *callback) :
     m_callback(callback),
-    m_speaker(NULL){
+    m_speaker(NULL),
+    m_dispatching(true),
+    m_dispatcherThread(NULL),
+    m_delivered(0),
+    m_maxWait(0),
+    m_maxRun(0) {
 
     TTSLOG_TRACE("TTSManager::TTSManager");
 
+    m_dispatcherThread = new std::thread(DispatcherThreadFunc, this);
+
     // Setup Speaker passing the read configuration
     m_speaker = new TTSSpeaker(m_defaultConfiguration);
 }
 
 TTSManager::~TTSManager() {
     TTSLOG_TRACE("TTSManager::~TTSManager");
+    stopDispatcher();
     m_callback = NULL;
 
     // Clear Speaker Instance
@@ -147,7 +158,21 @@ TTS_Error TTSManager::getConfiguration(Configuration &configuration) {
     return TTS_OK;
 }
 
-TTS_Error TTSManager::speak(int speechId, std::string text) {
+void TTSManager::configureCache(size_t memoryLimit, const std::string &directory, size_t flashLimit) {
+    TTSLOG_TRACE("Configuring audio cache");
+
+    if(m_speaker)
+        m_speaker->configureCache(memoryLimit, directory, flashLimit);
+}
+
+void TTSManager::configureQueue(size_t maxDepth, QueuePolicy policy) {
+    TTSLOG_TRACE("Configuring speech queue");
+
+    if(m_speaker)
+        m_speaker->configureQueue(maxDepth, policy);
+}
+
+TTS_Error TTSManager::speak(int speechId, const std::string &text, SpeechPriority priority) {
     TTSLOG_TRACE("Speak");
 
     if(!m_defaultConfiguration.isValid()) {
@@ -157,7 +182,7 @@ TTS_Error TTSManager::speak(int speechId, std::string text) {
 
     if(m_speaker) {
         // TODO: Currently 'secure' is set to true. Need to decide about this variable while Resident app integration.
-        m_speaker->speak(this, speechId , text, true);
+        m_speaker->speak(this, speechId , text, true, priority);
     }
 
     return TTS_OK;
@@ -202,67 +227,156 @@ TTS_Error TTSManager::getSpeechState(uint32_t id, SpeechState &state) {
     return TTS_OK;
 }
 
-void TTSManager::willSpeak(uint32_t speech_id, std::string text) {
+void TTSManager::willSpeak(uint32_t speech_id, const std::string &text) {
     TTSLOG_TRACE(" [%d, %s]", speech_id, text.c_str());
 
-    SpeechData d;
-    d.id = speech_id;
-    d.text = text;
-    m_callback->onWillSpeak(d);
+    Notification n(Notification::WILL_SPEAK, speech_id);
+    n.text = text;
+    notify(std::move(n));
 }
 
-void TTSManager::started(uint32_t speech_id, std::string text) {
+void TTSManager::started(uint32_t speech_id, const std::string &text) {
     TTSLOG_TRACE(" [%d, %s]", speech_id, text.c_str());
 
-    SpeechData d;
-    d.id = speech_id;
-    d.text = text;
-    m_callback->onSpeechStart(d);
+    Notification n(Notification::STARTED, speech_id);
+    n.text = text;
+    notify(std::move(n));
 }
 
-void TTSManager::spoke(uint32_t speech_id, std::string text) {
+void TTSManager::spoke(uint32_t speech_id, const std::string &text) {
     TTSLOG_TRACE(" [%d, %s]", speech_id, text.c_str());
 
-    SpeechData d;
-    d.id = speech_id;
-    d.text = text;
-    m_callback->onSpeechComplete(d);
+    Notification n(Notification::SPOKE, speech_id);
+    n.text = text;
+    notify(std::move(n));
 }
 
 void TTSManager::paused(uint32_t speech_id) {
     TTSLOG_TRACE(" [id=%d]", speech_id);
 
-    m_callback->onSpeechPause(speech_id);
+    notify(Notification(Notification::PAUSED, speech_id));
 }
 
 void TTSManager::resumed(uint32_t speech_id) {
     TTSLOG_WARNING(" [id=%d]", speech_id);
 
-    m_callback->onSpeechResume(speech_id);
+    notify(Notification(Notification::RESUMED, speech_id));
 }
 
 void TTSManager::cancelled(std::vector<uint32_t> &speeches) {
     if(speeches.size() <= 0)
         return;
 
-    m_callback->onSpeechCancelled(speeches);
+    Notification n(Notification::CANCELLED, 0);
+    n.ids = speeches;
+    notify(std::move(n));
+}
+
+void TTSManager::dropped(std::vector<uint32_t> &speeches, uint32_t total) {
+    if(speeches.size() <= 0)
+        return;
+
+    Notification n(Notification::DROPPED, 0);
+    n.ids = speeches;
+    n.total = total;
+    notify(std::move(n));
 }
 
 void TTSManager::interrupted(uint32_t speech_id) {
     TTSLOG_WARNING(" [id=%d]", speech_id);
 
-    m_callback->onSpeechInterrupted(speech_id);
+    notify(Notification(Notification::INTERRUPTED, speech_id));
 }
 
 void TTSManager::networkerror(uint32_t speech_id){
     TTSLOG_WARNING(" [id=%d]", speech_id);
 
-    m_callback->onNetworkError(speech_id);
+    notify(Notification(Notification::NETWORK_ERROR, speech_id));
 }
 
 void TTSManager::playbackerror(uint32_t speech_id){
     TTSLOG_WARNING(" [id=%d]", speech_id);
 
-    m_callback->onPlaybackError(speech_id);
+    notify(Notification(Notification::PLAYBACK_ERROR, speech_id));
+}
+
+void TTSManager::notify(Notification &&notification) {
+    std::lock_guard<std::mutex> lock(m_notifyMutex);
+    if(!m_dispatching)
+        return;
+    m_notifications.push_back(std::move(notification));
+    m_notifyCondition.notify_one();
+}
+
+void TTSManager::deliver(Notification &n) {
+    SpeechData d;
+    d.id = n.id;
+    d.text = std::move(n.text);
+
+    switch(n.type) {
+        case Notification::WILL_SPEAK:      m_callback->onWillSpeak(d); break;
+        case Notification::STARTED:         m_callback->onSpeechStart(d); break;
+        case Notification::SPOKE:           m_callback->onSpeechComplete(d); break;
+        case Notification::PAUSED:          m_callback->onSpeechPause(n.id); break;
+        case Notification::RESUMED:         m_callback->onSpeechResume(n.id); break;
+        case Notification::CANCELLED:       m_callback->onSpeechCancelled(n.ids); break;
+        case Notification::DROPPED:         m_callback->onSpeechDropped(n.ids, n.total); break;
+        case Notification::INTERRUPTED:     m_callback->onSpeechInterrupted(n.id); break;
+        case Notification::NETWORK_ERROR:   m_callback->onNetworkError(n.id); break;
+        case Notification::PLAYBACK_ERROR:  m_callback->onPlaybackError(n.id); break;
+    }
+}
+
+void TTSManager::DispatcherThreadFunc(void *ctx) {
+    TTSManager *manager = (TTSManager *)ctx;
+    TTSLOG_INFO("Starting DispatcherThread");
+
+    std::unique_lock<std::mutex> lock(manager->m_notifyMutex);
+    while(manager->m_dispatching) {
+        manager->m_notifyCondition.wait(lock, [manager] () {
+                return (!manager->m_notifications.empty() || !manager->m_dispatching);
+            });
+
+        while(manager->m_dispatching && !manager->m_notifications.empty()) {
+            Notification n = std::move(manager->m_notifications.front());
+            manager->m_notifications.pop_front();
+            size_t pending = manager->m_notifications.size();
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            manager->deliver(n);
+            auto end = std::chrono::steady_clock::now();
+
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(start - n.queued);
+            auto run = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            if(run > std::chrono::milliseconds(TTS_NOTIFY_SLOW_MS))
+                TTSLOG_WARNING("Event %d of speech %u took %lld ms in the callback, waited %lld ms, %zu pending",
+                        n.type, n.id, (long long)run.count() / 1000, (long long)wait.count() / 1000, pending);
+
+            lock.lock();
+            manager->m_delivered++;
+            manager->m_maxWait = std::max(manager->m_maxWait, wait);
+            manager->m_maxRun = std::max(manager->m_maxRun, run);
+        }
+    }
+    TTSLOG_INFO("Stopping DispatcherThread, %u events, longest wait %lld us, longest callback %lld us",
+            manager->m_delivered, (long long)manager->m_maxWait.count(), (long long)manager->m_maxRun.count());
+}
+
+void TTSManager::stopDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_notifyMutex);
+        m_dispatching = false;
+        if(!m_notifications.empty())
+            TTSLOG_WARNING("%zu speech events not delivered", m_notifications.size());
+        m_notifications.clear();
+        m_notifyCondition.notify_one();
+    }
+
+    if(m_dispatcherThread) {
+        m_dispatcherThread->join();
+        delete m_dispatcherThread;
+        m_dispatcherThread = NULL;
+    }
 }
 } // namespace TTS
@@ -23,6 +23,12 @@
 #include "TTSCommon.h"
 #include "TTSSpeaker.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace TTS {
@@ -51,6 +57,7 @@ public:
     virtual void onSpeechPause(uint32_t speechId) { (void)speechId; }
     virtual void onSpeechResume(uint32_t speechId) { (void)speechId; }
     virtual void onSpeechCancelled(std::vector<uint32_t> speechIds) { (void)speechIds; }
+    virtual void onSpeechDropped(std::vector<uint32_t> speechIds, uint32_t total) { (void)speechIds; (void)total; }
     virtual void onSpeechInterrupted(uint32_t speechId) { (void)speechId; }
     virtual void onNetworkError(uint32_t speechId) { (void)speechId; }
     virtual void onPlaybackError(uint32_t speechId) { (void)speechId; }
@@ -69,9 +76,11 @@ public:
     TTS_Error listVoices(std::string language, std::vector<std::string> &voices);
     TTS_Error setConfiguration(Configuration &configuration);
     TTS_Error getConfiguration(Configuration &configuration);
+    void configureCache(size_t memoryLimit, const std::string &directory, size_t flashLimit);
+    void configureQueue(size_t maxDepth, QueuePolicy policy);
 
     //Speak APIs
-    TTS_Error speak(int speechId, std::string text);
+    TTS_Error speak(int speechId, const std::string &text, SpeechPriority priority = SPEECH_PRIORITY_NORMAL);
     TTS_Error pause(uint32_t id);
     TTS_Error resume(uint32_t id);
     TTS_Error shut(uint32_t id);
@@ -82,20 +91,65 @@ public:
     virtual TTSConfiguration *configuration() {return &m_defaultConfiguration;}
 
     //Speak Events
-    virtual void willSpeak(uint32_t speech_id, std::string text);
-    virtual void started(uint32_t speech_id, std::string text);
-    virtual void spoke(uint32_t speech_id, std::string text);
+    virtual void willSpeak(uint32_t speech_id, const std::string &text);
+    virtual void started(uint32_t speech_id, const std::string &text);
+    virtual void spoke(uint32_t speech_id, const std::string &text);
     virtual void paused(uint32_t speech_id);
     virtual void resumed(uint32_t speech_id);
     virtual void cancelled(std::vector<uint32_t> &speeches);
+    virtual void dropped(std::vector<uint32_t> &speeches, uint32_t total);
     virtual void interrupted(uint32_t speech_id);
     virtual void networkerror(uint32_t speech_id);
     virtual void playbackerror(uint32_t speech_id);
 
 private:
+    // A speech event on its way to the callback. Only the events that report
+    // the text carry it, the others go by id.
+    struct Notification {
+        enum Type {
+            WILL_SPEAK,
+            STARTED,
+            SPOKE,
+            PAUSED,
+            RESUMED,
+            CANCELLED,
+            DROPPED,
+            INTERRUPTED,
+            NETWORK_ERROR,
+            PLAYBACK_ERROR
+        };
+
+        Notification(Type t, uint32_t i) : type(t), id(i), total(0), queued(std::chrono::steady_clock::now()) {}
+
+        Type type;
+        uint32_t id;
+        std::string text;
+        std::vector<uint32_t> ids;
+        uint32_t total;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    // The speaker reports from its GStreamer and bus threads, a slow callback
+    // must not hold those up. Events are delivered in order on a thread of their own.
+    void notify(Notification &&notification);
+    void deliver(Notification &notification);
+    static void DispatcherThreadFunc(void *ctx);
+    void stopDispatcher();
+
     TTSConfiguration m_defaultConfiguration;
     TTSEventCallback *m_callback;
     TTSSpeaker *m_speaker;
+
+    std::deque<Notification> m_notifications;
+    std::mutex m_notifyMutex;
+    std::condition_variable m_notifyCondition;
+    bool m_dispatching;
+    std::thread *m_dispatcherThread;
+
+    // Callback latency, for the log
+    uint32_t m_delivered;
+    std::chrono::microseconds m_maxWait;
+    std::chrono::microseconds m_maxRun;
 };
 
 } // namespace TTS
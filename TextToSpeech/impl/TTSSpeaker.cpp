@@ -22,10 +22,14 @@
 #include <curl/curl.h>
 #include <unistd.h>
 #include <regex>
+#include <algorithm>
+#include <functional>
 
 #define INT_FROM_ENV(env, default_value) ((getenv(env) ? atoi(getenv(env)) : 0) > 0 ? atoi(getenv(env)) : default_value)
 #define TTS_CONFIGURATION_STORE "/opt/persistent/tts.setting.ini"
 #define UPDATE_AND_RETURN(o, n) if(o != n) { o = n; return true; }
+#define TTS_PREFETCH_MAX_SIZE (1024 * 1024)
+#define TTS_PREFETCH_TIMEOUT 10 /* s */
 
 namespace WPEFramework {
 namespace Plugin {
@@ -171,8 +175,13 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
     m_currentSpeech(NULL),
     m_isSpeaking(false),
     m_isPaused(false),
+    m_maxQueueDepth(0),
+    m_queuePolicy(QUEUE_DROP_STALE),
+    m_droppedCount(0),
     m_pipeline(NULL),
     m_source(NULL),
+    m_cacheSource(NULL),
+    m_sourcePeer(NULL),
     m_audioSink(NULL),
     m_audioVolume(NULL),
     m_main_loop(NULL),
@@ -192,7 +201,10 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
     m_busWatch(0),
     m_duration(0),
     m_pipelineConstructionFailures(0),
-    m_maxPipelineConstructionFailures(INT_FROM_ENV("MAX_PIPELINE_FAILURE_THRESHOLD", 1)) {
+    m_maxPipelineConstructionFailures(INT_FROM_ENV("MAX_PIPELINE_FAILURE_THRESHOLD", 1)),
+    m_cacheSourceActive(false),
+    m_capturing(false),
+    m_prefetchWake(false) {
 
         setenv("GST_DEBUG", "2", 0);
         setenv("GST_REGISTRY_UPDATE", "no", 0);
@@ -200,6 +212,7 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
 
         m_main_loop_thread = g_thread_new("BusWatch", (void* (*)(void*)) event_loop, this);
         m_gstThread = new std::thread(GStreamerThreadFunc, this);
+        m_prefetchThread = new std::thread(PrefetchThreadFunc, this);
 
 }
 
@@ -217,6 +230,14 @@ TTSSpeaker::~TTSSpeaker() {
 #endif
     m_condition.notify_one();
 
+    cancelPrefetch();
+    wakePrefetch();
+    if(m_prefetchThread) {
+        m_prefetchThread->join();
+        delete m_prefetchThread;
+        m_prefetchThread = NULL;
+    }
+
     if(m_gstThread) {
         m_gstThread->join();
         m_gstThread = NULL;
@@ -234,19 +255,39 @@ void TTSSpeaker::ensurePipeline(bool flag) {
     m_condition.notify_one();
 }
 
-int TTSSpeaker::speak(TTSSpeakerClient *client, uint32_t id, std::string text, bool secure) {
-    TTSLOG_TRACE("id=%d, text=\"%s\"", id, text.c_str());
+int TTSSpeaker::speak(TTSSpeakerClient *client, uint32_t id, const std::string &text, bool secure, SpeechPriority priority) {
+    TTSLOG_TRACE("id=%d, text=\"%s\", priority=%d", id, text.c_str(), priority);
 
-    // If force speak is set, clear old queued data & stop speaking
-    if(client->configuration()->isPreemptive())
-        reset();
+    // If force speak is set, clear old queued data & stop speaking.
+    // Normal speech leaves alerts alone, the one being spoken included.
+    if(client->configuration()->isPreemptive()) {
+        if(priority == SPEECH_PRIORITY_ALERT) {
+            reset();
+        } else {
+            bool alertSpeaking = false;
+            {
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                alertSpeaking = m_currentSpeech && m_currentSpeech->priority == SPEECH_PRIORITY_ALERT;
+            }
+            if(!alertSpeaking)
+                cancelSpeech();
+            flushQueue(true);
+        }
+    }
 
-    SpeechData data(client, id, text, secure);
+    SpeechData data(client, id, text, secure, priority);
     queueData(data);
 
     return 0;
 }
 
+void TTSSpeaker::configureQueue(size_t maxDepth, QueuePolicy policy) {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_maxQueueDepth = maxDepth;
+    m_queuePolicy = policy;
+    TTSLOG_INFO("Speech queue: depth=%zu, policy=%s", maxDepth, policy == QUEUE_KEEP_LATEST ? "latest" : "stale");
+}
+
 SpeechState TTSSpeaker::getSpeechState(uint32_t id) {
     // See if the speech is in progress i.e Speaking / Paused
     {
@@ -294,6 +335,10 @@ bool TTSSpeaker::cancelSpeech(uint32_t id) {
     return status;
 }
 
+void TTSSpeaker::configureCache(size_t memoryLimit, const std::string &directory, size_t flashLimit) {
+    m_cache.configure(memoryLimit, directory, flashLimit);
+}
+
 bool TTSSpeaker::reset() {
     TTSLOG_VERBOSE("Resetting Speaker");
     cancelSpeech();
@@ -345,14 +390,94 @@ void TTSSpeaker::setSpeakingState(bool state, TTSSpeakerClient *client) {
 }
 
 void TTSSpeaker::queueData(SpeechData data) {
-    std::lock_guard<std::mutex> lock(m_queueMutex);
-    m_queue.push_back(data);
-    m_condition.notify_one();
+    std::vector<SpeechData> dropped;
+    uint32_t total = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        data.queued = std::chrono::steady_clock::now();
+
+        // Only the latest speech of a client is of interest, of the same priority
+        if(m_queuePolicy == QUEUE_KEEP_LATEST && !data.client->configuration()->isPreemptive()) {
+            for(auto it = m_queue.begin(); it != m_queue.end();) {
+                if(it->client == data.client && it->priority == data.priority) {
+                    dropped.push_back(*it);
+                    it = m_queue.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // A full queue drops its oldest speech, the client's own first and
+        // normal speech before alerts. Nothing to drop, the new one is.
+        bool queue = true;
+        if(m_maxQueueDepth > 0 && m_queue.size() >= m_maxQueueDepth) {
+            auto victim = m_queue.end();
+            for(int sameClient = 1; sameClient >= 0 && victim == m_queue.end(); sameClient--) {
+                for(int priority = SPEECH_PRIORITY_NORMAL; priority <= data.priority && victim == m_queue.end(); priority++) {
+                    victim = std::find_if(m_queue.begin(), m_queue.end(), [&data, sameClient, priority] (const SpeechData &d) {
+                            return d.priority == priority && (!sameClient || d.client == data.client);
+                        });
+                }
+            }
+
+            if(victim != m_queue.end()) {
+                dropped.push_back(*victim);
+                m_queue.erase(victim);
+            } else {
+                dropped.push_back(data);
+                queue = false;
+            }
+        }
+
+        if(queue) {
+            if(data.priority == SPEECH_PRIORITY_ALERT) {
+                // Behind the alerts already waiting, ahead of everything else
+                auto it = std::find_if(m_queue.begin(), m_queue.end(),
+                        [] (const SpeechData &d) { return d.priority != SPEECH_PRIORITY_ALERT; });
+                m_queue.insert(it, data);
+            } else {
+                m_queue.push_back(data);
+            }
+        }
+
+        for(auto it = dropped.begin(); it != dropped.end(); ++it)
+            cancelPrefetch(&(*it));
+        m_droppedCount += dropped.size();
+        total = m_droppedCount;
+        m_condition.notify_one();
+    }
+    wakePrefetch();
+    notifyDropped(dropped, total);
+}
+
+void TTSSpeaker::notifyDropped(std::vector<SpeechData> &dropped, uint32_t total) {
+    std::map<TTSSpeakerClient*, std::vector<uint32_t>> speeches;
+    for(auto it = dropped.begin(); it != dropped.end(); ++it)
+        speeches[it->client].push_back(it->id);
+
+    for(auto it = speeches.begin(); it != speeches.end(); ++it) {
+        TTSLOG_WARNING("Dropped %zu queued speech(es) of client %p, %u in total", it->second.size(), it->first, total);
+        it->first->dropped(it->second, total);
+    }
 }
 
-void TTSSpeaker::flushQueue() {
+void TTSSpeaker::flushQueue(bool keepAlerts) {
     std::lock_guard<std::mutex> lock(m_queueMutex);
-    m_queue.clear();
+    if(!keepAlerts) {
+        m_queue.clear();
+        cancelPrefetch();
+        return;
+    }
+
+    for(auto it = m_queue.begin(); it != m_queue.end();) {
+        if(it->priority != SPEECH_PRIORITY_ALERT) {
+            cancelPrefetch(&(*it));
+            it = m_queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 SpeechData TTSSpeaker::dequeueData() {
@@ -462,6 +587,14 @@ bool TTSSpeaker::setMixGain(MixGain gain, int val)
  return status;
 }
 #endif
+static void addBufferProbe(GstElement *element, const char *name, GstPadProbeCallback callback, gpointer data) {
+    GstPad *pad = element ? gst_element_get_static_pad(element, name) : NULL;
+    if(pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback, data, NULL);
+        gst_object_unref(pad);
+    }
+}
+
 // GStreamer Releated members
 void TTSSpeaker::createPipeline() {
     m_isEOS = false;
@@ -625,6 +758,10 @@ void TTSSpeaker::createPipeline() {
         return;
     }
 
+    setupCacheSource();
+    addBufferProbe(m_source, "src", sourceProbe, this);
+    addBufferProbe(m_audioSink, "sink", sinkProbe, this);
+
     TTSLOG_WARNING ("gst_element_get_bus\n");
     GstBus *bus = gst_element_get_bus(m_pipeline);
     m_busWatch = gst_bus_add_watch(bus, GstBusCallback, (gpointer)(this));
@@ -636,7 +773,9 @@ void TTSSpeaker::createPipeline() {
     resetPipeline();
 }
 
-void TTSSpeaker::resetPipeline() {
+// Between queued utterances the pipeline is kept READY, which keeps the audio
+// device open. Once the queue runs empty it goes back to NULL.
+void TTSSpeaker::resetPipeline(GstState state) {
     TTSLOG_WARNING("Resetting Pipeline...");
 
     // Detect pipe line error and destroy the pipeline if any
@@ -655,9 +794,9 @@ void TTSSpeaker::resetPipeline() {
         // If pipe line is NULL, create one
         createPipeline();
     } else {
-        // If pipeline is present, bring it to NULL state
-        gst_element_set_state(m_pipeline, GST_STATE_NULL);
-        while(!waitForStatus(GST_STATE_NULL, 60*1000));
+        // If pipeline is present, bring it to the requested state
+        gst_element_set_state(m_pipeline, state);
+        while(!waitForStatus(state, 60*1000));
     }
 }
 
@@ -669,15 +808,141 @@ void TTSSpeaker::destroyPipeline() {
         waitForStatus(GST_STATE_NULL, 1*1000);
         g_source_remove(m_busWatch);
         gst_object_unref(m_pipeline);
+
+        // The source not in the pipeline is ours
+        if(m_cacheSource)
+            gst_object_unref(m_cacheSourceActive ? m_source : m_cacheSource);
     }
 
     m_busWatch = 0;
     m_pipeline = NULL;
+    m_cacheSource = NULL;
+    m_sourcePeer = NULL;
+    m_cacheSourceActive = false;
     m_pipelineConstructionFailures = 0;
     m_condition.notify_one();
 }
 
-void TTSSpeaker::waitForAudioToFinishTimeout(float timeout_s) {
+void TTSSpeaker::setupCacheSource() {
+    m_cacheSource = NULL;
+    m_sourcePeer = NULL;
+    m_cacheSourceActive = false;
+
+    if(!m_source)
+        return;
+
+    // Cache hits are played by an appsrc that takes the http source's place in front of its peer
+    GstPad *srcPad = gst_element_get_static_pad(m_source, "src");
+    GstPad *peerPad = srcPad ? gst_pad_get_peer(srcPad) : NULL;
+    if(peerPad) {
+        m_sourcePeer = gst_pad_get_parent_element(peerPad);
+        gst_object_unref(peerPad);
+    }
+
+    if(m_sourcePeer) {
+        // Referenced by the pipeline as long as the peer is in it
+        gst_object_unref(m_sourcePeer);
+
+        m_cacheSource = gst_element_factory_make("appsrc", NULL);
+        if(m_cacheSource) {
+            gst_object_ref_sink(m_cacheSource);
+            g_object_set(G_OBJECT(m_cacheSource), "format", GST_FORMAT_BYTES, "is-live", FALSE, NULL);
+        }
+    }
+
+    if(!m_cacheSource)
+        TTSLOG_WARNING("Audio cache playback not available for this pipeline");
+
+    if(srcPad)
+        gst_object_unref(srcPad);
+}
+
+bool TTSSpeaker::useSource(bool cache) {
+    if(!m_cacheSource)
+        return !cache;
+
+    if(cache == m_cacheSourceActive)
+        return true;
+
+    // Only swapped between two utterances, with the pipeline in NULL or READY state
+    GstElement *current = cache ? m_source : m_cacheSource;
+    GstElement *next = cache ? m_cacheSource : m_source;
+
+    gst_element_unlink(current, m_sourcePeer);
+    gst_object_ref(current);
+    gst_bin_remove(GST_BIN(m_pipeline), current);
+    gst_element_set_state(current, GST_STATE_NULL);
+    gst_bin_add(GST_BIN(m_pipeline), next);
+    gst_object_unref(next);
+    m_cacheSourceActive = cache;
+
+    if(!gst_element_link(next, m_sourcePeer) || !gst_element_sync_state_with_parent(next)) {
+        TTSLOG_ERROR("Failed to link the %s source", cache ? "cache" : "http");
+        m_pipelineError = true;
+        return false;
+    }
+    return true;
+}
+
+static void releaseCachedAudio(gpointer data) {
+    delete static_cast<TTSCache::Data*>(data);
+}
+
+void TTSSpeaker::pushCachedAudio(TTSCache::Audio &audio) {
+    // The buffer holds a reference to the cached data
+    TTSCache::Data *data = new TTSCache::Data(audio.data);
+    GstBuffer *buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+            const_cast<uint8_t*>(audio.data->data()), audio.data->size(), 0, audio.data->size(),
+            data, releaseCachedAudio);
+
+    gst_app_src_push_buffer(GST_APP_SRC(m_cacheSource), buffer);
+    gst_app_src_end_of_stream(GST_APP_SRC(m_cacheSource));
+}
+
+// Streaming thread of the http source: first byte, and recording for the cache
+GstPadProbeReturn TTSSpeaker::sourceProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    TTSSpeaker *speaker = (TTSSpeaker*)data;
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if(speaker->m_firstByte == std::chrono::steady_clock::time_point())
+        speaker->m_firstByte = std::chrono::steady_clock::now();
+
+    if(!speaker->m_capturing || !buffer)
+        return GST_PAD_PROBE_OK;
+
+    if(speaker->m_captureCaps.empty()) {
+        GstCaps *caps = gst_pad_get_current_caps(pad);
+        if(caps) {
+            gchar *str = gst_caps_to_string(caps);
+            speaker->m_captureCaps = str;
+            g_free(str);
+            gst_caps_unref(caps);
+        }
+    }
+
+    GstMapInfo map;
+    if(gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        if(speaker->m_capture.size() + map.size > TTS_CACHE_MAX_ENTRY) {
+            // Too long to be cached
+            speaker->m_capturing = false;
+            speaker->m_capture.clear();
+        } else {
+            speaker->m_capture.insert(speaker->m_capture.end(), map.data, map.data + map.size);
+        }
+        gst_buffer_unmap(buffer, &map);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn TTSSpeaker::sinkProbe(GstPad *, GstPadProbeInfo *, gpointer data) {
+    TTSSpeaker *speaker = (TTSSpeaker*)data;
+
+    if(speaker->m_firstAudio == std::chrono::steady_clock::time_point())
+        speaker->m_firstAudio = std::chrono::steady_clock::now();
+    return GST_PAD_PROBE_OK;
+}
+
+bool TTSSpeaker::waitForAudioToFinishTimeout(float timeout_s) {
     TTSLOG_TRACE("timeout_s=%f", timeout_s);
 
     auto timeout = std::chrono::system_clock::now() + std::chrono::seconds((unsigned long)timeout_s);
@@ -723,13 +988,15 @@ void TTSSpeaker::waitForAudioToFinishTimeout(float timeout_s) {
     TTSLOG_INFO("m_isEOS=%d, m_pipeline=%p, m_pipelineError=%d, m_flushed=%d",
             m_isEOS, m_pipeline, m_pipelineError, m_flushed);
 
-    // Irrespective of EOS / Timeout reset pipeline
+    // Irrespective of EOS / Timeout stop the pipeline, READY keeps the audio device
     if(m_pipeline)
-        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_element_set_state(m_pipeline, GST_STATE_READY);
 
+    bool eos = m_isEOS;
     if(!m_isEOS)
         TTSLOG_ERROR("Stopped waiting for audio to finish without hitting EOS!");
     m_isEOS = false;
+    return eos;
 }
 
 void TTSSpeaker::replaceIfIsolated(std::string& text, const std::string& search, const std::string& replace) {
@@ -810,7 +1077,7 @@ bool TTSSpeaker::needsPipelineUpdate() {
        ((m_ensurePipeline && !m_pipeline) || (m_pipeline && !m_ensurePipeline));
 }
 
-std::string TTSSpeaker::constructURL(TTSConfiguration &config, SpeechData &d) {
+std::string TTSSpeaker::constructURL(TTSConfiguration &config, SpeechData &d, const std::string &sanitizedText) {
     if(!config.isValid()) {
         TTSLOG_ERROR("Invalid configuration");
         return "";
@@ -839,17 +1106,18 @@ std::string TTSSpeaker::constructURL(TTSConfiguration &config, SpeechData &d) {
     tts_request.append("&rate=");
     tts_request.append(std::to_string(config.rate() > 100 ? 100 : config.rate()));
 
-    // Sanitize String
-    std::string sanitizedString;
-    sanitizeString(d.text, sanitizedString);
-
     tts_request.append("&text=");
-    tts_request.append(sanitizedString);
+    tts_request.append(sanitizedText);
 
     TTSLOG_WARNING("Constructured final URL is %s", tts_request.c_str());
     return tts_request;
 }
 
+std::string TTSSpeaker::cacheKey(TTSConfiguration &config, const std::string &sanitizedText) {
+    return TTSCache::key(m_pcmAudioEnabled ? "pcm" : "mp3", config.voice(),
+            config.rate() > 100 ? 100 : config.rate(), config.language(), sanitizedText);
+}
+
 void TTSSpeaker::speakText(TTSConfiguration config, SpeechData &data) {
     m_isEOS = false;
     m_duration = 0;
@@ -857,10 +1125,51 @@ void TTSSpeaker::speakText(TTSConfiguration config, SpeechData &data) {
     if(m_pipeline && !m_pipelineError && !m_flushed) {
         m_currentSpeech = &data;
 
-        g_object_set(G_OBJECT(m_source), "location", constructURL(config, data).c_str(), NULL);
+        m_speechStart = std::chrono::steady_clock::now();
+        m_firstByte = std::chrono::steady_clock::time_point();
+        m_firstAudio = std::chrono::steady_clock::time_point();
+
+        std::string sanitizedText;
+        sanitizeString(data.text, sanitizedText);
+        std::string key = cacheKey(config, sanitizedText);
+
+        // Audio at hand is the prefetched one or a cached one, otherwise it is streamed
+        TTSCache::Audio audio;
+        const char *origin = "network";
+        bool prefetched = takePrefetched(data, key, audio) && m_cacheSource;
+        if(prefetched) {
+            origin = "prefetch";
+            m_cache.insert(key, audio);
+        }
+        bool cached = prefetched || (m_cacheSource && m_cache.lookup(key, audio));
+        if(cached && !prefetched)
+            origin = "cache";
+
+        if(!useSource(cached)) {
+            TTSLOG_WARNING("m_pipeline=%p, m_pipelineError=%d", m_pipeline, m_pipelineError);
+            m_currentSpeech = NULL;
+            return;
+        }
+
+        if(cached) {
+            GstCaps *caps = audio.caps.empty() ? NULL : gst_caps_from_string(audio.caps.c_str());
+            g_object_set(G_OBJECT(m_cacheSource), "caps", caps, NULL);
+            if(caps)
+                gst_caps_unref(caps);
+        } else {
+            g_object_set(G_OBJECT(m_source), "location", constructURL(config, data, sanitizedText).c_str(), NULL);
+            m_capture.clear();
+            m_captureCaps.clear();
+            m_capturing = m_cacheSource && m_cache.enabled();
+        }
+
         // PCM Sink seems to be accepting volume change before PLAYING state
         g_object_set(G_OBJECT(m_audioVolume), "volume", (double) (data.client->configuration()->volume() / MAX_VOLUME), NULL);
         gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+        if(cached) {
+            m_firstByte = std::chrono::steady_clock::now();
+            pushCachedAudio(audio);
+        }
 #if defined(PLATFORM_AMLOGIC)
         //-12db is almost 25%
         setMixGain(MIXGAIN_PRIM,-12);
@@ -868,19 +1177,208 @@ void TTSSpeaker::speakText(TTSConfiguration config, SpeechData &data) {
         TTSLOG_VERBOSE("Speaking.... ( %d, \"%s\")", data.id, data.text.c_str());
 
         //Wait for EOS with a timeout incase EOS never comes
+        bool eos;
         if(m_pcmAudioEnabled) {
             //FIXME, find out way to EOS or position for raw PCM audio
-            waitForAudioToFinishTimeout(60);
+            eos = waitForAudioToFinishTimeout(60);
         }
         else {
-            waitForAudioToFinishTimeout(10);
+            eos = waitForAudioToFinishTimeout(10);
+        }
+
+        // The pipeline is stopped, the capture is complete if the stream played to its end
+        if(m_capturing) {
+            m_capturing = false;
+            if(eos && !m_pipelineError && !m_flushed)
+                m_cache.insert(key, m_captureCaps, std::move(m_capture));
         }
+        m_capture.clear();
+        m_capture.shrink_to_fit();
+
+        auto since = [this] (std::chrono::steady_clock::time_point t) -> long long {
+            return t == std::chrono::steady_clock::time_point() ? -1 :
+                std::chrono::duration_cast<std::chrono::milliseconds>(t - m_speechStart).count();
+        };
+        TTSLOG_INFO("Speech %u timing: queue wait %lld ms, first byte %lld ms, first audio %lld ms (%s)", data.id,
+                (long long)std::chrono::duration_cast<std::chrono::milliseconds>(m_speechStart - data.queued).count(),
+                since(m_firstByte), since(m_firstAudio), origin);
     } else {
         TTSLOG_WARNING("m_pipeline=%p, m_pipelineError=%d", m_pipeline, m_pipelineError);
     }
     m_currentSpeech = NULL;
 }
 
+struct PrefetchTransfer {
+    std::vector<uint8_t> *audio;
+    std::function<bool()> cancelled;
+};
+
+static size_t prefetchWrite(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    PrefetchTransfer *transfer = static_cast<PrefetchTransfer*>(userdata);
+    size_t length = size * nmemb;
+
+    // Too long to be held, it is streamed instead
+    if(transfer->audio->size() + length > TTS_PREFETCH_MAX_SIZE)
+        return 0;
+
+    transfer->audio->insert(transfer->audio->end(), ptr, ptr + length);
+    return length;
+}
+
+static int prefetchProgress(void *clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    return static_cast<PrefetchTransfer*>(clientp)->cancelled() ? 1 : 0;
+}
+
+bool TTSSpeaker::fetchAudio(const std::string &url, std::vector<uint8_t> &audio) {
+    CURL *curl = curl_easy_init();
+    if(!curl)
+        return false;
+
+    PrefetchTransfer transfer;
+    transfer.audio = &audio;
+    transfer.cancelled = [this] () { return prefetchCancelled(); };
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)TTS_PREFETCH_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, prefetchWrite);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, prefetchProgress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &transfer);
+
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+
+    if(res != CURLE_OK) {
+        TTSLOG_WARNING("Prefetch failed: %s", curl_easy_strerror(res));
+        return false;
+    }
+    return !audio.empty();
+}
+
+bool TTSSpeaker::prefetchCancelled() {
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    return m_prefetch.cancelled || !m_runThread;
+}
+
+void TTSSpeaker::wakePrefetch() {
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    m_prefetchWake = true;
+    m_prefetchCondition.notify_all();
+}
+
+void TTSSpeaker::cancelPrefetch(const SpeechData *data) {
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    if(!m_prefetch.active || (data && (m_prefetch.id != data->id || m_prefetch.client != data->client)))
+        return;
+
+    // A transfer in progress clears the slot once it is aborted
+    if(m_prefetch.fetching)
+        m_prefetch.cancelled = true;
+    else
+        m_prefetch = Prefetch();
+
+    m_prefetchWake = true;
+    m_prefetchCondition.notify_all();
+}
+
+void TTSSpeaker::prefetchNext() {
+    std::string url;
+    uint32_t id = 0;
+    {
+        // Queue before prefetch, the order flushQueue takes them in
+        std::lock_guard<std::mutex> queueLock(m_queueMutex);
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+
+        // Only the next utterance, and only while another one is being spoken
+        if(m_prefetch.active || m_queue.empty() || !m_isSpeaking)
+            return;
+
+        SpeechData &next = m_queue.front();
+        TTSConfiguration *config = next.client->configuration();
+        std::string sanitizedText;
+        sanitizeString(next.text, sanitizedText);
+
+        m_prefetch = Prefetch();
+        m_prefetch.active = true;
+        m_prefetch.client = next.client;
+        m_prefetch.id = next.id;
+        m_prefetch.key = cacheKey(*config, sanitizedText);
+
+        // Played from the cache anyway
+        if(m_cache.contains(m_prefetch.key))
+            return;
+
+        url = constructURL(*config, next, sanitizedText);
+        m_prefetch.fetching = !url.empty();
+        if(!m_prefetch.fetching)
+            return;
+        id = next.id;
+    }
+
+    TTSLOG_INFO("Prefetching speech %u", id);
+    std::vector<uint8_t> audio;
+    bool fetched = fetchAudio(url, audio);
+
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    if(m_prefetch.cancelled) {
+        m_prefetch = Prefetch();
+    } else {
+        m_prefetch.fetching = false;
+        if(fetched)
+            m_prefetch.data = std::make_shared<const std::vector<uint8_t>>(std::move(audio));
+    }
+    m_prefetchCondition.notify_all();
+}
+
+bool TTSSpeaker::takePrefetched(SpeechData &data, const std::string &key, TTSCache::Audio &audio) {
+    std::unique_lock<std::mutex> lock(m_prefetchMutex);
+    if(!m_prefetch.active || m_prefetch.cancelled || m_prefetch.id != data.id || m_prefetch.client != data.client)
+        return false;
+
+    // Already on its way, better than a second request
+    while(m_prefetch.fetching && !m_flushed && m_runThread)
+        m_prefetchCondition.wait_for(lock, std::chrono::milliseconds(50));
+
+    if(m_prefetch.fetching) {
+        m_prefetch.cancelled = true;
+        return false;
+    }
+
+    bool ready = m_prefetch.data && m_prefetch.key == key;
+    if(ready) {
+        audio.caps.clear();
+        audio.data = m_prefetch.data;
+    }
+
+    m_prefetch = Prefetch();
+    m_prefetchWake = true;
+    m_prefetchCondition.notify_all();
+    return ready;
+}
+
+void TTSSpeaker::PrefetchThreadFunc(void *ctx) {
+    TTSLOG_INFO("Starting PrefetchThread");
+    TTSSpeaker *speaker = (TTSSpeaker*) ctx;
+
+    while(speaker->m_runThread) {
+        {
+            std::unique_lock<std::mutex> lock(speaker->m_prefetchMutex);
+            speaker->m_prefetchCondition.wait(lock, [speaker] () {
+                    return speaker->m_prefetchWake || !speaker->m_runThread;
+                });
+            speaker->m_prefetchWake = false;
+        }
+
+        if(speaker->m_runThread)
+            speaker->prefetchNext();
+    }
+    TTSLOG_INFO("Stopping PrefetchThread");
+}
+
 void TTSSpeaker::event_loop(void *data)
 {
     TTSSpeaker *speaker= (TTSSpeaker*) data;
@@ -940,6 +1438,7 @@ void TTSSpeaker::GStreamerThreadFunc(void *ctx) {
         SpeechData data = speaker->dequeueData();
 
         speaker->setSpeakingState(true, data.client);
+        speaker->wakePrefetch();
         // Inform the client before speaking
         if(!speaker->m_flushed)
             data.client->willSpeak(data.id, data.text);
@@ -968,8 +1467,11 @@ void TTSSpeaker::GStreamerThreadFunc(void *ctx) {
 	}
         speaker->setSpeakingState(false);
 
-        // stop the pipeline until the next tts string...
-        speaker->resetPipeline();
+        // In case it was not spoken, what was prefetched for it is of no use
+        speaker->cancelPrefetch(&data);
+
+        // stop the pipeline until the next tts string, keep it READY if one is waiting
+        speaker->resetPipeline(speaker->m_queue.empty() ? GST_STATE_NULL : GST_STATE_READY);
     }
 
     speaker->destroyPipeline();
@@ -23,15 +23,18 @@
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
 #include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
 
 #include <map>
 #include <list>
+#include <chrono>
 #include <mutex>
 #include <thread>
 #include <vector>
 #include <condition_variable>
 
 #include "TTSCommon.h"
+#include "TTSCache.h"
 
 #if defined(PLATFORM_AMLOGIC)
 #include "audio_if.h"
@@ -94,12 +97,13 @@ private:
 class TTSSpeakerClient {
 public:
     virtual TTSConfiguration* configuration() = 0;
-    virtual void willSpeak(uint32_t speech_id, std::string text) = 0;
-    virtual void started(uint32_t speech_id, std::string text) = 0;
-    virtual void spoke(uint32_t speech_id, std::string text) = 0;
+    virtual void willSpeak(uint32_t speech_id, const std::string &text) = 0;
+    virtual void started(uint32_t speech_id, const std::string &text) = 0;
+    virtual void spoke(uint32_t speech_id, const std::string &text) = 0;
     virtual void paused(uint32_t speech_id) = 0;
     virtual void resumed(uint32_t speech_id) = 0;
     virtual void cancelled(std::vector<uint32_t> &speeches) = 0;
+    virtual void dropped(std::vector<uint32_t> &speeches, uint32_t total) = 0;
     virtual void interrupted(uint32_t speech_id) = 0;
     virtual void networkerror(uint32_t speech_id) = 0;
     virtual void playbackerror(uint32_t speech_id) = 0;
@@ -107,13 +111,16 @@ public:
 
 struct SpeechData {
     public:
-        SpeechData() : client(NULL), secure(false), id(0), text() {}
-        SpeechData(TTSSpeakerClient *c, uint32_t i, std::string t, bool s=false) : client(c), secure(s), id(i), text(t) {}
+        SpeechData() : client(NULL), secure(false), id(0), text(), priority(SPEECH_PRIORITY_NORMAL) {}
+        SpeechData(TTSSpeakerClient *c, uint32_t i, const std::string &t, bool s=false, SpeechPriority p=SPEECH_PRIORITY_NORMAL) :
+            client(c), secure(s), id(i), text(t), priority(p) {}
         SpeechData(const SpeechData &n) {
             client = n.client;
             id = n.id;
             text = n.text;
             secure = n.secure;
+            priority = n.priority;
+            queued = n.queued;
         }
         ~SpeechData() {}
 
@@ -121,6 +128,8 @@ struct SpeechData {
         bool secure;
         uint32_t id;
         std::string text;
+        SpeechPriority priority;
+        std::chrono::steady_clock::time_point queued;
 };
 
 class TTSSpeaker {
@@ -131,7 +140,8 @@ public:
     void ensurePipeline(bool flag=true);
 
     // Speak Functions
-    int speak(TTSSpeakerClient* client, uint32_t id, std::string text, bool secure); // Formalize data to speak API
+    int speak(TTSSpeakerClient* client, uint32_t id, const std::string &text, bool secure,
+            SpeechPriority priority = SPEECH_PRIORITY_NORMAL); // Formalize data to speak API
     bool isSpeaking(uint32_t id);
     SpeechState getSpeechState(uint32_t id);
     bool cancelSpeech(uint32_t id=0);
@@ -140,6 +150,9 @@ public:
     bool pause(uint32_t id = 0);
     bool resume(uint32_t id = 0);
 
+    void configureCache(size_t memoryLimit, const std::string &directory, size_t flashLimit);
+    void configureQueue(size_t maxDepth, QueuePolicy policy);
+
 private:
 
     // Private Data
@@ -154,8 +167,12 @@ private:
 
     std::list<SpeechData> m_queue;
     std::mutex m_queueMutex;
+    size_t m_maxQueueDepth;     // 0 is unbounded
+    QueuePolicy m_queuePolicy;
+    uint32_t m_droppedCount;
     void queueData(SpeechData);
-    void flushQueue();
+    void flushQueue(bool keepAlerts = false);
+    void notifyDropped(std::vector<SpeechData> &dropped, uint32_t total);
     SpeechData dequeueData();
 
     // Private functions
@@ -164,6 +181,8 @@ private:
     // GStreamer Releated members
     GstElement  *m_pipeline;
     GstElement  *m_source;
+    GstElement  *m_cacheSource;
+    GstElement  *m_sourcePeer;
     GstElement  *m_audioSink;
     GstElement  *m_audioVolume;
     GMainLoop   *m_main_loop;
@@ -186,23 +205,68 @@ private:
 #endif
     bool        m_ensurePipeline;
     std::thread *m_gstThread;
+    std::thread *m_prefetchThread;
     guint       m_busWatch;
     gint64      m_duration;
     uint8_t     m_pipelineConstructionFailures;
     const uint8_t     m_maxPipelineConstructionFailures;
 
+    // Audio cache, the endpoint's stream is recorded while it plays
+    TTSCache    m_cache;
+    bool        m_cacheSourceActive;
+    bool        m_capturing;
+    std::string m_captureCaps;
+    std::vector<uint8_t> m_capture;
+
+    // Audio of the next queued utterance, fetched while the current one plays
+    struct Prefetch {
+        Prefetch() : active(false), fetching(false), cancelled(false), client(NULL), id(0) {}
+
+        bool active;
+        bool fetching;
+        bool cancelled;
+        TTSSpeakerClient *client;
+        uint32_t id;
+        std::string key;
+        TTSCache::Data data;
+    };
+    Prefetch    m_prefetch;
+    bool        m_prefetchWake;
+    std::mutex  m_prefetchMutex;
+    std::condition_variable m_prefetchCondition;
+
+    // Timing of the utterance being spoken
+    std::chrono::steady_clock::time_point m_speechStart;
+    std::chrono::steady_clock::time_point m_firstByte;
+    std::chrono::steady_clock::time_point m_firstAudio;
+
 #if defined(PLATFORM_AMLOGIC)
     bool setMixGain(MixGain gain, int val);
     bool loadInitAudioDev();
 #endif
     static void GStreamerThreadFunc(void *ctx);
     void createPipeline();
-    void resetPipeline();
+    void resetPipeline(GstState state = GST_STATE_NULL);
     void destroyPipeline();
+    void setupCacheSource();
+    bool useSource(bool cache);
+    void pushCachedAudio(TTSCache::Audio &audio);
+    static GstPadProbeReturn sourceProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+    static GstPadProbeReturn sinkProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+    // Prefetch of the next utterance
+    static void PrefetchThreadFunc(void *ctx);
+    void wakePrefetch();
+    void prefetchNext();
+    bool fetchAudio(const std::string &url, std::vector<uint8_t> &audio);
+    bool prefetchCancelled();
+    void cancelPrefetch(const SpeechData *data = NULL);
+    bool takePrefetched(SpeechData &data, const std::string &key, TTSCache::Audio &audio);
 
     // GStreamer Helper functions
     bool needsPipelineUpdate();
-    std::string constructURL(TTSConfiguration &config, SpeechData &d);
+    std::string constructURL(TTSConfiguration &config, SpeechData &d, const std::string &sanitizedText);
+    std::string cacheKey(TTSConfiguration &config, const std::string &sanitizedText);
     bool isSilentPunctuation(const char c);
     void replaceSuccesivePunctuation(std::string& subject);
     void replaceIfIsolated(std::string& subject, const std::string& search, const std::string& replace);
@@ -210,7 +274,7 @@ private:
     void sanitizeString(std::string &input, std::string &sanitizedString);
     void speakText(TTSConfiguration config, SpeechData &data);
     bool waitForStatus(GstState expected_state, uint32_t timeout_ms);
-    void waitForAudioToFinishTimeout(float timeout_s);
+    bool waitForAudioToFinishTimeout(float timeout_s);
     bool handleMessage(GstMessage*);
     static int GstBusCallback(GstBus *bus, GstMessage *message, gpointer data);
     static void event_loop(void *data);
@@ -38,9 +38,16 @@
 // Events
 #define TIMER_EVT_TIMER_EXPIRED           "timerExpired"
 #define TIMER_EVT_TIMER_EXPIRY_REMINDER   "timerExpiryReminder"
+#define TIMER_EVT_TIMERS_EXPIRED          "timersExpired"
+#define TIMER_EVT_TIMERS_EXPIRY_REMINDER  "timersExpiryReminder"
 
 #define TIMER_ACCURACY 0.001 // 10 milliseconds
 
+// How often a system clock step is looked for while wallClock timers run
+#define TIMER_WALL_CLOCK_CHECK_INTERVAL 60.0
+// System clock changes below this are not treated as a step
+#define TIMER_WALL_CLOCK_STEP 1.0
+
 static const char* stateStrings[] = {
     "",
     "RUNNING",
@@ -65,6 +72,10 @@ namespace WPEFramework
 
         Timer::Timer()
         : AbstractPlugin()
+        , m_wallClockTimers(0)
+        , m_wallClockOffset(0)
+        , m_slack(0.0)
+        , m_batchNotifications(false)
         {
             Timer::_instance = this;
 
@@ -84,78 +95,149 @@ namespace WPEFramework
         {
         }
 
+        const string Timer::Initialize(PluginHost::IShell* service)
+        {
+            Config config;
+            if (service)
+                config.FromString(service->ConfigLine());
+
+            std::lock_guard<std::mutex> guard(m_callMutex);
+            m_slack = config.Slack.Value() / 1000.0;
+            m_batchNotifications = config.BatchNotifications.Value();
+
+            if (m_slack > 0 || m_batchNotifications)
+                LOGINFO("slack %u ms, batched notifications %s", config.Slack.Value(), m_batchNotifications ? "on" : "off");
+
+            return AbstractPlugin::Initialize(service);
+        }
+
         void Timer::Deinitialize(PluginHost::IShell* /* service */)
         {
             Timer::_instance = nullptr;
         }
 
+        static std::chrono::steady_clock::duration toDuration(double seconds)
+        {
+            return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        static std::chrono::system_clock::duration wallClockOffset(std::chrono::steady_clock::time_point now)
+        {
+            return std::chrono::system_clock::now().time_since_epoch() -
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(now.time_since_epoch());
+        }
+
         void Timer::checkTimers()
         {
-            double minTimeout = 100000;
-            for (auto it = m_runningItems.cbegin(); it != m_runningItems.cend(); ++it)
+            if (m_schedule.empty())
             {
-                unsigned int timerId = *it;
-                if (timerId < 0 || timerId >= m_timerItems.size())
-                {
-                    LOGERR("Internal error: wrong timerId");
-                    continue;
-                }
-                if (m_timerItems[timerId].state != RUNNING)
-                {
-                    LOGERR("Internal error: timer %d has wrong state", timerId);
-                    continue;
-                }
-
-                std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
-                double timeout =  m_timerItems[timerId].interval - elapsed.count();
+                m_timer.stop();
+                return;
+            }
 
-                if (!m_timerItems[timerId].reminderSent && m_timerItems[timerId].remindBefore > TIMER_ACCURACY)
-                {
-                    if (timeout > m_timerItems[timerId].remindBefore)
-                    {
-                        timeout -= m_timerItems[timerId].remindBefore;
-                    }
-                    else
-                    {
-                        sendTimerExpiryReminder(timerId);
-                        m_timerItems[timerId].reminderSent = true;
-                    }
-                }
+            std::chrono::duration<double> timeout = m_schedule.begin()->first - std::chrono::steady_clock::now();
+            double minTimeout = timeout.count();
 
-                if (timeout < minTimeout)
-                    minTimeout = timeout;
-            }
+            if (m_wallClockTimers > 0 && minTimeout > TIMER_WALL_CLOCK_CHECK_INTERVAL)
+                minTimeout = TIMER_WALL_CLOCK_CHECK_INTERVAL;
 
             if (minTimeout < TIMER_ACCURACY)
                 minTimeout = TIMER_ACCURACY;
 
-            if (minTimeout < 100000)
-                m_timer.start(int(minTimeout * 1000));
-            else
-                m_timer.stop();
+            m_timer.start(int(minTimeout * 1000));
+        }
+
+        // The next thing due for a running timer is its reminder, if one has to be sent, otherwise its expiry.
+        void Timer::schedule(int timerId)
+        {
+            TimerItem& item = m_timerItems[timerId];
+
+            item.scheduled = item.expiry;
+            if (!item.reminderSent && item.remindBefore > TIMER_ACCURACY)
+                item.scheduled -= toDuration(item.remindBefore);
+
+            m_schedule.insert(std::make_pair(item.scheduled, timerId));
+            if (item.wallClock)
+                m_wallClockTimers++;
+        }
+
+        void Timer::unschedule(int timerId)
+        {
+            TimerItem& item = m_timerItems[timerId];
+
+            if (m_schedule.erase(std::make_pair(item.scheduled, timerId)) > 0 && item.wallClock)
+                m_wallClockTimers--;
+        }
+
+        // steady_clock does not follow the system clock. When it was stepped (NTP, time zone or
+        // user setting), the wallClock timers get the steady expiry that matches their wall time again.
+        void Timer::checkWallClock(std::chrono::steady_clock::time_point now)
+        {
+            std::chrono::system_clock::duration offset = wallClockOffset(now);
+            std::chrono::duration<double> step = offset - m_wallClockOffset;
+            m_wallClockOffset = offset;
+
+            if (m_wallClockTimers == 0 || (step.count() < TIMER_WALL_CLOCK_STEP && step.count() > -TIMER_WALL_CLOCK_STEP))
+                return;
+
+            LOGINFO("System clock stepped by %.3f s, rescheduling wall clock timers", step.count());
+
+            std::chrono::system_clock::time_point wallNow = std::chrono::system_clock::now();
+            for (unsigned int timerId = 0; timerId < m_timerItems.size(); timerId++)
+            {
+                TimerItem& item = m_timerItems[timerId];
+                if (item.state != RUNNING || !item.wallClock)
+                    continue;
+
+                unschedule(timerId);
+                item.expiry = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(item.wallExpiry - wallNow);
+                schedule(timerId);
+            }
+        }
+
+        int Timer::allocateTimerId()
+        {
+            if (m_freeIds.empty())
+            {
+                m_timerItems.push_back(TimerItem());
+                return m_timerItems.size() - 1;
+            }
+
+            int timerId = *m_freeIds.begin();
+            m_freeIds.erase(m_freeIds.begin());
+            return timerId;
         }
 
         void Timer::startTimer(int timerId)
         {
-            m_runningItems.push_back(timerId);
-            m_timerItems[timerId].state = RUNNING;
+            TimerItem& item = m_timerItems[timerId];
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            item.state = RUNNING;
+            item.expiry = now + toDuration(item.interval);
+            item.reminderSent = false;
 
-            m_timerItems[timerId].lastExpired = std::chrono::system_clock::now();
-            m_timerItems[timerId].lastExpiryReminder = std::chrono::system_clock::now();
-            m_timerItems[timerId].reminderSent = false;
+            if (item.wallClock)
+            {
+                if (m_wallClockTimers == 0)
+                    m_wallClockOffset = wallClockOffset(now);
+                item.wallExpiry = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(toDuration(item.interval));
+            }
 
+            schedule(timerId);
             checkTimers();
         }
 
         bool Timer::cancelTimer(int timerId)
         {
+            bool running = RUNNING == m_timerItems[timerId].state;
+
             m_timerItems[timerId].state = CANCELED;
+            m_freeIds.insert(timerId);
 
-            auto it = std::find(m_runningItems.begin(), m_runningItems.end(), timerId);
-            if (m_runningItems.end() != it)
+            if (running)
             {
-                m_runningItems.erase(it);
-                m_timer.stop();
+                unschedule(timerId);
                 checkTimers();
                 return true;
             }
@@ -165,79 +247,74 @@ namespace WPEFramework
 
         bool Timer::suspendTimer(int timerId)
         {
-            m_timerItems[timerId].state = SUSPENDED;
+            if (RUNNING != m_timerItems[timerId].state)
+                return false;
 
-            auto it = std::find(m_runningItems.begin(), m_runningItems.end(), timerId);
-            if (m_runningItems.end() != it)
-            {
-                m_runningItems.erase(it);
-                m_timer.stop();
-                checkTimers();
-                return true;
-            }
-
-            return false;
+            m_timerItems[timerId].state = SUSPENDED;
+            unschedule(timerId);
+            checkTimers();
+            return true;
         }
 
         void Timer::onTimerCallback()
         {
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            std::list <int> itemsToDelete;
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            checkWallClock(now);
+
+            // Everything due within the slack is handled by this wakeup
+            std::chrono::steady_clock::time_point due = now + toDuration(std::max(m_slack, TIMER_ACCURACY));
+            std::list <int> reminded;
+            std::list <int> expired;
 
-            for (auto it = m_runningItems.cbegin(); it != m_runningItems.cend(); ++it)
+            while (!m_schedule.empty() && m_schedule.begin()->first <= due)
             {
-                unsigned int timerId = *it;
-                if (timerId < 0 || timerId >= m_timerItems.size())
-                {
-                    LOGERR("Internal error: wrong timerId");
-                    continue;
-                }
-                if (m_timerItems[timerId].state != RUNNING)
-                {
-                    LOGERR("Internal error: timer %d has wrong state", timerId);
-                    continue;
-                }
+                int timerId = m_schedule.begin()->second;
+                TimerItem& item = m_timerItems[timerId];
 
-                std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
-                double timeout =  m_timerItems[timerId].interval - elapsed.count();
+                unschedule(timerId);
 
-                if (!m_timerItems[timerId].reminderSent && m_timerItems[timerId].remindBefore > TIMER_ACCURACY)
+                if (!item.reminderSent && item.remindBefore > TIMER_ACCURACY)
                 {
-                    if (timeout < m_timerItems[timerId].remindBefore + TIMER_ACCURACY)
-                    {
-                        sendTimerExpiryReminder(timerId);
-                        m_timerItems[timerId].reminderSent = true;
-                    }
+                    reminded.push_back(timerId);
+                    item.reminderSent = true;
                 }
 
-                if (timeout <= TIMER_ACCURACY)
+                if (item.expiry <= due)
                 {
-                    sendTimerExpired(timerId);
-
-                    m_timerItems[timerId].lastExpired = std::chrono::system_clock::now();
+                    expired.push_back(timerId);
 
-                    if (m_timerItems[timerId].repeatInterval > 0)
+                    if (item.repeatInterval > 0)
                     {
-                        m_timerItems[timerId].interval = m_timerItems[timerId].repeatInterval;
+                        item.interval = item.repeatInterval;
+                        item.expiry = now + toDuration(item.interval);
+                        if (item.wallClock)
+                            item.wallExpiry = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(toDuration(item.interval));
+                        item.reminderSent = false;
                     }
                     else
                     {
-                        m_timerItems[timerId].state = EXPIRED;
-                        itemsToDelete.push_back(timerId);
+                        item.state = EXPIRED;
+                        m_freeIds.insert(timerId);
+                        continue;
                     }
-
-                    m_timerItems[timerId].reminderSent = false;
                 }
+
+                schedule(timerId);
             }
 
-            for (auto delIt = itemsToDelete.cbegin(); delIt != itemsToDelete.cend(); ++delIt)
-            {
-                auto it = std::find(m_runningItems.begin(), m_runningItems.end(), *delIt);
-                if (m_runningItems.end() != it)
-                    m_runningItems.erase(it);
+            if (m_batchNotifications && reminded.size() > 1)
+                sendTimersExpiryReminder(reminded);
+            else
+                for (auto it = reminded.cbegin(); it != reminded.cend(); ++it)
+                    sendTimerExpiryReminder(*it);
 
-            }
+            if (m_batchNotifications && expired.size() > 1)
+                sendTimersExpired(expired);
+            else
+                for (auto it = expired.cbegin(); it != expired.cend(); ++it)
+                    sendTimerExpired(*it);
 
             checkTimers();
         }
@@ -250,12 +327,11 @@ namespace WPEFramework
             output["state"] = stateStrings[m_timerItems[timerId].state];
             output["mode"] = modeStrings[m_timerItems[timerId].mode];
 
-            std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
-            double timeRemaining =  m_timerItems[timerId].interval - elapsed.count();
+            std::chrono::duration<double> timeRemaining = m_timerItems[timerId].expiry - std::chrono::steady_clock::now();
 
             char buf[256];
 
-            snprintf(buf, sizeof(buf), "%.3f", timeRemaining);
+            snprintf(buf, sizeof(buf), "%.3f", timeRemaining.count());
             output["timeRemaining"] = (const char *)buf;
 
             snprintf(buf, sizeof(buf), "%.3f", m_timerItems[timerId].repeatInterval);
@@ -293,11 +369,14 @@ namespace WPEFramework
 
             item.repeatInterval = parameters.HasLabel("repeatInterval") ? std::stod(parameters["repeatInterval"].String()) : 0.0;
             item.remindBefore = parameters.HasLabel("remindBefore") ? std::stod(parameters["remindBefore"].String()) : 0.0;
+            item.wallClock = parameters.HasLabel("wallClock") && parameters["wallClock"].Boolean();
+            item.reminderSent = false;
 
-            m_timerItems.push_back(item);
+            int timerId = allocateTimerId();
+            m_timerItems[timerId] = item;
 
-            startTimer(m_timerItems.size() - 1);
-            response["timerId"] = m_timerItems.size() - 1;
+            startTimer(timerId);
+            response["timerId"] = timerId;
 
             returnResponse(true);
         }
@@ -440,25 +519,31 @@ namespace WPEFramework
             returnResponse(true);
         }
 
-        void Timer::sendTimerExpired(int timerId)
+        void Timer::sendCecPowerRequest(TimerMode mode)
         {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
-            if (SLEEP == m_timerItems[timerId].mode || WAKE == m_timerItems[timerId].mode)
+            if (SLEEP == mode || WAKE == mode)
             {
                 // Taken from power iarm manager
                 IARM_Bus_CECMgr_Send_Param_t dataToSend;
                 unsigned char buf[] = {0x30, 0x36}; //standby msg, from TUNER to TV
 
-                if (WAKE == m_timerItems[timerId].mode)
+                if (WAKE == mode)
                     buf[1] = 0x4; // Image On instead of Standby
 
                 memset(&dataToSend, 0, sizeof(dataToSend));
                 dataToSend.length = sizeof(buf);
                 memcpy(dataToSend.data, buf, dataToSend.length);
-                LOGINFO("Timer send CEC %s", SLEEP == m_timerItems[timerId].mode ? "Standby" : "Wake");
+                LOGINFO("Timer send CEC %s", SLEEP == mode ? "Standby" : "Wake");
                 IARM_Bus_Call(IARM_BUS_CECMGR_NAME,IARM_BUS_CECMGR_API_Send,(void *)&dataToSend, sizeof(dataToSend));
             }
 #endif
+        }
+
+        void Timer::sendTimerExpired(int timerId)
+        {
+            sendCecPowerRequest(m_timerItems[timerId].mode);
+
             JsonObject params;
             params["timerId"] = timerId;
             params["mode"] = modeStrings[m_timerItems[timerId].mode];
@@ -472,11 +557,61 @@ namespace WPEFramework
             params["timerId"] = timerId;
             params["mode"] = modeStrings[m_timerItems[timerId].mode];
 
-            std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
+            std::chrono::duration<double> timeRemaining = m_timerItems[timerId].expiry - std::chrono::steady_clock::now();
 
-            params["timeRemaining"] = (int)(m_timerItems[timerId].interval - elapsed.count() + 0.5);
+            params["timeRemaining"] = (int)(timeRemaining.count() + 0.5);
             sendNotify(TIMER_EVT_TIMER_EXPIRY_REMINDER, params);
         }
+
+        // One CEC request per mode, whatever the number of SLEEP or WAKE timers that expired together
+        void Timer::sendTimersExpired(const std::list<int>& timerIds)
+        {
+            bool sleep = false;
+            bool wake = false;
+            JsonArray timers;
+
+            for (auto it = timerIds.cbegin(); it != timerIds.cend(); ++it)
+            {
+                sleep = sleep || SLEEP == m_timerItems[*it].mode;
+                wake = wake || WAKE == m_timerItems[*it].mode;
+
+                JsonObject timer;
+                timer["timerId"] = *it;
+                timer["mode"] = modeStrings[m_timerItems[*it].mode];
+                timer["status"] = 0;
+                timers.Add(timer);
+            }
+
+            if (sleep)
+                sendCecPowerRequest(SLEEP);
+            if (wake)
+                sendCecPowerRequest(WAKE);
+
+            JsonObject params;
+            params["timers"] = timers;
+            sendNotify(TIMER_EVT_TIMERS_EXPIRED, params);
+        }
+
+        void Timer::sendTimersExpiryReminder(const std::list<int>& timerIds)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            JsonArray timers;
+
+            for (auto it = timerIds.cbegin(); it != timerIds.cend(); ++it)
+            {
+                std::chrono::duration<double> timeRemaining = m_timerItems[*it].expiry - now;
+
+                JsonObject timer;
+                timer["timerId"] = *it;
+                timer["mode"] = modeStrings[m_timerItems[*it].mode];
+                timer["timeRemaining"] = (int)(timeRemaining.count() + 0.5);
+                timers.Add(timer);
+            }
+
+            JsonObject params;
+            params["timers"] = timers;
+            sendNotify(TIMER_EVT_TIMERS_EXPIRY_REMINDER, params);
+        }
     } // namespace Plugin
 } // namespace WPEFramework
 
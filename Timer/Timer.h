@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include <chrono>
 #include <mutex>
+#include <set>
 
 #include "Module.h"
 #include "utils.h"
@@ -52,8 +54,10 @@ namespace WPEFramework {
             TimerMode mode;
             double repeatInterval;
             double remindBefore;
-            std::chrono::system_clock::time_point lastExpired;
-            std::chrono::system_clock::time_point lastExpiryReminder;
+            bool wallClock;                                 // expiry follows system clock changes
+            std::chrono::steady_clock::time_point expiry;
+            std::chrono::system_clock::time_point wallExpiry;
+            std::chrono::steady_clock::time_point scheduled; // key in m_schedule while RUNNING
             bool reminderSent;
         };
 
@@ -70,6 +74,29 @@ namespace WPEFramework {
 		// this class exposes a public method called, Notify(), using this methods, all subscribed clients
 		// will receive a JSONRPC message as a notification, in case this method is called.
         class Timer : public AbstractPlugin {
+        public:
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : Slack(0)
+                    , BatchNotifications(false)
+                {
+                    Add(_T("slack"), &Slack);
+                    Add(_T("batchnotifications"), &BatchNotifications);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Slack;                // ms a reminder or expiry may come early to share a wakeup
+                Core::JSON::Boolean BatchNotifications;     // timers of one wakeup in one event
+            };
+
         private:
 
             // We do not allow this plugin to be copied !!
@@ -88,10 +115,18 @@ namespace WPEFramework {
             //Begin events
             void sendTimerExpired(int timerId);
             void sendTimerExpiryReminder(int timerId);
+            void sendTimersExpired(const std::list<int>& timerIds);
+            void sendTimersExpiryReminder(const std::list<int>& timerIds);
             //End events
 
+            void sendCecPowerRequest(TimerMode mode);
+
             void checkTimers();
+            void schedule(int timerId);
+            void unschedule(int timerId);
+            void checkWallClock(std::chrono::steady_clock::time_point now);
 
+            int allocateTimerId();
             void startTimer(int timerId);
             bool cancelTimer(int timerId);
             bool suspendTimer(int timerId);
@@ -102,6 +137,7 @@ namespace WPEFramework {
         public:
             Timer();
             virtual ~Timer();
+            virtual const string Initialize(PluginHost::IShell* service) override;
             virtual void Deinitialize(PluginHost::IShell* service) override;
 
         public:
@@ -109,7 +145,12 @@ namespace WPEFramework {
         private:
             TpTimer m_timer;
             std::vector <TimerItem> m_timerItems;
-            std::list <int> m_runningItems;
+            std::set <int> m_freeIds;               // canceled or expired, reused lowest first
+            std::set <std::pair<std::chrono::steady_clock::time_point, int>> m_schedule;   // next reminder or expiry of the running timers
+            int m_wallClockTimers;                  // running wallClock timers
+            std::chrono::system_clock::duration m_wallClockOffset;
+            double m_slack;                         // s
+            bool m_batchNotifications;
             std::mutex m_callMutex;
         };
 	} // namespace Plugin
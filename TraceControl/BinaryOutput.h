@@ -0,0 +1,254 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "TraceBinaryFormat.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#ifndef __WINDOWS__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Writes trace entries as they are found in the trace buffers, without any
+    // text formatting, to a file or to a UDP receiver (see TraceBinaryFormat.h).
+    // Only used from the observer thread.
+    class BinaryOutput {
+    private:
+        // Repeat the string table on UDP, receivers may have joined late or lost datagrams.
+        static constexpr uint64_t AnnounceInterval = 5 * Core::Time::MicroSecondsPerSecond;
+        static constexpr uint32_t FileBufferSize = 64 * 1024;
+
+    public:
+        BinaryOutput() = delete;
+        BinaryOutput(const BinaryOutput&) = delete;
+        BinaryOutput& operator=(const BinaryOutput&) = delete;
+
+        BinaryOutput(const string& fileName)
+            : _file(nullptr)
+            , _socket(-1)
+            , _addressLength(0)
+            , _session(0)
+            , _used(0)
+            , _announced(0)
+            , _strings()
+        {
+            _file = fopen(fileName.c_str(), "ab");
+
+            if (_file != nullptr) {
+                setvbuf(_file, nullptr, _IOFBF, FileBufferSize);
+                Start();
+            } else {
+                TRACE(Trace::Error, (_T("Could not open binary trace file %s"), fileName.c_str()));
+            }
+        }
+        BinaryOutput(const string& binding, const uint16_t port)
+            : _file(nullptr)
+            , _socket(-1)
+            , _addressLength(0)
+            , _session(0)
+            , _used(0)
+            , _announced(0)
+            , _strings()
+        {
+#ifndef __WINDOWS__
+            ::memset(&_address, 0, sizeof(_address));
+
+            struct sockaddr_in* ipv4 = reinterpret_cast<struct sockaddr_in*>(&_address);
+            struct sockaddr_in6* ipv6 = reinterpret_cast<struct sockaddr_in6*>(&_address);
+
+            if (inet_pton(AF_INET, binding.c_str(), &(ipv4->sin_addr)) == 1) {
+                ipv4->sin_family = AF_INET;
+                ipv4->sin_port = htons(port);
+                _addressLength = sizeof(struct sockaddr_in);
+            } else if (inet_pton(AF_INET6, binding.c_str(), &(ipv6->sin6_addr)) == 1) {
+                ipv6->sin6_family = AF_INET6;
+                ipv6->sin6_port = htons(port);
+                _addressLength = sizeof(struct sockaddr_in6);
+            }
+
+            if (_addressLength != 0) {
+                _socket = ::socket(_address.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            }
+
+            if (_socket >= 0) {
+                Start();
+            } else {
+                TRACE(Trace::Error, (_T("Could not set up binary trace output to %s:%d"), binding.c_str(), port));
+            }
+#else
+            TRACE(Trace::Error, (_T("Binary trace output over UDP is not supported")));
+#endif
+        }
+        ~BinaryOutput()
+        {
+            Flush();
+
+            if (_file != nullptr) {
+                fclose(_file);
+            }
+#ifndef __WINDOWS__
+            if (_socket >= 0) {
+                ::close(_socket);
+            }
+#endif
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return ((_file != nullptr) || (_socket >= 0));
+        }
+        void Output(const uint64_t timestamp, const uint32_t lineNumber, const char fileName[], const char module[], const char category[], const char className[], const char data[], const uint16_t length)
+        {
+            if ((_socket >= 0) && ((timestamp - _announced) >= AnnounceInterval)) {
+                _announced = timestamp;
+                Announce();
+            }
+
+            uint8_t header[TraceBinary::EntryHeaderSize];
+            uint16_t ids[4] = { Intern(fileName), Intern(module), Intern(category), Intern(className) };
+
+            // The text is cut, rather than split over records.
+            uint16_t text = std::min(length, static_cast<uint16_t>(Capacity() - TraceBinary::EntryHeaderSize));
+
+            header[0] = TraceBinary::TYPE_ENTRY;
+            header[1] = 0;
+            TraceBinary::Store16(&header[2], TraceBinary::EntryHeaderSize + text);
+            TraceBinary::Store64(&header[4], timestamp);
+            TraceBinary::Store32(&header[12], lineNumber);
+            TraceBinary::Store16(&header[16], ids[0]);
+            TraceBinary::Store16(&header[18], ids[1]);
+            TraceBinary::Store16(&header[20], ids[2]);
+            TraceBinary::Store16(&header[22], ids[3]);
+
+            Append(header, sizeof(header), reinterpret_cast<const uint8_t*>(data), text);
+        }
+        // Called when the observer ran out of entries, so nothing lingers in a buffer.
+        void Flush()
+        {
+            if (_file != nullptr) {
+                fflush(_file);
+            }
+#ifndef __WINDOWS__
+            if ((_socket >= 0) && (_used > TraceBinary::HeaderSize)) {
+                // Lossy by design, tracing must never block on the network.
+                ::sendto(_socket, _datagram, _used, MSG_DONTWAIT, reinterpret_cast<const struct sockaddr*>(&_address), _addressLength);
+                _used = TraceBinary::HeaderSize;
+            }
+#endif
+        }
+
+    private:
+        inline uint16_t Capacity() const
+        {
+            return (_socket >= 0 ? TraceBinary::DatagramSize - TraceBinary::HeaderSize : static_cast<uint16_t>(~0));
+        }
+        void Start()
+        {
+            uint8_t header[TraceBinary::HeaderSize];
+
+            Crypto::Random(_session);
+
+            ::memcpy(header, TraceBinary::Magic, sizeof(TraceBinary::Magic));
+            header[4] = TraceBinary::Version;
+            header[5] = 0;
+            TraceBinary::Store16(&header[6], _session);
+
+            if (_file != nullptr) {
+                fwrite(header, 1, sizeof(header), _file);
+            } else {
+                // Every datagram starts with the header.
+                ::memcpy(_datagram, header, sizeof(header));
+                _used = sizeof(header);
+            }
+        }
+        uint16_t Intern(const char text[])
+        {
+            uint16_t result = 0;
+            auto index = _strings.find(text);
+
+            if (index != _strings.end()) {
+                result = index->second;
+            } else if (_strings.size() < 0xFFFE) {
+                // Id 0 is left for "unknown", once the table is full.
+                result = static_cast<uint16_t>(_strings.size() + 1);
+                index = _strings.emplace(text, result).first;
+                Define(index->first, result);
+            }
+
+            return (result);
+        }
+        void Define(const string& text, const uint16_t id)
+        {
+            uint8_t header[TraceBinary::StringHeaderSize];
+            uint16_t length = static_cast<uint16_t>(std::min(text.length(), static_cast<size_t>(Capacity() - TraceBinary::StringHeaderSize)));
+
+            header[0] = TraceBinary::TYPE_STRING;
+            header[1] = 0;
+            TraceBinary::Store16(&header[2], TraceBinary::StringHeaderSize + length);
+            TraceBinary::Store16(&header[4], id);
+
+            Append(header, sizeof(header), reinterpret_cast<const uint8_t*>(text.c_str()), length);
+        }
+        void Announce()
+        {
+            for (const auto& entry : _strings) {
+                Define(entry.first, entry.second);
+            }
+        }
+        void Append(const uint8_t header[], const uint16_t headerLength, const uint8_t data[], const uint16_t dataLength)
+        {
+            if (_file != nullptr) {
+                fwrite(header, 1, headerLength, _file);
+                fwrite(data, 1, dataLength, _file);
+            } else if (_socket >= 0) {
+                if ((_used + headerLength + dataLength) > TraceBinary::DatagramSize) {
+                    Flush();
+                }
+                ::memcpy(&_datagram[_used], header, headerLength);
+                ::memcpy(&_datagram[_used + headerLength], data, dataLength);
+                _used += headerLength + dataLength;
+            }
+        }
+
+    private:
+        FILE* _file;
+        int _socket;
+#ifndef __WINDOWS__
+        struct sockaddr_storage _address;
+#endif
+        uint32_t _addressLength;
+        uint16_t _session;
+        uint16_t _used;
+        uint64_t _announced;
+        uint8_t _datagram[TraceBinary::DatagramSize];
+        std::unordered_map<string, uint16_t> _strings;
+    };
+}
+}
@@ -0,0 +1,89 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Binary trace stream, shared by the TraceControl binary output and the offline
+// decoder (tools/TraceDecode.cpp), so it must not depend on the framework.
+//
+// All fields are little endian. A stream is a sequence of:
+//
+//   header : magic "TCTB" (4) | version (1) | reserved (1) | session (2)
+//   record : type (1) | reserved (1) | length of the whole record (2) | body
+//
+// with the bodies:
+//
+//   TYPE_STRING : id (2) | text (length - 6, not terminated)
+//   TYPE_ENTRY  : timestamp in us (8) | line (4) | file id (2) | module id (2)
+//                 | category id (2) | class id (2) | text (rest)
+//
+// File names, modules, categories and class names are interned: a TYPE_STRING
+// record defines an id before the first entry using it. The session changes
+// whenever the writer starts over, with new ids. On UDP every datagram starts
+// with a header and the string table is repeated regularly, so a receiver can
+// join (or lose datagrams) at any time.
+
+#include <stdint.h>
+
+namespace TraceBinary {
+
+    static const uint8_t Magic[4] = { 'T', 'C', 'T', 'B' };
+    static const uint8_t Version = 1;
+
+    static const uint16_t HeaderSize = 8;
+    static const uint16_t RecordHeaderSize = 4;
+    static const uint16_t StringHeaderSize = RecordHeaderSize + 2;
+    static const uint16_t EntryHeaderSize = RecordHeaderSize + 8 + 4 + 2 + 2 + 2 + 2;
+
+    // Leaves room for IP/UDP headers within a 1500 byte MTU.
+    static const uint16_t DatagramSize = 1472;
+
+    enum type : uint8_t {
+        TYPE_STRING = 1,
+        TYPE_ENTRY = 2
+    };
+
+    inline void Store16(uint8_t buffer[], const uint16_t value)
+    {
+        buffer[0] = static_cast<uint8_t>(value);
+        buffer[1] = static_cast<uint8_t>(value >> 8);
+    }
+    inline void Store32(uint8_t buffer[], const uint32_t value)
+    {
+        Store16(buffer, static_cast<uint16_t>(value));
+        Store16(buffer + 2, static_cast<uint16_t>(value >> 16));
+    }
+    inline void Store64(uint8_t buffer[], const uint64_t value)
+    {
+        Store32(buffer, static_cast<uint32_t>(value));
+        Store32(buffer + 4, static_cast<uint32_t>(value >> 32));
+    }
+    inline uint16_t Load16(const uint8_t buffer[])
+    {
+        return (static_cast<uint16_t>(buffer[0] | (buffer[1] << 8)));
+    }
+    inline uint32_t Load32(const uint8_t buffer[])
+    {
+        return (Load16(buffer) | (static_cast<uint32_t>(Load16(buffer + 2)) << 16));
+    }
+    inline uint64_t Load64(const uint8_t buffer[])
+    {
+        return (Load32(buffer) | (static_cast<uint64_t>(Load32(buffer + 4)) << 32));
+    }
+}
@@ -19,6 +19,7 @@
  
 #include "TraceControl.h"
 #include "TraceOutput.h"
+#include "BinaryOutput.h"
 
 namespace WPEFramework {
 
@@ -78,6 +79,18 @@ namespace Plugin {
 
             _outputs.push_back(new Trace::TraceMedia(logNode));
         }
+        if ((_config.Binary.Path.IsSet() == true) || (_config.Binary.Remote.IsSet() == true)) {
+            if (_config.Binary.Path.IsSet() == true) {
+                _binary = new BinaryOutput(_config.Binary.Path.Value());
+            } else {
+                _binary = new BinaryOutput(_config.Binary.Remote.Binding.Value(), _config.Binary.Remote.Port.Value());
+            }
+
+            if (_binary->IsValid() == false) {
+                delete _binary;
+                _binary = nullptr;
+            }
+        }
 
         _service->Register(&_observer);
 
@@ -102,6 +115,11 @@ namespace Plugin {
 
             _outputs.pop_front();
         }
+
+        if (_binary != nullptr) {
+            delete _binary;
+            _binary = nullptr;
+        }
     }
 
     /* virtual */ string TraceControl::Information() const
@@ -152,6 +170,7 @@ namespace Plugin {
                     response->Settings.Add(Data::Trace(moduleName, categoryName, categories.State()));
                 }
             }
+            Costs(*response, string(), string());
 
             result->Body(Core::proxy_cast<Web::IBody>(response));
             result->ContentType = Web::MIME_JSON;
@@ -209,6 +228,49 @@ namespace Plugin {
         return (result);
     }
 
+    // Adds what the listed categories cost and, unless filtered on a module or category, the
+    // counters of the buffers they were read from (one per process, 0 is the framework itself).
+    void TraceControl::Costs(Data& response, const string& module, const string& category)
+    {
+        Observer::Accounting::CostMap costs;
+        std::list<Observer::Accounting::SourceReport> sources;
+        std::list<Observer::Limiter::Report> reports;
+
+        _observer.Costs(costs, sources);
+        _observer.Reports(reports);
+
+        Core::JSON::ArrayType<Data::Trace>::Iterator index(response.Settings.Elements());
+
+        while (index.Next() == true) {
+            Data::Trace& trace(index.Current());
+            const std::pair<string, string> key(trace.Module.Value(), trace.Category.Value());
+            Observer::Accounting::CostMap::const_iterator cost(costs.find(key));
+            uint64_t filtered = 0;
+
+            for (const Observer::Limiter::Report& report : reports) {
+                if ((report.Module == key.first) && (report.Category == key.second)) {
+                    filtered = report.Sampled + report.Limited;
+                    break;
+                }
+            }
+
+            trace.Messages = (cost != costs.end() ? cost->second.Messages : 0);
+            trace.Bytes = (cost != costs.end() ? cost->second.Bytes : 0);
+            trace.Filtered = filtered;
+        }
+
+        if ((module.empty() == true) && (category.empty() == true)) {
+            for (const Observer::Accounting::SourceReport& report : sources) {
+                Data::Source& source(response.Sources.Add());
+                source.Id = report.Id;
+                source.Messages = report.Messages;
+                source.Bytes = report.Bytes;
+                source.Overflows = report.Overflows;
+                source.Resyncs = report.Resyncs;
+            }
+        }
+    }
+
     void TraceControl::Dispatch(Observer::Source& information)
     {
         std::list<Trace::ITraceMedia*>::iterator index(_outputs.begin());
@@ -218,6 +280,18 @@ namespace Plugin {
             (*index)->Output(information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
             index++;
         }
+
+        if (_binary != nullptr) {
+            _binary->Output(information.Timestamp(), information.LineNumber(), information.FileName(), information.Module(),
+                information.Category(), information.ClassName(), information.Information(), information.Length());
+        }
+    }
+
+    void TraceControl::Flush()
+    {
+        if (_binary != nullptr) {
+            _binary->Flush();
+        }
     }
 }
 }
@@ -22,10 +22,14 @@
 #include "Module.h"
 #include <interfaces/json/JsonData_TraceControl.h>
 
+#include <algorithm>
+
 namespace WPEFramework {
 
 namespace Plugin {
 
+    class BinaryOutput;
+
     class TraceControl : public PluginHost::IPlugin, public PluginHost::IWeb, public PluginHost::JSONRPC {
 
     public:
@@ -128,6 +132,10 @@ namespace Plugin {
                     , _classname(0)
                     , _information()
                     , _state(EMPTY)
+                    , _messages(0)
+                    , _bytes(0)
+                    , _overflows(0)
+                    , _resyncs(0)
                 {
                     if (_connection != nullptr) {
                         TRACE(Trace::Information, (_T("Constructing TraceControl::Source (%d)"), connection->Id()));
@@ -209,6 +217,11 @@ namespace Plugin {
                         available = Core::CyclicBuffer::Validate();
                     }
 
+                    // The writer overwrote entries not read yet, they are lost to every output.
+                    if ((available == true) && (Core::CyclicBuffer::Overwritten() == true)) {
+                        _overflows++;
+                    }
+
                     // Traces will be commited in one go, First reserve, then write. So if there is a length (2 bytes)
                     // The full trace has to be available as well.
                     if ((available == true) && (_state == EMPTY) && ((length = Read(_traceBuffer, sizeof(_traceBuffer))) != 0)) {
@@ -254,6 +267,8 @@ namespace Plugin {
 
                                 // Entries are read in whole, so we are done.
                                 _state = LOADED;
+                                _messages++;
+                                _bytes += requiredLength;
                             }
                         }
                     }
@@ -299,9 +314,31 @@ namespace Plugin {
                 {
                     return (_length);
                 }
+                // Size of the loaded entry in the buffer, header included.
+                inline uint16_t EntrySize() const
+                {
+                    return (static_cast<uint16_t>((_traceBuffer[1] << 8) | _traceBuffer[0]));
+                }
+                inline uint64_t Messages() const
+                {
+                    return (_messages);
+                }
+                inline uint64_t Bytes() const
+                {
+                    return (_bytes);
+                }
+                inline uint64_t Overflows() const
+                {
+                    return (_overflows);
+                }
+                inline uint64_t Resyncs() const
+                {
+                    return (_resyncs);
+                }
                 void Flush()
                 {
                     _state = EMPTY;
+                    _resyncs++;
                     Core::CyclicBuffer::Flush();
                 }
                 void Clear()
@@ -327,6 +364,10 @@ namespace Plugin {
                 uint16_t _information;
                 uint16_t _length;
                 state _state;
+                uint64_t _messages;
+                uint64_t _bytes; // entry sizes, as written into the buffer
+                uint64_t _overflows; // times the writer overwrote unread entries
+                uint64_t _resyncs; // times the buffer was flushed on an inconsistent entry
                 uint8_t _traceBuffer[Trace::CyclicBufferSize];
                 static LocalIterator _localIterator;
             };
@@ -549,6 +590,209 @@ namespace Plugin {
                 ModuleMapIterator _iterator;
             };
 
+            // Sampling (1-in-N) and token bucket rate limits per module/category, applied
+            // before an entry is dispatched. An empty module or category applies to all,
+            // the most specific limit wins. Only used with the observer lock taken.
+            // The entry is already in the cyclic buffer of its process by then: this spares
+            // the outputs, it does not keep a chatty category from overflowing the buffer.
+            class Limiter {
+            public:
+                struct Limit {
+                    uint32_t Sample; // pass 1 in Sample entries, 0 or 1 passes all
+                    uint32_t Rate; // entries per second, 0 is unlimited
+                    uint32_t Burst; // bucket size, entries
+                };
+                struct Report {
+                    string Module;
+                    string Category;
+                    Limit Limits;
+                    uint64_t Passed;
+                    uint64_t Sampled;
+                    uint64_t Limited;
+                };
+
+            private:
+                typedef std::pair<string, string> Key;
+
+                struct State {
+                    bool Active;
+                    Limit Limits;
+                    uint32_t Counter;
+                    double Tokens;
+                    uint64_t Refilled;
+                    uint64_t Passed;
+                    uint64_t Sampled;
+                    uint64_t Limited;
+                };
+
+            public:
+                Limiter(const Limiter&) = delete;
+                Limiter& operator=(const Limiter&) = delete;
+
+                Limiter()
+                    : _limits()
+                    , _states()
+                {
+                }
+                ~Limiter()
+                {
+                }
+
+            public:
+                // A limit that neither samples nor limits removes the limit.
+                void Set(const string& module, const string& category, const Limit& limit)
+                {
+                    if ((limit.Sample <= 1) && (limit.Rate == 0)) {
+                        _limits.erase(Key(module, category));
+                    } else {
+                        Limit& entry(_limits[Key(module, category)]);
+                        entry = limit;
+                        if (entry.Burst == 0) {
+                            entry.Burst = std::max(limit.Rate, static_cast<uint32_t>(1));
+                        }
+                    }
+
+                    // Re-resolve the categories seen so far, their counters are kept.
+                    std::map<Key, State>::iterator index(_states.begin());
+                    while (index != _states.end()) {
+                        State& state(index->second);
+                        state.Active = Resolve(index->first, state.Limits);
+                        state.Tokens = std::min(state.Tokens, static_cast<double>(state.Limits.Burst));
+                        if ((state.Active == false) && (state.Sampled == 0) && (state.Limited == 0)) {
+                            index = _states.erase(index);
+                        } else {
+                            index++;
+                        }
+                    }
+                }
+                bool Pass(const char module[], const char category[], const uint64_t timestamp)
+                {
+                    bool result = true;
+
+                    if (_limits.empty() == false) {
+                        Key key(module, category);
+                        std::map<Key, State>::iterator index(_states.find(key));
+
+                        if (index == _states.end()) {
+                            State state;
+                            state.Active = Resolve(key, state.Limits);
+                            state.Counter = 0;
+                            state.Tokens = state.Limits.Burst;
+                            state.Refilled = timestamp;
+                            state.Passed = 0;
+                            state.Sampled = 0;
+                            state.Limited = 0;
+                            index = _states.emplace(key, state).first;
+                        }
+
+                        State& state(index->second);
+
+                        if (state.Active == true) {
+                            if ((state.Limits.Sample > 1) && ((state.Counter++ % state.Limits.Sample) != 0)) {
+                                state.Sampled++;
+                                result = false;
+                            } else if (state.Limits.Rate > 0) {
+                                // Timestamps of different sources may interleave slightly out of order.
+                                if (timestamp > state.Refilled) {
+                                    state.Tokens = std::min(static_cast<double>(state.Limits.Burst),
+                                        state.Tokens + ((timestamp - state.Refilled) * static_cast<double>(state.Limits.Rate) / Core::Time::MicroSecondsPerSecond));
+                                    state.Refilled = timestamp;
+                                }
+                                if (state.Tokens >= 1.0) {
+                                    state.Tokens -= 1.0;
+                                } else {
+                                    state.Limited++;
+                                    result = false;
+                                }
+                            }
+
+                            if (result == true) {
+                                state.Passed++;
+                            }
+                        }
+                    }
+
+                    return (result);
+                }
+                void Reports(std::list<Report>& reports) const
+                {
+                    for (const auto& entry : _states) {
+                        if ((entry.second.Active == true) || (entry.second.Sampled != 0) || (entry.second.Limited != 0)) {
+                            const State& state(entry.second);
+                            reports.push_back({ entry.first.first, entry.first.second, state.Limits, state.Passed, state.Sampled, state.Limited });
+                        }
+                    }
+                }
+
+            private:
+                bool Resolve(const Key& key, Limit& limit) const
+                {
+                    static const string all;
+                    const Key candidates[] = { key, Key(key.first, all), Key(all, key.second), Key(all, all) };
+
+                    for (const Key& candidate : candidates) {
+                        std::map<Key, Limit>::const_iterator index(_limits.find(candidate));
+                        if (index != _limits.end()) {
+                            limit = index->second;
+                            return (true);
+                        }
+                    }
+
+                    limit = { 0, 0, 0 };
+                    return (false);
+                }
+
+            private:
+                std::map<Key, Limit> _limits;
+                std::map<Key, State> _states;
+            };
+
+            // What each module/category costs: the entries it wrote into the cyclic buffers and
+            // their size, whether they were dispatched or not. Entries overwritten before they
+            // were read are gone, so overflows are only known per buffer (Source), not per category.
+            class Accounting {
+            public:
+                struct Cost {
+                    uint64_t Messages;
+                    uint64_t Bytes;
+                };
+                struct SourceReport {
+                    uint32_t Id;
+                    uint64_t Messages;
+                    uint64_t Bytes;
+                    uint64_t Overflows;
+                    uint64_t Resyncs;
+                };
+                typedef std::map<std::pair<string, string>, Cost> CostMap;
+
+            public:
+                Accounting(const Accounting&) = delete;
+                Accounting& operator=(const Accounting&) = delete;
+
+                Accounting()
+                    : _costs()
+                {
+                }
+                ~Accounting()
+                {
+                }
+
+            public:
+                void Count(const char module[], const char category[], const uint16_t size)
+                {
+                    Cost& cost(_costs[std::pair<string, string>(module, category)]);
+                    cost.Messages++;
+                    cost.Bytes += size;
+                }
+                inline const CostMap& Costs() const
+                {
+                    return (_costs);
+                }
+
+            private:
+                CostMap _costs;
+            };
+
         public:
             Observer(TraceControl& parent)
                 : Thread(Core::Thread::DefaultStackSize(), _T("TraceWorker"))
@@ -556,6 +800,8 @@ namespace Plugin {
                 , _traceControl(Trace::TraceUnit::Instance())
                 , _parent(parent)
                 , _refcount(0)
+                , _limiter()
+                , _accounting()
             {
             }
             ~Observer()
@@ -635,6 +881,33 @@ namespace Plugin {
                 _adminLock.Unlock();
             }
 
+            void Limit(const std::string& module, const std::string& category, const Limiter::Limit& limit)
+            {
+                _adminLock.Lock();
+                _limiter.Set(module, category, limit);
+                _adminLock.Unlock();
+            }
+            void Reports(std::list<Limiter::Report>& reports) const
+            {
+                _adminLock.Lock();
+                _limiter.Reports(reports);
+                _adminLock.Unlock();
+            }
+
+            void Costs(Accounting::CostMap& costs, std::list<Accounting::SourceReport>& sources) const
+            {
+                _adminLock.Lock();
+
+                costs = _accounting.Costs();
+
+                for (const auto& entry : _buffers) {
+                    const Source& source(*entry.second);
+                    sources.push_back({ entry.first, source.Messages(), source.Bytes(), source.Overflows(), source.Resyncs() });
+                }
+
+                _adminLock.Unlock();
+            }
+
             void Relinquish()
             {
                 _adminLock.Lock();
@@ -708,8 +981,12 @@ namespace Plugin {
 
                         if (selected != nullptr) {
 
-                            // Oke, output this entry
-                            _parent.Dispatch(*selected);
+                            _accounting.Count(selected->Module(), selected->Category(), selected->EntrySize());
+
+                            // Oke, output this entry, unless it is sampled out or over its rate.
+                            if (_limiter.Pass(selected->Module(), selected->Category(), selected->Timestamp()) == true) {
+                                _parent.Dispatch(*selected);
+                            }
 
                             // Ready to load a new one..
                             selected->Clear();
@@ -722,17 +999,22 @@ namespace Plugin {
                         _adminLock.Unlock();
 
                     } while ((IsRunning() == true) && (timeStamp != static_cast<uint64_t>(~0)));
+
+                    // All buffers are drained, push out whatever the outputs still hold.
+                    _parent.Flush();
                 }
 
                 return (Core::infinite);
             }
 
         private:
-            Core::CriticalSection _adminLock;
+            mutable Core::CriticalSection _adminLock;
             std::map<const uint32_t, Source*> _buffers;
             Trace::TraceUnit& _traceControl;
             TraceControl& _parent;
             mutable uint32_t _refcount;
+            Limiter _limiter;
+            Accounting _accounting;
         };
 
         class InformationWrapper : public Trace::ITrace {
@@ -807,6 +1089,28 @@ namespace Plugin {
             Core::JSON::DecUInt16 Port;
             Core::JSON::String Binding;
         };
+        class BinaryNode : public Core::JSON::Container {
+        private:
+            BinaryNode(const BinaryNode&);
+            BinaryNode& operator=(const BinaryNode&);
+
+        public:
+            BinaryNode()
+                : Core::JSON::Container()
+                , Path()
+                , Remote()
+            {
+                Add(_T("path"), &Path);
+                Add(_T("remote"), &Remote);
+            }
+            ~BinaryNode()
+            {
+            }
+
+        public:
+            Core::JSON::String Path;
+            NetworkNode Remote;
+        };
         class Config : public Core::JSON::Container {
         private:
             Config(const Config&);
@@ -819,11 +1123,13 @@ namespace Plugin {
                 , SysLog(true)
                 , Abbreviated(true)
                 , Remote()
+                , Binary()
             {
                 Add(_T("console"), &Console);
                 Add(_T("syslog"), &SysLog);
                 Add(_T("abbreviated"), &Abbreviated);
                 Add(_T("remote"), &Remote);
+                Add(_T("binary"), &Binary);
             }
             ~Config()
             {
@@ -834,6 +1140,7 @@ namespace Plugin {
             Core::JSON::Boolean SysLog;
             Core::JSON::Boolean Abbreviated;
             NetworkNode Remote;
+            BinaryNode Binary;
         };
         class Data : public Core::JSON::Container {
         public:
@@ -864,16 +1171,12 @@ namespace Plugin {
                 Trace()
                     : Core::JSON::Container()
                 {
-                    Add(_T("module"), &Module);
-                    Add(_T("category"), &Category);
-                    Add(_T("state"), &State);
+                    Init();
                 }
                 Trace(const string& moduleName, const string& categoryName, const state currentState)
                     : Core::JSON::Container()
                 {
-                    Add(_T("module"), &Module);
-                    Add(_T("category"), &Category);
-                    Add(_T("state"), &State);
+                    Init();
 
                     Module = moduleName;
                     Category = categoryName;
@@ -884,12 +1187,94 @@ namespace Plugin {
                     , Module(copy.Module)
                     , Category(copy.Category)
                     , State(copy.State)
+                    , Messages(copy.Messages)
+                    , Bytes(copy.Bytes)
+                    , Filtered(copy.Filtered)
+                {
+                    Init();
+                }
+                ~Trace()
+                {
+                }
+
+            private:
+                void Init()
                 {
                     Add(_T("module"), &Module);
                     Add(_T("category"), &Category);
                     Add(_T("state"), &State);
+                    Add(_T("messages"), &Messages);
+                    Add(_T("bytes"), &Bytes);
+                    Add(_T("filtered"), &Filtered);
                 }
-                ~Trace()
+
+            public:
+                Core::JSON::String Module;
+                Core::JSON::String Category;
+                Core::JSON::EnumType<state> State;
+                Core::JSON::DecUInt64 Messages; // entries read from the buffers
+                Core::JSON::DecUInt64 Bytes; // their size in the buffers
+                Core::JSON::DecUInt64 Filtered; // entries dropped by sampling or the rate limit
+            };
+
+            class Source : public Core::JSON::Container {
+            private:
+                Source& operator=(const Source&);
+
+            public:
+                Source()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                Source(const Source& copy)
+                    : Core::JSON::Container()
+                    , Id(copy.Id)
+                    , Messages(copy.Messages)
+                    , Bytes(copy.Bytes)
+                    , Overflows(copy.Overflows)
+                    , Resyncs(copy.Resyncs)
+                {
+                    Init();
+                }
+                ~Source()
+                {
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("id"), &Id);
+                    Add(_T("messages"), &Messages);
+                    Add(_T("bytes"), &Bytes);
+                    Add(_T("overflows"), &Overflows);
+                    Add(_T("resyncs"), &Resyncs);
+                }
+
+            public:
+                Core::JSON::DecUInt32 Id; // RPC connection, 0 for the framework itself
+                Core::JSON::DecUInt64 Messages;
+                Core::JSON::DecUInt64 Bytes;
+                Core::JSON::DecUInt64 Overflows;
+                Core::JSON::DecUInt64 Resyncs;
+            };
+
+            class SetParams : public Core::JSON::Container {
+            public:
+                SetParams(const SetParams&) = delete;
+                SetParams& operator=(const SetParams&) = delete;
+
+                SetParams()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("module"), &Module);
+                    Add(_T("category"), &Category);
+                    Add(_T("state"), &State);
+                    Add(_T("sample"), &Sample);
+                    Add(_T("rate"), &Rate);
+                    Add(_T("burst"), &Burst);
+                }
+                ~SetParams()
                 {
                 }
 
@@ -897,6 +1282,78 @@ namespace Plugin {
                 Core::JSON::String Module;
                 Core::JSON::String Category;
                 Core::JSON::EnumType<state> State;
+                Core::JSON::DecUInt32 Sample;
+                Core::JSON::DecUInt32 Rate;
+                Core::JSON::DecUInt32 Burst;
+            };
+
+            class Limit : public Core::JSON::Container {
+            private:
+                Limit& operator=(const Limit&);
+
+            public:
+                Limit()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                Limit(const Limit& copy)
+                    : Core::JSON::Container()
+                    , Module(copy.Module)
+                    , Category(copy.Category)
+                    , Sample(copy.Sample)
+                    , Rate(copy.Rate)
+                    , Burst(copy.Burst)
+                    , Passed(copy.Passed)
+                    , Sampled(copy.Sampled)
+                    , Limited(copy.Limited)
+                {
+                    Init();
+                }
+                ~Limit()
+                {
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("module"), &Module);
+                    Add(_T("category"), &Category);
+                    Add(_T("sample"), &Sample);
+                    Add(_T("rate"), &Rate);
+                    Add(_T("burst"), &Burst);
+                    Add(_T("passed"), &Passed);
+                    Add(_T("sampled"), &Sampled);
+                    Add(_T("limited"), &Limited);
+                }
+
+            public:
+                Core::JSON::String Module;
+                Core::JSON::String Category;
+                Core::JSON::DecUInt32 Sample;
+                Core::JSON::DecUInt32 Rate;
+                Core::JSON::DecUInt32 Burst;
+                Core::JSON::DecUInt64 Passed;
+                Core::JSON::DecUInt64 Sampled;
+                Core::JSON::DecUInt64 Limited;
+            };
+
+            class LimitsResult : public Core::JSON::Container {
+            public:
+                LimitsResult(const LimitsResult&) = delete;
+                LimitsResult& operator=(const LimitsResult&) = delete;
+
+                LimitsResult()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("limits"), &Limits);
+                }
+                ~LimitsResult()
+                {
+                }
+
+            public:
+                Core::JSON::ArrayType<Limit> Limits;
             };
 
         private:
@@ -910,6 +1367,7 @@ namespace Plugin {
                 Add(_T("console"), &Console);
                 Add(_T("remote"), &Remote);
                 Add(_T("settings"), &Settings);
+                Add(_T("sources"), &Sources);
             }
             ~Data()
             {
@@ -919,6 +1377,7 @@ namespace Plugin {
             Core::JSON::Boolean Console;
             NetworkNode Remote;
             Core::JSON::ArrayType<Trace> Settings;
+            Core::JSON::ArrayType<Source> Sources;
         };
 
     public:
@@ -929,6 +1388,7 @@ namespace Plugin {
             : _skipURL(0)
             , _service(nullptr)
             , _outputs()
+            , _binary(nullptr)
             , _tracePath()
             , _observer(*this)
         {
@@ -984,12 +1444,14 @@ namespace Plugin {
 
     private:
         void Dispatch(Observer::Source& information);
+        void Flush();
 
         void RegisterAll();
         void UnregisterAll();
-        JsonData::TraceControl::StateType TranslateState(TraceControl::state state);
-        uint32_t endpoint_status(const JsonData::TraceControl::StatusParamsData& params, JsonData::TraceControl::StatusResultData& response);
-        uint32_t endpoint_set(const JsonData::TraceControl::TraceInfo& params);
+        void Costs(Data& response, const string& module, const string& category);
+        uint32_t endpoint_status(const JsonData::TraceControl::StatusParamsData& params, Data& response);
+        uint32_t endpoint_set(const Data::SetParams& params);
+        uint32_t endpoint_limits(Data::LimitsResult& response);
         inline const string& TracePath() const 
         {
             return (_tracePath);
@@ -1000,6 +1462,7 @@ namespace Plugin {
         PluginHost::IShell* _service;
         Config _config;
         std::list<Trace::ITraceMedia*> _outputs;
+        BinaryOutput* _binary;
         string _tracePath;
         Observer _observer;
     };
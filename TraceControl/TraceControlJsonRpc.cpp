@@ -32,48 +32,30 @@ namespace Plugin {
 
     void TraceControl::RegisterAll()
     {
-        Register<StatusParamsData,StatusResultData>(_T("status"), &TraceControl::endpoint_status, this);
-        Register<TraceInfo,void>(_T("set"), &TraceControl::endpoint_set, this);
+        Register<StatusParamsData,Data>(_T("status"), &TraceControl::endpoint_status, this);
+        Register<Data::SetParams,void>(_T("set"), &TraceControl::endpoint_set, this);
+        Register<void,Data::LimitsResult>(_T("limits"), &TraceControl::endpoint_limits, this);
     }
 
     void TraceControl::UnregisterAll()
     {
+        Unregister(_T("limits"));
         Unregister(_T("set"));
         Unregister(_T("status"));
     }
 
-    JsonData::TraceControl::StateType TraceControl::TranslateState(TraceControl::state state)
-    {
-        JsonData::TraceControl::StateType newState = JsonData::TraceControl::StateType::DISABLED;
-
-        switch (state)
-        {
-        case TraceControl::state::ENABLED:
-            newState = JsonData::TraceControl::StateType::ENABLED;
-            break;
-        case TraceControl::state::DISABLED:
-            break;
-        case TraceControl::state::TRISTATED:
-            newState = JsonData::TraceControl::StateType::TRISTATED;
-            break;
-        }
-
-        return newState;
-    }
-
     // API implementation
     //
 
-    // Method: status - Retrieves general information
+    // Method: status - Retrieves general information, and what the traces cost
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t TraceControl::endpoint_status(const StatusParamsData& params, StatusResultData& response)
+    uint32_t TraceControl::endpoint_status(const StatusParamsData& params, Data& response)
     {
         uint32_t result = Core::ERROR_NONE;
 
         response.Console = _config.Console;
-        response.Remote.Port = _config.Remote.Port;
-        response.Remote.Binding = _config.Remote.Binding;
+        response.Remote = _config.Remote;
 
         Observer::ModuleIterator index(_observer.Modules());
 
@@ -86,35 +68,65 @@ namespace Plugin {
                     string categoryName(Core::ToString(categories.Category()));
 
                     if ((params.Category.IsSet() == false) || ((params.Category.IsSet() == true) && (categoryName == params.Category.Value()))) {
-                        Data::Trace trace = Data::Trace(moduleName, categoryName, categories.State());
-                        JsonData::TraceControl::TraceInfo traceResponse;
-                        traceResponse.Module = trace.Module;
-                        traceResponse.Category = trace.Category;
-                        traceResponse.State = TranslateState(trace.State);
-                        response.Settings.Add(traceResponse);
+                        response.Settings.Add(Data::Trace(moduleName, categoryName, categories.State()));
                     }
                 }
             }
         }
         _observer.Relinquish();
 
+        Costs(response, params.Module.Value(), params.Category.Value());
+
         return result;
     }
 
-    // Method: set - Sets traces
+    // Method: set - Sets traces, and optionally their sampling and rate limit
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t TraceControl::endpoint_set(const TraceInfo& params)
+    uint32_t TraceControl::endpoint_set(const Data::SetParams& params)
     {
         uint32_t result = Core::ERROR_NONE;
+        const std::string module(params.Module.IsSet() == true ? params.Module.Value() : std::string(EMPTY_STRING));
+        const std::string category(params.Category.IsSet() == true ? params.Category.Value() : std::string(EMPTY_STRING));
+
+        _observer.Set((params.State.Value() == TraceControl::state::ENABLED), module, category);
+
+        if ((params.Sample.IsSet() == true) || (params.Rate.IsSet() == true)) {
+            Observer::Limiter::Limit limit;
+            limit.Sample = params.Sample.Value();
+            limit.Rate = params.Rate.Value();
+            limit.Burst = params.Burst.Value();
 
-        _observer.Set((params.State.Value() == JsonData::TraceControl::StateType::ENABLED),
-            (params.Module.IsSet() == true ? params.Module.Value() : std::string(EMPTY_STRING)),
-            (params.Category.IsSet() == true ? params.Category.Value() : std::string(EMPTY_STRING)));
+            _observer.Limit(module, category, limit);
+        }
 
         _observer.Relinquish();
         return result;
     }
+
+    // Method: limits - Retrieves the sampling and rate limits in effect, with their counters
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t TraceControl::endpoint_limits(Data::LimitsResult& response)
+    {
+        std::list<Observer::Limiter::Report> reports;
+
+        _observer.Reports(reports);
+
+        for (const Observer::Limiter::Report& report : reports) {
+            Data::Limit& limit(response.Limits.Add());
+            limit.Module = report.Module;
+            limit.Category = report.Category;
+            limit.Sample = report.Limits.Sample;
+            limit.Rate = report.Limits.Rate;
+            limit.Burst = report.Limits.Burst;
+            limit.Passed = report.Passed;
+            limit.Sampled = report.Sampled;
+            limit.Limited = report.Limited;
+        }
+
+        return (Core::ERROR_NONE);
+    }
 } // namespace Plugin
 
 }
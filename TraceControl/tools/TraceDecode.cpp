@@ -0,0 +1,210 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Offline decoder for the TraceControl binary trace output.
+//
+//   TraceDecode <file>     decode a file written with "binary": { "path": ... }
+//   TraceDecode -          decode from stdin
+//   TraceDecode -u <port>  receive and decode datagrams sent with "binary": { "remote": ... }
+//
+// Entries are printed as: [time] module/category [file:line] class: text
+
+#include "../TraceBinaryFormat.h"
+
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+    class Decoder {
+    public:
+        Decoder()
+            : _session(-1)
+            , _strings()
+        {
+        }
+
+    public:
+        // Returns the number of bytes used: a header or a complete record, or 0
+        // if more data is needed and -1 if the data is not a trace stream.
+        int Process(const uint8_t data[], const size_t length, const bool datagram)
+        {
+            if ((length >= TraceBinary::HeaderSize) && (memcmp(data, TraceBinary::Magic, sizeof(TraceBinary::Magic)) == 0)) {
+                if (data[4] != TraceBinary::Version) {
+                    fprintf(stderr, "Unsupported trace stream version %d\n", data[4]);
+                    return (-1);
+                }
+                int session = TraceBinary::Load16(&data[6]);
+                if (session != _session) {
+                    // A writer starting over, its ids start over as well. Datagrams of one writer repeat the header.
+                    _session = session;
+                    _strings.clear();
+                }
+                return (TraceBinary::HeaderSize);
+            }
+
+            if (length < TraceBinary::RecordHeaderSize) {
+                return (0);
+            }
+
+            uint16_t size = TraceBinary::Load16(&data[2]);
+
+            if (size < TraceBinary::RecordHeaderSize) {
+                return (-1);
+            }
+            if (size > length) {
+                return (datagram == true ? -1 : 0);
+            }
+
+            if ((data[0] == TraceBinary::TYPE_STRING) && (size >= TraceBinary::StringHeaderSize)) {
+                _strings[TraceBinary::Load16(&data[4])].assign(reinterpret_cast<const char*>(&data[TraceBinary::StringHeaderSize]), size - TraceBinary::StringHeaderSize);
+            } else if ((data[0] == TraceBinary::TYPE_ENTRY) && (size >= TraceBinary::EntryHeaderSize)) {
+                Print(data, size);
+            }
+            // Unknown record types are skipped, so newer writers stay readable.
+
+            return (size);
+        }
+
+    private:
+        const char* Lookup(const uint16_t id) const
+        {
+            std::map<uint16_t, std::string>::const_iterator index(_strings.find(id));
+
+            return (index != _strings.end() ? index->second.c_str() : "?");
+        }
+        void Print(const uint8_t data[], const uint16_t size) const
+        {
+            uint64_t timestamp = TraceBinary::Load64(&data[4]);
+            time_t seconds = static_cast<time_t>(timestamp / 1000000);
+            struct tm moment;
+            char stamp[32];
+
+            gmtime_r(&seconds, &moment);
+            strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &moment);
+
+            const char* file = Lookup(TraceBinary::Load16(&data[16]));
+            const char* slash = strrchr(file, '/');
+
+            printf("[%s.%06u] %s/%s [%s:%u] %s: %.*s\n",
+                stamp, static_cast<uint32_t>(timestamp % 1000000),
+                Lookup(TraceBinary::Load16(&data[18])), Lookup(TraceBinary::Load16(&data[20])),
+                (slash != nullptr ? slash + 1 : file), TraceBinary::Load32(&data[12]),
+                Lookup(TraceBinary::Load16(&data[22])),
+                static_cast<int>(size - TraceBinary::EntryHeaderSize), reinterpret_cast<const char*>(&data[TraceBinary::EntryHeaderSize]));
+        }
+
+    private:
+        int _session;
+        std::map<uint16_t, std::string> _strings;
+    };
+
+    int DecodeFile(FILE* input)
+    {
+        Decoder decoder;
+        std::vector<uint8_t> buffer;
+        uint8_t chunk[64 * 1024];
+        size_t loaded;
+
+        while ((loaded = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+            buffer.insert(buffer.end(), chunk, chunk + loaded);
+
+            size_t offset = 0;
+            int used;
+
+            while ((used = decoder.Process(&buffer[offset], buffer.size() - offset, false)) > 0) {
+                offset += used;
+            }
+            if (used < 0) {
+                fprintf(stderr, "Corrupt trace stream at offset %zu\n", offset);
+                return (1);
+            }
+
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+        }
+
+        return (buffer.empty() == true ? 0 : 1);
+    }
+
+    int DecodeDatagrams(const uint16_t port)
+    {
+        int fd = socket(AF_INET6, SOCK_DGRAM, 0);
+        struct sockaddr_in6 address;
+
+        memset(&address, 0, sizeof(address));
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+
+        if ((fd < 0) || (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)) {
+            perror("Could not listen for traces");
+            return (1);
+        }
+
+        Decoder decoder;
+        uint8_t datagram[TraceBinary::DatagramSize];
+        ssize_t received;
+
+        while ((received = recv(fd, datagram, sizeof(datagram), 0)) >= 0) {
+            size_t offset = 0;
+            int used;
+
+            while ((used = decoder.Process(&datagram[offset], received - offset, true)) > 0) {
+                offset += used;
+            }
+            fflush(stdout);
+        }
+
+        close(fd);
+        return (0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int result = 1;
+
+    if ((argc == 3) && (strcmp(argv[1], "-u") == 0)) {
+        result = DecodeDatagrams(static_cast<uint16_t>(atoi(argv[2])));
+    } else if (argc == 2) {
+        FILE* input = (strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb"));
+
+        if (input == nullptr) {
+            perror(argv[1]);
+        } else {
+            result = DecodeFile(input);
+            if (input != stdin) {
+                fclose(input);
+            }
+        }
+    } else {
+        fprintf(stderr, "Usage: %s <file> | - | -u <port>\n", argv[0]);
+    }
+
+    return (result);
+}
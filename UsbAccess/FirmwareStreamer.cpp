@@ -0,0 +1,309 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FirmwareStreamer.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <openssl/evp.h>
+
+#include "utils.h"
+
+extern char **environ;
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        FirmwareStreamer::FirmwareStreamer()
+            : m_context(nullptr)
+            , m_buffers()
+            , m_pipe(-1)
+            , m_pid(-1)
+        {
+        }
+
+        FirmwareStreamer::~FirmwareStreamer()
+        {
+            if (m_pid > 0)
+                finish(false);
+            if (m_context != nullptr)
+                EVP_MD_CTX_destroy(static_cast<EVP_MD_CTX*>(m_context));
+            free(m_buffers[0]);
+            free(m_buffers[1]);
+        }
+
+        bool FirmwareStreamer::digest(const std::string& image, std::string& hex)
+        {
+            std::ifstream fs(image + FIRMWARE_STREAM_DIGEST_SUFFIX);
+            std::string line;
+            if (!std::getline(fs, line))
+                return false;
+
+            // "<hex>  <name>" as sha256sum writes it, or the hex alone
+            hex.clear();
+            for (auto it = line.begin(); it != line.end() && isxdigit(static_cast<unsigned char>(*it)); ++it)
+                hex += tolower(static_cast<unsigned char>(*it));
+            return (hex.size() == 64);
+        }
+
+        FirmwareStreamer::Status FirmwareStreamer::stream(const std::string& image, const std::vector<std::string>& flasher, const Progress& progress)
+        {
+            std::string expected;
+            if (!digest(image, expected))
+            {
+                LOGERR("no digest for %s", image.c_str());
+                return ReadError;
+            }
+
+            int fd = open(image.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st;
+            if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                LOGERR("cannot read %s: %s", image.c_str(), strerror(errno));
+                if (fd >= 0)
+                    close(fd);
+                return ReadError;
+            }
+            uint64_t total = st.st_size;
+
+            // one sequential pass, the kernel reads ahead while the chunk is hashed and piped
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+            if (posix_memalign(reinterpret_cast<void**>(&m_buffers[0]), 4096, FIRMWARE_STREAM_READ_CHUNK) != 0 ||
+                posix_memalign(reinterpret_cast<void**>(&m_buffers[1]), 4096, FIRMWARE_STREAM_READ_CHUNK) != 0)
+            {
+                LOGERR("out of memory");
+                close(fd);
+                return FlashError;
+            }
+
+            EVP_MD_CTX* context = EVP_MD_CTX_create();
+            m_context = context;
+            if (context == nullptr || EVP_DigestInit_ex(context, EVP_sha256(), nullptr) != 1)
+            {
+                LOGERR("EVP_DigestInit_ex failed");
+                close(fd);
+                return FlashError;
+            }
+
+            std::vector<std::string> args = flasher;
+            args.push_back(std::to_string(total));
+            if (!spawn(args))
+            {
+                close(fd);
+                return FlashError;
+            }
+
+            Status status = Ok;
+            uint64_t done = 0;
+            size_t held = 0;            // bytes of the previous chunk, not piped yet
+            int current = 0;
+
+            progress(Streaming, 0, total);
+
+            while (status == Ok)
+            {
+                unsigned char* buffer = m_buffers[current];
+                size_t length = 0;
+                while (length < FIRMWARE_STREAM_READ_CHUNK)
+                {
+                    ssize_t n = read(fd, buffer + length, FIRMWARE_STREAM_READ_CHUNK - length);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    if (n < 0)
+                    {
+                        LOGERR("read error on %s: %s", image.c_str(), strerror(errno));
+                        status = ReadError;
+                    }
+                    if (n <= 0)
+                        break;
+                    length += n;
+                }
+                if (status != Ok || length == 0)
+                    break;
+
+                EVP_DigestUpdate(context, buffer, length);
+
+                if (held > 0 && !pipeOut(m_buffers[1 - current], held))
+                    status = FlashError;
+
+                done += held;
+                if (held > 0)
+                    progress(Streaming, done, total);
+
+                held = length;
+                current = 1 - current;
+            }
+            close(fd);
+
+            if (status == Ok && done + held != total)
+            {
+                LOGERR("%s changed size while it was read", image.c_str());
+                status = ReadError;
+            }
+
+            if (status == Ok)
+            {
+                progress(Verifying, done, total);
+
+                unsigned char md[EVP_MAX_MD_SIZE];
+                unsigned int mdLength = 0;
+                EVP_DigestFinal_ex(context, md, &mdLength);
+
+                char hex[2 * EVP_MAX_MD_SIZE + 1];
+                for (unsigned int i = 0; i < mdLength; i++)
+                    snprintf(hex + 2 * i, 3, "%02x", md[i]);
+                hex[2 * mdLength] = '\0';
+
+                if (expected != hex)
+                {
+                    LOGERR("%s does not match its digest, %s instead of %s", image.c_str(), hex, expected.c_str());
+                    status = VerifyError;
+                }
+            }
+
+            // only a verified image is piped to its end
+            if (status == Ok && !pipeOut(m_buffers[1 - current], held))
+                status = FlashError;
+
+            if (status == Ok)
+            {
+                done += held;
+                progress(Streaming, done, total);
+                progress(Flashing, done, total);
+            }
+
+            int rc = finish(status == Ok);
+            LOGINFO("flasher exit code: %d", rc);
+            if (status == Ok && rc != 0)
+                status = FlashError;
+
+            return status;
+        }
+
+        bool FirmwareStreamer::spawn(const std::vector<std::string>& args)
+        {
+            if (args.empty() || args[0].empty())
+            {
+                LOGERR("no flasher");
+                return false;
+            }
+
+            int fds[2];
+            if (pipe2(fds, O_CLOEXEC) != 0)
+            {
+                LOGERR("pipe failed: %s", strerror(errno));
+                return false;
+            }
+            // a flasher that erases ahead does not stall the read side so soon
+            fcntl(fds[1], F_SETPIPE_SZ, FIRMWARE_STREAM_READ_CHUNK);
+
+            std::vector<char*> argv;
+            for (auto it = args.begin(); it != args.end(); ++it)
+                argv.push_back(const_cast<char*>(it->c_str()));
+            argv.push_back(nullptr);
+
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+
+            int error = posix_spawnp(&m_pid, argv[0], &actions, nullptr, argv.data(), environ);
+            posix_spawn_file_actions_destroy(&actions);
+            close(fds[0]);
+
+            if (error != 0)
+            {
+                LOGERR("failed to run %s: %s", argv[0], strerror(error));
+                close(fds[1]);
+                m_pid = -1;
+                return false;
+            }
+
+            m_pipe = fds[1];
+            return true;
+        }
+
+        bool FirmwareStreamer::pipeOut(const unsigned char* data, size_t length)
+        {
+            // a flasher that stopped reading is EPIPE here, not a SIGPIPE of the whole process
+            sigset_t pipeSignal, old;
+            sigemptyset(&pipeSignal);
+            sigaddset(&pipeSignal, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipeSignal, &old);
+
+            bool result = true;
+            while (length > 0)
+            {
+                ssize_t n = write(m_pipe, data, length);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    LOGERR("flasher stopped reading: %s", strerror(errno));
+                    result = false;
+                    break;
+                }
+                data += n;
+                length -= n;
+            }
+
+            if (!result)
+            {
+                struct timespec zero = { 0, 0 };
+                sigtimedwait(&pipeSignal, nullptr, &zero);
+            }
+            pthread_sigmask(SIG_SETMASK, &old, nullptr);
+
+            return result;
+        }
+
+        int FirmwareStreamer::finish(bool complete)
+        {
+            // an incomplete image is never closed on the flasher, it could take it for the end
+            if (!complete && m_pid > 0)
+                kill(m_pid, SIGKILL);
+            if (m_pipe >= 0)
+            {
+                close(m_pipe);
+                m_pipe = -1;
+            }
+
+            int result = -1;
+            int status = 0;
+            pid_t waited;
+            while ((waited = waitpid(m_pid, &status, 0)) < 0 && errno == EINTR);
+            if (waited == m_pid && WIFEXITED(status))
+                result = WEXITSTATUS(status);
+            m_pid = -1;
+
+            return result;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,82 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* The image is read from the drive in chunks of this size, aligned in memory to a page */
+#define FIRMWARE_STREAM_READ_CHUNK (1024 * 1024)
+/* Digest of the image, sha256sum format, next to it on the drive */
+#define FIRMWARE_STREAM_DIGEST_SUFFIX ".sha256"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Feeds a firmware image from the drive to the flasher in one pass: each chunk is read
+        // once, goes into the SHA-256 of the image and down a pipe to the stdin of the flasher.
+        // Nothing is staged on local flash. The last chunk is held back until the digest matched,
+        // the flasher never sees the end of an image that did not verify: it is killed instead.
+        // The flasher has to write to the inactive bank and only switch to it once it read the
+        // whole image (EOF on stdin) - its exit code is the result of the update.
+        class FirmwareStreamer {
+        public:
+            enum Status {
+                Ok,
+                ReadError,      // no image, no digest or a read error on the drive
+                VerifyError,    // the image does not match its digest
+                FlashError      // the flasher could not be run, stopped reading or failed
+            };
+
+            enum Phase {
+                Streaming,      // done/total: bytes of the image read, verified and piped so far
+                Verifying,
+                Flashing        // the whole image is with the flasher, waiting for it to finish
+            };
+
+            typedef std::function<void(Phase phase, uint64_t done, uint64_t total)> Progress;
+
+            FirmwareStreamer();
+            ~FirmwareStreamer();
+
+            FirmwareStreamer(const FirmwareStreamer&) = delete;
+            FirmwareStreamer& operator=(const FirmwareStreamer&) = delete;
+
+            // The size of the image in bytes is added to the flasher arguments.
+            Status stream(const std::string& image, const std::vector<std::string>& flasher, const Progress& progress);
+
+            // The expected SHA-256 of image, lower case hex, false without a digest file.
+            static bool digest(const std::string& image, std::string& hex);
+
+        private:
+            bool spawn(const std::vector<std::string>& args);
+            bool pipeOut(const unsigned char* data, size_t length);
+            int finish(bool complete);
+
+            void* m_context;            // EVP_MD_CTX, OpenSSL stays out of the header
+            unsigned char* m_buffers[2];
+            int m_pipe;
+            pid_t m_pid;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,364 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "LogArchiver.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <zlib.h>
+
+#include "utils.h"
+
+/* <linux/ioprio.h> is not always installed */
+#define LOG_ARCHIVE_IOPRIO_WHO_PROCESS 1
+#define LOG_ARCHIVE_IOPRIO_CLASS_IDLE 3
+#define LOG_ARCHIVE_IOPRIO_CLASS_SHIFT 13
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        namespace {
+            const size_t TAR_BLOCK = 512;
+            const unsigned char ZEROS[TAR_BLOCK * 2] = {};
+
+            // ustar header, POSIX.1-1988
+            struct TarHeader {
+                char name[100];
+                char mode[8];
+                char uid[8];
+                char gid[8];
+                char size[12];
+                char mtime[12];
+                char chksum[8];
+                char typeflag;
+                char linkname[100];
+                char magic[6];
+                char version[2];
+                char uname[32];
+                char gname[32];
+                char devmajor[8];
+                char devminor[8];
+                char prefix[155];
+                char pad[12];
+            };
+
+            // name and prefix of a ustar entry, false if the name does not fit
+            bool splitName(const std::string& name, std::string& prefix, std::string& rest)
+            {
+                if (name.size() <= sizeof(TarHeader::name))
+                {
+                    prefix.clear();
+                    rest = name;
+                    return true;
+                }
+                for (size_t pos = name.find('/'); pos != std::string::npos; pos = name.find('/', pos + 1))
+                {
+                    if (pos > sizeof(TarHeader::prefix))
+                        break;
+                    if (name.size() - pos - 1 <= sizeof(TarHeader::name))
+                    {
+                        prefix = name.substr(0, pos);
+                        rest = name.substr(pos + 1);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool writeAll(int fd, const unsigned char* data, size_t length)
+            {
+                while (length > 0)
+                {
+                    ssize_t n = write(fd, data, length);
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                            continue;
+                        return false;
+                    }
+                    data += n;
+                    length -= n;
+                }
+                return true;
+            }
+        }
+
+        LogArchiver::LogArchiver()
+            : m_stream(nullptr)
+            , m_fd(-1)
+            , m_out(nullptr)
+            , m_outUsed(0)
+            , m_in(nullptr)
+        {
+        }
+
+        LogArchiver::~LogArchiver()
+        {
+            if (m_stream != nullptr)
+            {
+                deflateEnd(static_cast<z_stream*>(m_stream));
+                delete static_cast<z_stream*>(m_stream);
+            }
+            if (m_fd >= 0)
+                close(m_fd);
+            free(m_out);
+            free(m_in);
+        }
+
+        void LogArchiver::lowerThreadPriority()
+        {
+            pid_t tid = syscall(SYS_gettid);
+
+            if (setpriority(PRIO_PROCESS, tid, 19) != 0)
+                LOGWARN("setpriority failed: %s", strerror(errno));
+
+            if (syscall(SYS_ioprio_set, LOG_ARCHIVE_IOPRIO_WHO_PROCESS, tid,
+                    LOG_ARCHIVE_IOPRIO_CLASS_IDLE << LOG_ARCHIVE_IOPRIO_CLASS_SHIFT) != 0)
+                LOGWARN("ioprio_set failed: %s", strerror(errno));
+        }
+
+        LogArchiver::Status LogArchiver::archive(const std::string& source, const std::string& destination, const Progress& progress)
+        {
+            std::vector<Entry> entries;
+            uint64_t total = 0;
+
+            std::string parent = source;
+            while (parent.size() > 1 && parent.back() == '/')
+                parent.pop_back();
+            std::string base = parent.substr(parent.find_last_of('/') + 1);
+            walk(parent, base, entries, total);
+            if (entries.empty())
+            {
+                LOGERR("nothing to archive in %s", source.c_str());
+                return ReadError;
+            }
+
+            if (posix_memalign(reinterpret_cast<void**>(&m_out), 4096, LOG_ARCHIVE_WRITE_CHUNK) != 0 ||
+                posix_memalign(reinterpret_cast<void**>(&m_in), 4096, LOG_ARCHIVE_READ_CHUNK) != 0)
+            {
+                LOGERR("out of memory");
+                return WriteError;
+            }
+
+            z_stream* stream = new z_stream();
+            m_stream = stream;
+            // windowBits 15 + 16: gzip wrapper
+            if (deflateInit2(stream, LOG_ARCHIVE_COMPRESSION_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                delete stream;
+                m_stream = nullptr;
+                LOGERR("deflateInit2 failed");
+                return WriteError;
+            }
+
+            std::string part = destination + ".part";
+            m_fd = open(part.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (m_fd < 0)
+            {
+                LOGERR("cannot create %s: %s", part.c_str(), strerror(errno));
+                return WriteError;
+            }
+
+            bool ok = true;
+            uint64_t done = 0;
+            for (auto it = entries.begin(); ok && it != entries.end(); ++it)
+            {
+                if (it->directory)
+                {
+                    ok = header(*it);
+                    continue;
+                }
+
+                int fd = open(it->path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                {
+                    // rotated away since the walk
+                    LOGWARN("skipping %s: %s", it->path.c_str(), strerror(errno));
+                    done += it->size;
+                    continue;
+                }
+                posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+                ok = header(*it) && content(*it, fd, done, total, progress);
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+
+            ok = ok && deflate(ZEROS, sizeof(ZEROS), Z_FINISH) && flush() && (fsync(m_fd) == 0);
+            if (!ok)
+                LOGERR("writing %s failed: %s", part.c_str(), strerror(errno));
+
+            if (close(m_fd) != 0)
+                ok = false;
+            m_fd = -1;
+
+            if (ok && rename(part.c_str(), destination.c_str()) != 0)
+            {
+                LOGERR("cannot rename %s: %s", part.c_str(), strerror(errno));
+                ok = false;
+            }
+            if (!ok)
+            {
+                unlink(part.c_str());
+                return WriteError;
+            }
+
+            return Ok;
+        }
+
+        void LogArchiver::walk(const std::string& path, const std::string& name, std::vector<Entry>& entries, uint64_t& total)
+        {
+            struct stat st;
+            if (lstat(path.c_str(), &st) != 0)
+                return;
+
+            if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode))
+                return;     // links, sockets, fifos
+
+            Entry entry;
+            entry.path = path;
+            entry.name = S_ISDIR(st.st_mode) ? name + "/" : name;
+            entry.size = S_ISREG(st.st_mode) ? st.st_size : 0;
+            entry.mode = st.st_mode & 07777;
+            entry.mtime = st.st_mtime;
+            entry.directory = S_ISDIR(st.st_mode);
+
+            std::string prefix, rest;
+            if (!splitName(entry.name, prefix, rest))
+            {
+                LOGWARN("skipping %s: name too long", path.c_str());
+                return;
+            }
+
+            entries.push_back(entry);
+            total += entry.size;
+
+            if (!entry.directory)
+                return;
+
+            DIR* dir = opendir(path.c_str());
+            if (dir == nullptr)
+                return;
+
+            struct dirent* dp;
+            while ((dp = readdir(dir)) != nullptr)
+            {
+                if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0)
+                    continue;
+                walk(path + "/" + dp->d_name, name + "/" + dp->d_name, entries, total);
+            }
+            closedir(dir);
+        }
+
+        bool LogArchiver::header(const Entry& entry)
+        {
+            TarHeader h;
+            memset(&h, 0, sizeof(h));
+
+            std::string prefix, rest;
+            splitName(entry.name, prefix, rest);
+            memcpy(h.name, rest.data(), rest.size());
+            memcpy(h.prefix, prefix.data(), prefix.size());
+
+            snprintf(h.mode, sizeof(h.mode), "%07o", entry.mode);
+            snprintf(h.uid, sizeof(h.uid), "%07o", 0);
+            snprintf(h.gid, sizeof(h.gid), "%07o", 0);
+            snprintf(h.size, sizeof(h.size), "%011llo", static_cast<unsigned long long>(entry.size));
+            snprintf(h.mtime, sizeof(h.mtime), "%011llo", static_cast<unsigned long long>(entry.mtime));
+            h.typeflag = entry.directory ? '5' : '0';
+            memcpy(h.magic, "ustar", 6);
+            memcpy(h.version, "00", 2);
+            memcpy(h.uname, "root", 4);
+            memcpy(h.gname, "root", 4);
+
+            memset(h.chksum, ' ', sizeof(h.chksum));
+            unsigned int sum = 0;
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&h);
+            for (size_t i = 0; i < sizeof(h); i++)
+                sum += bytes[i];
+            snprintf(h.chksum, sizeof(h.chksum), "%06o", sum);
+            h.chksum[7] = ' ';
+
+            return deflate(&h, sizeof(h), Z_NO_FLUSH);
+        }
+
+        bool LogArchiver::content(const Entry& entry, int fd, uint64_t& done, uint64_t total, const Progress& progress)
+        {
+            uint64_t remaining = entry.size;
+            while (remaining > 0)
+            {
+                size_t wanted = (remaining < LOG_ARCHIVE_READ_CHUNK) ? remaining : LOG_ARCHIVE_READ_CHUNK;
+                ssize_t n = read(fd, m_in, wanted);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                {
+                    // truncated since the walk: the header promised the size, make it up with zeros
+                    n = wanted;
+                    memset(m_in, 0, n);
+                }
+                if (!deflate(m_in, n, Z_NO_FLUSH))
+                    return false;
+                remaining -= n;
+                done += n;
+                if (progress)
+                    progress(done, total);
+            }
+
+            size_t padding = (TAR_BLOCK - entry.size % TAR_BLOCK) % TAR_BLOCK;
+            return (padding == 0) || deflate(ZEROS, padding, Z_NO_FLUSH);
+        }
+
+        bool LogArchiver::deflate(const void* data, size_t length, int flush)
+        {
+            z_stream* stream = static_cast<z_stream*>(m_stream);
+            stream->next_in = static_cast<Bytef*>(const_cast<void*>(data));
+            stream->avail_in = length;
+
+            int ret;
+            do
+            {
+                stream->next_out = m_out + m_outUsed;
+                stream->avail_out = LOG_ARCHIVE_WRITE_CHUNK - m_outUsed;
+                ret = ::deflate(stream, flush);
+                if (ret == Z_STREAM_ERROR)
+                    return false;
+                m_outUsed = LOG_ARCHIVE_WRITE_CHUNK - stream->avail_out;
+                if (m_outUsed == LOG_ARCHIVE_WRITE_CHUNK && !this->flush())
+                    return false;
+            } while (stream->avail_in > 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+
+            return true;
+        }
+
+        bool LogArchiver::flush()
+        {
+            bool ok = writeAll(m_fd, m_out, m_outUsed);
+            m_outUsed = 0;
+            return ok;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,86 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* Compressed output is written to the drive in chunks of this size, aligned in memory to a page */
+#define LOG_ARCHIVE_WRITE_CHUNK (1024 * 1024)
+#define LOG_ARCHIVE_READ_CHUNK (256 * 1024)
+#define LOG_ARCHIVE_COMPRESSION_LEVEL 6
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Writes a tar.gz of a directory tree in a single pass: each file is read once and goes
+        // through tar framing and deflate straight into the output buffer, which is flushed to the
+        // destination in large writes. Nothing is staged in /tmp or on the drive but the archive.
+        class LogArchiver {
+        public:
+            enum Status {
+                Ok,
+                ReadError,      // nothing to archive
+                WriteError
+            };
+
+            // Called with the uncompressed bytes archived so far and the total.
+            typedef std::function<void(uint64_t done, uint64_t total)> Progress;
+
+            LogArchiver();
+            ~LogArchiver();
+
+            LogArchiver(const LogArchiver&) = delete;
+            LogArchiver& operator=(const LogArchiver&) = delete;
+
+            // The archive is written to destination + ".part" and renamed when complete. Entries are
+            // named relative to the parent of source, as tar -C parent would. Files changing size
+            // meanwhile are archived with the size they had when the walk found them.
+            Status archive(const std::string& source, const std::string& destination, const Progress& progress);
+
+            // Lowest CPU and idle I/O priority for the calling thread.
+            static void lowerThreadPriority();
+
+        private:
+            struct Entry {
+                std::string path;
+                std::string name;
+                uint64_t size;
+                uint32_t mode;
+                int64_t mtime;
+                bool directory;
+            };
+
+            void walk(const std::string& path, const std::string& name, std::vector<Entry>& entries, uint64_t& total);
+            bool header(const Entry& entry);
+            bool content(const Entry& entry, int fd, uint64_t& done, uint64_t total, const Progress& progress);
+            bool deflate(const void* data, size_t length, int flush);
+            bool flush();
+
+            void* m_stream;             // z_stream, zlib stays out of the header
+            int m_fd;
+            unsigned char* m_out;
+            size_t m_outUsed;
+            unsigned char* m_in;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
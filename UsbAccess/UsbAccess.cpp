@@ -1,11 +1,16 @@
 #include "UsbAccess.h"
+#include "LogArchiver.h"
+#include "FirmwareStreamer.h"
 
 #include <unistd.h>
 #include <mntent.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
 #include <regex>
 #include <libudev.h>
 #include <algorithm>
 #include <mutex>
+#include <sstream>
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
 #include "libIARM.h"
@@ -27,6 +32,9 @@ const string WPEFramework::Plugin::UsbAccess::LINK_URL_HTTP = "http://localhost:
 const string WPEFramework::Plugin::UsbAccess::LINK_PATH = "/tmp/usbdrive";
 const string WPEFramework::Plugin::UsbAccess::EVT_ON_USB_MOUNT_CHANGED = "onUSBMountChanged";
 const string WPEFramework::Plugin::UsbAccess::EVT_ON_ARCHIVE_LOGS = "onArchiveLogs";
+const string WPEFramework::Plugin::UsbAccess::EVT_ON_ARCHIVE_LOGS_PROGRESS = "onArchiveLogsProgress";
+const string WPEFramework::Plugin::UsbAccess::EVT_ON_FIRMWARE_UPDATE = "onFirmwareUpdate";
+const string WPEFramework::Plugin::UsbAccess::EVT_ON_FIRMWARE_UPDATE_PROGRESS = "onFirmwareUpdateProgress";
 const string WPEFramework::Plugin::UsbAccess::REGEX_BIN = "[\\w-]*\\.{0,1}[\\w-]*\\.bin";
 const string WPEFramework::Plugin::UsbAccess::REGEX_FILE =
         "[\\w-]*\\.{0,1}[\\w-]*\\.(png|jpg|jpeg|tiff|tif|bmp|mp4|mov|avi|mp3|wav|m4a|flac|mp4|aac|wma|txt|bin|enc|ts)";
@@ -102,6 +110,53 @@ namespace Plugin {
             return result;
         }
 
+        // Compiled once, matching is the expensive part of listing a large directory
+        const std::regex& fileRegex() {
+            static const std::regex result(UsbAccess::REGEX_FILE, std::regex_constants::icase);
+            return result;
+        }
+
+        const std::regex& deviceSpecificBinMatcher() {
+            static const std::regex result(deviceSpecificRegexBin(), std::regex_constants::icase);
+            return result;
+        }
+
+        const uint32_t INDEX_WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_ONLYDIR;
+
+        string makeCursor(uint32_t generation, size_t offset) {
+            return std::to_string(generation) + ":" + std::to_string(offset);
+        }
+
+        bool parseCursor(const string& cursor, uint32_t& generation, size_t& offset) {
+            size_t pos = cursor.find(':');
+            if (pos == string::npos || pos == 0 || pos + 1 == cursor.size())
+                return false;
+            char* end = nullptr;
+            generation = strtoul(cursor.c_str(), &end, 10);
+            if (end != cursor.c_str() + pos)
+                return false;
+            offset = strtoul(cursor.c_str() + pos + 1, &end, 10);
+            return (*end == '\0');
+        }
+
+        // MAC of the estb interface, upper case without separators, as the archive names have it
+        string archiveMac() {
+            string iface = findProp(UsbAccess::PATH_DEVICE_PROPERTIES.c_str(), "ESTB_INTERFACE");
+            if (iface.empty())
+                iface = "eth0";
+
+            string mac;
+            std::ifstream fs("/sys/class/net/" + iface + "/address");
+            std::getline(fs, mac);
+
+            string result;
+            for (char c : mac)
+                if (c != ':' && !isspace(static_cast<unsigned char>(c)))
+                    result += toupper(static_cast<unsigned char>(c));
+            return result;
+        }
+
         time_t fileModTime(const char* filename) {
             struct stat st;
             time_t mod_time;
@@ -117,6 +172,12 @@ namespace Plugin {
 
     UsbAccess::UsbAccess()
     : AbstractPlugin(UsbAccess::API_VERSION_NUMBER_MAJOR)
+    , m_nativeArchive(true)
+    , m_logPath(USB_ACCESS_LOG_PATH)
+    , m_inotify(-1)
+    , m_indexGeneration(0)
+    , m_indexUse(0)
+    , m_updating(false)
     {
         UsbAccess::_instance = this;
 
@@ -135,10 +196,27 @@ namespace Plugin {
 
         if (archiveLogsThread.joinable())
             archiveLogsThread.join();
+        if (firmwareThread.joinable())
+            firmwareThread.join();
     }
 
-    const string UsbAccess::Initialize(PluginHost::IShell * /* service */)
+    const string UsbAccess::Initialize(PluginHost::IShell* service)
     {
+        Config config;
+        if (service)
+            config.FromString(service->ConfigLine());
+        m_nativeArchive = config.NativeArchive.Value();
+        m_logPath = config.LogPath.Value();
+
+        m_flasher.clear();
+        std::istringstream flasher(config.Flasher.Value());
+        for (string arg; flasher >> arg;)
+            m_flasher.push_back(arg);
+
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotify < 0)
+            LOGWARN("inotify_init1 failed: %s, directory listings are not cached", strerror(errno));
+
         InitializeIARM();
         return "";
     }
@@ -146,6 +224,14 @@ namespace Plugin {
     void UsbAccess::Deinitialize(PluginHost::IShell * /* service */)
     {
         DeinitializeIARM();
+
+        std::lock_guard<std::mutex> lock(m_indexLock);
+        dropIndex();
+        if (m_inotify >= 0)
+        {
+            close(m_inotify);
+            m_inotify = -1;
+        }
     }
 
     string UsbAccess::Information() const
@@ -164,14 +250,35 @@ namespace Plugin {
         if (parameters.HasLabel("path"))
             pathParam = parameters["path"].String();
 
+        int limit = 0;
+        getDefaultNumberParameter("limit", limit, 0);
+        if (limit < 0)
+            limit = 0;
+
+        uint32_t cursorGeneration = 0;
+        size_t offset = 0;
+        bool cursorValid = true;
+        if (parameters.HasLabel("cursor"))
+            cursorValid = parseCursor(parameters["cursor"].String(), cursorGeneration, offset);
+
         FileList files;
+        size_t total = 0;
+        uint32_t generation = 0;
         std::list<string> paths;
         getMounted(paths);
-        if (!paths.empty())
-            result = getFileList(joinPaths(*paths.begin(), pathParam), files, REGEX_FILE, true);
+        if (cursorValid && !paths.empty())
+            result = getIndexedFileList(joinPaths(*paths.begin(), pathParam), offset, limit, files, total, generation);
 
-        if (!result)
+        if (!cursorValid)
+            response["error"] = "invalid cursor";
+        else if (!result)
             response["error"] = "not found";
+        else if (parameters.HasLabel("cursor") && cursorGeneration != generation)
+        {
+            // the directory changed since the first page, the client has to start over
+            result = false;
+            response["error"] = "cursor expired";
+        }
         else
         {
             JsonArray arr;
@@ -183,6 +290,9 @@ namespace Plugin {
                 arr.Add(ent);
             });
             response["contents"] = arr;
+            response["total"] = static_cast<uint32_t>(total);
+            if (offset + files.size() < total)
+                response["cursor"] = makeCursor(generation, offset + files.size());
         }
 
         returnResponse(result);
@@ -238,7 +348,7 @@ namespace Plugin {
         for_each(paths.begin(), paths.end(), [&allFiles](const string& it)
         {
             FileList files;
-            getFileList(it, files, deviceSpecificRegexBin(), false);
+            getFileList(it, files, &deviceSpecificBinMatcher(), false);
             for_each(files.begin(), files.end(), [&allFiles, &it](const FileEnt& jt) {
                 allFiles.emplace_back(joinPaths(it, jt.filename));
             });
@@ -269,8 +379,27 @@ namespace Plugin {
 
         string name = fileName.substr(fileName.find_last_of("/\\") + 1);
         string path = fileName.substr(0, fileName.find_last_of("/\\"));
+        string digest;
+        bool streaming = false;
         if (!name.empty() && !path.empty() &&
-            std::regex_match(name, std::regex(deviceSpecificRegexBin(), std::regex_constants::icase)) == true)
+            std::regex_match(name, deviceSpecificBinMatcher()) == true &&
+            !m_flasher.empty() && FirmwareStreamer::digest(fileName, digest))
+        {
+            // nothing is copied to local flash, the result comes with onFirmwareUpdate
+            streaming = true;
+            if (m_updating.exchange(true))
+                response["error"] = "update in progress";
+            else
+            {
+                if (firmwareThread.joinable())
+                    firmwareThread.join();
+                firmwareThread = std::thread(&UsbAccess::updateFirmwareStreamed, this, fileName);
+                result = true;
+            }
+            response["streaming"] = true;
+        }
+        else if (!name.empty() && !path.empty() &&
+            std::regex_match(name, deviceSpecificBinMatcher()) == true)
         {
             char buff[1000];
             size_t n = sizeof(buff);
@@ -288,7 +417,7 @@ namespace Plugin {
             }
         }
 
-        if (!result)
+        if (!result && !streaming)
             response["error"] = "invalid filename";
 
         returnResponse(result);
@@ -328,23 +457,85 @@ namespace Plugin {
     void UsbAccess::archiveLogsInternal()
     {
         ArchiveLogsError error = ScriptError;
+        string archivePath;
 
         std::list<string> paths;
         getMounted(paths);
         if (paths.empty())
             error = NoUSB;
+        else if (m_nativeArchive)
+            error = archiveLogsNative(*paths.begin(), archivePath);
         else
         {
-            string script = (ARCHIVE_LOGS_SCRIPT + " " + *paths.begin());
-            int rc = runScript(script.c_str());
-            LOGINFO("'%s' exit code: %d", script.c_str(), rc);
+            int rc = Utils::runCommand({ ARCHIVE_LOGS_SCRIPT, *paths.begin() });
+            LOGINFO("'%s %s' exit code: %d", ARCHIVE_LOGS_SCRIPT.c_str(), paths.begin()->c_str(), rc);
             error = static_cast<ArchiveLogsError>(rc);
         }
 
-        onArchiveLogs(error);
+        onArchiveLogs(error, archivePath);
     }
 
-    void UsbAccess::onArchiveLogs(ArchiveLogsError error)
+    UsbAccess::ArchiveLogsError UsbAccess::archiveLogsNative(const string& mountPath, string& archivePath)
+    {
+        int lock = open(USB_ACCESS_ARCHIVE_LOCK, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock < 0 || flock(lock, LOCK_EX | LOCK_NB) != 0)
+        {
+            LOGWARN("another log archive is in progress");
+            if (lock >= 0)
+                close(lock);
+            return Locked;
+        }
+
+        // the archive is the only thing written to the drive, in one pass, at the lowest priority
+        LogArchiver::lowerThreadPriority();
+
+        ArchiveLogsError error = None;
+        string dir = joinPaths(mountPath, "Log");
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            LOGERR("cannot create %s: %s", dir.c_str(), strerror(errno));
+            error = WritingError;
+        }
+        else
+        {
+            char stamp[32];
+            time_t now = time(nullptr);
+            struct tm tm;
+            localtime_r(&now, &tm);
+            strftime(stamp, sizeof(stamp), "%m-%d-%y-%I-%M%p", &tm);
+            archivePath = joinPaths(dir, archiveMac() + "_Logs_" + stamp + ".tgz");
+
+            int reported = 0;
+            onArchiveLogsProgress(0);
+
+            LogArchiver archiver;
+            LogArchiver::Status status = archiver.archive(m_logPath, archivePath,
+                [this, &reported](uint64_t done, uint64_t total)
+                {
+                    int progress = (total > 0) ? static_cast<int>(done * 100 / total) : 100;
+                    if (progress >= reported + USB_ACCESS_ARCHIVE_PROGRESS_STEP)
+                    {
+                        reported = progress - progress % USB_ACCESS_ARCHIVE_PROGRESS_STEP;
+                        onArchiveLogsProgress(reported);
+                    }
+                });
+            LOGINFO("archiving %s to %s: status %d", m_logPath.c_str(), archivePath.c_str(), status);
+
+            if (status == LogArchiver::WriteError)
+                error = WritingError;
+            else if (status != LogArchiver::Ok)
+                error = ScriptError;
+
+            if (error != None)
+                archivePath.clear();
+        }
+
+        flock(lock, LOCK_UN);
+        close(lock);
+        return error;
+    }
+
+    void UsbAccess::onArchiveLogs(ArchiveLogsError error, const string& archivePath)
     {
         JsonObject params;
         auto it = ARCHIVE_LOGS_ERRORS.find(error);
@@ -352,34 +543,85 @@ namespace Plugin {
             it = ARCHIVE_LOGS_ERRORS.find(ScriptError);
         params["error"] = it->second;
         params["success"] = (error == None);
+        if (!archivePath.empty())
+            params["path"] = archivePath;
         sendNotify(EVT_ON_ARCHIVE_LOGS.c_str(), params);
     }
 
+    void UsbAccess::onArchiveLogsProgress(int progress)
+    {
+        JsonObject params;
+        params["progress"] = progress;
+        sendNotify(EVT_ON_ARCHIVE_LOGS_PROGRESS.c_str(), params);
+    }
+
+    void UsbAccess::updateFirmwareStreamed(const string& fileName)
+    {
+        LOGINFO("streaming %s to %s", fileName.c_str(), m_flasher[0].c_str());
+
+        int reported = 0;
+        FirmwareStreamer::Phase phase = FirmwareStreamer::Streaming;
+        onFirmwareUpdateProgress("streaming", 0);
+
+        FirmwareStreamer streamer;
+        FirmwareStreamer::Status status = streamer.stream(fileName, m_flasher,
+            [this, &reported, &phase](FirmwareStreamer::Phase current, uint64_t done, uint64_t total)
+            {
+                if (current == FirmwareStreamer::Streaming)
+                {
+                    int progress = (total > 0) ? static_cast<int>(done * 100 / total) : 100;
+                    if (progress >= reported + USB_ACCESS_FIRMWARE_PROGRESS_STEP)
+                    {
+                        reported = progress - progress % USB_ACCESS_FIRMWARE_PROGRESS_STEP;
+                        onFirmwareUpdateProgress("streaming", reported);
+                    }
+                }
+                else if (current != phase)
+                {
+                    phase = current;
+                    onFirmwareUpdateProgress(current == FirmwareStreamer::Verifying ? "verifying" : "flashing", reported);
+                }
+            });
+        LOGINFO("streaming %s: status %d", fileName.c_str(), status);
+
+        static const char* const errors[] = { "none", "read error", "verify error", "flash error" };
+        onFirmwareUpdate(status == FirmwareStreamer::Ok, errors[status]);
+
+        m_updating = false;
+    }
+
+    void UsbAccess::onFirmwareUpdate(bool success, const string& error)
+    {
+        JsonObject params;
+        params["error"] = error;
+        params["success"] = success;
+        sendNotify(EVT_ON_FIRMWARE_UPDATE.c_str(), params);
+    }
+
+    void UsbAccess::onFirmwareUpdateProgress(const string& phase, int progress)
+    {
+        JsonObject params;
+        params["phase"] = phase;
+        params["progress"] = progress;
+        sendNotify(EVT_ON_FIRMWARE_UPDATE_PROGRESS.c_str(), params);
+    }
+
     // iarm
     void UsbAccess::InitializeIARM()
     {
         if (Utils::IARM::init())
         {
             IARM_Result_t res;
-            IARM_CHECK(IARM_Bus_RegisterEventHandler(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_USB_MOUNT_CHANGED, eventHandler));
+            m_iarmEvents.start();
+            IARM_CHECK(m_iarmEvents.subscribe(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_USB_MOUNT_CHANGED,
+                [this](const char *owner, IARM_EventId_t eventId, void *data, size_t len) { iarmEventHandler(owner, eventId, data, len); }));
         }
     }
 
     void UsbAccess::DeinitializeIARM()
     {
-        if (Utils::IARM::isConnected())
-        {
-            IARM_Result_t res;
-            IARM_CHECK(IARM_Bus_UnRegisterEventHandler(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_USB_MOUNT_CHANGED));
-        }
-    }
-
-    void UsbAccess::eventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
-    {
-        if (UsbAccess::_instance)
-            UsbAccess::_instance->iarmEventHandler(owner, eventId, data, len);
-        else
-            LOGWARN("cannot handle IARM events without a UsbAccess plugin instance!");
+        /* Unsubscribes, then handles what is still queued */
+        m_iarmEvents.stop();
     }
 
     void UsbAccess::iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
@@ -411,6 +653,12 @@ namespace Plugin {
 
     void UsbAccess::onUSBMountChanged(bool mounted, const string& device)
     {
+        {
+            // listings are built again on the next getFileList
+            std::lock_guard<std::mutex> lock(m_indexLock);
+            dropIndex();
+        }
+
         JsonObject params;
         params["mounted"] = mounted;
         params["device"] = device;
@@ -418,7 +666,7 @@ namespace Plugin {
     }
 
     // internal methods
-    bool UsbAccess::getFileList(const string& path, FileList& files, const string& fileRegex, bool includeFolders)
+    bool UsbAccess::getFileList(const string& path, FileList& files, const std::regex* fileRegex, bool includeFolders)
     {
         bool result = false;
 
@@ -433,8 +681,8 @@ namespace Plugin {
                 while ((dp = readdir(dirp)) != nullptr)
                 {
                     if (((dp->d_type == DT_DIR) && includeFolders) ||
-                        ((dp->d_type != DT_DIR) && (fileRegex.empty() ||
-                            std::regex_match(dp->d_name, std::regex(fileRegex, std::regex_constants::icase)) == true)))
+                        ((dp->d_type != DT_DIR) && (fileRegex == nullptr ||
+                            std::regex_match(dp->d_name, *fileRegex) == true)))
                         files.push_back(
                                 {
                                     dp->d_type == DT_DIR ? 'd' : 'f',
@@ -450,6 +698,119 @@ namespace Plugin {
         return result;
     }
 
+    bool UsbAccess::getIndexedFileList(const string& path, size_t offset, size_t limit, FileList& page, size_t& total, uint32_t& generation)
+    {
+        std::lock_guard<std::mutex> lock(m_indexLock);
+
+        FileList uncached;
+        const FileList* files = &uncached;
+        generation = 0;
+
+        if (m_inotify >= 0)
+            processIndexEvents();
+
+        auto it = m_index.find(path);
+        if (it == m_index.end())
+        {
+            // watch before listing, so that no change after the listing is missed
+            int watch = (m_inotify >= 0) ? inotify_add_watch(m_inotify, path.c_str(), INDEX_WATCH_MASK) : -1;
+
+            if (!getFileList(path, uncached, &fileRegex(), true))
+            {
+                if (watch >= 0)
+                    inotify_rm_watch(m_inotify, watch);
+                return false;
+            }
+
+            if (watch >= 0)
+            {
+                // the watch descriptor of a directory already watched under another path
+                for (auto jt = m_index.begin(); jt != m_index.end(); ++jt)
+                {
+                    if (jt->second.watch == watch)
+                    {
+                        m_index.erase(jt);
+                        break;
+                    }
+                }
+
+                if (m_index.size() >= USB_ACCESS_INDEX_MAX_DIRS)
+                {
+                    auto lru = std::min_element(m_index.begin(), m_index.end(),
+                        [](const std::pair<const string, DirIndex>& a, const std::pair<const string, DirIndex>& b)
+                        {
+                            return a.second.lastUsed < b.second.lastUsed;
+                        });
+                    inotify_rm_watch(m_inotify, lru->second.watch);
+                    m_index.erase(lru);
+                }
+
+                DirIndex index;
+                index.files.swap(uncached);
+                index.watch = watch;
+                index.generation = ++m_indexGeneration;
+                it = m_index.emplace(path, std::move(index)).first;
+            }
+        }
+
+        if (it != m_index.end())
+        {
+            it->second.lastUsed = ++m_indexUse;
+            files = &it->second.files;
+            generation = it->second.generation;
+        }
+
+        total = files->size();
+        page.clear();
+        if (offset < total)
+        {
+            size_t end = (limit == 0 || limit > total - offset) ? total : offset + limit;
+            page.assign(files->begin() + offset, files->begin() + end);
+        }
+
+        return true;
+    }
+
+    void UsbAccess::processIndexEvents()
+    {
+        char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+
+        while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* ptr = buffer; ptr < buffer + length; )
+            {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+                ptr += sizeof(struct inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    dropIndex();
+                    continue;
+                }
+
+                for (auto it = m_index.begin(); it != m_index.end(); ++it)
+                {
+                    if (it->second.watch == event->wd)
+                    {
+                        if (!(event->mask & IN_IGNORED))
+                            inotify_rm_watch(m_inotify, event->wd);
+                        m_index.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    void UsbAccess::dropIndex()
+    {
+        if (m_inotify >= 0)
+            for (auto it = m_index.begin(); it != m_index.end(); ++it)
+                inotify_rm_watch(m_inotify, it->second.watch);
+        m_index.clear();
+    }
+
     bool UsbAccess::getMounted(std::list <std::string>& paths)
     {
         bool result = false;
@@ -473,7 +834,9 @@ namespace Plugin {
                 const char *path = udev_list_entry_get_name(entry);
                 struct udev_device *dev = udev_device_new_from_syspath(udev, path);
                 struct udev_device *usb = udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
-                if (usb != nullptr && std::regex_match(udev_device_get_devtype(dev), std::regex("(partition|disk)")))
+                const char *devtype = udev_device_get_devtype(dev);
+                if (usb != nullptr && devtype != nullptr &&
+                    (strcmp(devtype, "partition") == 0 || strcmp(devtype, "disk") == 0))
                     devnodes.emplace_back(udev_device_get_devnode(dev));
 
                 udev_device_unref(dev);
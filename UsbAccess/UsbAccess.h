@@ -3,13 +3,52 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "IarmEventQueue.h"
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <regex>
 #include <thread>
+#include <vector>
+
+/* Directory listings kept current by inotify for getFileList, the least recently used is dropped beyond this */
+#define USB_ACCESS_INDEX_MAX_DIRS 16
+
+#define USB_ACCESS_LOG_PATH "/opt/logs"
+#define USB_ACCESS_ARCHIVE_LOCK "/tmp/.usbLogArchive.lock"
+/* onArchiveLogsProgress is sent when the progress advanced by this many percent */
+#define USB_ACCESS_ARCHIVE_PROGRESS_STEP 5
+/* onFirmwareUpdateProgress is sent when the streaming advanced by this many percent */
+#define USB_ACCESS_FIRMWARE_PROGRESS_STEP 5
 
 namespace WPEFramework {
 namespace Plugin {
 
     class UsbAccess :  public AbstractPlugin {
+    private:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : NativeArchive(true)
+                , LogPath(_T(USB_ACCESS_LOG_PATH))
+                , Flasher()
+            {
+                Add(_T("nativearchive"), &NativeArchive);
+                Add(_T("logpath"), &LogPath);
+                Add(_T("flasher"), &Flasher);
+            }
+
+        public:
+            Core::JSON::Boolean NativeArchive;
+            Core::JSON::String LogPath;
+            Core::JSON::String Flasher;     // command line, the image is streamed to its stdin
+        };
+
     public:
         UsbAccess();
         virtual ~UsbAccess();
@@ -35,6 +74,9 @@ namespace Plugin {
         //events
         static const string EVT_ON_USB_MOUNT_CHANGED;
         static const string EVT_ON_ARCHIVE_LOGS;
+        static const string EVT_ON_ARCHIVE_LOGS_PROGRESS;
+        static const string EVT_ON_FIRMWARE_UPDATE;
+        static const string EVT_ON_FIRMWARE_UPDATE_PROGRESS;
         //other
         static const string LINK_URL_HTTP;
         static const string LINK_PATH;
@@ -68,7 +110,6 @@ namespace Plugin {
     private/*iarm*/:
         void InitializeIARM();
         void DeinitializeIARM();
-        static void eventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
         void iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
         void onUSBMountChanged(bool mounted, const string& device);
 
@@ -81,14 +122,48 @@ namespace Plugin {
             char fileType; // 'f' or 'd'
             string filename;
         };
-        typedef std::list<FileEnt> FileList;
+        typedef std::vector<FileEnt> FileList;
 
-        static bool getFileList(const string& path, FileList& files, const string& fileRegex, bool includeFolders);
+        // fileRegex may be nullptr for all files
+        static bool getFileList(const string& path, FileList& files, const std::regex* fileRegex, bool includeFolders);
         static bool getMounted(std::list<string>& paths);
 
+        // The entries [offset, offset + limit) of the indexed listing of path (all with limit 0),
+        // built on first use and again after inotify reported a change in the directory.
+        // The generation identifies the listing the page was taken from.
+        bool getIndexedFileList(const string& path, size_t offset, size_t limit, FileList& page, size_t& total, uint32_t& generation);
+        void processIndexEvents();
+        void dropIndex();
+
+        struct DirIndex
+        {
+            FileList files;
+            int watch;
+            uint32_t generation;
+            uint32_t lastUsed;
+        };
+        std::mutex m_indexLock;
+        std::map<string, DirIndex> m_index;
+        int m_inotify;
+        uint32_t m_indexGeneration;
+        uint32_t m_indexUse;
+
         void archiveLogsInternal();
-        void onArchiveLogs(ArchiveLogsError error);
+        ArchiveLogsError archiveLogsNative(const string& mountPath, string& archivePath);
+        void onArchiveLogs(ArchiveLogsError error, const string& archivePath);
+        void onArchiveLogsProgress(int progress);
         std::thread archiveLogsThread;
+        bool m_nativeArchive;
+        string m_logPath;
+
+        // Streams a verified image from the drive to the flasher, see FirmwareStreamer
+        void updateFirmwareStreamed(const string& fileName);
+        void onFirmwareUpdate(bool success, const string& error);
+        void onFirmwareUpdateProgress(const string& phase, int progress);
+        std::thread firmwareThread;
+        std::atomic<bool> m_updating;
+        std::vector<string> m_flasher;
+        IarmEventQueue m_iarmEvents;
     };
 
 } // namespace Plugin
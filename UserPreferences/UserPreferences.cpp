@@ -20,13 +20,14 @@
 #include "UserPreferences.h"
 #include "utils.h"
 
-#include <glib.h>
 #include <glib/gstdio.h>
 
 #define SETTINGS_FILE_NAME              "/opt/user_preferences.conf"
 #define SETTINGS_FILE_KEY               "ui_language"
 #define SETTINGS_FILE_GROUP              "General"
 
+#define EVT_ON_UI_LANGUAGE_CHANGED      "onUILanguageChanged"
+
 using namespace std;
 
 namespace WPEFramework {
@@ -39,6 +40,9 @@ namespace WPEFramework {
 
         UserPreferences::UserPreferences()
                 : AbstractPlugin()
+                , m_settings(g_key_file_new())
+                , m_settingsLoaded(false)
+                , m_hasUILanguage(false)
         {
             LOGINFO("ctor");
             UserPreferences::_instance = this;
@@ -49,6 +53,7 @@ namespace WPEFramework {
         UserPreferences::~UserPreferences()
         {
             //LOGINFO("dtor");
+            g_key_file_free(m_settings);
         }
 
         void UserPreferences::Deinitialize(PluginHost::IShell* /* service */)
@@ -57,29 +62,50 @@ namespace WPEFramework {
             UserPreferences::_instance = nullptr;
         }
 
-        //Begin methods
-        uint32_t UserPreferences::getUILanguage(const JsonObject& parameters, JsonObject& response)
+        bool UserPreferences::loadSettingsNoLock()
         {
-            LOGINFOMETHOD();
-
-            g_autoptr(GKeyFile) file = g_key_file_new();
+            if (m_settingsLoaded)
+                return true;
 
             g_autoptr(GError) error = nullptr;
-            if (!g_key_file_load_from_file (file, SETTINGS_FILE_NAME, G_KEY_FILE_NONE, &error))
+            if (!g_key_file_load_from_file (m_settings, SETTINGS_FILE_NAME, G_KEY_FILE_KEEP_COMMENTS, &error))
             {
-                LOGERR("Unable to load from file '%s': %s", SETTINGS_FILE_NAME, error->message);
-                returnResponse(false);
+                if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+                {
+                    LOGERR("Unable to load from file '%s': %s", SETTINGS_FILE_NAME, error->message);
+                    return false;
+                }
+                LOGINFO("No '%s' yet", SETTINGS_FILE_NAME);
             }
 
-            g_autofree gchar * val = g_key_file_get_string(file, SETTINGS_FILE_GROUP, SETTINGS_FILE_KEY, &error);
-            if (val == nullptr)
+            g_autofree gchar * val = g_key_file_get_string(m_settings, SETTINGS_FILE_GROUP, SETTINGS_FILE_KEY, nullptr);
+            m_hasUILanguage = (val != nullptr);
+            m_uiLanguage = m_hasUILanguage ? string(val) : string();
+            m_settingsLoaded = true;
+
+            return true;
+        }
+
+        //Begin methods
+        uint32_t UserPreferences::getUILanguage(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            string language;
             {
-                LOGERR("Unable to get key '%s' for group '%s' from file '%s': %s"
-                        , SETTINGS_FILE_KEY, SETTINGS_FILE_GROUP, SETTINGS_FILE_NAME, error->message);
-                returnResponse(false);
+                std::lock_guard<std::mutex> lock(m_settingsLock);
+                if (!loadSettingsNoLock())
+                    returnResponse(false);
+
+                if (!m_hasUILanguage)
+                {
+                    LOGERR("No key '%s' for group '%s' in file '%s'", SETTINGS_FILE_KEY, SETTINGS_FILE_GROUP, SETTINGS_FILE_NAME);
+                    returnResponse(false);
+                }
+                language = m_uiLanguage;
             }
 
-            response[SETTINGS_FILE_KEY] = string(val);
+            response[SETTINGS_FILE_KEY] = language;
 
             returnResponse(true);
         }
@@ -90,21 +116,47 @@ namespace WPEFramework {
             returnIfStringParamNotFound(parameters, SETTINGS_FILE_KEY);
             string language = parameters[SETTINGS_FILE_KEY].String();
 
-            g_autoptr(GKeyFile) file = g_key_file_new();
-            g_key_file_set_string(file, SETTINGS_FILE_GROUP, SETTINGS_FILE_KEY, (gchar *)language.c_str());
-
-            g_autoptr(GError) error = nullptr;
-            if (!g_key_file_save_to_file (file, SETTINGS_FILE_NAME, &error))
             {
-                LOGERR("Error to saving file '%s': %s", SETTINGS_FILE_NAME, error->message);
-                returnResponse(false);
+                std::lock_guard<std::mutex> lock(m_settingsLock);
+                if (!loadSettingsNoLock())
+                    returnResponse(false);
+
+                if (m_hasUILanguage && m_uiLanguage == language)
+                    returnResponse(true);
+
+                g_key_file_set_string(m_settings, SETTINGS_FILE_GROUP, SETTINGS_FILE_KEY, (gchar *)language.c_str());
+
+                // g_file_set_contents writes a temporary file and renames it over the settings file
+                gsize length = 0;
+                g_autofree gchar * data = g_key_file_to_data(m_settings, &length, nullptr);
+                g_autoptr(GError) error = nullptr;
+                if (!g_file_set_contents(SETTINGS_FILE_NAME, data, length, &error))
+                {
+                    LOGERR("Error to saving file '%s': %s", SETTINGS_FILE_NAME, error->message);
+                    if (m_hasUILanguage)
+                        g_key_file_set_string(m_settings, SETTINGS_FILE_GROUP, SETTINGS_FILE_KEY, (gchar *)m_uiLanguage.c_str());
+                    else
+                        g_key_file_remove_key(m_settings, SETTINGS_FILE_GROUP, SETTINGS_FILE_KEY, nullptr);
+                    returnResponse(false);
+                }
+
+                m_uiLanguage = language;
+                m_hasUILanguage = true;
             }
 
+            onUILanguageChanged(language);
+
             returnResponse(true);
         }
         //End methods
 
         //Begin events
+        void UserPreferences::onUILanguageChanged(const string& language)
+        {
+            JsonObject params;
+            params[SETTINGS_FILE_KEY] = language;
+            sendNotify(EVT_ON_UI_LANGUAGE_CHANGED, params);
+        }
         //End events
 
     } // namespace Plugin
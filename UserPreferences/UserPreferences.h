@@ -23,6 +23,9 @@
 #include "utils.h"
 #include "AbstractPlugin.h"
 
+#include <glib.h>
+#include <mutex>
+
 namespace WPEFramework {
     namespace Plugin {
 
@@ -38,8 +41,11 @@ namespace WPEFramework {
             //End methods
 
             //Begin events
+            void onUILanguageChanged(const string& language);
             //End events
 
+            bool loadSettingsNoLock();
+
         public:
             UserPreferences();
             virtual ~UserPreferences();
@@ -49,6 +55,13 @@ namespace WPEFramework {
         public:
             static UserPreferences* _instance;
 
+        private:
+            // The settings file is read once, every group is kept so that saving doesn't drop the others
+            GKeyFile* m_settings;
+            bool m_settingsLoaded;
+            string m_uiLanguage;
+            bool m_hasUILanguage;
+            std::mutex m_settingsLock;
         };
     } // namespace Plugin
 } // namespace WPEFramework
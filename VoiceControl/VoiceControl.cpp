@@ -10,6 +10,28 @@ namespace WPEFramework {
 
     namespace Plugin {
 
+        namespace {
+            // Server messages carry their fields either at the top level or in msgPayload (VREX NextGen)
+            bool findServerField(const JsonObject& message, const char* label, JsonValue& value)
+            {
+                if (message.HasLabel(label))
+                {
+                    value = message[label];
+                    return true;
+                }
+                if (message.HasLabel("msgPayload"))
+                {
+                    JsonObject payload = message["msgPayload"].Object();
+                    if (payload.HasLabel(label))
+                    {
+                        value = payload[label];
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+
         SERVICE_REGISTRATION(VoiceControl, 1, 0);
 
         VoiceControl* VoiceControl::_instance = nullptr;
@@ -17,6 +39,8 @@ namespace WPEFramework {
         VoiceControl::VoiceControl()
             : AbstractPlugin()
             , m_apiVersionNumber((uint32_t)-1)   /* default max uint32_t so everything gets enabled */
+            , m_streaming(false)
+            , m_streamingRate(VOICE_STREAMING_DEFAULT_RATE)
         {
             LOGINFO("ctor");
             VoiceControl::_instance = this;
@@ -28,6 +52,8 @@ namespace WPEFramework {
             registerMethod("setVoiceInit",          &VoiceControl::setVoiceInit,        this);
             registerMethod("sendVoiceMessage",      &VoiceControl::sendVoiceMessage,    this);
             registerMethod("voiceSessionByText",    &VoiceControl::voiceSessionByText,  this);
+            registerMethod("setStreamingMode",      &VoiceControl::setStreamingMode,    this);
+            registerMethod("getStreamingMode",      &VoiceControl::getStreamingMode,    this);
 
             setApiVersionNumber(1);
         }
@@ -482,6 +508,38 @@ namespace WPEFramework {
 
             returnResponse(bSuccess);
         }
+
+        uint32_t VoiceControl::setStreamingMode(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            returnIfParamNotFound(parameters, "enable");
+
+            bool enable = false;
+            int rate = VOICE_STREAMING_DEFAULT_RATE;
+            getBoolParameter("enable", enable);
+            getDefaultNumberParameter("maxEventRate", rate, VOICE_STREAMING_DEFAULT_RATE);
+
+            if ((rate <= 0) || (rate > VOICE_STREAMING_MAX_RATE))
+            {
+                LOGERR("ERROR - maxEventRate %d out of range, 1 to %d events per second.", rate, VOICE_STREAMING_MAX_RATE);
+                returnResponse(false);
+            }
+
+            std::lock_guard<std::mutex> lock(m_streamingLock);
+            m_streaming = enable;
+            m_streamingRate = (uint32_t)rate;
+            returnResponse(true);
+        }
+
+        uint32_t VoiceControl::getStreamingMode(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            std::lock_guard<std::mutex> lock(m_streamingLock);
+            response["enable"] = m_streaming;
+            response["maxEventRate"] = m_streamingRate;
+            returnResponse(true);
+        }
         //End methods
 
         //Begin events
@@ -491,6 +549,8 @@ namespace WPEFramework {
 
             params.FromString(eventData->payload);
 
+            resetStreamingSession(params["sessionId"].String());
+
             sendNotify("onSessionBegin", params);
         }
 
@@ -519,6 +579,8 @@ namespace WPEFramework {
             params.FromString(eventData->payload);
 
             sendNotify("onServerMessage", params);
+
+            onStreamingMessage(params);
         }
 
         void VoiceControl::onStreamEnd(ctrlm_voice_iarm_event_json_t* eventData)
@@ -537,6 +599,68 @@ namespace WPEFramework {
             params.FromString(eventData->payload);
 
             sendNotify("onSessionEnd", params);
+
+            resetStreamingSession(string());
+        }
+
+        // Turns the server messages of a session into partial transcription, intent and audio level
+        // events as soon as they arrive, instead of leaving the application to wait for onSessionEnd.
+        // Intermediate partial transcriptions and audio levels are dropped beyond maxEventRate, the first
+        // and the final transcription and every new intent always get through.
+        void VoiceControl::onStreamingMessage(const JsonObject& message)
+        {
+            JsonValue value;
+            JsonObject partial;
+            JsonObject intent;
+            JsonObject level;
+
+            {
+                std::lock_guard<std::mutex> lock(m_streamingLock);
+                if (!m_streaming)
+                    return;
+
+                if (findServerField(message, "transcription", value) && (value.Content() == JsonValue::type::STRING))
+                {
+                    JsonValue isFinal;
+                    bool complete = (findServerField(message, "isFinal", isFinal) || findServerField(message, "final", isFinal)) && isFinal.Boolean();
+                    string transcription = value.String();
+
+                    if ((transcription != m_lastPartial) && (complete || m_lastPartial.empty() || streamingEventDue(m_lastPartialTime)))
+                    {
+                        m_lastPartial = transcription;
+                        m_lastPartialTime = std::chrono::steady_clock::now();
+                        partial["sessionId"] = m_streamingSessionId;
+                        partial["transcription"] = transcription;
+                        partial["final"] = complete;
+                    }
+                }
+
+                if (findServerField(message, "intent", value))
+                {
+                    string serialized;
+                    value.ToString(serialized);
+                    if (serialized != m_lastIntent)
+                    {
+                        m_lastIntent = serialized;
+                        intent["sessionId"] = m_streamingSessionId;
+                        intent["intent"] = value;
+                    }
+                }
+
+                if (findServerField(message, "audioLevel", value) && (value.Content() == JsonValue::type::NUMBER) && streamingEventDue(m_lastAudioLevelTime))
+                {
+                    m_lastAudioLevelTime = std::chrono::steady_clock::now();
+                    level["sessionId"] = m_streamingSessionId;
+                    level["level"] = value.Number();
+                }
+            }
+
+            if (partial.HasLabel("transcription"))
+                sendNotify("onPartialTranscription", partial);
+            if (intent.HasLabel("intent"))
+                sendNotify("onIntent", intent);
+            if (level.HasLabel("level"))
+                sendNotify("onAudioLevel", level);
         }
         //End events
 
@@ -546,6 +670,22 @@ namespace WPEFramework {
             LOGINFO("setting version: %d", (int)apiVersionNumber);
             m_apiVersionNumber = apiVersionNumber;
         }
+
+        void VoiceControl::resetStreamingSession(const string& sessionId)
+        {
+            std::lock_guard<std::mutex> lock(m_streamingLock);
+            m_streamingSessionId = sessionId;
+            m_lastPartial.clear();
+            m_lastIntent.clear();
+            m_lastPartialTime = std::chrono::steady_clock::time_point();
+            m_lastAudioLevelTime = std::chrono::steady_clock::time_point();
+        }
+
+        // Called with m_streamingLock held
+        bool VoiceControl::streamingEventDue(const std::chrono::steady_clock::time_point& last) const
+        {
+            return (std::chrono::steady_clock::now() - last) >= std::chrono::milliseconds(1000 / m_streamingRate);
+        }
         //End local private utility methods
 
     } // namespace Plugin
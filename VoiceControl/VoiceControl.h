@@ -8,8 +8,14 @@
 #include "ctrlm_ipc.h"
 #include "ctrlm_ipc_voice.h"
 
+#include <chrono>
+#include <mutex>
+
 #define IARM_VOICECONTROL_PLUGIN_NAME       "Voice_Control"
 
+#define VOICE_STREAMING_DEFAULT_RATE        10  // events per second, per event type
+#define VOICE_STREAMING_MAX_RATE            50
+
 namespace WPEFramework {
 
     namespace Plugin {
@@ -41,6 +47,8 @@ namespace WPEFramework {
             uint32_t setVoiceInit(const JsonObject& parameters, JsonObject& response);
             uint32_t sendVoiceMessage(const JsonObject& parameters, JsonObject& response);
             uint32_t voiceSessionByText(const JsonObject& parameters, JsonObject& response);
+            uint32_t setStreamingMode(const JsonObject& parameters, JsonObject& response);
+            uint32_t getStreamingMode(const JsonObject& parameters, JsonObject& response);
             //End methods
 
             //Begin events
@@ -50,6 +58,9 @@ namespace WPEFramework {
             void onServerMessage(ctrlm_voice_iarm_event_json_t* eventData);
             void onStreamEnd(ctrlm_voice_iarm_event_json_t* eventData);
             void onSessionEnd(ctrlm_voice_iarm_event_json_t* eventData);
+
+            // Streaming mode, derived from the server messages of the session
+            void onStreamingMessage(const JsonObject& message);
             //End events
 
         public:
@@ -67,11 +78,23 @@ namespace WPEFramework {
 
             // Local utility methods
             void setApiVersionNumber(uint32_t apiVersionNumber);
+            void resetStreamingSession(const string& sessionId);
+            bool streamingEventDue(const std::chrono::steady_clock::time_point& last) const;
         public:
             static VoiceControl* _instance;
         private:
             uint32_t m_apiVersionNumber;
             bool m_hasOwnProcess;
+
+            // Streaming mode state, events arrive on the IARM thread
+            std::mutex m_streamingLock;
+            bool m_streaming;
+            uint32_t m_streamingRate;
+            string m_streamingSessionId;
+            string m_lastPartial;
+            string m_lastIntent;
+            std::chrono::steady_clock::time_point m_lastPartialTime;
+            std::chrono::steady_clock::time_point m_lastAudioLevelTime;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
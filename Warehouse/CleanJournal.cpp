@@ -0,0 +1,353 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "CleanJournal.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "utils.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            const uint32_t JOURNAL_WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                    IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_ONLYDIR;
+
+            std::string parentOf(const std::string& path)
+            {
+                size_t slash = path.find_last_of('/');
+                return (slash == std::string::npos || slash == 0) ? std::string("/") : path.substr(0, slash);
+            }
+
+            bool isDirectory(const std::string& path)
+            {
+                struct stat info;
+                return (lstat(path.c_str(), &info) == 0) && S_ISDIR(info.st_mode);
+            }
+        }
+
+        CleanJournal::CleanJournal()
+            : m_inotify(-1)
+            , m_valid(false)
+        {
+        }
+
+        CleanJournal::~CleanJournal()
+        {
+            stop();
+        }
+
+        bool CleanJournal::start(const std::vector<Rule>& rules)
+        {
+            stop();
+
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (m_inotify < 0)
+            {
+                LOGWARN("inotify_init1 failed: %s, isClean scans every time", strerror(errno));
+                return false;
+            }
+
+            m_rules = rules;
+            m_valid = true;
+
+            for (size_t i = 0; i < m_rules.size() && m_valid; i++)
+            {
+                const Rule& rule = m_rules[i];
+
+                if (isDirectory(rule.root))
+                {
+                    if (!watch(rule.root, std::vector<size_t>(1, i), true))
+                        invalidate("can't watch a path");
+                }
+                else
+                {
+                    // Wait for the root to be created, one level only
+                    int wd = inotify_add_watch(m_inotify, parentOf(rule.root).c_str(), JOURNAL_WATCH_MASK);
+                    if (wd < 0)
+                    {
+                        LOGWARN("journal can't watch for %s: %s", rule.root.c_str(), strerror(errno));
+                        invalidate("can't watch a path");
+                    }
+                    else
+                    {
+                        Watch& entry = m_watches[wd];
+                        entry.path = parentOf(rule.root);
+                        entry.pending.push_back(i);
+                    }
+                }
+            }
+
+            LOGINFO("journal %s, %zu directories watched, %zu objects", m_valid ? "started" : "not usable", m_watches.size(), m_objects.size());
+            return m_valid;
+        }
+
+        void CleanJournal::stop()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_inotify >= 0)
+            {
+                close(m_inotify);
+                m_inotify = -1;
+            }
+            m_valid = false;
+            m_watches.clear();
+            m_objects.clear();
+            m_rules.clear();
+        }
+
+        bool CleanJournal::query(int age, std::vector<std::string>& files)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_valid)
+                processEvents();
+            if (!m_valid)
+                return false;
+
+            std::vector<uint32_t> reported(m_rules.size(), 0);
+            time_t now = time(nullptr);
+
+            files.clear();
+            for (const std::pair<const std::string, Object>& object : m_objects)
+            {
+                if (reported[object.second.rule] >= CLEAN_JOURNAL_MAX_FILES_PER_RULE)
+                    continue;
+
+                if (age == -1 || difftime(now, object.second.mtime) > age)
+                {
+                    files.push_back(object.first);
+                    reported[object.second.rule]++;
+                }
+            }
+
+            return true;
+        }
+
+        // Caller holds m_lock. The watches stay until the next start, they cost nothing when not read.
+        void CleanJournal::invalidate(const char* reason)
+        {
+            if (m_valid)
+                LOGWARN("journal invalidated: %s", reason);
+            m_valid = false;
+            m_objects.clear();
+        }
+
+        // Caller holds m_lock
+        bool CleanJournal::watch(const std::string& path, const std::vector<size_t>& rules, bool seed)
+        {
+            // Watch before listing, so that nothing created after the listing is missed
+            int wd = inotify_add_watch(m_inotify, path.c_str(), JOURNAL_WATCH_MASK);
+            if (wd < 0)
+            {
+                LOGWARN("journal can't watch %s: %s", path.c_str(), strerror(errno));
+                return false;
+            }
+
+            Watch& entry = m_watches[wd];
+            entry.path = path;
+            for (size_t rule : rules)
+                if (std::find(entry.rules.begin(), entry.rules.end(), rule) == entry.rules.end())
+                    entry.rules.push_back(rule);
+
+            if (!seed)
+                return true;
+
+            // Below the root only the recursive rules look into subdirectories
+            std::vector<size_t> recursive;
+            for (size_t rule : rules)
+                if (m_rules[rule].recursive)
+                    recursive.push_back(rule);
+
+            DIR* dir = opendir(path.c_str());
+            if (dir == nullptr)
+                return true; // gone again, the event says so
+
+            bool ok = true;
+            struct dirent* de;
+            while (ok && (de = readdir(dir)) != nullptr)
+            {
+                if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+                    continue;
+
+                std::string child = path + "/" + de->d_name;
+                record(child, rules, true);
+
+                bool isDir = (de->d_type == DT_DIR) || (de->d_type == DT_UNKNOWN && isDirectory(child));
+                if (isDir && !recursive.empty() && de->d_name[0] != '.')
+                    ok = watch(child, recursive, true);
+            }
+            closedir(dir);
+
+            return ok;
+        }
+
+        // Caller holds m_lock
+        void CleanJournal::record(const std::string& path, const std::vector<size_t>& rules, bool exists)
+        {
+            int rule = matchingRule(path, rules);
+            if (rule < 0)
+                return;
+
+            struct stat info;
+            if (exists && stat(path.c_str(), &info) == 0)
+            {
+                Object& object = m_objects[path];
+                object.rule = rule;
+                object.mtime = info.st_mtime;
+            }
+            else
+                m_objects.erase(path);
+        }
+
+        // The matching of the isClean scan: find <root> [-maxdepth 1] ! -path "*/\.*" -name <name> ! -path <root>/<exclusion>
+        int CleanJournal::matchingRule(const std::string& path, const std::vector<size_t>& rules) const
+        {
+            for (size_t index : rules)
+            {
+                const Rule& rule = m_rules[index];
+
+                if (rule.literal)
+                {
+                    if (path == rule.root + "/" + rule.name)
+                        return index;
+                    continue;
+                }
+
+                if (path.compare(0, rule.root.size() + 1, rule.root + "/") != 0)
+                    continue;
+                if (!rule.recursive && path.find('/', rule.root.size() + 1) != std::string::npos)
+                    continue;
+                if (path.find("/.") != std::string::npos)
+                    continue;
+                if (fnmatch(rule.name.c_str(), path.c_str() + path.find_last_of('/') + 1, 0) != 0)
+                    continue;
+
+                bool excluded = false;
+                for (const std::string& exclusion : rule.exclusions)
+                    excluded = excluded || (fnmatch((rule.root + "/" + exclusion).c_str(), path.c_str(), 0) == 0);
+                if (!excluded)
+                    return index;
+            }
+            return -1;
+        }
+
+        // Caller holds m_lock
+        void CleanJournal::forget(const std::string& path)
+        {
+            m_objects.erase(path);
+
+            std::map<std::string, Object>::iterator it = m_objects.lower_bound(path + "/");
+            while (it != m_objects.end() && it->first.compare(0, path.size() + 1, path + "/") == 0)
+                it = m_objects.erase(it);
+        }
+
+        // Caller holds m_lock
+        void CleanJournal::processEvents()
+        {
+            char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+            ssize_t length;
+
+            while (m_valid && (length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+            {
+                for (char* ptr = buffer; m_valid && ptr < buffer + length; )
+                {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+                    ptr += sizeof(struct inotify_event) + event->len;
+
+                    if (event->mask & IN_Q_OVERFLOW)
+                    {
+                        invalidate("inotify queue overflow");
+                        break;
+                    }
+
+                    std::map<int, Watch>::iterator watched = m_watches.find(event->wd);
+                    if (watched == m_watches.end())
+                        continue;
+
+                    if (event->mask & IN_IGNORED)
+                    {
+                        m_watches.erase(watched);
+                        continue;
+                    }
+
+                    const Watch& entry = watched->second;
+
+                    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT))
+                    {
+                        // A subdirectory that is deleted was forgotten with the event of its parent
+                        bool isRoot = false;
+                        for (size_t rule : entry.rules)
+                            isRoot = isRoot || (m_rules[rule].root == entry.path);
+                        if (isRoot || !entry.pending.empty() || (event->mask & (IN_MOVE_SELF | IN_UNMOUNT)))
+                            invalidate("a watched directory went away");
+                        continue;
+                    }
+
+                    if (event->len == 0)
+                        continue;
+
+                    const std::string path = entry.path + "/" + event->name;
+
+                    if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                    {
+                        forget(path);
+                        continue;
+                    }
+
+                    // Copies, watch() may add to m_watches
+                    const std::vector<size_t> rules = entry.rules;
+                    const std::vector<size_t> pending = entry.pending;
+
+                    record(path, rules, true);
+
+                    if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                    {
+                        std::vector<size_t> below;
+                        for (size_t rule : pending)
+                            if (m_rules[rule].root == path)
+                                below.push_back(rule);
+                        if (event->name[0] != '.')
+                            for (size_t rule : rules)
+                                if (m_rules[rule].recursive)
+                                    below.push_back(rule);
+
+                        if (!below.empty() && !watch(path, below, true))
+                            invalidate("can't watch a path");
+                    }
+                }
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,99 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <time.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Objects reported per rule, like the "head -n 10" of the isClean scan */
+#define CLEAN_JOURNAL_MAX_FILES_PER_RULE 10
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        /*
+         * Journal of the user data objects that exist in the paths checked by isClean.
+         *
+         * start() walks the paths once, puts inotify watches on the directories and records
+         * what exists. After that the inotify events keep the journal up to date, they are
+         * read when the journal is queried, so nothing runs in between. The journal gives up
+         * (query returns false and isClean scans) on an inotify queue overflow, when a watch
+         * can't be added or when a watched directory is moved away.
+         */
+        class CleanJournal
+        {
+        public:
+            // What the isClean scan looks for: objects named like name in root, or anywhere below it if recursive
+            struct Rule
+            {
+                std::string root;
+                std::string name;                   // fnmatch pattern
+                bool recursive;
+                bool literal;                       // root/name itself, hidden or not
+                std::vector<std::string> exclusions; // fnmatch patterns relative to root
+            };
+
+            CleanJournal();
+            ~CleanJournal();
+            CleanJournal(const CleanJournal&) = delete;
+            CleanJournal& operator=(const CleanJournal&) = delete;
+
+            bool start(const std::vector<Rule>& rules);
+            void stop();
+
+            // Objects modified more than age seconds ago (all for age -1), false if the journal can't tell
+            bool query(int age, std::vector<std::string>& files);
+
+        private:
+            struct Watch
+            {
+                std::string path;
+                std::vector<size_t> rules;          // rules with their root at or above path
+                std::vector<size_t> pending;        // rules the root of which may be created in path
+            };
+
+            struct Object
+            {
+                size_t rule;
+                time_t mtime;
+            };
+
+            void invalidate(const char* reason);
+            bool watch(const std::string& path, const std::vector<size_t>& rules, bool seed);
+            void record(const std::string& path, const std::vector<size_t>& rules, bool exists);
+            int matchingRule(const std::string& path, const std::vector<size_t>& rules) const;
+            void forget(const std::string& path);
+            void processEvents();
+
+            std::mutex m_lock;
+            int m_inotify;
+            bool m_valid;
+            std::vector<Rule> m_rules;
+            std::map<int, Watch> m_watches;
+            std::map<std::string, Object> m_objects;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
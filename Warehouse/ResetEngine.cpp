@@ -0,0 +1,221 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ResetEngine.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "utils.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            struct Removal
+            {
+                std::mutex lock;
+                std::string error;
+                std::atomic<uint32_t> removed;
+                uint32_t total;
+                const ResetEngine::Progress* progress;
+            };
+
+            void fail(Removal& removal, const std::string& path, int err)
+            {
+                std::lock_guard<std::mutex> lock(removal.lock);
+                LOGERR("failed to remove %s: %s", path.c_str(), strerror(err));
+                if (removal.error.empty())
+                    removal.error = "failed to remove " + path + ": " + strerror(err);
+            }
+
+            // Removes the contents of the directory dirFd, which is closed
+            bool removeContents(int dirFd, const std::string& path, Removal& removal)
+            {
+                DIR* dir = fdopendir(dirFd);
+                if (dir == nullptr)
+                {
+                    fail(removal, path, errno);
+                    close(dirFd);
+                    return false;
+                }
+
+                bool ok = true;
+                struct dirent* entry;
+                while ((entry = readdir(dir)) != nullptr)
+                {
+                    const char* name = entry->d_name;
+                    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+                        continue;
+
+                    bool isDir = (entry->d_type == DT_DIR);
+                    if (entry->d_type == DT_UNKNOWN)
+                    {
+                        struct stat info;
+                        isDir = (fstatat(dirfd(dir), name, &info, AT_SYMLINK_NOFOLLOW) == 0) && S_ISDIR(info.st_mode);
+                    }
+
+                    if (isDir)
+                    {
+                        int fd = openat(dirfd(dir), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                        if (fd < 0)
+                        {
+                            fail(removal, path + "/" + name, errno);
+                            ok = false;
+                            continue;
+                        }
+                        ok = removeContents(fd, path + "/" + name, removal) && ok;
+                    }
+
+                    if (unlinkat(dirfd(dir), name, isDir ? AT_REMOVEDIR : 0) != 0 && errno != ENOENT)
+                    {
+                        fail(removal, path + "/" + name, errno);
+                        ok = false;
+                    }
+                }
+
+                closedir(dir);
+                return ok;
+            }
+
+            void removePath(const std::string& path, Removal& removal)
+            {
+                struct stat info;
+                if (lstat(path.c_str(), &info) == 0)
+                {
+                    if (S_ISDIR(info.st_mode))
+                    {
+                        int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                        if (fd < 0)
+                            fail(removal, path, errno);
+                        else if (removeContents(fd, path, removal) && rmdir(path.c_str()) != 0 && errno != ENOENT)
+                            fail(removal, path, errno);
+                    }
+                    else if (unlink(path.c_str()) != 0 && errno != ENOENT)
+                        fail(removal, path, errno);
+                }
+
+                uint32_t removed = ++removal.removed;
+                if (*removal.progress)
+                {
+                    std::lock_guard<std::mutex> lock(removal.lock);
+                    (*removal.progress)(removed, removal.total);
+                }
+            }
+
+            std::string parentOf(const std::string& path)
+            {
+                size_t slash = path.find_last_of('/');
+                return (slash == std::string::npos || slash == 0) ? std::string("/") : path.substr(0, slash);
+            }
+        }
+
+        bool ResetEngine::removePaths(const std::vector<std::string>& manifest, const Progress& progress, std::string& error)
+        {
+            // Expanded paths grouped by the file system they are on
+            std::map<dev_t, std::vector<std::string>> fileSystems;
+            uint32_t total = 0;
+
+            for (const std::string& pattern : manifest)
+            {
+                glob_t matches;
+                if (glob(pattern.c_str(), GLOB_NOSORT, nullptr, &matches) != 0)
+                {
+                    globfree(&matches); // nothing to remove
+                    continue;
+                }
+
+                for (size_t i = 0; i < matches.gl_pathc; i++)
+                {
+                    std::string path(matches.gl_pathv[i]);
+                    while (path.size() > 1 && path[path.size() - 1] == '/')
+                        path.erase(path.size() - 1);
+
+                    if (path.empty() || path == "/" || path[0] != '/')
+                    {
+                        LOGWARN("not removing '%s'", path.c_str());
+                        continue;
+                    }
+
+                    struct stat info;
+                    if (lstat(parentOf(path).c_str(), &info) != 0)
+                        continue;
+
+                    fileSystems[info.st_dev].push_back(path);
+                    total++;
+                }
+                globfree(&matches);
+            }
+
+            Removal removal;
+            removal.removed = 0;
+            removal.total = total;
+            removal.progress = &progress;
+
+            LOGINFO("removing %u paths on %zu file systems", total, fileSystems.size());
+
+            std::vector<std::thread> workers;
+            for (auto& fileSystem : fileSystems)
+            {
+                const std::vector<std::string>& paths = fileSystem.second;
+                workers.push_back(std::thread([&paths, &removal]() {
+                    for (const std::string& path : paths)
+                        removePath(path, removal);
+
+                    // One sync per file system instead of one per unlink
+                    int fd = open(parentOf(paths.front()).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                    if (fd >= 0)
+                    {
+                        syncfs(fd);
+                        close(fd);
+                    }
+                }));
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+
+            error = removal.error;
+            return error.empty();
+        }
+
+        std::vector<std::string> ResetEngine::splitManifest(const std::string& paths)
+        {
+            std::vector<std::string> manifest;
+            std::istringstream fields(paths);
+            std::string path;
+            while (fields >> path)
+                manifest.push_back(path);
+            return manifest;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,59 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        /*
+         * Native replacement of the "rm -rf <paths>" of the reset scripts.
+         *
+         * The manifest holds the paths as the scripts had them, shell globs included:
+         * a path ending in a star wildcard removes the contents of the directory, as with
+         * the shell dot files are left, a plain path removes the directory itself.
+         * The expanded paths are grouped by file system and every file system is cleared
+         * by its own thread with unlinkat, so flash partitions and the SD card are worked
+         * on in parallel. Instead of syncing every unlink each file system is synced once
+         * when it is done.
+         */
+        class ResetEngine
+        {
+        public:
+            // <removed> of <total> expanded paths done
+            typedef std::function<void(uint32_t removed, uint32_t total)> Progress;
+
+            // Removes what the manifest matches, false with the first error if something could not be removed
+            static bool removePaths(const std::vector<std::string>& manifest, const Progress& progress, std::string& error);
+
+            // Splits a "path path ..." list like the one of the scripts
+            static std::vector<std::string> splitManifest(const std::string& paths);
+
+        private:
+            ResetEngine() = delete;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -33,6 +33,7 @@
 #include "utils.h"
 
 #include "frontpanel.h"
+#include "ResetEngine.h"
 
 #include "rfcapi.h"
 
@@ -55,6 +56,7 @@
 
 #define WAREHOUSE_EVT_DEVICE_INFO_RETRIEVED "deviceInfoRetrieved"
 #define WAREHOUSE_EVT_RESET_DONE "resetDone"
+#define WAREHOUSE_EVT_RESET_PROGRESS "resetProgress"
 
 #define HOSTS_FILE "/etc/warehouseHosts.conf"
 #define DEFAULT_CNAME_TAIL ".warehouse.ccp.xcal.tv"
@@ -63,11 +65,14 @@
 #define PARAM_ERROR "error"
 
 #define DEVICE_INFO_SCRIPT "sh /lib/rdk/getDeviceDetails.sh read"
+#define DEVICE_INFO_ARGS { "sh", "/lib/rdk/getDeviceDetails.sh", "read" }
 #define VERSION_FILE_NAME "/version.txt"
 #define CUSTOM_DATA_FILE "/lib/rdk/wh_api_5.conf"
 
-#define LIGHT_RESET_SCRIPT "rm -rf /opt/netflix/* SD_CARD_MOUNT_PATH/netflix/* XDG_DATA_HOME/* XDG_CACHE_HOME/* XDG_CACHE_HOME/../.sparkStorage/ /opt/QT/home/data/* /opt/hn_service_settings.conf /opt/apps/common/proxies.conf /opt/lib/bluetooth /opt/persistent/rdkservicestore"
-#define INTERNAL_RESET_SCRIPT "rm -rf /opt/drm /opt/www/whitebox /opt/www/authService && /rebootNow.sh -s WarehouseService &"
+// Removed by ResetEngine, upper case words are replaced with the environment variables
+#define LIGHT_RESET_PATHS "/opt/netflix/* SD_CARD_MOUNT_PATH/netflix/* XDG_DATA_HOME/* XDG_CACHE_HOME/* XDG_CACHE_HOME/../.sparkStorage/ /opt/QT/home/data/* /opt/hn_service_settings.conf /opt/apps/common/proxies.conf /opt/lib/bluetooth /opt/persistent/rdkservicestore"
+#define INTERNAL_RESET_PATHS "/opt/drm /opt/www/whitebox /opt/www/authService"
+#define INTERNAL_RESET_SCRIPT "/rebootNow.sh -s WarehouseService &"
 
 #define FRONT_PANEL_NONE -1
 #define FRONT_PANEL_INPROGRESS 1
@@ -83,6 +88,7 @@ namespace WPEFramework
         Warehouse* Warehouse::_instance = nullptr;
         Warehouse::Warehouse()
         : AbstractPlugin(2)
+        , m_cleanJournalEnabled(false)
 #ifdef HAS_FRONT_PANEL
         , m_ledTimer(64 * 1024, "LedTimer")
         , m_ledInfo(this)
@@ -105,8 +111,14 @@ namespace WPEFramework
             LOGWARN ("Dtor:%d", __LINE__);
         }
 
-        const string Warehouse::Initialize(PluginHost::IShell* /* service */)
+        const string Warehouse::Initialize(PluginHost::IShell* service)
         {
+            Config config;
+            if (service)
+                config.FromString(service->ConfigLine());
+            // Started by the first isClean, which scans
+            m_cleanJournalEnabled = config.CleanJournal.Value();
+
             InitializeIARM();
             LOGWARN ("Warehouse::Initialize finished line:%d", __LINE__);
             // On success return empty, to indicate there is no error text.
@@ -115,8 +127,9 @@ namespace WPEFramework
 
         void Warehouse::Deinitialize(PluginHost::IShell* /* service */)
         {
-            Warehouse::_instance = nullptr;
+            m_cleanJournal.stop();
             DeinitializeIARM();
+            Warehouse::_instance = nullptr;
             LOGWARN ("Warehouse::Deinitialize finished line:%d", __LINE__);
         }
 
@@ -124,16 +137,15 @@ namespace WPEFramework
         {
             if (Utils::IARM::init()) {
                IARM_Result_t res;
-               IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_WAREHOUSEOPS_STATUSCHANGED, dsWareHouseOpnStatusChanged) );
+               m_iarmEvents.start();
+               IARM_CHECK( m_iarmEvents.subscribe(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_WAREHOUSEOPS_STATUSCHANGED, dsWareHouseOpnStatusChanged) );
             }
         }
 
         void Warehouse::DeinitializeIARM()
         {
-            if (Utils::IARM::isConnected()) {
-                IARM_Result_t res;
-                IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_EVENT_MODECHANGED) );
-            }
+            /* Unsubscribes, then handles what is still queued */
+            m_iarmEvents.stop();
         }
 
         /**
@@ -332,22 +344,15 @@ namespace WPEFramework
          */
         void Warehouse::getDeviceInfo(JsonObject &params)
         {
-            char buf[256];
-
-            FILE *p = popen(DEVICE_INFO_SCRIPT, "r");
+            std::string res;
+            int errCode = Utils::runCommand(DEVICE_INFO_ARGS, &res);
 
-            if(!p)
+            if (-1 == errCode)
             {
-                LOGWARN("failed to run %s:%s", DEVICE_INFO_SCRIPT, strerror(errno));
+                LOGWARN("failed to run %s", DEVICE_INFO_SCRIPT);
                 return;
             }
 
-            std::string res;
-            while(fgets(buf, sizeof(buf), p) != NULL)
-                res += buf;
-
-            int errCode = pclose(p);
-
             if (0 != errCode)
             {
                 params[PARAM_SUCCESS] = false;
@@ -500,7 +505,7 @@ namespace WPEFramework
             {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
                 std::string error;
-                bool ok = RunScriptIARM(INTERNAL_RESET_SCRIPT, error);
+                bool ok = removePaths("INTERNAL", INTERNAL_RESET_PATHS, error) && RunScriptIARM(INTERNAL_RESET_SCRIPT, error);
                 response[PARAM_SUCCESS] = ok;
                 if (!ok)
                     response[PARAM_ERROR] = error;
@@ -511,11 +516,26 @@ namespace WPEFramework
             }
         }
 
-        void Warehouse::lightReset(JsonObject& response)
+        // Sends resetProgress for every percent done
+        bool Warehouse::removePaths(const char* resetType, const std::string& paths, std::string& error)
         {
-#if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
+            int reported = -1;
+            return ResetEngine::removePaths(ResetEngine::splitManifest(paths), [this, resetType, &reported](uint32_t removed, uint32_t total) {
+                int percent = (total > 0) ? (int)(removed * 100 / total) : 100;
+                if (percent != reported)
+                {
+                    reported = percent;
+                    JsonObject params;
+                    params["resetType"] = resetType;
+                    params["percent"] = percent;
+                    sendNotify(WAREHOUSE_EVT_RESET_PROGRESS, params);
+                }
+            }, error);
+        }
 
-            std::string script(LIGHT_RESET_SCRIPT);
+        void Warehouse::lightReset(JsonObject& response)
+        {
+            std::string script(" " LIGHT_RESET_PATHS);
             regex_t rx;
             regcomp(&rx, "(\\s+)([A-Z_][0-9A-Z_]*)(\\S*)", REG_EXTENDED);
             regmatch_t rm[4];
@@ -531,23 +551,32 @@ namespace WPEFramework
                 if ("SD_CARD_MOUNT_PATH" == var && (!envVar || 0 == *envVar))
                 {
 
-                    FILE *p = popen("cat  /proc/mounts | grep mmcblk0p1 | awk '{print $2}' ", "r");
-
-                    if(!p)
+                    std::string mounts;
+                    if (!Utils::readFile("/proc/mounts", mounts))
                     {
-                        LOGWARN("failed to run script to get SD_CARD_MOUNT_PATH");
+                        LOGWARN("failed to read /proc/mounts to get SD_CARD_MOUNT_PATH");
                     }
                     else
                     {
-                        char buf[256];
-                        while(fgets(buf, sizeof(buf), p) != NULL)
-                            scmp += buf;
+                        // Mount points of mmcblk0p1, one per line
+                        std::stringstream ss(mounts);
+                        std::string line;
+                        while (std::getline(ss, line))
+                        {
+                            if (std::string::npos == line.find("mmcblk0p1"))
+                                continue;
 
-                        scmp.erase(0, scmp.find_first_not_of(" \n\r\t"));
-                        scmp.erase(scmp.find_last_not_of(" \n\r\t") + 1);
+                            std::stringstream fields(line);
+                            std::string device, mountPoint;
+                            if (fields >> device >> mountPoint)
+                            {
+                                if (!scmp.empty())
+                                    scmp += "\n";
+                                scmp += mountPoint;
+                            }
+                        }
 
                         envVar = scmp.c_str();
-                        pclose(p);
                     }
                 }
 
@@ -576,7 +605,7 @@ namespace WPEFramework
             LOGWARN("lightReset: %s", script.c_str());
 
             std::string error;
-            bool ok = RunScriptIARM(script, error);
+            bool ok = removePaths("LIGHT", script, error);
             response[PARAM_SUCCESS] = ok;
             if (ok)
             {
@@ -587,29 +616,19 @@ namespace WPEFramework
                 LOGERR("lightReset failed. %s", error.c_str());
                 response[PARAM_ERROR] = error;
             }
-#else
-            LOGERR("lightReset failed: No IARMBUS");
-            response[PARAM_SUCCESS] = false;
-            response[PARAM_ERROR] = "No IARMBUS";
-#endif
         }
 
-        void Warehouse::isClean(int age, JsonObject& response)
+        // The paths isClean checks, from CUSTOM_DATA_FILE
+        static bool readCleanPaths(std::vector<std::string>& paths, std::string& error)
         {
             std::ifstream customDataFile(CUSTOM_DATA_FILE);
-            JsonArray existedObjects;
 
             if(!customDataFile)
             {
-                LOGERR("Can't open file %s", CUSTOM_DATA_FILE);
-                response[PARAM_SUCCESS] = false;
-                response[PARAM_ERROR] = "Can't open file " CUSTOM_DATA_FILE;
-                response["clean"] = false;
-                response["files"] = existedObjects;
-                return;
+                error = "Can't open file " CUSTOM_DATA_FILE;
+                return false;
             }
 
-            std::vector<std::string> listPathsToRemove;
             for( std::string line; getline( customDataFile, line ); )
             {
                 Utils::String::trim(line);
@@ -617,39 +636,128 @@ namespace WPEFramework
                 {
                     char firstChar = line[0];
                     if (firstChar != '#' && firstChar != '[' && line.substr(0, 2) != ". ")
-                        listPathsToRemove.emplace_back(line);
+                        paths.emplace_back(line);
                 }
             }
             customDataFile.close();
 
-            if (listPathsToRemove.size() == 0)
+            if (paths.size() == 0)
+            {
+                error = "file " CUSTOM_DATA_FILE " doesn't have any lines with paths";
+                return false;
+            }
+            return true;
+        }
+
+        // value of the first variable of the path in /etc/device.properties
+        static void resolveCleanPathVariable(const std::string& path, std::string& variable, std::string& value)
+        {
+            std::string script = "echo '" + path + "' | sed -r \"s/([^$]*)([$\\{]*)([^$\\{\\}\\/]*)(.*)/\\3/\"";
+            variable = Utils::cRunScript(script.c_str());
+            Utils::String::trim(variable);
+
+            value.clear();
+            if (variable.length() > 0)
             {
-                std::string msg = "file " CUSTOM_DATA_FILE " doesn't have any lines with paths";
-                LOGERR("%s", msg.c_str());
-                response[PARAM_ERROR] = msg;
+                script = ". /etc/device.properties; echo \"$" + variable + "\"";
+                value = Utils::cRunScript(script.c_str());
+                Utils::String::trim(value);
+            }
+        }
+
+        // The isClean scan of the paths as journal rules, paths with an empty variable are left out like in the scan
+        static std::vector<CleanJournal::Rule> cleanJournalRules(const std::vector<std::string>& paths)
+        {
+            std::vector<CleanJournal::Rule> rules;
+
+            for (std::string path : paths)
+            {
+                bool pattern = std::find_if(path.begin(), path.end(), [](char c) { return c == '$' || c == '*' || c == '?' || c == '+'; } ) != path.end();
+
+                std::vector<std::string> exclusions;
+                size_t bar = path.find('|');
+                if (pattern && bar != string::npos)
+                {
+                    std::stringstream ss(path.substr(bar + 1));
+                    for (std::string exclusion; getline(ss, exclusion, '|'); )
+                    {
+                        Utils::String::trim(exclusion);
+                        if (exclusion.length() > 0)
+                            exclusions.push_back(exclusion);
+                    }
+                    path = path.substr(0, bar);
+                    Utils::String::trim(path);
+                }
+
+                if (path.find('$') != std::string::npos)
+                {
+                    std::string variable, value;
+                    resolveCleanPathVariable(path, variable, value);
+                    if (value.length() == 0)
+                        continue;
+
+                    size_t start = path.find('$');
+                    size_t end = path.find_first_of("/", start);
+                    path.replace(start, (end == std::string::npos ? path.size() : end) - start, value);
+                }
+
+                size_t slash = path.find_last_of('/');
+                if (slash == std::string::npos || slash == 0)
+                    continue;
+
+                CleanJournal::Rule rule;
+                rule.root = path.substr(0, slash);
+                rule.name = path.substr(slash + 1);
+                rule.recursive = pattern && (rule.name == "*");
+                rule.literal = !pattern;
+                rule.exclusions = exclusions;
+                rules.push_back(rule);
+            }
+
+            return rules;
+        }
+
+        void Warehouse::isClean(int age, bool verify, JsonObject& response)
+        {
+            JsonArray existedObjects;
+
+            std::vector<std::string> files;
+            if (m_cleanJournalEnabled && !verify && m_cleanJournal.query(age, files))
+            {
+                for (const std::string& file : files)
+                    existedObjects.Add(file);
+
+                LOGINFO("journal has %d objects", (int)existedObjects.Length());
+                response[PARAM_SUCCESS] = true;
+                response["files"] = existedObjects;
+                response["clean"] = existedObjects.Length() == 0;
+                return;
+            }
+
+            std::vector<std::string> listPathsToRemove;
+            std::string error;
+            if (!readCleanPaths(listPathsToRemove, error))
+            {
+                LOGERR("%s", error.c_str());
                 response[PARAM_SUCCESS] = false;
+                response[PARAM_ERROR] = error;
+                response["clean"] = false;
                 response["files"] = existedObjects;
                 return;
             }
 
+            // The scan is the reference, the journal starts over from what is there now
+            if (m_cleanJournalEnabled)
+                m_cleanJournal.start(cleanJournalRules(listPathsToRemove));
+
             int totalPathsCounter = 0;
             for(auto &path : listPathsToRemove)
             {
                 // if script's variable in path is empty, then skip it
                 if (path.find('$') != std::string::npos)
                 {
-                    std::string variable;
-                    std::string script = "echo '" + path + "' | sed -r \"s/([^$]*)([$\\{]*)([^$\\{\\}\\/]*)(.*)/\\3/\"";
-                    variable = Utils::cRunScript(script.c_str());
-                    Utils::String::trim(variable);
-
-                    std::string value;
-                    if (variable.length() > 0)
-                    {
-                        script = ". /etc/device.properties; echo \"$" + variable + "\"";
-                        value = Utils::cRunScript(script.c_str());
-                        Utils::String::trim(value);
-                    }
+                    std::string variable, value;
+                    resolveCleanPathVariable(path, variable, value);
 
                     if (value.length() == 0)
                     {
@@ -878,8 +986,10 @@ namespace WPEFramework
 
             int age;
             getDefaultNumberParameter("age", age, -1);
+            bool verify;
+            getDefaultBoolParameter("verify", verify, false);
 
-            isClean(age, response);
+            isClean(age, verify, response);
             return Core::ERROR_NONE;
         }
 
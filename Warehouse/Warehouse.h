@@ -24,6 +24,8 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "IarmEventQueue.h"
+#include "CleanJournal.h"
 
 namespace WPEFramework {
 
@@ -75,6 +77,24 @@ namespace WPEFramework {
         // will receive a JSONRPC message as a notification, in case this method is called.
         class Warehouse : public AbstractPlugin {
         private:
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : CleanJournal(false)
+                {
+                    Add(_T("cleanjournal"), &CleanJournal);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::Boolean CleanJournal; // answer isClean from an inotify journal instead of scanning
+            };
 
             // We do not allow this plugin to be copied !!
             Warehouse(const Warehouse&) = delete;
@@ -86,7 +106,8 @@ namespace WPEFramework {
             void setFrontPanelState(int state, JsonObject& response);
             void internalReset(JsonObject& response);
             void lightReset(JsonObject& response);
-            void isClean(int age, JsonObject& response);
+            bool removePaths(const char* resetType, const std::string& paths, std::string& error);
+            void isClean(int age, bool verify, JsonObject& response);
             bool executeHardwareTest() const;
             bool getHardwareTestResults(string& testResults) const;
 
@@ -118,6 +139,9 @@ namespace WPEFramework {
             void getDeviceInfo(JsonObject &params);
 
             Utils::ThreadRAII m_resetThread;
+            IarmEventQueue m_iarmEvents;
+            bool m_cleanJournalEnabled;
+            CleanJournal m_cleanJournal;
 
 #ifdef HAS_FRONT_PANEL
             Core::TimerType<LedInfo> m_ledTimer;
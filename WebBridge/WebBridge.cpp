@@ -63,6 +63,7 @@ namespace Plugin {
         _callsign = service->Callsign();
         _service = service;
         _timeOut = (config.TimeOut.Value() * Core::Time::TicksPerMillisecond);
+        _maxInFlight = config.MaxInFlight.Value();
 
         // On success return empty, to indicate there is no error text.
         return (message);
@@ -145,19 +146,39 @@ namespace Plugin {
         case state::STATE_CUSTOM:
             // Let's on behalf of the request forward it and update 
             uint32_t newId = Core::InterlockedIncrement(_sequenceId);
-            Core::Time waitTill = Core::Time::Now() + _timeOut;
-
-            _pendingRequests.emplace(std::piecewise_construct,
-                std::forward_as_tuple(newId),
-                std::forward_as_tuple(channelId, message->Id.Value(), waitTill));
+            uint32_t requestId = message->Id.Value();
 
             message->Id = newId;
             message->Parameters = inbound.Parameters;
             message->Designator = inbound.Designator;
 
-            TRACE(Trace::Information, (_T("Request: [%d] from [%d], method: [%s]"), message->Id.Value(), channelId, method.c_str()));
+            _adminLock.Lock();
+
+            // Taken under the lock, so that the expiry list stays sorted
+            Core::Time waitTill = Core::Time::Now() + _timeOut;
+            ExpiryList::iterator expiry = _expiries.insert(_expiries.end(), newId);
+            Request& request = _pendingRequests.emplace(std::piecewise_construct,
+                std::forward_as_tuple(newId),
+                std::forward_as_tuple(channelId, requestId, waitTill, expiry)).first->second;
+
+            // Keep a busy channel from flooding the service, the remainder waits for a response to come in.
+            Channel& channel = _channels[channelId];
+            bool forward = ((_maxInFlight == 0) || (channel.InFlight < _maxInFlight));
+            if (forward == true) {
+                channel.InFlight++;
+                request.Forwarded(true);
+            }
+            else {
+                channel.Waiting.push_back(message);
+            }
+
+            _adminLock.Unlock();
+
+            TRACE(Trace::Information, (_T("Request: [%d] from [%d], method: [%s]%s"), newId, channelId, method.c_str(), (forward ? _T("") : _T(", queued"))));
 
-            _service->Submit(_javascriptService, Core::ProxyType<Core::JSON::IElement>(message));
+            if (forward == true) {
+                _service->Submit(_javascriptService, Core::ProxyType<Core::JSON::IElement>(message));
+            }
 
             // Wait for ID to return, we can not report anything back yet...
             message.Release();
@@ -223,6 +244,7 @@ namespace Plugin {
             }
             else {
                 uint32_t requestId, channelId = 0;
+                MessageList forward;
 
                 // This is the response to an invoked method, Let's see who should get this repsonse :-)
                 _adminLock.Lock();
@@ -230,10 +252,14 @@ namespace Plugin {
                 if (index != _pendingRequests.end()) {
                     channelId = index->second.ChannelId();
                     requestId = index->second.SequenceId();
-                    _pendingRequests.erase(index);
+                    Complete(index, forward);
                 }
                 _adminLock.Unlock();
 
+                for (Core::ProxyType<Core::JSONRPC::Message>& next : forward) {
+                    _service->Submit(_javascriptService, Core::ProxyType<Core::JSON::IElement>(next));
+                }
+
                 if (channelId != 0) {
                     TRACE(Trace::Information, (_T("Response: [%d] to [%d]"), requestId, channelId));
 
@@ -253,38 +279,81 @@ namespace Plugin {
     // -------------------------------------------------------------------------------------------------------
     void WebBridge::Cleanup() {
         // Lets see if there are still any pending request we should report Missing In Action :-)
+        // All requests have the same timeout, so the oldest ones are at the front of the expiry list and
+        // there is no need to look any further than the first one that is still in time.
         Core::Time now (Core::Time::Now());
         Core::Time nextSlot;
+        MessageList forward;
 
         _adminLock.Lock();
-        PendingMap::iterator index(_pendingRequests.begin());
-        while (index != _pendingRequests.end()) {
-            if (now >= index->second.Issued()) {
-                // Send and Error to the requester..
-                Core::ProxyType<Core::JSONRPC::Message> message(PluginHost::IFactories::Instance().JSONRPC());
-                message->Error.SetError(Core::ERROR_TIMEDOUT);
-                message->Error.Text = _T("There is no response form the server within time!!!");
-                message->Id = index->second.SequenceId();
-
-                TRACE(Trace::Warning, (_T("Got a timeout on channelId [%d] for request [%d]"), index->second.ChannelId(), message->Id.Value()));
-
-                _service->Submit(index->second.ChannelId(), Core::ProxyType<Core::JSON::IElement>(message));
-                index = _pendingRequests.erase(index);
-            }
-            else {
-                if ((nextSlot.IsValid() == false) || (nextSlot > index->second.Issued())) {
-                    nextSlot = index->second.Issued();
-                }
-                index++;
+        while (_expiries.empty() == false) {
+            PendingMap::iterator index(_pendingRequests.find(_expiries.front()));
+            ASSERT(index != _pendingRequests.end());
+
+            if (now < index->second.Issued()) {
+                nextSlot = index->second.Issued();
+                break;
             }
+
+            // Send and Error to the requester..
+            Core::ProxyType<Core::JSONRPC::Message> message(PluginHost::IFactories::Instance().JSONRPC());
+            message->Error.SetError(Core::ERROR_TIMEDOUT);
+            message->Error.Text = _T("There is no response form the server within time!!!");
+            message->Id = index->second.SequenceId();
+
+            TRACE(Trace::Warning, (_T("Got a timeout on channelId [%d] for request [%d]"), index->second.ChannelId(), message->Id.Value()));
+
+            _service->Submit(index->second.ChannelId(), Core::ProxyType<Core::JSON::IElement>(message));
+            Complete(index, forward);
         }
         _adminLock.Unlock();
 
+        for (Core::ProxyType<Core::JSONRPC::Message>& next : forward) {
+            _service->Submit(_javascriptService, Core::ProxyType<Core::JSON::IElement>(next));
+        }
+
         if (nextSlot.IsValid()) {
             _cleaner.Schedule(nextSlot);
         }
     }
 
+    // Called with the _adminLock taken. Requests of the channel that can go to the service now are added to forward.
+    void WebBridge::Complete(PendingMap::iterator& index, MessageList& forward) {
+        const uint32_t sequenceId = index->first;
+        ChannelMap::iterator channel(_channels.find(index->second.ChannelId()));
+
+        ASSERT(channel != _channels.end());
+
+        if (index->second.Forwarded() == true) {
+            channel->second.InFlight--;
+        }
+        else {
+            // Timed out before it was forwarded
+            channel->second.Waiting.remove_if([sequenceId](const Core::ProxyType<Core::JSONRPC::Message>& entry) {
+                return (entry->Id.Value() == sequenceId);
+            });
+        }
+
+        _expiries.erase(index->second.Expiry());
+        _pendingRequests.erase(index);
+
+        while ((channel->second.Waiting.empty() == false) && ((_maxInFlight == 0) || (channel->second.InFlight < _maxInFlight))) {
+            Core::ProxyType<Core::JSONRPC::Message> next(channel->second.Waiting.front());
+            channel->second.Waiting.pop_front();
+
+            PendingMap::iterator waiting(_pendingRequests.find(next->Id.Value()));
+            ASSERT(waiting != _pendingRequests.end());
+            waiting->second.Forwarded(true);
+            channel->second.InFlight++;
+
+            forward.push_back(next);
+        }
+
+        if ((channel->second.InFlight == 0) && (channel->second.Waiting.empty() == true)) {
+            _channels.erase(channel);
+        }
+    }
+
     bool WebBridge::InternalMessage(const Core::ProxyType<Core::JSONRPC::Message>& message) {
         bool result = false;
 
@@ -21,6 +21,8 @@
 
 #include "Module.h"
 
+#include <unordered_map>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -75,16 +77,20 @@ namespace Plugin {
             uint32_t _id;
             string _designator;
         };
+        using ExpiryList = std::list<uint32_t>;
+
         class Request {
         public:
             Request() = delete;
             Request(const Request&) = delete;
             Request& operator=(const Request&) = delete;
 
-            Request(const uint32_t channelId, const uint32_t sequenceId, const Core::Time& timeOut)
+            Request(const uint32_t channelId, const uint32_t sequenceId, const Core::Time& timeOut, const ExpiryList::iterator& expiry)
                 : _channelId(channelId)
                 , _sequenceId(sequenceId)
-                , _issued(timeOut) {
+                , _issued(timeOut)
+                , _expiry(expiry)
+                , _forwarded(false) {
             }
             ~Request() = default;
 
@@ -98,11 +104,38 @@ namespace Plugin {
             const Core::Time& Issued() const {
                 return (_issued);
             }
+            const ExpiryList::iterator& Expiry() const {
+                return (_expiry);
+            }
+            bool Forwarded() const {
+                return (_forwarded);
+            }
+            void Forwarded(const bool forwarded) {
+                _forwarded = forwarded;
+            }
 
         private:
             uint32_t _channelId;
             uint32_t _sequenceId;
             Core::Time _issued;
+            ExpiryList::iterator _expiry;
+            bool _forwarded;
+        };
+        // Requests of one channel that are with the JavaScript service, and the ones waiting for a free slot
+        class Channel {
+        public:
+            Channel(const Channel&) = delete;
+            Channel& operator=(const Channel&) = delete;
+
+            Channel()
+                : InFlight(0)
+                , Waiting() {
+            }
+            ~Channel() = default;
+
+        public:
+            uint32_t InFlight;
+            std::list< Core::ProxyType<Core::JSONRPC::Message> > Waiting;
         };
         class Cleaner  {
         private:
@@ -129,7 +162,9 @@ namespace Plugin {
         using ObserverMap = std::map<string, ObserverList>;
         using MethodList = std::vector<string>;
         using VersionMap = std::map<uint8_t, MethodList>;
-        using PendingMap = std::map<uint32_t, Request>;
+        using PendingMap = std::unordered_map<uint32_t, Request>;
+        using ChannelMap = std::unordered_map<uint32_t, Channel>;
+        using MessageList = std::list< Core::ProxyType<Core::JSONRPC::Message> >;
 
     public:
         class Config : public Core::JSON::Container {
@@ -137,14 +172,17 @@ namespace Plugin {
             Config()
                 : Core::JSON::Container()
                 , TimeOut(3000)
+                , MaxInFlight(16)
             {
                 Add(_T("timeout"), &TimeOut);
+                Add(_T("maxinflight"), &MaxInFlight);
             }
             ~Config() override = default;
 
         public:
             Core::JSON::String Bind;
             Core::JSON::DecUInt16 TimeOut;
+            Core::JSON::DecUInt16 MaxInFlight; // Requests per channel forwarded at once, 0 is no limit
         };
 
     public:
@@ -162,9 +200,12 @@ namespace Plugin {
             , _supportedVersions()
             , _observers()
             , _pendingRequests()
+            , _expiries()
+            , _channels()
             , _javascriptService(0)
             , _sequenceId(1)
             , _timeOut(0)
+            , _maxInFlight(0)
             , _cleaner(*this)
         {
         }
@@ -216,6 +257,7 @@ namespace Plugin {
 
     private:
         void Cleanup();
+        void Complete(PendingMap::iterator& index, MessageList& forward);
         bool InternalMessage(const Core::ProxyType<Core::JSONRPC::Message>& message);
 
         bool HasMethodSupport(const VersionMap::const_iterator& index, const string& method) const {
@@ -339,9 +381,12 @@ namespace Plugin {
         VersionMap _supportedVersions;
         ObserverMap _observers;
         PendingMap _pendingRequests;
+        ExpiryList _expiries; // Sequence ids in the order they time out, all requests share one timeout
+        ChannelMap _channels;
         uint32_t _javascriptService;
         uint32_t _sequenceId;
         uint32_t _timeOut;
+        uint16_t _maxInFlight;
         Core::WorkerPool::JobType<Cleaner> _cleaner;
     };
 
@@ -67,7 +67,8 @@ void UnloadJSBindings(WKBundleFrameRef frame) {
     if (WKBundleFrameIsMainFrame(frame)) {
         JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(frame);
         JSObjectRef global = JSContextGetGlobalObject(context);
-        JSStringRef aampStr = JSStringCreateWithUTF8CString("AAMP");
+        // Created once, it is not bound to the context of the frame
+        static JSStringRef aampStr = JSStringCreateWithUTF8CString("AAMP");
         if (JSObjectHasProperty(context, global, aampStr))
             aamp_UnloadJSController(context);
     }
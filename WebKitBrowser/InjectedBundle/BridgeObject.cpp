@@ -21,8 +21,11 @@
 
 #include "Utils.h"
 
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <glib.h>
 
@@ -68,14 +71,27 @@ window.addEventListener('load', (event) => {
 });
 )jssrc";
 
+// Names used for every message, created once. JSStrings do not belong to a context.
+static JSStringRef CachedString(const char name[])
+{
+  static std::map<std::string, JSStringRef> strings;
+  auto index = strings.find(name);
+  if (index == strings.end())
+    index = strings.emplace(name, JSStringCreateWithUTF8CString(name)).first;
+  return index->second;
+}
+
 static std::string JSStringToString(JSStringRef str)
 {
   if (!str)
     return string();
+  // Short strings are converted on the stack, without a heap buffer in between.
+  char local[256];
   size_t len = JSStringGetMaximumUTF8CStringSize(str);
-  std::unique_ptr<char[]> buffer(new char[len]);
-  len = JSStringGetUTF8CString(str, buffer.get(), len);
-  return Core::ToString(buffer.get(), len);
+  std::unique_ptr<char[]> buffer(len > sizeof(local) ? new char[len] : nullptr);
+  char* target = (buffer ? buffer.get() : local);
+  len = JSStringGetUTF8CString(str, target, len);
+  return Core::ToString(target, len > 0 ? len - 1 : 0);
 }
 
 static void LogException(JSContextRef ctx, JSValueRef exception)
@@ -92,19 +108,46 @@ static JSValueRef OnBridgeQuery(
     const JSValueRef arguments[], JSValueRef*)
 {
     if (argumentCount > 0 && JSValueIsString(context, arguments[0])) {
-        WKStringRef messageName = WKStringCreateWithUTF8CString(Tags::BridgeObjectQuery);
         JSStringRef jsString = JSValueToStringCopy(context, arguments[0], nullptr);
         WKStringRef messageBody = WKStringCreateWithJSString(jsString);
         JSStringRelease(jsString);
 
-        WKBundlePostSynchronousMessage(g_Bundle, messageName, messageBody, nullptr);
+        // The reply comes back as its own message, nothing to wait for.
+        WebKit::Utils::PostMessage(Tags::BridgeObjectQuery, messageBody);
         WKRelease(messageBody);
-        WKRelease(messageName);
     }
     return JSValueMakeNull(context);
 }
 
-static void CallBridge(WKBundlePageRef page, const char* scriptSrc, WKTypeRef payload)
+static JSObjectRef MakeBridgeFunction(JSContextRef context, const char* scriptSrc, JSValueRef* exception)
+{
+    JSStringRef scriptStr = JSStringCreateWithUTF8CString(scriptSrc);
+    JSStringRef paramNameStr = CachedString("payload");
+    JSObjectRef fun = JSObjectMakeFunction(context, nullptr, 1, &paramNameStr, scriptStr, nullptr, 1, exception);
+    JSStringRelease(scriptStr);
+    return fun;
+}
+
+// The functions are compiled once per window object by InjectJS and kept on window.ServiceManager.
+// Only when the page replaced that object they are compiled for the message.
+static JSObjectRef GetBridgeFunction(JSContextRef context, const char* name, const char* scriptSrc, JSValueRef* exception)
+{
+    JSObjectRef windowObject = JSContextGetGlobalObject(context);
+    JSValueRef smValue = JSObjectGetProperty(context, windowObject, CachedString("ServiceManager"), nullptr);
+
+    if (smValue && JSValueIsObject(context, smValue)) {
+        JSValueRef funValue = JSObjectGetProperty(context, JSValueToObject(context, smValue, nullptr), CachedString(name), nullptr);
+        if (funValue && JSValueIsObject(context, funValue)) {
+            JSObjectRef fun = JSValueToObject(context, funValue, nullptr);
+            if (JSObjectIsFunction(context, fun))
+                return fun;
+        }
+    }
+
+    return MakeBridgeFunction(context, scriptSrc, exception);
+}
+
+static void CallBridge(WKBundlePageRef page, const char* name, const char* scriptSrc, WKTypeRef payload)
 {
     if (WKGetTypeID(payload) != WKStringGetTypeID()) {
         TRACE_GLOBAL(Trace::Error, (_T("Message body must be string!")));
@@ -114,11 +157,7 @@ static void CallBridge(WKBundlePageRef page, const char* scriptSrc, WKTypeRef pa
     JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(WKBundlePageGetMainFrame(page));
     JSValueRef exception = nullptr;
 
-    JSStringRef scriptStr = JSStringCreateWithUTF8CString(scriptSrc);
-    JSStringRef paramNameStr = JSStringCreateWithUTF8CString("payload");
-    JSObjectRef fun = JSObjectMakeFunction(context, nullptr, 1, &paramNameStr, scriptStr, nullptr, 1, &exception);
-    JSStringRelease(scriptStr);
-    JSStringRelease(paramNameStr);
+    JSObjectRef fun = GetBridgeFunction(context, name, scriptSrc, &exception);
     if (exception) {
         LogException(context, exception);
         return;
@@ -162,25 +201,75 @@ struct PatternSpec
     GPatternSpec* _spec {nullptr};
 };
 
+// The injectfor patterns, compiled once when the config arrives. Most of them are either a plain URL
+// or a URL prefix followed by a single '*', those are matched without GPatternSpec: the plain ones
+// by hash, the prefixes by a binary search in a sorted set where no prefix is a prefix of another.
+// Only the remaining globs are matched one by one.
+class BadgerMatcher
+{
+public:
+    void Add(const std::string& pattern)
+    {
+        const size_t wildcard = pattern.find_first_of("*?");
+
+        _patterns.push_back(pattern);
+
+        if (wildcard == std::string::npos) {
+            _exact.insert(pattern);
+        } else if ((wildcard == pattern.length() - 1) && (pattern[wildcard] == '*')) {
+            _prefixes.push_back(pattern.substr(0, wildcard));
+        } else {
+            _globs.emplace_back(pattern);
+        }
+    }
+    // Call once all patterns are added.
+    void Compile()
+    {
+        std::sort(_prefixes.begin(), _prefixes.end());
+
+        // A prefix makes all the longer ones starting with it redundant, they sort right after it.
+        std::vector<std::string> kept;
+        for (const auto& prefix : _prefixes) {
+            if (kept.empty() || (prefix.compare(0, kept.back().length(), kept.back()) != 0))
+                kept.push_back(prefix);
+        }
+        _prefixes.swap(kept);
+    }
+    bool Match(const std::string& url) const
+    {
+        if (_exact.find(url) != _exact.end())
+            return true;
+
+        if (!_prefixes.empty()) {
+            // Only the greatest prefix not above the url can match.
+            auto index = std::upper_bound(_prefixes.begin(), _prefixes.end(), url);
+            if ((index != _prefixes.begin()) && (url.compare(0, (index - 1)->length(), *(index - 1)) == 0))
+                return true;
+        }
+
+        for (const auto& p : _globs) {
+            if (g_pattern_match(p._spec, url.length(), url.c_str(), nullptr))
+                return true;
+        }
+        return false;
+    }
+    const std::vector<std::string>& Patterns() const
+    {
+        return _patterns;
+    }
+
+private:
+    std::vector<std::string> _patterns;
+    std::unordered_set<std::string> _exact;
+    std::vector<std::string> _prefixes;
+    std::vector<PatternSpec> _globs;
+};
+
 static std::string g_badgerScriptUrl;
-static std::vector<PatternSpec> g_injectBadgerFor;
+static BadgerMatcher g_injectBadgerFor;
 
 void Initialize()
 {
-    auto requestConfig = []() -> std::string
-    {
-        std::string utf8MessageName(std::string(Tags::Config) + "badger");
-        WKStringRef jsMessageName = WKStringCreateWithUTF8CString(utf8MessageName.c_str());
-        WKMutableArrayRef messageBody = WKMutableArrayCreate();
-        WKTypeRef returnData;
-        WKBundlePostSynchronousMessage(WebKit::Utils::GetBundle(), jsMessageName, messageBody, &returnData);
-        std::string json (WebKit::Utils::WKStringToString(static_cast<WKStringRef>(returnData)));
-        WKRelease(returnData);
-        WKRelease(messageBody);
-        WKRelease(jsMessageName);
-        return json;
-    };
-
     auto parseConfig = [](const string& json)
     {
         struct BadgerConfig : public Core::JSON::Container
@@ -210,16 +299,17 @@ void Initialize()
             if (!it.IsValid())
                 continue;
             const auto &data  = it.Current();
-            g_injectBadgerFor.push_back(data.Value());
+            g_injectBadgerFor.Add(data.Value());
         }
+        g_injectBadgerFor.Compile();
         return true;
     };
 
-    std::string json = requestConfig();
+    std::string json = WebKit::Utils::GetConfig("badger");
     if (parseConfig(json)) {
         SYSLOG(Trace::Information, (_T("Configured $badger script url: '%s'\n"), g_badgerScriptUrl.c_str()));
-        for (const auto& p : g_injectBadgerFor) {
-            SYSLOG(Trace::Information, (_T("Enable $badger script injection for: '%s'\n"), p._text.c_str()));
+        for (const auto& p : g_injectBadgerFor.Patterns()) {
+            SYSLOG(Trace::Information, (_T("Enable $badger script injection for: '%s'\n"), p.c_str()));
         }
     }
 }
@@ -239,25 +329,38 @@ void InjectJS(WKBundleFrameRef frame)
         return;
     }
 
-    JSStringRef serviceManagerStr = JSStringCreateWithUTF8CString("ServiceManager");
     JSObjectRef windowObject = JSContextGetGlobalObject(context);
-    JSObjectRef smObject = const_cast<JSObjectRef>(JSObjectGetProperty(context, windowObject, serviceManagerStr, &exception));
-    JSStringRelease(serviceManagerStr);
+    JSObjectRef smObject = const_cast<JSObjectRef>(JSObjectGetProperty(context, windowObject, CachedString("ServiceManager"), &exception));
     if (exception) {
         LogException(context, exception);
         return;
     }
 
-    JSStringRef bridgeQueryStr = JSStringCreateWithUTF8CString("BridgeQuery");
+    JSStringRef bridgeQueryStr = CachedString("BridgeQuery");
     JSValueRef  bridgeQueryFun = JSObjectMakeFunctionWithCallback(context, bridgeQueryStr, OnBridgeQuery);
     JSObjectSetProperty(context, smObject, bridgeQueryStr, bridgeQueryFun,
         kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete | kJSPropertyAttributeDontEnum, &exception);
-    JSStringRelease(bridgeQueryStr);
     if (exception) {
         LogException(context, exception);
         return;
     }
 
+    const std::pair<const char*, const char*> bridgeFunctions[] = {
+        { "BridgeReply", kBadgerReplySrc },
+        { "BridgeEvent", kBadgerEventSrc }
+    };
+    for (const auto& bridgeFunction : bridgeFunctions) {
+        JSObjectRef fun = MakeBridgeFunction(context, bridgeFunction.second, &exception);
+        if (!exception) {
+            JSObjectSetProperty(context, smObject, CachedString(bridgeFunction.first), fun,
+                kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete | kJSPropertyAttributeDontEnum, &exception);
+        }
+        if (exception) {
+            LogException(context, exception);
+            return;
+        }
+    }
+
     auto getProvisionalUrl = [](WKBundleFrameRef frame) {
         std::string result;
         auto frameUrl = WKBundleFrameCopyURL(frame);
@@ -270,16 +373,8 @@ void InjectJS(WKBundleFrameRef frame)
         return result;
     };
 
-    auto shouldInjectBadgerScript = [](const std::string url) {
-        for (const auto& p : g_injectBadgerFor) {
-            if (g_pattern_match_string(p._spec, url.c_str()))
-                return true;
-        }
-        return false;
-    };
-
     std::string frameUrl = getProvisionalUrl(frame);
-    if ( shouldInjectBadgerScript(frameUrl) ) {
+    if ( g_injectBadgerFor.Match(frameUrl) ) {
         SYSLOG(Trace::Information, (_T("Injecting $badger script for: '%s'\n"), frameUrl.c_str()));
 
         JSStringRef mbScriptStr = JSStringCreateWithUTF8CString(kInjectBadgerSrc);
@@ -308,11 +403,11 @@ void InjectJS(WKBundleFrameRef frame)
 bool HandleMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody)
 {
     if (WKStringIsEqualToUTF8CString(messageName, Tags::BridgeObjectReply)) {
-        CallBridge(page, kBadgerReplySrc, messageBody);
+        CallBridge(page, "BridgeReply", kBadgerReplySrc, messageBody);
         return true;
     }
     else if (WKStringIsEqualToUTF8CString(messageName, Tags::BridgeObjectEvent)) {
-        CallBridge(page, kBadgerEventSrc, messageBody);
+        CallBridge(page, "BridgeEvent", kBadgerEventSrc, messageBody);
         return true;
     }
     return false;
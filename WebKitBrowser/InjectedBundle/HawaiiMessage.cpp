@@ -37,24 +37,10 @@ namespace Amazon {
         typedef bool ( *RegisterMessageListenerType )( MessageListenerType inMessageListener );
         typedef std::string ( *SendMessageType )( const std::string& );
 
-        // Gets configuration for this handler from WPEWebKitBrowser via synchronous message.
+        // Gets configuration for this handler from the bundle configuration fetched at init.
         static std::string Configuration()
         {
-            std::string utf8MessageName(string(Tags::Config) + "hawaii");
-
-            WKStringRef jsMessageName = WKStringCreateWithUTF8CString(utf8MessageName.c_str());
-            WKMutableArrayRef messageBody = WKMutableArrayCreate();
-            WKTypeRef returnData;
-
-            WKBundlePostSynchronousMessage(WebKit::Utils::GetBundle(), jsMessageName, messageBody, &returnData);
-
-            std::string result (WebKit::Utils::WKStringToString(static_cast<WKStringRef>(returnData)));
-
-            WKRelease(returnData);
-            WKRelease(messageBody);
-            WKRelease(jsMessageName);
-
-            return result;
+            return (WebKit::Utils::GetConfig("hawaii"));
         }
         static void ListenerCallback (const std::string& msg)
         {
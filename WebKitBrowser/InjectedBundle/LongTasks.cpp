@@ -0,0 +1,85 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LongTasks.h"
+
+#include <WPE/WebKit.h>
+#include <WPE/WebKit/WKNumber.h>
+
+#include <glib.h>
+
+#include "Tags.h"
+#include "Utils.h"
+
+namespace WPEFramework {
+namespace WebKit {
+
+namespace
+{
+
+GPollFunc g_poll = nullptr;
+gint64 g_dispatchStart = 0;
+
+// Called once per main loop iteration, the time since the previous poll returned is what the
+// iteration spent dispatching. Costs two clock reads per iteration and no wakeups of its own.
+gint LongTaskPoll(GPollFD* fds, guint count, gint timeout)
+{
+    if (g_dispatchStart != 0) {
+        gint64 busy = (g_get_monotonic_time() - g_dispatchStart) / 1000;
+
+        if (busy >= LONG_TASK_THRESHOLD_MS) {
+            WKUInt64Ref duration = WKUInt64Create(busy);
+            Utils::PostMessage(Tags::LongTask, duration);
+            WKRelease(duration);
+
+            // The flush was queued after this iteration was prepared, do not sleep past it.
+            timeout = 0;
+        }
+    }
+
+    gint result = g_poll(fds, count, timeout);
+
+    g_dispatchStart = g_get_monotonic_time();
+
+    return result;
+}
+
+}
+
+void StartLongTaskMonitor()
+{
+    if (g_poll == nullptr) {
+        GMainContext* context = g_main_context_default();
+
+        g_poll = g_main_context_get_poll_func(context);
+        g_main_context_set_poll_func(context, LongTaskPoll);
+    }
+}
+
+void StopLongTaskMonitor()
+{
+    if (g_poll != nullptr) {
+        g_main_context_set_poll_func(g_main_context_default(), g_poll);
+        g_poll = nullptr;
+        g_dispatchStart = 0;
+    }
+}
+
+}  // WebKit
+}  // WPEFramework
@@ -0,0 +1,32 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+// Main loop iterations of the web process that take at least this long count as long tasks.
+#define LONG_TASK_THRESHOLD_MS 50
+
+namespace WPEFramework {
+namespace WebKit {
+
+// Reports every long task of the web process main loop to the UI process, as a batched message.
+void StartLongTaskMonitor();
+void StopLongTaskMonitor();
+
+}  // WebKit
+}  // WPEFramework
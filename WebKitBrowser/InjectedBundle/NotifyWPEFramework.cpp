@@ -38,8 +38,6 @@ namespace JavaScript {
         JSValueRef NotifyWPEFramework::HandleMessage(JSContextRef context, JSObjectRef,
             JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef*)
         {
-            WKStringRef messageName = WKStringCreateWithUTF8CString(GetMessageName().c_str());
-
             // Build message body.
             WKMutableArrayRef messageBody = WKMutableArrayCreate();
             for (unsigned int index = 0; index < argumentCount; index++) {
@@ -58,10 +56,10 @@ namespace JavaScript {
                 JSStringRelease(jsString);
             }
 
-            WKBundlePostSynchronousMessage(g_Bundle, messageName, messageBody, nullptr);
+            // Fire and forget, the page does not wait for the UI process.
+            WebKit::Utils::PostMessage(GetMessageName().c_str(), messageBody);
 
             WKRelease(messageBody);
-            WKRelease(messageName);
 
             return JSValueMakeNull(context);
         }
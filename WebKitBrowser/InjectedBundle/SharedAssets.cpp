@@ -0,0 +1,106 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SharedAssets.h"
+
+#include "Module.h"
+#include "../SharedCache.h"
+
+#include <set>
+
+#include <sys/stat.h>
+
+namespace WPEFramework {
+namespace WebKit {
+
+namespace {
+
+// us between checks whether a browser preseeded the store
+constexpr gint64 kIndexCheckInterval = 1000 * 1000;
+
+// The WebProcess main thread sends all requests, nothing to lock
+struct {
+    string index;
+    std::set<string> urls;
+    time_t modified = 0;
+    gint64 checked = 0;
+} s_assets;
+
+void RefreshSharedAssets()
+{
+    const gint64 now = g_get_monotonic_time();
+    if ((now - s_assets.checked) < kIndexCheckInterval)
+        return;
+    s_assets.checked = now;
+
+    struct stat info;
+    const time_t modified = (::stat(s_assets.index.c_str(), &info) == 0 ? info.st_mtime : 0);
+    if (modified == s_assets.modified)
+        return;
+    s_assets.modified = modified;
+
+    Plugin::SharedCache::Index index;
+    s_assets.urls.clear();
+    if (index.Load(s_assets.index) == true) {
+        Core::JSON::ArrayType<Plugin::SharedCache::Asset>::ConstIterator asset(static_cast<const Plugin::SharedCache::Index&>(index).Assets.Elements());
+        while (asset.Next() == true) {
+            s_assets.urls.insert(asset.Current().URL.Value());
+        }
+    }
+}
+
+}  // namespace
+
+void SetSharedAssets(const char* path)
+{
+    s_assets.index.clear();
+    if (path != nullptr) {
+        s_assets.index = path;
+        if ((s_assets.index.empty() == false) && (s_assets.index.back() != '/'))
+            s_assets.index += '/';
+        s_assets.index += SHARED_CACHE_INDEX;
+    }
+    s_assets.urls.clear();
+    s_assets.modified = 0;
+    s_assets.checked = 0;
+}
+
+void ApplySharedAssets(WebKitURIRequest* request)
+{
+    if (s_assets.index.empty() == true)
+        return;
+
+    RefreshSharedAssets();
+
+    const string uri(webkit_uri_request_get_uri(request));
+    const string cached(Plugin::SharedCache::ToCache(uri));
+
+    if (cached.empty() == false) {
+        if (s_assets.urls.find(uri) != s_assets.urls.end())
+            webkit_uri_request_set_uri(request, cached.c_str());
+    } else {
+        // Relative to an asset of the store, but not in it
+        const string original(Plugin::SharedCache::FromCache(uri));
+        if ((original.empty() == false) && (s_assets.urls.find(original) == s_assets.urls.end()))
+            webkit_uri_request_set_uri(request, original.c_str());
+    }
+}
+
+}  // WebKit
+}  // WPEFramework
@@ -30,6 +30,8 @@ extern const char* const BridgeObjectQuery;
 extern const char* const BridgeObjectReply;
 extern const char* const BridgeObjectEvent;
 extern const char* const Headers;
+extern const char* const MessageBatch;
+extern const char* const LongTask;
 
 } } ;
 
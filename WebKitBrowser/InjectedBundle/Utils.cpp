@@ -18,6 +18,10 @@
  */
  
 #include "Utils.h"
+#include "Tags.h"
+
+#include <glib.h>
+#include <map>
 
 using std::unique_ptr;
 using std::vector;
@@ -26,6 +30,12 @@ namespace WPEFramework {
 namespace WebKit {
     namespace Utils {
 
+        // Only touched from the main thread of the web process.
+        static WKMutableArrayRef g_messages = nullptr;
+        static guint g_flushSource = 0;
+        static bool g_configLoaded = false;
+        static std::map<string, string> g_configs;
+
         // Adds string to WKMutableArray.
         void AppendStringToWKArray(const string& item, WKMutableArrayRef array)
         {
@@ -63,6 +73,76 @@ namespace WebKit {
 
             return stringVector;
         }
+
+        void PostMessage(const char* name, WKTypeRef body)
+        {
+            if (g_messages == nullptr) {
+                g_messages = WKMutableArrayCreate();
+            }
+
+            WKMutableArrayRef entry = WKMutableArrayCreate();
+            WKStringRef entryName = WKStringCreateWithUTF8CString(name);
+            WKArrayAppendItem(entry, entryName);
+            WKArrayAppendItem(entry, body);
+            WKArrayAppendItem(g_messages, entry);
+            WKRelease(entryName);
+            WKRelease(entry);
+
+            if (g_flushSource == 0) {
+                g_flushSource = g_idle_add_full(G_PRIORITY_DEFAULT,
+                    [](gpointer) -> gboolean {
+                        g_flushSource = 0;
+                        FlushMessages();
+                        return G_SOURCE_REMOVE;
+                    },
+                    nullptr, nullptr);
+            }
+        }
+
+        void FlushMessages()
+        {
+            if (g_messages != nullptr) {
+                WKStringRef batchName = WKStringCreateWithUTF8CString(Tags::MessageBatch);
+                WKBundlePostMessage(GetBundle(), batchName, g_messages);
+                WKRelease(batchName);
+                WKRelease(g_messages);
+                g_messages = nullptr;
+            }
+        }
+
+        string GetConfig(const string& key)
+        {
+            if (g_configLoaded == false) {
+                g_configLoaded = true;
+
+                FlushMessages();
+
+                // The bare tag asks for all keys, answered as key, value, key, value...
+                WKStringRef messageName = WKStringCreateWithUTF8CString(Tags::Config);
+                WKMutableArrayRef messageBody = WKMutableArrayCreate();
+                WKTypeRef returnData = nullptr;
+
+                WKBundlePostSynchronousMessage(GetBundle(), messageName, messageBody, &returnData);
+
+                if (returnData != nullptr) {
+                    if (WKGetTypeID(returnData) == WKArrayGetTypeID()) {
+                        WKArrayRef configs = static_cast<WKArrayRef>(returnData);
+                        size_t count = WKArrayGetSize(configs);
+
+                        for (unsigned int index = 0; (index + 1) < count; index += 2) {
+                            g_configs[GetStringFromWKArray(configs, index)] = GetStringFromWKArray(configs, index + 1);
+                        }
+                    }
+                    WKRelease(returnData);
+                }
+
+                WKRelease(messageBody);
+                WKRelease(messageName);
+            }
+
+            std::map<string, string>::const_iterator index(g_configs.find(key));
+            return (index != g_configs.end() ? index->second : string());
+        }
     }
 }
 }
@@ -36,6 +36,14 @@ namespace WebKit {
         WKBundleRef GetBundle();
         string WKStringToString(WKStringRef wkStringRef);
         std::vector<string> ConvertWKArrayToStringVector(WKArrayRef array);
+
+        // Queues a message for the UI process. The queue goes out as one asynchronous message, in
+        // order, when the script that posted returns to the main loop.
+        void PostMessage(const char* name, WKTypeRef body);
+        // Sends the queued messages right away, a synchronous message must not overtake them.
+        void FlushMessages();
+        // Bundle configuration for the key, all of it is fetched with one synchronous message on first use.
+        string GetConfig(const string& key);
     };
 }
 }
@@ -24,6 +24,8 @@
 #include "Tags.h"
 #endif
 
+#include <algorithm>
+
 using std::unique_ptr;
 using std::vector;
 
@@ -86,39 +88,27 @@ namespace WebKit {
                 bool subDomain(originIndex.Current().SubDomain.Value());
 
                 while (domainIndex.Next()) {
-                    domains.emplace_back(subDomain, domainIndex.Current().Value());
+                    // WebKit walks its list for the origin on every cross origin check, keep duplicates out of it.
+                    WhiteListedOriginDomainsList::Domain domain(subDomain, domainIndex.Current().Value());
+                    if (std::find(domains.begin(), domains.end(), domain) == domains.end()) {
+                        domains.push_back(std::move(domain));
+                    }
                 }
             }
         }
     }
 
-    // Gets white list from WPEFramework via synchronous message.
+    // Gets white list from the bundle configuration of WPEFramework.
     /* static */unique_ptr<WhiteListedOriginDomainsList> WhiteListedOriginDomainsList::RequestFromWPEFramework(const char* whitelist)
     {
 #ifdef WEBKIT_GLIB_API
         unique_ptr<WhiteListedOriginDomainsList> whiteList(new WhiteListedOriginDomainsList());
         ParseWhiteList(whitelist, whiteList->_whiteMap);
 #else
-        string messageName(string(Tags::Config) + "Whitelist");
-        std::string utf8MessageName = Core::ToString(messageName.c_str());
-
-        WKStringRef jsMessageName = WKStringCreateWithUTF8CString(utf8MessageName.c_str());
-        WKMutableArrayRef messageBody = WKMutableArrayCreate();
-        WKTypeRef returnData;
-
-        WKBundlePostSynchronousMessage(WebKit::Utils::GetBundle(), jsMessageName, messageBody, &returnData);
-
-        WKStringRef returnedString = static_cast<WKStringRef>(returnData);
-
-        string jsonString = WebKit::Utils::WKStringToString(returnedString);
+        string jsonString = WebKit::Utils::GetConfig("Whitelist");
 
         unique_ptr<WhiteListedOriginDomainsList> whiteList(new WhiteListedOriginDomainsList());
         ParseWhiteList(jsonString, whiteList->_whiteMap);
-
-        WKRelease(returnData);
-        WKRelease(messageBody);
-        WKRelease(jsMessageName);
-
 #endif
         return whiteList;
     }
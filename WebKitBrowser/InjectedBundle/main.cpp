@@ -27,6 +27,7 @@
 
 #include <wpe/webkit-web-extension.h>
 #include "../BrowserConsoleLog.h"
+#include "SharedAssets.h"
 
 using namespace WPEFramework;
 
@@ -46,6 +47,7 @@ using namespace WPEFramework;
 #include "Utils.h"
 #include "WhiteListedOriginDomainsList.h"
 #include "RequestHeaders.h"
+#include "LongTasks.h"
 
 #if defined(ENABLE_BADGER_BRIDGE)
 #include "BridgeObject.h"
@@ -123,14 +125,19 @@ public:
         const char *uid;
         const char *whitelist;
         gboolean logToSystemConsoleEnabled;
-        g_variant_get((GVariant*) userData, "(&sm&sb)", &uid, &whitelist, &logToSystemConsoleEnabled);
+        const char *sharedCache;
+        g_variant_get((GVariant*) userData, "(&sm&sbm&s)", &uid, &whitelist, &logToSystemConsoleEnabled, &sharedCache);
 
         _scriptWorld = webkit_script_world_new_with_name(uid);
 
         g_signal_connect(_scriptWorld, "window-object-cleared",
                 G_CALLBACK(windowObjectClearedCallback), nullptr);
 
-        if (logToSystemConsoleEnabled == TRUE) {
+        _logToSystemConsoleEnabled = (logToSystemConsoleEnabled == TRUE);
+        _sharedCacheEnabled = (sharedCache != nullptr);
+        WebKit::SetSharedAssets(sharedCache);
+
+        if ((_logToSystemConsoleEnabled == true) || (_sharedCacheEnabled == true)) {
             g_signal_connect(bundle, "page-created", G_CALLBACK(pageCreatedCallback), this);
         }
 
@@ -141,7 +148,9 @@ public:
             WhiteList(bundle);
         }
 #else
+        // The first request fetches the whole bundle configuration, later ones are served locally.
         _whiteListedOriginDomainPairs = WhiteListedOriginDomainsList::RequestFromWPEFramework();
+        WebKit::StartLongTaskMonitor();
         #if defined(ENABLE_BADGER_BRIDGE)
         JavaScript::BridgeObject::Initialize();
         #endif
@@ -157,6 +166,8 @@ public:
 #ifdef WEBKIT_GLIB_API
         g_object_unref(_scriptWorld);
         g_object_unref(_bundle);
+#else
+        WebKit::StopLongTaskMonitor();
 #endif
         Core::Singleton::Dispose();
     }
@@ -208,8 +219,19 @@ private:
     }
     static void pageCreatedCallback(WebKitWebExtension*, WebKitWebPage* page, PluginHost* host)
     {
-        g_signal_connect(page, "console-message-sent",
-                G_CALLBACK(consoleMessageSentCallback), nullptr);
+        if (host->_logToSystemConsoleEnabled == true) {
+            g_signal_connect(page, "console-message-sent",
+                    G_CALLBACK(consoleMessageSentCallback), nullptr);
+        }
+        if (host->_sharedCacheEnabled == true) {
+            g_signal_connect(page, "send-request",
+                    G_CALLBACK(sendRequestCallback), nullptr);
+        }
+    }
+    static gboolean sendRequestCallback(WebKitWebPage*, WebKitURIRequest* request, WebKitURIResponse*)
+    {
+        WebKit::ApplySharedAssets(request);
+        return FALSE;
     }
     static void consoleMessageSentCallback(WebKitWebPage* page, WebKitConsoleMessage* message)
     {
@@ -221,6 +243,8 @@ private:
 
     WKBundleRef _bundle;
     WebKitScriptWorld* _scriptWorld;
+    bool _logToSystemConsoleEnabled = false;
+    bool _sharedCacheEnabled = false;
 
 #endif
 
@@ -0,0 +1,172 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MemoryPolicy.h"
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    MemoryPolicy::MemoryPolicy(const Config& config, Exchange::IMemory* memory, Exchange::IWebBrowser* browser, Exchange::IApplication* application)
+        : _budget(config.Budget.Value())
+        , _threshold(std::min(std::max(config.Threshold.Value(), static_cast<uint8_t>(1)), static_cast<uint8_t>(100)))
+        , _interval(std::max(config.Interval.Value(), static_cast<uint16_t>(1)))
+        , _grace(config.Grace.Value())
+        , _sustained(config.Sustained.Value())
+        , _memory(memory)
+        , _browser(browser)
+        , _application(application)
+        , _adminLock()
+        , _stage(IDLE)
+        , _since(0)
+        , _resident(0)
+        , _peak(0)
+        , _checks(0)
+        , _episodes(0)
+        , _collections(0)
+        , _flushes(0)
+        , _suspensions(0)
+        , _worker(*this)
+    {
+        ASSERT(_memory != nullptr);
+        ASSERT(_browser != nullptr);
+        ASSERT(_application != nullptr);
+
+        _memory->AddRef();
+        _browser->AddRef();
+        _application->AddRef();
+
+        if (_budget != 0) {
+            SYSLOG(Logging::Notification, (_T("Memory policy: budget %u KB, collecting at %u%%"), _budget, _threshold));
+            _worker.Schedule(Core::Time::Now().Add(_interval * 1000));
+        }
+    }
+
+    MemoryPolicy::~MemoryPolicy()
+    {
+        _worker.Revoke();
+
+        _application->Release();
+        _browser->Release();
+        _memory->Release();
+    }
+
+    void MemoryPolicy::Get(Counters& counters) const
+    {
+        _adminLock.Lock();
+
+        counters.Budget = _budget;
+        counters.Resident = _resident;
+        counters.Peak = _peak;
+        counters.Pressure = (_stage != IDLE);
+        counters.Checks = _checks;
+        counters.Episodes = _episodes;
+        counters.Collections = _collections;
+        counters.Flushes = _flushes;
+        counters.Suspensions = _suspensions;
+
+        _adminLock.Unlock();
+    }
+
+    bool MemoryPolicy::IsHiddenAndResumed() const
+    {
+        bool result = false;
+
+        Exchange::IWebBrowser::VisibilityType visibility(Exchange::IWebBrowser::VisibilityType::VISIBLE);
+        if ((static_cast<const Exchange::IWebBrowser*>(_browser)->Visibility(visibility) == Core::ERROR_NONE) && (visibility == Exchange::IWebBrowser::VisibilityType::HIDDEN)) {
+
+            PluginHost::IStateControl* stateControl(_browser->QueryInterface<PluginHost::IStateControl>());
+
+            // The browser process may have crashed in the mean time.
+            if (stateControl != nullptr) {
+                result = (stateControl->State() == PluginHost::IStateControl::RESUMED);
+                stateControl->Release();
+            }
+        }
+
+        return (result);
+    }
+
+    // Only this job changes the stage, the lock keeps the counters consistent for Get.
+    void MemoryPolicy::Dispatch()
+    {
+        const uint64_t resident = _memory->Resident() / 1024;
+        const uint64_t now = Core::Time::Now().Ticks();
+        const uint64_t trigger = (static_cast<uint64_t>(_budget) * _threshold) / 100;
+        const uint64_t elapsed = (now - _since) / Core::Time::MicroSecondsPerSecond;
+
+        _adminLock.Lock();
+        _checks++;
+        _resident = resident;
+        if (resident > _peak) {
+            _peak = resident;
+        }
+        stage current(_stage);
+        _adminLock.Unlock();
+
+        if (resident >= trigger) {
+            if (current == IDLE) {
+                SYSLOG(Logging::Notification, (_T("Memory policy: %llu KB resident, collecting garbage"), static_cast<unsigned long long>(resident)));
+
+                _browser->CollectGarbage();
+
+                _adminLock.Lock();
+                _stage = COLLECTED;
+                _since = now;
+                _episodes++;
+                _collections++;
+                _adminLock.Unlock();
+            } else if ((current == COLLECTED) && (elapsed >= _grace)) {
+                SYSLOG(Logging::Notification, (_T("Memory policy: %llu KB resident after %llu s, flushing caches"), static_cast<unsigned long long>(resident), static_cast<unsigned long long>(elapsed)));
+
+                if (_application->Reset(Exchange::IApplication::CACHE) != Core::ERROR_NONE) {
+                    // Nothing to flush, the page is what is left.
+                    _browser->CollectGarbage();
+                }
+
+                _adminLock.Lock();
+                _stage = FLUSHED;
+                _flushes++;
+                _adminLock.Unlock();
+            } else if ((current == FLUSHED) && (elapsed >= _sustained) && (IsHiddenAndResumed() == true)) {
+                SYSLOG(Logging::Notification, (_T("Memory policy: %llu KB resident after %llu s, suspending the hidden page"), static_cast<unsigned long long>(resident), static_cast<unsigned long long>(elapsed)));
+
+                PluginHost::IStateControl* stateControl(_browser->QueryInterface<PluginHost::IStateControl>());
+                if (stateControl != nullptr) {
+                    stateControl->Request(PluginHost::IStateControl::SUSPEND);
+                    stateControl->Release();
+
+                    _adminLock.Lock();
+                    _stage = SUSPENDED;
+                    _suspensions++;
+                    _adminLock.Unlock();
+                }
+            }
+        } else if ((current != IDLE) && (resident < ((trigger * MEMORY_POLICY_RELEASE_PERCENT) / 100))) {
+            SYSLOG(Logging::Notification, (_T("Memory policy: %llu KB resident, pressure released"), static_cast<unsigned long long>(resident)));
+
+            _adminLock.Lock();
+            _stage = IDLE;
+            _adminLock.Unlock();
+        }
+
+        _worker.Schedule(Core::Time::Now().Add(_interval * 1000));
+    }
+}
+}
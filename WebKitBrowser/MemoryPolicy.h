@@ -0,0 +1,160 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MEMORYPOLICY_H
+#define __MEMORYPOLICY_H
+
+#include "Module.h"
+#include <interfaces/IBrowser.h>
+#include <interfaces/IApplication.h>
+#include <interfaces/IMemory.h>
+
+// Pressure ends when the resident memory drops below this percentage of the trigger level.
+#define MEMORY_POLICY_RELEASE_PERCENT 90
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // Keeps a browser instance within the memory budget configured for it. When the resident memory
+    // of the browser processes passes the threshold percentage of the budget, JavaScript garbage is
+    // collected. If that does not bring it down within the grace period, the memory caches are
+    // flushed, and if the pressure is sustained, the page is suspended, but only while it is hidden.
+    class MemoryPolicy {
+    private:
+        MemoryPolicy() = delete;
+        MemoryPolicy(const MemoryPolicy&) = delete;
+        MemoryPolicy& operator=(const MemoryPolicy&) = delete;
+
+        enum stage {
+            IDLE,
+            COLLECTED,
+            FLUSHED,
+            SUSPENDED
+        };
+
+    public:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Budget(0)
+                , Threshold(80)
+                , Interval(5)
+                , Grace(10)
+                , Sustained(30)
+            {
+                Add(_T("budget"), &Budget);
+                Add(_T("threshold"), &Threshold);
+                Add(_T("interval"), &Interval);
+                Add(_T("grace"), &Grace);
+                Add(_T("sustained"), &Sustained);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Budget;   // KB of resident memory, 0 disables the policy
+            Core::JSON::DecUInt8 Threshold; // percentage of the budget that starts the garbage collection
+            Core::JSON::DecUInt16 Interval; // seconds between two measurements
+            Core::JSON::DecUInt16 Grace;    // seconds after the garbage collection before the caches are flushed
+            Core::JSON::DecUInt16 Sustained; // seconds of pressure before a hidden page is suspended
+        };
+
+        class Counters : public Core::JSON::Container {
+        private:
+            Counters(const Counters&) = delete;
+            Counters& operator=(const Counters&) = delete;
+
+        public:
+            Counters()
+                : Core::JSON::Container()
+            {
+                Add(_T("budget"), &Budget);
+                Add(_T("resident"), &Resident);
+                Add(_T("peak"), &Peak);
+                Add(_T("pressure"), &Pressure);
+                Add(_T("checks"), &Checks);
+                Add(_T("episodes"), &Episodes);
+                Add(_T("collections"), &Collections);
+                Add(_T("flushes"), &Flushes);
+                Add(_T("suspensions"), &Suspensions);
+            }
+            ~Counters()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Budget;
+            Core::JSON::DecUInt64 Resident;
+            Core::JSON::DecUInt64 Peak;
+            Core::JSON::Boolean Pressure;
+            Core::JSON::DecUInt32 Checks;
+            Core::JSON::DecUInt32 Episodes;
+            Core::JSON::DecUInt32 Collections;
+            Core::JSON::DecUInt32 Flushes;
+            Core::JSON::DecUInt32 Suspensions;
+        };
+
+    public:
+        MemoryPolicy(const Config& config, Exchange::IMemory* memory, Exchange::IWebBrowser* browser, Exchange::IApplication* application);
+        ~MemoryPolicy();
+
+    public:
+        void Get(Counters& counters) const;
+
+    private:
+        friend Core::ThreadPool::JobType<MemoryPolicy&>;
+        void Dispatch();
+
+        bool IsHiddenAndResumed() const;
+
+    private:
+        const uint32_t _budget;
+        const uint32_t _threshold;
+        const uint32_t _interval;
+        const uint32_t _grace;
+        const uint32_t _sustained;
+
+        Exchange::IMemory* _memory;
+        Exchange::IWebBrowser* _browser;
+        Exchange::IApplication* _application;
+
+        mutable Core::CriticalSection _adminLock;
+        stage _stage;
+        uint64_t _since;
+        uint64_t _resident;
+        uint64_t _peak;
+        uint32_t _checks;
+        uint32_t _episodes;
+        uint32_t _collections;
+        uint32_t _flushes;
+        uint32_t _suspensions;
+
+        Core::WorkerPool::JobType<MemoryPolicy&> _worker;
+    };
+}
+}
+
+#endif // __MEMORYPOLICY_H
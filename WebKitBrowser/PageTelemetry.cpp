@@ -0,0 +1,186 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PageTelemetry.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "counters are shared between processes");
+
+    PageTelemetry::PageTelemetry()
+        : _counters(nullptr)
+        , _writable(false)
+        , _start(0)
+    {
+    }
+
+    PageTelemetry::~PageTelemetry()
+    {
+        Close();
+    }
+
+    bool PageTelemetry::Create(const string& location)
+    {
+        ASSERT(_counters == nullptr);
+
+        int fd = open(location.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+        if (fd >= 0) {
+            if (ftruncate(fd, sizeof(Counters)) == 0) {
+                void* memory = mmap(nullptr, sizeof(Counters), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+                if (memory != MAP_FAILED) {
+                    _counters = static_cast<Counters*>(memory);
+                    _writable = true;
+
+                    // A previous browser process may have left its figures.
+                    _counters->Navigations.store(0, std::memory_order_relaxed);
+                    _counters->TTFB.store(0, std::memory_order_relaxed);
+                    _counters->DOMContentLoaded.store(0, std::memory_order_relaxed);
+                    _counters->Load.store(0, std::memory_order_relaxed);
+                    _counters->LongTasks.store(0, std::memory_order_relaxed);
+                    _counters->LongestTask.store(0, std::memory_order_relaxed);
+                }
+            }
+            close(fd);
+        }
+
+        if (_counters == nullptr) {
+            TRACE_L1("Page telemetry not available in %s, error %d", location.c_str(), errno);
+        }
+
+        return (_counters != nullptr);
+    }
+
+    bool PageTelemetry::Open(const string& location)
+    {
+        ASSERT(_counters == nullptr);
+
+        int fd = open(location.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd >= 0) {
+            struct stat properties;
+
+            // Do not map what the browser process did not size yet.
+            if ((fstat(fd, &properties) == 0) && (properties.st_size >= static_cast<off_t>(sizeof(Counters)))) {
+                void* memory = mmap(nullptr, sizeof(Counters), PROT_READ, MAP_SHARED, fd, 0);
+
+                if (memory != MAP_FAILED) {
+                    _counters = static_cast<Counters*>(memory);
+                    _writable = false;
+                }
+            }
+            close(fd);
+        }
+
+        return (_counters != nullptr);
+    }
+
+    void PageTelemetry::Close()
+    {
+        if (_counters != nullptr) {
+            munmap(_counters, sizeof(Counters));
+            _counters = nullptr;
+        }
+    }
+
+    uint32_t PageTelemetry::Elapsed() const
+    {
+        uint32_t result = 0;
+
+        if (_start != 0) {
+            result = static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / Core::Time::TicksPerMillisecond);
+
+            // 0 reads as "not reached", a cached page can be quicker than that.
+            if (result == 0) {
+                result = 1;
+            }
+        }
+
+        return (result);
+    }
+
+    void PageTelemetry::NavigationStarted()
+    {
+        if (_writable == true) {
+            _start = Core::Time::Now().Ticks();
+
+            _counters->Navigations.fetch_add(1, std::memory_order_relaxed);
+            _counters->TTFB.store(0, std::memory_order_relaxed);
+            _counters->DOMContentLoaded.store(0, std::memory_order_relaxed);
+            _counters->Load.store(0, std::memory_order_relaxed);
+            _counters->LongTasks.store(0, std::memory_order_relaxed);
+            _counters->LongestTask.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Only the first of each kind after the start counts, redirects and reloads of parts do not.
+    void PageTelemetry::ResponseReceived()
+    {
+        if ((_writable == true) && (_counters->TTFB.load(std::memory_order_relaxed) == 0)) {
+            _counters->TTFB.store(Elapsed(), std::memory_order_relaxed);
+        }
+    }
+
+    void PageTelemetry::DocumentLoaded()
+    {
+        if ((_writable == true) && (_counters->DOMContentLoaded.load(std::memory_order_relaxed) == 0)) {
+            _counters->DOMContentLoaded.store(Elapsed(), std::memory_order_relaxed);
+        }
+    }
+
+    void PageTelemetry::LoadFinished()
+    {
+        if ((_writable == true) && (_counters->Load.load(std::memory_order_relaxed) == 0)) {
+            _counters->Load.store(Elapsed(), std::memory_order_relaxed);
+        }
+    }
+
+    void PageTelemetry::LongTask(const uint32_t duration)
+    {
+        if (_writable == true) {
+            _counters->LongTasks.fetch_add(1, std::memory_order_relaxed);
+
+            if (duration > _counters->LongestTask.load(std::memory_order_relaxed)) {
+                _counters->LongestTask.store(duration, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void PageTelemetry::Get(Data& data) const
+    {
+        if (_counters != nullptr) {
+            data.Navigations = _counters->Navigations.load(std::memory_order_relaxed);
+            data.TTFB = _counters->TTFB.load(std::memory_order_relaxed);
+            data.DOMContentLoaded = _counters->DOMContentLoaded.load(std::memory_order_relaxed);
+            data.Load = _counters->Load.load(std::memory_order_relaxed);
+            data.LongTasks = _counters->LongTasks.load(std::memory_order_relaxed);
+            data.LongestTask = _counters->LongestTask.load(std::memory_order_relaxed);
+        }
+    }
+}
+}
@@ -0,0 +1,124 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PAGETELEMETRY_H
+#define __PAGETELEMETRY_H
+
+#include "Module.h"
+
+#include <atomic>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // Performance figures of the page shown by a browser instance. The browser process keeps them in a
+    // small file it maps from the volatile path and the plugin maps the same file to read them, so they
+    // cost a few stores per navigation and no messages between the processes. Only the thread running
+    // the browser main loop writes.
+    class PageTelemetry {
+    private:
+        PageTelemetry(const PageTelemetry&) = delete;
+        PageTelemetry& operator=(const PageTelemetry&) = delete;
+
+        struct Counters {
+            std::atomic<uint32_t> Navigations;
+            std::atomic<uint32_t> TTFB;
+            std::atomic<uint32_t> DOMContentLoaded;
+            std::atomic<uint32_t> Load;
+            std::atomic<uint32_t> LongTasks;
+            std::atomic<uint32_t> LongestTask;
+        };
+
+    public:
+        class Data : public Core::JSON::Container {
+        private:
+            Data(const Data&) = delete;
+            Data& operator=(const Data&) = delete;
+
+        public:
+            Data()
+                : Core::JSON::Container()
+            {
+                Add(_T("navigations"), &Navigations);
+                Add(_T("ttfb"), &TTFB);
+                Add(_T("domcontentloaded"), &DOMContentLoaded);
+                Add(_T("load"), &Load);
+                Add(_T("fps"), &FPS);
+                Add(_T("longtasks"), &LongTasks);
+                Add(_T("longesttask"), &LongestTask);
+                Add(_T("resident"), &Resident);
+            }
+            ~Data()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Navigations;      // since the browser started
+            Core::JSON::DecUInt32 TTFB;             // ms from the navigation start to the response of the main frame
+            Core::JSON::DecUInt32 DOMContentLoaded; // ms from the navigation start, 0 if not reached (yet)
+            Core::JSON::DecUInt32 Load;             // ms from the navigation start, 0 if not reached (yet)
+            Core::JSON::DecUInt32 FPS;
+            Core::JSON::DecUInt32 LongTasks;        // of the current page
+            Core::JSON::DecUInt32 LongestTask;      // ms
+            Core::JSON::DecUInt64 Resident;         // KB, all browser processes
+        };
+
+    public:
+        PageTelemetry();
+        ~PageTelemetry();
+
+        static string Location(const PluginHost::IShell* service)
+        {
+            return (service->VolatilePath() + service->Callsign() + _T(".telemetry"));
+        }
+
+        // Browser process side, starts with cleared counters.
+        bool Create(const string& location);
+        // Plugin side, read only.
+        bool Open(const string& location);
+        void Close();
+
+        inline bool IsOpen() const
+        {
+            return (_counters != nullptr);
+        }
+
+        void NavigationStarted();
+        void ResponseReceived();
+        void DocumentLoaded();
+        void LoadFinished();
+        void LongTask(const uint32_t duration);
+
+        // Leaves FPS and Resident to the caller, those are known in the plugin already.
+        void Get(Data& data) const;
+
+    private:
+        // Milliseconds since the navigation started, 0 if it did not start.
+        uint32_t Elapsed() const;
+
+    private:
+        Counters* _counters;
+        bool _writable;
+        uint64_t _start;
+    };
+}
+}
+
+#endif // __PAGETELEMETRY_H
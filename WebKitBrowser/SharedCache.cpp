@@ -0,0 +1,348 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SharedCache.h"
+
+#include <fstream>
+#include <set>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gio/gio.h>
+#include <openssl/evp.h>
+
+// Manifests remembered as applied, the oldest are applied again when they come back
+#define SHARED_CACHE_MANIFESTS 8
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    static uint64_t ModificationTime(const string& fileName)
+    {
+        struct stat info;
+        return (::stat(fileName.c_str(), &info) == 0 ? (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ULL) + info.st_mtim.tv_nsec : 0);
+    }
+
+    SharedCache::SharedCache()
+        : _adminLock()
+        , _path()
+        , _size(0)
+        , _assets()
+        , _stamp(0)
+        , _preseed()
+        , _closing(false)
+        , _hits(0)
+        , _misses(0)
+    {
+    }
+
+    SharedCache::~SharedCache()
+    {
+        Close();
+    }
+
+    bool SharedCache::Open(const string& path, const uint32_t size)
+    {
+        ASSERT(IsOpen() == false);
+
+        string location(path);
+        if ((location.empty() == false) && (location[location.length() - 1] != '/')) {
+            location += '/';
+        }
+
+        bool result = (location.empty() == false) && (Core::Directory((location + SHARED_CACHE_OBJECTS).c_str()).CreatePath() == true);
+
+        if (result == true) {
+            _adminLock.Lock();
+            _path = location;
+            _size = size;
+            _closing = false;
+            Refresh();
+            TRACE(Trace::Information, (_T("Shared cache %s: %u assets"), _path.c_str(), static_cast<uint32_t>(_assets.size())));
+            _adminLock.Unlock();
+        } else {
+            TRACE(Trace::Error, (_T("Shared cache %s can not be created"), path.c_str()));
+        }
+        return (result);
+    }
+
+    void SharedCache::Close()
+    {
+        _closing = true;
+        if (_preseed.joinable() == true) {
+            _preseed.join();
+        }
+
+        _adminLock.Lock();
+        if (_path.empty() == false) {
+            TRACE(Trace::Information, (_T("Shared cache %s: %u hits, %u misses"), _path.c_str(), _hits, _misses));
+        }
+        _path.clear();
+        _assets.clear();
+        _stamp = 0;
+        _adminLock.Unlock();
+    }
+
+    void SharedCache::Preseed(const string& manifest)
+    {
+        if ((IsOpen() == true) && (manifest.empty() == false) && (_preseed.joinable() == false)) {
+            _preseed = std::thread(&SharedCache::Apply, this, manifest);
+        }
+    }
+
+    bool SharedCache::Lookup(const string& url, string& file, string& type, uint32_t& size)
+    {
+        bool result = false;
+
+        _adminLock.Lock();
+
+        if (_path.empty() == false) {
+            Refresh();
+
+            std::map<string, Entry>::const_iterator index(_assets.find(url));
+            if (index != _assets.end()) {
+                file = _path + SHARED_CACHE_OBJECTS + index->second.hash;
+                type = index->second.type;
+                size = index->second.size;
+                result = true;
+                _hits++;
+            } else {
+                _misses++;
+            }
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    // Call with the _adminLock taken. Another browser may have preseeded the store since it was read.
+    void SharedCache::Refresh()
+    {
+        const string fileName(_path + SHARED_CACHE_INDEX);
+        const uint64_t stamp = ModificationTime(fileName);
+
+        if (stamp != _stamp) {
+            Index index;
+            _assets.clear();
+            _stamp = stamp;
+
+            if (index.Load(fileName) == true) {
+                Core::JSON::ArrayType<Asset>::ConstIterator asset(static_cast<const Index&>(index).Assets.Elements());
+                while (asset.Next() == true) {
+                    Entry& entry(_assets[asset.Current().URL.Value()]);
+                    entry.hash = asset.Current().Hash.Value();
+                    entry.type = asset.Current().Type.Value();
+                    entry.size = asset.Current().Size.Value();
+                }
+            }
+        }
+    }
+
+    void SharedCache::Apply(const string& manifest)
+    {
+        // Out of the way of the first paint
+        for (uint32_t waited = 0; (waited < (SHARED_CACHE_PRESEED_DELAY * 10)) && (_closing == false); waited++) {
+            SleepMs(100);
+        }
+
+        _adminLock.Lock();
+        const string path(_path);
+        const uint32_t size(_size);
+        _adminLock.Unlock();
+
+        Index assets;
+        const uint64_t applied = ModificationTime(manifest);
+        const string signature(manifest + ':' + Core::NumberType<uint64_t>(applied).Text());
+
+        if ((_closing == true) || (path.empty() == true)) {
+        } else if ((applied == 0) || (assets.Load(manifest) == false)) {
+            TRACE(Trace::Error, (_T("Shared cache manifest %s can not be read"), manifest.c_str()));
+        } else {
+            // One browser at a time rewrites the index
+            const int lock = ::open((path + _T(".lock")).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+            if ((lock != -1) && (::flock(lock, LOCK_EX) == 0)) {
+                Index index;
+                index.Load(path + SHARED_CACHE_INDEX);
+
+                bool done = false;
+                Core::JSON::ArrayType<Core::JSON::String>::ConstIterator entry(static_cast<const Index&>(index).Manifests.Elements());
+                while ((done == false) && (entry.Next() == true)) {
+                    done = (entry.Current().Value() == signature);
+                }
+
+                if (done == false) {
+                    Index result;
+                    std::set<string> urls;
+                    std::set<string> hashes;
+                    uint64_t total = 0;
+                    uint32_t added = 0;
+
+                    auto keep = [&](const string& url, const string& hash, const string& type, const uint32_t length) -> bool {
+                        bool kept = false;
+                        if ((urls.find(url) == urls.end()) && ((total + length) <= (static_cast<uint64_t>(size) * 1024))) {
+                            Asset& asset(result.Assets.Add());
+                            asset.URL = url;
+                            asset.Hash = hash;
+                            asset.Type = type;
+                            asset.Size = length;
+                            urls.insert(url);
+                            // Same content under another URL takes no space again
+                            if (hashes.insert(hash).second == true) {
+                                total += length;
+                            }
+                            kept = true;
+                        }
+                        return (kept);
+                    };
+
+                    // The manifest first, it is the most recent
+                    Core::JSON::ArrayType<Asset>::ConstIterator asset(static_cast<const Index&>(assets).Assets.Elements());
+                    while ((asset.Next() == true) && (_closing == false)) {
+                        const string& url(asset.Current().URL.Value());
+                        const string& file(asset.Current().File.Value());
+                        string hash;
+                        uint32_t length;
+
+                        if (ToCache(url).empty() == true) {
+                            TRACE(Trace::Warning, (_T("Shared cache holds https URLs only, %s ignored"), url.c_str()));
+                        } else if (Digest(file, hash, length) == false) {
+                            TRACE(Trace::Warning, (_T("Shared cache content of %s, %s can not be read"), url.c_str(), file.c_str()));
+                        } else {
+                            const string object(path + SHARED_CACHE_OBJECTS + hash);
+                            bool stored = (ModificationTime(object) != 0);
+
+                            if (stored == false) {
+                                // Readers never see a partial object
+                                const string temporary(object + '.' + Core::NumberType<uint32_t>(static_cast<uint32_t>(::getpid())).Text());
+                                std::ifstream input(file, std::ios::binary);
+                                std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+                                output << input.rdbuf();
+                                output.close();
+                                stored = ((output.fail() == false) && (::rename(temporary.c_str(), object.c_str()) == 0));
+                                if (stored == false) {
+                                    ::unlink(temporary.c_str());
+                                }
+                            }
+
+                            string type(asset.Current().Type.Value());
+                            if (type.empty() == true) {
+                                gchar* guess = g_content_type_guess(file.c_str(), nullptr, 0, nullptr);
+                                gchar* mime = g_content_type_get_mime_type(guess);
+                                type = (mime != nullptr ? mime : _T("application/octet-stream"));
+                                g_free(mime);
+                                g_free(guess);
+                            }
+
+                            if ((stored == true) && (keep(url, hash, type, length) == true)) {
+                                added++;
+                            }
+                        }
+                    }
+
+                    // Then what the store held, preseeded by other manifests
+                    Core::JSON::ArrayType<Asset>::ConstIterator previous(static_cast<const Index&>(index).Assets.Elements());
+                    while (previous.Next() == true) {
+                        keep(previous.Current().URL.Value(), previous.Current().Hash.Value(), previous.Current().Type.Value(), previous.Current().Size.Value());
+                    }
+
+                    if (_closing == false) {
+                        Core::JSON::String& latest(result.Manifests.Add());
+                        latest = signature;
+                        Core::JSON::ArrayType<Core::JSON::String>::ConstIterator manifests(static_cast<const Index&>(index).Manifests.Elements());
+                        while ((manifests.Next() == true) && (result.Manifests.Length() < SHARED_CACHE_MANIFESTS)) {
+                            Core::JSON::String& older(result.Manifests.Add());
+                            older = manifests.Current().Value();
+                        }
+                    }
+
+                    // Replaced at once, the browsers serving from the store read either index
+                    const string temporary(path + SHARED_CACHE_INDEX + _T(".tmp"));
+                    Core::File file(temporary);
+                    if ((file.Create() == true) && (result.IElement::ToFile(file) == true)) {
+                        file.Close();
+                        ::rename(temporary.c_str(), (path + SHARED_CACHE_INDEX).c_str());
+
+                        // Contents no URL of the index refers to any more
+                        DIR* objects = ::opendir((path + SHARED_CACHE_OBJECTS).c_str());
+                        if (objects != nullptr) {
+                            struct dirent* element;
+                            while ((element = ::readdir(objects)) != nullptr) {
+                                if ((element->d_name[0] != '.') && (hashes.find(element->d_name) == hashes.end())) {
+                                    ::unlink((path + SHARED_CACHE_OBJECTS + element->d_name).c_str());
+                                }
+                            }
+                            ::closedir(objects);
+                        }
+
+                        TRACE(Trace::Information, (_T("Shared cache preseeded from %s: %u assets added, %u assets, %u KB"), manifest.c_str(), added, result.Assets.Length(), static_cast<uint32_t>(total / 1024)));
+                    } else {
+                        file.Close();
+                        TRACE(Trace::Error, (_T("Shared cache index %s can not be written"), temporary.c_str()));
+                    }
+                }
+            }
+            if (lock != -1) {
+                ::close(lock);
+            }
+        }
+    }
+
+    /* static */ bool SharedCache::Digest(const string& fileName, string& hash, uint32_t& size)
+    {
+        bool result = false;
+        std::ifstream input(fileName, std::ios::binary);
+
+        if (input.is_open() == true) {
+            EVP_MD_CTX* context = EVP_MD_CTX_new();
+            if ((context != nullptr) && (EVP_DigestInit_ex(context, EVP_sha256(), nullptr) == 1)) {
+                char buffer[16 * 1024];
+                uint64_t length = 0;
+
+                while (input.read(buffer, sizeof(buffer)) || (input.gcount() > 0)) {
+                    EVP_DigestUpdate(context, buffer, input.gcount());
+                    length += input.gcount();
+                }
+
+                uint8_t digest[EVP_MAX_MD_SIZE];
+                unsigned int digestLength = 0;
+                if ((input.bad() == false) && (length <= 0xFFFFFFFF) && (EVP_DigestFinal_ex(context, digest, &digestLength) == 1)) {
+                    static const char hex[] = "0123456789abcdef";
+                    hash.clear();
+                    for (unsigned int index = 0; index < digestLength; index++) {
+                        hash += hex[digest[index] >> 4];
+                        hash += hex[digest[index] & 0x0F];
+                    }
+                    size = static_cast<uint32_t>(length);
+                    result = true;
+                }
+            }
+            EVP_MD_CTX_free(context);
+        }
+        return (result);
+    }
+
+} // namespace Plugin
+
+} // namespace WPEFramework
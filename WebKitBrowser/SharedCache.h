@@ -0,0 +1,190 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SHAREDCACHE_H
+#define __SHAREDCACHE_H
+
+#include <core/core.h>
+
+#include <atomic>
+#include <map>
+#include <thread>
+
+// Assets of the store are loaded by the pages under this scheme, same host and path as the https URL
+#define SHARED_CACHE_SCHEME "thunder-cache"
+#define SHARED_CACHE_INDEX _T("index.json")
+#define SHARED_CACHE_OBJECTS _T("objects/")
+// Seconds after the first page loaded before the manifest is applied
+#define SHARED_CACHE_PRESEED_DELAY 10
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // Content-addressed store of common assets (fonts, JS frameworks) shared by the browser callsigns
+    // configured with the same path. A preseed manifest lists the https URLs with the installed files
+    // that hold their content, it is applied once per change of the manifest, in the background after
+    // the first page of a browser loaded.
+    // The injected bundle moves requests for URLs in the index to SHARED_CACHE_SCHEME, served by the
+    // browser from the store without a network fetch, so that they are not bound to the partitions
+    // of the WebKit disk cache of each callsign. URLs the index does not hold move back to https, the
+    // relative URLs in a stylesheet from the store included.
+    //
+    //   <path>/index.json          url -> hash, type and size, most recently preseeded first, replaced as a whole
+    //   <path>/objects/<sha256>    the contents, written once
+    class SharedCache {
+    private:
+        SharedCache(const SharedCache&) = delete;
+        SharedCache& operator=(const SharedCache&) = delete;
+
+    public:
+        class Asset : public Core::JSON::Container {
+        public:
+            Asset& operator=(const Asset&) = delete;
+
+            Asset()
+                : Core::JSON::Container()
+            {
+                Add(_T("url"), &URL);
+                Add(_T("hash"), &Hash);
+                Add(_T("type"), &Type);
+                Add(_T("size"), &Size);
+                Add(_T("file"), &File);
+            }
+            Asset(const Asset& copy)
+                : Core::JSON::Container()
+                , URL(copy.URL)
+                , Hash(copy.Hash)
+                , Type(copy.Type)
+                , Size(copy.Size)
+                , File(copy.File)
+            {
+                Add(_T("url"), &URL);
+                Add(_T("hash"), &Hash);
+                Add(_T("type"), &Type);
+                Add(_T("size"), &Size);
+                Add(_T("file"), &File);
+            }
+            ~Asset()
+            {
+            }
+
+        public:
+            Core::JSON::String URL;
+            Core::JSON::String Hash;        // index only
+            Core::JSON::String Type;
+            Core::JSON::DecUInt32 Size;     // index only
+            Core::JSON::String File;        // manifest only, the installed content of the URL
+        };
+
+        // The index of the store, and the manifest of the assets to preseed it with.
+        class Index : public Core::JSON::Container {
+        private:
+            Index(const Index&) = delete;
+            Index& operator=(const Index&) = delete;
+
+        public:
+            Index()
+                : Core::JSON::Container()
+            {
+                Add(_T("manifests"), &Manifests);
+                Add(_T("assets"), &Assets);
+            }
+            ~Index()
+            {
+            }
+
+            bool Load(const string& fileName)
+            {
+                bool result = false;
+                Core::File file(fileName);
+
+                if (file.Open(true) == true) {
+                    Core::OptionalType<Core::JSON::Error> error;
+                    IElement::FromFile(file, error);
+                    file.Close();
+                    result = (error.IsSet() == false);
+                }
+                return (result);
+            }
+
+        public:
+            Core::JSON::ArrayType<Core::JSON::String> Manifests;    // index only, those applied, with their modification time
+            Core::JSON::ArrayType<Asset> Assets;
+        };
+
+    public:
+        // https://host/path <-> thunder-cache://host/path, empty if the URL has the other scheme
+        static string ToCache(const string& url)
+        {
+            static const string https(_T("https://"));
+            return (url.compare(0, https.length(), https) == 0 ? string(_T(SHARED_CACHE_SCHEME "://")) + url.substr(https.length()) : string());
+        }
+        static string FromCache(const string& url)
+        {
+            static const string cache(_T(SHARED_CACHE_SCHEME "://"));
+            return (url.compare(0, cache.length(), cache) == 0 ? string(_T("https://")) + url.substr(cache.length()) : string());
+        }
+
+    public:
+        SharedCache();
+        ~SharedCache();
+
+        // Size in KB, the least recently preseeded assets are dropped beyond it.
+        bool Open(const string& path, const uint32_t size);
+        void Close();
+        bool IsOpen() const
+        {
+            return (_path.empty() == false);
+        }
+
+        // Applies the manifest in the background, after SHARED_CACHE_PRESEED_DELAY. Once per browser.
+        void Preseed(const string& manifest);
+
+        // The file holding the content of the https url, if the store has it.
+        bool Lookup(const string& url, string& file, string& type, uint32_t& size);
+
+    private:
+        struct Entry {
+            string hash;
+            string type;
+            uint32_t size;
+        };
+
+        void Refresh();
+        void Apply(const string& manifest);
+        static bool Digest(const string& fileName, string& hash, uint32_t& size);
+
+    private:
+        Core::CriticalSection _adminLock;
+        string _path;
+        uint32_t _size;
+        std::map<string, Entry> _assets;
+        uint64_t _stamp;                    // modification time of the index read into _assets
+        std::thread _preseed;
+        std::atomic<bool> _closing;
+        uint32_t _hits;
+        uint32_t _misses;
+    };
+
+} // namespace Plugin
+
+} // namespace WPEFramework
+
+#endif // __SHAREDCACHE_H
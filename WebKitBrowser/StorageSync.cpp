@@ -0,0 +1,353 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StorageSync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <set>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <sqlite3.h>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    static uint64_t ModificationTime(const string& fileName)
+    {
+        struct stat info;
+        return (::stat(fileName.c_str(), &info) == 0 ? (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ULL) + info.st_mtim.tv_nsec : 0);
+    }
+
+    // A database written in WAL mode changes in its -wal file until a checkpoint
+    static uint64_t Stamp(const string& fileName)
+    {
+        return (std::max(ModificationTime(fileName), ModificationTime(fileName + _T("-wal"))));
+    }
+
+    static void CreateParent(const string& fileName)
+    {
+        const size_t slash = fileName.rfind('/');
+        if ((slash != string::npos) && (slash != 0)) {
+            g_mkdir_with_parents(fileName.substr(0, slash).c_str(), 0700);
+        }
+    }
+
+    StorageSync::StorageSync()
+        : _lock()
+        , _signal()
+        , _targets()
+        , _synced()
+        , _interval(0)
+        , _journal(_T("wal"))
+        , _triggered(false)
+        , _running(false)
+        , _thread()
+        , _syncs(0)
+        , _copies(0)
+    {
+    }
+
+    StorageSync::~StorageSync()
+    {
+        Close();
+    }
+
+    void StorageSync::Open(const uint16_t interval, const string& journal)
+    {
+        static const std::set<string> modes { _T("wal"), _T("delete"), _T("truncate"), _T("persist") };
+
+        _interval = interval;
+        if (modes.find(journal) != modes.end()) {
+            _journal = journal;
+        } else {
+            TRACE(Trace::Warning, (_T("Journal mode %s not supported, using %s"), journal.c_str(), _journal.c_str()));
+        }
+    }
+
+    void StorageSync::AddFile(const string& persistent, const string& working)
+    {
+        ASSERT(_running == false);
+
+        CreateParent(working);
+        if ((ModificationTime(persistent) != 0) && (Copy(persistent, working, nullptr) == false)) {
+            TRACE(Trace::Error, (_T("Storage %s can not be restored"), persistent.c_str()));
+        }
+        _synced[working] = Stamp(working);
+
+        Target target;
+        target.persistent = persistent;
+        target.working = working;
+        target.directory = false;
+        _targets.push_back(target);
+    }
+
+    void StorageSync::AddDirectory(const string& persistent, const string& working)
+    {
+        ASSERT(_running == false);
+
+        std::list<string> files;
+        List(persistent, string(), files);
+        g_mkdir_with_parents(working.c_str(), 0700);
+
+        for (const string& file : files) {
+            const string from(persistent + '/' + file);
+            const string to(working + '/' + file);
+
+            CreateParent(to);
+            if ((IsDatabase(from) == true ? Copy(from, to, nullptr) : CopyFile(from, to)) == false) {
+                TRACE(Trace::Error, (_T("Storage %s can not be restored"), from.c_str()));
+            }
+            _synced[to] = Stamp(to);
+        }
+
+        TRACE(Trace::Information, (_T("Storage %s restored, %u files"), persistent.c_str(), static_cast<uint32_t>(files.size())));
+
+        Target target;
+        target.persistent = persistent;
+        target.working = working;
+        target.directory = true;
+        _targets.push_back(target);
+    }
+
+    void StorageSync::Start()
+    {
+        if ((_targets.empty() == false) && (_thread.joinable() == false)) {
+            _running = true;
+            _thread = std::thread(&StorageSync::Run, this);
+        }
+    }
+
+    void StorageSync::Trigger()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        _triggered = true;
+        _signal.notify_one();
+    }
+
+    void StorageSync::Close()
+    {
+        if (_thread.joinable() == true) {
+            {
+                std::unique_lock<std::mutex> lock(_lock);
+                _running = false;
+                _signal.notify_one();
+            }
+            _thread.join();
+
+            // The browser is gone, what it wrote last is on the volatile path only
+            Sync();
+            TRACE(Trace::Information, (_T("Storage synced %u times, %u copies"), _syncs, _copies));
+        }
+        _targets.clear();
+        _synced.clear();
+    }
+
+    void StorageSync::Run()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+
+        while (_running == true) {
+            _signal.wait_for(lock, std::chrono::seconds(_interval), [this]() { return ((_triggered == true) || (_running == false)); });
+
+            if (_running == true) {
+                _triggered = false;
+                lock.unlock();
+                Sync();
+                lock.lock();
+            }
+        }
+    }
+
+    // The sync thread, or Close once it is gone
+    uint32_t StorageSync::Sync()
+    {
+        uint32_t copied = 0;
+
+        for (const Target& target : _targets) {
+            if (target.directory == false) {
+                copied += (Sync(target.working, target.persistent) == true ? 1 : 0);
+            } else {
+                std::list<string> files;
+                List(target.working, string(), files);
+                std::set<string> present(files.begin(), files.end());
+
+                for (const string& file : files) {
+                    copied += (Sync(target.working + '/' + file, target.persistent + '/' + file) == true ? 1 : 0);
+                }
+
+                // Removed by the browser (cleared storage), removed from flash as well
+                std::list<string> stored;
+                List(target.persistent, string(), stored);
+                for (const string& file : stored) {
+                    if (present.find(file) == present.end()) {
+                        const string name(target.persistent + '/' + file);
+                        ::unlink(name.c_str());
+                        ::unlink((name + _T("-wal")).c_str());
+                        ::unlink((name + _T("-shm")).c_str());
+                        _synced.erase(target.working + '/' + file);
+                        copied++;
+                    }
+                }
+            }
+        }
+
+        if (copied != 0) {
+            _syncs++;
+            _copies += copied;
+        }
+        return (copied);
+    }
+
+    bool StorageSync::Sync(const string& working, const string& persistent)
+    {
+        bool result = false;
+        const uint64_t stamp = Stamp(working);
+
+        if (stamp != _synced[working]) {
+            CreateParent(persistent);
+            if ((IsDatabase(working) == true ? Copy(working, persistent, _journal.c_str()) : CopyFile(working, persistent)) == true) {
+                _synced[working] = stamp;
+                result = true;
+            } else {
+                TRACE(Trace::Error, (_T("Storage %s can not be synced"), working.c_str()));
+            }
+        }
+        return (result);
+    }
+
+    /* static */ void StorageSync::List(const string& root, const string& relative, std::list<string>& files)
+    {
+        static const char* const skipped[] = { "-wal", "-shm", "-journal" };
+
+        DIR* directory = ::opendir((root + '/' + relative).c_str());
+        if (directory != nullptr) {
+            struct dirent* entry;
+            while ((entry = ::readdir(directory)) != nullptr) {
+                const string name(entry->d_name);
+                const string path(relative.empty() == true ? name : relative + '/' + name);
+                struct stat info;
+
+                if ((name == _T(".")) || (name == _T("..")) || (::stat((root + '/' + path).c_str(), &info) != 0)) {
+                    continue;
+                }
+
+                if (S_ISDIR(info.st_mode)) {
+                    List(root, path, files);
+                } else if (S_ISREG(info.st_mode)) {
+                    bool skip = false;
+                    for (const char* suffix : skipped) {
+                        const size_t length = strlen(suffix);
+                        skip = skip || ((name.length() > length) && (name.compare(name.length() - length, length, suffix) == 0));
+                    }
+                    if (skip == false) {
+                        files.push_back(path);
+                    }
+                }
+            }
+            ::closedir(directory);
+        }
+    }
+
+    /* static */ bool StorageSync::IsDatabase(const string& fileName)
+    {
+        static const char header[] = "SQLite format 3";
+        char buffer[sizeof(header)];
+        bool result = false;
+
+        const int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd != -1) {
+            result = ((::read(fd, buffer, sizeof(buffer)) == sizeof(buffer)) && (memcmp(buffer, header, sizeof(header)) == 0));
+            ::close(fd);
+        }
+        return (result);
+    }
+
+    // One transaction on the destination, a consistent snapshot of the source while it is written
+    /* static */ bool StorageSync::Copy(const string& from, const string& to, const char journal[])
+    {
+        bool result = false;
+        sqlite3* source = nullptr;
+        sqlite3* destination = nullptr;
+
+        if ((sqlite3_open_v2(from.c_str(), &source, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) && (sqlite3_open_v2(to.c_str(), &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) == SQLITE_OK)) {
+            sqlite3_busy_timeout(source, 1000);
+            sqlite3_busy_timeout(destination, 1000);
+
+            if (journal != nullptr) {
+                // In WAL mode a commit does not need its own fsync
+                const string pragma(string(_T("PRAGMA journal_mode=")) + journal + _T("; PRAGMA synchronous=NORMAL;"));
+                sqlite3_exec(destination, pragma.c_str(), nullptr, nullptr, nullptr);
+            }
+
+            sqlite3_backup* backup = sqlite3_backup_init(destination, "main", source, "main");
+            if (backup != nullptr) {
+                result = (sqlite3_backup_step(backup, -1) == SQLITE_DONE);
+                sqlite3_backup_finish(backup);
+            }
+            if (result == false) {
+                TRACE(Trace::Error, (_T("Backup of %s failed: %s"), from.c_str(), sqlite3_errmsg(destination)));
+            }
+        }
+
+        sqlite3_close(source);
+        sqlite3_close(destination);
+
+        return (result);
+    }
+
+    /* static */ bool StorageSync::CopyFile(const string& from, const string& to)
+    {
+        bool result = false;
+        const string temporary(to + _T(".sync"));
+
+        const int input = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (input != -1) {
+            const int output = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (output != -1) {
+                char buffer[16 * 1024];
+                ssize_t length = 0;
+
+                result = true;
+                while ((result == true) && ((length = ::read(input, buffer, sizeof(buffer))) > 0)) {
+                    result = (::write(output, buffer, length) == length);
+                }
+                result = result && (length == 0) && (::fsync(output) == 0);
+                ::close(output);
+
+                result = result && (::rename(temporary.c_str(), to.c_str()) == 0);
+                if (result == false) {
+                    ::unlink(temporary.c_str());
+                }
+            }
+            ::close(input);
+        }
+        return (result);
+    }
+
+} // namespace Plugin
+
+} // namespace WPEFramework
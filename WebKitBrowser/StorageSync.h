@@ -0,0 +1,97 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STORAGESYNC_H
+#define __STORAGESYNC_H
+
+#include "Module.h"
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // Cookies and localStorage of the browser written to flash in batches. WebKit keeps its
+    // databases in working copies on the volatile path, restored from the persistent copies before
+    // the browser opens them. Every interval the databases that changed are copied back at once,
+    // with the SQLite backup API so that a copy is consistent while WebKit writes, into persistent
+    // copies in the configured journal mode (WAL by default). Suspending the browser syncs without
+    // waiting for the interval, closing the store syncs a last time. Changes of the last interval are
+    // lost when the power goes.
+    class StorageSync {
+    private:
+        StorageSync(const StorageSync&) = delete;
+        StorageSync& operator=(const StorageSync&) = delete;
+
+        struct Target {
+            string persistent;
+            string working;
+            bool directory;
+        };
+
+    public:
+        StorageSync();
+        ~StorageSync();
+
+    public:
+        // Interval in seconds, journal mode as in the SQLite journal_mode pragma
+        void Open(const uint16_t interval, const string& journal);
+        // A database file, or all the files under a directory, kept in a working copy.
+        void AddFile(const string& persistent, const string& working);
+        void AddDirectory(const string& persistent, const string& working);
+        // Syncs the targets every interval from now on
+        void Start();
+        // Syncs as soon as possible, does not wait for it
+        void Trigger();
+        // Syncs a last time, waits for it
+        void Close();
+
+    private:
+        void Run();
+        uint32_t Sync();
+        bool Sync(const string& working, const string& persistent);
+        static void List(const string& root, const string& relative, std::list<string>& files);
+        static bool IsDatabase(const string& fileName);
+        static bool Copy(const string& from, const string& to, const char journal[]);
+        static bool CopyFile(const string& from, const string& to);
+
+    private:
+        std::mutex _lock;
+        std::condition_variable _signal;
+        std::list<Target> _targets;
+        std::map<string, uint64_t> _synced;     // working file -> modification time copied
+        uint16_t _interval;
+        string _journal;
+        bool _triggered;
+        bool _running;
+        std::thread _thread;
+        uint32_t _syncs;
+        uint32_t _copies;
+    };
+
+} // namespace Plugin
+
+} // namespace WPEFramework
+
+#endif // __STORAGESYNC_H
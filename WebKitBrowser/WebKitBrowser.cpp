@@ -54,6 +54,23 @@ namespace Plugin {
             }
         }
 
+        // Each callsign has its own configuration, and thus its own memory budget.
+        class PolicyConfig : public Core::JSON::Container {
+        public:
+            PolicyConfig()
+                : Core::JSON::Container()
+                , TelemetryInterval(60)
+            {
+                Add(_T("memorypolicy"), &Policy);
+                Add(_T("telemetryinterval"), &TelemetryInterval);
+            }
+
+        public:
+            MemoryPolicy::Config Policy;
+            Core::JSON::DecUInt16 TelemetryInterval; // seconds between performance events, 0 disables them
+        } policyConfig;
+        policyConfig.FromString(configLine);
+
         // Register the Connection::Notification stuff. The Remote process might die before we get a
         // change to "register" the sink for these events !!! So do it ahead of instantiation.
         _service->Register(&_notification);
@@ -108,6 +125,17 @@ namespace Plugin {
             _service->Unregister(&_notification);
             _service = nullptr;
         } else {
+            _memoryPolicy = new MemoryPolicy(policyConfig.Policy, _memory, _browser, _application);
+
+            // The browser process created the telemetry while it was configured.
+            if (_telemetry.Open(PageTelemetry::Location(_service)) == false) {
+                TRACE(Trace::Error, (_T("Page telemetry is not available")));
+            }
+            _telemetryInterval = policyConfig.TelemetryInterval.Value();
+            if (_telemetryInterval != 0) {
+                _telemetryJob.Schedule(Core::Time::Now().Add(_telemetryInterval * 1000));
+            }
+
             RegisterAll();
             Exchange::JWebBrowser::Register(*this, _browser);
 
@@ -142,6 +170,10 @@ namespace Plugin {
         // Make sure we get no longer get any notifications, we are deactivating..
         _service->Unregister(&_notification);
         _browser->Unregister(&_notification);
+        _telemetryJob.Revoke();
+        _telemetry.Close();
+        delete _memoryPolicy;
+        _memoryPolicy = nullptr;
         _memory->Release();
         _application->Release();
         Exchange::JWebBrowser::Unregister(*this);
@@ -332,6 +364,25 @@ namespace Plugin {
         event_bridgequery(message);
     }
 
+    void WebKitBrowser::Performance(PageTelemetry::Data& data) const
+    {
+        _telemetry.Get(data);
+
+        uint8_t fps = 0;
+        static_cast<const Exchange::IWebBrowser*>(_browser)->FPS(fps);
+        data.FPS = fps;
+        data.Resident = _memory->Resident() / 1024;
+    }
+
+    void WebKitBrowser::Dispatch()
+    {
+        PageTelemetry::Data data;
+        Performance(data);
+        event_performance(data);
+
+        _telemetryJob.Schedule(Core::Time::Now().Add(_telemetryInterval * 1000));
+    }
+
     void WebKitBrowser::StateChange(const PluginHost::IStateControl::state state)
     {
         TRACE(Trace::Information, (_T("StateChange: { \"State\": %d }"), state));
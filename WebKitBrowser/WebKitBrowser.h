@@ -21,6 +21,8 @@
 #define __BROWSER_H
 
 #include "Module.h"
+#include "MemoryPolicy.h"
+#include "PageTelemetry.h"
 #include <interfaces/IBrowser.h>
 #include <interfaces/IApplication.h>
 #include <interfaces/IMemory.h>
@@ -152,9 +154,13 @@ namespace Plugin {
             , _browserResources(nullptr)
             , _browserSecurity(nullptr)
             , _memory(nullptr)
+            , _memoryPolicy(nullptr)
             , _application(nullptr)
             , _notification(this)
             , _jsonBodyDataFactory(2)
+            , _telemetry()
+            , _telemetryInterval(0)
+            , _telemetryJob(*this)
         {
         }
 
@@ -225,6 +231,10 @@ namespace Plugin {
         void BridgeQuery(const string& message);
         void StateChange(const PluginHost::IStateControl::state state);
         uint32_t DeleteDir(const string& path);
+        void Performance(PageTelemetry::Data& data) const;
+
+        friend Core::ThreadPool::JobType<WebKitBrowser&>;
+        void Dispatch();
 
         // JsonRpc
         void RegisterAll();
@@ -236,7 +246,10 @@ namespace Plugin {
         uint32_t set_languages(const Core::JSON::ArrayType<Core::JSON::String>& param);
         uint32_t get_headers(Core::JSON::ArrayType<JsonData::WebKitBrowser::HeadersData>& response) const;
         uint32_t set_headers(const Core::JSON::ArrayType<JsonData::WebKitBrowser::HeadersData>& param);
+        uint32_t get_memorypolicy(MemoryPolicy::Counters& response) const;
+        uint32_t get_performance(PageTelemetry::Data& response) const;
         void event_bridgequery(const string& message);
+        void event_performance(const PageTelemetry::Data& data);
         void event_statechange(const bool& suspended); // StateControl
 
     private:
@@ -247,10 +260,14 @@ namespace Plugin {
         Exchange::IBrowserResources* _browserResources;
         Exchange::IBrowserSecurity* _browserSecurity;
         Exchange::IMemory* _memory;
+        MemoryPolicy* _memoryPolicy;
         Exchange::IApplication* _application;
         Core::Sink<Notification> _notification;
         Core::ProxyPoolType<Web::JSONBodyType<WebKitBrowser::Data>> _jsonBodyDataFactory;
         string _persistentStoragePath;
+        PageTelemetry _telemetry;
+        uint16_t _telemetryInterval;
+        Core::WorkerPool::JobType<WebKitBrowser&> _telemetryJob;
     };
 }
 }
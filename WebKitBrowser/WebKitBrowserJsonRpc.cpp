@@ -41,6 +41,8 @@ namespace Plugin {
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("languages"), &WebKitBrowser::get_languages, &WebKitBrowser::set_languages, this);
         Property<Core::JSON::ArrayType<JsonData::WebKitBrowser::HeadersData>>(_T("headers"), &WebKitBrowser::get_headers, &WebKitBrowser::set_headers, this);
         Register<DeleteParamsData,void>(_T("delete"), &WebKitBrowser::endpoint_delete, this);
+        Property<MemoryPolicy::Counters>(_T("memorypolicy"), &WebKitBrowser::get_memorypolicy, nullptr, this);
+        Property<PageTelemetry::Data>(_T("performance"), &WebKitBrowser::get_performance, nullptr, this);
     }
 
     void WebKitBrowser::UnregisterAll()
@@ -49,6 +51,8 @@ namespace Plugin {
         Unregister(_T("headers"));
         Unregister(_T("languages"));
         Unregister(_T("delete"));
+        Unregister(_T("memorypolicy"));
+        Unregister(_T("performance"));
     }
 
     // API implementation
@@ -122,6 +126,30 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Property: memorypolicy - Counters of the memory pressure policy
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t WebKitBrowser::get_memorypolicy(MemoryPolicy::Counters& response) const
+    {
+        ASSERT(_memoryPolicy != nullptr);
+
+        _memoryPolicy->Get(response);
+
+        return Core::ERROR_NONE;
+    }
+
+    // Property: performance - Navigation timing, frame rate, long tasks and memory of the page
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t WebKitBrowser::get_performance(PageTelemetry::Data& response) const
+    {
+        ASSERT(_browser != nullptr);
+
+        Performance(response);
+
+        return Core::ERROR_NONE;
+    }
+
     // Property: state - Running state of the service
     // Return codes:
     //  - ERROR_NONE: Success
@@ -186,6 +214,12 @@ namespace Plugin {
         Notify(_T("bridgequery"), params);
     }
 
+    // Event: performance - Periodic copy of the performance property
+    void WebKitBrowser::event_performance(const PageTelemetry::Data& data)
+    {
+        Notify(_T("performance"), data);
+    }
+
 } // namespace Plugin
 
 } // namespace WPEFramework
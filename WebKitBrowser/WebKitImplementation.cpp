@@ -17,6 +17,7 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <condition_variable>
 #include <fstream>
 #include <memory>
@@ -42,6 +43,7 @@
 #include <WPE/WebKit/WKNotificationPermissionRequest.h>
 #include <WPE/WebKit/WKNotificationProvider.h>
 #include <WPE/WebKit/WKPreferencesRef.h>
+#include <WPE/WebKit/WKResourceCacheManager.h>
 #include <WPE/WebKit/WKSoupSession.h>
 #include <WPE/WebKit/WKUserMediaPermissionRequest.h>
 #include <WPE/WebKit/WKErrorRef.h>
@@ -82,6 +84,8 @@ WK_EXPORT WKProcessID WKPageGetProcessIdentifier(WKPageRef page);
 
 #include "HTML5Notification.h"
 #include "WebKitBrowser.h"
+#include "SharedCache.h"
+#include "StorageSync.h"
 
 namespace WPEFramework {
 namespace Plugin {
@@ -167,11 +171,14 @@ std::string getMainConfigValue(const std::string& key)
     static string consoleLogPrefix;
 
 #ifndef WEBKIT_GLIB_API
+    static void onDidReceiveMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, const void* clientInfo);
     static void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
         WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo);
     static void onNotificationShow(WKPageRef page, WKNotificationRef notification, const void* clientInfo);
     static void didStartProvisionalNavigation(WKPageRef page, WKNavigationRef navigation, WKTypeRef userData, const void* clientInfo);
     static void didFinishDocumentLoad(WKPageRef page, WKNavigationRef navigation, WKTypeRef userData, const void* clientInfo);
+    static void didFinishNavigation(WKPageRef page, WKNavigationRef navigation, WKTypeRef userData, const void* clientInfo);
     static void onFrameDisplayed(WKViewRef view, const void* clientInfo);
     static void didSameDocumentNavigation(const OpaqueWKPage* page, const OpaqueWKNavigation* nav, unsigned int count, const void* clientInfo, const void* info);
     static void requestClosure(const void* clientInfo);
@@ -201,7 +208,7 @@ std::string getMainConfigValue(const std::string& key)
         nullptr, // didReceiveServerRedirectForProvisionalNavigation
         didFailProvisionalNavigation,
         nullptr, // didCommitNavigation
-        nullptr, // didFinishNavigation
+        didFinishNavigation,
         didFailNavigation,
         nullptr, // didFailProvisionalLoadInSubframe
         didFinishDocumentLoad,
@@ -219,7 +226,8 @@ std::string getMainConfigValue(const std::string& key)
 
     static WKContextInjectedBundleClientV1 _handlerInjectedBundle = {
         { 1, nullptr },
-        nullptr, // didReceiveMessageFromInjectedBundle
+        // didReceiveMessageFromInjectedBundle
+        onDidReceiveMessageFromInjectedBundle,
         // didReceiveSynchronousMessageFromInjectedBundle
         onDidReceiveSynchronousMessageFromInjectedBundle,
         nullptr, // getInjectedBundleInitializationUserData
@@ -482,6 +490,10 @@ static GSourceFuncs _handlerIntervention =
 
                 return (result);
             }
+            inline Iterator Configs() const
+            {
+                return (Iterator(_configs));
+            }
 
         private:
             bool Request(const TCHAR label[]) override
@@ -538,6 +550,53 @@ static GSourceFuncs _handlerIntervention =
                 Core::JSON::String DumpOptions;
             };
 
+            class SharedCacheSettings : public Core::JSON::Container {
+            public:
+                SharedCacheSettings(const SharedCacheSettings&) = delete;
+                SharedCacheSettings& operator=(const SharedCacheSettings&) = delete;
+
+                SharedCacheSettings()
+                    : Core::JSON::Container()
+                    , Path()
+                    , Size(32 * 1024)
+                    , Manifest()
+                {
+                    Add(_T("path"), &Path);
+                    Add(_T("size"), &Size);
+                    Add(_T("manifest"), &Manifest);
+                }
+                ~SharedCacheSettings()
+                {
+                }
+
+            public:
+                Core::JSON::String Path;        // Same for the callsigns sharing the assets, empty is off
+                Core::JSON::DecUInt32 Size;     // KB
+                Core::JSON::String Manifest;    // Assets to preseed the store with
+            };
+
+            class StorageSyncSettings : public Core::JSON::Container {
+            public:
+                StorageSyncSettings(const StorageSyncSettings&) = delete;
+                StorageSyncSettings& operator=(const StorageSyncSettings&) = delete;
+
+                StorageSyncSettings()
+                    : Core::JSON::Container()
+                    , Interval(0)
+                    , Journal(_T("wal"))
+                {
+                    Add(_T("interval"), &Interval);
+                    Add(_T("journal"), &Journal);
+                }
+                ~StorageSyncSettings()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt16 Interval; // Seconds cookie and localStorage writes are coalesced, 0 is off
+                Core::JSON::String Journal;     // SQLite journal mode of the copies on flash
+            };
+
         public:
             Config()
                 : Core::JSON::Container()
@@ -594,6 +653,9 @@ static GSourceFuncs _handlerIntervention =
                 , WatchDogCheckTimeoutInSeconds(0)
                 , WatchDogHangThresholdInSeconds(0)
                 , LoadBlankPageOnSuspendEnabled(false)
+                , WarmStandby(false)
+                , SharedStore()
+                , Persistence()
             {
                 Add(_T("webkitdebug"), &WebkitDebug);
                 Add(_T("gstdebug"), &GstDebug);
@@ -650,6 +712,9 @@ static GSourceFuncs _handlerIntervention =
                 Add(_T("watchdogchecktimeoutinseconds"), &WatchDogCheckTimeoutInSeconds);
                 Add(_T("watchdoghangthresholdtinseconds"), &WatchDogHangThresholdInSeconds);
                 Add(_T("loadblankpageonsuspendenabled"), &LoadBlankPageOnSuspendEnabled);
+                Add(_T("warmstandby"), &WarmStandby);
+                Add(_T("sharedcache"), &SharedStore);
+                Add(_T("storagesync"), &Persistence);
             }
             ~Config()
             {
@@ -711,6 +776,9 @@ static GSourceFuncs _handlerIntervention =
             Core::JSON::DecUInt16 WatchDogCheckTimeoutInSeconds;   // How often to check main event loop for responsiveness
             Core::JSON::DecUInt16 WatchDogHangThresholdInSeconds;  // The amount of time to give a process to recover before declaring a hang state
             Core::JSON::Boolean LoadBlankPageOnSuspendEnabled;
+            Core::JSON::Boolean WarmStandby;  // Launch the WebProcess before the first URL is set
+            SharedCacheSettings SharedStore;
+            StorageSyncSettings Persistence;
         };
 
 #ifndef WEBKIT_GLIB_API
@@ -844,6 +912,7 @@ static GSourceFuncs _handlerIntervention =
             , _compliant(false)
             , _configurationCompleted(false)
             , _webProcessCheckInProgress(false)
+            , _warmStandby(false)
             , _unresponsiveReplyNum(0)
             , _frameCount(0)
             , _lastDumpTime(g_get_monotonic_time())
@@ -851,6 +920,9 @@ static GSourceFuncs _handlerIntervention =
             , _userScript()
             , _userStyleSheet()
             , _securityProfileName("compatible")
+            , _telemetry()
+            , _sharedCache()
+            , _storageSync()
         {
             // Register an @Exit, in case we are killed, with an incorrect ref count !!
             if (atexit(CloseDown) != 0) {
@@ -884,6 +956,9 @@ static GSourceFuncs _handlerIntervention =
             if (Wait(Core::Thread::STOPPED | Core::Thread::BLOCKED, 6000) == false)
                 TRACE(Trace::Information, (_T("Bailed out before the end of the WPE main app was reached. %d"), 6000));
 
+            // Deactivated, what the browser wrote since the last sync goes to flash now
+            _storageSync.Close();
+
             implementation = nullptr;
         }
 
@@ -1388,6 +1463,9 @@ static GSourceFuncs _handlerIntervention =
 
             if (!_context) return Core::ERROR_ILLEGAL_STATE;
 
+            // The first URL takes over the warm WebProcess.
+            _warmStandby = false;
+
             using SetURLData = std::tuple<WebKitImplementation *, string>;
             auto *data = new SetURLData(this, URL);
 
@@ -1672,7 +1750,26 @@ static GSourceFuncs _handlerIntervention =
 
         uint32_t Reset(const resettype type) override
         {
-            return Core::ERROR_UNAVAILABLE;
+            // Only the memory caches can be dropped from a running page.
+            if ((type != Exchange::IApplication::CACHE) || (_context == nullptr)) {
+                return Core::ERROR_UNAVAILABLE;
+            }
+
+            g_main_context_invoke(
+                _context,
+                [](gpointer customdata) -> gboolean {
+                    WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
+#ifdef WEBKIT_GLIB_API
+                    webkit_web_context_clear_cache(webkit_web_view_get_context(object->_view));
+#else
+                    WKResourceCacheManagerClearCacheForAllOrigins(
+                        WKContextGetResourceCacheManager(WKPageGetContext(object->_page)), WKResourceCachesToClearInMemoryOnly);
+#endif
+                    return G_SOURCE_REMOVE;
+                },
+                this);
+
+            return Core::ERROR_NONE;
         }
 
         uint32_t Identifier(string& id) const override
@@ -1801,6 +1898,10 @@ static GSourceFuncs _handlerIntervention =
         {
             TRACE_L1("%s", url.c_str());
 
+            if (_warmStandby == true) {
+                return;
+            }
+
             bool isCurrentUrlBootUrl = urlValue() == _bootUrl;
             bool isNewUrlBootUrl = url == _bootUrl;
             if(!isCurrentUrlBootUrl && isNewUrlBootUrl && !_bootUrl.empty()) {
@@ -1855,6 +1956,20 @@ static GSourceFuncs _handlerIntervention =
                 return;
             }
 #endif
+            if (_warmStandby == true) {
+                TRACE(Trace::Information, (_T("WebProcess warmed up, waiting for the first URL")));
+                return;
+            }
+
+#ifdef WEBKIT_GLIB_API
+            _telemetry.LoadFinished();
+#else
+            _telemetry.DocumentLoaded();
+#endif
+
+            // A page is up, the manifest can be applied while the browser idles
+            _sharedCache.Preseed(_config.SharedStore.Manifest.Value());
+
             urlValue(url);
 
             {
@@ -1887,6 +2002,10 @@ static GSourceFuncs _handlerIntervention =
 
         void OnLoadFailed()
         {
+            if (_warmStandby == true) {
+                return;
+            }
+
             const auto url = urlValue();
 
             TRACE_L1("%s (%p)", url.c_str(), NavigationRef());
@@ -1985,6 +2104,30 @@ static GSourceFuncs _handlerIntervention =
             _httpStatusCode = code;
         }
 
+        // Page telemetry, all of these run on the main loop.
+        void OnNavigationStarted()
+        {
+            if (_warmStandby == false) {
+                _telemetry.NavigationStarted();
+            }
+        }
+        void OnResponseReceived()
+        {
+            _telemetry.ResponseReceived();
+        }
+#ifndef WEBKIT_GLIB_API
+        void OnNavigationFinished(WKNavigationRef navigation)
+        {
+            if (NavigationRef() == navigation) {
+                _telemetry.LoadFinished();
+            }
+        }
+        void OnLongTask(const uint32_t duration)
+        {
+            _telemetry.LongTask(duration);
+        }
+#endif
+
 #if !defined(WEBKITBROWSER_CLIENT_CERTS_PRIV_KEY_PASSWD)
 #define WEBKITBROWSER_CLIENT_CERTS_PRIV_KEY_PASSWD ("")
 #endif
@@ -2127,6 +2270,8 @@ static GSourceFuncs _handlerIntervention =
             consoleLogPrefix = service->Callsign();
             _service = service;
 
+            _telemetry.Create(PageTelemetry::Location(service));
+
             _dataPath = service->DataPath();
 
             _bootUrl = getMainConfigValue("app.metroBootPath");
@@ -2143,6 +2288,30 @@ static GSourceFuncs _handlerIntervention =
 
             const bool environmentOverride(WebKitBrowser::EnvironmentOverride(_config.EnvironmentOverride.Value()));
 
+            if (_config.Persistence.Interval.Value() != 0) {
+                // WebKit writes to working copies on the volatile path, synced to flash in batches
+                const string working(service->VolatilePath() + _T("storage/"));
+                _storageSync.Open(_config.Persistence.Interval.Value(), _config.Persistence.Journal.Value());
+
+                if (_config.CookieStorage.Value().empty() == false) {
+                    _storageSync.AddFile(_config.CookieStorage.Value() + _T("/cookies.db"), working + _T("cookies/cookies.db"));
+                    _config.CookieStorage = working + _T("cookies");
+                }
+                if ((_config.LocalStorage.Value().empty() == false) && (_config.LocalStorageEnabled.Value() == true)) {
+                    _storageSync.AddDirectory(_config.LocalStorage.Value() + _T("/wpe/local-storage"), working + _T("localstorage/wpe/local-storage"));
+                    _config.LocalStorage = working + _T("localstorage");
+                }
+                _storageSync.Start();
+            }
+
+            if (_config.SharedStore.Path.Value().empty() == false) {
+#ifdef WEBKIT_GLIB_API
+                _sharedCache.Open(_config.SharedStore.Path.Value(), _config.SharedStore.Size.Value());
+#else
+                TRACE(Trace::Warning, (_T("The shared cache needs the WebKit GLib API, not used")));
+#endif
+            }
+
             {
                 std::string url = _config.URL.Value();
 
@@ -2381,6 +2550,10 @@ static GSourceFuncs _handlerIntervention =
             _config.Bundle.Config(key,value);
             return (value);
         }
+        BundleConfig::Iterator GetConfigs() const
+        {
+            return (_config.Bundle.Configs());
+        }
 #ifndef WEBKIT_GLIB_API
         void NavigationRef(WKNavigationRef ref)
         {
@@ -2494,6 +2667,7 @@ static GSourceFuncs _handlerIntervention =
                         WKViewSetViewState(object->_view, (object->_hidden ? 0 : kWKViewStateIsVisible));
 #endif
                         object->OnStateChange(PluginHost::IStateControl::SUSPENDED);
+                        object->_storageSync.Trigger();
 
                         TRACE_GLOBAL(Trace::Information, (_T("Internal Suspend Notification took %d mS."), static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time)));
 
@@ -2529,6 +2703,32 @@ static GSourceFuncs _handlerIntervention =
                     this);
             }
         }
+        // Loads a blank page, so the WebProcess is launched and the injected bundle loaded before the
+        // application sets its URL. The blank page is not reported to the clients.
+        void WarmUp()
+        {
+            _warmStandby = true;
+
+            g_main_context_invoke(
+                _context,
+                [](gpointer customdata) -> gboolean {
+                    WebKitImplementation* object = static_cast<WebKitImplementation*>(customdata);
+
+                    if (object->_warmStandby == true) {
+#ifdef WEBKIT_GLIB_API
+                        webkit_web_view_load_uri(object->_view, "about:blank");
+#else
+                        auto blankURL = WKURLCreateWithUTF8CString("about:blank");
+                        WKPageLoadURL(object->_page, blankURL);
+                        WKRelease(blankURL);
+#endif
+                        TRACE_GLOBAL(Trace::Information, (_T("Warm standby: WebProcess launch requested")));
+                    }
+
+                    return G_SOURCE_REMOVE;
+                },
+                this);
+        }
         std::string GetFileContent(const std::string& fileName)
         {
             std::string content;
@@ -2546,9 +2746,43 @@ static GSourceFuncs _handlerIntervention =
         {
             webkit_web_context_set_web_extensions_directory(context, browser->_dataPath.c_str());
             // FIX it
-            GVariant* data = g_variant_new("(smsb)", std::to_string(browser->_guid).c_str(), !browser->_config.Whitelist.Value().empty() ? browser->_config.Whitelist.Value().c_str() : nullptr, browser->_config.LogToSystemConsoleEnabled.Value());
+            GVariant* data = g_variant_new("(smsbms)", std::to_string(browser->_guid).c_str(), !browser->_config.Whitelist.Value().empty() ? browser->_config.Whitelist.Value().c_str() : nullptr, browser->_config.LogToSystemConsoleEnabled.Value(),
+                browser->_sharedCache.IsOpen() == true ? browser->_config.SharedStore.Path.Value().c_str() : nullptr);
             webkit_web_context_set_web_extensions_initialization_user_data(context, data);
         }
+        static void sharedCacheRequestCallback(WebKitURISchemeRequest* request, WebKitImplementation* browser)
+        {
+            string file, type;
+            uint32_t size = 0;
+            GFileInputStream* stream = nullptr;
+
+            if (browser->_sharedCache.Lookup(SharedCache::FromCache(webkit_uri_scheme_request_get_uri(request)), file, type, size) == true) {
+                GFile* content = g_file_new_for_path(file.c_str());
+                stream = g_file_read(content, nullptr, nullptr);
+                g_object_unref(content);
+            }
+
+            if (stream != nullptr) {
+#if WEBKIT_CHECK_VERSION(2, 36, 0)
+                // Fonts and scripts of other origins are loaded in CORS mode
+                WebKitURISchemeResponse* response = webkit_uri_scheme_response_new(G_INPUT_STREAM(stream), size);
+                SoupMessageHeaders* headers = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+                soup_message_headers_append(headers, "Access-Control-Allow-Origin", "*");
+                webkit_uri_scheme_response_set_content_type(response, type.c_str());
+                webkit_uri_scheme_response_set_http_headers(response, headers);
+                webkit_uri_scheme_request_finish_with_response(request, response);
+                g_object_unref(response);
+#else
+                webkit_uri_scheme_request_finish(request, G_INPUT_STREAM(stream), size, type.c_str());
+#endif
+                g_object_unref(stream);
+            } else {
+                // Dropped from the store since the page asked for it
+                GError* error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Not in the shared cache");
+                webkit_uri_scheme_request_finish_error(request, error);
+                g_error_free(error);
+            }
+        }
         static void wpeNotifyWPEFrameworkMessageReceivedCallback(WebKitUserContentManager*, WebKitJavascriptResult* message, WebKitImplementation* browser)
         {
             JSCValue* args = webkit_javascript_result_get_js_value(message);
@@ -2578,7 +2812,11 @@ static GSourceFuncs _handlerIntervention =
         }
         static void loadChangedCallback(WebKitWebView* webView, WebKitLoadEvent loadEvent, WebKitImplementation* browser)
         {
-            if (loadEvent == WEBKIT_LOAD_FINISHED)
+            if (loadEvent == WEBKIT_LOAD_STARTED)
+                browser->OnNavigationStarted();
+            else if (loadEvent == WEBKIT_LOAD_COMMITTED)
+                browser->OnResponseReceived();
+            else if (loadEvent == WEBKIT_LOAD_FINISHED)
                 browser->OnLoadFinished();
         }
         static void webProcessTerminatedCallback(WebKitWebView* webView, WebKitWebProcessTerminationReason reason)
@@ -2662,6 +2900,14 @@ static GSourceFuncs _handlerIntervention =
                 g_signal_connect(context, "initialize-web-extensions", G_CALLBACK(initializeWebExtensionsCallback), this);
             }
 
+            if (_sharedCache.IsOpen() == true) {
+                // The injected bundle moves the requests for assets in the store to this scheme
+                webkit_web_context_register_uri_scheme(context, SHARED_CACHE_SCHEME, reinterpret_cast<WebKitURISchemeRequestCallback>(sharedCacheRequestCallback), this, nullptr);
+                auto* securityManager = webkit_web_context_get_security_manager(context);
+                webkit_security_manager_register_uri_scheme_as_secure(securityManager, SHARED_CACHE_SCHEME);
+                webkit_security_manager_register_uri_scheme_as_cors_enabled(securityManager, SHARED_CACHE_SCHEME);
+            }
+
             if (!webkit_web_context_is_ephemeral(context)) {
                 gchar* cookieDatabasePath;
                 if (_config.CookieStorage.IsSet() == true && _config.CookieStorage.Value().empty() == false)
@@ -2751,6 +2997,10 @@ static GSourceFuncs _handlerIntervention =
             }
             _adminLock.Unlock();
 
+            if (_config.WarmStandby.Value() == true) {
+                WarmUp();
+            }
+
             g_main_loop_run(_loop);
 
             if (frameDisplayedCallbackID)
@@ -2963,6 +3213,10 @@ static GSourceFuncs _handlerIntervention =
 
             _configurationCompleted.SetState(true);
 
+            if (_config.WarmStandby.Value() == true) {
+                WarmUp();
+            }
+
             g_main_loop_run(_loop);
 
             // Seems if we stop the mainloop but are not in a suspended state, there is a crash.
@@ -3132,6 +3386,7 @@ static GSourceFuncs _handlerIntervention =
         bool _compliant;
         Core::StateTrigger<bool> _configurationCompleted;
         bool _webProcessCheckInProgress;
+        std::atomic<bool> _warmStandby;
         uint32_t _unresponsiveReplyNum;
         unsigned _frameCount;
         gint64 _lastDumpTime;
@@ -3139,35 +3394,95 @@ static GSourceFuncs _handlerIntervention =
         string _userScript;
         string _userStyleSheet;
         string _securityProfileName;
+        PageTelemetry _telemetry;
+        SharedCache _sharedCache;
+        StorageSync _storageSync;
     };
 
     SERVICE_REGISTRATION(WebKitImplementation, 1, 0);
 
 #ifndef WEBKIT_GLIB_API
-    // Handles synchronous messages from injected bundle.
-    /* static */ void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
-        WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo)
+    // Handles the fire and forget messages, returns false if the name is not one of them.
+    static bool HandleBundleMessage(WebKitImplementation* browser, const string& name, WKTypeRef messageBodyObj)
     {
-        int configLen = strlen(Tags::Config);
-        const WebKitImplementation* browser = static_cast<const WebKitImplementation*>(clientInfo);
-
-        string name = WKStringToString(messageName);
+        bool handled = true;
 
-        // Depending on message name, select action.
         if (name == Tags::Notification) {
             // Message contains strings from custom JS handler "NotifyWebbridge".
             WKArrayRef messageLines = static_cast<WKArrayRef>(messageBodyObj);
 
             std::vector<string> messageStrings = ConvertWKArrayToStringVector(messageLines);
-            const_cast<WebKitImplementation*>(browser)->OnJavaScript(messageStrings);
+            browser->OnJavaScript(messageStrings);
         } else if (name == Tags::BridgeObjectQuery) {
             WKStringRef messageBodyStr = static_cast<WKStringRef>(messageBodyObj);
             string messageText = WKStringToString(messageBodyStr);
-            const_cast<WebKitImplementation*>(browser)->OnBridgeQuery(messageText);
+            browser->OnBridgeQuery(messageText);
+        } else if (name == Tags::LongTask) {
+            browser->OnLongTask(static_cast<uint32_t>(WKUInt64GetValue(static_cast<WKUInt64Ref>(messageBodyObj))));
+        } else {
+            handled = false;
+        }
+
+        return (handled);
+    }
+
+    // Handles asynchronous messages from injected bundle, these arrive as batches of [name, body] pairs.
+    /* static */ void onDidReceiveMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, const void* clientInfo)
+    {
+        WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
+
+        string name = WKStringToString(messageName);
+
+        if ((name == Tags::MessageBatch) && (WKGetTypeID(messageBodyObj) == WKArrayGetTypeID())) {
+            WKArrayRef batch = static_cast<WKArrayRef>(messageBodyObj);
+            size_t count = WKArrayGetSize(batch);
+
+            for (size_t index = 0; index < count; ++index) {
+                WKArrayRef entry = static_cast<WKArrayRef>(WKArrayGetItemAtIndex(batch, index));
+                string entryName = WKStringToString(static_cast<WKStringRef>(WKArrayGetItemAtIndex(entry, 0)));
+
+                if (HandleBundleMessage(browser, entryName, WKArrayGetItemAtIndex(entry, 1)) == false) {
+                    std::cerr << "WebBridge received batched message (" << entryName << "), but didn't process it." << std::endl;
+                }
+            }
+        } else if (HandleBundleMessage(browser, name, messageBodyObj) == false) {
+            // Unexpected message name.
+            std::cerr << "WebBridge received message (" << name << "), but didn't process it." << std::endl;
+        }
+    }
+
+    // Handles synchronous messages from injected bundle.
+    /* static */ void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo)
+    {
+        int configLen = strlen(Tags::Config);
+        const WebKitImplementation* browser = static_cast<const WebKitImplementation*>(clientInfo);
+
+        string name = WKStringToString(messageName);
+
+        // Depending on message name, select action.
+        if (HandleBundleMessage(const_cast<WebKitImplementation*>(browser), name, messageBodyObj) == true) {
+            // Older bundles post these synchronously, nothing to return.
         } else if (name == Tags::URL) {
             string url;
             static_cast<const WebKitImplementation*>(browser)->URL(url);
             *returnData = WKStringCreateWithUTF8CString(url.c_str());
+        } else if (name == Tags::Config) {
+            // The whole bundle configuration, as key, value, key, value...
+            WKMutableArrayRef configs = WKMutableArrayCreate();
+            WebKitImplementation::BundleConfig::Iterator index(browser->GetConfigs());
+
+            while (index.Next() == true) {
+                WKStringRef key = WKStringCreateWithUTF8CString(Core::ToString(index.Key()).c_str());
+                WKStringRef value = WKStringCreateWithUTF8CString(Core::ToString(index.Current().Value()).c_str());
+                WKArrayAppendItem(configs, key);
+                WKArrayAppendItem(configs, value);
+                WKRelease(value);
+                WKRelease(key);
+            }
+
+            *returnData = configs;
         } else if (name.compare(0, configLen, Tags::Config) == 0) {
             // Second part of this string is the key we are looking for, extract it...
             std::string utf8Json = Core::ToString(browser->GetConfig(name.substr(configLen)));
@@ -3188,6 +3503,7 @@ static GSourceFuncs _handlerIntervention =
         string url = WKStringToString(urlStringRef);
 
         browser->NavigationRef(navigation);
+        browser->OnNavigationStarted();
         browser->OnURLChanged(url, true);
 
         WKRelease(urlRef);
@@ -3227,6 +3543,13 @@ static GSourceFuncs _handlerIntervention =
         WKRelease(urlStringRef);
     }
 
+    /* static */ void didFinishNavigation(WKPageRef, WKNavigationRef navigation, WKTypeRef, const void* clientInfo)
+    {
+        WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
+
+        browser->OnNavigationFinished(navigation);
+    }
+
     /* static */ void requestClosure(const void*)
     {
         // WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
@@ -3283,6 +3606,7 @@ static GSourceFuncs _handlerIntervention =
             WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
             WKURLResponseRef urlResponse = WKNavigationResponseGetURLResponse(response);
             browser->SetResponseHTTPStatusCode(WKURLResponseHTTPStatusCode(urlResponse));
+            browser->OnResponseReceived();
             // WKRelease(urlResponse);
         }
     }
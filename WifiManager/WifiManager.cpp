@@ -48,6 +48,7 @@ namespace {
         {"getQuirks", &WifiManager::getQuirks},
         {"getCurrentState", &WifiManager::getCurrentState},
         {"startScan", &WifiManager::startScan},
+        {"getCachedSSIDs", &WifiManager::getCachedSSIDs},
         {"getConnectedSSID", &WifiManager::getConnectedSSID},
         {"getPairedSSID", &WifiManager::getPairedSSID},
         {"getPairedSSIDInfo", &WifiManager::getPairedSSIDInfo},
@@ -156,6 +157,16 @@ namespace WPEFramework
             return result;
         }
 
+        uint32_t WifiManager::getCachedSSIDs(const JsonObject &parameters, JsonObject &response) const
+        {
+            LOGINFOMETHOD();
+
+            uint32_t const result = wifiScan.getCachedSSIDs(parameters, response);
+
+            LOGTRACEMETHODFIN();
+            return result;
+        }
+
         uint32_t WifiManager::getConnectedSSID(const JsonObject &parameters, JsonObject &response) const
         {
             LOGINFOMETHOD();
@@ -328,6 +339,12 @@ namespace WPEFramework
             JsonObject params;
             params["state"] = static_cast<int>(state);
             params["isLNF"] = isLNF;
+            JsonObject connected;
+            if (state == WifiState::CONNECTED)
+            {
+                wifiState.getConnectedSSID(JsonObject(), connected);
+            }
+            wifiConnect.onStateChanged(state, connected, params);
             sendNotify("onWIFIStateChanged", params);
             if (state == WifiState::CONNECTED)
             {
@@ -356,11 +373,12 @@ namespace WPEFramework
             sendNotify("onSSIDsChanged", JsonObject());
         }
 
-        void WifiManager::onWifiSignalThresholdChanged(float signalStrength, const std::string &strength)
+        void WifiManager::onWifiSignalThresholdChanged(float signalStrength, const std::string &strength, int linkQuality)
         {
             JsonObject params;
             params["signalStrength"] = std::to_string(signalStrength);
             params["strength"] = strength;
+            params["linkQuality"] = linkQuality;
             Notify("onWifiSignalThresholdChanged", params);
         }
 
@@ -61,6 +61,7 @@ namespace WPEFramework {
             virtual uint32_t getCurrentState(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t startScan(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t stopScan(const JsonObject& parameters, JsonObject& response) override;
+            virtual uint32_t getCachedSSIDs(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t getConnectedSSID(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t setEnabled(const JsonObject& parameters, JsonObject& response) override;
             virtual uint32_t connect(const JsonObject& parameters, JsonObject& response) override;
@@ -82,7 +83,7 @@ namespace WPEFramework {
             virtual void onWIFIStateChanged(WifiState state, bool isLNF) override;
             virtual void onError(ErrorCode code) override;
             virtual void onSSIDsChanged() override;
-            virtual void onWifiSignalThresholdChanged(float signalStrength, const std::string &strength) override;
+            virtual void onWifiSignalThresholdChanged(float signalStrength, const std::string &strength, int linkQuality) override;
             virtual void onAvailableSSIDs(JsonObject const& ssids) override;
             //End events
 
@@ -18,15 +18,35 @@
 **/
 
 #include "WifiManagerConnect.h"
+#include "WifiManagerWpaControl.h"
 
 #include "wifiSrvMgrIarmIf.h"
 #include "libIBus.h"
 #include "utils.h"
 
 #include <cstring>
+#include <time.h>
 
 using namespace WPEFramework::Plugin;
 
+namespace {
+    // Time for the scan of a single channel to report its results
+    const int directedScanTimeoutMs = 1500;
+    // A state change this long after the connect request is not its outcome anymore
+    const long long attemptTimeoutMs = 60000;
+
+    long long nowMs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+}
+
+WifiManagerConnect::WifiManagerConnect()
+{
+    attempt.active = false;
+}
+
 uint32_t WifiManagerConnect::connect(const JsonObject &parameters, JsonObject &response)
 {
     JsonObject params = parameters;
@@ -86,13 +106,32 @@ bool WifiManagerConnect::connect(const std::string &ssid, const std::string &pas
     IARM_Bus_WiFiSrvMgr_Param_t param;
     memset(&param, 0, sizeof(param));
 
+    long long startMs = nowMs();
+    bool directed = false;
+
     if(ssid.length() || passphrase.length())
     {
         ssid.copy(param.data.connect.ssid, sizeof(param.data.connect.ssid) - 1);
         passphrase.copy(param.data.connect.passphrase, sizeof(param.data.connect.passphrase) - 1);
         param.data.connect.security_mode = (SsidSecurity)securityMode;
+
+        Profile profile;
+        bool known = false;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = profiles.find(ssid);
+            if (it != profiles.end() && it->second.securityMode == securityMode) {
+                profile = it->second;
+                known = true;
+            }
+        }
+        if (known) {
+            directed = directedScan(profile);
+            LOGINFO("directed scan for %s on %d MHz: %s", ssid.c_str(), profile.frequency, directed ? "found" : "not found, full scan");
+        }
     }
 
+    long long requestMs = nowMs();
     retVal = IARM_Bus_Call( IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_WIFI_MGR_API_connect, (void *)&param, sizeof(param));
 
     if(retVal == IARM_RESULT_SUCCESS && param.status)
@@ -100,5 +139,72 @@ bool WifiManagerConnect::connect(const std::string &ssid, const std::string &pas
         success = true;
     }
 
+    std::lock_guard<std::mutex> guard(lock);
+    attempt.active = success;
+    attempt.ssid = ssid;
+    attempt.directed = directed;
+    attempt.startMs = startMs;
+    attempt.scanMs = requestMs - startMs;
+    attempt.requestMs = nowMs() - requestMs;
+
     return success;
 }
+
+bool WifiManagerConnect::directedScan(const Profile &profile)
+{
+    if (profile.frequency <= 0 || profile.bssid.empty())
+        return false;
+
+    WifiManagerWpaControl wpa;
+    if (!wpa.open("connect", true))
+        return false;
+
+    std::string reply;
+    if (!wpa.request("SCAN freq=" + std::to_string(profile.frequency), reply) || reply.compare(0, 2, "OK") != 0) {
+        LOGWARN("directed scan not started: %s", reply.c_str());
+        return false;
+    }
+    if (!wpa.waitFor("CTRL-EVENT-SCAN-RESULTS", directedScanTimeoutMs))
+        return false;
+
+    // An unknown BSS gets an empty reply
+    return wpa.request("BSS " + profile.bssid, reply) && reply.find("bssid=") != std::string::npos;
+}
+
+void WifiManagerConnect::onStateChanged(WifiState state, const JsonObject &connected, JsonObject &event)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (state == WifiState::CONNECTED && connected.HasLabel("ssid")) {
+        const std::string ssid = connected["ssid"].String();
+        Profile &profile = profiles[ssid];
+        profile.bssid = connected["bssid"].String();
+        try {
+            profile.frequency = static_cast<int>(std::stof(connected["frequency"].String()) * 1000 + 0.5f);
+            profile.securityMode = static_cast<SecurityMode>(std::stoi(connected["security"].String()));
+        } catch (...) {
+            profiles.erase(ssid);
+        }
+    }
+
+    if (!attempt.active || (state != WifiState::CONNECTED && state != WifiState::FAILED))
+        return;
+
+    long long now = nowMs();
+    attempt.active = false;
+    if (now - attempt.startMs > attemptTimeoutMs)
+        return;
+
+    if (state == WifiState::FAILED && attempt.directed) {
+        // The network may have moved, the next connect scans all channels
+        profiles.erase(attempt.ssid);
+    }
+
+    JsonObject timing;
+    timing["directed"] = attempt.directed;
+    timing["scanMs"] = static_cast<int>(attempt.scanMs);
+    timing["requestMs"] = static_cast<int>(attempt.requestMs);
+    timing["associationMs"] = static_cast<int>(now - attempt.startMs - attempt.scanMs - attempt.requestMs);
+    timing["totalMs"] = static_cast<int>(now - attempt.startMs);
+    event["connectTiming"] = timing;
+}
@@ -22,13 +22,20 @@
 #include "../Module.h"
 #include "../WifiManagerDefines.h"
 
+#include <map>
+#include <mutex>
 #include <string>
 
 namespace WPEFramework {
     namespace Plugin {
+        // The network a connect ends up on is kept as a profile per SSID (BSSID, channel,
+        // security). A later connect to the SSID first scans only the channel of the profile
+        // through wpa_supplicant, so that the supplicant has fresh scan results to associate
+        // from instead of scanning all channels; when the BSS is not found there the connect
+        // goes ahead as before.
         class WifiManagerConnect {
         public:
-            WifiManagerConnect() = default;
+            WifiManagerConnect();
             virtual ~WifiManagerConnect() = default;
             WifiManagerConnect(const WifiManagerConnect&) = delete;
             WifiManagerConnect& operator=(const WifiManagerConnect&) = delete;
@@ -36,8 +43,33 @@ namespace WPEFramework {
             uint32_t connect(const JsonObject& parameters, JsonObject& response);
             uint32_t disconnect(const JsonObject& parameters, JsonObject& response);
 
+            // State changes, connected is the getConnectedSSID response once CONNECTED. Adds the
+            // phase timing of the connect that ended here, if any, to event.
+            void onStateChanged(WifiState state, const JsonObject &connected, JsonObject &event);
+
         private:
+            struct Profile {
+                std::string bssid;
+                int frequency;                      // MHz
+                SecurityMode securityMode;
+            };
+
+            struct Attempt {
+                bool active;
+                std::string ssid;
+                bool directed;                      // the BSS of the profile was found on its channel
+                long long startMs;
+                long long scanMs;
+                long long requestMs;
+            };
+
             bool connect(const std::string &ssid, const std::string &passphrase, SecurityMode securityMode);
+            static bool directedScan(const Profile &profile);
+
+        private:
+            std::mutex lock;
+            std::map<std::string, Profile> profiles;
+            Attempt attempt;
         };
     }
 }
@@ -31,6 +31,7 @@
 #include "wifiSrvMgrIarmIf.h"
 
 // std
+#include <cmath>
 #include <sstream>
 #include <regex>
 
@@ -53,9 +54,35 @@ namespace
     char const* const g_ssids = "ssids";
     char const* const g_SSID_name = "SSID_name";
     char const* const g_timeout = "timeout";
+    char const* const g_bssid = "bssid";
+    char const* const g_security = "security";
+    char const* const g_signalStrength = "signalStrength";
+    char const* const g_age = "age";
+    char const* const g_maxAge = "maxAge";
+
+    // Access points not seen by a scan for this long are forgotten
+    const std::chrono::seconds g_cacheLifetime(300);
+    // Smaller changes of the signal strength (dBm) are not worth an update
+    const double g_signalStrengthDelta = 5.0;
+
+    std::string cacheKey(JsonObject &ssid)
+    {
+        std::string bssid = ssid.HasLabel(g_bssid) ? ssid[g_bssid].String() : std::string();
+        return bssid.empty() ? (ssid[g_ssid].String() + "/" + ssid[g_frequency].String()) : bssid;
+    }
+
+    bool hasChanged(JsonObject &cached, JsonObject &ssid)
+    {
+        return (cached[g_ssid].String() != ssid[g_ssid].String()) ||
+               (cached[g_security].String() != ssid[g_security].String()) ||
+               (cached[g_frequency].String() != ssid[g_frequency].String()) ||
+               (std::fabs(atof(cached[g_signalStrength].String().c_str()) - atof(ssid[g_signalStrength].String().c_str())) >= g_signalStrengthDelta);
+    }
 }
 
 WifiManagerScan::Filter WifiManagerScan::filter = {};
+std::map<std::string, WifiManagerScan::CacheEntry> WifiManagerScan::cache;
+std::mutex WifiManagerScan::cacheMutex;
 
 /**
  * \brief Register event handlers.
@@ -173,7 +200,8 @@ uint32_t WifiManagerScan::getAvailableSSIDsAsync(const JsonObject& parameters, J
  * \brief Get the available access points asynchronously and in increments.
  *
  * The results are published via the "onAvailableSSIDsIncr" event. Currently this is done in three stages:
- * high priority 5GHz; 2.4GHz; low priority 5GHz.
+ * high priority 5GHz; 2.4GHz; low priority 5GHz. Each event only carries the access points which are
+ * new or changed since the last scan, 'getCachedSSIDs' has the rest.
  *
  * \param parameters    There are no parameters to this method.
  * \param[out] response Whether the call succeeded, not the results.
@@ -232,6 +260,61 @@ uint32_t WifiManagerScan::stopScan(const JsonObject& parameters, JsonObject& res
     returnResponse(res == IARM_RESULT_SUCCESS);
 }
 
+/**
+ * \brief Get the access points found by earlier scans, without scanning.
+ *
+ * \param parameters        Optionally includes 'ssid' and/or 'frequency' (as for 'startScan') and 'maxAge' in seconds.
+ * \param[out] response     The 'ssids', each with the 'age' in seconds since a scan last saw it.
+ * \return                  A code indicating success.
+ *
+ */
+uint32_t WifiManagerScan::getCachedSSIDs(const JsonObject &parameters, JsonObject &response) const
+{
+    LOGINFOMETHOD();
+
+    Filter cacheFilter;
+    if (parameters.HasLabel(g_ssid)) {
+        std::string ssid;
+        getStringParameter(g_ssid, ssid);
+        if (ssid.length()) {
+            cacheFilter.onSsid = true;
+            cacheFilter.ssid = ssid;
+        }
+    }
+    if (parameters.HasLabel(g_frequency)) {
+        std::string frequency;
+        getStringParameter(g_frequency, frequency);
+        if (frequency.length()) {
+            cacheFilter.onFrequency = true;
+            cacheFilter.frequency = frequency;
+        }
+    }
+    int maxAge = -1;
+    if (parameters.HasLabel(g_maxAge)) {
+        getNumberParameter(g_maxAge, maxAge);
+    }
+
+    JsonArray ssids;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto const now = std::chrono::steady_clock::now();
+
+        for (auto const& entry : cache) {
+            auto const age = std::chrono::duration_cast<std::chrono::seconds>(now - entry.second.seen).count();
+            if ((maxAge >= 0) && (age > maxAge))
+                continue;
+
+            JsonObject ssid = entry.second.ssid;
+            ssid[g_age] = static_cast<int>(age);
+            ssids.Add(ssid);
+        }
+    }
+    applyFilter(ssids, cacheFilter);
+
+    response[g_ssids] = ssids;
+    returnResponse(true);
+}
+
 /**
  * \brief Handle events from the IARM bus relating to wireless scanning.
  *
@@ -266,6 +349,14 @@ void WifiManagerScan::iarmEventHandler(char const* owner, IARM_EventId_t eventId
         }
 
         JsonArray ssids = eventDocument[g_getAvailableSSIDs].Array();
+
+        // An incremental scan only reports what is not known from earlier scans already
+        if (eventId == IARM_BUS_WIFI_MGR_EVENT_onAvailableSSIDsIncr) {
+            updateCache(ssids);
+        } else {
+            JsonArray all = ssids;
+            updateCache(all);
+        }
         applyFilter(ssids, filter);
 
         JsonObject params;
@@ -310,3 +401,42 @@ void WifiManagerScan::applyFilter(JsonArray &ssids, const WifiManagerScan::Filte
     }
     ssids = result;
 }
+
+/**
+ * \brief Record the scanned access points and keep only those new or changed since the last scan.
+ *
+ * \param[in,out] ssids     The scan results, on return only those which were not in the cache as they are.
+ *
+ */
+void WifiManagerScan::updateCache(JsonArray &ssids)
+{
+    JsonArray updated;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto const now = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ssids.Length(); i++) {
+        JsonObject object = ssids[i].Object();
+        auto const key = cacheKey(object);
+        auto entry = cache.find(key);
+
+        if (entry == cache.end()) {
+            cache[key] = { object, now };
+            updated.Add(object);
+        } else {
+            if (hasChanged(entry->second.ssid, object)) {
+                entry->second.ssid = object;
+                updated.Add(object);
+            }
+            entry->second.seen = now;
+        }
+    }
+
+    for (auto entry = cache.begin(); entry != cache.end(); ) {
+        if ((now - entry->second.seen) > g_cacheLifetime)
+            entry = cache.erase(entry);
+        else
+            ++entry;
+    }
+
+    ssids = updated;
+}
@@ -21,6 +21,9 @@
 
 #include "../Module.h"
 
+#include <chrono>
+#include <map>
+#include <mutex>
 #include <string>
 
 // Forward declaration
@@ -44,6 +47,7 @@ namespace WPEFramework {
 
             uint32_t startScan(const JsonObject& parameters, JsonObject& response) const;
             uint32_t stopScan(const JsonObject& parameters, JsonObject& response);
+            uint32_t getCachedSSIDs(const JsonObject& parameters, JsonObject& response) const;
 
         private:
             uint32_t getAvailableSSIDsAsync(const JsonObject& parameters, JsonObject& response) const;
@@ -60,6 +64,16 @@ namespace WPEFramework {
 
             static void applyFilter(JsonArray &object, const WifiManagerScan::Filter &filter);
             static Filter filter;
+
+            // Every access point seen by any scan, by BSSID
+            struct CacheEntry {
+                JsonObject ssid;
+                std::chrono::steady_clock::time_point seen;
+            };
+
+            static void updateCache(JsonArray &ssids);
+            static std::map<std::string, CacheEntry> cache;
+            static std::mutex cacheMutex;
         };
     } // namespace Plugin
 } // namespace WPEFramework
@@ -18,10 +18,18 @@
 **/
 
 #include "WifiManagerSignalThreshold.h"
+#include "WifiManagerWpaControl.h"
 
 #include "utils.h"
 
-#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
 
 using namespace WPEFramework::Plugin;
 
@@ -30,31 +38,89 @@ namespace {
     const float signalStrengthThresholdGood = -60.0f;
     const float signalStrengthThresholdFair = -67.0f;
 
-    void getSignalData(WifiManagerInterface &wifiManager, float &signalStrengthOut, std::string &strengthOut) {
+    // Weight of a new sample in the smoothed signal strength
+    const float signalSmoothing = 0.3f;
+    // dB the smoothed signal has to be past a threshold to leave the current strength
+    const float signalHysteresis = 3.0f;
+    // With wpa_supplicant events, a stable signal is sampled up to this many intervals apart
+    const int maxIntervalBackoff = 4;
+
+    // The wpa_supplicant events a sample is taken for right away
+    const char* const linkEvents[] = { "CTRL-EVENT-SIGNAL-CHANGE", "CTRL-EVENT-CONNECTED", "CTRL-EVENT-DISCONNECTED", nullptr };
+
+    struct SignalData {
+        float signalStrength;
+        float noise;
+        float rate;
+    };
+
+    float numberOf(const JsonObject &response, const char* label) {
+        float value = 0.0f;
+        if (response.HasLabel(label)) {
+            try {
+                value = std::stof(response[label].String());
+            } catch (...) {
+                value = 0.0f;
+            }
+        }
+        return value;
+    }
+
+    void getSignalData(WifiManagerInterface &wifiManager, SignalData &data) {
         JsonObject response;
         wifiManager.getConnectedSSID(JsonObject(), response);
 
-        signalStrengthOut = 0.0f;
-        if (response.HasLabel("signalStrength")) {
-            signalStrengthOut = std::stof(response["signalStrength"].String());
+        data.signalStrength = numberOf(response, "signalStrength");
+        data.noise = numberOf(response, "noise");
+        data.rate = numberOf(response, "rate");
+    }
+
+    // The strength signalStrength is in, leaving current only when past its limits by the hysteresis
+    std::string strengthOf(float signalStrength, const std::string &current) {
+        const float limits[] = { signalStrengthThresholdExcellent, signalStrengthThresholdGood, signalStrengthThresholdFair };
+        const char* const names[] = { "Excellent", "Good", "Fair", "Weak" };
+
+        int band = 3;
+        if (signalStrength < 0) {
+            for (band = 0; band < 3 && signalStrength < limits[band]; band++);
         }
 
-        if (signalStrengthOut >= signalStrengthThresholdExcellent && signalStrengthOut < 0)
-        {
-            strengthOut = "Excellent";
+        int currentBand = -1;
+        for (int i = 0; i < 4; i++) {
+            if (current == names[i])
+                currentBand = i;
         }
-        else if (signalStrengthOut >= signalStrengthThresholdGood && signalStrengthOut < signalStrengthThresholdExcellent)
-        {
-            strengthOut = "Good";
+
+        if (currentBand >= 0 && band != currentBand && signalStrength < 0) {
+            // Moving up has to clear the upper limit of the current band, moving down the lower one
+            if (band < currentBand && signalStrength < limits[currentBand - 1] + signalHysteresis)
+                band = currentBand;
+            else if (band > currentBand && currentBand < 3 && signalStrength > limits[currentBand] - signalHysteresis)
+                band = currentBand;
         }
-        else if (signalStrengthOut >= signalStrengthThresholdFair && signalStrengthOut < signalStrengthThresholdGood)
-        {
-            strengthOut = "Fair";
+
+        return names[band];
+    }
+
+    // 0..100 from the signal strength, the signal to noise ratio and the bit rate, when known
+    int linkQualityOf(const SignalData &data, float smoothed) {
+        float total = 0.0f;
+        float weights = 0.0f;
+
+        total += 0.5f * std::min(std::max((smoothed + 90.0f) / 60.0f, 0.0f), 1.0f);
+        weights += 0.5f;
+
+        if (data.noise < 0 && data.signalStrength > data.noise) {
+            total += 0.3f * std::min((data.signalStrength - data.noise) / 40.0f, 1.0f);
+            weights += 0.3f;
         }
-        else
-        {
-            strengthOut = "Weak";
-        };
+
+        if (data.rate > 0) {
+            total += 0.2f * std::min(data.rate / 433.0f, 1.0f);
+            weights += 0.2f;
+        }
+
+        return static_cast<int>(100.0f * total / weights + 0.5f);
     }
 }
 
@@ -63,6 +129,7 @@ WifiManagerSignalThreshold::WifiManagerSignalThreshold(WifiManagerInterface &wif
     wifiManager(wifiManager),
     running(false)
 {
+    wakeFds[0] = wakeFds[1] = -1;
 }
 
 WifiManagerSignalThreshold::~WifiManagerSignalThreshold()
@@ -141,38 +208,86 @@ bool WifiManagerSignalThreshold::isSignalThresholdChangeEnabled() const
     return changeEnabled;
 }
 
+// Waits for timeoutMs, a stop or a link change reported by wpa_supplicant; true on a link change
+bool WifiManagerSignalThreshold::waitForChange(WifiManagerWpaControl &wpaEvents, int timeoutMs)
+{
+    struct pollfd fds[2];
+    fds[0].fd = wakeFds[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = wpaEvents.descriptor();
+    fds[1].events = POLLIN;
+
+    int ready = poll(fds, wpaEvents.isOpen() ? 2 : 1, timeoutMs);
+    if (ready <= 0)
+        return false;
+
+    return wpaEvents.isOpen() && (fds[1].revents & POLLIN) && wpaEvents.readEvents(linkEvents);
+}
+
 void WifiManagerSignalThreshold::loop(int interval)
 {
-    std::unique_lock<std::mutex> lk(cv_mutex);
     std::string lastStrength = "";
+    float smoothed = 0.0f;
+    bool haveSample = false;
+    int backoff = 1;
+
+    WifiManagerWpaControl wpaEvents;
+    if (wpaEvents.open("signal", true))
+        LOGINFO("sampling the signal on wpa_supplicant events too");
 
     while(changeEnabled)
     {
-        float signalStrength;
-        std::string strength;
         if (running)
         {
-            getSignalData(wifiManager, signalStrength, strength);
+            SignalData data;
+            getSignalData(wifiManager, data);
+
+            smoothed = haveSample ? smoothed + signalSmoothing * (data.signalStrength - smoothed) : data.signalStrength;
+            haveSample = true;
 
+            std::string strength = strengthOf(smoothed, lastStrength);
 
             if (strength != lastStrength)
             {
                 LOGINFO("Triggering onWifiSignalThresholdChanged notification");
-                wifiManager.onWifiSignalThresholdChanged(signalStrength, strength);
+                wifiManager.onWifiSignalThresholdChanged(smoothed, strength, linkQualityOf(data, smoothed));
                 lastStrength = strength;
+                backoff = 1;
             }
+            else if (wpaEvents.isOpen() && backoff < maxIntervalBackoff)
+            {
+                backoff++;
+            }
+        }
+        else
+        {
+            // Not connected, start over with the next connection
+            haveSample = false;
+            lastStrength = "";
+            backoff = 1;
         }
-        cv.wait_for(lk, std::chrono::milliseconds(interval), [this](){ return changeEnabled == false; });
+
+        if (waitForChange(wpaEvents, interval * backoff))
+            backoff = 1;
     }
 }
 
 void WifiManagerSignalThreshold::stopThread()
 {
     changeEnabled = false;
-    cv.notify_one();
+    if (wakeFds[1] >= 0) {
+        if (write(wakeFds[1], "", 1) < 0)
+            LOGWARN("can't wake the signal threshold thread: %s", strerror(errno));
+    }
     if(thread.joinable()) {
         thread.join();
     }
+    for (int i = 0; i < 2; i++) {
+        if (wakeFds[i] >= 0) {
+            close(wakeFds[i]);
+            wakeFds[i] = -1;
+        }
+    }
     running = false ;
 }
 
@@ -185,6 +300,11 @@ void WifiManagerSignalThreshold::setSignalThresholdChangeEnabled(bool enable)
 
 void WifiManagerSignalThreshold::startThread(int interval)
 {
+    if (pipe2(wakeFds, O_CLOEXEC | O_NONBLOCK) != 0) {
+        LOGERR("can't create the wake pipe: %s", strerror(errno));
+        wakeFds[0] = wakeFds[1] = -1;
+        return;
+    }
     thread = std::thread([interval, this](){
         loop(interval);
     });
@@ -24,12 +24,12 @@
 #include "../WifiManagerInterface.h"
 
 #include <atomic>
-#include <condition_variable>
-#include <mutex>
 #include <thread>
 
 namespace WPEFramework {
     namespace Plugin {
+        class WifiManagerWpaControl;
+
         class WifiManagerSignalThreshold {
             // This class realizes the following methods:
             // - setSignalThresholdChangeEnabled
@@ -39,7 +39,10 @@ namespace WPEFramework {
             // From WifiManager module.
             //
             // As the onWifiSignalTresholdChanged event is signalled periodically,
-            // it has to be handled with an additional thread.
+            // it has to be handled with an additional thread. The thread samples the
+            // signal every interval, or right away when wpa_supplicant reports a change
+            // on its control interface; the samples are smoothed and a strength is only
+            // left when the smoothed signal is a hysteresis past its limit.
         public:
             WifiManagerSignalThreshold(WifiManagerInterface &wifiManager);
             virtual ~WifiManagerSignalThreshold();
@@ -57,14 +60,14 @@ namespace WPEFramework {
             void loop(int interval);
             void stopThread();
             void startThread(int interval);
+            bool waitForChange(WifiManagerWpaControl &wpaEvents, int timeoutMs);
 
         private:
             std::thread thread;
             std::atomic<bool> changeEnabled;
-            std::mutex cv_mutex;
-            std::condition_variable cv;
             WifiManagerInterface &wifiManager;
-            bool running;
+            std::atomic<bool> running;
+            int wakeFds[2];
         };
     }
 }
@@ -0,0 +1,181 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "WifiManagerWpaControl.h"
+
+#include "utils.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+    const char* const wpaCtrlDir = "/var/run/wpa_supplicant";
+    const char* const wpaDefaultInterface = "wlan0";
+
+    long long nowMs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    // Unsolicited messages start with the level, as in "<3>CTRL-EVENT-..."
+    bool isEvent(const char* message) {
+        return message[0] == '<';
+    }
+
+    bool isEventOf(const char* message, const char* event) {
+        const char* end = isEvent(message) ? strchr(message, '>') : nullptr;
+        return end != nullptr && strncmp(end + 1, event, strlen(event)) == 0;
+    }
+}
+
+WifiManagerWpaControl::WifiManagerWpaControl():
+    fd(-1),
+    attached(false)
+{
+}
+
+WifiManagerWpaControl::~WifiManagerWpaControl()
+{
+    close();
+}
+
+bool WifiManagerWpaControl::open(const char* tag, bool attach)
+{
+    close();
+
+    const char* iface = getenv("WIFI_INTERFACE");
+    std::string path = std::string(wpaCtrlDir) + "/" + ((iface != nullptr && iface[0] != '\0') ? iface : wpaDefaultInterface);
+
+    if (access(path.c_str(), F_OK) != 0)
+        return false;
+
+    fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+        return false;
+
+    struct sockaddr_un local;
+    memset(&local, 0, sizeof(local));
+    local.sun_family = AF_UNIX;
+    snprintf(local.sun_path, sizeof(local.sun_path), "/tmp/wifimgr_%s_%d", tag, getpid());
+    localPath = local.sun_path;
+    unlink(local.sun_path);
+
+    struct sockaddr_un remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sun_family = AF_UNIX;
+    snprintf(remote.sun_path, sizeof(remote.sun_path), "%s", path.c_str());
+
+    std::string reply;
+    if (bind(fd, (struct sockaddr*) &local, sizeof(local)) != 0
+        || connect(fd, (struct sockaddr*) &remote, sizeof(remote)) != 0
+        || (attach && (!request("ATTACH", reply) || reply.compare(0, 2, "OK") != 0))) {
+        LOGWARN("can't use the wpa_supplicant control interface %s: %s", path.c_str(), strerror(errno));
+        close();
+        return false;
+    }
+
+    attached = attach;
+    return true;
+}
+
+void WifiManagerWpaControl::close()
+{
+    if (fd >= 0) {
+        if (attached)
+            send(fd, "DETACH", 6, 0);
+        ::close(fd);
+        fd = -1;
+    }
+    if (!localPath.empty()) {
+        unlink(localPath.c_str());
+        localPath.clear();
+    }
+    attached = false;
+}
+
+bool WifiManagerWpaControl::request(const std::string &command, std::string &reply, int timeoutMs)
+{
+    if (fd < 0 || send(fd, command.c_str(), command.size(), 0) != (ssize_t) command.size())
+        return false;
+
+    long long deadline = nowMs() + timeoutMs;
+    char buffer[4096];
+
+    while (true) {
+        int left = (int) (deadline - nowMs());
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (left <= 0 || poll(&pfd, 1, left) <= 0)
+            return false;
+
+        ssize_t length = recv(fd, buffer, sizeof(buffer) - 1, 0);
+        if (length < 0)
+            return false;
+        buffer[length] = '\0';
+
+        if (!isEvent(buffer)) {
+            reply.assign(buffer, length);
+            return true;
+        }
+    }
+}
+
+bool WifiManagerWpaControl::waitFor(const char* event, int timeoutMs)
+{
+    long long deadline = nowMs() + timeoutMs;
+    char buffer[512];
+
+    while (fd >= 0) {
+        int left = (int) (deadline - nowMs());
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (left <= 0 || poll(&pfd, 1, left) <= 0)
+            return false;
+
+        ssize_t length;
+        while ((length = recv(fd, buffer, sizeof(buffer) - 1, 0)) > 0) {
+            buffer[length] = '\0';
+            if (isEventOf(buffer, event))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool WifiManagerWpaControl::readEvents(const char* const events[])
+{
+    bool found = false;
+    char buffer[512];
+    ssize_t length;
+
+    while (fd >= 0 && (length = recv(fd, buffer, sizeof(buffer) - 1, 0)) > 0) {
+        buffer[length] = '\0';
+        for (int i = 0; events[i] != nullptr && !found; i++)
+            found = isEventOf(buffer, events[i]);
+    }
+    return found;
+}
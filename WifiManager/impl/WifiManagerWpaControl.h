@@ -0,0 +1,59 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <string>
+
+namespace WPEFramework {
+    namespace Plugin {
+        class WifiManagerWpaControl {
+            // A client of the wpa_supplicant control interface of the wifi interface
+            // (WIFI_INTERFACE, wlan0 by default). The network is still managed by the
+            // wifi service manager; this is only used to listen to the supplicant's
+            // events and for requests that don't change its configuration, like scans.
+        public:
+            WifiManagerWpaControl();
+            virtual ~WifiManagerWpaControl();
+            WifiManagerWpaControl(const WifiManagerWpaControl&) = delete;
+            WifiManagerWpaControl& operator=(const WifiManagerWpaControl&) = delete;
+
+            // tag keeps the local sockets of the clients apart; attach to receive the events
+            bool open(const char* tag, bool attach);
+            void close();
+            bool isOpen() const { return fd >= 0; }
+            int descriptor() const { return fd; }
+
+            // Sends command and returns its reply, false on a failure or timeout. Events that
+            // come in before the reply are dropped.
+            bool request(const std::string &command, std::string &reply, int timeoutMs = 1000);
+
+            // Waits up to timeoutMs for an event starting with (after the level) event
+            bool waitFor(const char* event, int timeoutMs);
+
+            // Whether the pending events include one of events, a null terminated list
+            bool readEvents(const char* const events[]);
+
+        private:
+            int fd;
+            bool attached;
+            std::string localPath;
+        };
+    }
+}
@@ -27,7 +27,7 @@ using namespace WPEFramework;
 #define LOCATE_CAST_SECOND_TIMEOUT_IN_MILLIS 15000  //15 seconds
 #define LOCATE_CAST_THIRD_TIMEOUT_IN_MILLIS  30000  //30 seconds
 #define LOCATE_CAST_FINAL_TIMEOUT_IN_MILLIS  60000  //60 seconds
-#define EVENT_LOOP_ITERATION_IN_100MS     100000
+#define EVENT_LOOP_ITERATION_IN_20MS      20000
 
 static rtObjectRef xdialCastObj = NULL;
 RtXcastConnector * RtXcastConnector::_instance = nullptr;
@@ -42,8 +42,10 @@ void RtXcastConnector::processRtMessages(){
     LOGINFO("Entering Event Loop");
     while(true)
     {
-        rtError err = rtRemoteProcessSingleItem();
-        if (err != RT_OK && err != RT_ERROR_QUEUE_EMPTY) {
+        // Drain everything that is queued, so a burst of DIAL requests isn't served one per iteration
+        rtError err;
+        while ((err = rtRemoteProcessSingleItem()) == RT_OK);
+        if (err != RT_ERROR_QUEUE_EMPTY) {
             LOGERR("Failed to gete item from Rt queue");
         }
         {
@@ -55,7 +57,7 @@ void RtXcastConnector::processRtMessages(){
          Ideally this should be part of wpe process main message loop,
          will reconsider once we decide on connectivity with dial server
         */
-        usleep(EVENT_LOOP_ITERATION_IN_100MS);
+        usleep(EVENT_LOOP_ITERATION_IN_20MS);
     }
     LOGINFO("Exiting Event Loop");
 }
@@ -228,6 +230,13 @@ int RtXcastConnector::connectToRemoteService()
     err = rtRemoteLocateObject(rtEnvironmentGetGlobal(), serviceName, xdialCastObj, timeout, &RtXcastConnector::remoteDisconnectCallback, m_observer);
     if(err == RT_OK && xdialCastObj != NULL)
     {
+        {
+            // A new server instance, everything has to be sent again
+            lock_guard<mutex> lock(m_stateLock);
+            m_activation = -1;
+            m_friendlyNameSent = false;
+            m_appsSent = false;
+        }
         rtError e = xdialCastObj.send("on", "onApplicationLaunchRequest" , new rtFunctionCallback(RtXcastConnector::onApplicationLaunchRequestCallback, m_observer));
         LOGINFO("Registered onApplicationLaunchRequest ; response %d" ,e );
         e = xdialCastObj.send("on", "onApplicationStopRequest" , new rtFunctionCallback(RtXcastConnector::onApplicationStopRequestCallback, m_observer));
@@ -313,8 +322,14 @@ int RtXcastConnector::applicationStateChanged( string app, string state, string
 void RtXcastConnector::enableCastService(bool enableService)
 {
     LOGINFO("XcastService::enableCastService ARGS = %d ", enableService);
-    if(xdialCastObj != NULL)
+    lock_guard<mutex> lock(m_stateLock);
+    if(xdialCastObj != NULL && m_activation == (enableService ? 1 : 0))
     {
+        LOGINFO("XcastService cast service already %s", enableService ? "enabled" : "disabled");
+    }
+    else if(xdialCastObj != NULL)
+    {
+        m_activation = enableService ? 1 : 0;
         rtObjectRef e = new rtMapObject;
         e.set("activation",(enableService ? "true": "false"));
         int ret = xdialCastObj.send("onActivationChanged", e);
@@ -329,8 +344,15 @@ void RtXcastConnector::enableCastService(bool enableService)
 void RtXcastConnector::setFriendlyName(string friendlyname)
 {
     LOGINFO("XcastService::setFriendlyName ARGS = %s", friendlyname.c_str());
-    if(xdialCastObj != NULL)
+    lock_guard<mutex> lock(m_stateLock);
+    if(xdialCastObj != NULL && m_friendlyNameSent && m_friendlyName == friendlyname)
     {
+        LOGINFO("XcastService friendly name unchanged");
+    }
+    else if(xdialCastObj != NULL)
+    {
+        m_friendlyName = friendlyname;
+        m_friendlyNameSent = true;
         rtObjectRef e = new rtMapObject;
         e.set("friendlyname", friendlyname.c_str());
         int ret = xdialCastObj.send("onFriendlyNameChanged", e);
@@ -357,7 +379,12 @@ void RtXcastConnector::updateFriendlyName(string friendlyname)
 }
 
 void RtXcastConnector::clearAppLaunchParamList (){
-   for (RegAppLaunchParams regAppLaunchParam : m_appLaunchParamList) {
+   lock_guard<mutex> lock(m_appLaunchParamLock);
+   freeAppLaunchParams (m_appLaunchParamList);
+}
+
+void RtXcastConnector::freeAppLaunchParams (std::list<RegAppLaunchParams>& appLaunchParams){
+   for (RegAppLaunchParams regAppLaunchParam : appLaunchParams) {
        if (NULL != regAppLaunchParam.appName) {
            free (regAppLaunchParam.appName);
            regAppLaunchParam.appName = NULL;
@@ -371,10 +398,11 @@ void RtXcastConnector::clearAppLaunchParamList (){
            regAppLaunchParam.payload = NULL;
        }
     }
-    m_appLaunchParamList.clear();
+    appLaunchParams.clear();
 }
 
 bool RtXcastConnector::getEntryFromAppLaunchParamList (const char* appName, RegAppLaunchParams* reqParam){
+    lock_guard<mutex> lock(m_appLaunchParamLock);
     bool isEntryFound = false;
     for (RegAppLaunchParams regAppLaunchParam : m_appLaunchParamList) {
         if (0 == strcmp (regAppLaunchParam.appName, appName)) {
@@ -424,6 +452,23 @@ void RtXcastConnector::registerApplications(string strApps)
     cJSON *jLaunchParam = NULL;
     cJSON *jQuery = NULL;
     cJSON *jPayload = NULL;
+
+    {
+        // The same list again, e.g. after a reconnect: send what was built last time
+        lock_guard<mutex> lock(m_stateLock);
+        if (!strApps.empty() && strApps == m_appsConfig && m_registeredApps) {
+            if (m_appsSent) {
+                LOGINFO("XcastService application list unchanged");
+            }
+            else if (xdialCastObj != NULL) {
+                int ret = xdialCastObj.send("onRegisterApplications", m_registeredApps);
+                m_appsSent = true;
+                LOGINFO("XcastService send cached onRegisterApplications ret:%d",ret);
+            }
+            return;
+        }
+    }
+
     if (!strApps.empty()) {
         cJSON *applications = cJSON_Parse(strApps.c_str());
         if (!cJSON_IsArray(applications)) {
@@ -438,8 +483,8 @@ void RtXcastConnector::registerApplications(string strApps)
         int iIndex = 0;
         rtArrayObject *appReqList = new rtArrayObject;
 
-        /*Clear all existing launch param*/
-        clearAppLaunchParamList ();
+        /*Launch params are built aside and swapped in once complete*/
+        std::list<RegAppLaunchParams> launchParams;
 
         cJSON_ArrayForEach(itrApp, applications) {
             LOGINFO("Application: %d \n", iIndex);
@@ -573,7 +618,7 @@ void RtXcastConnector::registerApplications(string strApps)
                                 strcpy (reqAppLaunchParams.payload, jPayload->valuestring);
                                 LOGINFO("reqAppLaunchParams.payload:%s iPayLoadLen:%d jPayload:%s", reqAppLaunchParams.payload, iPayLoadLen, jPayload->valuestring);
                             }
-                            m_appLaunchParamList.push_back (reqAppLaunchParams);
+                            launchParams.push_back (reqAppLaunchParams);
                         }
                     }
                 }
@@ -585,10 +630,21 @@ void RtXcastConnector::registerApplications(string strApps)
 
         cJSON_Delete(applications);
 
+        {
+            lock_guard<mutex> lock(m_appLaunchParamLock);
+            m_appLaunchParamList.swap (launchParams);
+        }
+        freeAppLaunchParams (launchParams);
+
+        lock_guard<mutex> lock(m_stateLock);
+        m_appsConfig = strApps;
+        m_registeredApps = appReqList;
+        m_appsSent = false;
         if(xdialCastObj != NULL)
         {
 	        LOGINFO("%s:%d xdialCastObj Not NULL strApps:%s", __FUNCTION__, __LINE__, strApps.c_str());
-            int ret = xdialCastObj.send("onRegisterApplications", appReqList);
+            int ret = xdialCastObj.send("onRegisterApplications", m_registeredApps);
+            m_appsSent = true;
             LOGINFO("XcastService send onRegisterApplications ret:%d",ret);
         }
         else
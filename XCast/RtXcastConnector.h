@@ -42,7 +42,7 @@ typedef struct _RegAppLaunchParams {
  */
 class RtXcastConnector {
 protected:
-    RtXcastConnector():m_runEventThread(true){
+    RtXcastConnector():m_runEventThread(true), m_activation(-1), m_friendlyNameSent(false), m_appsSent(false){
         }
 public:
     std::list<RegAppLaunchParams> m_appLaunchParamList;
@@ -108,12 +108,25 @@ private:
     mutex m_threadlock;
     // Boolean event thread exit condition
     bool m_runEventThread;
+    // Guards m_appLaunchParamList, read on the rtRemote thread while registerApplications rebuilds it
+    mutex m_appLaunchParamLock;
+
+    // What the xdial server was last sent, so unchanged settings are not sent again and changed ones
+    // are swapped in without deactivating the service. Reset when the server reconnects.
+    mutex m_stateLock;
+    int m_activation;
+    string m_friendlyName;
+    bool m_friendlyNameSent;
+    string m_appsConfig;
+    rtObjectRef m_registeredApps;
+    bool m_appsSent;
 
     XCastSystemRemoteObjectReferenceWrapper m_xcast_system_remote_object;
 
     // Member function to handle RT messages.
     void processRtMessages();
     void clearAppLaunchParamList ();
+    static void freeAppLaunchParams (std::list<RegAppLaunchParams>& appLaunchParams);
     bool IsAppEnabled(char* strAppName);
 
     // Class level contracts
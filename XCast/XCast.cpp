@@ -26,6 +26,7 @@
 #endif //RFC_ENABLED
 #include <syscall.h>
 #include <cstring>
+#include <algorithm>
 #include <cjson/cJSON.h>
 #include "RtXcastConnector.h"
 using namespace std;
@@ -54,6 +55,11 @@ using namespace std;
 #define LOCATE_CAST_THIRD_TIMEOUT_IN_MILLIS  30000  //30 seconds
 #define LOCATE_CAST_FINAL_TIMEOUT_IN_MILLIS  60000  //60 seconds
 
+#define RDKSHELL_CALLSIGN_VER "org.rdk.RDKShell.1"
+#define RDKSHELL_EVENT_ON_LAUNCHED  "onLaunched"
+#define RDKSHELL_EVENT_ON_SUSPENDED "onSuspended"
+#define RDKSHELL_EVENT_ON_DESTROYED "onDestroyed"
+
 /*
  * The maximum DIAL payload accepted per the DIAL 1.6.1 specification.
  */
@@ -88,19 +94,20 @@ namespace {
 
 XCast::XCast() : AbstractPluginWithApiAndIARMLock()
 , m_apiVersionNumber(1)
+, m_rdkShellSubscribed(false)
 {
     InitializeIARM();
     XCast::checkRFCServiceStatus();
     if(XCast::isCastEnabled)
     {
         LOGINFO("XcastService::Register methods and create onLocateCastTimer ");
-        registerMethod(METHOD_GET_API_VERSION_NUMBER, &XCast::getApiVersionNumber, this);
+        registerReadOnlyMethod(METHOD_GET_API_VERSION_NUMBER, &XCast::getApiVersionNumber, this);
         registerMethod(METHOD_ON_APPLICATION_STATE_CHANGED , &XCast::applicationStateChanged, this);
         registerMethod(METHOD_SET_ENABLED, &XCast::setEnabled, this);
-        registerMethod(METHOD_GET_ENABLED, &XCast::getEnabled, this);
-        registerMethod(METHOD_GET_STANDBY_BEHAVIOR, &XCast::getStandbyBehavior, this);
+        registerReadOnlyMethod(METHOD_GET_ENABLED, &XCast::getEnabled, this);
+        registerReadOnlyMethod(METHOD_GET_STANDBY_BEHAVIOR, &XCast::getStandbyBehavior, this);
         registerMethod(METHOD_SET_STANDBY_BEHAVIOR, &XCast::setStandbyBehavior, this);
-        registerMethod(METHOD_GET_FRIENDLYNAME, &XCast::getFriendlyName, this);
+        registerReadOnlyMethod(METHOD_GET_FRIENDLYNAME, &XCast::getFriendlyName, this);
         registerMethod(METHOD_SET_FRIENDLYNAME, &XCast::setFriendlyName, this);
         registerMethod(METHOD_REG_APPLICATIONS, &XCast::registerApplications, this);
         
@@ -176,6 +183,7 @@ const string XCast::Initialize(PluginHost::IShell* /* service */)
     if (XCast::isCastEnabled)
     {
         //TODO add rt intialization.
+        subscribeToRDKShell();
         if( _rtConnector->initialize())
         {
             //We give few seconds delay before the timer is fired.
@@ -195,6 +203,7 @@ void XCast::Deinitialize(PluginHost::IShell* /* service */)
     if( XCast::isCastEnabled){
         _rtConnector->enableCastService(false);
         _rtConnector->shutdown();
+        unsubscribeFromRDKShell();
     }
 }
 
@@ -233,6 +242,7 @@ uint32_t XCast::applicationStateChanged(const JsonObject& parameters, JsonObject
             app = "Netflix";
         
         LOGINFO("XcastService::ApplicationStateChanged  ARGS = %s : %s : %s : %s ", app.c_str(), id.c_str() , state.c_str() , error.c_str());
+        updateAppState(app, state, id, error);
         _rtConnector->applicationStateChanged(app, state, id, error);
      returnResponse(true);
     }//app && state not empty
@@ -340,14 +350,11 @@ uint32_t XCast::registerApplications(const JsonObject& parameters, JsonObject& r
        {
 	       LOGINFO("%s:%d _rtConnector Not NULL", __FUNCTION__, __LINE__);
            if(_rtConnector->IsDynamicAppListEnabled()) {
-               /*Disable cast service before registering Applications*/
-               _rtConnector->enableCastService(false);
-
+               /*The new list replaces the advertised one in place, the service stays active*/
                _rtConnector->registerApplications (parameters["applications"].String());
 
                /*Save the config*/
                strDyAppConfig.assign(parameters["applications"].String());
-               /*Reenabling cast service after registering Applications*/
                if (m_xcastEnable && ( (m_standbyBehavior == true) || ((m_standbyBehavior == false)&&(m_powerState == IARM_BUS_PWRMGR_POWERSTATE_ON)) ) ) {
                    LOGINFO("Enable CastService  m_xcastEnable: %d m_standbyBehavior: %d m_powerState:%d", m_xcastEnable, m_standbyBehavior, m_powerState);
                    _rtConnector->enableCastService(true);
@@ -372,6 +379,9 @@ uint32_t XCast::registerApplications(const JsonObject& parameters, JsonObject& r
 //Timer Functions
 void XCast::onLocateCastTimer()
 {
+    if (!m_rdkShellSubscribed)
+        subscribeToRDKShell();
+
     int status = _rtConnector->connectToRemoteService();
     if(status != 0)
     {
@@ -404,6 +414,10 @@ void XCast::onLocateCastTimer()
     locateCastObjectRetryCount = 0;
     m_locateCastTimer.stop();
 
+    if (!m_friendlyName.empty()) {
+        _rtConnector->setFriendlyName(m_friendlyName);
+    }
+
     if ((!strDyAppConfig.empty()) && (NULL != _rtConnector)) {
         if (_rtConnector->IsDynamicAppListEnabled()) {
             LOGINFO("XCast::onLocateCastTimer : strDyAppConfig: %s", strDyAppConfig.c_str());
@@ -611,6 +625,16 @@ void XCast::onXcastApplicationHideRequest(string appName, string appID)
 void XCast::onXcastApplicationStateRequest(string appName, string appID) 
 {
     LOGINFO("XcastService::onXcastApplicationStateRequest: ");
+
+    // Answer from the cache straight away, the application still gets the request to refresh it.
+    AppState appState;
+    if (getAppState(appName, appState))
+    {
+        string dialName = (appName == "NetflixApp") ? "Netflix" : appName;
+        LOGINFO("XcastService::onXcastApplicationStateRequest: cached state of %s is %s", dialName.c_str(), appState.state.c_str());
+        _rtConnector->applicationStateChanged(dialName, appState.state, appID.empty() ? appState.id : appID, appState.error);
+    }
+
     if (appName.compare("Netflix") == 0 )
         appName = "NetflixApp";
     
@@ -675,5 +699,93 @@ bool XCast::onXcastSystemApplicationSleepRequest(string key)
     }
 }
 
+string XCast::appStateKey(const string& appName)
+{
+    string key = appName;
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    if (key == "netflixapp")
+        key = "netflix";
+    return key;
+}
+
+void XCast::updateAppState(const string& appName, const string& state, const string& id, const string& error)
+{
+    std::lock_guard<std::mutex> lock(m_appStatesLock);
+    AppState& appState = m_appStates[appStateKey(appName)];
+    appState.state = state;
+    if (!id.empty())
+        appState.id = id;
+    appState.error = error;
+}
+
+bool XCast::getAppState(const string& appName, AppState& appState)
+{
+    std::lock_guard<std::mutex> lock(m_appStatesLock);
+    auto it = m_appStates.find(appStateKey(appName));
+    if (it == m_appStates.end())
+        return false;
+    appState = it->second;
+    return true;
+}
+
+void XCast::subscribeToRDKShell()
+{
+    if (nullptr == m_rdkShellClient)
+        m_rdkShellClient = Utils::getThunderControllerClient(RDKSHELL_CALLSIGN_VER, "XCast");
+
+    uint32_t err = m_rdkShellClient->Subscribe<JsonObject>(1000, RDKSHELL_EVENT_ON_LAUNCHED, &XCast::onRDKShellLaunched, this);
+    if (err == Core::ERROR_NONE)
+        err = m_rdkShellClient->Subscribe<JsonObject>(1000, RDKSHELL_EVENT_ON_SUSPENDED, &XCast::onRDKShellSuspended, this);
+    if (err == Core::ERROR_NONE)
+        err = m_rdkShellClient->Subscribe<JsonObject>(1000, RDKSHELL_EVENT_ON_DESTROYED, &XCast::onRDKShellDestroyed, this);
+
+    if (err == Core::ERROR_NONE)
+    {
+        LOGINFO("Subscribed to RDKShell lifecycle events");
+        m_rdkShellSubscribed = true;
+    }
+    else
+    {
+        // RDKShell may not be up yet, the locate cast timer tries again
+        LOGWARN("Failed to subscribe to RDKShell lifecycle events, err %d", err);
+        unsubscribeFromRDKShell();
+        Utils::releaseThunderControllerClient(m_rdkShellClient, err);
+        m_rdkShellClient = nullptr;
+    }
+}
+
+void XCast::unsubscribeFromRDKShell()
+{
+    if (nullptr != m_rdkShellClient)
+    {
+        m_rdkShellClient->Unsubscribe(1000, RDKSHELL_EVENT_ON_LAUNCHED);
+        m_rdkShellClient->Unsubscribe(1000, RDKSHELL_EVENT_ON_SUSPENDED);
+        m_rdkShellClient->Unsubscribe(1000, RDKSHELL_EVENT_ON_DESTROYED);
+    }
+    m_rdkShellSubscribed = false;
+}
+
+void XCast::onRDKShellLaunched(const JsonObject& parameters)
+{
+    string client = parameters["client"].String();
+    string launchType = parameters["launchType"].String();
+    LOGINFO("RDKShell onLaunched %s (%s)", client.c_str(), launchType.c_str());
+    updateAppState(client, (launchType == "suspend") ? "suspended" : "running", "", "");
+}
+
+void XCast::onRDKShellSuspended(const JsonObject& parameters)
+{
+    string client = parameters["client"].String();
+    LOGINFO("RDKShell onSuspended %s", client.c_str());
+    updateAppState(client, "suspended", "", "");
+}
+
+void XCast::onRDKShellDestroyed(const JsonObject& parameters)
+{
+    string client = parameters["client"].String();
+    LOGINFO("RDKShell onDestroyed %s", client.c_str());
+    updateAppState(client, "stopped", "", "");
+}
+
 } // namespace Plugin
 } // namespace WPEFramework
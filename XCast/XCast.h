@@ -28,6 +28,9 @@
 #include "libIBusDaemon.h"
 #include "pwrMgr.h"
 
+#include <map>
+#include <mutex>
+
 namespace WPEFramework {
 
 namespace Plugin {
@@ -89,6 +92,11 @@ public:
     bool onXcastSystemApplicationSleepRequest(string key) override;
 
 private:
+    struct AppState {
+        string state;
+        string id;
+        string error;
+    };
     /**
      * Whether Cast service is enabled by RFC
      */
@@ -111,6 +119,23 @@ private:
      */
     static bool checkRFCServiceStatus();
     static void powerModeChange(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+
+    /**
+     * Last known state of each application, as reported through onApplicationStateChanged and
+     * RDKShell lifecycle events. Lets application state requests from DIAL be answered right away.
+     */
+    std::map<string, AppState> m_appStates;
+    std::mutex m_appStatesLock;
+    std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > m_rdkShellClient;
+    bool m_rdkShellSubscribed;
+    static string appStateKey(const string& appName);
+    void updateAppState(const string& appName, const string& state, const string& id, const string& error);
+    bool getAppState(const string& appName, AppState& appState);
+    void subscribeToRDKShell();
+    void unsubscribeFromRDKShell();
+    void onRDKShellLaunched(const JsonObject& parameters);
+    void onRDKShellSuspended(const JsonObject& parameters);
+    void onRDKShellDestroyed(const JsonObject& parameters);
 };
 } // namespace Plugin
 } // namespace WPEFramework
@@ -19,8 +19,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <mutex>
 #include <unordered_map>
 #include "utils.h"
+#include "BootTimeline.h"
 
 namespace WPEFramework {
 
@@ -52,6 +57,23 @@ namespace WPEFramework {
                 response["quirks"] = array;
                 returnResponse(true);
             }
+
+            // The initialization phases of all plugins of the process since boot
+            uint32_t getBootTimeline(const JsonObject& parameters, JsonObject& response)
+            {
+                JsonArray phases;
+                for (const Utils::BootTimeline::Phase& entry : Utils::BootTimeline::read())
+                {
+                    JsonObject phase;
+                    phase["plugin"] = entry.plugin;
+                    phase["phase"] = entry.phase;
+                    phase["startUs"] = entry.startUs;
+                    phase["durationUs"] = entry.durationUs;
+                    phases.Add(phase);
+                }
+                response["phases"] = phases;
+                returnResponse(true);
+            }
             //End methods
 
         protected:
@@ -69,6 +91,7 @@ namespace WPEFramework {
                         m_versionAPIs[ver].push_back(methodName);
                     }
                 }
+                m_lastRegisteredUs = Utils::BootTimeline::now();
             }
 
             //registerMethod to register a method in specific versions
@@ -83,7 +106,86 @@ namespace WPEFramework {
                         handler->second->Register<WPEFramework::Core::JSON::VariantContainer, WPEFramework::Core::JSON::VariantContainer, METHOD, REALOBJECT>(methodName, method, objectPtr);
                         m_versionAPIs[ver].push_back(methodName);
                     }
-                } 
+                }
+                m_lastRegisteredUs = Utils::BootTimeline::now(); 
+            }
+
+            //registerMethod to register a method in all versions, with its own params and result types (e.g. JsonData containers)
+            template <typename INBOUND, typename OUTBOUND, typename REALOBJECT>
+            void registerMethod(const string& methodName, uint32_t (REALOBJECT::*method)(const INBOUND&, OUTBOUND&), REALOBJECT* objectPtr)
+            {
+                for(uint8_t ver = 1; ver <= m_currVersion; ver++)
+                {
+                    auto handler = m_versionHandlers.find(ver);
+                    if(handler != m_versionHandlers.end())
+                    {
+                        handler->second->Register<INBOUND, OUTBOUND>(methodName, method, objectPtr);
+                        m_versionAPIs[ver].push_back(methodName);
+                    }
+                }
+                m_lastRegisteredUs = Utils::BootTimeline::now();
+            }
+
+            /*
+                Boot timeline: records a phase of the initialization of the plugin, e.g.
+                    { BootPhase phase(*this, "iarmConnect"); InitializeIARM(); }
+                The first phase recorded also records "registration", from the construction
+                to the last registered method.
+            */
+            class BootPhase
+            {
+            public:
+                BootPhase(AbstractPlugin& plugin, const char* phase) : m_plugin(plugin), m_phase(phase), m_startUs(Utils::BootTimeline::now()) {}
+                ~BootPhase() { m_plugin.recordBootPhase(m_phase, m_startUs); }
+                BootPhase(const BootPhase&) = delete;
+                BootPhase& operator=(const BootPhase&) = delete;
+
+            private:
+                AbstractPlugin& m_plugin;
+                const char* m_phase;
+                uint64_t m_startUs;
+            };
+
+            void recordBootPhase(const char* phase, uint64_t startUs)
+            {
+                uint64_t endUs = Utils::BootTimeline::now();
+                if (!m_registrationRecorded.exchange(true))
+                    Utils::BootTimeline::record(bootTimelineName(), "registration", m_constructedUs, std::max(m_lastRegisteredUs, m_constructedUs));
+                Utils::BootTimeline::record(bootTimelineName(), phase, startUs, endUs);
+            }
+
+            // Records "ready", from the construction of the plugin to now; call at the end of Initialize
+            void bootReady()
+            {
+                recordBootPhase("ready", m_constructedUs);
+            }
+
+            /*
+                Lazy initialization: init runs once, when the first method or event that needs it calls
+                ensureInitialized(), instead of in Initialize, so the plugin reports ready sooner. Set it in
+                the constructor or in Initialize; the methods are registered right away as usual. The time
+                init took is recorded in the boot timeline as "deferredInit".
+            */
+            void setDeferredInitialization(const std::function<void()>& init)
+            {
+                std::lock_guard<std::mutex> lock(m_deferredLock);
+                m_deferredInit = init;
+                m_deferredPending = true;
+            }
+
+            void ensureInitialized()
+            {
+                if (!m_deferredPending)
+                    return;
+
+                std::lock_guard<std::mutex> lock(m_deferredLock);
+                if (m_deferredPending)
+                {
+                    BootPhase phase(*this, "deferredInit");
+                    m_deferredInit();
+                    m_deferredInit = nullptr;
+                    m_deferredPending = false;
+                }
             }
 
             void LOGT2(char* message)
@@ -97,18 +199,19 @@ namespace WPEFramework {
             }
 
         public:
-            AbstractPlugin() : PluginHost::JSONRPC(), m_currVersion(1)
+            AbstractPlugin() : PluginHost::JSONRPC(), m_currVersion(1), m_constructedUs(Utils::BootTimeline::now()), m_lastRegisteredUs(0), m_registrationRecorded(false), m_deferredPending(false)
             {
                 // For default constructor assume that only version 1 is supported.
                 // Also version 1 handler would always be the current object.
                 m_versionHandlers[1] = GetHandler(1);
 
                 registerMethod("getQuirks", &AbstractPlugin::getQuirks, this);
+                registerMethod("getBootTimeline", &AbstractPlugin::getBootTimeline, this);
 
                 Utils::Telemetry::init();
             }
 
-            AbstractPlugin(const uint8_t currVersion) : PluginHost::JSONRPC(), m_currVersion(currVersion)
+            AbstractPlugin(const uint8_t currVersion) : PluginHost::JSONRPC(), m_currVersion(currVersion), m_constructedUs(Utils::BootTimeline::now()), m_lastRegisteredUs(0), m_registrationRecorded(false), m_deferredPending(false)
             {
                 // Create handlers for all the versions upto m_currVersion
                 m_versionHandlers[1] = GetHandler(1);
@@ -121,6 +224,7 @@ namespace WPEFramework {
                 }
 
                 registerMethod("getQuirks", &AbstractPlugin::getQuirks, this);
+                registerMethod("getBootTimeline", &AbstractPlugin::getBootTimeline, this);
 
                 Utils::Telemetry::init();
             }
@@ -199,6 +303,20 @@ namespace WPEFramework {
             std::unordered_map<uint8_t, WPEFramework::Core::JSONRPC::Handler*> m_versionHandlers;
             std::unordered_map<uint8_t, std::vector<std::string>> m_versionAPIs;
             uint8_t m_currVersion; // current supported version
+
+            // Name of the plugin in the boot timeline, MODULE_NAME without the "Plugin_" prefix
+            static const char* bootTimelineName()
+            {
+                const char* name = UTILS_LOG_MODULE;
+                return (strncmp(name, "Plugin_", 7) == 0 ? name + 7 : name);
+            }
+
+            uint64_t m_constructedUs;
+            uint64_t m_lastRegisteredUs;
+            std::atomic<bool> m_registrationRecorded;
+            std::mutex m_deferredLock;
+            std::function<void()> m_deferredInit;
+            std::atomic<bool> m_deferredPending;
         };
 	} // namespace Plugin
 } // namespace WPEFramework
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <libIBus.h>
 #include <AbstractPluginWithApiLock.h>
@@ -12,22 +13,23 @@ namespace WPEFramework {
 
         static std::map<std::string, std::map<IARM_EventId_t, IARM_EventHandler_t>> _registered_iarm_handlers;
 
+        // api lock of the plugin of this library, the IARM handlers are static
+        static std::atomic<ApiLock*> _iarm_api_lock(nullptr);
+
         static void _generic_iarm_handler(const char *owner, IARM_EventId_t eventId, void *data, size_t len) {
-            std::lock_guard<std::mutex> lock(AbstractPluginWithApiLock::getApiLock());
-            // we can't be in IARM handler thread & API request thread at the same time, so
-            // it's safe to use AbstractPluginWithApiLock's isThreadUsingLockedApi here
-            isThreadUsingLockedApi = true;
-            try {
-                if (_registered_iarm_handlers[owner].count(eventId)) {
-                    _registered_iarm_handlers[owner][eventId](owner, eventId, data, len);
-                } else {
-                    LOGERR("missing handler for %s / %d", owner, eventId);
-                }
-            } catch (...) {
-                isThreadUsingLockedApi = false;
-                throw;
+            ApiLock* apiLock = _iarm_api_lock.load();
+            if (apiLock == nullptr) {
+                LOGERR("no plugin to handle %s / %d", owner, eventId);
+                return;
+            }
+
+            const std::string holder = std::string("IARM ") + owner + " / " + std::to_string(eventId);
+            AbstractPluginWithApiLock::ApiLockGuard lock(*apiLock, false, holder);
+            if (_registered_iarm_handlers[owner].count(eventId)) {
+                _registered_iarm_handlers[owner][eventId](owner, eventId, data, len);
+            } else {
+                LOGERR("missing handler for %s / %d", owner, eventId);
             }
-            isThreadUsingLockedApi = false;
         }
         /*
             provides overloaded versions of IARM_Bus_RegisterEventHandler (and IARM_Bus_UnRegisterEventHandler)
@@ -36,8 +38,9 @@ namespace WPEFramework {
         class AbstractPluginWithApiAndIARMLock : public AbstractPluginWithApiLock {
         public:
 
-            AbstractPluginWithApiAndIARMLock(const uint8_t currVersion) : AbstractPluginWithApiLock(currVersion) {}
-            AbstractPluginWithApiAndIARMLock() : AbstractPluginWithApiLock() {}
+            AbstractPluginWithApiAndIARMLock(const uint8_t currVersion) : AbstractPluginWithApiLock(currVersion) { _iarm_api_lock = &getApiLock(); }
+            AbstractPluginWithApiAndIARMLock() : AbstractPluginWithApiLock() { _iarm_api_lock = &getApiLock(); }
+            virtual ~AbstractPluginWithApiAndIARMLock() { _iarm_api_lock = nullptr; }
 
             // we are providing IARM_Bus_RegisterEventHandler as new static member (libiarm provides standalone function)
             static IARM_Result_t IARM_Bus_RegisterEventHandler(const char *ownerName, IARM_EventId_t eventId, IARM_EventHandler_t handler) {
@@ -1,44 +1,208 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <mutex>
+#include <string>
 
 #include <AbstractPlugin.h>
+#include <Metrics.h>
 
 namespace WPEFramework {
 
     namespace Plugin {
 
+        /*
+            Reader-writer lock of the API of one plugin. Writers are preferred: once a writer waits, new
+            readers queue behind it. Callers that find the lock taken have their wait recorded, together
+            with the method that held the lock when they started waiting.
+        */
+        class ApiLock {
+        public:
+            struct Blocked {
+                uint64_t waits = 0;
+                uint64_t waitUs = 0;
+            };
+
+            struct Statistics {
+                uint64_t acquisitions;
+                Utils::Metrics::Histogram::Summary wait;    // us, only of callers that had to wait
+                std::string holder;                         // empty if not held
+                uint32_t readers;
+                std::map<std::string, Blocked> blockedBy;
+            };
+
+            ApiLock() : m_readers(0), m_writer(false), m_waitingWriters(0), m_acquisitions(0) {}
+            ApiLock(const ApiLock&) = delete;
+            ApiLock& operator=(const ApiLock&) = delete;
+
+            void lock(const std::string& holder)
+            {
+                Clock::time_point start = Clock::now();
+                std::unique_lock<std::mutex> guard(m_mutex);
+
+                m_acquisitions++;
+                if (m_writer || m_readers > 0) {
+                    std::string blocker = m_holder;
+                    m_waitingWriters++;
+                    m_released.wait(guard, [this]() { return !m_writer && m_readers == 0; });
+                    m_waitingWriters--;
+                    contended(blocker, start);
+                }
+                m_writer = true;
+                m_holder = holder;
+            }
+
+            void unlock()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_writer = false;
+                    m_holder.clear();
+                }
+                m_released.notify_all();
+            }
+
+            void lockShared(const std::string& holder)
+            {
+                Clock::time_point start = Clock::now();
+                std::unique_lock<std::mutex> guard(m_mutex);
+
+                m_acquisitions++;
+                if (m_writer || m_waitingWriters > 0) {
+                    // behind a writer that is about to take the lock if it is not held
+                    std::string blocker = m_holder.empty() ? std::string("(writer)") : m_holder;
+                    m_released.wait(guard, [this]() { return !m_writer && m_waitingWriters == 0; });
+                    contended(blocker, start);
+                }
+                m_readers++;
+                m_holder = holder;
+            }
+
+            void unlockShared()
+            {
+                bool last;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    last = (--m_readers == 0);
+                    if (last)
+                        m_holder.clear();
+                }
+                if (last)
+                    m_released.notify_all();
+            }
+
+            void statistics(Statistics& statistics, bool reset)
+            {
+                m_waitUs.read(statistics.wait, reset);
+
+                std::lock_guard<std::mutex> guard(m_mutex);
+                statistics.acquisitions = m_acquisitions;
+                statistics.holder = m_holder;
+                statistics.readers = m_readers;
+                statistics.blockedBy = m_blockedBy;
+                if (reset) {
+                    m_acquisitions = 0;
+                    m_blockedBy.clear();
+                }
+            }
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            // Called with m_mutex held
+            void contended(const std::string& blocker, const Clock::time_point& start)
+            {
+                uint64_t waitUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+                m_waitUs.record(waitUs);
+
+                Blocked& blocked = m_blockedBy[blocker];
+                blocked.waits++;
+                blocked.waitUs += waitUs;
+            }
+
+            std::mutex m_mutex;
+            std::condition_variable m_released;
+            uint32_t m_readers;
+            bool m_writer;
+            uint32_t m_waitingWriters;
+            std::string m_holder;   // last method that took the lock
+            uint64_t m_acquisitions;
+            std::map<std::string, Blocked> m_blockedBy;
+            Utils::Metrics::Histogram m_waitUs;
+        };
+
         namespace {
             // set when inside of getFunctionToCall wrapper (or locked IARM handler - see AbstractPluginWithApiAndIARMLock)
-            thread_local bool isThreadUsingLockedApi = false;
+            struct HeldApiLock {
+                ApiLock* lock;
+                bool shared;
+                const std::string* holder;
+            };
+            thread_local HeldApiLock heldApiLock = { nullptr, false, nullptr };
         }
         /*
             When plugin extends this instead of AbstractPlugin all API method invocations will be mutex protected.
+            Every plugin has its own lock. Methods registered with registerReadOnlyMethod take it shared, so
+            they run in parallel with each other but never with the other methods or the IARM handlers.
         */
         class AbstractPluginWithApiLock : public AbstractPlugin {
-
         public:
 
-            AbstractPluginWithApiLock(const uint8_t currVersion) : AbstractPlugin(currVersion) {}
-            AbstractPluginWithApiLock() : AbstractPlugin() {}
+            AbstractPluginWithApiLock(const uint8_t currVersion) : AbstractPlugin(currVersion)
+            {
+                AbstractPlugin::registerMethod("getApiLockStatistics", &AbstractPluginWithApiLock::getApiLockStatistics, this);
+            }
+            AbstractPluginWithApiLock() : AbstractPlugin()
+            {
+                AbstractPlugin::registerMethod("getApiLockStatistics", &AbstractPluginWithApiLock::getApiLockStatistics, this);
+            }
+
+        private:
+            //Begin methods
+            uint32_t getApiLockStatistics(const JsonObject& parameters, JsonObject& response)
+            {
+                bool reset = false;
+                getDefaultBoolParameter("reset", reset, false);
+
+                ApiLock::Statistics statistics;
+                m_apiLock.statistics(statistics, reset);
+
+                JsonObject wait;
+                wait["count"] = statistics.wait.count;
+                wait["p50"] = statistics.wait.p50;
+                wait["p90"] = statistics.wait.p90;
+                wait["p99"] = statistics.wait.p99;
+                wait["max"] = statistics.wait.max;
+                wait["total"] = statistics.wait.sum;
+
+                JsonArray blockedBy;
+                for (const auto& entry : statistics.blockedBy) {
+                    JsonObject blocked;
+                    blocked["method"] = entry.first;
+                    blocked["waits"] = entry.second.waits;
+                    blocked["waitUs"] = entry.second.waitUs;
+                    blockedBy.Add(blocked);
+                }
+
+                response["acquisitions"] = statistics.acquisitions;
+                response["waitUs"] = wait;
+                response["holder"] = statistics.holder;
+                response["readers"] = statistics.readers;
+                response["blockedBy"] = blockedBy;
+                returnResponse(true);
+            }
+            //End methods
 
         protected:
 
             template <typename METHOD, typename REALOBJECT>
             std::function<uint32_t(REALOBJECT*, const WPEFramework::Core::JSON::VariantContainer&, WPEFramework::Core::JSON::VariantContainer&)>
-            getFunctionToCall(const METHOD& method, REALOBJECT* objectPtr) {
-                return [method](REALOBJECT *obj, const WPEFramework::Core::JSON::VariantContainer& in, WPEFramework::Core::JSON::VariantContainer& out) -> uint32_t {
-                    isThreadUsingLockedApi = true;
-                    std::lock_guard<std::mutex> lock(getApiLock());
-                    uint32_t ret;
-                    try {
-                        ret = (obj->*method)(in, out);
-                    } catch (...) {
-                        isThreadUsingLockedApi = false;
-                        throw;
-                    }
-                    isThreadUsingLockedApi = false;
-                    return ret;
+            getFunctionToCall(const string& methodName, const METHOD& method, REALOBJECT* objectPtr, bool shared) {
+                return [methodName, method, shared](REALOBJECT *obj, const WPEFramework::Core::JSON::VariantContainer& in, WPEFramework::Core::JSON::VariantContainer& out) -> uint32_t {
+                    ApiLockGuard lock(obj->getApiLock(), shared, methodName);
+                    return (obj->*method)(in, out);
                 };
             }
 
@@ -46,39 +210,94 @@ namespace WPEFramework {
             template <typename METHOD, typename REALOBJECT>
             void registerMethod(const string& methodName, const METHOD& method, REALOBJECT* objectPtr)
             {
-                WPEFramework::Plugin::AbstractPlugin::registerMethod(methodName, getFunctionToCall(method, objectPtr), objectPtr);
+                WPEFramework::Plugin::AbstractPlugin::registerMethod(methodName, getFunctionToCall(methodName, method, objectPtr, false), objectPtr);
             }
 
             /* we are hiding, not overriding, AbstractPlugin::registerMethod */
             template <typename METHOD, typename REALOBJECT>
             void registerMethod(const string& methodName, const METHOD& method, REALOBJECT* objectPtr, const std::vector<uint8_t> versions)
             {
-                WPEFramework::Plugin::AbstractPlugin::registerMethod(methodName, getFunctionToCall(method, objectPtr), objectPtr, versions);
+                WPEFramework::Plugin::AbstractPlugin::registerMethod(methodName, getFunctionToCall(methodName, method, objectPtr, false), objectPtr, versions);
+            }
+
+            /* for methods that only read plugin state; they hold the api lock shared */
+            template <typename METHOD, typename REALOBJECT>
+            void registerReadOnlyMethod(const string& methodName, const METHOD& method, REALOBJECT* objectPtr)
+            {
+                WPEFramework::Plugin::AbstractPlugin::registerMethod(methodName, getFunctionToCall(methodName, method, objectPtr, true), objectPtr);
+            }
+
+            template <typename METHOD, typename REALOBJECT>
+            void registerReadOnlyMethod(const string& methodName, const METHOD& method, REALOBJECT* objectPtr, const std::vector<uint8_t> versions)
+            {
+                WPEFramework::Plugin::AbstractPlugin::registerMethod(methodName, getFunctionToCall(methodName, method, objectPtr, true), objectPtr, versions);
             }
 
         public:
+            /*
+                Holds the api lock for the scope and marks the thread as using it, for UnlockApiGuard.
+            */
+            struct ApiLockGuard {
+                ApiLockGuard(ApiLock& lock, bool shared, const std::string& holder) : m_previous(heldApiLock) {
+                    if (shared) {
+                        lock.lockShared(holder);
+                    } else {
+                        lock.lock(holder);
+                    }
+                    heldApiLock = { &lock, shared, &holder };
+                }
+                ~ApiLockGuard() {
+                    if (heldApiLock.shared) {
+                        heldApiLock.lock->unlockShared();
+                    } else {
+                        heldApiLock.lock->unlock();
+                    }
+                    heldApiLock = m_previous;
+                }
+                ApiLockGuard(const ApiLockGuard&) = delete;
+                ApiLockGuard& operator=(const ApiLockGuard&) = delete;
+
+            private:
+                HeldApiLock m_previous;
+            };
+
             /*
                 This guard can unlock & re-lock api mutex to prevent deadlock possible when calling other plugins via Invoke
                 (could deadlock in case when that other plugin called Invoke on this plugin at the same time, or tried to call
                 this plugin recursively, from the Invoke'd call).
             */
             struct UnlockApiGuard {
-                UnlockApiGuard() {
-                    if (isThreadUsingLockedApi) {
-                        getApiLock().unlock();
+                UnlockApiGuard() : m_held(heldApiLock) {
+                    if (m_held.lock != nullptr) {
+                        if (m_held.shared) {
+                            m_held.lock->unlockShared();
+                        } else {
+                            m_held.lock->unlock();
+                        }
+                        heldApiLock = { nullptr, false, nullptr };
                     }
                 }
                 ~UnlockApiGuard() {
-                    if (isThreadUsingLockedApi) {
-                        getApiLock().lock();
+                    if (m_held.lock != nullptr) {
+                        if (m_held.shared) {
+                            m_held.lock->lockShared(*m_held.holder);
+                        } else {
+                            m_held.lock->lock(*m_held.holder);
+                        }
+                        heldApiLock = m_held;
                     }
                 }
+
+            private:
+                HeldApiLock m_held;
             };
 
-            static std::mutex& getApiLock() {
-                static std::mutex apiLock;
-                return apiLock;
+            ApiLock& getApiLock() {
+                return m_apiLock;
             }
+
+        private:
+            ApiLock m_apiLock;
         };
 
     } // Plugin
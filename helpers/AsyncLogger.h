@@ -0,0 +1,299 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * Backend of the LOG* macros in utils.h when built with USE_ASYNC_LOGGING.
+ *
+ * A logging thread only formats the line into a buffer of its own. One
+ * background thread per plugin library drains all buffers to stderr, with a
+ * single fflush per round, and sends LOGERR messages to telemetry. Lines of
+ * one thread stay in order; lines of different threads are no longer
+ * interleaved exactly as they were logged.
+ *
+ * A thread whose buffer overflows writes it out itself rather than dropping
+ * lines. Once the library is being unloaded all logging is synchronous again.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifdef ENABLE_TELEMETRY_LOGGING
+#include <telemetry_busmessage_sender.h>
+#endif
+
+#define ASYNC_LOGGER_BUFFER_LIMIT     (64 * 1024)
+#define ASYNC_LOGGER_DRAIN_INTERVAL   50 /* ms */
+
+namespace Utils
+{
+    /***
+     * @brief        : Kernel thread id of the caller, looked up once per thread.
+     * @return       : <int> tid
+     */
+    inline int logThreadId()
+    {
+        static thread_local int tid = static_cast<int>(syscall(SYS_gettid));
+        return tid;
+    }
+
+    class AsyncLogger {
+    private:
+        enum { IDLE, RUNNING, STOPPED };
+
+        struct Buffer {
+            std::mutex lock;
+            std::string text;
+            std::vector<std::string> errors;
+            bool orphan = false;
+        };
+
+        struct Holder {
+            std::shared_ptr<Buffer> buffer;
+
+            ~Holder()
+            {
+                // The thread exits, the drain thread writes what is left and forgets the buffer.
+                if (buffer) {
+                    std::lock_guard<std::mutex> lock(buffer->lock);
+                    buffer->orphan = true;
+                }
+            }
+        };
+
+    public:
+        /***
+         * @brief        : Queue one log line, "[tid] LEVEL [file:line] function: message".
+         * @param1[in]   : <bool> Also send the message to telemetry (LOGERR)
+         * @param2[in]   : <const char*> level name
+         * @param3..5[in]: location
+         * @param6[in]   : <const char*> printf format of the message, followed by its arguments
+         */
+        __attribute__((format(printf, 6, 7)))
+        static void write(bool error, const char* level, const char* file, int line, const char* function, const char* format, ...)
+        {
+            char stack[512];
+            std::string message;
+            va_list parameters;
+
+            va_start(parameters, format);
+            int length = vsnprintf(stack, sizeof(stack), format, parameters);
+            va_end(parameters);
+
+            if (length < 0)
+                length = 0;
+
+            if (static_cast<size_t>(length) < sizeof(stack)) {
+                message.assign(stack, length);
+            } else {
+                message.resize(length + 1);
+                va_start(parameters, format);
+                vsnprintf(&message[0], message.size(), format, parameters);
+                va_end(parameters);
+                message.resize(length);
+            }
+
+            char head[256];
+            int headLength = snprintf(head, sizeof(head), "[%d] %s [%s:%d] %s: ", logThreadId(), level, file, line, function);
+            if (headLength < 0)
+                headLength = 0;
+            else if (static_cast<size_t>(headLength) >= sizeof(head))
+                headLength = sizeof(head) - 1;
+
+            if (state() == STOPPED) {
+                fprintf(stderr, "%.*s%s\n", headLength, head, message.c_str());
+                fflush(stderr);
+                if (error)
+                    sendError(message);
+            } else {
+                instance().queue(head, headLength, message, error);
+            }
+        }
+
+    private:
+        AsyncLogger() : m_running(true), m_pending(false)
+        {
+            m_thread = std::thread(&AsyncLogger::drainLoop, this);
+            state() = RUNNING;
+        }
+
+        ~AsyncLogger()
+        {
+            state() = STOPPED;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running = false;
+            }
+            m_wake.notify_one();
+            if (m_thread.joinable())
+                m_thread.join();
+            drain();
+        }
+
+        AsyncLogger(const AsyncLogger&) = delete;
+        AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+        static std::atomic<int>& state()
+        {
+            static std::atomic<int> value(IDLE);
+            return value;
+        }
+
+        static AsyncLogger& instance()
+        {
+            static AsyncLogger logger;
+            return logger;
+        }
+
+        Buffer& local()
+        {
+            static thread_local Holder holder;
+            if (!holder.buffer) {
+                holder.buffer = std::make_shared<Buffer>();
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_buffers.push_back(holder.buffer);
+            }
+            return *holder.buffer;
+        }
+
+        void queue(const char* head, int headLength, const std::string& message, bool error)
+        {
+            Buffer& buffer = local();
+            std::string overflow;
+            std::vector<std::string> errors;
+            bool wake = error;
+            {
+                std::lock_guard<std::mutex> lock(buffer.lock);
+                buffer.text.append(head, headLength);
+                buffer.text.append(message);
+                buffer.text.push_back('\n');
+                if (error)
+                    buffer.errors.push_back(message);
+                if (buffer.text.size() > ASYNC_LOGGER_BUFFER_LIMIT) {
+                    // The drain thread can't keep up, write this thread's lines ourselves.
+                    overflow.swap(buffer.text);
+                    errors.swap(buffer.errors);
+                }
+                wake = wake || (buffer.text.size() > ASYNC_LOGGER_BUFFER_LIMIT / 2);
+            }
+            if (!overflow.empty()) {
+                fwrite(overflow.data(), 1, overflow.size(), stderr);
+                fflush(stderr);
+                for (auto it = errors.begin(); it != errors.end(); ++it)
+                    sendError(*it);
+                return;
+            }
+            if (wake) {
+                // Errors go out right away, they may well be followed by a crash.
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_pending = true;
+                }
+                m_wake.notify_one();
+            }
+        }
+
+        void drainLoop()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (m_running) {
+                m_wake.wait_for(lock, std::chrono::milliseconds(ASYNC_LOGGER_DRAIN_INTERVAL), [this] { return m_pending || !m_running; });
+                m_pending = false;
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        }
+
+        void drain()
+        {
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                buffers = m_buffers;
+            }
+
+            std::string text;
+            std::vector<std::string> errors;
+            bool orphans = false;
+
+            for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+                std::lock_guard<std::mutex> lock((*it)->lock);
+                text.append((*it)->text);
+                (*it)->text.clear();
+                errors.insert(errors.end(), (*it)->errors.begin(), (*it)->errors.end());
+                (*it)->errors.clear();
+                orphans = orphans || (*it)->orphan;
+            }
+
+            if (!text.empty()) {
+                fwrite(text.data(), 1, text.size(), stderr);
+                fflush(stderr);
+            }
+            for (auto it = errors.begin(); it != errors.end(); ++it)
+                sendError(*it);
+
+            if (orphans) {
+                std::lock_guard<std::mutex> lock(m_lock);
+                for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+                    std::lock_guard<std::mutex> bufferLock((*it)->lock);
+                    if ((*it)->orphan && (*it)->text.empty())
+                        it = m_buffers.erase(it);
+                    else
+                        ++it;
+                }
+            }
+        }
+
+        static void sendError(const std::string& message)
+        {
+#ifdef ENABLE_TELEMETRY_LOGGING
+            // get rid of const for t2_event_s
+            char* error = strdup(message.c_str());
+            if (error) {
+                t2_event_s("THUNDER_ERROR", error);
+                free(error);
+            }
+#else
+            (void)message;
+#endif
+        }
+
+    private:
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+        std::vector<std::shared_ptr<Buffer>> m_buffers;
+        std::thread m_thread;
+        bool m_running;
+        bool m_pending;
+    };
+}
@@ -0,0 +1,114 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * Boot timeline of the plugins.
+ *
+ * Every plugin library appends its initialization phases to one file on tmpfs,
+ * a line per phase, so the timeline covers all plugins of the process (and of
+ * restarts of it) since boot. Times are CLOCK_MONOTONIC, i.e. since boot, in us.
+ * AbstractPlugin records into it and returns it from getBootTimeline.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#define BOOT_TIMELINE_FILE "/tmp/.rdkservices_boot_timeline"
+/* Phases are no longer recorded once the file is this big */
+#define BOOT_TIMELINE_MAX_BYTES (64 * 1024)
+
+namespace Utils
+{
+    namespace BootTimeline
+    {
+        struct Phase
+        {
+            uint64_t startUs;
+            uint64_t durationUs;
+            std::string plugin;
+            std::string phase;
+        };
+
+        inline uint64_t now()
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+        }
+
+        // plugin and phase must not contain white space
+        inline void record(const std::string& plugin, const std::string& phase, uint64_t startUs, uint64_t endUs)
+        {
+            int fd = open(BOOT_TIMELINE_FILE, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0)
+                return;
+
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size < BOOT_TIMELINE_MAX_BYTES)
+            {
+                char line[256];
+                int length = snprintf(line, sizeof(line), "%llu %llu %s %s\n", (unsigned long long)startUs,
+                    (unsigned long long)(endUs > startUs ? endUs - startUs : 0), plugin.c_str(), phase.c_str());
+                // One write with O_APPEND, the lines of parallel writers don't mix
+                if (length > 0 && length < (int)sizeof(line))
+                {
+                    ssize_t written = write(fd, line, length);
+                    (void)written;
+                }
+            }
+            close(fd);
+        }
+
+        // Sorted by start
+        inline std::vector<Phase> read()
+        {
+            std::vector<Phase> phases;
+            std::ifstream file(BOOT_TIMELINE_FILE);
+            std::string line;
+
+            while (std::getline(file, line))
+            {
+                std::istringstream fields(line);
+                Phase phase;
+                unsigned long long start, duration;
+                if (fields >> start >> duration >> phase.plugin >> phase.phase)
+                {
+                    phase.startUs = start;
+                    phase.durationUs = duration;
+                    phases.push_back(phase);
+                }
+            }
+
+            std::stable_sort(phases.begin(), phases.end(), [](const Phase& a, const Phase& b) { return a.startUs < b.startUs; });
+            return phases;
+        }
+    }
+}
@@ -0,0 +1,148 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "EventDispatcher.h"
+
+#include "utils.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        EventDispatcher::EventDispatcher()
+            : m_running(false)
+        {
+        }
+
+        EventDispatcher::~EventDispatcher()
+        {
+            stop();
+        }
+
+        void EventDispatcher::start(int workers)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_running)
+                return;
+
+            m_running = true;
+            for (int i = 0; i < workers; i++)
+                m_workers.push_back(std::thread(&EventDispatcher::worker, this));
+        }
+
+        void EventDispatcher::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_running)
+                    return;
+                m_running = false;
+            }
+            m_cv.notify_all();
+
+            for (auto& thread : m_workers)
+                thread.join();
+            m_workers.clear();
+        }
+
+        void EventDispatcher::dispatch(const std::string& type, const Handler& handler)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            Queue& queue = m_queues[type];
+            queue.metrics.dispatched++;
+
+            if (!m_running || queue.events.size() >= EVENT_DISPATCHER_MAX_QUEUED) {
+                /* Not in order with the queued ones, but the dispatcher does not block nor lose it */
+                queue.metrics.inlined++;
+                if (m_running)
+                    LOGWARN("%s: %zu events queued, handling it inline", type.c_str(), queue.events.size());
+                lock.unlock();
+                handle(type, handler, queue.metrics, m_lock, 0);
+                return;
+            }
+
+            queue.events.push_back({handler, Clock::now()});
+            queue.metrics.queued = queue.events.size();
+            if (queue.metrics.queued > queue.metrics.maxQueued)
+                queue.metrics.maxQueued = queue.metrics.queued;
+
+            if (!queue.busy) {
+                queue.busy = true;
+                m_ready.push_back(type);
+                lock.unlock();
+                m_cv.notify_one();
+            }
+        }
+
+        std::map<std::string, EventDispatcher::Metrics> EventDispatcher::metrics() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            std::map<std::string, Metrics> result;
+            for (const auto& queue : m_queues)
+                result[queue.first] = queue.second.metrics;
+            return result;
+        }
+
+        void EventDispatcher::worker()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (true) {
+                m_cv.wait(lock, [this] { return !m_ready.empty() || !m_running; });
+                if (m_ready.empty())
+                    break;
+
+                std::string type = m_ready.front();
+                m_ready.pop_front();
+
+                Queue& queue = m_queues[type];
+                Event event = queue.events.front();
+                queue.events.pop_front();
+                queue.metrics.queued = queue.events.size();
+
+                uint64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - event.dispatched).count();
+                lock.unlock();
+                handle(type, event.handler, queue.metrics, m_lock, latencyUs);
+                lock.lock();
+
+                if (queue.events.empty())
+                    queue.busy = false;
+                else
+                    m_ready.push_back(type);
+            }
+        }
+
+        void EventDispatcher::handle(const std::string& type, const Handler& handler, Metrics& metrics, std::mutex& lock, uint64_t latencyUs)
+        {
+            Clock::time_point start = Clock::now();
+            handler();
+            uint64_t handlingUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+            if (handlingUs > EVENT_DISPATCHER_SLOW_HANDLER_MS * 1000)
+                LOGWARN("%s: handled in %llu ms after %llu ms queued", type.c_str(),
+                        (unsigned long long)handlingUs / 1000, (unsigned long long)latencyUs / 1000);
+
+            std::lock_guard<std::mutex> guard(lock);
+            metrics.totalLatencyUs += latencyUs;
+            if (latencyUs > metrics.maxLatencyUs)
+                metrics.maxLatencyUs = latencyUs;
+            metrics.totalHandlingUs += handlingUs;
+            if (handlingUs > metrics.maxHandlingUs)
+                metrics.maxHandlingUs = handlingUs;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,99 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define EVENT_DISPATCHER_WORKERS 2
+/* Beyond this many queued events of a type, further ones of it are handled on the dispatching thread */
+#define EVENT_DISPATCHER_MAX_QUEUED 64
+/* Handlers running longer are logged */
+#define EVENT_DISPATCHER_SLOW_HANDLER_MS 500
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Moves the handling of events off the threads delivering them (IARM callbacks).
+        // A fixed number of workers serve all event types; the events of one type are
+        // handled one at a time, in the order they were dispatched. Stopping handles
+        // what is still queued. While stopped, events are handled on the dispatching thread.
+        class EventDispatcher {
+        public:
+            typedef std::function<void()> Handler;
+
+            struct Metrics {
+                uint32_t dispatched = 0;
+                uint32_t inlined = 0;       // handled on the dispatching thread
+                uint32_t queued = 0;        // waiting now
+                uint32_t maxQueued = 0;
+                uint64_t totalLatencyUs = 0;    // dispatch to start of handling
+                uint64_t maxLatencyUs = 0;
+                uint64_t totalHandlingUs = 0;
+                uint64_t maxHandlingUs = 0;
+            };
+
+            EventDispatcher();
+            ~EventDispatcher();
+
+            EventDispatcher(const EventDispatcher&) = delete;
+            EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+            void start(int workers = EVENT_DISPATCHER_WORKERS);
+            void stop();
+
+            void dispatch(const std::string& type, const Handler& handler);
+
+            std::map<std::string, Metrics> metrics() const;
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Event {
+                Handler handler;
+                Clock::time_point dispatched;
+            };
+
+            struct Queue {
+                std::deque<Event> events;
+                bool busy = false;          // in m_ready or being handled
+                Metrics metrics;
+            };
+
+            void worker();
+            static void handle(const std::string& type, const Handler& handler, Metrics& metrics, std::mutex& lock, uint64_t latencyUs);
+
+            mutable std::mutex m_lock;
+            std::condition_variable m_cv;
+            std::vector<std::thread> m_workers;
+            bool m_running;
+            std::map<std::string, Queue> m_queues;
+            std::deque<std::string> m_ready;    // types with events and no worker on them
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,353 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * Shared-memory ring of fixed-layout event records, for local consumers of
+ * high-frequency notifications (frame rate updates, playback progress, motion
+ * events) that do not want a JSON encode, a WebSocket frame and a parse for
+ * every event. The plugin creates the ring when a client calls its
+ * subscribeFast method, which returns the name to open. The JSON-RPC
+ * notifications are sent as before, they remain the way to get the events
+ * from another host or without this header.
+ *
+ * One writer, any number of readers, each at its own position. A record is
+ * protected by its own sequence: 2n+1 while record n is written into the
+ * slot, 2n+2 once it is complete. A reader that finds a later record in the
+ * slot it wants fell behind by more than the capacity: it skips to the oldest
+ * record still in the ring and counts the ones it lost. The writer never
+ * waits for readers.
+ *
+ * Readers may sleep on the `wakeup` futex, which is bumped with every record.
+ * The writer only makes the wake-up call while a reader waits.
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define FAST_EVENT_CHANNEL_PREFIX       "/rdkservices_fast_"
+#define FAST_EVENT_CHANNEL_MAGIC        0x46455631 /* "FEV1" */
+#define FAST_EVENT_CHANNEL_VERSION      1
+/* Records in the ring, a power of two */
+#define FAST_EVENT_CHANNEL_CAPACITY     256
+#define FAST_EVENT_TEXT_SIZE            32
+#define FAST_EVENT_VALUES               8
+
+namespace Utils
+{
+    // Record types, and what their fields carry
+    enum FastEventType : uint32_t {
+        // FrameRate onFpsEvent: values average, min, max fps, frames, p99 and max frame time (us),
+        // dropped frames, jank events
+        FAST_EVENT_FPS = 1,
+        // FireboltMediaPlayer playbackProgressUpdate: text the stream id, values position, duration,
+        // start and end (ms), playback speed
+        FAST_EVENT_PLAYBACK_PROGRESS = 2,
+        // MotionDetection onMotionEvent: text the detector index, values motion (1) or none (0),
+        // activity level (%)
+        FAST_EVENT_MOTION = 3
+    };
+
+    struct FastEventRecord {
+        std::atomic<uint64_t> sequence;
+        uint64_t timestampUs;           // CLOCK_MONOTONIC
+        uint32_t type;                  // FastEventType
+        uint32_t reserved;
+        int64_t values[FAST_EVENT_VALUES];
+        char text[FAST_EVENT_TEXT_SIZE];  // '\0' terminated
+        char padding[128 - 24 - FAST_EVENT_VALUES * 8 - FAST_EVENT_TEXT_SIZE];
+    };
+
+    struct FastEventChannelHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t capacity;
+        std::atomic<uint64_t> written;      // records published since the ring was created
+        std::atomic<uint32_t> wakeup;       // futex
+        std::atomic<uint32_t> waiters;
+        FastEventRecord records[FAST_EVENT_CHANNEL_CAPACITY];
+    };
+
+    inline uint64_t fastEventNowUs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    class FastEventChannelWriter {
+    public:
+        FastEventChannelWriter() : m_open(false), m_header(nullptr)
+        {
+        }
+
+        ~FastEventChannelWriter()
+        {
+            close();
+        }
+
+        FastEventChannelWriter(const FastEventChannelWriter&) = delete;
+        FastEventChannelWriter& operator=(const FastEventChannelWriter&) = delete;
+
+        /***
+         * @brief        : Create the ring, or map it again if this plugin created it before.
+         * @param1[in]   : <string> channel name, FAST_EVENT_CHANNEL_PREFIX and the callsign
+         * @return       : <bool> False if the segment is unavailable.
+         */
+        bool open(const std::string& name)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_header)
+                return true;
+
+            int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+            if (fd < 0)
+                return false;
+
+            if (ftruncate(fd, sizeof(FastEventChannelHeader)) == 0) {
+                void* addr = mmap(nullptr, sizeof(FastEventChannelHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (addr != MAP_FAILED)
+                    m_header = static_cast<FastEventChannelHeader*>(addr);
+            }
+            ::close(fd);
+            if (!m_header)
+                return false;
+
+            /* A ring of an earlier run goes on from where it was, its readers keep their place. */
+            if (m_header->magic != FAST_EVENT_CHANNEL_MAGIC || m_header->version != FAST_EVENT_CHANNEL_VERSION) {
+                m_header->version = FAST_EVENT_CHANNEL_VERSION;
+                m_header->recordSize = sizeof(FastEventRecord);
+                m_header->capacity = FAST_EVENT_CHANNEL_CAPACITY;
+                for (uint32_t i = 0; i < FAST_EVENT_CHANNEL_CAPACITY; i++)
+                    m_header->records[i].sequence.store(0, std::memory_order_relaxed);
+                m_header->written.store(0, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                m_header->magic = FAST_EVENT_CHANNEL_MAGIC;
+            }
+            m_name = name;
+            m_open = true;
+            return true;
+        }
+
+        /***
+         * @brief        : Unmap the ring and remove its name, readers that have it mapped keep it.
+         */
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_header)
+                return;
+            m_open = false;
+            munmap(m_header, sizeof(FastEventChannelHeader));
+            m_header = nullptr;
+            shm_unlink(m_name.c_str());
+        }
+
+        bool isOpen() const
+        {
+            return m_open;
+        }
+
+        const std::string& name() const
+        {
+            return m_name;
+        }
+
+        /***
+         * @brief        : Append a record, nothing without a ring.
+         * @param1[in]   : <FastEventType> type
+         * @param2[in]   : <int64_t*> values, up to FAST_EVENT_VALUES
+         * @param3[in]   : <size_t> number of values
+         * @param4[in]   : <string> text, cut to FAST_EVENT_TEXT_SIZE - 1
+         */
+        void publish(FastEventType type, const int64_t* values, size_t count, const std::string& text = std::string())
+        {
+            if (!m_open)
+                return;
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_header)
+                return;
+
+            uint64_t n = m_header->written.load(std::memory_order_relaxed);
+            FastEventRecord& record = m_header->records[n & (FAST_EVENT_CHANNEL_CAPACITY - 1)];
+
+            record.sequence.store(2 * n + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            record.timestampUs = fastEventNowUs();
+            record.type = type;
+            record.reserved = 0;
+            if (count > FAST_EVENT_VALUES)
+                count = FAST_EVENT_VALUES;
+            memcpy(record.values, values, count * sizeof(int64_t));
+            memset(record.values + count, 0, (FAST_EVENT_VALUES - count) * sizeof(int64_t));
+            size_t length = (text.size() < FAST_EVENT_TEXT_SIZE) ? text.size() : FAST_EVENT_TEXT_SIZE - 1;
+            memcpy(record.text, text.c_str(), length);
+            record.text[length] = '\0';
+
+            record.sequence.store(2 * n + 2, std::memory_order_release);
+            m_header->written.store(n + 1, std::memory_order_release);
+
+            m_header->wakeup.fetch_add(1, std::memory_order_release);
+            if (m_header->waiters.load(std::memory_order_acquire) != 0)
+                syscall(SYS_futex, &m_header->wakeup, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+        }
+
+    private:
+        std::mutex m_lock;
+        std::atomic<bool> m_open;       // no lock taken to publish nothing
+        FastEventChannelHeader* m_header;
+        std::string m_name;
+    };
+
+    class FastEventChannelReader {
+    public:
+        FastEventChannelReader() : m_header(nullptr), m_next(0)
+        {
+        }
+
+        ~FastEventChannelReader()
+        {
+            if (m_header)
+                munmap(m_header, sizeof(FastEventChannelHeader));
+        }
+
+        FastEventChannelReader(const FastEventChannelReader&) = delete;
+        FastEventChannelReader& operator=(const FastEventChannelReader&) = delete;
+
+        /***
+         * @brief        : Map the ring returned by subscribeFast, the first record read is the next one published.
+         * @param1[in]   : <string> channel name
+         * @return       : <bool> False if there is no such ring, or of another layout.
+         */
+        bool open(const std::string& name)
+        {
+            if (m_header)
+                return true;
+
+            int fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0)
+                return false;
+
+            /* Read-write for the waiters count and the futex, records are never written. */
+            void* addr = mmap(nullptr, sizeof(FastEventChannelHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED)
+                return false;
+
+            FastEventChannelHeader* header = static_cast<FastEventChannelHeader*>(addr);
+            if (header->magic != FAST_EVENT_CHANNEL_MAGIC || header->version != FAST_EVENT_CHANNEL_VERSION
+                    || header->recordSize != sizeof(FastEventRecord) || header->capacity != FAST_EVENT_CHANNEL_CAPACITY) {
+                munmap(addr, sizeof(FastEventChannelHeader));
+                return false;
+            }
+            m_header = header;
+            m_next = m_header->written.load(std::memory_order_acquire);
+            return true;
+        }
+
+        /***
+         * @brief        : Take the next record.
+         * @param1[out]  : <FastEventRecord> record, its sequence is (n + 1) * 2 for record n
+         * @param2[out]  : <uint64_t> records skipped because this reader fell too far behind
+         * @return       : <bool> False if there is no record to read yet.
+         */
+        bool read(FastEventRecord& out, uint64_t& lost)
+        {
+            lost = 0;
+            if (!m_header)
+                return false;
+
+            for (;;) {
+                uint64_t written = m_header->written.load(std::memory_order_acquire);
+                if (m_next >= written)
+                    return false;
+                if (written - m_next > FAST_EVENT_CHANNEL_CAPACITY) {
+                    lost += written - FAST_EVENT_CHANNEL_CAPACITY - m_next;
+                    m_next = written - FAST_EVENT_CHANNEL_CAPACITY;
+                }
+
+                const FastEventRecord& record = m_header->records[m_next & (FAST_EVENT_CHANNEL_CAPACITY - 1)];
+                uint64_t expected = 2 * m_next + 2;
+                uint64_t before = record.sequence.load(std::memory_order_acquire);
+                if (before == expected) {
+                    out.timestampUs = record.timestampUs;
+                    out.type = record.type;
+                    out.reserved = 0;
+                    memcpy(out.values, record.values, sizeof(out.values));
+                    memcpy(out.text, record.text, sizeof(out.text));
+                    out.text[FAST_EVENT_TEXT_SIZE - 1] = '\0';
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (record.sequence.load(std::memory_order_relaxed) == expected) {
+                        out.sequence.store(expected, std::memory_order_relaxed);
+                        m_next++;
+                        return true;
+                    }
+                }
+                /* Overwritten while or before it was copied: skip to what the ring holds now. */
+                if (before < expected && record.sequence.load(std::memory_order_relaxed) < expected)
+                    return false;
+                lost++;
+                m_next++;
+            }
+        }
+
+        /***
+         * @brief        : Sleep until a record is published after the ones read.
+         * @param1[in]   : <int> timeout in ms
+         * @return       : <bool> True if there is a record to read.
+         */
+        bool wait(int timeoutMs)
+        {
+            if (!m_header)
+                return false;
+
+            uint32_t wakeup = m_header->wakeup.load(std::memory_order_acquire);
+            if (m_header->written.load(std::memory_order_acquire) > m_next)
+                return true;
+
+            struct timespec timeout;
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+            m_header->waiters.fetch_add(1, std::memory_order_acq_rel);
+            syscall(SYS_futex, &m_header->wakeup, FUTEX_WAIT, wakeup, &timeout, nullptr, 0);
+            m_header->waiters.fetch_sub(1, std::memory_order_acq_rel);
+
+            return (m_header->written.load(std::memory_order_acquire) > m_next);
+        }
+
+    private:
+        FastEventChannelHeader* m_header;
+        uint64_t m_next;
+    };
+}
@@ -0,0 +1,67 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * The key/value store of the PersistentStore plugin for the other plugins, without JSON-RPC:
+ *
+ *     Exchange::IPersistentStore* store =
+ *         service->QueryInterfaceByCallsign<Exchange::IPersistentStore>("org.rdk.PersistentStore");
+ *     if (store != nullptr)
+ *     {
+ *         store->SetValue("ns", "key", "value");
+ *         store->Release();
+ *     }
+ *
+ * In process the calls go straight to the store, out of process over COM-RPC with the proxy stubs
+ * built into the PersistentStore plugin. The limits are those of the JSON-RPC API: namespace and
+ * key not empty, namespace, key and value no longer than 1000 bytes.
+ *
+ * Results: Core::ERROR_NONE, ERROR_BAD_REQUEST for invalid arguments, ERROR_UNKNOWN_KEY for a key
+ * that is not in the store, ERROR_GENERAL when the store could not be read or written (or is full).
+ */
+
+#include "Module.h"
+#include <interfaces/Ids.h>
+
+#include <vector>
+
+namespace WPEFramework {
+namespace Exchange {
+
+    struct EXTERNAL IPersistentStore : virtual public Core::IUnknown {
+        enum { ID = ID_BROWSER + 0x12000 };
+
+        virtual ~IPersistentStore() {}
+
+        virtual uint32_t SetValue(const string& ns, const string& key, const string& value) = 0;
+        virtual uint32_t GetValue(const string& ns, const string& key, string& value /* @out */) = 0;
+        virtual uint32_t DeleteKey(const string& ns, const string& key) = 0;
+        virtual uint32_t DeleteNamespace(const string& ns) = 0;
+
+        // One transaction each. keys and values of SetValues go in pairs, GetValues returns the
+        // keys it found, in pairs with their values.
+        virtual uint32_t SetValues(const string& ns, const std::vector<string>& keys, const std::vector<string>& values) = 0;
+        virtual uint32_t GetValues(const string& ns, const std::vector<string>& keys, std::vector<string>& found /* @out */, std::vector<string>& values /* @out */) = 0;
+        virtual uint32_t DeleteKeys(const string& ns, const std::vector<string>& keys) = 0;
+    };
+
+} // Exchange
+} // WPEFramework
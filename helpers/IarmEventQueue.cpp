@@ -0,0 +1,166 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "IarmEventQueue.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "utils.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        namespace {
+
+            // Recursive: a handler run on the IARM thread because its queue is full may subscribe
+            std::recursive_mutex& subscriptionLock()
+            {
+                static std::recursive_mutex lock;
+                return lock;
+            }
+
+            std::map<std::pair<std::string, IARM_EventId_t>, std::list<IarmEventQueue*>>& subscriptions()
+            {
+                static std::map<std::pair<std::string, IARM_EventId_t>, std::list<IarmEventQueue*>> queues;
+                return queues;
+            }
+
+            std::string typeOf(const std::pair<std::string, IARM_EventId_t>& key)
+            {
+                return key.first + "/" + std::to_string(key.second);
+            }
+        }
+
+        IarmEventQueue::IarmEventQueue()
+        {
+        }
+
+        IarmEventQueue::~IarmEventQueue()
+        {
+            stop();
+        }
+
+        void IarmEventQueue::start()
+        {
+            m_dispatcher.start(1);
+        }
+
+        void IarmEventQueue::stop()
+        {
+            std::vector<Key> keys;
+            {
+                std::lock_guard<std::recursive_mutex> lock(subscriptionLock());
+                for (const auto& handler : m_handlers)
+                    keys.push_back(handler.first);
+            }
+            for (const Key& key : keys)
+                unsubscribe(key.first.c_str(), key.second);
+
+            m_dispatcher.stop();
+        }
+
+        IARM_Result_t IarmEventQueue::subscribe(const char* owner, IARM_EventId_t eventId, const Handler& handler)
+        {
+            Key key(owner, eventId);
+            bool first;
+            {
+                std::lock_guard<std::recursive_mutex> lock(subscriptionLock());
+
+                if (m_handlers.count(key) != 0) {
+                    m_handlers[key] = handler;
+                    return IARM_RESULT_SUCCESS;
+                }
+
+                std::list<IarmEventQueue*>& queues = subscriptions()[key];
+                first = queues.empty();
+                queues.push_back(this);
+                m_handlers[key] = handler;
+            }
+
+            // Outside of the lock, IARM may be delivering an event to onEvent
+            IARM_Result_t result = first ? IARM_Bus_RegisterEventHandler(owner, eventId, onEvent) : IARM_RESULT_SUCCESS;
+            if (result != IARM_RESULT_SUCCESS) {
+                LOGERR("registering for %s / %d failed: %d", owner, (int)eventId, (int)result);
+
+                std::lock_guard<std::recursive_mutex> lock(subscriptionLock());
+                subscriptions()[key].remove(this);
+                m_handlers.erase(key);
+            }
+            return result;
+        }
+
+        IARM_Result_t IarmEventQueue::unsubscribe(const char* owner, IARM_EventId_t eventId)
+        {
+            Key key(owner, eventId);
+            bool last;
+            {
+                std::lock_guard<std::recursive_mutex> lock(subscriptionLock());
+
+                if (m_handlers.erase(key) == 0)
+                    return IARM_RESULT_SUCCESS;
+
+                std::list<IarmEventQueue*>& queues = subscriptions()[key];
+                queues.remove(this);
+                last = queues.empty();
+                if (last)
+                    subscriptions().erase(key);
+            }
+
+            return last ? IARM_Bus_RemoveEventHandler(owner, eventId, onEvent) : IARM_RESULT_SUCCESS;
+        }
+
+        std::map<std::string, EventDispatcher::Metrics> IarmEventQueue::metrics() const
+        {
+            return m_dispatcher.metrics();
+        }
+
+        void IarmEventQueue::onEvent(const char* owner, IARM_EventId_t eventId, void* data, size_t len)
+        {
+            Key key(owner, eventId);
+
+            // Held while queueing, so that a queue is not destroyed under it
+            std::lock_guard<std::recursive_mutex> lock(subscriptionLock());
+
+            auto entry = subscriptions().find(key);
+            if (entry == subscriptions().end())
+                return;
+
+            for (IarmEventQueue* queue : entry->second)
+                queue->enqueue(key, data, len);
+        }
+
+        void IarmEventQueue::enqueue(const Key& key, const void* data, size_t len)
+        {
+            auto handler = m_handlers.find(key);
+            if (handler == m_handlers.end())
+                return;
+
+            std::shared_ptr<std::vector<char>> payload = std::make_shared<std::vector<char>>();
+            if (data != nullptr && len > 0)
+                payload->assign(static_cast<const char*>(data), static_cast<const char*>(data) + len);
+
+            Handler callback = handler->second;
+            m_dispatcher.dispatch(typeOf(key), [key, payload, callback]() {
+                callback(key.first.c_str(), key.second, payload->empty() ? nullptr : payload->data(), payload->size());
+            });
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,75 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "libIBus.h"
+
+#include "EventDispatcher.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Handles the IARM events of one plugin on its own worker instead of IARM's callback thread,
+        // so a slow handler only delays the events of its own plugin. The payload is copied when the
+        // event arrives and queued on an EventDispatcher per plugin. One worker handles the events,
+        // so handlers don't run in parallel, as on the IARM thread. When EVENT_DISPATCHER_MAX_QUEUED
+        // events of a type are waiting, further ones are handled on the IARM thread.
+        //
+        // The library registers a single IARM handler per (owner, event) for all of its queues and
+        // removes only that handler again with IARM_Bus_RemoveEventHandler. IARM_Bus_UnRegisterEventHandler
+        // would also drop the handlers of the other plugins in the process.
+        class IarmEventQueue {
+        public:
+            // Same as an IARM handler; data points to the copy of the payload, valid during the call
+            typedef std::function<void(const char* owner, IARM_EventId_t eventId, void* data, size_t len)> Handler;
+
+            IarmEventQueue();
+            ~IarmEventQueue();
+
+            IarmEventQueue(const IarmEventQueue&) = delete;
+            IarmEventQueue& operator=(const IarmEventQueue&) = delete;
+
+            void start();
+            // Unsubscribes from all events, then handles what is still queued
+            void stop();
+
+            IARM_Result_t subscribe(const char* owner, IARM_EventId_t eventId, const Handler& handler);
+            IARM_Result_t unsubscribe(const char* owner, IARM_EventId_t eventId);
+
+            // Per "<owner>/<eventId>": queue depth, latency to the start of the handler and handling time
+            std::map<std::string, EventDispatcher::Metrics> metrics() const;
+
+        private:
+            typedef std::pair<std::string, IARM_EventId_t> Key;
+
+            static void onEvent(const char* owner, IARM_EventId_t eventId, void* data, size_t len);
+            void enqueue(const Key& key, const void* data, size_t len);
+
+            EventDispatcher m_dispatcher;
+            std::map<Key, Handler> m_handlers;  // guarded by the lock of the library's subscriptions
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
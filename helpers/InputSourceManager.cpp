@@ -0,0 +1,145 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "InputSourceManager.h"
+
+#include "utils.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        InputSourceManager::InputSourceManager(const Select& select, const Scale& scale)
+            : m_select(select)
+            , m_scale(scale)
+            , m_selected(-1)
+            , m_planeApplied(false)
+            , m_pending(false)
+        {
+        }
+
+        bool InputSourceManager::start(int port)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (port == m_selected)
+            {
+                LOGINFO("Port %d is already selected", port);
+                return applyPlane(port);
+            }
+
+            Clock::time_point start = Clock::now();
+            if (!m_select(port))
+                return false;
+
+            m_last.from = m_selected;
+            m_last.to = port;
+            m_last.selectMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+            m_last.presentMs = -1;
+            m_selected = port;
+            m_pending = true;
+            m_startTime = start;
+
+            applyPlane(port);
+            LOGINFO("Switched from port %d to %d, select took %lld ms", m_last.from, port, (long long)m_last.selectMs);
+            return true;
+        }
+
+        bool InputSourceManager::stop()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (!m_select(-1))
+                return false;
+
+            m_selected = -1;
+            m_pending = false;
+            return true;
+        }
+
+        bool InputSourceManager::scale(const Plane& plane)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (!m_scale(plane))
+                return false;
+
+            m_applied = plane;
+            m_planeApplied = true;
+
+            if (m_selected >= 0)
+            {
+                m_planes.remove_if([this](const std::pair<int, Plane>& entry) { return entry.first == m_selected; });
+                m_planes.push_front(std::make_pair(m_selected, plane));
+                if (m_planes.size() > INPUT_SOURCE_PLANE_CACHE)
+                    m_planes.pop_back();
+            }
+            return true;
+        }
+
+        void InputSourceManager::presented(int port, bool isPresented)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (isPresented && m_pending && (port == m_selected))
+            {
+                m_pending = false;
+                m_last.presentMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_startTime).count();
+                m_switchTimes.record(m_last.presentMs);
+                LOGINFO("Port %d presented %lld ms after start", port, (long long)m_last.presentMs);
+            }
+            else if (!isPresented && !m_pending && (port == m_selected))
+            {
+                // Stopped by someone else, the next start has to select it again
+                m_selected = -1;
+            }
+        }
+
+        InputSourceManager::Switch InputSourceManager::lastSwitch() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_last;
+        }
+
+        void InputSourceManager::statistics(Utils::Metrics::Histogram::Summary& summary)
+        {
+            m_switchTimes.read(summary, false);
+        }
+
+        // Called with m_lock held. Ports without a remembered plane keep the current one.
+        bool InputSourceManager::applyPlane(int port)
+        {
+            for (auto it = m_planes.begin(); it != m_planes.end(); ++it)
+            {
+                if (it->first != port)
+                    continue;
+
+                m_planes.splice(m_planes.begin(), m_planes, it);
+                const Plane& plane = m_planes.front().second;
+                if (m_planeApplied && (plane == m_applied))
+                    return true;
+                if (!m_scale(plane))
+                    return false;
+                m_applied = plane;
+                m_planeApplied = true;
+                return true;
+            }
+            return true;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
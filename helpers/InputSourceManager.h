@@ -0,0 +1,104 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+
+#include "Metrics.h"
+
+/* Inputs whose video plane is remembered */
+#define INPUT_SOURCE_PLANE_CACHE 4
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Start, stop and switching of the ports of one input type (HDMI In, Composite In).
+        // The HAL presents one port per type and selectPort() switches between ports in place,
+        // so starting a port while another one is presented is done as a single select, and
+        // starting the port that is already selected costs nothing. The video plane (scaling)
+        // set while a port is selected is remembered for the last INPUT_SOURCE_PLANE_CACHE ports
+        // and applied again right after switching back to it. Every switch is timed from the
+        // start request to the presentation of the port.
+        class InputSourceManager {
+        public:
+            struct Plane {
+                int x = 0;
+                int y = 0;
+                int width = 0;
+                int height = 0;
+
+                bool operator==(const Plane& other) const
+                {
+                    return (x == other.x) && (y == other.y) && (width == other.width) && (height == other.height);
+                }
+            };
+
+            struct Switch {
+                int from = -1;
+                int to = -1;
+                int64_t selectMs = 0;       // the select call itself
+                int64_t presentMs = -1;     // start request to presentation, -1 while pending
+            };
+
+            // Both return false if the HAL call failed; select(-1) stops the input
+            typedef std::function<bool(int port)> Select;
+            typedef std::function<bool(const Plane& plane)> Scale;
+
+            InputSourceManager(const Select& select, const Scale& scale);
+
+            InputSourceManager(const InputSourceManager&) = delete;
+            InputSourceManager& operator=(const InputSourceManager&) = delete;
+
+            bool start(int port);
+            bool stop();
+            bool scale(const Plane& plane);
+
+            // From the input status event
+            void presented(int port, bool isPresented);
+
+            Switch lastSwitch() const;
+            // Start to presentation times, in ms, since the plugin started
+            void statistics(Utils::Metrics::Histogram::Summary& summary);
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            bool applyPlane(int port);
+
+            Select m_select;
+            Scale m_scale;
+
+            mutable std::mutex m_lock;
+            int m_selected;
+            bool m_planeApplied;
+            Plane m_applied;
+            std::list<std::pair<int, Plane>> m_planes;     // most recently used first
+            bool m_pending;
+            Clock::time_point m_startTime;
+            Switch m_last;
+            Utils::Metrics::Histogram m_switchTimes;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
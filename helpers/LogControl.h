@@ -0,0 +1,135 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * Runtime side of the LOG* macros in utils.h.
+ *
+ * PLUGINS_LOG_LEVEL=DEBUG|INFO|WARN|ERROR in the environment of the framework
+ * sets the level below which lines are skipped, LogControl::setLevel changes
+ * it later on. Levels compiled out with UTILS_LOG_LEVEL stay out.
+ *
+ * PLUGINS_LOG_METHOD_LIMIT cuts the JSON logged by LOGINFOMETHOD,
+ * LOGTRACEMETHODFIN and sendNotify, e.g. "1024,Plugin_Bluetooth=256,Plugin_DisplaySettings=0":
+ * a plain number applies to every plugin, <module>=<bytes> to one plugin, 0 is
+ * no limit. A plugin can build in its own default with UTILS_LOG_METHOD_LIMIT.
+ */
+
+#include <atomic>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define UTILS_LOG_LEVEL_DEBUG 0
+#define UTILS_LOG_LEVEL_INFO 1
+#define UTILS_LOG_LEVEL_WARN 2
+#define UTILS_LOG_LEVEL_ERROR 3
+
+namespace Utils
+{
+    namespace LogControl
+    {
+        inline int parseLevel(const char* text, int fallback)
+        {
+            int result = fallback;
+
+            if (text == nullptr || *text == '\0')
+                result = fallback;
+            else if (strcasecmp(text, "DEBUG") == 0)
+                result = UTILS_LOG_LEVEL_DEBUG;
+            else if (strcasecmp(text, "INFO") == 0)
+                result = UTILS_LOG_LEVEL_INFO;
+            else if (strcasecmp(text, "WARN") == 0)
+                result = UTILS_LOG_LEVEL_WARN;
+            else if (strcasecmp(text, "ERROR") == 0)
+                result = UTILS_LOG_LEVEL_ERROR;
+
+            return result;
+        }
+
+        inline std::atomic<int>& currentLevel()
+        {
+            static std::atomic<int> level(parseLevel(getenv("PLUGINS_LOG_LEVEL"), UTILS_LOG_LEVEL_DEBUG));
+            return level;
+        }
+
+        /***
+         * @brief        : Whether lines of this level are logged now. Cheap, test it before building a message.
+         * @param1[in]   : <int> UTILS_LOG_LEVEL_*
+         * @return       : <bool>
+         */
+        inline bool enabled(int level)
+        {
+            return level >= currentLevel().load(std::memory_order_relaxed);
+        }
+
+        inline void setLevel(int level)
+        {
+            currentLevel().store(level, std::memory_order_relaxed);
+        }
+
+        /***
+         * @brief        : Truncation limit of logged JSON for a plugin, from PLUGINS_LOG_METHOD_LIMIT.
+         * @param1[in]   : <const char*> MODULE_NAME of the plugin, may be empty
+         * @param2[in]   : <size_t> limit built into the plugin, 0 for none
+         * @return       : <size_t> limit in bytes, 0 for no limit
+         */
+        inline size_t methodLimit(const char* module, size_t builtIn)
+        {
+            const char* spec = getenv("PLUGINS_LOG_METHOD_LIMIT");
+            size_t moduleLength = strlen(module);
+            size_t general = 0;
+            bool hasGeneral = false;
+            bool hasModule = false;
+            size_t result = 0;
+
+            while (spec != nullptr && *spec != '\0' && !hasModule) {
+                const char* end = strchr(spec, ',');
+                size_t length = (end != nullptr) ? static_cast<size_t>(end - spec) : strlen(spec);
+                const char* equals = static_cast<const char*>(memchr(spec, '=', length));
+
+                if (equals == nullptr) {
+                    general = strtoul(spec, nullptr, 10);
+                    hasGeneral = true;
+                } else if (moduleLength != 0 && static_cast<size_t>(equals - spec) == moduleLength && strncmp(spec, module, moduleLength) == 0) {
+                    result = strtoul(equals + 1, nullptr, 10);
+                    hasModule = true;
+                }
+
+                spec = (end != nullptr) ? end + 1 : nullptr;
+            }
+
+            if (!hasModule)
+                result = (builtIn != 0) ? builtIn : (hasGeneral ? general : 0);
+
+            return result;
+        }
+
+        inline void truncate(std::string& text, size_t limit)
+        {
+            if (limit != 0 && text.size() > limit) {
+                size_t total = text.size();
+                text.resize(limit);
+                text += "...(" + std::to_string(total) + " bytes)";
+            }
+        }
+    }
+}
@@ -0,0 +1,368 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * In-process counters and histograms for the plugins.
+ *
+ * Utils::Metrics::registry() holds the metrics of a plugin library. Look a
+ * metric up once and keep the reference (e.g. in a static local), updating it
+ * takes no lock: counters are split over per-thread shards and histograms are
+ * plain atomic buckets.
+ *
+ * Utils::Metrics::attach(service) in Initialize hands the registry to the
+ * Telemetry plugin (org.rdk.Telemetry, in process), which drains it every
+ * aggregation window into one T2 marker per metric and returns it from
+ * getMetrics. Call detach() in Deinitialize, before the library is unloaded.
+ * If Telemetry is not active at attach time the metrics stay local.
+ *
+ * Histograms are log-linear like HDR histograms: 16 buckets per power of two,
+ * about 6% relative error, for durations in us or sizes in bytes.
+ */
+
+#include "Module.h"
+#include <interfaces/Ids.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Utils
+{
+    namespace Metrics
+    {
+        const size_t kShards = 16;
+
+        // Shard of the calling thread, threads are spread round robin
+        inline size_t shard()
+        {
+            static std::atomic<size_t> next(0);
+            thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+            return index;
+        }
+
+        class Counter
+        {
+        public:
+            Counter()
+            {
+                for (Shard& entry : mShards)
+                    entry.value.store(0, std::memory_order_relaxed);
+            }
+            Counter(const Counter&) = delete;
+            Counter& operator=(const Counter&) = delete;
+
+            void add(uint64_t value = 1)
+            {
+                mShards[shard()].value.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            /***
+             * @brief        : Total since the last drain.
+             * @param1[in]   : <bool> reset the counter
+             * @return       : <uint64_t>
+             */
+            uint64_t read(bool drain)
+            {
+                uint64_t total = 0;
+                for (Shard& entry : mShards)
+                    total += drain ? entry.value.exchange(0, std::memory_order_relaxed) : entry.value.load(std::memory_order_relaxed);
+                return total;
+            }
+
+        private:
+            // One cache line per shard so that threads don't share lines
+            struct Shard
+            {
+                std::atomic<uint64_t> value;
+                char padding[64 - sizeof(std::atomic<uint64_t>)];
+            };
+
+            Shard mShards[kShards];
+        };
+
+        class Histogram
+        {
+        public:
+            static const unsigned kSubBuckets = 16;
+            static const size_t kBuckets = (64 - 3) * kSubBuckets;
+
+            struct Summary
+            {
+                uint64_t count;
+                uint64_t sum;
+                uint64_t min;
+                uint64_t max;
+                uint64_t p50;
+                uint64_t p90;
+                uint64_t p99;
+            };
+
+            Histogram()
+                : mSum(0)
+                , mMin(UINT64_MAX)
+                , mMax(0)
+            {
+                for (std::atomic<uint32_t>& bucket : mBuckets)
+                    bucket.store(0, std::memory_order_relaxed);
+            }
+            Histogram(const Histogram&) = delete;
+            Histogram& operator=(const Histogram&) = delete;
+
+            void record(uint64_t value)
+            {
+                mBuckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+                mSum.fetch_add(value, std::memory_order_relaxed);
+
+                uint64_t current = mMin.load(std::memory_order_relaxed);
+                while (value < current && !mMin.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                    ;
+                current = mMax.load(std::memory_order_relaxed);
+                while (value > current && !mMax.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                    ;
+            }
+
+            /***
+             * @brief        : Values since the last drain. Values recorded while draining may land in either window.
+             * @param1[out]  : <Summary> percentiles are bucket upper bounds, capped at max
+             * @param2[in]   : <bool> reset the histogram
+             */
+            void read(Summary& summary, bool drain)
+            {
+                uint32_t counts[kBuckets];
+                uint64_t count = 0;
+
+                for (size_t i = 0; i < kBuckets; i++)
+                {
+                    counts[i] = drain ? mBuckets[i].exchange(0, std::memory_order_relaxed) : mBuckets[i].load(std::memory_order_relaxed);
+                    count += counts[i];
+                }
+
+                summary.count = count;
+                summary.sum = drain ? mSum.exchange(0, std::memory_order_relaxed) : mSum.load(std::memory_order_relaxed);
+                summary.min = drain ? mMin.exchange(UINT64_MAX, std::memory_order_relaxed) : mMin.load(std::memory_order_relaxed);
+                summary.max = drain ? mMax.exchange(0, std::memory_order_relaxed) : mMax.load(std::memory_order_relaxed);
+
+                if (count == 0)
+                {
+                    summary.sum = summary.min = summary.max = 0;
+                    summary.p50 = summary.p90 = summary.p99 = 0;
+                    return;
+                }
+
+                summary.p50 = percentile(counts, count, 50, summary.max);
+                summary.p90 = percentile(counts, count, 90, summary.max);
+                summary.p99 = percentile(counts, count, 99, summary.max);
+            }
+
+            static size_t index(uint64_t value)
+            {
+                if (value < kSubBuckets)
+                    return value;
+
+                unsigned power = 63 - __builtin_clzll(value);
+                return (power - 3) * kSubBuckets + ((value >> (power - 4)) - kSubBuckets);
+            }
+
+            static uint64_t upperBound(size_t index)
+            {
+                if (index < kSubBuckets)
+                    return index;
+
+                unsigned power = index / kSubBuckets + 3;
+                uint64_t width = uint64_t(1) << (power - 4);
+                return ((kSubBuckets + index % kSubBuckets) * width) + (width - 1);
+            }
+
+        private:
+            static uint64_t percentile(const uint32_t* counts, uint64_t count, unsigned percent, uint64_t max)
+            {
+                uint64_t rank = (count * percent + 99) / 100;
+                uint64_t seen = 0;
+
+                for (size_t i = 0; i < kBuckets; i++)
+                {
+                    seen += counts[i];
+                    if (seen >= rank)
+                        return std::min(upperBound(i), max);
+                }
+                return max;
+            }
+
+            std::atomic<uint32_t> mBuckets[kBuckets];
+            std::atomic<uint64_t> mSum;
+            std::atomic<uint64_t> mMin;
+            std::atomic<uint64_t> mMax;
+        };
+
+        // Records the lifetime of the object in us
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(Histogram& histogram)
+                : mHistogram(histogram)
+                , mStart(std::chrono::steady_clock::now())
+            {
+            }
+            ~ScopedTimer()
+            {
+                mHistogram.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart).count());
+            }
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        private:
+            Histogram& mHistogram;
+            std::chrono::steady_clock::time_point mStart;
+        };
+
+        struct Sample
+        {
+            std::string name;
+            bool histogram;
+            Histogram::Summary summary; // a counter only sets count
+        };
+
+        class Registry
+        {
+        public:
+            Registry() = default;
+            Registry(const Registry&) = delete;
+            Registry& operator=(const Registry&) = delete;
+
+            // Metric names end up as T2 markers, prefix them with the plugin, e.g. "DisplaySettings_setResolution_us"
+            Counter& counter(const std::string& name)
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                std::unique_ptr<Counter>& entry = mCounters[name];
+                if (!entry)
+                    entry.reset(new Counter());
+                return *entry;
+            }
+
+            Histogram& histogram(const std::string& name)
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                std::unique_ptr<Histogram>& entry = mHistograms[name];
+                if (!entry)
+                    entry.reset(new Histogram());
+                return *entry;
+            }
+
+            void collect(std::vector<Sample>& samples, bool drain)
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+
+                for (auto& entry : mCounters)
+                {
+                    Sample sample = {};
+                    sample.name = entry.first;
+                    sample.histogram = false;
+                    sample.summary.count = entry.second->read(drain);
+                    samples.push_back(sample);
+                }
+                for (auto& entry : mHistograms)
+                {
+                    Sample sample = {};
+                    sample.name = entry.first;
+                    sample.histogram = true;
+                    entry.second->read(sample.summary, drain);
+                    samples.push_back(sample);
+                }
+            }
+
+        private:
+            std::mutex mLock;
+            std::map<std::string, std::unique_ptr<Counter>> mCounters;
+            std::map<std::string, std::unique_ptr<Histogram>> mHistograms;
+        };
+
+        // Registry of the plugin library
+        inline Registry& registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+    }
+}
+
+namespace WPEFramework {
+namespace Exchange {
+
+    // Implemented by the Telemetry plugin. In process only, the registry is handed over as a pointer.
+    struct EXTERNAL IMetricsCollector : virtual public Core::IUnknown {
+        enum { ID = ID_BROWSER + 0x11000 };
+
+        virtual ~IMetricsCollector() {}
+
+        virtual void Attach(const string& module, Utils::Metrics::Registry* registry) = 0;
+        virtual void Detach(Utils::Metrics::Registry* registry) = 0;
+    };
+
+}
+}
+
+namespace Utils
+{
+    namespace Metrics
+    {
+        inline WPEFramework::Exchange::IMetricsCollector*& collector()
+        {
+            static WPEFramework::Exchange::IMetricsCollector* instance = nullptr;
+            return instance;
+        }
+
+        /***
+         * @brief        : Hands the registry of the plugin library to the Telemetry plugin.
+         * @param1[in]   : <IShell*> service of the plugin, its callsign names the metrics over JSON-RPC
+         * @return       : <bool> false if Telemetry is not active
+         */
+        inline bool attach(WPEFramework::PluginHost::IShell* service)
+        {
+            if (collector() != nullptr)
+                return true;
+
+            WPEFramework::Exchange::IMetricsCollector* metricsCollector =
+                service->QueryInterfaceByCallsign<WPEFramework::Exchange::IMetricsCollector>("org.rdk.Telemetry");
+            if (metricsCollector == nullptr)
+                return false;
+
+            metricsCollector->Attach(service->Callsign(), &registry());
+            collector() = metricsCollector;
+            return true;
+        }
+
+        inline void detach()
+        {
+            if (collector() != nullptr)
+            {
+                collector()->Detach(&registry());
+                collector()->Release();
+                collector() = nullptr;
+            }
+        }
+    }
+}
@@ -0,0 +1,277 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "SettingsStore.h"
+
+#include "utils.h"
+
+#define PERSISTENT_STORE_CALLSIGN "org.rdk.PersistentStore.1"
+#define PERSISTENT_STORE_TIMEOUT_MS 2000
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        SettingsStore::SettingsStore(const std::string& ns)
+            : m_namespace(ns)
+            , m_loaded(false)
+            , m_nextId(1)
+            , m_stop(false)
+        {
+            m_writer = std::thread(&SettingsStore::run, this);
+        }
+
+        SettingsStore::~SettingsStore()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stop = true;
+            }
+            m_wakeup.notify_all();
+            m_writer.join();
+        }
+
+        bool SettingsStore::get(const std::string& key, std::string& value)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            load(lock);
+
+            auto entry = m_values.find(key);
+            if (entry == m_values.end())
+                return false;
+
+            value = entry->second;
+            return true;
+        }
+
+        std::string SettingsStore::get(const std::string& key, const std::string& defaultValue)
+        {
+            std::string value;
+            return get(key, value) ? value : defaultValue;
+        }
+
+        bool SettingsStore::getBool(const std::string& key, bool& value)
+        {
+            std::string stored;
+            if (!get(key, stored) || (stored != "true" && stored != "false"))
+                return false;
+
+            value = (stored == "true");
+            return true;
+        }
+
+        void SettingsStore::set(const std::string& key, const std::string& value)
+        {
+            std::list<Listener> listeners;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+
+                auto entry = m_values.find(key);
+                if (entry != m_values.end() && entry->second == value)
+                    return;
+
+                m_values[key] = value;
+                m_pending[key] = value;
+                m_lastSet = Clock::now();
+
+                for (const Subscription& subscription : m_subscriptions)
+                    if (subscription.key == key)
+                        listeners.push_back(subscription.listener);
+            }
+            m_wakeup.notify_all();
+
+            for (const Listener& listener : listeners)
+                listener(key, value);
+        }
+
+        void SettingsStore::setBool(const std::string& key, bool value)
+        {
+            set(key, value ? "true" : "false");
+        }
+
+        uint32_t SettingsStore::subscribe(const std::string& key, const Listener& listener)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            uint32_t id = m_nextId++;
+            m_subscriptions.push_back({ id, key, listener });
+            return id;
+        }
+
+        void SettingsStore::unsubscribe(uint32_t id)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            m_subscriptions.remove_if([id](const Subscription& subscription) { return subscription.id == id; });
+        }
+
+        bool SettingsStore::flush()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            return write(lock);
+        }
+
+        // Called with the lock held, keeps it over the round trip so that readers wait for the values
+        bool SettingsStore::load(std::unique_lock<std::mutex>& /* lock */)
+        {
+            if (m_loaded)
+                return true;
+
+            Clock::time_point now = Clock::now();
+            if (m_lastLoad != Clock::time_point() && now - m_lastLoad < std::chrono::milliseconds(SETTINGS_STORE_RETRY_MS))
+                return false;
+            m_lastLoad = now;
+
+            auto client = Utils::getThunderControllerClient(PERSISTENT_STORE_CALLSIGN);
+            if (!client)
+            {
+                LOGWARN("%s is not available, settings of %s not loaded", PERSISTENT_STORE_CALLSIGN, m_namespace.c_str());
+                return false;
+            }
+
+            JsonObject params;
+            JsonObject result;
+            params["namespace"] = m_namespace;
+            uint32_t status = client->Invoke<JsonObject, JsonObject>(PERSISTENT_STORE_TIMEOUT_MS, "getKeys", params, result);
+            Utils::releaseThunderControllerClient(client, status);
+            if (status != Core::ERROR_NONE || !result["success"].Boolean())
+            {
+                LOGWARN("Could not read the keys of %s, status %u", m_namespace.c_str(), status);
+                return false;
+            }
+
+            JsonArray keys = result["keys"].Array();
+            std::map<std::string, std::string> values;
+            if (keys.Length() > 0)
+            {
+                JsonArray items;
+                for (int i = 0; i < keys.Length(); i++)
+                {
+                    JsonObject item;
+                    item["namespace"] = m_namespace;
+                    item["key"] = keys[i].String();
+                    items.Add(item);
+                }
+
+                JsonObject request;
+                request["items"] = items;
+                result = JsonObject();
+                status = client->Invoke<JsonObject, JsonObject>(PERSISTENT_STORE_TIMEOUT_MS, "getValues", request, result);
+                Utils::releaseThunderControllerClient(client, status);
+                if (status != Core::ERROR_NONE || !result["success"].Boolean())
+                {
+                    LOGWARN("Could not read the settings of %s, status %u", m_namespace.c_str(), status);
+                    return false;
+                }
+
+                JsonArray stored = result["values"].Array();
+                for (int i = 0; i < stored.Length(); i++)
+                {
+                    JsonObject entry = stored[i].Object();
+                    values[entry["key"].String()] = entry["value"].String();
+                }
+            }
+
+            // Values set before the load are newer than the stored ones
+            for (const auto& entry : m_pending)
+                values[entry.first] = entry.second;
+            m_values.swap(values);
+            m_loaded = true;
+
+            LOGINFO("Loaded %u settings of %s", (unsigned)m_values.size(), m_namespace.c_str());
+            return true;
+        }
+
+        // Called with the lock held, drops it over the round trip
+        bool SettingsStore::write(std::unique_lock<std::mutex>& lock)
+        {
+            if (m_pending.empty())
+                return true;
+
+            std::map<std::string, std::string> pending;
+            pending.swap(m_pending);
+
+            JsonArray items;
+            for (const auto& entry : pending)
+            {
+                JsonObject item;
+                item["namespace"] = m_namespace;
+                item["key"] = entry.first;
+                item["value"] = entry.second;
+                items.Add(item);
+            }
+
+            lock.unlock();
+
+            bool success = false;
+            auto client = Utils::getThunderControllerClient(PERSISTENT_STORE_CALLSIGN);
+            if (client)
+            {
+                JsonObject params;
+                JsonObject result;
+                params["items"] = items;
+                uint32_t status = client->Invoke<JsonObject, JsonObject>(PERSISTENT_STORE_TIMEOUT_MS, "setValues", params, result);
+                Utils::releaseThunderControllerClient(client, status);
+                success = (status == Core::ERROR_NONE && result["success"].Boolean());
+                if (!success)
+                    LOGERR("Could not write %u settings of %s, status %u", (unsigned)pending.size(), m_namespace.c_str(), status);
+            }
+
+            lock.lock();
+
+            if (!success)
+            {
+                // Keep the values that were not set again in the meantime for the next attempt
+                for (const auto& entry : pending)
+                    m_pending.insert(entry);
+            }
+            return success;
+        }
+
+        void SettingsStore::run()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            while (!m_stop)
+            {
+                if (m_pending.empty())
+                {
+                    m_wakeup.wait(lock);
+                    continue;
+                }
+
+                Clock::time_point due = m_lastSet + std::chrono::milliseconds(SETTINGS_STORE_WRITE_DELAY_MS);
+                if (Clock::now() < due)
+                {
+                    m_wakeup.wait_until(lock, due);
+                    continue;
+                }
+
+                if (!write(lock) && !m_stop)
+                {
+                    // PersistentStore is not available, try again later
+                    m_wakeup.wait_for(lock, std::chrono::milliseconds(SETTINGS_STORE_RETRY_MS));
+                }
+            }
+
+            write(lock);
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,100 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* Writes made within this time are sent to PersistentStore in one call */
+#define SETTINGS_STORE_WRITE_DELAY_MS 500
+/* Time between attempts to load the namespace while PersistentStore is not available */
+#define SETTINGS_STORE_RETRY_MS 5000
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Small settings of a plugin, kept in one PersistentStore (org.rdk.PersistentStore) namespace.
+        // The whole namespace is read with a single getKeys + getValues round trip on first use and
+        // served from memory afterwards. set() updates the cache right away, calls the subscribers
+        // of the key and queues the value; queued values are written with a single setValues call
+        // once no other value was set for SETTINGS_STORE_WRITE_DELAY_MS, and on destruction.
+        // PersistentStore is called over JSON-RPC, so the store must not be used before the
+        // plugin's Initialize or from a PersistentStore event handler.
+        class SettingsStore {
+        public:
+            typedef std::function<void(const std::string& key, const std::string& value)> Listener;
+
+            explicit SettingsStore(const std::string& ns);
+            ~SettingsStore();
+
+            SettingsStore(const SettingsStore&) = delete;
+            SettingsStore& operator=(const SettingsStore&) = delete;
+
+            // false if the key is not stored, or PersistentStore could not be read yet
+            bool get(const std::string& key, std::string& value);
+            std::string get(const std::string& key, const std::string& defaultValue);
+            bool getBool(const std::string& key, bool& value);
+
+            void set(const std::string& key, const std::string& value);
+            void setBool(const std::string& key, bool value);
+
+            // Called after set() changed the value of the key, from the thread that called set()
+            uint32_t subscribe(const std::string& key, const Listener& listener);
+            void unsubscribe(uint32_t id);
+
+            // Writes the queued values now; false if PersistentStore rejected them, they stay queued
+            bool flush();
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Subscription {
+                uint32_t id;
+                std::string key;
+                Listener listener;
+            };
+
+            bool load(std::unique_lock<std::mutex>& lock);
+            bool write(std::unique_lock<std::mutex>& lock);
+            void run();
+
+            const std::string m_namespace;
+
+            std::mutex m_lock;
+            std::condition_variable m_wakeup;
+            bool m_loaded;
+            Clock::time_point m_lastLoad;
+            std::map<std::string, std::string> m_values;
+            std::map<std::string, std::string> m_pending;
+            Clock::time_point m_lastSet;
+            std::list<Subscription> m_subscriptions;
+            uint32_t m_nextId;
+            bool m_stop;
+            std::thread m_writer;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,166 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/*
+ * Read-only shared-memory snapshot of the SystemServices cache
+ * (getCachedValue/cacheContains). SystemServices publishes the whole cache
+ * while it is initialized, after every setCachedValue/removeCacheKey, and
+ * removes the segment when it is deinitialized. Only processes of the same
+ * user can map it (0600).
+ *
+ * The segment is protected by a sequence lock: the writer makes the sequence
+ * odd while it copies, even when done. A reader loads the sequence (acquire),
+ * copies what it needs, and loads it again; the copy holds only if both loads
+ * are the same even value. It must bound every access by `size` and
+ * SYSTEM_CACHE_SNAPSHOT_CAPACITY while doing so. A reader that gives up while
+ * the sequence keeps moving has learned nothing about the key: it reports
+ * busy or falls back to org.rdk.System.getCachedValue, never "not cached".
+ * The same fallback applies while `magic` is not SYSTEM_CACHE_SNAPSHOT_MAGIC.
+ *
+ * Payload layout: key '\0' value '\0' ... repeated, `size` bytes in total.
+ */
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <utility>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SYSTEM_CACHE_SNAPSHOT_NAME      "/rdkservices_system_cache"
+#define SYSTEM_CACHE_SNAPSHOT_MAGIC     0x53534331 /* "SSC1" */
+#define SYSTEM_CACHE_SNAPSHOT_CAPACITY  (64 * 1024)
+
+namespace Utils
+{
+    struct SystemCacheSnapshotHeader {
+        uint32_t magic;
+        std::atomic<uint32_t> sequence;
+        uint32_t size;
+        char data[SYSTEM_CACHE_SNAPSHOT_CAPACITY];
+    };
+
+    class SystemCacheSnapshotWriter {
+    public:
+        SystemCacheSnapshotWriter() : m_header(nullptr)
+        {
+        }
+
+        ~SystemCacheSnapshotWriter()
+        {
+            close();
+        }
+
+        SystemCacheSnapshotWriter(const SystemCacheSnapshotWriter&) = delete;
+        SystemCacheSnapshotWriter& operator=(const SystemCacheSnapshotWriter&) = delete;
+
+        /***
+         * @brief        : Create (or take over) and map the segment.
+         * @return       : <bool> False if the segment is unavailable.
+         */
+        bool open()
+        {
+            if (m_header)
+                return true;
+
+            int fd = shm_open(SYSTEM_CACHE_SNAPSHOT_NAME, O_CREAT | O_RDWR, 0600);
+            if (fd < 0)
+                return false;
+
+            /* A segment left by an earlier run keeps the mode it was created with. */
+            if (fchmod(fd, 0600) == 0 && ftruncate(fd, sizeof(SystemCacheSnapshotHeader)) == 0) {
+                void* addr = mmap(nullptr, sizeof(SystemCacheSnapshotHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (addr != MAP_FAILED)
+                    m_header = static_cast<SystemCacheSnapshotHeader*>(addr);
+            }
+            ::close(fd);
+            return m_header != nullptr;
+        }
+
+        /***
+         * @brief        : Withdraw the snapshot, unmap and remove the segment.
+         * @return       : nil.
+         */
+        void close()
+        {
+            if (!m_header)
+                return;
+
+            /* Readers that mapped it already see it withdrawn. */
+            uint32_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+            m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_header->magic = 0;
+            m_header->size = 0;
+            m_header->sequence.store(sequence + 2, std::memory_order_release);
+
+            munmap(m_header, sizeof(SystemCacheSnapshotHeader));
+            m_header = nullptr;
+            shm_unlink(SYSTEM_CACHE_SNAPSHOT_NAME);
+        }
+
+        /***
+         * @brief        : Replace the published snapshot.
+         * @param1[in]   : <vector> key/value pairs
+         * @return       : <bool> False if the segment is unavailable or the entries don't fit.
+         */
+        bool publish(const std::vector<std::pair<std::string, std::string>>& entries)
+        {
+            if (!m_header)
+                return false;
+
+            size_t size = 0;
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+                size += it->first.size() + 1 + it->second.size() + 1;
+
+            uint32_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+            m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            if (size > SYSTEM_CACHE_SNAPSHOT_CAPACITY) {
+                /* Withdraw the snapshot rather than leave a stale one behind. */
+                m_header->magic = 0;
+                m_header->size = 0;
+                m_header->sequence.store(sequence + 2, std::memory_order_release);
+                return false;
+            }
+
+            char* out = m_header->data;
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                memcpy(out, it->first.c_str(), it->first.size() + 1);
+                out += it->first.size() + 1;
+                memcpy(out, it->second.c_str(), it->second.size() + 1);
+                out += it->second.size() + 1;
+            }
+            m_header->size = size;
+            m_header->magic = SYSTEM_CACHE_SNAPSHOT_MAGIC;
+
+            m_header->sequence.store(sequence + 2, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        SystemCacheSnapshotHeader* m_header;
+    };
+}
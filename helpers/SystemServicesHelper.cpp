@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <sstream>
 #include <sys/stat.h>
 #include <algorithm>
 #include <curl/curl.h>
@@ -283,6 +284,31 @@ bool getFileContent(std::string fileName, std::vector<std::string> & vecOfStrs)
     return retStatus;
 }
 
+int getCurlProgressPercent(const std::string& progress)
+{
+    // curl redraws its progress line with '\r', the last line is the current one.
+    std::string text(progress);
+    std::replace(text.begin(), text.end(), '\r', '\n');
+
+    size_t end = text.find_last_not_of('\n');
+    if (std::string::npos == end)
+        return -1;
+
+    size_t begin = text.find_last_of('\n', end);
+    begin = (std::string::npos == begin) ? 0 : begin + 1;
+    std::string line = text.substr(begin, end - begin + 1);
+
+    // Only lines with sizes (k, M, G) or the header are progress lines.
+    if (std::string::npos == line.find_first_of("MG/"))
+        return -1;
+
+    std::istringstream fields(line);
+    std::string total, percent;
+    if (fields >> percent >> total >> percent)
+        return strtol(percent.c_str(), NULL, 10);
+    return -1;
+}
+
 /***
  * @brief	: Used to search for files in the given directory
  * @param1[in]	: Directory on which the search has to be performed
@@ -292,15 +318,19 @@ bool getFileContent(std::string fileName, std::vector<std::string> & vecOfStrs)
 std::vector<std::string> searchAndGetFilesList(std::string path, std::string filter)
 {
     int retStat = -1;
-    char buff[4096 + 1];
-    std::string command,totalStr;
+    std::string totalStr;
     std::vector<std::string> FileList;
 
-    memset(buff, 0, 4096);
-    command = "find "+path+" -iname "+filter+" > /tmp/tempBuffer.dat";
-    retStat = system(command.c_str());
+    retStat = Utils::runCommand({ "find", path, "-iname", filter }, &totalStr);
     fprintf(stdout, "searchAndGetFilesList : retStat = %d\n", retStat);
-    getFileContent("/tmp/tempBuffer.dat", FileList);
+
+    std::istringstream lines(totalStr);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.size() > 0) {
+            FileList.push_back(line);
+        }
+    }
 
     return FileList;
 }
@@ -79,7 +79,7 @@
 #define MODE_EAS        "EAS"
 #define MODE_WAREHOUSE  "WAREHOUSE"
 
-#define CAT_DWNLDPROGRESSFILE_AND_GET_INFO "cat /opt/curl_progress | tr -s '\r' '\n' | tail -n 1 | sed 's/^ *//g' | sed '/^[^M/G]*$/d' | tr -s ' ' | cut -d ' ' -f3"
+#define DWNLD_PROGRESS_FILE "/opt/curl_progress"
 
 enum eRetval { E_NOK = -1,
     E_OK };
@@ -150,6 +150,13 @@ bool dirExists(std::string fname);
  */
 bool readFromFile(const char* filename, string &content);
 
+/***
+ * @brief	: Percentage of the last progress line curl wrote (its third column)
+ * @param1[in]	: progress; contents of the curl progress file
+ * @return	: <int>; percentage, -1 if there is no progress line yet.
+ */
+int getCurlProgressPercent(const std::string& progress);
+
 namespace WPEFramework {
     namespace Plugin {
         /***
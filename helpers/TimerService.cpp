@@ -0,0 +1,163 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "TimerService.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Constructed by the first timer of the library, so it outlives static timers
+        TimerService& TimerService::instance()
+        {
+            static TimerService service;
+            return service;
+        }
+
+        TimerService::TimerService()
+            : m_nextId(1)
+            , m_running(0)
+            , m_stop(false)
+        {
+            m_thread = std::thread(&TimerService::run, this);
+        }
+
+        TimerService::~TimerService()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stop = true;
+            }
+            m_wakeup.notify_all();
+            m_thread.join();
+        }
+
+        uint32_t TimerService::add(const Callback& callback)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            uint32_t id = m_nextId++;
+            m_timers[id] = { callback, 0, 0, false };
+            return id;
+        }
+
+        void TimerService::remove(uint32_t id)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            m_timers.erase(id);
+            waitIdle(lock, id);
+        }
+
+        bool TimerService::schedule(uint32_t id, uint32_t delayMs, uint32_t periodMs)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+
+                auto timer = m_timers.find(id);
+                if (timer == m_timers.end())
+                    return false;
+
+                timer->second.periodMs = periodMs;
+                timer->second.generation++;
+                timer->second.armed = true;
+                m_queue.push({ Clock::now() + std::chrono::milliseconds(delayMs), id, timer->second.generation });
+            }
+            m_wakeup.notify_all();
+            return true;
+        }
+
+        void TimerService::cancel(uint32_t id, bool wait)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            auto timer = m_timers.find(id);
+            if (timer != m_timers.end())
+            {
+                timer->second.generation++;
+                timer->second.armed = false;
+            }
+            if (wait)
+                waitIdle(lock, id);
+        }
+
+        bool TimerService::isScheduled(uint32_t id) const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            auto timer = m_timers.find(id);
+            return (timer != m_timers.end()) && timer->second.armed;
+        }
+
+        void TimerService::waitIdle(std::unique_lock<std::mutex>& lock, uint32_t id)
+        {
+            if (std::this_thread::get_id() == m_thread.get_id())
+                return;
+
+            m_idle.wait(lock, [this, id]() { return m_running != id; });
+        }
+
+        void TimerService::run()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            while (!m_stop)
+            {
+                if (m_queue.empty())
+                {
+                    m_wakeup.wait(lock);
+                    continue;
+                }
+
+                Due due = m_queue.top();
+                auto timer = m_timers.find(due.id);
+                if (timer == m_timers.end() || timer->second.generation != due.generation)
+                {
+                    m_queue.pop();
+                    continue;
+                }
+
+                if (Clock::now() < due.time)
+                {
+                    // Also woken up by an earlier timer being scheduled
+                    m_wakeup.wait_until(lock, due.time);
+                    continue;
+                }
+
+                m_queue.pop();
+                if (timer->second.periodMs == 0)
+                    timer->second.armed = false;
+
+                Callback callback = timer->second.callback;
+                m_running = due.id;
+                lock.unlock();
+
+                callback();
+
+                lock.lock();
+                m_running = 0;
+                m_idle.notify_all();
+
+                // Periodic timers count from the end of the callback, unless the callback rescheduled it
+                timer = m_timers.find(due.id);
+                if (timer != m_timers.end() && timer->second.generation == due.generation && timer->second.armed)
+                    m_queue.push({ Clock::now() + std::chrono::milliseconds(timer->second.periodMs), due.id, due.generation });
+            }
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
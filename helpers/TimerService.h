@@ -0,0 +1,97 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // One thread that runs the timers of a plugin library (TpTimer, cTimer), ordered on a
+        // min-heap of steady_clock due times. A timer is added once and then armed and disarmed
+        // any number of times. Callbacks run one at a time on the service thread, so they should
+        // not block; they may arm, cancel or remove any timer, including their own.
+        class TimerService {
+        public:
+            typedef std::function<void()> Callback;
+
+            static TimerService& instance();
+
+            TimerService(const TimerService&) = delete;
+            TimerService& operator=(const TimerService&) = delete;
+
+            uint32_t add(const Callback& callback);
+            // Removes the timer and waits for a running callback of it to return, unless called from a callback
+            void remove(uint32_t id);
+
+            // (Re)arms the timer: the callback runs after delayMs, then every periodMs until cancelled (0: once)
+            bool schedule(uint32_t id, uint32_t delayMs, uint32_t periodMs);
+            // Disarms the timer. If wait is set, also waits for a running callback of the timer to return,
+            // unless called from a callback. Don't wait while holding a lock the callback takes.
+            void cancel(uint32_t id, bool wait);
+            bool isScheduled(uint32_t id) const;
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Timer {
+                Callback callback;
+                uint32_t periodMs;
+                uint64_t generation;    // bumped on every schedule and cancel, older heap entries are stale
+                bool armed;
+            };
+
+            struct Due {
+                Clock::time_point time;
+                uint32_t id;
+                uint64_t generation;
+
+                bool operator>(const Due& other) const
+                {
+                    return time > other.time;
+                }
+            };
+
+            TimerService();
+            ~TimerService();
+
+            void waitIdle(std::unique_lock<std::mutex>& lock, uint32_t id);
+            void run();
+
+            mutable std::mutex m_lock;
+            std::condition_variable m_wakeup;
+            std::condition_variable m_idle;
+            std::map<uint32_t, Timer> m_timers;
+            std::priority_queue<Due, std::vector<Due>, std::greater<Due>> m_queue;
+            uint32_t m_nextId;
+            uint32_t m_running;     // timer whose callback runs, 0 if none
+            bool m_stop;
+            std::thread m_thread;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
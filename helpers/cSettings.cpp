@@ -20,14 +20,29 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdio.h>
+#include <unistd.h>
 #include "cSettings.h"
 #include "SystemServicesHelper.h"
 
+/*
+ * The file is an append-only log of key=value records; the last record for a
+ * key wins and an empty value marks a removed key. It is compacted (rewritten
+ * to a temporary file and renamed over the original) once the log holds more
+ * than COMPACT_MIN_ENTRIES records and twice as many records as live keys.
+ * Every record ends with a newline and is synced before the write reports
+ * success; a last line without one is a write cut short and is dropped, and
+ * cut from the file, when it is read.
+ */
+#define COMPACT_MIN_ENTRIES 64
+
 /***
  * @brief    : Constructor.
  * @return  : nil.
  */
 cSettings::cSettings(std::string file)
+    : logEntries(0)
+    , liveEntries(0)
 {
     filename = file;
     if (!readFromFile()) {
@@ -65,13 +80,41 @@ bool cSettings::readFromFile()
     }
     fstream ifile(filename,ios::in);
     if (ifile) {
+        logEntries = 0;
+        off_t complete = 0;
+        bool torn = false;
         while (!ifile.eof()) {
             std::getline(ifile,content);
+            if (ifile.eof()) {
+                /* No newline after it: the last append did not finish. */
+                torn = !content.empty();
+                break;
+            }
+            complete += content.size() + 1;
             size_t pos = content.find_last_of("=");
             if (std::string::npos != pos) {
+                /* Later records override earlier ones; an empty value reads as removed. */
                 data[(content.substr(0, pos).c_str())] = content.substr(pos+1,std::string::npos);
+                logEntries++;
+            }
+        }
+        retStatus = true;
+        ifile.close();
+
+        if (torn) {
+            /* The next record would be appended to the broken one. */
+            std::cout << "Warning:[readFromFile] dropping incomplete last record of " << filename << std::endl;
+            if (0 != truncate(filename.c_str(), complete)) {
+                std::cout << "Error:[readFromFile] unable to truncate " << filename << std::endl;
+            }
+        }
+
+        liveEntries = 0;
+        JsonObject::Iterator iterator = data.Variants();
+        while (iterator.Next()) {
+            if (!data[iterator.Label()].String().empty()) {
+                liveEntries++;
             }
-            retStatus = true;
         }
     } else {
         //Do nothing.
@@ -80,27 +123,37 @@ bool cSettings::readFromFile()
 }
 
 /***
- * @brief    : Update new inserts into the json object onto file.
- * @return  : <bool> False if timer thread couldn't be started.
+ * @brief    : Rewrite the file from the json object (compaction), replacing it atomically.
+ * @return  : <bool> False if the file couldn't be written, else True.
  */
 bool cSettings::writeToFile()
 {
     bool status = false;
 
     if (Utils::fileExists(filename.c_str())) {
-        ofstream ofile;
-        ofile.open(filename.c_str(),ios::out);
+        std::string tmpname = filename + ".tmp";
+        FILE *ofile = fopen(tmpname.c_str(), "w");
         if (ofile) {
+            unsigned int entries = 0;
             JsonObject::Iterator iterator = data.Variants();
             while (iterator.Next()) {
                 if (!data[iterator.Label()].String().empty()) {
-                    ofile << iterator.Label() << "=" << data[iterator.Label()].String() << endl;
+                    fprintf(ofile, "%s=%s\n", iterator.Label(), data[iterator.Label()].String().c_str());
+                    entries++;
                 } else {
                     continue;
                 }
             }
-            status = true;
-            ofile.close();
+            status = (fflush(ofile) == 0) && (fsync(fileno(ofile)) == 0);
+            status = (fclose(ofile) == 0) && status;
+            if (status && (0 == rename(tmpname.c_str(), filename.c_str()))) {
+                logEntries = entries;
+                liveEntries = entries;
+            } else {
+                std::cout << "Error:[writeToFile] unable to replace " << filename << std::endl;
+                ::remove(tmpname.c_str());
+                status = false;
+            }
         } else {
             status = false;
         }
@@ -108,6 +161,45 @@ bool cSettings::writeToFile()
     return status;
 }
 
+/***
+ * @brief        : Append a single key=value record to the file, compacting it when the log grows too long.
+ * @param1[in]  : <string> key
+ * @param2[in] : <bool> True if the key was set before this change
+ * @return     : <bool> True if the record was written, else False
+ */
+bool cSettings::appendToFile(std::string key, bool wasLive)
+{
+    bool status = false;
+    bool live = contains(key);
+
+    if (live != wasLive) {
+        if (live) {
+            liveEntries++;
+        } else if (liveEntries > 0) {
+            liveEntries--;
+        }
+    }
+
+    if (Utils::fileExists(filename.c_str())) {
+        std::string value = live ? data[key.c_str()].String() : "";
+        FILE *ofile = fopen(filename.c_str(), "a");
+        if (ofile) {
+            status = (fprintf(ofile, "%s=%s\n", key.c_str(), value.c_str()) > 0);
+            status = (fflush(ofile) == 0) && (fsync(fileno(ofile)) == 0) && status;
+            status = (fclose(ofile) == 0) && status;
+            logEntries++;
+        }
+    }
+
+    if (status) {
+        if ((logEntries > COMPACT_MIN_ENTRIES) && (logEntries > 2 * liveEntries)) {
+            /* Compaction failure is not fatal; the log is still complete. */
+            writeToFile();
+        }
+    }
+    return status;
+}
+
 /***
  * @brief        : Get value of given key.
  * @param1[in]  : <string> key
@@ -126,8 +218,9 @@ JsonValue cSettings::getValue(std::string key)
  */
 bool cSettings::setValue(std::string key,std::string value)
 {
+    bool wasLive = contains(key);
     data[key.c_str()] = value;
-    return writeToFile();
+    return appendToFile(key, wasLive);
 }
 
 /***
@@ -138,8 +231,9 @@ bool cSettings::setValue(std::string key,std::string value)
  */
 bool cSettings::setValue(std::string key,int value)
 {
+    bool wasLive = contains(key);
     data[key.c_str()] = value;
-    return writeToFile();
+    return appendToFile(key, wasLive);
 }
 
 /***
@@ -150,8 +244,26 @@ bool cSettings::setValue(std::string key,int value)
  */
 bool cSettings::setValue(std::string key,bool value)
 {
+    bool wasLive = contains(key);
     data[key.c_str()] = value;
-    return writeToFile();
+    return appendToFile(key, wasLive);
+}
+
+/***
+ * @brief        : Get all key-value pairs that are set.
+ * @param1[out] : <vector> key/value pairs
+ * @return     : nil.
+ */
+void cSettings::getAll(std::vector<std::pair<std::string, std::string>>& entries)
+{
+    entries.clear();
+    JsonObject::Iterator iterator = data.Variants();
+    while (iterator.Next()) {
+        std::string value = data[iterator.Label()].String();
+        if (!value.empty()) {
+            entries.push_back(std::make_pair(std::string(iterator.Label()), value));
+        }
+    }
 }
 
 /***
@@ -187,10 +299,11 @@ bool cSettings::remove(std::string key)
      * work around is to assign a null value to the key and handle it
      * accordingly.
      */
+    bool wasLive = contains(key);
     data[key.c_str()] = "";
     data.Remove(key.c_str());
     if (!contains(key)) {
-        if (writeToFile()) {
+        if (appendToFile(key, wasLive)) {
             status = true;
         } else {
             status = false;
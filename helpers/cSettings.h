@@ -18,6 +18,8 @@
 **/
 
 #include <string>
+#include <vector>
+#include <utility>
 #include <stdlib.h>
 #include <plugins/plugins.h>
 
@@ -26,6 +28,16 @@ using namespace std;
 class cSettings {
     std::string filename;
     JsonObject data;
+    unsigned int logEntries;
+    unsigned int liveEntries;
+
+    /***
+     * @brief        : Append a single key=value record to the file, compacting it when the log grows too long.
+     * @param1[in]   : <string> key
+     * @param2[in]   : <bool> True if the key was set before this change
+     * @return       : <bool> True if the record was written, else False
+     */
+    bool appendToFile(std::string key, bool wasLive);
     public:
     /***
      * @brief    : Constructor.
@@ -70,6 +82,13 @@ class cSettings {
      */
     bool setValue(std::string key,bool value);
 
+    /***
+     * @brief        : Get all key-value pairs that are set.
+     * @param1[out]  : <vector> key/value pairs
+     * @return       : nil.
+     */
+    void getAll(std::vector<std::pair<std::string, std::string>>& entries);
+
     /***
      * @brief        : Check if a particular key is set.
      * @param1[in]   : <string> key
@@ -85,8 +104,8 @@ class cSettings {
     bool remove(std::string key);
 
     /***
-     * @brief    : Update new inserts into the json object onto file.
-     * @return   : <bool> False if timer thread couldn't be started.
+     * @brief    : Rewrite the file from the json object (compaction), replacing it atomically.
+     * @return   : <bool> False if the file couldn't be written, else True.
      */
     bool writeToFile();
 
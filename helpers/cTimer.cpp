@@ -18,6 +18,7 @@
 **/
 
 #include "cTimer.h"
+#include "TimerService.h"
 
 /***
  * @brief : Constructor.
@@ -25,48 +26,39 @@
  */
 cTimer::cTimer()
 {
-    clear = false;
     interval = 0;
+    callBack_function = NULL;
+    id = WPEFramework::Plugin::TimerService::instance().add([this]() { this->callBack_function(); });
 }
 
 /***
- * @brief : Destructor.
+ * @brief : Destructor, stops the timer.
  * @return   : nil.
  */
 cTimer::~cTimer()
 {
-    this->clear = true;
+    WPEFramework::Plugin::TimerService::instance().remove(id);
 }
 
 /***
- * @brief : start timer thread.
- * @return   : <bool> False if timer thread couldn't be started.
+ * @brief : start timer, restarts it if it runs.
+ * @return   : <bool> False if no function or interval is set.
  */
 bool cTimer::start()
 {
-    if (interval <= 0 && callBack_function == NULL) {
+    if (interval <= 0 || callBack_function == NULL) {
         return false;
     }
-    this->clear = false;
-    std::thread timerThread([=]() {
-            while (true) {
-            if (this->clear) return;
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-            if (this->clear) return;
-            this->callBack_function();
-            }
-            });
-    timerThread.detach();
-    return true;
+    return WPEFramework::Plugin::TimerService::instance().schedule(id, interval, interval);
 }
 
 /***
- * @brief : stop timer thread.
+ * @brief : stop timer; waits for a running callback to return unless called from it.
  * @return   : nil
  */
 void cTimer::stop()
 {
-    this->clear = true;
+    WPEFramework::Plugin::TimerService::instance().cancel(id, true);
 }
 
 /***
@@ -19,12 +19,14 @@
 
 #include <thread>
 #include <chrono>
+#include <stdint.h>
 
 using namespace std;
 
+/* Handle on a periodic timer of the TimerService, the callback runs on the service thread */
 class cTimer{
     private:
-        bool clear;
+        uint32_t id;
         int interval;
         void (*callBack_function)();
     public:
@@ -35,19 +37,19 @@ class cTimer{
         cTimer();
 
         /***
-         * @brief    : Destructor.
+         * @brief    : Destructor, stops the timer.
          * @return   : nil.
          */
         ~cTimer();
 
         /***
-         * @brief    : start timer thread.
-         * @return   : <bool> False if timer thread couldn't be started.
+         * @brief    : start timer, restarts it if it runs.
+         * @return   : <bool> False if no function or interval is set.
          */
         bool start();
 
         /***
-         * @brief   : stop timer thread.
+         * @brief   : stop timer; waits for a running callback to return unless called from it.
          * @return   : nil
          */
         void stop();
@@ -0,0 +1,202 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "CecCore.h"
+
+#include <stdio.h>
+
+#include "ccec/Exception.hpp"
+#include "ccec/LibCCEC.hpp"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        CecCore& CecCore::getInstance()
+        {
+            static CecCore instance;
+            return instance;
+        }
+
+        CecCore::CecCore()
+            : m_users(0)
+            , m_connection(NULL)
+            , m_pingsSent(0)
+            , m_pingsAnswered(0)
+        {
+        }
+
+        CecCore::~CecCore()
+        {
+        }
+
+        Connection* CecCore::acquire(FrameListener* listener)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_users == 0)
+            {
+                try
+                {
+                    LibCCEC::getInstance().init();
+                }
+                catch (const std::exception& e)
+                {
+                    fprintf(stderr, "CecCore: exception from LibCCEC::init: %s\n", e.what());
+                }
+
+                m_connection = new Connection(LogicalAddress::UNREGISTERED, false, "ServiceManager::Connection::");
+                m_connection->open();
+                m_connection->addFrameListener(this);
+
+                std::lock_guard<std::mutex> tableLock(m_tableLock);
+                for (auto& device : m_devices)
+                    device = Device();
+            }
+            m_users++;
+
+            if (listener != NULL)
+                m_connection->addFrameListener(listener);
+
+            return m_connection;
+        }
+
+        void CecCore::release(FrameListener* listener)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_users == 0)
+                return;
+
+            if (listener != NULL)
+                m_connection->removeFrameListener(listener);
+
+            if (--m_users == 0)
+            {
+                {
+                    std::lock_guard<std::mutex> txLock(m_txLock);
+                    m_connection->removeFrameListener(this);
+                    m_connection->close();
+                    delete m_connection;
+                    m_connection = NULL;
+                }
+
+                try
+                {
+                    LibCCEC::getInstance().term();
+                }
+                catch (const std::exception& e)
+                {
+                    fprintf(stderr, "CecCore: exception from LibCCEC::term: %s\n", e.what());
+                }
+            }
+        }
+
+        void CecCore::ping(const LogicalAddress& from, const LogicalAddress& to, uint32_t maxAgeMs)
+        {
+            int address = to.toInt();
+
+            if (maxAgeMs > 0 && address >= 0 && address < LogicalAddress::UNREGISTERED)
+            {
+                std::lock_guard<std::mutex> tableLock(m_tableLock);
+                const Device& device = m_devices[address];
+                Clock::time_point since = Clock::now() - std::chrono::milliseconds(maxAgeMs);
+
+                if (device.known)
+                {
+                    if (device.present && device.heard > since)
+                    {
+                        m_pingsAnswered++;
+                        return;
+                    }
+                    if (!device.present && device.missed > since)
+                    {
+                        m_pingsAnswered++;
+                        throw CECNoAckException();
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> txLock(m_txLock);
+            if (m_connection == NULL)
+                throw IOException();
+
+            m_pingsSent++;
+            try
+            {
+                m_connection->ping(from, to, Throw_e());
+            }
+            catch (CECNoAckException& e)
+            {
+                if (address >= 0 && address < LogicalAddress::UNREGISTERED)
+                {
+                    std::lock_guard<std::mutex> tableLock(m_tableLock);
+                    Device& device = m_devices[address];
+                    device.missed = Clock::now();
+                    device.present = false;
+                    device.known = true;
+                }
+                throw;
+            }
+            heard(address);
+        }
+
+        void CecCore::sendTo(const LogicalAddress& to, const CECFrame& frame, int timeout)
+        {
+            std::lock_guard<std::mutex> txLock(m_txLock);
+            if (m_connection != NULL)
+                m_connection->sendTo(to, frame, timeout);
+        }
+
+        void CecCore::sendAsync(const CECFrame& frame)
+        {
+            std::lock_guard<std::mutex> txLock(m_txLock);
+            if (m_connection != NULL)
+                m_connection->sendAsync(frame);
+        }
+
+        bool CecCore::isPresent(int logicalAddress, uint32_t maxAgeMs)
+        {
+            if (logicalAddress < 0 || logicalAddress >= LogicalAddress::UNREGISTERED)
+                return false;
+
+            std::lock_guard<std::mutex> tableLock(m_tableLock);
+            const Device& device = m_devices[logicalAddress];
+            return device.known && device.present &&
+                device.heard > Clock::now() - std::chrono::milliseconds(maxAgeMs);
+        }
+
+        void CecCore::notify(const CECFrame& in) const
+        {
+            if (in.length() > 0)
+                heard(in.at(0) >> 4);   // initiator of the header block
+        }
+
+        void CecCore::heard(int logicalAddress) const
+        {
+            if (logicalAddress < 0 || logicalAddress >= LogicalAddress::UNREGISTERED)
+                return;
+
+            std::lock_guard<std::mutex> tableLock(m_tableLock);
+            Device& device = m_devices[logicalAddress];
+            device.heard = Clock::now();
+            device.present = true;
+            device.known = true;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,95 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "ccec/FrameListener.hpp"
+#include "ccec/Connection.hpp"
+#include "ccec/CECFrame.hpp"
+
+/* A ping is answered from the device table when the address was heard from this recently */
+#define CEC_CORE_PING_MAX_AGE_MS 5000
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // The CEC engine shared by the CEC plugins (HdmiCec, HdmiCec_2, LgiHdmiCec, HdmiCecSink)
+        // of a process: one LibCCEC initialisation and one connection, whose frames go to the
+        // listeners of all front-ends. A device table records when each logical address was
+        // last heard from, so a front-end's ping does not go on the bus again when another one
+        // (or the device itself) proved the address recently. Transmissions go out one at a time.
+        class CecCore : public FrameListener {
+        public:
+            static CecCore& getInstance();
+
+            // The first acquire initialises LibCCEC and opens the connection, the last release
+            // closes it. The listener may be NULL and be added to the connection later.
+            Connection* acquire(FrameListener* listener);
+            void release(FrameListener* listener);
+
+            // As Connection::ping(from, to, Throw_e()), throws CECNoAckException when nobody
+            // answers. Without bus traffic when the table knows the answer from the last maxAgeMs.
+            void ping(const LogicalAddress& from, const LogicalAddress& to, uint32_t maxAgeMs = CEC_CORE_PING_MAX_AGE_MS);
+
+            void sendTo(const LogicalAddress& to, const CECFrame& frame, int timeout);
+            void sendAsync(const CECFrame& frame);
+
+            bool isPresent(int logicalAddress, uint32_t maxAgeMs);
+
+            uint32_t pingsSent() const { return m_pingsSent; }
+            uint32_t pingsAnswered() const { return m_pingsAnswered; }
+
+            // FrameListener
+            void notify(const CECFrame& in) const;
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Device {
+                Clock::time_point heard;    // frame received or ping acknowledged
+                Clock::time_point missed;   // ping not acknowledged
+                bool present = false;
+                bool known = false;
+            };
+
+            CecCore();
+            ~CecCore();
+            CecCore(const CecCore&) = delete;
+            CecCore& operator=(const CecCore&) = delete;
+
+            void heard(int logicalAddress) const;
+
+            std::mutex m_lock;              // users and connection
+            int m_users;
+            Connection* m_connection;
+
+            mutable std::mutex m_tableLock;
+            mutable Device m_devices[LogicalAddress::UNREGISTERED + 1];
+
+            std::mutex m_txLock;            // one transmission at a time
+            std::atomic<uint32_t> m_pingsSent;
+            std::atomic<uint32_t> m_pingsAnswered;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
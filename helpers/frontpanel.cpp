@@ -72,9 +72,6 @@ namespace WPEFramework
 #endif
         static bool powerStatus = false;     //Check how this works on xi3 and rng's
         static bool started = false;
-        static int m_numberOfBlinks = 0;
-        static int m_maxNumberOfBlinkRepeats = 0;
-        static int m_currentBlinkListIndex = 0;
         static std::vector<std::string> m_lights;
         static device::List <device::FrontPanelIndicator> fpIndicators;
 
@@ -115,7 +112,7 @@ namespace WPEFramework
 
         CFrontPanel::CFrontPanel()
         : m_blinkTimer(this)
-        , m_isBlinking(false)
+        , m_animationTime(0)
         , mFrontPanelHelper(new FrontPanelHelper())
         {
         }
@@ -207,9 +204,6 @@ namespace WPEFramework
             }
             if (!started)
             {
-                m_numberOfBlinks = 0;
-                m_maxNumberOfBlinkRepeats = 0;
-                m_currentBlinkListIndex = 0;
                 started = true;
             }
             return true;
@@ -539,14 +533,8 @@ namespace WPEFramework
             return success;
         }
 
-        void CFrontPanel::setBlink(const JsonObject& blinkInfo)
+        bool CFrontPanel::parseFrames(const std::string& ledIndicator, const JsonArray& patternList, std::vector<FrontPanelBlinkInfo>& frames)
         {
-            stopBlinkTimer();
-            m_blinkList.clear();
-            string ledIndicator = svc2iarm(blinkInfo["ledIndicator"].String());
-            int iterations;
-            getNumberParameterObject(blinkInfo, "iterations", iterations);
-            JsonArray patternList = blinkInfo["pattern"].Array();
             for (int i = 0; i < patternList.Length(); i++)
             {
                 JsonObject frontPanelBlinkHash = patternList[i].Object();
@@ -558,7 +546,7 @@ namespace WPEFramework
 
                 int duration;
                 getNumberParameterObject(frontPanelBlinkHash, "duration", duration);
-                LOGWARN("setBlink ledIndicator: %s iterations: %d brightness: %d duration: %d", ledIndicator.c_str(), iterations, brightness, duration);
+                LOGWARN("frame ledIndicator: %s brightness: %d duration: %d", ledIndicator.c_str(), brightness, duration);
                 frontPanelBlinkInfo.brightness = brightness;
                 frontPanelBlinkInfo.durationInMs = duration;
                 frontPanelBlinkInfo.colorValue = 0;
@@ -583,9 +571,100 @@ namespace WPEFramework
                 {
                     frontPanelBlinkInfo.colorMode = 0;
                 }
-                m_blinkList.push_back(frontPanelBlinkInfo);
+                frames.push_back(frontPanelBlinkInfo);
+            }
+            return !frames.empty();
+        }
+
+        // setBlink runs in the lowest layer of the LED, so it stays behind animations of a higher priority
+        void CFrontPanel::setBlink(const JsonObject& blinkInfo)
+        {
+            string ledIndicator = svc2iarm(blinkInfo["ledIndicator"].String());
+            int iterations;
+            getNumberParameterObject(blinkInfo, "iterations", iterations);
+            LOGWARN("setBlink ledIndicator: %s iterations: %d", ledIndicator.c_str(), iterations);
+
+            std::vector<FrontPanelBlinkInfo> frames;
+            if (parseFrames(ledIndicator, blinkInfo["pattern"].Array(), frames))
+                startAnimation(ledIndicator, 0, frames, iterations);
+            else
+                stopAnimation(blinkInfo);
+        }
+
+        bool CFrontPanel::animate(const JsonObject& parameters)
+        {
+            if (!parameters.HasLabel("ledIndicator") || !parameters.HasLabel("keyframes"))
+                return false;
+
+            string ledIndicator = svc2iarm(parameters["ledIndicator"].String());
+            int priority = 0;
+            int iterations = 0;
+            if (parameters.HasLabel("priority"))
+                getNumberParameterObject(parameters, "priority", priority);
+            if (parameters.HasLabel("iterations"))
+                getNumberParameterObject(parameters, "iterations", iterations);
+            LOGWARN("animate ledIndicator: %s priority: %d iterations: %d", ledIndicator.c_str(), priority, iterations);
+
+            std::vector<FrontPanelBlinkInfo> frames;
+            if (!parseFrames(ledIndicator, parameters["keyframes"].Array(), frames))
+                return false;
+
+            startAnimation(ledIndicator, priority, frames, iterations);
+            return true;
+        }
+
+        // Without a priority all layers of the LED are stopped. The LED keeps its last state
+        // unless a lower layer takes over.
+        void CFrontPanel::stopAnimation(const JsonObject& parameters)
+        {
+            string ledIndicator = svc2iarm(parameters["ledIndicator"].String());
+            {
+                std::lock_guard<std::mutex> lock(m_animationMutex);
+                auto led = m_animations.find(ledIndicator);
+                if (led == m_animations.end())
+                    return;
+
+                if (parameters.HasLabel("priority"))
+                {
+                    int priority = 0;
+                    getNumberParameterObject(parameters, "priority", priority);
+                    led->second.erase(priority);
+                }
+                else
+                {
+                    led->second.clear();
+                }
+
+                if (led->second.empty())
+                {
+                    m_animations.erase(led);
+                    return;
+                }
+                led->second.rbegin()->second.frameEnd = 0;
             }
-            startBlinkTimer(iterations);
+            scheduleAnimation(Core::Time::Now().Ticks());
+        }
+
+        void CFrontPanel::startAnimation(const std::string& ledIndicator, int priority, const std::vector<FrontPanelBlinkInfo>& frames, int iterations)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_animationMutex);
+                std::map<int, FrontPanelAnimation>& layers = m_animations[ledIndicator];
+                FrontPanelAnimation& animation = layers[priority];
+                animation.frames = frames;
+                animation.iterations = iterations;
+                animation.loop = 0;
+                animation.frame = 0;
+                animation.frameEnd = 0;
+                // A paused layer shows its current frame again once it resumes
+                for (auto& layer : layers)
+                {
+                    if (layer.first != layers.rbegin()->first)
+                        layer.second.frameEnd = 0;
+                }
+            }
+            // The first frame is sent from the timer thread, too
+            scheduleAnimation(Core::Time::Now().Ticks());
         }
 
         JsonObject CFrontPanel::getPreferences()
@@ -623,33 +702,35 @@ namespace WPEFramework
             file.Close();
         }
 
-        void CFrontPanel::startBlinkTimer(int numberOfBlinkRepeats)
+        // Keeps a single chain of timer entries: an entry for another time than m_animationTime is stale and does nothing
+        void CFrontPanel::scheduleAnimation(uint64_t time)
         {
-            LOGWARN("startBlinkTimer numberOfBlinkRepeats: %d m_blinkList.length : %d", numberOfBlinkRepeats, m_blinkList.size());
-            stopBlinkTimer();
-            m_numberOfBlinks = 0;
-            m_isBlinking = true;
-            m_maxNumberOfBlinkRepeats = numberOfBlinkRepeats;
-            m_currentBlinkListIndex = 0;
-            if (m_blinkList.size() > 0)
             {
-                FrontPanelBlinkInfo blinkInfo = m_blinkList.at(0);
-                setBlinkLed(blinkInfo);
-                if (m_isBlinking)
-                    blinkTimer.Schedule(Core::Time::Now().Add(blinkInfo.durationInMs), m_blinkTimer);
+                std::lock_guard<std::mutex> lock(m_animationMutex);
+                if ((m_animationTime != 0) && (m_animationTime <= time))
+                    return;
+                m_animationTime = time;
             }
+            blinkTimer.Schedule(Core::Time(time), m_blinkTimer);
         }
 
+        // Stops all animations, called before the LEDs are changed directly
         void CFrontPanel::stopBlinkTimer()
         {
-            m_isBlinking = false;
+            {
+                std::lock_guard<std::mutex> lock(m_animationMutex);
+                m_animations.clear();
+                m_ledStates.clear();
+                m_animationTime = 0;
+            }
             blinkTimer.Revoke(m_blinkTimer);
         }
 
-        void CFrontPanel::setBlinkLed(FrontPanelBlinkInfo blinkInfo)
+        // blinkInfo only holds what changed, colorMode 0 and brightness -1 leave color and brightness as they are
+        void CFrontPanel::setBlinkLed(const FrontPanelBlinkInfo& blinkInfo)
         {
             std::string ledIndicator = blinkInfo.ledIndicator;
-            int brightness = blinkInfo.brightness;
+            bool success = true;
             try
             {
                 if (blinkInfo.colorMode == 1)
@@ -663,43 +744,114 @@ namespace WPEFramework
 
             }
             catch (...)
-            {}
+            {
+                success = false;
+            }
             try
             {
-                if (brightness == -1)
-                    brightness = device::FrontPanelIndicator::getInstance(ledIndicator.c_str()).getBrightness();
-
-                device::FrontPanelIndicator::getInstance(ledIndicator.c_str()).setBrightness(brightness, false);
+                if (blinkInfo.brightness != -1)
+                    device::FrontPanelIndicator::getInstance(ledIndicator.c_str()).setBrightness(blinkInfo.brightness, false);
             }
             catch (...)
             {
                 LOGWARN("Exception caught in setBlinkLed for setBrightness ");
+                success = false;
+            }
+
+            if (!success)
+            {
+                // Unknown state, send the next frame in full
+                std::lock_guard<std::mutex> lock(m_animationMutex);
+                m_ledStates.erase(ledIndicator);
             }
         }
 
-        void CFrontPanel::onBlinkTimer()
+        uint64_t CFrontPanel::onBlinkTimer(const uint64_t scheduledTime)
         {
-            m_currentBlinkListIndex++;
-            bool blinkAgain = true;
-            if ((size_t)m_currentBlinkListIndex >= m_blinkList.size())
+            std::vector<FrontPanelBlinkInfo> changes;
+            uint64_t next = 0;
             {
-                blinkAgain = false;
-                m_currentBlinkListIndex = 0;
-                m_numberOfBlinks++;
-                if (m_maxNumberOfBlinkRepeats < 0 || m_numberOfBlinks <= m_maxNumberOfBlinkRepeats)
+                std::lock_guard<std::mutex> lock(m_animationMutex);
+                if (scheduledTime != m_animationTime)
+                    return 0;
+
+                const uint64_t now = Core::Time::Now().Ticks();
+                auto led = m_animations.begin();
+                while (led != m_animations.end())
                 {
-                    blinkAgain = true;
+                    std::map<int, FrontPanelAnimation>& layers = led->second;
+                    while (!layers.empty())
+                    {
+                        FrontPanelAnimation& animation = layers.rbegin()->second;
+                        if ((animation.frameEnd != 0) && (animation.frameEnd > now))
+                            break;
+
+                        if (animation.frameEnd != 0)
+                        {
+                            animation.frame++;
+                            if (animation.frame >= animation.frames.size())
+                            {
+                                animation.frame = 0;
+                                animation.loop++;
+                                if ((animation.iterations >= 0) && (animation.loop > animation.iterations))
+                                {
+                                    // The LED stays on the last frame, as stated in the spec, unless a lower layer resumes
+                                    layers.erase(std::prev(layers.end()));
+                                    continue;
+                                }
+                            }
+                        }
+
+                        const FrontPanelBlinkInfo& frame = animation.frames[animation.frame];
+                        animation.frameEnd = now + (uint64_t)std::max(frame.durationInMs, 1) * Core::Time::TicksPerMillisecond;
+
+                        // Only send what differs from the last state of the LED
+                        FrontPanelBlinkInfo change = frame;
+                        auto state = m_ledStates.find(led->first);
+                        if (state != m_ledStates.end())
+                        {
+                            FrontPanelBlinkInfo& last = state->second;
+                            if ((change.colorMode == last.colorMode) &&
+                                (((change.colorMode == 1) && (change.colorValue == last.colorValue)) ||
+                                 ((change.colorMode == 2) && (change.colorName == last.colorName))))
+                                change.colorMode = 0;
+                            if (change.brightness == last.brightness)
+                                change.brightness = -1;
+                            if (frame.colorMode != 0)
+                            {
+                                last.colorMode = frame.colorMode;
+                                last.colorValue = frame.colorValue;
+                                last.colorName = frame.colorName;
+                            }
+                            if (frame.brightness != -1)
+                                last.brightness = frame.brightness;
+                        }
+                        else
+                        {
+                            m_ledStates[led->first] = frame;
+                        }
+                        if ((change.colorMode != 0) || (change.brightness != -1))
+                            changes.push_back(change);
+                        break;
+                    }
+
+                    if (layers.empty())
+                    {
+                        led = m_animations.erase(led);
+                        continue;
+                    }
+                    uint64_t frameEnd = layers.rbegin()->second.frameEnd;
+                    if ((next == 0) || (frameEnd < next))
+                        next = frameEnd;
+                    ++led;
                 }
+                m_animationTime = next;
             }
-            if (blinkAgain)
-            {
-                FrontPanelBlinkInfo blinkInfo = m_blinkList.at(m_currentBlinkListIndex);
-                setBlinkLed(blinkInfo);
-                if (m_isBlinking)
-                    blinkTimer.Schedule(Core::Time::Now().Add(blinkInfo.durationInMs), m_blinkTimer);
-            }
 
-            //if not blink again then the led color should stay on the LAST element in the array as stated in the spec
+            for (const FrontPanelBlinkInfo& change : changes)
+                setBlinkLed(change);
+
+            return next;
         }
 
         void CFrontPanel::set24HourClock(bool is24Hour)
@@ -756,9 +908,7 @@ namespace WPEFramework
         uint64_t BlinkInfo::Timed(const uint64_t scheduledTime)
         {
 
-            uint64_t result = 0;
-            m_frontPanel->onBlinkTimer();
-            return(result);
+            return m_frontPanel->onBlinkTimer(scheduledTime);
         }
 
     }
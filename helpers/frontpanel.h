@@ -30,6 +30,8 @@
 
 #include <string>
 #include <list>
+#include <map>
+#include <mutex>
 #include <vector>
 
 #include <plugins/plugins.h>
@@ -84,6 +86,17 @@ namespace WPEFramework
             int colorMode;
         } FrontPanelBlinkInfo;
 
+        // One priority layer of an LED. Only the highest layer of an LED runs, the layers
+        // below it are paused and resume from their current frame once it ends.
+        typedef struct _FrontPanelAnimation
+        {
+            std::vector<FrontPanelBlinkInfo> frames;
+            int iterations; // as in setBlink, -1 loops until stopped
+            int loop;
+            size_t frame;
+            uint64_t frameEnd; // ticks, 0 until the current frame is shown
+        } FrontPanelAnimation;
+
         typedef enum _frontPanelIndicator
         {
             FRONT_PANEL_INDICATOR_CLOCK,
@@ -119,6 +132,8 @@ namespace WPEFramework
             void setPreferences(const JsonObject& preferences);
             bool setLED(const JsonObject& blinkInfo);
             void setBlink(const JsonObject& blinkInfo);
+            bool animate(const JsonObject& animation);
+            void stopAnimation(const JsonObject& animation);
             void loadPreferences();
             void stopBlinkTimer();
             bool remoteLedOn();
@@ -126,20 +141,28 @@ namespace WPEFramework
             void set24HourClock(bool is24Hour);
             bool is24HourClock();
 
-            void onBlinkTimer();
+            uint64_t onBlinkTimer(const uint64_t scheduledTime);
 
         private:
             CFrontPanel();
             static CFrontPanel* s_instance;
-            void startBlinkTimer(int numberOfBlinkRepeats);
-            void setBlinkLed(FrontPanelBlinkInfo blinkInfo);
+            bool parseFrames(const std::string& ledIndicator, const JsonArray& patternList, std::vector<FrontPanelBlinkInfo>& frames);
+            void startAnimation(const std::string& ledIndicator, int priority, const std::vector<FrontPanelBlinkInfo>& frames, int iterations);
+            void scheduleAnimation(uint64_t time);
+            void setBlinkLed(const FrontPanelBlinkInfo& blinkInfo);
             JsonObject m_preferencesHash;  // is this needed
 
             BlinkInfo m_blinkTimer;
-            bool m_isBlinking;
-            std::vector<FrontPanelBlinkInfo> m_blinkList;
             std::list<FrontPanel*> observers_;
 
+            // Animation layers per LED indicator and priority, the last state sent to each
+            // LED, and the time the blink timer is scheduled for (0 if idle). Only the timer
+            // thread talks to the HAL for animations.
+            std::mutex m_animationMutex;
+            std::map<std::string, std::map<int, FrontPanelAnimation>> m_animations;
+            std::map<std::string, FrontPanelBlinkInfo> m_ledStates;
+            uint64_t m_animationTime;
+
             std::string lastError_;
             FrontPanelHelper* mFrontPanelHelper;
         };
@@ -53,14 +53,197 @@ namespace WPEFramework {
 
         void CThermalMonitor::addEventObserver(WPEFramework::Plugin::SystemServices* service)
         {
+            float high = 0, critical = 0;
+            bool valid = getCoreTempThresholds(high, critical);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_observer = service;
+            m_high = high;
+            m_critical = critical;
+            m_thresholdsValid = valid;
+            m_highArmed = m_criticalArmed = true;
+            if (!m_running) {
+                m_running = true;
+                m_thread = std::thread(&CThermalMonitor::sampler, this);
+            }
+            LOGWARN("%s: Added event observer for temperature threshold change.", __FUNCTION__);
         }
 
         void CThermalMonitor::removeEventObserver(WPEFramework::Plugin::SystemServices* service)
         {
             LOGWARN("%s: Removing event observer for temperature threshold change.", __FUNCTION__);
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_observer != service)
+                    return;
+                m_running = false;
+            }
+            m_cv.notify_all();
+            if (m_thread.joinable())
+                m_thread.join();
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_observer = nullptr;
+            m_history.clear();
+        }
+
+        bool CThermalMonitor::getCoreTemperature(float& temperature)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_history.empty() && Clock::now() - m_history.back().time < std::chrono::milliseconds(THERMAL_SAMPLE_INTERVAL_FAST_MS)) {
+                    temperature = m_history.back().temperature;
+                    return true;
+                }
+            }
+
+            bool result = readCoreTemperature(temperature);
+            if (result)
+                addSample(temperature);
+            return result;
+        }
+
+        bool CThermalMonitor::getTemperatureRate(float& rate)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return this->rate(rate);
+        }
+
+        void CThermalMonitor::onTemperatureReported(float temperature)
+        {
+            addSample(temperature);
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_wake = true;
+            }
+            m_cv.notify_all();
+        }
+
+        void CThermalMonitor::addSample(float temperature)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            Clock::time_point now = Clock::now();
+            m_history.push_back({now, temperature});
+            while (m_history.size() > THERMAL_HISTORY_MAX_SAMPLES
+                    || (m_history.size() > 2 && now - m_history.front().time > std::chrono::milliseconds(THERMAL_HISTORY_SPAN_MS)))
+                m_history.pop_front();
+        }
+
+        /* Least squares slope of the history, with the lock held */
+        bool CThermalMonitor::rate(float& rate) const
+        {
+            rate = 0;
+            if (m_history.size() < 3)
+                return false;
+
+            const Clock::time_point origin = m_history.front().time;
+            double n = m_history.size(), sumT = 0, sumX = 0, sumTT = 0, sumTX = 0;
+            for (const Sample& sample : m_history) {
+                double t = std::chrono::duration<double>(sample.time - origin).count();
+                sumT += t;
+                sumX += sample.temperature;
+                sumTT += t * t;
+                sumTX += t * sample.temperature;
+            }
+            double spread = n * sumTT - sumT * sumT;
+            if (std::chrono::duration_cast<std::chrono::milliseconds>(m_history.back().time - origin).count() < THERMAL_SAMPLE_INTERVAL_FAST_MS
+                    || spread <= 0)
+                return false;
+
+            rate = (n * sumTX - sumT * sumX) / spread;
+            return true;
+        }
+
+        /* With the lock held */
+        int CThermalMonitor::nextInterval(float temperature, float rate, bool rateValid) const
+        {
+            if (!m_thresholdsValid)
+                return THERMAL_SAMPLE_INTERVAL_SLOW_MS;
+
+            float threshold = temperature < m_high ? m_high : m_critical;
+            float margin = threshold - temperature;
+            if (margin <= THERMAL_NEAR_MARGIN)
+                return THERMAL_SAMPLE_INTERVAL_FAST_MS;
+
+            int interval = THERMAL_SAMPLE_INTERVAL_SLOW_MS;
+            if (margin < THERMAL_FAR_MARGIN)
+                interval = THERMAL_SAMPLE_INTERVAL_FAST_MS + (THERMAL_SAMPLE_INTERVAL_SLOW_MS - THERMAL_SAMPLE_INTERVAL_FAST_MS)
+                    * (margin - THERMAL_NEAR_MARGIN) / (THERMAL_FAR_MARGIN - THERMAL_NEAR_MARGIN);
+
+            /* At least four samples before the threshold is reached at the current rate */
+            if (rateValid && rate > 0) {
+                double eta = (margin - THERMAL_NEAR_MARGIN) / rate * 1000 / 4;
+                if (eta < interval)
+                    interval = eta;
+            }
+            return interval < THERMAL_SAMPLE_INTERVAL_FAST_MS ? THERMAL_SAMPLE_INTERVAL_FAST_MS : interval;
+        }
+
+        /* With the lock held, sends the approaching notifications with it released */
+        void CThermalMonitor::checkApproaching(float temperature, float rate, bool rateValid)
+        {
+            if (!m_thresholdsValid)
+                return;
+
+            struct Level {
+                const char* type;
+                float threshold;
+                bool& armed;
+            } levels[] = { { "WARN", m_high, m_highArmed }, { "MAX", m_critical, m_criticalArmed } };
+
+            for (Level& level : levels) {
+                if (temperature >= level.threshold)
+                    continue;
+
+                float margin = level.threshold - temperature;
+                float eta = (rateValid && rate > 0) ? margin / rate : -1;
+                if (eta < 0 || eta > 2 * THERMAL_PREDICTION_HORIZON_S) {
+                    level.armed = true;
+                } else if (level.armed && eta <= THERMAL_PREDICTION_HORIZON_S && m_observer) {
+                    level.armed = false;
+                    std::string type = level.type;
+                    float threshold = level.threshold;
+                    SystemServices* observer = m_observer;
+
+                    m_lock.unlock();
+                    observer->onTemperatureApproachingThreshold(type, temperature, threshold, rate, static_cast<int>(eta));
+                    m_lock.lock();
+                }
+            }
+        }
+
+        void CThermalMonitor::sampler()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (m_running) {
+                bool fresh = !m_history.empty()
+                    && Clock::now() - m_history.back().time < std::chrono::milliseconds(THERMAL_SAMPLE_INTERVAL_FAST_MS);
+                if (!fresh) {
+                    lock.unlock();
+                    float temperature = 0;
+                    bool valid = readCoreTemperature(temperature);
+                    if (valid)
+                        addSample(temperature);
+                    lock.lock();
+                    if (!m_running)
+                        break;
+                }
+
+                if (!m_history.empty()) {
+                    float temperature = m_history.back().temperature;
+                    float slope = 0;
+                    bool rateValid = rate(slope);
+                    checkApproaching(temperature, slope, rateValid);
+                    m_interval = nextInterval(temperature, slope, rateValid);
+                    LOGINFO("temperature %.1f rate %.4f/s, next sample in %d ms", temperature, slope, m_interval);
+                }
+
+                m_cv.wait_for(lock, std::chrono::milliseconds(m_interval), [this] { return !m_running || m_wake; });
+                m_wake = false;
+            }
         }
 
-        bool CThermalMonitor::getCoreTemperature(float& temperature) const
+        bool CThermalMonitor::readCoreTemperature(float& temperature) const
         {
             temperature = 0;
             bool result = false;
@@ -103,7 +286,7 @@ namespace WPEFramework {
             return result;
         }
 
-        bool CThermalMonitor::setCoreTempThresholds(float high, float critical) const
+        bool CThermalMonitor::setCoreTempThresholds(float high, float critical)
         {
             bool result = false;
             IARM_Bus_PWRMgr_SetTempThresholds_Param_t param;
@@ -118,6 +301,17 @@ namespace WPEFramework {
             if (res == IARM_RESULT_SUCCESS) {
                 LOGWARN("Set new temperature thresholds: high: %f, critical: %f", high, critical);
                 result = true;
+
+                /* The sampler picks its interval for the new margins */
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_high = high;
+                    m_critical = critical;
+                    m_thresholdsValid = true;
+                    m_highArmed = m_criticalArmed = true;
+                    m_wake = true;
+                }
+                m_cv.notify_all();
             } else {
                 LOGWARN("[%s] IARM Call failed.", __FUNCTION__);
             }
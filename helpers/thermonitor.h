@@ -32,8 +32,27 @@
 #define ENABLE_THERMAL_PROTECTION
 #endif
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "SystemServices.h"
 
+/* The sampler runs at the slow interval while the temperature is more than THERMAL_FAR_MARGIN
+ * below the next threshold and at the fast one within THERMAL_NEAR_MARGIN of it, in between
+ * the interval scales with the margin. */
+#define THERMAL_SAMPLE_INTERVAL_SLOW_MS 60000
+#define THERMAL_SAMPLE_INTERVAL_FAST_MS 5000
+#define THERMAL_FAR_MARGIN 15.0
+#define THERMAL_NEAR_MARGIN 5.0
+/* Samples of the last THERMAL_HISTORY_SPAN_MS make the rate of change */
+#define THERMAL_HISTORY_SPAN_MS 300000
+#define THERMAL_HISTORY_MAX_SAMPLES 64
+/* onTemperatureApproachingThreshold goes out when the threshold is predicted this close */
+#define THERMAL_PREDICTION_HORIZON_S 300
+
 /**
  * This class defines the functionalities for thermal monitoring.
  **/
@@ -44,16 +63,51 @@ namespace WPEFramework {
             public:
                 static CThermalMonitor* instance();
 
+                /* The observer starts the sampler, which reports predicted threshold crossings to it */
                 void addEventObserver(WPEFramework::Plugin::SystemServices* service);
                 void removeEventObserver(WPEFramework::Plugin::SystemServices* service);
 
-                bool getCoreTemperature(float& temperature) const;
+                /* From the last sample while the sampler runs fast enough, from the power manager otherwise */
+                bool getCoreTemperature(float& temperature);
+                /* Rate of change in degrees per second, false until the history spans enough samples */
+                bool getTemperatureRate(float& rate);
+                /* A temperature reported by the power manager's thermal events */
+                void onTemperatureReported(float temperature);
                 void emitTemperatureThresholdChange(std::string thresholdType, bool isAboveThreshold, float temperature);
                 bool getCoreTempThresholds(float& high, float& critical) const;
-                bool setCoreTempThresholds(float high, float critical) const;
+                bool setCoreTempThresholds(float high, float critical);
 		bool getOvertempGraceInterval(int& graceInterval) const;
 		bool setOvertempGraceInterval(int graceInterval) const;
                 void reportTemperatureThresholdChange(std::string thresholdType, bool isAboveThreshold, float temperature);
+
+            private:
+                typedef std::chrono::steady_clock Clock;
+
+                struct Sample {
+                    Clock::time_point time;
+                    float temperature;
+                };
+
+                bool readCoreTemperature(float& temperature) const;
+                void addSample(float temperature);
+                bool rate(float& rate) const;
+                int nextInterval(float temperature, float rate, bool rateValid) const;
+                void checkApproaching(float temperature, float rate, bool rateValid);
+                void sampler();
+
+                std::mutex m_lock;
+                std::condition_variable m_cv;
+                std::thread m_thread;
+                bool m_running = false;
+                bool m_wake = false;
+                SystemServices* m_observer = nullptr;
+                std::deque<Sample> m_history;
+                int m_interval = THERMAL_SAMPLE_INTERVAL_SLOW_MS;
+                float m_high = 0;
+                float m_critical = 0;
+                bool m_thresholdsValid = false;
+                bool m_highArmed = true;        // approaching event not sent for the threshold yet
+                bool m_criticalArmed = true;
         };
     }
 }
@@ -18,6 +18,9 @@
 **/
 
 #include "tptimer.h"
+#include "TimerService.h"
+
+#include <algorithm>
 
 namespace WPEFramework
 {
@@ -25,34 +28,31 @@ namespace WPEFramework
     namespace Plugin
     {    
         TpTimer::TpTimer() :
-                baseTimer(64 * 1024, "ThunderPluginBaseTimer")
-                , m_timerJob(this)
-        , m_isActive(false)
-        , m_isSingleShot(false)
+                m_isSingleShot(false)
         , m_intervalInMs(-1)
-        {}
+        {
+            m_id = TimerService::instance().add(std::bind(&TpTimer::Timed, this));
+        }
 
         TpTimer::~TpTimer()
         {
-            stop();
+            TimerService::instance().remove(m_id);
         }
 
         bool TpTimer::isActive()
         {
-            return m_isActive;
+            return TimerService::instance().isScheduled(m_id);
         }
 
         void TpTimer::stop()
         {
-            baseTimer.Revoke(m_timerJob);
-            m_isActive = false;
+            TimerService::instance().cancel(m_id, false);
         }
         
         void TpTimer::start()
         {
-            baseTimer.Revoke(m_timerJob);
-            baseTimer.Schedule(Core::Time::Now().Add(m_intervalInMs), m_timerJob);
-            m_isActive = true;
+            uint32_t interval = (m_intervalInMs > 0 ? m_intervalInMs : 0);
+            TimerService::instance().schedule(m_id, interval, (m_isSingleShot ? 0 : std::max(interval, 1u)));
         }
 
         void TpTimer::start(int msec)
@@ -81,22 +81,6 @@ namespace WPEFramework
             if(onTimeoutCallback != nullptr) {
                 onTimeoutCallback();
             }
-            
-            if (m_isActive) {
-                if(m_isSingleShot) {
-                    stop();
-                } else{
-                start();
-                }
-            }
-        }
-        
-        uint64_t TpTimerJob::Timed(const uint64_t scheduledTime)
-        {
-            if(m_tptimer) {
-                m_tptimer->Timed();
-            }
-            return 0;
         }
     }
 }
@@ -20,46 +20,26 @@
 #ifndef TTIMER_H
 #define TTIMER_H
 
-//#include <core/Timer.h>
 #include <plugins/plugins.h>
 
+#include <stdint.h>
+#include <functional>
+
 namespace WPEFramework
 {
 
     namespace Plugin
     {
-        class TpTimer;
-        
-        class TpTimerJob
-        {
-        private:
-            TpTimerJob() = delete;
-            TpTimerJob& operator=(const TpTimerJob& RHS) = delete;
-
-        public:
-            TpTimerJob(WPEFramework::Plugin::TpTimer* tpt) : m_tptimer(tpt) { }
-            TpTimerJob(const TpTimerJob& copy) : m_tptimer(copy.m_tptimer) { }
-            ~TpTimerJob() {}
-
-            inline bool operator==(const TpTimerJob& RHS) const
-            {
-                return(m_tptimer == RHS.m_tptimer);
-            }
-
-        public:
-            uint64_t Timed(const uint64_t scheduledTime);
-
-        private:
-            WPEFramework::Plugin::TpTimer* m_tptimer;
-        };
-
+        // Handle on a timer of the TimerService, the callback runs on the service thread
         class TpTimer
         {
         public:
             TpTimer();
+            // Waits for a running callback to return
             ~TpTimer();
             
             bool isActive();
+            // Does not wait for a running callback, so it can be called with the lock the callback takes
             void stop();
             void start();
             void start(int msec);
@@ -72,15 +52,11 @@ namespace WPEFramework
             
             void Timed();
             
-            WPEFramework::Core::TimerType<TpTimerJob> baseTimer;
-            TpTimerJob m_timerJob;
-            bool m_isActive;
+            uint32_t m_id;
             bool m_isSingleShot;
             int m_intervalInMs;
             
             std::function< void() > onTimeoutCallback;
-            
-            friend class TpTimerJob;
         };
     }
     
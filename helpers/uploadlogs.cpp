@@ -20,6 +20,9 @@
 #include "uploadlogs.h"
 
 #include <curl/curl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <sstream>
 #include <map>
 
@@ -29,6 +32,15 @@
 #define TR181_MTLS_LOGUPLOAD "Device.DeviceInfo.X_RDKCENTRAL-COM_RFC.Feature.MTLS.mTlsLogUpload.Enable"
 #define TR181_LOGUPLOAD_BEF_DEEPSLEEP "Device.DeviceInfo.X_RDKCENTRAL-COM_RFC.Feature.LogUploadBeforeDeepSleep.Enable"
 
+/* Uploads are throttled so that they don't starve playback of bandwidth */
+#define UPLOADLOGS_MAX_SEND_BYTES_PER_SEC (512 * 1024)
+/* Instead of a total timeout, that large bundles on slow links can't meet, give up when less than this goes out for UPLOADLOGS_LOW_SPEED_TIME_SEC */
+#define UPLOADLOGS_LOW_SPEED_BYTES_PER_SEC 1024
+#define UPLOADLOGS_LOW_SPEED_TIME_SEC 60
+/* Attempts of the upload of the archive file, the archive is kept between them */
+#define UPLOADLOGS_FILE_ATTEMPTS 3
+#define UPLOADLOGS_RETRY_DELAY_SEC 10
+
 namespace WPEFramework
 {
 namespace Plugin
@@ -115,7 +127,7 @@ namespace
         err_t ret = OK;
 
         string tmp = "/tmp/" + filename;
-        string cmd = "tar -C /opt/logs -zcf " + tmp + " ./";
+        string cmd = "nice -n 19 tar -C /opt/logs -zcf " + tmp + " ./";
 
         Utils::cRunScript(C_STR(cmd));
         if (!Utils::fileExists(C_STR(tmp)))
@@ -131,31 +143,28 @@ namespace
         return fread(data, size, nitems, (FILE *)userdata);
     }
 
-    err_t uploadLogs(const string& path, const string& uploadUrl)
+    // size < 0 streams with chunked transfer encoding
+    err_t put(const string& uploadUrl, FILE *source, curl_off_t size, long& http_code)
     {
-        err_t ret = OK;
-
-        CURL *curl;
-        CURLcode res;
-        long http_code = 0;
-        FILE *fd;
-        struct stat file_info;
-        stat(C_STR(path), &file_info);
-        fd = fopen(C_STR(path), "rb");
+        CURLcode res = CURLE_FAILED_INIT;
+        http_code = 0;
 
-        curl = curl_easy_init();
+        CURL *curl = curl_easy_init();
         if (curl)
         {
             curl_easy_setopt(curl, CURLOPT_READFUNCTION, uploadRead);
             curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
             curl_easy_setopt(curl, CURLOPT_PUT, 1L);
             curl_easy_setopt(curl, CURLOPT_URL, C_STR(uploadUrl));
-            curl_easy_setopt(curl, CURLOPT_READDATA, fd);
-            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)file_info.st_size);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L);
+            curl_easy_setopt(curl, CURLOPT_READDATA, source);
+            if (size >= 0)
+                curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, size);
+            curl_easy_setopt(curl, CURLOPT_MAX_SEND_SPEED_LARGE, (curl_off_t)UPLOADLOGS_MAX_SEND_BYTES_PER_SEC);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, (long)UPLOADLOGS_LOW_SPEED_BYTES_PER_SEC);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, (long)UPLOADLOGS_LOW_SPEED_TIME_SEC);
             curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 60L);
 
-            LOGINFO("curl request to: %s", C_STR(uploadUrl));
+            LOGINFO("curl request to: %s (%s)", C_STR(uploadUrl), size >= 0 ? "file" : "streamed");
             res = curl_easy_perform(curl);
             if (res != CURLE_OK)
                 LOGERR("curl_easy_perform() failed: %s", curl_easy_strerror(res));
@@ -165,10 +174,69 @@ namespace
 
             curl_easy_cleanup(curl);
         }
-        fclose(fd);
 
-        if (res != CURLE_OK || http_code != 200)
-            ret = UploadFail;
+        return (res == CURLE_OK && http_code == 200) ? OK : UploadFail;
+    }
+
+    /*
+     * Compresses /opt/logs straight into the request body, so no copy of the logs is
+     * kept in /tmp (RAM) and the upload starts with the first compressed block.
+     */
+    err_t streamLogs(const string& uploadUrl)
+    {
+        FILE *archive = popen("nice -n 19 tar -C /opt/logs -zcf - ./ 2>/dev/null", "r");
+        if (archive == nullptr)
+            return TarFail;
+
+        long http_code = 0;
+        err_t ret = put(uploadUrl, archive, -1, http_code);
+
+        /* Drain what curl didn't take, so that tar doesn't block on the pipe */
+        char buffer[4096];
+        while (fread(buffer, 1, sizeof(buffer), archive) > 0)
+            ;
+
+        int status = pclose(archive);
+        if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) > 1)
+        {
+            /* tar exits with 1 if logs changed while they were read, that is expected */
+            LOGERR("streaming tar failed, status %d", status);
+            ret = (ret == OK) ? TarFail : ret;
+        }
+
+        return ret;
+    }
+
+    // Servers that need a Content-Length get the archive from a file, which is also what the retries resend
+    err_t uploadLogs(const string& path, const string& uploadUrl)
+    {
+        err_t ret = UploadFail;
+
+        for (int attempt = 1; attempt <= UPLOADLOGS_FILE_ATTEMPTS && ret != OK; attempt++)
+        {
+            if (attempt > 1)
+            {
+                LOGWARN("upload attempt %d of %d in %d s", attempt, UPLOADLOGS_FILE_ATTEMPTS, UPLOADLOGS_RETRY_DELAY_SEC * (attempt - 1));
+                sleep(UPLOADLOGS_RETRY_DELAY_SEC * (attempt - 1));
+            }
+
+            struct stat file_info;
+            FILE *fd = fopen(C_STR(path), "rb");
+            if (fd == nullptr || fstat(fileno(fd), &file_info) != 0)
+            {
+                if (fd != nullptr)
+                    fclose(fd);
+                return UploadFail;
+            }
+
+            long http_code = 0;
+            ret = put(uploadUrl, fd, (curl_off_t)file_info.st_size, http_code);
+            fclose(fd);
+
+            /* The server refused the request, resending won't help */
+            if (http_code >= 400 && http_code < 500)
+                break;
+        }
 
         return ret;
     }
@@ -199,13 +267,18 @@ err_t upload(const std::string& ssrUrl)
         ret = acquireUploadUrl(ssr, filename, uploadUrl);
     }
 
-    string path;
     if (ret == OK)
     {
         LOGINFO("uploadUrl: %s", C_STR(uploadUrl));
-        ret = archiveLogs(filename, path);
+        if (streamLogs(uploadUrl) == OK)
+            return OK;
+        LOGWARN("streamed upload failed, uploading from an archive file");
     }
 
+    string path;
+    if (ret == OK)
+        ret = archiveLogs(filename, path);
+
     if (ret == OK)
     {
         LOGINFO("path: %s", C_STR(path));
@@ -19,6 +19,8 @@
 
 #include "upnpdiscoverymanager.h"
 
+#include <chrono>
+
 /* XUPNP Based Macros */
 #define  _IARM_XUPNP_NAME                            "XUPnP" /*!< Method to Get the Xupnp Info */
 #define  IARM_BUS_XUPNP_API_GetXUPNPDeviceInfo        "GetXUPNPDeviceInfo" /*!< Method to Get the Xupnp Info */
@@ -27,6 +29,10 @@ using namespace std::placeholders;
 static CUpnpDiscoveryManager s_instance;
 std::function <void (JsonObject) >_postUPNPUpdateFuncPtr;
 
+static uint64_t monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 CUpnpDiscoveryManager* CUpnpDiscoveryManager::instance()
 {
@@ -50,6 +56,9 @@ void CUpnpDiscoveryManager::stop()
     {
         m_isActive = false;
         IARM_Bus_UnRegisterEventHandler(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_EVENT_XUPNP_DATA_UPDATE);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_devices.clear();
     }
 }
 
@@ -59,26 +68,129 @@ void CUpnpDiscoveryManager::register_deviceupdate_cb (std::function< void () > c
 //    onDeviceUpdateCallback.push_back(std::make_shared<std::function< void () >> callback);
 }
 
+void CUpnpDiscoveryManager::register_devicedelta_cb (DeltaCallback callback)
+{
+    onDeviceDeltaCallback = callback;
+}
+
 JsonObject CUpnpDiscoveryManager::getDiscoveredDevices()
 {
+    JsonObject result;
     if (m_isActive)
     {
-        return m_upnpJSONResults;
+        JsonArray removed;
+        std::map<std::string, JsonArray> lists;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            expireDevices(monotonicMs(), removed);
+            for (auto& entry : m_devices)
+                lists[entry.second.list].Add(entry.second.device);
+        }
+        for (auto& list : lists)
+            result[list.first.c_str()] = list.second;
+
+        if (removed.Length() > 0 && onDeviceDeltaCallback != nullptr)
+            onDeviceDeltaCallback(JsonArray(), removed, JsonArray());
+    }
+    return result;
+}
+
+std::string CUpnpDiscoveryManager::deviceKey(const JsonObject& device, const std::string& json)
+{
+    static const char* const labels[] = { "usn", "USN", "bcastMacAddress" };
+    for (const char* label : labels)
+    {
+        if (device.HasLabel(label) && !device[label].String().empty())
+            return device[label].String();
     }
-    return JsonObject();
+    return json;
 }
 
+// Caller holds m_lock
+void CUpnpDiscoveryManager::expireDevices(uint64_t nowMs, JsonArray& removed)
+{
+    for (auto entry = m_devices.begin(); entry != m_devices.end(); )
+    {
+        if (entry->second.expiresMs <= nowMs)
+        {
+            removed.Add(entry->second.device);
+            entry = m_devices.erase(entry);
+        }
+        else
+            ++entry;
+    }
+}
+
+/*
+ * Every update from XUPnP is the complete list, devices missing from it are removed. Unchanged
+ * devices only get their TTL refreshed, so an SSDP burst that re-announces the same devices
+ * costs a string compare per device and notifies nobody.
+ */
 void CUpnpDiscoveryManager::saveUpdatedDiscoveredDevices(JsonObject upnpJSONResults)
 {
-    if (m_isActive)
+    if (!m_isActive)
+        return;
+
+    JsonArray added, removed, changed;
     {
-        /* Update the member variable */
-        m_upnpJSONResults = upnpJSONResults;
+        std::lock_guard<std::mutex> lock(m_lock);
+        uint64_t nowMs = monotonicMs();
+        std::map<std::string, Device> devices;
 
-        /* Notify to listeners */
-        if (onDeviceUpdateCallback != nullptr)
-            onDeviceUpdateCallback();
+        JsonObject::Iterator iterator = upnpJSONResults.Variants();
+        while (iterator.Next())
+        {
+            if (iterator.Current().Content() != JsonValue::type::ARRAY)
+                continue;
+
+            std::string list = iterator.Label();
+            JsonArray entries = iterator.Current().Array();
+            for (uint16_t i = 0; i < entries.Length(); i++)
+            {
+                if (entries[i].Content() != JsonValue::type::OBJECT)
+                    continue;
+
+                Device device;
+                device.list = list;
+                device.device = entries[i].Object();
+                device.device.ToString(device.json);
+
+                uint64_t ttlSec = UPNP_DEVICE_DEFAULT_TTL_SEC;
+                if (device.device.HasLabel("maxAge") && device.device["maxAge"].Number() > 0)
+                    ttlSec = device.device["maxAge"].Number();
+                device.expiresMs = nowMs + ttlSec * 1000;
+
+                std::string key = deviceKey(device.device, device.json);
+                if (devices.find(key) != devices.end())
+                    continue;
+
+                auto known = m_devices.find(key);
+                if (known == m_devices.end())
+                    added.Add(device.device);
+                else
+                {
+                    if (known->second.json != device.json)
+                        changed.Add(device.device);
+                    m_devices.erase(known);
+                }
+                devices[key] = device;
+            }
+        }
+
+        /* What is left was not reported any more */
+        for (auto& entry : m_devices)
+            removed.Add(entry.second.device);
+        m_devices.swap(devices);
     }
+
+    if (added.Length() == 0 && removed.Length() == 0 && changed.Length() == 0)
+        return;
+
+    /* Notify to listeners */
+    if (onDeviceDeltaCallback != nullptr)
+        onDeviceDeltaCallback(added, removed, changed);
+    if (onDeviceUpdateCallback != nullptr)
+        onDeviceUpdateCallback();
 }
 
 void CUpnpDiscoveryManager::requestUpnpDeviceList()
@@ -120,7 +232,7 @@ void CUpnpDiscoveryManager::monitorUpnpEvents(const char *owner, IARM_EventId_t
                 upnpJSONResults.FromString(std::string (upnpResults));
 
                 /* Notify the class */
-                _postUPNPUpdateFuncPtr(upnpResults);
+                _postUPNPUpdateFuncPtr(upnpJSONResults);
             }
         }
     }
@@ -35,27 +35,52 @@ extern "C" {
 }
 #endif
 
-//#include <functional>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <string>
 
+/* Devices that are not reported again within their max-age are dropped, 1800 s is the usual SSDP CACHE-CONTROL */
+#define UPNP_DEVICE_DEFAULT_TTL_SEC 1800
+
+/*
+ * Keeps the devices reported by XUPnP in a table keyed by USN (the broadcast MAC or the
+ * entry itself for devices without one). Every update from XUPnP is diffed against the
+ * table and the delta callbacks get only the devices that were added, removed (no longer
+ * reported or expired) or changed; nothing is notified if the update changed nothing.
+ */
 class CUpnpDiscoveryManager
 {
 public:
+    typedef std::function< void (const JsonArray& added, const JsonArray& removed, const JsonArray& changed) > DeltaCallback;
+
     static CUpnpDiscoveryManager* instance();
 
     void start();
     void stop();
     void register_deviceupdate_cb (std::function< void () > callback);
+    void register_devicedelta_cb (DeltaCallback callback);
     JsonObject getDiscoveredDevices();
 private:
+    struct Device
+    {
+        std::string list;       // member of the XUPnP result the device was reported in, e.g. "xmediagateways"
+        std::string json;       // the entry as reported, to detect changes
+        JsonObject device;
+        uint64_t expiresMs;
+    };
+
     std::function < void () > onDeviceUpdateCallback;
-    //std::vector<std::shared_ptr<std::function < void () >>> onDeviceUpdateCallback;
+    DeltaCallback onDeviceDeltaCallback;
 
     bool m_isActive;
-    JsonObject m_upnpJSONResults;
+    std::mutex m_lock;
+    std::map<std::string, Device> m_devices;
 
     void requestUpnpDeviceList();
     void saveUpdatedDiscoveredDevices(JsonObject upnpJSONResults);
+    void expireDevices(uint64_t nowMs, JsonArray& removed);
+    static std::string deviceKey(const JsonObject& device, const std::string& json);
     static void monitorUpnpEvents(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
 };
 
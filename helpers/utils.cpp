@@ -31,6 +31,14 @@
 #include <utility>
 #include <ctype.h>
 #include <mutex>
+#include <map>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #define MAX_STRING_LENGTH 2048
 
@@ -103,20 +111,135 @@ std::string Utils::formatIARMResult(IARM_Result_t result)
 std::string Utils::cRunScript(const char *cmd)
 {
     std::string totalStr = "";
-    FILE *pipe = NULL;
-    char buff[1024] = {'\0'};
-
-    if ((pipe = popen(cmd, "r"))) {
-        memset(buff, 0, sizeof(buff));
-        while (fgets(buff, sizeof(buff), pipe)) {
-            totalStr += buff;
-            memset(buff, 0, sizeof(buff));
+    std::vector<std::string> args = { "/bin/sh", "-c", cmd };
+
+    runCommand(args, &totalStr);
+    return totalStr;
+}
+
+int Utils::runCommand(const std::vector<std::string>& args, std::string* output, int timeoutMs)
+{
+    int result = -1;
+    int fds[2] = { -1, -1 };
+    pid_t pid = -1;
+    std::vector<char*> argv;
+    posix_spawn_file_actions_t actions;
+
+    if (args.empty())
+        return result;
+
+    for (auto it = args.begin(); it != args.end(); ++it)
+        argv.push_back(const_cast<char*>(it->c_str()));
+    argv.push_back(nullptr);
+
+    if (output != nullptr) {
+        output->clear();
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            LOGERR("pipe failed for %s: %s", argv[0], strerror(errno));
+            return result;
         }
-        pclose(pipe);
-    } else {
-        /* popen failed. */
     }
-    return totalStr;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    if (output != nullptr)
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+    int error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (fds[1] != -1)
+        close(fds[1]);
+
+    if (error != 0) {
+        LOGERR("failed to run %s: %s", argv[0], strerror(error));
+        if (fds[0] != -1)
+            close(fds[0]);
+        return result;
+    }
+
+    bool expired = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    if (fds[0] != -1) {
+        char buffer[4096];
+        struct pollfd pfd = { fds[0], POLLIN, 0 };
+
+        while (!expired) {
+            int wait = -1;
+            if (timeoutMs >= 0) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                wait = (left > 0) ? static_cast<int>(left) : 0;
+            }
+            int ready = poll(&pfd, 1, wait);
+            if (ready == 0) {
+                expired = true;
+            } else if (ready < 0) {
+                if (errno != EINTR)
+                    break;
+            } else {
+                ssize_t length = read(fds[0], buffer, sizeof(buffer));
+                if (length > 0)
+                    output->append(buffer, length);
+                else if (length == 0 || errno != EINTR)
+                    break;
+            }
+        }
+        close(fds[0]);
+    }
+
+    // Without output to wait for, the timeout applies to the exit itself.
+    int status = 0;
+    pid_t waited = 0;
+
+    while (!expired && (waited = waitpid(pid, &status, (timeoutMs >= 0) ? WNOHANG : 0)) == 0) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            expired = true;
+        else
+            usleep(10 * 1000);
+    }
+
+    if (expired) {
+        LOGWARN("%s timed out after %d ms, killing it", argv[0], timeoutMs);
+        kill(pid, SIGKILL);
+        waited = waitpid(pid, &status, 0);
+    } else if (waited < 0 && errno == EINTR) {
+        waited = waitpid(pid, &status, 0);
+    }
+
+    if (waited == pid && !expired && WIFEXITED(status))
+        result = WEXITSTATUS(status);
+
+    return result;
+}
+
+bool Utils::readFile(const char *path, std::string& content, bool trim, size_t maxSize)
+{
+    bool result = false;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    content.clear();
+    if (fd >= 0) {
+        char buffer[4096];
+        ssize_t length = 0;
+
+        while (content.size() < maxSize) {
+            length = read(fd, buffer, std::min(sizeof(buffer), maxSize - content.size()));
+            if (length > 0)
+                content.append(buffer, length);
+            else if (length == 0 || errno != EINTR)
+                break;
+        }
+        result = (length >= 0);
+        close(fd);
+    }
+
+    if (result && trim) {
+        content.erase(0, content.find_first_not_of(" \n\r\t"));
+        content.erase(content.find_last_not_of(" \n\r\t") + 1);
+    }
+
+    return result;
 }
 
 using namespace WPEFramework;
@@ -260,15 +383,104 @@ bool Utils::SecurityToken::isThunderSecurityConfigured()
 }
 
 // Thunder plugins communication
-std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > Utils::getThunderControllerClient(std::string callsign)
+namespace {
+    typedef WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> ThunderClient;
+
+    std::mutex& thunderClientsLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    // Keyed by access point and callsign. Setting up a link costs a WebSocket
+    // connection, so the ones to the Controller and the platform services are
+    // kept as long as they work and their plugin stays up.
+    std::map<std::string, std::shared_ptr<ThunderClient> >& thunderClients()
+    {
+        static std::map<std::string, std::shared_ptr<ThunderClient> > clients;
+        return clients;
+    }
+
+    // A link with a local identifier carries event subscriptions of its owner,
+    // application callsigns come and go, neither is shared.
+    bool isPooled(const std::string& callsign, const std::string& localidentifier)
+    {
+        return localidentifier.empty() &&
+            (callsign.empty() ||
+             callsign.compare(0, 11, "Controller.") == 0 ||
+             callsign.compare(0, 8, "org.rdk.") == 0 ||
+             callsign.compare(0, 9, "Packager.") == 0);
+    }
+
+    // "org.rdk.System.2" -> "org.rdk.System"
+    std::string withoutVersion(const std::string& callsign)
+    {
+        size_t dot = callsign.rfind('.');
+        if (dot == std::string::npos || dot + 1 == callsign.size() ||
+            callsign.find_first_not_of("0123456789", dot + 1) != std::string::npos)
+            return callsign;
+        return callsign.substr(0, dot);
+    }
+
+    std::shared_ptr<ThunderClient> createThunderClient(const std::string& callsign, const std::string& localidentifier, const std::string& access)
+    {
+        string token;
+        Utils::SecurityToken::getSecurityToken(token);
+        string query = "token=" + token;
+
+        // THUNDER_ACCESS is only read while the link is constructed, hence under the lock.
+        Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(access)));
+        return make_shared<ThunderClient>(callsign.c_str(), localidentifier.c_str(), false, query);
+    }
+}
+
+std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > Utils::getThunderControllerClient(std::string callsign, std::string localidentifier, std::string access)
 {
-    string token;
-    Utils::SecurityToken::getSecurityToken(token);
-    string query = "token=" + token;
+    if (access.empty())
+        access = SERVER_DETAILS;
+
+    std::lock_guard<std::mutex> lock(thunderClientsLock());
+    if (!isPooled(callsign, localidentifier))
+        return createThunderClient(callsign, localidentifier, access);
 
-    Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(SERVER_DETAILS)));
-    static std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> > thunderClient = make_shared<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> >(callsign.c_str(), "",false,query);
-    return thunderClient;
+    std::shared_ptr<ThunderClient>& client = thunderClients()[access + '|' + callsign];
+    if (!client)
+        client = createThunderClient(callsign, localidentifier, access);
+    return client;
+}
+
+void Utils::releaseThunderControllerClient(const std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> >& client, uint32_t status)
+{
+    if (client && (status == Core::ERROR_ASYNC_FAILED || status == Core::ERROR_CONNECTION_CLOSED || status == Core::ERROR_TIMEDOUT))
+    {
+        std::lock_guard<std::mutex> lock(thunderClientsLock());
+        for (auto it = thunderClients().begin(); it != thunderClients().end(); ++it)
+        {
+            if (it->second == client)
+            {
+                LOGWARN("Dropping client of '%s' after status %u", it->first.c_str(), status);
+                thunderClients().erase(it);
+                break;
+            }
+        }
+    }
+}
+
+void Utils::evictThunderControllerClients(const std::string& callsign)
+{
+    std::string name = withoutVersion(callsign);
+    std::lock_guard<std::mutex> lock(thunderClientsLock());
+    for (auto it = thunderClients().begin(); it != thunderClients().end(); )
+    {
+        std::string pooled = it->first.substr(it->first.find('|') + 1);
+        if (withoutVersion(pooled) == name)
+        {
+            LOGINFO("Dropping client of '%s', %s was deactivated", it->first.c_str(), callsign.c_str());
+            it = thunderClients().erase(it);
+        }
+        else
+            ++it;
+    }
 }
 
 void Utils::activatePlugin(const char* callSign)
@@ -280,7 +492,9 @@ void Utils::activatePlugin(const char* callSign)
     if(!isPluginActivated(callSign))
     {
         LOGINFO("Activating %s", callSign);
-        uint32_t status = getThunderControllerClient()->Invoke<JsonObject, JsonObject>(2000, "activate", joParams, joResult);
+        auto thunderController = getThunderControllerClient();
+        uint32_t status = thunderController->Invoke<JsonObject, JsonObject>(2000, "activate", joParams, joResult);
+        releaseThunderControllerClient(thunderController, status);
         string strParams;
         string strResult;
         joParams.ToString(strParams);
@@ -301,7 +515,9 @@ bool Utils::isPluginActivated(const char* callSign)
 {
     string method = "status@" + string(callSign);
     Core::JSON::ArrayType<PluginHost::MetaData::Service> joResult;
-    uint32_t status = getThunderControllerClient()->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(2000, method.c_str(),joResult);
+    auto thunderController = getThunderControllerClient();
+    uint32_t status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(2000, method.c_str(),joResult);
+    releaseThunderControllerClient(thunderController, status);
     bool pluginActivated = false;
     if (status == Core::ERROR_NONE)
     {
@@ -39,17 +39,81 @@
 // std
 #include <string>
 #include <thread>
+#include <vector>
+
+#include "AsyncLogger.h"
+#include "LogControl.h"
 
 #define UNUSED(expr)(void)(expr)
 #define C_STR(x) (x).c_str()
 
-#define LOGINFO(fmt, ...) do { fprintf(stderr, "[%d] INFO [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGDBG(fmt, ...) do { fprintf(stderr, "[%d] DEBUG [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGWARN(fmt, ...) do { fprintf(stderr, "[%d] WARN [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGERR(fmt, ...) do { fprintf(stderr, "[%d] ERROR [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); Utils::Telemetry::sendError(fmt, ##__VA_ARGS__); } while (0)
+/*
+ * LOG* levels below UTILS_LOG_LEVEL are compiled out, their arguments are
+ * still type checked but never evaluated. Above it the runtime level of
+ * LogControl.h decides, before any argument is evaluated. USE_ASYNC_LOGGING
+ * selects the buffered backend in AsyncLogger.h. Both are set for all plugins
+ * by the PLUGINS_LOG_LEVEL and PLUGINS_ASYNC_LOGGING build options.
+ */
+#ifndef UTILS_LOG_LEVEL
+#define UTILS_LOG_LEVEL UTILS_LOG_LEVEL_DEBUG
+#endif
+
+#ifndef UTILS_LOG_METHOD_LIMIT
+#define UTILS_LOG_METHOD_LIMIT 0
+#endif
 
-#define LOGINFOMETHOD() { std::string json; parameters.ToString(json); LOGINFO( "params=%s", json.c_str() );  }
-#define LOGTRACEMETHODFIN() do { std::string json; response.ToString(json); LOGINFO( "response=%s", json.c_str() );  } while (0)
+#define UTILS_LOG_QUOTE(x) #x
+#define UTILS_LOG_EXPAND_AND_QUOTE(x) UTILS_LOG_QUOTE(x)
+#ifdef MODULE_NAME
+#define UTILS_LOG_MODULE UTILS_LOG_EXPAND_AND_QUOTE(MODULE_NAME)
+#else
+#define UTILS_LOG_MODULE ""
+#endif
+
+#define LOG_DISABLED(fmt, ...) do { if (0) fprintf(stderr, fmt, ##__VA_ARGS__); } while (0)
+
+#ifdef USE_ASYNC_LOGGING
+#define LOG_DEBUG_OUTPUT(fmt, ...) Utils::AsyncLogger::write(false, "DEBUG", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
+#define LOG_INFO_OUTPUT(fmt, ...) Utils::AsyncLogger::write(false, "INFO", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
+#define LOG_WARN_OUTPUT(fmt, ...) Utils::AsyncLogger::write(false, "WARN", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_OUTPUT(fmt, ...) Utils::AsyncLogger::write(true, "ERROR", Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG_OUTPUT(fmt, ...) do { fprintf(stderr, "[%d] DEBUG [%s:%d] %s: " fmt "\n", Utils::logThreadId(), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
+#define LOG_INFO_OUTPUT(fmt, ...) do { fprintf(stderr, "[%d] INFO [%s:%d] %s: " fmt "\n", Utils::logThreadId(), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
+#define LOG_WARN_OUTPUT(fmt, ...) do { fprintf(stderr, "[%d] WARN [%s:%d] %s: " fmt "\n", Utils::logThreadId(), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
+#define LOG_ERROR_OUTPUT(fmt, ...) do { fprintf(stderr, "[%d] ERROR [%s:%d] %s: " fmt "\n", Utils::logThreadId(), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); Utils::Telemetry::sendError(fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_DEBUG
+#define LOGDBG(fmt, ...) do { if (Utils::LogControl::enabled(UTILS_LOG_LEVEL_DEBUG)) LOG_DEBUG_OUTPUT(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOGDBG(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_INFO
+#define LOGINFO(fmt, ...) do { if (Utils::LogControl::enabled(UTILS_LOG_LEVEL_INFO)) LOG_INFO_OUTPUT(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOGINFO(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_WARN
+#define LOGWARN(fmt, ...) do { if (Utils::LogControl::enabled(UTILS_LOG_LEVEL_WARN)) LOG_WARN_OUTPUT(fmt, ##__VA_ARGS__); } while (0)
+#else
+#define LOGWARN(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#define LOGERR(fmt, ...) LOG_ERROR_OUTPUT(fmt, ##__VA_ARGS__)
+
+// Serializes only when INFO is logged, cut to the plugin's PLUGINS_LOG_METHOD_LIMIT.
+#define LOG_JSON(object, fmt, ...) do { \
+        if ((UTILS_LOG_LEVEL <= UTILS_LOG_LEVEL_INFO) && Utils::LogControl::enabled(UTILS_LOG_LEVEL_INFO)) { \
+            static const size_t jsonLimit = Utils::LogControl::methodLimit(UTILS_LOG_MODULE, UTILS_LOG_METHOD_LIMIT); \
+            std::string json; \
+            (object).ToString(json); \
+            Utils::LogControl::truncate(json, jsonLimit); \
+            LOGINFO(fmt, ##__VA_ARGS__, json.c_str()); \
+        } \
+    } while (0)
+
+#define LOGINFOMETHOD() { LOG_JSON(parameters, "params=%s"); }
+#define LOGTRACEMETHODFIN() LOG_JSON(response, "response=%s")
 
 #define LOG_DEVICE_EXCEPTION0() LOGWARN("Exception caught: code=%d message=%s", err.getCode(), err.what());
 #define LOG_DEVICE_EXCEPTION1(param1) LOGWARN("Exception caught" #param1 "=%s code=%d message=%s", param1.c_str(), err.getCode(), err.what());
@@ -131,9 +195,7 @@
     }
 
 #define sendNotify(event,params) { \
-    std::string json; \
-    params.ToString(json); \
-    LOGINFO("Notify %s %s", event, json.c_str()); \
+    LOG_JSON(params, "Notify %s %s", event); \
     Notify(event,params); \
 }
 
@@ -338,6 +400,26 @@ namespace Utils
      */
     std::string cRunScript(const char *cmd);
 
+    /***
+     * @brief	: Run a program directly, without a shell. posix_spawn does not copy the
+     *		  page tables of the (large, multi threaded) calling process like fork does.
+     * @param1[in]	: args; args[0] is the program, looked up in PATH unless it contains a '/'
+     * @param2[out]	: output, if not null: cleared (keeping its capacity, so it can be reused)
+     *		  and filled with the program's stdout. Otherwise stdout is inherited.
+     * @param3[in]	: timeoutMs; the program is killed once it runs longer, -1 for no limit
+     * @return		: exit code of the program, -1 if it could not be run, was killed or timed out.
+     */
+    int runCommand(const std::vector<std::string>& args, std::string* output = nullptr, int timeoutMs = -1);
+
+    /***
+     * @brief	: Read a (small) file, e.g. a sysfs or procfs node, without running cat.
+     * @param1[in]	: path
+     * @param2[out]	: content, at most maxSize bytes
+     * @param3[in]	: trim; strip leading and trailing white space (a sysfs value's newline)
+     * @return		: true if the file could be read.
+     */
+    bool readFile(const char *path, std::string& content, bool trim = false, size_t maxSize = 64 * 1024);
+
     /***
      * @brief	: Checks that file exists
      * @param1[in]	: pFileName name of file
@@ -364,7 +446,32 @@ namespace Utils
     };
 
     // Thunder Plugin Communication
-    std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> getThunderControllerClient(std::string callsign="");
+    /***
+     * @brief        : JSON-RPC client for a callsign (the Controller if empty), set up with the
+     *                 cached security token. Links to the Controller and to org.rdk.* and
+     *                 Packager services without a local identifier are created once and shared;
+     *                 any other callsign, or a link with a local identifier, is a new client.
+     * @param1[in]   : <std::string> callsign, with version
+     * @param2[in]   : <std::string> local identifier, for events
+     * @param3[in]   : <std::string> THUNDER_ACCESS address, 127.0.0.1:9998 if empty
+     * @return       : shared client
+     */
+    std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>> getThunderControllerClient(std::string callsign="", std::string localidentifier="", std::string access="");
+
+    /***
+     * @brief        : Report the status of a call made on a shared client. After a connection
+     *                 failure or timeout a shared client is dropped, the next
+     *                 getThunderControllerClient reconnects.
+     * @param1[in]   : client the call was made on
+     * @param2[in]   : <uint32_t> status returned by the call
+     */
+    void releaseThunderControllerClient(const std::shared_ptr<WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement>>& client, uint32_t status);
+
+    /***
+     * @brief        : Drop the shared clients of a plugin that was deactivated.
+     * @param1[in]   : <std::string> callsign, with or without version
+     */
+    void evictThunderControllerClients(const std::string& callsign);
 
     void activatePlugin(const char* callSign);
 